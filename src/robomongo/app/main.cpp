@@ -1,6 +1,7 @@
 #include <QApplication>
 #include <QDesktopWidget>
 
+#include <cstdio>
 #include <locale.h>
 
 // Header "mongo/util/net/sock" is needed for mongo::enableIPv6()
@@ -16,7 +17,11 @@
 
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/AllocationStats.h"
+#include "robomongo/core/utils/GuiStallMonitor.h"
 #include "robomongo/core/utils/Logger.h"       
+#include "robomongo/core/utils/StartupProfile.h"
+#include "robomongo/core/utils/ThreadPriority.h"
 #include "robomongo/gui/MainWindow.h"
 #include "robomongo/gui/AppStyle.h"
 #include "robomongo/gui/dialogs/EulaDialog.h"
@@ -25,8 +30,14 @@
 
 int main(int argc, char *argv[], char** envp)
 {
-    if (rbm_ssh_init()) 
-        return 1;
+    // Timeline of startup phases is reported with --startup-profile
+    Robomongo::StartupProfile::parseArguments(argc, argv);
+
+    {
+        Robomongo::StartupProfile::Scope phase("ssh initialization");
+        if (rbm_ssh_init()) 
+            return 1;
+    }
 
     // Please check, do we really need envp for other OSes?
 #ifdef Q_OS_WIN
@@ -42,24 +53,28 @@ int main(int argc, char *argv[], char** envp)
     // Cross Platform High DPI support - Qt 5.7
     QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
 
-    // Initialization routine for MongoDB shell
-    mongo::runGlobalInitializersOrDie(argc, argv, envp);
-    mongo::setGlobalServiceContext(mongo::ServiceContext::make());
-    // Todo from mongo repo: This should use a TransportLayerManager or TransportLayerFactory
-    auto serviceContext = mongo::getGlobalServiceContext();
-    mongo::transport::TransportLayerASIO::Options opts;
-    // When true, it breaks connection to localhost, github #1757
-    opts.enableIPv6 = mongo::shellGlobalParams.enableIPv6;
-    opts.mode = mongo::transport::TransportLayerASIO::Options::kEgress;
-    serviceContext->setTransportLayer(
-        std::make_unique<mongo::transport::TransportLayerASIO>(opts, nullptr)
-    );
-    auto tlPtr = serviceContext->getTransportLayer();
-    uassertStatusOK(tlPtr->setup());
-    uassertStatusOK(tlPtr->start());    
+    {
+        Robomongo::StartupProfile::Scope phase("mongo initialization");
+        // Initialization routine for MongoDB shell
+        mongo::runGlobalInitializersOrDie(argc, argv, envp);
+        mongo::setGlobalServiceContext(mongo::ServiceContext::make());
+        // Todo from mongo repo: This should use a TransportLayerManager or TransportLayerFactory
+        auto serviceContext = mongo::getGlobalServiceContext();
+        mongo::transport::TransportLayerASIO::Options opts;
+        // When true, it breaks connection to localhost, github #1757
+        opts.enableIPv6 = mongo::shellGlobalParams.enableIPv6;
+        opts.mode = mongo::transport::TransportLayerASIO::Options::kEgress;
+        serviceContext->setTransportLayer(
+            std::make_unique<mongo::transport::TransportLayerASIO>(opts, nullptr)
+        );
+        auto tlPtr = serviceContext->getTransportLayer();
+        uassertStatusOK(tlPtr->setup());
+        uassertStatusOK(tlPtr->start());    
+    }
 
     // Initialize Qt application
     QApplication app(argc, argv);
+    Robomongo::StartupProfile::mark("QApplication created");
 
     // On Unix/Linux Qt is configured to use the system locale settings by default.
     // This can cause a conflict when using POSIX functions, for instance, when
@@ -70,10 +85,23 @@ int main(int argc, char *argv[], char** envp)
     // (http://doc.qt.io/qt-5/qcoreapplication.html#locale-settings)
     setlocale(LC_NUMERIC, "C");
 
+    // Frame times of GUI thread are shown in Performance panel, stalls are logged
+    Robomongo::GuiStallMonitor::start();
+
+    // GUI thread renders and handles input above worker threads, background ones are lowered
+    // while they run prefetch, stats and sampling, see EventBusDispatcher
+    Robomongo::ThreadPriority::setCurrent(Robomongo::ThreadPriority::Interactive);
+
 #ifdef Q_OS_MAC
     app.setAttribute(Qt::AA_UseHighDpiPixmaps);
 #endif
      
+    // Settings are loaded (and key of passwords is read) by the first use of registry
+    {
+        Robomongo::StartupProfile::Scope phase("AppRegistry");
+        Robomongo::AppRegistry::instance();
+    }
+
     // EULA License Agreement
     auto const& settings { Robomongo::AppRegistry::instance().settingsManager() };
     if (!settings->acceptedEulaVersions().contains(PROJECT_VERSION)) {
@@ -94,20 +122,30 @@ int main(int argc, char *argv[], char** envp)
     }  
 
     // Init GUI style
-    Robomongo::AppStyleUtils::initStyle();
+    {
+        Robomongo::StartupProfile::Scope phase("style");
+        Robomongo::AppStyleUtils::initStyle();
+    }
 
     // To be set true at normal program exit
     settings->setProgramExitedNormally(false);
     settings->save();
 
-    // Application main window
+    // Application main window, its first frame finishes startup profile
     Robomongo::MainWindow mainWindow;
-    mainWindow.show();
+    {
+        Robomongo::StartupProfile::Scope phase("show");
+        mainWindow.show();
+    }
 
     for(auto const& msgAndSeverity : Robomongo::RoboCrypt::roboCryptLogs())
         Robomongo::LOG_MSG(msgAndSeverity.first, msgAndSeverity.second);
 
     int rc = app.exec();
+
+    if (Robomongo::AllocationStats::enabled())
+        fprintf(stderr, "Allocations per event handler:\n%s", Robomongo::AllocationStats::report().c_str());
+
     rbm_ssh_cleanup();
     return rc;
 }
@@ -0,0 +1,390 @@
+// Benchmarks of BSON -> view conversion paths (text, tree and table modes).
+//
+// Usage: benchmarks [iterations]
+//
+// Every line of output is one JSON object, so results can be collected by scripts
+// and compared across releases:
+//   { "benchmark" : "jsonString", "corpus" : "wide", "docs" : 1000, "bytes" : ...,
+//     "iterations" : 5, "seconds" : ..., "docs_per_sec" : ..., "mb_per_sec" : ...,
+//     "allocs_per_doc" : ... }
+//
+// Corpora are generated with fixed seed, so numbers are reproducible between runs.
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+
+#include <atomic>
+#include <clocale>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <random>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/utils/AllocationStats.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
+#include "robomongo/gui/widgets/workarea/BsonTreeModel.h"
+#include "robomongo/gui/widgets/workarea/BsonTableModel.h"
+#include "robomongo/gui/widgets/workarea/JsonPrepareJob.h"
+
+#ifdef ROBOMONGO_ALLOCATION_STATS
+// Global operator new is hooked by AllocationStats in this build
+namespace
+{
+    long long allocationCount() { return Robomongo::AllocationStats::totalAllocations(); }
+}
+#else
+namespace
+{
+    std::atomic<long long> allocations { 0 };
+
+    long long allocationCount() { return allocations; }
+}
+
+// Count all heap allocations of the process, to report allocations per document
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
+namespace
+{
+    using namespace Robomongo;
+
+    typedef std::vector<MongoDocumentPtr> Corpus;
+
+    const int seed = 20170101;
+
+    std::string randomString(std::mt19937 &gen, int length)
+    {
+        static const char chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ";
+        std::uniform_int_distribution<int> dist(0, sizeof(chars) - 2);
+        std::string result(length, ' ');
+        for (char &c : result)
+            c = chars[dist(gen)];
+        return result;
+    }
+
+    void appendRandomValue(mongo::BSONObjBuilder &b, const std::string &name, std::mt19937 &gen)
+    {
+        switch (gen() % 6) {
+        case 0: b.append(name, static_cast<int>(gen() % 100000)); break;
+        case 1: b.append(name, static_cast<long long>(gen()) * 1000); break;
+        case 2: b.append(name, std::uniform_real_distribution<double>(-1e6, 1e6)(gen)); break;
+        case 3: b.append(name, randomString(gen, 5 + gen() % 40)); break;
+        case 4: b.append(name, (gen() % 2) == 0); break;
+        default: b.appendDate(name, mongo::Date_t::fromMillisSinceEpoch(1500000000000LL + gen() % 100000000)); break;
+        }
+    }
+
+    // 300 fields of mixed simple types, distinct field sets between documents
+    Corpus wideCorpus(int count)
+    {
+        std::mt19937 gen(seed);
+        Corpus corpus;
+        for (int i = 0; i < count; ++i) {
+            mongo::BSONObjBuilder b;
+            b.append("_id", mongo::OID::gen());
+            for (int f = 0; f < 300; ++f)
+                appendRandomValue(b, "field" + std::to_string((f + i) % 400), gen);
+            corpus.push_back(MongoDocumentPtr(new MongoDocument(b.obj())));
+        }
+        return corpus;
+    }
+
+    mongo::BSONObj nestedObject(std::mt19937 &gen, int depth)
+    {
+        mongo::BSONObjBuilder b;
+        appendRandomValue(b, "value", gen);
+        appendRandomValue(b, "other", gen);
+        if (depth > 0)
+            b.append("child", nestedObject(gen, depth - 1));
+        return b.obj();
+    }
+
+    // 50 levels of nested documents
+    Corpus deepCorpus(int count)
+    {
+        std::mt19937 gen(seed);
+        Corpus corpus;
+        for (int i = 0; i < count; ++i) {
+            mongo::BSONObjBuilder b;
+            b.append("_id", mongo::OID::gen());
+            b.append("root", nestedObject(gen, 50));
+            corpus.push_back(MongoDocumentPtr(new MongoDocument(b.obj())));
+        }
+        return corpus;
+    }
+
+    // Arrays of 5000 numbers and 500 strings
+    Corpus bigArrayCorpus(int count)
+    {
+        std::mt19937 gen(seed);
+        Corpus corpus;
+        for (int i = 0; i < count; ++i) {
+            mongo::BSONObjBuilder b;
+            b.append("_id", i);
+            mongo::BSONArrayBuilder numbers(b.subarrayStart("numbers"));
+            for (int n = 0; n < 5000; ++n)
+                numbers.append(static_cast<int>(gen() % 1000));
+            numbers.done();
+            mongo::BSONArrayBuilder strings(b.subarrayStart("strings"));
+            for (int n = 0; n < 500; ++n)
+                strings.append(randomString(gen, 16));
+            strings.done();
+            corpus.push_back(MongoDocumentPtr(new MongoDocument(b.obj())));
+        }
+        return corpus;
+    }
+
+    // UUIDs (new and legacy) and generic binary data
+    Corpus binaryCorpus(int count)
+    {
+        std::mt19937 gen(seed);
+        Corpus corpus;
+        for (int i = 0; i < count; ++i) {
+            mongo::BSONObjBuilder b;
+            b.append("_id", mongo::OID::gen());
+            for (int f = 0; f < 50; ++f) {
+                char data[256];
+                for (char &c : data)
+                    c = static_cast<char>(gen());
+                std::string const name = "bin" + std::to_string(f);
+                if (f % 3 == 0)
+                    b.appendBinData(name, 16, mongo::newUUID, data);
+                else if (f % 3 == 1)
+                    b.appendBinData(name, 16, mongo::bdtUUID, data);
+                else
+                    b.appendBinData(name, sizeof(data), mongo::BinDataGeneral, data);
+            }
+            corpus.push_back(MongoDocumentPtr(new MongoDocument(b.obj())));
+        }
+        return corpus;
+    }
+
+    // Doubles of different magnitudes, int32 and int64
+    Corpus numericCorpus(int count)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+        Corpus corpus;
+        for (int i = 0; i < count; ++i) {
+            mongo::BSONObjBuilder b;
+            b.append("_id", i);
+            for (int f = 0; f < 200; ++f) {
+                std::string const name = "n" + std::to_string(f);
+                switch (f % 3) {
+                case 0: b.append(name, mantissa(gen) * std::pow(10.0, static_cast<int>(gen() % 36) - 18)); break;
+                case 1: b.append(name, static_cast<int>(gen())); break;
+                default: b.append(name, static_cast<long long>(gen()) << 20); break;
+                }
+            }
+            corpus.push_back(MongoDocumentPtr(new MongoDocument(b.obj())));
+        }
+        return corpus;
+    }
+
+    // Dates over the whole supported range (1677 - 2262), before and after epoch
+    Corpus dateCorpus(int count)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<long long> millis(-9218988800000LL + 1, 9218988800000LL - 1);
+        Corpus corpus;
+        for (int i = 0; i < count; ++i) {
+            mongo::BSONObjBuilder b;
+            b.append("_id", i);
+            for (int f = 0; f < 200; ++f)
+                b.appendDate("d" + std::to_string(f), mongo::Date_t::fromMillisSinceEpoch(millis(gen)));
+            corpus.push_back(MongoDocumentPtr(new MongoDocument(b.obj())));
+        }
+        return corpus;
+    }
+
+    // Every BSON type in turn, so that formatting and classification switch type per element
+    Corpus allTypesCorpus(int count)
+    {
+        std::mt19937 gen(seed);
+        Corpus corpus;
+        for (int i = 0; i < count; ++i) {
+            mongo::BSONObjBuilder b;
+            b.append("_id", mongo::OID::gen());
+            for (int f = 0; f < 20; ++f) {
+                std::string const name = "t" + std::to_string(f);
+                char uuid[16];
+                for (char &c : uuid)
+                    c = static_cast<char>(gen());
+                appendRandomValue(b, name + "a", gen);
+                b.append(name + "b", mongo::Decimal128(static_cast<int>(gen() % 100000)));
+                b.append(name + "c", BSON("x" << f));
+                b.append(name + "d", BSON_ARRAY(f << randomString(gen, 8)));
+                b.appendBinData(name + "e", sizeof(uuid), f % 2 ? mongo::newUUID : mongo::bdtUUID, uuid);
+                b.appendNull(name + "f");
+                b.appendRegex(name + "g", randomString(gen, 10), "i");
+                b.appendCode(name + "h", "function() { return " + std::to_string(f) + "; }");
+                b.append(name + "i", mongo::Timestamp(1500000000 + gen() % 100000, f));
+                b.appendMinKey(name + "j");
+                b.appendMaxKey(name + "k");
+            }
+            corpus.push_back(MongoDocumentPtr(new MongoDocument(b.obj())));
+        }
+        return corpus;
+    }
+
+    long long corpusBytes(const Corpus &corpus)
+    {
+        long long bytes = 0;
+        for (auto const& doc : corpus)
+            bytes += doc->bsonObj().objsize();
+        return bytes;
+    }
+
+    void report(const std::string &benchmark, const std::string &corpusName, const Corpus &corpus,
+                int iterations, double seconds, long long allocs)
+    {
+        double const docs = static_cast<double>(corpus.size()) * iterations;
+        double const megabytes = static_cast<double>(corpusBytes(corpus)) * iterations / (1024 * 1024);
+        std::cout << "{ \"benchmark\" : \"" << benchmark << "\""
+                  << ", \"corpus\" : \"" << corpusName << "\""
+                  << ", \"docs\" : " << corpus.size()
+                  << ", \"bytes\" : " << corpusBytes(corpus)
+                  << ", \"iterations\" : " << iterations
+                  << ", \"seconds\" : " << seconds
+                  << ", \"docs_per_sec\" : " << (seconds > 0 ? docs / seconds : 0)
+                  << ", \"mb_per_sec\" : " << (seconds > 0 ? megabytes / seconds : 0)
+                  << ", \"allocs_per_doc\" : " << (docs > 0 ? allocs / docs : 0)
+                  << " }" << std::endl;
+    }
+
+    void run(const std::string &benchmark, const std::string &corpusName, const Corpus &corpus,
+             int iterations, const std::function<void(const Corpus&)> &body)
+    {
+        body(corpus); // warm up
+
+        long long const allocsBefore = allocationCount();
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i)
+            body(corpus);
+        double const seconds = timer.nsecsElapsed() / 1e9;
+        report(benchmark, corpusName, corpus, iterations, seconds, allocationCount() - allocsBefore);
+    }
+
+    void benchJsonString(const Corpus &corpus)
+    {
+        size_t total = 0;
+        for (auto const& doc : corpus)
+            total += BsonUtils::jsonString(doc->bsonObj(), mongo::TenGen, 1, DefaultEncoding, Utc).size();
+        if (total == 0)
+            std::cerr << "jsonString produced no output" << std::endl;
+    }
+
+    void benchJsonStringLocalTime(const Corpus &corpus)
+    {
+        size_t total = 0;
+        for (auto const& doc : corpus)
+            total += BsonUtils::jsonString(doc->bsonObj(), mongo::TenGen, 1, DefaultEncoding, LocalTime).size();
+        if (total == 0)
+            std::cerr << "jsonString produced no output" << std::endl;
+    }
+
+    void benchJsonStringCompact(const Corpus &corpus)
+    {
+        size_t total = 0;
+        for (auto const& doc : corpus)
+            total += BsonUtils::jsonString(doc->bsonObj(), CompactJson, DefaultEncoding, Utc).size();
+        if (total == 0)
+            std::cerr << "jsonString produced no output" << std::endl;
+    }
+
+    // Model construction, parsing of all top-level documents and decoding of their values
+    void benchTreeModel(const Corpus &corpus)
+    {
+        BsonTreeModel model(corpus);
+        for (int row = 0; row < model.rowCount(); ++row) {
+            BsonTreeItem *item = static_cast<BsonTreeItem*>(model.index(row, 0).internalPointer());
+            model.fetchChildren(item);
+            for (unsigned i = 0; i < item->childrenCount(); ++i)
+                item->child(i)->value();
+        }
+    }
+
+    void benchTableModel(const Corpus &corpus)
+    {
+        BsonTreeModel model(corpus);
+        BsonTableModelProxy proxy;
+        proxy.setSourceModel(&model);
+        int const columns = proxy.columnCount(QModelIndex());
+        for (int row = 0; row < proxy.rowCount(); ++row) {
+            for (int col = 0; col < columns; ++col)
+                proxy.data(proxy.index(row, col, QModelIndex()), Qt::DisplayRole);
+        }
+    }
+
+    void benchJsonPrepareJob(const Corpus &corpus)
+    {
+        JsonPrepareJob job(corpus, DefaultEncoding, Utc, ShellJson);
+        long long length = 0;
+        QEventLoop loop;
+        QObject::connect(&job, &JsonPrepareJob::partReady,
+                         [&length](const QString &part) { length += part.size(); });
+        QObject::connect(&job, &JsonPrepareJob::done, &loop, &QEventLoop::quit);
+        job.start();
+        loop.exec();
+        if (length == 0)
+            std::cerr << "JsonPrepareJob produced no output" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    // See main.cpp
+    setlocale(LC_NUMERIC, "C");
+
+    int const iterations = argc > 1 ? std::max(1, atoi(argv[1])) : 5;
+
+    std::vector<std::pair<std::string, Corpus>> const corpora {
+        { "wide", wideCorpus(1000) },
+        { "deep", deepCorpus(1000) },
+        { "big_array", bigArrayCorpus(50) },
+        { "binary", binaryCorpus(1000) },
+        { "numeric", numericCorpus(1000) },
+        { "all_types", allTypesCorpus(1000) },
+        { "dates", dateCorpus(1000) }
+    };
+
+    for (auto const& corpus : corpora) {
+        run("jsonString", corpus.first, corpus.second, iterations, benchJsonString);
+        run("jsonStringCompact", corpus.first, corpus.second, iterations, benchJsonStringCompact);
+        run("BsonTreeModel", corpus.first, corpus.second, iterations, benchTreeModel);
+        run("BsonTableModelProxy", corpus.first, corpus.second, iterations, benchTableModel);
+        run("JsonPrepareJob", corpus.first, corpus.second, iterations, benchJsonPrepareJob);
+    }
+
+    // Dates in local time zone, the other benchmarks format them in UTC
+    auto const& dates = corpora.back();
+    run("jsonStringLocalTime", dates.first, dates.second, iterations, benchJsonStringLocalTime);
+
+    return 0;
+}
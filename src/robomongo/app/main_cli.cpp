@@ -0,0 +1,78 @@
+// Headless runner of one script or export, for cron jobs and CI pipelines.
+//
+// Usage: robo3t-cli --connection <name> (--eval <js> | --file <path> | --export <db.coll>) [options]
+//
+// Connections, SSH tunnels and shell settings are those of the GUI settings file. Documents
+// are written to stdout as JSON Lines, see BatchRunner::usage() for all options.
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <cstdio>
+#include <locale.h>
+
+// Header "mongo/platform/basic" is required by "sock.h" under Windows
+#include <mongo/platform/basic.h>
+#include <mongo/util/net/socket_utils.h>
+#include <mongo/base/initializer.h>
+#include <mongo/util/net/ssl_options.h>
+#include <mongo/db/service_context.h>
+#include <mongo/transport/transport_layer_asio.h>
+#include <mongo/shell/shell_options.h>
+
+#include "robomongo/core/domain/BatchRunner.h"
+#include "robomongo/ssh/ssh.h"
+
+int main(int argc, char *argv[], char** envp)
+{
+    using Robomongo::BatchRunner;
+
+    if (rbm_ssh_init())
+        return BatchRunner::ConnectionError;
+
+#ifdef Q_OS_WIN
+    envp = NULL;
+#endif
+
+    // Same initialization of driver and shell as in app/main.cpp
+    mongo::enableIPv6(true);
+    mongo::sslGlobalParams.sslMode.store(mongo::SSLParams::SSLMode_allowSSL);
+
+    mongo::runGlobalInitializersOrDie(argc, argv, envp);
+    mongo::setGlobalServiceContext(mongo::ServiceContext::make());
+    auto serviceContext = mongo::getGlobalServiceContext();
+    mongo::transport::TransportLayerASIO::Options opts;
+    opts.enableIPv6 = mongo::shellGlobalParams.enableIPv6;
+    opts.mode = mongo::transport::TransportLayerASIO::Options::kEgress;
+    serviceContext->setTransportLayer(
+        std::make_unique<mongo::transport::TransportLayerASIO>(opts, nullptr)
+    );
+    auto tlPtr = serviceContext->getTransportLayer();
+    uassertStatusOK(tlPtr->setup());
+    uassertStatusOK(tlPtr->start());
+
+    // No widgets are created, so no display is needed
+    QCoreApplication app(argc, argv);
+    setlocale(LC_NUMERIC, "C");
+
+    BatchRunner::Options options;
+    std::string error;
+    if (!BatchRunner::parseArguments(app.arguments().mid(1), options, error)) {
+        if (!error.empty())
+            fprintf(stderr, "%s\n\n", error.c_str());
+        fprintf(error.empty() ? stdout : stderr, "%s", BatchRunner::usage().c_str());
+        rbm_ssh_cleanup();
+        return error.empty() ? BatchRunner::Success : BatchRunner::UsageError;
+    }
+
+    int rc = 0;
+    {
+        BatchRunner runner(options);
+        // In event loop, so that QCoreApplication::exit() of early failure is not lost
+        QTimer::singleShot(0, &runner, &BatchRunner::start);
+        rc = app.exec();
+    }
+
+    rbm_ssh_cleanup();
+    return rc;
+}
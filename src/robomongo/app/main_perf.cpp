@@ -0,0 +1,99 @@
+// End-to-end performance harness: real MongoWorker, shell, model and SSH relay code paths
+// against local mongod fixture (see app/perf/PerfHarness.h).
+//
+// Usage: perf_harness [--mongod <binary>] [--port <n>] | [--host <host:port>]
+//                     [--iterations <n>] [--baseline <file>] [--save-baseline <file>]
+//                     [--tolerance <fraction>]
+//                     [--ssh-host <host> --ssh-port <n> --ssh-user <name> --ssh-key <file>]
+//
+// Every line of output is one JSON object per scenario:
+//   { "scenario" : "query/wide", "iterations" : 10, "documents" : 2000, "p50_ms" : ...,
+//     "p99_ms" : ..., "docs_per_sec" : ... }
+// With --baseline, "regressed" is added and exit code is 1 if any scenario is slower than
+// baseline by more than tolerance (0.2 by default) in p50 latency or throughput.
+
+#include <QApplication>
+
+#include <cstdlib>
+#include <iostream>
+#include <locale.h>
+
+#include <mongo/platform/basic.h>
+#include <mongo/util/net/socket_utils.h>
+#include <mongo/base/initializer.h>
+#include <mongo/util/net/ssl_options.h>
+#include <mongo/db/service_context.h>
+#include <mongo/transport/transport_layer_asio.h>
+#include <mongo/shell/shell_options.h>
+
+#include "robomongo/app/perf/PerfHarness.h"
+#include "robomongo/core/utils/AllocationStats.h"
+#include "robomongo/ssh/ssh.h"
+
+int main(int argc, char *argv[], char** envp)
+{
+    using Robomongo::PerfHarness;
+
+    if (rbm_ssh_init())
+        return 2;
+
+#ifdef Q_OS_WIN
+    envp = NULL;
+#endif
+
+    // Same initialization of driver and shell as in app/main.cpp
+    mongo::enableIPv6(true);
+    mongo::sslGlobalParams.sslMode.store(mongo::SSLParams::SSLMode_allowSSL);
+
+    mongo::runGlobalInitializersOrDie(argc, argv, envp);
+    mongo::setGlobalServiceContext(mongo::ServiceContext::make());
+    auto serviceContext = mongo::getGlobalServiceContext();
+    mongo::transport::TransportLayerASIO::Options opts;
+    opts.enableIPv6 = mongo::shellGlobalParams.enableIPv6;
+    opts.mode = mongo::transport::TransportLayerASIO::Options::kEgress;
+    serviceContext->setTransportLayer(
+        std::make_unique<mongo::transport::TransportLayerASIO>(opts, nullptr)
+    );
+    auto tlPtr = serviceContext->getTransportLayer();
+    uassertStatusOK(tlPtr->setup());
+    uassertStatusOK(tlPtr->start());
+
+    // Models of tree mode use icons, which need QApplication
+    QApplication app(argc, argv);
+    setlocale(LC_NUMERIC, "C");
+
+    PerfHarness::Options options;
+    QStringList const args = app.arguments();
+    for (int i = 1; i + 1 < args.size(); i += 2) {
+        QString const &arg = args[i];
+        QString const &value = args[i + 1];
+        if (arg == "--mongod")              options.mongod = value;
+        else if (arg == "--host")           options.host = value.toStdString();
+        else if (arg == "--port")           options.port = value.toInt();
+        else if (arg == "--iterations")     options.iterations = std::max(1, value.toInt());
+        else if (arg == "--baseline")       options.baseline = value;
+        else if (arg == "--save-baseline")  options.saveBaseline = value;
+        else if (arg == "--tolerance")      options.tolerance = value.toDouble();
+        else if (arg == "--ssh-host")       options.sshHost = value.toStdString();
+        else if (arg == "--ssh-port")       options.sshPort = value.toInt();
+        else if (arg == "--ssh-user")       options.sshUser = value.toStdString();
+        else if (arg == "--ssh-key")        options.sshKey = value.toStdString();
+        else {
+            std::cerr << "Unknown option " << arg.toStdString() << std::endl;
+            return 2;
+        }
+    }
+
+    int rc = 0;
+    {
+        PerfHarness harness(options);
+        rc = harness.run();
+    }
+
+    // Built with -DALLOCATION_STATS=ON
+    if (Robomongo::AllocationStats::enabled())
+        std::cerr << "Allocations per event handler:" << std::endl << Robomongo::AllocationStats::report();
+
+    rbm_ssh_cleanup();
+    return rc;
+}
@@ -0,0 +1,527 @@
+#include "robomongo/app/perf/PerfHarness.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QThread>
+#include <QTimer>
+
+#include <functional>
+#include <iostream>
+#include <random>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoShellResult.h"
+#include "robomongo/core/mongodb/MongoWorker.h"
+#include "robomongo/core/mongodb/SshTunnelWorker.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/settings/SshSettings.h"
+#include "robomongo/core/utils/ExportWriter.h"
+#include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
+#include "robomongo/gui/widgets/workarea/BsonTreeModel.h"
+
+namespace
+{
+    using namespace Robomongo;
+
+    // Datasets, generated with fixed seed (as in app/main_benchmark.cpp)
+    int const Seed = 20170101;
+    char const *const Database = "perf";
+    char const *const ManyCollectionsDatabase = "perf_many";
+    char const *const UsersDatabase = "perf_users";
+    char const *const CopyDatabase = "perf_copy";
+
+    int const WideDocuments = 2000;
+    int const NestedDocuments = 2000;
+    int const NestedDepth = 30;
+    int const LargeArrayDocuments = 100;
+    int const Collections = 500;
+    int const Users = 200;
+    int const InsertBatch = 500;
+
+    int const FixtureStartSec = 30;
+
+    std::string randomString(std::mt19937 &gen, int length)
+    {
+        static const char chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ";
+        std::uniform_int_distribution<int> dist(0, sizeof(chars) - 2);
+        std::string result(length, ' ');
+        for (char &c : result)
+            c = chars[dist(gen)];
+        return result;
+    }
+
+    mongo::BSONObj wideDocument(std::mt19937 &gen, int i)
+    {
+        mongo::BSONObjBuilder b;
+        b.append("_id", i);
+        for (int f = 0; f < 300; ++f) {
+            std::string const name = "field" + std::to_string((f + i) % 400);
+            switch (gen() % 4) {
+            case 0: b.append(name, static_cast<int>(gen() % 100000)); break;
+            case 1: b.append(name, std::uniform_real_distribution<double>(-1e6, 1e6)(gen)); break;
+            case 2: b.append(name, randomString(gen, 5 + gen() % 40)); break;
+            default: b.appendDate(name, mongo::Date_t::fromMillisSinceEpoch(1500000000000LL + gen() % 100000000)); break;
+            }
+        }
+        return b.obj();
+    }
+
+    mongo::BSONObj nestedObject(std::mt19937 &gen, int depth)
+    {
+        mongo::BSONObjBuilder b;
+        b.append("value", static_cast<int>(gen() % 1000));
+        b.append("name", randomString(gen, 12));
+        if (depth > 0)
+            b.append("child", nestedObject(gen, depth - 1));
+        return b.obj();
+    }
+
+    mongo::BSONObj nestedDocument(std::mt19937 &gen, int i)
+    {
+        mongo::BSONObjBuilder b;
+        b.append("_id", i);
+        b.append("root", nestedObject(gen, NestedDepth));
+        return b.obj();
+    }
+
+    mongo::BSONObj largeArrayDocument(std::mt19937 &gen, int i)
+    {
+        mongo::BSONObjBuilder b;
+        b.append("_id", i);
+        mongo::BSONArrayBuilder numbers(b.subarrayStart("numbers"));
+        for (int n = 0; n < 5000; ++n)
+            numbers.append(static_cast<int>(gen() % 1000));
+        numbers.done();
+        mongo::BSONArrayBuilder strings(b.subarrayStart("strings"));
+        for (int n = 0; n < 500; ++n)
+            strings.append(randomString(gen, 16));
+        strings.done();
+        return b.obj();
+    }
+
+    QJsonObject toJson(const PerfHarness::Result &result)
+    {
+        QJsonObject obj;
+        obj["scenario"] = QString::fromStdString(result.scenario);
+        obj["iterations"] = static_cast<qint64>(result.latency.count());
+        obj["documents"] = result.documents;
+        obj["p50_ms"] = result.p50Ms();
+        obj["p99_ms"] = result.p99Ms();
+        obj["docs_per_sec"] = result.docsPerSec();
+        return obj;
+    }
+}
+
+namespace Robomongo
+{
+    PerfHarness::PerfHarness(const Options &options) :
+        _options(options),
+        _bus(AppRegistry::instance().bus()),
+        _worker(nullptr),
+        _sshWorker(nullptr),
+        _tunnel(nullptr),
+        _tunnelPort(0),
+        _pending(false),
+        _documents(0),
+        _regressed(false)
+    {
+    }
+
+    PerfHarness::~PerfHarness()
+    {
+        if (_worker)
+            _worker->stopAndDelete();
+        if (_sshWorker)
+            _sshWorker->stopAndDelete();
+        if (_tunnel)
+            _tunnel->stopAndDelete();
+        stopFixture();
+    }
+
+    int PerfHarness::run()
+    {
+        try {
+            if (!_options.baseline.isEmpty())
+                _baseline = loadBaseline(_options.baseline);
+
+            startFixture();
+            loadDatasets();
+
+            _settings.reset(new ConnectionSettings(false));
+            _settings->setConnectionName("perf");
+            mongo::HostAndPort const hostAndPort(_address);
+            _settings->setServerHost(hostAndPort.host());
+            _settings->setServerPort(hostAndPort.port());
+            _settings->setDefaultDatabase(Database);
+
+            _worker = createWorker(_settings->clone());
+            call(_worker, new EstablishConnectionRequest(this, ConnectionPrimary, _settings->uuid().toStdString()));
+
+            // Explorer
+            scenario("databases", nullptr, [this]() {
+                call(_worker, new LoadDatabaseNamesRequest(this));
+            });
+            scenario("collections/many_collections", nullptr, [this]() {
+                call(_worker, new LoadCollectionNamesRequest(this, ManyCollectionsDatabase));
+            });
+            scenario("users/many_users", nullptr, [this]() {
+                call(_worker, new LoadUsersRequest(this, UsersDatabase));
+            });
+
+            for (std::string const collection : { "wide", "nested", "large_array" }) {
+                MongoQueryInfo const info(CollectionInfo(_address, Database, collection),
+                                          mongo::BSONObj(), mongo::BSONObj(), 0, 0, 0, 0, false);
+
+                // Driver cursor of collection tab, all batches
+                scenario("query/" + collection, nullptr, [this, &info]() {
+                    call(_worker, new ExecuteQueryRequest(this, 0, info));
+                });
+
+                std::vector<MongoDocumentPtr> const documents = _lastDocuments;
+
+                // Two statements, so that script is statementized and run by shell
+                std::string const script = "var filter = {}; db.getCollection('" + collection + "').find(filter)";
+                scenario("script/" + collection, nullptr, [this, &script]() {
+                    call(_worker, new ExecuteScriptRequest(this, script, Database));
+                });
+
+                // Tree model of queried documents, with top level documents expanded
+                scenario("tree_model/" + collection, nullptr, [this, &documents]() {
+                    BsonTreeModel model(documents);
+                    for (int row = 0; row < model.rowCount(); ++row) {
+                        BsonTreeItem *item = static_cast<BsonTreeItem*>(model.index(row, 0).internalPointer());
+                        model.fetchChildren(item);
+                        for (unsigned i = 0; i < item->childrenCount(); ++i)
+                            item->child(i)->value();
+                    }
+                    _documents = documents.size();
+                });
+            }
+
+            MongoQueryInfo const wide(CollectionInfo(_address, Database, "wide"),
+                                      mongo::BSONObj(), mongo::BSONObj(), 0, 0, 0, 0, false);
+            QString const exportFile = _dataDir.path() + "/export.json";
+            scenario("export/wide", nullptr, [this, &wide, &exportFile]() {
+                call(_worker, new ExportDocumentsRequest(this, 0, wide, ExportOptions(), exportFile,
+                                                         std::make_shared<std::atomic<bool>>(false)));
+            });
+
+            scenario("copy/wide",
+                [this]() { _fixture.dropCollection(std::string(CopyDatabase) + ".wide"); },
+                [this]() { call(_worker, new CopyCollectionToDiffServerRequest(this, _worker, Database, "wide", CopyDatabase)); });
+
+            // Same query through SSH relay, if loopback sshd is given
+            if (!_options.sshHost.empty()) {
+                ConnectionSettings *tunneled = _settings->clone();
+                SshSettings *ssh = tunneled->sshSettings();
+                ssh->setEnabled(true);
+                ssh->setHost(_options.sshHost);
+                ssh->setPort(_options.sshPort);
+                ssh->setUserName(_options.sshUser);
+                ssh->setAuthMethod("publickey");
+                ssh->setPrivateKeyFile(_options.sshKey);
+
+                _tunnel = new SshTunnelWorker(tunneled);
+                call(_tunnel, new EstablishSshConnectionRequest(this, 0, _tunnel, tunneled, ConnectionPrimary));
+                _bus->send(_tunnel, new ListenSshConnectionRequest(this, 0, ConnectionPrimary));
+
+                ConnectionSettings *relayed = _settings->clone();
+                relayed->setServerHost("127.0.0.1");
+                relayed->setServerPort(_tunnelPort);
+                _sshWorker = createWorker(relayed);
+                call(_sshWorker, new EstablishConnectionRequest(this, ConnectionPrimary, _settings->uuid().toStdString()));
+
+                scenario("ssh_query/wide", nullptr, [this, &wide]() {
+                    call(_sshWorker, new ExecuteQueryRequest(this, 0, wide));
+                });
+            }
+        }
+        catch (const std::exception &ex) {
+            std::cerr << "Perf harness failed: " << ex.what() << std::endl;
+            return 2;
+        }
+
+        if (!_options.saveBaseline.isEmpty()) {
+            QSaveFile file(_options.saveBaseline);
+            if (file.open(QIODevice::WriteOnly)) {
+                for (auto const &result : _results)
+                    file.write(QJsonDocument(toJson(result)).toJson(QJsonDocument::Compact) + "\n");
+                file.commit();
+            }
+            else
+                std::cerr << "Cannot write baseline " << _options.saveBaseline.toStdString() << std::endl;
+        }
+
+        return _regressed ? 1 : 0;
+    }
+
+    std::map<std::string, PerfHarness::Result> PerfHarness::loadBaseline(const QString &path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            throw std::runtime_error("Cannot read baseline " + path.toStdString());
+
+        // Histogram of baseline holds its percentiles only, as one sample of each
+        std::map<std::string, Result> results;
+        while (!file.atEnd()) {
+            QJsonObject const obj = QJsonDocument::fromJson(file.readLine()).object();
+            if (obj.isEmpty())
+                continue;
+
+            Result result;
+            result.scenario = obj["scenario"].toString().toStdString();
+            result.latency.record(static_cast<long long>(obj["p50_ms"].toDouble() * 1000));
+            result.latency.record(static_cast<long long>(obj["p99_ms"].toDouble() * 1000));
+            result.documents = obj["documents"].toVariant().toLongLong();
+            double const docsPerSec = obj["docs_per_sec"].toDouble();
+            result.seconds = docsPerSec > 0 ? result.documents * 2 / docsPerSec : 0;
+            results[result.scenario] = result;
+        }
+        return results;
+    }
+
+    bool PerfHarness::regressed(const Result &current, const Result &baseline, double tolerance)
+    {
+        if (current.p50Ms() > baseline.p50Ms() * (1 + tolerance))
+            return true;
+
+        return baseline.docsPerSec() > 0 && current.docsPerSec() < baseline.docsPerSec() * (1 - tolerance);
+    }
+
+    void PerfHarness::startFixture()
+    {
+        if (!_options.host.empty()) {
+            _address = _options.host;
+        }
+        else {
+            if (!_dataDir.isValid())
+                throw std::runtime_error("Cannot create data directory of mongod");
+
+            _address = "127.0.0.1:" + std::to_string(_options.port);
+            _mongod.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+            _mongod.setStandardOutputFile(_dataDir.path() + "/mongod.log");
+            _mongod.start(_options.mongod, { "--port", QString::number(_options.port), "--bind_ip", "127.0.0.1",
+                                             "--dbpath", _dataDir.path() });
+            if (!_mongod.waitForStarted())
+                throw std::runtime_error("Cannot start " + _options.mongod.toStdString());
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        while (!_fixture.connect(mongo::HostAndPort(_address), "robomongo-perf").isOK()) {
+            if (timer.elapsed() > FixtureStartSec * 1000)
+                throw std::runtime_error("mongod is not reachable at " + _address);
+            QThread::msleep(100);
+        }
+    }
+
+    void PerfHarness::stopFixture()
+    {
+        if (_mongod.state() == QProcess::NotRunning)
+            return;
+
+        _mongod.terminate();
+        if (!_mongod.waitForFinished(10000))
+            _mongod.kill();
+    }
+
+    void PerfHarness::loadDatasets()
+    {
+        for (char const *db : { Database, ManyCollectionsDatabase, UsersDatabase, CopyDatabase })
+            _fixture.dropDatabase(db);
+
+        auto const insert = [this](const std::string &collection, int count,
+                                   const std::function<mongo::BSONObj(std::mt19937&, int)> &generate) {
+            std::mt19937 gen(Seed);
+            std::vector<mongo::BSONObj> batch;
+            for (int i = 0; i < count; ++i) {
+                batch.push_back(generate(gen, i));
+                if (static_cast<int>(batch.size()) == InsertBatch || i + 1 == count) {
+                    _fixture.insert(std::string(Database) + "." + collection, batch);
+                    batch.clear();
+                }
+            }
+        };
+
+        insert("wide", WideDocuments, wideDocument);
+        insert("nested", NestedDocuments, nestedDocument);
+        insert("large_array", LargeArrayDocuments, largeArrayDocument);
+
+        for (int i = 0; i < Collections; ++i)
+            _fixture.insert(std::string(ManyCollectionsDatabase) + ".c" + std::to_string(i), BSON("_id" << 1));
+
+        for (int i = 0; i < Users; ++i) {
+            mongo::BSONObj result;
+            _fixture.runCommand(UsersDatabase,
+                BSON("createUser" << "user" + std::to_string(i) << "pwd" << "perf" <<
+                     "roles" << BSON_ARRAY(BSON("role" << "read" << "db" << UsersDatabase))), result);
+        }
+    }
+
+    MongoWorker *PerfHarness::createWorker(ConnectionSettings *settings)
+    {
+        // Defaults of SettingsManager, so that runs compare regardless of user settings
+        return new MongoWorker(settings, false, 50, 10, 15, 512, 0, 1);
+    }
+
+    void PerfHarness::call(QObject *worker, Event *request)
+    {
+        _pending = true;
+        _error.clear();
+        _documents = 0;
+        _lastDocuments.clear();
+        _bus->send(worker, request);
+
+        // Timer wakes the loop up, when there is no response
+        QEventLoop loop;
+        QTimer timeout;
+        timeout.setSingleShot(true);
+        timeout.start(CallTimeoutMs);
+        while (_pending && timeout.isActive())
+            loop.processEvents(QEventLoop::WaitForMoreEvents);
+
+        if (_pending) {
+            _pending = false;
+            throw std::runtime_error("Request timed out");
+        }
+        if (!_error.empty())
+            throw std::runtime_error(_error);
+    }
+
+    void PerfHarness::respond(Event *event)
+    {
+        if (event->isError())
+            _error = event->error().errorMessage();
+        _pending = false;
+    }
+
+    void PerfHarness::scenario(const std::string &name, const std::function<void()> &prepare,
+                               const std::function<void()> &body)
+    {
+        if (prepare)
+            prepare();
+        body();     // warm up
+
+        Result result;
+        result.scenario = name;
+        QElapsedTimer total;
+        total.start();
+        for (int i = 0; i < _options.iterations; ++i) {
+            if (prepare)
+                prepare();
+
+            QElapsedTimer timer;
+            timer.start();
+            body();
+            result.latency.record(timer.nsecsElapsed() / 1000);
+            result.seconds += timer.nsecsElapsed() / 1e9;
+        }
+        result.documents = _documents;
+
+        report(result);
+        _results.push_back(result);
+    }
+
+    void PerfHarness::report(const Result &result)
+    {
+        QJsonObject obj = toJson(result);
+
+        auto const base = _baseline.find(result.scenario);
+        if (base != _baseline.end()) {
+            bool const slower = regressed(result, base->second, _options.tolerance);
+            obj["baseline_p50_ms"] = base->second.p50Ms();
+            obj["baseline_docs_per_sec"] = base->second.docsPerSec();
+            obj["regressed"] = slower;
+            if (slower) {
+                _regressed = true;
+                std::cerr << "Regression in " << result.scenario << std::endl;
+            }
+        }
+
+        std::cout << QJsonDocument(obj).toJson(QJsonDocument::Compact).toStdString() << std::endl;
+    }
+
+    void PerfHarness::handle(EstablishConnectionResponse *event)
+    {
+        respond(event);
+    }
+
+    void PerfHarness::handle(LoadDatabaseNamesResponse *event)
+    {
+        _documents = event->databaseNames.size();
+        respond(event);
+    }
+
+    void PerfHarness::handle(LoadCollectionNamesResponse *event)
+    {
+        _documents += event->collectionInfos().size();
+        if (event->isError() || event->isLastBatch())
+            respond(event);
+    }
+
+    void PerfHarness::handle(LoadUsersResponse *event)
+    {
+        _documents = event->users().size();
+        respond(event);
+    }
+
+    void PerfHarness::handle(ExecuteQueryResponse *event)
+    {
+        _documents += event->documents.size();
+        _lastDocuments.insert(_lastDocuments.end(), event->documents.begin(), event->documents.end());
+        if (event->isError() || event->lastBatch)
+            respond(event);
+    }
+
+    void PerfHarness::handle(ExecuteScriptResponse *event)
+    {
+        if (!event->isError()) {
+            for (auto const &result : event->result.results())
+                _documents += result.documents().size();
+            if (event->result.error())
+                _error = event->result.errorMessage();
+        }
+        respond(event);
+    }
+
+    void PerfHarness::handle(ExportProgressEvent *)
+    {
+    }
+
+    void PerfHarness::handle(ExportDocumentsResponse *event)
+    {
+        _documents = event->documents;
+        respond(event);
+    }
+
+    void PerfHarness::handle(CopyCollectionProgressEvent *)
+    {
+    }
+
+    void PerfHarness::handle(CopyCollectionToDiffServerResponse *event)
+    {
+        _documents = event->copied;
+        respond(event);
+    }
+
+    void PerfHarness::handle(EstablishSshConnectionResponse *event)
+    {
+        _tunnelPort = event->localport;
+        respond(event);
+    }
+
+    void PerfHarness::handle(ListenSshConnectionResponse *event)
+    {
+        // Tunnel is listened to, until it fails
+        if (event->isError())
+            std::cerr << "SSH tunnel closed: " << event->error().errorMessage() << std::endl;
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <QObject>
+#include <QProcess>
+#include <QTemporaryDir>
+
+#include <mongo/client/dbclient_connection.h>
+
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/LatencyHistogram.h"
+
+namespace Robomongo
+{
+    class ConnectionSettings;
+    class EventBus;
+    class MongoWorker;
+    class SshTunnelWorker;
+
+    /**
+     * @brief End-to-end performance scenarios against a local mongod, see app/main_perf.cpp.
+     *        Requests go through EventBus to real MongoWorkers (and SSH tunnel, when asked
+     *        for), as GUI sends them; responses are awaited in nested event loop.
+     *
+     *        Every scenario is reported as one JSON line with p50/p99 latency and throughput,
+     *        and is compared against baseline, if any. Used in GUI thread only.
+     */
+    class PerfHarness : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        struct Options
+        {
+            QString mongod = "mongod";      // binary of fixture, started on 'port'
+            std::string host;               // use running mongod, "host:port"; no fixture
+            int port = 27999;
+            int iterations = 10;
+            QString baseline;               // JSON lines of earlier run, to compare with
+            QString saveBaseline;           // write results as new baseline
+            double tolerance = 0.2;         // allowed slowdown of p50 and throughput
+            std::string sshHost;            // loopback sshd for tunnel scenario, optional
+            int sshPort = 22;
+            std::string sshUser;
+            std::string sshKey;             // private key file
+        };
+
+        struct Result
+        {
+            std::string scenario;           // i.e. "query/wide"
+            LatencyHistogram latency;
+            long long documents = 0;        // per iteration
+            double seconds = 0;             // of all iterations
+
+            double p50Ms() const { return latency.percentileUs(50) / 1000.0; }
+            double p99Ms() const { return latency.percentileUs(99) / 1000.0; }
+            double docsPerSec() const { return seconds > 0 ? documents * latency.count() / seconds : 0; }
+        };
+
+        explicit PerfHarness(const Options &options);
+        ~PerfHarness();
+
+        /**
+         * @return 0 if all scenarios ran and none regressed, 1 on regression, 2 on failure
+         */
+        int run();
+
+        // Reads results of earlier run, by scenario
+        static std::map<std::string, Result> loadBaseline(const QString &path);
+
+        /**
+         * @return true, if 'current' is slower than 'baseline' by more than 'tolerance'
+         *         in p50 latency or throughput
+         */
+        static bool regressed(const Result &current, const Result &baseline, double tolerance);
+
+    protected Q_SLOTS:
+        void handle(EstablishConnectionResponse *event);
+        void handle(LoadDatabaseNamesResponse *event);
+        void handle(LoadCollectionNamesResponse *event);
+        void handle(LoadUsersResponse *event);
+        void handle(ExecuteQueryResponse *event);
+        void handle(ExecuteScriptResponse *event);
+        void handle(ExportProgressEvent *event);
+        void handle(ExportDocumentsResponse *event);
+        void handle(CopyCollectionProgressEvent *event);
+        void handle(CopyCollectionToDiffServerResponse *event);
+        void handle(EstablishSshConnectionResponse *event);
+        void handle(ListenSshConnectionResponse *event);
+
+    private:
+        void startFixture();
+        void stopFixture();
+        void loadDatasets();
+
+        MongoWorker *createWorker(ConnectionSettings *settings);
+
+        // Sends request to worker and waits for its (last) response
+        // @throws std::runtime_error, if response is error or timeout is reached
+        void call(QObject *worker, Event *request);
+        void respond(Event *event);
+
+        void scenario(const std::string &name, const std::function<void()> &prepare,
+                      const std::function<void()> &body);
+        void report(const Result &result);
+
+        static const int CallTimeoutMs = 300 * 1000;
+
+        Options const _options;
+        EventBus *_bus;
+        std::string _address;                       // "127.0.0.1:port" of mongod
+        QProcess _mongod;
+        QTemporaryDir _dataDir;
+        mongo::DBClientConnection _fixture;         // loads datasets, drops copies
+
+        std::unique_ptr<ConnectionSettings> _settings;
+        MongoWorker *_worker;
+        MongoWorker *_sshWorker;
+        SshTunnelWorker *_tunnel;
+        int _tunnelPort;
+
+        bool _pending;
+        std::string _error;
+        long long _documents;                       // of last call
+        std::vector<MongoDocumentPtr> _lastDocuments;
+
+        std::map<std::string, Result> _baseline;
+        std::vector<Result> _results;
+        bool _regressed;
+    };
+}
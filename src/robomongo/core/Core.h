@@ -31,6 +31,12 @@ namespace Robomongo
     class MongoDocument;
     typedef boost::shared_ptr<MongoDocument> MongoDocumentPtr;
 
+    class BsonSegmentFile;
+    typedef boost::shared_ptr<BsonSegmentFile> BsonSegmentFilePtr;
+
+    class BsonDumpFile;
+    typedef boost::shared_ptr<BsonDumpFile> BsonDumpFilePtr;
+
     // todo: Use enum class
     enum ConnectionType {
         // This type of connection is shown in Explorer and also opens SSH tunnel for secondary 
@@ -5,6 +5,8 @@ namespace
 {
     const char *viewModeAsoc[Robomongo::Custom+1] = {"Text mode", "Tree mode", "Table mode", "Custom mode"};
     const char *timesAsoc[Robomongo::LocalTime+1] = {"UTC", "Local Timezone"};
+    const char *jsonOutputModeAsoc[Robomongo::CompactJson+1] = {"Shell Syntax", "Relaxed Extended JSON",
+                                                                "Compact Extended JSON (Single Line)"};
     const char *uuidAsoc[Robomongo::PythonLegacy+1] = {"Default encoding", "Java encoding", "CSharp encoding", "Python encoding"};
 
     template<typename type, int size>
@@ -52,5 +54,10 @@ namespace Robomongo
     {
         return findTypeInArray<ViewMode>(viewModeAsoc, text);
     }
+
+    const char *convertJsonOutputModeToString(JsonOutputMode mode)
+    {
+        return jsonOutputModeAsoc[mode];
+    }
 }
 
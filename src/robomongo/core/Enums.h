@@ -24,6 +24,14 @@ namespace Robomongo
         Custom = 3
     };
 
+    // Presets of text view, copied and exported JSON
+    enum JsonOutputMode
+    {
+        ShellJson   = 0,    // pretty, shell syntax: ObjectId(...), ISODate(...), NumberLong(...)
+        RelaxedJson = 1,    // pretty, relaxed Extended JSON v2
+        CompactJson = 2     // relaxed Extended JSON v2, document per line
+    };
+
     enum AutocompletionMode
     {
         AutocompleteNone = 0,
@@ -39,5 +47,7 @@ namespace Robomongo
 
     const char *convertViewModeToString(ViewMode mode);
     ViewMode convertStringToViewMode(const char *text);
+
+    const char *convertJsonOutputModeToString(JsonOutputMode mode);
 }
 
@@ -4,11 +4,21 @@
 #include <QString>
 #include <QEvent>
 #include <QMetaType>
+#include <memory>
+#include <string>
 
 #include "robomongo/core/EventError.h"
 
 namespace Robomongo
 {
+    class EventTrace;
+
+    /**
+     * @brief Pending events of one thread are delivered in order of priority:
+     *        user-initiated requests first, background work last.
+     */
+    enum class EventPriority { Background, Explorer, Interactive };
+
     /**
      * @brief Abstract base class for all events in Robomongo.
      */
@@ -48,6 +58,23 @@ namespace Robomongo
          */
         QObject *sender() const { return _sender; }
 
+        /**
+         * @brief Priority of this event in queue of receiver's thread.
+         */
+        virtual EventPriority priority() const { return EventPriority::Explorer; }
+
+        /**
+         * @brief If not empty, EventBus drops this event when an event of the same type, 
+         *        sender, receivers and key is still waiting in the queue of receiver's thread.
+         */
+        virtual std::string coalescingKey() const { return std::string(); }
+
+        /**
+         * @brief High-frequency events (i.e. log messages) could be delivered to other thread
+         *        in batches, about once per frame, instead of waking it up for every event.
+         */
+        virtual bool isBatched() const { return false; }
+
         /**
          * @brief Tests whether this event is "error-event".
          */
@@ -58,6 +85,12 @@ namespace Robomongo
          */
         const EventError &error() const { return _error; }
 
+        /**
+         * @brief Latency trace this event belongs to (see EventTrace), may be nullptr
+         */
+        const std::shared_ptr<EventTrace> &trace() const { return _trace; }
+        void setTrace(const std::shared_ptr<EventTrace> &trace) { _trace = trace; }
+
     private:
         /**
          * @brief Sender that emits this event.
@@ -68,6 +101,8 @@ namespace Robomongo
          * @brief Possible error.
          */
         const EventError _error;
+
+        std::shared_ptr<EventTrace> _trace;
     };
 }
 
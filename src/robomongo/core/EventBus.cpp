@@ -1,14 +1,19 @@
 #include "robomongo/core/EventBus.h"
 
+#include <algorithm>
+
 #include <QObject>
 #include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QThread>
-#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
 
 #include "robomongo/core/EventBusDispatcher.h"
 #include "robomongo/core/EventBusSubscriber.h"
 #include "robomongo/core/Event.h"
 #include "robomongo/core/EventWrapper.h"
+#include "robomongo/core/EventTrace.h"
 #include "robomongo/core/utils/QtUtils.h"
 
 namespace
@@ -17,9 +22,9 @@ namespace
     {
         RemoveIfReciver(QObject *receiver) : _receiver(receiver) {}
 
-        bool operator()(const Robomongo::EventBus::EventTypeAndSubscriber& item) const {
-            if (item.second->receiver == _receiver) {
-                delete item.second;
+        bool operator()(Robomongo::EventBusSubscriber *subscriber) const {
+            if (subscriber->receiver == _receiver) {
+                delete subscriber;
                 return true;
             }
             return false;
@@ -27,86 +32,84 @@ namespace
 
         QObject *_receiver;
     };
-
-    struct FindIfReciver
-    {
-        FindIfReciver(QThread *thread) : _thread(thread) {}
-        bool operator()(const Robomongo::EventBus::ThreadAndDispatcher &item) const {
-            if (item.first == _thread) 
-                return true;
-            
-            return false;
-        }
-        QThread *_thread;
-    };
 }
 
 namespace Robomongo
 {
     EventBus::EventBus() : QObject(),
-        _lock(QMutex::Recursive)
+        _publishCount(0),
+        _publishNanoseconds(0)
     {
     }
 
     EventBus::~EventBus()
     {
-        for (auto const& dispatchersByThread : _dispatchersByThread)
-            delete dispatchersByThread.second;
+        for (auto const& subscribers : _subscribersByEventType)
+            qDeleteAll(subscribers);
+
+        qDeleteAll(_dispatchersByThread);
     }
 
     void EventBus::publish(Event *event)
     {
-        QMutexLocker lock(&_lock);
+        QElapsedTimer timer;
+        timer.start();
+
         QList<QObject*> theReceivers;
         EventBusDispatcher *dis = nullptr;
-        for (auto const& item : _subscribersByEventType) {            
-            if (event->type() == item.first) {
-                EventBusSubscriber *subscriber = item.second;
-                if (!subscriber->sender || subscriber->sender == event->sender()) {
-                    theReceivers.append(subscriber->receiver);
-
-                    if (dis && dis != subscriber->dispatcher)
-                        throw "You cannot publish events to subscribers from more than one thread.";
-
-                    dis = subscriber->dispatcher;
+        {
+            QReadLocker lock(&_lock);
+            auto const it = _subscribersByEventType.constFind(event->type());
+            if (it != _subscribersByEventType.constEnd()) {
+                for (EventBusSubscriber *subscriber : it.value()) {
+                    if (!subscriber->sender || subscriber->sender == event->sender()) {
+                        theReceivers.append(subscriber->receiver);
+
+                        if (dis && dis != subscriber->dispatcher)
+                            throw "You cannot publish events to subscribers from more than one thread.";
+
+                        dis = subscriber->dispatcher;
+                    }
                 }
             }
         }
 
+        // Delivered without lock, so that handlers of synchronous events can use EventBus
         if (dis)
             sendEvent(dis, new EventWrapper(event, theReceivers));
+        else
+            delete event;
+
+        ++_publishCount;
+        _publishNanoseconds += timer.nsecsElapsed();
     }
 
     void EventBus::send(QObject *receiver, Event *event)
     {
-        QMutexLocker lock(&_lock);
-
         if (!receiver)
             return;
 
         QThread *thread = receiver->thread();
         EventBusDispatcher *dis = dispatcher(thread);
 
+        trace(event);
         sendEvent(dis, new EventWrapper(event, receiver));
     }
 
     void EventBus::send(QList<QObject *> receivers, Event *event)
     {
-        QMutexLocker lock(&_lock);
-
         if (receivers.count() == 0)
             return;
 
         QThread *thread = receivers.last()->thread();
         EventBusDispatcher *dis = dispatcher(thread);
 
+        trace(event);
         sendEvent(dis, new EventWrapper(event, receivers));
     }
 
     void EventBus::subscribe(QObject *receiver, QEvent::Type type, QObject *sender /* = NULL */)
     {
-        QMutexLocker lock(&_lock);
-
         QThread *currentThread = QThread::currentThread();
         EventBusDispatcher *dis = dispatcher(currentThread);
 
@@ -115,14 +118,47 @@ namespace Robomongo
         VERIFY(connect(receiver, SIGNAL(destroyed(QObject*)), this, SLOT(unsubscibe(QObject*))));
 
         // add subscriber
-        _subscribersByEventType.push_back(EventTypeAndSubscriber(type, new EventBusSubscriber(dis, receiver, sender)));
+        QWriteLocker lock(&_lock);
+        _subscribersByEventType[type].push_back(new EventBusSubscriber(dis, receiver, sender));
+    }
+
+    int EventBus::queueDepth(QObject *receiver, EventPriority priority)
+    {
+        return dispatcher(receiver->thread())->queueDepth(priority);
+    }
+
+    EventBus::PublishStats EventBus::publishStats() const
+    {
+        PublishStats stats;
+        stats.count = _publishCount;
+        stats.nanoseconds = _publishNanoseconds;
+        return stats;
     }
 
     void EventBus::unsubscibe(QObject *receiver)
     {
-        QMutexLocker lock(&_lock);
-        _subscribersByEventType.erase(std::remove_if(_subscribersByEventType.begin(), _subscribersByEventType.end(),
-            RemoveIfReciver(receiver)), _subscribersByEventType.end());
+        QWriteLocker lock(&_lock);
+        for (auto it = _subscribersByEventType.begin(); it != _subscribersByEventType.end(); ++it) {
+            Subscribers &subscribers = it.value();
+            subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(), RemoveIfReciver(receiver)),
+                              subscribers.end());
+        }
+    }
+
+    /**
+     * @brief Event joins trace of the event that is being handled by current thread, or 
+     * starts a new trace. Batched (high-frequency) events are not traced.
+     */
+    void EventBus::trace(Event *event)
+    {
+        if (event->isBatched())
+            return;
+
+        if (!event->trace()) {
+            std::shared_ptr<EventTrace> trace = EventTrace::current();
+            event->setTrace(trace ? trace : EventTraceRecorder::instance().startTrace(event->typeString()));
+        }
+        event->trace()->mark(std::string("send ") + event->typeString());
     }
 
     /**
@@ -131,34 +167,52 @@ namespace Robomongo
      */
     EventBusDispatcher *EventBus::dispatcher(QThread *thread)
     {
-        auto const& disIt = std::find_if(
-            _dispatchersByThread.begin(), _dispatchersByThread.end(), FindIfReciver(thread)
-        );
-       
-        if (disIt != _dispatchersByThread.end()) {
-            return (*disIt).second;
+        {
+            QReadLocker lock(&_lock);
+            if (EventBusDispatcher *dis = _dispatchersByThread.value(thread))
+                return dis;
         }
-        else {
-            EventBusDispatcher *dis = new EventBusDispatcher();
+
+        QWriteLocker lock(&_lock);
+        EventBusDispatcher *&dis = _dispatchersByThread[thread];
+        if (!dis) {
+            dis = new EventBusDispatcher();
             dis->moveToThread(thread);
-            _dispatchersByThread.push_back(ThreadAndDispatcher(thread, dis));
-            return dis;
-        }        
+        }
+        return dis;
     }
 
     /**
      * @brief Sends event synchronousely, if current thread and dispatcher thread are
      * the same. Sends asynchronousely, if this is cross-thread communication;
+     * pending events are delivered in order of Event::priority().
      */
     void EventBus::sendEvent(EventBusDispatcher *dispatcher, EventWrapper *wrapper)
     {
         if (dispatcher->thread() == QThread::currentThread()) {
             QCoreApplication::sendEvent(dispatcher, wrapper);
             delete wrapper;
+            return;
+        }
+
+        if (wrapper->event()->isBatched()) {
+            dispatcher->appendToBatch(wrapper);
+            return;
+        }
+
+        // The same request is still waiting, it will answer to the same sender
+        if (!dispatcher->enqueue(wrapper)) {
+            delete wrapper;
+            return;
         }
-        else {
-            QCoreApplication::postEvent(dispatcher, wrapper);
+
+        int qtPriority = Qt::NormalEventPriority;
+        switch (wrapper->event()->priority()) {
+            case EventPriority::Interactive: qtPriority = Qt::HighEventPriority; break;
+            case EventPriority::Background:  qtPriority = Qt::LowEventPriority; break;
+            default: break;
         }
+        QCoreApplication::postEvent(dispatcher, wrapper, qtPriority);
     }
 
 }
@@ -2,12 +2,15 @@
 
 #include <QObject>
 #include <QEvent>
-#include <QMutex>
+#include <QHash>
+#include <QReadWriteLock>
+#include <atomic>
 #include <vector>
 
+#include "robomongo/core/Event.h"
+
 namespace Robomongo
 {
-    class Event;
     class EventWrapper;
     class EventBusDispatcher;
     struct EventBusSubscriber;
@@ -21,8 +24,16 @@ namespace Robomongo
         Q_OBJECT
 
     public:
-        typedef std::pair<QEvent::Type, EventBusSubscriber *> EventTypeAndSubscriber;
-        typedef std::pair<QThread *, EventBusDispatcher *> ThreadAndDispatcher;
+        typedef std::vector<EventBusSubscriber *> Subscribers;
+
+        /**
+         * @brief Number of published events and total time spent in publish() for them
+         */
+        struct PublishStats
+        {
+            long long count;
+            long long nanoseconds;
+        };
 
         EventBus();
         ~EventBus();
@@ -49,6 +60,14 @@ namespace Robomongo
          */
         void subscribe(QObject *receiver, QEvent::Type type, QObject *sender = NULL);
 
+        /**
+         * @brief Number of events of specified priority, waiting in queue of the 
+         *        thread of 'receiver' (i.e. lane of MongoWorker).
+         */
+        int queueDepth(QObject *receiver, EventPriority priority);
+
+        PublishStats publishStats() const;
+
     public Q_SLOTS:
         void unsubscibe(QObject *receiver);
 
@@ -61,10 +80,15 @@ namespace Robomongo
         EventBusDispatcher *dispatcher(QThread *thread);
 
         void sendEvent(EventBusDispatcher *dispatcher, EventWrapper *wrapper);
+        void trace(Event *event);
 
     private:
-        QMutex _lock;
-        std::vector<EventTypeAndSubscriber> _subscribersByEventType;
-        std::vector<ThreadAndDispatcher> _dispatchersByThread;
+        // Subscribers and dispatchers are rarely changed, but read for every event
+        QReadWriteLock _lock;
+        QHash<QEvent::Type, Subscribers> _subscribersByEventType;
+        QHash<QThread *, EventBusDispatcher *> _dispatchersByThread;
+
+        std::atomic<long long> _publishCount;
+        std::atomic<long long> _publishNanoseconds;
     };
 }
@@ -1,13 +1,93 @@
 #include "robomongo/core/EventBusDispatcher.h"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimer>
+
 #include "robomongo/core/EventWrapper.h"
+#include "robomongo/core/EventTrace.h"
+#include "robomongo/core/utils/AllocationStats.h"
+#include "robomongo/core/utils/GuiStallMonitor.h"
+#include "robomongo/core/utils/ThreadPriority.h"
 
 namespace Robomongo
 {
 
     EventBusDispatcher::EventBusDispatcher(QObject *parent) :
-        QObject(parent)
+        QObject(parent),
+        _queueDepth()
+    {
+
+    }
+
+    EventBusDispatcher::~EventBusDispatcher()
+    {
+        qDeleteAll(_batch);
+    }
+
+    bool EventBusDispatcher::enqueue(EventWrapper *wrapper)
+    {
+        QMutexLocker lock(&_queueLock);
+
+        std::string const key = wrapper->queueKey();
+        if (!key.empty() && !_pendingKeys.insert(key).second)
+            return false;
+
+        ++_queueDepth[static_cast<int>(wrapper->event()->priority())];
+        wrapper->setQueued(true);
+        return true;
+    }
+
+    void EventBusDispatcher::dequeue(EventWrapper *wrapper)
+    {
+        QMutexLocker lock(&_queueLock);
+
+        std::string const key = wrapper->queueKey();
+        if (!key.empty())
+            _pendingKeys.erase(key);
+
+        --_queueDepth[static_cast<int>(wrapper->event()->priority())];
+        wrapper->setQueued(false);
+    }
+
+    int EventBusDispatcher::queueDepth(EventPriority priority) const
+    {
+        QMutexLocker lock(&_queueLock);
+        return _queueDepth[static_cast<int>(priority)];
+    }
+
+    void EventBusDispatcher::appendToBatch(EventWrapper *wrapper)
     {
+        bool isFirst = false;
+        {
+            QMutexLocker lock(&_queueLock);
+            isFirst = _batch.empty();
+            _batch.push_back(wrapper);
+        }
+
+        // Timer should be started in thread of this dispatcher
+        if (isFirst)
+            QMetaObject::invokeMethod(this, "scheduleBatch", Qt::QueuedConnection);
+    }
+
+    void EventBusDispatcher::scheduleBatch()
+    {
+        QTimer::singleShot(BatchIntervalMsec, this, SLOT(deliverBatch()));
+    }
+
+    void EventBusDispatcher::deliverBatch()
+    {
+        std::vector<EventWrapper *> batch;
+        {
+            QMutexLocker lock(&_queueLock);
+            batch.swap(_batch);
+        }
 
+        for (EventWrapper *wrapper : batch) {
+            dispatch(wrapper);
+            delete wrapper;
+        }
     }
 
     bool EventBusDispatcher::event(QEvent *qevent)
@@ -15,16 +95,46 @@ namespace Robomongo
         EventWrapper *wrapper = dynamic_cast<EventWrapper *>(qevent);
 
         if (!wrapper)
-            return false;
+            return QObject::event(qevent);
+
+        // Removed from queue before handling, so that events sent by handlers are not coalesced
+        if (wrapper->isQueued())
+            dequeue(wrapper);
+
+        dispatch(wrapper);
+        return true;
+    }
 
+    void EventBusDispatcher::dispatch(EventWrapper *wrapper)
+    {
         Event *event = wrapper->event();
 
         const char *typeName = event->typeString();
+        const std::shared_ptr<EventTrace> &trace = event->trace();
+        if (trace)
+            trace->mark(std::string("deliver ") + typeName);
+
+        // Events sent by handlers join the trace of this event (or of the outer one, 
+        // when untraced event is published synchronously from traced handler)
+        EventTrace::Scope traceScope(trace ? trace : EventTrace::current());
+        AllocationStats::Scope allocationScope(typeName);
+        GuiStallMonitor::Scope stallScope(typeName);
+
+        // Worker thread handles background requests (prefetch, stats, sampling) with lower
+        // OS priority. GUI thread keeps its own, it is not lowered by background responses
+        bool const isGuiThread = thread() == QCoreApplication::instance()->thread();
+        ThreadPriority::Class priorityClass = ThreadPriority::current();
+        if (!isGuiThread)
+            priorityClass = event->priority() == EventPriority::Background ?
+                            ThreadPriority::Background : ThreadPriority::Normal;
+        ThreadPriority::Scope priorityScope(priorityClass);
+
         const QList<QObject*> &recivers = wrapper->receivers();
         for (QList<QObject*>::const_iterator it = recivers.begin(); it != recivers.end(); ++it) {
             QMetaObject::invokeMethod(*it, "handle", QGenericArgument(typeName, &event));
         }
 
-        return true;
+        if (trace)
+            trace->mark(std::string("handle ") + typeName);
     }
 }
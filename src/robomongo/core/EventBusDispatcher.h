@@ -1,8 +1,15 @@
 #pragma once
 #include <QObject>
+#include <QMutex>
+#include <unordered_set>
+#include <vector>
+
+#include "robomongo/core/Event.h"
 
 namespace Robomongo
 {
+    class EventWrapper;
+
     /**
      * @brief The EventBusDispatcher class
      */
@@ -11,7 +18,48 @@ namespace Robomongo
         Q_OBJECT
     public:
         EventBusDispatcher(QObject *parent = 0);
+        ~EventBusDispatcher();
+
+        /**
+         * @brief Interval of delivery of batched events (see Event::isBatched())
+         */
+        static const int BatchIntervalMsec = 16;
+
+        /**
+         * @brief Registers 'wrapper' as pending in the queue of this dispatcher.
+         * @return false, if the same coalescible event is already pending and 'wrapper'
+         *         should be dropped.
+         * @threadsafe
+         */
+        bool enqueue(EventWrapper *wrapper);
+
+        /**
+         * @brief Number of events of specified priority, waiting to be delivered. 
+         * @threadsafe
+         */
+        int queueDepth(EventPriority priority) const;
+
+        /**
+         * @brief Adds 'wrapper' to events that are delivered together, in BatchIntervalMsec
+         *        after the first of them. Dispatcher takes ownership of 'wrapper'.
+         * @threadsafe
+         */
+        void appendToBatch(EventWrapper *wrapper);
+
     protected:
         virtual bool event(QEvent *qevent);
+
+    private Q_SLOTS:
+        void scheduleBatch();
+        void deliverBatch();
+
+    private:
+        void dequeue(EventWrapper *wrapper);
+        void dispatch(EventWrapper *wrapper);
+
+        mutable QMutex _queueLock;
+        int _queueDepth[3];
+        std::unordered_set<std::string> _pendingKeys;
+        std::vector<EventWrapper *> _batch;
     };
 }
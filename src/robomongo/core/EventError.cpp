@@ -32,4 +32,11 @@ namespace Robomongo
         return _errorMessage;
     }
 
+    bool EventError::isServerTimeLimitExceeded(const std::string &errorMessage)
+    {
+        // Errors reach us as text of driver and shell exceptions, code 50 is not kept
+        return errorMessage.find("MaxTimeMSExpired") != std::string::npos ||
+               errorMessage.find("operation exceeded time limit") != std::string::npos;
+    }
+
 }
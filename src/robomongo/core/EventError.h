@@ -53,6 +53,13 @@ namespace Robomongo
         ReplicaSet replicaSetInfo() const { return _replicaSetInfo; }
         bool showErrorWindow() const { return _showErrorWindow; }
 
+        /**
+         * @brief Tests whether server stopped operation because of its maxTimeMS
+         *        (MaxTimeMSExpired error), i.e. time limit of query tab was reached
+         */
+        bool isServerTimeLimitExceeded() const { return isServerTimeLimitExceeded(_errorMessage); }
+        static bool isServerTimeLimitExceeded(const std::string &errorMessage);
+
     private:
         /**
          * @brief Error message
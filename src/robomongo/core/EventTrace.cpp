@@ -0,0 +1,141 @@
+#include "robomongo/core/EventTrace.h"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <map>
+#include <sstream>
+
+namespace
+{
+    thread_local std::shared_ptr<Robomongo::EventTrace> currentTrace;
+
+    std::string currentThreadName()
+    {
+        QThread *thread = QThread::currentThread();
+        QCoreApplication *app = QCoreApplication::instance();
+        if (app && app->thread() == thread)
+            return "GUI";
+
+        if (!thread->objectName().isEmpty())
+            return thread->objectName().toStdString();
+
+        std::ostringstream name;
+        name << "Thread " << static_cast<const void *>(thread);
+        return name.str();
+    }
+}
+
+namespace Robomongo
+{
+    EventTrace::EventTrace(int id, const std::string &name) :
+        _id(id), _name(name) {}
+
+    void EventTrace::mark(const std::string &label)
+    {
+        Mark mark { label, EventTraceRecorder::instance().elapsedUs(), currentThreadName() };
+
+        QMutexLocker lock(&_mutex);
+        _marks.push_back(mark);
+    }
+
+    std::vector<EventTrace::Mark> EventTrace::marks() const
+    {
+        QMutexLocker lock(&_mutex);
+        return _marks;
+    }
+
+    std::shared_ptr<EventTrace> EventTrace::current()
+    {
+        return currentTrace;
+    }
+
+    void EventTrace::markCurrent(const std::string &label)
+    {
+        if (currentTrace)
+            currentTrace->mark(label);
+    }
+
+    EventTrace::Scope::Scope(const std::shared_ptr<EventTrace> &trace) :
+        _previous(currentTrace)
+    {
+        currentTrace = trace;
+    }
+
+    EventTrace::Scope::~Scope()
+    {
+        currentTrace = _previous;
+    }
+
+    EventTraceRecorder::EventTraceRecorder() :
+        _start(std::chrono::steady_clock::now()),
+        _nextId(1) {}
+
+    std::shared_ptr<EventTrace> EventTraceRecorder::startTrace(const std::string &name)
+    {
+        QMutexLocker lock(&_mutex);
+        auto trace = std::make_shared<EventTrace>(_nextId++, name);
+        _traces.push_back(trace);
+        if (static_cast<int>(_traces.size()) > MaxTraces)
+            _traces.pop_front();
+        return trace;
+    }
+
+    std::vector<std::shared_ptr<EventTrace>> EventTraceRecorder::traces() const
+    {
+        QMutexLocker lock(&_mutex);
+        return std::vector<std::shared_ptr<EventTrace>>(_traces.begin(), _traces.end());
+    }
+
+    void EventTraceRecorder::clear()
+    {
+        QMutexLocker lock(&_mutex);
+        _traces.clear();
+    }
+
+    long long EventTraceRecorder::elapsedUs() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - _start).count();
+    }
+
+    QByteArray EventTraceRecorder::toChromeTraceJson() const
+    {
+        QJsonArray events;
+        std::map<std::string, int> threadIds;
+        auto threadId = [&](const std::string &threadName) {
+            auto const it = threadIds.find(threadName);
+            if (it != threadIds.end())
+                return it->second;
+
+            int const tid = static_cast<int>(threadIds.size()) + 1;
+            threadIds[threadName] = tid;
+            events.append(QJsonObject {
+                { "name", "thread_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", tid },
+                { "args", QJsonObject { { "name", QString::fromStdString(threadName) } } }
+            });
+            return tid;
+        };
+
+        for (auto const& trace : traces()) {
+            std::vector<EventTrace::Mark> const marks = trace->marks();
+            for (size_t i = 1; i < marks.size(); ++i) {
+                events.append(QJsonObject {
+                    { "name", QString::fromStdString(marks[i].label) },
+                    { "cat", QString::fromStdString(trace->name()) },
+                    { "ph", "X" },
+                    { "ts", static_cast<double>(marks[i - 1].timestampUs) },
+                    { "dur", static_cast<double>(marks[i].timestampUs - marks[i - 1].timestampUs) },
+                    { "pid", 1 },
+                    { "tid", threadId(marks[i].threadName) },
+                    { "args", QJsonObject { { "trace", trace->id() } } }
+                });
+            }
+        }
+
+        return QJsonDocument(QJsonObject { { "traceEvents", events } }).toJson(QJsonDocument::Compact);
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QByteArray>
+#include <QMutex>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "robomongo/core/utils/SingletonPattern.hpp"
+
+namespace Robomongo
+{
+    /**
+     * @brief Timeline of one user action: request sent by GUI, its delivery to worker thread,
+     *        driver round trips, response and building of views.
+     *
+     *        Trace is started by EventBus::send() for event without trace. Events sent while
+     *        a traced event is handled join its trace (see EventBusDispatcher::dispatch()),
+     *        so that response of worker and all follow-up requests are on the same timeline.
+     * @threadsafe
+     */
+    class EventTrace
+    {
+    public:
+        struct Mark
+        {
+            std::string label;          // i.e. "deliver ExecuteQueryRequest*"
+            long long timestampUs;      // since start of EventTraceRecorder
+            std::string threadName;
+        };
+
+        EventTrace(int id, const std::string &name);
+
+        int id() const { return _id; }
+        const std::string &name() const { return _name; }
+
+        void mark(const std::string &label);
+        std::vector<Mark> marks() const;
+
+        /**
+         * @brief Trace of event that is being handled by current thread, or nullptr
+         */
+        static std::shared_ptr<EventTrace> current();
+
+        /**
+         * @brief Marks trace of current thread, if any. Use it for stages inside of
+         *        handlers, i.e. completion of driver call or of model build.
+         */
+        static void markCurrent(const std::string &label);
+
+        /**
+         * @brief Makes 'trace' current for this thread during lifetime of Scope
+         */
+        class Scope
+        {
+        public:
+            explicit Scope(const std::shared_ptr<EventTrace> &trace);
+            ~Scope();
+
+        private:
+            std::shared_ptr<EventTrace> _previous;
+        };
+
+    private:
+        const int _id;
+        const std::string _name;
+        mutable QMutex _mutex;
+        std::vector<Mark> _marks;
+    };
+
+    /**
+     * @brief Keeps MaxTraces most recent traces, see "Performance" panel
+     * @threadsafe
+     */
+    class EventTraceRecorder : public Patterns::LazySingleton<EventTraceRecorder>
+    {
+        friend class Patterns::LazySingleton<EventTraceRecorder>;
+
+    public:
+        static const int MaxTraces = 500;
+
+        std::shared_ptr<EventTrace> startTrace(const std::string &name);
+        std::vector<std::shared_ptr<EventTrace>> traces() const;
+        void clear();
+
+        long long elapsedUs() const;
+
+        /**
+         * @brief Traces in Chrome trace event format, can be opened in chrome://tracing or
+         *        Perfetto. Every stage is a span from previous mark to its own mark.
+         */
+        QByteArray toChromeTraceJson() const;
+
+    private:
+        EventTraceRecorder();
+
+        const std::chrono::steady_clock::time_point _start;
+        mutable QMutex _mutex;
+        std::deque<std::shared_ptr<EventTrace>> _traces;
+        int _nextId;
+    };
+}
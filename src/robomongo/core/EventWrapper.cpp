@@ -1,11 +1,14 @@
 #include "robomongo/core/EventWrapper.h"
+
+#include <sstream>
+
 namespace Robomongo
 {
     EventWrapper::EventWrapper(Event *event, QList<QObject *> receivers) 
-        : QEvent(event->type()), _event(event), _receivers(receivers) {}
+        : QEvent(event->type()), _event(event), _receivers(receivers), _isQueued(false) {}
 
     EventWrapper::EventWrapper(Event *event, QObject * receiver)
-        : QEvent(event->type()), _event(event), _receivers(QList<QObject *>() << receiver ) {}
+        : QEvent(event->type()), _event(event), _receivers(QList<QObject *>() << receiver ), _isQueued(false) {}
 
     Event *EventWrapper::event() const 
     {
@@ -16,4 +19,18 @@ namespace Robomongo
     {
         return _receivers;
     }
+
+    std::string EventWrapper::queueKey() const
+    {
+        std::string const key = _event->coalescingKey();
+        if (key.empty())
+            return key;
+
+        std::ostringstream stream;
+        stream << _event->type() << ':' << _event->sender();
+        for (auto const receiver : _receivers)
+            stream << ':' << receiver;
+        stream << ':' << key;
+        return stream.str();
+    }
 }
@@ -12,8 +12,20 @@ namespace Robomongo
         Event *event() const;
         const QList<QObject *> &receivers() const;
 
+        /**
+         * @brief Key of this event in queue of EventBusDispatcher (see Event::coalescingKey())
+         */
+        std::string queueKey() const;
+
+        /**
+         * @brief True, if this event was posted to queue of dispatcher (not sent synchronously)
+         */
+        bool isQueued() const { return _isQueued; }
+        void setQueued(bool queued) { _isQueued = queued; }
+
     private:
         const boost::scoped_ptr<Event> _event;
         const QList<QObject *> _receivers;
+        bool _isQueued;
     };
 }
@@ -1,157 +1,302 @@
 #include "robomongo/core/HexUtils.h"
 
-#include <mongo/util/hex.h>
-#include <pcrecpp.h>
-#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ROBOMONGO_HEX_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define ROBOMONGO_HEX_NEON 1
+#endif
 
 namespace Robomongo
 {
     namespace HexUtils
     {
+        namespace
+        {
+            const char hexDigits[] = "0123456789abcdef";
+
+            // Value of hex digit, 0xFF for other characters
+            struct HexValues
+            {
+                unsigned char values[256];
+
+                HexValues()
+                {
+                    std::memset(values, 0xFF, sizeof(values));
+                    for (int i = 0; i < 10; ++i)
+                        values['0' + i] = static_cast<unsigned char>(i);
+                    for (int i = 0; i < 6; ++i) {
+                        values['a' + i] = static_cast<unsigned char>(10 + i);
+                        values['A' + i] = static_cast<unsigned char>(10 + i);
+                    }
+                }
+            };
+
+            const HexValues hexValues;
+
+            // Order of bytes as shown, for every UUIDEncoding: legacy drivers stored UUIDs
+            // (subtype 3) in their platform byte order
+            const unsigned char uuidByteOrder[][16] = {
+                /* DefaultEncoding */ { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+                /* JavaLegacy */      { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 },
+                /* CSharpLegacy */    { 3, 2, 1, 0, 5, 4, 7, 6, 8, 9, 10, 11, 12, 13, 14, 15 },
+                /* PythonLegacy */    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 }
+            };
+
+            const unsigned char *byteOrder(UUIDEncoding encoding)
+            {
+                switch (encoding) {
+                case JavaLegacy:   return uuidByteOrder[1];
+                case CSharpLegacy: return uuidByteOrder[2];
+                case PythonLegacy: return uuidByteOrder[3];
+                default:           return uuidByteOrder[0];
+                }
+            }
+
+            /**
+             * @brief Writes 2 * len lower case hex digits of 'raw' to 'out'
+             */
+            void encodeHex(const unsigned char *raw, size_t len, char *out)
+            {
+                size_t i = 0;
+#if defined(ROBOMONGO_HEX_SSE2)
+                // Nibble n is '0' + n, plus ('a' - '0' - 10) if n > 9
+                const __m128i lowMask = _mm_set1_epi8(0x0F);
+                const __m128i zero = _mm_set1_epi8('0');
+                const __m128i nine = _mm_set1_epi8(9);
+                const __m128i letterOffset = _mm_set1_epi8('a' - '0' - 10);
+                for (; i + 16 <= len; i += 16) {
+                    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i));
+                    const __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), lowMask);
+                    const __m128i low = _mm_and_si128(bytes, lowMask);
+                    __m128i first = _mm_unpacklo_epi8(high, low);
+                    __m128i second = _mm_unpackhi_epi8(high, low);
+                    first = _mm_add_epi8(_mm_add_epi8(first, zero),
+                                         _mm_and_si128(_mm_cmpgt_epi8(first, nine), letterOffset));
+                    second = _mm_add_epi8(_mm_add_epi8(second, zero),
+                                          _mm_and_si128(_mm_cmpgt_epi8(second, nine), letterOffset));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), first);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), second);
+                }
+#elif defined(ROBOMONGO_HEX_NEON)
+                const uint8x16_t digits = vld1q_u8(reinterpret_cast<const uint8_t*>(hexDigits));
+                const uint8x16_t lowMask = vdupq_n_u8(0x0F);
+                for (; i + 16 <= len; i += 16) {
+                    const uint8x16_t bytes = vld1q_u8(raw + i);
+                    const uint8x16_t high = vqtbl1q_u8(digits, vshrq_n_u8(bytes, 4));
+                    const uint8x16_t low = vqtbl1q_u8(digits, vandq_u8(bytes, lowMask));
+                    vst1q_u8(reinterpret_cast<uint8_t*>(out + 2 * i), vzip1q_u8(high, low));
+                    vst1q_u8(reinterpret_cast<uint8_t*>(out + 2 * i + 16), vzip2q_u8(high, low));
+                }
+#endif
+                for (; i < len; ++i) {
+                    out[2 * i] = hexDigits[raw[i] >> 4];
+                    out[2 * i + 1] = hexDigits[raw[i] & 0x0F];
+                }
+            }
+
+            /**
+             * @brief Writes 'len' bytes of 2 * len hex digits of 'hex' to 'out'. Digits are
+             *        not validated, see isHexString().
+             */
+            void decodeHex(const char *hex, size_t len, unsigned char *out)
+            {
+                size_t i = 0;
+#if defined(ROBOMONGO_HEX_SSE2)
+                // Digit d is (d | 0x20) - '0', minus ('a' - '0' - 10) for letters
+                const __m128i lowerCase = _mm_set1_epi8(0x20);
+                const __m128i zero = _mm_set1_epi8('0');
+                const __m128i nine = _mm_set1_epi8(9);
+                const __m128i letterOffset = _mm_set1_epi8('a' - '0' - 10);
+                const __m128i lowByte = _mm_set1_epi16(0x00FF);
+                for (; i + 16 <= len; i += 16) {
+                    __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 2 * i));
+                    __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 2 * i + 16));
+                    first = _mm_sub_epi8(_mm_or_si128(first, lowerCase), zero);
+                    second = _mm_sub_epi8(_mm_or_si128(second, lowerCase), zero);
+                    first = _mm_sub_epi8(first, _mm_and_si128(_mm_cmpgt_epi8(first, nine), letterOffset));
+                    second = _mm_sub_epi8(second, _mm_and_si128(_mm_cmpgt_epi8(second, nine), letterOffset));
+                    // 16-bit lanes hold (high nibble, low nibble) bytes of one output byte
+                    first = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(first, lowByte), 4), _mm_srli_epi16(first, 8));
+                    second = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(second, lowByte), 4), _mm_srli_epi16(second, 8));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(first, second));
+                }
+#elif defined(ROBOMONGO_HEX_NEON)
+                const uint8x16_t lowerCase = vdupq_n_u8(0x20);
+                const uint8x16_t zero = vdupq_n_u8('0');
+                const uint8x16_t nine = vdupq_n_u8(9);
+                const uint8x16_t letterOffset = vdupq_n_u8('a' - '0' - 10);
+                for (; i + 16 <= len; i += 16) {
+                    // val[0] are high nibbles, val[1] low ones
+                    uint8x16x2_t digits = vld2q_u8(reinterpret_cast<const uint8_t*>(hex + 2 * i));
+                    for (uint8x16_t &d : digits.val) {
+                        d = vsubq_u8(vorrq_u8(d, lowerCase), zero);
+                        d = vsubq_u8(d, vandq_u8(vcgtq_u8(d, nine), letterOffset));
+                    }
+                    vst1q_u8(out + i, vorrq_u8(vshlq_n_u8(digits.val[0], 4), digits.val[1]));
+                }
+#endif
+                for (; i < len; ++i) {
+                    unsigned char const high = hexValues.values[static_cast<unsigned char>(hex[2 * i])];
+                    unsigned char const low = hexValues.values[static_cast<unsigned char>(hex[2 * i + 1])];
+                    out[i] = static_cast<unsigned char>((high << 4) | (low & 0x0F));
+                }
+            }
+
+            /**
+             * @brief xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx of 16 bytes, shown in 'order'
+             */
+            std::string formatUuidBytes(const unsigned char *bytes, const unsigned char *order)
+            {
+                unsigned char ordered[16];
+                for (int i = 0; i < 16; ++i)
+                    ordered[i] = bytes[order[i]];
+
+                char hex[32];
+                encodeHex(ordered, sizeof(ordered), hex);
+
+                char uuid[36];
+                std::memcpy(uuid, hex, 8);
+                uuid[8] = '-';
+                std::memcpy(uuid + 9, hex + 8, 4);
+                uuid[13] = '-';
+                std::memcpy(uuid + 14, hex + 12, 4);
+                uuid[18] = '-';
+                std::memcpy(uuid + 19, hex + 16, 4);
+                uuid[23] = '-';
+                std::memcpy(uuid + 24, hex + 20, 12);
+                return std::string(uuid, sizeof(uuid));
+            }
+
+            /**
+             * @brief Hex digits of the first 16 bytes of 'hex', shown in 'order'
+             */
+            std::string hexToUuid(const std::string &hex, const unsigned char *order)
+            {
+                if (hex.size() < 32)
+                    throw std::out_of_range("UUID should have 32 hex digits");
+
+                unsigned char bytes[16];
+                decodeHex(hex.data(), sizeof(bytes), bytes);
+                return formatUuidBytes(bytes, order);
+            }
+
+            /**
+             * @brief 32 hex digits of UUID, bytes in default order. Empty string, if 'uuid'
+             *        without '{', '}' and '-' is not 32 characters long.
+             */
+            std::string uuidToHex(const std::string &uuid, const unsigned char *order)
+            {
+                char hex[32];
+                size_t size = 0;
+                for (char const c : uuid) {
+                    if (c == '{' || c == '}' || c == '-')
+                        continue;
+                    if (size == sizeof(hex))
+                        return "";
+                    hex[size++] = c;
+                }
+
+                if (size != sizeof(hex))
+                    return "";
+
+                // Byte orders are their own inverses
+                char result[32];
+                for (int i = 0; i < 16; ++i) {
+                    result[2 * i] = hex[2 * order[i]];
+                    result[2 * i + 1] = hex[2 * order[i] + 1];
+                }
+                return std::string(result, sizeof(result));
+            }
+        }
+
         bool isHexString(const std::string &str)
         {
-            std::size_t i;
-            for (i = 0; i < str.size(); i++) {
-                if (!isxdigit(str[i])) {
+            for (char const c : str) {
+                if (hexValues.values[static_cast<unsigned char>(c)] == 0xFF)
                     return false;
-                }
             }
             return true;
         }
 
         std::string toStdHexLower(const char *raw, int len)
         {
-            const void* in = reinterpret_cast<const void*>(raw);
-            std::string stdstr = mongo::toHexLower(in, len);
-            return stdstr;
+            if (len <= 0)
+                return std::string();
+
+            std::string hex(2 * static_cast<size_t>(len), '\0');
+            encodeHex(reinterpret_cast<const unsigned char*>(raw), static_cast<size_t>(len), &hex[0]);
+            return hex;
         }
 
         const char *fromHex(const std::string &s, int *outBytes)
         {
-            const int size = s.size();
+            const size_t size = s.size();
             if (size % 2 != 0)
                 return NULL;
 
-            const int bytes = size / 2; // number of bytes
+            const size_t bytes = size / 2; // number of bytes
             char *data = new char[bytes];
+            decodeHex(s.data(), bytes, reinterpret_cast<unsigned char*>(data));
 
-            const char *p = s.c_str();
-            for (size_t i = 0; i < bytes; i++) {
-                data[i] = mongo::fromHex(p).getValue();
-                p += 2;
-            }
-
-            *outBytes = bytes;
+            *outBytes = static_cast<int>(bytes);
             return data;
         }
 
         std::string hexToUuid(const std::string &hex, UUIDEncoding encoding)
         {
-            switch(encoding) {
-            case DefaultEncoding: return hexToUuid(hex);
-            case JavaLegacy:      return hexToJavaUuid(hex);
-            case CSharpLegacy:    return hexToCSharpUuid(hex);
-            case PythonLegacy:    return hexToPythonUuid(hex);
-            default:              return hexToUuid(hex);
-            }
+            return hexToUuid(hex, byteOrder(encoding));
         }
 
         std::string hexToUuid(const std::string &hex)
         {
-            std::string uuid = hex.substr(0, 8) + '-' + hex.substr(8, 4) + '-' + hex.substr(12, 4) + '-' + hex.substr(16, 4) + '-' + hex.substr(20, 12);
-            return uuid;
+            return hexToUuid(hex, byteOrder(DefaultEncoding));
         }
 
         std::string hexToCSharpUuid(const std::string &hex)
         {
-            std::string a = hex.substr(6, 2) + hex.substr(4, 2) + hex.substr(2, 2) + hex.substr(0, 2);
-            std::string b = hex.substr(10, 2) + hex.substr(8, 2);
-            std::string c = hex.substr(14, 2) + hex.substr(12, 2);
-            std::string d = hex.substr(16, 16);
-            std::string temp = a + b + c + d;
-            std::string uuid = temp.substr(0, 8) + '-' + temp.substr(8, 4) + '-' + temp.substr(12, 4) + '-' + temp.substr(16, 4) + '-' + temp.substr(20, 12);
-            return uuid;
+            return hexToUuid(hex, byteOrder(CSharpLegacy));
         }
 
         std::string hexToJavaUuid(const std::string &hex)
         {
-            std::string msb = hex.substr(0, 16);
-            std::string lsb = hex.substr(16, 16);
-            msb = msb.substr(14, 2) + msb.substr(12, 2) + msb.substr(10, 2) + msb.substr(8, 2) + msb.substr(6, 2) + msb.substr(4, 2) + msb.substr(2, 2) + msb.substr(0, 2);
-            lsb = lsb.substr(14, 2) + lsb.substr(12, 2) + lsb.substr(10, 2) + lsb.substr(8, 2) + lsb.substr(6, 2) + lsb.substr(4, 2) + lsb.substr(2, 2) + lsb.substr(0, 2);
-            std::string temp = msb + lsb;
-            std::string uuid = temp.substr(0, 8) + '-' + temp.substr(8, 4) + '-' + temp.substr(12, 4) + '-' + temp.substr(16, 4) + '-' + temp.substr(20, 12);
-            return uuid;
+            return hexToUuid(hex, byteOrder(JavaLegacy));
         }
 
         std::string hexToPythonUuid(const std::string &hex)
         {
-            return hexToUuid(hex);
+            return hexToUuid(hex, byteOrder(PythonLegacy));
         }
 
         std::string uuidToHex(const std::string &uuid, Robomongo::UUIDEncoding encoding)
         {
-            switch(encoding) {
-            case DefaultEncoding: return uuidToHex(uuid);
-            case JavaLegacy:      return javaUuidToHex(uuid);
-            case CSharpLegacy:    return csharpUuidToHex(uuid);
-            case PythonLegacy:    return pythonUuidToHex(uuid);
-            default:              return uuidToHex(uuid);
-            }
+            return uuidToHex(uuid, byteOrder(encoding));
         }
 
         std::string uuidToHex(const std::string &uuid)
         {
-            // remove extra characters
-            std::string hex = uuid;
-            pcrecpp::RE re("[{}-]");
-            re.GlobalReplace("", &hex);
-
-            if (hex.size() != 32)
-                return "";
-
-            return hex;
+            return uuidToHex(uuid, byteOrder(DefaultEncoding));
         }
 
         std::string csharpUuidToHex(const std::string &uuid)
         {
-            // remove extra characters
-            std::string hex = uuid;
-            pcrecpp::RE re("[{}-]");
-            re.GlobalReplace("", &hex);
-
-            if (hex.size() != 32)
-                return "";
-
-            std::string a = hex.substr(6, 2) + hex.substr(4, 2) + hex.substr(2, 2) + hex.substr(0, 2);
-            std::string b = hex.substr(10, 2) + hex.substr(8, 2);
-            std::string c = hex.substr(14, 2) + hex.substr(12, 2);
-            std::string d = hex.substr(16, 16);
-            std::string result = a + b + c + d;
-            return result;
+            return uuidToHex(uuid, byteOrder(CSharpLegacy));
         }
 
         std::string javaUuidToHex(const std::string &uuid)
         {
-            // remove extra characters
-            std::string hex = uuid;
-            pcrecpp::RE re("[{}-]");
-            re.GlobalReplace("", &hex);
-
-            if (hex.size() != 32)
-                return "";
-
-            std::string msb = hex.substr(0, 16);
-            std::string lsb = hex.substr(16, 16);
-            msb = msb.substr(14, 2) + msb.substr(12, 2) + msb.substr(10, 2) + msb.substr(8, 2) + msb.substr(6, 2) + msb.substr(4, 2) + msb.substr(2, 2) + msb.substr(0, 2);
-            lsb = lsb.substr(14, 2) + lsb.substr(12, 2) + lsb.substr(10, 2) + lsb.substr(8, 2) + lsb.substr(6, 2) + lsb.substr(4, 2) + lsb.substr(2, 2) + lsb.substr(0, 2);
-            std::string result = msb + lsb;
-            return result;
+            return uuidToHex(uuid, byteOrder(JavaLegacy));
         }
 
         std::string pythonUuidToHex(const std::string &uuid)
         {
-            return uuidToHex(uuid);
+            return uuidToHex(uuid, byteOrder(PythonLegacy));
         }
 
         std::string formatUuid(const mongo::BSONElement &element, Robomongo::UUIDEncoding encoding)
@@ -163,10 +308,13 @@ namespace Robomongo
 
             int len;
             const char *data = element.binData(len);
-            std::string hex = HexUtils::toStdHexLower(data, len);
+            if (len < 16)
+                throw std::out_of_range("UUID should have 16 bytes");
 
+            // Bytes of standard UUID (subtype 4) are always in default order
+            const unsigned char *bytes = reinterpret_cast<const unsigned char*>(data);
             if (binType == mongo::bdtUUID) {
-                std::string uuid = HexUtils::hexToUuid(hex, encoding);
+                std::string const uuid = formatUuidBytes(bytes, byteOrder(encoding));
 
                 switch(encoding) {
                 case DefaultEncoding: return "LUUID(\"" + uuid + "\")";
@@ -176,9 +324,56 @@ namespace Robomongo
                 default:              return "LUUID(\"" + uuid + "\")";
                 }
             } else {
-                std::string uuid = HexUtils::hexToUuid(hex, DefaultEncoding);
-                return "UUID(\"" + uuid + "\")";
+                return "UUID(\"" + formatUuidBytes(bytes, byteOrder(DefaultEncoding)) + "\")";
+            }
+        }
+
+        std::string formatBinaryPreview(const char *raw, int len, int maxBytes)
+        {
+            int const shown = std::max(0, std::min(len, maxBytes));
+            std::string result = toStdHexLower(raw, shown);
+            if (shown < len)
+                result += "...";
+            if (!result.empty())
+                result += ' ';
+            result += "(" + std::to_string(len) + (len == 1 ? " byte)" : " bytes)");
+            return result;
+        }
+
+        std::string hexDump(const char *raw, int len, long long offset)
+        {
+            int const lineBytes = 16;
+            std::string result;
+            result.reserve(static_cast<size_t>((len + lineBytes - 1) / lineBytes) * 78);
+
+            char address[32];
+            for (int line = 0; line < len; line += lineBytes) {
+                int const count = std::min(lineBytes, len - line);
+                snprintf(address, sizeof(address), "%08llx  ", offset + line);
+                result += address;
+
+                for (int i = 0; i < lineBytes; ++i) {
+                    if (i < count) {
+                        unsigned char const byte = static_cast<unsigned char>(raw[line + i]);
+                        result += hexDigits[byte >> 4];
+                        result += hexDigits[byte & 0x0F];
+                        result += ' ';
+                    }
+                    else {
+                        result += "   ";
+                    }
+                    if (i == lineBytes / 2 - 1)
+                        result += ' ';
+                }
+
+                result += " |";
+                for (int i = 0; i < count; ++i) {
+                    char const ch = raw[line + i];
+                    result += (ch >= 0x20 && ch < 0x7F) ? ch : '.';
+                }
+                result += "|\n";
             }
+            return result;
         }
     }
 }
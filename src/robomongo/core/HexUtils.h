@@ -44,5 +44,18 @@ namespace Robomongo
         std::string javaUuidToHex(const std::string &uuid);
         std::string pythonUuidToHex(const std::string &uuid);
         std::string formatUuid(const mongo::BSONElement &element, UUIDEncoding encoding);
+
+        /**
+         * @brief Hex of at most 'maxBytes' first bytes, followed by "..." if cut, and
+         *        "(N bytes)". Only the shown bytes are formatted, whatever 'len' is.
+         */
+        std::string formatBinaryPreview(const char *raw, int len, int maxBytes);
+
+        /**
+         * @brief Hex dump of 'len' bytes, 16 per line: offset (counted from 'offset'),
+         *        bytes in hex and printable ASCII, i.e.
+         *        "00000010  48 65 6c 6c 6f 00 ...  |Hello.|"
+         */
+        std::string hexDump(const char *raw, int len, long long offset);
     }
 }
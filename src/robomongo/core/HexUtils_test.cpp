@@ -1,8 +1,35 @@
 #include "gtest/gtest.h"
 #include "HexUtils.h"
 
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include <cctype>
+#include <memory>
 #include <string>
 
+using namespace Robomongo;
+
+namespace
+{
+    // Bytes 00 01 02 ... 0f
+    std::string sequentialBytes(int len)
+    {
+        std::string bytes;
+        for (int i = 0; i < len; ++i)
+            bytes += static_cast<char>(i);
+        return bytes;
+    }
+
+    std::string formatUuid(mongo::BinDataType type, UUIDEncoding encoding)
+    {
+        std::string const bytes = sequentialBytes(16);
+        mongo::BSONObjBuilder builder;
+        builder.appendBinData("uuid", 16, type, bytes.data());
+        mongo::BSONObj const obj = builder.obj();
+        return HexUtils::formatUuid(obj.firstElement(), encoding);
+    }
+}
+
 /* Example Test:
 *
 * TEST( [Test_Case_Name], [Test_Name] )
@@ -17,3 +44,101 @@ TEST(hex_utils_tests, test_1)
     EXPECT_TRUE(Robomongo::HexUtils::isHexString("a"));
 }
 
+
+TEST(hex_utils_tests, is_hex_string)
+{
+    EXPECT_TRUE(HexUtils::isHexString(""));
+    EXPECT_TRUE(HexUtils::isHexString("0123456789abcdefABCDEF"));
+    EXPECT_FALSE(HexUtils::isHexString("0g"));
+    EXPECT_FALSE(HexUtils::isHexString("ab-cd"));
+    EXPECT_FALSE(HexUtils::isHexString(std::string("ab\0cd", 5)));
+}
+
+TEST(hex_utils_tests, to_hex_lower_all_lengths)
+{
+    // Lengths around 16 byte blocks of vectorized encoder
+    char const digits[] = "0123456789abcdef";
+    for (int len = 0; len <= 70; ++len) {
+        std::string raw;
+        std::string expected;
+        for (int i = 0; i < len; ++i) {
+            unsigned char const byte = static_cast<unsigned char>(i * 37 + 250);
+            raw += static_cast<char>(byte);
+            expected += digits[byte >> 4];
+            expected += digits[byte & 0x0F];
+        }
+        EXPECT_EQ(expected, HexUtils::toStdHexLower(raw.data(), len)) << "length " << len;
+    }
+}
+
+TEST(hex_utils_tests, from_hex_round_trip)
+{
+    for (int len = 0; len <= 70; ++len) {
+        std::string raw;
+        for (int i = 0; i < len; ++i)
+            raw += static_cast<char>(i * 53 + 7);
+
+        std::string hex = HexUtils::toStdHexLower(raw.data(), len);
+        for (size_t i = 0; i < hex.size(); i += 3)
+            hex[i] = static_cast<char>(toupper(hex[i]));
+
+        int outBytes = -1;
+        std::unique_ptr<const char[]> data(HexUtils::fromHex(hex, &outBytes));
+        ASSERT_EQ(len, outBytes);
+        EXPECT_EQ(raw, std::string(data.get(), outBytes)) << "length " << len;
+    }
+
+    int outBytes = -1;
+    EXPECT_EQ(nullptr, HexUtils::fromHex("abc", &outBytes));
+}
+
+TEST(hex_utils_tests, format_uuid_legacy_byte_orders)
+{
+    EXPECT_EQ("LUUID(\"00010203-0405-0607-0809-0a0b0c0d0e0f\")", formatUuid(mongo::bdtUUID, DefaultEncoding));
+    EXPECT_EQ("JUUID(\"07060504-0302-0100-0f0e-0d0c0b0a0908\")", formatUuid(mongo::bdtUUID, JavaLegacy));
+    EXPECT_EQ("NUUID(\"03020100-0504-0706-0809-0a0b0c0d0e0f\")", formatUuid(mongo::bdtUUID, CSharpLegacy));
+    EXPECT_EQ("PYUUID(\"00010203-0405-0607-0809-0a0b0c0d0e0f\")", formatUuid(mongo::bdtUUID, PythonLegacy));
+
+    // Standard UUID does not depend on encoding
+    EXPECT_EQ("UUID(\"00010203-0405-0607-0809-0a0b0c0d0e0f\")", formatUuid(mongo::newUUID, JavaLegacy));
+    EXPECT_EQ("UUID(\"00010203-0405-0607-0809-0a0b0c0d0e0f\")", formatUuid(mongo::newUUID, CSharpLegacy));
+}
+
+TEST(hex_utils_tests, uuid_hex_round_trip)
+{
+    std::string const bytes = sequentialBytes(16);
+    std::string const hex = HexUtils::toStdHexLower(bytes.data(), 16);
+
+    EXPECT_EQ("07060504-0302-0100-0f0e-0d0c0b0a0908", HexUtils::hexToJavaUuid(hex));
+    EXPECT_EQ("03020100-0504-0706-0809-0a0b0c0d0e0f", HexUtils::hexToCSharpUuid(hex));
+    EXPECT_EQ("00010203-0405-0607-0809-0a0b0c0d0e0f", HexUtils::hexToPythonUuid(hex));
+
+    UUIDEncoding const encodings[] = { DefaultEncoding, JavaLegacy, CSharpLegacy, PythonLegacy };
+    for (UUIDEncoding encoding : encodings) {
+        std::string const uuid = HexUtils::hexToUuid(hex, encoding);
+        EXPECT_EQ(hex, HexUtils::uuidToHex(uuid, encoding)) << "encoding " << encoding;
+        EXPECT_EQ(hex, HexUtils::uuidToHex("{" + uuid + "}", encoding)) << "encoding " << encoding;
+    }
+
+    EXPECT_EQ("", HexUtils::uuidToHex("00010203-0405-0607-0809-0a0b0c0d0e"));
+    EXPECT_EQ("", HexUtils::javaUuidToHex("00010203-0405-0607-0809-0a0b0c0d0e0f00"));
+}
+
+TEST(hex_utils_tests, binary_preview_is_capped)
+{
+    std::string const bytes = sequentialBytes(16);
+    EXPECT_EQ("00010203 (4 bytes)", HexUtils::formatBinaryPreview(bytes.data(), 4, 8));
+    EXPECT_EQ("0001... (16 bytes)", HexUtils::formatBinaryPreview(bytes.data(), 16, 2));
+    EXPECT_EQ("00 (1 byte)", HexUtils::formatBinaryPreview(bytes.data(), 1, 8));
+    EXPECT_EQ("(0 bytes)", HexUtils::formatBinaryPreview(bytes.data(), 0, 8));
+}
+
+TEST(hex_utils_tests, hex_dump_lines)
+{
+    std::string const bytes = "Hello" + sequentialBytes(13);
+    std::string const dump = HexUtils::hexDump(bytes.data(), static_cast<int>(bytes.size()), 0x20);
+
+    EXPECT_EQ("00000020  48 65 6c 6c 6f 00 01 02  03 04 05 06 07 08 09 0a  |Hello...........|\n"
+              "00000030  0b 0c                                             |..|\n", dump);
+    EXPECT_EQ("", HexUtils::hexDump(bytes.data(), 0, 0));
+}
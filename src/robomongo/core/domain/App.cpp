@@ -1,9 +1,12 @@
 #include "robomongo/core/domain/App.h"
 
+#include <QApplication>
 #include <QHash>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QTimerEvent>
 
+#include "robomongo/core/domain/ConnectionStartup.h"
 #include "robomongo/core/domain/MongoServer.h"
 #include "robomongo/core/domain/MongoShell.h"
 #include "robomongo/core/domain/MongoCollection.h"
@@ -13,9 +16,11 @@
 #include "robomongo/core/settings/SslSettings.h"
 #include "robomongo/core/mongodb/SshTunnelWorker.h"
 #include "robomongo/core/EventBus.h"
+#include "robomongo/core/utils/HostResolver.h"
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/core/utils/StdUtils.h"
 #include "robomongo/core/utils/Logger.h"
+#include "robomongo/core/utils/LogQueue.h"
 
 namespace Robomongo
 {
@@ -41,10 +46,10 @@ namespace Robomongo
     {}
 
     App::App(EventBus *const bus) : QObject(),
-        _bus(bus), _lastServerHandle(0) {
+        _bus(bus), _startup(new ConnectionStartup(this, bus)), _lastServerHandle(0) {
         _bus->subscribe(this, EstablishSshConnectionResponse::Type);
         _bus->subscribe(this, ListenSshConnectionResponse::Type);
-        _bus->subscribe(this, LogEvent::Type);
+        _logDrainTimerId = startTimer(LogDrainIntervalMs);
     }
 
     std::unique_ptr<MongoServer>
@@ -92,6 +97,19 @@ namespace Robomongo
         if (type == ConnectionPrimary)
             _bus->publish(new ConnectingEvent(this));
 
+        // Host names are looked up in background, while worker thread (or SSH tunnel) starts.
+        // Members of replica set are resolved by driver, its direct member connections use them.
+        std::vector<std::string> hosts;
+        if (connSettings->isReplicaSet()) {
+            for (auto const &member : connSettings->replicaSetSettings()->membersToHostAndPort())
+                hosts.push_back(member.host());
+        }
+        else if (connSettings->sshSettings()->enabled())
+            hosts.push_back(connSettings->sshSettings()->host());
+        else
+            hosts.push_back(connSettings->serverHost());
+        HostResolver::instance().prefetch(hosts);
+
         // When connection is SECONDARY or SSH not enabled or replica set,
         // then continue without SSH Tunnel
         if (type == ConnectionSecondary || !connSettings->sshSettings()->enabled() 
@@ -100,6 +118,15 @@ namespace Robomongo
             return continueOpenServer(_lastServerHandle, connSettings, type);
         }
 
+        // Reuse authenticated SSH session to the same server, if there is one
+        int const localport = SshTunnelWorker::openSharedForward(connSettings);
+        if (localport > 0) {
+            LOG_MSG(QString("Using existing SSH tunnel to %1:%2...")
+                .arg(QtUtils::toQString(connSettings->sshSettings()->host()))
+                .arg(connSettings->sshSettings()->port()), mongo::logger::LogSeverity::Info());
+            return continueOpenServer(_lastServerHandle, connSettings, type, localport);
+        }
+
         // Open SSH channel and only after that open connection
         LOG_MSG(QString("Creating SSH tunnel to %1:%2...")
             .arg(QtUtils::toQString(connSettings->sshSettings()->host()))
@@ -164,6 +191,11 @@ namespace Robomongo
         return true;
     }
 
+    void App::openServers(const std::vector<ConnectionSettings *> &connections)
+    {
+        _startup->open(connections);
+    }
+
     /**
      * @brief Closes MongoServer connection and frees all resources, owned
      * by MongoServer. Finally, specified MongoServer will also be deleted.
@@ -259,10 +291,34 @@ namespace Robomongo
         _bus->send(event->worker, new ListenSshConnectionRequest(this, event->serverHandle, event->connectionType));
     }
 
+    void App::timerEvent(QTimerEvent *event)
+    {
+        if (event->timerId() == _logDrainTimerId)
+            drainLogQueue();
+    }
+
+    void App::drainLogQueue()
+    {
+        LogQueue &queue = LogQueue::instance();
+
+        // Producers outpacing the log panel lose messages, but we tell how many
+        long long const dropped = queue.takeDropped();
+        if (dropped > 0)
+            LOG_MSG(QString("%1 log messages dropped.").arg(dropped), mongo::logger::LogSeverity::Warning());
+
+        LogQueue::Entry entry;
+        for (int i = 0; i < MaxLogMessagesPerDrain && queue.pop(entry); ++i) {
+            LogEvent event(this, entry.message, static_cast<LogEvent::LogLevel>(entry.level), 
+                           entry.informUser);
+            handle(&event);
+        }
+    }
+
     void App::handle(LogEvent *event) {
         LOG_MSG(event->message, event->mongoLogSeverity());
 
-        if (!event->informUser)
+        // No dialogs in headless batch runner (QCoreApplication), message is logged only
+        if (!event->informUser || !qobject_cast<QApplication *>(QCoreApplication::instance()))
             return;
 
         QMessageBox(
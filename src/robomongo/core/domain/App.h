@@ -15,6 +15,7 @@ namespace Robomongo
     class MongoDatabase;
     class EstablishSshConnectionResponse;
     class LogEvent;
+    class ConnectionStartup;
 
     namespace detail
     {
@@ -49,6 +50,11 @@ namespace Robomongo
          */
         bool openServer(ConnectionSettings *connection, ConnectionType type);
 
+        /**
+         * @brief Opens primary connections in parallel, a few at a time, see ConnectionStartup
+         */
+        void openServers(const std::vector<ConnectionSettings *> &connections);
+
         /**
          * @brief Closes MongoServer connection and frees all resources, owned
          * by specified MongoServer. Finally, specified MongoServer will also be deleted.
@@ -92,7 +98,15 @@ namespace Robomongo
         void handle(ListenSshConnectionResponse *event);
         void handle(LogEvent *event);
 
+    protected:
+        void timerEvent(QTimerEvent *event) override;
+
     private:
+        /**
+         * @brief Moves messages of worker threads from LogQueue to Logger (log panel and file)
+         */
+        void drainLogQueue();
+
         std::unique_ptr<MongoServer> openServerInternal(ConnectionSettings* connSettings, ConnectionType type);
         
         std::unique_ptr<MongoServer> 
@@ -117,8 +131,15 @@ namespace Robomongo
 
         EventBus *const _bus;
 
+        std::unique_ptr<ConnectionStartup> _startup;
+
         // Increase monotonically when new MongoServer is created
         // Never decreases.
         int _lastServerHandle;
+
+        // Log messages of other threads are shown with this cadence, see sendLog()
+        static const int LogDrainIntervalMs = 50;
+        static const int MaxLogMessagesPerDrain = 2000;
+        int _logDrainTimerId;
     };
 }
@@ -0,0 +1,380 @@
+#include "robomongo/core/domain/BatchRunner.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <QCoreApplication>
+#include <QFile>
+
+#include <mongo/bson/json.h>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoNamespace.h"
+#include "robomongo/core/domain/MongoShellResult.h"
+#include "robomongo/core/mongodb/MongoWorker.h"
+#include "robomongo/core/mongodb/SshTunnelWorker.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/settings/SshSettings.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/Logger.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace
+{
+    // Asked password of SSH tunnel is taken from environment, not from command line,
+    // where other users of the machine would see it
+    char const *const SshPasswordVariable = "ROBO3T_SSH_PASSWORD";
+
+    int const ExportId = 1;
+
+    void printError(const std::string &message)
+    {
+        if (!message.empty())
+            fprintf(stderr, "%s\n", message.c_str());
+    }
+}
+
+namespace Robomongo
+{
+    bool BatchRunner::parseArguments(const QStringList &arguments, Options &options, std::string &error)
+    {
+        bool hasQuery = false;
+        for (int i = 0; i < arguments.size(); ++i) {
+            QString const &arg = arguments[i];
+
+            if (arg == "--help" || arg == "-h") {
+                error.clear();
+                return false;
+            }
+
+            if (arg == "--verbose") {
+                options.verbose = true;
+                continue;
+            }
+
+            if (i + 1 >= arguments.size()) {
+                error = "Missing value of " + QtUtils::toStdString(arg);
+                return false;
+            }
+
+            QString const value = arguments[++i];
+            if (arg == "--connection") {
+                options.connection = QtUtils::toStdString(value);
+            }
+            else if (arg == "--db") {
+                options.database = QtUtils::toStdString(value);
+            }
+            else if (arg == "--eval") {
+                options.script = QtUtils::toStdString(value);
+            }
+            else if (arg == "--file") {
+                QFile file(value);
+                if (!file.open(QIODevice::ReadOnly)) {
+                    error = "Cannot read script file " + QtUtils::toStdString(value);
+                    return false;
+                }
+                options.script = file.readAll().toStdString();
+            }
+            else if (arg == "--export") {
+                options.exportNamespace = QtUtils::toStdString(value);
+            }
+            else if (arg == "--query") {
+                options.query = QtUtils::toStdString(value);
+                hasQuery = true;
+            }
+            else if (arg == "--out") {
+                options.outFile = QtUtils::toStdString(value);
+            }
+            else if (arg == "--batch-size") {
+                bool ok = false;
+                options.batchSize = value.toInt(&ok);
+                if (!ok || options.batchSize <= 0) {
+                    error = "Batch size must be a positive number";
+                    return false;
+                }
+            }
+            else {
+                error = "Unknown option " + QtUtils::toStdString(arg);
+                return false;
+            }
+        }
+
+        if (options.connection.empty()) {
+            error = "Connection name is required (--connection)";
+            return false;
+        }
+
+        if (options.script.empty() == options.exportNamespace.empty()) {
+            error = "Exactly one of --eval, --file or --export is required";
+            return false;
+        }
+
+        if (options.exportNamespace.empty() && (hasQuery || !options.outFile.empty())) {
+            error = "--query and --out are options of --export";
+            return false;
+        }
+
+        if (!options.exportNamespace.empty()) {
+            size_t const dot = options.exportNamespace.find('.');
+            if (dot == 0 || dot == std::string::npos || dot + 1 == options.exportNamespace.size()) {
+                error = "Export namespace must be <database>.<collection>";
+                return false;
+            }
+
+            try {
+                mongo::fromjson(options.query);
+            }
+            catch (const std::exception &ex) {
+                error = "Query is not valid JSON: " + std::string(ex.what());
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::string BatchRunner::usage()
+    {
+        return
+            "Usage: " PROJECT_NAME_LOWERCASE "-cli --connection <name> [options]\n"
+            "\n"
+            "Runs script or export with connection of settings file, without GUI.\n"
+            "Documents are written to stdout as JSON Lines, messages go to stderr.\n"
+            "\n"
+            "  --connection <name>   Connection name, as in Manage Connections\n"
+            "  --db <name>           Database of script, default database of connection if omitted\n"
+            "  --eval <script>       Run JavaScript\n"
+            "  --file <path>         Run JavaScript file\n"
+            "  --export <db.coll>    Export collection\n"
+            "  --query <json>        Filter of export, {} if omitted\n"
+            "  --out <path>          Export into file, instead of stdout\n"
+            "  --batch-size <n>      Documents per batch, as in settings if omitted\n"
+            "  --verbose             Log to stderr\n"
+            "\n"
+            "Asked SSH password or passphrase is read from ROBO3T_SSH_PASSWORD.\n"
+            "Exit codes: 0 success, 1 usage, 2 connection, 3 execution error.\n";
+    }
+
+    BatchRunner::BatchRunner(const Options &options) :
+        _options(options),
+        _worker(nullptr),
+        _bus(AppRegistry::instance().bus()),
+        _documents(0),
+        _finished(false)
+    {
+        if (_options.verbose) {
+            VERIFY(connect(&Logger::instance(), &Logger::printed, this,
+                [](const QString &msg, mongo::logger::LogSeverity) {
+                    fprintf(stderr, "%s\n", QtUtils::toStdString(msg).c_str());
+                }));
+        }
+    }
+
+    BatchRunner::~BatchRunner()
+    {
+        if (_worker)
+            _worker->stopAndDelete();
+    }
+
+    void BatchRunner::start()
+    {
+        ConnectionSettings *found = nullptr;
+        for (ConnectionSettings *connection : AppRegistry::instance().settingsManager()->connections()) {
+            if (connection->connectionName() == _options.connection) {
+                found = connection;
+                break;
+            }
+        }
+
+        if (!found) {
+            finish(UsageError, "Connection \"" + _options.connection + "\" not found in settings");
+            return;
+        }
+
+        _settings.reset(found->clone());
+
+        SshSettings *ssh = _settings->sshSettings();
+        if (!ssh->enabled() || _settings->isReplicaSet()) {
+            connectWorker(0);
+            return;
+        }
+
+        if (ssh->askPassword()) {
+            char const *password = getenv(SshPasswordVariable);
+            if (!password) {
+                finish(UsageError, std::string("SSH password is asked by this connection, set ") +
+                                   SshPasswordVariable);
+                return;
+            }
+            ssh->setAskedPassword(password);
+        }
+
+        ConnectionSettings *settingsCopy = _settings->clone();
+        SshTunnelWorker *sshWorker = new SshTunnelWorker(settingsCopy);
+        _bus->send(sshWorker, new EstablishSshConnectionRequest(this, 0, sshWorker, settingsCopy, ConnectionPrimary));
+    }
+
+    void BatchRunner::handle(EstablishSshConnectionResponse *event)
+    {
+        if (event->isError()) {
+            finish(ConnectionError, "SSH tunnel failed: " + event->error().errorMessage());
+            return;
+        }
+
+        _bus->send(event->worker, new ListenSshConnectionRequest(this, event->serverHandle, event->connectionType));
+        connectWorker(event->localport);
+    }
+
+    void BatchRunner::handle(ListenSshConnectionResponse *event)
+    {
+        // Tunnel is listened to until it fails
+        if (!_finished)
+            finish(ConnectionError, event->isError() ? "SSH tunnel closed: " + event->error().errorMessage()
+                                                     : "SSH tunnel closed");
+    }
+
+    void BatchRunner::connectWorker(int localPort)
+    {
+        if (localPort > 0) {
+            _settings->setServerHost("127.0.0.1");
+            _settings->setServerPort(localPort);
+        }
+
+        SettingsManager *settings = AppRegistry::instance().settingsManager();
+        _worker = new MongoWorker(_settings->clone(),
+                                  settings->loadMongoRcJs(),
+                                  _options.batchSize > 0 ? _options.batchSize : settings->batchSize(),
+                                  settings->mongoTimeoutSec(),
+                                  settings->shellTimeoutSec(),
+                                  settings->shellResultMemoryBudgetMb(),
+                                  settings->jsHeapLimitMb(),
+                                  settings->scopePoolSize(),
+                                  !_options.script.empty());
+
+        _bus->send(_worker, new EstablishConnectionRequest(this, ConnectionPrimary, _settings->uuid().toStdString()));
+    }
+
+    void BatchRunner::handle(EstablishConnectionResponse *event)
+    {
+        if (event->isError()) {
+            finish(ConnectionError, "Cannot connect to " + _settings->getFullAddress() + ": " +
+                                    event->error().errorMessage());
+            return;
+        }
+
+        run();
+    }
+
+    void BatchRunner::run()
+    {
+        if (!_options.script.empty()) {
+            std::string const database = _options.database.empty() ? _settings->defaultDatabase()
+                                                                   : _options.database;
+            _bus->send(_worker, new ExecuteScriptRequest(this, _options.script, database));
+            return;
+        }
+
+        MongoNamespace const ns(_options.exportNamespace);
+        MongoQueryInfo const info(CollectionInfo(_settings->getFullAddress(), ns.databaseName(), ns.collectionName()),
+                                  mongo::fromjson(_options.query), mongo::BSONObj(), 0, 0,
+                                  _options.batchSize, 0, false);
+
+        if (_options.outFile.empty()) {
+            // Whole cursor, replied batch by batch
+            _bus->send(_worker, new ExecuteQueryRequest(this, 0, info));
+            return;
+        }
+
+        ExportOptions options;
+        options.format = ExportFormat::JsonLines;
+        _bus->send(_worker, new ExportDocumentsRequest(this, ExportId, info, options,
+                                                       QtUtils::toQString(_options.outFile),
+                                                       std::make_shared<std::atomic<bool>>(false)));
+    }
+
+    void BatchRunner::handle(ExecuteScriptResponse *event)
+    {
+        if (event->isError()) {
+            finish(ExecutionError, event->error().errorMessage());
+            return;
+        }
+
+        MongoShellExecResult const &result = event->result;
+        if (result.error()) {
+            finish(ExecutionError, result.errorMessage());
+            return;
+        }
+
+        // Cursors of script give their first batch, as in result tabs
+        for (auto const &shellResult : result.results()) {
+            writeDocuments(shellResult.documents());
+            if (shellResult.documents().empty() && !shellResult.response().empty())
+                fprintf(stderr, "%s\n", shellResult.response().c_str());
+        }
+
+        if (event->timeoutReached()) {
+            finish(ExecutionError, "Script timed out");
+            return;
+        }
+
+        finish(Success);
+    }
+
+    void BatchRunner::handle(ExecuteQueryResponse *event)
+    {
+        if (event->isError()) {
+            finish(ExecutionError, event->error().errorMessage());
+            return;
+        }
+
+        writeDocuments(event->documents);
+        if (event->lastBatch)
+            finish(Success, _options.verbose ? std::to_string(_documents) + " documents exported" : "");
+    }
+
+    void BatchRunner::handle(ExportProgressEvent *event)
+    {
+        if (_options.verbose)
+            fprintf(stderr, "%lld documents, %lld bytes\n", event->documents, event->bytes);
+    }
+
+    void BatchRunner::handle(ExportDocumentsResponse *event)
+    {
+        if (event->isError()) {
+            finish(ExecutionError, event->error().errorMessage());
+            return;
+        }
+
+        finish(Success, _options.verbose ? std::to_string(event->documents) + " documents exported in " +
+                                           std::to_string(event->elapsedMs) + " ms" : "");
+    }
+
+    void BatchRunner::writeDocuments(const std::vector<MongoDocumentPtr> &documents)
+    {
+        for (auto const &document : documents) {
+            BsonUtils::jsonString(document->bsonObj(), _output, mongo::Strict, 0, DefaultEncoding, Utc);
+            _output += '\n';
+
+            if (_output.size() >= FlushBytes) {
+                fwrite(_output.data(), 1, _output.size(), stdout);
+                _output.clear();
+            }
+        }
+        _documents += documents.size();
+    }
+
+    void BatchRunner::finish(ExitCode code, const std::string &message)
+    {
+        if (_finished)
+            return;
+        _finished = true;
+
+        fwrite(_output.data(), 1, _output.size(), stdout);
+        _output.clear();
+        fflush(stdout);
+        printError(message);
+
+        QCoreApplication::exit(code);
+    }
+}
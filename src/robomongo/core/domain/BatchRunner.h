@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <QObject>
+#include <QStringList>
+
+#include "robomongo/core/events/MongoEvents.h"
+
+namespace Robomongo
+{
+    class ConnectionSettings;
+    class EventBus;
+    class MongoWorker;
+    class SshTunnelWorker;
+
+    /**
+     * @brief Runs one script or export against a connection of settings file without GUI
+     *        (see app/main_cli.cpp), with the same SSH tunnel and MongoWorker the GUI uses.
+     *        Documents are written to stdout as JSON Lines, everything else goes to stderr.
+     *        QCoreApplication is exited with ExitCode, when it is done.
+     */
+    class BatchRunner : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        enum ExitCode { Success = 0, UsageError = 1, ConnectionError = 2, ExecutionError = 3 };
+
+        struct Options
+        {
+            std::string connection;         // name of connection in settings file
+            std::string database;           // empty: default database of connection
+            std::string script;             // of --eval or --file
+            std::string exportNamespace;    // "db.collection" of --export
+            std::string query = "{}";       // filter of export, Extended JSON
+            std::string outFile;            // export into file, instead of stdout
+            int batchSize = 0;              // documents per cursor of script, 0: as in settings
+            bool verbose = false;           // log to stderr
+        };
+
+        /**
+         * @brief Parses arguments without program name, reads script of --file
+         * @return false with 'error' set, if arguments are not valid
+         */
+        static bool parseArguments(const QStringList &arguments, Options &options, std::string &error);
+        static std::string usage();
+
+        explicit BatchRunner(const Options &options);
+        ~BatchRunner();
+
+        // Finds connection, opens SSH tunnel if needed and connects. Call in event loop.
+        void start();
+
+    protected Q_SLOTS:
+        void handle(EstablishSshConnectionResponse *event);
+        void handle(ListenSshConnectionResponse *event);
+        void handle(EstablishConnectionResponse *event);
+        void handle(ExecuteScriptResponse *event);
+        void handle(ExecuteQueryResponse *event);
+        void handle(ExportProgressEvent *event);
+        void handle(ExportDocumentsResponse *event);
+
+    private:
+        void connectWorker(int localPort);
+        void run();
+        void writeDocuments(const std::vector<MongoDocumentPtr> &documents);
+        void finish(ExitCode code, const std::string &message = std::string());
+
+        // Output is flushed when this much is buffered and at the end
+        static const size_t FlushBytes = 256 * 1024;
+
+        Options const _options;
+        std::unique_ptr<ConnectionSettings> _settings;
+        MongoWorker *_worker;
+        EventBus *_bus;
+        std::string _output;
+        long long _documents;
+        bool _finished;
+    };
+}
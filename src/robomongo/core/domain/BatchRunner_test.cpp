@@ -0,0 +1,45 @@
+#include "gtest/gtest.h"
+#include "BatchRunner.h"
+
+using namespace Robomongo;
+
+TEST(batch_runner_tests, parse_export)
+{
+    BatchRunner::Options options;
+    std::string error;
+    ASSERT_TRUE(BatchRunner::parseArguments(
+        { "--connection", "local", "--export", "shop.orders", "--query", "{ \"qty\" : { \"$gt\" : 5 } }",
+          "--batch-size", "500", "--verbose" }, options, error));
+    EXPECT_EQ("local", options.connection);
+    EXPECT_EQ("shop.orders", options.exportNamespace);
+    EXPECT_EQ(500, options.batchSize);
+    EXPECT_TRUE(options.verbose);
+    EXPECT_TRUE(options.script.empty());
+}
+
+TEST(batch_runner_tests, parse_rejects_invalid)
+{
+    std::string error;
+    BatchRunner::Options noConnection;
+    EXPECT_FALSE(BatchRunner::parseArguments({ "--eval", "db.stats()" }, noConnection, error));
+    EXPECT_FALSE(error.empty());
+
+    BatchRunner::Options both;
+    EXPECT_FALSE(BatchRunner::parseArguments(
+        { "--connection", "local", "--eval", "1", "--export", "shop.orders" }, both, error));
+
+    BatchRunner::Options queryOfScript;
+    EXPECT_FALSE(BatchRunner::parseArguments(
+        { "--connection", "local", "--eval", "1", "--query", "{}" }, queryOfScript, error));
+
+    BatchRunner::Options badQuery;
+    EXPECT_FALSE(BatchRunner::parseArguments(
+        { "--connection", "local", "--export", "shop.orders", "--query", "{ qty: " }, badQuery, error));
+
+    BatchRunner::Options noCollection;
+    EXPECT_FALSE(BatchRunner::parseArguments({ "--connection", "local", "--export", "shop" }, noCollection, error));
+
+    BatchRunner::Options help;
+    EXPECT_FALSE(BatchRunner::parseArguments({ "--help" }, help, error));
+    EXPECT_TRUE(error.empty());
+}
@@ -0,0 +1,334 @@
+#include "robomongo/core/domain/BsonDumpFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <QDir>
+#include <QFileInfo>
+
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/core/utils/ThreadPriority.h"
+
+namespace
+{
+    // Ends prelude of archive and every block of namespace
+    qint32 const Terminator = -1;
+
+    // "db.collection" of archive prelude metadata and block headers; oplog has no database
+    std::string namespaceOf(const mongo::BSONObj &obj)
+    {
+        std::string const db = obj.getStringField("db");
+        std::string const collection = obj.getStringField("collection");
+        return db.empty() ? collection : db + "." + collection;
+    }
+}
+
+namespace Robomongo
+{
+    BsonDumpFile::BsonDumpFile(const QString &filePath) :
+        _file(filePath),
+        _data(nullptr),
+        _size(0),
+        _isArchive(false)
+    {
+        if (!_file.open(QIODevice::ReadOnly))
+            throw std::runtime_error("Cannot open " + QtUtils::toStdString(filePath) + ": " +
+                                     QtUtils::toStdString(_file.errorString()));
+
+        _size = _file.size();
+        if (_size > 0) {
+            _data = reinterpret_cast<const char *>(_file.map(0, _size));
+            if (!_data)
+                throw std::runtime_error("Cannot map " + QtUtils::toStdString(filePath) + ": " +
+                                         QtUtils::toStdString(_file.errorString()));
+        }
+
+        if (_size >= 2 && static_cast<unsigned char>(_data[0]) == 0x1f &&
+            static_cast<unsigned char>(_data[1]) == 0x8b)
+            throw std::runtime_error("Dump is compressed (--gzip), decompress it first");
+
+        std::string name = QtUtils::toStdString(QFileInfo(filePath).completeBaseName());
+        if (ResultArchive::isArchive(_data, _size)) {
+            ResultArchive::Index const archive = ResultArchive::readIndex(_data, _size);
+            if (!archive.ns.empty())
+                name = archive.ns;
+
+            // Sparse file, pages are written by index() and evicted by OS like pages of dump
+            _extracted.reset(new QTemporaryFile(
+                QString("%1/" PROJECT_NAME_LOWERCASE "-archive-XXXXXX.bson").arg(QDir::tempPath())));
+            if (!_extracted->open() || !_extracted->resize(archive.rawBytes))
+                throw std::runtime_error("Cannot create temporary file for result archive: " +
+                                         QtUtils::toStdString(_extracted->errorString()));
+
+            _archiveData = _data;
+            _blocks = archive.blocks;
+            _data = nullptr;
+            _size = archive.rawBytes;
+            if (_size > 0) {
+                _extractedData = reinterpret_cast<char *>(_extracted->map(0, _size));
+                if (!_extractedData)
+                    throw std::runtime_error("Cannot map temporary file for result archive: " +
+                                             QtUtils::toStdString(_extracted->errorString()));
+                _data = _extractedData;
+            }
+        }
+        else {
+            _isArchive = _size >= 4 && static_cast<quint32>(readInt(0)) == ArchiveMagic;
+        }
+
+        if (!_isArchive) {
+            Namespace ns;
+            ns.name = name;
+            _namespaces.push_back(ns);
+        }
+
+        _thread = std::thread(&BsonDumpFile::index, this);
+    }
+
+    BsonDumpFile::~BsonDumpFile()
+    {
+        // Mappings are released by QFile and QTemporaryFile
+        _stop = true;
+        if (_thread.joinable())
+            _thread.join();
+    }
+
+    std::vector<std::string> BsonDumpFile::namespaces() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<std::string> names;
+        for (auto const &ns : _namespaces)
+            names.push_back(ns.name);
+        return names;
+    }
+
+    long long BsonDumpFile::count(const std::string &ns) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto const &known : _namespaces) {
+            if (known.name == ns)
+                return known.count;
+        }
+        return 0;
+    }
+
+    std::string BsonDumpFile::error() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _error;
+    }
+
+    std::vector<MongoDocumentPtr> BsonDumpFile::documents(const std::string &ns, long long skip, int limit) const
+    {
+        std::vector<MongoDocumentPtr> result;
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto const found = std::find_if(_namespaces.begin(), _namespaces.end(),
+                                        [&ns](const Namespace &known) { return known.name == ns; });
+        if (found == _namespaces.end() || skip < 0 || limit <= 0 || skip >= found->count)
+            return result;
+
+        long long const end = std::min(found->count, skip + limit);
+        result.reserve(end - skip);
+
+        // Documents of one run follow each other, every run starts with a checkpoint
+        auto const &checkpoints = found->checkpoints;
+        auto checkpoint = std::upper_bound(checkpoints.begin(), checkpoints.end(), skip,
+            [](long long ordinal, const Checkpoint &point) { return ordinal < point.ordinal; }) - 1;
+
+        qint64 offset = checkpoint->offset;
+        for (long long ordinal = checkpoint->ordinal; ordinal < end; ++ordinal) {
+            if (checkpoint != checkpoints.end() && checkpoint->ordinal == ordinal) {
+                offset = checkpoint->offset;
+                ++checkpoint;
+            }
+
+            // Size was validated by index()
+            if (ordinal >= skip)
+                result.push_back(MongoDocument::fromBsonObj(mongo::BSONObj(_data + offset)));
+            offset += readInt(offset);
+        }
+
+        return result;
+    }
+
+    void BsonDumpFile::index()
+    {
+        // Documents indexed so far are browsed meanwhile
+        ThreadPriority::setCurrent(ThreadPriority::Background);
+        if (_isArchive) {
+            indexArchive(sizeof(ArchiveMagic));
+        }
+        else if (_extracted) {
+            indexResultArchive();
+        }
+        else {
+            qint64 offset = 0;
+            while (offset < _size && !_stop) {
+                int const size = documentSize(offset);
+                if (!size) {
+                    fail("Malformed document at offset " + std::to_string(offset));
+                    break;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    add(_namespaces.front(), offset, offset == 0);
+                }
+                offset += size;
+                _indexedBytes = offset;
+            }
+        }
+
+        _indexed = true;
+    }
+
+    void BsonDumpFile::indexArchive(qint64 offset)
+    {
+        auto const isTerminator = [this](qint64 at) { return at + 4 <= _size && readInt(at) == Terminator; };
+
+        // Prelude: header, metadata of every collection, terminator
+        int size = documentSize(offset);
+        if (!size) {
+            fail("Malformed archive header");
+            return;
+        }
+        offset += size;
+
+        while (!isTerminator(offset)) {
+            size = documentSize(offset);
+            if (!size) {
+                fail("Malformed collection metadata at offset " + std::to_string(offset));
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            findOrAdd(namespaceOf(mongo::BSONObj(_data + offset)));
+            offset += size;
+        }
+        offset += 4;
+
+        // Blocks of interleaved namespaces: header, documents, terminator.
+        // Last block of namespace has EOF header and no documents.
+        while (offset < _size && !_stop) {
+            size = documentSize(offset);
+            if (!size) {
+                fail("Malformed block header at offset " + std::to_string(offset));
+                return;
+            }
+
+            mongo::BSONObj const header(_data + offset);
+            bool const isEof = header.getBoolField("EOF");
+            size_t nsIndex = 0;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                nsIndex = &findOrAdd(namespaceOf(header)) - &_namespaces.front();
+            }
+            offset += size;
+
+            bool runStart = true;
+            while (!isTerminator(offset)) {
+                if (_stop)
+                    return;
+
+                size = documentSize(offset);
+                if (!size) {
+                    fail("Malformed document at offset " + std::to_string(offset));
+                    return;
+                }
+
+                if (!isEof) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    add(_namespaces[nsIndex], offset, runStart);
+                    runStart = false;
+                }
+                offset += size;
+                _indexedBytes = offset;
+            }
+            offset += 4;
+            _indexedBytes = offset;
+        }
+    }
+
+    void BsonDumpFile::indexResultArchive()
+    {
+        // Documents of block are indexed once it is decompressed, earlier pages can be read meanwhile
+        qint64 offset = 0;
+        for (ResultArchive::Block const &block : _blocks) {
+            if (_stop)
+                return;
+
+            try {
+                ResultArchive::extractBlock(_archiveData, block, _extractedData + offset);
+            }
+            catch (const std::exception &ex) {
+                fail(ex.what());
+                return;
+            }
+
+            qint64 const end = offset + block.rawBytes;
+            while (offset < end) {
+                int const size = documentSize(offset);
+                if (!size || size > end - offset) {
+                    fail("Malformed document in block at offset " + std::to_string(block.offset));
+                    return;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    add(_namespaces.front(), offset, offset == 0);
+                }
+                offset += size;
+            }
+            _indexedBytes = offset;
+        }
+    }
+
+    int BsonDumpFile::documentSize(qint64 offset) const
+    {
+        if (offset < 0 || _size - offset < 5)
+            return 0;
+
+        qint32 const size = readInt(offset);
+        if (size < 5 || size > _size - offset || _data[offset + size - 1] != 0)
+            return 0;
+
+        return size;
+    }
+
+    qint32 BsonDumpFile::readInt(qint64 offset) const
+    {
+        // BSON is little endian, as are supported CPUs
+        qint32 value = 0;
+        memcpy(&value, _data + offset, sizeof(value));
+        return value;
+    }
+
+    BsonDumpFile::Namespace &BsonDumpFile::findOrAdd(const std::string &name)
+    {
+        for (auto &ns : _namespaces) {
+            if (ns.name == name)
+                return ns;
+        }
+
+        _namespaces.emplace_back();
+        _namespaces.back().name = name;
+        return _namespaces.back();
+    }
+
+    void BsonDumpFile::add(Namespace &ns, qint64 offset, bool runStart)
+    {
+        if (runStart || ns.count % CheckpointInterval == 0)
+            ns.checkpoints.push_back({ ns.count, offset });
+        ++ns.count;
+    }
+
+    void BsonDumpFile::fail(const std::string &error)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _error = error;
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <QFile>
+#include <QTemporaryFile>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "robomongo/core/Core.h"
+#include "robomongo/core/domain/ResultArchive.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Read-only view of mongodump output: collection file (.bson) or --archive
+     *        stream (uncompressed). File is mapped into memory as a whole, pages are
+     *        loaded and evicted by OS on demand.
+     *
+     *  Offsets of documents are indexed by background thread, which is started by
+     *  constructor. Index is sparse: start of every run of documents of a namespace and
+     *  every CheckpointInterval-th document, so that it stays small for multi-GB dumps.
+     *  Documents indexed so far can be read while indexing continues.
+     *
+     *  ResultArchive is decompressed by the same thread, block by block, into temporary
+     *  file of its decompressed size, which is mapped instead and read as .bson dump.
+     */
+    class BsonDumpFile
+    {
+    public:
+        /**
+         * @throws std::runtime_error, if file cannot be opened or mapped, or is compressed
+         */
+        explicit BsonDumpFile(const QString &filePath);
+
+        /**
+         * @brief Stops indexing thread
+         */
+        ~BsonDumpFile();
+
+        QString filePath() const { return _file.fileName(); }
+        bool isArchive() const { return _isArchive; }
+        bool isResultArchive() const { return static_cast<bool>(_extracted); }
+
+        // Decompressed size of result archive
+        qint64 size() const { return _size; }
+
+        /**
+         * @brief Namespaces of archive in order of appearance, collections without documents
+         *        included; base name of file for .bson dump
+         */
+        std::vector<std::string> namespaces() const;
+
+        /**
+         * @brief Documents of 'ns' indexed so far
+         */
+        long long count(const std::string &ns) const;
+
+        /**
+         * @brief True, when whole file is indexed or indexing stopped on error
+         */
+        bool isIndexed() const { return _indexed; }
+        qint64 indexedBytes() const { return _indexedBytes; }
+
+        /**
+         * @brief Reason why indexing stopped before end of file, i.e. truncated dump.
+         *        Documents before that point are still available.
+         */
+        std::string error() const;
+
+        /**
+         * @brief Copies of indexed documents [skip, skip + limit) of 'ns'
+         */
+        std::vector<MongoDocumentPtr> documents(const std::string &ns, long long skip, int limit) const;
+
+        /**
+         * @brief First 4 bytes of mongodump --archive
+         */
+        static const quint32 ArchiveMagic = 0x8199e26d;
+
+    private:
+        struct Checkpoint
+        {
+            long long ordinal;      // index of document in its namespace
+            qint64 offset;          // in file
+        };
+
+        struct Namespace
+        {
+            std::string name;
+            long long count = 0;
+            std::vector<Checkpoint> checkpoints;
+        };
+
+        void index();
+        void indexArchive(qint64 offset);
+        void indexResultArchive();
+
+        // Size of BSON document at 'offset', 0 if it does not fit in file or is malformed
+        int documentSize(qint64 offset) const;
+        qint32 readInt(qint64 offset) const;
+
+        // Under _mutex
+        Namespace &findOrAdd(const std::string &name);
+        void add(Namespace &ns, qint64 offset, bool runStart);
+        void fail(const std::string &error);
+
+        BsonDumpFile(const BsonDumpFile&) = delete;
+        BsonDumpFile& operator=(const BsonDumpFile&) = delete;
+
+        static const long long CheckpointInterval = 64;
+
+        QFile _file;
+        const char *_data;
+        qint64 _size;
+        bool _isArchive;
+
+        // Of result archive: _data points to mapping of _extracted, compressed blocks are in _file
+        std::unique_ptr<QTemporaryFile> _extracted;
+        char *_extractedData = nullptr;
+        const char *_archiveData = nullptr;
+        std::vector<ResultArchive::Block> _blocks;
+
+        mutable std::mutex _mutex;
+        std::vector<Namespace> _namespaces;
+        std::string _error;
+
+        std::atomic<bool> _stop { false };
+        std::atomic<bool> _indexed { false };
+        std::atomic<qint64> _indexedBytes { 0 };
+        std::thread _thread;
+    };
+}
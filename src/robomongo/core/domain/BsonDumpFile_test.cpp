@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+#include "BsonDumpFile.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <QTemporaryFile>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/domain/MongoDocument.h"
+
+using namespace Robomongo;
+
+namespace
+{
+    void append(QByteArray &data, const mongo::BSONObj &obj)
+    {
+        data.append(obj.objdata(), obj.objsize());
+    }
+
+    void appendInt(QByteArray &data, qint32 value)
+    {
+        data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void waitIndexed(const BsonDumpFile &file)
+    {
+        while (!file.isIndexed())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::vector<int> values(const std::vector<MongoDocumentPtr> &documents)
+    {
+        std::vector<int> result;
+        for (auto const &document : documents)
+            result.push_back(document->bsonObj().getIntField("i"));
+        return result;
+    }
+}
+
+TEST(bson_dump_file_tests, pages_of_collection_dump)
+{
+    QByteArray data;
+    for (int i = 0; i < 200; ++i)
+        append(data, BSON("i" << i));
+
+    QTemporaryFile temp;
+    ASSERT_TRUE(temp.open());
+    temp.write(data);
+    temp.flush();
+
+    BsonDumpFile file(temp.fileName());
+    waitIndexed(file);
+    EXPECT_FALSE(file.isArchive());
+    EXPECT_TRUE(file.error().empty());
+    ASSERT_EQ(1u, file.namespaces().size());
+
+    std::string const ns = file.namespaces().front();
+    EXPECT_EQ(200, file.count(ns));
+    EXPECT_EQ(std::vector<int>({ 126, 127, 128, 129 }), values(file.documents(ns, 126, 4)));
+    EXPECT_EQ(std::vector<int>({ 198, 199 }), values(file.documents(ns, 198, 50)));
+    EXPECT_TRUE(file.documents(ns, 200, 50).empty());
+}
+
+TEST(bson_dump_file_tests, truncated_dump_keeps_complete_documents)
+{
+    QByteArray data;
+    for (int i = 0; i < 3; ++i)
+        append(data, BSON("i" << i));
+    data.chop(2);
+
+    QTemporaryFile temp;
+    ASSERT_TRUE(temp.open());
+    temp.write(data);
+    temp.flush();
+
+    BsonDumpFile file(temp.fileName());
+    waitIndexed(file);
+    EXPECT_FALSE(file.error().empty());
+    EXPECT_EQ(std::vector<int>({ 0, 1 }), values(file.documents(file.namespaces().front(), 0, 10)));
+}
+
+TEST(bson_dump_file_tests, interleaved_archive_blocks)
+{
+    QByteArray data;
+    appendInt(data, static_cast<qint32>(BsonDumpFile::ArchiveMagic));
+    append(data, BSON("version" << "0.1"));
+    append(data, BSON("db" << "shop" << "collection" << "orders" << "type" << "collection"));
+    append(data, BSON("db" << "shop" << "collection" << "empty" << "type" << "collection"));
+    appendInt(data, -1);
+
+    auto block = [&data](const char *collection, int first, int count) {
+        append(data, BSON("db" << "shop" << "collection" << collection << "EOF" << (count == 0)));
+        for (int i = first; i < first + count; ++i)
+            append(data, BSON("i" << i));
+        appendInt(data, -1);
+    };
+    block("orders", 0, 3);
+    block("items", 100, 2);
+    block("orders", 3, 2);
+    block("orders", 0, 0);
+    block("items", 0, 0);
+    block("empty", 0, 0);
+
+    QTemporaryFile temp;
+    ASSERT_TRUE(temp.open());
+    temp.write(data);
+    temp.flush();
+
+    BsonDumpFile file(temp.fileName());
+    waitIndexed(file);
+    EXPECT_TRUE(file.isArchive());
+    EXPECT_TRUE(file.error().empty());
+    EXPECT_EQ(std::vector<std::string>({ "shop.orders", "shop.empty", "shop.items" }), file.namespaces());
+    EXPECT_EQ(5, file.count("shop.orders"));
+    EXPECT_EQ(0, file.count("shop.empty"));
+    EXPECT_EQ(std::vector<int>({ 2, 3, 4 }), values(file.documents("shop.orders", 2, 3)));
+    EXPECT_EQ(std::vector<int>({ 100, 101 }), values(file.documents("shop.items", 0, 10)));
+}
+
+TEST(bson_dump_file_tests, result_archive_is_decompressed)
+{
+    ResultArchive::Index index;
+    index.ns = "shop.orders";
+    QByteArray data = ResultArchive::header();
+    for (int b = 0; b < 3; ++b) {
+        QByteArray raw;
+        for (int i = b * 50; i < (b + 1) * 50; ++i)
+            append(raw, BSON("i" << i));
+        data.append(ResultArchive::compressBlock(raw.constData(), raw.size(), 50, data.size(), index));
+    }
+    data.append(ResultArchive::footer(index, data.size()));
+
+    QTemporaryFile temp;
+    ASSERT_TRUE(temp.open());
+    temp.write(data);
+    temp.flush();
+
+    BsonDumpFile file(temp.fileName());
+    waitIndexed(file);
+    EXPECT_TRUE(file.isResultArchive());
+    EXPECT_FALSE(file.isArchive());
+    EXPECT_TRUE(file.error().empty());
+    EXPECT_EQ(index.rawBytes, file.size());
+    EXPECT_EQ(std::vector<std::string>({ "shop.orders" }), file.namespaces());
+    EXPECT_EQ(150, file.count("shop.orders"));
+    EXPECT_EQ(std::vector<int>({ 48, 49, 50, 51 }), values(file.documents("shop.orders", 48, 4)));
+
+    // Archive cut short is refused, before anything is decompressed
+    QTemporaryFile truncated;
+    ASSERT_TRUE(truncated.open());
+    truncated.write(data.left(data.size() - 1));
+    truncated.flush();
+    EXPECT_THROW(BsonDumpFile(truncated.fileName()), std::runtime_error);
+}
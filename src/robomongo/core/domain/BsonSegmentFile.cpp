@@ -0,0 +1,99 @@
+#include "robomongo/core/domain/BsonSegmentFile.h"
+
+#include <cstring>
+#include <QDir>
+
+namespace Robomongo
+{
+    BsonSegmentFile::BsonSegmentFile() :
+        _file(new QTemporaryFile(QString("%1/" PROJECT_NAME_LOWERCASE "-result-XXXXXX.bson").arg(QDir::tempPath()))),
+        _size(0)
+    {
+    }
+
+    BsonSegmentFile::BsonSegmentFile(QFile *file) :
+        _file(file),
+        _size(0)
+    {
+    }
+
+    BsonSegmentFile::~BsonSegmentFile()
+    {
+        // Mappings are released by QFile on close, file is removed by QTemporaryFile
+    }
+
+    BsonSegmentFilePtr BsonSegmentFile::open(const QString &filePath)
+    {
+        BsonSegmentFilePtr segment(new BsonSegmentFile(new QFile(filePath)));
+        QFile &file = *segment->_file;
+        if (!file.open(QIODevice::ReadOnly))
+            return BsonSegmentFilePtr();
+
+        qint64 const size = file.size();
+        if (size == 0)
+            return segment;
+
+        uchar *data = file.map(0, size);
+        if (!data)
+            return BsonSegmentFilePtr();
+
+        const char *const start = reinterpret_cast<const char *>(data);
+        for (qint64 offset = 0; offset < size; ) {
+            int objsize = 0;
+            if (size - offset < 5)
+                return BsonSegmentFilePtr();
+            memcpy(&objsize, start + offset, sizeof(objsize));     // BSON is little endian, as are supported CPUs
+            if (objsize < 5 || objsize > size - offset)
+                return BsonSegmentFilePtr();
+
+            segment->_index.push_back(start + offset);
+            offset += objsize;
+        }
+
+        segment->_size = size;
+        return segment;
+    }
+
+    bool BsonSegmentFile::append(std::vector<mongo::BSONObj>::const_iterator first,
+                                 std::vector<mongo::BSONObj>::const_iterator last)
+    {
+        if (first == last)
+            return true;
+
+        // Temporary file is created on the first append, open()ed one is read-only
+        if (!_file->isOpen() && !_file->open(QIODevice::ReadWrite))
+            return false;
+        if (!_file->isWritable())
+            return false;
+
+        // Drops partially written documents
+        auto const rollback = [this]() {
+            _file->resize(_size);
+            _file->seek(_size);
+            return false;
+        };
+
+        qint64 written = 0;
+        for (auto it = first; it != last; ++it) {
+            if (_file->write(it->objdata(), it->objsize()) != it->objsize())
+                return rollback();
+            written += it->objsize();
+        }
+
+        if (!_file->flush())
+            return rollback();
+
+        uchar *data = _file->map(_size, written);
+        if (!data)
+            return rollback();
+
+        const char *position = reinterpret_cast<const char *>(data);
+        for (auto it = first; it != last; ++it) {
+            _index.push_back(position);
+            position += it->objsize();
+        }
+
+        _size += written;
+        return true;
+    }
+}
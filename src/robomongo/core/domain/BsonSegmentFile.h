@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QTemporaryFile>
+#include <mongo/bson/bsonobj.h>
+
+#include <memory>
+#include <vector>
+
+#include "robomongo/core/Core.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Append-only temporary file of BSON documents, mapped into memory.
+     *
+     *  Documents are written one after another, in the same binary form as they are
+     *  received from server. Every appended range of file is mapped separately and
+     *  stays mapped until this object is destroyed, so BSONObj returned by document()
+     *  are valid views (not owned) for the lifetime of this file. Pages of mapped file
+     *  are loaded and evicted by OS on demand, instead of occupying process heap.
+     *
+     *  File is removed from disk when this object is destroyed, unless it was open()ed.
+     */
+    class BsonSegmentFile
+    {
+    public:
+        BsonSegmentFile();
+        ~BsonSegmentFile();
+
+        /**
+         * @brief Maps existing file of documents written one after another (i.e. result file of
+         *        WorkspaceSnapshot) as a whole, read-only. File is kept on disk. Only sizes of
+         *        documents are read here, their pages are loaded when documents are used.
+         * @return Null, if file cannot be mapped or does not consist of whole documents
+         */
+        static BsonSegmentFilePtr open(const QString &filePath);
+
+        /**
+         * @brief Appends [first, last) documents to the end of file and maps them.
+         * @return false on I/O error (see errorString()), or if file was open()ed.
+         *         File is not modified in this case.
+         */
+        bool append(std::vector<mongo::BSONObj>::const_iterator first,
+                    std::vector<mongo::BSONObj>::const_iterator last);
+
+        /**
+         * @return Document by index (in order of appending), pointing into mapped memory
+         */
+        mongo::BSONObj document(size_t index) const { return mongo::BSONObj(_index[index]); }
+
+        size_t count() const { return _index.size(); }
+        qint64 size() const { return _size; }
+        QString errorString() const { return _file->errorString(); }
+
+    private:
+        BsonSegmentFile(const BsonSegmentFile&) = delete;
+        BsonSegmentFile& operator=(const BsonSegmentFile&) = delete;
+
+        explicit BsonSegmentFile(QFile *file);
+
+        std::unique_ptr<QFile> _file;   // QTemporaryFile, unless open()ed
+        qint64 _size;
+
+        // Start of every document in mapped memory
+        std::vector<const char *> _index;
+    };
+}
@@ -0,0 +1,100 @@
+#include "robomongo/core/domain/CacheResidency.h"
+
+#include <algorithm>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace Robomongo
+{
+    namespace CacheResidency
+    {
+        namespace
+        {
+            Item &itemOf(std::vector<Item> &items, const std::string &ns, const std::string &index)
+            {
+                for (Item &item : items) {
+                    if (item.index == index)
+                        return item;
+                }
+                items.push_back(Item());
+                items.back().ns = ns;
+                items.back().index = index;
+                return items.back();
+            }
+
+            void addCache(Item &item, const mongo::BSONObj &wiredTiger)
+            {
+                mongo::BSONObj const cache = wiredTiger.getObjectField("cache");
+                item.cachedBytes += cache["bytes currently in the cache"].safeNumberLong();
+                item.readIntoCacheBytes += cache["bytes read into cache"].safeNumberLong();
+            }
+
+            // collStats of mongod or of one shard
+            void addStats(std::vector<Item> &items, const std::string &ns, const mongo::BSONObj &stats)
+            {
+                mongo::BSONObj const wiredTiger = stats.getObjectField("wiredTiger");
+                if (wiredTiger.isEmpty())
+                    return;
+
+                Item &data = itemOf(items, ns, std::string());
+                addCache(data, wiredTiger);
+                data.sizeBytes += stats["size"].safeNumberLong();
+
+                mongo::BSONObj const indexSizes = stats.getObjectField("indexSizes");
+                for (mongo::BSONObjIterator it(stats.getObjectField("indexDetails")); it.more();) {
+                    mongo::BSONElement const details = it.next();
+                    if (details.type() != mongo::Object)
+                        continue;
+
+                    Item &index = itemOf(items, ns, details.fieldName());
+                    addCache(index, details.Obj());
+                    index.sizeBytes += indexSizes[details.fieldName()].safeNumberLong();
+                }
+            }
+        }
+
+        std::vector<Item> itemsOf(const mongo::BSONObj &collStats)
+        {
+            std::vector<Item> items;
+            std::string const ns = collStats.getStringField("ns");
+            if (collStats["shards"].type() != mongo::Object) {
+                addStats(items, ns, collStats);
+                return items;
+            }
+
+            for (mongo::BSONObjIterator it(collStats.getObjectField("shards")); it.more();) {
+                mongo::BSONElement const shard = it.next();
+                if (shard.type() == mongo::Object)
+                    addStats(items, ns, shard.Obj());
+            }
+            return items;
+        }
+
+        double residency(const Item &item)
+        {
+            return item.sizeBytes > 0 ? static_cast<double>(item.cachedBytes) / item.sizeBytes : 0.0;
+        }
+
+        void rank(std::vector<Item> &items)
+        {
+            std::stable_sort(items.begin(), items.end(), [](const Item &left, const Item &right) {
+                return left.cachedBytes > right.cachedBytes;
+            });
+        }
+
+        size_t hotCount(const std::vector<Item> &ranked, double share)
+        {
+            long long total = 0;
+            for (Item const &item : ranked)
+                total += item.cachedBytes;
+            if (total == 0)
+                return 0;
+
+            long long sum = 0;
+            size_t count = 0;
+            while (count < ranked.size() && sum < share * total)
+                sum += ranked[count++].cachedBytes;
+            return count;
+        }
+    }
+}
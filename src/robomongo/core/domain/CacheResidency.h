@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Residency of collections and indexes in WiredTiger cache, read from "cache"
+     *        sections of collStats with indexDetails. Collections and indexes are ranked by
+     *        bytes in cache, so that the ones forming working set are seen first.
+     */
+    namespace CacheResidency
+    {
+        struct Item
+        {
+            std::string ns;
+            std::string index;                  // empty for data of collection
+            long long cachedBytes = 0;          // "bytes currently in the cache"
+            long long sizeBytes = 0;            // uncompressed data size, file size of index
+            long long readIntoCacheBytes = 0;   // since server start
+        };
+
+        /**
+         * @brief Data of collection followed by its indexes. Sharded collStats on mongos
+         *        is summed over shards.
+         * @return Empty, if storage engine is not WiredTiger
+         */
+        std::vector<Item> itemsOf(const mongo::BSONObj &collStats);
+
+        // Bytes in cache to size, 0 if size is unknown
+        double residency(const Item &item);
+
+        // Sorts by bytes in cache, the largest first
+        void rank(std::vector<Item> &items);
+
+        // Number of first ranked items holding 'share' (0..1) of all cached bytes
+        size_t hotCount(const std::vector<Item> &ranked, double share);
+    }
+}
@@ -0,0 +1,69 @@
+#include "gtest/gtest.h"
+#include "CacheResidency.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    mongo::BSONObj cache(long long cached, long long read)
+    {
+        return BSON("cache" << BSON("bytes currently in the cache" << cached << "bytes read into cache" << read));
+    }
+
+    mongo::BSONObj shardStats(long long dataCached, long long indexCached)
+    {
+        return BSON("size" << 1000 << "wiredTiger" << cache(dataCached, 10) <<
+                    "indexSizes" << BSON("_id_" << 200) <<
+                    "indexDetails" << BSON("_id_" << cache(indexCached, 5)));
+    }
+}
+
+TEST(cache_residency_tests, items_of_collection_and_indexes)
+{
+    mongo::BSONObj const stats = BSON("ns" << "db.orders" << "size" << 4000 << "wiredTiger" << cache(1000, 7) <<
+                                      "indexSizes" << BSON("_id_" << 400 << "a_1" << 100) <<
+                                      "indexDetails" << BSON("_id_" << cache(100, 1) << "a_1" << cache(100, 2)));
+
+    std::vector<CacheResidency::Item> const items = CacheResidency::itemsOf(stats);
+    ASSERT_EQ(3u, items.size());
+    EXPECT_EQ("db.orders", items[0].ns);
+    EXPECT_TRUE(items[0].index.empty());
+    EXPECT_EQ(1000, items[0].cachedBytes);
+    EXPECT_DOUBLE_EQ(0.25, CacheResidency::residency(items[0]));
+    EXPECT_EQ("a_1", items[2].index);
+    EXPECT_DOUBLE_EQ(1.0, CacheResidency::residency(items[2]));
+
+    EXPECT_TRUE(CacheResidency::itemsOf(BSON("ns" << "db.view")).empty());
+}
+
+TEST(cache_residency_tests, sharded_stats_are_summed)
+{
+    mongo::BSONObj const stats = BSON("ns" << "db.c" << "sharded" << true <<
+                                      "shards" << BSON("s1" << shardStats(300, 20) << "s2" << shardStats(100, 40)));
+
+    std::vector<CacheResidency::Item> const items = CacheResidency::itemsOf(stats);
+    ASSERT_EQ(2u, items.size());
+    EXPECT_EQ(400, items[0].cachedBytes);
+    EXPECT_EQ(2000, items[0].sizeBytes);
+    EXPECT_EQ(20, items[0].readIntoCacheBytes);
+    EXPECT_EQ(60, items[1].cachedBytes);
+    EXPECT_EQ(400, items[1].sizeBytes);
+}
+
+TEST(cache_residency_tests, hot_items_hold_share_of_cache)
+{
+    std::vector<CacheResidency::Item> items(4);
+    items[0].cachedBytes = 10;
+    items[1].cachedBytes = 700;
+    items[2].cachedBytes = 0;
+    items[3].cachedBytes = 290;
+
+    CacheResidency::rank(items);
+    EXPECT_EQ(700, items[0].cachedBytes);
+    EXPECT_EQ(0, items[3].cachedBytes);
+    EXPECT_EQ(1u, CacheResidency::hotCount(items, 0.5));
+    EXPECT_EQ(2u, CacheResidency::hotCount(items, 0.8));
+    EXPECT_EQ(0u, CacheResidency::hotCount(std::vector<CacheResidency::Item>(2), 0.8));
+}
@@ -0,0 +1,101 @@
+#include "robomongo/core/domain/ChangeStreamWatch.h"
+
+#include <algorithm>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace Robomongo
+{
+    namespace ChangeStreamWatch
+    {
+        namespace
+        {
+            // Events after which server closes the stream
+            const char *const ClosingTypes[] = { "drop", "rename", "dropDatabase", "invalidate" };
+        }
+
+        mongo::BSONArray pipeline(const Filter &filter)
+        {
+            mongo::BSONObjBuilder stage;
+            if (filter.fullDocument)
+                stage.append("fullDocument", "updateLookup");
+            if (!filter.resumeAfter.isEmpty())
+                stage.append("resumeAfter", filter.resumeAfter);
+
+            mongo::BSONArrayBuilder result;
+            result.append(BSON("$changeStream" << stage.obj()));
+
+            mongo::BSONArrayBuilder conditions;
+            if (!filter.operationTypes.empty()) {
+                mongo::BSONArrayBuilder types;
+                for (auto const &type : filter.operationTypes)
+                    types.append(type);
+                for (auto const type : ClosingTypes)
+                    types.append(type);
+                conditions.append(BSON("operationType" << BSON("$in" << types.arr())));
+            }
+            if (!filter.match.isEmpty()) {
+                // Closing events have no documents, they pass the user's match too
+                mongo::BSONArrayBuilder closing;
+                for (auto const type : ClosingTypes)
+                    closing.append(type);
+                conditions.append(BSON("$or" << BSON_ARRAY(
+                    filter.match << BSON("operationType" << BSON("$in" << closing.arr())))));
+            }
+
+            mongo::BSONArray const all = conditions.arr();
+            if (all.nFields() == 1)
+                result.append(BSON("$match" << all.firstElement().Obj()));
+            else if (all.nFields() > 1)
+                result.append(BSON("$match" << BSON("$and" << all)));
+            return result.arr();
+        }
+
+        std::string operationType(const mongo::BSONObj &event)
+        {
+            std::string const type = event.getStringField("operationType");
+            return type.empty() ? "unknown" : type;
+        }
+
+        void RateMeter::add(const std::string &operationType, long long nowMs, long long count)
+        {
+            long long const second = nowMs / 1000;
+            if (_startSecond < 0)
+                _startSecond = second;
+
+            Counter &counter = _counters[operationType];
+            counter.total += count;
+            if (!counter.seconds.empty() && counter.seconds.back().first == second)
+                counter.seconds.back().second += count;
+            else
+                counter.seconds.push_back(std::make_pair(second, count));
+
+            while (counter.seconds.front().first < second - WindowSeconds)
+                counter.seconds.pop_front();
+        }
+
+        void RateMeter::clear()
+        {
+            _counters.clear();
+            _startSecond = -1;
+        }
+
+        std::vector<RateMeter::Rate> RateMeter::rates(long long nowMs) const
+        {
+            long long const now = nowMs / 1000;
+            // Meter opened a moment ago is averaged over the seconds it has seen
+            long long const window = std::max(1LL, std::min<long long>(WindowSeconds, now - _startSecond));
+
+            std::vector<Rate> result;
+            for (auto const &it : _counters) {
+                long long events = 0;
+                for (auto const &second : it.second.seconds) {
+                    if (second.first >= now - window && second.first < now)
+                        events += second.second;
+                }
+                result.push_back({ it.first, static_cast<double>(events) / window, it.second.total });
+            }
+            return result;
+        }
+    }
+}
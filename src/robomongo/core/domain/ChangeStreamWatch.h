@@ -0,0 +1,70 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Change stream of one collection for change stream panel (see ChangeStreamDialog).
+     *        Events are filtered by server with $match, so that only matching ones are transferred.
+     */
+    namespace ChangeStreamWatch
+    {
+        struct Filter
+        {
+            std::vector<std::string> operationTypes;    // "insert", "update", ...; all of them if empty
+            mongo::BSONObj match;                       // on fields of change event, i.e. { "fullDocument.status": "A" }
+            bool fullDocument = false;                  // updates look up the current document
+            mongo::BSONObj resumeAfter;                 // _id of the last seen event, now if empty
+        };
+
+        /**
+         * @brief Pipeline of { aggregate: <collection> }. Events that end the stream (drop,
+         *        rename, invalidate) always pass, so that panel shows why it was closed.
+         */
+        mongo::BSONArray pipeline(const Filter &filter);
+
+        /**
+         * @brief Type of event, "unknown" if it has none
+         */
+        std::string operationType(const mongo::BSONObj &event);
+
+        /**
+         * @brief Events per second of each operation type over the last WindowSeconds complete
+         *        seconds, so that meter does not jump with every coalesced batch
+         */
+        class RateMeter
+        {
+        public:
+            static const int WindowSeconds = 5;
+
+            struct Rate
+            {
+                std::string operationType;
+                double perSecond;
+                long long total;
+            };
+
+            void add(const std::string &operationType, long long nowMs, long long count = 1);
+            void clear();
+
+            // In order of operation type
+            std::vector<Rate> rates(long long nowMs) const;
+
+        private:
+            struct Counter
+            {
+                long long total = 0;
+                std::deque<std::pair<long long, long long>> seconds;   // second, events
+            };
+
+            std::map<std::string, Counter> _counters;
+            long long _startSecond = -1;
+        };
+    }
+}
@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+#include "ChangeStreamWatch.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    mongo::BSONObj stage(const mongo::BSONArray &pipeline, int index)
+    {
+        return pipeline[std::to_string(index)].Obj();
+    }
+}
+
+TEST(change_stream_watch_tests, pipeline_of_filter)
+{
+    ChangeStreamWatch::Filter filter;
+    mongo::BSONArray all = ChangeStreamWatch::pipeline(filter);
+    ASSERT_EQ(1, all.nFields());
+    EXPECT_TRUE(stage(all, 0)["$changeStream"].Obj().isEmpty());
+
+    filter.operationTypes = { "insert", "delete" };
+    filter.fullDocument = true;
+    filter.resumeAfter = BSON("_data" << "8263");
+    mongo::BSONArray const byType = ChangeStreamWatch::pipeline(filter);
+    ASSERT_EQ(2, byType.nFields());
+    mongo::BSONObj const options = stage(byType, 0)["$changeStream"].Obj();
+    EXPECT_EQ("updateLookup", std::string(options.getStringField("fullDocument")));
+    EXPECT_EQ("8263", std::string(options.getObjectField("resumeAfter").getStringField("_data")));
+    std::vector<mongo::BSONElement> const types = stage(byType, 1)["$match"].Obj()["operationType"].Obj()["$in"].Array();
+    ASSERT_EQ(6u, types.size());
+    EXPECT_EQ("insert", types[0].String());
+    EXPECT_EQ("invalidate", types[5].String());
+
+    filter.match = BSON("fullDocument.status" << "A");
+    mongo::BSONArray const matched = ChangeStreamWatch::pipeline(filter);
+    ASSERT_EQ(2, matched.nFields());
+    EXPECT_EQ(2u, stage(matched, 1)["$match"].Obj()["$and"].Array().size());
+}
+
+TEST(change_stream_watch_tests, operation_type)
+{
+    EXPECT_EQ("update", ChangeStreamWatch::operationType(BSON("operationType" << "update")));
+    EXPECT_EQ("unknown", ChangeStreamWatch::operationType(BSON("_id" << 1)));
+}
+
+TEST(change_stream_watch_tests, rates_over_window)
+{
+    ChangeStreamWatch::RateMeter meter;
+    EXPECT_TRUE(meter.rates(0).empty());
+
+    // 10 inserts/s for 10 s, deletes in the first second only
+    for (long long ms = 0; ms < 10000; ms += 100)
+        meter.add("insert", ms);
+    meter.add("delete", 500, 20);
+
+    std::vector<ChangeStreamWatch::RateMeter::Rate> rates = meter.rates(10000);
+    ASSERT_EQ(2u, rates.size());
+    EXPECT_EQ("delete", rates[0].operationType);
+    EXPECT_DOUBLE_EQ(0, rates[0].perSecond);
+    EXPECT_EQ(20, rates[0].total);
+    EXPECT_EQ("insert", rates[1].operationType);
+    EXPECT_DOUBLE_EQ(10, rates[1].perSecond);
+    EXPECT_EQ(100, rates[1].total);
+
+    // The first second is averaged over itself only
+    meter.clear();
+    meter.add("update", 200, 30);
+    rates = meter.rates(1500);
+    ASSERT_EQ(1u, rates.size());
+    EXPECT_DOUBLE_EQ(30, rates[0].perSecond);
+}
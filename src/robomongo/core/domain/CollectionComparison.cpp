@@ -0,0 +1,111 @@
+#include "robomongo/core/domain/CollectionComparison.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    unsigned long long mix(unsigned long long hash)
+    {
+        hash ^= hash >> 30;
+        hash *= 0xbf58476d1ce4e5b9ULL;
+        hash ^= hash >> 27;
+        hash *= 0x94d049bb133111ebULL;
+        return hash ^ (hash >> 31);
+    }
+
+    unsigned long long rotateLeft(unsigned long long value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    bool idLess(const Robomongo::CollectionComparison::Entry &a, const Robomongo::CollectionComparison::Entry &b)
+    {
+        return a.id.woCompare(b.id, mongo::BSONObj(), false) < 0;
+    }
+}
+
+namespace Robomongo
+{
+    CollectionComparison::CollectionComparison(size_t maxDifferences /* = DefaultMaxDifferences */) :
+        _maxDifferences(maxDifferences)
+    {
+    }
+
+    unsigned long long CollectionComparison::documentHash(const mongo::BSONObj &document)
+    {
+        // Eight bytes per step, documents are read at network speed and hashed on the fly
+        const char *const data = document.objdata();
+        size_t const size = document.objsize();
+        unsigned long long hash = 0x9e3779b97f4a7c15ULL ^ size;
+        size_t offset = 0;
+        for (; offset + 8 <= size; offset += 8) {
+            unsigned long long word;
+            std::memcpy(&word, data + offset, 8);
+            hash = rotateLeft(hash ^ (word * 0x87c37b91114253d5ULL), 31) * 0x4cf5ad432745937fULL;
+        }
+
+        unsigned long long tail = 0;
+        std::memcpy(&tail, data + offset, size - offset);
+        hash ^= tail * 0x87c37b91114253d5ULL;
+        return mix(hash);
+    }
+
+    CollectionComparison::Entry CollectionComparison::entry(const mongo::BSONObj &document)
+    {
+        Entry entry;
+        entry.id = document["_id"].wrap();
+        entry.hash = documentHash(document);
+        return entry;
+    }
+
+    void CollectionComparison::diffRange(std::vector<Entry> source, std::vector<Entry> target)
+    {
+        // Index order of _id may follow collation of collection, so both are sorted the same way here
+        std::sort(source.begin(), source.end(), idLess);
+        std::sort(target.begin(), target.end(), idLess);
+
+        size_t i = 0, j = 0;
+        while (i < source.size() || j < target.size()) {
+            int const order = i == source.size() ? 1 : j == target.size() ? -1 :
+                              source[i].id.woCompare(target[j].id, mongo::BSONObj(), false);
+            if (order < 0) {
+                add(MissingInTarget, source[i++].id);
+            }
+            else if (order > 0) {
+                add(OnlyInTarget, target[j++].id);
+            }
+            else {
+                if (source[i].hash != target[j].hash)
+                    add(Changed, source[i].id);
+                ++i;
+                ++j;
+            }
+        }
+    }
+
+    void CollectionComparison::merge(const CollectionComparison &other)
+    {
+        for (int kind = 0; kind < DifferenceKindCount; ++kind)
+            _counts[kind] += other._counts[kind];
+
+        size_t const room = _maxDifferences - std::min(_maxDifferences, _differences.size());
+        size_t const taken = std::min(room, other._differences.size());
+        _differences.insert(_differences.end(), other._differences.begin(), other._differences.begin() + taken);
+    }
+
+    long long CollectionComparison::differenceCount() const
+    {
+        long long total = 0;
+        for (long long const count : _counts)
+            total += count;
+        return total;
+    }
+
+    void CollectionComparison::add(DifferenceKind kind, const mongo::BSONObj &id)
+    {
+        ++_counts[kind];
+        if (_differences.size() < _maxDifferences)
+            _differences.push_back(Difference{ kind, id });
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Compares collection of two servers range by range of _id. Every range is reduced
+     *        to Digest (count and order-independent sum of hashes of raw BSON of documents) on
+     *        both sides, only ranges with different digests are compared document by document.
+     */
+    class CollectionComparison
+    {
+    public:
+        static const size_t DefaultMaxDifferences = 1000;
+
+        enum DifferenceKind
+        {
+            MissingInTarget,
+            OnlyInTarget,
+            Changed,
+            DifferenceKindCount
+        };
+
+        struct Difference
+        {
+            DifferenceKind kind;
+            mongo::BSONObj id;      // { _id: ... }
+        };
+
+        struct Entry
+        {
+            mongo::BSONObj id;      // { _id: ... }
+            unsigned long long hash = 0;
+        };
+
+        struct Digest
+        {
+            void add(unsigned long long hash) { ++documents; hashSum += hash; }
+
+            bool operator==(const Digest &other) const {
+                return documents == other.documents && hashSum == other.hashSum;
+            }
+            bool operator!=(const Digest &other) const { return !(*this == other); }
+
+            long long documents = 0;
+            unsigned long long hashSum = 0;
+        };
+
+        // At most 'maxDifferences' are kept, all of them are counted
+        explicit CollectionComparison(size_t maxDifferences = DefaultMaxDifferences);
+
+        // 64-bit hash of raw bytes of document, so field order and types matter
+        static unsigned long long documentHash(const mongo::BSONObj &document);
+        static Entry entry(const mongo::BSONObj &document);
+
+        // Merges all entries of one range of both sides, in any order
+        void diffRange(std::vector<Entry> source, std::vector<Entry> target);
+
+        // Adds differences of comparison of other ranges
+        void merge(const CollectionComparison &other);
+
+        const std::vector<Difference> &differences() const { return _differences; }
+        long long count(DifferenceKind kind) const { return _counts[kind]; }
+        long long differenceCount() const;
+
+    private:
+        void add(DifferenceKind kind, const mongo::BSONObj &id);
+
+        size_t const _maxDifferences;
+        std::vector<Difference> _differences;
+        long long _counts[DifferenceKindCount] = {};
+    };
+}
@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+#include "CollectionComparison.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+TEST(collection_comparison_tests, hash_depends_on_bytes)
+{
+    mongo::BSONObj const a = BSON("_id" << 1 << "x" << 1 << "y" << 2);
+    EXPECT_EQ(CollectionComparison::documentHash(a),
+              CollectionComparison::documentHash(BSON("_id" << 1 << "x" << 1 << "y" << 2)));
+    EXPECT_NE(CollectionComparison::documentHash(a),
+              CollectionComparison::documentHash(BSON("_id" << 1 << "y" << 2 << "x" << 1)));
+    EXPECT_NE(CollectionComparison::documentHash(a),
+              CollectionComparison::documentHash(BSON("_id" << 1 << "x" << 1.0 << "y" << 2)));
+}
+
+TEST(collection_comparison_tests, digest_ignores_order)
+{
+    CollectionComparison::Digest source, target;
+    for (int i = 0; i < 10; ++i) {
+        source.add(CollectionComparison::documentHash(BSON("_id" << i)));
+        target.add(CollectionComparison::documentHash(BSON("_id" << 9 - i)));
+    }
+    EXPECT_TRUE(source == target);
+
+    target.add(CollectionComparison::documentHash(BSON("_id" << 10)));
+    EXPECT_TRUE(source != target);
+}
+
+TEST(collection_comparison_tests, range_diff_finds_every_kind)
+{
+    std::vector<CollectionComparison::Entry> source, target;
+    for (int i = 0; i < 5; ++i)
+        source.push_back(CollectionComparison::entry(BSON("_id" << i << "v" << 1)));
+    for (int i = 5; i >= 1; --i)
+        target.push_back(CollectionComparison::entry(BSON("_id" << i << "v" << (i == 3 ? 2 : 1))));
+
+    CollectionComparison comparison(2);
+    comparison.diffRange(source, target);
+    EXPECT_EQ(1, comparison.count(CollectionComparison::MissingInTarget));
+    EXPECT_EQ(1, comparison.count(CollectionComparison::OnlyInTarget));
+    EXPECT_EQ(1, comparison.count(CollectionComparison::Changed));
+    EXPECT_EQ(3, comparison.differenceCount());
+
+    // Only the first two are kept, ordered by _id
+    ASSERT_EQ(2u, comparison.differences().size());
+    EXPECT_EQ(CollectionComparison::MissingInTarget, comparison.differences()[0].kind);
+    EXPECT_EQ(0, comparison.differences()[0].id["_id"].numberInt());
+    EXPECT_EQ(CollectionComparison::Changed, comparison.differences()[1].kind);
+    EXPECT_EQ(3, comparison.differences()[1].id["_id"].numberInt());
+}
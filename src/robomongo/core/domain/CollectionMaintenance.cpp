@@ -0,0 +1,84 @@
+#include "robomongo/core/domain/CollectionMaintenance.h"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+namespace Robomongo
+{
+    namespace CollectionMaintenance
+    {
+        const char *const NamePlaceholder = "{name}";
+
+        std::string renamedName(const std::string &pattern, const std::string &collection)
+        {
+            std::string const placeholder = NamePlaceholder;
+            if (pattern.find(placeholder) == std::string::npos)
+                throw std::invalid_argument("Pattern must contain " + placeholder);
+
+            std::string name;
+            size_t from = 0;
+            for (size_t at = pattern.find(placeholder); at != std::string::npos;
+                 from = at + placeholder.size(), at = pattern.find(placeholder, from)) {
+                name += pattern.substr(from, at - from);
+                name += collection;
+            }
+            name += pattern.substr(from);
+            return name;
+        }
+
+        IndexInfo indexFor(const Action &action, const std::string &ns)
+        {
+            IndexInfo info = action.index;
+            info._collection = MongoCollectionInfo(ns);
+            return info;
+        }
+
+        std::string describe(const Action &action)
+        {
+            switch (action.kind) {
+            case Action::CreateIndex: return "Create index \"" + action.index._name + "\"";
+            case Action::DropIndex: return "Drop index \"" + action.index._name + "\"";
+            case Action::RenameCollection: return "Rename to \"" + action.renamePattern + "\"";
+            case Action::DropCollection: return "Drop collection";
+            }
+            return std::string();
+        }
+
+        std::string failureSummary(const std::vector<ItemResult> &results, size_t maxNames)
+        {
+            // Errors in order of their first failure, so that equal counts keep that order
+            std::vector<std::string> errors;
+            std::map<std::string, std::vector<std::string>> collections;
+            for (auto const &result : results) {
+                if (result.ok)
+                    continue;
+
+                auto &names = collections[result.error];
+                if (names.empty())
+                    errors.push_back(result.error);
+                names.push_back(result.collection);
+            }
+
+            std::stable_sort(errors.begin(), errors.end(), [&collections](const std::string &left,
+                                                                          const std::string &right) {
+                return collections[left].size() > collections[right].size();
+            });
+
+            std::string summary;
+            for (auto const &error : errors) {
+                std::vector<std::string> const &names = collections[error];
+                if (!summary.empty())
+                    summary += "\n";
+                summary += std::to_string(names.size()) + (names.size() == 1 ? " collection: " : " collections: ");
+                summary += error + " (";
+                for (size_t i = 0; i < names.size() && i < maxNames; ++i)
+                    summary += (i ? ", " : "") + names[i];
+                if (names.size() > maxNames)
+                    summary += ", ...";
+                summary += ")";
+            }
+            return summary;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "robomongo/core/events/MongoEventsInfo.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief The same DDL action run on many collections of one database, i.e. the same index
+     *        added to every tenant collection. Collections are processed on several connections
+     *        at once (see MongoWorker::handle(CollectionMaintenanceRequest *)), every one is
+     *        reported as it finishes and failures do not stop the others.
+     */
+    namespace CollectionMaintenance
+    {
+        // Placeholder of collection name in rename pattern
+        extern const char *const NamePlaceholder;
+
+        struct Action
+        {
+            enum Kind { CreateIndex, DropIndex, RenameCollection, DropCollection };
+
+            Kind kind;
+            IndexInfo index;            // CreateIndex: applied to every collection; DropIndex: its name
+            std::string renamePattern;  // RenameCollection, i.e. "archive_{name}"
+
+            Action(Kind kind, const IndexInfo &index = IndexInfo(MongoCollectionInfo()),
+                   const std::string &renamePattern = std::string()) :
+                kind(kind), index(index), renamePattern(renamePattern) {}
+        };
+
+        struct ItemResult
+        {
+            std::string collection;
+            bool ok = true;
+            std::string error;
+            long long elapsedMs = 0;
+        };
+
+        /**
+         * @brief New name of 'collection' by 'pattern', every NamePlaceholder is replaced by it
+         * @throws std::invalid_argument, if pattern has no placeholder (all collections would
+         *         get one name)
+         */
+        std::string renamedName(const std::string &pattern, const std::string &collection);
+
+        // Index of 'action' for collection 'ns'
+        IndexInfo indexFor(const Action &action, const std::string &ns);
+
+        // I.e. "Create index \"tenant_1\"", of the whole batch
+        std::string describe(const Action &action);
+
+        /**
+         * @brief Failed items grouped by error, the most frequent first, i.e.
+         *        "12 collections: index already exists with different options (orders_a, ...)"
+         *        Empty, if nothing failed.
+         * @param maxNames Names listed per error
+         */
+        std::string failureSummary(const std::vector<ItemResult> &results, size_t maxNames = 3);
+    }
+}
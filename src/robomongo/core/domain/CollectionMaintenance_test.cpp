@@ -0,0 +1,44 @@
+#include "gtest/gtest.h"
+#include "CollectionMaintenance.h"
+
+using namespace Robomongo;
+
+TEST(collection_maintenance_tests, renamed_name_by_pattern)
+{
+    EXPECT_EQ("archive_orders", CollectionMaintenance::renamedName("archive_{name}", "orders"));
+    EXPECT_EQ("orders_orders_v2", CollectionMaintenance::renamedName("{name}_{name}_v2", "orders"));
+    EXPECT_THROW(CollectionMaintenance::renamedName("archive", "orders"), std::invalid_argument);
+}
+
+TEST(collection_maintenance_tests, index_for_collection)
+{
+    CollectionMaintenance::Action const action(CollectionMaintenance::Action::CreateIndex,
+        IndexInfo(MongoCollectionInfo("shop.tenant_a"), "tenant_1", "{ \"tenant\" : 1 }", true));
+
+    IndexInfo const info = CollectionMaintenance::indexFor(action, "shop.tenant_b");
+    EXPECT_EQ("shop.tenant_b", info._collection.ns().toString());
+    EXPECT_EQ("tenant_1", info._name);
+    EXPECT_TRUE(info._unique);
+    EXPECT_EQ("Create index \"tenant_1\"", CollectionMaintenance::describe(action));
+}
+
+TEST(collection_maintenance_tests, failures_grouped_by_error)
+{
+    auto item = [](const std::string &collection, const std::string &error) {
+        CollectionMaintenance::ItemResult result;
+        result.collection = collection;
+        result.ok = error.empty();
+        result.error = error;
+        return result;
+    };
+
+    EXPECT_EQ("", CollectionMaintenance::failureSummary({ item("a", "") }));
+
+    std::vector<CollectionMaintenance::ItemResult> const results = {
+        item("a", "not authorized"), item("b", "exists"), item("c", ""),
+        item("d", "exists"), item("e", "exists"), item("f", "exists")
+    };
+    EXPECT_EQ("4 collections: exists (b, d, e, ...)\n"
+              "1 collection: not authorized (a)",
+              CollectionMaintenance::failureSummary(results));
+}
@@ -0,0 +1,43 @@
+#include "robomongo/core/domain/CollectionNamesVersion.h"
+
+#include <mutex>
+#include <QHash>
+
+namespace
+{
+    std::mutex versionsMutex;
+    QHash<QString, unsigned long long> versions;
+
+    // Substrings of shell helpers and commands which could change collection names
+    char const *const NameChangingWords[] = {
+        "create", "drop", "rename", "insert", "save", "update", "replace", "Modify", "aggregate",
+        "mapReduce", "copyTo", "runCommand", "adminCommand", "eval"
+    };
+}
+
+namespace Robomongo
+{
+    namespace CollectionNamesVersion
+    {
+        void bump(const QString &connection)
+        {
+            std::lock_guard<std::mutex> lock(versionsMutex);
+            ++versions[connection];
+        }
+
+        unsigned long long current(const QString &connection)
+        {
+            std::lock_guard<std::mutex> lock(versionsMutex);
+            return versions.value(connection, 0);
+        }
+
+        bool mayChangeNames(const std::string &script)
+        {
+            for (char const *word : NameChangingWords) {
+                if (script.find(word) != std::string::npos)
+                    return true;
+            }
+            return false;
+        }
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <QString>
+
+namespace Robomongo
+{
+    /**
+     * @brief Version of collection names of connection record (by its uuid), increased
+     *        when names could have changed: explorer loaded them, collection or database
+     *        was created, dropped or renamed by this program or by change stream.
+     *        Shells compare it with the version of their autocompletion cache instead of
+     *        listing collections periodically. Thread safe.
+     */
+    namespace CollectionNamesVersion
+    {
+        void bump(const QString &connection);
+
+        // 0 if names were never changed
+        unsigned long long current(const QString &connection);
+
+        // True, if script could create, drop or rename collections (i.e. insert into new one)
+        bool mayChangeNames(const std::string &script);
+    }
+}
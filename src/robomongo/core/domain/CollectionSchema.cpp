@@ -0,0 +1,118 @@
+#include "robomongo/core/domain/CollectionSchema.h"
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <set>
+#include <mongo/bson/bsonobj.h>
+#include <mongo/bson/bsonobjiterator.h>
+#include <mongo/bson/bsontypes.h>
+
+namespace
+{
+    struct PathStats
+    {
+        int count = 0;
+        std::map<int, int> types;   // BSONType -> occurrences
+    };
+
+    typedef std::map<std::string, PathStats> Paths;
+
+    void collect(const mongo::BSONObj &obj, const std::string &path, int depth, int maxDepth,
+                 size_t maxFields, Paths &paths, std::set<std::string> &seen)
+    {
+        for (mongo::BSONObjIterator it(obj); it.more();) {
+            mongo::BSONElement const element = it.next();
+            std::string const name = path + element.fieldName();
+
+            auto found = paths.find(name);
+            if (found == paths.end()) {
+                if (paths.size() >= maxFields)
+                    continue;
+                found = paths.emplace(name, PathStats()).first;
+            }
+
+            // Field of subdocuments in array is counted once per document
+            if (seen.insert(name).second)
+                ++found->second.count;
+            ++found->second.types[element.type()];
+
+            if (depth + 1 >= maxDepth)
+                continue;
+
+            if (element.type() == mongo::Object) {
+                collect(element.Obj(), name + ".", depth + 1, maxDepth, maxFields, paths, seen);
+            }
+            else if (element.type() == mongo::Array) {
+                for (mongo::BSONObjIterator item(element.Obj()); item.more();) {
+                    mongo::BSONElement const value = item.next();
+                    if (value.type() == mongo::Object)
+                        collect(value.Obj(), name + ".", depth + 1, maxDepth, maxFields, paths, seen);
+                }
+            }
+        }
+    }
+
+    bool isIdentifier(const std::string &name)
+    {
+        if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+            return false;
+
+        return std::all_of(name.begin(), name.end(), [](char ch) {
+            return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_' || ch == '$';
+        });
+    }
+}
+
+namespace Robomongo
+{
+    CollectionSchema CollectionSchema::infer(const std::vector<mongo::BSONObj> &documents,
+                                             int maxDepth /* = 3 */, size_t maxFields /* = 500 */)
+    {
+        Paths paths;
+        for (mongo::BSONObj const &document : documents) {
+            std::set<std::string> seen;
+            collect(document, "", 0, maxDepth, maxFields, paths, seen);
+        }
+
+        CollectionSchema schema;
+        schema.sampledDocuments = documents.size();
+        schema.fields.reserve(paths.size());
+        for (auto const &path : paths) {
+            auto const type = std::max_element(path.second.types.begin(), path.second.types.end(),
+                [](const std::pair<const int, int> &a, const std::pair<const int, int> &b) {
+                    return a.second < b.second;
+                });
+
+            SchemaField field;
+            field.path = path.first;
+            field.type = mongo::typeName(static_cast<mongo::BSONType>(type->first));
+            field.count = path.second.count;
+            schema.fields.push_back(field);
+        }
+        return schema;
+    }
+
+    std::vector<std::string> CollectionSchema::complete(const std::string &prefix,
+                                                        size_t maxResults /* = 100 */) const
+    {
+        auto it = std::lower_bound(fields.begin(), fields.end(), prefix,
+            [](const SchemaField &field, const std::string &value) { return field.path < value; });
+
+        std::vector<SchemaField const *> matched;
+        for (; it != fields.end() && it->path.compare(0, prefix.size(), prefix) == 0; ++it)
+            matched.push_back(&*it);
+
+        std::stable_sort(matched.begin(), matched.end(), [](const SchemaField *a, const SchemaField *b) {
+            return a->count > b->count;
+        });
+
+        std::vector<std::string> result;
+        for (SchemaField const *field : matched) {
+            if (result.size() >= maxResults)
+                break;
+            result.push_back(isIdentifier(field->path) ? field->path : "'" + field->path + "'");
+        }
+        return result;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace mongo
+{
+    class BSONObj;
+}
+
+namespace Robomongo
+{
+    struct SchemaField
+    {
+        std::string path;   // dotted, i.e. "address.city"
+        std::string type;   // most frequent BSON type name
+        int count = 0;      // number of sampled documents with this field
+    };
+
+    /**
+     * @brief Field paths of collection, inferred from sample of its documents
+     */
+    struct CollectionSchema
+    {
+        std::vector<SchemaField> fields;    // sorted by path
+        int sampledDocuments = 0;
+        long long sampledAt = 0;            // seconds since epoch
+
+        /**
+         * @brief Collects paths of documents, arrays of subdocuments are descended as well
+         *        ("tags.name"). Paths deeper than 'maxDepth' or over 'maxFields' are dropped.
+         */
+        static CollectionSchema infer(const std::vector<mongo::BSONObj> &documents,
+                                      int maxDepth = 3, size_t maxFields = 500);
+
+        /**
+         * @return Paths starting with 'prefix', most frequent first. Paths which are not
+         *         identifiers are quoted, so that completion is a valid key of JS object.
+         */
+        std::vector<std::string> complete(const std::string &prefix, size_t maxResults = 100) const;
+    };
+}
@@ -0,0 +1,223 @@
+#include "robomongo/core/domain/CompletionIndex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <regex>
+#include <mongo/bson/bsonobj.h>
+#include <mongo/bson/bsonobjiterator.h>
+
+namespace
+{
+    // Functions end with "(", as in completions of shell
+    const char *const Globals[] = {
+        "BinData(", "DBRef(", "Date(", "HexData(", "ISODate(", "MaxKey", "MinKey", "NumberDecimal(",
+        "NumberInt(", "NumberLong(", "ObjectId(", "Timestamp(", "UUID(", "db", "load(", "print(",
+        "printjson(", "quit(", "rs", "sh", "show", "sleep(", "tojson(", "use"
+    };
+
+    const char *const DbMethods[] = {
+        "adminCommand(", "aggregate(", "createCollection(", "createUser(", "createView(",
+        "currentOp(", "dropDatabase(", "dropUser(", "getCollection(", "getCollectionInfos(",
+        "getCollectionNames(", "getLastError(", "getMongo(", "getName(", "getProfilingLevel(",
+        "getProfilingStatus(", "getSiblingDB(", "getUser(", "getUsers(", "hostInfo(", "isMaster(",
+        "killOp(", "listCommands(", "printCollectionStats(", "runCommand(", "serverStatus(",
+        "setProfilingLevel(", "stats(", "version("
+    };
+
+    const char *const CollectionMethods[] = {
+        "aggregate(", "bulkWrite(", "count(", "countDocuments(", "createIndex(", "createIndexes(",
+        "deleteMany(", "deleteOne(", "distinct(", "drop(", "dropIndex(", "dropIndexes(",
+        "estimatedDocumentCount(", "explain(", "find(", "findAndModify(", "findOne(",
+        "findOneAndDelete(", "findOneAndReplace(", "findOneAndUpdate(", "getIndexes(", "insert(",
+        "insertMany(", "insertOne(", "mapReduce(", "reIndex(", "remove(", "renameCollection(",
+        "replaceOne(", "save(", "stats(", "storageSize(", "totalIndexSize(", "totalSize(",
+        "update(", "updateMany(", "updateOne(", "validate(", "watch("
+    };
+
+    const char *const CursorMethods[] = {
+        "addOption(", "batchSize(", "collation(", "comment(", "count(", "explain(", "forEach(",
+        "hasNext(", "hint(", "itcount(", "limit(", "map(", "max(", "maxTimeMS(", "min(", "next(",
+        "noCursorTimeout(", "objsLeftInBatch(", "pretty(", "readPref(", "returnKey(",
+        "showRecordId(", "size(", "skip(", "sort(", "tailable(", "toArray("
+    };
+
+    // Methods of collection, which take filter or pipeline as the first argument
+    const char *const QueryMethods[] = {
+        "count", "countDocuments", "deleteMany", "deleteOne", "distinct", "find", "findOne",
+        "findOneAndDelete", "findOneAndReplace", "findOneAndUpdate", "remove", "replaceOne",
+        "update", "updateMany", "updateOne"
+    };
+
+    // Collections with other names are completed as db.getCollection('name')
+    bool isIdentifier(const std::string &name)
+    {
+        if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+            return false;
+
+        return std::all_of(name.begin(), name.end(), [](char ch) {
+            return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_' || ch == '$';
+        });
+    }
+}
+
+namespace Robomongo
+{
+    CompletionIndex::CompletionIndex() :
+        _globals(std::begin(Globals), std::end(Globals)),
+        _dbMethods(std::begin(DbMethods), std::end(DbMethods)),
+        _collectionMethods(std::begin(CollectionMethods), std::end(CollectionMethods)),
+        _cursorMethods(std::begin(CursorMethods), std::end(CursorMethods)) {}
+
+    void CompletionIndex::setDatabases(const std::vector<std::string> &names)
+    {
+        _databases = Names(names.begin(), names.end());
+    }
+
+    void CompletionIndex::setCollections(const std::string &dbName, const std::vector<std::string> &names,
+                                         bool replace /* = true */)
+    {
+        Names &collections = _collections[dbName];
+        if (replace)
+            collections.clear();
+
+        collections.insert(names.begin(), names.end());
+    }
+
+    void CompletionIndex::removeCollections(const std::string &dbName, const std::vector<std::string> &names)
+    {
+        auto const it = _collections.find(dbName);
+        if (it == _collections.end())
+            return;
+
+        for (auto const &name : names)
+            it->second.erase(name);
+    }
+
+    void CompletionIndex::removeDatabase(const std::string &dbName)
+    {
+        _databases.erase(dbName);
+        _collections.erase(dbName);
+    }
+
+    void CompletionIndex::addFields(const mongo::BSONObj &document)
+    {
+        mongo::BSONObjIterator it(document);
+        while (it.more() && _fields.size() < MaxFields) {
+            mongo::BSONElement const element = it.next();
+            std::string const name = element.fieldName();
+            if (isIdentifier(name))
+                _fields.insert(name);
+        }
+    }
+
+    void CompletionIndex::match(const Names &names, const std::string &prefix, const std::string &head,
+                                const std::string &suffix, std::vector<std::string> &out)
+    {
+        for (auto it = names.lower_bound(prefix);
+             it != names.end() && it->compare(0, prefix.size(), prefix) == 0; ++it)
+            out.push_back(head + *it + suffix);
+    }
+
+    std::string CompletionIndex::queriedCollection(const std::string &textBefore)
+    {
+        // Positions of unclosed brackets, strings are skipped
+        std::vector<size_t> open;
+        for (size_t pos = 0; pos < textBefore.size(); ++pos) {
+            char const ch = textBefore[pos];
+            if (ch == '\'' || ch == '"') {
+                while (++pos < textBefore.size() && textBefore[pos] != ch) {
+                    if (textBefore[pos] == '\\')
+                        ++pos;
+                }
+            }
+            else if (ch == '(' || ch == '{' || ch == '[') {
+                open.push_back(pos);
+            }
+            else if ((ch == ')' || ch == '}' || ch == ']') && !open.empty()) {
+                open.pop_back();
+            }
+        }
+
+        static std::regex const call(
+            "db\\.(?:getCollection\\(\\s*['\"]([^'\"]+)['\"]\\s*\\)|([A-Za-z_$][\\w$]*))"
+            "\\.\\s*(\\w+)\\s*$");
+
+        // The innermost call, which has object open inside it
+        bool insideObject = false;
+        for (auto it = open.rbegin(); it != open.rend(); ++it) {
+            char const bracket = textBefore[*it];
+            if (bracket == '{') {
+                insideObject = true;
+                continue;
+            }
+
+            if (bracket != '(' || !insideObject)
+                continue;
+
+            std::smatch match;
+            std::string const head = textBefore.substr(0, *it);
+            if (!std::regex_search(head, match, call))
+                continue;
+
+            std::string const method = match[3];
+            std::string const collection = match[1].matched ? match[1] : match[2];
+            if (method == "aggregate") {
+                if (textBefore.find("$match", *it) != std::string::npos)
+                    return collection;
+            }
+            else if (std::find(std::begin(QueryMethods), std::end(QueryMethods), method) != 
+                     std::end(QueryMethods)) {
+                return collection;
+            }
+            return std::string();
+        }
+        return std::string();
+    }
+
+    std::vector<std::string> CompletionIndex::complete(const std::string &prefix, const std::string &dbName,
+                                                       bool afterUse /* = false */,
+                                                       bool collectionNames /* = true */) const
+    {
+        std::vector<std::string> result;
+        auto const collections = _collections.find(dbName);
+        size_t const dot = prefix.rfind('.');
+
+        if (afterUse) {
+            match(_databases, prefix, "", "", result);
+        }
+        else if (dot == std::string::npos) {
+            match(_globals, prefix, "", "", result);
+            match(_fields, prefix, "", "", result);
+        }
+        else if (dot == 0) {
+            // Method of cursor, i.e. after "find()"
+            match(_cursorMethods, prefix.substr(1), ".", "", result);
+        }
+        else if (prefix.compare(0, 3, "db.") == 0) {
+            std::string const head = prefix.substr(0, dot + 1);
+            if (dot == 2)
+                match(_dbMethods, prefix.substr(dot + 1), head, "", result);
+            else
+                match(_collectionMethods, prefix.substr(dot + 1), head, "", result);
+
+            // Names of collections may contain dots as well
+            if (collectionNames && collections != _collections.end()) {
+                std::string const typed = prefix.substr(3);
+                for (auto it = collections->second.lower_bound(typed);
+                     it != collections->second.end() && it->compare(0, typed.size(), typed) == 0; ++it) {
+                    if (isIdentifier(*it))
+                        result.push_back("db." + *it);
+                    else
+                        result.push_back("db.getCollection('" + *it + "')");
+                }
+            }
+        }
+
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        if (result.size() > MaxCompletions)
+            result.resize(MaxCompletions);
+
+        return result;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace mongo
+{
+    class BSONObj;
+}
+
+namespace Robomongo
+{
+    /**
+     * @brief Names known to the GUI (databases and collections from explorer, field names
+     *        of recent query results and members of shell API), for autocompletion without
+     *        asking JavaScript shell of MongoWorker.
+     *
+     *  Completions are full replacements of typed prefix, in the same form as returned by
+     *  shell's autocomplete: "db.us" -> "db.users", "db.users.fi" -> "db.users.find(".
+     *
+     *  Not thread safe, MongoShell updates and queries it in GUI thread.
+     */
+    class CompletionIndex
+    {
+    public:
+        CompletionIndex();
+
+        void setDatabases(const std::vector<std::string> &names);
+
+        /**
+         * @param replace Collections of database are replaced, otherwise new ones are added
+         */
+        void setCollections(const std::string &dbName, const std::vector<std::string> &names,
+                            bool replace = true);
+        void removeCollections(const std::string &dbName, const std::vector<std::string> &names);
+        void removeDatabase(const std::string &dbName);
+
+        /**
+         * @brief Adds top level field names of document.
+         *        Total number of fields is bounded, oldest ones are kept.
+         */
+        void addFields(const mongo::BSONObj &document);
+
+        /**
+         * @param prefix Text before cursor, up to the nearest stop character
+         * @param dbName Current database of shell, which "db." refers to
+         * @param afterUse Prefix follows "use " statement, i.e. database name is typed
+         * @param collectionNames If false, collection names are never completed (slow on
+         *        servers with many collections for shell, and noisy here)
+         * @return Sorted completions, empty if prefix is not recognized
+         */
+        std::vector<std::string> complete(const std::string &prefix, const std::string &dbName,
+                                          bool afterUse = false, bool collectionNames = true) const;
+
+        /**
+         * @brief Collection, whose documents are described by object being typed at the end of
+         *        'textBefore': filter of db.<collection>.find({ ... or similar method of 
+         *        collection, or $match stage of aggregate().
+         * @return Empty string, if cursor is not inside such object
+         */
+        static std::string queriedCollection(const std::string &textBefore);
+
+    private:
+        static const size_t MaxFields = 2000;
+        static const size_t MaxCompletions = 200;
+
+        typedef std::set<std::string> Names;
+
+        // Appends decorated names starting with 'prefix'
+        static void match(const Names &names, const std::string &prefix, const std::string &head,
+                          const std::string &suffix, std::vector<std::string> &out);
+
+        Names _globals;
+        Names _dbMethods;
+        Names _collectionMethods;
+        Names _cursorMethods;
+        Names _databases;
+        std::map<std::string, Names> _collections;    // by database name
+        Names _fields;
+    };
+}
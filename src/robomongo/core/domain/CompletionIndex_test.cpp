@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+#include "robomongo/core/domain/CompletionIndex.h"
+
+#include <mongo/db/jsobj.h>
+
+using Robomongo::CompletionIndex;
+
+TEST(CompletionIndexTests, Complete_Collections_OfCurrentDatabase)
+{
+    CompletionIndex index;
+    index.setCollections("test", { "users", "user-log" });
+    index.setCollections("other", { "usage" });
+
+    std::vector<std::string> const expected { "db.getCollection('user-log')", "db.users" };
+    EXPECT_EQ(expected, index.complete("db.us", "test"));
+    EXPECT_TRUE(index.complete("db.us", "test", false, false).empty());
+
+    index.setCollections("test", { "usage" }, false);
+    EXPECT_EQ(3u, index.complete("db.us", "test").size());
+
+    index.removeCollections("test", { "user-log", "unknown" });
+    std::vector<std::string> const remaining { "db.usage", "db.users" };
+    EXPECT_EQ(remaining, index.complete("db.us", "test"));
+}
+
+TEST(CompletionIndexTests, Complete_Methods_OfShellApi)
+{
+    CompletionIndex index;
+    std::vector<std::string> const expected { "db.users.findOne(", "db.users.findOneAndDelete(",
+                                              "db.users.findOneAndReplace(", "db.users.findOneAndUpdate(" };
+    EXPECT_EQ(expected, index.complete("db.users.findO", "test"));
+    EXPECT_EQ(std::vector<std::string>{ "db.getSiblingDB(" }, index.complete("db.getSib", "test"));
+    EXPECT_EQ(std::vector<std::string>{ ".limit(" }, index.complete(".li", "test"));
+}
+
+TEST(CompletionIndexTests, Complete_DatabasesAndFields)
+{
+    CompletionIndex index;
+    index.setDatabases({ "admin", "test" });
+    index.addFields(BSON("name" << "x" << "nested" << BSON("a" << 1)));
+
+    EXPECT_EQ(std::vector<std::string>{ "test" }, index.complete("te", "test", true));
+    std::vector<std::string> const expected { "name", "nested" };
+    EXPECT_EQ(expected, index.complete("n", "test"));
+    EXPECT_TRUE(index.complete("x.y", "test").empty());
+}
+
+TEST(CompletionIndexTests, QueriedCollection_InsideFilterOrMatch)
+{
+    EXPECT_EQ("users", CompletionIndex::queriedCollection("db.users.find({ na"));
+    EXPECT_EQ("a-b", CompletionIndex::queriedCollection("db.getCollection('a-b').find({ x: '}', "));
+    EXPECT_EQ("c", CompletionIndex::queriedCollection("db.c.aggregate([{ $match: { "));
+    EXPECT_EQ("", CompletionIndex::queriedCollection("db.c.aggregate([{ $group: { "));
+    EXPECT_EQ("", CompletionIndex::queriedCollection("db.c.insert({ "));
+    EXPECT_EQ("", CompletionIndex::queriedCollection("db.c.find("));
+}
@@ -0,0 +1,87 @@
+#include "robomongo/core/domain/ConnectionSearchIndex.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace Robomongo
+{
+    void ConnectionSearchIndex::add(const std::vector<std::string> &fields)
+    {
+        std::string text;
+        for (std::string const &field : fields) {
+            if (!text.empty())
+                text.push_back('\n');
+            text.append(lower(field));
+        }
+
+        size_t const id = _texts.size();
+        for (size_t i = 0; i + 3 <= text.size(); ++i) {
+            std::vector<size_t> &ids = _postings[trigram(text.data() + i)];
+            if (ids.empty() || ids.back() != id)
+                ids.push_back(id);
+        }
+        _texts.push_back(std::move(text));
+    }
+
+    void ConnectionSearchIndex::clear()
+    {
+        _texts.clear();
+        _postings.clear();
+    }
+
+    std::vector<size_t> ConnectionSearchIndex::find(const std::string &query) const
+    {
+        std::string const needle = lower(query);
+        std::vector<size_t> result;
+        if (needle.size() < 3) {
+            for (size_t id = 0; id < _texts.size(); ++id) {
+                if (_texts[id].find(needle) != std::string::npos)
+                    result.push_back(id);
+            }
+            return result;
+        }
+
+        // Rarest trigrams first, so that candidates shrink fast
+        std::vector<const std::vector<size_t> *> lists;
+        for (size_t i = 0; i + 3 <= needle.size(); ++i) {
+            auto const it = _postings.find(trigram(needle.data() + i));
+            if (it == _postings.end())
+                return result;
+            lists.push_back(&it->second);
+        }
+        std::sort(lists.begin(), lists.end(),
+                  [](const std::vector<size_t> *left, const std::vector<size_t> *right) {
+                      return left->size() < right->size(); });
+
+        std::vector<size_t> candidates = *lists.front();
+        for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+            std::vector<size_t> both;
+            std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(),
+                                  std::back_inserter(both));
+            candidates.swap(both);
+        }
+
+        // Trigrams can occur apart from each other, text is compared to be sure
+        for (size_t const id : candidates) {
+            if (_texts[id].find(needle) != std::string::npos)
+                result.push_back(id);
+        }
+        return result;
+    }
+
+    std::string ConnectionSearchIndex::lower(const std::string &text)
+    {
+        std::string result(text);
+        for (char &ch : result) {
+            if (ch >= 'A' && ch <= 'Z')
+                ch = static_cast<char>(ch - 'A' + 'a');
+        }
+        return result;
+    }
+
+    ConnectionSearchIndex::Trigram ConnectionSearchIndex::trigram(const char *text)
+    {
+        return static_cast<unsigned char>(text[0]) << 16 | static_cast<unsigned char>(text[1]) << 8 |
+               static_cast<unsigned char>(text[2]);
+    }
+}
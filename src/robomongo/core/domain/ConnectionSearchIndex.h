@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Robomongo
+{
+    /**
+     * @brief Case insensitive substring search over texts of connections (name, addresses
+     *        of server or replica set members, SSH host), for filtering of long connection
+     *        lists as user types.
+     *
+     *  Every entry is indexed by its trigrams. Query of three or more characters is looked
+     *  up as intersection of posting lists of its trigrams, and only those candidates are
+     *  compared with query. Shorter queries are compared with all entries.
+     *
+     *  Not thread safe, ConnectionsDialog rebuilds and queries it in GUI thread.
+     */
+    class ConnectionSearchIndex
+    {
+    public:
+        /**
+         * @brief Adds entry with the next id (0, 1, ...), whose text consists of 'fields'
+         */
+        void add(const std::vector<std::string> &fields);
+
+        void clear();
+
+        size_t size() const { return _texts.size(); }
+
+        /**
+         * @return Ascending ids of entries containing 'query' in any of their fields,
+         *         all of them for empty query
+         */
+        std::vector<size_t> find(const std::string &query) const;
+
+    private:
+        typedef unsigned Trigram;
+
+        static std::string lower(const std::string &text);
+        static Trigram trigram(const char *text);
+
+        // Fields of entry, lower cased and separated by '\n', which no query contains
+        std::vector<std::string> _texts;
+
+        // Ascending ids of entries containing trigram
+        std::unordered_map<Trigram, std::vector<size_t>> _postings;
+    };
+}
@@ -0,0 +1,50 @@
+#include "gtest/gtest.h"
+#include "ConnectionSearchIndex.h"
+
+using namespace Robomongo;
+
+namespace
+{
+    ConnectionSearchIndex sampleIndex()
+    {
+        ConnectionSearchIndex index;
+        index.add({ "Production EU", "db1.eu.example.com:27017", "db2.eu.example.com:27017" });
+        index.add({ "Staging", "localhost:27018", "bastion.example.com" });
+        index.add({ "Local", "localhost:27017" });
+        return index;
+    }
+}
+
+TEST(connection_search_index_tests, substring_of_any_field)
+{
+    ConnectionSearchIndex const index = sampleIndex();
+    EXPECT_EQ(std::vector<size_t>({ 0 }), index.find("DB2.eu"));
+    EXPECT_EQ(std::vector<size_t>({ 1 }), index.find("bastion"));
+    EXPECT_EQ(std::vector<size_t>({ 1, 2 }), index.find("localhost"));
+    EXPECT_EQ(std::vector<size_t>({ 0, 2 }), index.find(":27017"));
+    EXPECT_TRUE(index.find("production staging").empty());
+    EXPECT_TRUE(index.find("unknown").empty());
+}
+
+TEST(connection_search_index_tests, short_and_empty_queries)
+{
+    ConnectionSearchIndex const index = sampleIndex();
+    EXPECT_EQ(std::vector<size_t>({ 0, 1, 2 }), index.find(""));
+    EXPECT_EQ(std::vector<size_t>({ 1, 2 }), index.find("st"));
+    EXPECT_EQ(std::vector<size_t>({ 0 }), index.find("eu"));
+}
+
+TEST(connection_search_index_tests, trigrams_apart_do_not_match)
+{
+    ConnectionSearchIndex index;
+    index.add({ "abcxbcd" });
+    EXPECT_TRUE(index.find("abcd").empty());
+    EXPECT_EQ(std::vector<size_t>({ 0 }), index.find("xbcd"));
+
+    // Fields are not matched across their boundary
+    index.add({ "abc", "def" });
+    EXPECT_TRUE(index.find("cde").empty());
+
+    index.clear();
+    EXPECT_EQ(0u, index.size());
+}
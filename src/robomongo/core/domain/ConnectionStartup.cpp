@@ -0,0 +1,85 @@
+#include "robomongo/core/domain/ConnectionStartup.h"
+
+#include "robomongo/core/domain/App.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/utils/Logger.h"
+
+namespace Robomongo
+{
+    ConnectionStartup::ConnectionStartup(App *app, EventBus *bus) :
+        QObject(),
+        _app(app),
+        _bus(bus)
+    {
+        _bus->subscribe(this, ConnectionEstablishedEvent::Type);
+        _bus->subscribe(this, ConnectionFailedEvent::Type);
+    }
+
+    void ConnectionStartup::open(const std::vector<ConnectionSettings *> &connections)
+    {
+        for (ConnectionSettings *connection : connections) {
+            _queued.push_back(connection);
+            _bus->publish(new ConnectionStartupEvent(this, connection, ConnectionStartupEvent::Queued));
+        }
+
+        startNext();
+    }
+
+    void ConnectionStartup::startNext()
+    {
+        while (!_queued.empty() && _connecting.size() < MaxConcurrent) {
+            ConnectionSettings *connection = _queued.front();
+            _queued.pop_front();
+
+            // Server is created (or SSH tunnel requested) synchronously, its events come later
+            int const serverHandle = _app->getLastServerHandle() + 1;
+            bool opened = false;
+            try {
+                opened = _app->openServer(connection, ConnectionPrimary);
+            }
+            catch (const std::exception &ex) {
+                LOG_MSG("Cannot connect to " + connection->connectionName() + ": " + ex.what(),
+                        mongo::logger::LogSeverity::Error());
+            }
+
+            // Password prompt was cancelled or it failed right away
+            if (!opened || _app->getLastServerHandle() != serverHandle) {
+                _bus->publish(new ConnectionStartupEvent(this, connection, ConnectionStartupEvent::Failed));
+                continue;
+            }
+
+            _connecting[serverHandle] = connection;
+            _bus->publish(new ConnectionStartupEvent(this, connection, ConnectionStartupEvent::Connecting,
+                                                     serverHandle));
+        }
+    }
+
+    void ConnectionStartup::handle(ConnectionEstablishedEvent *event)
+    {
+        if (event->connectionType == ConnectionPrimary)
+            finish(event->server->handle(), true);
+    }
+
+    void ConnectionStartup::handle(ConnectionFailedEvent *event)
+    {
+        // Failures of SSH tunnel and of MongoWorker may be both reported for one server
+        if (event->connectionType == ConnectionPrimary)
+            finish(event->serverHandle, false);
+    }
+
+    void ConnectionStartup::finish(int serverHandle, bool connected)
+    {
+        auto const it = _connecting.find(serverHandle);
+        if (it == _connecting.end())
+            return;
+
+        ConnectionSettings *connection = it->second;
+        _connecting.erase(it);
+        _bus->publish(new ConnectionStartupEvent(this, connection,
+            connected ? ConnectionStartupEvent::Connected : ConnectionStartupEvent::Failed, serverHandle));
+
+        startNext();
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <vector>
+#include <QObject>
+
+namespace Robomongo
+{
+    class App;
+    class EventBus;
+    class ConnectionSettings;
+    struct ConnectionEstablishedEvent;
+    class ConnectionFailedEvent;
+
+    /**
+     * @brief Opens several connections at once (i.e. "Connect at startup" ones), at most
+     *        MaxConcurrent of them at a time, so that SSH setup and handshake of one do not
+     *        wait for the other ones. Progress of every connection is published with
+     *        ConnectionStartupEvent, so that explorer keeps their order.
+     */
+    class ConnectionStartup : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        static const size_t MaxConcurrent = 4;
+
+        ConnectionStartup(App *app, EventBus *bus);
+
+        /**
+         * @brief Queues connections (records of SettingsManager) in this order
+         */
+        void open(const std::vector<ConnectionSettings *> &connections);
+
+    public Q_SLOTS:
+        void handle(ConnectionEstablishedEvent *event);
+        void handle(ConnectionFailedEvent *event);
+
+    private:
+        void startNext();
+        void finish(int serverHandle, bool connected);
+
+        App *const _app;
+        EventBus *const _bus;
+        std::deque<ConnectionSettings *> _queued;
+        std::map<int, ConnectionSettings *> _connecting;    // by server handle
+    };
+}
@@ -0,0 +1,44 @@
+#include "robomongo/core/domain/CreatedDatabases.h"
+
+#include <mutex>
+#include <set>
+#include <QHash>
+
+namespace
+{
+    std::mutex createdMutex;
+    QHash<QString, std::set<std::string>> created;
+}
+
+namespace Robomongo
+{
+    namespace CreatedDatabases
+    {
+        void add(const QString &connection, const std::string &database)
+        {
+            std::lock_guard<std::mutex> lock(createdMutex);
+            created[connection].insert(database);
+        }
+
+        void remove(const QString &connection, const std::string &database)
+        {
+            std::lock_guard<std::mutex> lock(createdMutex);
+            auto const databases = created.find(connection);
+            if (databases != created.end())
+                databases->erase(database);
+        }
+
+        std::vector<std::string> merge(const QString &connection, std::vector<std::string> existing)
+        {
+            std::lock_guard<std::mutex> lock(createdMutex);
+            auto const databases = created.find(connection);
+            if (databases == created.end())
+                return existing;
+
+            for (std::string const &database : existing)
+                databases->erase(database);
+            existing.insert(existing.end(), databases->begin(), databases->end());
+            return existing;
+        }
+    }
+}
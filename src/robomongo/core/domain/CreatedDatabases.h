@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <QString>
+
+namespace Robomongo
+{
+    /**
+     * @brief Databases created by this program, per connection record (by its uuid).
+     *        Starting from 3.0, MongoDB drops empty databases, so there is no way to create
+     *        an "empty" one. Created databases are merged with the list of real databases
+     *        until they exist on server (or are dropped). Shared by all workers of connection,
+     *        database is created by one of them and names are listed by another. Thread safe.
+     */
+    namespace CreatedDatabases
+    {
+        void add(const QString &connection, const std::string &database);
+        void remove(const QString &connection, const std::string &database);
+
+        /**
+         * @brief 'existing' databases of server and created ones, that do not exist yet.
+         *        Created databases found in 'existing' are forgotten.
+         */
+        std::vector<std::string> merge(const QString &connection, std::vector<std::string> existing);
+    }
+}
@@ -0,0 +1,22 @@
+#include "gtest/gtest.h"
+#include "CreatedDatabases.h"
+
+using namespace Robomongo;
+
+TEST(created_databases_tests, merged_until_they_exist)
+{
+    QString const connection = "created-databases-test";
+    CreatedDatabases::add(connection, "empty");
+    CreatedDatabases::add(connection, "filled");
+    CreatedDatabases::add(connection, "dropped");
+    CreatedDatabases::remove(connection, "dropped");
+
+    // Databases of other connection records are not affected
+    EXPECT_EQ(std::vector<std::string>({ "admin" }), CreatedDatabases::merge("other", { "admin" }));
+
+    EXPECT_EQ(std::vector<std::string>({ "admin", "filled", "empty" }),
+              CreatedDatabases::merge(connection, { "admin", "filled" }));
+
+    // Once a database exists on server, it is not added anymore, even if dropped there
+    EXPECT_EQ(std::vector<std::string>({ "admin", "empty" }), CreatedDatabases::merge(connection, { "admin" }));
+}
@@ -0,0 +1,284 @@
+#include "robomongo/core/domain/DataGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <functional>
+
+#include <mongo/bson/bsontypes.h>
+#include <mongo/bson/oid.h>
+
+namespace
+{
+    // Paths with at least this share of distinct values are unique, i.e. counters or ids
+    const double UniqueRatio = 0.9;
+
+    // Spread of dates without analysis, around the sample date
+    const double DateSpreadMs = 60.0 * 24 * 60 * 60 * 1000;
+
+    uint64_t splitmix(uint64_t value)
+    {
+        value += 0x9e3779b97f4a7c15ULL;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    int typeByName(const std::string &name)
+    {
+        static const int types[] = {
+            mongo::MinKey, mongo::NumberDouble, mongo::String, mongo::Object, mongo::Array, mongo::BinData,
+            mongo::Undefined, mongo::jstOID, mongo::Bool, mongo::Date, mongo::jstNULL, mongo::RegEx,
+            mongo::DBRef, mongo::Code, mongo::Symbol, mongo::CodeWScope, mongo::NumberInt, mongo::bsonTimestamp,
+            mongo::NumberLong, mongo::NumberDecimal, mongo::MaxKey
+        };
+        for (int const type : types) {
+            if (name == mongo::typeName(static_cast<mongo::BSONType>(type)))
+                return type;
+        }
+        return mongo::EOO;
+    }
+}
+
+namespace Robomongo
+{
+    DataGenerator::DataGenerator(const mongo::BSONObj &sample, const std::vector<FieldAnalysis> &fields,
+                                 uint64_t seed, unsigned stream) :
+        _sample(sample.getOwned()),
+        _random(splitmix(seed + stream)),
+        _salt(splitmix(seed)),
+        _number(0)
+    {
+        for (FieldAnalysis const &analysis : fields) {
+            Field field;
+            field.analysis = analysis;
+            double weight = 0;
+            for (auto const &type : analysis.types) {
+                int const bsonType = typeByName(type.first);
+                if (bsonType == mongo::EOO)
+                    continue;
+                weight += static_cast<double>(type.second);
+                field.types.emplace_back(bsonType, weight);
+            }
+            _fields.emplace(analysis.path, std::move(field));
+        }
+    }
+
+    mongo::BSONObj DataGenerator::next(uint64_t number)
+    {
+        _number = number;
+        mongo::BSONObjBuilder builder;
+        generate(_sample, std::string(), builder);
+        return builder.obj();
+    }
+
+    void DataGenerator::generate(const mongo::BSONObj &sample, const std::string &prefix,
+                                 mongo::BSONObjBuilder &builder)
+    {
+        for (mongo::BSONObjIterator it(sample); it.more(); ) {
+            mongo::BSONElement const element = it.next();
+            std::string const name = element.fieldName();
+            std::string const path = prefix + name;
+            if (path == "_id") {
+                if (element.type() == mongo::jstOID)
+                    appendObjectId(builder, name, uniqueValue(path));
+                continue;
+            }
+            append(builder, name, element, path);
+        }
+    }
+
+    void DataGenerator::append(mongo::BSONObjBuilder &builder, const std::string &name,
+                               const mongo::BSONElement &sample, const std::string &path)
+    {
+        auto const found = _fields.find(path);
+        Field const *field = found != _fields.end() ? &found->second : nullptr;
+        if (field && uniform() < field->analysis.missingRatio)
+            return;
+
+        int type = sample.type();
+        if (field && !field->types.empty()) {
+            double const pick = uniform() * field->types.back().second;
+            for (auto const &weight : field->types) {
+                if (pick < weight.second) {
+                    type = weight.first;
+                    break;
+                }
+            }
+        }
+        appendOfType(builder, name, type, sample, path, field);
+    }
+
+    void DataGenerator::appendOfType(mongo::BSONObjBuilder &builder, const std::string &name, int type,
+                                     const mongo::BSONElement &sample, const std::string &path,
+                                     const Field *field)
+    {
+        uint64_t count = 0;
+        uint64_t const index = distinctIndex(field, count);
+
+        // Position of value in range: random for unique paths, one of 'count' steps otherwise
+        double const position = count == 0 ? uniform() : (count > 1 ? static_cast<double>(index) / (count - 1) : 0.5);
+        bool const hasRange = field && field->analysis.hasRange;
+
+        switch (type) {
+        case mongo::jstNULL:
+            builder.appendNull(name);
+            return;
+
+        case mongo::Bool:
+            if (count == 1 && sample.type() == mongo::Bool)
+                builder.appendAs(sample, name);
+            else
+                builder.append(name, count == 0 ? uniform() < 0.5 : index % 2 == 1);
+            return;
+
+        case mongo::NumberInt:
+        case mongo::NumberLong:
+        case mongo::NumberDouble: {
+            double value;
+            if (hasRange) {
+                value = field->analysis.minValue + (field->analysis.maxValue - field->analysis.minValue) * position;
+            } else {
+                double const base = sample.isNumber() ? sample.numberDouble() : 0;
+                bool const isInteger = type != mongo::NumberDouble;
+                value = count == 0 && isInteger ? base + static_cast<double>(_number) :
+                        base + std::max(1.0, std::fabs(base)) * (position - 0.5);
+            }
+
+            if (type == mongo::NumberInt)
+                builder.append(name, static_cast<int>(std::llround(std::max<double>(INT_MIN, std::min<double>(INT_MAX, value)))));
+            else if (type == mongo::NumberLong)
+                builder.append(name, static_cast<long long>(std::llround(value)));
+            else
+                builder.append(name, value);
+            return;
+        }
+
+        case mongo::String: {
+            if (count == 1 && sample.type() == mongo::String) {
+                builder.appendAs(sample, name);
+                return;
+            }
+
+            // BSON string value is length, characters and terminating zero
+            size_t length = sample.type() == mongo::String ? static_cast<size_t>(sample.valuestrsize() - 1) : 8;
+            if (field && field->analysis.averageSize > 5)
+                length = static_cast<size_t>(std::llround(field->analysis.averageSize - 5));
+
+            static const char digits[] = "0123456789abcdef";
+            uint64_t value = count == 0 ? uniqueValue(path) : splitmix(index ^ std::hash<std::string>()(path));
+            std::string text;
+            text.reserve(length);
+            for (size_t i = 0; i < length; ++i) {
+                if (i > 0 && i % 16 == 0)
+                    value = splitmix(value);
+                text += digits[(value >> ((i % 16) * 4)) & 0xf];
+            }
+            builder.append(name, text);
+            return;
+        }
+
+        case mongo::Date: {
+            double millis;
+            if (hasRange) {
+                millis = field->analysis.minValue + (field->analysis.maxValue - field->analysis.minValue) * position;
+            } else {
+                double const base = sample.type() == mongo::Date ?
+                    static_cast<double>(sample.date().toMillisSinceEpoch()) :
+                    static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count());
+                millis = base + DateSpreadMs * (position - 0.5);
+            }
+            builder.appendDate(name, mongo::Date_t::fromMillisSinceEpoch(std::llround(millis)));
+            return;
+        }
+
+        case mongo::jstOID:
+            appendObjectId(builder, name, count == 0 ? uniqueValue(path) : splitmix(index ^ std::hash<std::string>()(path)));
+            return;
+
+        case mongo::Object:
+            if (sample.type() == mongo::Object) {
+                mongo::BSONObjBuilder object(builder.subobjStart(name));
+                generate(sample.Obj(), path + ".", object);
+                object.done();
+            } else {
+                builder.append(name, mongo::BSONObj());
+            }
+            return;
+
+        case mongo::Array:
+            appendArray(builder, name, sample, path);
+            return;
+
+        default:
+            // Other types (binary, regular expressions, timestamps...) are copied from sample
+            builder.appendAs(sample, name);
+            return;
+        }
+    }
+
+    void DataGenerator::appendArray(mongo::BSONObjBuilder &builder, const std::string &name,
+                                    const mongo::BSONElement &sample, const std::string &path)
+    {
+        std::vector<mongo::BSONElement> items;
+        if (sample.type() == mongo::Array)
+            items = sample.Array();
+
+        mongo::BSONObjBuilder array(builder.subarrayStart(name));
+        if (!items.empty()) {
+            // Length varies from half to one and a half of sample length, items repeat those of sample
+            size_t const minLength = (items.size() + 1) / 2;
+            size_t const length = minLength + _random() % (items.size() + 1);
+            for (size_t i = 0; i < length; ++i) {
+                mongo::BSONElement const &item = items[i % items.size()];
+                std::string const key = std::to_string(i);
+                if (item.type() == mongo::Object) {
+                    mongo::BSONObjBuilder object(array.subobjStart(key));
+                    generate(item.Obj(), path + ".", object);
+                    object.done();
+                } else {
+                    appendOfType(array, key, item.type(), item, path, nullptr);
+                }
+            }
+        }
+        array.done();
+    }
+
+    void DataGenerator::appendObjectId(mongo::BSONObjBuilder &builder, const std::string &name, uint64_t value)
+    {
+        // Current time, as in ObjectIds of drivers, then 8 bytes of value
+        uint32_t const seconds = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        unsigned char bytes[mongo::OID::kOIDSize];
+        for (int i = 0; i < 4; ++i)
+            bytes[i] = static_cast<unsigned char>(seconds >> (8 * (3 - i)));
+        for (int i = 0; i < 8; ++i)
+            bytes[4 + i] = static_cast<unsigned char>(value >> (8 * (7 - i)));
+        builder.append(name, mongo::OID::from(bytes));
+    }
+
+    uint64_t DataGenerator::distinctIndex(const Field *field, uint64_t &count)
+    {
+        if (!field || field->analysis.values == 0 ||
+            field->analysis.distinct >= UniqueRatio * static_cast<double>(field->analysis.values)) {
+            count = 0;
+            return _number;
+        }
+
+        count = std::max<uint64_t>(1, static_cast<uint64_t>(std::llround(field->analysis.distinct)));
+        return _random() % count;
+    }
+
+    uint64_t DataGenerator::uniqueValue(const std::string &path) const
+    {
+        // Bijection of number for every path, distinct numbers never give the same value
+        return splitmix(_number ^ _salt ^ std::hash<std::string>()(path));
+    }
+
+    double DataGenerator::uniform()
+    {
+        return static_cast<double>(_random() >> 11) * (1.0 / 9007199254740992.0);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/domain/SchemaAnalyzer.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Synthetic documents shaped like 'sample': every field of sample is generated
+     *        following FieldAnalysis of its path (type histogram, missing ratio, number of
+     *        distinct values, range of numbers and dates, average size of strings). Fields
+     *        without analysis get values of their sample type around the sample value.
+     *        _id is a new ObjectId, if it is ObjectId in sample, otherwise it is left to server.
+     *        Not thread safe, every thread has its own generator (another 'stream' of the same run).
+     */
+    class DataGenerator
+    {
+    public:
+        /**
+         * @param seed Seed of run, generators of one run differ by 'stream'
+         */
+        DataGenerator(const mongo::BSONObj &sample, const std::vector<FieldAnalysis> &fields, uint64_t seed,
+                      unsigned stream = 0);
+
+        /**
+         * @param number Number of document in run: values of unique paths (ids, counters) are
+         *        derived from it, so that they do not repeat in documents of other streams
+         */
+        mongo::BSONObj next(uint64_t number);
+
+    private:
+        struct Field
+        {
+            FieldAnalysis analysis;
+            std::vector<std::pair<int, double>> types;     // BSON type -> cumulative weight
+        };
+
+        void generate(const mongo::BSONObj &sample, const std::string &prefix, mongo::BSONObjBuilder &builder);
+        void append(mongo::BSONObjBuilder &builder, const std::string &name, const mongo::BSONElement &sample,
+                    const std::string &path);
+        void appendOfType(mongo::BSONObjBuilder &builder, const std::string &name, int type,
+                          const mongo::BSONElement &sample, const std::string &path, const Field *field);
+        void appendArray(mongo::BSONObjBuilder &builder, const std::string &name, const mongo::BSONElement &sample,
+                         const std::string &path);
+        void appendObjectId(mongo::BSONObjBuilder &builder, const std::string &name, uint64_t value);
+        uint64_t uniqueValue(const std::string &path) const;
+
+        // Index of value among 'distinct' ones of path, so that cardinality of sample is kept
+        uint64_t distinctIndex(const Field *field, uint64_t &count);
+        double uniform();
+
+        mongo::BSONObj const _sample;
+        std::unordered_map<std::string, Field> _fields;
+        std::mt19937_64 _random;
+        uint64_t const _salt;       // of unique values, so that other runs do not repeat them
+        uint64_t _number;
+    };
+}
@@ -0,0 +1,70 @@
+#include "gtest/gtest.h"
+#include "DataGenerator.h"
+
+#include <set>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+TEST(data_generator_tests, sample_shape_without_analysis)
+{
+    mongo::BSONObj const sample = BSON("_id" << mongo::OID::gen() << "name" << "abc" << "n" << 5
+                                             << "tags" << BSON_ARRAY("x" << "y"));
+    DataGenerator generator(sample, std::vector<FieldAnalysis>(), 1);
+
+    std::set<std::string> ids;
+    for (uint64_t number = 0; number < 100; ++number) {
+        mongo::BSONObj const doc = generator.next(number);
+        ASSERT_EQ(mongo::jstOID, doc["_id"].type());
+        ids.insert(doc["_id"].OID().toString());
+        EXPECT_EQ(mongo::String, doc["name"].type());
+        EXPECT_EQ(3u, doc["name"].str().size());
+        EXPECT_EQ(mongo::NumberInt, doc["n"].type());
+        ASSERT_EQ(mongo::Array, doc["tags"].type());
+        EXPECT_GE(doc["tags"].Obj().nFields(), 1);
+        EXPECT_LE(doc["tags"].Obj().nFields(), 3);
+    }
+    EXPECT_EQ(100u, ids.size());
+
+    // Other streams of the same run do not repeat ids of other numbers
+    DataGenerator other(sample, std::vector<FieldAnalysis>(), 1, 1);
+    EXPECT_EQ(0u, ids.count(other.next(100)["_id"].OID().toString()));
+}
+
+TEST(data_generator_tests, values_follow_analysis)
+{
+    SchemaAnalyzer analyzer;
+    const char *const statuses[] = { "new", "old", "mid" };
+    for (int i = 0; i < 1000; ++i) {
+        mongo::BSONObjBuilder builder;
+        builder.append("_id", i);
+        builder.append("status", statuses[i % 3]);
+        builder.append("age", 18 + i % 48);
+        if (i % 2 == 0)
+            builder.append("optional", true);
+        analyzer.add(builder.obj());
+    }
+
+    mongo::BSONObj const sample = BSON("_id" << 1 << "status" << "new" << "age" << 30 << "optional" << true);
+    DataGenerator generator(sample, analyzer.summary(), 7);
+
+    std::set<std::string> statusValues;
+    int missing = 0;
+    for (uint64_t number = 0; number < 2000; ++number) {
+        mongo::BSONObj const doc = generator.next(number);
+        EXPECT_FALSE(doc.hasField("_id"));     // not ObjectId, left to server
+
+        ASSERT_EQ(mongo::String, doc["status"].type());
+        statusValues.insert(doc["status"].str());
+
+        ASSERT_EQ(mongo::NumberInt, doc["age"].type());
+        EXPECT_GE(doc["age"].numberInt(), 18);
+        EXPECT_LE(doc["age"].numberInt(), 65);
+
+        if (!doc.hasField("optional"))
+            ++missing;
+    }
+    EXPECT_LE(statusValues.size(), 3u);
+    EXPECT_NEAR(1000, missing, 150);
+}
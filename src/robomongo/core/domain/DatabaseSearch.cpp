@@ -0,0 +1,194 @@
+#include "robomongo/core/domain/DatabaseSearch.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace Robomongo
+{
+    namespace DatabaseSearch
+    {
+        namespace
+        {
+            bool isHex(const std::string &text)
+            {
+                return std::all_of(text.begin(), text.end(), [](char ch) {
+                    return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
+                });
+            }
+
+            // { $or: [ <clauses> ] }, or the only clause itself
+            mongo::BSONObj anyOf(const std::vector<mongo::BSONObj> &clauses)
+            {
+                if (clauses.empty())
+                    return mongo::BSONObj();
+                if (clauses.size() == 1)
+                    return clauses.front();
+
+                mongo::BSONArrayBuilder array;
+                for (auto const &clause : clauses)
+                    array.append(clause);
+                return BSON("$or" << array.arr());
+            }
+        }
+
+        mongo::BSONArray candidates(const std::string &text)
+        {
+            mongo::BSONArrayBuilder values;
+            values.append(text);
+            if (text.empty())
+                return values.arr();
+
+            // Numbers of any type compare equal on server, one of them is enough
+            char *end = nullptr;
+            errno = 0;
+            long long const integer = std::strtoll(text.c_str(), &end, 10);
+            if (errno == 0 && *end == '\0') {
+                values.append(integer);
+            }
+            else {
+                errno = 0;
+                double const number = std::strtod(text.c_str(), &end);
+                if (errno == 0 && *end == '\0' && std::isfinite(number) &&
+                    !std::isspace(static_cast<unsigned char>(text[0])))
+                    values.append(number);
+            }
+
+            if (text.size() == 24 && isHex(text))
+                values.append(mongo::OID(text));
+            return values.arr();
+        }
+
+        std::vector<std::string> indexedFields(const std::vector<mongo::BSONObj> &indexSpecs)
+        {
+            std::vector<std::string> fields;
+            for (auto const &spec : indexSpecs) {
+                mongo::BSONObj const key = spec.getObjectField("key");
+                if (key.isEmpty())
+                    continue;
+
+                // Special index types ("text", "2dsphere") have string values, hashed serves equality
+                mongo::BSONElement const first = key.firstElement();
+                if (first.type() == mongo::String && first.valueStringData() != "hashed")
+                    continue;
+
+                std::string const name = first.fieldName();
+                if (std::find(fields.begin(), fields.end(), name) == fields.end())
+                    fields.push_back(name);
+            }
+            return fields;
+        }
+
+        bool hasTextIndex(const std::vector<mongo::BSONObj> &indexSpecs)
+        {
+            for (auto const &spec : indexSpecs) {
+                for (mongo::BSONObjIterator it(spec.getObjectField("key")); it.more();) {
+                    mongo::BSONElement const element = it.next();
+                    if (element.type() == mongo::String && element.valueStringData() == "text")
+                        return true;
+                }
+            }
+            return false;
+        }
+
+        std::vector<std::string> sampledFields(const std::vector<mongo::BSONObj> &documents,
+                                               const std::vector<std::string> &exclude, size_t maxFields)
+        {
+            std::map<std::string, int> counts;
+            for (auto const &document : documents) {
+                for (mongo::BSONObjIterator it(document); it.more();) {
+                    std::string const name = it.next().fieldName();
+                    if (std::find(exclude.begin(), exclude.end(), name) == exclude.end())
+                        ++counts[name];
+                }
+            }
+
+            std::vector<std::pair<std::string, int>> sorted(counts.begin(), counts.end());
+            std::stable_sort(sorted.begin(), sorted.end(),
+                             [](const std::pair<std::string, int> &left, const std::pair<std::string, int> &right) {
+                                 return left.second > right.second; });
+
+            std::vector<std::string> fields;
+            for (size_t i = 0; i < sorted.size() && i < maxFields; ++i)
+                fields.push_back(sorted[i].first);
+            return fields;
+        }
+
+        mongo::BSONObj equalityFilter(const std::vector<std::string> &fields, const mongo::BSONArray &candidates)
+        {
+            std::vector<mongo::BSONObj> clauses;
+            for (auto const &field : fields)
+                clauses.push_back(BSON(field << BSON("$in" << candidates)));
+            return anyOf(clauses);
+        }
+
+        mongo::BSONObj regexFilter(const std::vector<std::string> &fields, const std::string &text)
+        {
+            std::string const pattern = escapeRegex(text);
+            std::vector<mongo::BSONObj> clauses;
+            for (auto const &field : fields) {
+                mongo::BSONObjBuilder clause;
+                clause.appendRegex(field, pattern, "i");
+                clauses.push_back(clause.obj());
+            }
+            return anyOf(clauses);
+        }
+
+        mongo::BSONObj textFilter(const std::string &text)
+        {
+            // Quotes inside phrase would end it
+            std::string phrase = text;
+            phrase.erase(std::remove(phrase.begin(), phrase.end(), '"'), phrase.end());
+            return BSON("$text" << BSON("$search" << "\"" + phrase + "\""));
+        }
+
+        std::string escapeRegex(const std::string &text)
+        {
+            static std::string const special = "\\^$.|?*+()[]{}";
+            std::string result;
+            result.reserve(text.size());
+            for (char const ch : text) {
+                if (special.find(ch) != std::string::npos)
+                    result.push_back('\\');
+                result.push_back(ch);
+            }
+            return result;
+        }
+
+        std::string planName(bool indexed, bool scanned, bool text)
+        {
+            std::string plan;
+            auto add = [&plan](bool used, const char *name) {
+                if (!used)
+                    return;
+                if (!plan.empty())
+                    plan += " + ";
+                plan += name;
+            };
+            add(indexed, "index");
+            add(scanned, "scan");
+            add(text, "text");
+            return plan.empty() ? "none" : plan;
+        }
+
+        void Cancellation::cancel(const std::string &collection)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _collections.insert(collection);
+        }
+
+        bool Cancellation::isCancelled(const std::string &collection) const
+        {
+            if (_all)
+                return true;
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _collections.count(collection) > 0;
+        }
+    }
+}
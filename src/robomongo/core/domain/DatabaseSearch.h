@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/domain/MongoDocument.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Search of one value in all collections of database, i.e. customer id of support
+     *        ticket. Collections are queried at once on several connections (see
+     *        MongoWorker::handle(DatabaseSearchRequest *)), every query with time limit.
+     *
+     *  Equality of value is looked up in the leading fields of indexes first, so that
+     *  indexed collections answer at once. Other top level fields (from a few sampled
+     *  documents) are scanned, unless disabled, and collections with text index are
+     *  queried with $text phrase too. Substring search uses case insensitive regex on the
+     *  same fields instead.
+     */
+    namespace DatabaseSearch
+    {
+        struct Options
+        {
+            std::string value;
+            bool substring = false;         // regex on fields instead of equality
+            bool scanUnindexed = true;      // query sampled fields without index too
+            int maxTimeMs = 5000;           // of every query
+            int maxHitsPerCollection = 100;
+        };
+
+        struct Hit
+        {
+            std::string collection;
+            MongoDocumentPtr document;
+        };
+
+        // Outcome of one collection
+        struct CollectionResult
+        {
+            enum State { Done, TimedOut, Cancelled, Failed };
+
+            std::string collection;
+            State state = Done;
+            std::string plan;               // i.e. "index + scan", see planName()
+            int hits = 0;
+            long long elapsedMs = 0;
+            std::string error;
+        };
+
+        // Documents sampled for names of fields, which are not indexed
+        const int SampleSize = 20;
+
+        // Sampled field names queried by scan, the most frequent ones
+        const size_t MaxScannedFields = 50;
+
+        /**
+         * @brief Value of search box in forms it may be stored in: string, and also number
+         *        or ObjectId, if it parses as one
+         */
+        mongo::BSONArray candidates(const std::string &text);
+
+        /**
+         * @brief Leading fields of indexes, which serve equality of value. Text and geo
+         *        indexes are not used.
+         */
+        std::vector<std::string> indexedFields(const std::vector<mongo::BSONObj> &indexSpecs);
+        bool hasTextIndex(const std::vector<mongo::BSONObj> &indexSpecs);
+
+        /**
+         * @return Top level fields of documents, by number of documents having them (at most
+         *         'maxFields'), except for 'exclude' ones
+         */
+        std::vector<std::string> sampledFields(const std::vector<mongo::BSONObj> &documents,
+                                               const std::vector<std::string> &exclude, size_t maxFields);
+
+        /**
+         * @brief { f: { $in: [ <candidates> ] } }, or $or of these for several fields
+         * @return Empty object, if there are no fields
+         */
+        mongo::BSONObj equalityFilter(const std::vector<std::string> &fields, const mongo::BSONArray &candidates);
+
+        /**
+         * @brief { f: /<escaped text>/i }, or $or of these for several fields
+         * @return Empty object, if there are no fields
+         */
+        mongo::BSONObj regexFilter(const std::vector<std::string> &fields, const std::string &text);
+
+        // { $text: { $search: "\"<text>\"" } }: the whole text as phrase
+        mongo::BSONObj textFilter(const std::string &text);
+
+        // Regex matching 'text' literally
+        std::string escapeRegex(const std::string &text);
+
+        // I.e. "index + scan", from which queries were run
+        std::string planName(bool indexed, bool scanned, bool text);
+
+        /**
+         * @brief Cancellation of the whole search or of single collections, set by GUI and
+         *        checked by worker threads between batches. Thread-safe.
+         */
+        class Cancellation
+        {
+        public:
+            Cancellation() : _all(false) {}
+
+            void cancelAll() { _all = true; }
+            void cancel(const std::string &collection);
+
+            bool isCancelled() const { return _all; }
+            bool isCancelled(const std::string &collection) const;
+
+        private:
+            std::atomic<bool> _all;
+            mutable std::mutex _mutex;
+            std::set<std::string> _collections;
+        };
+    }
+}
@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+#include "DatabaseSearch.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+TEST(database_search_tests, candidates_by_form_of_value)
+{
+    mongo::BSONArray const text = DatabaseSearch::candidates("alice");
+    EXPECT_EQ(1, text.nFields());
+
+    mongo::BSONArray const number = DatabaseSearch::candidates("42");
+    ASSERT_EQ(2, number.nFields());
+    EXPECT_EQ(mongo::String, number["0"].type());
+    EXPECT_EQ(42, number["1"].numberLong());
+
+    mongo::BSONArray const oid = DatabaseSearch::candidates("5f1d7a3e9b1e8a3c4d5e6f70");
+    ASSERT_EQ(2, oid.nFields());
+    EXPECT_EQ(mongo::jstOID, oid["1"].type());
+}
+
+TEST(database_search_tests, leading_fields_of_indexes)
+{
+    std::vector<mongo::BSONObj> const specs = {
+        BSON("name" << "_id_" << "key" << BSON("_id" << 1)),
+        BSON("name" << "customer" << "key" << BSON("customerId" << 1 << "createdAt" << -1)),
+        BSON("name" << "text" << "key" << BSON("_fts" << "text" << "_ftsx" << 1)),
+        BSON("name" << "email" << "key" << BSON("email" << "hashed")),
+        BSON("name" << "customer2" << "key" << BSON("customerId" << -1))
+    };
+
+    auto const fields = DatabaseSearch::indexedFields(specs);
+    ASSERT_EQ(3u, fields.size());
+    EXPECT_EQ("_id", fields[0]);
+    EXPECT_EQ("customerId", fields[1]);
+    EXPECT_EQ("email", fields[2]);
+    EXPECT_TRUE(DatabaseSearch::hasTextIndex(specs));
+    EXPECT_FALSE(DatabaseSearch::hasTextIndex({ specs[0] }));
+}
+
+TEST(database_search_tests, sampled_fields_by_frequency)
+{
+    std::vector<mongo::BSONObj> const documents = {
+        BSON("_id" << 1 << "a" << 1 << "b" << 1),
+        BSON("_id" << 2 << "b" << 1),
+        BSON("_id" << 3 << "b" << 1 << "c" << 1)
+    };
+
+    auto const fields = DatabaseSearch::sampledFields(documents, { "_id" }, 2);
+    ASSERT_EQ(2u, fields.size());
+    EXPECT_EQ("b", fields[0]);
+    EXPECT_EQ("a", fields[1]);
+}
+
+TEST(database_search_tests, filters)
+{
+    mongo::BSONArray const values = DatabaseSearch::candidates("x");
+    EXPECT_TRUE(DatabaseSearch::equalityFilter({}, values).isEmpty());
+    EXPECT_TRUE(BSON("a" << BSON("$in" << values)).binaryEqual(DatabaseSearch::equalityFilter({ "a" }, values)));
+    EXPECT_EQ(2, DatabaseSearch::equalityFilter({ "a", "b" }, values)["$or"].Obj().nFields());
+
+    EXPECT_EQ("a\\.b\\(1\\)", DatabaseSearch::escapeRegex("a.b(1)"));
+    mongo::BSONObj const regex = DatabaseSearch::regexFilter({ "name" }, "a.b");
+    EXPECT_EQ("a\\.b", std::string(regex["name"].regex()));
+    EXPECT_EQ("i", std::string(regex["name"].regexFlags()));
+
+    EXPECT_EQ("\"ab c\"", DatabaseSearch::textFilter("a\"b c")["$text"]["$search"].String());
+    EXPECT_EQ("index + text", DatabaseSearch::planName(true, false, true));
+    EXPECT_EQ("none", DatabaseSearch::planName(false, false, false));
+}
+
+TEST(database_search_tests, cancellation_of_collections)
+{
+    DatabaseSearch::Cancellation cancellation;
+    cancellation.cancel("orders");
+    EXPECT_TRUE(cancellation.isCancelled("orders"));
+    EXPECT_FALSE(cancellation.isCancelled("customers"));
+    EXPECT_FALSE(cancellation.isCancelled());
+
+    cancellation.cancelAll();
+    EXPECT_TRUE(cancellation.isCancelled("customers"));
+}
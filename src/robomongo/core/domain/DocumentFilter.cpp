@@ -0,0 +1,160 @@
+#include "robomongo/core/domain/DocumentFilter.h"
+
+#include <stdexcept>
+
+#include "robomongo/core/domain/MongoDocument.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        bool isOperatorObject(const mongo::BSONElement &element)
+        {
+            if (element.type() != mongo::Object)
+                return false;
+
+            mongo::BSONObj const obj = element.embeddedObject();
+            return !obj.isEmpty() && obj.firstElementFieldName()[0] == '$';
+        }
+    }
+
+    DocumentFilter::DocumentFilter(const mongo::BSONObj &filter) :
+        _filter(filter.getOwned())
+    {
+        static const struct { const char *name; Operator op; } operators[] = {
+            { "$eq", Eq }, { "$ne", Ne }, { "$gt", Gt }, { "$gte", Gte }, { "$lt", Lt },
+            { "$lte", Lte }, { "$in", In }, { "$nin", Nin }, { "$exists", Exists }
+        };
+
+        mongo::BSONObjIterator it(_filter);
+        while (it.more()) {
+            mongo::BSONElement const element = it.next();
+            std::string const path = element.fieldName();
+            if (path.empty() || path[0] == '$')
+                throw std::invalid_argument("Unsupported filter operator " + path);
+
+            Condition condition;
+            condition.path = path;
+            if (!isOperatorObject(element)) {
+                condition.predicates.push_back({ Eq, element });
+                _conditions.push_back(condition);
+                continue;
+            }
+
+            mongo::BSONObjIterator ops(element.embeddedObject());
+            while (ops.more()) {
+                mongo::BSONElement const operand = ops.next();
+                std::string const name = operand.fieldName();
+
+                bool known = false;
+                for (auto const &op : operators) {
+                    if (name != op.name)
+                        continue;
+
+                    if ((op.op == In || op.op == Nin) && operand.type() != mongo::Array)
+                        throw std::invalid_argument(name + " needs an array");
+
+                    condition.predicates.push_back({ op.op, operand });
+                    known = true;
+                    break;
+                }
+
+                if (!known)
+                    throw std::invalid_argument("Unsupported filter operator " + name);
+            }
+            _conditions.push_back(condition);
+        }
+    }
+
+    void DocumentFilter::select(const std::vector<MongoDocumentPtr> &documents, size_t first, size_t last,
+                                std::vector<size_t> &selection, const std::atomic<bool> *stop) const
+    {
+        std::vector<size_t> candidates;
+        candidates.reserve(last - first);
+        for (size_t i = first; i < last; ++i)
+            candidates.push_back(i);
+
+        std::vector<mongo::BSONElement> column;
+        for (const Condition &condition : _conditions) {
+            if (stop && stop->load(std::memory_order_relaxed))
+                return;
+
+            // Field of every candidate, then predicates over the column
+            column.clear();
+            for (size_t index : candidates)
+                column.push_back(documents[index]->bsonObj().getFieldDotted(condition.path));
+
+            size_t kept = 0;
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                bool matched = true;
+                for (const Predicate &predicate : condition.predicates) {
+                    if (!matches(predicate, column[i])) {
+                        matched = false;
+                        break;
+                    }
+                }
+                if (matched)
+                    candidates[kept++] = candidates[i];
+            }
+            candidates.resize(kept);
+        }
+
+        selection.insert(selection.end(), candidates.begin(), candidates.end());
+    }
+
+    bool DocumentFilter::matches(const Predicate &predicate, const mongo::BSONElement &value)
+    {
+        switch (predicate.op) {
+        case Exists:
+            return value.eoo() != predicate.operand.trueValue();
+        case Ne:
+            return !matches({ Eq, predicate.operand }, value);
+        case Nin:
+            return !matches({ In, predicate.operand }, value);
+        case In: {
+            mongo::BSONObjIterator it(predicate.operand.embeddedObject());
+            while (it.more()) {
+                if (matches({ Eq, it.next() }, value))
+                    return true;
+            }
+            return false;
+        }
+        default:
+            break;
+        }
+
+        // Missing field equals to null only
+        if (value.eoo())
+            return predicate.op == Eq && predicate.operand.isNull();
+
+        if (matchesValue(predicate.op, predicate.operand, value))
+            return true;
+
+        // Any element of array
+        if (value.type() == mongo::Array && predicate.operand.type() != mongo::Array) {
+            mongo::BSONObjIterator it(value.embeddedObject());
+            while (it.more()) {
+                if (matchesValue(predicate.op, predicate.operand, it.next()))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    bool DocumentFilter::matchesValue(Operator op, const mongo::BSONElement &operand, const mongo::BSONElement &value)
+    {
+        // As in query, values of different kinds (i.e. numbers and strings) are not ordered
+        if (operand.canonicalType() != value.canonicalType())
+            return false;
+
+        int const compared = value.woCompare(operand, false);
+        switch (op) {
+        case Eq:  return compared == 0;
+        case Gt:  return compared > 0;
+        case Gte: return compared >= 0;
+        case Lt:  return compared < 0;
+        case Lte: return compared <= 0;
+        default:  return false;
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/Core.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Subset of query language evaluated over documents already shown, without server:
+     *        { <path>: <value>, <path>: { <operator>: <value>, ... }, ... }, all conditions must
+     *        match. Operators are $eq, $ne, $gt, $gte, $lt, $lte, $in, $nin and $exists.
+     *        Paths are dotted ("address.city") and do not descend into arrays, but array field
+     *        matches if any of its elements does (as in query).
+     */
+    class DocumentFilter
+    {
+    public:
+        /**
+         * @throws std::invalid_argument, if filter has unsupported operators
+         */
+        explicit DocumentFilter(const mongo::BSONObj &filter);
+
+        bool isEmpty() const { return _conditions.empty(); }
+
+        /**
+         * @brief Appends indexes of documents [first, last) matching filter to 'selection',
+         *        ascending. Every condition extracts its field of remaining candidates first
+         *        and then filters them, so later conditions see fewer documents.
+         * @param stop If set, selection returns early (with incomplete result).
+         */
+        void select(const std::vector<MongoDocumentPtr> &documents, size_t first, size_t last,
+                    std::vector<size_t> &selection, const std::atomic<bool> *stop = nullptr) const;
+
+    private:
+        enum Operator { Eq, Ne, Gt, Gte, Lt, Lte, In, Nin, Exists };
+
+        struct Predicate
+        {
+            Operator op;
+            mongo::BSONElement operand;     // points into _filter
+        };
+
+        struct Condition
+        {
+            std::string path;
+            std::vector<Predicate> predicates;
+        };
+
+        static bool matches(const Predicate &predicate, const mongo::BSONElement &value);
+        static bool matchesValue(Operator op, const mongo::BSONElement &operand, const mongo::BSONElement &value);
+
+        mongo::BSONObj _filter;
+        std::vector<Condition> _conditions;
+    };
+}
@@ -0,0 +1,122 @@
+#include "robomongo/core/domain/DocumentSizeHistogram.h"
+
+#include <algorithm>
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace
+{
+    bool largerFirst(const Robomongo::DocumentSizeHistogram::Document &a, 
+                     const Robomongo::DocumentSizeHistogram::Document &b)
+    {
+        return a.size > b.size;
+    }
+
+    // { _id: ... } of document, projections and views may have no _id
+    mongo::BSONObj idOf(const mongo::BSONObj &document)
+    {
+        mongo::BSONElement const id = document["_id"];
+        return id.eoo() ? mongo::BSONObj() : id.wrap();
+    }
+}
+
+namespace Robomongo
+{
+    DocumentSizeHistogram::DocumentSizeHistogram(size_t topCount /* = 20 */) :
+        _topCount(topCount),
+        _documents(0),
+        _totalBytes(0)
+    {
+        _largest.reserve(topCount + 1);
+    }
+
+    void DocumentSizeHistogram::add(const mongo::BSONObj &document)
+    {
+        long long const size = document.objsize();
+        int const bucket = bucketIndex(size);
+        ++_counts[bucket];
+        _bytes[bucket] += size;
+        ++_documents;
+        _totalBytes += size;
+
+        // Id is copied only for documents which get into the top
+        if (_largest.size() < _topCount || (!_largest.empty() && size > _largest.front().size))
+            addLargest(idOf(document), size);
+    }
+
+    mongo::BSONArray DocumentSizeHistogram::pipeline(int sampleSize, size_t topCount)
+    {
+        mongo::BSONArrayBuilder boundaries;
+        boundaries.append(0);
+        for (int bucket = 1; bucket <= BucketCount; ++bucket)
+            boundaries.append(bucketLowerBytes(bucket));
+
+        mongo::BSONArrayBuilder pipeline;
+        if (sampleSize > 0)
+            pipeline.append(BSON("$sample" << BSON("size" << sampleSize)));
+        pipeline.append(BSON("$project" << BSON("size" << BSON("$bsonSize" << "$$ROOT"))));
+        pipeline.append(BSON("$facet" << BSON(
+            "histogram" << BSON_ARRAY(BSON("$bucket" << BSON(
+                "groupBy" << "$size" << "boundaries" << boundaries.arr() << 
+                "default" << bucketLowerBytes(BucketCount) << 
+                "output" << BSON("count" << BSON("$sum" << 1) << "bytes" << BSON("$sum" << "$size"))))) <<
+            "largest" << BSON_ARRAY(
+                BSON("$sort" << BSON("size" << -1)) << 
+                BSON("$limit" << static_cast<long long>(std::max<size_t>(topCount, 1)))))));
+        return pipeline.arr();
+    }
+
+    void DocumentSizeHistogram::addPipelineResult(const mongo::BSONObj &result)
+    {
+        for (mongo::BSONObjIterator it(result.getObjectField("histogram")); it.more();) {
+            mongo::BSONObj const bucketObj = it.next().Obj();
+            int const bucket = bucketIndex(bucketObj["_id"].safeNumberLong());
+            long long const count = bucketObj["count"].safeNumberLong();
+            long long const bytes = bucketObj["bytes"].safeNumberLong();
+            _counts[bucket] += count;
+            _bytes[bucket] += bytes;
+            _documents += count;
+            _totalBytes += bytes;
+        }
+
+        for (mongo::BSONObjIterator it(result.getObjectField("largest")); it.more();) {
+            mongo::BSONObj const document = it.next().Obj();
+            addLargest(idOf(document), document["size"].safeNumberLong());
+        }
+    }
+
+    std::vector<DocumentSizeHistogram::Document> DocumentSizeHistogram::largest() const
+    {
+        std::vector<Document> largest = _largest;
+        std::sort(largest.begin(), largest.end(), largerFirst);
+        return largest;
+    }
+
+    int DocumentSizeHistogram::bucketIndex(long long size)
+    {
+        int bucket = 0;
+        while (size > 1 && bucket < BucketCount - 1) {
+            size >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    long long DocumentSizeHistogram::bucketLowerBytes(int bucket)
+    {
+        return bucket == 0 ? 0 : 1LL << bucket;
+    }
+
+    void DocumentSizeHistogram::addLargest(const mongo::BSONObj &id, long long size)
+    {
+        if (_topCount == 0)
+            return;
+
+        // Heap with the smallest of the top on front, it is replaced by larger one
+        _largest.push_back(Document{ id, size });
+        std::push_heap(_largest.begin(), _largest.end(), largerFirst);
+        if (_largest.size() > _topCount) {
+            std::pop_heap(_largest.begin(), _largest.end(), largerFirst);
+            _largest.pop_back();
+        }
+    }
+}
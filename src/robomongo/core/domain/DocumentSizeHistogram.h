@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Log-scale histogram of BSON sizes of documents and the largest of them. Built by
+     *        server with $bsonSize (see pipeline()), or from documents read by client on servers
+     *        older than 4.4. Memory is fixed: buckets and 'topCount' largest ids.
+     */
+    class DocumentSizeHistogram
+    {
+    public:
+        // Bucket k counts sizes in [2^k, 2^(k+1)) bytes (bucket 0 from 0). BSON document
+        // has at most 16 MB + 16 KB, so the last one is [16 MB, 32 MB).
+        static const int BucketCount = 25;
+
+        struct Document
+        {
+            mongo::BSONObj id;      // { _id: ... }
+            long long size = 0;
+        };
+
+        explicit DocumentSizeHistogram(size_t topCount = 20);
+
+        // Client side: size of whole document is counted, _id is kept if it is one of the largest
+        void add(const mongo::BSONObj &document);
+
+        /**
+         * @brief Server side aggregation: size of every document ($bsonSize), then one $facet
+         *        with $bucket of powers of two and $sort of the largest 'topCount'
+         * @param sampleSize $sample of this size goes first, 0 for whole collection
+         */
+        static mongo::BSONArray pipeline(int sampleSize, size_t topCount);
+
+        // Reads the only document of pipeline()
+        void addPipelineResult(const mongo::BSONObj &result);
+
+        long long documents() const { return _documents; }
+        long long totalBytes() const { return _totalBytes; }
+        long long count(int bucket) const { return _counts[bucket]; }
+        long long bytes(int bucket) const { return _bytes[bucket]; }
+
+        // Largest first
+        std::vector<Document> largest() const;
+
+        static int bucketIndex(long long size);
+        static long long bucketLowerBytes(int bucket);
+
+    private:
+        void addLargest(const mongo::BSONObj &id, long long size);
+
+        size_t const _topCount;
+        std::array<long long, BucketCount> _counts {};
+        std::array<long long, BucketCount> _bytes {};
+        std::vector<Document> _largest;     // min-heap by size, at most _topCount
+        long long _documents;
+        long long _totalBytes;
+    };
+}
@@ -0,0 +1,48 @@
+#include "gtest/gtest.h"
+#include "DocumentSizeHistogram.h"
+
+#include <string>
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+TEST(document_size_histogram_tests, buckets_are_powers_of_two)
+{
+    EXPECT_EQ(0, DocumentSizeHistogram::bucketIndex(1));
+    EXPECT_EQ(1, DocumentSizeHistogram::bucketIndex(3));
+    EXPECT_EQ(10, DocumentSizeHistogram::bucketIndex(1024));
+    EXPECT_EQ(10, DocumentSizeHistogram::bucketIndex(2047));
+    EXPECT_EQ(24, DocumentSizeHistogram::bucketIndex(16 * 1024 * 1024 + 16 * 1024));
+    EXPECT_EQ(1024, DocumentSizeHistogram::bucketLowerBytes(10));
+}
+
+TEST(document_size_histogram_tests, client_side_keeps_largest)
+{
+    DocumentSizeHistogram histogram(2);
+    for (int i = 0; i < 10; ++i)
+        histogram.add(BSON("_id" << i << "data" << std::string(i * 100, 'x')));
+
+    EXPECT_EQ(10, histogram.documents());
+    std::vector<DocumentSizeHistogram::Document> const largest = histogram.largest();
+    ASSERT_EQ(2u, largest.size());
+    EXPECT_EQ(9, largest[0].id["_id"].numberInt());
+    EXPECT_EQ(8, largest[1].id["_id"].numberInt());
+    EXPECT_GT(largest[0].size, largest[1].size);
+}
+
+TEST(document_size_histogram_tests, reads_pipeline_result)
+{
+    mongo::BSONObj const result = BSON(
+        "histogram" << BSON_ARRAY(BSON("_id" << 64 << "count" << 3 << "bytes" << 300) <<
+                                  BSON("_id" << 4096 << "count" << 1 << "bytes" << 5000)) <<
+        "largest" << BSON_ARRAY(BSON("_id" << "a" << "size" << 5000) << BSON("_id" << "b" << "size" << 120)));
+
+    DocumentSizeHistogram histogram;
+    histogram.addPipelineResult(result);
+    EXPECT_EQ(4, histogram.documents());
+    EXPECT_EQ(5300, histogram.totalBytes());
+    EXPECT_EQ(3, histogram.count(6));
+    EXPECT_EQ(1, histogram.count(12));
+    ASSERT_EQ(2u, histogram.largest().size());
+    EXPECT_EQ("a", histogram.largest()[0].id["_id"].str());
+}
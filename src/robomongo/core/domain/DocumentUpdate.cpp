@@ -0,0 +1,152 @@
+#include "robomongo/core/domain/DocumentUpdate.h"
+
+#include <cstring>
+#include <map>
+#include <string>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace
+{
+    struct Changes
+    {
+        mongo::BSONObjBuilder set;
+        mongo::BSONObjBuilder unset;
+        mongo::BSONObjBuilder guard;
+    };
+
+    bool equalValues(const mongo::BSONElement &left, const mongo::BSONElement &right)
+    {
+        return left.type() == right.type() && left.valuesize() == right.valuesize() &&
+               std::memcmp(left.value(), right.value(), left.valuesize()) == 0;
+    }
+
+    // Name can be part of dotted path of update operators
+    bool isAddressable(const char *name)
+    {
+        return *name != '\0' && *name != '$' && !std::strchr(name, '.');
+    }
+
+    void setValue(Changes &changes, const std::string &path, const mongo::BSONElement &original,
+                  const mongo::BSONElement &edited)
+    {
+        changes.set.appendAs(edited, path);
+        changes.guard.appendAs(original, path);
+    }
+
+    /**
+     * @brief Adds changes that turn 'original' (at 'prefix') into 'edited'
+     * @return False, if they cannot be expressed with paths inside 'original', which
+     *         then has to be set as a whole
+     */
+    bool diffObjects(const mongo::BSONObj &original, const mongo::BSONObj &edited,
+                     const std::string &prefix, Changes &changes)
+    {
+        std::map<std::string, mongo::BSONElement> originalFields;
+        for (mongo::BSONObjIterator it(original); it.more(); ) {
+            mongo::BSONElement const elem = it.next();
+            if (!isAddressable(elem.fieldName()) || 
+                !originalFields.emplace(elem.fieldName(), elem).second)
+                return false;
+        }
+
+        // Fields kept must stay in the same order, new ones can only be appended. Update
+        // operators add new fields in lexicographic order, so they have to be sorted too.
+        std::map<std::string, mongo::BSONElement> editedFields;
+        int lastKept = -1;
+        std::string lastAdded;
+        bool added = false;
+        for (mongo::BSONObjIterator it(edited); it.more(); ) {
+            mongo::BSONElement const elem = it.next();
+            std::string const name = elem.fieldName();
+            if (!isAddressable(name.c_str()) || !editedFields.emplace(name, elem).second)
+                return false;
+
+            auto const orig = originalFields.find(name);
+            if (orig == originalFields.end()) {
+                if (added && name < lastAdded)
+                    return false;
+                lastAdded = name;
+                added = true;
+                continue;
+            }
+
+            if (added)
+                return false;
+
+            int const position = static_cast<int>(orig->second.rawdata() - original.objdata());
+            if (position < lastKept)
+                return false;
+            lastKept = position;
+        }
+
+        for (mongo::BSONObjIterator it(original); it.more(); ) {
+            mongo::BSONElement const elem = it.next();
+            std::string const path = prefix + elem.fieldName();
+            auto const edit = editedFields.find(elem.fieldName());
+            if (edit == editedFields.end()) {
+                changes.unset.append(path, "");
+                changes.guard.appendAs(elem, path);
+                continue;
+            }
+
+            mongo::BSONElement const editedElem = edit->second;
+            if (equalValues(elem, editedElem))
+                continue;
+
+            // Arrays are diffed by position only if their length is not changed
+            bool const bothObjects = elem.type() == mongo::Object && editedElem.type() == mongo::Object;
+            bool const sameArrays = elem.type() == mongo::Array && editedElem.type() == mongo::Array &&
+                                    elem.Obj().nFields() == editedElem.Obj().nFields();
+            if ((bothObjects || sameArrays) && 
+                diffObjects(elem.Obj(), editedElem.Obj(), path + ".", changes))
+                continue;
+
+            setValue(changes, path, elem, editedElem);
+        }
+
+        for (mongo::BSONObjIterator it(edited); it.more(); ) {
+            mongo::BSONElement const elem = it.next();
+            if (originalFields.count(elem.fieldName()))
+                continue;
+
+            std::string const path = prefix + elem.fieldName();
+            changes.set.appendAs(elem, path);
+            changes.guard.append(path, BSON("$exists" << false));
+        }
+        return true;
+    }
+}
+
+namespace Robomongo
+{
+    bool DocumentUpdate::compute(const mongo::BSONObj &original, const mongo::BSONObj &edited)
+    {
+        _filter = mongo::BSONObj();
+        _update = mongo::BSONObj();
+
+        mongo::BSONElement const id = original.getField("_id");
+        mongo::BSONElement const editedId = edited.getField("_id");
+        if (id.eoo() || editedId.eoo() || !equalValues(id, editedId))
+            return false;
+
+        Changes changes;
+        changes.guard.append(id);
+        if (!diffObjects(original, edited, std::string(), changes))
+            return false;
+
+        mongo::BSONObj const set = changes.set.obj();
+        mongo::BSONObj const unset = changes.unset.obj();
+        mongo::BSONObjBuilder update;
+        if (!set.isEmpty())
+            update.append("$set", set);
+        if (!unset.isEmpty())
+            update.append("$unset", unset);
+
+        _filter = changes.guard.obj();
+        _update = update.obj();
+
+        // Loaded values in filter are sent too
+        return _update.objsize() + _filter.objsize() < edited.objsize();
+    }
+}
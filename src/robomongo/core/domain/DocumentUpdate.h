@@ -0,0 +1,41 @@
+#pragma once
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Targeted update of one document, computed from document as it was loaded and
+     *        as it was edited. Changed fields are sent with $set/$unset instead of replacing
+     *        the whole document, filter matches document only if these fields still have
+     *        loaded values (optimistic concurrency), so concurrent change is not overwritten.
+     */
+    class DocumentUpdate
+    {
+    public:
+        /**
+         * @return False, if 'edited' cannot be expressed as $set/$unset of 'original' so that
+         *         result is exactly the same document (_id changed, order of fields changed,
+         *         field names that cannot be used in paths), or if replacement is smaller.
+         *         Then document should be saved as a whole.
+         */
+        bool compute(const mongo::BSONObj &original, const mongo::BSONObj &edited);
+
+        bool isEmpty() const { return _update.isEmpty(); }
+
+        /**
+         * @brief { _id: <id>, <path>: <loaded value>, <new path>: { $exists: false }, ... }
+         */
+        mongo::BSONObj filter() const { return _filter; }
+
+        /**
+         * @brief { $set: { <path>: <value>, ... }, $unset: { <path>: "", ... } }, empty if
+         *        nothing changed
+         */
+        mongo::BSONObj update() const { return _update; }
+
+    private:
+        mongo::BSONObj _filter;
+        mongo::BSONObj _update;
+    };
+}
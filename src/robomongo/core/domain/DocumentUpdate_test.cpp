@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+#include "DocumentUpdate.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include <string>
+
+using namespace Robomongo;
+
+namespace
+{
+    // Large enough field, so that update is smaller than replacement
+    const std::string payload(1000, 'x');
+
+    ::testing::AssertionResult sameBson(const mongo::BSONObj &expected, const mongo::BSONObj &actual)
+    {
+        if (expected.binaryEqual(actual))
+            return ::testing::AssertionSuccess();
+        return ::testing::AssertionFailure() << actual.toString() << " instead of " << expected.toString();
+    }
+}
+
+TEST(document_update_tests, nothing_changed)
+{
+    mongo::BSONObj const doc = BSON("_id" << 1 << "a" << 1 << "payload" << payload);
+    DocumentUpdate diff;
+    ASSERT_TRUE(diff.compute(doc, doc));
+    EXPECT_TRUE(diff.isEmpty());
+}
+
+TEST(document_update_tests, set_unset_and_guard)
+{
+    mongo::BSONObj const original = BSON("_id" << 1 << "a" << 1 << "b" << BSON("c" << 2 << "d" << 3) 
+                                               << "e" << true << "payload" << payload);
+    mongo::BSONObj const edited = BSON("_id" << 1 << "a" << 1 << "b" << BSON("c" << 5 << "d" << 3) 
+                                             << "payload" << payload << "f" << "new");
+    DocumentUpdate diff;
+    ASSERT_TRUE(diff.compute(original, edited));
+    EXPECT_TRUE(sameBson(BSON("$set" << BSON("b.c" << 5 << "f" << "new") << "$unset" << BSON("e" << "")), diff.update()));
+    EXPECT_TRUE(sameBson(BSON("_id" << 1 << "b.c" << 2 << "e" << true << "f" << BSON("$exists" << false)), diff.filter()));
+}
+
+TEST(document_update_tests, arrays_by_position)
+{
+    mongo::BSONObj const original = BSON("_id" << 1 << "arr" << BSON_ARRAY(1 << 2 << 3) 
+                                               << "grow" << BSON_ARRAY(1) << "payload" << payload);
+    mongo::BSONObj const edited = BSON("_id" << 1 << "arr" << BSON_ARRAY(1 << 7 << 3) 
+                                             << "grow" << BSON_ARRAY(1 << 2) << "payload" << payload);
+    DocumentUpdate diff;
+    ASSERT_TRUE(diff.compute(original, edited));
+    EXPECT_TRUE(sameBson(BSON("$set" << BSON("arr.1" << 7 << "grow" << BSON_ARRAY(1 << 2))), diff.update()));
+}
+
+TEST(document_update_tests, replacement_required)
+{
+    mongo::BSONObj const original = BSON("_id" << 1 << "a" << 1 << "b" << 2 << "payload" << payload);
+    DocumentUpdate diff;
+
+    // Changed _id
+    EXPECT_FALSE(diff.compute(original, BSON("_id" << 2 << "a" << 1 << "b" << 2 << "payload" << payload)));
+
+    // Reordered fields
+    EXPECT_FALSE(diff.compute(original, BSON("_id" << 1 << "b" << 2 << "a" << 1 << "payload" << payload)));
+
+    // New field before existing one
+    EXPECT_FALSE(diff.compute(original, BSON("_id" << 1 << "n" << 0 << "a" << 1 << "b" << 2 << "payload" << payload)));
+
+    // Whole document changed, replacement is smaller
+    EXPECT_FALSE(diff.compute(original, BSON("_id" << 1 << "a" << 1 << "b" << 2 << "payload" << "y")));
+}
+
+TEST(document_update_tests, nested_reorder_sets_parent)
+{
+    mongo::BSONObj const original = BSON("_id" << 1 << "o" << BSON("x" << 1 << "y" << 2) << "payload" << payload);
+    mongo::BSONObj const edited = BSON("_id" << 1 << "o" << BSON("y" << 2 << "x" << 1) << "payload" << payload);
+    DocumentUpdate diff;
+    ASSERT_TRUE(diff.compute(original, edited));
+    EXPECT_TRUE(sameBson(BSON("$set" << BSON("o" << BSON("y" << 2 << "x" << 1))), diff.update()));
+}
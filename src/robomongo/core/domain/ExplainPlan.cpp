@@ -0,0 +1,307 @@
+#include "robomongo/core/domain/ExplainPlan.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/utils/BsonUtils.h"
+
+namespace Robomongo
+{
+    namespace ExplainPlan
+    {
+        namespace
+        {
+            // Most fields of compound index
+            size_t const MaxIndexFields = 32;
+
+            std::string json(const mongo::BSONObj &obj)
+            {
+                return BsonUtils::jsonString(obj, mongo::TenGen, 0, DefaultEncoding, Utc);
+            }
+
+            long long number(const mongo::BSONObj &obj, const char *field)
+            {
+                mongo::BSONElement const element = obj[field];
+                return element.isNumber() ? element.safeNumberLong() : -1;
+            }
+
+            Stage parseStage(const mongo::BSONObj &obj);
+
+            // Shard of sharded plan: { shardName: ..., executionStages (or winningPlan): ... }
+            Stage parseShard(const mongo::BSONObj &obj)
+            {
+                Stage shard;
+                shard.stage = "shard " + std::string(obj.getStringField("shardName"));
+                shard.nReturned = number(obj, "nReturned");
+                shard.docsExamined = number(obj, "totalDocsExamined");
+                shard.keysExamined = number(obj, "totalKeysExamined");
+                shard.timeMs = number(obj, "executionTimeMillis");
+
+                mongo::BSONObj plan = obj.getObjectField("executionStages");
+                if (plan.isEmpty())
+                    plan = obj.getObjectField("winningPlan");
+                if (plan.hasField("queryPlan"))     // slot based engine
+                    plan = plan.getObjectField("queryPlan");
+                if (!plan.isEmpty())
+                    shard.children.push_back(parseStage(plan));
+                return shard;
+            }
+
+            void parseChild(const mongo::BSONObj &obj, Stage &parent)
+            {
+                if (obj.hasField("stage"))
+                    parent.children.push_back(parseStage(obj));
+                else if (obj.hasField("shardName"))
+                    parent.children.push_back(parseShard(obj));
+            }
+
+            Stage parseStage(const mongo::BSONObj &obj)
+            {
+                Stage stage;
+                stage.stage = obj.getStringField("stage");
+                stage.nReturned = number(obj, "nReturned");
+                stage.docsExamined = number(obj, "docsExamined");
+                stage.keysExamined = number(obj, "keysExamined");
+                stage.timeMs = number(obj, "executionTimeMillisEstimate");
+
+                if (obj.hasField("indexName")) {
+                    stage.details = obj.getStringField("indexName");
+                    if (obj["keyPattern"].type() == mongo::Object)
+                        stage.details += " " + json(obj.getObjectField("keyPattern"));
+                }
+                else if (obj["filter"].type() == mongo::Object && !obj.getObjectField("filter").isEmpty()) {
+                    stage.details = json(obj.getObjectField("filter"));
+                }
+
+                // Children are inputStage, inputStages, outerStage, innerStage, shards...
+                for (mongo::BSONObjIterator it(obj); it.more();) {
+                    mongo::BSONElement const element = it.next();
+                    if (element.type() == mongo::Object) {
+                        parseChild(element.Obj(), stage);
+                    }
+                    else if (element.type() == mongo::Array) {
+                        for (mongo::BSONObjIterator child(element.Obj()); child.more();) {
+                            mongo::BSONElement const item = child.next();
+                            if (item.type() == mongo::Object)
+                                parseChild(item.Obj(), stage);
+                        }
+                    }
+                }
+                return stage;
+            }
+
+            mongo::BSONObj queryPlan(const mongo::BSONObj &plan)
+            {
+                return plan.hasField("queryPlan") ? plan.getObjectField("queryPlan") : plan;
+            }
+
+            // Plan of query part: { queryPlanner: ..., executionStats: ... }
+            void parseQuery(const mongo::BSONObj &explain, Plan &plan)
+            {
+                mongo::BSONObj const planner = explain.getObjectField("queryPlanner");
+                mongo::BSONObj const stats = explain.getObjectField("executionStats");
+
+                mongo::BSONObj const stages = stats.getObjectField("executionStages");
+                plan.winning = parseStage(!stages.isEmpty() ? stages : queryPlan(planner.getObjectField("winningPlan")));
+                for (mongo::BSONObjIterator it(planner.getObjectField("rejectedPlans")); it.more();) {
+                    mongo::BSONElement const rejected = it.next();
+                    if (rejected.type() == mongo::Object)
+                        plan.rejected.push_back(parseStage(queryPlan(rejected.Obj())));
+                }
+
+                plan.nReturned = std::max(number(stats, "nReturned"), 0LL);
+                plan.docsExamined = std::max(number(stats, "totalDocsExamined"), 0LL);
+                plan.keysExamined = std::max(number(stats, "totalKeysExamined"), 0LL);
+                plan.timeMs = std::max(number(stats, "executionTimeMillis"), 0LL);
+            }
+
+            std::string upper(std::string text)
+            {
+                std::transform(text.begin(), text.end(), text.begin(), 
+                               [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+                return text;
+            }
+
+            bool isOperator(const char *field)
+            {
+                return field[0] == '$';
+            }
+
+            // Equality is a value or { $eq: value }, anything else with operators is range
+            bool isEquality(const mongo::BSONElement &condition)
+            {
+                if (condition.type() != mongo::Object)
+                    return true;
+
+                mongo::BSONObj const obj = condition.Obj();
+                if (obj.isEmpty() || !isOperator(obj.firstElementFieldName()))
+                    return true;
+                return obj.nFields() == 1 && std::strcmp(obj.firstElementFieldName(), "$eq") == 0;
+            }
+
+            void collectFields(const mongo::BSONObj &filter, std::vector<std::string> &equality,
+                               std::vector<std::string> &range)
+            {
+                for (mongo::BSONObjIterator it(filter); it.more();) {
+                    mongo::BSONElement const condition = it.next();
+                    char const *field = condition.fieldName();
+                    if (std::strcmp(field, "$and") == 0 && condition.type() == mongo::Array) {
+                        for (mongo::BSONObjIterator child(condition.Obj()); child.more();) {
+                            mongo::BSONElement const item = child.next();
+                            if (item.type() == mongo::Object)
+                                collectFields(item.Obj(), equality, range);
+                        }
+                    }
+                    else if (!isOperator(field)) {
+                        (isEquality(condition) ? equality : range).push_back(field);
+                    }
+                }
+            }
+        }
+
+        Plan parse(const mongo::BSONObj &explain)
+        {
+            Plan plan;
+
+            // Aggregation: { stages: [ { $cursor: <query plan> }, { $group: ..., nReturned }, ... ] },
+            // pipelines pushed down to slot based engine are explained as queries
+            mongo::BSONObj const stages = explain.getObjectField("stages");
+            if (stages.isEmpty()) {
+                parseQuery(explain, plan);
+                return plan;
+            }
+
+            std::vector<Stage> pipeline;
+            for (mongo::BSONObjIterator it(stages); it.more();) {
+                mongo::BSONElement const element = it.next();
+                if (element.type() != mongo::Object)
+                    continue;
+
+                mongo::BSONObj const obj = element.Obj();
+                char const *name = obj.firstElementFieldName();
+                if (std::strcmp(name, "$cursor") == 0) {
+                    Plan query;
+                    parseQuery(obj.getObjectField("$cursor"), query);
+                    plan.rejected = query.rejected;
+                    plan.docsExamined = query.docsExamined;
+                    plan.keysExamined = query.keysExamined;
+                    plan.timeMs = query.timeMs;
+                    pipeline.push_back(query.winning);
+                    continue;
+                }
+
+                Stage stage;
+                stage.stage = name;
+                stage.nReturned = number(obj, "nReturned");
+                stage.timeMs = number(obj, "executionTimeMillisEstimate");
+                if (obj.firstElement().type() == mongo::Object)
+                    stage.details = json(obj.firstElement().Obj());
+                pipeline.push_back(stage);
+            }
+
+            // Every stage is input of the next one, the last one is root
+            for (size_t i = 1; i < pipeline.size(); ++i)
+                pipeline[i].children.push_back(pipeline[i - 1]);
+            if (!pipeline.empty()) {
+                plan.winning = pipeline.back();
+                plan.nReturned = std::max(plan.winning.nReturned, 0LL);
+                plan.timeMs = std::max(plan.timeMs, plan.winning.timeMs);
+            }
+            return plan;
+        }
+
+        Stage parseTree(const mongo::BSONObj &plan)
+        {
+            return parseStage(queryPlan(plan));
+        }
+
+        std::string summary(const Stage &stage)
+        {
+            if (stage.children.empty()) {
+                bool const scan = stage.stage == "IXSCAN" || stage.stage == "COUNT_SCAN" ||
+                                  stage.stage == "DISTINCT_SCAN";
+                return scan && !stage.details.empty() ? stage.stage + " " + stage.details : stage.stage;
+            }
+
+            std::string text;
+            for (Stage const &child : stage.children) {
+                if (!text.empty())
+                    text += ", ";
+                text += summary(child);
+            }
+            return text;
+        }
+
+        bool contains(const Stage &stage, const std::string &name)
+        {
+            if (upper(stage.stage) == upper(name))
+                return true;
+            for (Stage const &child : stage.children) {
+                if (contains(child, name))
+                    return true;
+            }
+            return false;
+        }
+
+        bool needsIndex(const Stage &stage)
+        {
+            return contains(stage, "COLLSCAN") || contains(stage, "SORT") || contains(stage, "$sort");
+        }
+
+        mongo::BSONObj suggestIndex(const mongo::BSONObj &filter, const mongo::BSONObj &sort)
+        {
+            std::vector<std::string> equality, range;
+            collectFields(filter, equality, range);
+
+            std::vector<std::string> added;
+            mongo::BSONObjBuilder keys;
+            auto add = [&](const std::string &field, const mongo::BSONElement &direction) {
+                if (added.size() >= MaxIndexFields || std::find(added.begin(), added.end(), field) != added.end())
+                    return;
+                added.push_back(field);
+                if (direction.isNumber())
+                    keys.append(field, direction.numberInt() < 0 ? -1 : 1);
+                else
+                    keys.append(field, 1);
+            };
+
+            for (std::string const &field : equality)
+                add(field, mongo::BSONElement());
+            for (mongo::BSONObjIterator it(sort); it.more();) {
+                mongo::BSONElement const field = it.next();
+                if (!isOperator(field.fieldName()))
+                    add(field.fieldName(), field);
+            }
+            for (std::string const &field : range)
+                add(field, mongo::BSONElement());
+            return keys.obj();
+        }
+
+        void pipelineFilterAndSort(const mongo::BSONObj &pipeline, mongo::BSONObj &filter, mongo::BSONObj &sort)
+        {
+            mongo::BSONArrayBuilder matches;
+            int count = 0;
+            for (mongo::BSONObjIterator it(pipeline); it.more();) {
+                mongo::BSONElement const element = it.next();
+                if (element.type() != mongo::Object)
+                    break;
+
+                mongo::BSONObj const stage = element.Obj();
+                char const *name = stage.firstElementFieldName();
+                if (std::strcmp(name, "$match") == 0 && stage.firstElement().type() == mongo::Object) {
+                    matches.append(stage.firstElement().Obj());
+                    ++count;
+                    continue;
+                }
+                if (std::strcmp(name, "$sort") == 0 && stage.firstElement().type() == mongo::Object)
+                    sort = stage.firstElement().Obj().getOwned();
+                break;
+            }
+            filter = count > 1 ? BSON("$and" << matches.arr()) : 
+                     count == 1 ? matches.arr().firstElement().Obj().getOwned() : mongo::BSONObj();
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Plan trees of explain command at "executionStats" verbosity (find or aggregate,
+     *        classic or slot based engine, sharded or not) and index suggestions for the
+     *        plans that scan collection or sort in memory.
+     */
+    namespace ExplainPlan
+    {
+        struct Stage
+        {
+            std::string stage;          // i.e. "IXSCAN", "$group", "shard rs0"
+            std::string details;        // index and its key pattern, or filter
+            // -1, if stage was not executed (rejected plans have no statistics)
+            long long nReturned = -1;
+            long long docsExamined = -1;
+            long long keysExamined = -1;
+            long long timeMs = -1;      // executionTimeMillisEstimate
+            std::vector<Stage> children;
+        };
+
+        struct Plan
+        {
+            Stage winning;              // with statistics, root is the last stage
+            std::vector<Stage> rejected;
+            long long nReturned = 0;
+            long long docsExamined = 0;
+            long long keysExamined = 0;
+            long long timeMs = 0;       // executionTimeMillis of the slowest shard
+        };
+
+        Plan parse(const mongo::BSONObj &explain);
+
+        // Tree of one plan without statistics, i.e. winningPlan or cachedPlan of plan cache
+        Stage parseTree(const mongo::BSONObj &plan);
+
+        // Leaf stages of plan as server writes planSummary, i.e. "IXSCAN a_1 { a: 1 }, COLLSCAN"
+        std::string summary(const Stage &stage);
+
+        // Stage or one of its descendants has this name (case insensitive), i.e. "COLLSCAN"
+        bool contains(const Stage &stage, const std::string &name);
+
+        // Plan scans the whole collection or sorts documents in memory
+        bool needsIndex(const Stage &stage);
+
+        /**
+         * @brief Compound index for filter and sort by Equality, Sort, Range rule: fields
+         *        compared by equality, then sort fields, then fields of other conditions.
+         *        Conditions under $and are used, $or, $expr and the like are not.
+         * @return Key pattern, empty if filter and sort have no fields
+         */
+        mongo::BSONObj suggestIndex(const mongo::BSONObj &filter, const mongo::BSONObj &sort);
+
+        // Filter of leading $match stages of pipeline and sort of $sort right after them
+        void pipelineFilterAndSort(const mongo::BSONObj &pipeline, mongo::BSONObj &filter, mongo::BSONObj &sort);
+    }
+}
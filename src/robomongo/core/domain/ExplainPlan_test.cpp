@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+#include "ExplainPlan.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+TEST(explain_plan_tests, find_with_rejected_plan)
+{
+    mongo::BSONObj const scan = BSON("stage" << "IXSCAN" << "indexName" << "a_1" << "keyPattern" << BSON("a" << 1) <<
+                                     "nReturned" << 5 << "keysExamined" << 5);
+    mongo::BSONObj const explain = BSON(
+        "queryPlanner" << BSON("winningPlan" << BSON("stage" << "FETCH" << "inputStage" << scan) <<
+                               "rejectedPlans" << BSON_ARRAY(BSON("stage" << "COLLSCAN"))) <<
+        "executionStats" << BSON("nReturned" << 5 << "executionTimeMillis" << 3 << "totalKeysExamined" << 5 <<
+                                 "totalDocsExamined" << 5 << "executionStages" <<
+                                 BSON("stage" << "FETCH" << "nReturned" << 5 << "docsExamined" << 5 << 
+                                      "inputStage" << scan)));
+
+    ExplainPlan::Plan const plan = ExplainPlan::parse(explain);
+    EXPECT_EQ("FETCH", plan.winning.stage);
+    ASSERT_EQ(1u, plan.winning.children.size());
+    EXPECT_EQ("IXSCAN", plan.winning.children[0].stage);
+    EXPECT_EQ(5, plan.winning.children[0].keysExamined);
+    EXPECT_EQ(3, plan.timeMs);
+    ASSERT_EQ(1u, plan.rejected.size());
+    EXPECT_EQ(-1, plan.rejected[0].nReturned);
+    EXPECT_FALSE(ExplainPlan::needsIndex(plan.winning));
+    EXPECT_TRUE(ExplainPlan::needsIndex(plan.rejected[0]));
+}
+
+TEST(explain_plan_tests, aggregate_stages_are_chained)
+{
+    mongo::BSONObj const cursor = BSON("queryPlanner" << BSON("winningPlan" << BSON("stage" << "COLLSCAN")) <<
+                                       "executionStats" << BSON("totalDocsExamined" << 100 << "executionStages" <<
+                                                                BSON("stage" << "COLLSCAN" << "nReturned" << 100)));
+    mongo::BSONObj const explain = BSON("stages" << BSON_ARRAY(
+        BSON("$cursor" << cursor) << BSON("$group" << BSON("_id" << "$a") << "nReturned" << 4)));
+
+    ExplainPlan::Plan const plan = ExplainPlan::parse(explain);
+    EXPECT_EQ("$group", plan.winning.stage);
+    EXPECT_EQ(4, plan.nReturned);
+    EXPECT_EQ(100, plan.docsExamined);
+    ASSERT_EQ(1u, plan.winning.children.size());
+    EXPECT_TRUE(ExplainPlan::contains(plan.winning, "collscan"));
+}
+
+TEST(explain_plan_tests, equality_sort_range)
+{
+    mongo::BSONObj const filter = BSON("age" << BSON("$gt" << 20) << "status" << "A" << 
+                                       "$and" << BSON_ARRAY(BSON("city" << BSON("$eq" << "X"))));
+    mongo::BSONObj const keys = ExplainPlan::suggestIndex(filter, BSON("name" << -1 << "status" << 1));
+    EXPECT_EQ(BSON("status" << 1 << "city" << 1 << "name" << -1 << "age" << 1).toString(), keys.toString());
+
+    EXPECT_TRUE(ExplainPlan::suggestIndex(BSON("$or" << BSON_ARRAY(BSON("a" << 1))), mongo::BSONObj()).isEmpty());
+}
+
+TEST(explain_plan_tests, pipeline_filter_and_sort)
+{
+    mongo::BSONArray const pipeline = BSON_ARRAY(BSON("$match" << BSON("a" << 1)) << BSON("$match" << BSON("b" << 2)) <<
+                                                 BSON("$sort" << BSON("c" << 1)) << BSON("$match" << BSON("d" << 1)));
+    mongo::BSONObj filter, sort;
+    ExplainPlan::pipelineFilterAndSort(pipeline, filter, sort);
+    EXPECT_EQ(BSON("$and" << BSON_ARRAY(BSON("a" << 1) << BSON("b" << 2))).toString(), filter.toString());
+    EXPECT_EQ(BSON("c" << 1).toString(), sort.toString());
+}
+
+TEST(explain_plan_tests, summary_of_leaf_stages)
+{
+    mongo::BSONObj const plan = BSON("stage" << "FETCH" << "inputStage" << BSON("stage" << "OR" << "inputStages" <<
+        BSON_ARRAY(BSON("stage" << "IXSCAN" << "indexName" << "a_1" << "keyPattern" << BSON("a" << 1)) <<
+                   BSON("stage" << "COLLSCAN"))));
+
+    std::string const summary = ExplainPlan::summary(ExplainPlan::parseTree(plan));
+    EXPECT_EQ(0u, summary.find("IXSCAN a_1 {"));
+    EXPECT_NE(std::string::npos, summary.find("}, COLLSCAN"));
+    EXPECT_EQ("COLLSCAN", ExplainPlan::summary(ExplainPlan::parseTree(BSON("stage" << "COLLSCAN"))));
+}
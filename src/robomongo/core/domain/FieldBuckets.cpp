@@ -0,0 +1,140 @@
+#include "robomongo/core/domain/FieldBuckets.h"
+
+#include <stdexcept>
+#include <QDateTime>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace
+{
+    using Robomongo::FieldBuckets::DateUnit;
+
+    // Average lengths, only to choose unit
+    long long approximateUnitMs(DateUnit unit)
+    {
+        switch (unit) {
+        case DateUnit::Minute: return 60LL * 1000;
+        case DateUnit::Hour:   return 60LL * 60 * 1000;
+        case DateUnit::Day:    return 24LL * 60 * 60 * 1000;
+        case DateUnit::Week:   return 7LL * 24 * 60 * 60 * 1000;
+        case DateUnit::Month:  return 2629746LL * 1000;
+        default:               return 31556952LL * 1000;
+        }
+    }
+
+    // Start of the next bucket, months and years are of calendar length
+    long long bucketEndMs(long long fromMs, DateUnit unit)
+    {
+        QDateTime const from = QDateTime::fromMSecsSinceEpoch(fromMs, Qt::UTC);
+        switch (unit) {
+        case DateUnit::Month: return from.addMonths(1).toMSecsSinceEpoch();
+        case DateUnit::Year:  return from.addYears(1).toMSecsSinceEpoch();
+        default:              return fromMs + approximateUnitMs(unit);
+        }
+    }
+
+    // { $dateFromParts: ... } with parts of 'date' down to 'unit', weeks are ISO weeks
+    mongo::BSONObj legacyTruncate(const std::string &date, DateUnit unit)
+    {
+        mongo::BSONObjBuilder parts;
+        if (unit == DateUnit::Week) {
+            parts.append("isoWeekYear", BSON("$isoWeekYear" << date));
+            parts.append("isoWeek", BSON("$isoWeek" << date));
+        }
+        else {
+            parts.append("year", BSON("$year" << date));
+            if (unit <= DateUnit::Month)
+                parts.append("month", BSON("$month" << date));
+            if (unit <= DateUnit::Day)
+                parts.append("day", BSON("$dayOfMonth" << date));
+            if (unit <= DateUnit::Hour)
+                parts.append("hour", BSON("$hour" << date));
+            if (unit <= DateUnit::Minute)
+                parts.append("minute", BSON("$minute" << date));
+        }
+        return BSON("$dateFromParts" << parts.obj());
+    }
+}
+
+namespace Robomongo
+{
+    namespace FieldBuckets
+    {
+        const char *unitName(DateUnit unit)
+        {
+            static const char *const names[DateUnitCount] = { "minute", "hour", "day", "week", "month", "year" };
+            return names[static_cast<int>(unit)];
+        }
+
+        DateUnit suitableUnit(long long fromMs, long long toMs, int maxBuckets)
+        {
+            long long const span = toMs > fromMs ? toMs - fromMs : 0;
+            for (int i = 0; i < DateUnitCount - 1; ++i) {
+                DateUnit const unit = static_cast<DateUnit>(i);
+                if (span / approximateUnitMs(unit) < maxBuckets)
+                    return unit;
+            }
+            return DateUnit::Year;
+        }
+
+        mongo::BSONArray pipeline(const mongo::BSONObj &filter, const std::string &field, const Spec &spec,
+                                  bool legacyDates)
+        {
+            if (field.empty() || field.front() == '$' || field.front() == '.' || field.back() == '.' ||
+                field.find("..") != std::string::npos)
+                throw std::runtime_error("Values of field \"" + field + "\" cannot be charted.");
+
+            bool const dates = spec.kind == Kind::Dates;
+            mongo::BSONObj const typeMatch = BSON(field << BSON("$type" << (dates ? "date" : "number")));
+
+            mongo::BSONArrayBuilder stages;
+            stages.append(BSON("$match" << (filter.isEmpty() ? typeMatch : BSON("$and" << BSON_ARRAY(filter << typeMatch)))));
+
+            std::string const value = "$" + field;
+            if (!dates) {
+                stages.append(BSON("$bucketAuto" << BSON("groupBy" << value << "buckets" << spec.buckets)));
+                return stages.arr();
+            }
+
+            mongo::BSONObj const truncated = legacyDates ? legacyTruncate(value, spec.unit) :
+                BSON("$dateTrunc" << BSON("date" << value << "unit" << unitName(spec.unit) << "startOfWeek" << "monday"));
+            stages.append(BSON("$group" << BSON("_id" << truncated << "count" << BSON("$sum" << 1))));
+            stages.append(BSON("$sort" << BSON("_id" << 1)));
+
+            // One more than shown tells that series was cut
+            stages.append(BSON("$limit" << MaxDateBuckets + 1));
+            return stages.arr();
+        }
+
+        void readResult(const std::vector<mongo::BSONObj> &documents, Result &result)
+        {
+            result.buckets.clear();
+            result.documents = 0;
+            result.truncated = false;
+
+            bool const dates = result.spec.kind == Kind::Dates;
+            for (mongo::BSONObj const &document : documents) {
+                if (dates && result.buckets.size() == static_cast<size_t>(MaxDateBuckets)) {
+                    result.truncated = true;
+                    break;
+                }
+
+                Bucket bucket;
+                bucket.count = document["count"].safeNumberLong();
+                if (dates) {
+                    long long const fromMs = document["_id"].date().toMillisSinceEpoch();
+                    bucket.from = static_cast<double>(fromMs);
+                    bucket.to = static_cast<double>(bucketEndMs(fromMs, result.spec.unit));
+                }
+                else {
+                    mongo::BSONObj const bounds = document.getObjectField("_id");
+                    bucket.from = bounds["min"].numberDouble();
+                    bucket.to = bounds["max"].numberDouble();
+                }
+
+                result.documents += bucket.count;
+                result.buckets.push_back(bucket);
+            }
+        }
+    }
+}
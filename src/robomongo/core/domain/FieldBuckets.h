@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Histogram of numeric field or time series of date field among documents matching
+     *        query filter, bucketed on server: only a few hundred rows come back, however many
+     *        documents match. Documents where field has another type are not counted.
+     */
+    namespace FieldBuckets
+    {
+        enum class Kind
+        {
+            Numbers,    // $bucketAuto, buckets of about the same number of documents
+            Dates       // $dateTrunc and $group, buckets of the same length of time
+        };
+
+        // Units of $dateTrunc, weeks start on Monday
+        enum class DateUnit
+        {
+            Minute, Hour, Day, Week, Month, Year
+        };
+        constexpr int DateUnitCount = 6;
+
+        constexpr int DefaultBucketCount = 40;
+
+        // Time series longer than this are cut, the earliest buckets are kept
+        constexpr int MaxDateBuckets = 1000;
+
+        // Time limit, if tab has none; time limit of tab can only make it shorter
+        constexpr int DefaultMaxTimeMs = 60000;
+
+        struct Spec
+        {
+            Kind kind = Kind::Numbers;
+            int buckets = DefaultBucketCount;   // of numbers
+            DateUnit unit = DateUnit::Day;      // of dates
+        };
+
+        struct Bucket
+        {
+            double from = 0;        // number, or milliseconds since epoch of dates
+            double to = 0;          // exclusive, except of the last bucket of numbers
+            long long count = 0;
+        };
+
+        struct Result
+        {
+            std::string field;
+            Spec spec;
+            std::vector<Bucket> buckets;    // ascending
+            long long documents = 0;        // counted in buckets
+            bool truncated = false;         // time series had more than MaxDateBuckets buckets
+        };
+
+        // "minute", "hour" ... as in $dateTrunc
+        const char *unitName(DateUnit unit);
+
+        /**
+         * @brief The shortest unit, which splits [fromMs, toMs] into at most 'maxBuckets' buckets.
+         *        Used to choose unit from dates of shown documents, before server is asked.
+         */
+        DateUnit suitableUnit(long long fromMs, long long toMs, int maxBuckets = 200);
+
+        /**
+         * @brief Numbers: [ $match, $bucketAuto ], dates: [ $match, $group, $sort, $limit ].
+         *        $match keeps documents of 'filter', where field has the charted type.
+         * @param legacyDates Dates are truncated with $dateFromParts, for servers older than
+         *        MongoDB 5.0, which have no $dateTrunc
+         * @throws std::runtime_error, if 'field' is not a field path
+         */
+        mongo::BSONArray pipeline(const mongo::BSONObj &filter, const std::string &field, const Spec &spec,
+                                  bool legacyDates = false);
+
+        // Fills buckets and totals of 'result' (with 'spec' set) from documents of pipeline() result
+        void readResult(const std::vector<mongo::BSONObj> &documents, Result &result);
+    }
+}
@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+#include "FieldBuckets.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    mongo::BSONObj dateBucket(long long ms, long long count)
+    {
+        mongo::BSONObjBuilder builder;
+        builder.appendDate("_id", mongo::Date_t::fromMillisSinceEpoch(ms));
+        builder.append("count", count);
+        return builder.obj();
+    }
+}
+
+TEST(field_buckets_tests, numbers_pipeline)
+{
+    FieldBuckets::Spec spec;
+    spec.buckets = 10;
+    mongo::BSONArray const all = FieldBuckets::pipeline(mongo::BSONObj(), "price", spec);
+    ASSERT_EQ(2, all.nFields());
+    EXPECT_STREQ("$match", all["0"].Obj().firstElementFieldName());
+    EXPECT_STREQ("$bucketAuto", all["1"].Obj().firstElementFieldName());
+    EXPECT_EQ("number", all["0"].Obj()["$match"].Obj()["price"].Obj()["$type"].String());
+    mongo::BSONObj const bucketAuto = all["1"].Obj()["$bucketAuto"].Obj();
+    EXPECT_EQ("$price", bucketAuto["groupBy"].String());
+    EXPECT_EQ(10, bucketAuto["buckets"].numberInt());
+
+    mongo::BSONArray const filtered = FieldBuckets::pipeline(BSON("a" << 1), "price", spec);
+    EXPECT_EQ(2, filtered["0"].Obj()["$match"].Obj()["$and"].Obj().nFields());
+
+    EXPECT_THROW(FieldBuckets::pipeline(mongo::BSONObj(), "$where", spec), std::runtime_error);
+}
+
+TEST(field_buckets_tests, dates_pipeline)
+{
+    FieldBuckets::Spec spec;
+    spec.kind = FieldBuckets::Kind::Dates;
+    spec.unit = FieldBuckets::DateUnit::Hour;
+    mongo::BSONArray const pipeline = FieldBuckets::pipeline(mongo::BSONObj(), "ts", spec);
+    ASSERT_EQ(4, pipeline.nFields());
+    EXPECT_STREQ("$match", pipeline["0"].Obj().firstElementFieldName());
+    EXPECT_STREQ("$group", pipeline["1"].Obj().firstElementFieldName());
+    EXPECT_STREQ("$sort", pipeline["2"].Obj().firstElementFieldName());
+    EXPECT_STREQ("$limit", pipeline["3"].Obj().firstElementFieldName());
+    mongo::BSONObj const trunc = pipeline["1"].Obj()["$group"].Obj()["_id"].Obj()["$dateTrunc"].Obj();
+    EXPECT_EQ("$ts", trunc["date"].String());
+    EXPECT_EQ("hour", trunc["unit"].String());
+    EXPECT_EQ(FieldBuckets::MaxDateBuckets + 1, pipeline["3"].Obj()["$limit"].numberInt());
+
+    mongo::BSONArray const legacy = FieldBuckets::pipeline(mongo::BSONObj(), "ts", spec, true);
+    mongo::BSONObj const parts = legacy["1"].Obj()["$group"].Obj()["_id"].Obj()["$dateFromParts"].Obj();
+    EXPECT_TRUE(parts.hasField("hour"));
+    EXPECT_FALSE(parts.hasField("minute"));
+}
+
+TEST(field_buckets_tests, read_results)
+{
+    FieldBuckets::Result numbers;
+    FieldBuckets::readResult({ BSON("_id" << BSON("min" << 0 << "max" << 10) << "count" << 4),
+                               BSON("_id" << BSON("min" << 10 << "max" << 12.5) << "count" << 6) }, numbers);
+    ASSERT_EQ(2u, numbers.buckets.size());
+    EXPECT_EQ(10, numbers.documents);
+    EXPECT_DOUBLE_EQ(12.5, numbers.buckets[1].to);
+
+    FieldBuckets::Result months;
+    months.spec.kind = FieldBuckets::Kind::Dates;
+    months.spec.unit = FieldBuckets::DateUnit::Month;
+    long long const february = 1580515200000LL;    // 2020-02-01
+    FieldBuckets::readResult({ dateBucket(february, 3) }, months);
+    ASSERT_EQ(1u, months.buckets.size());
+    EXPECT_DOUBLE_EQ(february + 29 * 86400000.0, months.buckets[0].to);
+    EXPECT_FALSE(months.truncated);
+
+    std::vector<mongo::BSONObj> many;
+    for (int i = 0; i <= FieldBuckets::MaxDateBuckets; ++i)
+        many.push_back(dateBucket(i * 60000LL, 1));
+    FieldBuckets::Result minutes;
+    minutes.spec.kind = FieldBuckets::Kind::Dates;
+    minutes.spec.unit = FieldBuckets::DateUnit::Minute;
+    FieldBuckets::readResult(many, minutes);
+    EXPECT_TRUE(minutes.truncated);
+    EXPECT_EQ(static_cast<size_t>(FieldBuckets::MaxDateBuckets), minutes.buckets.size());
+}
+
+TEST(field_buckets_tests, suitable_unit)
+{
+    long long const day = 86400000LL;
+    EXPECT_EQ(FieldBuckets::DateUnit::Minute, FieldBuckets::suitableUnit(0, 60 * 60000LL));
+    EXPECT_EQ(FieldBuckets::DateUnit::Hour, FieldBuckets::suitableUnit(0, 3 * day));
+    EXPECT_EQ(FieldBuckets::DateUnit::Day, FieldBuckets::suitableUnit(0, 90 * day));
+    EXPECT_EQ(FieldBuckets::DateUnit::Year, FieldBuckets::suitableUnit(0, 100000 * day));
+    EXPECT_EQ(FieldBuckets::DateUnit::Minute, FieldBuckets::suitableUnit(5, 5));
+}
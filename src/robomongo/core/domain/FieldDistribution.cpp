@@ -0,0 +1,62 @@
+#include "robomongo/core/domain/FieldDistribution.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace Robomongo
+{
+    namespace FieldDistribution
+    {
+        mongo::BSONArray pipeline(const mongo::BSONObj &filter, const std::string &field,
+                                  int topCount, int sampleSize)
+        {
+            if (field.empty() || field.front() == '$' || field.front() == '.' || field.back() == '.' ||
+                field.find("..") != std::string::npos)
+                throw std::runtime_error("Values of field \"" + field + "\" cannot be grouped.");
+
+            mongo::BSONArrayBuilder stages;
+            if (!filter.isEmpty())
+                stages.append(BSON("$match" << filter));
+            if (sampleSize > 0)
+                stages.append(BSON("$sample" << BSON("size" << sampleSize)));
+
+            // One $group serves both the top values and totals
+            stages.append(BSON("$group" << BSON("_id" << "$" + field << "count" << BSON("$sum" << 1))));
+            stages.append(BSON("$facet" << BSON(
+                "top" << BSON_ARRAY(
+                    BSON("$sort" << BSON("count" << -1 << "_id" << 1)) <<
+                    BSON("$limit" << topCount)) <<
+                "totals" << BSON_ARRAY(
+                    BSON("$group" << BSON("_id" << mongo::BSONNULL <<
+                                          "distinct" << BSON("$sum" << 1) <<
+                                          "documents" << BSON("$sum" << "$count")))))));
+            return stages.arr();
+        }
+
+        void readResult(const mongo::BSONObj &document, Result &result)
+        {
+            // No totals at all, if nothing matched
+            mongo::BSONObj const totals = document.getObjectField("totals");
+            if (!totals.isEmpty()) {
+                mongo::BSONObj const first = totals.firstElement().Obj();
+                result.documents = first["documents"].safeNumberLong();
+                result.distinct = first["distinct"].safeNumberLong();
+            }
+
+            result.groups.clear();
+            for (mongo::BSONObjIterator it(document.getObjectField("top")); it.more();) {
+                mongo::BSONObj const group = it.next().Obj();
+                long long const count = group["count"].safeNumberLong();
+                double const percent = result.documents > 0 ? 100.0 * count / result.documents : 0;
+
+                mongo::BSONObjBuilder builder;
+                builder.appendAs(group["_id"], "_id");
+                builder.append("count", count);
+                builder.append("percent", std::round(percent * 100) / 100);
+                result.groups.push_back(MongoDocumentPtr(new MongoDocument(builder.obj())));
+            }
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/domain/MongoDocument.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Most frequent values of one field among documents matching query filter, grouped
+     *        on server, so that documents are not read just to see how values are distributed.
+     *        Missing field and null are one group with null _id, as in $group.
+     */
+    namespace FieldDistribution
+    {
+        constexpr int DefaultTopCount = 20;
+
+        // Input of "on sample" grouping, 0 groups all matching documents
+        constexpr int DefaultSampleSize = 10000;
+
+        // Time limit, if tab has none; time limit of tab can only make it shorter
+        constexpr int DefaultMaxTimeMs = 30000;
+
+        struct Result
+        {
+            std::string field;
+            long long documents = 0;    // grouped, at most sample size
+            long long distinct = 0;     // groups, the first 'topCount' are in 'groups'
+            std::vector<MongoDocumentPtr> groups;   // { _id: value, count, percent }, most frequent first
+        };
+
+        /**
+         * @brief [ $match, $sample, $group, $facet ] with the most frequent 'topCount' values and
+         *        totals in one document, see readResult(). $match is left out for empty filter,
+         *        $sample for 'sampleSize' 0.
+         * @throws std::runtime_error, if 'field' is not a field path
+         */
+        mongo::BSONArray pipeline(const mongo::BSONObj &filter, const std::string &field,
+                                  int topCount, int sampleSize);
+
+        // Fills totals and groups of 'result' from the only document of pipeline() result
+        void readResult(const mongo::BSONObj &document, Result &result);
+    }
+}
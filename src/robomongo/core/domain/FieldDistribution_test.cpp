@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+#include "FieldDistribution.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+TEST(field_distribution_tests, pipeline_stages)
+{
+    mongo::BSONArray const all = FieldDistribution::pipeline(mongo::BSONObj(), "status", 20, 0);
+    ASSERT_EQ(2, all.nFields());
+    EXPECT_STREQ("$group", all["0"].Obj().firstElementFieldName());
+    EXPECT_STREQ("$facet", all["1"].Obj().firstElementFieldName());
+    EXPECT_EQ("$status", all["0"].Obj()["$group"].Obj()["_id"].String());
+
+    mongo::BSONArray const sampled = FieldDistribution::pipeline(BSON("a" << 1), "address.city", 5, 1000);
+    ASSERT_EQ(4, sampled.nFields());
+    EXPECT_STREQ("$match", sampled["0"].Obj().firstElementFieldName());
+    EXPECT_STREQ("$sample", sampled["1"].Obj().firstElementFieldName());
+    EXPECT_STREQ("$group", sampled["2"].Obj().firstElementFieldName());
+    EXPECT_STREQ("$facet", sampled["3"].Obj().firstElementFieldName());
+    EXPECT_EQ(1000, sampled["1"].Obj()["$sample"].Obj()["size"].numberInt());
+    EXPECT_EQ("$address.city", sampled["2"].Obj()["$group"].Obj()["_id"].String());
+    mongo::BSONObj const top = sampled["3"].Obj()["$facet"].Obj()["top"].Obj();
+    EXPECT_EQ(5, top["1"].Obj()["$limit"].numberInt());
+}
+
+TEST(field_distribution_tests, pipeline_rejects_non_paths)
+{
+    EXPECT_THROW(FieldDistribution::pipeline(mongo::BSONObj(), "", 20, 0), std::runtime_error);
+    EXPECT_THROW(FieldDistribution::pipeline(mongo::BSONObj(), "$where", 20, 0), std::runtime_error);
+    EXPECT_THROW(FieldDistribution::pipeline(mongo::BSONObj(), "a..b", 20, 0), std::runtime_error);
+}
+
+TEST(field_distribution_tests, read_result)
+{
+    mongo::BSONObj const document = BSON(
+        "top" << BSON_ARRAY(BSON("_id" << "new" << "count" << 3) << BSON("_id" << mongo::BSONNULL << "count" << 1)) <<
+        "totals" << BSON_ARRAY(BSON("_id" << mongo::BSONNULL << "distinct" << 4 << "documents" << 6)));
+
+    FieldDistribution::Result result;
+    FieldDistribution::readResult(document, result);
+    EXPECT_EQ(6, result.documents);
+    EXPECT_EQ(4, result.distinct);
+    ASSERT_EQ(2u, result.groups.size());
+    mongo::BSONObj const first = result.groups[0]->bsonObj();
+    EXPECT_EQ("new", first["_id"].String());
+    EXPECT_EQ(3, first["count"].numberLong());
+    EXPECT_DOUBLE_EQ(50, first["percent"].Double());
+    EXPECT_DOUBLE_EQ(16.67, result.groups[1]->bsonObj()["percent"].Double());
+}
+
+TEST(field_distribution_tests, read_result_of_nothing_matched)
+{
+    FieldDistribution::Result result;
+    FieldDistribution::readResult(BSON("top" << mongo::BSONArray() << "totals" << mongo::BSONArray()), result);
+    EXPECT_EQ(0, result.documents);
+    EXPECT_EQ(0, result.distinct);
+    EXPECT_TRUE(result.groups.empty());
+}
@@ -0,0 +1,36 @@
+#include "robomongo/core/domain/FieldNameInterner.h"
+
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    FieldNameInterner::Id FieldNameInterner::intern(std::string_view name, bool arrayElement)
+    {
+        if (arrayElement) {
+            _scratch.assign(1, '[').append(name.data(), name.size()).append(1, ']');
+            name = _scratch;
+        }
+
+        auto const it = _ids.find(name);
+        if (it != _ids.end())
+            return it->second;
+
+        Id const id = static_cast<Id>(_names.size());
+        _utf8.emplace_back(name);
+        _names.push_back(QtUtils::fromUtf8(name.data(), name.size()));
+        _ids.emplace(_utf8.back(), id);
+        return id;
+    }
+
+    FieldNameInterner::Id FieldNameInterner::find(std::string_view name, bool arrayElement) const
+    {
+        std::string bracketed;
+        if (arrayElement) {
+            bracketed.assign(1, '[').append(name.data(), name.size()).append(1, ']');
+            name = bracketed;
+        }
+
+        auto const it = _ids.find(name);
+        return it == _ids.end() ? NoId : it->second;
+    }
+}
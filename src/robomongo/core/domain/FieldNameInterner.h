@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <QString>
+
+namespace Robomongo
+{
+    /**
+     * @brief Field names of one result set, each stored once and identified by small
+     *        integer. Documents of a result usually repeat the same fields, so tree keys,
+     *        table columns and paths are compared and looked up by Id, and share the
+     *        QString of the name instead of converting it for every element.
+     *
+     *        Keys of array elements are interned as shown, i.e. "[3]". Used in GUI thread.
+     */
+    class FieldNameInterner
+    {
+    public:
+        typedef uint32_t Id;
+        static const Id NoId = UINT32_MAX;
+
+        /**
+         * @brief Id of key of element, added if it is new
+         * @param name Field name, as in BSON (UTF-8)
+         */
+        Id intern(std::string_view name, bool arrayElement = false);
+
+        // NoId, if key was never interned
+        Id find(std::string_view name, bool arrayElement = false) const;
+
+        const QString &name(Id id) const { return _names[id]; }
+        const std::string &utf8(Id id) const { return _utf8[id]; }
+
+        size_t size() const { return _names.size(); }
+
+    private:
+        // Views point into _utf8, which does not move its strings when it grows
+        std::unordered_map<std::string_view, Id> _ids;
+        std::deque<std::string> _utf8;
+        std::vector<QString> _names;
+        std::string _scratch;
+    };
+}
@@ -0,0 +1,35 @@
+#include "gtest/gtest.h"
+#include "FieldNameInterner.h"
+
+using namespace Robomongo;
+
+TEST(field_name_interner_tests, same_name_same_id)
+{
+    FieldNameInterner names;
+    FieldNameInterner::Id const id = names.intern("name");
+    FieldNameInterner::Id const qty = names.intern("qty");
+    std::string const again = "name";
+
+    EXPECT_NE(id, qty);
+    EXPECT_EQ(id, names.intern(again));
+    EXPECT_EQ(qty, names.find("qty"));
+    EXPECT_EQ(FieldNameInterner::NoId, names.find("missing"));
+    EXPECT_EQ(QString("name"), names.name(id));
+    EXPECT_EQ(2u, names.size());
+}
+
+TEST(field_name_interner_tests, array_keys_and_utf8)
+{
+    FieldNameInterner names;
+    FieldNameInterner::Id const element = names.intern("0", true);
+    EXPECT_EQ(QString("[0]"), names.name(element));
+    EXPECT_EQ("[0]", names.utf8(element));
+    EXPECT_EQ(element, names.find("0", true));
+    EXPECT_EQ(FieldNameInterner::NoId, names.find("0"));
+
+    // Views of earlier names stay valid while many are added
+    for (int i = 0; i < 10000; ++i)
+        names.intern("field" + std::to_string(i));
+    EXPECT_EQ(element, names.intern("[0]"));
+    EXPECT_EQ(QString::fromUtf8("\xc3\xa9t\xc3\xa9"), names.name(names.intern("\xc3\xa9t\xc3\xa9")));
+}
@@ -0,0 +1,66 @@
+#include "robomongo/core/domain/FirstPageCache.h"
+
+#include "robomongo/core/domain/MongoDocument.h"
+
+namespace Robomongo
+{
+    constexpr std::chrono::seconds FirstPageCache::Ttl;
+    constexpr long long FirstPageCache::BudgetBytes;
+
+    FirstPageCache &FirstPageCache::instance()
+    {
+        static FirstPageCache cache;
+        return cache;
+    }
+
+    unsigned long long FirstPageCache::focus(const std::string &connection, const std::string &ns)
+    {
+        std::vector<MongoDocumentPtr> dropped;
+        std::lock_guard<std::mutex> lock(_mutex);
+        _connection = connection;
+        _ns = ns;
+        _hasPage = false;
+        _documents.swap(dropped);
+        return ++_generation;
+    }
+
+    bool FirstPageCache::isWanted(unsigned long long generation) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return generation == _generation && !_ns.empty();
+    }
+
+    void FirstPageCache::put(unsigned long long generation, int batchSize,
+                             const std::vector<MongoDocumentPtr> &documents, Clock::time_point now)
+    {
+        if (MongoDocument::bsonSize(documents) > BudgetBytes)
+            return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (generation != _generation || _ns.empty())
+            return;
+
+        _hasPage = true;
+        _batchSize = batchSize;
+        _readAt = now;
+        _documents = documents;
+    }
+
+    bool FirstPageCache::take(const std::string &connection, const std::string &ns, int batchSize,
+                              std::vector<MongoDocumentPtr> &documents, Clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_hasPage || connection != _connection || ns != _ns || batchSize != _batchSize)
+            return false;
+
+        _hasPage = false;
+        if (now - _readAt > Ttl) {
+            _documents.clear();
+            return false;
+        }
+
+        documents.swap(_documents);
+        _documents.clear();
+        return true;
+    }
+}
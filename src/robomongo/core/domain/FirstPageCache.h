@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "robomongo/core/Core.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief First page of the collection focused in explorer, read ahead by metadata worker
+     *        (see PrefetchCollectionRequest) as find({}) would read it when collection is
+     *        opened. Worker of the opened tab takes the page instead of querying it again.
+     *
+     *        One collection is wanted at a time: focusing another one (or none) drops the page
+     *        and cancels prefetch, which is not done yet. Page is taken once, and only within
+     *        Ttl, so that refresh of the tab reads current documents.
+     * @threadsafe
+     */
+    class FirstPageCache
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        static constexpr std::chrono::seconds Ttl { 30 };
+
+        // Larger pages are not kept, nor read ahead if average size of documents tells so
+        static constexpr long long BudgetBytes = 8 * 1024 * 1024;
+
+        static FirstPageCache &instance();
+
+        FirstPageCache() {}
+
+        /**
+         * @brief Collection 'ns' of connection record 'connection' is focused now, empty
+         *        'ns' for none
+         * @return Generation of prefetch of it
+         */
+        unsigned long long focus(const std::string &connection, const std::string &ns);
+
+        // Prefetch of 'generation' is still wanted: its collection was not unfocused since
+        bool isWanted(unsigned long long generation) const;
+
+        /**
+         * @brief Keeps page read by prefetch of 'generation' with 'batchSize', unless focus
+         *        has moved or page is larger than BudgetBytes
+         */
+        void put(unsigned long long generation, int batchSize, const std::vector<MongoDocumentPtr> &documents,
+                 Clock::time_point now = Clock::now());
+
+        /**
+         * @brief Page of collection read with 'batchSize', which is removed from cache
+         * @return false, if there is no such page or it is older than Ttl
+         */
+        bool take(const std::string &connection, const std::string &ns, int batchSize,
+                  std::vector<MongoDocumentPtr> &documents, Clock::time_point now = Clock::now());
+
+    private:
+        mutable std::mutex _mutex;
+        unsigned long long _generation = 0;
+        std::string _connection;
+        std::string _ns;
+
+        // Page of current generation, if it was read
+        bool _hasPage = false;
+        int _batchSize = 0;
+        Clock::time_point _readAt;
+        std::vector<MongoDocumentPtr> _documents;
+    };
+}
@@ -0,0 +1,69 @@
+#include "gtest/gtest.h"
+#include "FirstPageCache.h"
+#include "MongoDocument.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    std::vector<MongoDocumentPtr> page(int count, int padding = 10)
+    {
+        std::vector<mongo::BSONObj> objs;
+        for (int i = 0; i < count; ++i)
+            objs.push_back(BSON("_id" << i << "padding" << std::string(padding, 'x')));
+        return MongoDocument::fromBatch(objs);
+    }
+}
+
+TEST(first_page_cache_tests, page_is_taken_once)
+{
+    FirstPageCache cache;
+    auto const now = FirstPageCache::Clock::now();
+    unsigned long long const generation = cache.focus("uuid", "shop.orders");
+    ASSERT_TRUE(cache.isWanted(generation));
+    cache.put(generation, 50, page(50), now);
+
+    std::vector<MongoDocumentPtr> documents;
+    EXPECT_FALSE(cache.take("uuid", "shop.orders", 20, documents, now));
+    EXPECT_FALSE(cache.take("uuid", "shop.users", 50, documents, now));
+    ASSERT_TRUE(cache.take("uuid", "shop.orders", 50, documents, now));
+    EXPECT_EQ(50u, documents.size());
+    EXPECT_FALSE(cache.take("uuid", "shop.orders", 50, documents, now));
+}
+
+TEST(first_page_cache_tests, focus_change_cancels_prefetch)
+{
+    FirstPageCache cache;
+    auto const now = FirstPageCache::Clock::now();
+    unsigned long long const orders = cache.focus("uuid", "shop.orders");
+    unsigned long long const users = cache.focus("uuid", "shop.users");
+    EXPECT_FALSE(cache.isWanted(orders));
+    EXPECT_TRUE(cache.isWanted(users));
+
+    // Page of collection focused before arrives late
+    cache.put(orders, 50, page(50), now);
+    std::vector<MongoDocumentPtr> documents;
+    EXPECT_FALSE(cache.take("uuid", "shop.orders", 50, documents, now));
+
+    cache.put(users, 50, page(50), now);
+    EXPECT_FALSE(cache.isWanted(cache.focus("uuid", "")));
+    EXPECT_FALSE(cache.take("uuid", "shop.users", 50, documents, now));
+}
+
+TEST(first_page_cache_tests, stale_and_large_pages_are_not_used)
+{
+    FirstPageCache cache;
+    auto const now = FirstPageCache::Clock::now();
+    unsigned long long generation = cache.focus("uuid", "shop.orders");
+    cache.put(generation, 50, page(50), now);
+
+    std::vector<MongoDocumentPtr> documents;
+    EXPECT_FALSE(cache.take("uuid", "shop.orders", 50, documents, now + FirstPageCache::Ttl + std::chrono::seconds(1)));
+
+    generation = cache.focus("uuid", "shop.orders");
+    int const padding = static_cast<int>(FirstPageCache::BudgetBytes / 10);
+    cache.put(generation, 20, page(20, padding), now);
+    EXPECT_FALSE(cache.take("uuid", "shop.orders", 20, documents, now));
+}
@@ -0,0 +1,143 @@
+#include "robomongo/core/domain/GridFs.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/domain/DatabaseSearch.h"
+
+namespace Robomongo
+{
+    namespace GridFs
+    {
+        namespace
+        {
+            const std::string FilesSuffix = ".files";
+            const std::string ChunksSuffix = ".chunks";
+
+            bool endsWith(const std::string &text, const std::string &suffix)
+            {
+                return text.size() > suffix.size() &&
+                       text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+            }
+        }
+
+        bool bucketOf(const std::string &collection, std::string &bucket)
+        {
+            for (std::string const &suffix : { FilesSuffix, ChunksSuffix }) {
+                if (endsWith(collection, suffix)) {
+                    bucket = collection.substr(0, collection.size() - suffix.size());
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::string filesCollection(const std::string &bucket)
+        {
+            return bucket + FilesSuffix;
+        }
+
+        std::string chunksCollection(const std::string &bucket)
+        {
+            return bucket + ChunksSuffix;
+        }
+
+        FileInfo fileFromDocument(const mongo::BSONObj &doc)
+        {
+            FileInfo file;
+            mongo::BSONObjBuilder id;
+            id.appendAs(doc["_id"], "_id");
+            file.id = id.obj();
+            file.filename = doc.getStringField("filename");
+            file.contentType = doc.getStringField("contentType");
+            file.length = doc["length"].safeNumberLong();
+            if (doc["chunkSize"].isNumber() && doc["chunkSize"].numberInt() > 0)
+                file.chunkSize = doc["chunkSize"].numberInt();
+            if (doc["uploadDate"].type() == mongo::Date)
+                file.uploadDateMs = doc["uploadDate"].date().toMillisSinceEpoch();
+            return file;
+        }
+
+        mongo::BSONObj fileDocument(const FileInfo &file)
+        {
+            mongo::BSONObjBuilder doc;
+            doc.appendElements(file.id);
+            doc.append("length", file.length);
+            doc.append("chunkSize", file.chunkSize);
+            doc.append("uploadDate", mongo::Date_t::fromMillisSinceEpoch(file.uploadDateMs));
+            doc.append("filename", file.filename);
+            if (!file.contentType.empty())
+                doc.append("contentType", file.contentType);
+            return doc.obj();
+        }
+
+        mongo::BSONObj filesFilter(const std::string &text)
+        {
+            if (text.empty())
+                return mongo::BSONObj();
+
+            mongo::BSONObjBuilder filter;
+            filter.appendRegex("filename", DatabaseSearch::escapeRegex(text), "i");
+            return filter.obj();
+        }
+
+        long long chunkCount(const FileInfo &file)
+        {
+            return (file.length + file.chunkSize - 1) / file.chunkSize;
+        }
+
+        int chunkLength(const FileInfo &file, long long n)
+        {
+            long long const rest = file.length - n * file.chunkSize;
+            return static_cast<int>(std::max(0LL, std::min<long long>(rest, file.chunkSize)));
+        }
+
+        std::vector<Range> ranges(const FileInfo &file)
+        {
+            long long const chunks = chunkCount(file);
+            long long const perRange = std::max(1LL, RangeBytes / file.chunkSize);
+
+            std::vector<Range> result;
+            for (long long first = 0; first < chunks; first += perRange)
+                result.push_back({ first, std::min(chunks, first + perRange) });
+            return result;
+        }
+
+        mongo::BSONObj rangeFilter(const FileInfo &file, const Range &range)
+        {
+            mongo::BSONObjBuilder filter;
+            filter.appendAs(file.id.firstElement(), "files_id");
+            filter.append("n", BSON("$gte" << range.first << "$lt" << range.end));
+            return filter.obj();
+        }
+
+        mongo::BSONObj chunkDocument(const FileInfo &file, long long n, const char *data, int size)
+        {
+            mongo::BSONObjBuilder doc;
+            doc.append("_id", mongo::OID::gen());
+            doc.appendAs(file.id.firstElement(), "files_id");
+            doc.append("n", static_cast<int>(n));
+            doc.appendBinData("data", size, mongo::BinDataGeneral, data);
+            return doc.obj();
+        }
+
+        const char *chunkData(const FileInfo &file, long long expectedN, const mongo::BSONObj &chunk, int &size)
+        {
+            long long const n = chunk["n"].safeNumberLong();
+            if (n != expectedN)
+                throw std::runtime_error("Chunk " + std::to_string(expectedN) + " of file is missing.");
+
+            mongo::BSONElement const data = chunk["data"];
+            if (data.type() != mongo::BinData)
+                throw std::runtime_error("Chunk " + std::to_string(n) + " of file has no binary data.");
+
+            const char *bytes = data.binData(size);
+            if (size != chunkLength(file, n))
+                throw std::runtime_error("Chunk " + std::to_string(n) + " of file has " + std::to_string(size) +
+                                         " bytes, " + std::to_string(chunkLength(file, n)) + " expected.");
+            return bytes;
+        }
+    }
+}
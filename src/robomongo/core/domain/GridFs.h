@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief GridFS bucket: documents of files in "<bucket>.files", their content split into
+     *        numbered chunks in "<bucket>.chunks". Files are downloaded and uploaded in ranges
+     *        of chunks, several ranges in flight at once on separate connections, and every
+     *        chunk goes straight between file on disk and server. Memory used is bounded by
+     *        ranges in flight times RangeBytes, not by size of file.
+     */
+    namespace GridFs
+    {
+        const int DefaultChunkSize = 255 * 1024;
+
+        // Bytes of chunks read or inserted by one request
+        const long long RangeBytes = 4 * 1024 * 1024;
+
+        struct FileInfo
+        {
+            mongo::BSONObj id;                  // { _id: <any type> }
+            std::string filename;
+            std::string contentType;            // deprecated by spec, shown if present
+            long long length = 0;
+            int chunkSize = DefaultChunkSize;
+            long long uploadDateMs = 0;
+        };
+
+        // Chunk numbers [first, end)
+        struct Range
+        {
+            long long first;
+            long long end;
+        };
+
+        /**
+         * @brief Bucket of "<bucket>.files" or "<bucket>.chunks" collection
+         * @return false, if collection does not belong to bucket
+         */
+        bool bucketOf(const std::string &collection, std::string &bucket);
+
+        std::string filesCollection(const std::string &bucket);
+        std::string chunksCollection(const std::string &bucket);
+
+        FileInfo fileFromDocument(const mongo::BSONObj &doc);
+        mongo::BSONObj fileDocument(const FileInfo &file);
+
+        // Filter of files collection, filename containing 'text' (case insensitive)
+        mongo::BSONObj filesFilter(const std::string &text);
+
+        long long chunkCount(const FileInfo &file);
+
+        // Bytes of chunk 'n', the last one may be shorter
+        int chunkLength(const FileInfo &file, long long n);
+
+        // Ranges of at most RangeBytes (at least one chunk each) covering all chunks of file
+        std::vector<Range> ranges(const FileInfo &file);
+
+        // { files_id: <id>, n: { $gte: first, $lt: end } }
+        mongo::BSONObj rangeFilter(const FileInfo &file, const Range &range);
+
+        mongo::BSONObj chunkDocument(const FileInfo &file, long long n, const char *data, int size);
+
+        /**
+         * @brief Checks that chunk read in order of 'n' is the expected one and has expected length
+         * @return Data of chunk
+         * @throws std::runtime_error, if chunk is missing, out of order or has wrong length
+         */
+        const char *chunkData(const FileInfo &file, long long expectedN, const mongo::BSONObj &chunk, int &size);
+    }
+}
@@ -0,0 +1,84 @@
+#include "gtest/gtest.h"
+#include "GridFs.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    GridFs::FileInfo file(long long length, int chunkSize)
+    {
+        GridFs::FileInfo info;
+        info.id = BSON("_id" << 7);
+        info.length = length;
+        info.chunkSize = chunkSize;
+        return info;
+    }
+}
+
+TEST(gridfs_tests, bucket_of_collection)
+{
+    std::string bucket;
+    EXPECT_TRUE(GridFs::bucketOf("fs.files", bucket));
+    EXPECT_EQ("fs", bucket);
+    EXPECT_TRUE(GridFs::bucketOf("images.chunks", bucket));
+    EXPECT_EQ("images", bucket);
+    EXPECT_FALSE(GridFs::bucketOf("files", bucket));
+    EXPECT_FALSE(GridFs::bucketOf("orders", bucket));
+    EXPECT_EQ("images.files", GridFs::filesCollection("images"));
+}
+
+TEST(gridfs_tests, file_document_round_trip)
+{
+    GridFs::FileInfo info = file(1000, 256);
+    info.filename = "a.bin";
+    info.uploadDateMs = 1500;
+
+    GridFs::FileInfo const parsed = GridFs::fileFromDocument(GridFs::fileDocument(info));
+    EXPECT_EQ(7, parsed.id["_id"].numberInt());
+    EXPECT_EQ("a.bin", parsed.filename);
+    EXPECT_EQ(1000, parsed.length);
+    EXPECT_EQ(256, parsed.chunkSize);
+    EXPECT_EQ(1500, parsed.uploadDateMs);
+    EXPECT_TRUE(parsed.contentType.empty());
+}
+
+TEST(gridfs_tests, chunks_and_ranges)
+{
+    GridFs::FileInfo const info = file(1000, 256);
+    EXPECT_EQ(4, GridFs::chunkCount(info));
+    EXPECT_EQ(256, GridFs::chunkLength(info, 0));
+    EXPECT_EQ(232, GridFs::chunkLength(info, 3));
+    EXPECT_EQ(0, GridFs::chunkCount(file(0, 256)));
+
+    std::vector<GridFs::Range> const small = GridFs::ranges(info);
+    ASSERT_EQ(1u, small.size());
+    EXPECT_EQ(4, small[0].end);
+
+    // Chunks larger than RangeBytes go one per range
+    std::vector<GridFs::Range> const large = GridFs::ranges(file(3 * GridFs::RangeBytes, static_cast<int>(GridFs::RangeBytes * 2)));
+    ASSERT_EQ(2u, large.size());
+    EXPECT_EQ(1, large[1].first);
+    EXPECT_EQ(2, large[1].end);
+
+    long long const perRange = GridFs::RangeBytes / GridFs::DefaultChunkSize;
+    std::vector<GridFs::Range> const many = GridFs::ranges(file(GridFs::DefaultChunkSize * (perRange + 1LL),
+                                                                GridFs::DefaultChunkSize));
+    ASSERT_EQ(2u, many.size());
+    EXPECT_EQ(perRange, many[0].end);
+    EXPECT_EQ(perRange + 1, many[1].end);
+}
+
+TEST(gridfs_tests, chunk_is_validated)
+{
+    GridFs::FileInfo const info = file(5, 4);
+    int size = 0;
+    mongo::BSONObj const chunk = GridFs::chunkDocument(info, 1, "x", 1);
+    EXPECT_EQ(7, chunk["files_id"].numberInt());
+    EXPECT_EQ('x', *GridFs::chunkData(info, 1, chunk, size));
+    EXPECT_EQ(1, size);
+
+    EXPECT_THROW(GridFs::chunkData(info, 0, chunk, size), std::runtime_error);
+    EXPECT_THROW(GridFs::chunkData(info, 0, GridFs::chunkDocument(info, 0, "abc", 3), size), std::runtime_error);
+}
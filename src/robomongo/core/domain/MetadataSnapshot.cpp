@@ -0,0 +1,240 @@
+#include "robomongo/core/domain/MetadataSnapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/settings/SettingsManager.h"
+
+namespace
+{
+    QString const SnapshotDirName = "metadata";
+    int const FormatVersion = 1;
+
+    /*
+     * { v: 1, databases: [ { name: "db", collections: [ "c1", ... ],
+     *                        indexes: [ { collection: "c1", list: [ <index>, ... ] }, ... ] }, ... ] }
+     */
+
+    mongo::BSONObj indexToBSON(const Robomongo::IndexInfo &index)
+    {
+        mongo::BSONObjBuilder builder;
+        builder.append("name", index._name);
+        builder.append("keys", index._keys);
+        builder.append("unique", index._unique);
+        builder.append("background", index._backGround);
+        builder.append("sparse", index._sparse);
+        builder.append("ttl", index._ttl);
+        builder.append("defaultLanguage", index._defaultLanguage);
+        builder.append("languageOverride", index._languageOverride);
+        builder.append("textWeights", index._textWeights);
+        return builder.obj();
+    }
+
+    Robomongo::IndexInfo indexFromBSON(const Robomongo::MongoNamespace &ns, const mongo::BSONObj &obj)
+    {
+        return Robomongo::IndexInfo(Robomongo::MongoCollectionInfo(ns.toString()),
+                                    obj.getStringField("name"), obj.getStringField("keys"),
+                                    obj.getBoolField("unique"), obj.getBoolField("background"),
+                                    obj.getBoolField("sparse"), obj.getIntField("ttl"),
+                                    obj.getStringField("defaultLanguage"),
+                                    obj.getStringField("languageOverride"), obj.getStringField("textWeights"));
+    }
+
+    bool sameIndexes(const std::vector<Robomongo::IndexInfo> &a, const std::vector<Robomongo::IndexInfo> &b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+            [](const Robomongo::IndexInfo &x, const Robomongo::IndexInfo &y) {
+                return indexToBSON(x).binaryEqual(indexToBSON(y));
+            });
+    }
+
+    QString snapshotFilePath(const QString &connection)
+    {
+        return Robomongo::CacheDir + SnapshotDirName + "/" + connection + ".bin";
+    }
+}
+
+namespace Robomongo
+{
+    MetadataSnapshot &MetadataSnapshot::instance()
+    {
+        static MetadataSnapshot snapshot;
+        return snapshot;
+    }
+
+    const std::vector<std::string> *MetadataSnapshot::collections(const QString &connection,
+                                                                  const std::string &database)
+    {
+        Databases const &dbs = databases(connection);
+        auto const it = dbs.find(database);
+        return it == dbs.end() ? nullptr : &it->second.collections;
+    }
+
+    void MetadataSnapshot::setCollections(const QString &connection, const std::string &database,
+                                          const std::vector<std::string> &names)
+    {
+        Databases &dbs = databases(connection);
+        auto const it = dbs.find(database);
+        if (it != dbs.end() && it->second.collections == names)
+            return;
+
+        Database &db = dbs[database];
+        db.collections = names;
+        for (auto index = db.indexes.begin(); index != db.indexes.end(); ) {
+            if (std::find(names.begin(), names.end(), index->first) == names.end())
+                index = db.indexes.erase(index);
+            else
+                ++index;
+        }
+        save(connection);
+    }
+
+    const std::vector<IndexInfo> *MetadataSnapshot::indexes(const QString &connection, const MongoNamespace &ns)
+    {
+        Databases const &dbs = databases(connection);
+        auto const db = dbs.find(ns.databaseName());
+        if (db == dbs.end())
+            return nullptr;
+
+        auto const it = db->second.indexes.find(ns.collectionName());
+        return it == db->second.indexes.end() ? nullptr : &it->second;
+    }
+
+    void MetadataSnapshot::setIndexes(const QString &connection, const MongoNamespace &ns,
+                                      const std::vector<IndexInfo> &indexes)
+    {
+        Databases &dbs = databases(connection);
+        std::vector<IndexInfo> *known = nullptr;
+        auto const db = dbs.find(ns.databaseName());
+        if (db != dbs.end()) {
+            auto const it = db->second.indexes.find(ns.collectionName());
+            if (it != db->second.indexes.end())
+                known = &it->second;
+        }
+        if (known && sameIndexes(*known, indexes))
+            return;
+
+        dbs[ns.databaseName()].indexes[ns.collectionName()] = indexes;
+        save(connection);
+    }
+
+    void MetadataSnapshot::retainDatabases(const QString &connection, const std::vector<std::string> &names)
+    {
+        Databases &dbs = databases(connection);
+        bool changed = false;
+        for (auto it = dbs.begin(); it != dbs.end(); ) {
+            if (std::find(names.begin(), names.end(), it->first) == names.end()) {
+                it = dbs.erase(it);
+                changed = true;
+            }
+            else
+                ++it;
+        }
+
+        if (changed)
+            save(connection);
+    }
+
+    QByteArray MetadataSnapshot::serialize(const Databases &databases)
+    {
+        mongo::BSONArrayBuilder dbsBuilder;
+        for (auto const &db : databases) {
+            mongo::BSONArrayBuilder collections;
+            for (auto const &name : db.second.collections)
+                collections.append(name);
+
+            mongo::BSONArrayBuilder indexes;
+            for (auto const &collection : db.second.indexes) {
+                mongo::BSONArrayBuilder list;
+                for (auto const &index : collection.second)
+                    list.append(indexToBSON(index));
+                indexes.append(BSON("collection" << collection.first << "list" << list.arr()));
+            }
+
+            dbsBuilder.append(BSON("name" << db.first << "collections" << collections.arr()
+                                          << "indexes" << indexes.arr()));
+        }
+
+        mongo::BSONObj const obj = BSON("v" << FormatVersion << "databases" << dbsBuilder.arr());
+        return qCompress(QByteArray(obj.objdata(), obj.objsize()));
+    }
+
+    bool MetadataSnapshot::deserialize(const QByteArray &data, Databases &databases)
+    {
+        QByteArray const raw = qUncompress(data);
+        if (raw.size() < 5)
+            return false;
+
+        int size = 0;
+        memcpy(&size, raw.constData(), sizeof(size));   // BSON is little endian, as are supported CPUs
+        if (size != raw.size())
+            return false;
+
+        try {
+            mongo::BSONObj const obj(raw.constData());
+            if (obj.getIntField("v") != FormatVersion)
+                return false;
+
+            Databases result;
+            for (auto const &dbElem : obj.getObjectField("databases")) {
+                mongo::BSONObj const dbObj = dbElem.Obj();
+                std::string const dbName = dbObj.getStringField("name");
+                Database &db = result[dbName];
+
+                for (auto const &name : dbObj.getObjectField("collections"))
+                    db.collections.push_back(name.String());
+
+                for (auto const &indexesElem : dbObj.getObjectField("indexes")) {
+                    mongo::BSONObj const indexesObj = indexesElem.Obj();
+                    std::string const collection = indexesObj.getStringField("collection");
+                    MongoNamespace const ns(dbName, collection);
+                    std::vector<IndexInfo> &list = db.indexes[collection];
+                    for (auto const &index : indexesObj.getObjectField("list"))
+                        list.push_back(indexFromBSON(ns, index.Obj()));
+                }
+            }
+            databases.swap(result);
+            return true;
+        }
+        catch (const std::exception &) {
+            return false;
+        }
+    }
+
+    MetadataSnapshot::Databases &MetadataSnapshot::databases(const QString &connection)
+    {
+        auto const it = _connections.find(connection);
+        if (it != _connections.end())
+            return it->second;
+
+        Databases &dbs = _connections[connection];
+        QFile file(snapshotFilePath(connection));
+        if (!connection.isEmpty() && file.open(QIODevice::ReadOnly))
+            deserialize(file.readAll(), dbs);
+        return dbs;
+    }
+
+    void MetadataSnapshot::save(const QString &connection) const
+    {
+        auto const it = _connections.find(connection);
+        if (connection.isEmpty() || it == _connections.end())
+            return;
+
+        QString const dir = CacheDir + SnapshotDirName;
+        if (!QDir(dir).exists())
+            QDir().mkpath(dir);
+
+        // Half written snapshot would be worse than the previous one
+        QSaveFile file(snapshotFilePath(connection));
+        if (!file.open(QIODevice::WriteOnly))
+            return;
+
+        file.write(serialize(it->second));
+        file.commit();
+    }
+}
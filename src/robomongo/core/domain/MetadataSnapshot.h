@@ -0,0 +1,73 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <QByteArray>
+#include <QString>
+
+#include "robomongo/core/events/MongoEventsInfo.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Last known collections and indexes of every connection, by connection uuid.
+     *        Explorer shows them at once on the first expand of a session and replaces them
+     *        when the server answers. One compressed file per connection is kept in cache
+     *        directory between sessions. Used in GUI thread only.
+     */
+    class MetadataSnapshot
+    {
+    public:
+        struct Database
+        {
+            std::vector<std::string> collections;
+            std::map<std::string, std::vector<IndexInfo>> indexes;  // by collection name
+        };
+
+        typedef std::map<std::string, Database> Databases;          // by database name
+
+        static MetadataSnapshot &instance();
+
+        /**
+         * @return nullptr, if collections of this database were never loaded
+         */
+        const std::vector<std::string> *collections(const QString &connection, const std::string &database);
+
+        /**
+         * @brief Stores collections and saves file, if they differ from the snapshot.
+         *        Indexes of collections which are gone are dropped.
+         */
+        void setCollections(const QString &connection, const std::string &database,
+                            const std::vector<std::string> &names);
+
+        /**
+         * @return nullptr, if indexes of this collection were never loaded
+         */
+        const std::vector<IndexInfo> *indexes(const QString &connection, const MongoNamespace &ns);
+
+        void setIndexes(const QString &connection, const MongoNamespace &ns, const std::vector<IndexInfo> &indexes);
+
+        /**
+         * @brief Drops databases which are not in the list any more
+         */
+        void retainDatabases(const QString &connection, const std::vector<std::string> &names);
+
+        // qCompress()ed BSON, see .cpp for layout
+        static QByteArray serialize(const Databases &databases);
+
+        /**
+         * @return false, if data is not a snapshot of this format
+         */
+        static bool deserialize(const QByteArray &data, Databases &databases);
+
+    private:
+        MetadataSnapshot() {}
+
+        // Reads file of connection on first use
+        Databases &databases(const QString &connection);
+        void save(const QString &connection) const;
+
+        std::map<QString, Databases> _connections;
+    };
+}
@@ -0,0 +1,42 @@
+#include "gtest/gtest.h"
+#include "MetadataSnapshot.h"
+
+using namespace Robomongo;
+
+TEST(metadata_snapshot_tests, serialize_round_trip)
+{
+    MetadataSnapshot::Databases databases;
+    MetadataSnapshot::Database &db = databases["shop"];
+    db.collections = { "orders", "items.archive", "system.views" };
+    MongoCollectionInfo const orders("shop.orders");
+    db.indexes["orders"] = {
+        IndexInfo(orders, "_id_", "{ \"_id\" : 1 }"),
+        IndexInfo(orders, "ttl_1", "{ \"createdAt\" : 1 }", false, true, true, 3600)
+    };
+    databases["empty"];
+
+    MetadataSnapshot::Databases loaded;
+    ASSERT_TRUE(MetadataSnapshot::deserialize(MetadataSnapshot::serialize(databases), loaded));
+    ASSERT_EQ(2u, loaded.size());
+    EXPECT_TRUE(loaded["empty"].collections.empty());
+    EXPECT_EQ(db.collections, loaded["shop"].collections);
+
+    auto const &indexes = loaded["shop"].indexes["orders"];
+    ASSERT_EQ(2u, indexes.size());
+    EXPECT_EQ("_id_", indexes[0]._name);
+    EXPECT_EQ("shop.orders", indexes[0]._collection.fullName());
+    EXPECT_EQ("{ \"createdAt\" : 1 }", indexes[1]._keys);
+    EXPECT_TRUE(indexes[1]._backGround);
+    EXPECT_TRUE(indexes[1]._sparse);
+    EXPECT_EQ(3600, indexes[1]._ttl);
+}
+
+TEST(metadata_snapshot_tests, deserialize_rejects_garbage)
+{
+    MetadataSnapshot::Databases databases;
+    databases["kept"];
+
+    EXPECT_FALSE(MetadataSnapshot::deserialize(QByteArray(), databases));
+    EXPECT_FALSE(MetadataSnapshot::deserialize(qCompress(QByteArray("not bson")), databases));
+    EXPECT_EQ(1u, databases.count("kept"));
+}
@@ -7,9 +7,10 @@ namespace Robomongo
         AggrInfo() {}
 
         AggrInfo(const std::string& collectionName, int skip, int batchSize, 
-                 mongo::BSONObj const& pipeline, mongo::BSONObj const& options, int resultIndex) :
+                 mongo::BSONObj const& pipeline, mongo::BSONObj const& options, int resultIndex,
+                 const std::string& dbName = std::string()) :
             collectionName(collectionName), skip(skip), batchSize(batchSize), pipeline(pipeline), 
-            options(options), isValid(true), resultIndex(resultIndex)
+            options(options), isValid(true), resultIndex(resultIndex), dbName(dbName)
         {}
 
         std::string collectionName = "";
@@ -19,5 +20,7 @@ namespace Robomongo
         mongo::BSONObj options;
         bool isValid = false;
         int resultIndex = -1;
+        std::string dbName;     // pages are read with aggregation cursor of this database
+        int maxTimeMs = 0;      // server time limit of tab, 0 if none, added to options by MongoWorker
     };
 }
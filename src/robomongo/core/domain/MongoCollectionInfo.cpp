@@ -6,15 +6,16 @@ namespace Robomongo
 {
     MongoCollectionInfo::MongoCollectionInfo(const std::string &ns) : _ns(ns) {}
 
-/*    MongoCollectionInfo::MongoCollectionInfo(mongo::BSONObj stats) : _ns(stats.getStringField("ns"))
+    MongoCollectionInfo::MongoCollectionInfo(const std::string &ns, const mongo::BSONObj &stats) : 
+        _ns(ns), _hasStats(true)
     {
         // if "size" and "storageSize" are of type Int32 or Int64, they
         // will be converted to double by "numberDouble()" function.
-        _sizeBytes = BsonUtils::getField<mongo::NumberDouble>(stats,"size");
-        _storageSizeBytes = BsonUtils::getField<mongo::NumberDouble>(stats,"storageSize");
+        _sizeBytes = BsonUtils::getField<mongo::NumberDouble>(stats, "size");
+        _storageSizeBytes = BsonUtils::getField<mongo::NumberDouble>(stats, "storageSize");
+        _totalIndexSizeBytes = BsonUtils::getField<mongo::NumberDouble>(stats, "totalIndexSize");
 
         // NumberLong because of mongodb can have very big collections
-        _count = BsonUtils::getField<mongo::NumberLong>(stats,"count");
-    }*/
+        _count = BsonUtils::getField<mongo::NumberLong>(stats, "count");
+    }
 }
-
@@ -9,7 +9,12 @@ namespace Robomongo
     public:
         MongoCollectionInfo() {}
         MongoCollectionInfo(const std::string &ns);
-//        MongoCollectionInfo(mongo::BSONObj stats);
+
+        /**
+         * @brief Collection info with statistics
+         * @param stats Result of { collStats: <collection> } command
+         */
+        MongoCollectionInfo(const std::string &ns, const mongo::BSONObj &stats);
 
         std::string name() const { return _ns.collectionName(); }
         std::string fullName() const { return _ns.toString(); }
@@ -20,16 +25,23 @@ namespace Robomongo
          * It is double, because db.stats()'s "size" field may be double
          * for large values, while Int32 for small.
          */
-//        double sizeBytes() const { return _sizeBytes; }
+        double sizeBytes() const { return _sizeBytes; }
 
         /**
          * @brief Storage size in bytes
          * It is double, because db.stats()'s "storageSize" field may be double
          * for large values, while Int32 for small.
          */
-//        double storageSizeBytes() const { return _storageSizeBytes; }
+        double storageSizeBytes() const { return _storageSizeBytes; }
 
-//        long long count() const { return _count; }
+        double totalIndexSizeBytes() const { return _totalIndexSizeBytes; }
+
+        long long count() const { return _count; }
+
+        /**
+         * @brief False, if this info was built from collection name only (i.e. by listCollections)
+         */
+        bool hasStats() const { return _hasStats; }
 
     private:
         MongoNamespace _ns;
@@ -39,16 +51,20 @@ namespace Robomongo
          * It is double, because db.stats()'s "size" field may be double
          * for large values, while Int32 for small.
          */
-        double _sizeBytes;
+        double _sizeBytes = 0;
 
         /**
          * @brief Storage size in bytes
          * It is double, because db.stats()'s "storageSize" field may be double
          * for large values, while Int32 for small.
          */
-        double _storageSizeBytes;
+        double _storageSizeBytes = 0;
+
+        double _totalIndexSizeBytes = 0;
+
+        long long _count = 0;
 
-        long long _count;
+        bool _hasStats = false;
     };
 }
 
@@ -2,15 +2,20 @@
 
 #include "robomongo/core/domain/MongoServer.h"
 #include "robomongo/core/domain/MongoCollection.h"
+#include "robomongo/core/domain/MetadataSnapshot.h"
 #include "robomongo/core/mongodb/MongoWorker.h"
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/EventBus.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/utils/Logger.h"
+#include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/utils/common.h"
 
 namespace Robomongo
 {
     R_REGISTER_EVENT(MongoDatabaseCollectionListLoadedEvent)
+    R_REGISTER_EVENT(MongoDatabaseCollectionStatsLoadedEvent)
+    R_REGISTER_EVENT(MongoDatabaseIndexUsageLoadedEvent)
     R_REGISTER_EVENT(MongoDatabaseUsersLoadedEvent)
     R_REGISTER_EVENT(MongoDatabaseFunctionsLoadedEvent)
     R_REGISTER_EVENT(MongoDatabaseUsersLoadingEvent)
@@ -37,15 +42,105 @@ namespace Robomongo
     }
 
     void MongoDatabase::loadCollections()
+    {
+        startCollectionsLoad();
+        _bus->send(_server->metadataWorker(), new LoadCollectionNamesRequest(this, _name, _collectionNameFilter));
+    }
+
+    void MongoDatabase::startCollectionsLoad()
     {
         _bus->publish(new MongoDatabaseCollectionsLoadingEvent(this));
-        _bus->send(_server->worker(), new LoadCollectionNamesRequest(this, _name));
+
+        if (!_reconciling) {
+            // First load of the session shows collections of the last one at once
+            if (_collections.empty() && _collectionNameFilter.empty()) {
+                auto const names = MetadataSnapshot::instance().collections(_server->connectionRecord()->uuid(), _name);
+                if (names) {
+                    for (auto const& name : *names)
+                        addCollection(new MongoCollection(this, MongoCollectionInfo(MongoNamespace(_name, name).toString())));
+
+                    // Not the last batch: explorer shows "...", until the server answers
+                    _bus->publish(new MongoDatabaseCollectionListLoadedEvent(this, _collections, 0, false));
+                }
+            }
+
+            // Shown collections are only added or removed, so that their expanded items stay
+            _reconciling = !_collections.empty();
+            _reconciledCollections.clear();
+        }
+    }
+
+    void MongoDatabase::loadCollectionStats(const std::vector<std::string> &collectionNames)
+    {
+        auto const now = std::chrono::steady_clock::now();
+        for (auto const& name : collectionNames) {
+            auto const cached = _collectionStats.find(name);
+            if (cached != _collectionStats.end() && now - cached->second.loadedAt < CollectionStatsTtl)
+                continue;
+
+            if (_queuedStats.insert(name).second)
+                _pendingStats.push_back(name);
+        }
+
+        sendNextCollectionStatsRequest();
+    }
+
+    void MongoDatabase::cancelCollectionStats()
+    {
+        for (auto const& name : _pendingStats)
+            _queuedStats.erase(name);
+        _pendingStats.clear();
+
+        if (_statsCancelled)
+            *_statsCancelled = true;
+    }
+
+    const MongoCollectionInfo *MongoDatabase::collectionStats(const std::string &collectionName) const
+    {
+        auto const cached = _collectionStats.find(collectionName);
+        return cached == _collectionStats.end() ? nullptr : &cached->second.info;
+    }
+
+    void MongoDatabase::loadIndexUsage(const std::string &collectionName, bool force)
+    {
+        auto const cached = _indexUsage.find(collectionName);
+        if (!force && cached != _indexUsage.end() && 
+            std::chrono::steady_clock::now() - cached->second.loadedAt < IndexUsageTtl) {
+            _bus->publish(new MongoDatabaseIndexUsageLoadedEvent(this, collectionName));
+            return;
+        }
+
+        if (_inFlightIndexUsage.insert(collectionName).second)
+            _bus->send(_server->metadataWorker(), 
+                       new LoadIndexUsageRequest(this, MongoNamespace(_name, collectionName)));
+    }
+
+    const std::vector<IndexUsageInfo> *MongoDatabase::indexUsage(const std::string &collectionName) const
+    {
+        auto const cached = _indexUsage.find(collectionName);
+        return cached == _indexUsage.end() ? nullptr : &cached->second.usage;
+    }
+
+    void MongoDatabase::sendNextCollectionStatsRequest()
+    {
+        // One request in flight at a time, so stats never delay other explorer requests much
+        if (!_inFlightStats.empty() || _pendingStats.empty())
+            return;
+
+        while (!_pendingStats.empty() && _inFlightStats.size() < CollectionStatsChunkSize) {
+            _inFlightStats.push_back(_pendingStats.front());
+            _pendingStats.pop_front();
+        }
+
+        _statsCancelled = std::make_shared<std::atomic<bool>>(false);
+        _bus->send(_server->metadataWorker(), 
+                   new LoadCollectionStatsRequest(this, _name, _inFlightStats, _statsCancelled));
     }
 
     void MongoDatabase::loadUsers()
     {
         _bus->publish(new MongoDatabaseUsersLoadingEvent(this));
-        _bus->send(_server->worker(), new LoadUsersRequest(this, _name));
+        _bus->send(_server->metadataWorker(), new LoadUsersRequest(this, _name));
     }
 
     void MongoDatabase::loadFunctions()
@@ -54,6 +149,14 @@ namespace Robomongo
         _bus->send(_server->worker(), new LoadFunctionsRequest(this, _name));
     }
 
+    void MongoDatabase::loadMetadata()
+    {
+        startCollectionsLoad();
+        _bus->publish(new MongoDatabaseUsersLoadingEvent(this));
+        _bus->publish(new MongoDatabaseFunctionsLoadingEvent(this));
+        _bus->send(_server->metadataWorker(), new LoadDatabaseMetadataRequest(this, _name, _collectionNameFilter));
+    }
+
     void MongoDatabase::createCollection(const std::string &collection, long long size, bool capped, int maxDocNum, const mongo::BSONObj& extraOptions)
     {
         _bus->send(_server->worker(), 
@@ -109,20 +212,191 @@ namespace Robomongo
     void MongoDatabase::handle(LoadCollectionNamesResponse *event)
     {
         if (event->isError()) {
+            _reconciling = false;
+            _reconciledCollections.clear();
             _bus->publish(new MongoDatabaseCollectionListLoadedEvent(this, event->error()));            
             genericEventErrorHandler(event, "Failed to refresh 'Collections'.", _bus, this);
             return;
         }
 
-        clearCollections();
+        if (_reconciling) {
+            if (event->batchIndex() == 0)
+                _reconciledCollections.clear();
+
+            auto const& infos = event->collectionInfos();
+            _reconciledCollections.insert(_reconciledCollections.end(), infos.begin(), infos.end());
+            if (event->isLastBatch())
+                reconcileCollections();
+            return;
+        }
 
-        for (auto const& collectionInfo : event->collectionInfos())
-            addCollection(new MongoCollection(this, collectionInfo));
+        if (event->batchIndex() == 0)
+            clearCollections();
 
-        _bus->publish(new MongoDatabaseCollectionListLoadedEvent(this, _collections));
+        std::vector<MongoCollection *> batch;
+        for (auto const& collectionInfo : event->collectionInfos()) {
+            batch.push_back(new MongoCollection(this, collectionInfo));
+            addCollection(batch.back());
+        }
+
+        _bus->publish(new MongoDatabaseCollectionListLoadedEvent(this, batch, event->batchIndex(), 
+                                                                 event->isLastBatch()));
+        if (event->isLastBatch()) {
+            _collectionsLoaded = true;
+            saveSnapshot();
+            LOG_MSG("'Collections' refreshed.", mongo::logger::LogSeverity::Info());
+        }
+    }
+
+    void MongoDatabase::reconcileCollections()
+    {
+        _reconciling = false;
+        _collectionsLoaded = true;
+        std::vector<MongoCollectionInfo> fresh;
+        fresh.swap(_reconciledCollections);
+
+        std::unordered_set<std::string> freshNames;
+        for (auto const& info : fresh)
+            freshNames.insert(info.name());
+
+        std::unordered_set<std::string> knownNames, removedNames;
+        for (MongoCollection const *collection : _collections) {
+            knownNames.insert(collection->name());
+            if (!freshNames.count(collection->name()))
+                removedNames.insert(collection->name());
+        }
+
+        std::vector<MongoCollectionInfo> added;
+        for (auto const& info : fresh) {
+            if (!knownNames.count(info.name()))
+                added.push_back(info);
+        }
+
+        applyCollectionChanges(added, removedNames);
         LOG_MSG("'Collections' refreshed.", mongo::logger::LogSeverity::Info());
     }
 
+    void MongoDatabase::applyCollectionChanges(const std::vector<MongoCollectionInfo> &added,
+                                               const std::unordered_set<std::string> &removedNames)
+    {
+        std::vector<MongoCollection *> kept, removed;
+        std::vector<std::string> removedList;
+        for (MongoCollection *collection : _collections) {
+            if (!removedNames.count(collection->name())) {
+                kept.push_back(collection);
+                continue;
+            }
+
+            removed.push_back(collection);
+            removedList.push_back(collection->name());
+            _collectionStats.erase(collection->name());
+            _indexUsage.erase(collection->name());
+        }
+        _collections.swap(kept);
+
+        std::vector<MongoCollection *> addedCollections;
+        for (auto const& info : added) {
+            addedCollections.push_back(new MongoCollection(this, info));
+            addCollection(addedCollections.back());
+        }
+
+        // Removed collections are deleted only after their explorer items
+        _bus->publish(new MongoDatabaseCollectionListLoadedEvent(this, addedCollections, 1, true, removedList));
+        qDeleteAll(removed);
+
+        saveSnapshot();
+    }
+
+    void MongoDatabase::collectionCreated(const std::string &collection)
+    {
+        // Load in flight (or the first one) returns it anyway
+        if (!_collectionsLoaded || _reconciling)
+            return;
+
+        if (!_collectionNameFilter.empty() &&
+            !QtUtils::toQString(collection).contains(QtUtils::toQString(_collectionNameFilter), Qt::CaseInsensitive))
+            return;
+
+        for (MongoCollection const *known : _collections) {
+            if (known->name() == collection)
+                return;
+        }
+
+        applyCollectionChanges({ MongoCollectionInfo(MongoNamespace(_name, collection).toString()) }, {});
+    }
+
+    void MongoDatabase::collectionDropped(const std::string &collection)
+    {
+        if (!_collectionsLoaded || _reconciling)
+            return;
+
+        for (MongoCollection const *known : _collections) {
+            if (known->name() == collection) {
+                applyCollectionChanges({}, { collection });
+                return;
+            }
+        }
+    }
+
+    void MongoDatabase::saveSnapshot() const
+    {
+        // Filtered lists are not the whole database
+        if (!_collectionNameFilter.empty())
+            return;
+
+        std::vector<std::string> names;
+        for (MongoCollection const *collection : _collections)
+            names.push_back(collection->name());
+        MetadataSnapshot::instance().setCollections(_server->connectionRecord()->uuid(), _name, names);
+    }
+
+    void MongoDatabase::handle(LoadCollectionStatsResponse *event)
+    {
+        for (auto const& name : _inFlightStats)
+            _queuedStats.erase(name);
+        _inFlightStats.clear();
+        _statsCancelled.reset();
+
+        if (event->isError()) {
+            // Do not hammer the server, stats are requested again on next scroll/expand
+            cancelCollectionStats();
+            LOG_MSG("Failed to load collection statistics: " + event->error().errorMessage(), 
+                    mongo::logger::LogSeverity::Warning());
+            return;
+        }
+
+        std::vector<std::string> names;
+        auto const now = std::chrono::steady_clock::now();
+        for (auto const& info : event->collectionInfos()) {
+            if (!info.hasStats())
+                continue;
+
+            _collectionStats[info.name()] = CachedCollectionStats{ info, now };
+            names.push_back(info.name());
+        }
+
+        if (!names.empty())
+            _bus->publish(new MongoDatabaseCollectionStatsLoadedEvent(this, names));
+
+        sendNextCollectionStatsRequest();
+    }
+
+    void MongoDatabase::handle(LoadIndexUsageResponse *event)
+    {
+        std::string const &collectionName = event->ns().collectionName();
+        _inFlightIndexUsage.erase(collectionName);
+
+        if (event->isError()) {
+            // Indexes are shown without usage, it is requested again on next expand
+            LOG_MSG("Failed to load index usage of '" + event->ns().toString() + "': " + 
+                    event->error().errorMessage(), mongo::logger::LogSeverity::Warning());
+            return;
+        }
+
+        _indexUsage[collectionName] = CachedIndexUsage{ event->usage(), std::chrono::steady_clock::now() };
+        _bus->publish(new MongoDatabaseIndexUsageLoadedEvent(this, collectionName));
+    }
+
     void MongoDatabase::handle(CreateFunctionResponse *event)
     {
         if (event->isError()) {
@@ -155,7 +429,12 @@ namespace Robomongo
             if (_server->connectionRecord()->isReplicaSet()) // replica set
                 handleIfReplicaSetUnreachable(event);           
 
-            genericEventErrorHandler(event, "Failed to refresh 'Users'.", _bus, this);
+            // Not shown, if it was loaded with other metadata of database (see loadMetadata())
+            if (event->error().showErrorWindow())
+                genericEventErrorHandler(event, "Failed to refresh 'Users'.", _bus, this);
+            else
+                LOG_MSG("Failed to refresh 'Users'. " + event->error().errorMessage(), 
+                        mongo::logger::LogSeverity::Warning());
             return;
         }
 
@@ -171,7 +450,12 @@ namespace Robomongo
             if (_server->connectionRecord()->isReplicaSet()) // replica set
                 handleIfReplicaSetUnreachable(event);           
 
-            genericEventErrorHandler(event, "Failed to refresh 'Functions'.", _bus, this);
+            // Not shown, if it was loaded with other metadata of database (see loadMetadata())
+            if (event->error().showErrorWindow())
+                genericEventErrorHandler(event, "Failed to refresh 'Functions'.", _bus, this);
+            else
+                LOG_MSG("Failed to refresh 'Functions'. " + event->error().errorMessage(), 
+                        mongo::logger::LogSeverity::Warning());
             return;
         }
 
@@ -266,6 +550,43 @@ namespace Robomongo
         }
     }
 
+    void MongoDatabase::handle(CopyCollectionProgressEvent *event)
+    {
+        // Throughput of the whole copy, ETA is based on estimated count of source
+        double const seconds = event->elapsedMs / 1000.0;
+        long long const perSecond = seconds > 0 ? static_cast<long long>(event->copied / seconds) : 0;
+        std::string message = "Copying collection \'" + event->to.collectionName() + "\': " + 
+                              std::to_string(event->copied);
+        if (event->total > 0)
+            message += " of " + std::to_string(event->total);
+        message += " documents, " + std::to_string(perSecond) + " docs/s";
+
+        long long const left = event->total - event->copied - event->failed;
+        if (perSecond > 0 && left > 0)
+            message += ", about " + std::to_string(left / perSecond + 1) + " s left";
+        LOG_MSG(message + ".", mongo::logger::LogSeverity::Info());
+    }
+
+    void MongoDatabase::handle(CopyCollectionToDiffServerResponse *event)
+    {
+        loadCollections();
+        std::string const counts = std::to_string(event->copied) + " documents copied" +
+            (event->failed > 0 ? ", " + std::to_string(event->failed) + " failed" : "");
+
+        if (event->isError()) {
+            handleIfReplicaSetUnreachable(event);
+            genericEventErrorHandler(event, "Failed to copy collection \'" + event->to.collectionName() + 
+                                     "\' (" + counts + ").", _bus, this);
+            return;
+        }
+
+        LOG_MSG("Collection \'" + event->to.collectionName() + "\' copied to database \'" + _name + "\': " + 
+                counts + " in " + std::to_string(event->elapsedMs / 1000) + " s.", 
+                mongo::logger::LogSeverity::Info());
+        if (!event->errors.empty())
+            LOG_MSG(event->errors, mongo::logger::LogSeverity::Warning());
+    }
+
     void MongoDatabase::handleIfReplicaSetUnreachable(Event *event)
     {
         if (!_server->connectionRecord()->isReplicaSet())
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <QObject>
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
 #include <mongo/bson/bsonobj.h>
 
 #include "robomongo/core/Core.h"
@@ -46,9 +50,51 @@ namespace Robomongo
 
         /**
          * @brief Initiate listCollection asynchronous operation.
+         *        Collections are loaded in batches, see MongoDatabaseCollectionListLoadedEvent
          */
         void loadCollections();
 
+        /**
+         * @brief Only collections with names containing this string (case insensitive) are
+         *        loaded by loadCollections(). Empty string means no filter.
+         */
+        void setCollectionNameFilter(const std::string &filter) { _collectionNameFilter = filter; }
+        const std::string &collectionNameFilter() const { return _collectionNameFilter; }
+
+        /**
+         * @brief Initiate collStats asynchronous operation for these collections (usually, 
+         *        the ones visible in explorer). Collections with fresh cached stats are skipped.
+         *        Stats are loaded on metadata worker a few collections at a time, and only one 
+         *        such request per database is in flight. See MongoDatabaseCollectionStatsLoadedEvent
+         */
+        void loadCollectionStats(const std::vector<std::string> &collectionNames);
+
+        /**
+         * @brief Drops queued collStats requests and stops the one in flight after its
+         *        current collection. Already loaded stats are kept.
+         */
+        void cancelCollectionStats();
+
+        /**
+         * @brief Cached stats of collection, shared by all views of this database.
+         * @return nullptr, if stats of this collection were not loaded yet
+         */
+        const MongoCollectionInfo *collectionStats(const std::string &collectionName) const;
+
+        /**
+         * @brief Initiate $indexStats and collStats asynchronous operation for indexes of
+         *        collection (see MongoClient::indexUsage()), unless cached usage is fresh
+         *        or it is already loading. See MongoDatabaseIndexUsageLoadedEvent
+         * @param force Reload even fresh cached usage (i.e. on refresh of indexes)
+         */
+        void loadIndexUsage(const std::string &collectionName, bool force = false);
+
+        /**
+         * @brief Cached usage of indexes of collection, shared by all views of this database.
+         * @return nullptr, if usage of this collection was not loaded yet
+         */
+        const std::vector<IndexUsageInfo> *indexUsage(const std::string &collectionName) const;
+
         /**
          * @brief Initiate loadUsers asynchronous operation.
          */
@@ -56,6 +102,13 @@ namespace Robomongo
 
         void loadFunctions();
 
+        /**
+         * @brief Initiate loading of collections, users and functions with one request (see
+         *        LoadDatabaseMetadataRequest), when database is expanded. Results come as
+         *        events of loadCollections(), loadUsers() and loadFunctions().
+         */
+        void loadMetadata();
+
         void createCollection(const std::string &collection, long long size, bool capped, int maxDocNum, const mongo::BSONObj& extraOptions);
         void dropCollection(const std::string &collection);
         void renameCollection(const std::string &collection, const std::string &newCollection);
@@ -79,8 +132,22 @@ namespace Robomongo
 
         MongoServer *server() const { return _server; }
 
+        /**
+         * @brief Collections loaded by the last loadCollections(), with respect to name filter
+         */
+        const std::vector<MongoCollection *> &collections() const { return _collections; }
+
+        /**
+         * @brief Collection was created or dropped by somebody else, see MongoServer::setLiveExplorer().
+         *        Applied to loaded collections like a refresh, ignored if they were not loaded yet.
+         */
+        void collectionCreated(const std::string &collection);
+        void collectionDropped(const std::string &collection);
+
     protected Q_SLOTS:
         void handle(LoadCollectionNamesResponse *event);
+        void handle(LoadCollectionStatsResponse *event);
+        void handle(LoadIndexUsageResponse *event);
         void handle(LoadUsersResponse *event);
         void handle(LoadFunctionsResponse *event);
         void handle(CreateFunctionResponse *event);
@@ -91,15 +158,67 @@ namespace Robomongo
         void handle(DropUserResponse *event);
         void handle(RenameCollectionResponse *event);
         void handle(DuplicateCollectionResponse *event);
+        void handle(CopyCollectionProgressEvent *event);
+        void handle(CopyCollectionToDiffServerResponse *event);
 
     private:
         void clearCollections();
         void addCollection(MongoCollection *collection);
         void handleIfReplicaSetUnreachable(Event *event);
+        void sendNextCollectionStatsRequest();
+
+        // Shows collections of snapshot or prepares reconciliation, before names are requested
+        void startCollectionsLoad();
+
+        /**
+         * @brief Applies differences between shown collections (loaded before or taken from
+         *        MetadataSnapshot) and the ones server returned: removes the dropped ones,
+         *        appends the new ones and keeps the others
+         */
+        void reconcileCollections();
+
+        // Publishes MongoDatabaseCollectionListLoadedEvent with both and saves snapshot
+        void applyCollectionChanges(const std::vector<MongoCollectionInfo> &added,
+                                    const std::unordered_set<std::string> &removedNames);
+        void saveSnapshot() const;
 
     private:
+        struct CachedCollectionStats
+        {
+            MongoCollectionInfo info;
+            std::chrono::steady_clock::time_point loadedAt;
+        };
+
+        struct CachedIndexUsage
+        {
+            std::vector<IndexUsageInfo> usage;
+            std::chrono::steady_clock::time_point loadedAt;
+        };
+
+        // Collections per LoadCollectionStatsRequest
+        static constexpr size_t CollectionStatsChunkSize = 16;
+        static constexpr std::chrono::minutes CollectionStatsTtl { 5 };
+        static constexpr std::chrono::minutes IndexUsageTtl { 2 };
+
         MongoServer *_server;
         std::vector<MongoCollection *> _collections;
+        std::string _collectionNameFilter;
+
+        // Collections are shown already, batches of server are collected here
+        bool _collectionsLoaded = false;
+        bool _reconciling = false;
+        std::vector<MongoCollectionInfo> _reconciledCollections;
+
+        // collStats cache and queue, see loadCollectionStats()
+        std::unordered_map<std::string, CachedCollectionStats> _collectionStats;
+        std::deque<std::string> _pendingStats;
+        std::unordered_set<std::string> _queuedStats;      // pending or in flight
+        std::vector<std::string> _inFlightStats;
+        std::shared_ptr<std::atomic<bool>> _statsCancelled;
+
+        // $indexStats cache, see loadIndexUsage()
+        std::unordered_map<std::string, CachedIndexUsage> _indexUsage;
+        std::unordered_set<std::string> _inFlightIndexUsage;
         const std::string _name;
         const bool _system;
         EventBus *_bus;
@@ -109,14 +228,51 @@ namespace Robomongo
     {
         R_EVENT
 
-        MongoDatabaseCollectionListLoadedEvent(QObject *sender, const std::vector<MongoCollection *> &list) :
+        MongoDatabaseCollectionListLoadedEvent(QObject *sender, const std::vector<MongoCollection *> &list,
+                                               int batchIndex = 0, bool lastBatch = true,
+                                               const std::vector<std::string> &removed = std::vector<std::string>()) :
             Event(sender),
-            collections(list) { }
+            collections(list),
+            batchIndex(batchIndex),
+            lastBatch(lastBatch),
+            removedNames(removed) { }
 
         MongoDatabaseCollectionListLoadedEvent(QObject *sender, const EventError &error) :
             Event(sender, error) {}
 
+        // Collections of this batch only. First batch (index 0) replaces previous
+        // collections, every next batch is appended to them.
         std::vector<MongoCollection *> collections;
+        int batchIndex = 0;
+        bool lastBatch = true;
+
+        // Dropped since the previous load, removed before the collections of this batch
+        // are appended. Empty in the first batch.
+        std::vector<std::string> removedNames;
+    };
+
+    class MongoDatabaseCollectionStatsLoadedEvent : public Event
+    {
+        R_EVENT
+
+        MongoDatabaseCollectionStatsLoadedEvent(QObject *sender, const std::vector<std::string> &names) :
+            Event(sender),
+            collectionNames(names) {}
+
+        // Collections with updated stats, see MongoDatabase::collectionStats()
+        std::vector<std::string> collectionNames;
+    };
+
+    class MongoDatabaseIndexUsageLoadedEvent : public Event
+    {
+        R_EVENT
+
+        MongoDatabaseIndexUsageLoadedEvent(QObject *sender, const std::string &name) :
+            Event(sender),
+            collectionName(name) {}
+
+        // Collection with updated usage, see MongoDatabase::indexUsage()
+        std::string collectionName;
     };
 
     class MongoDatabaseUsersLoadedEvent : public Event
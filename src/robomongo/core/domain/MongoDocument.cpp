@@ -1,12 +1,50 @@
 #include "robomongo/core/domain/MongoDocument.h"
 
+#include <cstring>
+#include <memory>
+#include <boost/make_shared.hpp>
 #include <mongo/client/dbclient_base.h>
 #include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/Logger.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/core/domain/BsonSegmentFile.h"
 
 namespace Robomongo
 {
+    namespace
+    {
+        /*
+        ** Documents of one batch and buffer they point into, allocated together
+        */
+        class DocumentSlab
+        {
+        public:
+            explicit DocumentSlab(const std::vector<mongo::BSONObj> &bsonObjs)
+            {
+                size_t size = 0;
+                for (auto const& bsonObj : bsonObjs)
+                    size += bsonObj.objsize();
+
+                _data.reset(new char[size]);
+                _documents.reserve(bsonObjs.size());
+                char *next = _data.get();
+                for (auto const& bsonObj : bsonObjs) {
+                    std::memcpy(next, bsonObj.objdata(), bsonObj.objsize());
+                    _documents.emplace_back(mongo::BSONObj(next));
+                    next += bsonObj.objsize();
+                }
+            }
+
+            std::vector<MongoDocument> &documents() { return _documents; }
+
+        private:
+            std::unique_ptr<char[]> _data;
+            std::vector<MongoDocument> _documents;
+        };
+    }
+
     MongoDocument::MongoDocument()
     {
 
@@ -19,7 +57,12 @@ namespace Robomongo
     /*
     ** Create MongoDocument from BsonObj. It will take owned version of BSONObj
     */
-    MongoDocument::MongoDocument(mongo::BSONObj bsonObj) :_bsonObj(bsonObj)
+    MongoDocument::MongoDocument(mongo::BSONObj bsonObj) :_bsonObj(std::move(bsonObj))
+    {
+    }
+
+    MongoDocument::MongoDocument(mongo::BSONObj bsonObj, BsonSegmentFilePtr storage) :
+        _bsonObj(std::move(bsonObj)), _storage(std::move(storage))
     {
     }
 
@@ -44,4 +87,120 @@ namespace Robomongo
 
         return list;
     }
+
+    std::vector<MongoDocumentPtr> MongoDocument::fromBsonObj(std::vector<mongo::BSONObj> &&bsonObjs)
+    {
+        std::vector<MongoDocumentPtr> list;
+        list.reserve(bsonObjs.size());
+        for (auto &bsonObj : bsonObjs)
+            list.push_back(MongoDocumentPtr(new MongoDocument(std::move(bsonObj))));
+
+        bsonObjs.clear();
+        return list;
+    }
+
+    std::vector<MongoDocumentPtr> MongoDocument::fromBatch(const std::vector<mongo::BSONObj> &bsonObjs)
+    {
+        std::vector<MongoDocumentPtr> list;
+        if (bsonObjs.empty())
+            return list;
+
+        // Every document shares reference count of slab (aliasing constructor)
+        boost::shared_ptr<DocumentSlab> const slab = boost::make_shared<DocumentSlab>(bsonObjs);
+        list.reserve(bsonObjs.size());
+        for (MongoDocument &doc : slab->documents())
+            list.push_back(MongoDocumentPtr(slab, &doc));
+
+        return list;
+    }
+
+    std::vector<MongoDocumentPtr> MongoDocument::fromBsonObj(std::vector<mongo::BSONObj> &&bsonObjs,
+                                                             long long memoryBudget)
+    {
+        size_t const count = bsonObjs.size();
+        size_t inMemory = 0;
+        long long size = 0;
+        while (inMemory < count && (memoryBudget <= 0 || size + bsonObjs[inMemory].objsize() <= memoryBudget))
+            size += bsonObjs[inMemory++].objsize();
+
+        if (inMemory == count)
+            return fromBsonObj(std::move(bsonObjs));
+
+        std::vector<MongoDocumentPtr> list;
+        list.reserve(count);
+        for (size_t i = 0; i < inMemory; ++i)
+            list.push_back(MongoDocumentPtr(new MongoDocument(std::move(bsonObjs[i]))));
+
+        // Written in chunks, so that memory of spilled documents is released as we go
+        size_t const CHUNK_SIZE = 1000;
+        BsonSegmentFilePtr storage(new BsonSegmentFile);
+        size_t first = inMemory;
+        for (; first < count; first += CHUNK_SIZE) {
+            size_t const last = std::min(first + CHUNK_SIZE, count);
+            if (!storage->append(bsonObjs.begin() + first, bsonObjs.begin() + last)) {
+                LOG_MSG("Failed to move shell result to temporary file (" +
+                        QtUtils::toStdString(storage->errorString()) + "). " +
+                        std::to_string(count - first) + " documents are kept in memory.",
+                        mongo::logger::LogSeverity::Warning());
+                break;
+            }
+
+            for (size_t i = first; i < last; ++i) {
+                list.push_back(MongoDocumentPtr(new MongoDocument(storage->document(i - inMemory), storage)));
+                bsonObjs[i] = mongo::BSONObj();
+            }
+        }
+
+        for (; first < count; ++first)
+            list.push_back(MongoDocumentPtr(new MongoDocument(std::move(bsonObjs[first]))));
+
+        if (storage->count() > 0)
+            LOG_MSG("Shell result exceeds memory budget, " + std::to_string(storage->count()) +
+                    " documents were moved to temporary file.", mongo::logger::LogSeverity::Info());
+
+        bsonObjs.clear();
+        return list;
+    }
+
+    std::vector<MongoDocumentPtr> MongoDocument::moveToStorage(const std::vector<MongoDocumentPtr> &documents,
+                                                               const BsonSegmentFilePtr &storage)
+    {
+        std::vector<mongo::BSONObj> bsonObjs;
+        for (auto const& doc : documents) {
+            if (!doc->isSpilled())
+                bsonObjs.push_back(doc->bsonObj());
+        }
+
+        if (bsonObjs.empty())
+            return documents;
+
+        size_t next = storage->count();
+        if (!storage->append(bsonObjs.begin(), bsonObjs.end())) {
+            LOG_MSG("Failed to write result to temporary file (" + QtUtils::toStdString(storage->errorString()) +
+                    "), documents are kept in memory.", mongo::logger::LogSeverity::Warning());
+            return documents;
+        }
+
+        std::vector<MongoDocumentPtr> list;
+        list.reserve(documents.size());
+        for (auto const& doc : documents) {
+            if (doc->isSpilled())
+                list.push_back(doc);
+            else
+                list.push_back(MongoDocumentPtr(new MongoDocument(storage->document(next++), storage)));
+        }
+
+        return list;
+    }
+
+    long long MongoDocument::bsonSize(const std::vector<MongoDocumentPtr> &documents, bool includeSpilled)
+    {
+        long long size = 0;
+        for (auto const& doc : documents) {
+            if (includeSpilled || !doc->isSpilled())
+                size += doc->bsonObj().objsize();
+        }
+
+        return size;
+    }
 }
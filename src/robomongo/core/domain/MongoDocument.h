@@ -16,6 +16,11 @@ namespace Robomongo
         ** Owned BSONObj
         */
         const mongo::BSONObj _bsonObj;
+
+        /*
+        ** File, which _bsonObj points into (for documents spilled to disk)
+        */
+        const BsonSegmentFilePtr _storage;
     public:
         /*
         ** Constructs empty Document, i.e. { }
@@ -28,6 +33,12 @@ namespace Robomongo
         */
         MongoDocument(mongo::BSONObj bsonObj);
 
+        /*
+        ** Create MongoDocument from BsonObj, which points into memory-mapped 'storage'.
+        ** Document keeps 'storage' alive
+        */
+        MongoDocument(mongo::BSONObj bsonObj, BsonSegmentFilePtr storage);
+
         /*
         ** Create MongoDocument from BsonObj. It will take owned version of BSONObj
         */ 
@@ -38,9 +49,48 @@ namespace Robomongo
         */ 
         static std::vector<MongoDocumentPtr> fromBsonObj(const std::vector<mongo::BSONObj> &bsonObj);
 
+        /*
+        ** Create list of MongoDocuments taking ownership of buffers of 'bsonObjs' (without copying).
+        ** 'bsonObjs' is left empty
+        */
+        static std::vector<MongoDocumentPtr> fromBsonObj(std::vector<mongo::BSONObj> &&bsonObjs);
+
+        /*
+        ** Create list of MongoDocuments from 'bsonObjs' (e.g. views into batch of cursor), copied
+        ** one after another into one buffer. Documents share lifetime of that buffer, so there is
+        ** no heap allocation per document
+        */
+        static std::vector<MongoDocumentPtr> fromBatch(const std::vector<mongo::BSONObj> &bsonObjs);
+
+        /*
+        ** The same as above, but documents past 'memoryBudget' bytes are moved to temporary
+        ** memory-mapped file, instead of being kept in process memory. Budget 0 means no limit
+        */
+        static std::vector<MongoDocumentPtr> fromBsonObj(std::vector<mongo::BSONObj> &&bsonObjs,
+                                                         long long memoryBudget);
+
+        /*
+        ** Appends documents, which are kept in process memory, to 'storage' and returns list
+        ** where they are replaced by documents pointing into 'storage'. Already spilled documents
+        ** are returned as is. If 'storage' fails to write, 'documents' are returned unchanged
+        */
+        static std::vector<MongoDocumentPtr> moveToStorage(const std::vector<MongoDocumentPtr> &documents,
+                                                           const BsonSegmentFilePtr &storage);
+
+        /*
+        ** Total size (in bytes) of BSON buffers of 'documents'. Spilled documents are
+        ** counted only if 'includeSpilled' is true
+        */
+        static long long bsonSize(const std::vector<MongoDocumentPtr> &documents, bool includeSpilled = true);
+
         /*
         ** Return "native" BSONObj
         */
-        mongo::BSONObj bsonObj() const { return _bsonObj; }
+        const mongo::BSONObj &bsonObj() const { return _bsonObj; }
+
+        /*
+        ** True if document is stored in memory-mapped file instead of process memory
+        */
+        bool isSpilled() const { return static_cast<bool>(_storage); }
     };
 }
@@ -0,0 +1,29 @@
+#include "gtest/gtest.h"
+#include "MongoDocument.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+TEST(mongo_document_tests, batch_is_copied_to_slab)
+{
+    std::vector<MongoDocumentPtr> docs;
+    {
+        std::vector<mongo::BSONObj> batch;
+        for (int i = 0; i < 3; ++i)
+            batch.push_back(BSON("_id" << i << "name" << "document"));
+        docs = MongoDocument::fromBatch(batch);
+    }
+
+    ASSERT_EQ(3u, docs.size());
+    EXPECT_EQ(BSON("_id" << 1 << "name" << "document").toString(), docs[1]->bsonObj().toString());
+    EXPECT_EQ(docs[0]->bsonObj().objdata() + docs[0]->bsonObj().objsize(), docs[1]->bsonObj().objdata());
+    EXPECT_FALSE(docs[2]->isSpilled());
+
+    // Any document keeps the whole slab alive
+    MongoDocumentPtr const last = docs[2];
+    docs.clear();
+    EXPECT_EQ(2, last->bsonObj()["_id"].numberInt());
+
+    EXPECT_TRUE(MongoDocument::fromBatch(std::vector<mongo::BSONObj>()).empty());
+}
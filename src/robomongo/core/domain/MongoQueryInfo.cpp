@@ -28,7 +28,7 @@ namespace Robomongo
         return !_serverAddress.empty() && _ns.isValid();
     }
 
-    MongoQueryInfo::MongoQueryInfo() {}
+    MongoQueryInfo::MongoQueryInfo() : _maxTimeMs(0) {}
 
     MongoQueryInfo::MongoQueryInfo(const CollectionInfo &info,
               mongo::BSONObj query, mongo::BSONObj fields, int limit, int skip, int batchSize,
@@ -40,6 +40,7 @@ namespace Robomongo
         _skip(skip),
         _batchSize(batchSize),
         _options(options),
-        _special(special)
+        _special(special),
+        _maxTimeMs(0)
         {}
 }
@@ -2,6 +2,7 @@
 
 #include <mongo/bson/bsonobj.h>
 #include "robomongo/core/domain/MongoNamespace.h"
+#include "robomongo/core/domain/ReadPreferenceInfo.h"
 
 namespace Robomongo
 {
@@ -37,6 +38,7 @@ namespace Robomongo
         int _options;
         bool _special; // flag, indicating that `query` contains special fields on
                       // first level, and query data in `query` field.
-        
+        ReadPreferenceInfo _readPreference;     // of tab, applied by MongoClient::openCursor()
+        int _maxTimeMs;     // server time limit of tab, 0 if none, applied by MongoClient::openCursor()
     };
 }
@@ -1,6 +1,7 @@
 #include "robomongo/core/domain/MongoServer.h"
 
 #include "robomongo/core/domain/MongoDatabase.h"
+#include "robomongo/core/domain/MetadataSnapshot.h"
 #include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/settings/SshSettings.h"
 #include "robomongo/core/settings/SettingsManager.h"
@@ -17,16 +18,24 @@
 #include "robomongo/utils/common.h"
 #include "robomongo/utils/StringOperations.h"
 
+#include <unordered_map>
+#include <unordered_set>
 #include <QApplication>
+#include <QTimerEvent>
 
 namespace Robomongo {
     R_REGISTER_EVENT(MongoServerLoadingDatabasesEvent)
+    R_REGISTER_EVENT(ServerHealthCheckedEvent)
 
     MongoServer::MongoServer(int handle, ConnectionSettings *settings, ConnectionType connectionType) 
         : QObject(),
         _version(0.0f),
         _connectionType(connectionType),
         _worker(nullptr),
+        _metadataWorker(nullptr),
+        _indexBuildWorker(nullptr),
+        _changeStreamWorker(nullptr),
+        _isMetadataWorkerConnected(false),
         _isConnected(false),
         _connSettings(settings),
         _handle(handle),
@@ -44,26 +53,113 @@ namespace Robomongo {
     }
 
     MongoServer::~MongoServer() {
+        stopTopologyMonitor();
+        if (_healthCheckTimerId != -1)
+            killTimer(_healthCheckTimerId);
+
         clearDatabases();
 
         if (_worker) {
             _worker->stopAndDelete();
         }
 
-        // MongoWorker "_worker" is not deleted here, because it is now owned by
+        if (_metadataWorker) {
+            _metadataWorker->stopAndDelete();
+        }
+
+        if (_indexBuildWorker) {
+            _indexBuildWorker->stopAndDelete();
+        }
+
+        if (_changeStreamWorker) {
+            setLiveExplorer(false);
+            _changeStreamWorker->stopAndDelete();
+        }
+
+        // MongoWorkers are not deleted here, because it is now owned by
         // another thread (call to moveToThread() made in MongoWorker constructor).
         // It will be deleted by this thread by means of "deleteLater()", which
         // is also specified in MongoWorker constructor.
     }
 
+    MongoWorker *MongoServer::metadataWorker() const
+    {
+        return _isMetadataWorkerConnected ? _metadataWorker : _worker;
+    }
+
+    MongoWorker *MongoServer::indexBuildWorker()
+    {
+        // Connection is established by the first request
+        if (!_indexBuildWorker)
+            _indexBuildWorker = new MongoWorker(_connSettings->clone(),
+                                                false,
+                                                AppRegistry::instance().settingsManager()->batchSize(),
+                                                AppRegistry::instance().settingsManager()->mongoTimeoutSec(),
+                                                AppRegistry::instance().settingsManager()->shellTimeoutSec(),
+                                                AppRegistry::instance().settingsManager()->shellResultMemoryBudgetMb(),
+                                                0,
+                                                0,
+                                                false);
+        return _indexBuildWorker;
+    }
+
+    MongoWorker *MongoServer::changeStreamWorker()
+    {
+        // Streams wait for server in every step, so they do not share worker with other requests.
+        // Steps of all of them (live explorer, oplog tails) are interleaved on this one.
+        if (!_changeStreamWorker)
+            _changeStreamWorker = new MongoWorker(_connSettings->clone(),
+                                                  false,
+                                                  AppRegistry::instance().settingsManager()->batchSize(),
+                                                  AppRegistry::instance().settingsManager()->mongoTimeoutSec(),
+                                                  AppRegistry::instance().settingsManager()->shellTimeoutSec(),
+                                                  AppRegistry::instance().settingsManager()->shellResultMemoryBudgetMb(),
+                                                  0,
+                                                  0,
+                                                  false);
+        return _changeStreamWorker;
+    }
+
+    void MongoServer::setLiveExplorer(bool enabled)
+    {
+        if (enabled == liveExplorer())
+            return;
+
+        if (!enabled) {
+            // Worker closes the stream within WatchNamespaceChangesRequest::AwaitMs
+            *_liveExplorerCancelled = true;
+            _liveExplorerCancelled.reset();
+            return;
+        }
+
+        _liveExplorerCancelled = std::make_shared<std::atomic<bool>>(false);
+        _bus->send(changeStreamWorker(), new WatchNamespaceChangesRequest(this, _liveExplorerCancelled));
+    }
+
+    void MongoServer::tailOplog(int tailId, const OplogTail::Filter &filter,
+                                const std::shared_ptr<std::atomic<bool>> &cancelled)
+    {
+        _bus->send(changeStreamWorker(), new TailOplogRequest(this, tailId, filter, cancelled));
+    }
+
+    void MongoServer::watchCollection(int watchId, const MongoNamespace &ns, const ChangeStreamWatch::Filter &filter,
+                                      const std::shared_ptr<std::atomic<bool>> &cancelled)
+    {
+        _bus->send(changeStreamWorker(), new WatchCollectionRequest(this, watchId, ns, filter, cancelled));
+    }
+
     void MongoServer::tryConnect() 
     {
         _bus->send(_worker, new EstablishConnectionRequest(this, _connectionType, _connSettings->uuid().toStdString()));
+        if (_metadataWorker)
+            _bus->send(_metadataWorker, new EstablishConnectionRequest(this, _connectionType, _connSettings->uuid().toStdString()));
     }
 
     void MongoServer::tryRefresh() 
     {
         _bus->send(_worker, new EstablishConnectionRequest(this, ConnectionRefresh, _connSettings->uuid().toStdString()));
+        if (_metadataWorker)
+            _bus->send(_metadataWorker, new EstablishConnectionRequest(this, ConnectionRefresh, _connSettings->uuid().toStdString()));
     }
 
     void MongoServer::tryRefreshReplicaSetConnection()
@@ -82,6 +178,62 @@ namespace Robomongo {
         _bus->send(_worker, new RefreshReplicaSetFolderRequest(this, expanded));
     }
 
+    void MongoServer::expandReplicaSetFolder()
+    {
+        if (!_connSettings->isReplicaSet())
+            return;
+
+        bool const fresh = _replicaSetInfo && _topologyUpdatedAt.isValid() &&
+            _topologyUpdatedAt.msecsTo(QDateTime::currentDateTimeUtc()) < 2 * TopologyMonitorIntervalMs;
+
+        if (!fresh) {
+            tryRefreshReplicaSetFolder(true);
+            return;
+        }
+
+        // Topology is kept up to date by monitor, no need to wait for network
+        if (_replicaSetInfo->primary.empty())
+            _bus->publish(new ReplicaSetFolderRefreshed(this, 
+                EventError(_replicaSetInfo->errorStr, EventError::Unknown, false), true));
+        else
+            _bus->publish(new ReplicaSetFolderRefreshed(this, true));
+    }
+
+    void MongoServer::startTopologyMonitor()
+    {
+        if (_topologyMonitorTimerId != -1)
+            return;
+
+        _topologyMonitorTimerId = startTimer(TopologyMonitorIntervalMs);
+    }
+
+    void MongoServer::stopTopologyMonitor()
+    {
+        if (_topologyMonitorTimerId == -1)
+            return;
+
+        killTimer(_topologyMonitorTimerId);
+        _topologyMonitorTimerId = -1;
+    }
+
+    void MongoServer::timerEvent(QTimerEvent *event)
+    {
+        if (event->timerId() == _healthCheckTimerId) {
+            if (_isMetadataWorkerConnected)
+                _bus->send(_metadataWorker, new PingServerRequest(this));
+            return;
+        }
+
+        if (event->timerId() != _topologyMonitorTimerId) {
+            QObject::timerEvent(event);
+            return;
+        }
+
+        // Metadata worker does not wait behind user scripts. Pending poll is coalesced 
+        // with this one by the event bus, so slow members do not pile up requests.
+        _bus->send(metadataWorker(), new RefreshReplicaSetFolderRequest(this, false, true));
+    }
+
     QStringList MongoServer::getDatabasesNames() const 
     {
         QStringList result;
@@ -117,32 +269,193 @@ namespace Robomongo {
     }
 
     void MongoServer::insertDocuments(const std::vector<mongo::BSONObj> &objCont,
-                                      const MongoNamespace &ns) {
-        for (std::vector<mongo::BSONObj>::const_iterator it = objCont.begin(); it != objCont.end(); it++) {
-            insertDocument(*it, ns);
-        }
+                                      const MongoNamespace &ns, int batchBytesLimit) {
+        if (objCont.size() == 1)
+            return insertDocument(objCont.front(), ns);
+
+        _bus->send(_worker, new InsertDocumentsRequest(this, objCont, ns, false, batchBytesLimit));
     }
 
     void MongoServer::insertDocument(const mongo::BSONObj &obj, const MongoNamespace &ns) {
         _bus->send(_worker, new InsertDocumentRequest(this, obj, ns));
     }
 
-    void MongoServer::saveDocuments(const std::vector<mongo::BSONObj> &objCont, const MongoNamespace &ns) {
-        for (std::vector<mongo::BSONObj>::const_iterator it = objCont.begin(); it != objCont.end(); it++) {
-            saveDocument(*it, ns);
-        }
+    void MongoServer::saveDocuments(const std::vector<mongo::BSONObj> &objCont, const MongoNamespace &ns,
+                                    int batchBytesLimit) {
+        if (objCont.size() == 1)
+            return saveDocument(objCont.front(), ns);
+
+        _bus->send(_worker, new InsertDocumentsRequest(this, objCont, ns, true, batchBytesLimit));
     }
 
     void MongoServer::saveDocument(const mongo::BSONObj &obj, const MongoNamespace &ns) {
         _bus->send(_worker, new InsertDocumentRequest(this, obj, ns, true));
     }
 
+    void MongoServer::updateDocument(const mongo::BSONObj &original, const mongo::BSONObj &edited,
+                                     const MongoNamespace &ns) {
+        _bus->send(_worker, new InsertDocumentRequest(this, edited, ns, true, original));
+    }
+
+    void MongoServer::commitChangeset(int changesetId, const MongoNamespace &ns,
+                                      const std::vector<TableChangeset::Statement> &statements)
+    {
+        _bus->send(_worker, new CommitChangesetRequest(this, changesetId, ns, statements));
+    }
+
     void MongoServer::removeDocuments(mongo::Query query, const MongoNamespace &ns, 
                                       RemoveDocumentCount removeCount, int index) 
     {
         _bus->send(_worker, new RemoveDocumentRequest(this, query, ns, removeCount, index));
     }
 
+    void MongoServer::removeDocuments(const std::vector<mongo::BSONObj> &ids, const MongoNamespace &ns)
+    {
+        _bus->send(_worker, new RemoveDocumentsByIdRequest(this, ids, ns));
+    }
+
+    void MongoServer::exportDocuments(int exportId, const MongoQueryInfo &queryInfo, const ExportOptions &options,
+                                      const QString &filePath, const std::shared_ptr<std::atomic<bool>> &cancelled)
+    {
+        _bus->send(_worker, new ExportDocumentsRequest(this, exportId, queryInfo, options, filePath, cancelled));
+    }
+
+    void MongoServer::importDocuments(int importId, const MongoNamespace &ns, const QString &filePath,
+                                      const ImportOptions &options, const std::shared_ptr<std::atomic<bool>> &cancelled)
+    {
+        _bus->send(_worker, new ImportDocumentsRequest(this, importId, ns, filePath, options, cancelled));
+    }
+
+    void MongoServer::databaseStats(int statsId, const std::string &dbName, 
+                                    const std::shared_ptr<std::atomic<bool>> &cancelled, bool indexDetails)
+    {
+        _bus->send(_worker, new DatabaseStatsRequest(this, statsId, dbName, cancelled, indexDetails));
+    }
+
+    void MongoServer::searchDatabase(int searchId, const std::string &dbName, const DatabaseSearch::Options &options,
+                                     const std::shared_ptr<DatabaseSearch::Cancellation> &cancellation)
+    {
+        _bus->send(_worker, new DatabaseSearchRequest(this, searchId, dbName, options, cancellation));
+    }
+
+    void MongoServer::maintainCollections(int runId, const std::string &dbName,
+                                          const std::vector<std::string> &collections,
+                                          const CollectionMaintenance::Action &action,
+                                          const std::shared_ptr<std::atomic<bool>> &cancelled)
+    {
+        _bus->send(_worker, new CollectionMaintenanceRequest(this, runId, dbName, collections, action, cancelled));
+    }
+
+    void MongoServer::analyzeSchema(int analysisId, const MongoNamespace &ns, int sampleSize,
+                                    const std::shared_ptr<std::atomic<bool>> &cancelled)
+    {
+        _bus->send(_worker, new AnalyzeSchemaRequest(this, analysisId, ns, sampleSize, cancelled));
+    }
+
+    void MongoServer::documentSizes(int sizesId, const MongoNamespace &ns, int sampleSize, int topCount,
+                                    const std::shared_ptr<std::atomic<bool>> &cancelled)
+    {
+        _bus->send(_worker, new DocumentSizesRequest(this, sizesId, ns, sampleSize, topCount, cancelled));
+    }
+
+    void MongoServer::generateData(int generateId, const MongoNamespace &ns, const mongo::BSONObj &sample,
+                                   int sampleSize, long long documents, int rate, int threads,
+                                   const std::shared_ptr<std::atomic<bool>> &cancelled)
+    {
+        _bus->send(_worker, new GenerateDataRequest(this, generateId, ns, sample, sampleSize, documents, rate,
+                                                    threads, cancelled));
+    }
+
+    void MongoServer::throttledWrite(int writeId, const MongoNamespace &ns, const mongo::BSONObj &filter,
+                                     const mongo::BSONObj &update, long long maxLagMs,
+                                     const std::shared_ptr<std::atomic<bool>> &cancelled,
+                                     const std::shared_ptr<std::atomic<bool>> &paused)
+    {
+        _bus->send(_worker, new ThrottledWriteRequest(this, writeId, ns, filter, update, maxLagMs, cancelled,
+                                                      paused));
+    }
+
+    void MongoServer::replayWorkload(int replayId, const std::string &profileDatabase, const std::string &logFile,
+                                     long long sinceMs, const std::string &targetDatabase, double speed,
+                                     int threads, const std::shared_ptr<std::atomic<bool>> &cancelled)
+    {
+        _bus->send(_worker, new ReplayWorkloadRequest(this, replayId, profileDatabase, logFile, sinceMs,
+                                                      targetDatabase, speed, threads, cancelled));
+    }
+
+    void MongoServer::compareCollections(int compareId, const MongoNamespace &source, MongoServer *targetServer,
+                                         const MongoNamespace &target,
+                                         const std::shared_ptr<std::atomic<bool>> &cancelled)
+    {
+        _bus->send(_worker, new CompareCollectionsRequest(this, compareId, source, targetServer->worker(),
+            targetServer->connectionRecord()->getFullAddress(), target, CompareCollectionsRequest::DefaultRanges,
+            cancelled));
+    }
+
+    void MongoServer::currentOps(int monitorId, const mongo::BSONObj &filter, int limit)
+    {
+        _bus->send(metadataWorker(), new CurrentOpsRequest(this, monitorId, filter, limit));
+    }
+
+    void MongoServer::killOps(int monitorId, const std::vector<mongo::BSONObj> &opids)
+    {
+        _bus->send(metadataWorker(), new KillOpRequest(this, monitorId, opids));
+    }
+
+    void MongoServer::sampleServerStatus(int monitorId)
+    {
+        _bus->send(metadataWorker(), new ServerStatusRequest(this, monitorId));
+    }
+
+    void MongoServer::profileSummary(int summaryId, const std::string &dbName, long long sinceMs, 
+                                     int minMillis, int limit)
+    {
+        _bus->send(_worker, new ProfileSummaryRequest(this, summaryId, dbName, sinceMs, minMillis, limit));
+    }
+
+    void MongoServer::planCacheStats(int cacheId, const MongoNamespace &ns, int limit)
+    {
+        _bus->send(metadataWorker(), new PlanCacheRequest(this, cacheId, ns, limit));
+    }
+
+    void MongoServer::shardDistribution(int distributionId, const MongoNamespace &ns, long long sinceMs)
+    {
+        _bus->send(metadataWorker(), new ShardDistributionRequest(this, distributionId, ns, sinceMs));
+    }
+
+    void MongoServer::gridFsFiles(int listId, const std::string &dbName, const std::string &bucket,
+                                  const std::string &filename, int limit)
+    {
+        _bus->send(_worker, new GridFsFilesRequest(this, listId, dbName, bucket, filename, limit));
+    }
+
+    void MongoServer::gridFsTransfer(int transferId, GridFsTransferRequest::Direction direction, 
+                                     const std::string &dbName, const std::string &bucket, 
+                                     const GridFs::FileInfo &file, const QString &filePath,
+                                     const std::shared_ptr<std::atomic<bool>> &cancelled)
+    {
+        _bus->send(_worker, new GridFsTransferRequest(this, transferId, direction, dbName, bucket, file, 
+                                                      filePath, cancelled));
+    }
+
+    void MongoServer::explain(int explainId, const std::string &dbName, const mongo::BSONObj &command)
+    {
+        _bus->send(_worker, new ExplainRequest(this, explainId, dbName, command));
+    }
+
+    void MongoServer::shardFanout(int fanoutId, const MongoNamespace &ns, const mongo::BSONObj &filter, 
+                                  const mongo::BSONObj &projection, const mongo::BSONObj &sort, int limit, 
+                                  bool readFromSecondaries)
+    {
+        _bus->send(_worker, new ShardFanoutRequest(this, fanoutId, ns, filter, projection, sort, limit,
+                                                   readFromSecondaries));
+    }
+
+    void MongoServer::rollingIndexBuild(const IndexInfo &oldInfo, const IndexInfo &newInfo)
+    {
+        _bus->send(indexBuildWorker(), new RollingIndexBuildRequest(this, oldInfo, newInfo));
+    }
+
     void MongoServer::loadDatabases() 
     {
         _bus->publish(new MongoServerLoadingDatabasesEvent(this));
@@ -150,7 +463,7 @@ namespace Robomongo {
             tryRefreshReplicaSetConnection();
         }
         else {  // single server
-            _bus->send(_worker, new LoadDatabaseNamesRequest(this));
+            _bus->send(metadataWorker(), new LoadDatabaseNamesRequest(this));
         }
     }
 
@@ -162,6 +475,18 @@ namespace Robomongo {
 
     void MongoServer::handle(EstablishConnectionResponse *event) 
     {
+        // Connection of metadata worker only switches explorer requests between workers,
+        // connection view is updated by responses of the main worker
+        if (event->sender() == _metadataWorker) {
+            _isMetadataWorkerConnected = !event->isError();
+            if (event->isError())
+                LOG_MSG("Explorer requests will share connection with shell. " + event->error().errorMessage(), 
+                        mongo::logger::LogSeverity::Warning());
+            else if (_healthCheckTimerId == -1)
+                _healthCheckTimerId = startTimer(HealthCheckIntervalMs);
+            return;
+        }
+
         _connectionType = event->connectionType;
 
         // In any case, replica set info must be updated, there might be reachable secondary(ies).
@@ -212,14 +537,18 @@ namespace Robomongo {
             MongoDatabase *db  = new MongoDatabase(this, dbname);
             addDatabase(db);    // todo: serverClones for replica sets should not do this
         }
+        if (ConnectionPrimary == _connectionType)
+            MetadataSnapshot::instance().retainDatabases(_connSettings->uuid(), info._databases);
 
         if (_connSettings->isReplicaSet()) {
             _bus->publish(new ConnectionEstablishedEvent(this, event->connectionType, info));
             // In order to do first connection much faster, time consuming refresh 
             // "repSetMonitor->startOrContinueRefresh(). refreshAll()" is being requested after 
             // successful connection.
-            if (ConnectionPrimary == event->connectionType)
+            if (ConnectionPrimary == event->connectionType) {
                 _bus->send(_worker, new RefreshReplicaSetFolderRequest(this, false));
+                startTopologyMonitor();
+            }
         }
 
         // Save connected db version if not saved before and if this is primary connection.
@@ -235,7 +564,37 @@ namespace Robomongo {
 
     void MongoServer::handle(RefreshReplicaSetFolderResponse *event)
     {
-        handleReplicaSetRefreshEvents(event->isError(), event->error(), event->replicaSet, event->expanded);
+        if (event->monitor) {
+            if (_replicaSetInfo && _replicaSetInfo->sameTopology(event->replicaSet)) {
+                _topologyUpdatedAt = QDateTime::currentDateTimeUtc();
+                return;
+            }
+
+            LOG_MSG("Replica set topology changed. Connection: " + _connSettings->connectionName(),
+                    mongo::logger::LogSeverity::Info());
+        }
+
+        handleReplicaSetRefreshEvents(event->isError(), event->error(), event->replicaSet, event->expanded,
+                                      event->monitor);
+    }
+
+    void MongoServer::handle(PingServerResponse *event)
+    {
+        if (event->isError()) {
+            _rttHistogram.addFailure();
+            if (!_lastHealthCheckFailed)    // Log only first failure of a series
+                LOG_MSG("Health check failed. " + event->error().errorMessage() + 
+                        ". Connection: " + _connSettings->connectionName(), mongo::logger::LogSeverity::Warning());
+        }
+        else {
+            _rttHistogram.addSample(event->rttMs);
+            if (_rttHistogram.samples() % HealthCheckLogEvery == 0 || _lastHealthCheckFailed)
+                LOG_MSG("Ping RTT: " + _rttHistogram.toString() + ". Connection: " + _connSettings->connectionName(),
+                        mongo::logger::LogSeverity::Info());
+        }
+
+        _lastHealthCheckFailed = event->isError();
+        _bus->publish(new ServerHealthCheckedEvent(this));
     }
 
     void MongoServer::handle(LoadDatabaseNamesResponse *event) 
@@ -245,12 +604,35 @@ namespace Robomongo {
             return;
         }
 
-        clearDatabases();
+        // Databases which are still there keep their loaded collections
+        std::unordered_set<std::string> const fresh(event->databaseNames.begin(), event->databaseNames.end());
+        std::unordered_map<std::string, MongoDatabase *> known;
+        QList<MongoDatabase *> removed;
+        std::vector<std::string> removedNames;
+        for (MongoDatabase *database : _databases) {
+            known[database->name()] = database;
+            if (!fresh.count(database->name())) {
+                removed.append(database);
+                removedNames.push_back(database->name());
+            }
+        }
 
-        for (auto const& dbname : event->databaseNames) 
-            addDatabase(new MongoDatabase(this, dbname));
+        QList<MongoDatabase *> databases, added;
+        for (auto const& dbname : event->databaseNames) {
+            auto const it = known.find(dbname);
+            MongoDatabase *database = it == known.end() ? nullptr : it->second;
+            if (!database) {
+                database = new MongoDatabase(this, dbname);
+                added.append(database);
+            }
+            databases.append(database);
+        }
+        _databases = databases;
+        MetadataSnapshot::instance().retainDatabases(_connSettings->uuid(), event->databaseNames);
 
-        _bus->publish(new DatabaseListLoadedEvent(this, _databases));
+        // Removed databases are deleted only after their explorer items
+        _bus->publish(new DatabaseListLoadedEvent(this, _databases, added, removedNames));
+        qDeleteAll(removed);
         LOG_MSG("Database list refreshed. Connection: " + _connSettings->connectionName(), 
                  mongo::logger::LogSeverity::Info());
     }
@@ -278,6 +660,23 @@ namespace Robomongo {
         }
     }
 
+    void MongoServer::handle(InsertDocumentsResponse *event) 
+    {
+        int const inserted = event->insertedCount();
+        if (inserted > 0)
+            LOG_MSG(std::to_string(inserted) + " documents inserted.", mongo::logger::LogSeverity::Info());
+
+        // Errors are reported the same way as for single document
+        if (event->isError()) {
+            InsertDocumentResponse response(this, event->error());
+            handle(&response);
+        }
+
+        // Notifier refreshes its view, also when only part of documents was written
+        if (inserted > 0)
+            _bus->publish(new InsertDocumentResponse(this));
+    }
+
     void MongoServer::handle(RemoveDocumentResponse *event) 
     {        
         if (event->removeCount == RemoveDocumentCount::MULTI && event->index > 0)
@@ -306,13 +705,490 @@ namespace Robomongo {
         }
     }
 
+    void MongoServer::handle(RemoveDocumentsByIdResponse *event) 
+    {
+        int const removed = event->removedCount();
+
+        if (event->isError()) {
+            hideProgressBar();
+            if (_connSettings->isReplicaSet() &&
+                EventError::SetPrimaryUnreachable == event->error().errorCode()) {
+                auto refreshEvent = ReplicaSetRefreshed(this, event->error(), event->error().replicaSetInfo());
+                handle(&refreshEvent);
+            }
+            genericEventErrorHandler(event, "Failed to remove documents.", _bus, this);
+        }
+
+        // Published also on partial failure, so that views refresh removed documents
+        _bus->publish(new RemoveDocumentsByIdResponse(this, event->error(), event->chunks));
+        if (removed > 0)
+            LOG_MSG("Removed " + std::to_string(removed) + " documents.", mongo::logger::LogSeverity::Info());
+    }
+
+    void MongoServer::handle(ExportProgressEvent *event)
+    {
+        _bus->publish(new ExportProgressEvent(this, event->exportId, event->documents, event->bytes,
+                                              event->elapsedMs));
+    }
+
+    void MongoServer::handle(ExportDocumentsResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Export failed: " + event->error().errorMessage(), mongo::logger::LogSeverity::Error());
+            _bus->publish(new ExportDocumentsResponse(this, event->exportId, event->error()));
+            return;
+        }
+
+        LOG_MSG("Exported " + std::to_string(event->documents) + " documents.", 
+                mongo::logger::LogSeverity::Info());
+        _bus->publish(new ExportDocumentsResponse(this, event->exportId, event->documents, event->bytes,
+                                                  event->elapsedMs));
+    }
+
+    void MongoServer::handle(ImportProgressEvent *event)
+    {
+        _bus->publish(new ImportProgressEvent(this, event->importId, event->inserted, event->failed,
+                                              event->bytesRead, event->fileSize, event->elapsedMs, 
+                                              event->throttleMs));
+    }
+
+    void MongoServer::handle(ImportDocumentsResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Import failed: " + event->error().errorMessage(), mongo::logger::LogSeverity::Error());
+            _bus->publish(new ImportDocumentsResponse(this, event->importId, event->inserted, event->failed,
+                                                      event->error()));
+            return;
+        }
+
+        LOG_MSG("Imported " + std::to_string(event->inserted) + " documents" +
+                (event->failed ? ", " + std::to_string(event->failed) + " failed." : "."),
+                mongo::logger::LogSeverity::Info());
+        _bus->publish(new ImportDocumentsResponse(this, event->importId, event->inserted, event->failed,
+                                                  event->elapsedMs, event->errors));
+    }
+
+    void MongoServer::handle(DatabaseStatsProgressEvent *event)
+    {
+        _bus->publish(new DatabaseStatsProgressEvent(this, event->statsId, event->collections, 
+                                                     event->done, event->total));
+    }
+
+    void MongoServer::handle(DatabaseStatsResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Failed to read database statistics: " + event->error().errorMessage(), 
+                    mongo::logger::LogSeverity::Error());
+            _bus->publish(new DatabaseStatsResponse(this, event->statsId, event->error()));
+            return;
+        }
+
+        _bus->publish(new DatabaseStatsResponse(this, event->statsId, event->databaseStats, 
+                                                event->skipped, event->elapsedMs));
+    }
+
+    void MongoServer::handle(DatabaseSearchProgressEvent *event)
+    {
+        _bus->publish(new DatabaseSearchProgressEvent(this, event->searchId, event->hits, event->finished,
+                                                      event->started, event->total));
+    }
+
+    void MongoServer::handle(DatabaseSearchResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Failed to search database: " + event->error().errorMessage(),
+                    mongo::logger::LogSeverity::Error());
+            _bus->publish(new DatabaseSearchResponse(this, event->searchId, event->error()));
+            return;
+        }
+
+        _bus->publish(new DatabaseSearchResponse(this, event->searchId, event->hits, event->elapsedMs));
+    }
+
+    void MongoServer::handle(CollectionMaintenanceProgressEvent *event)
+    {
+        _bus->publish(new CollectionMaintenanceProgressEvent(this, event->runId, event->started, event->finished));
+    }
+
+    void MongoServer::handle(CollectionMaintenanceResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Failed to run action on collections: " + event->error().errorMessage(),
+                    mongo::logger::LogSeverity::Error());
+            _bus->publish(new CollectionMaintenanceResponse(this, event->runId, event->error()));
+            return;
+        }
+
+        _bus->publish(new CollectionMaintenanceResponse(this, event->runId, event->succeeded, event->failed,
+                                                        event->elapsedMs));
+    }
+
+    void MongoServer::handle(AnalyzeSchemaProgressEvent *event)
+    {
+        _bus->publish(new AnalyzeSchemaProgressEvent(this, event->analysisId, event->analyzed, 
+                                                     event->sampleSize));
+    }
+
+    void MongoServer::handle(AnalyzeSchemaResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Failed to analyze schema: " + event->error().errorMessage(), 
+                    mongo::logger::LogSeverity::Error());
+            _bus->publish(new AnalyzeSchemaResponse(this, event->analysisId, event->error()));
+            return;
+        }
+
+        // Response is delivered to this server only, so fields are moved instead of copied
+        _bus->publish(new AnalyzeSchemaResponse(this, event->analysisId, std::move(event->fields), 
+                                                event->documents, event->droppedPaths, event->elapsedMs));
+    }
+
+    void MongoServer::handle(CommitChangesetResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Failed to save edited documents: " + event->error().errorMessage(),
+                    mongo::logger::LogSeverity::Error());
+            _bus->publish(new CommitChangesetResponse(this, event->changesetId, event->error()));
+            return;
+        }
+
+        _bus->publish(new CommitChangesetResponse(this, event->changesetId, event->result));
+    }
+
+    void MongoServer::handle(DocumentSizesResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Failed to read document sizes: " + event->error().errorMessage(),
+                    mongo::logger::LogSeverity::Error());
+            _bus->publish(new DocumentSizesResponse(this, event->sizesId, event->error()));
+            return;
+        }
+
+        _bus->publish(new DocumentSizesResponse(this, event->sizesId, event->histogram, event->serverSide,
+                                                event->elapsedMs));
+    }
+
+    void MongoServer::handle(GenerateDataProgressEvent *event)
+    {
+        _bus->publish(new GenerateDataProgressEvent(this, event->generateId, event->stats));
+    }
+
+    void MongoServer::handle(GenerateDataResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Failed to generate documents: " + event->error().errorMessage(),
+                    mongo::logger::LogSeverity::Error());
+            _bus->publish(new GenerateDataResponse(this, event->generateId, event->error()));
+            return;
+        }
+
+        _bus->publish(new GenerateDataResponse(this, event->generateId, event->stats));
+    }
+
+    void MongoServer::handle(ThrottledWriteProgressEvent *event)
+    {
+        _bus->publish(new ThrottledWriteProgressEvent(this, event->writeId, event->progress));
+    }
+
+    void MongoServer::handle(ThrottledWriteResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Failed to remove or update documents in chunks: " + event->error().errorMessage(),
+                    mongo::logger::LogSeverity::Error());
+            _bus->publish(new ThrottledWriteResponse(this, event->writeId, event->error(), event->progress));
+            return;
+        }
+
+        _bus->publish(new ThrottledWriteResponse(this, event->writeId, event->progress));
+    }
+
+    void MongoServer::handle(ReplayWorkloadProgressEvent *event)
+    {
+        _bus->publish(new ReplayWorkloadProgressEvent(this, event->replayId, event->replayed, event->total,
+                                                      event->errors, event->elapsedMs));
+    }
+
+    void MongoServer::handle(ReplayWorkloadResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Failed to replay workload: " + event->error().errorMessage(),
+                    mongo::logger::LogSeverity::Error());
+            _bus->publish(new ReplayWorkloadResponse(this, event->replayId, event->error()));
+            return;
+        }
+
+        _bus->publish(new ReplayWorkloadResponse(this, event->replayId, event->result));
+    }
+
+    void MongoServer::handle(CompareCollectionsProgressEvent *event)
+    {
+        _bus->publish(new CompareCollectionsProgressEvent(this, event->compareId, event->rangesCompared,
+                                                          event->ranges, event->mismatchedRanges));
+    }
+
+    void MongoServer::handle(CompareCollectionsResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Failed to compare collections: " + event->error().errorMessage(),
+                    mongo::logger::LogSeverity::Error());
+            _bus->publish(new CompareCollectionsResponse(this, event->compareId, event->error()));
+            return;
+        }
+
+        _bus->publish(new CompareCollectionsResponse(this, event->compareId, event->result, event->elapsedMs));
+    }
+
+    void MongoServer::handle(CurrentOpsResponse *event)
+    {
+        if (event->isError()) {
+            _bus->publish(new CurrentOpsResponse(this, event->monitorId, event->error()));
+            return;
+        }
+
+        _bus->publish(new CurrentOpsResponse(this, event->monitorId, event->ops, event->elapsedMs));
+    }
+
+    void MongoServer::handle(KillOpResponse *event)
+    {
+        _bus->publish(new KillOpResponse(this, event->monitorId, event->killed, event->errors));
+    }
+
+    void MongoServer::handle(ServerStatusResponse *event)
+    {
+        if (event->isError()) {
+            _bus->publish(new ServerStatusResponse(this, event->monitorId, event->error()));
+            return;
+        }
+
+        _bus->publish(new ServerStatusResponse(this, event->monitorId, event->status));
+    }
+
+    void MongoServer::handle(ProfileSummaryResponse *event)
+    {
+        if (event->isError()) {
+            _bus->publish(new ProfileSummaryResponse(this, event->summaryId, event->error()));
+            return;
+        }
+
+        _bus->publish(new ProfileSummaryResponse(this, event->summaryId, event->shapes, 
+                                                 event->profilingLevel, event->slowMs, event->elapsedMs));
+    }
+
+    void MongoServer::handle(PlanCacheResponse *event)
+    {
+        if (event->isError()) {
+            _bus->publish(new PlanCacheResponse(this, event->cacheId, event->error()));
+            return;
+        }
+
+        _bus->publish(new PlanCacheResponse(this, event->cacheId, event->entries, event->elapsedMs));
+    }
+
+    void MongoServer::handle(ShardDistributionResponse *event)
+    {
+        if (event->isError()) {
+            _bus->publish(new ShardDistributionResponse(this, event->distributionId, event->error()));
+            return;
+        }
+
+        _bus->publish(new ShardDistributionResponse(this, event->distributionId, event->snapshot, 
+                                                    event->elapsedMs));
+    }
+
+    void MongoServer::handle(GridFsFilesResponse *event)
+    {
+        if (event->isError()) {
+            _bus->publish(new GridFsFilesResponse(this, event->listId, event->error()));
+            return;
+        }
+
+        _bus->publish(new GridFsFilesResponse(this, event->listId, event->files, event->elapsedMs));
+    }
+
+    void MongoServer::handle(GridFsTransferProgressEvent *event)
+    {
+        _bus->publish(new GridFsTransferProgressEvent(this, event->transferId, event->bytes, event->total,
+                                                      event->elapsedMs));
+    }
+
+    void MongoServer::handle(GridFsTransferResponse *event)
+    {
+        if (event->isError()) {
+            _bus->publish(new GridFsTransferResponse(this, event->transferId, event->error()));
+            return;
+        }
+
+        _bus->publish(new GridFsTransferResponse(this, event->transferId, event->file, event->elapsedMs));
+    }
+
+    void MongoServer::handle(ExplainResponse *event)
+    {
+        if (event->isError()) {
+            _bus->publish(new ExplainResponse(this, event->explainId, event->error()));
+            return;
+        }
+
+        _bus->publish(new ExplainResponse(this, event->explainId, event->plan, event->explain, 
+                                          event->elapsedMs));
+    }
+
+    void MongoServer::handle(RollingIndexBuildProgressEvent *event)
+    {
+        _bus->publish(new RollingIndexBuildProgressEvent(this, event->newInfo, event->step, event->steps,
+                                                         event->description, event->done, event->total));
+    }
+
+    void MongoServer::handle(RollingIndexBuildResponse *event)
+    {
+        if (event->isError()) {
+            _bus->publish(new RollingIndexBuildResponse(this, event->oldInfo, event->newInfo, event->error()));
+            return;
+        }
+
+        _bus->publish(new RollingIndexBuildResponse(this, event->oldInfo, event->newInfo, event->elapsedMs));
+    }
+
+    void MongoServer::handle(ShardFanoutResponse *event)
+    {
+        if (event->isError()) {
+            _bus->publish(new ShardFanoutResponse(this, event->fanoutId, event->error()));
+            return;
+        }
+
+        _bus->publish(new ShardFanoutResponse(this, event->fanoutId, event->documents, event->shards,
+                                              event->elapsedMs));
+    }
+
+    void MongoServer::handle(NamespaceChangesEvent *event)
+    {
+        // Changes of the stream, which was closed already
+        if (!liveExplorer())
+            return;
+
+        for (auto const &change : event->changes) {
+            switch (change.kind) {
+            case NamespaceChanges::Change::CollectionCreated:
+                namespaceCreated(change.ns);
+                break;
+            case NamespaceChanges::Change::CollectionDropped:
+                if (MongoDatabase *database = findDatabase(change.ns.databaseName()))
+                    database->collectionDropped(change.ns.collectionName());
+                break;
+            case NamespaceChanges::Change::CollectionRenamed:
+                if (MongoDatabase *database = findDatabase(change.ns.databaseName()))
+                    database->collectionDropped(change.ns.collectionName());
+                namespaceCreated(change.to);
+                break;
+            case NamespaceChanges::Change::DatabaseDropped:
+                databaseDropped(change.ns.databaseName());
+                break;
+            }
+        }
+    }
+
+    void MongoServer::handle(WatchNamespaceChangesResponse *event)
+    {
+        if (!event->isError())
+            return;
+
+        // Standalone servers have no change streams
+        setLiveExplorer(false);
+        LOG_MSG("Live explorer updates stopped: " + event->error().errorMessage(), 
+                mongo::logger::LogSeverity::Warning());
+    }
+
+    void MongoServer::handle(OplogEntriesEvent *event)
+    {
+        _bus->publish(new OplogEntriesEvent(this, event->tailId, event->entries));
+    }
+
+    void MongoServer::handle(TailOplogResponse *event)
+    {
+        if (event->isError()) {
+            _bus->publish(new TailOplogResponse(this, event->tailId, event->error()));
+            return;
+        }
+
+        _bus->publish(new TailOplogResponse(this, event->tailId));
+    }
+
+    void MongoServer::handle(ChangeEventsEvent *event)
+    {
+        _bus->publish(new ChangeEventsEvent(this, event->watchId, event->events));
+    }
+
+    void MongoServer::handle(WatchCollectionResponse *event)
+    {
+        if (event->isError()) {
+            _bus->publish(new WatchCollectionResponse(this, event->watchId, event->error()));
+            return;
+        }
+
+        _bus->publish(new WatchCollectionResponse(this, event->watchId));
+    }
+
+    MongoDatabase *MongoServer::findDatabase(const std::string &name) const
+    {
+        for (MongoDatabase *database : _databases) {
+            if (database->name() == name)
+                return database;
+        }
+        return nullptr;
+    }
+
+    void MongoServer::namespaceCreated(const MongoNamespace &ns)
+    {
+        if (MongoDatabase *database = findDatabase(ns.databaseName())) {
+            database->collectionCreated(ns.collectionName());
+            return;
+        }
+
+        // Databases are listed by name, new one is inserted like a refresh would do
+        auto database = new MongoDatabase(this, ns.databaseName());
+        int index = 0;
+        while (index < _databases.count() && _databases[index]->name() < database->name())
+            ++index;
+        _databases.insert(index, database);
+        _bus->publish(new DatabaseListLoadedEvent(this, _databases, { database }));
+    }
+
+    void MongoServer::databaseDropped(const std::string &name)
+    {
+        MongoDatabase *database = findDatabase(name);
+        if (!database)
+            return;
+
+        _databases.removeOne(database);
+        std::vector<std::string> names;
+        for (MongoDatabase const *known : _databases)
+            names.push_back(known->name());
+        MetadataSnapshot::instance().retainDatabases(_connSettings->uuid(), names);
+
+        // Database is deleted only after its explorer item
+        _bus->publish(new DatabaseListLoadedEvent(this, _databases, QList<MongoDatabase *>(), { name }));
+        delete database;
+    }
+
     void MongoServer::runWorkerThread() 
     {
         _worker = new MongoWorker(_connSettings->clone(),
                                   AppRegistry::instance().settingsManager()->loadMongoRcJs(),
                                   AppRegistry::instance().settingsManager()->batchSize(),
                                   AppRegistry::instance().settingsManager()->mongoTimeoutSec(),
-                                  AppRegistry::instance().settingsManager()->shellTimeoutSec());
+                                  AppRegistry::instance().settingsManager()->shellTimeoutSec(),
+                                  AppRegistry::instance().settingsManager()->shellResultMemoryBudgetMb(),
+                                  AppRegistry::instance().settingsManager()->jsHeapLimitMb(),
+                                  AppRegistry::instance().settingsManager()->scopePoolSize());
+
+        _metadataWorker = new MongoWorker(_connSettings->clone(),
+                                          false,
+                                          AppRegistry::instance().settingsManager()->batchSize(),
+                                          AppRegistry::instance().settingsManager()->mongoTimeoutSec(),
+                                          AppRegistry::instance().settingsManager()->shellTimeoutSec(),
+                                          AppRegistry::instance().settingsManager()->shellResultMemoryBudgetMb(),
+                                          0,
+                                          0,
+                                          false);
     }
 
     void MongoServer::handle(CreateDatabaseResponse *event) 
@@ -358,13 +1234,17 @@ namespace Robomongo {
     }
 
     void MongoServer::handleReplicaSetRefreshEvents(bool isError, EventError eventError, 
-                                                    ReplicaSet const& replicaSet, bool expanded)
+                                                    ReplicaSet const& replicaSet, bool expanded,
+                                                    bool monitor /*= false*/)
     {
+        _topologyUpdatedAt = QDateTime::currentDateTimeUtc();
+
         if (isError) { // Primary is unreachable
             _replicaSetInfo.reset(new ReplicaSet(replicaSet));
             LOG_MSG("Replica set folder refreshed with error. " + eventError.errorMessage() +
                     ". Connection: " + _connSettings->connectionName(), mongo::logger::LogSeverity::Error());
-            _bus->publish(new ReplicaSetFolderRefreshed(this, eventError, true));
+            // Do not pop up the folder when change is found by background monitor
+            _bus->publish(new ReplicaSetFolderRefreshed(this, eventError, !monitor || expanded));
             return;
         }
 
@@ -373,8 +1253,9 @@ namespace Robomongo {
         _replicaSetInfo.reset(new ReplicaSet(replicaSet));
         _connSettings->setServerHost(_replicaSetInfo->primary.host());
         _connSettings->setServerPort(_replicaSetInfo->primary.port());
-        _connSettings->replicaSetSettings()->setCachedSetName(
-            _connSettings->replicaSetSettings()->setNameUserEntered().empty() ? _replicaSetInfo->setName : "");
+        _connSettings->replicaSetSettings()->setCachedTopology(
+            _connSettings->replicaSetSettings()->setNameUserEntered().empty() ? _replicaSetInfo->setName : "",
+            _replicaSetInfo->primary.toString());
 
         LOG_MSG("Replica set folder refreshed. Connection: " + _connSettings->connectionName(),
                  mongo::logger::LogSeverity::Info());
@@ -389,8 +1270,9 @@ namespace Robomongo {
         _replicaSetInfo.reset(new ReplicaSet(event->replicaSet));
         _connSettings->setServerHost(_replicaSetInfo->primary.host());
         _connSettings->setServerPort(_replicaSetInfo->primary.port());
-        _connSettings->replicaSetSettings()->setCachedSetName(
-            _connSettings->replicaSetSettings()->setNameUserEntered().empty() ? _replicaSetInfo->setName : "");
+        _connSettings->replicaSetSettings()->setCachedTopology(
+            _connSettings->replicaSetSettings()->setNameUserEntered().empty() ? _replicaSetInfo->setName : "",
+            _replicaSetInfo->primary.toString());
 
         if (_connSettings->replicaSetSettings()->setNameUserEntered().empty()) {
             // Cache replica set name for 2 times faster first connection 
@@ -399,7 +1281,8 @@ namespace Robomongo {
                     ->getConnectionSettingsByUuid(event->info._uuid);
                 if (originalConnSettings) {
                     auto setName = event->isError() ? "" : _replicaSetInfo->setName;
-                    originalConnSettings->replicaSetSettings()->setCachedSetName(setName);
+                    originalConnSettings->replicaSetSettings()->setCachedTopology(
+                        setName, _replicaSetInfo->primary.toString());
                     AppRegistry::instance().settingsManager()->save();
                     LOG_MSG("Replica set name cached as \"" + setName + "\".", mongo::logger::LogSeverity::Info());
                 }
@@ -1,8 +1,10 @@
 #pragma once
 #include <QObject>
+#include <QDateTime>
 
 #include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/RttHistogram.h"
 
 namespace Robomongo
 {
@@ -29,6 +31,9 @@ namespace Robomongo
         Q_OBJECT
 
     public:
+        // Default size of one batch of insertDocuments()/saveDocuments()
+        static const int DefaultBatchBytesLimit = 4 * 1024 * 1024;
+
         /**
          * @brief MongoServer
          * @param connectionRecord: MongoServer will own this ConnectionSettings.
@@ -72,6 +77,12 @@ namespace Robomongo
         */
         void tryRefreshReplicaSetFolder(bool expanded, bool showLoading = true);
 
+        /**
+        * @brief Shows 'Replica Set' folder as expanded. Topology kept up to date by background 
+        *        monitor is used if it is fresh enough, otherwise falls back to tryRefreshReplicaSetFolder().
+        */
+        void expandReplicaSetFolder();
+
         bool isConnected() const;
 
         void addDatabase(MongoDatabase *database);
@@ -81,12 +92,211 @@ namespace Robomongo
         QList<MongoDatabase*> const& databases() const { return _databases; };
         MongoDatabase *findDatabaseByName(const std::string &dbName) const;
 
-        void insertDocuments(const std::vector<mongo::BSONObj> &objCont, const MongoNamespace &ns);
+        /**
+         * @brief Inserts (saves) all documents with one request, see InsertDocumentsRequest
+         */
+        void insertDocuments(const std::vector<mongo::BSONObj> &objCont, const MongoNamespace &ns,
+                             int batchBytesLimit = DefaultBatchBytesLimit);
         void insertDocument(const mongo::BSONObj &obj, const MongoNamespace &ns);
-        void saveDocuments(const std::vector<mongo::BSONObj> &objCont, const MongoNamespace &ns);
+        void saveDocuments(const std::vector<mongo::BSONObj> &objCont, const MongoNamespace &ns,
+                           int batchBytesLimit = DefaultBatchBytesLimit);
         void saveDocument(const mongo::BSONObj &obj, const MongoNamespace &ns);
+
+        /**
+         * @brief Saves edited document with update of changed fields only, which fails if
+         *        they were changed since 'original' was loaded
+         */
+        void updateDocument(const mongo::BSONObj &original, const mongo::BSONObj &edited,
+                            const MongoNamespace &ns);
+
+        /**
+         * @brief Saves edited cells of table view in worker() (see TableChangeset).
+         *        CommitChangesetResponse is published with 'changesetId'.
+         */
+        void commitChangeset(int changesetId, const MongoNamespace &ns,
+                             const std::vector<TableChangeset::Statement> &statements);
         void removeDocuments(mongo::Query query, const MongoNamespace &ns, RemoveDocumentCount removeCount, 
                              int index = 0);
+
+        /**
+         * @brief Removes documents by _id with one request (see RemoveDocumentsByIdRequest)
+         * @param ids Objects of form { _id : <value> }
+         */
+        void removeDocuments(const std::vector<mongo::BSONObj> &ids, const MongoNamespace &ns);
+
+        /**
+         * @brief Exports documents of query to file in worker(), so that explorer stays responsive.
+         *        ExportProgressEvent and ExportDocumentsResponse are published with 'exportId'.
+         * @param cancelled Set to true to stop export, file is not created then
+         */
+        void exportDocuments(int exportId, const MongoQueryInfo &queryInfo, const ExportOptions &options,
+                             const QString &filePath, const std::shared_ptr<std::atomic<bool>> &cancelled);
+
+        /**
+         * @brief Inserts documents of file into collection 'ns' in worker(). ImportProgressEvent
+         *        and ImportDocumentsResponse are published with 'importId'.
+         * @param cancelled Set to true to stop import, documents inserted until then are kept
+         */
+        void importDocuments(int importId, const MongoNamespace &ns, const QString &filePath,
+                             const ImportOptions &options, const std::shared_ptr<std::atomic<bool>> &cancelled);
+
+        /**
+         * @brief Reads dbStats and collStats of all collections of database in worker().
+         *        DatabaseStatsProgressEvent (with collections read so far) and DatabaseStatsResponse
+         *        are published with 'statsId'.
+         * @param cancelled Set to true to stop, collections read until then are kept
+         * @param indexDetails Adds cache and storage statistics of every index to collStats
+         */
+        void databaseStats(int statsId, const std::string &dbName, const std::shared_ptr<std::atomic<bool>> &cancelled,
+                           bool indexDetails = false);
+
+        /**
+         * @brief Searches value in all collections of database in worker(), see DatabaseSearch.
+         *        DatabaseSearchProgressEvent (with hits found so far) and DatabaseSearchResponse
+         *        are published with 'searchId'.
+         */
+        void searchDatabase(int searchId, const std::string &dbName, const DatabaseSearch::Options &options,
+                            const std::shared_ptr<DatabaseSearch::Cancellation> &cancellation);
+
+        /**
+         * @brief Runs 'action' on 'collections' of database in worker(), see CollectionMaintenance.
+         *        CollectionMaintenanceProgressEvent (with collections finished so far) and
+         *        CollectionMaintenanceResponse are published with 'runId'.
+         */
+        void maintainCollections(int runId, const std::string &dbName, const std::vector<std::string> &collections,
+                                 const CollectionMaintenance::Action &action,
+                                 const std::shared_ptr<std::atomic<bool>> &cancelled);
+
+        /**
+         * @brief Analyzes fields of 'sampleSize' random documents of collection in worker()
+         *        (see SchemaAnalyzer). AnalyzeSchemaProgressEvent and AnalyzeSchemaResponse are
+         *        published with 'analysisId'.
+         * @param cancelled Set to true to stop, nothing is published after that
+         */
+        void analyzeSchema(int analysisId, const MongoNamespace &ns, int sampleSize,
+                           const std::shared_ptr<std::atomic<bool>> &cancelled);
+
+        /**
+         * @brief Builds histogram of document sizes of collection (see DocumentSizeHistogram)
+         *        in worker(). DocumentSizesResponse is published with 'sizesId'.
+         * @param sampleSize Documents of $sample, 0 for whole collection
+         * @param cancelled Set to true to stop, nothing is published after that
+         */
+        void documentSizes(int sizesId, const MongoNamespace &ns, int sampleSize, int topCount,
+                           const std::shared_ptr<std::atomic<bool>> &cancelled);
+
+        /**
+         * @brief Inserts 'documents' synthetic documents shaped like 'sample' (see DataGenerator)
+         *        in worker(). GenerateDataProgressEvent and GenerateDataResponse are published
+         *        with 'generateId'.
+         * @param sample Empty to take first of 'sampleSize' documents analyzed in collection
+         * @param cancelled Set to true to stop, GenerateDataResponse is still published
+         */
+        void generateData(int generateId, const MongoNamespace &ns, const mongo::BSONObj &sample, int sampleSize,
+                          long long documents, int rate, int threads,
+                          const std::shared_ptr<std::atomic<bool>> &cancelled);
+
+        /**
+         * @brief Removes (or updates with 'update', if it is not empty) documents matching
+         *        'filter' by chunks of _id ranges throttled by replication lag (see
+         *        ThrottledWrite) in worker(). ThrottledWriteProgressEvent and
+         *        ThrottledWriteResponse are published with 'writeId'.
+         * @param cancelled Set to true to stop, ThrottledWriteResponse is still published
+         * @param paused Set to true to pause before the next chunk, reset to resume
+         */
+        void throttledWrite(int writeId, const MongoNamespace &ns, const mongo::BSONObj &filter,
+                            const mongo::BSONObj &update, long long maxLagMs,
+                            const std::shared_ptr<std::atomic<bool>> &cancelled,
+                            const std::shared_ptr<std::atomic<bool>> &paused);
+
+        /**
+         * @brief Replays operations captured in system.profile of 'profileDatabase' or in
+         *        'logFile' (see WorkloadReplay) in worker(). ReplayWorkloadProgressEvent and
+         *        ReplayWorkloadResponse are published with 'replayId'.
+         * @param cancelled Set to true to stop, ReplayWorkloadResponse is still published
+         */
+        void replayWorkload(int replayId, const std::string &profileDatabase, const std::string &logFile,
+                            long long sinceMs, const std::string &targetDatabase, double speed, int threads,
+                            const std::shared_ptr<std::atomic<bool>> &cancelled);
+
+        /**
+         * @brief Compares collection 'source' of this server with 'target' of 'targetServer'
+         *        (may be this one) in worker(). CompareCollectionsProgressEvent and
+         *        CompareCollectionsResponse are published with 'compareId'.
+         * @param cancelled Set to true to stop, nothing is published after that
+         */
+        void compareCollections(int compareId, const MongoNamespace &source, MongoServer *targetServer,
+                                const MongoNamespace &target, const std::shared_ptr<std::atomic<bool>> &cancelled);
+
+        /**
+         * @brief Lists operations matching 'filter' (at most 'limit') and kills operations in
+         *        metadataWorker(), so that monitor is not blocked by scripts of worker().
+         *        CurrentOpsResponse and KillOpResponse are published with 'monitorId'.
+         * @param opids Objects of form { op: <opid> }
+         */
+        void currentOps(int monitorId, const mongo::BSONObj &filter, int limit);
+        void killOps(int monitorId, const std::vector<mongo::BSONObj> &opids);
+
+        /**
+         * @brief Samples serverStatus in metadataWorker(), ServerStatusResponse is published
+         *        with 'monitorId'
+         */
+        void sampleServerStatus(int monitorId);
+
+        /**
+         * @brief Reads system.profile of database grouped by query shape in worker(), as
+         *        grouping may take long. ProfileSummaryResponse is published with 'summaryId'.
+         */
+        void profileSummary(int summaryId, const std::string &dbName, long long sinceMs, int minMillis, int limit);
+
+        /**
+         * @brief Reads plan cache of collection in metadataWorker(), so that polling is not
+         *        blocked by scripts. PlanCacheResponse is published with 'cacheId'.
+         */
+        void planCacheStats(int cacheId, const MongoNamespace &ns, int limit);
+
+        /**
+         * @brief Reads chunk distribution of sharded collection in metadataWorker().
+         *        ShardDistributionResponse is published with 'distributionId'.
+         */
+        void shardDistribution(int distributionId, const MongoNamespace &ns, long long sinceMs);
+
+        /**
+         * @brief Lists files of GridFS bucket in worker(). GridFsFilesResponse is published
+         *        with 'listId'.
+         */
+        void gridFsFiles(int listId, const std::string &dbName, const std::string &bucket,
+                         const std::string &filename, int limit);
+
+        /**
+         * @brief Downloads or uploads GridFS file in worker(). GridFsTransferProgressEvent and
+         *        GridFsTransferResponse are published with 'transferId'.
+         * @param cancelled Set to true to stop, partial download or upload is removed
+         */
+        void gridFsTransfer(int transferId, GridFsTransferRequest::Direction direction, const std::string &dbName,
+                            const std::string &bucket, const GridFs::FileInfo &file, const QString &filePath,
+                            const std::shared_ptr<std::atomic<bool>> &cancelled);
+
+        /**
+         * @brief Explains find or aggregate command in worker(), as winning plan is executed.
+         *        ExplainResponse is published with 'explainId'.
+         */
+        void explain(int explainId, const std::string &dbName, const mongo::BSONObj &command);
+
+        /**
+         * @brief Queries every shard of collection directly in worker() (see ShardFanout),
+         *        ShardFanoutResponse is published with 'fanoutId'
+         */
+        void shardFanout(int fanoutId, const MongoNamespace &ns, const mongo::BSONObj &filter, 
+                         const mongo::BSONObj &projection, const mongo::BSONObj &sort, int limit, 
+                         bool readFromSecondaries);
+
+        /**
+         * @brief Adds or edits index with steps of RollingIndexBuild in indexBuildWorker(), so
+         *        that neither shell nor explorer wait for the build. RollingIndexBuildProgressEvent
+         *        and RollingIndexBuildResponse are published.
+         */
+        void rollingIndexBuild(const IndexInfo &oldInfo, const IndexInfo &newInfo);
         float version() const{ return _version; }
         const std::string& getStorageEngineType() const { return _storageEngineType; }
 
@@ -95,36 +305,142 @@ namespace Robomongo
          */
         ConnectionSettings *connectionRecord() const;
 
+        // Unique for the session, see App::getLastServerHandle()
+        int handle() const { return _handle; }
+
         /**
          * @brief Loads databases of this server asynchronously.
          */
         void loadDatabases();
         MongoWorker *const worker() const { return _worker; }
 
+        /**
+         * @brief Worker for cheap explorer requests (database/collection names, indexes, users).
+         *        It has its own thread and connection, so these requests are not
+         *        blocked by long running scripts of worker(). Falls back to worker(), if
+         *        metadata connection is not established.
+         */
+        MongoWorker *metadataWorker() const;
+
+        /**
+         * @brief Worker for index builds, which may take hours. It is created and connected on
+         *        first build, builds of all collections of server wait for each other in it.
+         */
+        MongoWorker *indexBuildWorker();
+
+        /**
+         * @brief Follows creation, drop and rename of collections and databases of the whole
+         *        deployment with change stream (see NamespaceChanges) in its own worker, and
+         *        applies them to loaded databases like a refresh. Needs replica set or sharded
+         *        cluster; stream is closed on error and warning is logged.
+         */
+        void setLiveExplorer(bool enabled);
+        bool liveExplorer() const { return _liveExplorerCancelled != nullptr; }
+
+        /**
+         * @brief Tails oplog of replica set member in its own worker, so that panel is not
+         *        blocked by other requests. OplogEntriesEvent and TailOplogResponse are
+         *        published with 'tailId'.
+         * @param cancelled Set to true to close the cursor, tails of the server wait for each other
+         */
+        void tailOplog(int tailId, const OplogTail::Filter &filter, const std::shared_ptr<std::atomic<bool>> &cancelled);
+
+        /**
+         * @brief Watches change stream of collection in the worker of streams, so that panel is
+         *        not blocked by other requests. ChangeEventsEvent and WatchCollectionResponse are
+         *        published with 'watchId'.
+         * @param cancelled Set to true to close the stream
+         */
+        void watchCollection(int watchId, const MongoNamespace &ns, const ChangeStreamWatch::Filter &filter,
+                             const std::shared_ptr<std::atomic<bool>> &cancelled);
+
         ReplicaSet* replicaSetInfo() const { return _replicaSetInfo.get(); }
 
+        /**
+         * @brief Round trip times of periodic health checks, see handle(PingServerResponse*)
+         */
+        RttHistogram const& rttHistogram() const { return _rttHistogram; }
+
         void handle(ReplicaSetRefreshed *event);
 
         void changeWorkerShellTimeout(int newTimeout);
 
+    protected:
+        void timerEvent(QTimerEvent *event) override;
+
     protected Q_SLOTS:
         void handle(EstablishConnectionResponse *event);
         void handle(RefreshReplicaSetFolderResponse *event);
+        void handle(PingServerResponse *event);
         void handle(LoadDatabaseNamesResponse *event);
         void handle(InsertDocumentResponse *event);
+        void handle(InsertDocumentsResponse *event);
+        void handle(CommitChangesetResponse *event);
         void handle(RemoveDocumentResponse *event);
+        void handle(RemoveDocumentsByIdResponse *event);
+        void handle(ExportProgressEvent *event);
+        void handle(ExportDocumentsResponse *event);
+        void handle(ImportProgressEvent *event);
+        void handle(ImportDocumentsResponse *event);
+        void handle(DatabaseStatsProgressEvent *event);
+        void handle(DatabaseStatsResponse *event);
+        void handle(DatabaseSearchProgressEvent *event);
+        void handle(DatabaseSearchResponse *event);
+        void handle(CollectionMaintenanceProgressEvent *event);
+        void handle(CollectionMaintenanceResponse *event);
+        void handle(AnalyzeSchemaProgressEvent *event);
+        void handle(AnalyzeSchemaResponse *event);
+        void handle(DocumentSizesResponse *event);
+        void handle(GenerateDataProgressEvent *event);
+        void handle(GenerateDataResponse *event);
+        void handle(ReplayWorkloadProgressEvent *event);
+        void handle(ReplayWorkloadResponse *event);
+        void handle(ThrottledWriteProgressEvent *event);
+        void handle(ThrottledWriteResponse *event);
+        void handle(CompareCollectionsProgressEvent *event);
+        void handle(CompareCollectionsResponse *event);
+        void handle(CurrentOpsResponse *event);
+        void handle(KillOpResponse *event);
+        void handle(ServerStatusResponse *event);
+        void handle(ProfileSummaryResponse *event);
+        void handle(PlanCacheResponse *event);
+        void handle(ShardDistributionResponse *event);
+        void handle(GridFsFilesResponse *event);
+        void handle(GridFsTransferProgressEvent *event);
+        void handle(GridFsTransferResponse *event);
+        void handle(ExplainResponse *event);
+        void handle(RollingIndexBuildProgressEvent *event);
+        void handle(RollingIndexBuildResponse *event);
+        void handle(ShardFanoutResponse *event);
+        void handle(NamespaceChangesEvent *event);
+        void handle(WatchNamespaceChangesResponse *event);
+        void handle(OplogEntriesEvent *event);
+        void handle(TailOplogResponse *event);
+        void handle(ChangeEventsEvent *event);
+        void handle(WatchCollectionResponse *event);
         void handle(CreateDatabaseResponse *event);
         void handle(DropDatabaseResponse *event);
 
     private:                 
         void clearDatabases();
         void handleReplicaSetRefreshEvents(bool isError, EventError eventError, ReplicaSet const& replicaSet,
-                                           bool expanded);
+                                           bool expanded, bool monitor = false);
         void updateReplicaSetSettings(EstablishConnectionResponse* event);
         void handleConnectionFailure(EstablishConnectionResponse* event);
         void hideProgressBar() const;
+        void startTopologyMonitor();
+        void stopTopologyMonitor();
+        MongoWorker *changeStreamWorker();
+        MongoDatabase *findDatabase(const std::string &name) const;
+        void namespaceCreated(const MongoNamespace &ns);
+        void databaseDropped(const std::string &name);
 
         MongoWorker *_worker;
+        MongoWorker *_metadataWorker;
+        MongoWorker *_indexBuildWorker;
+        MongoWorker *_changeStreamWorker;
+        std::shared_ptr<std::atomic<bool>> _liveExplorerCancelled;     // null, if live explorer is off
+        bool _isMetadataWorkerConnected;
         std::unique_ptr<ConnectionSettings> _connSettings;
         EventBus *_bus;
         App *_app;
@@ -137,6 +453,18 @@ namespace Robomongo
 
         QList<MongoDatabase *> _databases;
         std::unique_ptr<ReplicaSet> _replicaSetInfo;
+
+        // Background topology monitor of replica set, see startTopologyMonitor()
+        static int const TopologyMonitorIntervalMs = 15 * 1000;
+        int _topologyMonitorTimerId = -1;
+        QDateTime _topologyUpdatedAt;   // last time _replicaSetInfo was confirmed by server
+
+        // Health checks, run by metadata worker only, so they never wait behind user work
+        static int const HealthCheckIntervalMs = 30 * 1000;
+        static int const HealthCheckLogEvery = 20;   // pings, i.e. every 10 minutes
+        int _healthCheckTimerId = -1;
+        bool _lastHealthCheckFailed = false;
+        RttHistogram _rttHistogram;
     };
 
     class MongoServerLoadingDatabasesEvent : public Event
@@ -144,4 +472,13 @@ namespace Robomongo
         R_EVENT
         MongoServerLoadingDatabasesEvent(QObject *sender) : Event(sender) {}
     };
+
+    /**
+     * @brief Published after every health check, see MongoServer::rttHistogram()
+     */
+    class ServerHealthCheckedEvent : public Event
+    {
+        R_EVENT
+        ServerHealthCheckedEvent(QObject *sender) : Event(sender) {}
+    };
 }
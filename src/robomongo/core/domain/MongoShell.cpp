@@ -1,8 +1,13 @@
 #include "robomongo/core/domain/MongoShell.h"
 
+#include <algorithm>
+#include <QDateTime>
 #include "mongo/scripting/engine.h"
 
 #include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/MongoDatabase.h"
+#include "robomongo/core/domain/MongoCollection.h"
+#include "robomongo/core/domain/SchemaCache.h"
 #include "robomongo/core/mongodb/MongoWorker.h"
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/EventBus.h"
@@ -14,11 +19,37 @@ namespace Robomongo
 {  
     auto const& eventBus = []() { return AppRegistry::instance().bus(); };
 
+    namespace
+    {
+        // Field names of the first documents are enough for completion
+        size_t const MaxIndexedDocuments = 20;
+
+        std::vector<std::string> collectionNames(const std::vector<MongoCollection *> &collections)
+        {
+            std::vector<std::string> names;
+            names.reserve(collections.size());
+            for (MongoCollection const *collection : collections)
+                names.push_back(collection->name());
+            return names;
+        }
+    }
+
     MongoShell::MongoShell(MongoServer *server, ScriptInfo scriptInfo) :
         QObject(),
         _scriptInfo(scriptInfo),
-        _server(server)      
+        _server(server),
+        _currentDatabase(scriptInfo.dbname())
     {
+        // Explorer data loaded before this shell was opened
+        std::vector<std::string> databases;
+        for (MongoDatabase const *database : _server->databases()) {
+            databases.push_back(database->name());
+            _completionIndex.setCollections(database->name(), collectionNames(database->collections()));
+        }
+        _completionIndex.setDatabases(databases);
+
+        eventBus()->subscribe(this, DatabaseListLoadedEvent::Type, _server);
+        eventBus()->subscribe(this, MongoDatabaseCollectionListLoadedEvent::Type);
     }
 
     void MongoShell::open(const std::string &script, const std::string &dbName)
@@ -42,15 +73,125 @@ namespace Robomongo
 
         std::string const finalScript = script.empty() ? query() : script;
         eventBus()->publish(new ScriptExecutingEvent(this));
-        eventBus()->send(_server->worker(), 
-            new ExecuteScriptRequest(this, finalScript, dbName, _aggrInfo));
+        bool const profile = AppRegistry::instance().settingsManager()->profileQueries();
+
+        // Scripts re-run for pages of aggregation result are not new to history
+        _isHistoryPending = !_aggrInfo.isValid && !finalScript.empty();
+        if (_isHistoryPending) {
+            _pendingHistory = QueryHistoryEntry();
+            _pendingHistory.executedAt = QDateTime::currentSecsSinceEpoch();
+            _pendingHistory.database = dbName.empty() ? _currentDatabase : dbName;
+            _pendingHistory.script = finalScript;
+            _historyTimer.start();
+        }
+        bool const parallelReads = AppRegistry::instance().settingsManager()->parallelReads();
+        auto request = new ExecuteScriptRequest(this, finalScript, dbName, _aggrInfo, 0, 0, profile, _readPreference,
+                                                _maxTimeMs, parallelReads);
+        // Pages of aggregation run their own script
+        if (script.empty() && !_aggrInfo.isValid)
+            request->nativeQuery = _scriptInfo.nativeQuery();
+        eventBus()->send(_server->worker(), request);
         if (!_scriptInfo.script().isEmpty())
             LOG_MSG(_scriptInfo.script(), mongo::logger::LogSeverity::Info());
     }
 
-    void MongoShell::query(int resultIndex, const MongoQueryInfo &info)
+    void MongoShell::executeFile(const QString &filePath)
+    {
+        eventBus()->publish(new ScriptExecutingEvent(this));
+        eventBus()->send(_server->worker(), 
+                         new ExecuteScriptFileRequest(this, filePath, "", _readPreference, _maxTimeMs));
+        LOG_MSG("Running script file " + QtUtils::toStdString(filePath), mongo::logger::LogSeverity::Info());
+    }
+
+    void MongoShell::query(int resultIndex, const MongoQueryInfo &info, 
+                           unsigned long long cursorKey /* = 0 */)
     {
-        eventBus()->send(_server->worker(), new ExecuteQueryRequest(this, resultIndex, info));
+        MongoQueryInfo tabInfo = info;
+        tabInfo._readPreference = _readPreference;
+        tabInfo._maxTimeMs = _maxTimeMs;
+        eventBus()->send(_server->worker(), new ExecuteQueryRequest(this, resultIndex, tabInfo, cursorKey));
+    }
+
+    void MongoShell::prefetch(int resultIndex, const MongoQueryInfo &info, unsigned long long cursorKey)
+    {
+        MongoQueryInfo tabInfo = info;
+        tabInfo._readPreference = _readPreference;
+        tabInfo._maxTimeMs = _maxTimeMs;
+        eventBus()->send(_server->metadataWorker(), 
+                         new ExecuteQueryRequest(this, resultIndex, tabInfo, cursorKey, true));
+    }
+
+    void MongoShell::aggregatePage(int resultIndex, const AggrInfo &aggrInfo, unsigned long long cursorKey,
+                                   bool reread)
+    {
+        AggrInfo tabAggrInfo = aggrInfo;
+        tabAggrInfo.maxTimeMs = _maxTimeMs;
+        eventBus()->send(_server->worker(), 
+                         new AggregatePageRequest(this, resultIndex, tabAggrInfo, cursorKey, reread));
+    }
+
+    void MongoShell::previewPipeline(const AggrInfo &aggrInfo, int sampleSize)
+    {
+        AggrInfo tabAggrInfo = aggrInfo;
+        tabAggrInfo.maxTimeMs = _maxTimeMs;
+        eventBus()->send(_server->worker(), new PipelinePreviewRequest(this, tabAggrInfo, sampleSize));
+    }
+
+    void MongoShell::groupByField(const MongoQueryInfo &info, const std::string &field, int sampleSize)
+    {
+        // Grouping has its own limit, time limit of tab can only make it shorter
+        int const maxTimeMs = _maxTimeMs > 0 ? std::min<int>(_maxTimeMs, FieldDistribution::DefaultMaxTimeMs) :
+                                               FieldDistribution::DefaultMaxTimeMs;
+        eventBus()->send(_server->worker(), new FieldDistributionRequest(this, info, field, 
+            FieldDistribution::DefaultTopCount, sampleSize, maxTimeMs));
+    }
+
+    void MongoShell::bucketField(int bucketsId, const MongoQueryInfo &info, const std::string &field,
+                                 const FieldBuckets::Spec &spec)
+    {
+        int const maxTimeMs = _maxTimeMs > 0 ? std::min<int>(_maxTimeMs, FieldBuckets::DefaultMaxTimeMs) :
+                                               FieldBuckets::DefaultMaxTimeMs;
+        eventBus()->send(_server->worker(), new FieldBucketsRequest(this, bucketsId, info, field, spec, maxTimeMs));
+    }
+
+    void MongoShell::countDocuments(int resultIndex, const MongoQueryInfo &info)
+    {
+        // Count has its own limit, time limit of tab can only make it shorter
+        int const maxTimeMs = _maxTimeMs > 0 ? std::min<int>(_maxTimeMs, CountDocumentsRequest::DefaultMaxTimeMs) :
+                                               CountDocumentsRequest::DefaultMaxTimeMs;
+        eventBus()->send(_server->metadataWorker(), new CountDocumentsRequest(this, resultIndex, info, maxTimeMs));
+    }
+
+    QStringList MongoShell::complete(const std::string &prefix, const std::string &textBefore)
+    {
+        AutocompletionMode const mode = AppRegistry::instance().settingsManager()->autocompletionMode();
+        if (mode == AutocompleteNone)
+            return QStringList();
+
+        QStringList list;
+        std::string const collection = CompletionIndex::queriedCollection(textBefore);
+        if (!collection.empty()) {
+            std::string const key = _server->connectionRecord()->getFullAddress() + "/" + 
+                                    _currentDatabase + "." + collection;
+            SchemaCache &schemas = SchemaCache::instance();
+            if (CollectionSchema const *schema = schemas.find(key))
+                list = QtUtils::toQStringList(schema->complete(prefix));
+
+            if (schemas.startSampling(key)) {
+                eventBus()->send(_server->metadataWorker(), 
+                                 new SampleSchemaRequest(this, key, MongoNamespace(_currentDatabase, collection)));
+            }
+        }
+
+        std::string const line = textBefore.substr(textBefore.rfind('\n') + 1);
+        bool const afterUse = QtUtils::toQString(line).trimmed() == "use";
+        for (std::string const &completion : 
+             _completionIndex.complete(prefix, _currentDatabase, afterUse, mode == AutocompleteAll)) {
+            QString const name = QtUtils::toQString(completion);
+            if (!list.contains(name))
+                list.append(name);
+        }
+        return list;
     }
 
     void MongoShell::autocomplete(const std::string &prefix)
@@ -68,8 +209,14 @@ namespace Robomongo
 
     void MongoShell::stop()
     {
-        // _server->worker()->interrupt();
-        // mongo::Scope::setInterruptFlag(true);
+        MongoWorker *const worker = _server->worker();
+        worker->interrupt();    // stops script before its next statement
+
+        // Operation that is already running on server is killed through the other 
+        // (metadata) connection, busy worker cannot do it itself
+        std::vector<std::string> const clients = worker->activeClientAddresses();
+        if (!clients.empty())
+            eventBus()->send(_server->metadataWorker(), new KillOperationsRequest(this, clients));
     }
 
     bool MongoShell::loadFromFile()
@@ -89,22 +236,95 @@ namespace Robomongo
 
     void MongoShell::handle(ExecuteQueryResponse *event)
     {
+        if (event->prefetch) {
+            if (!event->isError())
+                eventBus()->publish(new PagePrefetchedEvent(this, event->resultIndex, event->queryInfo,
+                                                            event->documents));
+            return;
+        }
+
         if (event->isError()) {
             eventBus()->publish(new DocumentListLoadedEvent(this, event->error()));
             return;
         }
 
+        indexFields(event->documents);
         eventBus()->publish(
             new DocumentListLoadedEvent(this, 
-                event->resultIndex, event->queryInfo, query(), event->documents)
+                event->resultIndex, event->queryInfo, query(), event->documents,
+                event->batchIndex, event->lastBatch)
         );
     }
 
+    void MongoShell::handle(AggregatePageResponse *event)
+    {
+        if (event->isError()) {
+            eventBus()->publish(new AggregatePageResponse(this, event->resultIndex, event->error()));
+            return;
+        }
+
+        indexFields(event->documents);
+        eventBus()->publish(new AggregatePageResponse(this, event->resultIndex, event->aggrInfo, 
+                                                      event->documents));
+    }
+
+    void MongoShell::handle(PipelinePreviewResponse *event)
+    {
+        if (event->isError()) {
+            eventBus()->publish(new PipelinePreviewResponse(this, event->aggrInfo, event->error()));
+            return;
+        }
+
+        // Response is delivered to this shell only, so stages are moved instead of copied
+        eventBus()->publish(new PipelinePreviewResponse(this, event->aggrInfo, std::move(event->stages), 
+                                                        event->sampleSize, event->elapsedMs));
+    }
+
+    void MongoShell::handle(FieldDistributionResponse *event)
+    {
+        if (event->isError()) {
+            eventBus()->publish(new FieldDistributionResponse(this, event->queryInfo, event->error()));
+            return;
+        }
+
+        eventBus()->publish(new FieldDistributionResponse(this, event->queryInfo, std::move(event->result),
+                                                          event->sampleSize, event->elapsedMs));
+    }
+
+    void MongoShell::handle(FieldBucketsResponse *event)
+    {
+        if (event->isError()) {
+            eventBus()->publish(new FieldBucketsResponse(this, event->bucketsId, event->error()));
+            return;
+        }
+
+        eventBus()->publish(new FieldBucketsResponse(this, event->bucketsId, std::move(event->result),
+                                                     event->elapsedMs));
+    }
+
     void MongoShell::handle(ExecuteScriptResponse *event)
     {
+        if (_isHistoryPending) {
+            _isHistoryPending = false;
+            _pendingHistory.durationMs = _historyTimer.elapsed();
+            _pendingHistory.failed = event->isError() || event->result.error();
+            for (MongoShellResult const &result : event->result.results()) {
+                _pendingHistory.results += static_cast<long long>(result.documents().size());
+                if (result.explainInfo().isValid)
+                    _pendingHistory.serverMs = std::max(0LL, _pendingHistory.serverMs) + result.explainInfo().serverMs;
+            }
+            QueryHistory::append(_server->connectionRecord()->uuid(), _pendingHistory);
+        }
+
         if (!event->isError()) {
+            if (event->result.isCurrentDatabaseValid())
+                _currentDatabase = event->result.currentDatabase();
+            for (MongoShellResult const &result : event->result.results())
+                indexFields(result.documents());
+
+            // Response is delivered to this shell only, so result is moved instead of copied
             eventBus()->publish(
-                new ScriptExecutedEvent(this, event->result, event->empty, event->timeoutReached())
+                new ScriptExecutedEvent(this, std::move(event->result), event->empty, event->timeoutReached())
             );
             return;
         }
@@ -127,6 +347,79 @@ namespace Robomongo
         }
     }
 
+    void MongoShell::handle(ExecuteScriptFileProgressEvent *event)
+    {
+        eventBus()->publish(new ExecuteScriptFileProgressEvent(this, event->doneBytes, event->totalBytes,
+                                                               event->statements));
+    }
+
+    void MongoShell::handle(DatabaseListLoadedEvent *event)
+    {
+        if (event->isError())
+            return;
+
+        std::vector<std::string> databases;
+        for (MongoDatabase const *database : event->list)
+            databases.push_back(database->name());
+        _completionIndex.setDatabases(databases);
+    }
+
+    void MongoShell::handle(MongoDatabaseCollectionListLoadedEvent *event)
+    {
+        auto const database = qobject_cast<MongoDatabase *>(event->sender());
+        if (event->isError() || !database || database->server() != _server)
+            return;
+
+        _completionIndex.removeCollections(database->name(), event->removedNames);
+        _completionIndex.setCollections(database->name(), collectionNames(event->collections), 
+                                        event->batchIndex == 0);
+    }
+
+    void MongoShell::handle(SampleSchemaResponse *event)
+    {
+        // Optional, i.e. $sample is not supported by old servers or sampling timed out
+        if (event->isError()) {
+            LOG_MSG("Failed to sample collection schema: " + event->error().errorMessage(), 
+                    mongo::logger::LogSeverity::Info());
+            return;
+        }
+
+        SchemaCache::instance().insert(event->key, event->schema);
+    }
+
+    void MongoShell::indexFields(const std::vector<MongoDocumentPtr> &documents)
+    {
+        size_t const count = std::min(documents.size(), MaxIndexedDocuments);
+        for (size_t i = 0; i < count; ++i)
+            _completionIndex.addFields(documents[i]->bsonObj());
+    }
+
+    void MongoShell::handle(CountDocumentsResponse *event)
+    {
+        // Total is optional information, i.e. count of huge filtered collection may time out
+        if (event->isError()) {
+            LOG_MSG("Failed to count documents: " + event->error().errorMessage(), 
+                    mongo::logger::LogSeverity::Info());
+            return;
+        }
+
+        eventBus()->publish(new DocumentsCountedEvent(this, event->resultIndex, event->queryInfo, 
+                                                      event->count, event->estimated));
+    }
+
+    void MongoShell::handle(KillOperationsResponse *event)
+    {
+        if (event->isError()) {
+            LOG_MSG("Failed to stop operations on server: " + event->error().errorMessage(), 
+                    mongo::logger::LogSeverity::Warning());
+            return;
+        }
+
+        LOG_MSG("Stopped " + std::to_string(event->killedOps) + " operation(s) and " + 
+                std::to_string(event->killedCursors) + " cursor(s) on server", 
+                mongo::logger::LogSeverity::Info());
+    }
+
     void MongoShell::handle(AutocompleteResponse *event)
     {
         if (event->isError()) {
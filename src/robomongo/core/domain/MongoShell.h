@@ -1,12 +1,17 @@
 #pragma once
+#include <QElapsedTimer>
 #include <QObject>
+#include <QStringList>
 #include "robomongo/core/events/MongoEvents.h"
 #include "robomongo/core/domain/ScriptInfo.h"
 #include "robomongo/core/domain/MongoAggregateInfo.h"
+#include "robomongo/core/domain/CompletionIndex.h"
+#include "robomongo/core/domain/QueryHistory.h"
 
 namespace Robomongo
 {
     struct AggrInfo;
+    class MongoDatabaseCollectionListLoadedEvent;
 
     class MongoShell : public QObject
     {
@@ -16,12 +21,70 @@ namespace Robomongo
         MongoShell(MongoServer *server, ScriptInfo scriptInfo);
 
         void open(const std::string &script, const std::string &dbName = std::string());
-        void query(int resultIndex, const MongoQueryInfo &info);
+        void query(int resultIndex, const MongoQueryInfo &info, unsigned long long cursorKey = 0);
+
+        /**
+         * @brief Reads page ahead with metadata worker, PagePrefetchedEvent is published.
+         *        Failures are not reported, page is just read again when it is needed.
+         */
+        void prefetch(int resultIndex, const MongoQueryInfo &info, unsigned long long cursorKey);
+
+        /**
+         * @brief Reads page of aggregation result with cursor kept open by worker under 
+         *        'cursorKey' (see AggregatePageRequest), AggregatePageResponse is published
+         */
+        void aggregatePage(int resultIndex, const AggrInfo &aggrInfo, unsigned long long cursorKey, bool reread);
+
+        /**
+         * @brief Runs every prefix of aggregation pipeline on the first 'sampleSize' input
+         *        documents (see PipelinePreviewRequest), PipelinePreviewResponse is published
+         */
+        void previewPipeline(const AggrInfo &aggrInfo, int sampleSize);
+
+        /**
+         * @brief Groups values of 'field' of documents matching query on server, with time
+         *        limit of tab (see FieldDistributionRequest), FieldDistributionResponse is published
+         * @param sampleSize Documents grouped, 0 for all matching ones
+         */
+        void groupByField(const MongoQueryInfo &info, const std::string &field, int sampleSize);
+
+        /**
+         * @brief Buckets values of 'field' of documents matching query on server, with time
+         *        limit of tab (see FieldBucketsRequest), FieldBucketsResponse is published
+         */
+        void bucketField(int bucketsId, const MongoQueryInfo &info, const std::string &field,
+                         const FieldBuckets::Spec &spec);
+
+        /**
+         * @brief Counts documents of query result asynchronously, DocumentsCountedEvent is published
+         */
+        void countDocuments(int resultIndex, const MongoQueryInfo &info);
+
+        /**
+         * @brief Completes prefix synchronously, with names of explorer, recent results and 
+         *        shell API (see CompletionIndex). Worker, which may be busy with a query, is 
+         *        not involved. Inside filter of collection, its field paths from SchemaCache
+         *        come first. Unknown collection is sampled in background for the next time.
+         * @param textBefore Script text before prefix
+         * @return Empty list, if nothing is known for this prefix. Scripts may define their 
+         *         own variables, so autocomplete() is used then.
+         */
+        QStringList complete(const std::string &prefix, const std::string &textBefore);
+
+        /**
+         * @brief Completes prefix with JavaScript shell of worker, AutocompleteResponse is published
+         */
         void autocomplete(const std::string &prefix);
         void stop();
         MongoServer *server() const { return _server; }
         std::string query() const;
         void execute(const std::string &script = "", const std::string &dbName = "");
+
+        /**
+         * @brief Runs script file without loading it into editor (see ScriptEngine::execFile()).
+         *        ExecuteScriptFileProgressEvent and then ScriptExecutedEvent are published.
+         */
+        void executeFile(const QString &filePath);
         bool isExecutable() const { return _scriptInfo.execute(); }
         const QString &title() const { return _scriptInfo.title(); }
         std::string dbname() const { return _scriptInfo.dbname(); }
@@ -29,6 +92,20 @@ namespace Robomongo
         void setScript(const QString &script) { return _scriptInfo.setScript(script); }
         void setScriptExecutable(bool execute) { _scriptInfo.setExecutable(execute); }
         void setAggrInfo(AggrInfo const& aggrInfo) { _aggrInfo = aggrInfo; }
+
+        /**
+         * @brief Read preference of scripts executed from now on, and of pages and prefetch
+         *        of their results
+         */
+        void setReadPreference(const ReadPreferenceInfo &readPreference) { _readPreference = readPreference; }
+        const ReadPreferenceInfo &readPreference() const { return _readPreference; }
+
+        /**
+         * @brief Server time limit (maxTimeMS) of scripts executed from now on, of pages,
+         *        prefetch and counts of their results. 0 for no limit.
+         */
+        void setMaxTimeMs(int maxTimeMs) { _maxTimeMs = maxTimeMs; }
+        int maxTimeMs() const { return _maxTimeMs; }
         QString filePath() const { return _scriptInfo.filePath(); }
 
         bool saveToFile();
@@ -37,13 +114,34 @@ namespace Robomongo
 
     protected Q_SLOTS:
         void handle(ExecuteQueryResponse *event);
+        void handle(AggregatePageResponse *event);
+        void handle(PipelinePreviewResponse *event);
+        void handle(FieldDistributionResponse *event);
+        void handle(FieldBucketsResponse *event);
         void handle(ExecuteScriptResponse *event);
+        void handle(ExecuteScriptFileProgressEvent *event);
         void handle(AutocompleteResponse *event);
+        void handle(KillOperationsResponse *event);
+        void handle(CountDocumentsResponse *event);
+        void handle(DatabaseListLoadedEvent *event);
+        void handle(MongoDatabaseCollectionListLoadedEvent *event);
+        void handle(SampleSchemaResponse *event);
 
     private:        
+        void indexFields(const std::vector<MongoDocumentPtr> &documents);
+
         ScriptInfo _scriptInfo;
         AggrInfo _aggrInfo;
+        ReadPreferenceInfo _readPreference;
+        int _maxTimeMs = 0;
         MongoServer *_server;
+        CompletionIndex _completionIndex;
+        std::string _currentDatabase;   // as reported by the last script, "db." of completions
+
+        // Script sent by execute(), written to QueryHistory with its response
+        QueryHistoryEntry _pendingHistory;
+        QElapsedTimer _historyTimer;
+        bool _isHistoryPending = false;
     };
 
 }
@@ -5,29 +5,49 @@
 
 namespace Robomongo
 {
+    /* --------------  ExplainInfo Class --------- */
+    // Summary of explain("executionStats") of find/aggregate statement, see ScriptEngine
+    struct ExplainInfo
+    {
+        bool isValid = false;
+        std::string error;          // explain failed (i.e. not authorized), other fields are empty
+        long long keysExamined = 0;
+        long long docsExamined = 0;
+        long long returned = 0;
+        long long serverMs = 0;     // executionTimeMillis of explain run (slowest shard)
+        bool collScan = false;
+        std::string indexes;        // names of indexes used by winning plan, comma separated
+    };
+
     /* --------------  MongoShellResult Class --------- */
+    // Move-only, so that documents of result are never copied on their way to output views
     class MongoShellResult
     {
     public:
         MongoShellResult(
             const std::string &type, const std::string &response,
-            const std::vector<MongoDocumentPtr> &documents,
+            std::vector<MongoDocumentPtr> documents,
             const MongoQueryInfo &queryInfo, const std::string &statement,
             qint64 elapsedms, AggrInfo aggrInfo = AggrInfo()) :
             _type(type),
             _response(response),
-            _documents(documents),
+            _documents(std::move(documents)),
             _queryInfo(queryInfo),
             _statement(statement),
             _elapsedms(elapsedms),
             _aggrInfo(aggrInfo)
         { }
 
-        std::string response() const { return _response; }
-        std::string type() const { return _type; }
-        std::vector<MongoDocumentPtr> documents() const { return _documents; }
-        MongoQueryInfo queryInfo() const { return _queryInfo; }
-        std::string statement() const { return _statement; }
+        MongoShellResult(MongoShellResult &&) = default;
+        MongoShellResult& operator=(MongoShellResult &&) = default;
+        MongoShellResult(const MongoShellResult &) = delete;
+        MongoShellResult& operator=(const MongoShellResult &) = delete;
+
+        std::string const& response() const { return _response; }
+        std::string const& type() const { return _type; }
+        std::vector<MongoDocumentPtr> const& documents() const { return _documents; }
+        MongoQueryInfo const& queryInfo() const { return _queryInfo; }
+        std::string const& statement() const { return _statement; }
         std::string statementShort() const {
             std::size_t const LEN = _statement.size() < 10 ? _statement.size() : 10;
             std::string statementShort { _statement, 0, LEN };
@@ -38,28 +58,41 @@ namespace Robomongo
         qint64 elapsedMs() const { return _elapsedms; }
         AggrInfo const& aggrInfo() const { return _aggrInfo; }
 
+        ExplainInfo const& explainInfo() const { return _explainInfo; }
+        void setExplainInfo(const ExplainInfo &info) { _explainInfo = info; }
+
+        // JavaScript heap of shell right after statement, 0 if not measured (see ScriptEngine)
+        long long jsHeapBytes() const { return _jsHeapBytes; }
+        void setJsHeapBytes(long long bytes) { _jsHeapBytes = bytes; }
+
+        // Releases documents, when they are already handed over to output views
+        void clearDocuments() { _documents.clear(); }
+
     private:
         std::string _type;
         std::string _response;
         std::vector<MongoDocumentPtr> _documents;
         MongoQueryInfo _queryInfo;
-        std::string const _statement;
+        std::string _statement;
         qint64 _elapsedms;
         AggrInfo _aggrInfo = AggrInfo();
+        ExplainInfo _explainInfo;
+        long long _jsHeapBytes = 0;
     };
 
     /* --------------  MongoShellExecResult Class --------- */
+    // Move-only as MongoShellResult, it is moved from worker to shell and then to QueryWidget
     class MongoShellExecResult
     {
     public:
         MongoShellExecResult() { }
 
         MongoShellExecResult(
-            const std::vector<MongoShellResult> &results,
+            std::vector<MongoShellResult> results,
             const std::string &currentServer, bool isCurrentServerValid,
             const std::string &currentDatabase, bool isCurrentDatabaseValid,
             bool timeoutReached = false) :
-            _results(results),
+            _results(std::move(results)),
             _currentServer(currentServer),
             _currentDatabase(currentDatabase),
             _isCurrentServerValid(isCurrentServerValid),
@@ -70,13 +103,22 @@ namespace Robomongo
         MongoShellExecResult(bool error, std::string const& errorMsg = "", bool timeoutReached = false) : 
             _error(error), _errorMessage(errorMsg), _timeoutReached(timeoutReached) { }
 
+        MongoShellExecResult(MongoShellExecResult &&) = default;
+        MongoShellExecResult& operator=(MongoShellExecResult &&) = default;
+        MongoShellExecResult(const MongoShellExecResult &) = delete;
+        MongoShellExecResult& operator=(const MongoShellExecResult &) = delete;
+
         std::vector<MongoShellResult> const& results() const { return _results; }
-        std::string currentServer() const { return _currentServer; }
+        void clearDocuments() {
+            for (auto &result : _results)
+                result.clearDocuments();
+        }
+        std::string const& currentServer() const { return _currentServer; }
         void setCurrentServer(std::string const& server) { _currentServer = server; }
-        std::string currentDatabase() const { return _currentDatabase; }        
+        std::string const& currentDatabase() const { return _currentDatabase; }
         bool isCurrentServerValid() const { return _isCurrentServerValid; }
         bool isCurrentDatabaseValid() const { return _isCurrentDatabaseValid; }
-        std::string errorMessage() const { return _errorMessage; }
+        std::string const& errorMessage() const { return _errorMessage; }
         bool error() const { return _error; }
         bool timeoutReached() const { return _timeoutReached; }
 
@@ -84,8 +126,8 @@ namespace Robomongo
         std::vector<MongoShellResult> _results;
         std::string _currentServer;
         std::string _currentDatabase;
-        bool _isCurrentServerValid;
-        bool _isCurrentDatabaseValid;
+        bool _isCurrentServerValid = false;
+        bool _isCurrentDatabaseValid = false;
         std::string _errorMessage;
         bool _error = false;
         bool _timeoutReached = false;
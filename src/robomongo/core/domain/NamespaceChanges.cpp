@@ -0,0 +1,72 @@
+#include "robomongo/core/domain/NamespaceChanges.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace Robomongo
+{
+    namespace NamespaceChanges
+    {
+        namespace
+        {
+            MongoNamespace toNamespace(const mongo::BSONObj &ns)
+            {
+                return MongoNamespace(ns.getStringField("db"), ns.getStringField("coll"));
+            }
+        }
+
+        mongo::BSONArray pipeline()
+        {
+            return BSON_ARRAY(
+                BSON("$changeStream" << BSON("allChangesForCluster" << true)) <<
+                BSON("$match" << BSON("operationType" <<
+                    BSON("$in" << BSON_ARRAY("insert" << "drop" << "rename" << "dropDatabase")))) <<
+                BSON("$project" << BSON("operationType" << 1 << "ns" << 1 << "to" << 1)));
+        }
+
+        bool Filter::apply(const mongo::BSONObj &event, Change &change)
+        {
+            std::string const type = event.getStringField("operationType");
+            MongoNamespace const ns = toNamespace(event.getObjectField("ns"));
+            if (ns.databaseName().empty())
+                return false;
+
+            if (type == "dropDatabase") {
+                for (auto it = _seen.begin(); it != _seen.end(); ) {
+                    if (MongoNamespace(*it).databaseName() == ns.databaseName())
+                        it = _seen.erase(it);
+                    else
+                        ++it;
+                }
+                change = Change{ Change::DatabaseDropped, MongoNamespace(ns.databaseName(), ""), MongoNamespace() };
+                return true;
+            }
+
+            if (ns.collectionName().empty())
+                return false;
+
+            if (type == "insert") {
+                if (!_seen.insert(ns.toString()).second)
+                    return false;
+
+                change = Change{ Change::CollectionCreated, ns, MongoNamespace() };
+                return true;
+            }
+
+            if (type == "drop") {
+                _seen.erase(ns.toString());
+                change = Change{ Change::CollectionDropped, ns, MongoNamespace() };
+                return true;
+            }
+
+            if (type == "rename") {
+                MongoNamespace const to = toNamespace(event.getObjectField("to"));
+                _seen.erase(ns.toString());
+                _seen.insert(to.toString());
+                change = Change{ Change::CollectionRenamed, ns, to };
+                return true;
+            }
+
+            return false;
+        }
+    }
+}
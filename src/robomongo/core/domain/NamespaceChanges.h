@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/domain/MongoNamespace.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Creation, drop and rename of collections and databases of the whole deployment,
+     *        read from a cluster wide change stream, so that explorer follows them without
+     *        refresh. Server of 4.2 reports drops and renames only, so new collections are
+     *        recognized by their first insert.
+     */
+    namespace NamespaceChanges
+    {
+        struct Change
+        {
+            enum Kind { CollectionCreated, CollectionDropped, CollectionRenamed, DatabaseDropped };
+
+            Kind kind;
+            MongoNamespace ns;      // only database name is set for DatabaseDropped
+            MongoNamespace to;      // new name of CollectionRenamed
+        };
+
+        /**
+         * @brief Pipeline of { aggregate: 1 } on admin database. Events are projected to
+         *        operation type and namespaces, so that inserts cost only a few bytes.
+         */
+        mongo::BSONArray pipeline();
+
+        /**
+         * @brief Turns change events into changes. Insert into a namespace, which was not seen
+         *        since the stream was opened (or since its drop), is reported as creation once.
+         */
+        class Filter
+        {
+        public:
+            /**
+             * @return false, if event is not a change of namespaces
+             */
+            bool apply(const mongo::BSONObj &event, Change &change);
+
+        private:
+            std::unordered_set<std::string> _seen;      // full names
+        };
+    }
+}
@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+#include "NamespaceChanges.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+using NamespaceChanges::Change;
+
+namespace
+{
+    mongo::BSONObj event(const char *type, const char *db, const char *coll = "")
+    {
+        return BSON("operationType" << type << "ns" << BSON("db" << db << "coll" << coll));
+    }
+}
+
+TEST(namespace_changes_tests, first_insert_is_creation)
+{
+    NamespaceChanges::Filter filter;
+    Change change;
+
+    ASSERT_TRUE(filter.apply(event("insert", "shop", "orders"), change));
+    EXPECT_EQ(Change::CollectionCreated, change.kind);
+    EXPECT_EQ("shop.orders", change.ns.toString());
+    EXPECT_FALSE(filter.apply(event("insert", "shop", "orders"), change));
+
+    ASSERT_TRUE(filter.apply(event("drop", "shop", "orders"), change));
+    EXPECT_EQ(Change::CollectionDropped, change.kind);
+    EXPECT_TRUE(filter.apply(event("insert", "shop", "orders"), change));
+}
+
+TEST(namespace_changes_tests, rename_and_drop_database)
+{
+    NamespaceChanges::Filter filter;
+    Change change;
+
+    mongo::BSONObj const rename = BSON("operationType" << "rename"
+                                       << "ns" << BSON("db" << "shop" << "coll" << "orders")
+                                       << "to" << BSON("db" << "archive" << "coll" << "orders2019"));
+    ASSERT_TRUE(filter.apply(rename, change));
+    EXPECT_EQ(Change::CollectionRenamed, change.kind);
+    EXPECT_EQ("archive.orders2019", change.to.toString());
+    EXPECT_FALSE(filter.apply(event("insert", "archive", "orders2019"), change));
+
+    ASSERT_TRUE(filter.apply(event("dropDatabase", "archive"), change));
+    EXPECT_EQ(Change::DatabaseDropped, change.kind);
+    EXPECT_EQ("archive", change.ns.databaseName());
+    EXPECT_TRUE(filter.apply(event("insert", "archive", "orders2019"), change));
+
+    EXPECT_FALSE(filter.apply(event("update", "shop", "items"), change));
+}
@@ -0,0 +1,144 @@
+#include "robomongo/core/domain/NamespaceIndex.h"
+
+#include <algorithm>
+
+namespace Robomongo
+{
+    namespace
+    {
+        bool isBoundary(char ch)
+        {
+            return ch == '.' || ch == '_' || ch == '-' || ch == ' ';
+        }
+
+        // Bits of 'a'-'z', '0'-'9', '.', '_', '-'; other characters share the last bit
+        int charBit(char ch)
+        {
+            if (ch >= 'a' && ch <= 'z')
+                return ch - 'a';
+            if (ch >= '0' && ch <= '9')
+                return 26 + ch - '0';
+            switch (ch) {
+            case '.': return 36;
+            case '_': return 37;
+            case '-': return 38;
+            default: return 63;
+            }
+        }
+    }
+
+    void NamespaceIndex::add(size_t server, const std::string &database, const std::string &collection)
+    {
+        std::string const text = lower(database + "." + collection);
+        _masks.push_back(charMask(text));
+        _texts.push_back(text);
+        _entries.push_back({ server, database, collection });
+    }
+
+    void NamespaceIndex::clear()
+    {
+        _entries.clear();
+        _texts.clear();
+        _masks.clear();
+    }
+
+    std::vector<size_t> NamespaceIndex::find(const std::string &query, size_t limit) const
+    {
+        std::string needle = lower(query);
+        needle.erase(std::remove(needle.begin(), needle.end(), ' '), needle.end());
+
+        std::vector<size_t> result;
+        if (needle.empty()) {
+            for (size_t id = 0; id < _entries.size() && result.size() < limit; ++id)
+                result.push_back(id);
+            return result;
+        }
+
+        uint64_t const mask = charMask(needle);
+        std::vector<std::pair<int, size_t>> scored;    // (score, id)
+        for (size_t id = 0; id < _texts.size(); ++id) {
+            if ((_masks[id] & mask) != mask)
+                continue;
+
+            int const value = score(_texts[id], needle);
+            if (value >= 0)
+                scored.emplace_back(value, id);
+        }
+
+        // Only the best 'limit' are sorted, ties in order of adding
+        auto const better = [](const std::pair<int, size_t> &left, const std::pair<int, size_t> &right) {
+            return left.first != right.first ? left.first > right.first : left.second < right.second;
+        };
+        size_t const count = std::min(limit, scored.size());
+        std::partial_sort(scored.begin(), scored.begin() + count, scored.end(), better);
+
+        result.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            result.push_back(scored[i].second);
+        return result;
+    }
+
+    int NamespaceIndex::score(const std::string &text, const std::string &needle)
+    {
+        if (needle.empty())
+            return 0;
+
+        // Greedy match from every occurrence of the first character, the best one counts
+        int best = -1;
+        for (size_t start = text.find(needle[0]); start != std::string::npos;
+             start = text.find(needle[0], start + 1)) {
+            int value = 0;
+            size_t matched = 0;
+            size_t previous = std::string::npos;
+            for (size_t i = start; i < text.size() && matched < needle.size(); ++i) {
+                if (text[i] != needle[matched])
+                    continue;
+
+                value += 1;
+                if (previous != std::string::npos && i == previous + 1)
+                    value += 8;
+                if (i == 0 || isBoundary(text[i - 1]))
+                    value += 6;
+                previous = i;
+                ++matched;
+            }
+
+            // Later starts have even fewer characters left
+            if (matched < needle.size())
+                break;
+            best = std::max(best, value);
+        }
+
+        if (best < 0)
+            return -1;
+
+        // Database names have no dots, collection is the rest
+        size_t const dot = text.find('.');
+        std::string const collection = dot == std::string::npos ? text : text.substr(dot + 1);
+        if (collection == needle)
+            best += 40;
+        else if (collection.compare(0, needle.size(), needle) == 0)
+            best += 20;
+
+        // Of equal matches, shorter names are closer to what was typed
+        return std::max(0, best - static_cast<int>(text.size() / 8));
+    }
+
+    std::string NamespaceIndex::lower(const std::string &text)
+    {
+        std::string result(text);
+        for (char &ch : result) {
+            if (ch >= 'A' && ch <= 'Z')
+                ch = static_cast<char>(ch - 'A' + 'a');
+        }
+        return result;
+    }
+
+    uint64_t NamespaceIndex::charMask(const std::string &text)
+    {
+        uint64_t mask = 0;
+        for (char const ch : text)
+            mask |= uint64_t(1) << charBit(ch);
+        return mask;
+    }
+}
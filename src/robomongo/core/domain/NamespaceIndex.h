@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Robomongo
+{
+    /**
+     * @brief Collections of all connected servers, for "Go to Namespace" finder. Fuzzy match:
+     *        characters of query occur in "database.collection" in order, case insensitive,
+     *        so "ordv2" finds "shop.orders_v2".
+     *
+     *  Every entry keeps mask of characters it contains; entries missing any character of
+     *  query are skipped without comparing texts, so that tens of thousands of namespaces
+     *  are searched as user types.
+     *
+     *  Not thread safe, NamespaceFinderDialog builds and queries it in GUI thread.
+     */
+    class NamespaceIndex
+    {
+    public:
+        struct Entry
+        {
+            size_t server;          // index of server in list of caller
+            std::string database;
+            std::string collection;
+        };
+
+        void add(size_t server, const std::string &database, const std::string &collection);
+        void clear();
+
+        size_t size() const { return _entries.size(); }
+        const Entry &entry(size_t id) const { return _entries[id]; }
+
+        /**
+         * @return Ids of at most 'limit' matching entries, best first: consecutive characters
+         *         and ones at start of name or after '.', '_', '-' weigh more, so do exact and
+         *         prefix matches of collection name. All entries in order of adding, if query
+         *         is empty. Spaces of query are ignored.
+         */
+        std::vector<size_t> find(const std::string &query, size_t limit) const;
+
+        /**
+         * @return Score of fuzzy match of 'needle' in 'text' (both lower case), -1 if it does
+         *         not match
+         */
+        static int score(const std::string &text, const std::string &needle);
+
+    private:
+        static std::string lower(const std::string &text);
+        static uint64_t charMask(const std::string &text);
+
+        std::vector<Entry> _entries;
+        std::vector<std::string> _texts;    // "database.collection", lower cased
+        std::vector<uint64_t> _masks;
+    };
+}
@@ -0,0 +1,47 @@
+#include "gtest/gtest.h"
+#include "NamespaceIndex.h"
+
+using namespace Robomongo;
+
+TEST(namespace_index_tests, fuzzy_match_in_order)
+{
+    EXPECT_LT(0, NamespaceIndex::score("shop.orders_v2", "ordv2"));
+    EXPECT_LT(0, NamespaceIndex::score("shop.orders_v2", "shop.ord"));
+    EXPECT_EQ(-1, NamespaceIndex::score("shop.orders_v2", "v2ord"));
+    EXPECT_EQ(-1, NamespaceIndex::score("shop.orders", "orders2"));
+}
+
+TEST(namespace_index_tests, exact_and_prefix_collection_names_first)
+{
+    NamespaceIndex index;
+    index.add(0, "archive", "old_orders_v2_backup");
+    index.add(1, "shop", "orders_v2");
+    index.add(2, "shop", "orders");
+    index.add(2, "crm", "Customers");
+
+    auto const ids = index.find("orders_v2", 10);
+    ASSERT_EQ(2u, ids.size());
+    EXPECT_EQ(1u, ids[0]);
+    EXPECT_EQ(0u, ids[1]);
+    EXPECT_EQ(1u, index.entry(ids[0]).server);
+
+    // Case insensitive, spaces ignored
+    auto const customers = index.find("CRM cust", 10);
+    ASSERT_EQ(1u, customers.size());
+    EXPECT_EQ("Customers", index.entry(customers[0]).collection);
+}
+
+TEST(namespace_index_tests, limit_and_empty_query)
+{
+    NamespaceIndex index;
+    for (int i = 0; i < 10; ++i)
+        index.add(0, "db", "coll" + std::to_string(i));
+
+    EXPECT_EQ(3u, index.find("", 3).size());
+    EXPECT_EQ(0u, index.find("", 3)[0]);
+    EXPECT_EQ(5u, index.find("coll", 5).size());
+    EXPECT_TRUE(index.find("zzz", 5).empty());
+
+    index.clear();
+    EXPECT_EQ(0u, index.size());
+}
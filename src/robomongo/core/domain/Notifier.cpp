@@ -1,18 +1,29 @@
 #include "robomongo/core/domain/Notifier.h"
 
+#include <algorithm>
+#include <set>
 #include <thread>
 #include <chrono>
 
+#include <QAbstractItemView>
+#include <QAbstractProxyModel>
 #include <QAction>
 #include <QClipboard>
 #include <QApplication>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QMenu>
+#include <QPointer>
+#include <QSaveFile>
 
 #include "robomongo/core/domain/MongoShell.h"
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/ExportWriter.h"
+#include "robomongo/core/utils/Logger.h"
 #include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/domain/MongoDocument.h"
 #include "robomongo/core/domain/MongoServer.h"
 #include "robomongo/core/events/MongoEvents.h"
 
@@ -20,11 +31,53 @@
 
 #include "robomongo/gui/MainWindow.h"
 #include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
+#include "robomongo/gui/widgets/workarea/BsonTreeModel.h"
+#include "robomongo/gui/dialogs/BinaryViewerDialog.h"
 #include "robomongo/gui/dialogs/DocumentTextEditor.h"
 #include "robomongo/gui/utils/DialogUtils.h"
 #include "robomongo/gui/GuiRegistry.h"
 #include "robomongo/core/EventBus.h"
 
+namespace
+{
+    // BSON size of Copy JSON above which saving to file is offered; JSON text is
+    // several times larger, and clipboard owners copy it again
+    int const ClipboardGuardBytes = 16 * 1024 * 1024;
+
+    // Documents pushed to ExportWriter at once
+    size_t const SaveBatchSize = 1000;
+
+    // Columns of CSV: top-level fields of all documents, in order of first appearance
+    std::vector<std::string> topLevelFields(const std::vector<Robomongo::MongoDocumentPtr> &documents)
+    {
+        std::vector<std::string> fields;
+        std::set<std::string> known;
+        for (auto const &document : documents) {
+            for (auto const &element : document->bsonObj()) {
+                std::string name = element.fieldName();
+                if (known.insert(name).second)
+                    fields.push_back(std::move(name));
+            }
+        }
+        return fields;
+    }
+
+    // Shows outcome of background save in GUI thread, 'error' is empty on success
+    void reportSaved(const QString &filePath, long long documents, const std::string &error)
+    {
+        QMetaObject::invokeMethod(qApp, [filePath, documents, error]() {
+            if (!error.empty()) {
+                QMessageBox::warning(QApplication::activeWindow(), "Save Results",
+                                     QString("Cannot write file %1: %2").arg(filePath)
+                                                                         .arg(QString::fromStdString(error)));
+                return;
+            }
+            LOG_MSG(QString("Saved %1 documents to %2").arg(documents).arg(filePath),
+                    mongo::logger::LogSeverity::Info());
+        }, Qt::QueuedConnection);
+    }
+}
+
 namespace Robomongo
 {
     namespace detail
@@ -50,9 +103,15 @@ namespace Robomongo
             return BsonUtils::isDocument(item->type());
         }
 
+        // Binary value other than UUID, shown only by prefix in views
+        bool isBinaryType(BsonTreeItem const *item)
+        {
+            return item->type() == mongo::BinData && !BsonUtils::isUuidType(item->type(), item->binType());
+        }
+
         bool isArrayChild(BsonTreeItem const *item)
         {
-            return BsonUtils::isArray(dynamic_cast<BsonTreeItem*>(item->parent())->type());
+            return BsonUtils::isArray(item->parent()->type());
         }
 
         bool isDocumentRoot(BsonTreeItem const *item)
@@ -60,6 +119,27 @@ namespace Robomongo
             return ( item == item->superParent() );
         }
 
+        // Tree model of index, also behind table proxy; NULL for other models
+        BsonTreeModel const *treeModel(QAbstractItemModel const *model)
+        {
+            if (auto proxy = qobject_cast<QAbstractProxyModel const *>(model))
+                model = proxy->sourceModel();
+            return qobject_cast<BsonTreeModel const *>(model);
+        }
+
+        BsonTreeModel const *treeModel(const QModelIndex &index)
+        {
+            return treeModel(index.model());
+        }
+
+        // Key of item, shared by all items of the same field when model interned it
+        QString fieldName(BsonTreeModel const *model, BsonTreeItem const *item)
+        {
+            if (model && item->nameId() != FieldNameInterner::NoId && !isArrayChild(item))
+                return model->fieldNames().name(item->nameId());
+            return QString::fromStdString(item->fieldName());
+        }
+
         /**
          * 
          * @param QModelIndexList indexes
@@ -106,8 +186,13 @@ namespace Robomongo
         _queryInfo(queryInfo)
     {
         QWidget *wid = dynamic_cast<QWidget*>(_observer);
-        AppRegistry::instance().bus()->subscribe(this, InsertDocumentResponse::Type, _shell->server());
-        AppRegistry::instance().bus()->subscribe(this, RemoveDocumentResponse::Type, _shell->server());
+
+        // Documents of dump file have no shell, they are read-only
+        if (_shell) {
+            AppRegistry::instance().bus()->subscribe(this, InsertDocumentResponse::Type, _shell->server());
+            AppRegistry::instance().bus()->subscribe(this, RemoveDocumentResponse::Type, _shell->server());
+            AppRegistry::instance().bus()->subscribe(this, RemoveDocumentsByIdResponse::Type, _shell->server());
+        }
 
         _deleteDocumentAction = new QAction("Delete Document...", wid);
         VERIFY(connect(_deleteDocumentAction, SIGNAL(triggered()), SLOT(onDeleteDocument())));
@@ -121,6 +206,9 @@ namespace Robomongo
         _viewDocumentAction = new QAction("View Document...", wid);
         VERIFY(connect(_viewDocumentAction, SIGNAL(triggered()), SLOT(onViewDocument())));
 
+        _viewBinaryAction = new QAction("View Binary...", wid);
+        VERIFY(connect(_viewBinaryAction, SIGNAL(triggered()), SLOT(onViewBinary())));
+
         _insertDocumentAction = new QAction("Insert Document...", wid);
         VERIFY(connect(_insertDocumentAction, SIGNAL(triggered()), SLOT(onInsertDocument())));
 
@@ -137,7 +225,10 @@ namespace Robomongo
         VERIFY(connect(_copyTimestampAction, SIGNAL(triggered()), SLOT(onCopyTimestamp())));
 
         _copyJsonAction = new QAction("Copy JSON", wid);
-        VERIFY(connect(_copyJsonAction, SIGNAL(triggered()), SLOT(onCopyJson())));        
+        VERIFY(connect(_copyJsonAction, SIGNAL(triggered()), SLOT(onCopyJson())));
+
+        _saveResultsAction = new QAction("Save Results As...", wid);
+        VERIFY(connect(_saveResultsAction, SIGNAL(triggered()), SLOT(onSaveResults())));
     }
 
     void Notifier::initMenu(QMenu *const menu, BsonTreeItem *const item)
@@ -151,6 +242,7 @@ namespace Robomongo
         bool isObjectId = false;
         bool isNotArrayChild = false;
         bool isRoot = false;
+        bool isBinary = false;
 
         if (item) {
             isSimple = detail::isSimpleType(item);
@@ -158,10 +250,12 @@ namespace Robomongo
             isObjectId = detail::isObjectIdType(item);
             isNotArrayChild = !detail::isArrayChild(item);
             isRoot = detail::isDocumentRoot(item);
+            isBinary = detail::isBinaryType(item);
         }
 
         if (onItem && isEditable) menu->addAction(_editDocumentAction);
         if (onItem)               menu->addAction(_viewDocumentAction);
+        if (onItem && isBinary)   menu->addAction(_viewBinaryAction);
         if (isEditable)           menu->addAction(_insertDocumentAction);
         if (onItem && (isSimple || isDocument)) menu->addSeparator();
         if (onItem && isSimple)   menu->addAction(_copyValueAction);
@@ -176,6 +270,8 @@ namespace Robomongo
         if (onItem && isDocument) menu->addAction(_copyJsonAction);
         if (onItem && isEditable) menu->addSeparator();
         if (onItem && isEditable) menu->addAction(_deleteDocumentAction);
+        menu->addSeparator();
+        menu->addAction(_saveResultsAction);
     }
 
     void Notifier::initMultiSelectionMenu(QMenu *const menu)
@@ -184,13 +280,15 @@ namespace Robomongo
 
         if (isEditable) menu->addAction(_insertDocumentAction);
         if (isEditable) menu->addAction(_deleteDocumentsAction);
+        menu->addSeparator();
+        menu->addAction(_saveResultsAction);
     }
 
     void Notifier::deleteDocuments(std::vector<BsonTreeItem*> const& items, bool force)
     {
-        bool isNeededRefresh = false;
+        // Objects of form { _id : <value> }, removed with one bulk request
+        std::vector<mongo::BSONObj> ids;
 
-        int index = 0;
         for (auto const * const documentItem : items) {
             if (!documentItem)
                 break;
@@ -207,8 +305,6 @@ namespace Robomongo
 
             mongo::BSONObjBuilder builder;
             builder.append(id);
-            mongo::BSONObj bsonQuery = builder.obj();
-            mongo::Query query(bsonQuery);
 
             if (!force) {
                 // Ask user
@@ -219,14 +315,20 @@ namespace Robomongo
                     break;
             }
 
-            isNeededRefresh = true;
-
-            RemoveDocumentCount removeCount = items.size() == 1 ? RemoveDocumentCount::ONE :  
-                                                                  RemoveDocumentCount::MULTI;
-            _shell->server()->removeDocuments(query, _queryInfo._info._ns, removeCount, index);
-            ++index;
-            mainWindow()->showQueryWidgetProgressBar();
+            ids.push_back(builder.obj());
         }
+
+        if (ids.empty())
+            return;
+
+        if (ids.size() == 1)
+            _shell->server()->removeDocuments(mongo::Query(ids.front()), _queryInfo._info._ns, 
+                                              RemoveDocumentCount::ONE);
+        else
+            _shell->server()->removeDocuments(ids, _queryInfo._info._ns);
+
+        publishDocumentsChanged();
+        mainWindow()->showQueryWidgetProgressBar();
     }
 
     void Notifier::handle(InsertDocumentResponse *event)
@@ -263,6 +365,16 @@ namespace Robomongo
        }
     }
 
+    void Notifier::handle(RemoveDocumentsByIdResponse *event)
+    {
+        // Errors are reported by MongoServer, refresh if at least part of documents was removed
+        if (event->removedCount() == 0)
+            return;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        _shell->query(0, _queryInfo);
+    }
+
     void Notifier::onCopyNameDocument()
     {
         QModelIndex const& selectedInd = _observer->selectedIndex();
@@ -278,7 +390,7 @@ namespace Robomongo
             return;
 
         QClipboard *clipboard = QApplication::clipboard();
-        clipboard->setText(QString::fromStdString(documentItem->fieldName()));
+        clipboard->setText(detail::fieldName(detail::treeModel(selectedInd), documentItem));
     }
 
     void Notifier::onCopyPathDocument()
@@ -297,13 +409,14 @@ namespace Robomongo
 
         QStringList namesList;
         BsonTreeItem const *documentItemHelper = documentItem;
+        BsonTreeModel const *model = detail::treeModel(selectedInd);
 
         while (!detail::isDocumentRoot(documentItemHelper)) {
             if (!detail::isArrayChild(documentItemHelper)) {
-                namesList.push_front(QString::fromStdString(documentItemHelper->fieldName()));
+                namesList.push_front(detail::fieldName(model, documentItemHelper));
             }
 
-            documentItemHelper = dynamic_cast<BsonTreeItem*>(documentItemHelper->parent());
+            documentItemHelper = documentItemHelper->parent();
         }
 
         QClipboard *clipboard = QApplication::clipboard();
@@ -320,6 +433,84 @@ namespace Robomongo
         return mainWindow;
     }
 
+    std::vector<MongoDocumentPtr> Notifier::resultDocuments() const
+    {
+        auto view = dynamic_cast<QAbstractItemView*>(_observer);
+        BsonTreeModel const *model = view ? detail::treeModel(view->model()) : NULL;
+        return model ? model->documents() : std::vector<MongoDocumentPtr>();
+    }
+
+    void Notifier::saveDocuments(std::vector<MongoDocumentPtr> documents)
+    {
+        QString const filePath = QFileDialog::getSaveFileName(dynamic_cast<QWidget*>(_observer),
+            "Save Results", "results.json", "JSON (*.json);;JSON Lines (*.jsonl);;CSV (*.csv)");
+        if (filePath.isEmpty())
+            return;
+
+        QString const suffix = QFileInfo(filePath).suffix().toLower();
+        ExportOptions options;
+        options.format = suffix == "csv" ? ExportFormat::Csv :
+                         suffix == "jsonl" ? ExportFormat::JsonLines : ExportFormat::JsonArray;
+        options.uuidEncoding = AppRegistry::instance().settingsManager()->uuidEncoding();
+        options.timeFormat = AppRegistry::instance().settingsManager()->timeZone();
+        options.jsonMode = AppRegistry::instance().settingsManager()->jsonOutputMode();
+
+        // Documents are shared with the result, which may be closed meanwhile
+        std::thread([documents, filePath, options]() mutable {
+            long long written = 0;
+            try {
+                if (options.format == ExportFormat::Csv)
+                    options.fields = topLevelFields(documents);
+
+                ExportWriter writer(filePath, options);
+                for (size_t i = 0; i < documents.size(); i += SaveBatchSize) {
+                    size_t const end = std::min(documents.size(), i + SaveBatchSize);
+                    std::vector<mongo::BSONObj> batch;
+                    batch.reserve(end - i);
+                    for (size_t j = i; j < end; ++j)
+                        batch.push_back(documents[j]->bsonObj());
+                    writer.push(std::move(batch));
+                }
+                writer.finish();
+                written = writer.documentsWritten();
+            }
+            catch (const std::exception &ex) {
+                reportSaved(filePath, 0, ex.what());
+                return;
+            }
+            reportSaved(filePath, written, "");
+        }).detach();
+    }
+
+    void Notifier::saveJson(const mongo::BSONObj &obj, bool isArray)
+    {
+        QString const filePath = QFileDialog::getSaveFileName(dynamic_cast<QWidget*>(_observer),
+            "Save JSON", "document.json", "JSON (*.json)");
+        if (filePath.isEmpty())
+            return;
+
+        UUIDEncoding const uuidEncoding = AppRegistry::instance().settingsManager()->uuidEncoding();
+        SupportedTimes const timeZone = AppRegistry::instance().settingsManager()->timeZone();
+        JsonOutputMode const mode = AppRegistry::instance().settingsManager()->jsonOutputMode();
+        mongo::BSONObj const owned = obj.getOwned();
+
+        std::thread([owned, isArray, filePath, uuidEncoding, timeZone, mode]() {
+            std::string const json = BsonUtils::jsonString(owned, mode, uuidEncoding, timeZone, isArray);
+            QSaveFile file(filePath);
+            if (!file.open(QIODevice::WriteOnly) ||
+                file.write(json.data(), json.size()) != static_cast<qint64>(json.size()) || !file.commit()) {
+                reportSaved(filePath, 0, QtUtils::toStdString(file.errorString()));
+                return;
+            }
+            reportSaved(filePath, 1, "");
+        }).detach();
+    }
+
+    void Notifier::publishDocumentsChanged()
+    {
+        AppRegistry::instance().bus()->publish(new DocumentsChangedEvent(this, _queryInfo._info));
+    }
+
     void Notifier::handleDeleteCommand()
     {
         if (_observer->selectedIndexes().count() > 1) 
@@ -378,7 +569,9 @@ namespace Robomongo
         if (!documentItem)
             return;
 
-        std::string str = BsonUtils::jsonString(documentItem->superRoot(), mongo::TenGen, 1,
+        // Copy, as view may be refreshed while editor is open
+        mongo::BSONObj const original = documentItem->superRoot().getOwned();
+        std::string str = BsonUtils::jsonString(original, mongo::TenGen, 1,
                                                 AppRegistry::instance().settingsManager()->uuidEncoding(),
                                                 AppRegistry::instance().settingsManager()->timeZone());
 
@@ -390,7 +583,13 @@ namespace Robomongo
         int result = editor.exec();
 
         if (result == QDialog::Accepted) {
-            _shell->server()->saveDocuments(editor.bsonObj(), _queryInfo._info._ns);
+            // Single edited document is saved with update of changed fields only
+            std::vector<mongo::BSONObj> const edited = editor.bsonObj();
+            if (edited.size() == 1)
+                _shell->server()->updateDocument(original, edited.front(), _queryInfo._info._ns);
+            else
+                _shell->server()->saveDocuments(edited, _queryInfo._info._ns);
+            publishDocumentsChanged();
             mainWindow()->showQueryWidgetProgressBar();
         }
     }
@@ -420,6 +619,21 @@ namespace Robomongo
         editor->show();
     }
 
+    void Notifier::onViewBinary()
+    {
+        BsonTreeItem *item = QtUtils::item<BsonTreeItem*>(_observer->selectedIndex());
+        if (!item || !detail::isBinaryType(item))
+            return;
+
+        mongo::BSONElement const element = item->element();
+        int length = 0;
+        const char *data = element.binData(length);
+
+        auto dialog = new BinaryViewerDialog(detail::fieldName(detail::treeModel(_observer->selectedIndex()), item),
+                                             data, length, dynamic_cast<QWidget*>(_observer));
+        dialog->show();
+    }
+
     void Notifier::onInsertDocument()
     {
         if (!_queryInfo._info.isValid())
@@ -440,6 +654,7 @@ namespace Robomongo
             _shell->server()->insertDocument(*it, _queryInfo._info._ns);
             mainWindow()->showQueryWidgetProgressBar();
         }
+        publishDocumentsChanged();
     }
 
     void Notifier::onCopyDocument()
@@ -481,13 +696,10 @@ namespace Robomongo
 
         bool isSupportedDate = (miutil::minDate < milliTimestamp) && (milliTimestamp < miutil::maxDate);
 
-        boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
-        boost::posix_time::time_duration diff = boost::posix_time::millisec(milliTimestamp);
-        boost::posix_time::ptime time = epoch + diff;
-
         if (isSupportedDate)
         {
-            std::string date = miutil::isotimeString(time, false, false);
+            std::string date;
+            miutil::appendIsoDate(date, milliTimestamp, false, false);
             clipboard->setText("ISODate(\""+QString::fromStdString(date)+"\")");
         }
         else {
@@ -514,11 +726,35 @@ namespace Robomongo
              obj = obj[documentItem->fieldName()].Obj();
          }
          bool isArray = BsonUtils::isArray(documentItem->type());
-         std::string str = BsonUtils::jsonString(obj, mongo::TenGen, 1,
+
+         if (obj.objsize() > ClipboardGuardBytes) {
+             QMessageBox::StandardButton const answer = QMessageBox::question(
+                 dynamic_cast<QWidget*>(_observer), "Copy JSON",
+                 QString("JSON of this %1 is about %2 MB and may make clipboard unresponsive. "
+                         "Do you want to save it to file instead?")
+                     .arg(isArray ? "array" : "document").arg(obj.objsize() / (1024 * 1024)),
+                 QMessageBox::Save | QMessageBox::Ignore | QMessageBox::Cancel, QMessageBox::Save);
+
+             if (answer == QMessageBox::Save)
+                 saveJson(obj, isArray);
+             if (answer != QMessageBox::Ignore)
+                 return;
+         }
+
+         std::string str = BsonUtils::jsonString(obj, AppRegistry::instance().settingsManager()->jsonOutputMode(),
                  AppRegistry::instance().settingsManager()->uuidEncoding(),
                  AppRegistry::instance().settingsManager()->timeZone(), isArray);
 
          const QString &json = QtUtils::toQString(str);
          clipboard->setText(json);
      }
+
+    void Notifier::onSaveResults()
+    {
+        std::vector<MongoDocumentPtr> documents = resultDocuments();
+        if (documents.empty())
+            return;
+
+        saveDocuments(std::move(documents));
+    }
 }
@@ -2,6 +2,7 @@
 
 #include <QModelIndex>
 
+#include "robomongo/core/Core.h"
 #include "robomongo/core/domain/MongoQueryInfo.h"
 
 QT_BEGIN_NAMESPACE
@@ -16,6 +17,7 @@ namespace Robomongo
     class BsonTreeItem;
     class InsertDocumentResponse;
     struct RemoveDocumentResponse;
+    struct RemoveDocumentsByIdResponse;
 
     namespace detail
     {
@@ -58,26 +60,42 @@ namespace Robomongo
         void onCopyDocument();
         void onCopyTimestamp();
         void onCopyJson();
+        void onSaveResults();
         void handle(InsertDocumentResponse *event);
         void handle(RemoveDocumentResponse *event);
+        void handle(RemoveDocumentsByIdResponse *event);
 
     private Q_SLOTS:
         void onCopyNameDocument();
         void onCopyPathDocument();
+        void onViewBinary();
 
     private:
         MainWindow* mainWindow() const;
+        void publishDocumentsChanged();
+
+        // Documents of the result shown by observer, empty for other models
+        std::vector<MongoDocumentPtr> resultDocuments() const;
+
+        // Asks file name and writes 'documents' in format of its extension (.json, .jsonl,
+        // .csv) in background thread; outcome is logged, or shown if writing failed
+        void saveDocuments(std::vector<MongoDocumentPtr> documents);
+
+        // Writes JSON of Copy JSON into file, instead of clipboard
+        void saveJson(const mongo::BSONObj &obj, bool isArray);
 
         QAction *_deleteDocumentAction;
         QAction *_deleteDocumentsAction;
         QAction *_editDocumentAction;
         QAction *_viewDocumentAction;
+        QAction *_viewBinaryAction;
         QAction *_insertDocumentAction;
         QAction *_copyValueAction;
         QAction *_copyValueNameAction;
         QAction *_copyValuePathAction;
         QAction *_copyTimestampAction;
         QAction *_copyJsonAction;
+        QAction *_saveResultsAction;
         const MongoQueryInfo _queryInfo;
 
         MongoShell *_shell;
@@ -0,0 +1,111 @@
+#include "robomongo/core/domain/OplogTail.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace Robomongo
+{
+    namespace OplogTail
+    {
+        namespace
+        {
+            std::string escapeRegex(const std::string &text)
+            {
+                std::string escaped;
+                for (char const c : text) {
+                    if (std::strchr("\\^$.|?*+()[]{}", c))
+                        escaped += '\\';
+                    escaped += c;
+                }
+                return escaped;
+            }
+        }
+
+        mongo::BSONObj query(const Filter &filter)
+        {
+            mongo::BSONObjBuilder query;
+            if (!filter.from.isNull())
+                query.append("ts", BSON((filter.afterFrom ? "$gt" : "$gte") << filter.from));
+
+            // Database prefix matches its collections, not other databases with longer name
+            if (!filter.nsPrefix.empty()) {
+                std::string const prefix = "^" + escapeRegex(filter.nsPrefix);
+                query.appendRegex("ns", filter.nsPrefix.find('.') == std::string::npos ? prefix + "(\\.|$)"
+                                                                                        : prefix);
+            }
+
+            if (!filter.ops.empty()) {
+                mongo::BSONArrayBuilder ops;
+                for (auto const &op : filter.ops)
+                    ops.append(op);
+                query.append("op", BSON("$in" << ops.arr()));
+            }
+
+            return query.obj();
+        }
+
+        std::string operationName(const std::string &op)
+        {
+            if (op == "i") return "insert";
+            if (op == "u") return "update";
+            if (op == "d") return "delete";
+            if (op == "c") return "command";
+            if (op == "n") return "noop";
+            return op;
+        }
+
+        Buffer::Buffer(size_t capacity) :
+            _entries(std::max<size_t>(capacity, 1)),
+            _first(0),
+            _size(0)
+        {
+        }
+
+        size_t Buffer::append(const std::vector<mongo::BSONObj> &entries)
+        {
+            size_t dropped = 0;
+            for (auto const &entry : entries) {
+                if (_size == _entries.size()) {
+                    _first = (_first + 1) % _entries.size();
+                    --_size;
+                    ++dropped;
+                }
+                _entries[(_first + _size) % _entries.size()] = entry.getOwned();
+                ++_size;
+            }
+            return dropped;
+        }
+
+        void Buffer::dropOldest(size_t count)
+        {
+            count = std::min(count, _size);
+            for (size_t i = 0; i < count; ++i)
+                _entries[(_first + i) % _entries.size()] = mongo::BSONObj();
+            _first = (_first + count) % _entries.size();
+            _size -= count;
+        }
+
+        void Buffer::clear()
+        {
+            std::fill(_entries.begin(), _entries.end(), mongo::BSONObj());
+            _first = 0;
+            _size = 0;
+        }
+
+        size_t Buffer::lowerBound(mongo::Timestamp ts) const
+        {
+            // Entries are in order of 'ts', as in the oplog
+            size_t low = 0, high = _size;
+            while (low < high) {
+                size_t const middle = low + (high - low) / 2;
+                if (at(middle)["ts"].timestamp() < ts)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            return low;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+#include <mongo/bson/timestamp.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Tailing of local.oplog.rs of replica set member for oplog panel (see OplogDialog).
+     *        Entries are filtered by server, so that only matching ones are transferred.
+     */
+    namespace OplogTail
+    {
+        struct Filter
+        {
+            std::string nsPrefix;           // "db" or "db.collection", all namespaces if empty
+            std::vector<std::string> ops;   // "i", "u", "d", "c", "n"; all operations if empty
+            mongo::Timestamp from;          // the newest entry if null
+            bool afterFrom = false;         // entries after 'from' only, i.e. when tail is resumed
+        };
+
+        /**
+         * @brief Filter of find on oplog.rs
+         */
+        mongo::BSONObj query(const Filter &filter);
+
+        /**
+         * @brief Operation of entry as shown in panel, i.e. "insert" for "i"
+         */
+        std::string operationName(const std::string &op);
+
+        /**
+         * @brief Entries in order of the oplog, the oldest are dropped when 'capacity' is reached,
+         *        so that panel keeps bounded memory at high rates
+         */
+        class Buffer
+        {
+        public:
+            explicit Buffer(size_t capacity);
+
+            /**
+             * @return Number of oldest entries dropped to make room, including appended ones,
+             *         if there are more of them than 'capacity'
+             */
+            size_t append(const std::vector<mongo::BSONObj> &entries);
+            void dropOldest(size_t count);
+            void clear();
+
+            size_t size() const { return _size; }
+            size_t capacity() const { return _entries.size(); }
+
+            // Entry 0 is the oldest one
+            const mongo::BSONObj &at(size_t index) const { return _entries[(_first + index) % _entries.size()]; }
+
+            /**
+             * @brief Index of the first entry with 'ts' not less than 'ts', size() if there is none
+             */
+            size_t lowerBound(mongo::Timestamp ts) const;
+
+        private:
+            std::vector<mongo::BSONObj> _entries;
+            size_t _first;
+            size_t _size;
+        };
+    }
+}
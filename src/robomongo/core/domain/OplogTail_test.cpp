@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+#include "OplogTail.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    std::vector<mongo::BSONObj> entries(unsigned first, unsigned count)
+    {
+        std::vector<mongo::BSONObj> result;
+        for (unsigned i = first; i < first + count; ++i)
+            result.push_back(BSON("ts" << mongo::Timestamp(i, 0) << "op" << "i"));
+        return result;
+    }
+}
+
+TEST(oplog_tail_tests, query_of_filter)
+{
+    OplogTail::Filter filter;
+    EXPECT_TRUE(OplogTail::query(filter).isEmpty());
+
+    filter.nsPrefix = "shop";
+    filter.ops = { "i", "u" };
+    filter.from = mongo::Timestamp(100, 2);
+    filter.afterFrom = true;
+
+    mongo::BSONObj const query = OplogTail::query(filter);
+    EXPECT_EQ(mongo::Timestamp(100, 2), query["ts"].Obj()["$gt"].timestamp());
+    EXPECT_EQ(std::string("^shop(\\.|$)"), query["ns"].regex());
+    EXPECT_EQ(2u, query["op"].Obj()["$in"].Array().size());
+
+    filter.nsPrefix = "shop.orders";
+    EXPECT_EQ(std::string("^shop\\.orders"), OplogTail::query(filter)["ns"].regex());
+}
+
+TEST(oplog_tail_tests, buffer_drops_oldest_entries)
+{
+    OplogTail::Buffer buffer(4);
+    EXPECT_EQ(0u, buffer.append(entries(1, 3)));
+    EXPECT_EQ(2u, buffer.append(entries(4, 3)));
+    ASSERT_EQ(4u, buffer.size());
+    EXPECT_EQ(3u, buffer.at(0)["ts"].timestamp().getSecs());
+    EXPECT_EQ(6u, buffer.at(3)["ts"].timestamp().getSecs());
+
+    EXPECT_EQ(7u, buffer.append(entries(7, 7)));
+    EXPECT_EQ(10u, buffer.at(0)["ts"].timestamp().getSecs());
+    EXPECT_EQ(13u, buffer.at(3)["ts"].timestamp().getSecs());
+}
+
+TEST(oplog_tail_tests, buffer_seek_by_timestamp)
+{
+    OplogTail::Buffer buffer(8);
+    buffer.append(entries(10, 5));
+    EXPECT_EQ(0u, buffer.lowerBound(mongo::Timestamp(1, 0)));
+    EXPECT_EQ(2u, buffer.lowerBound(mongo::Timestamp(12, 0)));
+    EXPECT_EQ(3u, buffer.lowerBound(mongo::Timestamp(12, 1)));
+    EXPECT_EQ(5u, buffer.lowerBound(mongo::Timestamp(20, 0)));
+}
@@ -0,0 +1,105 @@
+#include "robomongo/core/domain/PagePatch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "robomongo/core/domain/MongoDocument.h"
+
+namespace
+{
+    using namespace Robomongo;
+
+    // Type and bytes of _id value, or bytes of the whole document without _id
+    std::string pairingKey(const mongo::BSONObj &doc)
+    {
+        mongo::BSONElement const id = doc.isArray() ? mongo::BSONElement() : doc["_id"];
+        if (id.eoo())
+            return std::string("d") + std::string(doc.objdata(), doc.objsize());
+
+        return std::string("i") + static_cast<char>(id.type()) + std::string(id.value(), id.valuesize());
+    }
+
+    bool sameBytes(const mongo::BSONObj &left, const mongo::BSONObj &right)
+    {
+        return left.objsize() == right.objsize() &&
+               std::memcmp(left.objdata(), right.objdata(), left.objsize()) == 0;
+    }
+
+    /**
+     * @return Positions of the longest strictly increasing subsequence of 'values'
+     *         (patience sorting, O(n log n))
+     */
+    std::vector<size_t> longestIncreasing(const std::vector<int> &values)
+    {
+        std::vector<size_t> tails;                  // position of the last value of subsequence of length i + 1
+        std::vector<size_t> previous(values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            auto const it = std::lower_bound(tails.begin(), tails.end(), values[i],
+                [&values](size_t position, int value) { return values[position] < value; });
+            previous[i] = it == tails.begin() ? i : *(it - 1);
+            if (it == tails.end())
+                tails.push_back(i);
+            else
+                *it = i;
+        }
+
+        std::vector<size_t> positions(tails.size());
+        if (!tails.empty()) {
+            size_t position = tails.back();
+            for (size_t k = tails.size(); k > 0; --k) {
+                positions[k - 1] = position;
+                position = previous[position];
+            }
+        }
+        return positions;
+    }
+}
+
+namespace Robomongo
+{
+    PagePatch PagePatch::compute(const std::vector<MongoDocumentPtr> &before,
+                                 const std::vector<MongoDocumentPtr> &after)
+    {
+        // Duplicate keys (i.e. equal documents without _id) are paired in order
+        std::unordered_map<std::string, std::deque<int>> oldRows;
+        for (size_t row = 0; row < before.size(); ++row)
+            oldRows[pairingKey(before[row]->bsonObj())].push_back(static_cast<int>(row));
+
+        std::vector<int> pairedOld;     // old row of paired new rows, in order of new page
+        std::vector<int> pairedNew;
+        for (size_t row = 0; row < after.size(); ++row) {
+            auto const it = oldRows.find(pairingKey(after[row]->bsonObj()));
+            if (it == oldRows.end() || it->second.empty())
+                continue;
+
+            pairedOld.push_back(it->second.front());
+            pairedNew.push_back(static_cast<int>(row));
+            it->second.pop_front();
+        }
+
+        std::vector<bool> keptOld(before.size(), false);
+        std::vector<bool> keptNew(after.size(), false);
+        PagePatch patch;
+        for (size_t const position : longestIncreasing(pairedOld)) {
+            int const oldRow = pairedOld[position];
+            int const newRow = pairedNew[position];
+            keptOld[oldRow] = true;
+            keptNew[newRow] = true;
+            if (!sameBytes(before[oldRow]->bsonObj(), after[newRow]->bsonObj()))
+                patch.updated.push_back(newRow);
+        }
+
+        for (size_t row = 0; row < before.size(); ++row) {
+            if (!keptOld[row])
+                patch.removed.push_back(static_cast<int>(row));
+        }
+        for (size_t row = 0; row < after.size(); ++row) {
+            if (!keptNew[row])
+                patch.inserted.push_back(static_cast<int>(row));
+        }
+        return patch;
+    }
+}
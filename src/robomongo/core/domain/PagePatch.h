@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+#include "robomongo/core/Core.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Minimal changes turning shown page of documents into the same page read again
+     *        (see OutputItemContentWidget::refresh()). Documents are paired by _id (documents
+     *        without _id by content), pairs which keep their relative order are kept, all other
+     *        documents are removed and inserted. Kept pairs, which differ in bytes, are updated.
+     *
+     *  Applied in order: rows 'removed' (of old page) are removed, then documents of rows
+     *  'inserted' (of new page) are inserted at those rows. Row of every document is then its
+     *  row in new page, and rows 'updated' are replaced by their documents of new page.
+     */
+    struct PagePatch
+    {
+        std::vector<int> removed;   // ascending
+        std::vector<int> inserted;  // ascending
+        std::vector<int> updated;   // ascending
+
+        bool isEmpty() const { return removed.empty() && inserted.empty() && updated.empty(); }
+
+        static PagePatch compute(const std::vector<MongoDocumentPtr> &before,
+                                 const std::vector<MongoDocumentPtr> &after);
+    };
+}
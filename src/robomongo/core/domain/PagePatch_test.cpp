@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+#include "PagePatch.h"
+#include "MongoDocument.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    // Documents { _id: id, v: value } for "id:value" pairs, value 0 if omitted
+    std::vector<MongoDocumentPtr> page(const std::vector<std::pair<int, int>> &docs)
+    {
+        std::vector<mongo::BSONObj> objs;
+        for (auto const &doc : docs)
+            objs.push_back(BSON("_id" << doc.first << "v" << doc.second));
+        return MongoDocument::fromBatch(objs);
+    }
+}
+
+TEST(page_patch_tests, unchanged_page_is_empty_patch)
+{
+    auto const before = page({ {1, 0}, {2, 0}, {3, 0} });
+    EXPECT_TRUE(PagePatch::compute(before, page({ {1, 0}, {2, 0}, {3, 0} })).isEmpty());
+    EXPECT_TRUE(PagePatch::compute({}, {}).isEmpty());
+}
+
+TEST(page_patch_tests, changes_are_minimal)
+{
+    auto const before = page({ {1, 0}, {2, 0}, {3, 0}, {4, 0}, {5, 0} });
+    auto const after = page({ {1, 0}, {3, 7}, {6, 0}, {4, 0}, {5, 0} });
+    PagePatch const patch = PagePatch::compute(before, after);
+    EXPECT_EQ(std::vector<int>({ 1 }), patch.removed);      // _id 2
+    EXPECT_EQ(std::vector<int>({ 2 }), patch.inserted);     // _id 6
+    EXPECT_EQ(std::vector<int>({ 1 }), patch.updated);      // _id 3
+}
+
+TEST(page_patch_tests, moved_document_is_removed_and_inserted)
+{
+    auto const before = page({ {1, 0}, {2, 0}, {3, 0}, {4, 0} });
+    auto const after = page({ {2, 0}, {3, 0}, {4, 0}, {1, 0} });
+    PagePatch const patch = PagePatch::compute(before, after);
+    EXPECT_EQ(std::vector<int>({ 0 }), patch.removed);
+    EXPECT_EQ(std::vector<int>({ 3 }), patch.inserted);
+    EXPECT_TRUE(patch.updated.empty());
+}
+
+TEST(page_patch_tests, documents_without_id_are_paired_by_content)
+{
+    auto const before = MongoDocument::fromBatch({ BSON("a" << 1), BSON("a" << 1), BSON("a" << 2) });
+    auto const after = MongoDocument::fromBatch({ BSON("a" << 1), BSON("a" << 3), BSON("a" << 1) });
+    PagePatch const patch = PagePatch::compute(before, after);
+    EXPECT_EQ(std::vector<int>({ 2 }), patch.removed);
+    EXPECT_EQ(std::vector<int>({ 1 }), patch.inserted);
+    EXPECT_TRUE(patch.updated.empty());
+}
@@ -0,0 +1,87 @@
+#include "robomongo/core/domain/PipelinePreview.h"
+
+#include <cstring>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace Robomongo
+{
+    namespace PipelinePreview
+    {
+        const char *const Comment = "Robo 3T pipeline preview";
+
+        namespace
+        {
+            // Stages, that run before input is capped
+            bool isLeadingStage(const char *name)
+            {
+                for (const char *leading : { "$match", "$geoNear", "$search", "$searchMeta", 
+                                             "$collStats", "$indexStats" }) {
+                    if (std::strcmp(name, leading) == 0)
+                        return true;
+                }
+                return false;
+            }
+        }
+
+        std::vector<mongo::BSONObj> previewedStages(const mongo::BSONObj &pipeline)
+        {
+            std::vector<mongo::BSONObj> stages;
+            for (mongo::BSONObjIterator it(pipeline); it.more();) {
+                mongo::BSONElement const element = it.next();
+                if (element.type() != mongo::Object)
+                    continue;
+
+                mongo::BSONObj const stage = element.Obj();
+                char const *name = stage.firstElementFieldName();
+                if (std::strcmp(name, "$out") == 0 || std::strcmp(name, "$merge") == 0)
+                    break;
+                stages.push_back(stage.getOwned());
+            }
+            return stages;
+        }
+
+        mongo::BSONArray prefixPipeline(const std::vector<mongo::BSONObj> &stages, size_t count,
+                                        int sampleSize)
+        {
+            mongo::BSONArrayBuilder pipeline;
+            size_t i = 0;
+            for (; i < stages.size() && isLeadingStage(stages[i].firstElementFieldName()); ++i) {
+                if (i < count)
+                    pipeline.append(stages[i]);
+            }
+            pipeline.append(BSON("$limit" << sampleSize));
+            for (; i < count && i < stages.size(); ++i)
+                pipeline.append(stages[i]);
+
+            // Count and the first documents in one result
+            pipeline.append(BSON("$facet" << BSON(
+                "count" << BSON_ARRAY(BSON("$count" << "n")) <<
+                "documents" << BSON_ARRAY(BSON("$limit" << ShownDocuments)))));
+            return pipeline.arr();
+        }
+
+        mongo::BSONObj previewOptions(const mongo::BSONObj &options)
+        {
+            mongo::BSONObjBuilder builder;
+            for (mongo::BSONObjIterator it(options); it.more();) {
+                mongo::BSONElement const option = it.next();
+                if (std::strcmp(option.fieldName(), "comment") != 0)
+                    builder.append(option);
+            }
+            builder.append("comment", Comment);
+            return builder.obj();
+        }
+
+        void readResult(const mongo::BSONObj &result, StageResult &stage)
+        {
+            // $count gives no document for empty input
+            mongo::BSONObj const count = result.getObjectField("count");
+            stage.count = count.isEmpty() ? 0 : count.firstElement().Obj()["n"].safeNumberLong();
+
+            stage.documents.clear();
+            for (mongo::BSONObjIterator it(result.getObjectField("documents")); it.more();)
+                stage.documents.push_back(MongoDocumentPtr(new MongoDocument(it.next().Obj().getOwned())));
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/domain/MongoDocument.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Stage by stage preview of aggregation pipeline. Every prefix of pipeline runs
+     *        on the same capped input, so that shape and count of documents after each stage
+     *        are seen without running the whole pipeline on the whole collection.
+     */
+    namespace PipelinePreview
+    {
+        constexpr int DefaultSampleSize = 1000;
+
+        // Documents shown for every stage, the rest is only counted
+        constexpr int ShownDocuments = 20;
+
+        // Comment of preview aggregations, they are told from user ones in currentOp by it
+        extern const char *const Comment;
+
+        struct StageResult
+        {
+            std::string name;       // i.e. "$group"
+            std::string stage;      // JSON of stage
+            long long count = 0;    // documents after stage
+            long long elapsedMs = 0;
+            std::vector<MongoDocumentPtr> documents;    // at most ShownDocuments
+            std::string error;      // prefix failed, count and documents are empty
+        };
+
+        /**
+         * @brief Stages that are previewed: all before the first $out or $merge, which
+         *        would write into collection
+         * @param pipeline Array of stages, as AggrInfo::pipeline
+         */
+        std::vector<mongo::BSONObj> previewedStages(const mongo::BSONObj &pipeline);
+
+        /**
+         * @brief Pipeline of the first 'count' stages, on input capped to 'sampleSize'
+         *        documents. Cap is placed after leading $match (and other stages that must be
+         *        first), so that they still use indexes. Result is one document, see readResult().
+         */
+        mongo::BSONArray prefixPipeline(const std::vector<mongo::BSONObj> &stages, size_t count,
+                                        int sampleSize);
+
+        // Options of aggregation with Comment, other options are kept
+        mongo::BSONObj previewOptions(const mongo::BSONObj &options);
+
+        // Fills count and documents of 'stage' from the only document of prefixPipeline() result
+        void readResult(const mongo::BSONObj &result, StageResult &stage);
+    }
+}
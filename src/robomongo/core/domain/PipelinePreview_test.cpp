@@ -0,0 +1,54 @@
+#include "gtest/gtest.h"
+#include "PipelinePreview.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    std::vector<std::string> stageNames(const mongo::BSONArray &pipeline)
+    {
+        std::vector<std::string> names;
+        for (mongo::BSONObjIterator it(pipeline); it.more();)
+            names.push_back(it.next().Obj().firstElementFieldName());
+        return names;
+    }
+}
+
+TEST(pipeline_preview_tests, stages_before_out)
+{
+    mongo::BSONArray const pipeline = BSON_ARRAY(
+        BSON("$match" << BSON("a" << 1)) << BSON("$group" << BSON("_id" << "$b")) << 
+        BSON("$out" << "result") << BSON("$project" << BSON("x" << 1)));
+    std::vector<mongo::BSONObj> const stages = PipelinePreview::previewedStages(pipeline);
+    ASSERT_EQ(2u, stages.size());
+    EXPECT_STREQ("$group", stages[1].firstElementFieldName());
+}
+
+TEST(pipeline_preview_tests, cap_after_leading_match)
+{
+    std::vector<mongo::BSONObj> const stages {
+        BSON("$match" << BSON("a" << 1)), BSON("$unwind" << "$b"), BSON("$group" << BSON("_id" << "$b"))
+    };
+
+    std::vector<std::string> const second = stageNames(PipelinePreview::prefixPipeline(stages, 2, 100));
+    EXPECT_EQ((std::vector<std::string> { "$match", "$limit", "$unwind", "$facet" }), second);
+
+    // Input of the first stage is capped after it too, as for all other prefixes
+    std::vector<std::string> const first = stageNames(PipelinePreview::prefixPipeline(stages, 1, 100));
+    EXPECT_EQ((std::vector<std::string> { "$match", "$limit", "$facet" }), first);
+}
+
+TEST(pipeline_preview_tests, read_result)
+{
+    PipelinePreview::StageResult stage;
+    PipelinePreview::readResult(BSON("count" << BSON_ARRAY(BSON("n" << 42)) << 
+                                     "documents" << BSON_ARRAY(BSON("_id" << 1) << BSON("_id" << 2))), stage);
+    EXPECT_EQ(42, stage.count);
+    EXPECT_EQ(2u, stage.documents.size());
+
+    PipelinePreview::readResult(BSON("count" << mongo::BSONArray() << "documents" << mongo::BSONArray()), stage);
+    EXPECT_EQ(0, stage.count);
+    EXPECT_TRUE(stage.documents.empty());
+}
@@ -0,0 +1,198 @@
+#include "robomongo/core/domain/PlanCache.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/domain/ExplainPlan.h"
+#include "robomongo/core/utils/BsonUtils.h"
+
+namespace Robomongo
+{
+    namespace PlanCache
+    {
+        namespace
+        {
+            // Slot based plan is one long text, its first line names the root stage
+            const size_t MaxSbeSummary = 80;
+
+            std::string json(const mongo::BSONObj &obj)
+            {
+                return BsonUtils::jsonString(obj, mongo::TenGen, 0, DefaultEncoding, Utc);
+            }
+
+            bool isOperator(const char *field)
+            {
+                return field[0] == '$';
+            }
+
+            std::string shapeOfValue(const mongo::BSONElement &element);
+
+            std::string shapeOfArray(const mongo::BSONObj &array)
+            {
+                std::string text = "[ ";
+                bool first = true;
+                for (mongo::BSONObjIterator it(array); it.more();) {
+                    mongo::BSONElement const item = it.next();
+                    text += first ? "" : ", ";
+                    text += item.type() == mongo::Object ? shapeOf(item.Obj()) : "?";
+                    first = false;
+                }
+                return text + " ]";
+            }
+
+            // Operators keep their names, values become "?"
+            std::string shapeOfValue(const mongo::BSONElement &element)
+            {
+                char const *field = element.fieldName();
+                bool const logical = std::string("$and") == field || std::string("$or") == field ||
+                                     std::string("$nor") == field;
+                if (logical && element.type() == mongo::Array)
+                    return shapeOfArray(element.Obj());
+
+                if (element.type() == mongo::Object) {
+                    mongo::BSONObj const obj = element.Obj();
+                    if (!obj.isEmpty() && isOperator(obj.firstElementFieldName()))
+                        return shapeOf(obj);
+                }
+                return "?";
+            }
+        }
+
+        mongo::BSONArray pipeline(int limit)
+        {
+            return BSON_ARRAY(BSON("$planCacheStats" << mongo::BSONObj()) <<
+                              BSON("$project" << BSON("creationExecStats" << 0 << "candidatePlanScores" << 0)) <<
+                              BSON("$limit" << limit));
+        }
+
+        PlanCacheEntryInfo entryFromStats(const mongo::BSONObj &stats)
+        {
+            PlanCacheEntryInfo entry;
+            entry._host = stats.getStringField("host");
+            if (stats.hasField("shard"))
+                entry._host = std::string(stats.getStringField("shard")) + " " + entry._host;
+            entry._queryHash = stats.hasField("planCacheShapeHash") ? stats.getStringField("planCacheShapeHash")
+                                                                     : stats.getStringField("queryHash");
+            entry._planCacheKey = stats.getStringField("planCacheKey");
+            entry._engine = std::string(stats.getStringField("version")) == "2" ? "sbe" : "classic";
+
+            mongo::BSONObj const query = stats.getObjectField("createdFromQuery");
+            if (!query.isEmpty()) {
+                entry._shape = shapeOf(query.getObjectField("query"));
+                if (!query.getObjectField("sort").isEmpty())
+                    entry._shape += " sort " + json(query.getObjectField("sort"));
+                if (!query.getObjectField("projection").isEmpty())
+                    entry._shape += " projection " + json(query.getObjectField("projection"));
+            }
+
+            mongo::BSONObj const plan = stats.getObjectField("cachedPlan");
+            ExplainPlan::Stage const tree = ExplainPlan::parseTree(plan);
+            if (!tree.stage.empty()) {
+                entry._planSummary = ExplainPlan::summary(tree);
+            }
+            else if (plan["stages"].type() == mongo::String) {
+                std::string const stages = plan.getStringField("stages");
+                entry._planSummary = stages.substr(0, std::min(stages.find('\n'), MaxSbeSummary));
+            }
+
+            mongo::BSONElement const works = stats["works"];
+            entry._works = works.isNumber() ? works.safeNumberLong() : -1;
+            entry._isActive = stats["isActive"].trueValue();
+            entry._isPinned = stats["isPinned"].trueValue();
+            if (stats["timeOfCreation"].type() == mongo::Date)
+                entry._createdMs = stats["timeOfCreation"].date().toMillisSinceEpoch();
+            return entry;
+        }
+
+        std::string shapeOf(const mongo::BSONObj &filter)
+        {
+            if (filter.isEmpty())
+                return "{}";
+
+            std::string text = "{ ";
+            bool first = true;
+            for (mongo::BSONObjIterator it(filter); it.more();) {
+                mongo::BSONElement const element = it.next();
+                text += first ? "" : ", ";
+                text += std::string(element.fieldName()) + ": " + shapeOfValue(element);
+                first = false;
+            }
+            return text + " }";
+        }
+
+        std::vector<ShapeGroup> groupByShape(const std::vector<PlanCacheEntryInfo> &entries)
+        {
+            std::vector<ShapeGroup> groups;
+            std::map<std::string, size_t> byKey;
+            std::vector<std::set<std::string>> plans;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                PlanCacheEntryInfo const &entry = entries[i];
+                std::string const key = entry._queryHash.empty() ? entry._shape : entry._queryHash;
+                auto found = byKey.find(key);
+                if (found == byKey.end()) {
+                    found = byKey.emplace(key, groups.size()).first;
+                    groups.push_back(ShapeGroup());
+                    groups.back().queryHash = entry._queryHash;
+                    plans.push_back(std::set<std::string>());
+                }
+
+                ShapeGroup &group = groups[found->second];
+                if (group.shape.empty())
+                    group.shape = entry._shape;
+                group.entries.push_back(i);
+                group.active += entry._isActive ? 1 : 0;
+                plans[found->second].insert(entry._planSummary);
+            }
+
+            for (size_t i = 0; i < groups.size(); ++i)
+                groups[i].plans = static_cast<int>(plans[i].size());
+
+            std::stable_sort(groups.begin(), groups.end(), [](const ShapeGroup &left, const ShapeGroup &right) {
+                if (left.plans != right.plans)
+                    return left.plans > right.plans;
+                return left.entries.size() > right.entries.size();
+            });
+            return groups;
+        }
+
+        std::string entryKey(const PlanCacheEntryInfo &entry)
+        {
+            return entry._host + "/" + entry._queryHash + "/" + entry._planCacheKey;
+        }
+
+        std::vector<Change> diff(const std::vector<PlanCacheEntryInfo> &previous,
+                                 const std::vector<PlanCacheEntryInfo> &current)
+        {
+            std::map<std::string, const PlanCacheEntryInfo *> before;
+            for (auto const &entry : previous)
+                before[entryKey(entry)] = &entry;
+
+            std::vector<Change> changes;
+            for (auto const &entry : current) {
+                std::string const key = entryKey(entry);
+                auto const found = before.find(key);
+                if (found == before.end()) {
+                    changes.push_back({ Change::Added, key, std::string(), entry._planSummary });
+                    continue;
+                }
+
+                PlanCacheEntryInfo const &old = *found->second;
+                before.erase(found);
+                if (old._planSummary != entry._planSummary)
+                    changes.push_back({ Change::PlanChanged, key, old._planSummary, entry._planSummary });
+                else if (old._createdMs != entry._createdMs)
+                    changes.push_back({ Change::Replanned, key, old._planSummary, entry._planSummary });
+                if (old._isActive != entry._isActive)
+                    changes.push_back({ entry._isActive ? Change::Activated : Change::Deactivated, key,
+                                        old._planSummary, entry._planSummary });
+            }
+
+            for (auto const &removed : before)
+                changes.push_back({ Change::Removed, removed.first, removed.second->_planSummary, std::string() });
+            return changes;
+        }
+    }
+}
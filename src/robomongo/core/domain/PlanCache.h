@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/events/MongoEventsInfo.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Plan cache of collection read with $planCacheStats (MongoDB 4.2+), grouped by query
+     *        shape. Snapshots read one after another are compared entry by entry, so that flips
+     *        of cached plan (the usual cause of sudden latency regressions) are seen as they
+     *        happen.
+     */
+    namespace PlanCache
+    {
+        // Pipeline of aggregation on collection, statistics of candidate plans are left out
+        mongo::BSONArray pipeline(int limit);
+
+        // Parses one document of $planCacheStats, classic or slot based engine
+        PlanCacheEntryInfo entryFromStats(const mongo::BSONObj &stats);
+
+        // I.e. { a: ?, b: { $gt: ? } }: filter without values
+        std::string shapeOf(const mongo::BSONObj &filter);
+
+        struct ShapeGroup
+        {
+            std::string queryHash;          // empty, if server does not report it
+            std::string shape;
+            std::vector<size_t> entries;    // indexes into entries of snapshot
+            int active = 0;
+            int plans = 0;                  // distinct cached plans, more than one is suspicious
+        };
+
+        /**
+         * @brief Entries grouped by queryHash (or shape, if hash is missing). Shapes with
+         *        several cached plans go first, then the ones with more entries.
+         */
+        std::vector<ShapeGroup> groupByShape(const std::vector<PlanCacheEntryInfo> &entries);
+
+        // Identity of entry between snapshots
+        std::string entryKey(const PlanCacheEntryInfo &entry);
+
+        struct Change
+        {
+            enum Kind { Added, Removed, PlanChanged, Replanned, Activated, Deactivated };
+
+            Kind kind;
+            std::string key;                // see entryKey()
+            std::string oldPlan;            // PlanChanged, Removed
+            std::string newPlan;            // PlanChanged, Added
+        };
+
+        // Differences of 'current' snapshot from 'previous' one
+        std::vector<Change> diff(const std::vector<PlanCacheEntryInfo> &previous,
+                                 const std::vector<PlanCacheEntryInfo> &current);
+    }
+}
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+#include "PlanCache.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    PlanCacheEntryInfo entry(const std::string &hash, const std::string &key, const std::string &plan,
+                             bool active = true, long long createdMs = 1)
+    {
+        PlanCacheEntryInfo info;
+        info._queryHash = hash;
+        info._planCacheKey = key;
+        info._planSummary = plan;
+        info._isActive = active;
+        info._createdMs = createdMs;
+        return info;
+    }
+}
+
+TEST(plan_cache_tests, shape_without_values)
+{
+    EXPECT_EQ("{}", PlanCache::shapeOf(mongo::BSONObj()));
+    EXPECT_EQ("{ a: ?, b: { $gt: ?, $lt: ? } }",
+              PlanCache::shapeOf(BSON("a" << 5 << "b" << BSON("$gt" << 1 << "$lt" << 9))));
+    EXPECT_EQ("{ $or: [ { a: ? }, { c: { $in: ? } } ] }",
+              PlanCache::shapeOf(BSON("$or" << BSON_ARRAY(BSON("a" << "x") << BSON("c" << BSON("$in" << BSON_ARRAY(1 << 2)))))));
+    EXPECT_EQ("{ d: ? }", PlanCache::shapeOf(BSON("d" << BSON("x" << 1))));
+}
+
+TEST(plan_cache_tests, entry_of_classic_engine)
+{
+    mongo::BSONObj const stats = BSON(
+        "createdFromQuery" << BSON("query" << BSON("a" << 1) << "sort" << BSON("b" << -1) << "projection" << mongo::BSONObj()) <<
+        "queryHash" << "8AB1C2D3" << "planCacheKey" << "11AA22BB" << "isActive" << true << "works" << 7 <<
+        "cachedPlan" << BSON("stage" << "FETCH" << "inputStage" << BSON("stage" << "IXSCAN" << "indexName" << "a_1_b_-1")) <<
+        "host" << "db1:27017");
+
+    PlanCacheEntryInfo const info = PlanCache::entryFromStats(stats);
+    EXPECT_EQ("8AB1C2D3", info._queryHash);
+    EXPECT_EQ("11AA22BB", info._planCacheKey);
+    EXPECT_EQ("db1:27017", info._host);
+    EXPECT_EQ("classic", info._engine);
+    EXPECT_EQ(0u, info._shape.find("{ a: ? } sort "));
+    EXPECT_EQ("IXSCAN a_1_b_-1", info._planSummary);
+    EXPECT_EQ(7, info._works);
+    EXPECT_TRUE(info._isActive);
+
+    PlanCacheEntryInfo const sbe = PlanCache::entryFromStats(BSON(
+        "version" << "2" << "planCacheShapeHash" << "FF00" << "queryHash" << "EE00" <<
+        "cachedPlan" << BSON("slots" << "$$RESULT=s5" << "stages" << "[2] project [s5]\n[1] scan s1")));
+    EXPECT_EQ("FF00", sbe._queryHash);
+    EXPECT_EQ("sbe", sbe._engine);
+    EXPECT_EQ("[2] project [s5]", sbe._planSummary);
+    EXPECT_EQ(-1, sbe._works);
+}
+
+TEST(plan_cache_tests, groups_with_several_plans_first)
+{
+    std::vector<PlanCacheEntryInfo> const entries = {
+        entry("A", "1", "IXSCAN a_1"), entry("A", "2", "IXSCAN a_1", false),
+        entry("B", "3", "IXSCAN b_1"), entry("B", "4", "COLLSCAN")
+    };
+
+    std::vector<PlanCache::ShapeGroup> const groups = PlanCache::groupByShape(entries);
+    ASSERT_EQ(2u, groups.size());
+    EXPECT_EQ("B", groups[0].queryHash);
+    EXPECT_EQ(2, groups[0].plans);
+    EXPECT_EQ("A", groups[1].queryHash);
+    EXPECT_EQ(1, groups[1].plans);
+    EXPECT_EQ(1, groups[1].active);
+    EXPECT_EQ(2u, groups[1].entries.size());
+}
+
+TEST(plan_cache_tests, diff_of_snapshots)
+{
+    std::vector<PlanCacheEntryInfo> const previous = {
+        entry("A", "1", "IXSCAN a_1"), entry("B", "2", "IXSCAN b_1", false), entry("C", "3", "COLLSCAN"),
+        entry("D", "4", "IXSCAN d_1")
+    };
+    std::vector<PlanCacheEntryInfo> const current = {
+        entry("A", "1", "COLLSCAN"), entry("B", "2", "IXSCAN b_1", true), entry("D", "4", "IXSCAN d_1", true, 2),
+        entry("E", "5", "IXSCAN e_1")
+    };
+
+    std::vector<PlanCache::Change> const changes = PlanCache::diff(previous, current);
+    ASSERT_EQ(5u, changes.size());
+    EXPECT_EQ(PlanCache::Change::PlanChanged, changes[0].kind);
+    EXPECT_EQ("IXSCAN a_1", changes[0].oldPlan);
+    EXPECT_EQ("COLLSCAN", changes[0].newPlan);
+    EXPECT_EQ(PlanCache::Change::Activated, changes[1].kind);
+    EXPECT_EQ(PlanCache::Change::Replanned, changes[2].kind);
+    EXPECT_EQ(PlanCache::Change::Added, changes[3].kind);
+    EXPECT_EQ(PlanCache::Change::Removed, changes[4].kind);
+    EXPECT_EQ(PlanCache::entryKey(previous[2]), changes[4].key);
+}
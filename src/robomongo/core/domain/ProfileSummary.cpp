@@ -0,0 +1,121 @@
+#include "robomongo/core/domain/ProfileSummary.h"
+
+#include <algorithm>
+#include <string>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace Robomongo
+{
+    namespace ProfileSummary
+    {
+        const char *const Comment = "Robo 3T profile summary";
+
+        namespace
+        {
+            std::string bucketField(size_t i)
+            {
+                return "le" + std::to_string(UpperBoundsMs[i]);
+            }
+
+            // Field names of document at 'path': { $map: { input: { $objectToArray: ... }, in: "$$this.k" } }
+            mongo::BSONObj fieldNames(const mongo::BSONObj &document)
+            {
+                return BSON("$map" << BSON("input" << BSON("$objectToArray" << document) << "in" << "$$this.k"));
+            }
+
+            mongo::BSONObj ifNull(const char *path, const mongo::BSONObj &otherwise)
+            {
+                return BSON("$ifNull" << BSON_ARRAY(path << otherwise));
+            }
+
+            // Upper bound of bucket with p-th percentile, as RttHistogram::percentileMs()
+            double percentile(const mongo::BSONObj &group, long long count, double p)
+            {
+                auto const rank = std::max(static_cast<long long>(count * p / 100.0 + 0.5), 1LL);
+                for (size_t i = 0; i < UpperBoundsMs.size(); ++i) {
+                    if (group[bucketField(i)].safeNumberLong() >= rank)
+                        return static_cast<double>(UpperBoundsMs[i]);
+                }
+                return -1;
+            }
+        }
+
+        mongo::BSONArray pipeline(long long sinceMs, int minMillis, int limit)
+        {
+            mongo::BSONObjBuilder match;
+            match.append("command.comment", BSON("$ne" << Comment));
+            if (sinceMs > 0)
+                match.append("ts", BSON("$gte" << mongo::Date_t::fromMillisSinceEpoch(sinceMs)));
+            if (minMillis > 0)
+                match.append("millis", BSON("$gte" << minMillis));
+
+            // Shape is queryHash (4.2+) or field names of filter of find (3.6+), update (3.6+)
+            // or legacy query
+            mongo::BSONObj const filter = ifNull("$command.filter", ifNull("$command.q", ifNull("$query", mongo::BSONObj())));
+            mongo::BSONObj const command = BSON("$arrayElemAt" << BSON_ARRAY(fieldNames(ifNull("$command", mongo::BSONObj())) << 0));
+            mongo::BSONObj const id = BSON("ns" << "$ns" << "op" << "$op" << "command" << command <<
+                                           "shape" << BSON("$ifNull" << BSON_ARRAY("$queryHash" << fieldNames(filter))) <<
+                                           "plan" << "$planSummary");
+
+            mongo::BSONObjBuilder group;
+            group.append("_id", id);
+            group.append("count", BSON("$sum" << 1));
+            group.append("totalMillis", BSON("$sum" << "$millis"));
+            group.append("maxMillis", BSON("$max" << "$millis"));
+            group.append("docsExamined", BSON("$sum" << "$docsExamined"));
+            group.append("keysExamined", BSON("$sum" << "$keysExamined"));
+            group.append("nreturned", BSON("$sum" << "$nreturned"));
+            group.append("lastSeen", BSON("$max" << "$ts"));
+
+            // Cumulative buckets: operations that took at most the bound
+            for (size_t i = 0; i < UpperBoundsMs.size(); ++i) {
+                mongo::BSONObj const isBelow = BSON("$lte" << BSON_ARRAY("$millis" << UpperBoundsMs[i]));
+                group.append(bucketField(i), BSON("$sum" << BSON("$cond" << BSON_ARRAY(isBelow << 1 << 0))));
+            }
+
+            mongo::BSONArrayBuilder stages;
+            stages.append(BSON("$match" << match.obj()));
+            stages.append(BSON("$group" << group.obj()));
+            stages.append(BSON("$sort" << BSON("totalMillis" << -1)));
+            stages.append(BSON("$limit" << limit));
+            return stages.arr();
+        }
+
+        ProfileShapeInfo shapeFromGroup(const mongo::BSONObj &group)
+        {
+            mongo::BSONObj const id = group.getObjectField("_id");
+
+            ProfileShapeInfo info;
+            info._ns = id.getStringField("ns");
+            info._op = id.getStringField("op");
+            info._command = id.getStringField("command");
+            info._planSummary = id.getStringField("plan");
+
+            mongo::BSONElement const shape = id["shape"];
+            if (shape.type() == mongo::String) {
+                info._shape = shape.String();
+            }
+            else if (shape.type() == mongo::Array) {
+                for (mongo::BSONObjIterator it(shape.Obj()); it.more();) {
+                    if (!info._shape.empty())
+                        info._shape += ", ";
+                    info._shape += it.next().str();
+                }
+            }
+
+            info._count = group["count"].safeNumberLong();
+            info._totalMillis = group["totalMillis"].safeNumberLong();
+            info._maxMillis = group["maxMillis"].safeNumberLong();
+            info._docsExamined = group["docsExamined"].safeNumberLong();
+            info._keysExamined = group["keysExamined"].safeNumberLong();
+            info._nreturned = group["nreturned"].safeNumberLong();
+            if (group["lastSeen"].type() == mongo::Date)
+                info._lastSeenMs = group["lastSeen"].date().toMillisSinceEpoch();
+
+            info._p50Ms = percentile(group, info._count, 50);
+            info._p95Ms = percentile(group, info._count, 95);
+            return info;
+        }
+    }
+}
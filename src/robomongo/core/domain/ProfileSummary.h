@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/events/MongoEventsInfo.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Aggregation of system.profile by query shape, that runs on server, so that
+     *        only one document per shape is read instead of every profiled operation.
+     *        Durations are counted in buckets with fixed upper bounds, which give percentiles
+     *        on all server versions ($percentile needs 7.0).
+     */
+    namespace ProfileSummary
+    {
+        constexpr std::array<long long, 15> UpperBoundsMs {
+            1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 30000, 60000
+        };
+
+        // Comment of aggregation, it is excluded from its own results
+        extern const char *const Comment;
+
+        /**
+         * @param sinceMs Only operations since this time (ms since epoch), 0 for all
+         * @param minMillis Only operations that took at least so long
+         * @param limit Number of shapes, the ones with the largest total time
+         */
+        mongo::BSONArray pipeline(long long sinceMs, int minMillis, int limit);
+
+        // Parses one document of pipeline() result
+        ProfileShapeInfo shapeFromGroup(const mongo::BSONObj &group);
+    }
+}
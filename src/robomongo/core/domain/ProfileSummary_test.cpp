@@ -0,0 +1,46 @@
+#include "gtest/gtest.h"
+#include "ProfileSummary.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    // Group of 'count' operations, the first 'fast' of them took at most 5 ms, all at most 500 ms
+    mongo::BSONObj group(long long count, long long fast)
+    {
+        mongo::BSONObjBuilder builder;
+        builder.append("_id", BSON("ns" << "db.coll" << "op" << "query" << "command" << "find" << 
+                                   "shape" << BSON_ARRAY("a" << "b") << "plan" << "IXSCAN { a: 1 }"));
+        builder.append("count", count);
+        builder.append("docsExamined", 40LL);
+        builder.append("nreturned", 10LL);
+        for (long long const bound : ProfileSummary::UpperBoundsMs) {
+            long long const below = bound < 5 ? 0 : bound < 500 ? fast : count;
+            builder.append("le" + std::to_string(bound), below);
+        }
+        return builder.obj();
+    }
+}
+
+TEST(profile_summary_tests, shape_and_percentiles)
+{
+    ProfileShapeInfo const info = ProfileSummary::shapeFromGroup(group(100, 90));
+    EXPECT_EQ("db.coll", info._ns);
+    EXPECT_EQ("find", info._command);
+    EXPECT_EQ("a, b", info._shape);
+    EXPECT_EQ("IXSCAN { a: 1 }", info._planSummary);
+    EXPECT_EQ(100, info._count);
+    EXPECT_EQ(40, info._docsExamined);
+    EXPECT_DOUBLE_EQ(5, info._p50Ms);
+    EXPECT_DOUBLE_EQ(500, info._p95Ms);
+}
+
+TEST(profile_summary_tests, query_hash_shape)
+{
+    mongo::BSONObj const group = BSON("_id" << BSON("ns" << "db.coll" << "shape" << "8A3B1C2D") << "count" << 1);
+    ProfileShapeInfo const info = ProfileSummary::shapeFromGroup(group);
+    EXPECT_EQ("8A3B1C2D", info._shape);
+    EXPECT_DOUBLE_EQ(-1, info._p50Ms);    // no buckets, beyond the last bound
+}
@@ -0,0 +1,114 @@
+#include "robomongo/core/domain/QueryBenchmark.h"
+
+#include <algorithm>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/engine/NativeQuery.h"
+
+namespace
+{
+    double toMs(long long us)
+    {
+        return us / 1000.0;
+    }
+
+    mongo::BSONObj latencies(const Robomongo::LatencyHistogram &histogram)
+    {
+        mongo::BSONObjBuilder builder;
+        builder.append("p50", toMs(histogram.percentileUs(50)));
+        builder.append("p95", toMs(histogram.percentileUs(95)));
+        builder.append("p99", toMs(histogram.percentileUs(99)));
+        builder.append("max", toMs(histogram.maxUs()));
+        builder.append("avg", histogram.count() ? toMs(histogram.totalUs()) / histogram.count() : 0.0);
+        return builder.obj();
+    }
+}
+
+namespace Robomongo
+{
+    namespace QueryBenchmark
+    {
+        mongo::BSONObj command(const NativeQuery &query, int maxTimeMs)
+        {
+            mongo::BSONObjBuilder builder;
+            if (query.kind == NativeQuery::Find) {
+                builder.append("find", query.collection);
+                if (!query.filter.isEmpty())
+                    builder.append("filter", query.filter);
+                if (!query.projection.isEmpty())
+                    builder.append("projection", query.projection);
+                if (maxTimeMs > 0)
+                    builder.append("maxTimeMS", maxTimeMs);
+                return builder.obj();
+            }
+
+            builder.append("aggregate", query.collection);
+            builder.appendArray("pipeline", query.pipeline);
+            for (mongo::BSONObjIterator it(query.options); it.more(); ) {
+                mongo::BSONElement const option = it.next();
+                if (std::string(option.fieldName()) != "cursor")
+                    builder.append(option);
+            }
+            builder.append("cursor", mongo::BSONObj());
+            if (maxTimeMs > 0 && !query.options.hasField("maxTimeMS"))
+                builder.append("maxTimeMS", maxTimeMs);
+            return builder.obj();
+        }
+
+        void Result::add(long long clientUs, long long serverUs, long long documents, const std::string &error)
+        {
+            ++iterations;
+            if (!error.empty()) {
+                ++errors;
+                if (firstError.empty())
+                    firstError = error;
+                return;
+            }
+
+            client.record(clientUs);
+            server.record(serverUs);
+            this->documents += documents;
+        }
+
+        void Result::merge(const Result &other)
+        {
+            client.merge(other.client);
+            server.merge(other.server);
+            iterations += other.iterations;
+            errors += other.errors;
+            documents += other.documents;
+            elapsedUs = std::max(elapsedUs, other.elapsedUs);
+            if (firstError.empty())
+                firstError = other.firstError;
+        }
+
+        double Result::documentsPerSecond() const
+        {
+            return elapsedUs > 0 ? documents * 1e6 / elapsedUs : 0;
+        }
+
+        double Result::iterationsPerSecond() const
+        {
+            return elapsedUs > 0 ? (iterations - errors) * 1e6 / elapsedUs : 0;
+        }
+
+        mongo::BSONObj Result::toBson(const std::string &query) const
+        {
+            mongo::BSONObjBuilder builder;
+            builder.append("benchmark", query);
+            builder.append("iterations", iterations);
+            builder.append("concurrency", concurrency);
+            builder.append("errors", errors);
+            builder.append("documents", documents);
+            builder.append("elapsedMs", toMs(elapsedUs));
+            builder.append("docsPerSec", documentsPerSecond());
+            builder.append("iterationsPerSec", iterationsPerSecond());
+            builder.append("clientMs", latencies(client));
+            builder.append("serverMs", latencies(server));
+            if (!firstError.empty())
+                builder.append("firstError", firstError);
+            return builder.obj();
+        }
+    }
+}
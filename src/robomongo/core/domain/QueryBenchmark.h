@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/utils/LatencyHistogram.h"
+
+namespace Robomongo
+{
+    struct NativeQuery;
+
+    /**
+     * @brief Native benchmark of find or aggregate statement, written as
+     *        db.coll.find({ ... }).benchmark(iterations [, concurrency]), see NativeQuery.
+     *        MongoWorker runs the query repeatedly with driver connections, without JavaScript
+     *        overhead of shell, reads all batches of every iteration and collects its latencies.
+     */
+    namespace QueryBenchmark
+    {
+        int const MaxIterations = 100000;
+        int const MaxConcurrency = 32;
+
+        /**
+         * @brief Command of the first batch, with time limit unless query has its own
+         *        (0 for none). Aggregation gets cursor with default batch size.
+         */
+        mongo::BSONObj command(const NativeQuery &query, int maxTimeMs);
+
+        struct Result
+        {
+            LatencyHistogram client;    // whole iteration: commands and reading of documents
+            LatencyHistogram server;    // waiting for replies of iteration: network and server
+            long long iterations = 0;   // including failed ones
+            long long errors = 0;
+            long long documents = 0;    // of iterations that succeeded
+            long long elapsedUs = 0;    // of all iterations, threads run at once
+            int concurrency = 1;
+            std::string firstError;
+
+            void add(long long clientUs, long long serverUs, long long documents, const std::string &error);
+            void merge(const Result &other);
+
+            double documentsPerSecond() const;
+            double iterationsPerSecond() const;
+
+            // Document shown as result of benchmark statement, times in milliseconds
+            mongo::BSONObj toBson(const std::string &query) const;
+        };
+    }
+}
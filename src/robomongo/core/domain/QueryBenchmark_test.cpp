@@ -0,0 +1,58 @@
+#include "gtest/gtest.h"
+#include "QueryBenchmark.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/engine/NativeQuery.h"
+
+using namespace Robomongo;
+
+TEST(query_benchmark_tests, commands)
+{
+    NativeQuery find;
+    find.collection = "orders";
+    find.filter = BSON("status" << "new");
+    mongo::BSONObj const findCommand = QueryBenchmark::command(find, 500);
+    EXPECT_EQ("orders", findCommand.getStringField("find"));
+    EXPECT_EQ("new", findCommand.getObjectField("filter").getStringField("status"));
+    EXPECT_FALSE(findCommand.hasField("projection"));
+    EXPECT_EQ(500, findCommand.getIntField("maxTimeMS"));
+
+    NativeQuery aggregate;
+    aggregate.kind = NativeQuery::Aggregate;
+    aggregate.collection = "orders";
+    aggregate.pipeline = BSON_ARRAY(BSON("$count" << "n"));
+    aggregate.options = BSON("allowDiskUse" << true << "cursor" << BSON("batchSize" << 0) << "maxTimeMS" << 100);
+    mongo::BSONObj const aggregateCommand = QueryBenchmark::command(aggregate, 500);
+    EXPECT_EQ("orders", aggregateCommand.getStringField("aggregate"));
+    EXPECT_TRUE(aggregateCommand.getBoolField("allowDiskUse"));
+    EXPECT_TRUE(aggregateCommand.getObjectField("cursor").isEmpty());
+    EXPECT_EQ(100, aggregateCommand.getIntField("maxTimeMS"));
+}
+
+TEST(query_benchmark_tests, merged_result)
+{
+    QueryBenchmark::Result first;
+    first.add(2000, 1500, 10, "");
+    first.add(4000, 3000, 10, "");
+    first.elapsedUs = 1000000;
+
+    QueryBenchmark::Result second;
+    second.add(0, 0, 0, "timeout");
+    second.add(3000, 2000, 20, "");
+    second.elapsedUs = 500000;
+
+    first.merge(second);
+    EXPECT_EQ(4, first.iterations);
+    EXPECT_EQ(1, first.errors);
+    EXPECT_EQ(40, first.documents);
+    EXPECT_EQ(3u, first.client.count());
+    EXPECT_EQ("timeout", first.firstError);
+    EXPECT_DOUBLE_EQ(40, first.documentsPerSecond());
+    EXPECT_DOUBLE_EQ(3, first.iterationsPerSecond());
+
+    mongo::BSONObj const shown = first.toBson("db.orders.find({})");
+    EXPECT_EQ(40, shown["docsPerSec"].numberDouble());
+    EXPECT_LE(4.0, shown["clientMs"]["p99"].numberDouble());
+    EXPECT_EQ("timeout", shown.getStringField("firstError"));
+}
@@ -0,0 +1,198 @@
+#include "robomongo/core/domain/QueryHistory.h"
+
+#include <algorithm>
+#include <iterator>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QVariantMap>
+
+#include <parser.h>
+#include <serializer.h>
+
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace
+{
+    QString const HistoryDirName = "history";
+
+    QString segmentPath(const QString &connection, bool previous)
+    {
+        return Robomongo::CacheDir + HistoryDirName + "/" + connection + (previous ? ".1.jsonl" : ".jsonl");
+    }
+
+    void readSegment(const QString &path, std::vector<Robomongo::QueryHistoryEntry> &entries)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            return;
+
+        while (!file.atEnd()) {
+            Robomongo::QueryHistoryEntry entry;
+            if (Robomongo::QueryHistory::fromLine(file.readLine().trimmed(), entry))
+                entries.push_back(std::move(entry));
+        }
+    }
+
+    bool isWordChar(char ch)
+    {
+        unsigned char const c = static_cast<unsigned char>(ch);
+        return c >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+               c == '_' || c == '$';
+    }
+}
+
+namespace Robomongo
+{
+    namespace QueryHistory
+    {
+        void append(const QString &connection, const QueryHistoryEntry &entry)
+        {
+            QString const dir = CacheDir + HistoryDirName;
+            if (!QDir(dir).exists())
+                QDir().mkpath(dir);
+
+            QByteArray const line = toLine(entry) + '\n';
+            QString const path = segmentPath(connection, false);
+            if (QFileInfo(path).size() + line.size() > MaxSegmentBytes) {
+                QFile::remove(segmentPath(connection, true));
+                QFile::rename(path, segmentPath(connection, true));
+            }
+
+            QFile file(path);
+            if (file.open(QIODevice::WriteOnly | QIODevice::Append))
+                file.write(line);
+        }
+
+        std::vector<QueryHistoryEntry> load(const QString &connection)
+        {
+            std::vector<QueryHistoryEntry> entries;
+            readSegment(segmentPath(connection, true), entries);
+            readSegment(segmentPath(connection, false), entries);
+            return entries;
+        }
+
+        QByteArray toLine(const QueryHistoryEntry &entry)
+        {
+            QVariantMap map;
+            map.insert("at", entry.executedAt);
+            map.insert("db", QtUtils::toQString(entry.database));
+            map.insert("script", QtUtils::toQString(entry.script));
+            map.insert("ms", entry.durationMs);
+            map.insert("results", entry.results);
+            map.insert("serverMs", entry.serverMs);
+            map.insert("failed", entry.failed);
+
+            // Line breaks of script are escaped, so that entry takes exactly one line
+            bool ok = false;
+            QJson::Serializer serializer;
+            serializer.setIndentMode(QJson::IndentCompact);
+            return serializer.serialize(map, &ok);
+        }
+
+        bool fromLine(const QByteArray &line, QueryHistoryEntry &outEntry)
+        {
+            if (line.isEmpty())
+                return false;
+
+            bool ok = false;
+            QJson::Parser parser;
+            QVariantMap const map = parser.parse(line, &ok).toMap();
+            if (!ok || !map.contains("script"))
+                return false;
+
+            outEntry.executedAt = map.value("at").toLongLong();
+            outEntry.database = QtUtils::toStdString(map.value("db").toString());
+            outEntry.script = QtUtils::toStdString(map.value("script").toString());
+            outEntry.durationMs = map.value("ms").toLongLong();
+            outEntry.results = map.value("results").toLongLong();
+            outEntry.serverMs = map.value("serverMs", -1).toLongLong();
+            outEntry.failed = map.value("failed").toBool();
+            return true;
+        }
+    }
+
+    std::vector<std::string> QueryHistoryIndex::words(const std::string &text)
+    {
+        std::vector<std::string> result;
+        size_t i = 0;
+        while (i < text.size()) {
+            if (!isWordChar(text[i])) {
+                ++i;
+                continue;
+            }
+
+            std::string word;
+            for (; i < text.size() && isWordChar(text[i]); ++i)
+                word += (text[i] >= 'A' && text[i] <= 'Z') ? static_cast<char>(text[i] - 'A' + 'a') : text[i];
+            result.push_back(std::move(word));
+        }
+        return result;
+    }
+
+    void QueryHistoryIndex::add(QueryHistoryEntry entry)
+    {
+        uint32_t const id = static_cast<uint32_t>(_entries.size());
+        std::vector<std::string> entryWords = words(entry.script);
+        std::vector<std::string> const dbWords = words(entry.database);
+        entryWords.insert(entryWords.end(), dbWords.begin(), dbWords.end());
+
+        // Operators and field paths are found with and without '$'
+        size_t const count = entryWords.size();
+        for (size_t i = 0; i < count; ++i) {
+            if (entryWords[i].size() > 1 && entryWords[i][0] == '$')
+                entryWords.push_back(entryWords[i].substr(1));
+        }
+
+        // Ids are added in ascending order, so postings stay sorted
+        for (std::string const &word : entryWords) {
+            std::vector<uint32_t> &postings = _postings[word];
+            if (postings.empty() || postings.back() != id)
+                postings.push_back(id);
+        }
+        _entries.push_back(std::move(entry));
+    }
+
+    std::vector<size_t> QueryHistoryIndex::find(const std::string &query, size_t limit) const
+    {
+        std::vector<std::string> const queryWords = words(query);
+        std::vector<size_t> result;
+
+        if (queryWords.empty()) {
+            for (size_t id = _entries.size(); id > 0 && result.size() < limit; --id)
+                result.push_back(id - 1);
+            return result;
+        }
+
+        std::vector<uint32_t> matched;
+        for (size_t i = 0; i < queryWords.size(); ++i) {
+            // Union of postings of all indexed words with this prefix
+            std::string const &prefix = queryWords[i];
+            std::vector<uint32_t> ids;
+            for (auto it = _postings.lower_bound(prefix);
+                 it != _postings.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+                ids.insert(ids.end(), it->second.begin(), it->second.end());
+            }
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+            if (i == 0) {
+                matched.swap(ids);
+            }
+            else {
+                std::vector<uint32_t> both;
+                std::set_intersection(matched.begin(), matched.end(), ids.begin(), ids.end(),
+                                      std::back_inserter(both));
+                matched.swap(both);
+            }
+
+            if (matched.empty())
+                return result;
+        }
+
+        for (auto it = matched.rbegin(); it != matched.rend() && result.size() < limit; ++it)
+            result.push_back(*it);
+        return result;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <QByteArray>
+#include <QString>
+
+namespace Robomongo
+{
+    /**
+     * @brief One executed script of query history
+     */
+    struct QueryHistoryEntry
+    {
+        long long executedAt = 0;   // seconds since epoch
+        std::string database;
+        std::string script;
+        long long durationMs = 0;   // from request to response, as seen by shell
+        long long results = 0;      // documents returned by all statements
+        long long serverMs = -1;    // explained executionTimeMillis, -1 if not profiled
+        bool failed = false;
+    };
+
+    /**
+     * @brief Executed scripts of every connection, by connection uuid. Entries are appended
+     *        as JSON lines to a segment file in cache directory, the full segment is renamed
+     *        to the previous one (replacing it) once it grows over MaxSegmentBytes.
+     */
+    namespace QueryHistory
+    {
+        constexpr qint64 MaxSegmentBytes = 4 * 1024 * 1024;
+
+        void append(const QString &connection, const QueryHistoryEntry &entry);
+
+        /**
+         * @brief Entries of both segments, oldest first. Lines which cannot be parsed
+         *        (i.e. cut by crash) are skipped.
+         */
+        std::vector<QueryHistoryEntry> load(const QString &connection);
+
+        // One line of segment file, without line break
+        QByteArray toLine(const QueryHistoryEntry &entry);
+        bool fromLine(const QByteArray &line, QueryHistoryEntry &outEntry);
+    }
+
+    /**
+     * @brief Inverted index of query history: word -> ids of entries, ascending. Words are
+     *        runs of letters, digits, '_' and '$' of script and database, ASCII is lowercased.
+     *        Words starting with '$' are also indexed without it.
+     */
+    class QueryHistoryIndex
+    {
+    public:
+        static std::vector<std::string> words(const std::string &text);
+
+        void add(QueryHistoryEntry entry);
+        size_t size() const { return _entries.size(); }
+        const QueryHistoryEntry &entry(size_t id) const { return _entries[id]; }
+
+        /**
+         * @return Ids of entries, which have a word starting with every word of query,
+         *         newest first, at most 'limit'. Empty query matches all entries.
+         */
+        std::vector<size_t> find(const std::string &query, size_t limit) const;
+
+    private:
+        std::vector<QueryHistoryEntry> _entries;
+        std::map<std::string, std::vector<uint32_t>> _postings;
+    };
+}
@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+#include "QueryHistory.h"
+
+using namespace Robomongo;
+
+namespace
+{
+    QueryHistoryEntry entry(const std::string &database, const std::string &script)
+    {
+        QueryHistoryEntry result;
+        result.database = database;
+        result.script = script;
+        return result;
+    }
+
+    QueryHistoryIndex sampleIndex()
+    {
+        QueryHistoryIndex index;
+        index.add(entry("shop", "db.orders.find({ status: 'A' })"));
+        index.add(entry("shop", "db.orders.aggregate([{ $group: { _id: '$customer' } }])"));
+        index.add(entry("crm", "db.customers.find().sort({ Name: 1 })"));
+        return index;
+    }
+}
+
+TEST(query_history_tests, words)
+{
+    EXPECT_EQ(std::vector<std::string>({ "db", "orders", "find", "$gt", "5" }),
+              QueryHistoryIndex::words("db.Orders.find({$gt: 5})"));
+    EXPECT_TRUE(QueryHistoryIndex::words(" .({}) ").empty());
+}
+
+TEST(query_history_tests, find_by_word_prefixes_newest_first)
+{
+    QueryHistoryIndex const index = sampleIndex();
+    EXPECT_EQ(std::vector<size_t>({ 1, 0 }), index.find("orders", 10));
+    EXPECT_EQ(std::vector<size_t>({ 2, 1 }), index.find("CUSTOM", 10));
+    EXPECT_EQ(std::vector<size_t>({ 1 }), index.find("ord aggr", 10));
+    EXPECT_EQ(std::vector<size_t>({ 2 }), index.find("crm find", 10));
+    EXPECT_EQ(std::vector<size_t>({ 1 }), index.find("$group", 10));
+    EXPECT_EQ(std::vector<size_t>({ 1 }), index.find("group", 10));
+    EXPECT_EQ(std::vector<size_t>({ 1 }), index.find("$cust", 10));
+    EXPECT_TRUE(index.find("orders sort", 10).empty());
+    EXPECT_TRUE(index.find("unknown", 10).empty());
+}
+
+TEST(query_history_tests, empty_query_and_limit)
+{
+    QueryHistoryIndex const index = sampleIndex();
+    EXPECT_EQ(std::vector<size_t>({ 2, 1, 0 }), index.find("", 10));
+    EXPECT_EQ(std::vector<size_t>({ 2, 1 }), index.find(" ", 2));
+    EXPECT_EQ(std::vector<size_t>({ 2 }), index.find("db", 1));
+}
+
+TEST(query_history_tests, line_round_trip)
+{
+    QueryHistoryEntry original = entry("shop", "db.orders.find()\n  .limit(5)");
+    original.executedAt = 1700000000;
+    original.durationMs = 42;
+    original.results = 5;
+    original.serverMs = 3;
+    original.failed = true;
+
+    QByteArray const line = QueryHistory::toLine(original);
+    EXPECT_FALSE(line.contains('\n'));
+
+    QueryHistoryEntry parsed;
+    ASSERT_TRUE(QueryHistory::fromLine(line, parsed));
+    EXPECT_EQ(original.executedAt, parsed.executedAt);
+    EXPECT_EQ(original.database, parsed.database);
+    EXPECT_EQ(original.script, parsed.script);
+    EXPECT_EQ(original.durationMs, parsed.durationMs);
+    EXPECT_EQ(original.results, parsed.results);
+    EXPECT_EQ(original.serverMs, parsed.serverMs);
+    EXPECT_TRUE(parsed.failed);
+
+    EXPECT_FALSE(QueryHistory::fromLine("{\"at\": 17000", parsed));
+    EXPECT_FALSE(QueryHistory::fromLine("", parsed));
+}
@@ -0,0 +1,292 @@
+#include "robomongo/core/domain/QueryTemplate.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <QFile>
+#include <QVariantList>
+#include <QVariantMap>
+
+#include <parser.h>
+#include <serializer.h>
+#include <mongo/bson/bsonobjbuilder.h>
+#include <mongo/util/time_support.h>
+
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace QueryTemplate
+    {
+        namespace
+        {
+            QString const TemplatesFileName = "query-templates.json";
+
+            const std::pair<Type, const char *> TypeNames[] = {
+                { Type::String, "string" }, { Type::Int, "int" }, { Type::Long, "long" },
+                { Type::Double, "double" }, { Type::Bool, "bool" }, { Type::ObjectId, "objectId" },
+                { Type::Date, "date" }
+            };
+
+            // "{{name}}" or "{{name:type}}"
+            bool parsePlaceholder(const mongo::BSONElement &elem, Parameter &outParameter)
+            {
+                if (elem.type() != mongo::String)
+                    return false;
+
+                std::string const value = elem.String();
+                if (value.size() < 5 || value.compare(0, 2, "{{") != 0 || value.compare(value.size() - 2, 2, "}}") != 0)
+                    return false;
+
+                std::string const inner = value.substr(2, value.size() - 4);
+                size_t const colon = inner.find(':');
+                outParameter.name = inner.substr(0, colon);
+                if (outParameter.name.empty())
+                    return false;
+
+                outParameter.type = Type::String;
+                if (colon == std::string::npos)
+                    return true;
+
+                std::string const type = inner.substr(colon + 1);
+                for (auto const &it : TypeNames) {
+                    if (type == it.second) {
+                        outParameter.type = it.first;
+                        return true;
+                    }
+                }
+                throw std::runtime_error("Parameter \"" + outParameter.name + "\" has unknown type \"" + type + "\".");
+            }
+
+            void collect(const mongo::BSONObj &obj, std::vector<Parameter> &parameters)
+            {
+                for (mongo::BSONObjIterator it(obj); it.more();) {
+                    mongo::BSONElement const elem = it.next();
+                    Parameter parameter;
+                    if (elem.isABSONObj()) {
+                        collect(elem.Obj(), parameters);
+                        continue;
+                    }
+                    if (!parsePlaceholder(elem, parameter))
+                        continue;
+
+                    auto const same = std::find_if(parameters.begin(), parameters.end(),
+                        [&parameter](const Parameter &p) { return p.name == parameter.name; });
+                    if (same == parameters.end())
+                        parameters.push_back(parameter);
+                    else if (same->type != parameter.type)
+                        throw std::runtime_error("Parameter \"" + parameter.name + "\" has two different types.");
+                }
+            }
+
+            bool isHex(const std::string &text)
+            {
+                return std::all_of(text.begin(), text.end(),
+                                   [](char ch) { return std::isxdigit(static_cast<unsigned char>(ch)) != 0; });
+            }
+
+            void appendValue(mongo::BSONObjBuilder &builder, const std::string &field, const Parameter &parameter,
+                             const std::string &text)
+            {
+                auto const invalid = [&parameter, &text]() {
+                    return std::runtime_error("Value \"" + text + "\" of parameter \"" + parameter.name +
+                                              "\" is not " + typeName(parameter.type) + ".");
+                };
+
+                try {
+                    size_t used = 0;
+                    switch (parameter.type) {
+                    case Type::String:
+                        builder.append(field, text);
+                        return;
+                    case Type::Int: {
+                        int const value = std::stoi(text, &used);
+                        if (used != text.size())
+                            throw invalid();
+                        builder.append(field, value);
+                        return;
+                    }
+                    case Type::Long: {
+                        long long const value = std::stoll(text, &used);
+                        if (used != text.size())
+                            throw invalid();
+                        builder.append(field, value);
+                        return;
+                    }
+                    case Type::Double: {
+                        double const value = std::stod(text, &used);
+                        if (used != text.size())
+                            throw invalid();
+                        builder.append(field, value);
+                        return;
+                    }
+                    case Type::Bool:
+                        if (text != "true" && text != "false")
+                            throw invalid();
+                        builder.append(field, text == "true");
+                        return;
+                    case Type::ObjectId:
+                        if (text.size() != 24 || !isHex(text))
+                            throw invalid();
+                        builder.append(field, mongo::OID(text));
+                        return;
+                    case Type::Date: {
+                        // Date without time is midnight UTC
+                        auto const date = mongo::dateFromISOString(text.size() == 10 ? text + "T00:00:00Z" : text);
+                        if (!date.isOK())
+                            throw invalid();
+                        builder.appendDate(field, date.getValue());
+                        return;
+                    }
+                    }
+                }
+                catch (const std::invalid_argument &) {
+                    throw invalid();
+                }
+                catch (const std::out_of_range &) {
+                    throw invalid();
+                }
+            }
+
+            // Copy of 'obj' with field names kept, so that arrays stay arrays
+            mongo::BSONObj bindObject(const mongo::BSONObj &obj, const std::map<std::string, std::string> &values)
+            {
+                mongo::BSONObjBuilder builder;
+                for (mongo::BSONObjIterator it(obj); it.more();) {
+                    mongo::BSONElement const elem = it.next();
+                    Parameter placeholder;
+                    if (elem.type() == mongo::Object) {
+                        builder.append(elem.fieldName(), bindObject(elem.Obj(), values));
+                    }
+                    else if (elem.type() == mongo::Array) {
+                        builder.appendArray(elem.fieldName(), bindObject(elem.Obj(), values));
+                    }
+                    else if (parsePlaceholder(elem, placeholder)) {
+                        auto const value = values.find(placeholder.name);
+                        if (value == values.end())
+                            throw std::runtime_error("Parameter \"" + placeholder.name + "\" has no value.");
+                        appendValue(builder, elem.fieldName(), placeholder, value->second);
+                    }
+                    else {
+                        builder.append(elem);
+                    }
+                }
+                return builder.obj();
+            }
+
+            std::string jsonOf(const mongo::BSONObj &obj, bool isArray = false)
+            {
+                return BsonUtils::jsonString(obj, mongo::TenGen, 0, DefaultEncoding, Utc, isArray);
+            }
+
+            std::string quoted(const std::string &collection)
+            {
+                std::string result = "'";
+                for (char const ch : collection) {
+                    if (ch == '\\' || ch == '\'')
+                        result += '\\';
+                    result += ch;
+                }
+                return result + "'";
+            }
+        }
+
+        std::string typeName(Type type)
+        {
+            for (auto const &it : TypeNames) {
+                if (it.first == type)
+                    return it.second;
+            }
+            return "string";
+        }
+
+        Compiled compile(const std::string &script)
+        {
+            Compiled compiled;
+            if (!NativeQuery::parse(script, compiled.skeleton, true))
+                throw std::runtime_error("Template must be a single find() or aggregate() of collection "
+                                         "with JSON arguments.");
+
+            NativeQuery const &query = compiled.skeleton;
+            for (auto const &obj : { query.filter, query.projection, query.pipeline, query.options })
+                collect(obj, compiled.parameters);
+            return compiled;
+        }
+
+        NativeQuery bind(const Compiled &compiled, const std::map<std::string, std::string> &values)
+        {
+            NativeQuery query = compiled.skeleton;
+            if (compiled.parameters.empty())
+                return query;
+
+            query.filter = bindObject(query.filter, values);
+            query.projection = bindObject(query.projection, values);
+            query.pipeline = bindObject(query.pipeline, values);
+            query.options = bindObject(query.options, values);
+            return query;
+        }
+
+        std::string scriptOf(const NativeQuery &query)
+        {
+            std::string script = "db.getCollection(" + quoted(query.collection) + ").";
+            if (query.kind == NativeQuery::Find) {
+                script += "find(" + jsonOf(query.filter);
+                if (!query.projection.isEmpty())
+                    script += ", " + jsonOf(query.projection);
+            }
+            else {
+                script += "aggregate(" + jsonOf(query.pipeline, true);
+                if (!query.options.isEmpty())
+                    script += ", " + jsonOf(query.options);
+            }
+            return script + ")";
+        }
+
+        std::vector<Template> load()
+        {
+            std::vector<Template> templates;
+            QFile file(ConfigDir + TemplatesFileName);
+            if (!file.open(QIODevice::ReadOnly))
+                return templates;
+
+            bool ok = false;
+            QJson::Parser parser;
+            QVariantList const list = parser.parse(file.readAll(), &ok).toList();
+            for (auto const &item : list) {
+                QVariantMap const map = item.toMap();
+                Template saved;
+                saved.name = QtUtils::toStdString(map.value("name").toString());
+                saved.database = QtUtils::toStdString(map.value("db").toString());
+                saved.script = QtUtils::toStdString(map.value("script").toString());
+                if (!saved.name.empty())
+                    templates.push_back(saved);
+            }
+            return templates;
+        }
+
+        void save(const std::vector<Template> &templates)
+        {
+            QVariantList list;
+            for (auto const &saved : templates) {
+                QVariantMap map;
+                map.insert("name", QtUtils::toQString(saved.name));
+                map.insert("db", QtUtils::toQString(saved.database));
+                map.insert("script", QtUtils::toQString(saved.script));
+                list.append(map);
+            }
+
+            bool ok = false;
+            QJson::Serializer serializer;
+            serializer.setIndentMode(QJson::IndentFull);
+            QByteArray const json = serializer.serialize(list, &ok);
+            if (!ok)
+                return;
+
+            QFile file(ConfigDir + TemplatesFileName);
+            if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                file.write(json);
+        }
+    }
+}
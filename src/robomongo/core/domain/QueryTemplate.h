@@ -0,0 +1,70 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "robomongo/core/engine/NativeQuery.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Saved find or aggregate with typed parameters. Parameters are string values of
+     *        the form "{{name}}" or "{{name:type}}" in filter, projection, pipeline or options:
+     *
+     *  db.getCollection('orders').find({ customer: "{{customer:objectId}}", created: { $gte: "{{from:date}}" } })
+     *
+     *  Template is compiled once, when it is saved or loaded, into NativeQuery skeleton.
+     *  Execution binds values into copy of skeleton, and worker runs the bound query with
+     *  driver connection, so that neither JavaScript parser nor shell is involved.
+     */
+    namespace QueryTemplate
+    {
+        enum class Type { String, Int, Long, Double, Bool, ObjectId, Date };
+
+        struct Parameter
+        {
+            std::string name;
+            Type type = Type::String;
+        };
+
+        struct Template
+        {
+            std::string name;
+            std::string database;
+            std::string script;
+        };
+
+        struct Compiled
+        {
+            NativeQuery skeleton;
+            std::vector<Parameter> parameters;      // in order of the first appearance
+        };
+
+        std::string typeName(Type type);
+
+        /**
+         * @throws std::runtime_error, if script is not a single find or aggregate (see NativeQuery),
+         *         or parameter has unknown type or two different types
+         */
+        Compiled compile(const std::string &script);
+
+        /**
+         * @brief Copy of skeleton with values of parameters, converted to their types
+         * @param values Text of value by name of parameter
+         * @throws std::runtime_error, if value is missing or is not valid for its type
+         */
+        NativeQuery bind(const Compiled &compiled, const std::map<std::string, std::string> &values);
+
+        /**
+         * @brief Script of bound query, as shown in shell and written to query history
+         */
+        std::string scriptOf(const NativeQuery &query);
+
+        /**
+         * @brief Templates of all connections, saved in a file of config directory
+         */
+        std::vector<Template> load();
+        void save(const std::vector<Template> &templates);
+    }
+}
@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+#include "QueryTemplate.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+TEST(query_template_tests, compile_collects_typed_parameters)
+{
+    QueryTemplate::Compiled const compiled = QueryTemplate::compile(
+        "db.getCollection('orders').find({ customer: \"{{customer:objectId}}\", "
+        "$or: [ { status: \"{{status}}\" }, { total: { $gte: \"{{min:double}}\" } } ], "
+        "other: \"{{customer:objectId}}\" })");
+
+    EXPECT_EQ(NativeQuery::Find, compiled.skeleton.kind);
+    EXPECT_EQ("orders", compiled.skeleton.collection);
+    ASSERT_EQ(3u, compiled.parameters.size());
+    EXPECT_EQ("customer", compiled.parameters[0].name);
+    EXPECT_EQ(QueryTemplate::Type::ObjectId, compiled.parameters[0].type);
+    EXPECT_EQ("status", compiled.parameters[1].name);
+    EXPECT_EQ(QueryTemplate::Type::String, compiled.parameters[1].type);
+    EXPECT_EQ(QueryTemplate::Type::Double, compiled.parameters[2].type);
+}
+
+TEST(query_template_tests, compile_rejects)
+{
+    EXPECT_THROW(QueryTemplate::compile("db.orders.find().limit(5)"), std::runtime_error);
+    EXPECT_THROW(QueryTemplate::compile("db.orders.find({ a: \"{{a:uuid}}\" })"), std::runtime_error);
+    EXPECT_THROW(QueryTemplate::compile("db.orders.find({ a: \"{{a:int}}\", b: \"{{a}}\" })"), std::runtime_error);
+}
+
+TEST(query_template_tests, bind_converts_values)
+{
+    QueryTemplate::Compiled const compiled = QueryTemplate::compile(
+        "db.orders.aggregate([ { $match: { qty: \"{{qty:int}}\", at: { $gte: \"{{from:date}}\" }, "
+        "vip: \"{{vip:bool}}\", id: \"{{id:objectId}}\" } }, { $limit: 10 } ])");
+
+    std::map<std::string, std::string> values = {
+        { "qty", "5" }, { "from", "2024-03-01" }, { "vip", "true" }, { "id", "5f1d7a2b9c4e3a0012345678" }
+    };
+    NativeQuery const bound = QueryTemplate::bind(compiled, values);
+    ASSERT_EQ(NativeQuery::Aggregate, bound.kind);
+    mongo::BSONObj const match = bound.pipeline["0"].Obj()["$match"].Obj();
+    EXPECT_EQ(mongo::NumberInt, match["qty"].type());
+    EXPECT_EQ(5, match["qty"].numberInt());
+    EXPECT_EQ(mongo::Date, match["at"].Obj()["$gte"].type());
+    EXPECT_TRUE(match["vip"].Bool());
+    EXPECT_EQ(mongo::jstOID, match["id"].type());
+    EXPECT_EQ(10, bound.pipeline["1"].Obj()["$limit"].numberInt());
+
+    // Skeleton is not changed by binding
+    EXPECT_EQ(mongo::String, compiled.skeleton.pipeline["0"].Obj()["$match"].Obj()["qty"].type());
+
+    values["qty"] = "5x";
+    EXPECT_THROW(QueryTemplate::bind(compiled, values), std::runtime_error);
+    values["qty"] = "5";
+    values.erase("vip");
+    EXPECT_THROW(QueryTemplate::bind(compiled, values), std::runtime_error);
+}
+
+TEST(query_template_tests, script_of_bound_query_is_native)
+{
+    QueryTemplate::Compiled const compiled = QueryTemplate::compile(
+        "db.getCollection('it\\'s').find({ n: \"{{n:long}}\" }, { _id: 0 })");
+    NativeQuery const bound = QueryTemplate::bind(compiled, { { "n", "42" } });
+
+    NativeQuery reparsed;
+    ASSERT_TRUE(NativeQuery::parse(QueryTemplate::scriptOf(bound), reparsed));
+    EXPECT_EQ("it's", reparsed.collection);
+    EXPECT_EQ(42, reparsed.filter["n"].numberLong());
+    EXPECT_EQ(0, reparsed.projection["_id"].numberInt());
+}
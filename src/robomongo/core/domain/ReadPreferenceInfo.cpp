@@ -0,0 +1,79 @@
+#include "robomongo/core/domain/ReadPreferenceInfo.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+#include <mongo/client/dbclient_base.h>
+
+#include "robomongo/core/utils/BsonUtils.h"
+
+namespace Robomongo
+{
+    ReadPreferenceInfo::ReadPreferenceInfo(Mode mode, const mongo::BSONArray &tags) :
+        _mode(mode),
+        _tags(tags) {}
+
+    bool ReadPreferenceInfo::operator==(const ReadPreferenceInfo &other) const
+    {
+        return _mode == other._mode && _tags.binaryEqual(other._tags);
+    }
+
+    const char *ReadPreferenceInfo::modeName(Mode mode)
+    {
+        switch (mode) {
+        case Primary:               return "primary";
+        case PrimaryPreferred:      return "primaryPreferred";
+        case Secondary:             return "secondary";
+        case SecondaryPreferred:    return "secondaryPreferred";
+        case Nearest:               return "nearest";
+        default:                    return "";
+        }
+    }
+
+    mongo::BSONObj ReadPreferenceInfo::toBSON() const
+    {
+        mongo::BSONObjBuilder builder;
+        builder.append("mode", modeName(_mode));
+        if (allowsTags() && !_tags.isEmpty())
+            builder.appendArray("tags", _tags);
+        return builder.obj();
+    }
+
+    mongo::BSONObj ReadPreferenceInfo::applyToQuery(const mongo::BSONObj &query, bool special) const
+    {
+        if (isDefault() || query.hasField("$readPreference"))
+            return query;
+
+        mongo::BSONObjBuilder builder;
+        if (special)
+            builder.appendElements(query);
+        else
+            builder.append("$query", query);
+        builder.append("$readPreference", toBSON());
+        return builder.obj();
+    }
+
+    int ReadPreferenceInfo::applyToOptions(int options) const
+    {
+        if (isDefault())
+            return options;
+
+        if (_mode == Primary)
+            return options & ~mongo::QueryOption_SlaveOk;
+
+        return options | mongo::QueryOption_SlaveOk;
+    }
+
+    std::string ReadPreferenceInfo::shellStatement() const
+    {
+        if (isDefault())
+            return "db.getMongo().setReadPref(null); rs.slaveOk();";
+
+        std::string tags = "undefined";
+        if (allowsTags() && !_tags.isEmpty()) {
+            mongo::BSONObj const wrapper = BSON("tags" << _tags);
+            tags = BsonUtils::jsonString(wrapper["tags"], mongo::TenGen, false, 0, DefaultEncoding, Utc);
+        }
+
+        return std::string("db.getMongo().setReadPref('") + modeName(_mode) + "', " + tags + "); " +
+               "db.getMongo().setSlaveOk(" + (_mode == Primary ? "false" : "true") + ");";
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Read preference of one query tab, honored by its scripts and by queries of
+     *        its results (paging, prefetch).
+     */
+    struct ReadPreferenceInfo
+    {
+        enum Mode { Default, Primary, PrimaryPreferred, Secondary, SecondaryPreferred, Nearest };
+
+        // Default keeps what Robomongo always did: shell reads with rs.slaveOk(), driver
+        // queries go as they were built.
+        ReadPreferenceInfo(Mode mode = Default, const mongo::BSONArray &tags = mongo::BSONArray());
+
+        bool isDefault() const { return _mode == Default; }
+
+        // Server rejects tag sets with primary read preference
+        bool allowsTags() const { return _mode != Default && _mode != Primary; }
+
+        bool operator==(const ReadPreferenceInfo &other) const;
+        bool operator!=(const ReadPreferenceInfo &other) const { return !(*this == other); }
+
+        // i.e. "secondaryPreferred", as shell and $readPreference name it. Empty for Default.
+        static const char *modeName(Mode mode);
+
+        // { mode: "nearest", tags: [ ... ] }, tags only if allowed and not empty
+        mongo::BSONObj toBSON() const;
+
+        /**
+         * @brief Query for DBClientBase::query() with $readPreference, which DBClientReplicaSet
+         *        uses to pick member and mongos to pick shard members. Default and queries
+         *        with their own $readPreference are returned as they are.
+         * @param special Query is { $query: ..., <modifiers> } already
+         */
+        mongo::BSONObj applyToQuery(const mongo::BSONObj &query, bool special) const;
+
+        // SlaveOk is set for modes which may read from secondaries, cleared for Primary
+        int applyToOptions(int options) const;
+
+        // JavaScript which sets read preference of shell connection
+        std::string shellStatement() const;
+
+        Mode _mode;
+        mongo::BSONArray _tags;     // tag sets in order of preference, i.e. [ { dc: "analytics" }, {} ]
+    };
+}
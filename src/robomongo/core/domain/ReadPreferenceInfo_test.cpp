@@ -0,0 +1,37 @@
+#include "gtest/gtest.h"
+#include "ReadPreferenceInfo.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+#include <mongo/client/dbclient_base.h>
+
+using namespace Robomongo;
+
+TEST(read_preference_info_tests, default_leaves_query_as_is)
+{
+    ReadPreferenceInfo const preference;
+    mongo::BSONObj const query = BSON("a" << 1);
+
+    EXPECT_EQ(query.toString(), preference.applyToQuery(query, false).toString());
+    EXPECT_EQ(mongo::QueryOption_SlaveOk, preference.applyToOptions(mongo::QueryOption_SlaveOk));
+    EXPECT_EQ(0, preference.applyToOptions(0));
+}
+
+TEST(read_preference_info_tests, query_gets_read_preference)
+{
+    ReadPreferenceInfo const nearest(ReadPreferenceInfo::Nearest, BSON_ARRAY(BSON("dc" << "analytics")));
+
+    mongo::BSONObj const plain = nearest.applyToQuery(BSON("a" << 1), false);
+    EXPECT_EQ(BSON("a" << 1).toString(), plain.getObjectField("$query").toString());
+    EXPECT_EQ("nearest", std::string(plain.getObjectField("$readPreference").getStringField("mode")));
+    EXPECT_EQ(1, plain.getObjectField("$readPreference").getObjectField("tags").nFields());
+    EXPECT_EQ(mongo::QueryOption_SlaveOk, nearest.applyToOptions(0));
+
+    mongo::BSONObj const special = nearest.applyToQuery(BSON("$query" << BSON("a" << 1) << "$orderby" << BSON("b" << 1)), true);
+    EXPECT_EQ(3, special.nFields());
+    EXPECT_TRUE(special.hasField("$orderby"));
+
+    // Tag sets are not allowed with primary
+    ReadPreferenceInfo const primary(ReadPreferenceInfo::Primary, BSON_ARRAY(BSON("dc" << "analytics")));
+    EXPECT_FALSE(primary.toBSON().hasField("tags"));
+    EXPECT_EQ(0, primary.applyToOptions(mongo::QueryOption_SlaveOk));
+}
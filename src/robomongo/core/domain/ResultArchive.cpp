@@ -0,0 +1,134 @@
+#include "robomongo/core/domain/ResultArchive.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <QtEndian>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace
+{
+    // Offset of index (qint64) and magic (quint32) after index
+    int const TrailerBytes = 12;
+    int const HeaderBytes = 8;
+
+    void appendLittleEndian(QByteArray &out, quint32 value)
+    {
+        uchar bytes[4];
+        qToLittleEndian(value, bytes);
+        out.append(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+    }
+
+    template <typename T>
+    T readLittleEndian(const char *data)
+    {
+        return qFromLittleEndian<T>(reinterpret_cast<const uchar *>(data));
+    }
+}
+
+namespace Robomongo
+{
+    namespace ResultArchive
+    {
+        const char *const FileSuffix = "bsonz";
+
+        QByteArray header()
+        {
+            QByteArray out;
+            appendLittleEndian(out, Magic);
+            appendLittleEndian(out, Version);
+            return out;
+        }
+
+        QByteArray compressBlock(const char *raw, int size, long long documents, qint64 offset, Index &index)
+        {
+            QByteArray const block = qCompress(reinterpret_cast<const uchar *>(raw), size);
+
+            Block added;
+            added.offset = offset;
+            added.bytes = block.size();
+            added.rawBytes = size;
+            added.documents = documents;
+            index.blocks.push_back(added);
+            index.documents += documents;
+            index.rawBytes += size;
+            return block;
+        }
+
+        QByteArray footer(const Index &index, qint64 offset)
+        {
+            // Block is [offset, bytes, rawBytes, documents], to keep index of multi-GB result small
+            mongo::BSONArrayBuilder blocks;
+            for (Block const &block : index.blocks) {
+                blocks.append(BSON_ARRAY(static_cast<long long>(block.offset) << block.bytes <<
+                                         block.rawBytes << block.documents));
+            }
+
+            mongo::BSONObjBuilder builder;
+            builder.append("ns", index.ns);
+            builder.append("documents", index.documents);
+            builder.append("rawBytes", static_cast<long long>(index.rawBytes));
+            builder.append("blocks", blocks.arr());
+            mongo::BSONObj const obj = builder.obj();
+
+            QByteArray out(obj.objdata(), obj.objsize());
+            uchar bytes[8];
+            qToLittleEndian(static_cast<qint64>(offset), bytes);
+            out.append(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+            appendLittleEndian(out, Magic);
+            return out;
+        }
+
+        bool isArchive(const char *data, qint64 size)
+        {
+            return size >= HeaderBytes && readLittleEndian<quint32>(data) == Magic;
+        }
+
+        Index readIndex(const char *data, qint64 size)
+        {
+            if (!isArchive(data, size) || size < HeaderBytes + TrailerBytes)
+                throw std::runtime_error("Not a result archive");
+            if (readLittleEndian<quint32>(data + 4) > Version)
+                throw std::runtime_error("Result archive was written by newer version, update to open it");
+            if (readLittleEndian<quint32>(data + size - 4) != Magic)
+                throw std::runtime_error("Result archive is truncated, it was not written completely");
+
+            qint64 const indexOffset = readLittleEndian<qint64>(data + size - TrailerBytes);
+            qint64 const indexBytes = size - TrailerBytes - indexOffset;
+            if (indexOffset < HeaderBytes || indexBytes < 5 ||
+                readLittleEndian<qint32>(data + indexOffset) != indexBytes ||
+                data[indexOffset + indexBytes - 1] != 0)
+                throw std::runtime_error("Index of result archive is malformed");
+
+            Index index;
+            mongo::BSONObj const obj(data + indexOffset);
+            index.ns = obj.getStringField("ns");
+
+            for (mongo::BSONObjIterator it(obj.getObjectField("blocks")); it.more();) {
+                mongo::BSONObj const fields = it.next().Obj();
+                Block block;
+                block.offset = fields["0"].safeNumberLong();
+                block.bytes = fields["1"].numberInt();
+                block.rawBytes = fields["2"].numberInt();
+                block.documents = fields["3"].safeNumberLong();
+                if (block.offset < HeaderBytes || block.bytes <= 0 || block.rawBytes < 0 ||
+                    block.documents < 0 || block.offset + block.bytes > indexOffset)
+                    throw std::runtime_error("Index of result archive is malformed");
+
+                index.documents += block.documents;
+                index.rawBytes += block.rawBytes;
+                index.blocks.push_back(block);
+            }
+            return index;
+        }
+
+        void extractBlock(const char *data, const Block &block, char *out)
+        {
+            QByteArray const raw = qUncompress(reinterpret_cast<const uchar *>(data + block.offset), block.bytes);
+            if (raw.size() != block.rawBytes)
+                throw std::runtime_error("Block at offset " + std::to_string(block.offset) +
+                                         " of result archive is corrupted");
+            memcpy(out, raw.constData(), raw.size());
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QByteArray>
+#include <string>
+#include <vector>
+
+namespace Robomongo
+{
+    /**
+     * @brief Compressed file of query result, written by ExportWriter and opened without server
+     *        by BsonDumpFile, so that result can be shared instead of being queried again.
+     *
+     *  Layout: Magic, Version, blocks, index, offset of index, Magic. Block is qCompress()ed
+     *  (zlib deflate) run of whole BSON documents. Index is BSON document with offset, sizes
+     *  and document count of every block, so reader knows size of decompressed result before
+     *  it starts, and decompresses block by block, without scanning archive.
+     */
+    namespace ResultArchive
+    {
+        quint32 const Magic = 0x5a4e5342;     // "BSNZ"
+        quint32 const Version = 1;
+
+        // Suffix of archive files, without dot
+        extern const char *const FileSuffix;
+
+        struct Block
+        {
+            qint64 offset = 0;          // in archive
+            int bytes = 0;              // compressed
+            int rawBytes = 0;
+            long long documents = 0;
+        };
+
+        struct Index
+        {
+            std::string ns;             // "db.collection" of query, may be empty
+            long long documents = 0;
+            qint64 rawBytes = 0;        // of all blocks decompressed
+            std::vector<Block> blocks;
+        };
+
+        // Magic and version, the start of archive
+        QByteArray header();
+
+        /**
+         * @brief Compresses 'size' bytes of 'documents' BSON documents into block, which is
+         *        written at 'offset' of archive, and adds block to 'index'
+         */
+        QByteArray compressBlock(const char *raw, int size, long long documents, qint64 offset, Index &index);
+
+        // Index, offset of index and magic, the end of archive. Index starts at 'offset'
+        QByteArray footer(const Index &index, qint64 offset);
+
+        bool isArchive(const char *data, qint64 size);
+
+        /**
+         * @brief Index of archive in memory ('size' bytes at 'data'), blocks are checked to
+         *        lie between header and index
+         * @throws std::runtime_error, if archive is malformed or of newer version
+         */
+        Index readIndex(const char *data, qint64 size);
+
+        /**
+         * @brief Decompresses 'block' of archive at 'data' into 'out' (block.rawBytes)
+         * @throws std::runtime_error, if block is corrupted
+         */
+        void extractBlock(const char *data, const Block &block, char *out);
+    }
+}
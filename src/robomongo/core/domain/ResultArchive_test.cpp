@@ -0,0 +1,62 @@
+#include "gtest/gtest.h"
+#include "ResultArchive.h"
+
+#include <stdexcept>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    // Archive of 'blocks' blocks of 'perBlock' documents { i: n }
+    QByteArray archive(int blocks, int perBlock, ResultArchive::Index &index)
+    {
+        index.ns = "db.coll";
+        QByteArray data = ResultArchive::header();
+        int i = 0;
+        for (int b = 0; b < blocks; ++b) {
+            std::string raw;
+            for (int d = 0; d < perBlock; ++d) {
+                mongo::BSONObj const obj = BSON("i" << i++);
+                raw.append(obj.objdata(), obj.objsize());
+            }
+            data.append(ResultArchive::compressBlock(raw.data(), static_cast<int>(raw.size()), perBlock,
+                                                     data.size(), index));
+        }
+        data.append(ResultArchive::footer(index, data.size()));
+        return data;
+    }
+}
+
+TEST(result_archive_tests, read_index_and_blocks)
+{
+    ResultArchive::Index written;
+    QByteArray const data = archive(3, 100, written);
+
+    ResultArchive::Index const index = ResultArchive::readIndex(data.constData(), data.size());
+    EXPECT_EQ("db.coll", index.ns);
+    EXPECT_EQ(300, index.documents);
+    EXPECT_EQ(written.rawBytes, index.rawBytes);
+    ASSERT_EQ(3u, index.blocks.size());
+    EXPECT_EQ(written.blocks[2].offset, index.blocks[2].offset);
+
+    std::string raw(index.blocks[1].rawBytes, '\0');
+    ResultArchive::extractBlock(data.constData(), index.blocks[1], &raw[0]);
+    EXPECT_EQ(100, mongo::BSONObj(raw.data()).getIntField("i"));
+}
+
+TEST(result_archive_tests, malformed_archives)
+{
+    ResultArchive::Index written;
+    QByteArray const data = archive(2, 10, written);
+
+    EXPECT_FALSE(ResultArchive::isArchive("not bson archive", 16));
+    EXPECT_THROW(ResultArchive::readIndex(data.constData(), data.size() - 1), std::runtime_error);
+
+    QByteArray corrupted = data;
+    corrupted[static_cast<int>(written.blocks[0].offset) + 8] = ~corrupted[static_cast<int>(written.blocks[0].offset) + 8];
+    ResultArchive::Index const index = ResultArchive::readIndex(corrupted.constData(), corrupted.size());
+    std::string raw(index.blocks[0].rawBytes, '\0');
+    EXPECT_THROW(ResultArchive::extractBlock(corrupted.constData(), index.blocks[0], &raw[0]), std::runtime_error);
+}
@@ -0,0 +1,239 @@
+#include "robomongo/core/domain/ResultColumn.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <thread>
+
+namespace Robomongo
+{
+    namespace
+    {
+        // Columns shorter than this per thread are sorted on the calling thread
+        const size_t MinRowsPerSortThread = 16 * 1024;
+
+        // Missing field is ordered with nulls (canonical type of jstNULL)
+        const int8_t MissingCanonicalType = 5;
+
+        template <typename T>
+        int compareValues(T a, T b)
+        {
+            return a < b ? -1 : (b < a ? 1 : 0);
+        }
+
+        // NaN is lower than any number, as on server
+        int compareDoubles(double a, double b)
+        {
+            bool const aNan = std::isnan(a);
+            bool const bNan = std::isnan(b);
+            if (aNan || bNan)
+                return compareValues(!aNan, !bNan);
+            return compareValues(a, b);
+        }
+
+        mongo::BSONElement fieldOf(const mongo::BSONObj &document, const std::string &field)
+        {
+            if (document.isArray() && field.size() > 2 && field.front() == '[' && field.back() == ']')
+                return document.getField(field.substr(1, field.size() - 2));
+            return document.getField(field);
+        }
+    }
+
+    ResultColumn::ResultColumn(const std::vector<mongo::BSONObj> &documents, const std::string &field)
+    {
+        size_t const count = documents.size();
+        _kinds.resize(count);
+        _types.resize(count);
+        _integers.resize(count);
+        _doubles.resize(count);
+        _stringOffsets.resize(count);
+        _stringSizes.resize(count);
+        _raw.resize(count);
+
+        for (size_t row = 0; row < count; ++row) {
+            mongo::BSONElement const element = fieldOf(documents[row], field);
+            if (element.eoo()) {
+                _kinds[row] = Missing;
+                _types[row] = MissingCanonicalType;
+                continue;
+            }
+
+            _raw[row] = element.rawdata();
+            _types[row] = static_cast<int8_t>(element.canonicalType());
+            switch (element.type()) {
+            case mongo::jstNULL:
+            case mongo::Undefined:
+                _kinds[row] = Null;
+                break;
+            case mongo::NumberInt:
+            case mongo::NumberLong:
+                _kinds[row] = Integer;
+                _integers[row] = element.numberLong();
+                _doubles[row] = static_cast<double>(_integers[row]);
+                break;
+            case mongo::NumberDouble:
+                _kinds[row] = Double;
+                _doubles[row] = element._numberDouble();
+                break;
+            case mongo::String:
+                _kinds[row] = String;
+                _stringOffsets[row] = static_cast<uint32_t>(_strings.size());
+                _stringSizes[row] = static_cast<uint32_t>(element.valuestrsize() - 1);
+                _strings.append(element.valuestr(), element.valuestrsize() - 1);
+                break;
+            case mongo::Date:
+                _kinds[row] = Date;
+                _integers[row] = element.date().toMillisSinceEpoch();
+                break;
+            case mongo::Bool:
+                _kinds[row] = Bool;
+                _integers[row] = element.boolean() ? 1 : 0;
+                break;
+            default:
+                _kinds[row] = Other;
+                break;
+            }
+        }
+    }
+
+    mongo::BSONElement ResultColumn::element(int row) const
+    {
+        return _raw[row] ? mongo::BSONElement(_raw[row]) : mongo::BSONElement();
+    }
+
+    int ResultColumn::compare(int a, int b) const
+    {
+        if (_types[a] != _types[b])
+            return compareValues(_types[a], _types[b]);
+
+        uint8_t const kindA = _kinds[a];
+        uint8_t const kindB = _kinds[b];
+        if (kindA == Missing || kindB == Missing)
+            return compareValues(kindA != Missing, kindB != Missing);
+
+        if (kindA == kindB) {
+            switch (kindA) {
+            case Null:
+                return 0;
+            case Integer:
+            case Date:
+            case Bool:
+                return compareValues(_integers[a], _integers[b]);
+            case Double:
+                return compareDoubles(_doubles[a], _doubles[b]);
+            case String: {
+                uint32_t const sizeA = _stringSizes[a];
+                uint32_t const sizeB = _stringSizes[b];
+                int const compared = std::memcmp(_strings.data() + _stringOffsets[a],
+                                                 _strings.data() + _stringOffsets[b], std::min(sizeA, sizeB));
+                return compared != 0 ? compared : compareValues(sizeA, sizeB);
+            }
+            default:
+                break;
+            }
+        } else if ((kindA == Integer || kindA == Double) && (kindB == Integer || kindB == Double)) {
+            return compareDoubles(_doubles[a], _doubles[b]);
+        }
+
+        // Other types (i.e. decimals and subdocuments) are compared by BSON
+        return mongo::BSONElement(_raw[a]).woCompare(mongo::BSONElement(_raw[b]), false);
+    }
+
+    std::vector<int> ResultColumn::sortedRows(bool ascending) const
+    {
+        std::vector<int> rows(size());
+        std::iota(rows.begin(), rows.end(), 0);
+
+        auto const less = [this, ascending](int a, int b) {
+            int const compared = compare(a, b);
+            return ascending ? compared < 0 : compared > 0;
+        };
+
+        size_t const threads = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(),
+                                                                    rows.size() / MinRowsPerSortThread));
+        if (threads <= 1) {
+            std::stable_sort(rows.begin(), rows.end(), less);
+            return rows;
+        }
+
+        // Chunks are sorted in parallel, then neighbours are merged in parallel until one is left
+        std::vector<size_t> bounds;
+        for (size_t i = 0; i <= threads; ++i)
+            bounds.push_back(rows.size() * i / threads);
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([&rows, &bounds, &less, i]() {
+                std::stable_sort(rows.begin() + bounds[i], rows.begin() + bounds[i + 1], less);
+            });
+        }
+        for (std::thread &worker : workers)
+            worker.join();
+
+        while (bounds.size() > 2) {
+            workers.clear();
+            std::vector<size_t> merged;
+            for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+                merged.push_back(bounds[i]);
+                if (i + 2 >= bounds.size())
+                    continue;   // last chunk without pair
+
+                workers.emplace_back([&rows, &bounds, &less, i]() {
+                    std::inplace_merge(rows.begin() + bounds[i], rows.begin() + bounds[i + 1],
+                                       rows.begin() + bounds[i + 2], less);
+                });
+            }
+            merged.push_back(bounds.back());
+            for (std::thread &worker : workers)
+                worker.join();
+            bounds.swap(merged);
+        }
+        return rows;
+    }
+
+    ResultColumn::Summary ResultColumn::summarize() const
+    {
+        Summary summary;
+        for (size_t i = 0; i < size(); ++i) {
+            int const row = static_cast<int>(i);
+            if (_kinds[row] == Missing) {
+                ++summary.missing;
+                continue;
+            }
+
+            ++summary.values;
+            if (_kinds[row] == Integer || _kinds[row] == Double) {
+                ++summary.numbers;
+                summary.sum += _doubles[row];
+            }
+
+            if (summary.minRow < 0 || compare(row, summary.minRow) < 0)
+                summary.minRow = row;
+            if (summary.maxRow < 0 || compare(row, summary.maxRow) > 0)
+                summary.maxRow = row;
+        }
+        return summary;
+    }
+
+    std::vector<ResultColumn::Group> ResultColumn::groups(size_t maxGroups) const
+    {
+        std::vector<Group> groups;
+        std::vector<int> const rows = sortedRows(true);
+        for (size_t i = 0; i < rows.size(); ) {
+            size_t next = i + 1;
+            while (next < rows.size() && compare(rows[i], rows[next]) == 0)
+                ++next;
+            groups.push_back({ rows[i], next - i });
+            i = next;
+        }
+
+        // Stable, so that groups of the same count stay in order of values
+        std::stable_sort(groups.begin(), groups.end(), [](const Group &a, const Group &b) {
+            return a.count > b.count;
+        });
+        if (groups.size() > maxGroups)
+            groups.resize(maxGroups);
+        return groups;
+    }
+}
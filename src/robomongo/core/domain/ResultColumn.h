@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Values of one field of result documents, extracted once into typed arrays
+     *        (integers, doubles, string offsets, dates), so that table view can sort and
+     *        summarize column without parsing BSON again. Values are ordered as server
+     *        orders them (by canonical type, then by value), missing field before null.
+     *        Documents must outlive column, values of other types point into them.
+     */
+    class ResultColumn
+    {
+    public:
+        struct Summary
+        {
+            size_t values = 0;      // rows with field
+            size_t missing = 0;
+            size_t numbers = 0;
+            double sum = 0;         // of numbers
+            int minRow = -1;        // rows of the lowest and highest value, -1 if no values
+            int maxRow = -1;
+        };
+
+        struct Group
+        {
+            int row;                // first row with value of group
+            size_t count;
+        };
+
+        /**
+         * @param field Name of top-level field, or "[i]" for element of array document
+         */
+        ResultColumn(const std::vector<mongo::BSONObj> &documents, const std::string &field);
+
+        size_t size() const { return _kinds.size(); }
+
+        /**
+         * @return Element of row, EOO if field is missing
+         */
+        mongo::BSONElement element(int row) const;
+
+        /**
+         * @return Negative, zero or positive, if value of row 'a' is lower, equal or higher
+         */
+        int compare(int a, int b) const;
+
+        /**
+         * @brief Stable order of rows by value. Large columns are sorted in chunks on several
+         *        threads, and chunks are merged.
+         */
+        std::vector<int> sortedRows(bool ascending) const;
+
+        Summary summarize() const;
+
+        /**
+         * @brief Distinct values (including missing), most frequent first
+         */
+        std::vector<Group> groups(size_t maxGroups) const;
+
+    private:
+        enum Kind : uint8_t { Missing, Null, Integer, Double, String, Date, Bool, Other };
+
+        std::vector<uint8_t> _kinds;
+        std::vector<int8_t> _types;         // canonical type, as of null for missing field
+        std::vector<long long> _integers;   // of Integer, Date and Bool
+        std::vector<double> _doubles;       // of Integer and Double
+        std::vector<uint32_t> _stringOffsets;
+        std::vector<uint32_t> _stringSizes;
+        std::string _strings;               // values of String rows, one after another
+        std::vector<const char *> _raw;     // element of row, null for missing field
+    };
+}
@@ -0,0 +1,154 @@
+#include "robomongo/core/domain/ResultDiff.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include "robomongo/core/domain/MongoDocument.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        // Type and raw value of _id, equal ids have equal keys. Documents without _id are
+        // keyed by position, so results of aggregations without _id are paired in order.
+        std::string joinKey(const mongo::BSONObj &document, size_t index)
+        {
+            mongo::BSONElement const id = document["_id"];
+            if (id.eoo())
+                return '#' + std::to_string(index);
+
+            std::string key(1, static_cast<char>(id.type()));
+            key.append(id.value(), id.valuesize());
+            return key;
+        }
+
+        bool sameValue(const mongo::BSONElement &left, const mongo::BSONElement &right)
+        {
+            return left.type() == right.type() && left.valuesize() == right.valuesize() &&
+                   std::memcmp(left.value(), right.value(), left.valuesize()) == 0;
+        }
+
+        bool isContainer(const mongo::BSONElement &element)
+        {
+            return element.type() == mongo::Object || element.type() == mongo::Array;
+        }
+
+        std::string childPath(const std::string &path, const char *field)
+        {
+            return path.empty() ? std::string(field) : path + '.' + field;
+        }
+
+        void diffObjects(const mongo::BSONObj &left, const mongo::BSONObj &right, const std::string &path,
+                         std::vector<ResultDiff::FieldChange> &changes)
+        {
+            size_t const before = changes.size();
+
+            std::unordered_map<std::string, mongo::BSONElement> rightFields;
+            for (mongo::BSONObjIterator it(right); it.more(); ) {
+                mongo::BSONElement const element = it.next();
+                rightFields.emplace(element.fieldName(), element);
+            }
+
+            for (mongo::BSONObjIterator it(left); it.more(); ) {
+                mongo::BSONElement const element = it.next();
+                auto const pair = rightFields.find(element.fieldName());
+                std::string const fieldPath = childPath(path, element.fieldName());
+                if (pair == rightFields.end()) {
+                    changes.push_back({ ResultDiff::FieldChange::Removed, fieldPath, element, mongo::BSONElement() });
+                    continue;
+                }
+
+                mongo::BSONElement const other = pair->second;
+                rightFields.erase(pair);
+                if (sameValue(element, other))
+                    continue;
+
+                if (isContainer(element) && element.type() == other.type())
+                    diffObjects(element.embeddedObject(), other.embeddedObject(), fieldPath, changes);
+                else
+                    changes.push_back({ ResultDiff::FieldChange::Modified, fieldPath, element, other });
+            }
+
+            // Fields left in map are added, in order of right document
+            for (mongo::BSONObjIterator it(right); it.more() && !rightFields.empty(); ) {
+                mongo::BSONElement const element = it.next();
+                if (rightFields.erase(element.fieldName()) > 0) {
+                    changes.push_back({ ResultDiff::FieldChange::Added, childPath(path, element.fieldName()),
+                                        mongo::BSONElement(), element });
+                }
+            }
+
+            // Bytes differ, but every field is the same
+            if (changes.size() == before && !left.binaryEqual(right))
+                changes.push_back({ ResultDiff::FieldChange::Reordered, path, mongo::BSONElement(), mongo::BSONElement() });
+        }
+    }
+
+    std::vector<ResultDiff::Row> ResultDiff::align(const std::vector<MongoDocumentPtr> &left,
+                                                   const std::vector<MongoDocumentPtr> &right)
+    {
+        // Right result is the build side, the first of duplicate ids wins
+        std::unordered_map<std::string, int> rightIndex;
+        rightIndex.reserve(right.size());
+        for (size_t i = 0; i < right.size(); ++i)
+            rightIndex.emplace(joinKey(right[i]->bsonObj(), i), static_cast<int>(i));
+
+        std::vector<Row> rows;
+        rows.reserve(std::max(left.size(), right.size()));
+        std::vector<char> paired(right.size(), false);
+        for (size_t i = 0; i < left.size(); ++i) {
+            Row row;
+            row.left = static_cast<int>(i);
+            auto const match = rightIndex.find(joinKey(left[i]->bsonObj(), i));
+            if (match != rightIndex.end() && !paired[match->second]) {
+                row.right = match->second;
+                paired[match->second] = true;
+            }
+            else {
+                row.status = OnlyLeft;
+            }
+            rows.push_back(row);
+        }
+
+        for (size_t i = 0; i < right.size(); ++i) {
+            if (paired[i])
+                continue;
+
+            Row row;
+            row.status = OnlyRight;
+            row.right = static_cast<int>(i);
+            rows.push_back(row);
+        }
+        return rows;
+    }
+
+    void ResultDiff::compare(const std::vector<MongoDocumentPtr> &left, const std::vector<MongoDocumentPtr> &right,
+                             std::vector<Row> &rows, size_t first, size_t last, const std::atomic<bool> *stop)
+    {
+        for (size_t i = first; i < last; ++i) {
+            if (stop && *stop)
+                return;
+
+            Row &row = rows[i];
+            if (row.left < 0 || row.right < 0)
+                continue;
+
+            mongo::BSONObj const leftObj = left[row.left]->bsonObj();
+            mongo::BSONObj const rightObj = right[row.right]->bsonObj();
+            if (leftObj.binaryEqual(rightObj))
+                continue;
+
+            row.status = Changed;
+            row.changedFields = static_cast<int>(fieldChanges(leftObj, rightObj).size());
+        }
+    }
+
+    std::vector<ResultDiff::FieldChange> ResultDiff::fieldChanges(const mongo::BSONObj &left,
+                                                                  const mongo::BSONObj &right)
+    {
+        std::vector<FieldChange> changes;
+        diffObjects(left, right, std::string(), changes);
+        return changes;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/Core.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Differences of two results (i.e. before and after update, or of primary and
+     *        secondary). Documents are paired by _id with hash join, documents without _id
+     *        by position. Paired documents are compared by raw bytes first, and only those
+     *        which differ are compared field by field (see fieldChanges()).
+     */
+    class ResultDiff
+    {
+    public:
+        enum Status { Same, Changed, OnlyLeft, OnlyRight };
+
+        struct Row
+        {
+            Status status = Same;
+            int left = -1;          // index of document in left result, -1 if none
+            int right = -1;
+            int changedFields = 0;  // of Changed rows, set by compare()
+        };
+
+        struct FieldChange
+        {
+            enum Kind { Added, Removed, Modified, Reordered };
+
+            Kind kind;
+            std::string path;               // dotted, empty for the whole document
+            mongo::BSONElement left;        // points into left document, eoo() if added
+            mongo::BSONElement right;
+        };
+
+        /**
+         * @brief Rows of all documents, in order of left result, then documents of right
+         *        result without pair. Paired rows are Same until compare().
+         */
+        static std::vector<Row> align(const std::vector<MongoDocumentPtr> &left,
+                                      const std::vector<MongoDocumentPtr> &right);
+
+        /**
+         * @brief Compares paired documents of rows [first, last), sets Changed status and
+         *        changedFields. Ranges may be compared in parallel.
+         * @param stop If set, compare returns early (with incomplete result).
+         */
+        static void compare(const std::vector<MongoDocumentPtr> &left, const std::vector<MongoDocumentPtr> &right,
+                            std::vector<Row> &rows, size_t first, size_t last, const std::atomic<bool> *stop = nullptr);
+
+        /**
+         * @brief Structural diff: fields added, removed or modified, recursively in embedded
+         *        documents and arrays (by index). Object with the same fields in other order
+         *        is Reordered. Elements point into documents.
+         */
+        static std::vector<FieldChange> fieldChanges(const mongo::BSONObj &left, const mongo::BSONObj &right);
+    };
+}
@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+#include "ResultDiff.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/domain/MongoDocument.h"
+
+using namespace Robomongo;
+
+namespace
+{
+    std::vector<MongoDocumentPtr> documents(const std::vector<mongo::BSONObj> &objects)
+    {
+        std::vector<MongoDocumentPtr> result;
+        for (mongo::BSONObj const &obj : objects)
+            result.push_back(MongoDocumentPtr(new MongoDocument(obj)));
+        return result;
+    }
+}
+
+TEST(result_diff_tests, aligns_by_id)
+{
+    std::vector<MongoDocumentPtr> const left = documents({ BSON("_id" << 1 << "a" << 1), BSON("_id" << 2),
+                                                           BSON("_id" << 3 << "a" << 1) });
+    std::vector<MongoDocumentPtr> const right = documents({ BSON("_id" << 4), BSON("_id" << 3 << "a" << 2),
+                                                            BSON("_id" << 1 << "a" << 1) });
+
+    std::vector<ResultDiff::Row> rows = ResultDiff::align(left, right);
+    ResultDiff::compare(left, right, rows, 0, rows.size());
+    ASSERT_EQ(4u, rows.size());
+    EXPECT_EQ(ResultDiff::Same, rows[0].status);
+    EXPECT_EQ(2, rows[0].right);
+    EXPECT_EQ(ResultDiff::OnlyLeft, rows[1].status);
+    EXPECT_EQ(ResultDiff::Changed, rows[2].status);
+    EXPECT_EQ(1, rows[2].changedFields);
+    EXPECT_EQ(ResultDiff::OnlyRight, rows[3].status);
+    EXPECT_EQ(0, rows[3].right);
+}
+
+TEST(result_diff_tests, field_changes_are_structural)
+{
+    mongo::BSONObj const left = BSON("_id" << 1 << "a" << BSON("b" << 1 << "c" << 2) << "d" << BSON_ARRAY(1 << 2)
+                                           << "gone" << true);
+    mongo::BSONObj const right = BSON("_id" << 1 << "a" << BSON("b" << 1 << "c" << 3) << "d" << BSON_ARRAY(1 << 5)
+                                            << "new" << "x");
+
+    std::vector<ResultDiff::FieldChange> const changes = ResultDiff::fieldChanges(left, right);
+    ASSERT_EQ(4u, changes.size());
+    EXPECT_EQ("a.c", changes[0].path);
+    EXPECT_EQ(ResultDiff::FieldChange::Modified, changes[0].kind);
+    EXPECT_EQ("d.1", changes[1].path);
+    EXPECT_EQ(ResultDiff::FieldChange::Removed, changes[2].kind);
+    EXPECT_EQ("gone", changes[2].path);
+    EXPECT_EQ(ResultDiff::FieldChange::Added, changes[3].kind);
+    EXPECT_EQ("new", changes[3].path);
+}
+
+TEST(result_diff_tests, field_order_is_reordered)
+{
+    std::vector<ResultDiff::FieldChange> const changes =
+        ResultDiff::fieldChanges(BSON("_id" << 1 << "a" << 1 << "b" << 2), BSON("_id" << 1 << "b" << 2 << "a" << 1));
+    ASSERT_EQ(1u, changes.size());
+    EXPECT_EQ(ResultDiff::FieldChange::Reordered, changes[0].kind);
+    EXPECT_EQ("", changes[0].path);
+}
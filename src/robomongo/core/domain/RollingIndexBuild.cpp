@@ -0,0 +1,69 @@
+#include "robomongo/core/domain/RollingIndexBuild.h"
+
+#include <stdexcept>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/shell/bson/json.h"
+
+namespace Robomongo
+{
+    namespace RollingIndexBuild
+    {
+        const char *const TemporarySuffix = "_rolling";
+
+        IndexInfo temporaryIndex(const IndexInfo &info)
+        {
+            mongo::BSONObj const keys = mongo::Robomongo::fromjson(info._keys);
+            if (keys.isEmpty())
+                throw std::invalid_argument("Index has no keys.");
+
+            mongo::BSONObjBuilder builder;
+            for (mongo::BSONObjIterator it(keys); it.more();) {
+                mongo::BSONElement const key = it.next();
+                if (!key.isNumber())
+                    throw std::invalid_argument("Rolling build keeping the name supports only ascending and "
+                                                "descending keys, rename the index instead.");
+                if (std::string(key.fieldName()) == "_id")
+                    throw std::invalid_argument("Rolling build keeping the name does not support "
+                                                "keys with _id, rename the index instead.");
+                builder.append(key);
+            }
+            builder.append("_id", 1);
+
+            IndexInfo temporary(info._collection, info._name + TemporarySuffix,
+                                BsonUtils::jsonString(builder.obj(), mongo::TenGen, 0, DefaultEncoding, Utc));
+            temporary._sparse = info._sparse;
+            temporary._backGround = true;
+            return temporary;
+        }
+
+        std::vector<Step> steps(const IndexInfo &oldInfo, const IndexInfo &newInfo)
+        {
+            // Servers before 4.2 lock database for the whole foreground build
+            IndexInfo built = newInfo;
+            built._backGround = true;
+
+            if (oldInfo._name.empty())
+                return { Step{ Step::Create, built } };
+
+            if (oldInfo._name != newInfo._name)
+                return { Step{ Step::Create, built }, Step{ Step::Drop, oldInfo } };
+
+            IndexInfo const temporary = temporaryIndex(newInfo);
+            return {
+                Step{ Step::Create, temporary },
+                Step{ Step::Drop, oldInfo },
+                Step{ Step::Create, built },
+                Step{ Step::Drop, temporary }
+            };
+        }
+
+        std::string describe(const Step &step)
+        {
+            return (step.kind == Step::Create ? "Building index '" : "Dropping index '") +
+                   step.index._name + "'";
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "robomongo/core/events/MongoEventsInfo.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Steps of adding or editing index without a moment when neither the old nor the
+     *        new index serves queries. MongoDB cannot rename index or edit it in place, so new
+     *        index is built next to the old one (under a temporary name, if it keeps the old
+     *        name), before the old one is dropped.
+     */
+    namespace RollingIndexBuild
+    {
+        // Appended to name of temporary index
+        extern const char *const TemporarySuffix;
+
+        struct Step
+        {
+            enum Kind { Create, Drop };
+
+            Kind kind;
+            IndexInfo index;    // index to create, or to drop (only its name is used then)
+        };
+
+        /**
+         * @brief Temporary index that serves queries of 'info' while it is rebuilt under its
+         *        own name: keys of 'info' followed by { _id: 1 }, so that the server accepts
+         *        both indexes at once. As _id is unique, it is neither unique nor TTL.
+         * @throws std::invalid_argument, if keys are not ascending/descending or contain _id
+         */
+        IndexInfo temporaryIndex(const IndexInfo &info);
+
+        /**
+         * @brief Add: create new index. Rename or edit with other name: create new index, drop
+         *        old one. Edit keeping the name: create temporary index, drop old one, create
+         *        new index, drop temporary index. Indexes are built in background.
+         * @param oldInfo Edited index, without name for a new index
+         * @throws std::invalid_argument, if temporary index is needed but cannot be made
+         */
+        std::vector<Step> steps(const IndexInfo &oldInfo, const IndexInfo &newInfo);
+
+        // i.e. "Building index 'a_1'"
+        std::string describe(const Step &step);
+    }
+}
@@ -0,0 +1,64 @@
+#include "gtest/gtest.h"
+#include "RollingIndexBuild.h"
+
+#include <stdexcept>
+
+using namespace Robomongo;
+
+namespace
+{
+    IndexInfo index(const std::string &name, const std::string &keys)
+    {
+        return IndexInfo(MongoCollectionInfo("db.coll"), name, keys);
+    }
+}
+
+TEST(rolling_index_build_tests, add_only_creates)
+{
+    auto const steps = RollingIndexBuild::steps(index("", ""), index("a_1", "{ \"a\" : 1 }"));
+    ASSERT_EQ(1u, steps.size());
+    EXPECT_EQ(RollingIndexBuild::Step::Create, steps[0].kind);
+    EXPECT_EQ("a_1", steps[0].index._name);
+    EXPECT_TRUE(steps[0].index._backGround);
+}
+
+TEST(rolling_index_build_tests, rename_creates_before_drop)
+{
+    auto const steps = RollingIndexBuild::steps(index("a_1", "{ \"a\" : 1 }"),
+                                                index("a_1_b_1", "{ \"a\" : 1, \"b\" : 1 }"));
+    ASSERT_EQ(2u, steps.size());
+    EXPECT_EQ(RollingIndexBuild::Step::Create, steps[0].kind);
+    EXPECT_EQ("a_1_b_1", steps[0].index._name);
+    EXPECT_EQ(RollingIndexBuild::Step::Drop, steps[1].kind);
+    EXPECT_EQ("a_1", steps[1].index._name);
+}
+
+TEST(rolling_index_build_tests, same_name_goes_through_temporary_index)
+{
+    IndexInfo edited = index("byA", "{ \"a\" : 1, \"b\" : -1 }");
+    edited._unique = true;
+    edited._sparse = true;
+
+    auto const steps = RollingIndexBuild::steps(index("byA", "{ \"a\" : 1 }"), edited);
+    ASSERT_EQ(4u, steps.size());
+    EXPECT_EQ(RollingIndexBuild::Step::Create, steps[0].kind);
+    EXPECT_EQ("byA_rolling", steps[0].index._name);
+    EXPECT_EQ("{ \"a\" : 1, \"b\" : -1, \"_id\" : 1 }", steps[0].index._keys);
+    EXPECT_FALSE(steps[0].index._unique);
+    EXPECT_TRUE(steps[0].index._sparse);
+
+    EXPECT_EQ(RollingIndexBuild::Step::Drop, steps[1].kind);
+    EXPECT_EQ("byA", steps[1].index._name);
+    EXPECT_EQ(RollingIndexBuild::Step::Create, steps[2].kind);
+    EXPECT_TRUE(steps[2].index._unique);
+    EXPECT_EQ(RollingIndexBuild::Step::Drop, steps[3].kind);
+    EXPECT_EQ("byA_rolling", steps[3].index._name);
+}
+
+TEST(rolling_index_build_tests, same_name_needs_plain_keys)
+{
+    EXPECT_THROW(RollingIndexBuild::steps(index("t", "{ \"a\" : 1 }"), index("t", "{ \"a\" : \"text\" }")),
+                 std::invalid_argument);
+    EXPECT_THROW(RollingIndexBuild::steps(index("i", "{ \"a\" : 1 }"), index("i", "{ \"_id\" : 1, \"a\" : 1 }")),
+                 std::invalid_argument);
+}
@@ -0,0 +1,149 @@
+#include "robomongo/core/domain/SchemaAnalyzer.h"
+
+#include <algorithm>
+#include <mongo/bson/bsonobj.h>
+#include <mongo/bson/bsonobjiterator.h>
+#include <mongo/bson/bsontypes.h>
+
+namespace Robomongo
+{
+    SchemaAnalyzer::SchemaAnalyzer(int maxDepth, size_t maxFields) :
+        _maxDepth(maxDepth),
+        _maxFields(maxFields),
+        _documents(0),
+        _droppedPaths(0)
+    {
+        _paths.reserve(maxFields);
+    }
+
+    void SchemaAnalyzer::add(const mongo::BSONObj &document)
+    {
+        collect(document, "", 0);
+        ++_documents;
+    }
+
+    void SchemaAnalyzer::collect(const mongo::BSONObj &obj, const std::string &prefix, int depth)
+    {
+        for (mongo::BSONObjIterator it(obj); it.more();) {
+            mongo::BSONElement const element = it.next();
+            std::string const path = prefix + element.fieldName();
+
+            PathStats *const pathStats = stats(path);
+            if (!pathStats) {
+                ++_droppedPaths;
+                continue;
+            }
+
+            // Field of subdocuments in array is present once per document, its values are all counted
+            if (pathStats->lastDocument != _documents) {
+                pathStats->lastDocument = _documents;
+                ++pathStats->documents;
+            }
+            ++pathStats->values;
+            ++pathStats->types[typeSlot(element.type())];
+
+            // Type is mixed into hash of value, so that 1 and "1" are distinct
+            int const size = element.valuesize();
+            pathStats->valueBytes += size;
+            uint64_t const typeBits = static_cast<uint64_t>(element.type() & 0xff) * 0x9e3779b97f4a7c15ULL;
+            pathStats->distinct.addHash(HyperLogLog::hash(element.value(), size) ^ typeBits);
+
+            if (element.isNumber() || element.type() == mongo::Date) {
+                double const value = element.type() == mongo::Date ?
+                    static_cast<double>(element.date().toMillisSinceEpoch()) : element.numberDouble();
+                if (pathStats->rangeValues++ == 0) {
+                    pathStats->minValue = pathStats->maxValue = value;
+                } else {
+                    pathStats->minValue = std::min(pathStats->minValue, value);
+                    pathStats->maxValue = std::max(pathStats->maxValue, value);
+                }
+            }
+
+            if (depth + 1 >= _maxDepth)
+                continue;
+
+            if (element.type() == mongo::Object) {
+                collect(element.Obj(), path + ".", depth + 1);
+            }
+            else if (element.type() == mongo::Array) {
+                for (mongo::BSONObjIterator item(element.Obj()); item.more();) {
+                    mongo::BSONElement const value = item.next();
+                    if (value.type() == mongo::Object)
+                        collect(value.Obj(), path + ".", depth + 1);
+                }
+            }
+        }
+    }
+
+    SchemaAnalyzer::PathStats *SchemaAnalyzer::stats(const std::string &path)
+    {
+        auto found = _paths.find(path);
+        if (found != _paths.end())
+            return &found->second;
+
+        if (_paths.size() >= _maxFields)
+            return nullptr;
+
+        return &_paths[path];
+    }
+
+    std::vector<FieldAnalysis> SchemaAnalyzer::summary() const
+    {
+        std::vector<FieldAnalysis> fields;
+        fields.reserve(_paths.size());
+        for (auto const &path : _paths) {
+            PathStats const &stats = path.second;
+            FieldAnalysis field;
+            field.path = path.first;
+            field.documents = stats.documents;
+            field.values = stats.values;
+            field.distinct = stats.distinct.estimate();
+            if (stats.values > 0) {
+                field.nullRatio = static_cast<double>(stats.types[typeSlot(mongo::jstNULL)]) / stats.values;
+                field.averageSize = static_cast<double>(stats.valueBytes) / stats.values;
+            }
+            if (stats.rangeValues > 0) {
+                field.hasRange = true;
+                field.minValue = stats.minValue;
+                field.maxValue = stats.maxValue;
+            }
+            if (_documents > 0)
+                field.missingRatio = 1.0 - static_cast<double>(stats.documents) / _documents;
+
+            for (int slot = 0; slot < TypeSlots; ++slot) {
+                if (stats.types[slot] > 0)
+                    field.types.emplace_back(mongo::typeName(static_cast<mongo::BSONType>(slotType(slot))), 
+                                             stats.types[slot]);
+            }
+            std::stable_sort(field.types.begin(), field.types.end(),
+                [](const std::pair<std::string, long long> &a, const std::pair<std::string, long long> &b) {
+                    return a.second > b.second;
+                });
+
+            fields.push_back(std::move(field));
+        }
+
+        std::sort(fields.begin(), fields.end(), [](const FieldAnalysis &a, const FieldAnalysis &b) {
+            return a.path < b.path;
+        });
+        return fields;
+    }
+
+    int SchemaAnalyzer::typeSlot(int type)
+    {
+        if (type == mongo::MinKey)
+            return TypeSlots - 2;
+        if (type == mongo::MaxKey)
+            return TypeSlots - 1;
+        return std::min(std::max(type, 0), TypeSlots - 3);
+    }
+
+    int SchemaAnalyzer::slotType(int slot)
+    {
+        if (slot == TypeSlots - 2)
+            return mongo::MinKey;
+        if (slot == TypeSlots - 1)
+            return mongo::MaxKey;
+        return slot;
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "robomongo/core/utils/HyperLogLog.h"
+
+namespace mongo
+{
+    class BSONObj;
+}
+
+namespace Robomongo
+{
+    /**
+     * @brief Statistics of one field path, as reported by SchemaAnalyzer::summary()
+     */
+    struct FieldAnalysis
+    {
+        std::string path;                                   // dotted, i.e. "address.city"
+        std::vector<std::pair<std::string, long long>> types;  // BSON type name -> values, most frequent first
+        long long documents = 0;        // documents with this path
+        long long values = 0;           // values of path, more than documents for arrays of subdocuments
+        double distinct = 0;            // approximate number of distinct values
+        double nullRatio = 0;           // null values of all values
+        double missingRatio = 0;        // documents without this path of all documents
+        double averageSize = 0;         // bytes of BSON value
+        bool hasRange = false;          // path has numbers or dates (milliseconds since epoch)
+        double minValue = 0;
+        double maxValue = 0;
+    };
+
+    /**
+     * @brief Field statistics of documents streamed through it: type histogram, approximate
+     *        distinct count (HyperLogLog), null and missing ratio, average value size. Memory
+     *        is fixed, whatever the number of documents: paths over 'maxFields' and deeper
+     *        than 'maxDepth' are counted as dropped only. Not thread safe.
+     */
+    class SchemaAnalyzer
+    {
+    public:
+        static const int DefaultMaxDepth = 5;
+        static const size_t DefaultMaxFields = 500;
+
+        explicit SchemaAnalyzer(int maxDepth = DefaultMaxDepth, size_t maxFields = DefaultMaxFields);
+
+        void add(const mongo::BSONObj &document);
+
+        long long documents() const { return _documents; }
+        long long droppedPaths() const { return _droppedPaths; }
+
+        // Sorted by path
+        std::vector<FieldAnalysis> summary() const;
+
+    private:
+        // Histogram slots of BSON types 1..19 (by type number), MinKey and MaxKey
+        static constexpr int TypeSlots = 22;
+
+        struct PathStats
+        {
+            std::array<long long, TypeSlots> types {};
+            long long documents = 0;
+            long long values = 0;
+            long long valueBytes = 0;
+            long long lastDocument = -1;    // document which counted it last
+            long long rangeValues = 0;      // numbers and dates, of minValue and maxValue
+            double minValue = 0;
+            double maxValue = 0;
+            HyperLogLog distinct;
+        };
+
+        void collect(const mongo::BSONObj &obj, const std::string &prefix, int depth);
+        PathStats *stats(const std::string &path);
+
+        static int typeSlot(int type);
+        static int slotType(int slot);
+
+        int const _maxDepth;
+        size_t const _maxFields;
+        std::unordered_map<std::string, PathStats> _paths;
+        long long _documents;
+        long long _droppedPaths;
+    };
+}
@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+#include "SchemaAnalyzer.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    const FieldAnalysis *find(const std::vector<FieldAnalysis> &fields, const std::string &path)
+    {
+        for (FieldAnalysis const &field : fields) {
+            if (field.path == path)
+                return &field;
+        }
+        return nullptr;
+    }
+}
+
+TEST(schema_analyzer_tests, types_nulls_and_missing)
+{
+    SchemaAnalyzer analyzer;
+    for (int i = 0; i < 100; ++i) {
+        mongo::BSONObjBuilder builder;
+        builder.append("_id", i);
+        if (i % 4 == 0)
+            builder.appendNull("name");
+        else if (i % 2 == 0)
+            builder.append("name", "n" + std::to_string(i % 10));
+        builder.append("address", BSON("city" << (i % 3 ? "Oslo" : "Rome")));
+        analyzer.add(builder.obj());
+    }
+
+    std::vector<FieldAnalysis> const fields = analyzer.summary();
+    ASSERT_EQ(4u, fields.size());
+    EXPECT_EQ("_id", fields[0].path);
+    EXPECT_EQ(100, analyzer.documents());
+
+    FieldAnalysis const *id = find(fields, "_id");
+    ASSERT_TRUE(id);
+    EXPECT_NEAR(100, id->distinct, 2);
+    EXPECT_EQ(4, id->averageSize);
+    EXPECT_EQ(0, id->missingRatio);
+    EXPECT_TRUE(id->hasRange);
+    EXPECT_EQ(0, id->minValue);
+    EXPECT_EQ(99, id->maxValue);
+
+    FieldAnalysis const *name = find(fields, "name");
+    ASSERT_TRUE(name);
+    EXPECT_EQ(50, name->documents);
+    EXPECT_DOUBLE_EQ(0.5, name->missingRatio);
+    EXPECT_DOUBLE_EQ(0.5, name->nullRatio);
+    ASSERT_EQ(2u, name->types.size());
+    EXPECT_FALSE(name->hasRange);
+
+    FieldAnalysis const *city = find(fields, "address.city");
+    ASSERT_TRUE(city);
+    EXPECT_NEAR(2, city->distinct, 0.5);
+}
+
+TEST(schema_analyzer_tests, arrays_and_fixed_number_of_paths)
+{
+    SchemaAnalyzer analyzer(5, 3);
+    analyzer.add(BSON("tags" << BSON_ARRAY(BSON("name" << "a") << BSON("name" << "b")) << 
+                      "x" << 1 << "y" << 2));
+
+    std::vector<FieldAnalysis> const fields = analyzer.summary();
+    ASSERT_EQ(3u, fields.size());
+    EXPECT_EQ(1, analyzer.droppedPaths());
+
+    // Field of subdocuments in array: present in one document, with two values
+    FieldAnalysis const *name = find(fields, "tags.name");
+    ASSERT_TRUE(name);
+    EXPECT_EQ(1, name->documents);
+    EXPECT_EQ(2, name->values);
+}
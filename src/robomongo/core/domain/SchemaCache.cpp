@@ -0,0 +1,130 @@
+#include "robomongo/core/domain/SchemaCache.h"
+
+#include <ctime>
+#include <QDir>
+#include <QFile>
+#include <QVariantList>
+#include <QVariantMap>
+
+#include <parser.h>
+#include <serializer.h>
+
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace
+{
+    QString const SchemaCacheFileName = "schemas.json";
+}
+
+namespace Robomongo
+{
+    SchemaCache::SchemaCache()
+    {
+        load();
+    }
+
+    SchemaCache &SchemaCache::instance()
+    {
+        static SchemaCache cache;
+        return cache;
+    }
+
+    const CollectionSchema *SchemaCache::find(const std::string &key) const
+    {
+        auto const it = _schemas.find(key);
+        return it == _schemas.end() ? nullptr : &it->second;
+    }
+
+    void SchemaCache::insert(const std::string &key, const CollectionSchema &schema)
+    {
+        _schemas[key] = schema;
+
+        while (_schemas.size() > MaxCollections) {
+            auto oldest = _schemas.begin();
+            for (auto it = _schemas.begin(); it != _schemas.end(); ++it) {
+                if (it->second.sampledAt < oldest->second.sampledAt)
+                    oldest = it;
+            }
+            _schemas.erase(oldest);
+        }
+
+        save();
+    }
+
+    bool SchemaCache::startSampling(const std::string &key)
+    {
+        if (_sampledInSession.count(key))
+            return false;
+
+        CollectionSchema const *schema = find(key);
+        if (schema && std::time(nullptr) - schema->sampledAt < MaxAgeSecs)
+            return false;
+
+        _sampledInSession.insert(key);
+        return true;
+    }
+
+    void SchemaCache::load()
+    {
+        QFile file(CacheDir + SchemaCacheFileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return;
+
+        bool ok = false;
+        QJson::Parser parser;
+        QVariantMap const map = parser.parse(file.readAll(), &ok).toMap();
+        if (!ok)
+            return;
+
+        for (auto it = map.begin(); it != map.end(); ++it) {
+            QVariantMap const entry = it.value().toMap();
+            CollectionSchema schema;
+            schema.sampledAt = entry.value("sampledAt").toLongLong();
+            schema.sampledDocuments = entry.value("sampledDocuments").toInt();
+
+            // [path, type, count] per field
+            for (QVariant const &value : entry.value("fields").toList()) {
+                QVariantList const list = value.toList();
+                if (list.size() != 3)
+                    continue;
+
+                SchemaField field;
+                field.path = QtUtils::toStdString(list.at(0).toString());
+                field.type = QtUtils::toStdString(list.at(1).toString());
+                field.count = list.at(2).toInt();
+                schema.fields.push_back(field);
+            }
+            _schemas[QtUtils::toStdString(it.key())] = schema;
+        }
+    }
+
+    void SchemaCache::save() const
+    {
+        QVariantMap map;
+        for (auto const &schema : _schemas) {
+            QVariantList fields;
+            for (SchemaField const &field : schema.second.fields) {
+                fields.append(QVariant(QVariantList() << QtUtils::toQString(field.path)
+                                                      << QtUtils::toQString(field.type) << field.count));
+            }
+
+            QVariantMap entry;
+            entry.insert("sampledAt", schema.second.sampledAt);
+            entry.insert("sampledDocuments", schema.second.sampledDocuments);
+            entry.insert("fields", fields);
+            map.insert(QtUtils::toQString(schema.first), entry);
+        }
+
+        if (!QDir(CacheDir).exists())
+            QDir().mkpath(CacheDir);
+
+        QFile file(CacheDir + SchemaCacheFileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return;
+
+        bool ok = false;
+        QJson::Serializer serializer;
+        serializer.serialize(map, &file, &ok);
+    }
+}
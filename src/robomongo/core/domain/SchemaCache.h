@@ -0,0 +1,49 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "robomongo/core/domain/CollectionSchema.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Inferred schemas of collections of all servers, by "address/db.collection".
+     *        Kept in cache directory between sessions. Used in GUI thread only.
+     */
+    class SchemaCache
+    {
+    public:
+        static SchemaCache &instance();
+
+        /**
+         * @return nullptr, if collection was never sampled
+         */
+        const CollectionSchema *find(const std::string &key) const;
+
+        /**
+         * @brief Stores schema and saves cache file. The least recently sampled
+         *        collections are dropped over MaxCollections.
+         */
+        void insert(const std::string &key, const CollectionSchema &schema);
+
+        /**
+         * @brief Collection should be (re)sampled: it is not known or its schema is older than
+         *        MaxAgeSecs. Every collection is sampled at most once per session, so that
+         *        failing or slow $sample is not repeated on every key press.
+         */
+        bool startSampling(const std::string &key);
+
+    private:
+        SchemaCache();
+        void load();
+        void save() const;
+
+        static const size_t MaxCollections = 256;
+        static const long long MaxAgeSecs = 24 * 60 * 60;
+
+        std::map<std::string, CollectionSchema> _schemas;
+        std::set<std::string> _sampledInSession;
+    };
+}
@@ -0,0 +1,240 @@
+#include "robomongo/core/domain/ScriptBroadcast.h"
+
+#include <algorithm>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoShellResult.h"
+#include "robomongo/core/mongodb/MongoWorker.h"
+#include "robomongo/core/mongodb/SshTunnelWorker.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/settings/SshSettings.h"
+
+namespace Robomongo
+{
+    ScriptBroadcast::ScriptBroadcast(const std::vector<ConnectionSettings *> &connections, const std::string &script,
+                                     const std::string &dbName, int concurrency, QObject *parent) :
+        QObject(parent),
+        _script(script),
+        _dbName(dbName),
+        _concurrency(std::max(concurrency, 1)),
+        _bus(AppRegistry::instance().bus()),
+        _results(connections.size()),
+        _connections(connections.size()),
+        _next(0),
+        _running(0),
+        _finished(0),
+        _isCancelled(false)
+    {
+        for (size_t i = 0; i < connections.size(); ++i) {
+            _results[i].connection = connections[i]->getReadableName();
+            _connections[i].settings.reset(connections[i]->clone());
+        }
+    }
+
+    ScriptBroadcast::~ScriptBroadcast()
+    {
+        for (auto &connection : _connections) {
+            if (connection.worker)
+                connection.worker->stopAndDelete();
+            if (connection.tunnel)
+                connection.tunnel->stopAndDelete();
+        }
+    }
+
+    void ScriptBroadcast::start()
+    {
+        // Connections, which fail right away, start the next ones themselves
+        while (_running < _concurrency && _next < _results.size())
+            startNext();
+
+        if (_results.empty())
+            emit finished();
+    }
+
+    void ScriptBroadcast::cancel()
+    {
+        if (_isCancelled)
+            return;
+        _isCancelled = true;
+
+        for (size_t i = 0; i < _results.size(); ++i) {
+            Result::Status const status = _results[i].status;
+            if (status == Result::Pending || status == Result::Connecting || status == Result::Running)
+                finish(static_cast<int>(i), Result::Cancelled);
+        }
+    }
+
+    void ScriptBroadcast::startNext()
+    {
+        int const index = static_cast<int>(_next++);
+        Slot &connection = _connections[index];
+        ++_running;
+        connection.timer.start();
+        _results[index].status = Result::Connecting;
+        emit resultChanged(index);
+
+        SshSettings *ssh = connection.settings->sshSettings();
+        if (!ssh->enabled() || connection.settings->isReplicaSet()) {
+            connectWorker(index, 0);
+            return;
+        }
+
+        // Password is not asked for every connection of broadcast
+        if (ssh->askPassword() && ssh->askedPassword().empty()) {
+            finish(index, Result::Failed, "SSH password is asked by this connection, connect to it first");
+            return;
+        }
+
+        // Tunnel is told which connection it belongs to by server handle
+        ConnectionSettings *settingsCopy = connection.settings->clone();
+        connection.tunnel = new SshTunnelWorker(settingsCopy);
+        _bus->send(connection.tunnel, new EstablishSshConnectionRequest(this, index, connection.tunnel, settingsCopy,
+                                                                        ConnectionPrimary));
+    }
+
+    void ScriptBroadcast::connectWorker(int index, int localPort)
+    {
+        Slot &connection = _connections[index];
+        if (localPort > 0) {
+            connection.settings->setServerHost("127.0.0.1");
+            connection.settings->setServerPort(localPort);
+        }
+
+        // No warm scopes, worker runs this script only
+        SettingsManager *settings = AppRegistry::instance().settingsManager();
+        connection.worker = new MongoWorker(connection.settings->clone(),
+                                            settings->loadMongoRcJs(),
+                                            settings->batchSize(),
+                                            settings->mongoTimeoutSec(),
+                                            settings->shellTimeoutSec(),
+                                            settings->shellResultMemoryBudgetMb(),
+                                            settings->jsHeapLimitMb(),
+                                            0);
+
+        _bus->send(connection.worker, new EstablishConnectionRequest(this, ConnectionPrimary,
+                                                                     connection.settings->uuid().toStdString()));
+    }
+
+    void ScriptBroadcast::handle(EstablishSshConnectionResponse *event)
+    {
+        int const index = event->serverHandle;
+        if (index < 0 || index >= static_cast<int>(_results.size()) || _results[index].status != Result::Connecting)
+            return;
+
+        if (event->isError()) {
+            finish(index, Result::Failed, "SSH tunnel failed: " + event->error().errorMessage());
+            return;
+        }
+
+        _bus->send(event->worker, new ListenSshConnectionRequest(this, index, event->connectionType));
+        connectWorker(index, event->localport);
+    }
+
+    void ScriptBroadcast::handle(ListenSshConnectionResponse *event)
+    {
+        // Tunnel is listened to until it fails or is stopped
+        int const index = event->serverHandle;
+        if (index < 0 || index >= static_cast<int>(_results.size()))
+            return;
+
+        Result::Status const status = _results[index].status;
+        if (status == Result::Connecting || status == Result::Running)
+            finish(index, Result::Failed, event->isError() ? "SSH tunnel closed: " + event->error().errorMessage()
+                                                           : "SSH tunnel closed");
+    }
+
+    void ScriptBroadcast::handle(EstablishConnectionResponse *event)
+    {
+        int const index = indexOf(event->sender());
+        if (index < 0 || _results[index].status != Result::Connecting)
+            return;
+
+        if (event->isError()) {
+            finish(index, Result::Failed, event->error().errorMessage());
+            return;
+        }
+
+        Slot &connection = _connections[index];
+        Result &result = _results[index];
+        result.connectMs = connection.timer.restart();
+        result.status = Result::Running;
+        emit resultChanged(index);
+
+        std::string const database = _dbName.empty() ? connection.settings->defaultDatabase() : _dbName;
+        _bus->send(connection.worker, new ExecuteScriptRequest(this, _script, database));
+    }
+
+    void ScriptBroadcast::handle(ExecuteScriptResponse *event)
+    {
+        int const index = indexOf(event->sender());
+        if (index < 0 || _results[index].status != Result::Running)
+            return;
+
+        Result &result = _results[index];
+        result.scriptMs = _connections[index].timer.elapsed();
+
+        if (event->isError()) {
+            finish(index, Result::Failed, event->error().errorMessage());
+            return;
+        }
+
+        MongoShellExecResult const &execResult = event->result;
+        for (auto const &shellResult : execResult.results()) {
+            result.documents.insert(result.documents.end(), shellResult.documents().begin(),
+                                    shellResult.documents().end());
+            if (shellResult.documents().empty() && !shellResult.response().empty())
+                result.responses.push_back(shellResult.response());
+        }
+
+        if (execResult.error())
+            finish(index, Result::Failed, execResult.errorMessage());
+        else if (event->timeoutReached())
+            finish(index, Result::Failed, "Script timed out");
+        else
+            finish(index, Result::Done);
+    }
+
+    int ScriptBroadcast::indexOf(QObject *worker) const
+    {
+        for (size_t i = 0; i < _connections.size(); ++i) {
+            if (_connections[i].worker == worker)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    void ScriptBroadcast::finish(int index, Result::Status status, const std::string &error)
+    {
+        Result &result = _results[index];
+        bool const wasStarted = result.status != Result::Pending;
+        result.status = status;
+        result.error = error;
+
+        // Stopped workers are deleted in their threads, late responses are ignored by status
+        Slot &connection = _connections[index];
+        if (connection.worker) {
+            if (status == Result::Cancelled)
+                connection.worker->interrupt();
+            connection.worker->stopAndDelete();
+            connection.worker = nullptr;
+        }
+        if (connection.tunnel) {
+            connection.tunnel->stopAndDelete();
+            connection.tunnel = nullptr;
+        }
+
+        ++_finished;
+        emit resultChanged(index);
+
+        if (wasStarted) {
+            --_running;
+            if (!_isCancelled && _next < _results.size())
+                startNext();
+        }
+
+        if (isFinished())
+            emit finished();
+    }
+}
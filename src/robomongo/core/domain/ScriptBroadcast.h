@@ -0,0 +1,95 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <QElapsedTimer>
+#include <QObject>
+
+#include "robomongo/core/events/MongoEvents.h"
+
+namespace Robomongo
+{
+    class ConnectionSettings;
+    class EventBus;
+    class MongoWorker;
+    class SshTunnelWorker;
+
+    /**
+     * @brief Runs one script on many connections, without opening them in explorer. Every
+     *        connection gets its own MongoWorker (and SSH tunnel, as BatchRunner does), at
+     *        most 'concurrency' of them at once; the worker is stopped when its script is done.
+     *        Results are kept in order of connections, resultChanged() is emitted for each change.
+     */
+    class ScriptBroadcast : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        struct Result
+        {
+            enum Status { Pending, Connecting, Running, Done, Failed, Cancelled };
+
+            std::string connection;         // readable name
+            Status status = Pending;
+            std::string error;
+            std::vector<MongoDocumentPtr> documents;    // of all statements, first batch of cursors
+            std::vector<std::string> responses;         // text output of statements without documents
+            qint64 connectMs = 0;
+            qint64 scriptMs = 0;
+        };
+
+        /**
+         * @param dbName Database of script, default database of connection if empty
+         */
+        ScriptBroadcast(const std::vector<ConnectionSettings *> &connections, const std::string &script,
+                        const std::string &dbName, int concurrency, QObject *parent = nullptr);
+        ~ScriptBroadcast();
+
+        void start();
+
+        // Interrupts running scripts, connections which have not started are not run
+        void cancel();
+
+        const std::vector<Result> &results() const { return _results; }
+        bool isFinished() const { return _finished == _results.size(); }
+
+    Q_SIGNALS:
+        void resultChanged(int index);
+        void finished();
+
+    protected Q_SLOTS:
+        void handle(EstablishSshConnectionResponse *event);
+        void handle(ListenSshConnectionResponse *event);
+        void handle(EstablishConnectionResponse *event);
+        void handle(ExecuteScriptResponse *event);
+
+    private:
+        struct Slot
+        {
+            std::unique_ptr<ConnectionSettings> settings;
+            MongoWorker *worker = nullptr;
+            SshTunnelWorker *tunnel = nullptr;
+            QElapsedTimer timer;
+        };
+
+        void startNext();
+        void connectWorker(int index, int localPort);
+        int indexOf(QObject *worker) const;
+
+        // Sets final status of connection, stops its workers and starts the next connection
+        void finish(int index, Result::Status status, const std::string &error = std::string());
+
+        std::string const _script;
+        std::string const _dbName;
+        int const _concurrency;
+        EventBus *_bus;
+
+        std::vector<Result> _results;
+        std::vector<Slot> _connections;   // by index of result
+        size_t _next;       // connection to start next
+        int _running;
+        size_t _finished;
+        bool _isCancelled;
+    };
+}
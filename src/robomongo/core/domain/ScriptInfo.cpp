@@ -71,6 +71,13 @@ namespace Robomongo
         _cursor(position),
         _filePath(filePath) {}
 
+    void ScriptInfo::setScript(const QString &script)
+    {
+        if (script != _script)
+            _nativeQuery.reset();
+        _script = script;
+    }
+
     bool ScriptInfo::loadFromFile(const QString &filePath)
     {
         bool result = false;
@@ -78,7 +85,7 @@ namespace Robomongo
         if (!filepath.isEmpty()) {
             QString out;
             if (loadFromFileText(filepath, out)) {
-                _script = out;
+                setScript(out);
                 _filePath = filepath;
                 result = true;
             }
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <QString>
+#include <memory>
 
 #include "robomongo/core/domain/CursorPosition.h"
 
 namespace Robomongo
 {
+    struct NativeQuery;
+
     class ScriptInfo
     {
     public:
@@ -19,8 +22,16 @@ namespace Robomongo
         std::string dbname() const { return _dbname; }
         const QString &title() const { return _title; }
         const CursorPosition &cursor() const { return _cursor; }
-        void setScript(const QString &script) { _script = script; }
+        void setScript(const QString &script);
         QString filePath() const { return _filePath; }
+
+        /**
+         * @brief Compiled form of script (i.e. bound query template), which is run instead of
+         *        parsing script. It is dropped, once script is changed.
+         */
+        void setNativeQuery(const std::shared_ptr<const NativeQuery> &query) { _nativeQuery = query; }
+        const std::shared_ptr<const NativeQuery> &nativeQuery() const { return _nativeQuery; }
+
         bool loadFromFile(const QString &filePath);
         bool loadFromFile();
         bool saveToFileAs();
@@ -33,5 +44,6 @@ namespace Robomongo
         const QString _title;
         const CursorPosition _cursor;
         QString _filePath;
+        std::shared_ptr<const NativeQuery> _nativeQuery;
     };
 }
@@ -0,0 +1,106 @@
+#include "robomongo/core/domain/ServerStatusSeries.h"
+
+#include <algorithm>
+
+namespace Robomongo
+{
+    namespace
+    {
+        // Dotted path of every metric in serverStatus result, counters first
+        const char *const metricPaths[ServerStatusSeries::MetricCount] = {
+            "opcounters.insert", "opcounters.query", "opcounters.update", "opcounters.delete",
+            "opcounters.getmore", "opcounters.command",
+            "network.bytesIn", "network.bytesOut",
+            "wiredTiger.cache.bytes currently in the cache", 
+            "wiredTiger.cache.tracked dirty bytes in the cache",
+            "globalLock.currentQueue.readers", "globalLock.currentQueue.writers",
+            "connections.current"
+        };
+
+        const char *const metricNames[ServerStatusSeries::MetricCount] = {
+            "Inserts/s", "Queries/s", "Updates/s", "Deletes/s", "Get mores/s", "Commands/s",
+            "Network in", "Network out",
+            "Cache used", "Cache dirty",
+            "Queued readers", "Queued writers", "Connections"
+        };
+    }
+
+    const char *ServerStatusSeries::metricName(Metric metric)
+    {
+        return metricNames[metric];
+    }
+
+    bool ServerStatusSeries::isRate(Metric metric)
+    {
+        return metric <= NetworkOut;
+    }
+
+    bool ServerStatusSeries::addSample(const mongo::BSONObj &status)
+    {
+        // Server clock gives interval of counters, it does not depend on latency of request
+        mongo::BSONElement const uptimeElement = status["uptimeMillis"];
+        if (!uptimeElement.isNumber())
+            return false;
+
+        double const uptimeMs = uptimeElement.numberDouble();
+        std::array<double, MetricCount> counters {};
+        std::array<double, MetricCount> values {};
+        bool isRestarted = _uptimeMs < 0 || uptimeMs <= _uptimeMs;
+
+        double const cacheMax = status.getFieldDotted("wiredTiger.cache.maximum bytes configured").numberDouble();
+        for (int metric = 0; metric < MetricCount; ++metric) {
+            mongo::BSONElement const element = status.getFieldDotted(metricPaths[metric]);
+            _isAvailable[metric] = element.isNumber();
+            double const number = element.numberDouble();
+
+            if (isRate(Metric(metric))) {
+                counters[metric] = number;
+                if (number < _counters[metric])
+                    isRestarted = true;
+                else
+                    values[metric] = (number - _counters[metric]) * 1000 / (uptimeMs - _uptimeMs);
+            }
+            else if (metric == CacheUsed || metric == CacheDirty) {
+                values[metric] = cacheMax > 0 ? number * 100 / cacheMax : 0;
+            }
+            else {
+                values[metric] = number;
+            }
+        }
+
+        _counters = counters;
+        _uptimeMs = uptimeMs;
+        if (isRestarted)
+            return false;
+
+        int const index = (_head + _size) % Capacity;
+        for (int metric = 0; metric < MetricCount; ++metric)
+            _values[metric][index] = values[metric];
+
+        if (_size < Capacity)
+            ++_size;
+        else
+            _head = (_head + 1) % Capacity;
+        return true;
+    }
+
+    void ServerStatusSeries::clear()
+    {
+        _uptimeMs = -1;
+        _head = 0;
+        _size = 0;
+    }
+
+    double ServerStatusSeries::value(Metric metric, int i) const
+    {
+        return _values[metric][(_head + i) % Capacity];
+    }
+
+    double ServerStatusSeries::max(Metric metric) const
+    {
+        double result = 0;
+        for (int i = 0; i < _size; ++i)
+            result = std::max(result, value(metric, i));
+        return result;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Recent values of server metrics computed from successive serverStatus results:
+     *        rates of counters (from deltas between two samples) and gauges. Values are kept 
+     *        in a fixed-size ring buffer, adding a sample does not allocate.
+     */
+    class ServerStatusSeries
+    {
+    public:
+        enum Metric
+        {
+            Inserts, Queries, Updates, Deletes, GetMores, Commands,     // per second
+            NetworkIn, NetworkOut,                                      // bytes per second
+            CacheUsed, CacheDirty,                                      // % of WiredTiger cache
+            QueuedReaders, QueuedWriters, Connections,
+            MetricCount
+        };
+
+        static const int Capacity = 300;
+
+        static const char *metricName(Metric metric);
+        static bool isRate(Metric metric);
+
+        /**
+         * @brief Adds values of serverStatus result. The first sample (and sample after server
+         *        restart, when counters went down) only gives base for rates of the next one.
+         * @return false, if nothing was added
+         */
+        bool addSample(const mongo::BSONObj &status);
+
+        void clear();
+
+        // Number of values, the same for all metrics
+        int size() const { return _size; }
+
+        // Value 'i' of metric, 0 is the oldest one. Metrics missing in serverStatus are 0.
+        double value(Metric metric, int i) const;
+        double last(Metric metric) const { return _size > 0 ? value(metric, _size - 1) : 0; }
+        double max(Metric metric) const;
+
+        // Whether metric was reported, i.e. cache metrics only come with WiredTiger
+        bool isAvailable(Metric metric) const { return _isAvailable[metric]; }
+
+    private:
+        // Counters of the previous sample, base for rates
+        std::array<double, MetricCount> _counters {};
+        double _uptimeMs = -1;      // -1 if there is no previous sample
+
+        std::array<std::array<double, Capacity>, MetricCount> _values {};
+        std::array<bool, MetricCount> _isAvailable {};
+        int _head = 0;              // index of the oldest value
+        int _size = 0;
+    };
+}
@@ -0,0 +1,59 @@
+#include "gtest/gtest.h"
+#include "ServerStatusSeries.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    mongo::BSONObj status(long long uptimeMs, long long inserts, long long bytesIn)
+    {
+        return BSON("uptimeMillis" << uptimeMs << 
+                    "opcounters" << BSON("insert" << inserts) <<
+                    "network" << BSON("bytesIn" << bytesIn) <<
+                    "connections" << BSON("current" << 7));
+    }
+}
+
+TEST(server_status_series_tests, rates_from_deltas)
+{
+    ServerStatusSeries series;
+    EXPECT_FALSE(series.addSample(status(1000, 100, 5000)));
+    EXPECT_EQ(0, series.size());
+
+    ASSERT_TRUE(series.addSample(status(3000, 300, 9000)));
+    ASSERT_EQ(1, series.size());
+    EXPECT_DOUBLE_EQ(100, series.last(ServerStatusSeries::Inserts));
+    EXPECT_DOUBLE_EQ(2000, series.last(ServerStatusSeries::NetworkIn));
+    EXPECT_DOUBLE_EQ(7, series.last(ServerStatusSeries::Connections));
+    EXPECT_TRUE(series.isAvailable(ServerStatusSeries::Inserts));
+    EXPECT_FALSE(series.isAvailable(ServerStatusSeries::CacheUsed));
+}
+
+TEST(server_status_series_tests, restart_skips_sample)
+{
+    ServerStatusSeries series;
+    series.addSample(status(1000, 100, 0));
+    series.addSample(status(2000, 200, 0));
+    EXPECT_FALSE(series.addSample(status(500, 10, 0)));
+    ASSERT_TRUE(series.addSample(status(1500, 60, 0)));
+    ASSERT_EQ(2, series.size());
+    EXPECT_DOUBLE_EQ(50, series.last(ServerStatusSeries::Inserts));
+}
+
+TEST(server_status_series_tests, ring_keeps_latest_values)
+{
+    ServerStatusSeries series;
+    long long inserts = 0;
+    series.addSample(status(0, 0, 0));
+    for (int i = 1; i <= ServerStatusSeries::Capacity + 10; ++i) {
+        inserts += i;
+        series.addSample(status(i * 1000LL, inserts, 0));
+    }
+
+    ASSERT_EQ(ServerStatusSeries::Capacity, series.size());
+    EXPECT_DOUBLE_EQ(11, series.value(ServerStatusSeries::Inserts, 0));
+    EXPECT_DOUBLE_EQ(ServerStatusSeries::Capacity + 10, series.last(ServerStatusSeries::Inserts));
+    EXPECT_DOUBLE_EQ(ServerStatusSeries::Capacity + 10, series.max(ServerStatusSeries::Inserts));
+}
@@ -0,0 +1,144 @@
+#include "robomongo/core/domain/ShardDistribution.h"
+
+#include <algorithm>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace Robomongo
+{
+    namespace ShardDistribution
+    {
+        namespace
+        {
+            ShardInfo &shardOf(Snapshot &snapshot, const std::string &name)
+            {
+                auto found = std::lower_bound(snapshot.shards.begin(), snapshot.shards.end(), name,
+                    [](const ShardInfo &info, const std::string &shard) { return info.shard < shard; });
+                if (found == snapshot.shards.end() || found->shard != name) {
+                    found = snapshot.shards.insert(found, ShardInfo());
+                    found->shard = name;
+                }
+                return *found;
+            }
+
+            long long millisOf(const mongo::BSONElement &element)
+            {
+                return element.type() == mongo::Date ? element.date().toMillisSinceEpoch() : 0;
+            }
+        }
+
+        mongo::BSONObj chunksFilter(const mongo::BSONObj &collection, const std::string &ns)
+        {
+            if (collection.hasField("uuid"))
+                return BSON("$or" << BSON_ARRAY(BSON("uuid" << collection["uuid"]) << BSON("ns" << ns)));
+            return BSON("ns" << ns);
+        }
+
+        mongo::BSONArray chunksPipeline(const mongo::BSONObj &filter)
+        {
+            return BSON_ARRAY(BSON("$match" << filter) <<
+                              BSON("$group" << BSON("_id" << BSON("shard" << "$shard" <<
+                                                                  "jumbo" << BSON("$ifNull" << BSON_ARRAY("$jumbo" << false))) <<
+                                                    "chunks" << BSON("$sum" << 1))));
+        }
+
+        mongo::BSONArray changelogPipeline(const std::string &ns, long long sinceMs)
+        {
+            mongo::BSONObj const what = BSON("$in" << BSON_ARRAY("moveChunk.commit" << "moveChunk.error" <<
+                                                                 "split" << "multi-split"));
+            return BSON_ARRAY(BSON("$match" << BSON("ns" << ns << "what" << what <<
+                                                    "time" << BSON("$gt" << mongo::Date_t::fromMillisSinceEpoch(sinceMs)))) <<
+                              BSON("$group" << BSON("_id" << BSON("what" << "$what" << "from" << "$details.from" <<
+                                                                  "to" << "$details.to") <<
+                                                    "count" << BSON("$sum" << 1) <<
+                                                    "last" << BSON("$max" << "$time"))));
+        }
+
+        void addShard(Snapshot &snapshot, const std::string &shard)
+        {
+            shardOf(snapshot, shard);
+        }
+
+        void addChunkGroup(Snapshot &snapshot, const mongo::BSONObj &group)
+        {
+            mongo::BSONObj const id = group.getObjectField("_id");
+            long long const chunks = group["chunks"].safeNumberLong();
+
+            ShardInfo &shard = shardOf(snapshot, id.getStringField("shard"));
+            shard.chunks += chunks;
+            if (id["jumbo"].trueValue())
+                shard.jumboChunks += chunks;
+            snapshot.totalChunks += chunks;
+        }
+
+        void addStorageStats(Snapshot &snapshot, const mongo::BSONObj &stats)
+        {
+            mongo::BSONObj const storage = stats.getObjectField("storageStats");
+            if (storage.isEmpty())
+                return;
+
+            // Unsharded $collStats on mongod has no "shard"
+            std::string const name = stats.hasField("shard") ? stats.getStringField("shard") : "";
+            if (name.empty() && snapshot.shards.size() != 1)
+                return;
+
+            ShardInfo &shard = name.empty() ? snapshot.shards.front() : shardOf(snapshot, name);
+            shard.dataBytes = std::max(shard.dataBytes, 0LL) + storage["size"].safeNumberLong();
+            shard.documents = std::max(shard.documents, 0LL) + storage["count"].safeNumberLong();
+        }
+
+        void addChangelogGroup(Snapshot &snapshot, const mongo::BSONObj &group)
+        {
+            mongo::BSONObj const id = group.getObjectField("_id");
+            std::string const what = id.getStringField("what");
+            long long const count = group["count"].safeNumberLong();
+            long long const lastMs = millisOf(group["last"]);
+
+            BalancerInfo &balancer = snapshot.balancer;
+            balancer.lastActivityMs = std::max(balancer.lastActivityMs, lastMs);
+            if (what == "moveChunk.commit") {
+                balancer.migrations += count;
+                balancer.lastMigrationMs = std::max(balancer.lastMigrationMs, lastMs);
+                if (id["from"].type() == mongo::String)
+                    shardOf(snapshot, id.getStringField("from")).movedOut += count;
+                if (id["to"].type() == mongo::String)
+                    shardOf(snapshot, id.getStringField("to")).movedIn += count;
+            }
+            else if (what == "moveChunk.error") {
+                balancer.failedMigrations += count;
+            }
+            else {
+                balancer.splits += count;
+            }
+        }
+
+        void addActivity(Snapshot &current, const Snapshot &previous)
+        {
+            for (ShardInfo const &old : previous.shards) {
+                if (old.movedIn == 0 && old.movedOut == 0)
+                    continue;
+                ShardInfo &shard = shardOf(current, old.shard);
+                shard.movedIn += old.movedIn;
+                shard.movedOut += old.movedOut;
+            }
+
+            BalancerInfo &balancer = current.balancer;
+            BalancerInfo const &old = previous.balancer;
+            balancer.migrations += old.migrations;
+            balancer.failedMigrations += old.failedMigrations;
+            balancer.splits += old.splits;
+            balancer.lastMigrationMs = std::max(balancer.lastMigrationMs, old.lastMigrationMs);
+            balancer.lastActivityMs = std::max(balancer.lastActivityMs, old.lastActivityMs);
+        }
+
+        long long chunkSpread(const Snapshot &snapshot)
+        {
+            if (snapshot.shards.empty())
+                return 0;
+
+            auto const bounds = std::minmax_element(snapshot.shards.begin(), snapshot.shards.end(),
+                [](const ShardInfo &left, const ShardInfo &right) { return left.chunks < right.chunks; });
+            return bounds.second->chunks - bounds.first->chunks;
+        }
+    }
+}
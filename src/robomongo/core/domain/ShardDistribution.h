@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Distribution of sharded collection over shards. Chunks are counted by
+     *        aggregation on config.chunks grouped by shard and jumbo flag, so that only
+     *        a few documents are returned for collections with hundreds of thousands of
+     *        chunks (getShardDistribution() of shell reads every chunk). Balancer activity
+     *        is read from config.changelog incrementally: every refresh asks only for entries
+     *        newer than the last one seen and adds them to the previous totals.
+     */
+    namespace ShardDistribution
+    {
+        struct ShardInfo
+        {
+            std::string shard;                  // _id of config.shards
+            long long chunks = 0;
+            long long jumboChunks = 0;
+            long long dataBytes = -1;           // -1, if $collStats is not available
+            long long documents = -1;
+            long long movedIn = 0;              // committed migrations of chunks
+            long long movedOut = 0;
+        };
+
+        struct BalancerInfo
+        {
+            std::string mode;                   // "full" or "off", empty if balancerStatus failed
+            bool inRound = false;
+            bool noBalance = false;             // balancing disabled for this collection
+            long long migrations = 0;
+            long long failedMigrations = 0;
+            long long splits = 0;
+            long long lastMigrationMs = 0;
+            long long lastActivityMs = 0;       // time of newest changelog entry read
+        };
+
+        struct Snapshot
+        {
+            std::vector<ShardInfo> shards;      // sorted by name
+            BalancerInfo balancer;
+            long long totalChunks = 0;
+        };
+
+        /**
+         * @param collection Document of config.collections
+         * @return Filter of config.chunks: by uuid since 5.0, by namespace before
+         */
+        mongo::BSONObj chunksFilter(const mongo::BSONObj &collection, const std::string &ns);
+
+        // Aggregation on config.chunks, one document per shard and jumbo flag
+        mongo::BSONArray chunksPipeline(const mongo::BSONObj &filter);
+
+        // Aggregation on config.changelog: migrations and splits newer than 'sinceMs'
+        mongo::BSONArray changelogPipeline(const std::string &ns, long long sinceMs);
+
+        // Shard without chunks is listed too, the balancer should move chunks to it
+        void addShard(Snapshot &snapshot, const std::string &shard);
+
+        // Adds result document of chunksPipeline()
+        void addChunkGroup(Snapshot &snapshot, const mongo::BSONObj &group);
+
+        // Adds document of $collStats with storageStats, mongos reports one per shard
+        void addStorageStats(Snapshot &snapshot, const mongo::BSONObj &stats);
+
+        // Adds result document of changelogPipeline()
+        void addChangelogGroup(Snapshot &snapshot, const mongo::BSONObj &group);
+
+        /**
+         * @brief Adds balancer activity of 'previous' snapshot to 'current' one, which was
+         *        read only since the newest changelog entry of 'previous'
+         */
+        void addActivity(Snapshot &current, const Snapshot &previous);
+
+        // Chunks of the fullest shard minus chunks of the emptiest one
+        long long chunkSpread(const Snapshot &snapshot);
+    }
+}
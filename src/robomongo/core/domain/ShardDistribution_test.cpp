@@ -0,0 +1,84 @@
+#include "gtest/gtest.h"
+#include "ShardDistribution.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    mongo::BSONObj chunkGroup(const std::string &shard, bool jumbo, int chunks)
+    {
+        return BSON("_id" << BSON("shard" << shard << "jumbo" << jumbo) << "chunks" << chunks);
+    }
+
+    mongo::BSONObj changelogGroup(const std::string &what, const std::string &from, const std::string &to,
+                                  int count, long long lastMs)
+    {
+        mongo::BSONObjBuilder id;
+        id.append("what", what);
+        if (!from.empty())
+            id.append("from", from);
+        if (!to.empty())
+            id.append("to", to);
+        return BSON("_id" << id.obj() << "count" << count <<
+                    "last" << mongo::Date_t::fromMillisSinceEpoch(lastMs));
+    }
+}
+
+TEST(shard_distribution_tests, chunks_filter_by_uuid_since_5_0)
+{
+    EXPECT_EQ("ns", std::string(ShardDistribution::chunksFilter(BSON("_id" << "db.c"), "db.c").firstElementFieldName()));
+    EXPECT_EQ("$or", std::string(ShardDistribution::chunksFilter(BSON("_id" << "db.c" << "uuid" << 1), "db.c")
+                                     .firstElementFieldName()));
+}
+
+TEST(shard_distribution_tests, chunks_by_shard_and_jumbo)
+{
+    ShardDistribution::Snapshot snapshot;
+    ShardDistribution::addShard(snapshot, "shard3");
+    ShardDistribution::addChunkGroup(snapshot, chunkGroup("shard2", false, 40));
+    ShardDistribution::addChunkGroup(snapshot, chunkGroup("shard1", false, 100));
+    ShardDistribution::addChunkGroup(snapshot, chunkGroup("shard1", true, 3));
+
+    ASSERT_EQ(3u, snapshot.shards.size());
+    EXPECT_EQ("shard1", snapshot.shards[0].shard);
+    EXPECT_EQ(103, snapshot.shards[0].chunks);
+    EXPECT_EQ(3, snapshot.shards[0].jumboChunks);
+    EXPECT_EQ(0, snapshot.shards[2].chunks);
+    EXPECT_EQ(143, snapshot.totalChunks);
+    EXPECT_EQ(103, ShardDistribution::chunkSpread(snapshot));
+
+    ShardDistribution::addStorageStats(snapshot, BSON("shard" << "shard2" << "storageStats" <<
+                                                      BSON("size" << 2048 << "count" << 16)));
+    EXPECT_EQ(2048, snapshot.shards[1].dataBytes);
+    EXPECT_EQ(16, snapshot.shards[1].documents);
+    EXPECT_EQ(-1, snapshot.shards[0].dataBytes);
+}
+
+TEST(shard_distribution_tests, activity_is_accumulated_between_refreshes)
+{
+    ShardDistribution::Snapshot previous;
+    ShardDistribution::addChangelogGroup(previous, changelogGroup("moveChunk.commit", "shard1", "shard2", 5, 1000));
+    ShardDistribution::addChangelogGroup(previous, changelogGroup("split", "", "", 7, 1500));
+    EXPECT_EQ(5, previous.balancer.migrations);
+    EXPECT_EQ(1000, previous.balancer.lastMigrationMs);
+    EXPECT_EQ(1500, previous.balancer.lastActivityMs);
+
+    ShardDistribution::Snapshot current;
+    ShardDistribution::addChunkGroup(current, chunkGroup("shard1", false, 10));
+    ShardDistribution::addChangelogGroup(current, changelogGroup("moveChunk.commit", "shard2", "shard1", 1, 2000));
+    ShardDistribution::addChangelogGroup(current, changelogGroup("moveChunk.error", "shard1", "shard2", 2, 2500));
+    ShardDistribution::addActivity(current, previous);
+
+    ASSERT_EQ(2u, current.shards.size());
+    EXPECT_EQ(1, current.shards[0].movedIn);
+    EXPECT_EQ(5, current.shards[0].movedOut);
+    EXPECT_EQ(5, current.shards[1].movedIn);
+    EXPECT_EQ(1, current.shards[1].movedOut);
+    EXPECT_EQ(6, current.balancer.migrations);
+    EXPECT_EQ(2, current.balancer.failedMigrations);
+    EXPECT_EQ(7, current.balancer.splits);
+    EXPECT_EQ(2000, current.balancer.lastMigrationMs);
+    EXPECT_EQ(2500, current.balancer.lastActivityMs);
+}
@@ -0,0 +1,137 @@
+#include "robomongo/core/domain/ShardFanout.h"
+
+#include <algorithm>
+#include <queue>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace Robomongo
+{
+    namespace ShardFanout
+    {
+        const char *const Comment = "Robo 3T shard fan-out";
+
+        void parseShardHost(const std::string &host, std::string &setName, std::vector<std::string> &hosts)
+        {
+            setName.clear();
+            hosts.clear();
+
+            std::string list = host;
+            size_t const slash = host.find('/');
+            if (slash != std::string::npos) {
+                setName = host.substr(0, slash);
+                list = host.substr(slash + 1);
+            }
+
+            size_t start = 0;
+            while (start <= list.size()) {
+                size_t end = list.find(',', start);
+                if (end == std::string::npos)
+                    end = list.size();
+                if (end > start)
+                    hosts.push_back(list.substr(start, end - start));
+                start = end + 1;
+            }
+        }
+
+        std::vector<Range> mergeRanges(std::vector<Range> ranges)
+        {
+            std::sort(ranges.begin(), ranges.end(), [](const Range &a, const Range &b) {
+                return a.min.woCompare(b.min, mongo::BSONObj(), false) < 0;
+            });
+
+            std::vector<Range> merged;
+            for (Range const &range : ranges) {
+                if (!merged.empty() && merged.back().max.woCompare(range.min, mongo::BSONObj(), false) == 0)
+                    merged.back().max = range.max;
+                else
+                    merged.push_back(range);
+            }
+            return merged;
+        }
+
+        std::vector<Target> targets(const std::vector<mongo::BSONObj> &shards,
+                                    const std::vector<mongo::BSONObj> &chunks)
+        {
+            std::vector<Target> result;
+            for (mongo::BSONObj const &shard : shards) {
+                Target target;
+                target.shard = shard.getStringField("_id");
+                parseShardHost(shard.getStringField("host"), target.setName, target.hosts);
+
+                std::vector<Range> ranges;
+                for (mongo::BSONObj const &chunk : chunks) {
+                    if (target.shard == chunk.getStringField("shard"))
+                        ranges.push_back(Range{ chunk.getObjectField("min").getOwned(),
+                                                chunk.getObjectField("max").getOwned() });
+                }
+                if (ranges.empty() || target.hosts.empty())
+                    continue;
+
+                target.ranges = mergeRanges(std::move(ranges));
+                result.push_back(std::move(target));
+            }
+            return result;
+        }
+
+        mongo::BSONObj sortKey(const mongo::BSONObj &doc, const mongo::BSONObj &sort)
+        {
+            mongo::BSONObjBuilder key;
+            for (mongo::BSONObjIterator it(sort); it.more();) {
+                mongo::BSONElement const value = doc.getFieldDotted(it.next().fieldName());
+                if (value.eoo())
+                    key.appendNull("");
+                else
+                    key.appendAs(value, "");
+            }
+            return key.obj();
+        }
+
+        std::vector<mongo::BSONObj> mergeSorted(const std::vector<std::vector<mongo::BSONObj>> &streams,
+                                                const mongo::BSONObj &sort, int limit)
+        {
+            size_t const most = limit > 0 ? static_cast<size_t>(limit) : static_cast<size_t>(-1);
+            std::vector<mongo::BSONObj> merged;
+
+            if (sort.isEmpty()) {
+                for (auto const &stream : streams) {
+                    for (mongo::BSONObj const &doc : stream) {
+                        if (merged.size() >= most)
+                            return merged;
+                        merged.push_back(doc);
+                    }
+                }
+                return merged;
+            }
+
+            // Heads of streams, the smallest key first (ties by stream, so merge is stable)
+            struct Head
+            {
+                mongo::BSONObj key;
+                size_t stream;
+                size_t position;
+            };
+            auto const greater = [&sort](const Head &a, const Head &b) {
+                int const cmp = a.key.woCompare(b.key, sort, false);
+                return cmp != 0 ? cmp > 0 : a.stream > b.stream;
+            };
+            std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads(greater);
+
+            for (size_t i = 0; i < streams.size(); ++i) {
+                if (!streams[i].empty())
+                    heads.push(Head{ sortKey(streams[i][0], sort), i, 0 });
+            }
+
+            while (!heads.empty() && merged.size() < most) {
+                Head const head = heads.top();
+                heads.pop();
+
+                auto const &stream = streams[head.stream];
+                merged.push_back(stream[head.position]);
+                if (head.position + 1 < stream.size())
+                    heads.push(Head{ sortKey(stream[head.position + 1], sort), head.stream, head.position + 1 });
+            }
+            return merged;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Read-only query of sharded collection sent to every shard directly instead of
+     *        through mongos. Each shard is queried only for key ranges of chunks it owns
+     *        (with $min/$max on shard key index), so that orphaned documents are not read
+     *        twice. Sorted results of all ranges are merged client side.
+     */
+    namespace ShardFanout
+    {
+        // Comment of shard queries, so that they are recognized in $currentOp and profiler
+        extern const char *const Comment;
+
+        struct Range
+        {
+            mongo::BSONObj min;     // inclusive, in shard key (index) space
+            mongo::BSONObj max;     // exclusive
+        };
+
+        struct Target
+        {
+            std::string shard;                  // _id of config.shards
+            std::string setName;                // empty, if shard is standalone mongod
+            std::vector<std::string> hosts;     // "host:port"
+            std::vector<Range> ranges;          // contiguous chunks merged, ascending
+        };
+
+        // Statistics of queries of one shard
+        struct ShardResult
+        {
+            std::string shard;
+            std::string host;                   // member that answered, "host:port"
+            size_t ranges = 0;
+            long long documents = 0;
+            long long elapsedMs = 0;
+        };
+
+        /**
+         * @brief Splits "host" of config.shards: "rs0/a:27017,b:27017" or "a:27017"
+         */
+        void parseShardHost(const std::string &host, std::string &setName, std::vector<std::string> &hosts);
+
+        /**
+         * @brief Sorts ranges by min and merges every range with the next one, if it starts
+         *        where this one ends
+         */
+        std::vector<Range> mergeRanges(std::vector<Range> ranges);
+
+        /**
+         * @param shards Documents of config.shards
+         * @param chunks Documents of config.chunks of one collection, in any order
+         * @return Only shards owning chunks, in order of 'shards'
+         */
+        std::vector<Target> targets(const std::vector<mongo::BSONObj> &shards,
+                                    const std::vector<mongo::BSONObj> &chunks);
+
+        /**
+         * @brief Values of sort fields (dotted paths) of document, missing ones as null as
+         *        server sorts them, so that keys compare with woCompare(other, sort, false)
+         */
+        mongo::BSONObj sortKey(const mongo::BSONObj &doc, const mongo::BSONObj &sort);
+
+        /**
+         * @brief Merges streams sorted by 'sort' into one, keeps order of streams and their
+         *        documents, if sort is empty
+         * @param limit Most documents returned, 0 for all
+         */
+        std::vector<mongo::BSONObj> mergeSorted(const std::vector<std::vector<mongo::BSONObj>> &streams,
+                                                const mongo::BSONObj &sort, int limit);
+    }
+}
@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+#include "ShardFanout.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+TEST(shard_fanout_tests, parse_shard_host)
+{
+    std::string setName;
+    std::vector<std::string> hosts;
+
+    ShardFanout::parseShardHost("rs0/a:27017,b:27018", setName, hosts);
+    EXPECT_EQ("rs0", setName);
+    ASSERT_EQ(2u, hosts.size());
+    EXPECT_EQ("a:27017", hosts[0]);
+    EXPECT_EQ("b:27018", hosts[1]);
+
+    ShardFanout::parseShardHost("c:27019", setName, hosts);
+    EXPECT_EQ("", setName);
+    ASSERT_EQ(1u, hosts.size());
+    EXPECT_EQ("c:27019", hosts[0]);
+}
+
+TEST(shard_fanout_tests, targets_merge_contiguous_chunks)
+{
+    std::vector<mongo::BSONObj> const shards = {
+        BSON("_id" << "s0" << "host" << "rs0/a:1"),
+        BSON("_id" << "s1" << "host" << "rs1/b:1"),
+        BSON("_id" << "s2" << "host" << "rs2/c:1")
+    };
+    std::vector<mongo::BSONObj> const chunks = {
+        BSON("shard" << "s0" << "min" << BSON("k" << 20) << "max" << BSON("k" << 30)),
+        BSON("shard" << "s1" << "min" << BSON("k" << 10) << "max" << BSON("k" << 20)),
+        BSON("shard" << "s0" << "min" << BSON("k" << 0) << "max" << BSON("k" << 10)),
+        BSON("shard" << "s0" << "min" << BSON("k" << 30) << "max" << BSON("k" << 40))
+    };
+
+    auto const targets = ShardFanout::targets(shards, chunks);
+    ASSERT_EQ(2u, targets.size());     // s2 owns no chunks
+
+    EXPECT_EQ("s0", targets[0].shard);
+    EXPECT_EQ("rs0", targets[0].setName);
+    ASSERT_EQ(2u, targets[0].ranges.size());
+    EXPECT_EQ(BSON("k" << 0).toString(), targets[0].ranges[0].min.toString());
+    EXPECT_EQ(BSON("k" << 10).toString(), targets[0].ranges[0].max.toString());
+    EXPECT_EQ(BSON("k" << 20).toString(), targets[0].ranges[1].min.toString());
+    EXPECT_EQ(BSON("k" << 40).toString(), targets[0].ranges[1].max.toString());
+
+    EXPECT_EQ("s1", targets[1].shard);
+    ASSERT_EQ(1u, targets[1].ranges.size());
+}
+
+TEST(shard_fanout_tests, merge_sorted_streams)
+{
+    std::vector<std::vector<mongo::BSONObj>> const streams = {
+        { BSON("a" << 9 << "s" << 0), BSON("a" << 5 << "s" << 0), BSON("a" << 1 << "s" << 0) },
+        { BSON("a" << 7 << "s" << 1), BSON("s" << 1) },     // missing 'a' sorts as null, last
+        { }
+    };
+
+    auto const merged = ShardFanout::mergeSorted(streams, BSON("a" << -1), 4);
+    ASSERT_EQ(4u, merged.size());
+    EXPECT_EQ(9, merged[0]["a"].numberInt());
+    EXPECT_EQ(7, merged[1]["a"].numberInt());
+    EXPECT_EQ(5, merged[2]["a"].numberInt());
+    EXPECT_EQ(1, merged[3]["a"].numberInt());
+
+    auto const all = ShardFanout::mergeSorted(streams, BSON("a" << -1), 0);
+    ASSERT_EQ(5u, all.size());
+    EXPECT_FALSE(all[4].hasField("a"));
+}
+
+TEST(shard_fanout_tests, merge_without_sort_concatenates)
+{
+    std::vector<std::vector<mongo::BSONObj>> const streams = {
+        { BSON("a" << 2), BSON("a" << 1) },
+        { BSON("a" << 3) }
+    };
+
+    auto const merged = ShardFanout::mergeSorted(streams, mongo::BSONObj(), 0);
+    ASSERT_EQ(3u, merged.size());
+    EXPECT_EQ(2, merged[0]["a"].numberInt());
+    EXPECT_EQ(3, merged[2]["a"].numberInt());
+}
@@ -0,0 +1,94 @@
+#include "robomongo/core/domain/SharedDocuments.h"
+
+#include <algorithm>
+#include <cstring>
+#include <QHash>
+
+#include "robomongo/core/domain/MongoDocument.h"
+
+namespace Robomongo
+{
+    SharedDocuments &SharedDocuments::instance()
+    {
+        static SharedDocuments documents;
+        return documents;
+    }
+
+    bool SharedDocuments::find(const std::vector<MongoDocumentPtr> &documents,
+                               std::vector<MongoDocumentPtr> &shared)
+    {
+        if (MongoDocument::bsonSize(documents) < MinSharedBytes)
+            return false;
+
+        auto const range = _entries.equal_range(hash(documents));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.size() != documents.size() || !lock(it->second, shared))
+                continue;
+
+            // Hash tells nothing for sure, bytes do
+            bool equal = true;
+            for (size_t i = 0; equal && i < documents.size(); ++i) {
+                mongo::BSONObj const &ours = documents[i]->bsonObj();
+                mongo::BSONObj const &theirs = shared[i]->bsonObj();
+                equal = ours.objsize() == theirs.objsize() &&
+                        std::memcmp(ours.objdata(), theirs.objdata(), ours.objsize()) == 0;
+            }
+            if (equal)
+                return true;
+        }
+
+        shared.clear();
+        return false;
+    }
+
+    void SharedDocuments::add(const std::vector<MongoDocumentPtr> &documents)
+    {
+        if (MongoDocument::bsonSize(documents) < MinSharedBytes)
+            return;
+
+        if (_entries.size() >= _sweepAt) {
+            sweep();
+            _sweepAt = std::max<size_t>(64, 2 * _entries.size());
+        }
+
+        _entries.emplace(hash(documents), Entry(documents.begin(), documents.end()));
+    }
+
+    size_t SharedDocuments::size()
+    {
+        sweep();
+        return _entries.size();
+    }
+
+    size_t SharedDocuments::hash(const std::vector<MongoDocumentPtr> &documents)
+    {
+        uint seed = 0;
+        for (MongoDocumentPtr const &document : documents)
+            seed = qHashBits(document->bsonObj().objdata(), document->bsonObj().objsize(), seed);
+        return seed;
+    }
+
+    void SharedDocuments::sweep()
+    {
+        std::vector<MongoDocumentPtr> documents;
+        for (auto it = _entries.begin(); it != _entries.end();) {
+            if (lock(it->second, documents))
+                ++it;
+            else
+                it = _entries.erase(it);
+        }
+    }
+
+    bool SharedDocuments::lock(const Entry &entry, std::vector<MongoDocumentPtr> &documents)
+    {
+        documents.clear();
+        documents.reserve(entry.size());
+        for (boost::weak_ptr<MongoDocument> const &weak : entry) {
+            MongoDocumentPtr document = weak.lock();
+            if (!document)
+                return false;
+            documents.push_back(std::move(document));
+        }
+        return true;
+    }
+}
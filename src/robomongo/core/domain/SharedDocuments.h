@@ -0,0 +1,60 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <boost/weak_ptr.hpp>
+
+#include "robomongo/core/Core.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Batches and pages of documents held by results, by hash of their raw BSON. Result
+     *        receiving documents identical to those held by another result (i.e. the same query
+     *        in duplicated tab) keeps the other's documents and drops its own copy. Documents are
+     *        immutable: refreshed result receives new documents, which are looked up again, and
+     *        the shared ones stay with results still showing them.
+     *        Documents are not owned here, they are forgotten when no result holds them.
+     *        Used in GUI thread only.
+     */
+    class SharedDocuments
+    {
+    public:
+        static SharedDocuments &instance();
+
+        // Smaller batches are not worth looking up
+        static const long long MinSharedBytes = 16 * 1024;
+
+        SharedDocuments() {}
+
+        /**
+         * @brief Documents held by some result, which are byte for byte equal to 'documents'
+         * @return false, if there are none (or 'documents' are smaller than MinSharedBytes)
+         */
+        bool find(const std::vector<MongoDocumentPtr> &documents, std::vector<MongoDocumentPtr> &shared);
+
+        /**
+         * @brief Registers documents just received by result, for find() of results to come
+         */
+        void add(const std::vector<MongoDocumentPtr> &documents);
+
+        // Registered batches, which are still held by some result
+        size_t size();
+
+        /**
+         * @brief Hash of BSON of documents one after another
+         */
+        static size_t hash(const std::vector<MongoDocumentPtr> &documents);
+
+    private:
+        typedef std::vector<boost::weak_ptr<MongoDocument>> Entry;
+
+        // Entries, which some document was freed of, are dropped
+        void sweep();
+
+        static bool lock(const Entry &entry, std::vector<MongoDocumentPtr> &documents);
+
+        std::unordered_multimap<size_t, Entry> _entries;
+        size_t _sweepAt = 64;   // number of entries, when expired ones are dropped again
+    };
+}
@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+#include "SharedDocuments.h"
+#include "MongoDocument.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    std::vector<MongoDocumentPtr> batch(const std::string &name)
+    {
+        std::vector<mongo::BSONObj> objs;
+        for (int i = 0; i < 100; ++i)
+            objs.push_back(BSON("_id" << i << "name" << name << "padding" << std::string(200, 'x')));
+        return MongoDocument::fromBatch(objs);
+    }
+}
+
+TEST(shared_documents_tests, identical_batch_is_shared)
+{
+    SharedDocuments registry;
+    std::vector<MongoDocumentPtr> const first = batch("first");
+    registry.add(first);
+
+    std::vector<MongoDocumentPtr> shared;
+    ASSERT_TRUE(registry.find(batch("first"), shared));
+    ASSERT_EQ(first.size(), shared.size());
+    EXPECT_EQ(first[10].get(), shared[10].get());
+
+    EXPECT_FALSE(registry.find(batch("other"), shared));
+    EXPECT_TRUE(shared.empty());
+    EXPECT_EQ(1u, registry.size());
+}
+
+TEST(shared_documents_tests, small_and_freed_batches_are_not_shared)
+{
+    SharedDocuments registry;
+    std::vector<MongoDocumentPtr> const small = MongoDocument::fromBatch({ BSON("_id" << 1) });
+    registry.add(small);
+    std::vector<MongoDocumentPtr> shared;
+    EXPECT_FALSE(registry.find(MongoDocument::fromBatch({ BSON("_id" << 1) }), shared));
+
+    {
+        std::vector<MongoDocumentPtr> const freed = batch("freed");
+        registry.add(freed);
+        EXPECT_EQ(1u, registry.size());
+    }
+    EXPECT_FALSE(registry.find(batch("freed"), shared));
+    EXPECT_EQ(0u, registry.size());
+}
@@ -0,0 +1,154 @@
+#include "robomongo/core/domain/TableChangeset.h"
+
+#include <algorithm>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/domain/DocumentUpdate.h"
+
+namespace
+{
+    bool lessBson(const mongo::BSONObj &left, const mongo::BSONObj &right)
+    {
+        return left.woCompare(right) < 0;
+    }
+}
+
+namespace Robomongo
+{
+    void TableChangeset::set(int row, const mongo::BSONObj &original, const std::string &field,
+                             const mongo::BSONElement &value)
+    {
+        auto it = _rows.find(row);
+        mongo::BSONObj const loadedDocument = it != _rows.end() ? it->second.original : original;
+        mongo::BSONElement const loaded = loadedDocument.getField(field);
+        bool const isLoadedValue = !loaded.eoo() && loaded.binaryEqualValues(value);
+
+        if (isLoadedValue) {
+            if (it == _rows.end())
+                return;
+
+            it->second.values.erase(field);
+            if (it->second.values.empty())
+                _rows.erase(it);
+            return;
+        }
+
+        if (it == _rows.end())
+            it = _rows.emplace(row, Row{ original.getOwned(), {} }).first;
+
+        mongo::BSONObjBuilder wrapped;
+        wrapped.appendAs(value, field);
+        it->second.values[field] = wrapped.obj();
+    }
+
+    mongo::BSONElement TableChangeset::value(int row, const std::string &field) const
+    {
+        auto const it = _rows.find(row);
+        if (it == _rows.end())
+            return mongo::BSONElement();
+
+        auto const value = it->second.values.find(field);
+        return value != it->second.values.end() ? value->second.firstElement() : mongo::BSONElement();
+    }
+
+    int TableChangeset::changeCount() const
+    {
+        int count = 0;
+        for (auto const &row : _rows)
+            count += static_cast<int>(row.second.values.size());
+        return count;
+    }
+
+    mongo::BSONObj TableChangeset::edited(int row) const
+    {
+        auto const it = _rows.find(row);
+        if (it == _rows.end())
+            return mongo::BSONObj();
+
+        Row const &edited = it->second;
+        mongo::BSONObjBuilder document;
+        for (mongo::BSONObjIterator fields(edited.original); fields.more(); ) {
+            mongo::BSONElement const elem = fields.next();
+            auto const value = edited.values.find(elem.fieldName());
+            document.append(value != edited.values.end() ? value->second.firstElement() : elem);
+        }
+
+        // Columns of other documents, that this one did not have
+        for (auto const &value : edited.values) {
+            if (!edited.original.hasField(value.first))
+                document.append(value.second.firstElement());
+        }
+        return document.obj();
+    }
+
+    std::vector<TableChangeset::Statement> TableChangeset::statements() const
+    {
+        std::vector<Statement> statements;
+        for (auto const &row : _rows) {
+            mongo::BSONObj const &original = row.second.original;
+            mongo::BSONElement const id = original.getField("_id");
+            if (id.eoo())
+                continue;
+
+            Statement statement;
+            statement.row = row.first;
+            mongo::BSONObjBuilder idOnly;
+            idOnly.append(id);
+            statement.id = idOnly.obj();
+
+            mongo::BSONObj const edited = this->edited(row.first);
+            DocumentUpdate diff;
+            if (diff.compute(original, edited)) {
+                if (diff.isEmpty())
+                    continue;
+
+                statement.filter = diff.filter();
+                statement.update = diff.update();
+            }
+            else {
+                // Replacement, still guarded by loaded values of edited fields
+                mongo::BSONObjBuilder filter;
+                filter.append(id);
+                for (auto const &value : row.second.values) {
+                    mongo::BSONElement const loaded = original.getField(value.first);
+                    if (loaded.eoo())
+                        filter.append(value.first, BSON("$exists" << false));
+                    else
+                        filter.append(value.first, BSON("$eq" << loaded));
+                }
+                statement.filter = filter.obj();
+                statement.update = edited;
+            }
+
+            // $eq, so that edited regular expressions are compared as values, not matched
+            mongo::BSONObjBuilder applied;
+            applied.append(id);
+            for (auto const &value : row.second.values)
+                applied.append(value.first, BSON("$eq" << value.second.firstElement()));
+            statement.applied = applied.obj();
+
+            statements.push_back(statement);
+        }
+        return statements;
+    }
+
+    std::vector<TableChangeset::Conflict> TableChangeset::conflicts(const std::vector<Statement> &statements,
+                                                                    const std::vector<mongo::BSONObj> &matchedIds,
+                                                                    const std::map<int, std::string> &writeErrors)
+    {
+        std::vector<mongo::BSONObj> matched(matchedIds);
+        std::sort(matched.begin(), matched.end(), lessBson);
+
+        std::vector<Conflict> conflicts;
+        for (size_t i = 0; i < statements.size(); ++i) {
+            auto const error = writeErrors.find(static_cast<int>(i));
+            if (error != writeErrors.end())
+                conflicts.push_back(Conflict{ statements[i].row, error->second });
+            else if (!std::binary_search(matched.begin(), matched.end(), statements[i].id, lessBson))
+                conflicts.push_back(Conflict{ statements[i].row, "Document was modified or removed by "
+                                              "another client after it was loaded." });
+        }
+        return conflicts;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Cells of table view edited, but not yet saved. Every edited row keeps document
+     *        as it was loaded, so that all rows are committed together as targeted updates
+     *        (see DocumentUpdate), which fail for rows changed by another client since then.
+     */
+    class TableChangeset
+    {
+    public:
+        /**
+         * @brief Update of one edited row, element of 'updates' of update command
+         */
+        struct Statement
+        {
+            int row = -1;
+            mongo::BSONObj id;          // { _id: <value> }
+            mongo::BSONObj filter;      // matches document only while it is as it was loaded
+            mongo::BSONObj update;      // $set/$unset, or replacement document
+            mongo::BSONObj applied;     // matches document once update was applied
+        };
+
+        struct Conflict
+        {
+            int row;
+            std::string error;
+        };
+
+        struct CommitResult
+        {
+            bool transaction = false;   // statements were run in one multi-document transaction
+            bool aborted = false;       // transaction was aborted, nothing was saved
+            int updated = 0;
+            std::vector<Conflict> conflicts;
+        };
+
+        /**
+         * @brief Sets field of document at 'row' to 'value'. Setting loaded value again
+         *        removes the change.
+         * @param original Document as it was loaded, copied on the first change of row
+         */
+        void set(int row, const mongo::BSONObj &original, const std::string &field,
+                 const mongo::BSONElement &value);
+
+        /**
+         * @return Edited value of field (named 'field'), EOO if field is not edited
+         */
+        mongo::BSONElement value(int row, const std::string &field) const;
+
+        bool isEdited(int row) const { return _rows.count(row) != 0; }
+        bool isEmpty() const { return _rows.empty(); }
+        int rowCount() const { return static_cast<int>(_rows.size()); }
+        int changeCount() const;
+        void discard(int row) { _rows.erase(row); }
+        void clear() { _rows.clear(); }
+
+        /**
+         * @brief Loaded document of row with edited values, fields missing in it are appended
+         */
+        mongo::BSONObj edited(int row) const;
+
+        /**
+         * @brief One statement per edited row, in order of rows. Rows without _id are skipped.
+         */
+        std::vector<Statement> statements() const;
+
+        /**
+         * @brief Rows of statements that were not applied
+         * @param matchedIds { _id: <value> } of documents matching filter (or 'applied') of their statement
+         * @param writeErrors Index of statement -> error reported by server
+         */
+        static std::vector<Conflict> conflicts(const std::vector<Statement> &statements,
+                                               const std::vector<mongo::BSONObj> &matchedIds,
+                                               const std::map<int, std::string> &writeErrors);
+
+    private:
+        struct Row
+        {
+            mongo::BSONObj original;
+            std::map<std::string, mongo::BSONObj> values;   // field -> { <field>: <value> }
+        };
+
+        std::map<int, Row> _rows;
+    };
+}
@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+#include "TableChangeset.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    mongo::BSONElement element(const mongo::BSONObj &holder)
+    {
+        return holder.firstElement();
+    }
+}
+
+TEST(table_changeset_tests, loaded_value_removes_change)
+{
+    mongo::BSONObj const doc = BSON("_id" << 1 << "a" << 1 << "b" << "x");
+    mongo::BSONObj const two = BSON("v" << 2);
+    mongo::BSONObj const one = BSON("v" << 1);
+
+    TableChangeset changeset;
+    changeset.set(0, doc, "a", element(one));
+    EXPECT_TRUE(changeset.isEmpty());
+
+    changeset.set(0, doc, "a", element(two));
+    ASSERT_TRUE(changeset.isEdited(0));
+    EXPECT_EQ(2, changeset.value(0, "a").numberInt());
+    EXPECT_TRUE(changeset.value(0, "b").eoo());
+
+    changeset.set(0, doc, "a", element(one));
+    EXPECT_TRUE(changeset.isEmpty());
+}
+
+TEST(table_changeset_tests, edited_keeps_order_and_appends_new_fields)
+{
+    mongo::BSONObj const doc = BSON("_id" << 1 << "a" << 1 << "b" << "x");
+    TableChangeset changeset;
+    changeset.set(3, doc, "c", element(BSON("v" << true)));
+    changeset.set(3, doc, "a", element(BSON("v" << 5)));
+
+    EXPECT_TRUE(changeset.edited(3).binaryEqual(BSON("_id" << 1 << "a" << 5 << "b" << "x" << "c" << true)));
+    EXPECT_EQ(2, changeset.changeCount());
+    EXPECT_EQ(1, changeset.rowCount());
+}
+
+TEST(table_changeset_tests, statements_are_targeted_and_guarded)
+{
+    mongo::BSONObj const doc = BSON("_id" << 7 << "a" << 1 << "payload" << std::string(1000, 'x'));
+    TableChangeset changeset;
+    changeset.set(0, doc, "a", element(BSON("v" << 2)));
+    changeset.set(1, BSON("a" << 1), "a", element(BSON("v" << 2)));   // no _id, not saved
+
+    std::vector<TableChangeset::Statement> const statements = changeset.statements();
+    ASSERT_EQ(1u, statements.size());
+    EXPECT_EQ(0, statements[0].row);
+    EXPECT_TRUE(statements[0].id.binaryEqual(BSON("_id" << 7)));
+    EXPECT_TRUE(statements[0].filter.binaryEqual(BSON("_id" << 7 << "a" << 1)));
+    EXPECT_TRUE(statements[0].update.binaryEqual(BSON("$set" << BSON("a" << 2))));
+    EXPECT_TRUE(statements[0].applied.binaryEqual(BSON("_id" << 7 << "a" << BSON("$eq" << 2))));
+}
+
+TEST(table_changeset_tests, conflicts_of_unmatched_and_failed_statements)
+{
+    TableChangeset changeset;
+    for (int row = 0; row < 3; ++row)
+        changeset.set(row, BSON("_id" << row << "a" << 1), "a", element(BSON("v" << 2)));
+
+    std::vector<TableChangeset::Statement> const statements = changeset.statements();
+    ASSERT_EQ(3u, statements.size());
+
+    std::map<int, std::string> writeErrors;
+    writeErrors[2] = "Document failed validation";
+    std::vector<TableChangeset::Conflict> const conflicts =
+        TableChangeset::conflicts(statements, { BSON("_id" << 0), BSON("_id" << 2) }, writeErrors);
+
+    ASSERT_EQ(2u, conflicts.size());
+    EXPECT_EQ(1, conflicts[0].row);
+    EXPECT_EQ(2, conflicts[1].row);
+    EXPECT_EQ("Document failed validation", conflicts[1].error);
+}
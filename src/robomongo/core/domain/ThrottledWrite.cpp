@@ -0,0 +1,90 @@
+#include "robomongo/core/domain/ThrottledWrite.h"
+
+#include <algorithm>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace Robomongo
+{
+    namespace ThrottledWrite
+    {
+        mongo::BSONObj remainingQuery(const mongo::BSONObj &filter, const mongo::BSONObj &lastId)
+        {
+            mongo::BSONObj const idOrder = BSON("_id" << 1);
+            mongo::BSONObjBuilder query;
+            query.append("$query", filter);
+            query.append("$orderby", idOrder);
+            query.append("$hint", idOrder);
+            if (!lastId.isEmpty())
+                query.append("$min", lastId);
+            return query.obj();
+        }
+
+        mongo::BSONObj chunkFilter(const mongo::BSONObj &filter, const std::vector<mongo::BSONObj> &ids)
+        {
+            mongo::BSONArrayBuilder values;
+            for (mongo::BSONObj const &id : ids)
+                values.append(id.firstElement());
+
+            mongo::BSONObj const idFilter = BSON("_id" << BSON("$in" << values.arr()));
+            if (filter.isEmpty())
+                return idFilter;
+            return BSON("$and" << BSON_ARRAY(filter << idFilter));
+        }
+
+        long long replicationLagMs(const mongo::BSONObj &status)
+        {
+            mongo::BSONElement const members = status["members"];
+            if (members.type() != mongo::Array)
+                return -1;
+
+            long long primaryMs = -1;
+            long long slowestMs = -1;
+            for (mongo::BSONObjIterator it(members.Obj()); it.more(); ) {
+                mongo::BSONObj const member = it.next().Obj();
+                mongo::BSONElement const optime = member["optimeDate"];
+                if (optime.type() != mongo::Date)
+                    continue;
+
+                long long const optimeMs = optime.date().toMillisSinceEpoch();
+                int const state = member["state"].numberInt();
+                if (state == 1)
+                    primaryMs = optimeMs;
+                else if (state == 2 && member["health"].numberDouble() > 0)
+                    slowestMs = slowestMs < 0 ? optimeMs : std::min(slowestMs, optimeMs);
+            }
+
+            if (primaryMs < 0 || slowestMs < 0)
+                return -1;
+            return std::max(0LL, primaryMs - slowestMs);
+        }
+
+        Throttle::Throttle(long long maxLagMs) :
+            _maxLagMs(maxLagMs),
+            _chunkSize(InitialChunkSize) {}
+
+        long long Throttle::afterChunk(long long lagMs, double chunkMs)
+        {
+            if (_maxLagMs > 0 && lagMs > _maxLagMs) {
+                _chunkSize = std::max(MinChunkSize, _chunkSize / 2);
+                return LagPollMs;
+            }
+
+            if (chunkMs > MaxChunkMs) {
+                _chunkSize = std::max(MinChunkSize, static_cast<int>(_chunkSize * MaxChunkMs / chunkMs));
+                return 0;
+            }
+
+            // Grows while secondaries keep up easily, holds near the threshold
+            bool const lagIsLow = _maxLagMs <= 0 || lagMs < _maxLagMs / 2;
+            if (lagIsLow && chunkMs < MaxChunkMs / 2)
+                _chunkSize = std::min(MaxChunkSize, _chunkSize + _chunkSize / 2);
+            return 0;
+        }
+
+        long long Throttle::whileWaiting(long long lagMs) const
+        {
+            return _maxLagMs > 0 && lagMs > _maxLagMs / 2 ? LagPollMs : 0;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Remove or update of many documents in chunks of documents in _id order, so that
+     *        oplog is written at a rate secondaries keep up with. Between chunks, lag of the
+     *        slowest secondary is read from replSetGetStatus and Throttle adapts chunk size
+     *        and pauses, so that lag stays under a threshold.
+     */
+    namespace ThrottledWrite
+    {
+        /**
+         * @brief Query of documents matching 'filter' in _id index order, starting at 'lastId'
+         *        ({ _id: <id> }, inclusive), all of them if 'lastId' is empty. Index bound $min
+         *        instead of $gt, which would skip _id values of other types than 'lastId'.
+         */
+        mongo::BSONObj remainingQuery(const mongo::BSONObj &filter, const mongo::BSONObj &lastId);
+
+        /**
+         * @brief Documents matching 'filter' with one of 'ids' ({ _id: <id> } each), so that
+         *        chunk is exactly the documents read, whatever types their _id values have
+         */
+        mongo::BSONObj chunkFilter(const mongo::BSONObj &filter, const std::vector<mongo::BSONObj> &ids);
+
+        /**
+         * @brief Optime of primary minus the one of the slowest healthy secondary, -1 if
+         *        there are no secondaries (or no primary) in replSetGetStatus result
+         */
+        long long replicationLagMs(const mongo::BSONObj &status);
+
+        class Throttle
+        {
+        public:
+            static constexpr int MinChunkSize = 10;
+            static constexpr int MaxChunkSize = 10 * 1000;
+            static constexpr int InitialChunkSize = 500;
+            static constexpr int LagPollMs = 1000;      // wait before lag is read again
+            static constexpr int MaxChunkMs = 2000;     // so that pause and stop take effect soon
+
+            /**
+             * @param maxLagMs Threshold of lag, 0 to adapt chunks to time of writing only
+             */
+            explicit Throttle(long long maxLagMs);
+
+            int chunkSize() const { return _chunkSize; }
+
+            /**
+             * @param lagMs Lag after the chunk, see replicationLagMs()
+             * @param chunkMs Time the chunk was written in
+             * @return Milliseconds to wait before lag is read again, 0 to write next chunk
+             */
+            long long afterChunk(long long lagMs, double chunkMs);
+
+            /**
+             * @brief Once lag was over threshold, next chunk waits until it is below half of it
+             * @return As afterChunk()
+             */
+            long long whileWaiting(long long lagMs) const;
+
+        private:
+            long long const _maxLagMs;
+            int _chunkSize;
+        };
+    }
+}
@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+#include "ThrottledWrite.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    mongo::BSONObj member(int state, long long optimeMs, double health = 1)
+    {
+        return BSON("state" << state << "health" << health <<
+                    "optimeDate" << mongo::Date_t::fromMillisSinceEpoch(optimeMs));
+    }
+}
+
+TEST(throttled_write_tests, replication_lag)
+{
+    mongo::BSONObj const status = BSON("members" << BSON_ARRAY(member(2, 7000) << member(1, 10000) <<
+                                                               member(2, 9500) << member(2, 1000, 0)));
+    EXPECT_EQ(3000, ThrottledWrite::replicationLagMs(status));
+
+    // Standalone or primary without secondaries
+    EXPECT_EQ(-1, ThrottledWrite::replicationLagMs(BSON("ok" << 0)));
+    EXPECT_EQ(-1, ThrottledWrite::replicationLagMs(BSON("members" << BSON_ARRAY(member(1, 10000)))));
+}
+
+TEST(throttled_write_tests, queries_of_chunks)
+{
+    mongo::BSONObj const filter = BSON("status" << "old");
+
+    mongo::BSONObj const first = ThrottledWrite::remainingQuery(filter, mongo::BSONObj());
+    EXPECT_EQ(filter.toString(), first.getObjectField("$query").toString());
+    EXPECT_EQ(BSON("_id" << 1).toString(), first.getObjectField("$hint").toString());
+    EXPECT_FALSE(first.hasField("$min"));
+
+    // Index bound keeps _id values of other types than the last one
+    mongo::BSONObj const next = ThrottledWrite::remainingQuery(filter, BSON("_id" << 20));
+    EXPECT_EQ(BSON("_id" << 20).toString(), next.getObjectField("$min").toString());
+    EXPECT_EQ(std::string::npos, next.toString().find("$gt"));
+}
+
+TEST(throttled_write_tests, chunk_of_mixed_id_types)
+{
+    mongo::OID const oid = mongo::OID::gen();
+    std::vector<mongo::BSONObj> const ids = { BSON("_id" << 10), BSON("_id" << 20.5),
+                                              BSON("_id" << "a"), BSON("_id" << oid) };
+    mongo::BSONObj const filter = BSON("status" << "old");
+
+    // Every _id read is listed, range of first and last would match nothing
+    EXPECT_EQ(BSON("$and" << BSON_ARRAY(filter << BSON("_id" << BSON("$in" << BSON_ARRAY(10 << 20.5 << "a" << oid))))).toString(),
+              ThrottledWrite::chunkFilter(filter, ids).toString());
+    EXPECT_EQ(BSON("_id" << BSON("$in" << BSON_ARRAY(10 << 20.5 << "a" << oid))).toString(),
+              ThrottledWrite::chunkFilter(mongo::BSONObj(), ids).toString());
+}
+
+TEST(throttled_write_tests, chunk_size_follows_lag)
+{
+    typedef ThrottledWrite::Throttle Throttle;
+    Throttle throttle(10000);
+    EXPECT_EQ(Throttle::InitialChunkSize, throttle.chunkSize());
+
+    // Grows while lag is low, holds near threshold
+    EXPECT_EQ(0, throttle.afterChunk(100, 50));
+    EXPECT_EQ(750, throttle.chunkSize());
+    EXPECT_EQ(0, throttle.afterChunk(7000, 50));
+    EXPECT_EQ(750, throttle.chunkSize());
+
+    // Over threshold: halves and waits until lag is below half of threshold
+    EXPECT_EQ(Throttle::LagPollMs, throttle.afterChunk(12000, 50));
+    EXPECT_EQ(375, throttle.chunkSize());
+    EXPECT_EQ(Throttle::LagPollMs, throttle.whileWaiting(6000));
+    EXPECT_EQ(0, throttle.whileWaiting(4000));
+
+    // Slow chunks shrink to the time limit, also without secondaries
+    EXPECT_EQ(0, throttle.afterChunk(-1, Throttle::MaxChunkMs * 3));
+    EXPECT_EQ(125, throttle.chunkSize());
+}
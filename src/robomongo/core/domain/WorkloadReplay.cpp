@@ -0,0 +1,246 @@
+#include "robomongo/core/domain/WorkloadReplay.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/shell/bson/json.h"
+
+namespace Robomongo
+{
+    namespace WorkloadReplay
+    {
+        namespace
+        {
+            // Fields of captured command, that belong to connection or cluster it was captured on
+            const char *const ConnectionFields[] = {
+                "lsid", "txnNumber", "autocommit", "startTransaction", "$clusterTime", "$db",
+                "$readPreference", "$queryOptions", "$audit", "$client", "$configServerState",
+                "readConcern", "shardVersion", "databaseVersion"
+            };
+
+            bool isConnectionField(const char *name)
+            {
+                for (const char *const field : ConnectionFields) {
+                    if (std::strcmp(name, field) == 0)
+                        return true;
+                }
+                return false;
+            }
+
+            std::string fieldNames(const mongo::BSONElement &element)
+            {
+                if (element.type() != mongo::Object || element.Obj().isEmpty())
+                    return "{}";
+
+                std::string names;
+                for (mongo::BSONObjIterator it(element.Obj()); it.more(); ) {
+                    names += names.empty() ? "{ " : ", ";
+                    names += it.next().fieldName();
+                }
+                return names + " }";
+            }
+
+            bool hasWriteStage(const mongo::BSONObj &command)
+            {
+                mongo::BSONElement const pipeline = command["pipeline"];
+                if (pipeline.type() != mongo::Array)
+                    return false;
+
+                for (mongo::BSONObjIterator it(pipeline.Obj()); it.more(); ) {
+                    mongo::BSONElement const stage = it.next();
+                    if (stage.type() == mongo::Object &&
+                        (stage.Obj().hasField("$out") || stage.Obj().hasField("$merge")))
+                        return true;
+                }
+                return false;
+            }
+
+            bool fromCommand(const mongo::BSONObj &command, const std::string &ns, const mongo::BSONElement &time,
+                             Operation &operation)
+            {
+                if (command.isEmpty() || command.hasField("$truncated"))
+                    return false;
+
+                std::string const name = command.firstElementFieldName();
+                if (name != "find" && name != "aggregate" && name != "count")
+                    return false;
+                if (name == "aggregate" && hasWriteStage(command))
+                    return false;
+
+                mongo::BSONElement const db = command["$db"];
+                std::string const database = db.type() == mongo::String ? db.str() : ns.substr(0, ns.find('.'));
+                if (database.empty())
+                    return false;
+
+                operation.timeMs = time.type() == mongo::Date ? time.date().toMillisSinceEpoch() : 0;
+                operation.database = database;
+                operation.command = replayCommand(command);
+                operation.shape = shapeOf(database, command);
+                return true;
+            }
+
+            // Structured log writes "+00:00" offsets, which dateFromISOString does not take
+            void normalizeDates(std::string &line)
+            {
+                static const char marker[] = "\"$date\":\"";
+                for (size_t pos = line.find(marker); pos != std::string::npos; pos = line.find(marker, pos)) {
+                    pos += sizeof(marker) - 1;
+                    size_t const end = line.find('"', pos);
+                    if (end == std::string::npos)
+                        return;
+                    if (end - pos > 6 && line[end - 3] == ':' && (line[end - 6] == '+' || line[end - 6] == '-'))
+                        line.erase(end - 3, 1);
+                }
+            }
+        }
+
+        bool fromProfileEntry(const mongo::BSONObj &entry, Operation &operation)
+        {
+            std::string const op = entry["op"].str();
+            if (!op.empty() && op != "query" && op != "command")
+                return false;
+
+            mongo::BSONElement const command = entry["command"];
+            if (command.type() != mongo::Object)
+                return false;
+
+            return fromCommand(command.Obj(), entry["ns"].str(), entry["ts"], operation);
+        }
+
+        bool fromLine(const std::string &line, Operation &operation)
+        {
+            size_t const begin = line.find_first_not_of(" \t\r\n");
+            if (begin == std::string::npos || line[begin] != '{')
+                return false;
+
+            mongo::BSONObj entry;
+            try {
+                std::string normalized = line.substr(begin);
+                normalizeDates(normalized);
+                entry = mongo::Robomongo::fromjson(normalized);
+            }
+            catch (const std::exception &) {
+                return false;
+            }
+
+            mongo::BSONElement const attr = entry["attr"];
+            if (attr.type() != mongo::Object)
+                return fromProfileEntry(entry, operation);
+
+            mongo::BSONObj const attributes = attr.Obj();
+            mongo::BSONElement const command = attributes["command"];
+            if (command.type() != mongo::Object)
+                return false;
+
+            return fromCommand(command.Obj(), attributes["ns"].str(), entry["t"], operation);
+        }
+
+        std::string shapeOf(const std::string &database, const mongo::BSONObj &command)
+        {
+            mongo::BSONElement const first = command.firstElement();
+            std::string const name = first.fieldName();
+            std::string shape = name + " " + database;
+            if (first.type() == mongo::String)
+                shape += "." + first.str();
+
+            if (name == "find") {
+                shape += " " + fieldNames(command["filter"]);
+                if (command.hasField("sort"))
+                    shape += " sort " + fieldNames(command["sort"]);
+            } else if (name == "count") {
+                shape += " " + fieldNames(command["query"]);
+            } else if (command["pipeline"].type() == mongo::Array) {
+                std::string stages;
+                for (mongo::BSONObjIterator it(command["pipeline"].Obj()); it.more(); ) {
+                    mongo::BSONElement const stage = it.next();
+                    if (stage.type() != mongo::Object || stage.Obj().isEmpty())
+                        continue;
+
+                    mongo::BSONElement const spec = stage.Obj().firstElement();
+                    stages += stages.empty() ? "" : ", ";
+                    stages += spec.fieldName();
+                    if (std::strcmp(spec.fieldName(), "$match") == 0 || std::strcmp(spec.fieldName(), "$sort") == 0)
+                        stages += " " + fieldNames(spec);
+                }
+                shape += " [" + stages + "]";
+            }
+            return shape;
+        }
+
+        mongo::BSONObj replayCommand(const mongo::BSONObj &command)
+        {
+            mongo::BSONObjBuilder builder;
+            for (mongo::BSONObjIterator it(command); it.more(); ) {
+                mongo::BSONElement const element = it.next();
+                if (!isConnectionField(element.fieldName()))
+                    builder.append(element);
+            }
+            return builder.obj();
+        }
+
+        void Result::add(const Operation &operation, long long us, const std::string &error)
+        {
+            ShapeResult &shape = shapes[operation.shape];
+            ++operations;
+            if (error.empty()) {
+                shape.latency.record(us);
+                return;
+            }
+
+            ++shape.errors;
+            ++errors;
+            if (firstError.empty())
+                firstError = error;
+        }
+
+        void Result::merge(const Result &other)
+        {
+            for (auto const &shape : other.shapes) {
+                ShapeResult &merged = shapes[shape.first];
+                merged.errors += shape.second.errors;
+                merged.latency.merge(shape.second.latency);
+            }
+            operations += other.operations;
+            errors += other.errors;
+            skipped += other.skipped;
+            elapsedMs = std::max(elapsedMs, other.elapsedMs);
+            if (firstError.empty())
+                firstError = other.firstError;
+        }
+
+        std::vector<ShapeComparison> compare(const Result &baseline, const Result &current)
+        {
+            std::vector<ShapeComparison> comparisons;
+            for (auto const &shape : current.shapes) {
+                auto const before = baseline.shapes.find(shape.first);
+                comparisons.push_back(ShapeComparison{ shape.first,
+                    before != baseline.shapes.end() ? &before->second : nullptr, &shape.second });
+            }
+            for (auto const &shape : baseline.shapes) {
+                if (current.shapes.count(shape.first) == 0)
+                    comparisons.push_back(ShapeComparison{ shape.first, &shape.second, nullptr });
+            }
+
+            auto const totalUs = [](const ShapeResult *result) {
+                return result ? result->latency.totalUs() : -1;
+            };
+            std::stable_sort(comparisons.begin(), comparisons.end(),
+                [&totalUs](const ShapeComparison &left, const ShapeComparison &right) {
+                    if (totalUs(left.current) != totalUs(right.current))
+                        return totalUs(left.current) > totalUs(right.current);
+                    return totalUs(left.baseline) > totalUs(right.baseline);
+                });
+            return comparisons;
+        }
+
+        double change(long long baselineUs, long long currentUs)
+        {
+            if (baselineUs <= 0)
+                return 0;
+            return static_cast<double>(currentUs - baselineUs) / baselineUs;
+        }
+    }
+}
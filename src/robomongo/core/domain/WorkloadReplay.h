@@ -0,0 +1,91 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/utils/LatencyHistogram.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Replay of captured read workload: find, aggregate and count commands taken from
+     *        system.profile entries (or their JSON export) and structured log lines (4.4+) are
+     *        run again with original spacing in time, and their latencies are grouped by
+     *        query shape, so that two runs (before and after index change) can be compared.
+     */
+    namespace WorkloadReplay
+    {
+        struct Operation
+        {
+            long long timeMs = 0;       // when it was captured, since epoch
+            std::string database;
+            mongo::BSONObj command;     // without session and cluster time fields
+            std::string shape;
+        };
+
+        /**
+         * @return False, if entry is not a replayable find, aggregate or count (i.e. getMore,
+         *         writes, aggregation with $out or $merge, or truncated command)
+         */
+        bool fromProfileEntry(const mongo::BSONObj &entry, Operation &operation);
+
+        /**
+         * @param line JSON line of structured log (4.4+) or of exported system.profile
+         */
+        bool fromLine(const std::string &line, Operation &operation);
+
+        /**
+         * @brief Command name, namespace and field names of filter (stage names of pipeline),
+         *        without values, e.g. "find db.coll { a, b } sort { c }"
+         */
+        std::string shapeOf(const std::string &database, const mongo::BSONObj &command);
+
+        /**
+         * @brief Command without fields of session, transaction, cluster time and read
+         *        concern, which belong to the connection and cluster it was captured on
+         */
+        mongo::BSONObj replayCommand(const mongo::BSONObj &command);
+
+        struct ShapeResult
+        {
+            long long errors = 0;
+            LatencyHistogram latency;   // of operations that succeeded
+        };
+
+        struct Result
+        {
+            std::map<std::string, ShapeResult> shapes;
+            long long operations = 0;   // replayed, including failed ones
+            long long errors = 0;
+            long long skipped = 0;      // captured entries that are not replayable
+            long long elapsedMs = 0;
+            double speed = 1;           // 0 is as fast as possible
+            std::string firstError;
+
+            void add(const Operation &operation, long long us, const std::string &error);
+            void merge(const Result &other);
+        };
+
+        struct ShapeComparison
+        {
+            std::string shape;
+            ShapeResult const *baseline = nullptr;      // null, if shape is not in baseline
+            ShapeResult const *current = nullptr;       // null, if shape is not in current
+        };
+
+        /**
+         * @brief Shapes of both runs, the ones with the largest total time of current run
+         *        first. Pointers refer to results, that have to outlive the comparison.
+         */
+        std::vector<ShapeComparison> compare(const Result &baseline, const Result &current);
+
+        /**
+         * @brief Relative change of latency, e.g. 0.5 if 'current' is 50% slower, 0 if
+         *        'baseline' is 0
+         */
+        double change(long long baselineUs, long long currentUs);
+    }
+}
@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+#include "WorkloadReplay.h"
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+TEST(workload_replay_tests, profile_entry)
+{
+    mongo::BSONObj const entry = BSON("op" << "query" << "ns" << "shop.orders" <<
+        "command" << BSON("find" << "orders" << "filter" << BSON("status" << "new" << "total" << BSON("$gt" << 10)) <<
+                          "sort" << BSON("created" << -1) << "lsid" << BSON("id" << 1) << "$db" << "shop") <<
+        "ts" << mongo::Date_t::fromMillisSinceEpoch(1000));
+
+    WorkloadReplay::Operation operation;
+    ASSERT_TRUE(WorkloadReplay::fromProfileEntry(entry, operation));
+    EXPECT_EQ(1000, operation.timeMs);
+    EXPECT_EQ("shop", operation.database);
+    EXPECT_EQ("find shop.orders { status, total } sort { created }", operation.shape);
+    EXPECT_FALSE(operation.command.hasField("lsid"));
+    EXPECT_FALSE(operation.command.hasField("$db"));
+    EXPECT_TRUE(operation.command.hasField("filter"));
+
+    // Writes, aggregations with $out and truncated commands are not replayed
+    EXPECT_FALSE(WorkloadReplay::fromProfileEntry(BSON("op" << "update" << "ns" << "shop.orders" <<
+        "command" << BSON("q" << BSON("a" << 1) << "u" << BSON("a" << 2))), operation));
+    EXPECT_FALSE(WorkloadReplay::fromProfileEntry(BSON("op" << "command" << "ns" << "shop.orders" <<
+        "command" << BSON("aggregate" << "orders" << "pipeline" << BSON_ARRAY(BSON("$out" << "copy")))), operation));
+    EXPECT_FALSE(WorkloadReplay::fromProfileEntry(BSON("op" << "query" << "ns" << "shop.orders" <<
+        "command" << BSON("$truncated" << "{ find: ..." << "comment" << "x")), operation));
+}
+
+TEST(workload_replay_tests, log_line)
+{
+    std::string const line = "{\"t\":{\"$date\":\"2020-05-20T19:18:40.604+00:00\"},\"s\":\"I\",\"c\":\"COMMAND\","
+        "\"id\":51803,\"msg\":\"Slow query\",\"attr\":{\"type\":\"command\",\"ns\":\"shop.orders\","
+        "\"command\":{\"aggregate\":\"orders\",\"pipeline\":[{\"$match\":{\"status\":\"new\"}},"
+        "{\"$group\":{\"_id\":\"$customer\"}}],\"cursor\":{},\"$db\":\"shop\"},\"durationMillis\":120}}";
+
+    WorkloadReplay::Operation operation;
+    ASSERT_TRUE(WorkloadReplay::fromLine(line, operation));
+    EXPECT_EQ(1590002320604LL, operation.timeMs);
+    EXPECT_EQ("aggregate shop.orders [$match { status }, $group]", operation.shape);
+    EXPECT_TRUE(operation.command.hasField("cursor"));
+
+    EXPECT_FALSE(WorkloadReplay::fromLine("", operation));
+    EXPECT_FALSE(WorkloadReplay::fromLine("not json", operation));
+}
+
+TEST(workload_replay_tests, compare_runs)
+{
+    WorkloadReplay::Operation fast, slow;
+    fast.shape = "count db.c { a }";
+    slow.shape = "find db.c { b }";
+
+    WorkloadReplay::Result baseline;
+    baseline.add(fast, 100, "");
+    baseline.add(slow, 10000, "");
+
+    WorkloadReplay::Result current;
+    current.add(slow, 1000, "");
+    current.add(slow, 0, "timeout");
+
+    std::vector<WorkloadReplay::ShapeComparison> const comparisons = WorkloadReplay::compare(baseline, current);
+    ASSERT_EQ(2u, comparisons.size());
+    EXPECT_EQ(slow.shape, comparisons[0].shape);
+    ASSERT_TRUE(comparisons[0].baseline && comparisons[0].current);
+    EXPECT_EQ(1, comparisons[0].current->errors);
+    EXPECT_EQ(fast.shape, comparisons[1].shape);
+    EXPECT_EQ(nullptr, comparisons[1].current);
+
+    EXPECT_EQ(2, current.operations);
+    EXPECT_EQ("timeout", current.firstError);
+    EXPECT_DOUBLE_EQ(-0.9, WorkloadReplay::change(10000, 1000));
+    EXPECT_DOUBLE_EQ(0, WorkloadReplay::change(0, 1000));
+}
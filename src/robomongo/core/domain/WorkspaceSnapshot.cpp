@@ -0,0 +1,244 @@
+#include "robomongo/core/domain/WorkspaceSnapshot.h"
+
+#include <cstring>
+#include <set>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/domain/BsonSegmentFile.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace
+{
+    QString const SnapshotDirName = "workspace";
+    QString const SnapshotFileName = "tabs.bin";
+    int const FormatVersion = 1;
+
+    /*
+     * { v: 1, tabs: [ { connection, title, db, script, file,
+     *                   parts: [ { type, response, statement, elapsedMs, pageSkip, pageBatchSize, results,
+     *                              query: { server, ns, query, fields, limit, skip, batchSize, options,
+     *                                       special, maxTimeMs },
+     *                              aggr: { collection, db, skip, batchSize, pipeline, options, resultIndex,
+     *                                      maxTimeMs } }, ... ] }, ... ] }
+     *
+     * 'query' and 'aggr' are present only for valid infos.
+     */
+
+    mongo::BSONObj queryToBSON(const Robomongo::MongoQueryInfo &info)
+    {
+        mongo::BSONObjBuilder builder;
+        builder.append("server", info._info._serverAddress);
+        builder.append("ns", info._info._ns.toString());
+        builder.append("query", info._query);
+        builder.append("fields", info._fields);
+        builder.append("limit", info._limit);
+        builder.append("skip", info._skip);
+        builder.append("batchSize", info._batchSize);
+        builder.append("options", info._options);
+        builder.append("special", info._special);
+        builder.append("maxTimeMs", info._maxTimeMs);
+        return builder.obj();
+    }
+
+    Robomongo::MongoQueryInfo queryFromBSON(const mongo::BSONObj &obj)
+    {
+        Robomongo::MongoNamespace const ns(obj.getStringField("ns"));
+        Robomongo::MongoQueryInfo info(
+            Robomongo::CollectionInfo(obj.getStringField("server"), ns.databaseName(), ns.collectionName()),
+            obj.getObjectField("query").getOwned(), obj.getObjectField("fields").getOwned(),
+            obj.getIntField("limit"), obj.getIntField("skip"), obj.getIntField("batchSize"),
+            obj.getIntField("options"), obj.getBoolField("special"));
+        info._maxTimeMs = obj.getIntField("maxTimeMs");
+        return info;
+    }
+
+    mongo::BSONObj aggrToBSON(const Robomongo::AggrInfo &info)
+    {
+        mongo::BSONObjBuilder builder;
+        builder.append("collection", info.collectionName);
+        builder.append("db", info.dbName);
+        builder.append("skip", info.skip);
+        builder.append("batchSize", info.batchSize);
+        builder.appendArray("pipeline", info.pipeline);
+        builder.append("options", info.options);
+        builder.append("resultIndex", info.resultIndex);
+        builder.append("maxTimeMs", info.maxTimeMs);
+        return builder.obj();
+    }
+
+    Robomongo::AggrInfo aggrFromBSON(const mongo::BSONObj &obj)
+    {
+        Robomongo::AggrInfo info(obj.getStringField("collection"), obj.getIntField("skip"),
+                                 obj.getIntField("batchSize"), obj.getObjectField("pipeline").getOwned(),
+                                 obj.getObjectField("options").getOwned(), obj.getIntField("resultIndex"),
+                                 obj.getStringField("db"));
+        info.maxTimeMs = obj.getIntField("maxTimeMs");
+        return info;
+    }
+
+    QString snapshotFilePath()
+    {
+        return Robomongo::WorkspaceSnapshot::directory() + SnapshotFileName;
+    }
+}
+
+namespace Robomongo
+{
+    QString WorkspaceSnapshot::directory()
+    {
+        return CacheDir + SnapshotDirName + "/";
+    }
+
+    void WorkspaceSnapshot::save(const std::vector<Tab> &tabs)
+    {
+        QDir const dir(directory());
+        if (!dir.exists())
+            QDir().mkpath(dir.path());
+
+        // Half written snapshot would be worse than the previous one
+        QSaveFile file(snapshotFilePath());
+        if (!file.open(QIODevice::WriteOnly))
+            return;
+        file.write(serialize(tabs));
+        if (!file.commit())
+            return;
+
+        std::set<QString> used;
+        for (auto const &tab : tabs) {
+            for (auto const &part : tab.parts)
+                used.insert(part.resultFile);
+        }
+        for (QString const &name : dir.entryList(QStringList() << "*.bson", QDir::Files)) {
+            if (used.find(name) == used.end())
+                QFile::remove(dir.filePath(name));
+        }
+    }
+
+    std::vector<WorkspaceSnapshot::Tab> WorkspaceSnapshot::load()
+    {
+        std::vector<Tab> tabs;
+        QFile file(snapshotFilePath());
+        if (file.open(QIODevice::ReadOnly))
+            deserialize(file.readAll(), tabs);
+        return tabs;
+    }
+
+    bool WorkspaceSnapshot::writeResults(const QString &name, const std::vector<MongoDocumentPtr> &documents)
+    {
+        QSaveFile file(directory() + name);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        for (MongoDocumentPtr const &document : documents) {
+            mongo::BSONObj const &obj = document->bsonObj();
+            if (file.write(obj.objdata(), obj.objsize()) != obj.objsize()) {
+                file.cancelWriting();
+                return false;
+            }
+        }
+        return file.commit();
+    }
+
+    bool WorkspaceSnapshot::readResults(const QString &name, std::vector<MongoDocumentPtr> &documents)
+    {
+        if (name.isEmpty())
+            return false;
+
+        BsonSegmentFilePtr const storage = BsonSegmentFile::open(directory() + name);
+        if (!storage)
+            return false;
+
+        documents.clear();
+        documents.reserve(storage->count());
+        for (size_t i = 0; i < storage->count(); ++i)
+            documents.push_back(MongoDocumentPtr(new MongoDocument(storage->document(i), storage)));
+        return true;
+    }
+
+    QByteArray WorkspaceSnapshot::serialize(const std::vector<Tab> &tabs)
+    {
+        mongo::BSONArrayBuilder tabsBuilder;
+        for (auto const &tab : tabs) {
+            mongo::BSONArrayBuilder parts;
+            for (auto const &part : tab.parts) {
+                mongo::BSONObjBuilder builder;
+                builder.append("type", part.type);
+                builder.append("response", part.response);
+                builder.append("statement", part.statement);
+                builder.append("elapsedMs", part.elapsedMs);
+                builder.append("pageSkip", part.pageSkip);
+                builder.append("pageBatchSize", part.pageBatchSize);
+                builder.append("results", QtUtils::toStdString(part.resultFile));
+                if (part.queryInfo._info.isValid())
+                    builder.append("query", queryToBSON(part.queryInfo));
+                if (part.aggrInfo.isValid)
+                    builder.append("aggr", aggrToBSON(part.aggrInfo));
+                parts.append(builder.obj());
+            }
+
+            tabsBuilder.append(BSON("connection" << QtUtils::toStdString(tab.connection) <<
+                                    "title" << tab.title << "db" << tab.database << "script" << tab.script <<
+                                    "file" << QtUtils::toStdString(tab.filePath) << "parts" << parts.arr()));
+        }
+
+        mongo::BSONObj const obj = BSON("v" << FormatVersion << "tabs" << tabsBuilder.arr());
+        return qCompress(QByteArray(obj.objdata(), obj.objsize()));
+    }
+
+    bool WorkspaceSnapshot::deserialize(const QByteArray &data, std::vector<Tab> &tabs)
+    {
+        QByteArray const raw = qUncompress(data);
+        if (raw.size() < 5)
+            return false;
+
+        int size = 0;
+        memcpy(&size, raw.constData(), sizeof(size));   // BSON is little endian, as are supported CPUs
+        if (size != raw.size())
+            return false;
+
+        try {
+            mongo::BSONObj const obj(raw.constData());
+            if (obj.getIntField("v") != FormatVersion)
+                return false;
+
+            std::vector<Tab> result;
+            for (auto const &tabElem : obj.getObjectField("tabs")) {
+                mongo::BSONObj const tabObj = tabElem.Obj();
+                Tab tab;
+                tab.connection = QtUtils::toQString(tabObj.getStringField("connection"));
+                tab.title = tabObj.getStringField("title");
+                tab.database = tabObj.getStringField("db");
+                tab.script = tabObj.getStringField("script");
+                tab.filePath = QtUtils::toQString(tabObj.getStringField("file"));
+
+                for (auto const &partElem : tabObj.getObjectField("parts")) {
+                    mongo::BSONObj const partObj = partElem.Obj();
+                    Part part;
+                    part.type = partObj.getStringField("type");
+                    part.response = partObj.getStringField("response");
+                    part.statement = partObj.getStringField("statement");
+                    part.elapsedMs = partObj["elapsedMs"].safeNumberLong();
+                    part.pageSkip = partObj.getIntField("pageSkip");
+                    part.pageBatchSize = partObj.getIntField("pageBatchSize");
+                    part.resultFile = QtUtils::toQString(partObj.getStringField("results"));
+                    if (partObj.hasField("query"))
+                        part.queryInfo = queryFromBSON(partObj.getObjectField("query"));
+                    if (partObj.hasField("aggr"))
+                        part.aggrInfo = aggrFromBSON(partObj.getObjectField("aggr"));
+                    tab.parts.push_back(part);
+                }
+                result.push_back(tab);
+            }
+            tabs.swap(result);
+            return true;
+        }
+        catch (const std::exception &) {
+            return false;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <QByteArray>
+#include <QString>
+
+#include "robomongo/core/domain/MongoQueryInfo.h"
+#include "robomongo/core/domain/MongoAggregateInfo.h"
+#include "robomongo/core/domain/MongoDocument.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Query tabs open at exit, restored when their connections are opened again.
+     *        Scripts, queries of result parts and their current pages are kept in one
+     *        compressed file of cache directory. Documents of current pages are optionally
+     *        written as plain BSON files next to it, so that restored parts map them from
+     *        disk (see BsonSegmentFile::open()) instead of running queries again.
+     */
+    class WorkspaceSnapshot
+    {
+    public:
+        struct Part
+        {
+            std::string type;           // of documents, empty for text output
+            std::string response;       // text output
+            std::string statement;
+            long long elapsedMs = 0;
+            MongoQueryInfo queryInfo;
+            AggrInfo aggrInfo;
+            int pageSkip = 0;           // current page, as paged by user
+            int pageBatchSize = 0;
+            QString resultFile;         // name in directory(), empty if documents were not written
+        };
+
+        struct Tab
+        {
+            QString connection;         // uuid of ConnectionSettings
+            std::string title;
+            std::string database;
+            std::string script;         // text of editor, saved or not
+            QString filePath;
+            std::vector<Part> parts;
+        };
+
+        static QString directory();
+
+        /**
+         * @brief Replaces snapshot, result files which it does not refer to are removed
+         *        (ones still mapped by restored parts are left for the next save)
+         */
+        static void save(const std::vector<Tab> &tabs);
+
+        // Empty, if there is no snapshot or it cannot be read
+        static std::vector<Tab> load();
+
+        // Writes documents one after another into result file 'name' of directory()
+        static bool writeResults(const QString &name, const std::vector<MongoDocumentPtr> &documents);
+
+        /**
+         * @brief Documents of result file 'name', pointing into the mapped file
+         * @return false, if file is missing or damaged
+         */
+        static bool readResults(const QString &name, std::vector<MongoDocumentPtr> &documents);
+
+        // qCompress()ed BSON, see .cpp for layout
+        static QByteArray serialize(const std::vector<Tab> &tabs);
+
+        /**
+         * @return false, if data is not a snapshot of this format
+         */
+        static bool deserialize(const QByteArray &data, std::vector<Tab> &tabs);
+    };
+}
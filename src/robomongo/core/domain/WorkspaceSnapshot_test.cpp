@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+#include "WorkspaceSnapshot.h"
+
+#include <QTemporaryFile>
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "BsonSegmentFile.h"
+
+using namespace Robomongo;
+
+TEST(workspace_snapshot_tests, serialize_round_trip)
+{
+    WorkspaceSnapshot::Tab tab;
+    tab.connection = "0b6f6a1e-uuid";
+    tab.title = "orders";
+    tab.database = "shop";
+    tab.script = "db.orders.find({ status: 'new' })\ndb.stats()";
+
+    WorkspaceSnapshot::Part query;
+    query.type = "Document";
+    query.statement = "db.orders.find({ status: 'new' })";
+    query.elapsedMs = 42;
+    query.queryInfo = MongoQueryInfo(CollectionInfo("localhost:27017", "shop", "orders"),
+                                     BSON("status" << "new"), BSON("_id" << 0), 0, 0, 50, 0, false);
+    query.queryInfo._maxTimeMs = 5000;
+    query.pageSkip = 100;
+    query.pageBatchSize = 50;
+    query.resultFile = "1-0-0.bson";
+
+    WorkspaceSnapshot::Part aggregation;
+    aggregation.type = "Document";
+    aggregation.aggrInfo = AggrInfo("orders", 0, 50, BSON_ARRAY(BSON("$limit" << 5)), BSON("allowDiskUse" << true),
+                                    1, "shop");
+
+    WorkspaceSnapshot::Part text;
+    text.response = "{ \"ok\" : 1 }";
+    tab.parts = { query, aggregation, text };
+
+    WorkspaceSnapshot::Tab empty;
+    empty.connection = "other";
+
+    std::vector<WorkspaceSnapshot::Tab> loaded;
+    ASSERT_TRUE(WorkspaceSnapshot::deserialize(WorkspaceSnapshot::serialize({ tab, empty }), loaded));
+    ASSERT_EQ(2u, loaded.size());
+    EXPECT_TRUE(loaded[1].parts.empty());
+
+    WorkspaceSnapshot::Tab const &restored = loaded[0];
+    EXPECT_EQ(tab.connection, restored.connection);
+    EXPECT_EQ(tab.script, restored.script);
+    EXPECT_EQ("shop", restored.database);
+    ASSERT_EQ(3u, restored.parts.size());
+
+    WorkspaceSnapshot::Part const &restoredQuery = restored.parts[0];
+    EXPECT_TRUE(restoredQuery.queryInfo._info.isValid());
+    EXPECT_EQ("shop.orders", restoredQuery.queryInfo._info._ns.toString());
+    EXPECT_EQ("new", std::string(restoredQuery.queryInfo._query.getStringField("status")));
+    EXPECT_TRUE(restoredQuery.queryInfo._fields.binaryEqual(BSON("_id" << 0)));
+    EXPECT_EQ(50, restoredQuery.queryInfo._batchSize);
+    EXPECT_EQ(5000, restoredQuery.queryInfo._maxTimeMs);
+    EXPECT_EQ(100, restoredQuery.pageSkip);
+    EXPECT_EQ(42, restoredQuery.elapsedMs);
+    EXPECT_EQ(QString("1-0-0.bson"), restoredQuery.resultFile);
+    EXPECT_FALSE(restoredQuery.aggrInfo.isValid);
+
+    AggrInfo const &restoredAggr = restored.parts[1].aggrInfo;
+    EXPECT_TRUE(restoredAggr.isValid);
+    EXPECT_FALSE(restored.parts[1].queryInfo._info.isValid());
+    EXPECT_EQ("shop", restoredAggr.dbName);
+    EXPECT_EQ(1, restoredAggr.resultIndex);
+    EXPECT_EQ(5, restoredAggr.pipeline["0"].Obj()["$limit"].numberInt());
+    EXPECT_TRUE(restoredAggr.options.getBoolField("allowDiskUse"));
+
+    EXPECT_EQ(text.response, restored.parts[2].response);
+    EXPECT_TRUE(restored.parts[2].type.empty());
+}
+
+TEST(workspace_snapshot_tests, deserialize_rejects_garbage)
+{
+    std::vector<WorkspaceSnapshot::Tab> tabs(1);
+    EXPECT_FALSE(WorkspaceSnapshot::deserialize(QByteArray(), tabs));
+    EXPECT_FALSE(WorkspaceSnapshot::deserialize(qCompress(QByteArray("not bson")), tabs));
+    EXPECT_EQ(1u, tabs.size());
+}
+
+TEST(workspace_snapshot_tests, result_file_is_mapped)
+{
+    QTemporaryFile file;
+    ASSERT_TRUE(file.open());
+    std::vector<mongo::BSONObj> const documents = { BSON("_id" << 1 << "name" << "first"), BSON("_id" << 2) };
+    for (auto const &obj : documents)
+        file.write(obj.objdata(), obj.objsize());
+    file.flush();
+
+    BsonSegmentFilePtr const mapped = BsonSegmentFile::open(file.fileName());
+    ASSERT_TRUE(static_cast<bool>(mapped));
+    ASSERT_EQ(2u, mapped->count());
+    EXPECT_TRUE(mapped->document(0).binaryEqual(documents[0]));
+    EXPECT_TRUE(mapped->document(1).binaryEqual(documents[1]));
+
+    // Read-only, documents are not appended to restored results
+    EXPECT_FALSE(mapped->append(documents.begin(), documents.end()));
+    EXPECT_EQ(2u, mapped->count());
+
+    // Truncated document
+    file.write(documents[0].objdata(), 3);
+    file.flush();
+    EXPECT_FALSE(static_cast<bool>(BsonSegmentFile::open(file.fileName())));
+}
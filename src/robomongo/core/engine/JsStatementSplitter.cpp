@@ -0,0 +1,352 @@
+#include "robomongo/core/engine/JsStatementSplitter.h"
+
+#include <cctype>
+#include <cstring>
+#include <unordered_set>
+
+namespace
+{
+    bool isIdentifierChar(char c)
+    {
+        unsigned char const u = static_cast<unsigned char>(c);
+        return isalnum(u) || c == '_' || c == '$' || u >= 0x80;
+    }
+
+    bool isOneOf(char c, const char *chars)
+    {
+        return c != 0 && strchr(chars, c) != NULL;
+    }
+
+    // Keywords after which '/' starts regular expression
+    bool isRegexPrefixKeyword(const std::string &word)
+    {
+        static const std::unordered_set<std::string> keywords {
+            "return", "typeof", "instanceof", "in", "of", "new", "delete", "void", "throw",
+            "case", "do", "else", "yield", "await"
+        };
+        return keywords.count(word) > 0;
+    }
+
+    // Keywords that can not end statement, so that line break after them does not end it too
+    bool isContinuationKeyword(const std::string &word)
+    {
+        static const std::unordered_set<std::string> keywords {
+            "typeof", "instanceof", "in", "of", "new", "delete", "void", "var", "let", "const"
+        };
+        return keywords.count(word) > 0;
+    }
+
+    // Statements which have body after header in parentheses, i.e. 'if (a) b()'
+    bool isControlKeyword(const std::string &word)
+    {
+        static const std::unordered_set<std::string> keywords {
+            "if", "for", "while", "with", "else", "do", "function"
+        };
+        return keywords.count(word) > 0;
+    }
+
+    enum class LineBreak { EndsStatement, ContinuesStatement, Ambiguous };
+
+    class Scanner
+    {
+    public:
+        explicit Scanner(const std::string &script) : _s(script), _n(script.size()) {}
+
+        bool run(Robomongo::JsStatementSplitter::Ranges &ranges)
+        {
+            size_t i = 0;
+            while (i < _n) {
+                char const c = _s[i];
+
+                if (c == '\n' || c == '\r') {
+                    _lineBreak = true;
+                    ++i;
+                    continue;
+                }
+
+                if (c == ' ' || c == '\t' || c == '\f' || c == '\v') {
+                    ++i;
+                    continue;
+                }
+
+                if (c == '/' && i + 1 < _n && _s[i + 1] == '/') {
+                    i = _s.find('\n', i);
+                    if (i == std::string::npos)
+                        i = _n;
+                    continue;
+                }
+
+                if (c == '/' && i + 1 < _n && _s[i + 1] == '*') {
+                    size_t const close = _s.find("*/", i + 2);
+                    if (close == std::string::npos)
+                        return false;
+                    if (_s.find_first_of("\r\n", i) < close)
+                        _lineBreak = true;
+                    i = close + 2;
+                    continue;
+                }
+
+                // Start of next token
+                if (_lineBreak && _start != std::string::npos && _brackets.empty()) {
+                    switch (lineBreakAt(i)) {
+                        case LineBreak::EndsStatement: finish(ranges); break;
+                        case LineBreak::Ambiguous: return false;
+                        default: break;
+                    }
+                }
+                _lineBreak = false;
+
+                if (_start == std::string::npos)
+                    _start = i;
+
+                if (!token(i, ranges))
+                    return false;
+            }
+
+            if (!_brackets.empty())
+                return false;
+
+            finish(ranges);
+            return true;
+        }
+
+    private:
+        // Scans token at 'i' and moves 'i' after it
+        bool token(size_t &i, Robomongo::JsStatementSplitter::Ranges &ranges)
+        {
+            char const c = _s[i];
+
+            if (isIdentifierChar(c)) {
+                size_t const from = i;
+                while (i < _n && isIdentifierChar(_s[i]))
+                    ++i;
+                std::string const word = _s.substr(from, i - from);
+                if (from == _start)
+                    _firstWord = word;
+                setLast(i, word.back(), word);
+                return true;
+            }
+
+            if (c == '\'' || c == '"') {
+                if (!skipString(i))
+                    return false;
+                setLast(i, c);
+                return true;
+            }
+
+            if (c == '`') {
+                ++i;
+                if (!skipTemplate(i))
+                    return false;
+                return true;
+            }
+
+            // Regular expression ends as literal (like string), not as trailing '/' operator
+            if (c == '/' && isRegexAllowed(i)) {
+                if (!skipRegex(i))
+                    return false;
+                setLast(i, '"');
+                return true;
+            }
+
+            if (c == '(' || c == '[' || c == '{') {
+                _brackets.push_back(c);
+                ++i;
+                setLast(i, c);
+                return true;
+            }
+
+            if (c == ')' || c == ']' || c == '}') {
+                if (_brackets.empty())
+                    return false;
+
+                char const open = _brackets.back();
+                _brackets.pop_back();
+                ++i;
+
+                // End of ${...} expression, continue with the rest of template literal
+                if (open == '$' && c == '}')
+                    return skipTemplate(i);
+
+                if ((c == ')' && open != '(') || (c == ']' && open != '[') || (c == '}' && open != '{'))
+                    return false;
+
+                setLast(i, c);
+                return true;
+            }
+
+            ++i;
+            setLast(i, c);
+
+            if (c == ';' && _brackets.empty())
+                finish(ranges);
+
+            return true;
+        }
+
+        LineBreak lineBreakAt(size_t next) const
+        {
+            char const c = _s[next];
+
+            // Operator at the end of line, i.e. "a = \n b" (but not postfix "a++")
+            bool const isPostfix = (_last == '+' || _last == '-') && _end >= 2 && _s[_end - 2] == _last;
+            if (!_lastIsWord && !isPostfix && isOneOf(_last, ".,=+-*/%<>&|^!~?:"))
+                return LineBreak::ContinuesStatement;
+
+            if (_lastIsWord && isContinuationKeyword(_lastWord))
+                return LineBreak::ContinuesStatement;
+
+            // Chained calls and operators on the next line, i.e. "db.coll.find() \n .sort()"
+            if (isOneOf(c, ".,?:=*%<>&|^"))
+                return LineBreak::ContinuesStatement;
+
+            // Could continue previous statement as call, index, template or operator
+            if (isOneOf(c, "([`+-/"))
+                return LineBreak::Ambiguous;
+
+            if (isIdentifierChar(c)) {
+                size_t till = next;
+                while (till < _n && isIdentifierChar(_s[till]))
+                    ++till;
+                std::string const word = _s.substr(next, till - next);
+                if (word == "else" || word == "catch" || word == "finally")
+                    return LineBreak::ContinuesStatement;
+                if (word == "while" && _firstWord == "do")
+                    return LineBreak::ContinuesStatement;
+            }
+
+            // Header of statement without body yet, or body without braces, i.e. "if (a) b()"
+            if (isControlKeyword(_firstWord) && (_last == ')' || (_lastIsWord && isControlKeyword(_lastWord))))
+                return LineBreak::Ambiguous;
+
+            return LineBreak::EndsStatement;
+        }
+
+        bool isRegexAllowed(size_t i) const
+        {
+            if (i == _start)
+                return true;
+
+            if (_lastIsWord)
+                return isRegexPrefixKeyword(_lastWord);
+
+            return isOneOf(_last, "(,=:[!&|?{};+-*%<>~^");
+        }
+
+        bool skipString(size_t &i) const
+        {
+            char const quote = _s[i++];
+            while (i < _n) {
+                char const c = _s[i];
+                if (c == '\\') {
+                    i += 2;
+                    continue;
+                }
+                if (c == '\n' || c == '\r')
+                    return false;
+                ++i;
+                if (c == quote)
+                    return true;
+            }
+            return false;
+        }
+
+        // Skips template literal from 'i' (after opening backtick or closing brace of ${...})
+        bool skipTemplate(size_t &i)
+        {
+            while (i < _n) {
+                char const c = _s[i];
+                if (c == '\\') {
+                    i += 2;
+                    continue;
+                }
+                if (c == '`') {
+                    ++i;
+                    setLast(i, c);
+                    return true;
+                }
+                if (c == '$' && i + 1 < _n && _s[i + 1] == '{') {
+                    i += 2;
+                    _brackets.push_back('$');
+                    setLast(i, '{');
+                    return true;
+                }
+                ++i;
+            }
+            return false;
+        }
+
+        bool skipRegex(size_t &i) const
+        {
+            bool inClass = false;
+            ++i;
+            while (i < _n) {
+                char const c = _s[i];
+                if (c == '\n' || c == '\r')
+                    return false;
+                if (c == '\\') {
+                    i += 2;
+                    continue;
+                }
+                ++i;
+                if (c == '[')
+                    inClass = true;
+                else if (c == ']')
+                    inClass = false;
+                else if (c == '/' && !inClass) {
+                    while (i < _n && isIdentifierChar(_s[i]))  // flags
+                        ++i;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void setLast(size_t end, char last, const std::string &word = std::string())
+        {
+            _end = end;
+            _last = last;
+            _lastIsWord = !word.empty();
+            _lastWord = word;
+        }
+
+        void finish(Robomongo::JsStatementSplitter::Ranges &ranges)
+        {
+            // Empty statements (";") have nothing to execute
+            if (_start != std::string::npos && !(_end == _start + 1 && _s[_start] == ';'))
+                ranges.push_back(std::make_pair(_start, _end));
+
+            _start = std::string::npos;
+            _firstWord.clear();
+            setLast(_end, 0);
+        }
+
+        const std::string &_s;
+        size_t const _n;
+
+        std::vector<char> _brackets;        // '(', '[', '{' and '$' for ${ of template literal
+        size_t _start = std::string::npos;  // start of current statement
+        size_t _end = 0;                    // end of last token
+        std::string _firstWord;             // first word of current statement
+        std::string _lastWord;              // last token, if it is identifier or keyword
+        char _last = 0;                     // last char of last token
+        bool _lastIsWord = false;
+        bool _lineBreak = false;            // line break after last token
+    };
+}
+
+namespace Robomongo
+{
+    namespace JsStatementSplitter
+    {
+        bool split(const std::string &script, Ranges &outRanges)
+        {
+            Ranges ranges;
+            if (!Scanner(script).run(ranges))
+                return false;
+
+            outRanges.insert(outRanges.end(), ranges.begin(), ranges.end());
+            return true;
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Robomongo
+{
+    /**
+     * @brief Native splitter of JavaScript into top-level statements, used by
+     *        ScriptEngine instead of parsing whole script by esprima inside of JS scope.
+     *
+     *  Scanner is aware of brackets, strings, comments, regular expressions and template
+     *  literals. Automatic semicolon insertion is supported for common cases only: if line
+     *  break could either end or continue statement (i.e. next line starts with '(' or '['),
+     *  script is reported as ambiguous and caller should use esprima.
+     *
+     *  Usage:
+     *
+     *  JsStatementSplitter::Ranges ranges;
+     *  if (JsStatementSplitter::split(script, ranges)) {
+     *      for (auto const& range : ranges)
+     *          statements.push_back(script.substr(range.first, range.second - range.first));
+     *  }
+     */
+    namespace JsStatementSplitter
+    {
+        // [from, till) byte positions of statements in script
+        typedef std::vector<std::pair<size_t, size_t>> Ranges;
+
+        /**
+         * @return false, if script is invalid or ambiguous for this scanner.
+         *         'outRanges' is not modified in this case.
+         */
+        bool split(const std::string &script, Ranges &outRanges);
+    }
+}
@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+#include "robomongo/core/engine/JsStatementSplitter.h"
+
+#include <string>
+
+namespace
+{
+    std::vector<std::string> statements(const std::string &script, bool *ok = nullptr)
+    {
+        Robomongo::JsStatementSplitter::Ranges ranges;
+        bool const result = Robomongo::JsStatementSplitter::split(script, ranges);
+        if (ok)
+            *ok = result;
+
+        std::vector<std::string> output;
+        for (auto const& range : ranges)
+            output.push_back(script.substr(range.first, range.second - range.first));
+        return output;
+    }
+
+    bool isAmbiguous(const std::string &script)
+    {
+        bool ok = true;
+        statements(script, &ok);
+        return !ok;
+    }
+}
+
+TEST(JsStatementSplitterTests, Split_EmptyScript_ReturnsNoStatements)
+{
+    bool ok = false;
+    EXPECT_TRUE(statements(" \n\t", &ok).empty());
+    EXPECT_TRUE(ok);
+}
+
+TEST(JsStatementSplitterTests, Split_Semicolons_SplitsAndKeepsSemicolon)
+{
+    std::vector<std::string> const expected { "db.a.find();", "db.b.find()" };
+    EXPECT_EQ(expected, statements("db.a.find();db.b.find()"));
+    EXPECT_EQ(std::vector<std::string> { "a;" }, statements("a;;\n;"));
+}
+
+TEST(JsStatementSplitterTests, Split_LineBreaks_InsertsSemicolons)
+{
+    std::vector<std::string> const expected { "var a = 1", "var b = {\n x: 'a;b'\n}", "print(a / b)" };
+    EXPECT_EQ(expected, statements("var a = 1\nvar b = {\n x: 'a;b'\n}\nprint(a / b)"));
+    EXPECT_EQ((std::vector<std::string> { "a++", "b" }), statements("a++\nb"));
+}
+
+TEST(JsStatementSplitterTests, Split_ChainedCalls_ReturnsOneStatement)
+{
+    std::string const script = "db.a.find()\n  .sort({a: 1})\n  .limit(5)";
+    EXPECT_EQ(std::vector<std::string> { script }, statements(script));
+}
+
+TEST(JsStatementSplitterTests, Split_LiteralsAndComments_IgnoresSeparatorsInside)
+{
+    std::vector<std::string> const expected { "x = /ab;c/g.test(s);", "`a ${ {x: 1}.x } b`;", "y /* ; */;" };
+    EXPECT_EQ(expected, statements("x = /ab;c/g.test(s);\n`a ${ {x: 1}.x } b`; // ;\ny /* ; */;"));
+}
+
+TEST(JsStatementSplitterTests, Split_LineBreakAfterRegex_EndsStatement)
+{
+    EXPECT_EQ((std::vector<std::string> { "var r = /abc/", "print(r)" }), statements("var r = /abc/\nprint(r)"));
+    EXPECT_EQ((std::vector<std::string> { "var r = /abc/g", "db.foo.find()" }),
+              statements("var r = /abc/g\ndb.foo.find()"));
+    EXPECT_EQ((std::vector<std::string> { "x = /a/ / 2" }), statements("x = /a/ / 2"));
+}
+
+TEST(JsStatementSplitterTests, Split_IfElse_ReturnsOneStatement)
+{
+    std::vector<std::string> const expected { "if (a) {\n b()\n} else {\n c()\n}", "d()" };
+    EXPECT_EQ(expected, statements("if (a) {\n b()\n} else {\n c()\n}\nd()"));
+}
+
+TEST(JsStatementSplitterTests, Split_AmbiguousOrInvalid_ReturnsFalse)
+{
+    EXPECT_TRUE(isAmbiguous("a\n(b)"));
+    EXPECT_TRUE(isAmbiguous("if (a)\n b()"));
+    EXPECT_TRUE(isAmbiguous("'unterminated"));
+    EXPECT_TRUE(isAmbiguous("a = (1"));
+    EXPECT_TRUE(isAmbiguous("a = 1 /* unterminated"));
+}
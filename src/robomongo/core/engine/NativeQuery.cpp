@@ -0,0 +1,356 @@
+#include "robomongo/core/engine/NativeQuery.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <vector>
+
+#include "robomongo/core/engine/JsStatementSplitter.h"
+#include "robomongo/shell/bson/json.h"
+
+namespace
+{
+    void skipSpaces(const std::string &text, size_t &pos)
+    {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+            ++pos;
+    }
+
+    bool consume(const std::string &text, size_t &pos, const std::string &token)
+    {
+        skipSpaces(text, pos);
+        if (text.compare(pos, token.size(), token) != 0)
+            return false;
+
+        pos += token.size();
+        return true;
+    }
+
+    // Quoted JavaScript string, only escapes produced by App::buildCollectionQuery() are decoded
+    bool readString(const std::string &text, size_t &pos, std::string &outValue)
+    {
+        skipSpaces(text, pos);
+        if (pos >= text.size() || (text[pos] != '\'' && text[pos] != '"'))
+            return false;
+
+        char const quote = text[pos++];
+        outValue.clear();
+        for (; pos < text.size(); ++pos) {
+            char const ch = text[pos];
+            if (ch == quote) {
+                ++pos;
+                return true;
+            }
+
+            if (ch == '\\') {
+                if (++pos >= text.size())
+                    return false;
+
+                char const escaped = text[pos];
+                if (escaped != '\\' && escaped != '\'' && escaped != '"')
+                    return false;
+
+                outValue += escaped;
+                continue;
+            }
+
+            if (ch == '\n')
+                return false;
+
+            outValue += ch;
+        }
+        return false;
+    }
+
+    // Splits text of arguments up to the closing bracket of call, which must end the script
+    bool readArguments(const std::string &text, size_t pos, std::vector<std::string> &outArgs)
+    {
+        int depth = 0;
+        size_t argStart = pos;
+        for (; pos < text.size(); ++pos) {
+            char const ch = text[pos];
+            if (ch == '\'' || ch == '"') {
+                std::string ignored;
+                if (!readString(text, pos, ignored))
+                    return false;
+                --pos;
+                continue;
+            }
+
+            if (ch == '/' || ch == '`')     // comments, regular expressions and templates
+                return false;
+
+            if (ch == '(' || ch == '[' || ch == '{') {
+                ++depth;
+            }
+            else if (ch == ']' || ch == '}') {
+                if (--depth < 0)
+                    return false;
+            }
+            else if (ch == ')') {
+                if (depth-- == 0)
+                    break;
+            }
+            else if (ch == ',' && depth == 0) {
+                outArgs.push_back(text.substr(argStart, pos - argStart));
+                argStart = pos + 1;
+            }
+        }
+
+        if (pos >= text.size())
+            return false;
+
+        outArgs.push_back(text.substr(argStart, pos - argStart));
+
+        // Nothing but semicolon may follow the call
+        ++pos;
+        consume(text, pos, ";");
+        skipSpaces(text, pos);
+        if (pos != text.size())
+            return false;
+
+        // "find()" has one empty argument here
+        if (outArgs.size() == 1 && outArgs.front().find_first_not_of(" \t\r\n") == std::string::npos)
+            outArgs.clear();
+
+        return true;
+    }
+
+    bool readIdentifier(const std::string &text, size_t &pos, std::string &outName)
+    {
+        skipSpaces(text, pos);
+        size_t const begin = pos;
+        for (; pos < text.size(); ++pos) {
+            unsigned char const ch = static_cast<unsigned char>(text[pos]);
+            if (!(std::isalpha(ch) || ch == '_' || ch == '$' || (pos > begin && std::isdigit(ch))))
+                break;
+        }
+        outName = text.substr(begin, pos - begin);
+        return pos > begin;
+    }
+
+    // Properties of DB in shell, which are not collections (see src/mongo/shell/db.js)
+    bool isDbMethod(const std::string &name)
+    {
+        static const char *const methods[] = {
+            "adminCommand", "aggregate", "auth", "changeUserPassword", "cloneCollection", "cloneDatabase",
+            "commandHelp", "copyDatabase", "createCollection", "createRole", "createUser", "createView",
+            "currentOp", "dropAllRoles", "dropAllUsers", "dropDatabase", "dropRole", "dropUser", "eval",
+            "fsyncLock", "fsyncUnlock", "getCollection", "getCollectionInfos", "getCollectionNames",
+            "getLastError", "getLastErrorObj", "getLogComponents", "getMongo", "getName", "getPrevError",
+            "getProfilingLevel", "getProfilingStatus", "getQueryOptions", "getReplicationInfo", "getRole",
+            "getRoles", "getSiblingDB", "getSlaveOk", "getUser", "getUsers", "getWriteConcern",
+            "grantPrivilegesToRole", "grantRolesToRole", "grantRolesToUser", "help", "hostInfo",
+            "isMaster", "killOp", "listCommands", "loadServerScripts", "logout", "printCollectionStats",
+            "printReplicationInfo", "printShardingStatus", "printSlaveReplicationInfo", "repairDatabase",
+            "resetError", "revokePrivilegesFromRole", "revokeRolesFromRole", "revokeRolesFromUser",
+            "runCommand", "runCommandWithMetadata", "serverBits", "serverBuildInfo", "serverCmdLineOpts",
+            "serverStatus", "setLogLevel", "setProfilingLevel", "setSlaveOk", "setWriteConcern",
+            "shutdownServer", "stats", "toString", "unsetWriteConcern", "updateRole", "updateUser",
+            "version", "watch"
+        };
+        return std::any_of(std::begin(methods), std::end(methods),
+                           [&name](const char *method) { return name == method; });
+    }
+
+    // "orders" of db.orders.find(, "system.profile" of db.system.profile.aggregate(
+    bool readCollectionPath(const std::string &text, size_t &pos, std::string &outPath)
+    {
+        outPath.clear();
+        for (;;) {
+            std::string part;
+            if (!readIdentifier(text, pos, part))
+                return false;
+            if (outPath.empty() && (isDbMethod(part) || part[0] == '_'))
+                return false;
+            outPath += outPath.empty() ? part : "." + part;
+
+            size_t next = pos;
+            if (!consume(text, next, "."))
+                return false;
+
+            // Method call of collection ends the path
+            size_t method = next;
+            std::string name;
+            if (readIdentifier(text, method, name) && (name == "find" || name == "aggregate") &&
+                consume(text, method, "(")) {
+                pos = next;
+                return true;
+            }
+            pos = next;
+        }
+    }
+
+    bool parseObject(const std::string &text, mongo::BSONObj &outObj)
+    {
+        size_t const begin = text.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos || text[begin] != '{')
+            return false;
+
+        try {
+            int len = 0;
+            outObj = mongo::Robomongo::fromjson(text.c_str() + begin, &len).getOwned();
+            size_t end = begin + len;
+            skipSpaces(text, end);
+            return end == text.size();
+        }
+        catch (const std::exception &) {
+            return false;   // i.e. JavaScript expression, which only shell can evaluate
+        }
+    }
+
+    bool parseArray(const std::string &text, mongo::BSONObj &outArray)
+    {
+        size_t const begin = text.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos || text[begin] != '[')
+            return false;
+
+        mongo::BSONObj wrapper;
+        if (!parseObject("{ a: " + text.substr(begin) + " }", wrapper))
+            return false;
+
+        mongo::BSONElement const element = wrapper.firstElement();
+        if (element.type() != mongo::Array)
+            return false;
+
+        outArray = element.Obj().getOwned();
+        return true;
+    }
+
+    bool parseCount(const std::string &text, int &outCount)
+    {
+        size_t const begin = text.find_first_not_of(" \t\r\n");
+        size_t const end = text.find_last_not_of(" \t\r\n");
+        if (begin == std::string::npos || end - begin >= 9)
+            return false;
+
+        std::string const digits = text.substr(begin, end - begin + 1);
+        if (!std::all_of(digits.begin(), digits.end(), [](char ch) { return std::isdigit(static_cast<unsigned char>(ch)); }))
+            return false;
+
+        outCount = std::stoi(digits);
+        return outCount > 0;
+    }
+}
+
+namespace Robomongo
+{
+    bool NativeQuery::parse(const std::string &script, NativeQuery &outQuery, bool dottedCollection)
+    {
+        NativeQuery query;
+        size_t pos = 0;
+        if (!consume(script, pos, "db") || !consume(script, pos, "."))
+            return false;
+
+        size_t const afterDb = pos;
+        if (consume(script, pos, "getCollection") && consume(script, pos, "(")) {
+            if (!readString(script, pos, query.collection) || !consume(script, pos, ")") ||
+                !consume(script, pos, "."))
+                return false;
+        }
+        else {
+            pos = afterDb;
+            if (!dottedCollection || !readCollectionPath(script, pos, query.collection))
+                return false;
+        }
+
+        if (query.collection.empty())
+            return false;
+
+        if (consume(script, pos, "find"))
+            query.kind = Find;
+        else if (consume(script, pos, "aggregate"))
+            query.kind = Aggregate;
+        else
+            return false;
+
+        std::vector<std::string> args;
+        if (!consume(script, pos, "(") || !readArguments(script, pos, args))
+            return false;
+
+        if (query.kind == Find) {
+            if (args.size() > 2)
+                return false;
+            if (args.size() > 0 && !parseObject(args[0], query.filter))
+                return false;
+            if (args.size() > 1 && !parseObject(args[1], query.projection))
+                return false;
+        }
+        else {
+            if (args.empty() || args.size() > 2)
+                return false;
+            if (!parseArray(args[0], query.pipeline))
+                return false;
+            if (args.size() > 1 && !parseObject(args[1], query.options))
+                return false;
+        }
+
+        outQuery = query;
+        return true;
+    }
+
+    bool NativeQuery::isReadOnly() const
+    {
+        if (kind == Find)
+            return true;
+
+        for (mongo::BSONObjIterator it(pipeline); it.more(); ) {
+            mongo::BSONElement const stage = it.next();
+            if (stage.type() != mongo::Object)
+                return false;
+            char const *const name = stage.Obj().firstElementFieldName();
+            if (std::strcmp(name, "$out") == 0 || std::strcmp(name, "$merge") == 0)
+                return false;
+        }
+        return true;
+    }
+
+    bool NativeQuery::parseReads(const std::string &script, std::vector<std::string> &outStatements,
+                                 std::vector<NativeQuery> &outQueries)
+    {
+        JsStatementSplitter::Ranges ranges;
+        if (!JsStatementSplitter::split(script, ranges) || ranges.size() < 2)
+            return false;
+
+        std::vector<std::string> statements;
+        std::vector<NativeQuery> queries;
+        for (auto const& range : ranges) {
+            statements.push_back(script.substr(range.first, range.second - range.first));
+            NativeQuery query;
+            if (!parse(statements.back(), query, true) || !query.isReadOnly())
+                return false;
+            queries.push_back(query);
+        }
+
+        outStatements.swap(statements);
+        outQueries.swap(queries);
+        return true;
+    }
+
+    bool NativeQuery::parseBenchmark(const std::string &script, NativeQuery &outQuery,
+                                     int &outIterations, int &outConcurrency)
+    {
+        size_t const call = script.rfind(".benchmark");
+        if (call == std::string::npos)
+            return false;
+
+        size_t pos = call + std::strlen(".benchmark");
+        std::vector<std::string> args;
+        if (!consume(script, pos, "(") || !readArguments(script, pos, args) || args.empty() || args.size() > 2)
+            return false;
+
+        int iterations = 0;
+        int concurrency = 1;
+        if (!parseCount(args[0], iterations) || (args.size() > 1 && !parseCount(args[1], concurrency)))
+            return false;
+
+        NativeQuery query;
+        if (!parse(script.substr(0, call), query, true) || !query.isReadOnly())
+            return false;
+
+        outQuery = query;
+        outIterations = iterations;
+        outConcurrency = concurrency;
+        return true;
+    }
+}
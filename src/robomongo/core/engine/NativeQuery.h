@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Query generated by Robomongo itself (i.e. when collection is opened from explorer),
+     *        that MongoWorker runs with driver connection instead of JavaScript shell.
+     *
+     *  Recognized forms (one statement, optional trailing semicolon, arguments are JSON as
+     *  accepted by mongo::Robomongo::fromjson()):
+     *
+     *  db.getCollection('name').find()
+     *  db.getCollection('name').find({ filter } [, { projection }])
+     *  db.getCollection('name').aggregate([ stages ] [, { options }])
+     *
+     *  Everything else (chained cursor methods, JavaScript expressions in arguments, several
+     *  statements) is left to ScriptEngine.
+     *
+     *  With 'dottedCollection', collection may also be named as property of db (db.orders.find(),
+     *  db.system.profile.find()), unless it is a method of DB (db.stats) or starts with '_'.
+     */
+    struct NativeQuery
+    {
+        enum Kind { Find, Aggregate };
+
+        Kind kind = Find;
+        std::string collection;
+        mongo::BSONObj filter;
+        mongo::BSONObj projection;
+        mongo::BSONObj pipeline;    // array
+        mongo::BSONObj options;
+
+        /**
+         * @return false, if script is not one of recognized forms
+         */
+        static bool parse(const std::string &script, NativeQuery &outQuery, bool dottedCollection = false);
+
+        /**
+         * @brief Query does not write: find, or aggregation without $out and $merge stages
+         */
+        bool isReadOnly() const;
+
+        /**
+         * @brief Script of at least two statements, every one of which is a read-only query
+         *        (dotted collections allowed). Arguments are literals, so statements share no
+         *        variables and can run in any order.
+         * @return false, if script is anything else
+         */
+        static bool parseReads(const std::string &script, std::vector<std::string> &outStatements,
+                               std::vector<NativeQuery> &outQueries);
+
+        /**
+         * @brief Query of recognized form (dotted collections allowed), that does not write,
+         *        followed by .benchmark(iterations [, concurrency]), which shell does not have,
+         *        e.g. db.orders.find({ status: 'new' }).benchmark(1000, 8). See QueryBenchmark.
+         * @param outConcurrency 1, if not given
+         * @return false, if script is anything else or counts are not positive integers
+         */
+        static bool parseBenchmark(const std::string &script, NativeQuery &outQuery,
+                                   int &outIterations, int &outConcurrency);
+    };
+}
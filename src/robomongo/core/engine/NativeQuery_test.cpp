@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+#include "robomongo/core/engine/NativeQuery.h"
+
+using Robomongo::NativeQuery;
+
+TEST(NativeQueryTests, Parse_GeneratedFind_IsNative)
+{
+    NativeQuery query;
+    ASSERT_TRUE(NativeQuery::parse("db.getCollection('users').find({})", query));
+    EXPECT_EQ(NativeQuery::Find, query.kind);
+    EXPECT_EQ("users", query.collection);
+    EXPECT_TRUE(query.filter.isEmpty());
+    EXPECT_TRUE(query.projection.isEmpty());
+
+    ASSERT_TRUE(NativeQuery::parse(" db.getCollection(\"a\\\\b\").find();\n", query));
+    EXPECT_EQ("a\\b", query.collection);
+}
+
+TEST(NativeQueryTests, Parse_FindWithFilterAndProjection_ParsesArguments)
+{
+    NativeQuery query;
+    ASSERT_TRUE(NativeQuery::parse("db.getCollection('c').find({ name: 'x, y)' }, { _id: 0 })", query));
+    EXPECT_EQ("x, y)", std::string(query.filter.getStringField("name")));
+    EXPECT_EQ(0, query.projection.getIntField("_id"));
+}
+
+TEST(NativeQueryTests, Parse_Aggregate_ParsesPipelineAndOptions)
+{
+    NativeQuery query;
+    ASSERT_TRUE(NativeQuery::parse(
+        "db.getCollection('c').aggregate([{ $match: { a: 1 } }, {$skip:0}, {$limit:50}], { allowDiskUse: true })",
+        query));
+    EXPECT_EQ(NativeQuery::Aggregate, query.kind);
+    EXPECT_EQ(3, query.pipeline.nFields());
+    EXPECT_TRUE(query.options.getBoolField("allowDiskUse"));
+}
+
+TEST(NativeQueryTests, Parse_ArbitraryScripts_AreLeftToShell)
+{
+    NativeQuery query;
+    EXPECT_FALSE(NativeQuery::parse("db.getCollection('c').find({}).sort({ a: 1 })", query));
+    EXPECT_FALSE(NativeQuery::parse("db.getCollection('c').find({ a: new Date() })", query));
+    EXPECT_FALSE(NativeQuery::parse("db.getCollection('c').find({ a: /x/ })", query));
+    EXPECT_FALSE(NativeQuery::parse("db.getCollection('c').find({}); db.getCollection('d').find({})", query));
+    EXPECT_FALSE(NativeQuery::parse("db.getCollection('c').aggregate({ $match: {} })", query));
+    EXPECT_FALSE(NativeQuery::parse("db.c.find({})", query));
+    EXPECT_FALSE(NativeQuery::parse("db.getCollection('c').count()", query));
+}
+
+TEST(NativeQueryTests, Parse_DottedCollection_OnlyWhenAllowed)
+{
+    NativeQuery query;
+    ASSERT_TRUE(NativeQuery::parse("db.orders.aggregate([{ $group: { _id: '$a' } }])", query, true));
+    EXPECT_EQ(NativeQuery::Aggregate, query.kind);
+    EXPECT_EQ("orders", query.collection);
+
+    ASSERT_TRUE(NativeQuery::parse("db.system.profile.find({ millis: { $gt: 100 } });", query, true));
+    EXPECT_EQ(NativeQuery::Find, query.kind);
+    EXPECT_EQ("system.profile", query.collection);
+
+    ASSERT_TRUE(NativeQuery::parse("db.getCollection('c').find()", query, true));
+    EXPECT_EQ("c", query.collection);
+
+    EXPECT_FALSE(NativeQuery::parse("db.stats.find()", query, true));
+    EXPECT_FALSE(NativeQuery::parse("db._private.find()", query, true));
+    EXPECT_FALSE(NativeQuery::parse("db.c.findOne()", query, true));
+    EXPECT_FALSE(NativeQuery::parse("db.c.find().limit(1)", query, true));
+    EXPECT_FALSE(NativeQuery::parse("x = db.c.find()", query, true));
+}
+
+TEST(NativeQueryTests, IsReadOnly_WritingStages)
+{
+    NativeQuery query;
+    ASSERT_TRUE(NativeQuery::parse("db.c.aggregate([{ $match: {} }])", query, true));
+    EXPECT_TRUE(query.isReadOnly());
+    ASSERT_TRUE(NativeQuery::parse("db.c.aggregate([{ $match: {} }, { $out: 'd' }])", query, true));
+    EXPECT_FALSE(query.isReadOnly());
+    ASSERT_TRUE(NativeQuery::parse("db.c.aggregate([{ $merge: { into: 'd' } }])", query, true));
+    EXPECT_FALSE(query.isReadOnly());
+    ASSERT_TRUE(NativeQuery::parse("db.c.find({})", query, true));
+    EXPECT_TRUE(query.isReadOnly());
+}
+
+TEST(NativeQueryTests, ParseReads_IndependentStatementsOnly)
+{
+    std::vector<std::string> statements;
+    std::vector<NativeQuery> queries;
+    ASSERT_TRUE(NativeQuery::parseReads(
+        "db.a.aggregate([{ $count: 'n' }]);\ndb.b.find({ x: 1 })\ndb.getCollection('c').find()", statements, queries));
+    ASSERT_EQ(3u, queries.size());
+    ASSERT_EQ(3u, statements.size());
+    EXPECT_EQ("a", queries[0].collection);
+    EXPECT_EQ("b", queries[1].collection);
+    EXPECT_EQ("c", queries[2].collection);
+
+    EXPECT_FALSE(NativeQuery::parseReads("db.a.find({})", statements, queries));
+    EXPECT_FALSE(NativeQuery::parseReads("var q = { x: 1 }; db.a.find(q)", statements, queries));
+    EXPECT_FALSE(NativeQuery::parseReads("db.a.find({}); db.a.insert({ x: 1 })", statements, queries));
+    EXPECT_FALSE(NativeQuery::parseReads("db.a.find({}); db.a.aggregate([{ $out: 'b' }])", statements, queries));
+    EXPECT_EQ(3u, queries.size());
+}
+
+TEST(NativeQueryTests, ParseBenchmark_CountsAndReadOnlyQuery)
+{
+    NativeQuery query;
+    int iterations = 0;
+    int concurrency = 0;
+    ASSERT_TRUE(NativeQuery::parseBenchmark("db.orders.find({ s: '.benchmark(2)' }).benchmark(1000, 8);",
+                                            query, iterations, concurrency));
+    EXPECT_EQ(NativeQuery::Find, query.kind);
+    EXPECT_EQ("orders", query.collection);
+    EXPECT_EQ(".benchmark(2)", query.filter.getStringField("s"));
+    EXPECT_EQ(1000, iterations);
+    EXPECT_EQ(8, concurrency);
+
+    ASSERT_TRUE(NativeQuery::parseBenchmark("db.getCollection('c').aggregate([{ $count: 'n' }]).benchmark(5)",
+                                            query, iterations, concurrency));
+    EXPECT_EQ(NativeQuery::Aggregate, query.kind);
+    EXPECT_EQ(5, iterations);
+    EXPECT_EQ(1, concurrency);
+
+    EXPECT_FALSE(NativeQuery::parseBenchmark("db.c.find({})", query, iterations, concurrency));
+    EXPECT_FALSE(NativeQuery::parseBenchmark("db.c.find({}).benchmark()", query, iterations, concurrency));
+    EXPECT_FALSE(NativeQuery::parseBenchmark("db.c.find({}).benchmark(0)", query, iterations, concurrency));
+    EXPECT_FALSE(NativeQuery::parseBenchmark("db.c.find({}).benchmark(n, 2)", query, iterations, concurrency));
+    EXPECT_FALSE(NativeQuery::parseBenchmark("db.c.find({}).limit(5).benchmark(10)", query, iterations, concurrency));
+    EXPECT_FALSE(NativeQuery::parseBenchmark("db.c.aggregate([{ $out: 'd' }]).benchmark(10)", query, iterations, concurrency));
+}
@@ -0,0 +1,107 @@
+#include "robomongo/core/engine/ScopePool.h"
+
+#include <thread>
+#include <mongo/scripting/engine.h>
+
+#include "robomongo/core/utils/ThreadPriority.h"
+
+namespace Robomongo
+{
+    ScopePool &ScopePool::instance()
+    {
+        // Never destroyed: filling threads may still run while application exits
+        static ScopePool *pool = new ScopePool;
+        return *pool;
+    }
+
+    std::unique_ptr<mongo::Scope> ScopePool::take(const std::string &key, const std::string &fingerprint)
+    {
+        std::vector<std::unique_ptr<mongo::Scope>> stale;   // closed after unlock
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto const it = _idle.find(key);
+        if (it == _idle.end())
+            return nullptr;
+
+        if (it->second.fingerprint != fingerprint) {
+            stale.swap(it->second.scopes);
+            _idle.erase(it);
+            return nullptr;
+        }
+
+        if (it->second.scopes.empty())
+            return nullptr;
+
+        std::unique_ptr<mongo::Scope> scope = std::move(it->second.scopes.back());
+        it->second.scopes.pop_back();
+        return scope;
+    }
+
+    void ScopePool::fill(const std::string &key, const std::string &fingerprint, size_t size, 
+                         const Factory &factory)
+    {
+        if (size == 0)
+            return;
+
+        std::vector<std::unique_ptr<mongo::Scope>> stale;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            Entry &entry = _idle[key];
+            if (entry.fingerprint != fingerprint) {
+                stale.swap(entry.scopes);
+                entry.fingerprint = fingerprint;
+            }
+
+            if (_filling.count(key) || entry.scopes.size() >= size)
+                return;
+
+            _filling.insert(key);
+        }
+
+        std::thread(&ScopePool::fillThread, this, key, fingerprint, size, factory).detach();
+    }
+
+    void ScopePool::evict(const std::string &key)
+    {
+        std::vector<std::unique_ptr<mongo::Scope>> stale;
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto const it = _idle.find(key);
+        if (it == _idle.end())
+            return;
+
+        stale.swap(it->second.scopes);
+        _idle.erase(it);
+    }
+
+    void ScopePool::fillThread(const std::string &key, const std::string &fingerprint, size_t size, 
+                               const Factory &factory)
+    {
+        // Spare scopes are not awaited by anyone yet
+        ThreadPriority::setCurrent(ThreadPriority::Background);
+        while (true) {
+            std::unique_ptr<mongo::Scope> scope;
+            try {
+                scope = factory();
+            } catch (const std::exception &) {
+                // Shell which takes no scope from pool reports the error
+            }
+
+            bool const created = static_cast<bool>(scope);
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            // Key was evicted, or its settings changed while scope was created
+            auto const it = _idle.find(key);
+            if (it == _idle.end() || it->second.fingerprint != fingerprint) {
+                _filling.erase(key);
+                return;
+            }
+
+            if (created)
+                it->second.scopes.push_back(std::move(scope));
+
+            if (!created || it->second.scopes.size() >= size) {
+                _filling.erase(key);
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace mongo
+{
+    class Scope;
+}
+
+namespace Robomongo
+{
+    /**
+     * @brief Initialized JavaScript scopes (connected shell, .mongorc.js and Robomongo helpers),
+     *        prepared in background for shells that are opened next, by connection key.
+     *        Used scopes are not returned to the pool: globals of user scripts cannot be
+     *        reliably removed from scope, so pool is refilled with new scopes instead.
+     *
+     *        Scopes of key are kept with fingerprint of everything they were created with
+     *        (address, credential, options), so that they are not taken once it changed.
+     *        Fingerprint is a hash, pool keeps no secrets. Idle scopes hold authenticated
+     *        connections, owner of key evicts them when it no longer needs them.
+     * @threadsafe
+     */
+    class ScopePool
+    {
+    public:
+        typedef std::function<std::unique_ptr<mongo::Scope>()> Factory;
+
+        static ScopePool &instance();
+
+        /**
+         * @return nullptr, if there is no prepared scope for this key and fingerprint. Scopes
+         *         of other fingerprint are evicted.
+         */
+        std::unique_ptr<mongo::Scope> take(const std::string &key, const std::string &fingerprint);
+
+        /**
+         * @brief Creates scopes with 'factory' in background thread, until 'size' scopes are
+         *        prepared for this key. Filling stops at the first failure (i.e. server is
+         *        unreachable), it is retried on the next call. Scopes of other fingerprint
+         *        are evicted.
+         */
+        void fill(const std::string &key, const std::string &fingerprint, size_t size, const Factory &factory);
+
+        /**
+         * @brief Closes idle scopes of key. Scopes being created for it are closed too.
+         */
+        void evict(const std::string &key);
+
+    private:
+        struct Entry
+        {
+            std::string fingerprint;
+            std::vector<std::unique_ptr<mongo::Scope>> scopes;
+        };
+
+        ScopePool() {}
+        void fillThread(const std::string &key, const std::string &fingerprint, size_t size, 
+                        const Factory &factory);
+
+        std::mutex _mutex;
+        std::map<std::string, Entry> _idle;
+        std::set<std::string> _filling;
+    };
+}
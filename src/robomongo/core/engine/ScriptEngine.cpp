@@ -7,6 +7,9 @@
 #include <QTextStream>
 #include <QFile>
 #include <QElapsedTimer>
+#include <QCryptographicHash>
+#include <algorithm>
+#include <map>
 
 // v0.9
 //#include <third_party/js-1.7/jsapi.h>
@@ -14,6 +17,7 @@
 //#include <third_party/js-1.7/jsscan.h>
 //#include <third_party/js-1.7/jsstr.h>
 
+#include <mongo/bson/bsonobjbuilder.h>
 #include <mongo/util/assert_util.h>
 #include <mongo/util/exit_code.h>
 #include <mongo/scripting/engine.h>
@@ -27,9 +31,13 @@
 #include <mongo/client/dbclient_base.h>
 #include <pcrecpp.h>
 
+#include "robomongo/core/engine/JsStatementSplitter.h"
+#include "robomongo/core/engine/ScopePool.h"
 #include "robomongo/core/events/MongoEvents.h"
 #include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/settings/CredentialSettings.h"
+#include "robomongo/core/settings/StoredSecret.h"
+#include "robomongo/core/domain/CollectionNamesVersion.h"
 #include "robomongo/core/domain/MongoDocument.h"
 #include "robomongo/core/utils/Logger.h"
 #include "robomongo/core/utils/QtUtils.h"
@@ -48,20 +56,70 @@ namespace
         output.push_back(s.substr(prev_pos, pos-prev_pos)); // Last word
         return output;
     }
+
+    // Script engine setup and connection string are global, they are read by initScope() of every new scope
+    QMutex scopeCreationMutex;
+
+    // Statement connecting 'db' of new scope. Password stays in StoredSecret (wiped when
+    // released) until the statement is built for scope being created.
+    struct ShellConnect
+    {
+        std::string hostAndPort;
+        std::string database;
+        bool authenticate = false;
+        std::string userName;
+        Robomongo::StoredSecret password;
+
+        std::string script() const
+        {
+            std::stringstream ss;
+            ss << "db = connect('" << hostAndPort << "/" << database;
+
+//            v0.9
+//            ss << "db = connect('" << _connection->serverHost() << ":" << _connection->serverPort() << _connection->sslInfo() << _connection->sshInfo() << "/" << connectDatabase;
+
+            if (!authenticate)
+                ss << "')";
+            else
+                ss << "', '" << userName << "', '" << password.plain() << "')";
+            return ss.str();
+        }
+    };
 }
 
 namespace mongo {
     extern bool isShell;
     void logProcessDetailsForLogRotate() {}
+
+    // Counter of MozJS custom allocator (jscustomallocator.cpp), per JavaScript thread
+    namespace sm {
+        size_t get_total_bytes();
+    }
+}
+
+namespace
+{
+    // Native __robomongoJsHeapBytes() runs on thread of scope, where its allocations are counted
+    mongo::BSONObj jsHeapBytesNative(const mongo::BSONObj &, void *)
+    {
+        return BSON("" << static_cast<double>(mongo::sm::get_total_bytes()));
+    }
 }
 
 namespace Robomongo
 {
-    ScriptEngine::ScriptEngine(ConnectionSettings *connection, int timeoutSec) :
+    QCache<QString, ScriptEngine::StatementRanges> ScriptEngine::_statementsCache(128);
+    QMutex ScriptEngine::_statementsCacheMutex;
+
+    ScriptEngine::ScriptEngine(ConnectionSettings *connection, int timeoutSec, int resultBudgetMb,
+                               int jsHeapLimitMb, int scopePoolSize /* = 0 */) :
         _connection(connection),
         _scope(nullptr),
         _engine(NULL),
         _timeoutSec(timeoutSec),
+        _resultBudgetMb(resultBudgetMb),
+        _jsHeapLimitMb(jsHeapLimitMb > 0 ? jsHeapLimitMb : DefaultJsHeapLimitMb),
+        _scopePoolSize(scopePoolSize),
         _initialized(false),
         _mutex(QMutex::Recursive) { }
 
@@ -78,22 +136,59 @@ namespace Robomongo
         if (_connection->hasEnabledPrimaryCredential())
             connectDatabase = _connection->primaryCredential()->databaseName();
 
-        std::stringstream ss;
-        auto hostAndPort = serverAddr.empty() ? _connection->hostAndPort().toString() : serverAddr;
-        ss << "db = connect('" << hostAndPort << "/" << connectDatabase;
+        ShellConnect connect;
+        connect.hostAndPort = serverAddr.empty() ? _connection->hostAndPort().toString() : serverAddr;
+        connect.database = connectDatabase;
+        if (_connection->hasEnabledPrimaryCredential()) {
+            connect.authenticate = true;
+            connect.userName = _connection->primaryCredential()->userName();
+            connect.password = _connection->primaryCredential()->userPassword();
+        }
 
-//        v0.9
-//        ss << "db = connect('" << _connection->serverHost() << ":" << _connection->serverPort() << _connection->sslInfo() << _connection->sshInfo() << "/" << connectDatabase;
+        // Scope prepared in background by previous shell of this connection, if any. Pool
+        // keeps hash of connect statement only, statement is built where scope is created.
+        int const jsHeapLimitMb = _jsHeapLimitMb;
+        QString const uuid = _connection->uuid();
+        _scopePoolKey = uuid.isEmpty() ? _connection->connectionName() : QtUtils::toStdString(uuid);
+        std::string const fingerprint = QCryptographicHash::hash(
+            QByteArray::fromStdString(connect.script() + (isLoadMongoRcJs ? "|mongorc" : "") +
+                                      "|heap" + std::to_string(jsHeapLimitMb)),
+            QCryptographicHash::Sha256).toHex().toStdString();
+        std::unique_ptr<mongo::Scope> scope = ScopePool::instance().take(_scopePoolKey, fingerprint);
+        if (!scope)
+            scope = createScope(connect.script(), isLoadMongoRcJs, jsHeapLimitMb);
+
+        _scope = std::move(scope);
+        _engine = mongo::getGlobalScriptEngine();
+        _failedScope = false;
+        _readPreference = ReadPreferenceInfo();
+        _maxTimeMs = 0;
+
+        // Esprima ECMAScript parser (http://esprima.org/) is loaded on demand, see statementize()
+        _isEsprimaLoaded = false;
+
+        // Operations of this shell are found by its address, when user stops script
+        _scope->exec("__robomongoClientAddress = '';"
+                     "try { __robomongoClientAddress = db.runCommand({ whatsmyuri: 1 }).you || ''; } catch (e) {}",
+                     "(whatsmyuri)", false, false, false, 3000);
+        _clientAddress = getString("__robomongoClientAddress");
 
-        if (!_connection->hasEnabledPrimaryCredential())
-            ss << "')";
-        else
-            ss << "', '"
-               << _connection->primaryCredential()->userName() << "', '"
-               << _connection->primaryCredential()->userPassword() << "')";
+        _initialized = true;
 
+        ScopePool::instance().fill(_scopePoolKey, fingerprint, _scopePoolSize, 
+                                   [connect, isLoadMongoRcJs, jsHeapLimitMb]() {
+            return createScope(connect.script(), isLoadMongoRcJs, jsHeapLimitMb);
+        });
+    }
+
+    std::unique_ptr<mongo::Scope> ScriptEngine::createScope(const std::string &dbConnect, bool isLoadMongoRcJs,
+                                                            int jsHeapLimitMb)
+    {
+        std::unique_ptr<mongo::Scope> scope;
         {
-            mongo::shell_utils::dbConnect = ss.str();
+            QMutexLocker lock(&scopeCreationMutex);
+
+            mongo::shell_utils::dbConnect = dbConnect;
 
             // v0.9
             // mongo::isShell = true;
@@ -103,54 +198,60 @@ namespace Robomongo
             mongo::getGlobalScriptEngine()->setScopeInitCallback(mongo::shell_utils::initScope);
             mongo::getGlobalScriptEngine()->enableJIT(true);
 
-            _scope.reset(mongo::getGlobalScriptEngine()->newScope());
-            _engine = mongo::getGlobalScriptEngine();
+            // Read by runtime of new scope only: its allocator fails past the limit, and it
+            // collects garbage on its own when heap comes close to it
+            mongo::getGlobalScriptEngine()->setJSHeapLimitMB(jsHeapLimitMb);
 
-            // Load '.mongorc.js' from user's home directory
-            if (isLoadMongoRcJs) {
-                QString mongorcPath = QString("%1/.mongorc.js").arg(QDir::homePath());
-                if (QFile::exists(mongorcPath)) {
-                    _scope->execFile(QtUtils::toStdString(mongorcPath), false, false);
-                }
-            }
+            scope.reset(mongo::getGlobalScriptEngine()->newScope());
+
+            // Read by initScope() of new scope only, credential is not left in it
+            mongo::shell_utils::dbConnect.clear();
+        }
+
+        scope->injectNative("__robomongoJsHeapBytes", jsHeapBytesNative);
 
-            // Load '.robomongorc.js'
-            QString robomongorcPath = QString("%1/.robomongorc.js").arg(QDir::homePath());
-            if (QFile::exists(robomongorcPath)) {
-                _scope->execFile(QtUtils::toStdString(robomongorcPath), false, false);
+        // Load '.mongorc.js' from user's home directory
+        if (isLoadMongoRcJs) {
+            QString mongorcPath = QString("%1/.mongorc.js").arg(QDir::homePath());
+            if (QFile::exists(mongorcPath)) {
+                scope->execFile(QtUtils::toStdString(mongorcPath), false, false);
             }
-            _failedScope = false;
         }
 
-        // Esprima ECMAScript parser: http://esprima.org/
-        std::string esprima = loadFile(":/robomongo/scripts/esprima.js", true);
-        _scope->exec(esprima, "(esprima)", false, true, true);
+        // Load '.robomongorc.js'
+        QString robomongorcPath = QString("%1/.robomongorc.js").arg(QDir::homePath());
+        if (QFile::exists(robomongorcPath)) {
+            scope->execFile(QtUtils::toStdString(robomongorcPath), false, false);
+        }
 
         // UUID helpers
         std::string uuidhelpers = loadFile(":/robomongo/scripts/uuidhelpers.js", true);
-        _scope->exec(uuidhelpers, "(uuidhelpers)", false, true, true);
+        scope->exec(uuidhelpers, "(uuidhelpers)", false, true, true);
 
         // Enable verbose shell reporting
-        _scope->exec("_verboseShell = true;", "(verboseShell)", false, false, false);
+        scope->exec("_verboseShell = true;", "(verboseShell)", false, false, false);
 
         // Save original autocomplete function so it can be restored if overwritten by user preference
-        _scope->exec("DB.autocompleteOriginal = DB.autocomplete;", "(saveOriginalAutocomplete)", false, false, false);
+        scope->exec("DB.autocompleteOriginal = DB.autocomplete;", "(saveOriginalAutocomplete)", false, false, false);
 
-        // Cache result of original "DB.autocomplete"
+        // Cache result of original "DB.autocomplete", per database.
         // Cache invalidated by the invalidateDbCollectionsCache() method.
         std::string const cacheAutocompletion =
-            "__robomongoAutocompletionCache = null;"
+            "__robomongoAutocompletionCache = {};"
             "DB.autocompleteCached = function(obj) { "
-            "   if (__robomongoAutocompletionCache == null) {"
-            "       __robomongoAutocompletionCache = DB.autocompleteOriginal(obj);"
+            "   var name = obj.getName();"
+            "   if (!__robomongoAutocompletionCache.hasOwnProperty(name)) {"
+            "       __robomongoAutocompletionCache[name] = DB.autocompleteOriginal(obj);"
             "   }"
-            "   return __robomongoAutocompletionCache;"
+            "   return __robomongoAutocompletionCache[name];"
             "}";
 
-        _scope->exec(cacheAutocompletion, "", false, false, false);
+        scope->exec(cacheAutocompletion, "", false, false, false);
 
-        // Capture aggregate parameters: pipeline, options
+        // Capture aggregate parameters: pipeline, options. Time limit of tab is not captured,
+        // pages of result get it from their tab (see setMaxTimeMs())
         std::string const aggregateInterceptor =
+            "__robomongoMaxTimeMS = 0;"
             "__robomongoAggregateUsed = false;"
             "__robomongoAggregate = DBCollection.prototype.aggregate;"
             "__robomongoAggregatePipeline = null;"
@@ -159,16 +260,34 @@ namespace Robomongo
             "   __robomongoAggregateUsed = true;"
             "   __robomongoAggregatePipeline = pipeline;"
             "   __robomongoAggregateOptions = options;"
+            "   if (__robomongoMaxTimeMS > 0 && Array.isArray(pipeline) && "
+            "       (options === undefined || (typeof options == 'object' && options.maxTimeMS === undefined)))"
+            "       options = Object.assign({ maxTimeMS: __robomongoMaxTimeMS }, options);"
             "   return __robomongoAggregate.call(this, pipeline, options);"
             "}";
 
-        _scope->exec(aggregateInterceptor, "", false, false, false);
+        scope->exec(aggregateInterceptor, "", false, false, false);
+
+        // Time limit of tab for finds, removed once cursor is opened, so prepareResult() does not capture it
+        std::string const findInterceptor =
+            "__robomongoExec = DBQuery.prototype._exec;"
+            "DBQuery.prototype._exec = function() { "
+            "   if (this._cursor || !(__robomongoMaxTimeMS > 0) || "
+            "       (this._special && this._query.$maxTimeMS !== undefined))"
+            "       return __robomongoExec.call(this);"
+            "   this._addSpecial('$maxTimeMS', __robomongoMaxTimeMS);"
+            "   try { return __robomongoExec.call(this); }"
+            "   finally { delete this._query.$maxTimeMS; }"
+            "}";
+
+        scope->exec(findInterceptor, "", false, false, false);
 
-        _initialized = true;
+        return scope;
     }
 
     MongoShellExecResult ScriptEngine::exec(const std::string &originalScript, const std::string &dbName, 
-                                            AggrInfo aggrInfo /* = AggrInfo() */)
+                                            AggrInfo aggrInfo /* = AggrInfo() */, 
+                                            bool profile /* = false */)
     {
         QMutexLocker lock(&_mutex);
 
@@ -180,16 +299,7 @@ namespace Robomongo
         // robomongo shell timeout
         bool timeoutReached = false;
 
-        /*
-         * Replace all commands ('show dbs', 'use db' etc.) with call
-         * to shellHelper('show', 'dbs') and so on.
-         */
-        std::string stdstr(originalScript);
-
-        pcrecpp::RE re("^(show|use|set) (\\w+)$",
-            pcrecpp::RE_Options(PCRE_CASELESS|PCRE_MULTILINE|PCRE_NEWLINE_ANYCRLF));
-
-        re.GlobalReplace("shellHelper('\\1', '\\2');", &stdstr);
+        std::string const stdstr = replaceShellHelpers(originalScript);
 
         /*
          * Statementize (i.e. extract all JavaScript statements from script) and
@@ -206,60 +316,239 @@ namespace Robomongo
 
         use(dbName);
 
+        _interrupted = false;
         for (auto const& statement : statements) {
-            // clear global objects
-            __objects.clear();
-            __type = "";
-            __finished = false;
-            __logs.str("");
-
-            if (true /* ! wascmd */) {
-                try {
-                    bool failed = false;
-                    QElapsedTimer timer;
-                    timer.start();
-                    if ( _scope->exec( statement , "(shell)" , false , true , false, _timeoutSec * 1000) ) {
-                         _scope->exec( "__robomongoLastRes = __lastres__; shellPrintHelper( __lastres__ );", 
-                                      "(shell2)" , true , true , false, _timeoutSec * 1000);
-                    }
-                    else   // failed to run script 
-                        failed = true;                               
-
-                    qint64 elapsed = timer.elapsed();   // milliseconds 
-
-                    if (elapsed > _timeoutSec * 1000)
-                        timeoutReached = true;
-
-                    std::string logs = __logs.str();
-                    std::string answer = logs.c_str();
-                    std::string type = __type.c_str();
-
-                    if (failed && !timeoutReached)
-                        return MongoShellExecResult(true, answer);
-
-                    std::vector<MongoDocumentPtr> docs = MongoDocument::fromBsonObj(__objects);
-
-                    if (!answer.empty() || docs.size() > 0)
-                        results.push_back(
-                            prepareResult(type, answer, docs, elapsed, statement, aggrInfo)
-                        );
+            // Stopped by user, results of already executed statements are shown
+            if (_interrupted)
+                break;
+
+            if (!execStatement(statement, aggrInfo, profile, results, timeoutReached, error))
+                return MongoShellExecResult(true, error);
+        }
+
+        collectGarbage(jsHeapBytes());
+        return prepareExecResult(std::move(results), timeoutReached);
+    }
+
+    MongoShellExecResult ScriptEngine::execFile(const QString &filePath, const std::string &dbName,
+                                                const FileProgressHandler &onProgress)
+    {
+        QMutexLocker lock(&_mutex);
+
+        if (!_scope) {
+            _failedScope = true;
+            return MongoShellExecResult(true, "Connection error. Uninitialized mongo scope.");
+        }
+
+        // Pages of file are read by OS as statements are split, text is never loaded as a whole
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly))
+            return MongoShellExecResult(true, "Cannot open " + QtUtils::toStdString(filePath) + ": " +
+                                              QtUtils::toStdString(file.errorString()));
+
+        qint64 const size = file.size();
+        const char *const data = size > 0 ? reinterpret_cast<const char *>(file.map(0, size)) : "";
+        if (!data)
+            return MongoShellExecResult(true, "Cannot map " + QtUtils::toStdString(filePath) + ": " +
+                                              QtUtils::toStdString(file.errorString()));
+
+        pcrecpp::RE re("^(show|use|set) (\\w+)$",
+            pcrecpp::RE_Options(PCRE_CASELESS|PCRE_MULTILINE|PCRE_NEWLINE_ANYCRLF));
+
+        use(dbName);
+
+        bool timeoutReached = false;
+        std::vector<MongoShellResult> results;
+        long long executed = 0;
+        long long dropped = 0;
+        QElapsedTimer elapsed;
+        elapsed.start();
+        qint64 lastProgressMs = 0;
+
+        _interrupted = false;
+        qint64 offset = 0;
+        qint64 chunkBytes = FileChunkBytes;
+        while (offset < size && !_interrupted) {
+            // Chunk ends at line break, so that only the last statement of it may be cut
+            qint64 end = std::min(size, offset + chunkBytes);
+            if (end < size) {
+                qint64 lineEnd = end;
+                while (lineEnd > offset && data[lineEnd - 1] != '\n')
+                    --lineEnd;
+                if (lineEnd > offset)
+                    end = lineEnd;
+            }
+
+            bool const lastChunk = end == size;
+            std::string const chunk(data + offset, static_cast<size_t>(end - offset));
+            std::vector<std::pair<qint64, std::string>> statements;   // by byte offset in file
+            qint64 consumed = end - offset;
+
+            JsStatementSplitter::Ranges ranges;
+            bool const split = JsStatementSplitter::split(chunk, ranges);
+            if (split && (lastChunk || ranges.size() != 1)) {
+                // The last statement may continue in the next chunk (i.e. chained call on next
+                // line), it is split again from there
+                if (!lastChunk && !ranges.empty()) {
+                    consumed = ranges.back().first;
+                    ranges.pop_back();
                 }
-                catch (const std::exception &e) {
-                    std::cout << "error:" << e.what() << std::endl;
+
+                for (auto const& range : ranges) {
+                    std::string statement = chunk.substr(range.first, range.second - range.first);
+                    re.GlobalReplace("shellHelper('\\1', '\\2');", &statement);
+                    statements.emplace_back(offset + range.first, std::move(statement));
                 }
             }
+            else if (!lastChunk) {
+                // Statement is longer than chunk, or chunk was cut inside of it
+                chunkBytes *= 2;
+                continue;
+            }
+            else {
+                // The rest of file is left to esprima, as in exec()
+                std::string script = chunk;
+                re.GlobalReplace("shellHelper('\\1', '\\2');", &script);
+                std::vector<std::string> parsed;
+                std::string error;
+                if (!statementize(script, parsed, error) && parsed.empty())
+                    parsed.push_back("print(__robomongoResult.error)");
+                for (std::string &statement : parsed)
+                    statements.emplace_back(offset, std::move(statement));
+            }
+
+            for (auto const& statement : statements) {
+                if (_interrupted)
+                    break;
+
+                std::string error;
+                if (!execStatement(statement.second, AggrInfo(), false, results, timeoutReached, error)) {
+                    return MongoShellExecResult(true, "Statement at byte " + std::to_string(statement.first) +
+                                                      " of file failed:\n" + error);
+                }
+                ++executed;
+
+                // Output of millions of generated statements is not kept, only of the last ones
+                if (results.size() > MaxFileResults) {
+                    results.erase(results.begin());
+                    ++dropped;
+                }
+
+                if (onProgress && elapsed.elapsed() - lastProgressMs >= FileProgressIntervalMs) {
+                    lastProgressMs = elapsed.elapsed();
+                    onProgress(statement.first, size, executed);
+                }
+            }
+
+            offset += consumed;
+            chunkBytes = FileChunkBytes;
+            collectGarbage(jsHeapBytes());
+            if (onProgress)
+                onProgress(offset, size, executed);
         }
 
-        return prepareExecResult(results, timeoutReached);
+        std::string summary = (_interrupted ? "Stopped after " : "Executed ") + std::to_string(executed) +
+                              " statements of " + QtUtils::toStdString(filePath) + " (" +
+                              std::to_string(offset) + " of " + std::to_string(size) + " bytes)";
+        if (dropped > 0)
+            summary += ", output of the last " + std::to_string(results.size()) + " statements is shown";
+        results.insert(results.begin(), MongoShellResult("", summary + ".", std::vector<MongoDocumentPtr>(),
+                                                         MongoQueryInfo(), "", elapsed.elapsed()));
+
+        return prepareExecResult(std::move(results), timeoutReached);
+    }
+
+    bool ScriptEngine::execStatement(const std::string &statement, const AggrInfo &aggrInfo, bool profile,
+                                     std::vector<MongoShellResult> &results, bool &timeoutReached,
+                                     std::string &outError)
+    {
+        // clear global objects
+        __objects.clear();
+        __type = "";
+        __finished = false;
+        __logs.str("");
+
+        try {
+            bool failed = false;
+            QElapsedTimer timer;
+            timer.start();
+            if ( _scope->exec( statement , "(shell)" , false , true , false, _timeoutSec * 1000) ) {
+                 _scope->exec( "__robomongoLastRes = __lastres__; shellPrintHelper( __lastres__ );", 
+                              "(shell2)" , true , true , false, _timeoutSec * 1000);
+            }
+            else   // failed to run script 
+                failed = true;                               
+
+            qint64 elapsed = timer.elapsed();   // milliseconds 
+
+            // Allocation past heap limit fails with "out of memory", which script may even catch.
+            // Garbage of runtime is not reliably freed after that, so next script gets new scope.
+            if (failed && _scope->hasOutOfMemoryException()) {
+                _failedScope = true;
+                outError = "JavaScript heap limit of " + std::to_string(_jsHeapLimitMb) +
+                           " MB exceeded, statement was stopped. Shell is started again, variables of "
+                           "previous scripts are lost. Limit can be changed in Options > Preferences.";
+                return false;
+            }
+
+            if (elapsed > _timeoutSec * 1000)
+                timeoutReached = true;
+
+            std::string logs = __logs.str();
+            std::string answer = logs.c_str();
+            std::string type = __type.c_str();
+
+            if (failed && !timeoutReached) {
+                outError = answer;
+                return false;
+            }
+
+            // Buffers captured by shell print hook are handed over to documents without copying,
+            // documents past memory budget are moved to temporary file
+            std::vector<MongoDocumentPtr> docs = MongoDocument::fromBsonObj(
+                std::move(__objects), static_cast<long long>(_resultBudgetMb) * 1024 * 1024);
+
+            if (!answer.empty() || docs.size() > 0) {
+                // Heap before garbage of statement is collected, the closest to its peak we can read
+                long long const heapBytes = jsHeapBytes();
+                results.push_back(
+                    prepareResult(type, answer, std::move(docs), elapsed, statement, aggrInfo, profile)
+                );
+                results.back().setJsHeapBytes(heapBytes);
+            }
+        }
+        catch (const std::exception &e) {
+            std::cout << "error:" << e.what() << std::endl;
+        }
+        return true;
+    }
+
+    long long ScriptEngine::jsHeapBytes()
+    {
+        try {
+            if (!_scope->exec("__robomongoJsHeap = __robomongoJsHeapBytes();", "(jsHeap)",
+                              false, false, false))
+                return 0;
+            return static_cast<long long>(_scope->getNumber("__robomongoJsHeap"));
+        }
+        catch (const std::exception &) {
+            return 0;
+        }
+    }
+
+    void ScriptEngine::collectGarbage(long long heapBytes)
+    {
+        // Collection happens on thread of scope, at the next interrupt check
+        long long const limitBytes = _jsHeapLimitMb * 1024LL * 1024LL;
+        if (heapBytes * 100 > limitBytes * GcHeapPercent)
+            _scope->gc();
     }
 
     void ScriptEngine::interrupt()
     {
-        // This operation crash Robomongo
+        // MozJS kill() of running scope crashes Robomongo, so we only stop at the next statement
         // static_cast<mongo::mozjs::MozJSImplScope*>(_scope)->kill();
-
-        // v0.9
-        //mongo::Scope::_interruptFlag = true;
+        _interrupted = true;
     }
 
     void ScriptEngine::use(const std::string &dbName)
@@ -279,6 +568,29 @@ namespace Robomongo
         }
     }
 
+    void ScriptEngine::setReadPreference(const ReadPreferenceInfo &readPreference)
+    {
+        QMutexLocker lock(&_mutex);
+
+        if (!_scope || readPreference == _readPreference)
+            return;
+
+        _scope->exec(readPreference.shellStatement(), "(readPreference)", false, true, true);
+        _readPreference = readPreference;
+    }
+
+    void ScriptEngine::setMaxTimeMs(int maxTimeMs)
+    {
+        QMutexLocker lock(&_mutex);
+
+        if (!_scope || maxTimeMs == _maxTimeMs)
+            return;
+
+        _scope->exec("__robomongoMaxTimeMS = " + std::to_string(maxTimeMs) + ";", "(maxTimeMS)", 
+                     false, true, true);
+        _maxTimeMs = maxTimeMs;
+    }
+
     void ScriptEngine::setBatchSize(int batchSize)
     {
         QMutexLocker lock(&_mutex);
@@ -304,6 +616,13 @@ namespace Robomongo
         //    return;
 
         try {
+            // Collection names are listed again only after something could change them
+            unsigned long long const namesVersion = CollectionNamesVersion::current(_connection->uuid());
+            if (namesVersion != _collectionNamesVersion) {
+                invalidateDbCollectionsCache();
+                _collectionNamesVersion = namesVersion;
+            }
+
             if (mode == AutocompleteAll)
                 _scope->exec("DB.autocomplete = DB.autocompleteCached;", "", false, false, false);
             else if (mode == AutocompleteNoCollectionNames)
@@ -332,8 +651,9 @@ namespace Robomongo
     }
 
     MongoShellResult ScriptEngine::prepareResult(const std::string &type, const std::string &output,
-                                                 const std::vector<MongoDocumentPtr> &objects, qint64 elapsedms,
-                                                 const std::string &statement, AggrInfo aggrInfo /*= AggrInfo()*/)
+                                                 std::vector<MongoDocumentPtr> objects, qint64 elapsedms,
+                                                 const std::string &statement, AggrInfo aggrInfo /*= AggrInfo()*/,
+                                                 bool profile /* = false */)
     {
         const char *script =
             "__robomongoQuery = false; \n"
@@ -387,7 +707,10 @@ namespace Robomongo
 
             MongoQueryInfo const info{ CollectionInfo(serverAddress, dbName, collectionName),
                                        query, fields, limit, skip, batchSize, options, special };
-            return MongoShellResult(type, output, objects, info, statement, elapsedms);
+            MongoShellResult result(type, output, std::move(objects), info, statement, elapsedms);
+            if (profile)
+                result.setExplainInfo(explainLastResult());
+            return result;
         }
         else if (isAggregate) {
             std::string const serverAddress = getString("__robomongoServerAddress");
@@ -403,13 +726,84 @@ namespace Robomongo
             int const batchSize = aggrInfo.isValid ? aggrInfo.batchSize : 50;
             int const resultIndex = aggrInfo.isValid ? aggrInfo.resultIndex : -1;
 
-            AggrInfo const newAggrInfo { collectionName, skip, batchSize, origPipeline, options, resultIndex };
-            return MongoShellResult(type, output, objects, MongoQueryInfo(), statement, elapsedms, newAggrInfo);
+            AggrInfo const newAggrInfo { collectionName, skip, batchSize, origPipeline, options, resultIndex,
+                                         dbName };
+            MongoShellResult result(type, output, std::move(objects), MongoQueryInfo(), statement, elapsedms, newAggrInfo);
+            if (profile)
+                result.setExplainInfo(explainLastResult());
+            return result;
+        }
+        return MongoShellResult(type, output, std::move(objects), MongoQueryInfo(), statement, elapsedms);
+    }
+
+    ExplainInfo ScriptEngine::explainLastResult()
+    {
+        // Plans of sharded queries and aggregations are nested (per shard, per $cursor stage),
+        // so the whole explain document is walked. Rejected plans are not interesting.
+        const char *script =
+            "__robomongoExplainError = ''; \n"
+            "__robomongoExplainKeys = 0; __robomongoExplainDocs = 0; __robomongoExplainReturned = 0; \n"
+            "__robomongoExplainMs = 0; __robomongoExplainCollScan = false; __robomongoExplainIndexes = ''; \n"
+            "(function() { try { \n"
+            "    var explain = __robomongoIsAggregate ? \n"
+            "        db.getSiblingDB(__robomongoDbName).runCommand({ \n"
+            "            explain: { aggregate: __robomongoCollectionName, \n"
+            "                       pipeline: Array.isArray(__robomongoAggregatePipeline) ? \n"
+            "                           __robomongoAggregatePipeline : [__robomongoAggregatePipeline], \n"
+            "                       cursor: {} }, \n"
+            "            verbosity: 'executionStats' }) : \n"
+            "        __robomongoLastRes.clone().explain('executionStats'); \n"
+            "    if (explain.ok === 0) \n"
+            "        throw Error(explain.errmsg); \n"
+            "    var indexes = []; \n"
+            "    var visit = function(obj) { \n"
+            "        if (obj === null || typeof obj != 'object') \n"
+            "            return; \n"
+            "        if (obj.stage == 'COLLSCAN') \n"
+            "            __robomongoExplainCollScan = true; \n"
+            "        if (obj.stage == 'IXSCAN' && obj.indexName && indexes.indexOf(obj.indexName) < 0) \n"
+            "            indexes.push(obj.indexName); \n"
+            "        for (var key in obj) { \n"
+            "            var value = obj[key]; \n"
+            "            if (key == 'rejectedPlans') \n"
+            "                continue; \n"
+            "            if (key == 'executionStats' && value && value.totalDocsExamined !== undefined) { \n"
+            "                __robomongoExplainKeys += Number(value.totalKeysExamined); \n"
+            "                __robomongoExplainDocs += Number(value.totalDocsExamined); \n"
+            "                __robomongoExplainReturned += Number(value.nReturned); \n"
+            "                __robomongoExplainMs = Math.max(__robomongoExplainMs, Number(value.executionTimeMillis)); \n"
+            "            } \n"
+            "            visit(value); \n"
+            "        } \n"
+            "    }; \n"
+            "    visit(explain); \n"
+            "    __robomongoExplainIndexes = indexes.join(', '); \n"
+            "} catch (e) { \n"
+            "    __robomongoExplainError = '' + (e.message || e); \n"
+            "} })(); \n"
+            ;
+
+        ExplainInfo info;
+        try {
+            _scope->exec(script, "(explain)", false, false, false, _timeoutSec * 1000);
+            info.error = getString("__robomongoExplainError");
+            if (info.error.empty()) {
+                info.keysExamined = static_cast<long long>(_scope->getNumber("__robomongoExplainKeys"));
+                info.docsExamined = static_cast<long long>(_scope->getNumber("__robomongoExplainDocs"));
+                info.returned = static_cast<long long>(_scope->getNumber("__robomongoExplainReturned"));
+                info.serverMs = static_cast<long long>(_scope->getNumber("__robomongoExplainMs"));
+                info.collScan = _scope->getBoolean("__robomongoExplainCollScan");
+                info.indexes = getString("__robomongoExplainIndexes");
+            }
         }
-        return MongoShellResult(type, output, objects, MongoQueryInfo(), statement, elapsedms);
+        catch (const std::exception &ex) {
+            info.error = ex.what();
+        }
+        info.isValid = true;
+        return info;
     }
 
-    MongoShellExecResult ScriptEngine::prepareExecResult(const std::vector<MongoShellResult> &results, 
+    MongoShellExecResult ScriptEngine::prepareExecResult(std::vector<MongoShellResult> results, 
                                                          bool timeoutReached /* = false */)
     {
         const char *script =
@@ -432,7 +826,7 @@ namespace Robomongo
         std::string dbName = getString("__robomongoDbName");
         bool dbIsValid = _scope->getBoolean("__robomongoDbIsValid");
 
-        return MongoShellExecResult(results, serverName, serverIsValid, dbName, dbIsValid, timeoutReached);
+        return MongoShellExecResult(std::move(results), serverName, serverIsValid, dbName, dbIsValid, timeoutReached);
     }
 
     std::string ScriptEngine::getString(const char *fieldName)
@@ -443,6 +837,30 @@ namespace Robomongo
     bool ScriptEngine::statementize(
         const std::string &script, std::vector<std::string> &outVec, std::string &outError)
     {
+        // Native splitter handles most of scripts, esprima is used only for ambiguous ones
+        // Splitter only checks brackets, strings and comments. Whole script is compiled
+        // before its statements run, single statement reports its syntax error itself.
+        JsStatementSplitter::Ranges native;
+        if (JsStatementSplitter::split(script, native)) {
+            if (native.size() > 1 && !compiles(script, outError))
+                return false;
+
+            for (auto const& range : native)
+                outVec.push_back(script.substr(range.first, range.second - range.first));
+            return true;
+        }
+
+        QString const qScript = QtUtils::toQString(script);
+        {
+            QMutexLocker cacheLock(&_statementsCacheMutex);
+            if (StatementRanges const *cached = _statementsCache.object(qScript)) {
+                for (auto const& range : *cached)
+                    outVec.push_back(qScript.mid(range.first, range.second - range.first).toStdString());
+                return true;
+            }
+        }
+
+        loadEsprima();
         _scope->setString("__robomongoEsprima", script.c_str());
 
         mongo::StringData const data {
@@ -459,6 +877,9 @@ namespace Robomongo
             sendLog(this, LogEvent::RBM_ERROR, "ScriptEngine: Scope failed. Resetting scope.");
             _scope->reset();
             sendLog(this, LogEvent::RBM_INFO, "ScriptEngine: Scope reset complete.");
+            _isEsprimaLoaded = false;
+            loadEsprima();
+            _scope->setString("__robomongoEsprima", script.c_str());
             _scope->exec(data, "(esprima2)", false, true, false);
         }
 
@@ -468,6 +889,7 @@ namespace Robomongo
             return false;
         }
 
+        StatementRanges *ranges = new StatementRanges;
         for (auto const& bsonElem : obj.getField("result").Obj().getField("body").Array())
         {
             mongo::BSONObj const item = bsonElem.Obj();
@@ -475,22 +897,109 @@ namespace Robomongo
             auto const from = static_cast<int>(range.at(0).number());
             auto const till = static_cast<int>(range.at(1).number());
 
-            QString const qScript = QtUtils::toQString(script);
+            ranges->push_back(std::make_pair(from, till));
             std::string statement = qScript.mid(from, till - from).toStdString();
             outVec.push_back(statement);
         }
 
+        QMutexLocker cacheLock(&_statementsCacheMutex);
+        _statementsCache.insert(qScript, ranges);
         return true;
     }
 
+    bool ScriptEngine::compiles(const std::string &script, std::string &outError)
+    {
+        _scope->setString("__robomongoScript", script.c_str());
+
+        mongo::StringData const data {
+            "var __robomongoResult = {};"
+            "try {"
+                "new Function(__robomongoScript);"
+            "} catch(e) {"
+                "__robomongoResult.error = e.name + ': ' + e.message;"
+            "}"
+            "__robomongoResult;"
+        };
+
+        // Scope that cannot run the check leaves errors to statements, as before
+        if (!_scope->exec(data, "(syntax)", false, true, false))
+            return true;
+
+        mongo::BSONObj const obj = _scope->getObject("__lastres__");
+        if (!obj.hasField("error"))
+            return true;
+
+        outError = obj.getStringField("error");
+        return false;
+    }
+
+    std::string ScriptEngine::replaceShellHelpers(const std::string &script)
+    {
+        std::string result(script);
+
+        pcrecpp::RE re("^(show|use|set) (\\w+)$",
+            pcrecpp::RE_Options(PCRE_CASELESS|PCRE_MULTILINE|PCRE_NEWLINE_ANYCRLF));
+
+        re.GlobalReplace("shellHelper('\\1', '\\2');", &result);
+        return result;
+    }
+
+    std::unique_ptr<mongo::Scope> ScriptEngine::createParserScope()
+    {
+        std::unique_ptr<mongo::Scope> scope;
+        {
+            QMutexLocker lock(&scopeCreationMutex);
+
+            // Empty connection string, initScope() does not connect
+            mongo::shell_utils::dbConnect.clear();
+
+            mongo::ScriptEngine::setConnectCallback( mongo::shell_utils::onConnect );
+            mongo::ScriptEngine::setup();
+            mongo::getGlobalScriptEngine()->setScopeInitCallback(mongo::shell_utils::initScope);
+            mongo::getGlobalScriptEngine()->enableJIT(true);
+            mongo::getGlobalScriptEngine()->setJSHeapLimitMB(DefaultJsHeapLimitMb);
+
+            scope.reset(mongo::getGlobalScriptEngine()->newScope());
+        }
+
+        std::string const esprima = loadFile(":/robomongo/scripts/esprima.js", true);
+        scope->exec(esprima, "(esprima)", false, true, true);
+        return scope;
+    }
+
+    void ScriptEngine::cacheStatements(const std::string &script, const StatementRanges &ranges)
+    {
+        QMutexLocker cacheLock(&_statementsCacheMutex);
+        _statementsCache.insert(QtUtils::toQString(script), new StatementRanges(ranges));
+    }
+
     void ScriptEngine::invalidateDbCollectionsCache() {
         if (!_initialized)
             return;
 
-        _scope->exec("__robomongoAutocompletionCache = null;", "", false, false, false);
+        _scope->exec("__robomongoAutocompletionCache = {};", "", false, false, false);
+    }
+
+    void ScriptEngine::loadEsprima()
+    {
+        if (_isEsprimaLoaded)
+            return;
+
+        std::string const esprima = loadFile(":/robomongo/scripts/esprima.js", true);
+        _scope->exec(esprima, "(esprima)", false, true, true);
+        _isEsprimaLoaded = true;
     }
 
     std::string ScriptEngine::loadFile(const QString &path, bool throwOnError) {
+        // Every worker has its own JavaScript runtime, so only the source can be shared
+        static QMutex mutex;
+        static std::map<QString, std::string> contents;
+
+        QMutexLocker lock(&mutex);
+        auto const cached = contents.find(path);
+        if (cached != contents.end())
+            return cached->second;
+
         QFile file(path);
         if (!file.open(QIODevice::ReadOnly)) {
             if (throwOnError)
@@ -501,7 +1010,7 @@ namespace Robomongo
 
         QTextStream in(&file);
         QString content = in.readAll();
-        return QtUtils::toStdString(content);
+        return contents[path] = QtUtils::toStdString(content);
     }
 }
 
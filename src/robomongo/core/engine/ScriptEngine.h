@@ -1,7 +1,10 @@
 #pragma once
 
 #include <QObject>
+#include <QCache>
 #include <QMutex>
+#include <atomic>
+#include <functional>
 #include <mongo/scripting/engine.h>
 //#include <third_party/js-1.7/jsparse.h>
 
@@ -17,15 +20,76 @@ namespace Robomongo
         Q_OBJECT
 
     public:
-        ScriptEngine(ConnectionSettings *connection, int timeoutSec);
+        // [from, till) positions (in UTF-16 code units) of statements of script
+        typedef std::vector<std::pair<int, int>> StatementRanges;
+
+        // Heap limit of MozJS runtime, when none is given (as jsHeapLimitMB of MongoDB)
+        static constexpr int DefaultJsHeapLimitMb = 1100;
+
+        /**
+         * @param resultBudgetMb Memory (in megabytes) that documents of one statement result may
+         *        occupy, documents past it are moved to temporary file. 0 means no limit
+         * @param jsHeapLimitMb JavaScript heap (in megabytes) of shell scope. Statement, which
+         *        allocates past it, fails and scope is created again. 0 means DefaultJsHeapLimitMb
+         * @param scopePoolSize Number of scopes init() prepares for next shells of the same
+         *        connection, see ScopePool
+         */
+        ScriptEngine(ConnectionSettings *connection, int timeoutSec, int resultBudgetMb,
+                     int jsHeapLimitMb, int scopePoolSize = 0);
         ~ScriptEngine();
 
         void init(bool isLoadMongoJs, const std::string& serverAddr = "", const std::string& dbName = "");
+
+        /**
+         * @brief Key of connection in ScopePool, set by init(). Owner evicts it when shell
+         *        of connection is no longer needed.
+         */
+        const std::string &scopePoolKey() const { return _scopePoolKey; }
+        /**
+         * @param profile If true, find/aggregate statements are also explained with 
+         *        "executionStats" verbosity (i.e. run second time), see MongoShellResult::explainInfo()
+         */
         MongoShellExecResult exec(const std::string &script, const std::string &dbName = std::string(),
-                                  AggrInfo aggrInfo = AggrInfo());
+                                  AggrInfo aggrInfo = AggrInfo(), bool profile = false);
+
+        /**
+         * @brief Progress of execFile(): bytes of file done, size of file, statements executed
+         */
+        typedef std::function<void(qint64 done, qint64 total, long long statements)> FileProgressHandler;
+
+        /**
+         * @brief Runs script file without reading it into memory as a whole: file is mapped and
+         *        split into statements chunk by chunk, which are run as they come. Output of
+         *        the last MaxFileResults statements is kept, after summary of the run.
+         */
+        MongoShellExecResult execFile(const QString &filePath, const std::string &dbName,
+                                      const FileProgressHandler &onProgress);
+
+        /**
+         * @brief Stops exec() before its next statement. Statement which is running now is
+         *        stopped by killing its server operations, see MongoWorker::handle(KillOperationsRequest*)
+         * @threadsafe
+         */
         void interrupt();
 
+        /**
+         * @brief Address of shell connection, as seen by server (i.e. "client" field of currentOp)
+         */
+        const std::string &clientAddress() const { return _clientAddress; }
+
         void use(const std::string &dbName);
+
+        /**
+         * @brief Sets read preference of shell connection, if it differs from the one set
+         *        before. Kept until the next call, as if set by user's own script.
+         */
+        void setReadPreference(const ReadPreferenceInfo &readPreference);
+
+        /**
+         * @brief Sets server time limit (maxTimeMS) of finds and aggregations of scripts,
+         *        which have no limit of their own. 0 for no limit.
+         */
+        void setMaxTimeMs(int maxTimeMs);
         void setBatchSize(int batchSize);
         void ping();
         QStringList complete(const std::string &prefix, const AutocompletionMode mode);
@@ -36,26 +100,104 @@ namespace Robomongo
 
         void changeTimeout(int newTimeout) { _timeoutSec = newTimeout; }
 
+        /**
+         * @brief Replaces shell commands ('show dbs', 'use db' etc.) with calls of
+         *        shellHelper('show', 'dbs'), as exec() does before script is split
+         */
+        static std::string replaceShellHelpers(const std::string &script);
+
+        /**
+         * @brief New scope without connection, with esprima loaded, for parsing only
+         * @throws std::exception
+         */
+        static std::unique_ptr<mongo::Scope> createParserScope();
+
+        /**
+         * @brief Statement ranges of script (after replaceShellHelpers()), parsed elsewhere,
+         *        so that exec() of the same script does not parse it again
+         */
+        static void cacheStatements(const std::string &script, const StatementRanges &ranges);
+
     private:
         ConnectionSettings *_connection;
 
         MongoShellResult prepareResult(const std::string &type, const std::string &output, 
-                                       const std::vector<MongoDocumentPtr> &objects, qint64 elapsedms,
-                                       const std::string &statement, AggrInfo aggrInfo = AggrInfo());
+                                       std::vector<MongoDocumentPtr> objects, qint64 elapsedms,
+                                       const std::string &statement, AggrInfo aggrInfo = AggrInfo(),
+                                       bool profile = false);
+
+        // Explains __robomongoLastRes, after it was recognized as query or aggregation by prepareResult()
+        ExplainInfo explainLastResult();
 
         MongoShellExecResult prepareExecResult(
-            const std::vector<MongoShellResult> &results, bool timeoutReached = false);
+            std::vector<MongoShellResult> results, bool timeoutReached = false);
+
+        /**
+         * @brief New scope connected with 'dbConnect' script, with rc files and Robomongo
+         *        helpers loaded. Called by init() and by ScopePool threads.
+         * @throws std::exception
+         */
+        static std::unique_ptr<mongo::Scope> createScope(const std::string &dbConnect, bool isLoadMongoRcJs,
+                                                         int jsHeapLimitMb);
+
+        // Bytes allocated by JavaScript heap of _scope, live or not yet collected. 0 if unknown
+        long long jsHeapBytes();
+
+        // Requests garbage collection, when heap left by script is over GcHeapPercent of limit,
+        // so that next script starts with memory of this one returned
+        void collectGarbage(long long heapBytes);
 
-        std::string loadFile(const QString &path, bool throwOnError);
+        // Contents of bundled scripts are read once per process, see loadFile()
+        static std::string loadFile(const QString &path, bool throwOnError);
+
+        // Esprima is evaluated in scope only for the first script, which native
+        // statement splitter cannot handle
+        void loadEsprima();
         std::string getString(const char *fieldName);
         bool statementize(
             const std::string &script, std::vector<std::string> &outVec, std::string &outError);
 
+        /**
+         * @brief Compiles script as body of function, without running it, so that script
+         *        split by native splitter does not run its first statements when a later one
+         *        is invalid
+         * @return false with syntax error in 'outError' (and in __robomongoResult.error)
+         */
+        bool compiles(const std::string &script, std::string &outError);
+
+        /**
+         * @brief Runs one statement of exec() or execFile() and appends its result, if any
+         * @return false if statement failed, with shell output in 'outError'
+         */
+        bool execStatement(const std::string &statement, const AggrInfo &aggrInfo, bool profile,
+                           std::vector<MongoShellResult> &results, bool &timeoutReached,
+                           std::string &outError);
+
+        static constexpr qint64 FileChunkBytes = 1024 * 1024;
+        static constexpr size_t MaxFileResults = 100;
+        static constexpr qint64 FileProgressIntervalMs = 250;
+        static constexpr int GcHeapPercent = 50;
+
         int _timeoutSec;
+        int _resultBudgetMb;
+        int _jsHeapLimitMb;
+        int _scopePoolSize;
+        std::string _scopePoolKey;
         mongo::ScriptEngine *_engine;
         std::unique_ptr<mongo::Scope> _scope; // MozJSProxyScope
         bool _failedScope = false;
+        bool _isEsprimaLoaded = false;
+        std::atomic<bool> _interrupted { false };
+        std::string _clientAddress;
+        ReadPreferenceInfo _readPreference;     // of _scope, Default after init()
+        int _maxTimeMs = 0;                     // of _scope, 0 after init()
         QMutex _mutex;
         bool _initialized;
+        unsigned long long _collectionNamesVersion = 0;    // of autocompletion cache, see complete()
+
+        // Script -> statement ranges found by esprima, for recently executed scripts. Shared by
+        // engines of all shells, so that script replayed from history in new tab is not parsed again.
+        static QCache<QString, StatementRanges> _statementsCache;
+        static QMutex _statementsCacheMutex;
     };
 }
@@ -0,0 +1,114 @@
+#include "robomongo/core/engine/SyntaxChecker.h"
+
+#include <algorithm>
+#include <thread>
+#include <mongo/scripting/engine.h>
+
+#include "robomongo/core/engine/JsStatementSplitter.h"
+#include "robomongo/core/engine/ScriptEngine.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/Logger.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    SyntaxChecker &SyntaxChecker::instance()
+    {
+        // Never destroyed: checker thread waits for scripts until application exits
+        static SyntaxChecker *checker = new SyntaxChecker;
+        return *checker;
+    }
+
+    void SyntaxChecker::check(QObject *requester, int revision, const QString &script)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pending[requester] = Request { revision, script };
+
+            // Scope is created in checker thread on the first check, not at startup
+            if (!_started) {
+                _started = true;
+                std::thread(&SyntaxChecker::run, this).detach();
+            }
+        }
+        _requested.notify_one();
+    }
+
+    void SyntaxChecker::cancel(QObject *requester)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pending.erase(requester);
+    }
+
+    void SyntaxChecker::run()
+    {
+        try {
+            _scope = ScriptEngine::createParserScope();
+        }
+        catch (const std::exception &ex) {
+            sendLog(this, LogEvent::RBM_ERROR, std::string("SyntaxChecker: cannot create scope: ") + ex.what());
+            return;
+        }
+
+        for (;;) {
+            QObject *requester = nullptr;
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _requested.wait(lock, [this] { return !_pending.empty(); });
+                auto const it = _pending.begin();
+                requester = it->first;
+                request = it->second;
+                _pending.erase(it);
+            }
+
+            QString error;
+            int line = 0, column = 0;
+            if (parse(request.script, error, line, column))
+                emit checked(requester, request.revision, error, line, column);
+        }
+    }
+
+    bool SyntaxChecker::parse(const QString &text, QString &error, int &line, int &column)
+    {
+        std::string const script = ScriptEngine::replaceShellHelpers(QtUtils::toStdString(text));
+        _scope->setString("__robomongoSyntax", script.c_str());
+
+        mongo::StringData const data {
+            "var __robomongoSyntaxResult = {};"
+            "try {"
+                "__robomongoSyntaxResult.ranges = esprima.parse(__robomongoSyntax, { range: true }).body"
+                    ".map(function(statement) { return statement.range; });"
+            "} catch(e) {"
+                "__robomongoSyntaxResult.error = e.description || (e.name + ': ' + e.message);"
+                "__robomongoSyntaxResult.line = e.lineNumber || 1;"
+                "__robomongoSyntaxResult.column = e.column || 1;"
+            "}"
+            "__robomongoSyntaxResult;"
+        };
+
+        if (!_scope->exec(data, "(syntax)", false, true, false))
+            return false;
+
+        mongo::BSONObj const obj = _scope->getObject("__lastres__");
+        if (obj.hasField("error")) {
+            error = QtUtils::toQString(obj.getStringField("error"));
+            line = std::max(0, obj["line"].numberInt() - 1);
+            column = std::max(0, obj["column"].numberInt() - 1);
+            return true;
+        }
+
+        // Scripts split natively are never looked up in cache of ScriptEngine
+        JsStatementSplitter::Ranges native;
+        if (!JsStatementSplitter::split(script, native)) {
+            ScriptEngine::StatementRanges ranges;
+            for (auto const &elem : obj.getField("ranges").Array()) {
+                std::vector<mongo::BSONElement> const range = elem.Array();
+                ranges.push_back(std::make_pair(static_cast<int>(range.at(0).number()),
+                                                static_cast<int>(range.at(1).number())));
+            }
+            ScriptEngine::cacheStatements(script, ranges);
+        }
+        return true;
+    }
+}
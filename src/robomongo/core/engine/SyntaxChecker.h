@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <QObject>
+#include <QString>
+
+namespace mongo
+{
+    class Scope;
+}
+
+namespace Robomongo
+{
+    /**
+     * @brief Checks syntax of scripts being edited with esprima, in its own scope and thread,
+     *        so that workers of shells are not busy while user types. Only the latest script
+     *        of every requester is checked. Statement ranges of scripts, which native splitter
+     *        cannot handle, are cached for ScriptEngine::exec() of the same script.
+     * @threadsafe
+     */
+    class SyntaxChecker : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        static SyntaxChecker &instance();
+
+        // checked() is emitted for this revision, unless newer script of requester comes first
+        void check(QObject *requester, int revision, const QString &script);
+
+        // Pending script of requester is dropped, i.e. when requester is deleted
+        void cancel(QObject *requester);
+
+    Q_SIGNALS:
+        /**
+         * @brief Emitted in checker thread
+         * @param error Empty, if script is valid
+         * @param line, column Zero-based position of error, column in UTF-16 code units
+         */
+        void checked(QObject *requester, int revision, const QString &error, int line, int column);
+
+    private:
+        struct Request
+        {
+            int revision;
+            QString script;
+        };
+
+        SyntaxChecker() {}
+        void run();
+
+        /**
+         * @return false if script could not be checked
+         */
+        bool parse(const QString &script, QString &error, int &line, int &column);
+
+        std::mutex _mutex;
+        std::condition_variable _requested;
+        std::map<QObject *, Request> _pending;
+        bool _started = false;
+        std::unique_ptr<mongo::Scope> _scope;   // used by checker thread only
+    };
+}
@@ -10,13 +10,22 @@ namespace Robomongo
     R_REGISTER_EVENT(RefreshReplicaSetFolderResponse)
     R_REGISTER_EVENT(ReplicaSetFolderLoading)
     R_REGISTER_EVENT(ReplicaSetFolderRefreshed)
+    R_REGISTER_EVENT(PingServerRequest)
+    R_REGISTER_EVENT(PingServerResponse)
     R_REGISTER_EVENT(LoadDatabaseNamesRequest)
     R_REGISTER_EVENT(LoadDatabaseNamesResponse)
     R_REGISTER_EVENT(LoadCollectionNamesRequest)
+    R_REGISTER_EVENT(LoadDatabaseMetadataRequest)
     R_REGISTER_EVENT(LoadCollectionNamesResponse)
+    R_REGISTER_EVENT(LoadCollectionStatsRequest)
+    R_REGISTER_EVENT(LoadCollectionStatsResponse)
     R_REGISTER_EVENT(LoadUsersRequest)
     R_REGISTER_EVENT(LoadCollectionIndexesRequest)
     R_REGISTER_EVENT(LoadCollectionIndexesResponse)
+    R_REGISTER_EVENT(PrefetchCollectionRequest)
+    R_REGISTER_EVENT(PrefetchCollectionResponse)
+    R_REGISTER_EVENT(LoadIndexUsageRequest)
+    R_REGISTER_EVENT(LoadIndexUsageResponse)
     R_REGISTER_EVENT(AddEditIndexRequest)
     R_REGISTER_EVENT(AddEditIndexResponse)
     R_REGISTER_EVENT(DropCollectionIndexRequest)
@@ -25,14 +34,58 @@ namespace Robomongo
     R_REGISTER_EVENT(LoadFunctionsRequest)
     R_REGISTER_EVENT(LoadFunctionsResponse)
     R_REGISTER_EVENT(ConnectingEvent)
+    R_REGISTER_EVENT(ConnectionStartupEvent)
     R_REGISTER_EVENT(ConnectionFailedEvent)
     R_REGISTER_EVENT(ConnectionEstablishedEvent)
     R_REGISTER_EVENT(DatabaseListLoadedEvent)
     R_REGISTER_EVENT(OpeningShellEvent)
     R_REGISTER_EVENT(ExecuteQueryRequest)
     R_REGISTER_EVENT(ExecuteQueryResponse)
+    R_REGISTER_EVENT(CountDocumentsRequest)
+    R_REGISTER_EVENT(CountDocumentsResponse)
+    R_REGISTER_EVENT(SampleSchemaRequest)
+    R_REGISTER_EVENT(SampleSchemaResponse)
+    R_REGISTER_EVENT(ExportDocumentsRequest)
+    R_REGISTER_EVENT(ExportProgressEvent)
+    R_REGISTER_EVENT(ExportDocumentsResponse)
+    R_REGISTER_EVENT(ImportDocumentsRequest)
+    R_REGISTER_EVENT(ImportProgressEvent)
+    R_REGISTER_EVENT(ImportDocumentsResponse)
+    R_REGISTER_EVENT(DatabaseStatsRequest)
+    R_REGISTER_EVENT(DatabaseStatsProgressEvent)
+    R_REGISTER_EVENT(DatabaseStatsResponse)
+    R_REGISTER_EVENT(DatabaseSearchRequest)
+    R_REGISTER_EVENT(DatabaseSearchProgressEvent)
+    R_REGISTER_EVENT(DatabaseSearchResponse)
+    R_REGISTER_EVENT(CollectionMaintenanceRequest)
+    R_REGISTER_EVENT(CollectionMaintenanceProgressEvent)
+    R_REGISTER_EVENT(CollectionMaintenanceResponse)
+    R_REGISTER_EVENT(AnalyzeSchemaRequest)
+    R_REGISTER_EVENT(AnalyzeSchemaProgressEvent)
+    R_REGISTER_EVENT(AnalyzeSchemaResponse)
+    R_REGISTER_EVENT(DocumentSizesRequest)
+    R_REGISTER_EVENT(DocumentSizesResponse)
+    R_REGISTER_EVENT(CompareCollectionsRequest)
+    R_REGISTER_EVENT(CompareCollectionsProgressEvent)
+    R_REGISTER_EVENT(CompareCollectionsResponse)
+    R_REGISTER_EVENT(GenerateDataRequest)
+    R_REGISTER_EVENT(GenerateDataProgressEvent)
+    R_REGISTER_EVENT(GenerateDataResponse)
+    R_REGISTER_EVENT(ReplayWorkloadRequest)
+    R_REGISTER_EVENT(ReplayWorkloadProgressEvent)
+    R_REGISTER_EVENT(ReplayWorkloadResponse)
+    R_REGISTER_EVENT(ThrottledWriteRequest)
+    R_REGISTER_EVENT(ThrottledWriteProgressEvent)
+    R_REGISTER_EVENT(ThrottledWriteResponse)
+    R_REGISTER_EVENT(CommitChangesetRequest)
+    R_REGISTER_EVENT(CommitChangesetResponse)
     R_REGISTER_EVENT(DocumentListLoadedEvent)
+    R_REGISTER_EVENT(DocumentsCountedEvent)
+    R_REGISTER_EVENT(PagePrefetchedEvent)
+    R_REGISTER_EVENT(DocumentsChangedEvent)
     R_REGISTER_EVENT(ExecuteScriptRequest)
+    R_REGISTER_EVENT(ExecuteScriptFileRequest)
+    R_REGISTER_EVENT(ExecuteScriptFileProgressEvent)
     R_REGISTER_EVENT(ExecuteScriptResponse)
     R_REGISTER_EVENT(AutocompleteRequest)
     R_REGISTER_EVENT(AutocompleteResponse)
@@ -40,8 +93,12 @@ namespace Robomongo
     R_REGISTER_EVENT(ScriptExecutingEvent)
     R_REGISTER_EVENT(InsertDocumentRequest)
     R_REGISTER_EVENT(InsertDocumentResponse)
+    R_REGISTER_EVENT(InsertDocumentsRequest)
+    R_REGISTER_EVENT(InsertDocumentsResponse)
     R_REGISTER_EVENT(RemoveDocumentRequest)
     R_REGISTER_EVENT(RemoveDocumentResponse)
+    R_REGISTER_EVENT(RemoveDocumentsByIdRequest)
+    R_REGISTER_EVENT(RemoveDocumentsByIdResponse)
     R_REGISTER_EVENT(CreateDatabaseRequest)
     R_REGISTER_EVENT(CreateDatabaseResponse)
     R_REGISTER_EVENT(DropDatabaseRequest)
@@ -55,6 +112,7 @@ namespace Robomongo
     R_REGISTER_EVENT(DuplicateCollectionRequest)
     R_REGISTER_EVENT(DuplicateCollectionResponse)
     R_REGISTER_EVENT(CopyCollectionToDiffServerRequest)
+    R_REGISTER_EVENT(CopyCollectionProgressEvent)
     R_REGISTER_EVENT(CopyCollectionToDiffServerResponse)
     R_REGISTER_EVENT(CreateUserRequest)
     R_REGISTER_EVENT(CreateUserResponse)
@@ -71,5 +129,48 @@ namespace Robomongo
     R_REGISTER_EVENT(ListenSshConnectionResponse)
     R_REGISTER_EVENT(LogEvent)
     R_REGISTER_EVENT(StopScriptRequest)
+    R_REGISTER_EVENT(KillOperationsRequest)
+    R_REGISTER_EVENT(KillOperationsResponse)
+    R_REGISTER_EVENT(CurrentOpsRequest)
+    R_REGISTER_EVENT(CurrentOpsResponse)
+    R_REGISTER_EVENT(KillOpRequest)
+    R_REGISTER_EVENT(KillOpResponse)
+    R_REGISTER_EVENT(ServerStatusRequest)
+    R_REGISTER_EVENT(ServerStatusResponse)
+    R_REGISTER_EVENT(ProfileSummaryRequest)
+    R_REGISTER_EVENT(ProfileSummaryResponse)
+    R_REGISTER_EVENT(PlanCacheRequest)
+    R_REGISTER_EVENT(PlanCacheResponse)
+    R_REGISTER_EVENT(ShardDistributionRequest)
+    R_REGISTER_EVENT(ShardDistributionResponse)
+    R_REGISTER_EVENT(GridFsFilesRequest)
+    R_REGISTER_EVENT(GridFsFilesResponse)
+    R_REGISTER_EVENT(GridFsTransferRequest)
+    R_REGISTER_EVENT(GridFsTransferProgressEvent)
+    R_REGISTER_EVENT(GridFsTransferResponse)
+    R_REGISTER_EVENT(ExplainRequest)
+    R_REGISTER_EVENT(ExplainResponse)
+    R_REGISTER_EVENT(RollingIndexBuildRequest)
+    R_REGISTER_EVENT(RollingIndexBuildProgressEvent)
+    R_REGISTER_EVENT(RollingIndexBuildResponse)
+    R_REGISTER_EVENT(ShardFanoutRequest)
+    R_REGISTER_EVENT(ShardFanoutResponse)
+    R_REGISTER_EVENT(AggregatePageRequest)
+    R_REGISTER_EVENT(AggregatePageResponse)
+    R_REGISTER_EVENT(PipelinePreviewRequest)
+    R_REGISTER_EVENT(PipelinePreviewResponse)
+    R_REGISTER_EVENT(FieldDistributionRequest)
+    R_REGISTER_EVENT(FieldDistributionResponse)
+    R_REGISTER_EVENT(FieldBucketsRequest)
+    R_REGISTER_EVENT(FieldBucketsResponse)
+    R_REGISTER_EVENT(WatchNamespaceChangesRequest)
+    R_REGISTER_EVENT(NamespaceChangesEvent)
+    R_REGISTER_EVENT(WatchNamespaceChangesResponse)
+    R_REGISTER_EVENT(TailOplogRequest)
+    R_REGISTER_EVENT(OplogEntriesEvent)
+    R_REGISTER_EVENT(TailOplogResponse)
+    R_REGISTER_EVENT(WatchCollectionRequest)
+    R_REGISTER_EVENT(ChangeEventsEvent)
+    R_REGISTER_EVENT(WatchCollectionResponse)
     R_REGISTER_EVENT(OperationFailedEvent)
 }
@@ -4,6 +4,8 @@
 #include <QString>
 #include <QStringList>
 #include <QEvent>
+#include <atomic>
+#include <memory>
 #include <mongo/client/dbclient_base.h>
 
 #include "robomongo/core/domain/MongoShellResult.h"
@@ -12,6 +14,28 @@
 #include "robomongo/core/domain/MongoFunction.h"
 #include "robomongo/core/events/MongoEventsInfo.h"
 #include "robomongo/core/domain/MongoAggregateInfo.h"
+#include "robomongo/core/domain/MongoNamespace.h"
+#include "robomongo/core/domain/CollectionSchema.h"
+#include "robomongo/core/domain/DocumentSizeHistogram.h"
+#include "robomongo/core/domain/CollectionComparison.h"
+#include "robomongo/core/domain/CollectionMaintenance.h"
+#include "robomongo/core/domain/DatabaseSearch.h"
+#include "robomongo/core/domain/TableChangeset.h"
+#include "robomongo/core/domain/SchemaAnalyzer.h"
+#include "robomongo/core/domain/WorkloadReplay.h"
+#include "robomongo/core/utils/LatencyHistogram.h"
+#include "robomongo/core/domain/ExplainPlan.h"
+#include "robomongo/core/domain/PipelinePreview.h"
+#include "robomongo/core/domain/FieldBuckets.h"
+#include "robomongo/core/domain/FieldDistribution.h"
+#include "robomongo/core/domain/GridFs.h"
+#include "robomongo/core/domain/ShardDistribution.h"
+#include "robomongo/core/domain/ShardFanout.h"
+#include "robomongo/core/domain/NamespaceChanges.h"
+#include "robomongo/core/domain/OplogTail.h"
+#include "robomongo/core/domain/ChangeStreamWatch.h"
+#include "robomongo/core/utils/ExportWriter.h"
+#include "robomongo/core/utils/ImportReader.h"
 #include "robomongo/core/Event.h"
 #include "robomongo/core/Enums.h"
 #include "robomongo/core/mongodb/ReplicaSet.h"
@@ -24,6 +48,7 @@ namespace Robomongo
     class MongoWorker;
     class ConnectionSettings;
     class SshTunnelWorker;
+    struct NativeQuery;
 
     /**
      * @brief EstablishConnection
@@ -93,10 +118,16 @@ namespace Robomongo
     {
         R_EVENT
 
-        RefreshReplicaSetFolderRequest(QObject *sender, bool expanded) :
-            Event(sender), expanded(expanded) {}
+        RefreshReplicaSetFolderRequest(QObject *sender, bool expanded, bool monitor = false) :
+            Event(sender), expanded(expanded), monitor(monitor) {}
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        // Polls of topology monitor do not pile up behind a slow one
+        std::string coalescingKey() const override { return monitor ? "replicaSetMonitor" : std::string(); }
 
         bool const expanded = false;
+        bool const monitor = false;     // sent by topology monitor of MongoServer, not by user
     };
 
     struct RefreshReplicaSetFolderResponse : public Event
@@ -104,16 +135,18 @@ namespace Robomongo
         R_EVENT
 
         // Primary is reachable
-        RefreshReplicaSetFolderResponse(QObject *sender, ReplicaSet const& replicaSet, bool expanded) :
-            Event(sender), replicaSet(replicaSet), expanded(expanded) {}
+        RefreshReplicaSetFolderResponse(QObject *sender, ReplicaSet const& replicaSet, bool expanded,
+                                        bool monitor = false) :
+            Event(sender), replicaSet(replicaSet), expanded(expanded), monitor(monitor) {}
         
         // Primary is unreachable, secondary(ies) might be reachable
         RefreshReplicaSetFolderResponse(QObject *sender, ReplicaSet const&  replicaSet, bool expanded,
-                                        const EventError &error) :
-            Event(sender, error), replicaSet(replicaSet), expanded(expanded) {}
+                                        const EventError &error, bool monitor = false) :
+            Event(sender, error), replicaSet(replicaSet), expanded(expanded), monitor(monitor) {}
 
         ReplicaSet const replicaSet;
         bool const expanded = false;
+        bool const monitor = false;
     };
 
     struct ReplicaSetFolderLoading : public Event
@@ -142,6 +175,34 @@ namespace Robomongo
         bool const expanded = false;
     };
 
+    /**
+     * @brief Health check of server, sent periodically by MongoServer to its metadata worker
+     */
+
+    class PingServerRequest : public Event
+    {
+        R_EVENT
+
+        PingServerRequest(QObject *sender) :
+            Event(sender) {}
+
+        EventPriority priority() const override { return EventPriority::Background; }
+        std::string coalescingKey() const override { return "ping"; }
+    };
+
+    class PingServerResponse : public Event
+    {
+        R_EVENT
+
+        PingServerResponse(QObject *sender, double rttMs) :
+            Event(sender), rttMs(rttMs) {}
+
+        PingServerResponse(QObject *sender, const EventError &error) :
+            Event(sender, error) {}
+
+        double const rttMs = 0;
+    };
+
     /**
      * @brief LoadDatabaseNames
      */
@@ -152,6 +213,8 @@ namespace Robomongo
 
         LoadDatabaseNamesRequest(QObject *sender) :
             Event(sender) {}
+
+        std::string coalescingKey() const override { return "databases"; }
     };
 
     class LoadDatabaseNamesResponse : public Event
@@ -178,14 +241,25 @@ namespace Robomongo
         R_EVENT
 
     public:
-        LoadCollectionNamesRequest(QObject *sender, const std::string &databaseName) :
+        /**
+         * @param nameFilter If not empty, only collections with names containing it
+         *        (case insensitive) are listed
+         */
+        LoadCollectionNamesRequest(QObject *sender, const std::string &databaseName,
+                                   const std::string &nameFilter = std::string()) :
             Event(sender),
-            _databaseName(databaseName) {}
+            _databaseName(databaseName),
+            _nameFilter(nameFilter) {}
 
         std::string databaseName() const { return _databaseName; }
+        std::string nameFilter() const { return _nameFilter; }
+
+        // Filtered load is not dropped behind unfiltered one (or one of other filter)
+        std::string coalescingKey() const override { return _databaseName + '\0' + _nameFilter; }
 
     private:
         std::string _databaseName;
+        std::string _nameFilter;
     };
 
     class LoadCollectionNamesResponse : public Event
@@ -194,16 +268,109 @@ namespace Robomongo
 
     public:
         LoadCollectionNamesResponse(QObject *sender, const std::string &databaseName,
-                                    const std::vector<MongoCollectionInfo> &collectionInfos) :
+                                    const std::vector<MongoCollectionInfo> &collectionInfos,
+                                    int batchIndex = 0, bool lastBatch = true) :
             Event(sender),
             _databaseName(databaseName),
-            _collectionInfos(collectionInfos) { }
+            _collectionInfos(collectionInfos),
+            _batchIndex(batchIndex),
+            _lastBatch(lastBatch) { }
 
         LoadCollectionNamesResponse(QObject *sender, const EventError &error) :
             Event(sender, error) {}
 
         std::string databaseName() const { return _databaseName; }
-        std::vector<MongoCollectionInfo> collectionInfos() const { return _collectionInfos; }
+        std::vector<MongoCollectionInfo> const& collectionInfos() const { return _collectionInfos; }
+
+        // Collections are streamed one listCollections batch per response. First batch (index 0)
+        // replaces previously loaded collections, every next batch is appended to them.
+        int batchIndex() const { return _batchIndex; }
+        bool isLastBatch() const { return _lastBatch; }
+
+    private:
+        std::string _databaseName;
+        std::vector<MongoCollectionInfo> _collectionInfos;
+        int _batchIndex = 0;
+        bool _lastBatch = true;
+    };
+
+    /**
+     * @brief Collection names, users and functions of database at once, when database is
+     *        expanded in explorer. They are read in parallel on pooled connections of worker
+     *        and replied as LoadCollectionNamesResponse, LoadUsersResponse and
+     *        LoadFunctionsResponse, the same ones as replies to separate requests.
+     */
+    class LoadDatabaseMetadataRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        LoadDatabaseMetadataRequest(QObject *sender, const std::string &databaseName,
+                                    const std::string &nameFilter = std::string()) :
+            Event(sender),
+            _databaseName(databaseName),
+            _nameFilter(nameFilter) {}
+
+        std::string databaseName() const { return _databaseName; }
+        std::string nameFilter() const { return _nameFilter; }  // see LoadCollectionNamesRequest
+        std::string coalescingKey() const override { return _databaseName + '\0' + _nameFilter; }
+
+    private:
+        std::string _databaseName;
+        std::string _nameFilter;
+    };
+
+    /**
+     * @brief LoadCollectionStats
+     */
+
+    class LoadCollectionStatsRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        /**
+         * @param cancelled Set by sender, when stats are not needed anymore. It is checked by
+         *        worker before every collStats command.
+         */
+        LoadCollectionStatsRequest(QObject *sender, const std::string &databaseName,
+                                   const std::vector<std::string> &collectionNames,
+                                   const std::shared_ptr<std::atomic<bool>> &cancelled) :
+            Event(sender),
+            _databaseName(databaseName),
+            _collectionNames(collectionNames),
+            _cancelled(cancelled) {}
+
+        std::string databaseName() const { return _databaseName; }
+        std::vector<std::string> const& collectionNames() const { return _collectionNames; }
+        bool isCancelled() const { return _cancelled && *_cancelled; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+    private:
+        std::string _databaseName;
+        std::vector<std::string> _collectionNames;
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+
+    class LoadCollectionStatsResponse : public Event
+    {
+        R_EVENT
+
+    public:
+        LoadCollectionStatsResponse(QObject *sender, const std::string &databaseName,
+                                    const std::vector<MongoCollectionInfo> &collectionInfos) :
+            Event(sender),
+            _databaseName(databaseName),
+            _collectionInfos(collectionInfos) {}
+
+        LoadCollectionStatsResponse(QObject *sender, const EventError &error) :
+            Event(sender, error) {}
+
+        std::string databaseName() const { return _databaseName; }
+
+        // Only collections fetched before cancellation, in order of request
+        std::vector<MongoCollectionInfo> const& collectionInfos() const { return _collectionInfos; }
 
     private:
         std::string _databaseName;
@@ -217,6 +384,10 @@ namespace Robomongo
         LoadCollectionIndexesRequest(QObject *sender, const MongoCollectionInfo &collection) :
         Event(sender), _collection(collection) {}
         MongoCollectionInfo collection() const { return _collection; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
+        std::string coalescingKey() const override { return _collection.fullName(); }
+
     private:
         const MongoCollectionInfo _collection;
     };
@@ -235,6 +406,73 @@ namespace Robomongo
         std::vector<IndexInfo> _indexes;
     };
 
+    /**
+     * @brief Reads indexes and, if 'readPage', the first page of collection focused in
+     *        explorer, before it is expanded or opened. Page is kept by FirstPageCache. Request
+     *        is dropped if collection is unfocused before it is handled (see 'generation').
+     */
+    class PrefetchCollectionRequest : public Event
+    {
+        R_EVENT
+    public:
+        PrefetchCollectionRequest(QObject *sender, const MongoCollectionInfo &collection,
+                                  unsigned long long generation, bool readPage) :
+            Event(sender), collection(collection), generation(generation), readPage(readPage) {}
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        MongoCollectionInfo const collection;
+        unsigned long long const generation;    // see FirstPageCache::focus()
+        bool const readPage;
+    };
+
+    class PrefetchCollectionResponse : public Event
+    {
+        R_EVENT
+    public:
+        PrefetchCollectionResponse(QObject *sender, const std::vector<IndexInfo> &indexes) :
+            Event(sender), indexes(indexes) {}
+
+        PrefetchCollectionResponse(QObject *sender, const EventError &error) :
+            Event(sender, error) {}
+
+        std::vector<IndexInfo> const indexes;
+    };
+
+    class LoadIndexUsageRequest : public Event
+    {
+        R_EVENT
+    public:
+        LoadIndexUsageRequest(QObject *sender, const MongoNamespace &ns) :
+            Event(sender), _ns(ns) {}
+        const MongoNamespace &ns() const { return _ns; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
+        std::string coalescingKey() const override { return _ns.toString(); }
+
+    private:
+        const MongoNamespace _ns;
+    };
+
+    class LoadIndexUsageResponse : public Event
+    {
+        R_EVENT
+    public:
+        LoadIndexUsageResponse(QObject *sender, const MongoNamespace &ns,
+                               const std::vector<IndexUsageInfo> &usage) :
+            Event(sender), _ns(ns), _usage(usage) {}
+
+        LoadIndexUsageResponse(QObject *sender, const MongoNamespace &ns, const EventError &error) :
+            Event(sender, error), _ns(ns) {}
+
+        const MongoNamespace &ns() const { return _ns; }
+        const std::vector<IndexUsageInfo> &usage() const { return _usage; }
+
+    private:
+        MongoNamespace _ns;
+        std::vector<IndexUsageInfo> _usage;
+    };
+
     class AddEditIndexRequest : public Event
     {
         R_EVENT
@@ -321,6 +559,7 @@ namespace Robomongo
             _databaseName(databaseName) {}
 
         std::string databaseName() const { return _databaseName; }
+        std::string coalescingKey() const override { return _databaseName; }
 
     private:
         std::string _databaseName;
@@ -391,7 +630,8 @@ namespace Robomongo
     };
 
     /**
-     * @brief InsertDocument
+     * @brief InsertDocument. If 'overwrite' is true and 'original' (document as it was loaded)
+     *        is not empty, only changed fields are updated (see MongoClient::updateDocument()).
      */
 
     class InsertDocumentRequest : public Event
@@ -399,18 +639,22 @@ namespace Robomongo
         R_EVENT
 
     public:
-        InsertDocumentRequest(QObject *sender, const mongo::BSONObj &obj, const MongoNamespace &ns, bool overwrite = false) :
+        InsertDocumentRequest(QObject *sender, const mongo::BSONObj &obj, const MongoNamespace &ns, bool overwrite = false,
+                              const mongo::BSONObj &original = mongo::BSONObj()) :
             Event(sender),
             _obj(obj),
+            _original(original),
             _ns(ns),
             _overwrite(overwrite) {}
 
         mongo::BSONObj obj() const { return _obj; }
+        mongo::BSONObj original() const { return _original; }
         MongoNamespace ns() const { return _ns; }
         bool overwrite() const { return _overwrite; }
 
     private:
         mongo::BSONObj _obj;
+        mongo::BSONObj _original;
         const MongoNamespace _ns;
         bool _overwrite;
     };
@@ -427,6 +671,63 @@ namespace Robomongo
             Event(sender, error) {}
     };
 
+    /**
+     * @brief Insert (or save, if 'overwrite' is true) many documents. Documents are sent
+     *        in batches of at most 'batchBytesLimit' bytes, one aggregated response is
+     *        sent back with result of every batch.
+     */
+
+    class InsertDocumentsRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        InsertDocumentsRequest(QObject *sender, const std::vector<mongo::BSONObj> &objs, const MongoNamespace &ns, 
+                               bool overwrite, int batchBytesLimit) :
+            Event(sender),
+            _objs(objs),
+            _ns(ns),
+            _overwrite(overwrite),
+            _batchBytesLimit(batchBytesLimit) {}
+
+        std::vector<mongo::BSONObj> objs() const { return _objs; }
+        MongoNamespace ns() const { return _ns; }
+        bool overwrite() const { return _overwrite; }
+        int batchBytesLimit() const { return _batchBytesLimit; }
+
+    private:
+        std::vector<mongo::BSONObj> const _objs;
+        MongoNamespace const _ns;
+        bool const _overwrite;
+        int const _batchBytesLimit;
+    };
+
+    struct InsertDocumentsResponse : public Event
+    {
+        R_EVENT
+
+        InsertDocumentsResponse(QObject *sender, const std::vector<BulkChunkResult> &batches) :
+            Event(sender), batches(batches) {}
+
+        InsertDocumentsResponse(QObject *sender, const EventError &error, 
+                                const std::vector<BulkChunkResult> &batches) :
+            Event(sender, error), batches(batches) {}
+
+        /**
+         * @brief Number of documents in succeeded batches
+         */
+        int insertedCount() const {
+            int count = 0;
+            for (auto const& batch : batches) {
+                if (!batch.isError())
+                    count += batch._count;
+            }
+            return count;
+        }
+
+        std::vector<BulkChunkResult> const batches;
+    };
+
     /**
      * @brief Remove Document
      */
@@ -473,6 +774,57 @@ namespace Robomongo
         int const index;
     };
 
+    /**
+     * @brief Remove many documents by _id. Ids are grouped into { _id : { $in : [...] } }
+     *        chunks and one aggregated response is sent back when all chunks are processed.
+     */
+
+    class RemoveDocumentsByIdRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        // Every object of 'ids' is { _id : <value> }
+        RemoveDocumentsByIdRequest(QObject *sender, const std::vector<mongo::BSONObj> &ids, 
+                                   const MongoNamespace &ns) :
+            Event(sender),
+            _ids(ids),
+            _ns(ns) {}
+
+        std::vector<mongo::BSONObj> ids() const { return _ids; }
+        MongoNamespace ns() const { return _ns; }
+
+    private:
+        std::vector<mongo::BSONObj> const _ids;
+        MongoNamespace const _ns;
+    };
+
+    struct RemoveDocumentsByIdResponse : public Event
+    {
+        R_EVENT
+
+        RemoveDocumentsByIdResponse(QObject *sender, const std::vector<BulkChunkResult> &chunks) :
+            Event(sender), chunks(chunks) {}
+
+        RemoveDocumentsByIdResponse(QObject *sender, const EventError &error, 
+                                    const std::vector<BulkChunkResult> &chunks) :
+            Event(sender, error), chunks(chunks) {}
+
+        /**
+         * @brief Number of documents in succeeded chunks
+         */
+        int removedCount() const {
+            int count = 0;
+            for (auto const& chunk : chunks) {
+                if (!chunk.isError())
+                    count += chunk._count;
+            }
+            return count;
+        }
+
+        std::vector<BulkChunkResult> const chunks;
+    };
+
     /**
      * @brief Create Database
      */
@@ -689,10 +1041,10 @@ namespace Robomongo
         std::string const duplicateCollection;
     };
 
-     /**
-     * @brief Copy collection to diffrent server
+    /**
+     * @brief Copy collection to other database of this or different server. Sent to worker
+     *        of destination server, source is read with extra connection of 'worker'.
      */
-
     class CopyCollectionToDiffServerRequest : public Event
     {
         R_EVENT
@@ -708,22 +1060,65 @@ namespace Robomongo
         MongoWorker *worker() const { return _worker; }
         MongoNamespace from() const { return _from; }
         MongoNamespace to() const { return _to; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
     private:
         MongoWorker *_worker;
         const MongoNamespace _from;
         const MongoNamespace _to;
     };
 
+    class CopyCollectionProgressEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        static const int IntervalMs = 5000;
+
+        CopyCollectionProgressEvent(QObject *sender, const MongoNamespace &to, long long copied,
+                                    long long failed, long long total, long long elapsedMs) :
+            Event(sender),
+            to(to),
+            copied(copied),
+            failed(failed),
+            total(total),
+            elapsedMs(elapsedMs) {}
+
+        MongoNamespace const to;
+        long long const copied;         // inserted into destination
+        long long const failed;         // e.g. duplicate _id in destination
+        long long const total;          // estimated count of source, may be 0
+        long long const elapsedMs;
+    };
+
     class CopyCollectionToDiffServerResponse : public Event
     {
         R_EVENT
 
     public:
-        CopyCollectionToDiffServerResponse(QObject *sender) :
-            Event(sender) {}
+        CopyCollectionToDiffServerResponse(QObject *sender, const MongoNamespace &to, long long copied,
+                                           long long failed, long long elapsedMs, const std::string &errors) :
+            Event(sender),
+            to(to),
+            copied(copied),
+            failed(failed),
+            elapsedMs(elapsedMs),
+            errors(errors) {}
+
+        CopyCollectionToDiffServerResponse(QObject *sender, const MongoNamespace &to, long long copied,
+                                           long long failed, const EventError &error) :
+            Event(sender, error),
+            to(to),
+            copied(copied),
+            failed(failed),
+            elapsedMs(0) {}
 
-        CopyCollectionToDiffServerResponse(QObject *sender, const EventError &error) :
-            Event(sender, error) {}
+        MongoNamespace const to;
+        long long const copied;
+        long long const failed;
+        long long const elapsedMs;
+        std::string const errors;       // the first failed documents, one per line
     };
 
     /**
@@ -892,414 +1287,2560 @@ namespace Robomongo
         R_EVENT
 
     public:
-        ExecuteQueryRequest(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo) :
+        /**
+         * @param cursorKey If not 0, server cursor is kept open after this page under this key,
+         *        so that the next page of the same query is read with getMore (see MongoWorker)
+         * @param prefetch Page is read ahead (in background), before user asked for it
+         */
+        ExecuteQueryRequest(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo,
+                            unsigned long long cursorKey = 0, bool prefetch = false) :
             Event(sender),
             _resultIndex(resultIndex),
-            _queryInfo(queryInfo) {}
+            _queryInfo(queryInfo),
+            _cursorKey(cursorKey),
+            _prefetch(prefetch) {}
 
         int resultIndex() const { return _resultIndex; }
         MongoQueryInfo queryInfo() const { return _queryInfo; }
+        unsigned long long cursorKey() const { return _cursorKey; }
+        bool isPrefetch() const { return _prefetch; }
+
+        EventPriority priority() const override { 
+            return _prefetch ? EventPriority::Background : EventPriority::Interactive; 
+        }
 
     private:
         int _resultIndex; //external user data;
         MongoQueryInfo _queryInfo;
+        unsigned long long _cursorKey;
+        bool _prefetch;
     };
 
-    class ExecuteQueryResponse : public Event
+    /**
+     * @brief Counts all documents matching query (skip and limit are ignored), without fetching
+     *        them. Sent to metadata worker, so count runs concurrently with query itself.
+     */
+    class CountDocumentsRequest : public Event
     {
         R_EVENT
 
-        ExecuteQueryResponse(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo, const std::vector<MongoDocumentPtr> &documents) :
+    public:
+        static const int DefaultMaxTimeMs = 5000;
+
+        CountDocumentsRequest(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo,
+                              int maxTimeMs = DefaultMaxTimeMs) :
             Event(sender),
             resultIndex(resultIndex),
             queryInfo(queryInfo),
-            documents(documents) { }
+            maxTimeMs(maxTimeMs) {}
 
-        ExecuteQueryResponse(QObject *sender, const EventError &error) :
+        EventPriority priority() const override { return EventPriority::Explorer; }
+
+        int const resultIndex;
+        MongoQueryInfo const queryInfo;
+        int const maxTimeMs;
+    };
+
+    class CountDocumentsResponse : public Event
+    {
+        R_EVENT
+
+        CountDocumentsResponse(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo,
+                               long long count, bool estimated) :
+            Event(sender),
+            resultIndex(resultIndex),
+            queryInfo(queryInfo),
+            count(count),
+            estimated(estimated) {}
+
+        CountDocumentsResponse(QObject *sender, const EventError &error) :
             Event(sender, error) {}
 
-        int resultIndex;
+        int resultIndex = -1;
         MongoQueryInfo queryInfo;
-        std::vector<MongoDocumentPtr> documents;
+        long long count = 0;
+        bool estimated = false;     // taken from collection metadata, not by scanning
     };
 
-    class AutocompleteRequest : public Event
+    /**
+     * @brief Infers schema of collection from $sample of its documents, for completion.
+     *        Limited by sample size and server time, so that it is cheap for the server.
+     */
+    class SampleSchemaRequest : public Event
     {
         R_EVENT
 
-        AutocompleteRequest(QObject *sender, const std::string &prefix, const AutocompletionMode mode) :
+    public:
+        static const int DefaultSampleSize = 100;
+        static const int DefaultMaxTimeMs = 2000;
+
+        SampleSchemaRequest(QObject *sender, const std::string &key, const MongoNamespace &ns,
+                            int sampleSize = DefaultSampleSize, int maxTimeMs = DefaultMaxTimeMs) :
             Event(sender),
-            prefix(prefix),
-            mode(mode) {}
+            key(key),
+            ns(ns),
+            sampleSize(sampleSize),
+            maxTimeMs(maxTimeMs) {}
 
-        std::string prefix;
-        AutocompletionMode mode;
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        std::string const key;  // of SchemaCache
+        MongoNamespace const ns;
+        int const sampleSize;
+        int const maxTimeMs;
     };
 
-    class AutocompleteResponse : public Event
+    class SampleSchemaResponse : public Event
     {
         R_EVENT
 
-        AutocompleteResponse(QObject *sender, const QStringList &list, const std::string &prefix) :
+        SampleSchemaResponse(QObject *sender, const std::string &key, const CollectionSchema &schema) :
             Event(sender),
-            list(list),
-            prefix(prefix) {}
+            key(key),
+            schema(schema) {}
 
-        AutocompleteResponse(QObject *sender, const EventError &error) :
+        SampleSchemaResponse(QObject *sender, const EventError &error) :
             Event(sender, error) {}
 
-        QStringList list;
-        std::string prefix;
+        std::string key;
+        CollectionSchema schema;
     };
 
-
     /**
-     * @brief ExecuteScript
+     * @brief Exports documents of query to file, see ExportWriter. Worker replies with
+     *        ExportProgressEvent every ExportProgressEvent::IntervalMs, then with ExportDocumentsResponse.
      */
-
-    class ExecuteScriptRequest : public Event
+    class ExportDocumentsRequest : public Event
     {
         R_EVENT
 
-        ExecuteScriptRequest(QObject *sender, const std::string &script, const std::string &dbName, 
-                             AggrInfo aggrInfo = AggrInfo(), int take = 0, int skip = 0) :
+    public:
+        /**
+         * @param exportId Identifies export in progress and response events
+         * @param cancelled Set by sender to stop export, checked by worker before every batch
+         */
+        ExportDocumentsRequest(QObject *sender, int exportId, const MongoQueryInfo &queryInfo,
+                               const ExportOptions &options, const QString &filePath,
+                               const std::shared_ptr<std::atomic<bool>> &cancelled) :
             Event(sender),
-            script(script),
-            databaseName(dbName),
-            aggrInfo(aggrInfo),
-            take(take),
-            skip(skip)
-            {}
+            exportId(exportId),
+            queryInfo(queryInfo),
+            options(options),
+            filePath(filePath),
+            _cancelled(cancelled) {}
 
-        std::string script;
-        std::string databaseName;
-        int take; //
-        int skip;
-        AggrInfo const aggrInfo;
+        bool isCancelled() const { return _cancelled && *_cancelled; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        int const exportId;
+        MongoQueryInfo const queryInfo;
+        ExportOptions const options;
+        QString const filePath;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
     };
 
-    class ExecuteScriptResponse : public Event
+    class ExportProgressEvent : public Event
     {
         R_EVENT
 
-        ExecuteScriptResponse(QObject *sender, const MongoShellExecResult &result, bool empty,
-                              bool timeoutReached = false) :
-            Event(sender), result(result), empty(empty), _timeoutReached(timeoutReached) {}
-
-        ExecuteScriptResponse(QObject *sender, const EventError &error, bool timeoutReached = false) :
-            Event(sender, error), _timeoutReached(timeoutReached) {}
+    public:
+        static const int IntervalMs = 250;
 
-        bool timeoutReached() const { return _timeoutReached; }
+        ExportProgressEvent(QObject *sender, int exportId, long long documents, long long bytes,
+                            long long elapsedMs) :
+            Event(sender),
+            exportId(exportId),
+            documents(documents),
+            bytes(bytes),
+            elapsedMs(elapsedMs) {}
 
-        MongoShellExecResult result;
-        bool empty;
-        bool const _timeoutReached = false;
+        int const exportId;
+        long long const documents;      // written to file
+        long long const bytes;
+        long long const elapsedMs;
     };
 
-    class ConnectingEvent : public Event
+    class ExportDocumentsResponse : public Event
     {
         R_EVENT
 
-        ConnectingEvent(QObject *sender) :
-            Event(sender) { }
+    public:
+        ExportDocumentsResponse(QObject *sender, int exportId, long long documents, long long bytes,
+                                long long elapsedMs) :
+            Event(sender),
+            exportId(exportId),
+            documents(documents),
+            bytes(bytes),
+            elapsedMs(elapsedMs) {}
+
+        ExportDocumentsResponse(QObject *sender, int exportId, const EventError &error) :
+            Event(sender, error),
+            exportId(exportId) {}
+
+        int exportId;
+        long long documents = 0;
+        long long bytes = 0;
+        long long elapsedMs = 0;
     };
 
-    class OpeningShellEvent : public Event
+    /**
+     * @brief Inserts documents of file into collection, see ImportReader and BulkInserter.
+     *        Worker replies with ImportProgressEvent every ImportProgressEvent::IntervalMs,
+     *        then with ImportDocumentsResponse.
+     */
+    class ImportDocumentsRequest : public Event
     {
         R_EVENT
 
-        OpeningShellEvent(QObject *sender, MongoShell *shell) :
+    public:
+        /**
+         * @param importId Identifies import in progress and response events
+         * @param cancelled Set by sender to stop import, checked by worker before every batch
+         */
+        ImportDocumentsRequest(QObject *sender, int importId, const MongoNamespace &ns,
+                               const QString &filePath, const ImportOptions &options,
+                               const std::shared_ptr<std::atomic<bool>> &cancelled) :
             Event(sender),
-            shell(shell) {}
+            importId(importId),
+            ns(ns),
+            filePath(filePath),
+            options(options),
+            _cancelled(cancelled) {}
 
-        MongoShell *shell;
+        bool isCancelled() const { return _cancelled && *_cancelled; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        int const importId;
+        MongoNamespace const ns;
+        QString const filePath;
+        ImportOptions const options;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
     };
 
-    class ConnectionFailedEvent : public Event
+    class ImportProgressEvent : public Event
     {
         R_EVENT
 
-        enum Reason {
-            MongoConnection    = 1,
-            MongoAuth          = 2,
-            SshConnection      = 3,
-            SshChannel         = 4,
-            SslConnection      = 5
-        };
+    public:
+        static const int IntervalMs = 250;
 
-        ConnectionFailedEvent(QObject *sender, int serverHandle, ConnectionType connectionType,
-                              const std::string& message, Reason reason) :
+        ImportProgressEvent(QObject *sender, int importId, long long inserted, long long failed,
+                            long long bytesRead, long long fileSize, long long elapsedMs, int throttleMs) :
             Event(sender),
-            message(message),
-            reason(reason),
-            serverHandle(serverHandle),
-            connectionType(connectionType) {}
+            importId(importId),
+            inserted(inserted),
+            failed(failed),
+            bytesRead(bytesRead),
+            fileSize(fileSize),
+            elapsedMs(elapsedMs),
+            throttleMs(throttleMs) {}
 
-        std::string message;
-        Reason reason;
-        ConnectionType connectionType;
-        int serverHandle;
+        int const importId;
+        long long const inserted;
+        long long const failed;
+        long long const bytesRead;      // of file, parsed and queued for insert
+        long long const fileSize;
+        long long const elapsedMs;
+        int const throttleMs;           // delay before inserts, while server is overloaded
     };
 
-//    class ScriptExecute
-
-    struct ConnectionEstablishedEvent : public Event
+    class ImportDocumentsResponse : public Event
     {
         R_EVENT
 
-        ConnectionEstablishedEvent(MongoServer *server, ConnectionType type, ConnectionInfo connInfo) :
-            Event((QObject *)server),
-            server(server),
-            connectionType(type),
-            connInfo(connInfo) { }       
+    public:
+        /**
+         * @param errors Failed documents (the first few of them) and parse error, which
+         *        stopped import. Empty if all documents were inserted.
+         */
+        ImportDocumentsResponse(QObject *sender, int importId, long long inserted, long long failed,
+                                long long elapsedMs, const std::string &errors) :
+            Event(sender),
+            importId(importId),
+            inserted(inserted),
+            failed(failed),
+            elapsedMs(elapsedMs),
+            errors(errors) {}
+
+        ImportDocumentsResponse(QObject *sender, int importId, long long inserted, long long failed,
+                                const EventError &error) :
+            Event(sender, error),
+            importId(importId),
+            inserted(inserted),
+            failed(failed) {}
 
-        MongoServer *server;
-        ConnectionType const connectionType;
-        ConnectionInfo const connInfo;
+        int importId;
+        long long inserted;
+        long long failed;
+        long long elapsedMs = 0;
+        std::string errors;
     };
 
-    class DatabaseListLoadedEvent : public Event
+    class DatabaseStatsRequest : public Event
     {
         R_EVENT
 
-        DatabaseListLoadedEvent(QObject *sender, const QList<MongoDatabase *> &list) :
+    public:
+        /**
+         * @param statsId Identifies request in progress and response events
+         * @param cancelled Set by sender to stop, checked by worker before every collStats command
+         * @param indexDetails Reads collStats with storage engine statistics of every index
+         */
+        DatabaseStatsRequest(QObject *sender, int statsId, const std::string &databaseName,
+                             const std::shared_ptr<std::atomic<bool>> &cancelled, bool indexDetails = false) :
             Event(sender),
-            list(list) { }
+            statsId(statsId),
+            databaseName(databaseName),
+            indexDetails(indexDetails),
+            _cancelled(cancelled) {}
 
-        DatabaseListLoadedEvent(QObject *sender, const EventError &error) :
-            Event(sender, error) {}
+        bool isCancelled() const { return _cancelled && *_cancelled; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
 
-        QList<MongoDatabase *> list;
+        int const statsId;
+        std::string const databaseName;
+        bool const indexDetails;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
     };
 
-    class DocumentListLoadedEvent : public Event
+    class DatabaseStatsProgressEvent : public Event
     {
         R_EVENT
 
     public:
-        DocumentListLoadedEvent(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo, const std::string &query, const std::vector<MongoDocumentPtr> &docs) :
-            Event(sender),
-            _resultIndex(resultIndex),
-            _queryInfo(queryInfo),
-            _query(query),
-            _documents(docs) { }
-
-        DocumentListLoadedEvent(QObject *sender, const EventError &error) :
-            Event(sender, error) {}
+        static const int IntervalMs = 200;
 
-        int resultIndex() const { return _resultIndex; }
-        MongoQueryInfo queryInfo() const { return _queryInfo; }
-        std::vector<MongoDocumentPtr> documents() const { return _documents; }
-        std::string query() const { return _query; }
+        DatabaseStatsProgressEvent(QObject *sender, int statsId, const std::vector<MongoDocumentPtr> &collections,
+                                   int done, int total) :
+            Event(sender),
+            statsId(statsId),
+            collections(collections),
+            done(done),
+            total(total) {}
 
-    private:
-        int _resultIndex;
-        MongoQueryInfo _queryInfo;
-        std::vector<MongoDocumentPtr> _documents;
-        std::string _query;
+        int const statsId;
+        std::vector<MongoDocumentPtr> const collections;   // collStats results since previous event
+        int const done;                                     // collections with or without stats
+        int const total;
     };
 
-    class ScriptExecutedEvent : public Event
+    class DatabaseStatsResponse : public Event
     {
         R_EVENT
 
     public:
-        ScriptExecutedEvent(QObject *sender, const MongoShellExecResult &result, bool empty,
-                            bool timeoutReached = false) :
-            Event(sender), _result(result), _empty(empty), _timeoutReached(timeoutReached) {}
-
-        ScriptExecutedEvent(QObject *sender, const EventError &error, bool timeoutReached = false) :
-            Event(sender, error), _timeoutReached(timeoutReached) {}
+        /**
+         * @param databaseStats Result of dbStats, null if it failed
+         * @param skipped Collections without stats (views, collections without access rights)
+         */
+        DatabaseStatsResponse(QObject *sender, int statsId, const MongoDocumentPtr &databaseStats,
+                              int skipped, long long elapsedMs) :
+            Event(sender),
+            statsId(statsId),
+            databaseStats(databaseStats),
+            skipped(skipped),
+            elapsedMs(elapsedMs) {}
 
-        MongoShellExecResult result() const { return _result; }
-        bool empty() const { return _empty; }
-        bool timeoutReached() const { return _timeoutReached; }
+        DatabaseStatsResponse(QObject *sender, int statsId, const EventError &error) :
+            Event(sender, error),
+            statsId(statsId) {}
 
-    private:
-        MongoShellExecResult _result;
-        bool _empty;
-        bool const _timeoutReached = false;
+        int statsId;
+        MongoDocumentPtr databaseStats;
+        int skipped = 0;
+        long long elapsedMs = 0;
     };
 
-    class ScriptExecutingEvent : public Event
+    /**
+     * @brief Searches value in all collections of database, see DatabaseSearch. Worker replies
+     *        with DatabaseSearchProgressEvent every DatabaseSearchProgressEvent::IntervalMs,
+     *        then with DatabaseSearchResponse.
+     */
+    class DatabaseSearchRequest : public Event
     {
         R_EVENT
 
     public:
-        ScriptExecutingEvent(QObject *sender) :
-            Event(sender) { }
+        /**
+         * @param cancellation Set by sender for the whole search or single collections
+         */
+        DatabaseSearchRequest(QObject *sender, int searchId, const std::string &databaseName,
+                              const DatabaseSearch::Options &options,
+                              const std::shared_ptr<DatabaseSearch::Cancellation> &cancellation) :
+            Event(sender),
+            searchId(searchId),
+            databaseName(databaseName),
+            options(options),
+            cancellation(cancellation) {}
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        int const searchId;
+        std::string const databaseName;
+        DatabaseSearch::Options const options;
+        std::shared_ptr<DatabaseSearch::Cancellation> const cancellation;
     };
 
-    class OperationFailedEvent : public Event
+    class DatabaseSearchProgressEvent : public Event
     {
         R_EVENT
 
     public:
-        OperationFailedEvent(QObject *sender, const std::string &technicalErrorMessage, const std::string &userFriendlyErrorMessage) :
-            technicalErrorMessage(technicalErrorMessage),
-            userFriendlyErrorMessage(userFriendlyErrorMessage),
-            Event(sender) { }
+        static const int IntervalMs = 200;
 
-        std::string technicalErrorMessage;
-        std::string userFriendlyErrorMessage;
+        DatabaseSearchProgressEvent(QObject *sender, int searchId, const std::vector<DatabaseSearch::Hit> &hits,
+                                    const std::vector<DatabaseSearch::CollectionResult> &finished,
+                                    const std::vector<std::string> &started, int total) :
+            Event(sender),
+            searchId(searchId),
+            hits(hits),
+            finished(finished),
+            started(started),
+            total(total) {}
+
+        int const searchId;
+        std::vector<DatabaseSearch::Hit> const hits;                        // since previous event
+        std::vector<DatabaseSearch::CollectionResult> const finished;       // since previous event
+        std::vector<std::string> const started;                             // since previous event
+        int const total;                                                    // collections of database
     };
 
-    class QueryWidgetUpdatedEvent : public Event
+    class DatabaseSearchResponse : public Event
     {
         R_EVENT
 
     public:
-        QueryWidgetUpdatedEvent(QObject *sender, int numOfResults) :
+        DatabaseSearchResponse(QObject *sender, int searchId, long long hits, long long elapsedMs) :
             Event(sender),
-          _numOfResults(numOfResults) { }
+            searchId(searchId),
+            hits(hits),
+            elapsedMs(elapsedMs) {}
 
-        int numOfResults() const { return _numOfResults; }
+        DatabaseSearchResponse(QObject *sender, int searchId, const EventError &error) :
+            Event(sender, error),
+            searchId(searchId) {}
 
-    private:
-        int _numOfResults;
+        int searchId;
+        long long hits = 0;
+        long long elapsedMs = 0;
     };
 
     /**
-     * @brief Establish SSH Connection
+     * @brief Runs one DDL action on many collections of database, see CollectionMaintenance.
+     *        Worker replies with CollectionMaintenanceProgressEvent every
+     *        CollectionMaintenanceProgressEvent::IntervalMs, then with CollectionMaintenanceResponse.
      */
+    class CollectionMaintenanceRequest : public Event
+    {
+        R_EVENT
 
-    class EstablishSshConnectionRequest : public Event
+    public:
+        /**
+         * @param cancelled Set by sender to skip collections not started yet, running
+         *        commands are not interrupted
+         */
+        CollectionMaintenanceRequest(QObject *sender, int runId, const std::string &databaseName,
+                                     const std::vector<std::string> &collections,
+                                     const CollectionMaintenance::Action &action,
+                                     const std::shared_ptr<std::atomic<bool>> &cancelled) :
+            Event(sender),
+            runId(runId),
+            databaseName(databaseName),
+            collections(collections),
+            action(action),
+            cancelled(cancelled) {}
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        int const runId;
+        std::string const databaseName;
+        std::vector<std::string> const collections;
+        CollectionMaintenance::Action const action;
+        std::shared_ptr<std::atomic<bool>> const cancelled;
+    };
+
+    class CollectionMaintenanceProgressEvent : public Event
     {
-    R_EVENT
+        R_EVENT
 
-        EstablishSshConnectionRequest(QObject *sender, int serverHandle, SshTunnelWorker* worker, ConnectionSettings* settings, ConnectionType connectionType) :
+    public:
+        static const int IntervalMs = 200;
+
+        CollectionMaintenanceProgressEvent(QObject *sender, int runId, const std::vector<std::string> &started,
+                                           const std::vector<CollectionMaintenance::ItemResult> &finished) :
             Event(sender),
-            worker(worker),
-            settings(settings),
-            serverHandle(serverHandle),
-            connectionType(connectionType) {}
+            runId(runId),
+            started(started),
+            finished(finished) {}
 
-        ConnectionSettings* settings;
-        ConnectionType connectionType;
-        SshTunnelWorker* worker;
-        int serverHandle;
+        int const runId;
+        std::vector<std::string> const started;                             // since previous event
+        std::vector<CollectionMaintenance::ItemResult> const finished;      // since previous event
     };
 
-    class EstablishSshConnectionResponse : public Event
+    class CollectionMaintenanceResponse : public Event
     {
-    R_EVENT
+        R_EVENT
 
-        EstablishSshConnectionResponse(QObject *sender, int serverHandle, SshTunnelWorker* worker, ConnectionSettings* settings, ConnectionType connectionType, int localport) :
+    public:
+        CollectionMaintenanceResponse(QObject *sender, int runId, int succeeded, int failed, long long elapsedMs) :
             Event(sender),
-            worker(worker),
-            settings(settings),
-            connectionType(connectionType),
-            serverHandle(serverHandle),
-            localport(localport) {}
+            runId(runId),
+            succeeded(succeeded),
+            failed(failed),
+            elapsedMs(elapsedMs) {}
 
-        EstablishSshConnectionResponse(QObject *sender, int serverHandle, const EventError &error, SshTunnelWorker* worker, ConnectionSettings* settings, ConnectionType connectionType) :
+        CollectionMaintenanceResponse(QObject *sender, int runId, const EventError &error) :
             Event(sender, error),
-            worker(worker),
-            settings(settings),
-            serverHandle(serverHandle),
-            connectionType(connectionType) {}
+            runId(runId) {}
 
-        ConnectionSettings* settings;
-        ConnectionType connectionType;
-        SshTunnelWorker* worker;
-        int localport;
-        int serverHandle;
+        int runId;
+        int succeeded = 0;
+        int failed = 0;             // skipped collections of cancelled run are neither
+        long long elapsedMs = 0;
     };
 
     /**
-     * @brief Start listening on all opened sockets (SSH tunnel)
+     * @brief Streams $sample of collection through SchemaAnalyzer. Worker replies with
+     *        AnalyzeSchemaProgressEvent every AnalyzeSchemaProgressEvent::IntervalMs, then
+     *        with AnalyzeSchemaResponse.
      */
+    class AnalyzeSchemaRequest : public Event
+    {
+        R_EVENT
 
-    class ListenSshConnectionRequest : public Event
+    public:
+        static const int DefaultSampleSize = 10000;
+        static const int BatchSize = 1000;
+
+        /**
+         * @param analysisId Identifies request in progress and response events
+         * @param cancelled Set by sender to stop, checked by worker before every batch
+         */
+        AnalyzeSchemaRequest(QObject *sender, int analysisId, const MongoNamespace &ns, int sampleSize,
+                             const std::shared_ptr<std::atomic<bool>> &cancelled) :
+            Event(sender),
+            analysisId(analysisId),
+            ns(ns),
+            sampleSize(sampleSize),
+            _cancelled(cancelled) {}
+
+        bool isCancelled() const { return _cancelled && *_cancelled; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        int const analysisId;
+        MongoNamespace const ns;
+        int const sampleSize;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+
+    class AnalyzeSchemaProgressEvent : public Event
     {
-    R_EVENT
+        R_EVENT
 
-        ListenSshConnectionRequest(QObject *sender, int serverHandle, ConnectionType connectionType) :
+    public:
+        static const int IntervalMs = 200;
+
+        AnalyzeSchemaProgressEvent(QObject *sender, int analysisId, long long analyzed, int sampleSize) :
             Event(sender),
-            serverHandle(serverHandle),
-            connectionType(connectionType) {}
+            analysisId(analysisId),
+            analyzed(analyzed),
+            sampleSize(sampleSize) {}
 
-        ConnectionType connectionType;
-        int serverHandle;
+        int const analysisId;
+        long long const analyzed;   // documents analyzed so far
+        int const sampleSize;
     };
 
-    class ListenSshConnectionResponse : public Event
+    class AnalyzeSchemaResponse : public Event
     {
-    R_EVENT
+        R_EVENT
 
-        ListenSshConnectionResponse(QObject *sender, int serverHandle, ConnectionSettings* settings, ConnectionType connectionType) :
+    public:
+        /**
+         * @param droppedPaths Values of paths over limit of SchemaAnalyzer, not analyzed
+         */
+        AnalyzeSchemaResponse(QObject *sender, int analysisId, std::vector<FieldAnalysis> fields,
+                              long long documents, long long droppedPaths, long long elapsedMs) :
             Event(sender),
-            settings(settings),
-            serverHandle(serverHandle),
-            connectionType(connectionType) {}
+            analysisId(analysisId),
+            fields(std::move(fields)),
+            documents(documents),
+            droppedPaths(droppedPaths),
+            elapsedMs(elapsedMs) {}
 
-        ListenSshConnectionResponse(QObject *sender, const EventError &error, int serverHandle, ConnectionSettings* settings, ConnectionType connectionType) :
+        AnalyzeSchemaResponse(QObject *sender, int analysisId, const EventError &error) :
             Event(sender, error),
-            settings(settings),
-            serverHandle(serverHandle),
-            connectionType(connectionType) {}
+            analysisId(analysisId) {}
 
-        ConnectionSettings* settings;
-        ConnectionType connectionType;
-        int serverHandle;
+        int analysisId;
+        std::vector<FieldAnalysis> fields;
+        long long documents = 0;
+        long long droppedPaths = 0;
+        long long elapsedMs = 0;
     };
 
-    class LogEvent : public Event
+    /**
+     * @brief Builds DocumentSizeHistogram of collection with $bsonSize, or from documents
+     *        read by worker on servers without it (older than 4.4)
+     */
+    class DocumentSizesRequest : public Event
     {
-    R_EVENT
+        R_EVENT
 
-        enum LogLevel {
-            RBM_ERROR  = 1,
-            RBM_WARN   = 2,
-            RBM_INFO   = 3,
-            RBM_DEBUG  = 100 // log as much as possible
-        };
+    public:
+        static const int DefaultTopCount = 20;
+
+        /**
+         * @param sizesId Identifies request in response event
+         * @param sampleSize Documents of $sample, 0 for whole collection
+         * @param cancelled Set by sender to stop, checked by worker before every batch read by it
+         */
+        DocumentSizesRequest(QObject *sender, int sizesId, const MongoNamespace &ns, int sampleSize,
+                             int topCount, const std::shared_ptr<std::atomic<bool>> &cancelled) :
+            Event(sender),
+            sizesId(sizesId),
+            ns(ns),
+            sampleSize(sampleSize),
+            topCount(topCount),
+            _cancelled(cancelled) {}
 
-        LogEvent(QObject *sender, const std::string& message, LogLevel level, 
-                 bool const informUser = false) 
-            : Event(sender), message(message), level(level), informUser(informUser)
-        {}
+        bool isCancelled() const { return _cancelled && *_cancelled; }
 
-        std::string severity() const {
-            switch (level) {
-                case RBM_ERROR : return "Error";
-                case RBM_WARN  : return "Warning";
-                case RBM_INFO  : return "Info";
-                case RBM_DEBUG : return "Debug";
-                default: return "Undefined";
-            }
-        }
+        EventPriority priority() const override { return EventPriority::Background; }
 
-        QMessageBox::Icon qMessageBoxIcon() const {
-            switch (level) {
-                case RBM_ERROR: return QMessageBox::Icon::Critical;
-                case RBM_WARN: return QMessageBox::Icon::Warning;
-                case RBM_INFO: return QMessageBox::Icon::Information;
-                case RBM_DEBUG: return QMessageBox::Icon::Information;
-                default: return QMessageBox::Icon::Information;
-            }
-        }
+        int const sizesId;
+        MongoNamespace const ns;
+        int const sampleSize;
+        int const topCount;
 
-        mongo::logger::LogSeverity mongoLogSeverity() const {
-            switch (level) {
-                case RBM_ERROR: return mongo::logger::LogSeverity::Error();
-                case RBM_WARN: return mongo::logger::LogSeverity::Warning();
-                case RBM_INFO: return mongo::logger::LogSeverity::Info();
-                case RBM_DEBUG: return mongo::logger::LogSeverity::Log();
-                default: return mongo::logger::LogSeverity::Info();
-            }
-        }
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
 
-        std::string message;
-        LogLevel level;
-        bool const informUser = false;
+    class DocumentSizesResponse : public Event
+    {
+        R_EVENT
+
+    public:
+        /**
+         * @param serverSide Sizes were computed by server, not from documents read by worker
+         */
+        DocumentSizesResponse(QObject *sender, int sizesId, const DocumentSizeHistogram &histogram,
+                              bool serverSide, long long elapsedMs) :
+            Event(sender),
+            sizesId(sizesId),
+            histogram(histogram),
+            serverSide(serverSide),
+            elapsedMs(elapsedMs) {}
+
+        DocumentSizesResponse(QObject *sender, int sizesId, const EventError &error) :
+            Event(sender, error),
+            sizesId(sizesId) {}
+
+        int const sizesId;
+        DocumentSizeHistogram const histogram;
+        bool const serverSide = true;
+        long long const elapsedMs = 0;
     };
 
-    class StopScriptRequest : public Event
+    /**
+     * @brief Compares collection of this server with collection of other or the same server
+     *        (see CollectionComparison). Sent to worker of source server, target is read with
+     *        extra connections of 'targetWorker'.
+     */
+    class CompareCollectionsRequest : public Event
     {
-    R_EVENT
+        R_EVENT
 
-        StopScriptRequest(QObject *sender) :
-            Event(sender) {}
+    public:
+        static const int DefaultRanges = 64;
+
+        /**
+         * @param compareId Identifies request in progress and response events
+         * @param targetAddress Address of target server, key of its AdaptiveBatchSize observations
+         * @param ranges Ranges of _id hashed and compared in parallel
+         * @param cancelled Set by sender to stop, checked by worker before every batch
+         */
+        CompareCollectionsRequest(QObject *sender, int compareId, const MongoNamespace &source,
+                                  MongoWorker *targetWorker, const std::string &targetAddress,
+                                  const MongoNamespace &target, int ranges,
+                                  const std::shared_ptr<std::atomic<bool>> &cancelled) :
+            Event(sender),
+            compareId(compareId),
+            source(source),
+            targetWorker(targetWorker),
+            targetAddress(targetAddress),
+            target(target),
+            ranges(ranges),
+            _cancelled(cancelled) {}
+
+        bool isCancelled() const { return _cancelled && *_cancelled; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        int const compareId;
+        MongoNamespace const source;
+        MongoWorker *const targetWorker;
+        std::string const targetAddress;
+        MongoNamespace const target;
+        int const ranges;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+
+    class CompareCollectionsProgressEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        static const int IntervalMs = 200;
+
+        CompareCollectionsProgressEvent(QObject *sender, int compareId, int rangesCompared, int ranges,
+                                        int mismatchedRanges) :
+            Event(sender),
+            compareId(compareId),
+            rangesCompared(rangesCompared),
+            ranges(ranges),
+            mismatchedRanges(mismatchedRanges) {}
+
+        int const compareId;
+        int const rangesCompared;
+        int const ranges;
+        int const mismatchedRanges;
+    };
+
+    class CompareCollectionsResponse : public Event
+    {
+        R_EVENT
+
+    public:
+        struct Result
+        {
+            CollectionComparison comparison;
+            bool sameDbHash = false;        // equal by dbHash of both servers, nothing was read
+            long long sourceDocuments = 0;
+            long long targetDocuments = 0;
+            int ranges = 0;
+            int mismatchedRanges = 0;
+        };
+
+        CompareCollectionsResponse(QObject *sender, int compareId, const Result &result, long long elapsedMs) :
+            Event(sender),
+            compareId(compareId),
+            result(result),
+            elapsedMs(elapsedMs) {}
+
+        CompareCollectionsResponse(QObject *sender, int compareId, const EventError &error) :
+            Event(sender, error),
+            compareId(compareId) {}
+
+        int const compareId;
+        Result const result;
+        long long const elapsedMs = 0;
+    };
+
+    /**
+     * @brief Inserts documents generated like 'sample' (see DataGenerator) on several
+     *        connections, at most 'rate' documents per second. Sample and FieldAnalysis
+     *        are taken from $sample of collection, unless 'sample' is set.
+     */
+    class GenerateDataRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        static const int DefaultSampleSize = 1000;
+        static const int DefaultThreads = 4;
+        static const int BatchSize = 500;               // documents of one bulk insert
+
+        /**
+         * @param generateId Identifies request in progress and response events
+         * @param rate Documents per second of all threads, 0 for as fast as possible
+         * @param cancelled Set by sender to stop, checked by worker before every batch
+         */
+        GenerateDataRequest(QObject *sender, int generateId, const MongoNamespace &ns, const mongo::BSONObj &sample,
+                            int sampleSize, long long documents, int rate, int threads,
+                            const std::shared_ptr<std::atomic<bool>> &cancelled) :
+            Event(sender),
+            generateId(generateId),
+            ns(ns),
+            sample(sample),
+            sampleSize(sampleSize),
+            documents(documents),
+            rate(rate),
+            threads(threads),
+            _cancelled(cancelled) {}
+
+        bool isCancelled() const { return _cancelled && *_cancelled; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        int const generateId;
+        MongoNamespace const ns;
+        mongo::BSONObj const sample;
+        int const sampleSize;
+        long long const documents;
+        int const rate;
+        int const threads;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+
+    class GenerateDataProgressEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        static const int IntervalMs = 500;
+
+        struct Stats
+        {
+            long long inserted = 0;
+            long long failed = 0;           // documents of batches rejected by server
+            long long elapsedMs = 0;
+            LatencyHistogram latency;       // of bulk inserts, 'BatchSize' documents each
+            std::string firstError;
+        };
+
+        GenerateDataProgressEvent(QObject *sender, int generateId, const Stats &stats) :
+            Event(sender),
+            generateId(generateId),
+            stats(stats) {}
+
+        int const generateId;
+        Stats const stats;
+    };
+
+    class GenerateDataResponse : public Event
+    {
+        R_EVENT
+
+    public:
+        GenerateDataResponse(QObject *sender, int generateId, const GenerateDataProgressEvent::Stats &stats) :
+            Event(sender),
+            generateId(generateId),
+            stats(stats) {}
+
+        GenerateDataResponse(QObject *sender, int generateId, const EventError &error) :
+            Event(sender, error),
+            generateId(generateId) {}
+
+        int const generateId;
+        GenerateDataProgressEvent::Stats const stats;
+    };
+
+    /**
+     * @brief Removes (or updates, if 'update' is not empty) documents matching 'filter' in
+     *        chunks of _id ranges, throttled by replication lag (see ThrottledWrite)
+     */
+    class ThrottledWriteRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        static const int DefaultMaxLagMs = 10 * 1000;
+
+        /**
+         * @param writeId Identifies request in progress and response events
+         * @param update Update operators applied to every matching document, empty to remove them
+         * @param maxLagMs Lag of the slowest secondary, above which chunks wait
+         * @param cancelled Set by sender to stop, checked by worker before every chunk
+         * @param paused Set by sender to pause, chunks are not written until it is reset
+         */
+        ThrottledWriteRequest(QObject *sender, int writeId, const MongoNamespace &ns, const mongo::BSONObj &filter,
+                              const mongo::BSONObj &update, long long maxLagMs,
+                              const std::shared_ptr<std::atomic<bool>> &cancelled,
+                              const std::shared_ptr<std::atomic<bool>> &paused) :
+            Event(sender),
+            writeId(writeId),
+            ns(ns),
+            filter(filter),
+            update(update),
+            maxLagMs(maxLagMs),
+            _cancelled(cancelled),
+            _paused(paused) {}
+
+        bool isCancelled() const { return _cancelled && *_cancelled; }
+        bool isPaused() const { return _paused && *_paused; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        int const writeId;
+        MongoNamespace const ns;
+        mongo::BSONObj const filter;
+        mongo::BSONObj const update;
+        long long const maxLagMs;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+        std::shared_ptr<std::atomic<bool>> _paused;
+    };
+
+    class ThrottledWriteProgressEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        static const int IntervalMs = 500;
+
+        struct Progress
+        {
+            long long total = -1;           // matching documents at start, -1 if not counted
+            long long processed = 0;        // removed, or modified by update
+            long long chunks = 0;
+            int chunkSize = 0;
+            long long lagMs = -1;           // -1 if there are no secondaries
+            long long throttledMs = 0;      // waited for secondaries
+            long long pausedMs = 0;
+            long long elapsedMs = 0;
+            bool paused = false;
+        };
+
+        ThrottledWriteProgressEvent(QObject *sender, int writeId, const Progress &progress) :
+            Event(sender),
+            writeId(writeId),
+            progress(progress) {}
+
+        int const writeId;
+        Progress const progress;
+    };
+
+    class ThrottledWriteResponse : public Event
+    {
+        R_EVENT
+
+    public:
+        ThrottledWriteResponse(QObject *sender, int writeId, const ThrottledWriteProgressEvent::Progress &progress) :
+            Event(sender),
+            writeId(writeId),
+            progress(progress) {}
+
+        /**
+         * @param progress Documents processed before the error
+         */
+        ThrottledWriteResponse(QObject *sender, int writeId, const EventError &error,
+                               const ThrottledWriteProgressEvent::Progress &progress) :
+            Event(sender, error),
+            writeId(writeId),
+            progress(progress) {}
+
+        int const writeId;
+        ThrottledWriteProgressEvent::Progress const progress;
+    };
+
+    /**
+     * @brief Runs captured find, aggregate and count commands again (see WorkloadReplay),
+     *        taken from system.profile of 'profileDatabase' or from lines of 'logFile'
+     */
+    class ReplayWorkloadRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        static const int MaxOperations = 100 * 1000;
+        static const int DefaultThreads = 8;
+
+        /**
+         * @param replayId Identifies request in progress and response events
+         * @param logFile Structured log or exported system.profile, empty to read profile
+         * @param sinceMs Only profile entries since this time (ms since epoch), 0 for all
+         * @param targetDatabase Database to run commands in, empty for the captured one
+         * @param speed Multiple of captured rate, 0 for as fast as possible
+         * @param cancelled Set by sender to stop, checked by worker before every operation
+         */
+        ReplayWorkloadRequest(QObject *sender, int replayId, const std::string &profileDatabase,
+                              const std::string &logFile, long long sinceMs, const std::string &targetDatabase,
+                              double speed, int threads, const std::shared_ptr<std::atomic<bool>> &cancelled) :
+            Event(sender),
+            replayId(replayId),
+            profileDatabase(profileDatabase),
+            logFile(logFile),
+            sinceMs(sinceMs),
+            targetDatabase(targetDatabase),
+            speed(speed),
+            threads(threads),
+            _cancelled(cancelled) {}
+
+        bool isCancelled() const { return _cancelled && *_cancelled; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        int const replayId;
+        std::string const profileDatabase;
+        std::string const logFile;
+        long long const sinceMs;
+        std::string const targetDatabase;
+        double const speed;
+        int const threads;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+
+    class ReplayWorkloadProgressEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        static const int IntervalMs = 500;
+
+        ReplayWorkloadProgressEvent(QObject *sender, int replayId, long long replayed, long long total,
+                                    long long errors, long long elapsedMs) :
+            Event(sender),
+            replayId(replayId),
+            replayed(replayed),
+            total(total),
+            errors(errors),
+            elapsedMs(elapsedMs) {}
+
+        int const replayId;
+        long long const replayed;
+        long long const total;
+        long long const errors;
+        long long const elapsedMs;
+    };
+
+    class ReplayWorkloadResponse : public Event
+    {
+        R_EVENT
+
+    public:
+        ReplayWorkloadResponse(QObject *sender, int replayId, const WorkloadReplay::Result &result) :
+            Event(sender),
+            replayId(replayId),
+            result(result) {}
+
+        ReplayWorkloadResponse(QObject *sender, int replayId, const EventError &error) :
+            Event(sender, error),
+            replayId(replayId) {}
+
+        int const replayId;
+        WorkloadReplay::Result const result;
+    };
+
+    /**
+     * @brief Saves cells edited in table view with one update command, in a transaction
+     *        where server supports it (see MongoClient::commitChangeset)
+     */
+    class CommitChangesetRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        /**
+         * @param changesetId Identifies request in response event
+         */
+        CommitChangesetRequest(QObject *sender, int changesetId, const MongoNamespace &ns,
+                               const std::vector<TableChangeset::Statement> &statements) :
+            Event(sender),
+            changesetId(changesetId),
+            ns(ns),
+            statements(statements) {}
+
+        int const changesetId;
+        MongoNamespace const ns;
+        std::vector<TableChangeset::Statement> const statements;
+    };
+
+    class CommitChangesetResponse : public Event
+    {
+        R_EVENT
+
+    public:
+        CommitChangesetResponse(QObject *sender, int changesetId, const TableChangeset::CommitResult &result) :
+            Event(sender),
+            changesetId(changesetId),
+            result(result) {}
+
+        CommitChangesetResponse(QObject *sender, int changesetId, const EventError &error) :
+            Event(sender, error),
+            changesetId(changesetId) {}
+
+        int const changesetId;
+        TableChangeset::CommitResult const result;
+    };
+
+    class ExecuteQueryResponse : public Event
+    {
+        R_EVENT
+
+        ExecuteQueryResponse(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo, const std::vector<MongoDocumentPtr> &documents,
+                             int batchIndex = 0, bool lastBatch = true) :
+            Event(sender),
+            resultIndex(resultIndex),
+            queryInfo(queryInfo),
+            documents(documents),
+            batchIndex(batchIndex),
+            lastBatch(lastBatch) { }
+
+        ExecuteQueryResponse(QObject *sender, const EventError &error) :
+            Event(sender, error) {}
+
+        int resultIndex;
+        MongoQueryInfo queryInfo;
+        std::vector<MongoDocumentPtr> documents;
+
+        // Query results are streamed one server batch per response. First batch (index 0) 
+        // replaces previous results, every next batch is appended to them.
+        int batchIndex = 0;
+        bool lastBatch = true;
+
+        bool prefetch = false;  // see ExecuteQueryRequest::isPrefetch()
+    };
+
+    class AutocompleteRequest : public Event
+    {
+        R_EVENT
+
+        AutocompleteRequest(QObject *sender, const std::string &prefix, const AutocompletionMode mode) :
+            Event(sender),
+            prefix(prefix),
+            mode(mode) {}
+
+        EventPriority priority() const override { return EventPriority::Interactive; }
+
+        std::string prefix;
+        AutocompletionMode mode;
+    };
+
+    class AutocompleteResponse : public Event
+    {
+        R_EVENT
+
+        AutocompleteResponse(QObject *sender, const QStringList &list, const std::string &prefix) :
+            Event(sender),
+            list(list),
+            prefix(prefix) {}
+
+        AutocompleteResponse(QObject *sender, const EventError &error) :
+            Event(sender, error) {}
+
+        QStringList list;
+        std::string prefix;
+    };
+
+
+    /**
+     * @brief ExecuteScript
+     */
+
+    class ExecuteScriptRequest : public Event
+    {
+        R_EVENT
+
+        ExecuteScriptRequest(QObject *sender, const std::string &script, const std::string &dbName, 
+                             AggrInfo aggrInfo = AggrInfo(), int take = 0, int skip = 0,
+                             bool profile = false, 
+                             const ReadPreferenceInfo &readPreference = ReadPreferenceInfo(),
+                             int maxTimeMs = 0, bool parallelReads = false) :
+            Event(sender),
+            script(script),
+            databaseName(dbName),
+            take(take),
+            skip(skip),
+            aggrInfo(aggrInfo),
+            profile(profile),
+            readPreference(readPreference),
+            maxTimeMs(maxTimeMs),
+            parallelReads(parallelReads)
+            {}
+
+        EventPriority priority() const override { return EventPriority::Interactive; }
+
+        std::string script;
+        std::string databaseName;
+        int take; //
+        int skip;
+        AggrInfo const aggrInfo;
+        bool const profile;     // collect explain() of find/aggregate statements, see ExplainInfo
+        ReadPreferenceInfo const readPreference;    // of shell connection, for this script and on
+        int const maxTimeMs;    // server time limit of finds and aggregations of script, 0 if none
+        bool const parallelReads;   // see SettingsManager::parallelReads()
+
+        // Already compiled form of script (see QueryTemplate), run without parsing it. Null if none.
+        std::shared_ptr<const NativeQuery> nativeQuery;
+    };
+
+    /**
+     * @brief Runs script file statement by statement, see ScriptEngine::execFile().
+     *        Replied with ExecuteScriptFileProgressEvent and then ExecuteScriptResponse.
+     */
+    class ExecuteScriptFileRequest : public Event
+    {
+        R_EVENT
+
+        ExecuteScriptFileRequest(QObject *sender, const QString &filePath, const std::string &dbName,
+                                 const ReadPreferenceInfo &readPreference = ReadPreferenceInfo(),
+                                 int maxTimeMs = 0) :
+            Event(sender),
+            filePath(filePath),
+            databaseName(dbName),
+            readPreference(readPreference),
+            maxTimeMs(maxTimeMs) {}
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        QString const filePath;
+        std::string const databaseName;
+        ReadPreferenceInfo const readPreference;
+        int const maxTimeMs;
+    };
+
+    class ExecuteScriptFileProgressEvent : public Event
+    {
+        R_EVENT
+
+        ExecuteScriptFileProgressEvent(QObject *sender, qint64 doneBytes, qint64 totalBytes,
+                                       long long statements) :
+            Event(sender),
+            doneBytes(doneBytes),
+            totalBytes(totalBytes),
+            statements(statements) {}
+
+        qint64 const doneBytes;
+        qint64 const totalBytes;
+        long long const statements;     // executed so far
+    };
+
+    class ExecuteScriptResponse : public Event
+    {
+        R_EVENT
+
+        ExecuteScriptResponse(QObject *sender, MongoShellExecResult result, bool empty,
+                              bool timeoutReached = false) :
+            Event(sender), result(std::move(result)), empty(empty), _timeoutReached(timeoutReached) {}
+
+        ExecuteScriptResponse(QObject *sender, const EventError &error, bool timeoutReached = false) :
+            Event(sender, error), _timeoutReached(timeoutReached) {}
+
+        bool timeoutReached() const { return _timeoutReached; }
+
+        MongoShellExecResult result;
+        bool empty;
+        bool const _timeoutReached = false;
+    };
+
+    class ConnectingEvent : public Event
+    {
+        R_EVENT
+
+        ConnectingEvent(QObject *sender) :
+            Event(sender) { }
+    };
+
+    /**
+     * @brief Progress of one connection opened by ConnectionStartup
+     */
+    class ConnectionStartupEvent : public Event
+    {
+        R_EVENT
+
+        enum State {
+            Queued,         // waits for a free slot, serverHandle is 0
+            Connecting,
+            Connected,
+            Failed
+        };
+
+        ConnectionStartupEvent(QObject *sender, ConnectionSettings *connection, State state,
+                               int serverHandle = 0) :
+            Event(sender),
+            connection(connection),
+            state(state),
+            serverHandle(serverHandle) { }
+
+        ConnectionSettings *const connection;   // as in connection list of SettingsManager
+        State const state;
+        int const serverHandle;
+    };
+
+    class OpeningShellEvent : public Event
+    {
+        R_EVENT
+
+        OpeningShellEvent(QObject *sender, MongoShell *shell) :
+            Event(sender),
+            shell(shell) {}
+
+        MongoShell *shell;
+    };
+
+    class ConnectionFailedEvent : public Event
+    {
+        R_EVENT
+
+        enum Reason {
+            MongoConnection    = 1,
+            MongoAuth          = 2,
+            SshConnection      = 3,
+            SshChannel         = 4,
+            SslConnection      = 5
+        };
+
+        ConnectionFailedEvent(QObject *sender, int serverHandle, ConnectionType connectionType,
+                              const std::string& message, Reason reason) :
+            Event(sender),
+            message(message),
+            reason(reason),
+            serverHandle(serverHandle),
+            connectionType(connectionType) {}
+
+        std::string message;
+        Reason reason;
+        ConnectionType connectionType;
+        int serverHandle;
+    };
+
+//    class ScriptExecute
+
+    struct ConnectionEstablishedEvent : public Event
+    {
+        R_EVENT
+
+        ConnectionEstablishedEvent(MongoServer *server, ConnectionType type, ConnectionInfo connInfo) :
+            Event((QObject *)server),
+            server(server),
+            connectionType(type),
+            connInfo(connInfo) { }       
+
+        MongoServer *server;
+        ConnectionType const connectionType;
+        ConnectionInfo const connInfo;
+    };
+
+    class DatabaseListLoadedEvent : public Event
+    {
+        R_EVENT
+
+        DatabaseListLoadedEvent(QObject *sender, const QList<MongoDatabase *> &list,
+                                const QList<MongoDatabase *> &added = QList<MongoDatabase *>(),
+                                const std::vector<std::string> &removed = std::vector<std::string>()) :
+            Event(sender),
+            list(list),
+            added(added),
+            removedNames(removed) { }
+
+        DatabaseListLoadedEvent(QObject *sender, const EventError &error) :
+            Event(sender, error) {}
+
+        QList<MongoDatabase *> list;            // all databases, in order of server
+        QList<MongoDatabase *> added;           // since the previous list, also in 'list'
+        std::vector<std::string> removedNames;  // since the previous list
+    };
+
+    class DocumentListLoadedEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        DocumentListLoadedEvent(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo, const std::string &query, const std::vector<MongoDocumentPtr> &docs,
+                                int batchIndex = 0, bool lastBatch = true) :
+            Event(sender),
+            _resultIndex(resultIndex),
+            _queryInfo(queryInfo),
+            _query(query),
+            _documents(docs),
+            _batchIndex(batchIndex),
+            _lastBatch(lastBatch) { }
+
+        DocumentListLoadedEvent(QObject *sender, const EventError &error) :
+            Event(sender, error) {}
+
+        int resultIndex() const { return _resultIndex; }
+        MongoQueryInfo queryInfo() const { return _queryInfo; }
+        std::vector<MongoDocumentPtr> documents() const { return _documents; }
+        std::string query() const { return _query; }
+        int batchIndex() const { return _batchIndex; }
+        bool isFirstBatch() const { return _batchIndex == 0; }
+        bool isLastBatch() const { return _lastBatch; }
+
+    private:
+        int _resultIndex;
+        MongoQueryInfo _queryInfo;
+        std::vector<MongoDocumentPtr> _documents;
+        std::string _query;
+        int _batchIndex = 0;
+        bool _lastBatch = true;
+    };
+
+    /**
+     * @brief Published by MongoShell, when page of query result part was read ahead
+     */
+    class PagePrefetchedEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        PagePrefetchedEvent(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo,
+                            const std::vector<MongoDocumentPtr> &documents) :
+            Event(sender),
+            resultIndex(resultIndex),
+            queryInfo(queryInfo),
+            documents(documents) {}
+
+        int const resultIndex;
+        MongoQueryInfo const queryInfo;
+        std::vector<MongoDocumentPtr> const documents;
+    };
+
+    /**
+     * @brief Reads page of aggregation result part from aggregation cursor kept open by worker
+     *        under 'cursorKey', so that the pipeline is not run again for the next pages.
+     *        Response is published by MongoShell too.
+     */
+    class AggregatePageRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        /**
+         * @param aggrInfo Aggregation with skip and batch size of page
+         * @param reread Cursor is opened again, so that current results are read (explicit refresh)
+         */
+        AggregatePageRequest(QObject *sender, int resultIndex, const AggrInfo &aggrInfo,
+                             unsigned long long cursorKey, bool reread) :
+            Event(sender),
+            resultIndex(resultIndex),
+            aggrInfo(aggrInfo),
+            cursorKey(cursorKey),
+            reread(reread) {}
+
+        EventPriority priority() const override { return EventPriority::Interactive; }
+
+        int const resultIndex;
+        AggrInfo const aggrInfo;
+        unsigned long long const cursorKey;
+        bool const reread;
+    };
+
+    class AggregatePageResponse : public Event
+    {
+        R_EVENT
+
+    public:
+        AggregatePageResponse(QObject *sender, int resultIndex, const AggrInfo &aggrInfo,
+                              const std::vector<MongoDocumentPtr> &documents) :
+            Event(sender),
+            resultIndex(resultIndex),
+            aggrInfo(aggrInfo),
+            documents(documents) {}
+
+        AggregatePageResponse(QObject *sender, int resultIndex, const EventError &error) :
+            Event(sender, error), 
+            resultIndex(resultIndex) {}
+
+        int resultIndex;
+        AggrInfo aggrInfo;
+        std::vector<MongoDocumentPtr> documents;
+    };
+
+    /**
+     * @brief Runs every prefix of aggregation pipeline on the first 'sampleSize' input
+     *        documents, on several connections at once (see PipelinePreview).
+     *        Response is published by MongoShell too.
+     */
+    class PipelinePreviewRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        PipelinePreviewRequest(QObject *sender, const AggrInfo &aggrInfo, int sampleSize) :
+            Event(sender),
+            aggrInfo(aggrInfo),
+            sampleSize(sampleSize) {}
+
+        EventPriority priority() const override { return EventPriority::Interactive; }
+
+        AggrInfo const aggrInfo;
+        int const sampleSize;
+    };
+
+    class PipelinePreviewResponse : public Event
+    {
+        R_EVENT
+
+    public:
+        /**
+         * @param stages Result of every previewed stage, in pipeline order. Failed prefix 
+         *        has its error set, the other ones are still shown.
+         */
+        PipelinePreviewResponse(QObject *sender, const AggrInfo &aggrInfo, 
+                                std::vector<PipelinePreview::StageResult> stages, int sampleSize,
+                                long long elapsedMs) :
+            Event(sender),
+            aggrInfo(aggrInfo),
+            stages(std::move(stages)),
+            sampleSize(sampleSize),
+            elapsedMs(elapsedMs) {}
+
+        PipelinePreviewResponse(QObject *sender, const AggrInfo &aggrInfo, const EventError &error) :
+            Event(sender, error),
+            aggrInfo(aggrInfo) {}
+
+        AggrInfo aggrInfo;
+        std::vector<PipelinePreview::StageResult> stages;
+        int sampleSize = 0;
+        long long elapsedMs = 0;
+    };
+
+    /**
+     * @brief Groups values of one field of documents matching query on server, see
+     *        FieldDistribution. Response is published by MongoShell too.
+     * @param sampleSize Documents grouped, 0 for all matching ones
+     */
+    class FieldDistributionRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        FieldDistributionRequest(QObject *sender, const MongoQueryInfo &queryInfo, const std::string &field,
+                                 int topCount, int sampleSize, int maxTimeMs) :
+            Event(sender),
+            queryInfo(queryInfo),
+            field(field),
+            topCount(topCount),
+            sampleSize(sampleSize),
+            maxTimeMs(maxTimeMs) {}
+
+        EventPriority priority() const override { return EventPriority::Interactive; }
+
+        MongoQueryInfo const queryInfo;
+        std::string const field;
+        int const topCount;
+        int const sampleSize;
+        int const maxTimeMs;
+    };
+
+    class FieldDistributionResponse : public Event
+    {
+        R_EVENT
+
+    public:
+        FieldDistributionResponse(QObject *sender, const MongoQueryInfo &queryInfo, 
+                                  FieldDistribution::Result result, int sampleSize, long long elapsedMs) :
+            Event(sender),
+            queryInfo(queryInfo),
+            result(std::move(result)),
+            sampleSize(sampleSize),
+            elapsedMs(elapsedMs) {}
+
+        FieldDistributionResponse(QObject *sender, const MongoQueryInfo &queryInfo, const EventError &error) :
+            Event(sender, error),
+            queryInfo(queryInfo) {}
+
+        MongoQueryInfo queryInfo;
+        FieldDistribution::Result result;
+        int sampleSize = 0;
+        long long elapsedMs = 0;
+    };
+
+    /**
+     * @brief Buckets values of one field of documents matching query on server, see
+     *        FieldBuckets. Response is published by MongoShell too.
+     * @param bucketsId Tells responses to requests of one chart from others
+     */
+    class FieldBucketsRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        FieldBucketsRequest(QObject *sender, int bucketsId, const MongoQueryInfo &queryInfo, 
+                            const std::string &field, const FieldBuckets::Spec &spec, int maxTimeMs) :
+            Event(sender),
+            bucketsId(bucketsId),
+            queryInfo(queryInfo),
+            field(field),
+            spec(spec),
+            maxTimeMs(maxTimeMs) {}
+
+        EventPriority priority() const override { return EventPriority::Interactive; }
+
+        int const bucketsId;
+        MongoQueryInfo const queryInfo;
+        std::string const field;
+        FieldBuckets::Spec const spec;
+        int const maxTimeMs;
+    };
+
+    class FieldBucketsResponse : public Event
+    {
+        R_EVENT
+
+    public:
+        FieldBucketsResponse(QObject *sender, int bucketsId, FieldBuckets::Result result, long long elapsedMs) :
+            Event(sender),
+            bucketsId(bucketsId),
+            result(std::move(result)),
+            elapsedMs(elapsedMs) {}
+
+        FieldBucketsResponse(QObject *sender, int bucketsId, const EventError &error) :
+            Event(sender, error),
+            bucketsId(bucketsId) {}
+
+        int bucketsId;
+        FieldBuckets::Result result;
+        long long elapsedMs = 0;
+    };
+
+    /**
+     * @brief Published by MongoShell, when total count of query result part is known
+     */
+    class DocumentsCountedEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        DocumentsCountedEvent(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo,
+                              long long count, bool estimated) :
+            Event(sender),
+            resultIndex(resultIndex),
+            queryInfo(queryInfo),
+            count(count),
+            estimated(estimated) {}
+
+        int const resultIndex;
+        MongoQueryInfo const queryInfo;
+        long long const count;
+        bool const estimated;
+    };
+
+    /**
+     * @brief Published by Notifier, when documents of collection are inserted, edited or
+     *        removed from output views, so that cached pages of this collection are dropped.
+     */
+    class DocumentsChangedEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        DocumentsChangedEvent(QObject *sender, const CollectionInfo &info) :
+            Event(sender), _info(info) {}
+
+        CollectionInfo const& info() const { return _info; }
+
+    private:
+        CollectionInfo _info;
+    };
+
+    class ScriptExecutedEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        ScriptExecutedEvent(QObject *sender, MongoShellExecResult result, bool empty,
+                            bool timeoutReached = false) :
+            Event(sender), _result(std::move(result)), _empty(empty), _timeoutReached(timeoutReached) {}
+
+        ScriptExecutedEvent(QObject *sender, const EventError &error, bool timeoutReached = false) :
+            Event(sender, error), _timeoutReached(timeoutReached) {}
+
+        MongoShellExecResult const& result() const { return _result; }
+
+        // Result is taken by QueryWidget of the shell, other subscribers do not read it
+        MongoShellExecResult takeResult() { return std::move(_result); }
+        bool empty() const { return _empty; }
+        bool timeoutReached() const { return _timeoutReached; }
+
+    private:
+        MongoShellExecResult _result;
+        bool _empty;
+        bool const _timeoutReached = false;
+    };
+
+    class ScriptExecutingEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        ScriptExecutingEvent(QObject *sender) :
+            Event(sender) { }
+    };
+
+    class OperationFailedEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        OperationFailedEvent(QObject *sender, const std::string &technicalErrorMessage, const std::string &userFriendlyErrorMessage) :
+            technicalErrorMessage(technicalErrorMessage),
+            userFriendlyErrorMessage(userFriendlyErrorMessage),
+            Event(sender) { }
+
+        std::string technicalErrorMessage;
+        std::string userFriendlyErrorMessage;
+    };
+
+    class QueryWidgetUpdatedEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        QueryWidgetUpdatedEvent(QObject *sender, int numOfResults) :
+            Event(sender),
+          _numOfResults(numOfResults) { }
+
+        int numOfResults() const { return _numOfResults; }
+
+    private:
+        int _numOfResults;
+    };
+
+    /**
+     * @brief Establish SSH Connection
+     */
+
+    class EstablishSshConnectionRequest : public Event
+    {
+    R_EVENT
+
+        EstablishSshConnectionRequest(QObject *sender, int serverHandle, SshTunnelWorker* worker, ConnectionSettings* settings, ConnectionType connectionType) :
+            Event(sender),
+            worker(worker),
+            settings(settings),
+            serverHandle(serverHandle),
+            connectionType(connectionType) {}
+
+        ConnectionSettings* settings;
+        ConnectionType connectionType;
+        SshTunnelWorker* worker;
+        int serverHandle;
+    };
+
+    class EstablishSshConnectionResponse : public Event
+    {
+    R_EVENT
+
+        EstablishSshConnectionResponse(QObject *sender, int serverHandle, SshTunnelWorker* worker, ConnectionSettings* settings, ConnectionType connectionType, int localport) :
+            Event(sender),
+            worker(worker),
+            settings(settings),
+            connectionType(connectionType),
+            serverHandle(serverHandle),
+            localport(localport) {}
+
+        EstablishSshConnectionResponse(QObject *sender, int serverHandle, const EventError &error, SshTunnelWorker* worker, ConnectionSettings* settings, ConnectionType connectionType) :
+            Event(sender, error),
+            worker(worker),
+            settings(settings),
+            serverHandle(serverHandle),
+            connectionType(connectionType) {}
+
+        ConnectionSettings* settings;
+        ConnectionType connectionType;
+        SshTunnelWorker* worker;
+        int localport;
+        int serverHandle;
+    };
+
+    /**
+     * @brief Start listening on all opened sockets (SSH tunnel)
+     */
+
+    class ListenSshConnectionRequest : public Event
+    {
+    R_EVENT
+
+        ListenSshConnectionRequest(QObject *sender, int serverHandle, ConnectionType connectionType) :
+            Event(sender),
+            serverHandle(serverHandle),
+            connectionType(connectionType) {}
+
+        ConnectionType connectionType;
+        int serverHandle;
+    };
+
+    class ListenSshConnectionResponse : public Event
+    {
+    R_EVENT
+
+        ListenSshConnectionResponse(QObject *sender, int serverHandle, ConnectionSettings* settings, ConnectionType connectionType) :
+            Event(sender),
+            settings(settings),
+            serverHandle(serverHandle),
+            connectionType(connectionType) {}
+
+        ListenSshConnectionResponse(QObject *sender, const EventError &error, int serverHandle, ConnectionSettings* settings, ConnectionType connectionType) :
+            Event(sender, error),
+            settings(settings),
+            serverHandle(serverHandle),
+            connectionType(connectionType) {}
+
+        ConnectionSettings* settings;
+        ConnectionType connectionType;
+        int serverHandle;
+    };
+
+    class LogEvent : public Event
+    {
+    R_EVENT
+
+        enum LogLevel {
+            RBM_ERROR  = 1,
+            RBM_WARN   = 2,
+            RBM_INFO   = 3,
+            RBM_DEBUG  = 100 // log as much as possible
+        };
+
+        LogEvent(QObject *sender, const std::string& message, LogLevel level, 
+                 bool const informUser = false) 
+            : Event(sender), message(message), level(level), informUser(informUser)
+        {}
+
+        bool isBatched() const override { return true; }
+
+        std::string severity() const {
+            switch (level) {
+                case RBM_ERROR : return "Error";
+                case RBM_WARN  : return "Warning";
+                case RBM_INFO  : return "Info";
+                case RBM_DEBUG : return "Debug";
+                default: return "Undefined";
+            }
+        }
+
+        QMessageBox::Icon qMessageBoxIcon() const {
+            switch (level) {
+                case RBM_ERROR: return QMessageBox::Icon::Critical;
+                case RBM_WARN: return QMessageBox::Icon::Warning;
+                case RBM_INFO: return QMessageBox::Icon::Information;
+                case RBM_DEBUG: return QMessageBox::Icon::Information;
+                default: return QMessageBox::Icon::Information;
+            }
+        }
+
+        mongo::logger::LogSeverity mongoLogSeverity() const {
+            switch (level) {
+                case RBM_ERROR: return mongo::logger::LogSeverity::Error();
+                case RBM_WARN: return mongo::logger::LogSeverity::Warning();
+                case RBM_INFO: return mongo::logger::LogSeverity::Info();
+                case RBM_DEBUG: return mongo::logger::LogSeverity::Log();
+                default: return mongo::logger::LogSeverity::Info();
+            }
+        }
+
+        std::string message;
+        LogLevel level;
+        bool const informUser = false;
+    };
+
+    class StopScriptRequest : public Event
+    {
+    R_EVENT
+
+        StopScriptRequest(QObject *sender) :
+            Event(sender) {}
+
+        EventPriority priority() const override { return EventPriority::Interactive; }
+    };
+
+    /**
+     * @brief Kills server operations and idle cursors of connections with these client 
+     *        addresses. Sent to metadata worker, while the worker with these connections is busy.
+     */
+    class KillOperationsRequest : public Event
+    {
+    R_EVENT
+
+        KillOperationsRequest(QObject *sender, const std::vector<std::string> &clientAddresses) :
+            Event(sender), clientAddresses(clientAddresses) {}
+
+        EventPriority priority() const override { return EventPriority::Interactive; }
+
+        std::vector<std::string> clientAddresses;
+    };
+
+    class KillOperationsResponse : public Event
+    {
+    R_EVENT
+
+        KillOperationsResponse(QObject *sender, int killedOps, int killedCursors) :
+            Event(sender), killedOps(killedOps), killedCursors(killedCursors) {}
+
+        KillOperationsResponse(QObject *sender, const EventError &error) :
+            Event(sender, error) {}
+
+        int killedOps = 0;
+        int killedCursors = 0;
+    };
+
+    /**
+     * @brief Lists in-progress operations matching 'filter' (see MongoClient::currentOps()).
+     *        Polled by operations monitor, so it waits behind explorer requests.
+     */
+    class CurrentOpsRequest : public Event
+    {
+    R_EVENT
+
+        CurrentOpsRequest(QObject *sender, int monitorId, const mongo::BSONObj &filter, int limit) :
+            Event(sender), monitorId(monitorId), filter(filter), limit(limit) {}
+
+        EventPriority priority() const override { return EventPriority::Background; }
+        std::string coalescingKey() const override { return "currentOps:" + std::to_string(monitorId); }
+
+        int const monitorId;
+        mongo::BSONObj const filter;
+        int const limit;
+    };
+
+    class CurrentOpsResponse : public Event
+    {
+    R_EVENT
+
+        CurrentOpsResponse(QObject *sender, int monitorId, const std::vector<mongo::BSONObj> &ops,
+                           long long elapsedMs) :
+            Event(sender), monitorId(monitorId), ops(ops), elapsedMs(elapsedMs) {}
+
+        CurrentOpsResponse(QObject *sender, int monitorId, const EventError &error) :
+            Event(sender, error), monitorId(monitorId) {}
+
+        int monitorId;
+        std::vector<mongo::BSONObj> ops;
+        long long elapsedMs = 0;
+    };
+
+    /**
+     * @brief Kills operations with killOp, one failed operation does not stop the others
+     */
+    class KillOpRequest : public Event
+    {
+    R_EVENT
+
+        /**
+         * @param opids Objects of form { op: <opid> }
+         */
+        KillOpRequest(QObject *sender, int monitorId, const std::vector<mongo::BSONObj> &opids) :
+            Event(sender), monitorId(monitorId), opids(opids) {}
+
+        EventPriority priority() const override { return EventPriority::Interactive; }
+
+        int const monitorId;
+        std::vector<mongo::BSONObj> const opids;
+    };
+
+    class KillOpResponse : public Event
+    {
+    R_EVENT
+
+        KillOpResponse(QObject *sender, int monitorId, int killed, const std::vector<std::string> &errors) :
+            Event(sender), monitorId(monitorId), killed(killed), errors(errors) {}
+
+        int const monitorId;
+        int const killed;
+        std::vector<std::string> const errors;
+    };
+
+    /**
+     * @brief Samples serverStatus for server status dashboard, waits behind explorer requests
+     */
+    class ServerStatusRequest : public Event
+    {
+    R_EVENT
+
+        ServerStatusRequest(QObject *sender, int monitorId) :
+            Event(sender), monitorId(monitorId) {}
+
+        EventPriority priority() const override { return EventPriority::Background; }
+        std::string coalescingKey() const override { return "serverStatus:" + std::to_string(monitorId); }
+
+        int const monitorId;
+    };
+
+    class ServerStatusResponse : public Event
+    {
+    R_EVENT
+
+        ServerStatusResponse(QObject *sender, int monitorId, const mongo::BSONObj &status) :
+            Event(sender), monitorId(monitorId), status(status) {}
+
+        ServerStatusResponse(QObject *sender, int monitorId, const EventError &error) :
+            Event(sender, error), monitorId(monitorId) {}
+
+        int monitorId;
+        mongo::BSONObj status;
+    };
+
+    /**
+     * @brief Reads system.profile of database grouped by query shape (see MongoClient::profileSummary())
+     */
+    class ProfileSummaryRequest : public Event
+    {
+    R_EVENT
+
+        ProfileSummaryRequest(QObject *sender, int summaryId, const std::string &databaseName,
+                              long long sinceMs, int minMillis, int limit) :
+            Event(sender),
+            summaryId(summaryId),
+            databaseName(databaseName),
+            sinceMs(sinceMs),
+            minMillis(minMillis),
+            limit(limit) {}
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        int const summaryId;
+        std::string const databaseName;
+        long long const sinceMs;
+        int const minMillis;
+        int const limit;
+    };
+
+    class ProfileSummaryResponse : public Event
+    {
+    R_EVENT
+
+        /**
+         * @param profilingLevel Level of database (0, 1, 2), -1 if it cannot be read
+         */
+        ProfileSummaryResponse(QObject *sender, int summaryId, const std::vector<ProfileShapeInfo> &shapes,
+                               int profilingLevel, int slowMs, long long elapsedMs) :
+            Event(sender),
+            summaryId(summaryId),
+            shapes(shapes),
+            profilingLevel(profilingLevel),
+            slowMs(slowMs),
+            elapsedMs(elapsedMs) {}
+
+        ProfileSummaryResponse(QObject *sender, int summaryId, const EventError &error) :
+            Event(sender, error), summaryId(summaryId) {}
+
+        int summaryId;
+        std::vector<ProfileShapeInfo> shapes;
+        int profilingLevel = -1;
+        int slowMs = 0;
+        long long elapsedMs = 0;
+    };
+
+    /**
+     * @brief Reads plan cache of collection ($planCacheStats, see MongoClient::planCacheStats()),
+     *        waits behind explorer requests
+     */
+    class PlanCacheRequest : public Event
+    {
+    R_EVENT
+
+        PlanCacheRequest(QObject *sender, int cacheId, const MongoNamespace &ns, int limit) :
+            Event(sender), cacheId(cacheId), ns(ns), limit(limit) {}
+
+        EventPriority priority() const override { return EventPriority::Background; }
+        std::string coalescingKey() const override { return "planCache:" + std::to_string(cacheId); }
+
+        int const cacheId;
+        MongoNamespace const ns;
+        int const limit;
+    };
+
+    class PlanCacheResponse : public Event
+    {
+    R_EVENT
+
+        PlanCacheResponse(QObject *sender, int cacheId, const std::vector<PlanCacheEntryInfo> &entries,
+                          long long elapsedMs) :
+            Event(sender), cacheId(cacheId), entries(entries), elapsedMs(elapsedMs) {}
+
+        PlanCacheResponse(QObject *sender, int cacheId, const EventError &error) :
+            Event(sender, error), cacheId(cacheId) {}
+
+        int cacheId;
+        std::vector<PlanCacheEntryInfo> entries;
+        long long elapsedMs = 0;
+    };
+
+    /**
+     * @brief Counts chunks of sharded collection per shard and reads balancer activity
+     *        (see MongoClient::shardDistribution()), waits behind explorer requests
+     */
+    class ShardDistributionRequest : public Event
+    {
+    R_EVENT
+
+        ShardDistributionRequest(QObject *sender, int distributionId, const MongoNamespace &ns, long long sinceMs) :
+            Event(sender), distributionId(distributionId), ns(ns), sinceMs(sinceMs) {}
+
+        EventPriority priority() const override { return EventPriority::Background; }
+        std::string coalescingKey() const override { return "shardDistribution:" + std::to_string(distributionId); }
+
+        int const distributionId;
+        MongoNamespace const ns;
+        long long const sinceMs;
+    };
+
+    class ShardDistributionResponse : public Event
+    {
+    R_EVENT
+
+        ShardDistributionResponse(QObject *sender, int distributionId, const ShardDistribution::Snapshot &snapshot,
+                                  long long elapsedMs) :
+            Event(sender), distributionId(distributionId), snapshot(snapshot), elapsedMs(elapsedMs) {}
+
+        ShardDistributionResponse(QObject *sender, int distributionId, const EventError &error) :
+            Event(sender, error), distributionId(distributionId) {}
+
+        int distributionId;
+        ShardDistribution::Snapshot snapshot;
+        long long elapsedMs = 0;
+    };
+
+    /**
+     * @brief Lists files of GridFS bucket, see MongoClient::gridFsFiles()
+     */
+    class GridFsFilesRequest : public Event
+    {
+    R_EVENT
+
+        GridFsFilesRequest(QObject *sender, int listId, const std::string &dbName, const std::string &bucket,
+                           const std::string &filename, int limit) :
+            Event(sender), listId(listId), dbName(dbName), bucket(bucket), filename(filename), limit(limit) {}
+
+        int const listId;
+        std::string const dbName;
+        std::string const bucket;
+        std::string const filename;     // part of filename, empty for all files
+        int const limit;
+    };
+
+    class GridFsFilesResponse : public Event
+    {
+    R_EVENT
+
+        GridFsFilesResponse(QObject *sender, int listId, const std::vector<GridFs::FileInfo> &files,
+                            long long elapsedMs) :
+            Event(sender), listId(listId), files(files), elapsedMs(elapsedMs) {}
+
+        GridFsFilesResponse(QObject *sender, int listId, const EventError &error) :
+            Event(sender, error), listId(listId) {}
+
+        int listId;
+        std::vector<GridFs::FileInfo> files;
+        long long elapsedMs = 0;
+    };
+
+    /**
+     * @brief Downloads file of GridFS bucket to disk or uploads file from disk into bucket,
+     *        ranges of chunks in flight on several connections (see GridFs). Worker replies
+     *        with GridFsTransferProgressEvent every GridFsTransferProgressEvent::IntervalMs,
+     *        then with GridFsTransferResponse.
+     */
+    class GridFsTransferRequest : public Event
+    {
+    R_EVENT
+
+        enum Direction { Download, Upload };
+
+        /**
+         * @param file File to download. Name and content type of upload, the rest is set by worker.
+         * @param cancelled Set by sender to stop, checked by worker before every range of chunks
+         */
+        GridFsTransferRequest(QObject *sender, int transferId, Direction direction, const std::string &dbName,
+                              const std::string &bucket, const GridFs::FileInfo &file, const QString &filePath,
+                              const std::shared_ptr<std::atomic<bool>> &cancelled) :
+            Event(sender),
+            transferId(transferId),
+            direction(direction),
+            dbName(dbName),
+            bucket(bucket),
+            file(file),
+            filePath(filePath),
+            _cancelled(cancelled) {}
+
+        bool isCancelled() const { return _cancelled && *_cancelled; }
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        int const transferId;
+        Direction const direction;
+        std::string const dbName;
+        std::string const bucket;
+        GridFs::FileInfo const file;
+        QString const filePath;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+
+    class GridFsTransferProgressEvent : public Event
+    {
+    R_EVENT
+
+        static const int IntervalMs = 250;
+
+        GridFsTransferProgressEvent(QObject *sender, int transferId, long long bytes, long long total,
+                                    long long elapsedMs) :
+            Event(sender), transferId(transferId), bytes(bytes), total(total), elapsedMs(elapsedMs) {}
+
+        int const transferId;
+        long long const bytes;          // written to disk or inserted
+        long long const total;
+        long long const elapsedMs;
+    };
+
+    class GridFsTransferResponse : public Event
+    {
+    R_EVENT
+
+        GridFsTransferResponse(QObject *sender, int transferId, const GridFs::FileInfo &file, long long elapsedMs) :
+            Event(sender), transferId(transferId), file(file), elapsedMs(elapsedMs) {}
+
+        GridFsTransferResponse(QObject *sender, int transferId, const EventError &error) :
+            Event(sender, error), transferId(transferId) {}
+
+        int transferId;
+        GridFs::FileInfo file;          // downloaded or uploaded one
+        long long elapsedMs = 0;
+    };
+
+    /**
+     * @brief Runs find or aggregate with explain at "executionStats" verbosity, see ExplainPlan
+     */
+    class ExplainRequest : public Event
+    {
+    R_EVENT
+
+        /**
+         * @param command Command to explain, i.e. { find: "coll", filter: ..., sort: ... }
+         */
+        ExplainRequest(QObject *sender, int explainId, const std::string &databaseName, 
+                       const mongo::BSONObj &command) :
+            Event(sender),
+            explainId(explainId),
+            databaseName(databaseName),
+            command(command) {}
+
+        EventPriority priority() const override { return EventPriority::Interactive; }
+
+        int const explainId;
+        std::string const databaseName;
+        mongo::BSONObj const command;
+    };
+
+    class ExplainResponse : public Event
+    {
+    R_EVENT
+
+        /**
+         * @param explain Result of explain command, 'plan' is parsed from it
+         */
+        ExplainResponse(QObject *sender, int explainId, const ExplainPlan::Plan &plan, 
+                        const mongo::BSONObj &explain, long long elapsedMs) :
+            Event(sender),
+            explainId(explainId),
+            plan(plan),
+            explain(explain),
+            elapsedMs(elapsedMs) {}
+
+        ExplainResponse(QObject *sender, int explainId, const EventError &error) :
+            Event(sender, error), explainId(explainId) {}
+
+        int explainId;
+        ExplainPlan::Plan plan;
+        mongo::BSONObj explain;
+        long long elapsedMs = 0;
+    };
+
+    /**
+     * @brief Adds or edits index with steps of RollingIndexBuild, so that collection is not
+     *        left without index meanwhile
+     */
+    class RollingIndexBuildRequest : public Event
+    {
+    R_EVENT
+
+        /**
+         * @param oldInfo Edited index, without name for a new index
+         */
+        RollingIndexBuildRequest(QObject *sender, const IndexInfo &oldInfo, const IndexInfo &newInfo) :
+            Event(sender),
+            oldInfo(oldInfo),
+            newInfo(newInfo) {}
+
+        EventPriority priority() const override { return EventPriority::Background; }
+
+        IndexInfo const oldInfo;
+        IndexInfo const newInfo;
+    };
+
+    class RollingIndexBuildProgressEvent : public Event
+    {
+    R_EVENT
+
+    public:
+        static const int IntervalMs = 1000;
+
+        RollingIndexBuildProgressEvent(QObject *sender, const IndexInfo &newInfo, int step, int steps,
+                                       const std::string &description, long long done = 0, 
+                                       long long total = 0) :
+            Event(sender),
+            newInfo(newInfo),
+            step(step),
+            steps(steps),
+            description(description),
+            done(done),
+            total(total) {}
+
+        IndexInfo const newInfo;
+        int const step;                 // from 0
+        int const steps;
+        std::string const description;  // see RollingIndexBuild::describe()
+        long long const done;           // of current phase of build, 0 of 0 if unknown
+        long long const total;
+    };
+
+    class RollingIndexBuildResponse : public Event
+    {
+    R_EVENT
+
+        RollingIndexBuildResponse(QObject *sender, const IndexInfo &oldInfo, const IndexInfo &newInfo,
+                                  long long elapsedMs) :
+            Event(sender),
+            oldInfo(oldInfo),
+            newInfo(newInfo),
+            elapsedMs(elapsedMs) {}
+
+        RollingIndexBuildResponse(QObject *sender, const IndexInfo &oldInfo, const IndexInfo &newInfo,
+                                  const EventError &error) :
+            Event(sender, error),
+            oldInfo(oldInfo),
+            newInfo(newInfo) {}
+
+        IndexInfo oldInfo;
+        IndexInfo newInfo;
+        long long elapsedMs = 0;
+    };
+
+    /**
+     * @brief Queries every shard of sharded collection directly, see ShardFanout
+     */
+    class ShardFanoutRequest : public Event
+    {
+    R_EVENT
+
+        /**
+         * @param limit Most documents returned (and read from every chunk range)
+         * @param readFromSecondaries Query secondaries of shard replica sets
+         */
+        ShardFanoutRequest(QObject *sender, int fanoutId, const MongoNamespace &ns, 
+                           const mongo::BSONObj &filter, const mongo::BSONObj &projection, 
+                           const mongo::BSONObj &sort, int limit, bool readFromSecondaries) :
+            Event(sender),
+            fanoutId(fanoutId),
+            ns(ns),
+            filter(filter),
+            projection(projection),
+            sort(sort),
+            limit(limit),
+            readFromSecondaries(readFromSecondaries) {}
+
+        EventPriority priority() const override { return EventPriority::Interactive; }
+
+        int const fanoutId;
+        MongoNamespace const ns;
+        mongo::BSONObj const filter;
+        mongo::BSONObj const projection;
+        mongo::BSONObj const sort;
+        int const limit;
+        bool const readFromSecondaries;
+    };
+
+    class ShardFanoutResponse : public Event
+    {
+    R_EVENT
+
+        ShardFanoutResponse(QObject *sender, int fanoutId, const std::vector<MongoDocumentPtr> &documents,
+                            const std::vector<ShardFanout::ShardResult> &shards, long long elapsedMs) :
+            Event(sender),
+            fanoutId(fanoutId),
+            documents(documents),
+            shards(shards),
+            elapsedMs(elapsedMs) {}
+
+        ShardFanoutResponse(QObject *sender, int fanoutId, const EventError &error) :
+            Event(sender, error), fanoutId(fanoutId) {}
+
+        int fanoutId;
+        std::vector<MongoDocumentPtr> documents;   // merged in sort order
+        std::vector<ShardFanout::ShardResult> shards;
+        long long elapsedMs = 0;
+    };
+
+    /**
+     * @brief Follows creation, drop and rename of namespaces with change stream of the whole
+     *        deployment, see NamespaceChanges. It runs until it is cancelled, between other
+     *        requests of worker (see MongoWorker::continueLater()). NamespaceChangesEvent are replied meanwhile, WatchNamespaceChangesResponse at the end.
+     */
+    class WatchNamespaceChangesRequest : public Event
+    {
+    R_EVENT
+
+        /**
+         * @param cancelled Set by sender to close the stream, checked about every AwaitMs
+         */
+        WatchNamespaceChangesRequest(QObject *sender, const std::shared_ptr<std::atomic<bool>> &cancelled) :
+            Event(sender),
+            cancelled(cancelled) {}
+
+        static const int AwaitMs = 1000;
+
+        EventPriority priority() const override { return EventPriority::Background; }
+        bool isCancelled() const { return cancelled && *cancelled; }
+
+        std::shared_ptr<std::atomic<bool>> const cancelled;
+    };
+
+    class NamespaceChangesEvent : public Event
+    {
+    R_EVENT
+
+        NamespaceChangesEvent(QObject *sender, const std::vector<NamespaceChanges::Change> &changes) :
+            Event(sender),
+            changes(changes) {}
+
+        std::vector<NamespaceChanges::Change> const changes;     // in order of the stream
+    };
+
+    class WatchNamespaceChangesResponse : public Event
+    {
+    R_EVENT
+
+        WatchNamespaceChangesResponse(QObject *sender) :
+            Event(sender) {}
+
+        WatchNamespaceChangesResponse(QObject *sender, const EventError &error) :
+            Event(sender, error) {}
+    };
+
+    /**
+     * @brief Tails local.oplog.rs with entries matching filter, see OplogTail. It runs until
+     *        it is cancelled, between other requests of worker. OplogEntriesEvent are replied meanwhile, at most
+     *        one per CoalesceMs, and TailOplogResponse at the end.
+     */
+    class TailOplogRequest : public Event
+    {
+    R_EVENT
+
+        /**
+         * @param cancelled Set by sender to close the cursor, checked about every AwaitMs
+         */
+        TailOplogRequest(QObject *sender, int tailId, const OplogTail::Filter &filter,
+                         const std::shared_ptr<std::atomic<bool>> &cancelled) :
+            Event(sender),
+            tailId(tailId),
+            filter(filter),
+            cancelled(cancelled) {}
+
+        static const int AwaitMs = 1000;
+        static const int CoalesceMs = 100;
+        static const int BatchSize = 5000;
+
+        EventPriority priority() const override { return EventPriority::Background; }
+        bool isCancelled() const { return cancelled && *cancelled; }
+
+        int const tailId;
+        OplogTail::Filter const filter;
+        std::shared_ptr<std::atomic<bool>> const cancelled;
+    };
+
+    class OplogEntriesEvent : public Event
+    {
+    R_EVENT
+
+        OplogEntriesEvent(QObject *sender, int tailId, const std::vector<mongo::BSONObj> &entries) :
+            Event(sender),
+            tailId(tailId),
+            entries(entries) {}
+
+        int const tailId;
+        std::vector<mongo::BSONObj> const entries;     // in order of the oplog
+    };
+
+    class TailOplogResponse : public Event
+    {
+    R_EVENT
+
+        TailOplogResponse(QObject *sender, int tailId) :
+            Event(sender),
+            tailId(tailId) {}
+
+        TailOplogResponse(QObject *sender, int tailId, const EventError &error) :
+            Event(sender, error),
+            tailId(tailId) {}
+
+        int const tailId;
+    };
+
+    /**
+     * @brief Keeps change stream of one collection open with events matching filter, see
+     *        ChangeStreamWatch. It runs until it is cancelled, between other requests of worker.
+     *        ChangeEventsEvent are replied meanwhile, at most one per CoalesceMs, and
+     *        WatchCollectionResponse at the end.
+     */
+    class WatchCollectionRequest : public Event
+    {
+    R_EVENT
+
+        /**
+         * @param cancelled Set by sender to close the stream, checked about every AwaitMs
+         */
+        WatchCollectionRequest(QObject *sender, int watchId, const MongoNamespace &ns,
+                               const ChangeStreamWatch::Filter &filter,
+                               const std::shared_ptr<std::atomic<bool>> &cancelled) :
+            Event(sender),
+            watchId(watchId),
+            ns(ns),
+            filter(filter),
+            cancelled(cancelled) {}
+
+        static const int AwaitMs = 1000;
+        static const int CoalesceMs = 100;
+        static const int BatchSize = 5000;
+
+        EventPriority priority() const override { return EventPriority::Background; }
+        bool isCancelled() const { return cancelled && *cancelled; }
+
+        int const watchId;
+        MongoNamespace const ns;
+        ChangeStreamWatch::Filter const filter;
+        std::shared_ptr<std::atomic<bool>> const cancelled;
+    };
+
+    class ChangeEventsEvent : public Event
+    {
+    R_EVENT
+
+        ChangeEventsEvent(QObject *sender, int watchId, const std::vector<mongo::BSONObj> &events) :
+            Event(sender),
+            watchId(watchId),
+            events(events) {}
+
+        int const watchId;
+        std::vector<mongo::BSONObj> const events;     // in order of the stream
+    };
+
+    class WatchCollectionResponse : public Event
+    {
+    R_EVENT
+
+        WatchCollectionResponse(QObject *sender, int watchId) :
+            Event(sender),
+            watchId(watchId) {}
+
+        WatchCollectionResponse(QObject *sender, int watchId, const EventError &error) :
+            Event(sender, error),
+            watchId(watchId) {}
+
+        int const watchId;
     };
 }
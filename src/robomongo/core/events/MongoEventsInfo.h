@@ -43,4 +43,77 @@ namespace Robomongo
         const std::string _storageEngineType;
         std::string const _uuid;
     };
+
+    /**
+     * @brief Result of one chunk of a bulk write operation: position of the first
+     *        document of the chunk, number of documents in it and error message
+     *        (empty if chunk succeeded).
+     */
+    struct BulkChunkResult
+    {
+        BulkChunkResult(int first, int count, const std::string &error = std::string()) :
+            _first(first), _count(count), _error(error) {}
+
+        bool isError() const { return !_error.empty(); }
+
+        int _first;
+        int _count;
+        std::string _error;
+    };
+
+    /**
+     * @brief Operations of system.profile with the same namespace, op, command, query shape
+     *        and plan summary (see ProfileSummary). Percentiles are upper bounds of
+     *        ProfileSummary::UpperBoundsMs buckets, -1 if beyond the last bound.
+     */
+    struct ProfileShapeInfo
+    {
+        std::string _ns;
+        std::string _op;
+        std::string _command;
+        std::string _shape;         // queryHash or field names of filter
+        std::string _planSummary;
+
+        long long _count = 0;
+        long long _totalMillis = 0;
+        long long _maxMillis = 0;
+        double _p50Ms = -1;
+        double _p95Ms = -1;
+
+        long long _docsExamined = 0;
+        long long _keysExamined = 0;
+        long long _nreturned = 0;
+        long long _lastSeenMs = 0;  // since epoch
+    };
+
+    /**
+     * @brief Entry of plan cache of collection ($planCacheStats, see PlanCache). Entries of
+     *        one query shape share _queryHash, _planCacheKey differs by available indexes.
+     */
+    struct PlanCacheEntryInfo
+    {
+        std::string _host;          // mongod of entry, empty if not sharded
+        std::string _queryHash;     // planCacheShapeHash on 8.0+
+        std::string _planCacheKey;
+        std::string _shape;         // filter with values as "?", sort and projection
+        std::string _planSummary;   // of cached plan, see ExplainPlan::summary()
+        std::string _engine;        // "classic" or "sbe"
+
+        long long _works = -1;      // needed by plan when it was cached, -1 if not reported
+        bool _isActive = false;     // inactive entries are not used until they prove themselves
+        bool _isPinned = false;
+        long long _createdMs = 0;   // since epoch
+    };
+
+    /**
+     * @brief Usage ($indexStats) and size (collStats.indexSizes) of index. Operations are
+     *        summed over shards, they are counted by every mongod since its start.
+     */
+    struct IndexUsageInfo
+    {
+        std::string _name;
+        long long _ops = -1;        // -1 if $indexStats is not available (i.e. no privilege)
+        long long _sinceMs = 0;     // since epoch, the oldest one of shards
+        long long _sizeBytes = -1;  // -1 if collStats failed
+    };
 }
@@ -0,0 +1,235 @@
+#include "robomongo/core/mongodb/BulkInserter.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+namespace Robomongo
+{
+    BulkInserter::BulkInserter(std::vector<std::unique_ptr<mongo::DBClientBase>> connections,
+                               const MongoNamespace &ns, bool ordered) :
+        _connections(std::move(connections)),
+        _ns(ns),
+        _ordered(ordered)
+    {
+        for (auto const &connection : _connections)
+            _threads.emplace_back(&BulkInserter::run, this, connection.get());
+    }
+
+    BulkInserter::~BulkInserter()
+    {
+        cancel();
+    }
+
+    void BulkInserter::cancel()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopped = true;
+            _queue.clear();
+        }
+        _changed.notify_all();
+        for (std::thread &thread : _threads) {
+            if (thread.joinable())
+                thread.join();
+        }
+    }
+
+    bool BulkInserter::push(std::vector<mongo::BSONObj> batch)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _changed.wait(lock, [this]() {
+            return _stopped || _queue.size() < MaxQueuedBatches * _connections.size();
+        });
+        if (_stopped)
+            return false;
+
+        long long const first = _pushed;
+        _pushed += static_cast<long long>(batch.size());
+        _queue.push_back(Batch { first, std::move(batch) });
+        _changed.notify_all();
+        return true;
+    }
+
+    void BulkInserter::finish()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _finishing = true;
+        }
+        _changed.notify_all();
+        for (std::thread &thread : _threads) {
+            if (thread.joinable())
+                thread.join();
+        }
+    }
+
+    std::string BulkInserter::errors() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::string text;
+        for (std::string const &error : _errors)
+            text += (text.empty() ? "" : "\n") + error;
+        return text;
+    }
+
+    LatencyHistogram BulkInserter::latency() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _latency;
+    }
+
+    void BulkInserter::run(mongo::DBClientBase *connection)
+    {
+        while (true) {
+            Batch batch;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _changed.wait(lock, [this]() { return _stopped || _finishing || !_queue.empty(); });
+                if (_stopped || _queue.empty())
+                    return;
+
+                batch = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            _changed.notify_all();
+
+            insert(connection, batch);
+        }
+    }
+
+    void BulkInserter::insert(mongo::DBClientBase *connection, const Batch &batch)
+    {
+        for (int attempt = 0; ; ++attempt) {
+            if (int const delay = _throttleMs)
+                std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+
+            // Retry may repeat inserts of the failed attempt. They fail with duplicate key (all
+            // documents have _id), which must not stop the rest of batch.
+            mongo::BSONObjBuilder command;
+            command.append("insert", _ns.collectionName());
+            mongo::BSONArrayBuilder documents(command.subarrayStart("documents"));
+            for (mongo::BSONObj const &doc : batch.documents)
+                documents.append(doc);
+            documents.done();
+            command.append("ordered", _ordered && attempt == 0);
+
+            mongo::BSONObj result;
+            std::string error;
+            try {
+                auto const sent = std::chrono::steady_clock::now();
+                bool const ok = connection->runCommand(_ns.databaseName(), command.obj(), result);
+                long long const us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - sent).count();
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _latency.record(us);
+                }
+
+                if (!ok) {
+                    error = result.getStringField("errmsg");
+                    if (!isTransient(result["code"].numberInt()))
+                        attempt = MaxRetries;
+                }
+            }
+            catch (const std::exception &ex) {
+                // Network errors
+                error = ex.what();
+            }
+
+            if (!error.empty()) {
+                if (attempt < MaxRetries) {
+                    slowDown();
+                    continue;
+                }
+
+                _failed += static_cast<long long>(batch.documents.size());
+                addError(batch.first, error);
+                if (_ordered) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _stopped = true;
+                }
+                _changed.notify_all();
+                return;
+            }
+
+            long long inserted = result["n"].safeNumberLong();
+            long long failed = 0;
+            mongo::BSONElement const writeErrors = result["writeErrors"];
+            if (writeErrors.type() == mongo::Array) {
+                for (mongo::BSONElement const &item : writeErrors.Array()) {
+                    mongo::BSONObj const writeError = item.Obj();
+                    if (attempt > 0 && writeError["code"].numberInt() == 11000) {
+                        ++inserted;     // by previous attempt
+                        continue;
+                    }
+
+                    ++failed;
+                    addError(batch.first + writeError["index"].numberInt(),
+                             writeError.getStringField("errmsg"));
+                }
+            }
+
+            // Unordered insert continues after failed documents, ordered one skips the rest of batch
+            if (_ordered && failed > 0)
+                failed = static_cast<long long>(batch.documents.size()) - inserted;
+
+            _inserted += inserted;
+            _failed += failed;
+
+            if (result.hasField("writeConcernError"))
+                slowDown();
+            else
+                speedUp();
+
+            if (_ordered && failed > 0) {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _stopped = true;
+                }
+                _changed.notify_all();
+            }
+            return;
+        }
+    }
+
+    void BulkInserter::addError(long long document, const std::string &error)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_errors.size() < MaxErrors)
+            _errors.push_back("Document " + std::to_string(document + 1) + ": " + error);
+    }
+
+    void BulkInserter::slowDown()
+    {
+        _throttleMs = std::min(MaxThrottleMs, std::max(MinThrottleMs, _throttleMs * 2));
+    }
+
+    void BulkInserter::speedUp()
+    {
+        int const delay = _throttleMs / 2;
+        _throttleMs = delay < MinThrottleMs ? 0 : delay;
+    }
+
+    bool BulkInserter::isTransient(int code)
+    {
+        switch (code) {
+        case 6:         // HostUnreachable
+        case 7:         // HostNotFound
+        case 89:        // NetworkTimeout
+        case 91:        // ShutdownInProgress
+        case 189:       // PrimarySteppedDown
+        case 262:       // ExceededTimeLimit
+        case 462:       // IngressRequestRateLimitExceeded
+        case 9001:      // SocketException
+        case 10107:     // NotWritablePrimary
+        case 11600:     // InterruptedAtShutdown
+        case 11602:     // InterruptedDueToReplStateChange
+        case 13435:     // NotPrimaryNoSecondaryOk
+            return true;
+        default:
+            return false;
+        }
+    }
+}
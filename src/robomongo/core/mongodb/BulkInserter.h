@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mongo/client/dbclient_base.h>
+
+#include "robomongo/core/domain/MongoNamespace.h"
+#include "robomongo/core/utils/LatencyHistogram.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Inserts batches of documents with { insert } commands, one thread per connection.
+     *        Producer waits in push() while connections are behind, and inserters slow down
+     *        (wait up to MaxThrottleMs before every command) while server reports write
+     *        concern errors or transient failures, which are retried.
+     *
+     *        Ordered inserter stops at the first failed document, it should have one connection
+     *        so that batches are inserted in order.
+     */
+    class BulkInserter
+    {
+    public:
+        BulkInserter(std::vector<std::unique_ptr<mongo::DBClientBase>> connections, const MongoNamespace &ns,
+                     bool ordered);
+
+        ~BulkInserter();
+
+        /**
+         * @brief Queues batch, waits while queue is full
+         * @return false, if ordered insert stopped because of failed document
+         */
+        bool push(std::vector<mongo::BSONObj> batch);
+
+        /**
+         * @brief Waits until all queued batches are inserted
+         */
+        void finish();
+
+        /**
+         * @brief Stops inserters, queued batches are not inserted. Commands in progress
+         *        are waited for, so counts do not change after it.
+         */
+        void cancel();
+
+        long long inserted() const { return _inserted; }
+        long long failed() const { return _failed; }
+        int throttleMs() const { return _throttleMs; }
+
+        // Round trips of insert commands that reached server, without throttling delays
+        LatencyHistogram latency() const;
+
+        /**
+         * @brief The first MaxErrors errors, one per line, with number of document in import
+         */
+        std::string errors() const;
+
+    private:
+        struct Batch
+        {
+            long long first;        // number of the first document in import
+            std::vector<mongo::BSONObj> documents;
+        };
+
+        void run(mongo::DBClientBase *connection);
+        void insert(mongo::DBClientBase *connection, const Batch &batch);
+        void addError(long long document, const std::string &error);
+        void slowDown();
+        void speedUp();
+
+        static bool isTransient(int code);
+
+        static const int MaxRetries = 5;
+        static constexpr int MinThrottleMs = 50;
+        static constexpr int MaxThrottleMs = 5000;
+        static const size_t MaxErrors = 10;
+        static const size_t MaxQueuedBatches = 2;   // per connection
+
+        std::vector<std::unique_ptr<mongo::DBClientBase>> const _connections;
+        MongoNamespace const _ns;
+        bool const _ordered;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _changed;
+        std::deque<Batch> _queue;
+        long long _pushed = 0;
+        bool _finishing = false;
+        bool _stopped = false;
+        std::vector<std::string> _errors;
+        LatencyHistogram _latency;
+
+        std::atomic<long long> _inserted { 0 };
+        std::atomic<long long> _failed { 0 };
+        std::atomic<int> _throttleMs { 0 };
+        std::vector<std::thread> _threads;
+    };
+}
@@ -0,0 +1,61 @@
+#include "robomongo/core/mongodb/ConnectionHealth.h"
+
+#include <algorithm>
+
+namespace Robomongo
+{
+    constexpr std::chrono::milliseconds ConnectionHealth::InitialBackoff;
+    constexpr std::chrono::milliseconds ConnectionHealth::MaxBackoff;
+
+    void ConnectionHealth::recordFailure(const std::string &reason, Clock::time_point now)
+    {
+        _state = State::Down;
+        _reason = reason;
+        ++_failures;
+
+        // 1, 2, 4 ... seconds; shift is capped, so that it does not overflow
+        auto const backoff = InitialBackoff * (1LL << std::min(_failures - 1, 16));
+        _nextProbe = now + std::min<std::chrono::milliseconds>(backoff, MaxBackoff);
+    }
+
+    void ConnectionHealth::recordSuccess()
+    {
+        _state = State::Up;
+        _failures = 0;
+        _reason.clear();
+    }
+
+    bool ConnectionHealth::startProbe()
+    {
+        if (_state != State::Down)
+            return false;
+
+        _state = State::Probing;
+        return true;
+    }
+
+    std::chrono::milliseconds ConnectionHealth::untilNextProbe(Clock::time_point now) const
+    {
+        if (_state == State::Up || now >= _nextProbe)
+            return std::chrono::milliseconds(0);
+
+        return std::chrono::duration_cast<std::chrono::milliseconds>(_nextProbe - now);
+    }
+
+    std::string ConnectionHealth::describe(Clock::time_point now) const
+    {
+        if (_state == State::Up)
+            return std::string();
+
+        std::string text = "Server is unreachable";
+        if (!_reason.empty())
+            text += " (" + _reason + ")";
+
+        if (_state == State::Probing)
+            return text + ", reconnecting";
+
+        // Rounded up, so that "0 s" is not shown while probe is still pending
+        long long const seconds = (untilNextProbe(now).count() + 999) / 1000;
+        return text + ", reconnecting in " + std::to_string(seconds) + " s";
+    }
+}
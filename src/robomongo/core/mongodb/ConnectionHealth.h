@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace Robomongo
+{
+    /**
+     * @brief Health of the driver connection of one MongoWorker (circuit breaker). Once
+     *        connect fails, the server is known to be down: requests fail at once instead of
+     *        waiting for connect and socket timeouts, while reachability is probed in the
+     *        background with exponential backoff. Not thread-safe, used by worker thread only.
+     */
+    class ConnectionHealth
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        enum class State { Up, Down, Probing };
+
+        // Delay before the first probe, doubled after every failed one up to MaxBackoff
+        static constexpr std::chrono::milliseconds InitialBackoff { 1000 };
+        static constexpr std::chrono::milliseconds MaxBackoff { 30000 };
+
+        State state() const { return _state; }
+        bool isDown() const { return _state != State::Up; }
+
+        // Connect or probe failed, the next probe is due after backoff of 'failures()'
+        void recordFailure(const std::string &reason, Clock::time_point now = Clock::now());
+
+        // Connect or probe succeeded, backoff starts again from InitialBackoff
+        void recordSuccess();
+
+        // Down -> Probing. False, if server is up or probe is already running.
+        bool startProbe();
+
+        // Consecutive failures since the server was last up
+        int failures() const { return _failures; }
+        const std::string &reason() const { return _reason; }
+
+        // Zero, if probe is due or server is up
+        std::chrono::milliseconds untilNextProbe(Clock::time_point now = Clock::now()) const;
+
+        // I.e. "Server is unreachable (Connection refused), reconnecting in 4 s"
+        std::string describe(Clock::time_point now = Clock::now()) const;
+
+    private:
+        State _state = State::Up;
+        int _failures = 0;
+        std::string _reason;
+        Clock::time_point _nextProbe;
+    };
+}
@@ -0,0 +1,49 @@
+#include "gtest/gtest.h"
+#include "ConnectionHealth.h"
+
+using namespace Robomongo;
+
+TEST(connection_health_tests, backoff_doubles_up_to_max)
+{
+    ConnectionHealth health;
+    auto const now = ConnectionHealth::Clock::now();
+    EXPECT_FALSE(health.isDown());
+    EXPECT_EQ(0, health.untilNextProbe(now).count());
+
+    health.recordFailure("Connection refused", now);
+    EXPECT_TRUE(health.isDown());
+    EXPECT_EQ(1000, health.untilNextProbe(now).count());
+
+    health.recordFailure("Connection refused", now);
+    EXPECT_EQ(2000, health.untilNextProbe(now).count());
+
+    for (int i = 0; i < 40; ++i)
+        health.recordFailure("Connection refused", now);
+    EXPECT_EQ(ConnectionHealth::MaxBackoff.count(), health.untilNextProbe(now).count());
+}
+
+TEST(connection_health_tests, probe_starts_once_and_success_resets)
+{
+    ConnectionHealth health;
+    EXPECT_FALSE(health.startProbe());
+
+    auto const now = ConnectionHealth::Clock::now();
+    health.recordFailure("timed out", now);
+    EXPECT_TRUE(health.startProbe());
+    EXPECT_FALSE(health.startProbe());
+    EXPECT_EQ(ConnectionHealth::State::Probing, health.state());
+    EXPECT_TRUE(health.isDown());
+    EXPECT_EQ("Server is unreachable (timed out), reconnecting", health.describe(now));
+
+    health.recordFailure("timed out", now);
+    EXPECT_EQ(2, health.failures());
+    EXPECT_EQ("Server is unreachable (timed out), reconnecting in 2 s", health.describe(now));
+
+    health.recordSuccess();
+    EXPECT_FALSE(health.isDown());
+    EXPECT_EQ(0, health.failures());
+    EXPECT_EQ("", health.describe(now));
+
+    health.recordFailure("timed out", now);
+    EXPECT_EQ(1000, health.untilNextProbe(now).count());
+}
@@ -0,0 +1,384 @@
+#include "robomongo/core/mongodb/ConnectionProbe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <QHostInfo>
+#include <QTcpSocket>
+
+#include <mongo/bson/bsonobjbuilder.h>
+#include <mongo/client/dbclient_connection.h>
+
+#include "robomongo/core/mongodb/ScramAuth.h"
+#include "robomongo/core/mongodb/SshTunnelWorker.h"
+#include "robomongo/core/mongodb/TlsContext.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/settings/CredentialSettings.h"
+#include "robomongo/core/settings/ReplicaSetSettings.h"
+#include "robomongo/core/settings/SshSettings.h"
+#include "robomongo/core/settings/SslSettings.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/ssh/ssh.h"
+
+namespace Robomongo
+{
+namespace ConnectionProbe
+{
+    namespace
+    {
+        std::string const AppName { "robo3t-" + std::string(PROJECT_VERSION) };
+
+        class Stopwatch
+        {
+        public:
+            Stopwatch() : _started(std::chrono::steady_clock::now()) {}
+
+            long long elapsedUs() const
+            {
+                using namespace std::chrono;
+                return duration_cast<microseconds>(steady_clock::now() - _started).count();
+            }
+
+        private:
+            std::chrono::steady_clock::time_point const _started;
+        };
+
+        // Phase which throws is recorded as failed one, later phases are not reached
+        template <typename Check>
+        bool measure(Result &result, Phase phase, Check check)
+        {
+            Stopwatch const watch;
+            try {
+                check();
+                result.us[phase] = watch.elapsedUs();
+                return true;
+            }
+            catch (const std::exception &ex) {
+                result.us[phase] = watch.elapsedUs();
+                result.failedPhase = phase;
+                result.error = ex.what();
+                return false;
+            }
+        }
+
+        bool resolveAndConnect(Result &result, const std::string &host, int port, double timeoutSec)
+        {
+            QHostAddress address;
+            bool const resolved = measure(result, Dns, [&] {
+                QHostInfo const info = QHostInfo::fromName(QtUtils::toQString(host));
+                if (info.error() != QHostInfo::NoError || info.addresses().isEmpty())
+                    throw std::runtime_error("Cannot resolve " + host + ": " + QtUtils::toStdString(info.errorString()));
+                address = info.addresses().first();
+            });
+            if (!resolved)
+                return false;
+
+            // Plain socket, closed right away: driver connects again by itself
+            return measure(result, TcpConnect, [&] {
+                QTcpSocket socket;
+                socket.connectToHost(address, static_cast<quint16>(port));
+                if (!socket.waitForConnected(static_cast<int>(timeoutSec * 1000)))
+                    throw std::runtime_error("Cannot connect to " + result.target + ": " +
+                                             QtUtils::toStdString(socket.errorString()));
+            });
+        }
+
+        void authenticate(mongo::DBClientConnection &conn, CredentialSettings *credentials)
+        {
+            if (ScramAuth::isSupported(credentials)) {
+                ScramAuth::authenticate(&conn, credentials);
+                return;
+            }
+
+            conn.auth(mongo::BSONObjBuilder()
+                .append("user", credentials->userName())
+                .append("db", credentials->databaseName())
+                .append("pwd", credentials->userPassword())
+                .append("mechanism", credentials->mechanism())
+                .obj());
+        }
+
+        mongo::BSONObj runAdminCommand(mongo::DBClientConnection &conn, const mongo::BSONObj &command)
+        {
+            mongo::BSONObj reply;
+            if (!conn.runCommand("admin", command, reply))
+                throw std::runtime_error(reply["errmsg"].str());
+            return reply;
+        }
+
+        // First document of admin aggregation
+        mongo::BSONObj aggregateAdmin(mongo::DBClientConnection &conn, const mongo::BSONArray &pipeline)
+        {
+            mongo::BSONObj const reply = runAdminCommand(conn, BSON("aggregate" << 1 << "pipeline" << pipeline <<
+                                                                    "cursor" << mongo::BSONObj()));
+            mongo::BSONObj const batch = reply.getObjectField("cursor").getObjectField("firstBatch");
+            if (batch.isEmpty())
+                throw std::runtime_error("Aggregation of tunnel test returned no document");
+            return batch.firstElement().Obj().getOwned();
+        }
+
+        // Printable, so that it is a valid string, and random, so that it does not compress much
+        std::string randomPayload(int bytes)
+        {
+            static char const alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            std::mt19937 random(std::random_device{}());
+            std::string payload(static_cast<size_t>(bytes), ' ');
+            for (char &ch : payload)
+                ch = alphabet[random() % 64];
+            return payload;
+        }
+
+        mongo::BSONArray currentOpPipeline(const mongo::BSONObj &project)
+        {
+            return BSON_ARRAY(BSON("$currentOp" << BSON("allUsers" << false << "idleConnections" << false)) <<
+                              BSON("$limit" << 1) <<
+                              BSON("$project" << project));
+        }
+
+        Result probeSsh(ConnectionSettings *settings, double timeoutSec)
+        {
+            SshSettings *ssh = settings->sshSettings();
+            Result result;
+            result.target = ssh->host() + ":" + std::to_string(ssh->port()) + " (SSH)";
+            if (!resolveAndConnect(result, ssh->host(), ssh->port(), timeoutSec))
+                return result;
+
+            // Session of its own: the shared one is authenticated long ago, if it is
+            measure(result, SshHandshake, [&] {
+                SshTunnelConfigCreator creator(settings);
+                rbm_ssh_session *session = rbm_ssh_session_create(creator.config());
+                if (!session)
+                    throw std::runtime_error("Failed to create SSH session");
+
+                bool const isSetUp = rbm_ssh_session_setup(session) != -1;
+                std::string const error(session->lasterror);
+                rbm_ssh_session_close(session);
+                if (!isSetUp)
+                    throw std::runtime_error(error);
+            });
+            return result;
+        }
+
+        Result probeServer(ConnectionSettings *settings, const std::string &host, int port,
+                           const std::string &target, double timeoutSec)
+        {
+            Result result;
+            result.target = target;
+            if (!resolveAndConnect(result, host, port, timeoutSec))
+                return result;
+
+            bool const isTls = settings->sslSettings()->sslEnabled();
+            std::shared_ptr<const TlsContext> const tlsContext = TlsContext::of(settings->sslSettings());
+
+            mongo::DBClientConnection conn(false, timeoutSec);
+            bool connected = measure(result, MongoHandshake, [&] {
+                TlsContext::Guard tls(*tlsContext);
+                mongo::Status const status = conn.connect(mongo::HostAndPort(host, port), AppName);
+                if (!status.isOK())
+                    throw std::runtime_error(status.reason());
+            });
+
+            // Failed connect is blamed on TLS, if there is one: driver does not tell which step failed
+            if (!connected) {
+                if (isTls) {
+                    result.us[TlsHandshake] = result.us[MongoHandshake];
+                    result.us[MongoHandshake] = NotMeasured;
+                    result.failedPhase = TlsHandshake;
+                }
+                return result;
+            }
+
+            // Driver has connected TCP again, as long as the probe socket did
+            long long const afterTcpUs = std::max(0LL, result.us[MongoHandshake] - result.us[TcpConnect]);
+            result.us[MongoHandshake] = afterTcpUs;
+            if (isTls) {
+                Result roundTrip;
+                connected = measure(roundTrip, MongoHandshake, [&] {
+                    mongo::BSONObj info;
+                    if (!conn.runCommand("admin", BSON("isMaster" << 1), info))
+                        throw std::runtime_error(info.toString());
+                });
+
+                if (connected) {
+                    result.us[MongoHandshake] = std::min(roundTrip.us[MongoHandshake], afterTcpUs);
+                    result.us[TlsHandshake] = afterTcpUs - result.us[MongoHandshake];
+                }
+            }
+
+            if (settings->hasEnabledPrimaryCredential()) {
+                bool const authenticated = measure(result, Authentication, [&] {
+                    authenticate(conn, settings->primaryCredential());
+                });
+                if (!authenticated)
+                    return result;
+            }
+
+            measure(result, FirstCommand, [&] {
+                mongo::BSONObj info;
+                if (!conn.runCommand("admin", BSON("listDatabases" << 1 << "nameOnly" << true), info))
+                    throw std::runtime_error(info["errmsg"].str());
+            });
+            return result;
+        }
+    }
+
+    mongo::BSONArray uploadPipeline(const std::string &payload)
+    {
+        return currentOpPipeline(BSON("_id" << 0 << "length" <<
+                                      BSON("$strLenBytes" << BSON("$literal" << payload))));
+    }
+
+    mongo::BSONArray echoPipeline(const std::string &payload)
+    {
+        return currentOpPipeline(BSON("_id" << 0 << "payload" << BSON("$literal" << payload)));
+    }
+
+    double bytesPerSecond(long long bytes, long long us, long long latencyUs)
+    {
+        return bytes * 1000000.0 / std::max(1LL, us - std::max(0LL, latencyUs));
+    }
+
+    TunnelResult testTunnel(ConnectionSettings *settings, double timeoutSec)
+    {
+        TunnelResult result;
+        result.methods = SshTunnelWorker::sharedSessionMethods(settings);
+        int const localport = SshTunnelWorker::openSharedForward(settings);
+        if (localport <= 0) {
+            result.error = "There is no open SSH tunnel to test";
+            return result;
+        }
+
+        try {
+            // Transfers on slow links take longer than commands are allowed to
+            std::shared_ptr<const TlsContext> const tlsContext = TlsContext::of(settings->sslSettings());
+            mongo::DBClientConnection conn(false, std::max(timeoutSec, 120.0));
+            {
+                TlsContext::Guard tls(*tlsContext);
+                mongo::Status const status = conn.connect(mongo::HostAndPort("127.0.0.1", localport), AppName);
+                if (!status.isOK())
+                    throw std::runtime_error(status.reason());
+            }
+
+            if (settings->hasEnabledPrimaryCredential())
+                authenticate(conn, settings->primaryCredential());
+
+            std::vector<long long> pings;
+            for (int i = 0; i < TunnelPings; ++i) {
+                Stopwatch const watch;
+                runAdminCommand(conn, BSON("ping" << 1));
+                pings.push_back(watch.elapsedUs());
+            }
+            std::sort(pings.begin(), pings.end());
+            result.minLatencyUs = pings.front();
+            result.latencyUs = pings[pings.size() / 2];
+
+            std::string const payload = randomPayload(TunnelPayloadBytes);
+            long long uploadUs = LLONG_MAX;
+            long long echoUs = LLONG_MAX;
+            for (int round = 0; round < TunnelRounds; ++round) {
+                Stopwatch const upload;
+                mongo::BSONObj const length = aggregateAdmin(conn, uploadPipeline(payload));
+                uploadUs = std::min(uploadUs, upload.elapsedUs());
+                if (length["length"].numberLong() != static_cast<long long>(payload.size()))
+                    throw std::runtime_error("Payload of tunnel test was received incomplete");
+
+                Stopwatch const echo;
+                mongo::BSONObj const echoed = aggregateAdmin(conn, echoPipeline(payload));
+                echoUs = std::min(echoUs, echo.elapsedUs());
+                mongo::BSONElement const echoedPayload = echoed["payload"];
+                if (echoedPayload.type() != mongo::String ||
+                    echoedPayload.valuestrsize() - 1 != static_cast<int>(payload.size()))
+                    throw std::runtime_error("Payload of tunnel test was echoed incomplete");
+            }
+
+            result.uploadBytesPerSec = bytesPerSecond(payload.size(), uploadUs, result.minLatencyUs);
+            result.downloadBytesPerSec = bytesPerSecond(payload.size(), echoUs - uploadUs, 0);
+        }
+        catch (const std::exception &ex) {
+            result.error = ex.what();
+        }
+        return result;
+    }
+
+    const char *phaseName(Phase phase)
+    {
+        switch (phase) {
+        case Dns:               return "DNS";
+        case TcpConnect:        return "TCP connect";
+        case TlsHandshake:      return "TLS handshake";
+        case SshHandshake:      return "SSH handshake and auth";
+        case MongoHandshake:    return "Mongo handshake";
+        case Authentication:    return "Authentication";
+        case FirstCommand:      return "First command";
+        case PhaseCount:        break;
+        }
+        return "";
+    }
+
+    Result::Result() :
+        failedPhase(PhaseCount)
+    {
+        std::fill(std::begin(us), std::end(us), NotMeasured);
+    }
+
+    long long Result::totalUs() const
+    {
+        long long total = 0;
+        for (long long const phaseUs : us) {
+            if (phaseUs != NotMeasured)
+                total += phaseUs;
+        }
+        return total;
+    }
+
+    std::vector<Result> probe(ConnectionSettings *settings, double timeoutSec)
+    {
+        std::vector<std::function<Result()>> checks;
+        if (settings->isReplicaSet()) {
+            // SSH is not used for replica sets, see App::openServerInternal
+            for (mongo::HostAndPort const &member : settings->replicaSetSettings()->membersToHostAndPort()) {
+                checks.push_back([=] {
+                    return probeServer(settings, member.host(), member.port(), member.toString(), timeoutSec);
+                });
+            }
+        }
+        else if (settings->sshSettings()->enabled()) {
+            checks.push_back([=] { return probeSsh(settings, timeoutSec); });
+
+            std::string const target = settings->getFullAddress() + " (via SSH tunnel)";
+            int const localport = SshTunnelWorker::openSharedForward(settings);
+            checks.push_back([=] {
+                if (localport > 0)
+                    return probeServer(settings, "127.0.0.1", localport, target, timeoutSec);
+
+                Result result;
+                result.target = target;
+                result.failedPhase = MongoHandshake;
+                result.error = "There is no open SSH tunnel to probe server through";
+                return result;
+            });
+        }
+        else {
+            checks.push_back([=] {
+                return probeServer(settings, settings->serverHost(), settings->serverPort(),
+                                   settings->getFullAddress(), timeoutSec);
+            });
+        }
+
+        // Independent checks run at once: the slowest one, not their sum, is waited for
+        std::vector<Result> results(checks.size());
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < checks.size(); ++i)
+            threads.emplace_back([&checks, &results, i] { results[i] = checks[i](); });
+        for (std::thread &thread : threads)
+            thread.join();
+
+        return results;
+    }
+}
+}
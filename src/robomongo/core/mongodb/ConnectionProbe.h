@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    class ConnectionSettings;
+
+    /**
+     * @brief Times phases of opening connection of record, each on a fresh connection of its
+     *        own: SSH server and every member of replica set are probed in parallel. Mongo
+     *        phases of SSH record go through a forward of the shared SSH session (see
+     *        SshTunnelWorker::openSharedForward), so they are probed only while it is open.
+     *
+     *        Driver resolves, connects, negotiates TLS and sends handshake in one call, TLS
+     *        handshake is what remains of it after TCP connect and a round trip of isMaster.
+     *        Probe connections are not counted in DriverMetrics of the record.
+     */
+    namespace ConnectionProbe
+    {
+        enum Phase
+        {
+            Dns,
+            TcpConnect,
+            TlsHandshake,
+            SshHandshake,       // and authentication on SSH server
+            MongoHandshake,
+            Authentication,     // SCRAM (or other mechanism of credential)
+            FirstCommand,       // listDatabases
+            PhaseCount
+        };
+
+        const char *phaseName(Phase phase);
+
+        constexpr long long NotMeasured = -1;
+
+        struct Result
+        {
+            Result();
+
+            std::string target;             // i.e. "host:27017", "ssh.example.com:22 (SSH)"
+            long long us[PhaseCount];       // NotMeasured if phase is skipped or not reached
+            Phase failedPhase;              // PhaseCount if all phases passed
+            std::string error;
+
+            bool failed() const { return failedPhase != PhaseCount; }
+            long long totalUs() const;
+        };
+
+        /**
+         * @brief Blocks until all checks are done or failed, results are in order of
+         *        SSH server (if enabled) and members (or the only server)
+         */
+        std::vector<Result> probe(ConnectionSettings *settings, double timeoutSec);
+
+        // Round trips of ping and transfers of payload, of which the best is taken
+        const int TunnelPings = 10;
+        const int TunnelRounds = 3;
+        const int TunnelPayloadBytes = 1024 * 1024;
+
+        struct TunnelResult
+        {
+            std::string methods;                // cipher, MAC and compression of SSH session
+            long long latencyUs = NotMeasured;  // median round trip of ping
+            long long minLatencyUs = NotMeasured;
+            double uploadBytesPerSec = 0;
+            double downloadBytesPerSec = 0;
+            std::string error;
+        };
+
+        /**
+         * @brief Measures latency and throughput of the shared SSH session of record, on a
+         *        connection of its own through a forward of it. Payload is random text, so
+         *        that compression of tunnel does not inflate the numbers. It is uploaded in
+         *        an aggregation that returns its length only, then echoed back by another
+         *        one: download takes what the echo takes more than the upload. Blocks.
+         */
+        TunnelResult testTunnel(ConnectionSettings *settings, double timeoutSec);
+
+        // Pipelines of admin aggregation, $currentOp is there for a single input document
+        mongo::BSONArray uploadPipeline(const std::string &payload);   // { length: <bytes of payload> }
+        mongo::BSONArray echoPipeline(const std::string &payload);     // { payload: <payload> }
+
+        // Bytes per second of transfer that took 'us', one round trip of 'latencyUs' excluded
+        double bytesPerSecond(long long bytes, long long us, long long latencyUs);
+    }
+}
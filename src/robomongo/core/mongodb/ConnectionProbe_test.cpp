@@ -0,0 +1,26 @@
+#include "gtest/gtest.h"
+#include "ConnectionProbe.h"
+
+using namespace Robomongo;
+
+TEST(connection_probe_tests, tunnel_pipelines_carry_payload)
+{
+    mongo::BSONArray const upload = ConnectionProbe::uploadPipeline("abc");
+    ASSERT_EQ(3, upload.nFields());
+    EXPECT_STREQ("$currentOp", upload["0"].Obj().firstElementFieldName());
+    EXPECT_EQ(1, upload["1"].Obj()["$limit"].numberInt());
+    mongo::BSONObj const length = upload["2"].Obj()["$project"].Obj()["length"].Obj();
+    EXPECT_EQ("abc", length["$strLenBytes"].Obj()["$literal"].str());
+
+    mongo::BSONArray const echo = ConnectionProbe::echoPipeline("abc");
+    EXPECT_EQ("abc", echo["2"].Obj()["$project"].Obj()["payload"].Obj()["$literal"].str());
+}
+
+TEST(connection_probe_tests, bytes_per_second_excludes_latency)
+{
+    EXPECT_DOUBLE_EQ(1000000.0, ConnectionProbe::bytesPerSecond(1000000, 1000000, 0));
+    EXPECT_DOUBLE_EQ(2000000.0, ConnectionProbe::bytesPerSecond(1000000, 600000, 100000));
+
+    // Transfer faster than round trip does not divide by zero or go negative
+    EXPECT_GT(ConnectionProbe::bytesPerSecond(1000, 100, 500), 0);
+}
@@ -0,0 +1,210 @@
+#include "robomongo/core/mongodb/DriverMetrics.h"
+
+#include <mutex>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <mongo/client/dbclient_base.h>
+
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace DriverMetrics
+    {
+        namespace
+        {
+            struct Record
+            {
+                std::mutex mutex;
+                Stats stats;
+            };
+
+            // Request of one connection, which waits for its reply. Connections are used by
+            // one thread at a time, so it needs no lock.
+            struct Pending
+            {
+                bool active = false;
+                std::string command;
+                long long requestBytes = 0;
+                std::chrono::steady_clock::time_point sent;
+            };
+
+            std::mutex registryMutex;
+
+            // Records are never destroyed, totals of edited connection records are not lost
+            std::map<std::string, std::shared_ptr<Record>> records;
+
+            thread_local Scope *currentScope = nullptr;
+
+            std::string recordKey(const ConnectionSettings *settings)
+            {
+                QString const uuid = settings->uuid();
+                return uuid.isEmpty() ? settings->connectionName() : QtUtils::toStdString(uuid);
+            }
+
+            std::shared_ptr<Record> record(const std::string &key)
+            {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                auto &record = records[key];
+                if (!record)
+                    record = std::make_shared<Record>();
+                return record;
+            }
+
+            long long elapsedUs(std::chrono::steady_clock::time_point since)
+            {
+                return std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - since).count();
+            }
+
+            void finish(Record &record, const Pending &pending, long long responseBytes, bool ok)
+            {
+                long long const us = elapsedUs(pending.sent);
+                {
+                    std::lock_guard<std::mutex> lock(record.mutex);
+                    OperationStats &operation = record.stats.operations[pending.command];
+                    ++operation.count;
+                    if (!ok)
+                        ++operation.failures;
+                    operation.requestBytes += pending.requestBytes;
+                    operation.responseBytes += responseBytes;
+                    operation.roundTrip.record(us);
+                }
+
+                if (Scope *const scope = Scope::current())
+                    scope->addRoundTrip(us);
+            }
+
+            QJsonObject histogramToJson(const LatencyHistogram &histogram)
+            {
+                QJsonObject json;
+                json["count"] = static_cast<double>(histogram.count());
+                json["p50"] = static_cast<double>(histogram.percentileUs(50));
+                json["p90"] = static_cast<double>(histogram.percentileUs(90));
+                json["p99"] = static_cast<double>(histogram.percentileUs(99));
+                json["max"] = static_cast<double>(histogram.maxUs());
+                json["total"] = static_cast<double>(histogram.totalUs());
+                return json;
+            }
+        }
+
+        void install(mongo::DBClientBase *conn, const ConnectionSettings *settings)
+        {
+            std::shared_ptr<Record> const target = record(recordKey(settings));
+            auto const pending = std::make_shared<Pending>();
+            mongo::rpc::RequestMetadataWriter const previousWriter = conn->getRequestMetadataWriter();
+            mongo::rpc::ReplyMetadataReader const previousReader = conn->getReplyMetadataReader();
+
+            // Builder holds the whole command here, cursors of find and aggregate included
+            conn->setRequestMetadataWriter(
+                [target, pending, previousWriter](mongo::OperationContext *opCtx, mongo::BSONObjBuilder *builder) {
+                    if (previousWriter) {
+                        mongo::Status const status = previousWriter(opCtx, builder);
+                        if (!status.isOK())
+                            return status;
+                    }
+
+                    // Previous request got no reply, i.e. network error
+                    if (pending->active)
+                        finish(*target, *pending, 0, false);
+
+                    mongo::BSONObj const request = builder->asTempObj();
+                    pending->active = true;
+                    pending->command = request.firstElementFieldName();
+                    pending->requestBytes = request.objsize();
+                    pending->sent = std::chrono::steady_clock::now();
+                    return mongo::Status::OK();
+                }
+            );
+
+            conn->setReplyMetadataReader(
+                [target, pending, previousReader](mongo::OperationContext *opCtx, const mongo::BSONObj &reply,
+                                                  mongo::StringData host) {
+                    if (pending->active) {
+                        pending->active = false;
+                        finish(*target, *pending, reply.objsize(), reply["ok"].trueValue());
+                    }
+
+                    return previousReader ? previousReader(opCtx, reply, host) : mongo::Status::OK();
+                }
+            );
+        }
+
+        void recordRetry(const ConnectionSettings *settings, const std::string &reason)
+        {
+            std::shared_ptr<Record> const target = record(recordKey(settings));
+            std::lock_guard<std::mutex> lock(target->mutex);
+            ++target->stats.retries[reason];
+        }
+
+        Scope::Scope(const ConnectionSettings *settings) :
+            _key(recordKey(settings)),
+            _started(std::chrono::steady_clock::now()),
+            _outer(currentScope)
+        {
+            currentScope = this;
+        }
+
+        Scope::~Scope()
+        {
+            currentScope = _outer;
+
+            long long const wallUs = elapsedUs(_started);
+            std::shared_ptr<Record> const target = record(_key);
+            std::lock_guard<std::mutex> lock(target->mutex);
+            ++target->stats.clientOperations;
+            target->stats.wall.record(wallUs);
+            target->stats.roundTripUs += _roundTripUs;
+        }
+
+        Scope *Scope::current()
+        {
+            return currentScope;
+        }
+
+        Stats stats(const ConnectionSettings *settings)
+        {
+            std::shared_ptr<Record> target;
+            {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                auto const it = records.find(recordKey(settings));
+                if (it == records.end())
+                    return Stats();
+                target = it->second;
+            }
+
+            std::lock_guard<std::mutex> lock(target->mutex);
+            return target->stats;
+        }
+
+        std::string toJson(const Stats &stats)
+        {
+            QJsonObject operations;
+            for (auto const &entry : stats.operations) {
+                OperationStats const &operation = entry.second;
+                QJsonObject json;
+                json["count"] = static_cast<double>(operation.count);
+                json["failures"] = static_cast<double>(operation.failures);
+                json["requestBytes"] = static_cast<double>(operation.requestBytes);
+                json["responseBytes"] = static_cast<double>(operation.responseBytes);
+                json["roundTripUs"] = histogramToJson(operation.roundTrip);
+                operations[QtUtils::toQString(entry.first)] = json;
+            }
+
+            QJsonObject retries;
+            for (auto const &entry : stats.retries)
+                retries[QtUtils::toQString(entry.first)] = static_cast<double>(entry.second);
+
+            QJsonObject json;
+            json["clientOperations"] = static_cast<double>(stats.clientOperations);
+            json["wallUs"] = histogramToJson(stats.wall);
+            json["roundTripUs"] = static_cast<double>(stats.roundTripUs);
+            json["clientUs"] = static_cast<double>(stats.wall.totalUs() - stats.roundTripUs);
+            json["operations"] = operations;
+            json["retries"] = retries;
+            return QJsonDocument(json).toJson().toStdString();
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "robomongo/core/utils/LatencyHistogram.h"
+
+namespace mongo
+{
+    class DBClientBase;
+}
+
+namespace Robomongo
+{
+    class ConnectionSettings;
+
+    /**
+     * @brief Traffic of driver connections of workers, counted per connection record (its
+     *        clones included) since the start of the program, so that it can be seen where
+     *        client time goes. Commands and cursor batches are seen by request metadata writer
+     *        and reply metadata reader of connections, the shell has connections of its own
+     *        and is not counted.
+     */
+    namespace DriverMetrics
+    {
+        struct OperationStats
+        {
+            unsigned long long count = 0;
+            unsigned long long failures = 0;    // replies with ok: 0 and requests without reply
+            long long requestBytes = 0;
+            long long responseBytes = 0;
+            LatencyHistogram roundTrip;         // from request to reply: network and server
+        };
+
+        struct Stats
+        {
+            std::map<std::string, OperationStats> operations;   // by command name, i.e. "find", "getMore"
+            std::map<std::string, unsigned long long> retries;  // by reason
+
+            // MongoClient instances, that is, requests of workers
+            unsigned long long clientOperations = 0;
+            LatencyHistogram wall;              // of whole requests, client side work included
+            long long roundTripUs = 0;          // part of wall time spent waiting for replies
+        };
+
+        /**
+         * @brief Counts commands of not yet connected 'conn' (and of members of replica set
+         *        connection) in stats of connection record. Hooks set before are kept.
+         */
+        void install(mongo::DBClientBase *conn, const ConnectionSettings *settings);
+
+        // I.e. "ntoreturn" when query is repeated for DocumentDB
+        void recordRetry(const ConnectionSettings *settings, const std::string &reason);
+
+        /**
+         * @brief Measures wall time of one request of worker, round trips of this thread are
+         *        attributed to the innermost scope
+         */
+        class Scope
+        {
+        public:
+            explicit Scope(const ConnectionSettings *settings);
+            ~Scope();
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+            void addRoundTrip(long long us) { _roundTripUs += us; }
+            static Scope *current();
+
+        private:
+            std::string const _key;
+            std::chrono::steady_clock::time_point const _started;
+            long long _roundTripUs = 0;
+            Scope *const _outer;
+        };
+
+        Stats stats(const ConnectionSettings *settings);
+
+        /**
+         * @brief Indented JSON with plain numbers: { clientOperations, wallUs: { count, p50,
+         *        p90, p99, max, total }, roundTripUs, clientUs, operations: { find: { count,
+         *        failures, requestBytes, responseBytes, roundTripUs: { ... } }, ... }, retries }
+         */
+        std::string toJson(const Stats &stats);
+    }
+}
@@ -1,8 +1,18 @@
 #include "robomongo/core/mongodb/MongoClient.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+#include "mongo/base/error_codes.h"
 #include "mongo/db/namespace_string.h"
 
+#include "robomongo/core/domain/DocumentUpdate.h"
 #include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/domain/PlanCache.h"
+#include "robomongo/core/domain/ProfileSummary.h"
+#include "robomongo/core/utils/AdaptiveBatchSize.h"
 #include "robomongo/core/utils/BsonUtils.h"
 #include "robomongo/shell/bson/json.h"
 
@@ -32,51 +42,190 @@ namespace
 
         return info;
     }
+
+    mongo::IndexSpec makeIndexSpec(const Robomongo::IndexInfo &indexInfo)
+    {
+        mongo::IndexSpec indexSpec;
+        indexSpec.name(indexInfo._name);
+        indexSpec.addKeys(mongo::Robomongo::fromjson(indexInfo._keys));
+
+        mongo::BSONObjBuilder optionsBuilder;
+
+        auto const addIfTrue = [&](auto const& keyValuePair) {
+            if (keyValuePair.second)
+                optionsBuilder.appendBool(keyValuePair.first, true);
+        };
+
+        addIfTrue(std::pair{ "unique", indexInfo._unique });
+        addIfTrue(std::pair{ "background", indexInfo._backGround });
+        addIfTrue(std::pair{ "sparse", indexInfo._sparse });
+
+        if (!indexInfo._defaultLanguage.empty())
+            optionsBuilder.append("default_language", indexInfo._defaultLanguage);
+
+        if (!indexInfo._languageOverride.empty())
+            optionsBuilder.append("language_override", indexInfo._languageOverride);
+
+        if (!mongo::Robomongo::fromjson(indexInfo._textWeights).isEmpty())
+            optionsBuilder.append("weights", mongo::Robomongo::fromjson(indexInfo._textWeights));
+
+        if (indexInfo._ttl > 0)
+            optionsBuilder.append("expireAfterSeconds", indexInfo._ttl);
+
+        indexSpec.addOptions(optionsBuilder.obj());
+        return indexSpec;
+    }
+
+    // Documents of "firstBatch" or "nextBatch" of command cursor
+    std::vector<mongo::BSONObj> cursorBatch(const mongo::BSONObj &cursor, const char *field)
+    {
+        std::vector<mongo::BSONObj> batch;
+        for (mongo::BSONObjIterator it(cursor.getObjectField(field)); it.more();)
+            batch.push_back(it.next().Obj().getOwned());
+        return batch;
+    }
+
+    // Query with $maxTimeMS, unless it is 0 or query has its own limit
+    mongo::BSONObj withMaxTime(const mongo::BSONObj &query, bool special, int maxTimeMs)
+    {
+        if (maxTimeMs <= 0 || (special && query.hasField("$maxTimeMS")))
+            return query;
+
+        mongo::BSONObjBuilder builder;
+        if (special)
+            builder.appendElements(query);
+        else
+            builder.append("$query", query);
+        builder.append("$maxTimeMS", maxTimeMs);
+        return builder.obj();
+    }
 }
 
 namespace Robomongo
 {
-    MongoClient::MongoClient(mongo::DBClientBase *const dbclient) :
-        _dbclient(dbclient) { }
+    MongoClient::MongoClient(mongo::DBClientBase *const dbclient, ServerCapabilities *capabilities,
+                             const ConnectionSettings *metricsRecord) :
+        _dbclient(dbclient), _capabilities(capabilities),
+        _metrics(metricsRecord ? new DriverMetrics::Scope(metricsRecord) : nullptr) { }
 
     std::vector<std::string> MongoClient::getCollectionNamesWithDbname(const std::string &dbname) const
     {
-        std::list<mongo::BSONObj> collList = _dbclient->getCollectionInfos(dbname);
-
-        std::vector<std::string> collNames;	
-        for (auto const& coll : collList)
-            collNames.push_back(dbname + '.' + coll.getStringField("name")); // todo: verify
+        std::vector<std::string> collNames;
+        getCollectionNamesWithDbname(dbname, std::string(), 0, 
+            [&collNames](const std::vector<std::string> &namespaces, bool) {
+                collNames.insert(collNames.end(), namespaces.begin(), namespaces.end());
+            }
+        );
 
         std::sort(collNames.begin(), collNames.end());
         return collNames;
     }
 
+    void MongoClient::getCollectionNamesWithDbname(const std::string &dbname, const std::string &nameFilter, 
+                                                   int batchSize, const CollectionNamesBatchHandler &onBatch) const
+    {
+        mongo::BSONObjBuilder filterBuilder;
+        if (!nameFilter.empty()) {
+            // Escape regex metacharacters, filter is a plain substring
+            std::string pattern;
+            for (char const ch : nameFilter) {
+                if (std::strchr("\\^$.|?*+()[]{}", ch))
+                    pattern += '\\';
+                pattern += ch;
+            }
+            filterBuilder.appendRegex("name", pattern, "i");
+        }
+        mongo::BSONObj const filter = filterBuilder.obj();
+
+        // { listCollections: 1, filter: {..}, cursor: { batchSize: N }, nameOnly: true, authorizedCollections: true }
+        auto const listCollections = [&](bool nameOnly) {
+            mongo::BSONObjBuilder cursorOptions;
+            if (batchSize > 0)
+                cursorOptions.append("batchSize", batchSize);
+
+            mongo::BSONObjBuilder command;
+            command.append("listCollections", 1);
+            command.append("filter", filter);
+            command.append("cursor", cursorOptions.obj());
+            if (nameOnly) {
+                command.append("nameOnly", true);
+                command.append("authorizedCollections", true);
+            }
+            return command.obj();
+        };
+
+        mongo::BSONObj result;
+        // Servers before 4.0 do not know 'nameOnly' and 'authorizedCollections'
+        if (!_dbclient->runCommand(dbname, listCollections(true), result, mongo::QueryOption_SlaveOk) &&
+            !_dbclient->runCommand(dbname, listCollections(false), result, mongo::QueryOption_SlaveOk))
+            throw std::runtime_error("Failed to list collections: " + std::string(result.getStringField("errmsg")));
+
+        // Namespace of cursor is "<db>.$cmd.listCollections", getMore needs the part after database
+        mongo::BSONObj cursor = result.getObjectField("cursor").getOwned();
+        std::string const cursorNs = cursor.getStringField("ns");
+        std::string const cursorCollection = cursorNs.substr(cursorNs.find('.') + 1);
+
+        mongo::BSONObj batch = cursor.getObjectField("firstBatch");
+        long long cursorId = cursor["id"].safeNumberLong();
+        while (true) {
+            std::vector<std::string> namespaces;
+            for (mongo::BSONObjIterator it(batch); it.more();)
+                namespaces.push_back(dbname + '.' + it.next().Obj().getStringField("name"));
+
+            std::sort(namespaces.begin(), namespaces.end());
+            onBatch(namespaces, cursorId == 0);
+            if (cursorId == 0)
+                return;
+
+            mongo::BSONObjBuilder getMore;
+            getMore.append("getMore", cursorId);
+            getMore.append("collection", cursorCollection);
+            if (batchSize > 0)
+                getMore.append("batchSize", batchSize);
+
+            if (!_dbclient->runCommand(dbname, getMore.obj(), result, mongo::QueryOption_SlaveOk))
+                throw std::runtime_error("Failed to list collections: " + std::string(result.getStringField("errmsg")));
+
+            cursor = result.getObjectField("cursor").getOwned();
+            batch = cursor.getObjectField("nextBatch");
+            cursorId = cursor["id"].safeNumberLong();
+        }
+    }
+
     // Warning: 
     // Use string version dbVersionStr(), version number is corrupted after conversion to float
     // Todo: Remove this function
     float MongoClient::getVersion() const
     {
-        float result = 0.0f;
-        mongo::BSONObj resultObj;
-        _dbclient->runCommand("db", BSON("buildInfo" << "1"), resultObj);
-        std::string resultStr = BsonUtils::getField<mongo::String>(resultObj, "version");
-        result = atof(resultStr.c_str());
-        return result;
+        return atof(dbVersionStr().c_str());
     }
 
     std::string MongoClient::dbVersionStr() const
     {
+        if (_capabilities && !_capabilities->_version.empty())
+            return _capabilities->_version;
+
         mongo::BSONObj resultObj;
         _dbclient->runCommand("db", BSON("buildInfo" << "1"), resultObj);
         std::string const resultStr = BsonUtils::getField<mongo::String>(resultObj, "version");
+        if (_capabilities)
+            _capabilities->_version = resultStr;
         return resultStr;
     }
 
     std::string MongoClient::getStorageEngineType() const
     {
+        if (_capabilities && _capabilities->_isStorageEngineFetched)
+            return _capabilities->_storageEngineType;
+
         mongo::BSONObj resultObj;
         _dbclient->runCommand("db", BSON("serverStatus" << "1"), resultObj);
-        return resultObj.getObjectField("storageEngine").getStringField("name");
+        std::string const engine = resultObj.getObjectField("storageEngine").getStringField("name");
+        if (_capabilities) {
+            _capabilities->_storageEngineType = engine;
+            _capabilities->_isStorageEngineFetched = true;
+        }
+        return engine;
     }
 
     std::vector<std::string> MongoClient::getDatabaseNames() const
@@ -101,9 +250,10 @@ namespace Robomongo
             throw std::runtime_error(errStr);
         }
 
+        float const version = getVersion();
         std::vector<MongoUser> users;
         for (auto const& usr : result.getField("users").Array())
-            users.push_back(MongoUser(getVersion(), usr.embeddedObject()));
+            users.push_back(MongoUser(version, usr.embeddedObject()));
 
         return users;
     }
@@ -195,46 +345,14 @@ namespace Robomongo
             _dbclient->dropIndex(ns, oldInfo._name);
 
         // 2.Step: Add/Edit Index
-        auto const createIndexSpec = [](IndexInfo const& indexInfo) {
-            mongo::IndexSpec indexSpec;
-            indexSpec.name(indexInfo._name);
-            indexSpec.addKeys(mongo::Robomongo::fromjson(indexInfo._keys));
-
-            mongo::BSONObjBuilder optionsBuilder;
-
-            auto const addIfTrue = [&](auto const& keyValuePair) {
-                if (keyValuePair.second)
-                    optionsBuilder.appendBool(keyValuePair.first, true);
-            };
-
-            addIfTrue(std::pair{ "unique", indexInfo._unique });
-            addIfTrue(std::pair{ "background", indexInfo._backGround });
-            addIfTrue(std::pair{ "sparse", indexInfo._sparse });
-
-            if (!indexInfo._defaultLanguage.empty())
-                optionsBuilder.append("default_language", indexInfo._defaultLanguage);
-
-            if (!indexInfo._languageOverride.empty())
-                optionsBuilder.append("language_override", indexInfo._languageOverride);
-
-            if (!mongo::Robomongo::fromjson(indexInfo._textWeights).isEmpty())
-                optionsBuilder.append("weights", mongo::Robomongo::fromjson(indexInfo._textWeights));
-
-            if (indexInfo._ttl > 0)
-                optionsBuilder.append("expireAfterSeconds", indexInfo._ttl);
-
-            indexSpec.addOptions(optionsBuilder.obj());
-            return indexSpec;
-        };
-
         try {
-            _dbclient->createIndex(ns, createIndexSpec(newInfo));
+            _dbclient->createIndex(ns, makeIndexSpec(newInfo));
         } 
         catch (std::exception const& /*ex*/) { // Logging of "ex" is done in upper scope
             if (editIndex) {
                 // If we are here, index that is being edited, must have already been dropped and 
                 // creation of new index failed. So, we try to at least recover the dropped (old) index
-                _dbclient->createIndex(ns, createIndexSpec(oldInfo));
+                _dbclient->createIndex(ns, makeIndexSpec(oldInfo));
             }
             throw;
         }
@@ -290,6 +408,34 @@ namespace Robomongo
         _dbclient->insert(systemIndexesNs, builder.obj());
     }
 
+    void MongoClient::createIndex(const IndexInfo &info) const
+    {
+        _dbclient->createIndex(info._collection.ns().toString(), makeIndexSpec(info));
+
+        std::string const errorStr = _dbclient->getLastError();
+        if (!errorStr.empty())
+            throw std::runtime_error(errorStr);
+    }
+
+    bool MongoClient::indexBuildProgress(const MongoNamespace &ns, const std::string &indexName,
+                                         long long &done, long long &total) const
+    {
+        // Build of 4.4+ is run by coordinator, which reports the createIndexes command too
+        mongo::BSONObj const filter = BSON("command.createIndexes" << ns.collectionName() <<
+                                           "command.indexes.name" << indexName <<
+                                           "progress" << BSON("$exists" << true));
+        for (mongo::BSONObj const &op : currentOps(filter, false, 0)) {
+            if (MongoNamespace(op.getStringField("ns")).databaseName() != ns.databaseName())
+                continue;
+
+            mongo::BSONObj const progress = op.getObjectField("progress");
+            done = progress["done"].safeNumberLong();
+            total = progress["total"].safeNumberLong();
+            return true;
+        }
+        return false;
+    }
+
     void MongoClient::dropIndexFromCollection(const MongoCollectionInfo &collection, const std::string &indexName) const
     {
         _dbclient->dropIndex(collection.ns().toString(), indexName);
@@ -453,57 +599,128 @@ namespace Robomongo
     void MongoClient::duplicateCollection(const MongoNamespace &ns, const std::string &newCollectionName)
     {
         MongoNamespace const newCollection(ns.databaseName(), newCollectionName);
+        if (_dbclient->exists(newCollection.toString()))
+            throw std::runtime_error("Collection with same name already exists.");
 
-        if (!_dbclient->exists(newCollection.toString())) {
-            mongo::BSONObj result;
-            // todo: Issue #1258 : Duplicate Collection should support advanced collection options.
-            //       _dbclient->createCollection() should be called with properties of source collection
-            //       not with default parameters as below.
-            if (!_dbclient->createCollection(newCollection.toString(), 0, false, 0, &result)) {
-                std::string errStr = result.getStringField("errmsg");
-                if (errStr.empty())
-                    errStr = "Failed to get error message.";
+        if (!createCollectionLike(_dbclient, ns, newCollection))
+            return;
 
-                throw std::runtime_error(errStr);
-            }
-        }
-        else {
-            throw std::runtime_error("Collection with same name already exists.");
+        copyDocumentsOnServer(ns, newCollection);
+        copyIndexes(_dbclient, ns, newCollection);
+    }
+
+    bool MongoClient::createCollectionLike(mongo::DBClientBase *const fromServ, const MongoNamespace &from,
+                                           const MongoNamespace &to)
+    {
+        // Issue #1258: new collection is created with options of source (capped, validator,
+        // collation, ...). Options of view are its 'viewOn' and 'pipeline', so view is duplicated as view.
+        mongo::BSONObj result;
+        mongo::BSONObj const listCommand = BSON("listCollections" << 1 << 
+                                                "filter" << BSON("name" << from.collectionName()));
+        if (!fromServ->runCommand(from.databaseName(), listCommand, result))
+            throw std::runtime_error("Failed to read collection options: " + std::string(result.getStringField("errmsg")));
+
+        mongo::BSONObj const batch = result.getObjectField("cursor").getObjectField("firstBatch");
+        if (batch.isEmpty())
+            throw std::runtime_error("Collection " + from.toString() + " does not exist.");
+
+        mongo::BSONObj const info = batch.firstElement().Obj().getOwned();
+
+        mongo::BSONObjBuilder create;
+        create.append("create", to.collectionName());
+        create.appendElements(info.getObjectField("options"));
+        if (!_dbclient->runCommand(to.databaseName(), create.obj(), result)) {
+            std::string errStr = result.getStringField("errmsg");
+            if (errStr.empty())
+                errStr = "Failed to get error message.";
+
+            throw std::runtime_error(errStr);
         }
 
-        std::unique_ptr<mongo::DBClientCursor> cursor {
-			_dbclient->query(mongo::NamespaceString(ns.databaseName(), ns.collectionName()), mongo::Query()) 
-		};
+        return std::strcmp(info.getStringField("type"), "view") != 0;
+    }
 
-        // Cursor may be NULL, it means we have connectivity problem
-        if (!cursor)
-            throw std::runtime_error("Network error while attempting to run query");
+    void MongoClient::copyIndexes(mongo::DBClientBase *const fromServ, const MongoNamespace &from,
+                                  const MongoNamespace &to)
+    {
+        // Called after documents are copied, which is faster than updating indexes on every insert
+        mongo::BSONArrayBuilder indexes;
+        for (mongo::BSONObj const &spec : fromServ->getIndexSpecs(from.toString())) {
+            if (std::strcmp(spec.getStringField("name"), "_id_") == 0)
+                continue;
 
-        while (cursor->more()) {
-            mongo::BSONObj bsonObj = cursor->next();
-            _dbclient->insert(newCollection.toString(), bsonObj);
+            // Specs of servers before 4.4 have namespace of source collection
+            indexes.append(spec.removeField("ns"));
         }
+
+        mongo::BSONArray const indexSpecs = indexes.arr();
+        if (indexSpecs.isEmpty())
+            return;
+
+        mongo::BSONObj result;
+        mongo::BSONObj const createIndexes = BSON("createIndexes" << to.collectionName() << "indexes" << indexSpecs);
+        if (!_dbclient->runCommand(to.databaseName(), createIndexes, result))
+            throw std::runtime_error("Documents are copied, but failed to create indexes: " + 
+                                     std::string(result.getStringField("errmsg")));
     }
 
-    void MongoClient::copyCollectionToDiffServer(mongo::DBClientBase *const fromServ, const MongoNamespace &from, 
-                                                 const MongoNamespace &to)
+    void MongoClient::copyDocumentsOnServer(const MongoNamespace &from, const MongoNamespace &to)
     {
-        if (!_dbclient->exists(to.toString()))
-            _dbclient->createCollection(to.toString());
+        // Wire version 8 is MongoDB 4.2 ($merge), 2 is MongoDB 2.6 (aggregation cursors and $out).
+        // $out into existing collection keeps its options, $merge inserts into it.
+        int const wireVersion = _dbclient->getMaxWireVersion();
+        if (wireVersion >= 2) {
+            mongo::BSONObj const stage = wireVersion >= 8 ?
+                BSON("$merge" << BSON("into" << BSON("db" << to.databaseName() << "coll" << to.collectionName()) <<
+                                      "whenMatched" << "fail" << "whenNotMatched" << "insert")) :
+                BSON("$out" << to.collectionName());
+
+            mongo::BSONObj const command = BSON("aggregate" << from.collectionName() << 
+                                                "pipeline" << BSON_ARRAY(BSON("$match" << mongo::BSONObj()) << stage) <<
+                                                "cursor" << mongo::BSONObj());
+            mongo::BSONObj result;
+            if (_dbclient->runCommand(from.databaseName(), command, result))
+                return;
+
+            // E.g. $out of sharded collection before 4.4 or into capped collection. Failed $out leaves
+            // collection unchanged, failed $merge may have inserted documents which can't be repeated.
+            if (!_dbclient->findOne(to.toString(), mongo::Query()).isEmpty())
+                throw std::runtime_error("Failed to copy documents: " + std::string(result.getStringField("errmsg")));
+        }
 
-        std::unique_ptr<mongo::DBClientCursor> cursor{fromServ->query(
-            mongo::NamespaceString(from.databaseName(), from.collectionName()),
-            mongo::Query()) 
-		};
+        copyDocuments(_dbclient, from, to);
+    }
+
+    void MongoClient::copyDocuments(mongo::DBClientBase *const fromServ, const MongoNamespace &from,
+                                    const MongoNamespace &to)
+    {
+        std::unique_ptr<mongo::DBClientCursor> cursor {
+            fromServ->query(mongo::NamespaceString(from.databaseName(), from.collectionName()), mongo::Query())
+        };
 
         // Cursor may be NULL, it means we have connectivity problem
         if (!cursor)
             throw std::runtime_error("Network error while attempting to run query");
 
+        // Documents are inserted in batches, one write command for up to 1000 documents or 8 MB
+        size_t const maxBatchCount = 1000;
+        int const maxBatchBytes = 8 * 1024 * 1024;
+
+        std::vector<mongo::BSONObj> batch;
+        int batchBytes = 0;
         while (cursor->more()) {
-            mongo::BSONObj bsonObj = cursor->next();
-            _dbclient->insert(to.toString(), bsonObj);
+            mongo::BSONObj const bsonObj = cursor->next().getOwned();
+            if (!batch.empty() && (batch.size() >= maxBatchCount || batchBytes + bsonObj.objsize() > maxBatchBytes)) {
+                _dbclient->insert(to.toString(), batch);
+                batch.clear();
+                batchBytes = 0;
+            }
+            batchBytes += bsonObj.objsize();
+            batch.push_back(bsonObj);
         }
+
+        if (!batch.empty())
+            _dbclient->insert(to.toString(), batch);
     }
 
     void MongoClient::dropCollection(const MongoNamespace &ns)
@@ -541,60 +758,878 @@ namespace Robomongo
         checkLastErrorAndThrow(ns.databaseName());
     }
 
+    void MongoClient::updateDocument(const mongo::BSONObj &original, const mongo::BSONObj &edited,
+                                     const MongoNamespace &ns)
+    {
+        DocumentUpdate diff;
+        if (!diff.compute(original, edited))
+            return saveDocument(edited, ns);
+
+        if (diff.isEmpty())
+            return;
+
+        mongo::BSONArrayBuilder updates;
+        updates.append(BSON("q" << diff.filter() << "u" << diff.update()));
+
+        mongo::BSONObjBuilder cmd;
+        cmd.append("update", ns.collectionName());
+        cmd.append("updates", updates.arr());
+
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(ns.databaseName(), cmd.done(), result)) {
+            std::string errStr = result.getStringField("errmsg");
+            if (errStr.empty())
+                errStr = "Failed to get error message.";
+
+            throw std::runtime_error(errStr);
+        }
+
+        mongo::BSONElement writeErrors = result.getField("writeErrors");
+        if (writeErrors.type() == mongo::Array && !writeErrors.Array().empty())
+            throw std::runtime_error(writeErrors.Array().front().Obj().getStringField("errmsg"));
+
+        if (result.getIntField("n") == 0)
+            throw std::runtime_error("Document was modified or removed by another client after it "
+                                     "was loaded. Refresh results and edit it again.");
+    }
+
+    bool MongoClient::supportsTransactions() const
+    {
+        if (_capabilities && _capabilities->_transactions >= 0)
+            return _capabilities->_transactions == 1;
+
+        // Wire version 7 is MongoDB 4.0 (transactions on replica sets), 8 is 4.2 (sharded clusters).
+        // Standalone servers have no transactions, servers without sessions report no timeout.
+        bool supported = false;
+        mongo::BSONObj info;
+        if (_dbclient->runCommand("admin", BSON("isMaster" << 1), info) &&
+            info.hasField("logicalSessionTimeoutMinutes")) {
+            int const wireVersion = info.getIntField("maxWireVersion");
+            bool const isReplicaSet = info.hasField("setName");
+            bool const isMongos = std::string(info.getStringField("msg")) == "isdbgrid";
+            supported = (isReplicaSet && wireVersion >= 7) || (isMongos && wireVersion >= 8);
+        }
+
+        if (_capabilities)
+            _capabilities->_transactions = supported ? 1 : 0;
+        return supported;
+    }
+
+    TableChangeset::CommitResult MongoClient::commitChangeset(const std::vector<TableChangeset::Statement> &statements,
+                                                              const MongoNamespace &ns)
+    {
+        TableChangeset::CommitResult commit;
+        if (statements.empty())
+            return commit;
+
+        mongo::BSONArrayBuilder updates;
+        for (TableChangeset::Statement const &statement : statements)
+            updates.append(BSON("q" << statement.filter << "u" << statement.update));
+
+        mongo::BSONObjBuilder cmd;
+        cmd.append("update", ns.collectionName());
+        cmd.append("updates", updates.arr());
+        cmd.append("ordered", false);
+
+        // Session id is generated here, server starts the session with the first command of
+        // transaction. It is not ended explicitly, unused sessions expire on server.
+        commit.transaction = supportsTransactions();
+        mongo::BSONObj lsid;
+        auto const transactionCommand = [&lsid](const char *name) {
+            return BSON(name << 1 << "lsid" << lsid << "txnNumber" << 1LL << "autocommit" << false);
+        };
+        if (commit.transaction) {
+            thread_local std::mt19937_64 generator(std::random_device{}());
+            unsigned char uuid[16];
+            for (unsigned char &byte : uuid)
+                byte = static_cast<unsigned char>(generator());
+            uuid[6] = (uuid[6] & 0x0f) | 0x40;  // version 4 (random)
+            uuid[8] = (uuid[8] & 0x3f) | 0x80;  // RFC 4122 variant
+            mongo::BSONObjBuilder id;
+            id.appendBinData("id", sizeof(uuid), mongo::newUUID, uuid);
+            lsid = id.obj();
+
+            cmd.append("lsid", lsid);
+            cmd.append("txnNumber", 1LL);
+            cmd.append("startTransaction", true);
+            cmd.append("autocommit", false);
+        }
+
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(ns.databaseName(), cmd.obj(), result)) {
+            std::string errStr = result.getStringField("errmsg");
+            if (errStr.empty())
+                errStr = "Failed to get error message.";
+
+            // Failed command aborts transaction on server, this only makes sure it is not left open
+            if (commit.transaction) {
+                mongo::BSONObj aborted;
+                _dbclient->runCommand("admin", transactionCommand("abortTransaction"), aborted);
+            }
+            throw std::runtime_error(errStr);
+        }
+
+        std::map<int, std::string> writeErrors;
+        mongo::BSONElement const errors = result.getField("writeErrors");
+        if (errors.type() == mongo::Array) {
+            for (mongo::BSONElement const &error : errors.Array())
+                writeErrors[error.Obj().getIntField("index")] = error.Obj().getStringField("errmsg");
+        }
+
+        int const matched = result.getIntField("n");
+        bool const complete = writeErrors.empty() && matched == static_cast<int>(statements.size());
+        if (commit.transaction) {
+            if (complete) {
+                mongo::BSONObj committed;
+                if (!_dbclient->runCommand("admin", transactionCommand("commitTransaction"), committed))
+                    throw std::runtime_error("Failed to commit transaction: " +
+                                             std::string(committed.getStringField("errmsg")));
+                commit.updated = matched;
+                return commit;
+            }
+
+            mongo::BSONObj aborted;
+            _dbclient->runCommand("admin", transactionCommand("abortTransaction"), aborted);
+            commit.aborted = true;
+        }
+        else {
+            commit.updated = matched;
+            if (complete)
+                return commit;
+        }
+
+        // Rows still as loaded (transaction was aborted) or already updated (no transaction)
+        // are matched, the rest are conflicts
+        mongo::BSONArrayBuilder filters;
+        for (TableChangeset::Statement const &statement : statements)
+            filters.append(commit.aborted ? statement.filter : statement.applied);
+
+        mongo::BSONObj const idOnly = BSON("_id" << 1);
+        std::unique_ptr<mongo::DBClientCursor> cursor = _dbclient->query(
+            mongo::NamespaceString(ns.databaseName(), ns.collectionName()),
+            mongo::Query(BSON("$or" << filters.arr())), 0, 0, &idOnly);
+        if (!cursor)
+            throw std::runtime_error("Network error while reading conflicting documents");
+
+        std::vector<mongo::BSONObj> matchedIds;
+        while (cursor->more())
+            matchedIds.push_back(cursor->nextSafe().getOwned());
+
+        commit.conflicts = TableChangeset::conflicts(statements, matchedIds, writeErrors);
+        return commit;
+    }
+
+    std::vector<BulkChunkResult> MongoClient::insertDocuments(const std::vector<mongo::BSONObj> &objs, 
+                                                              const MongoNamespace &ns, bool overwrite,
+                                                              int batchBytesLimit)
+    {
+        // Limit of documents in one write command, for servers before 3.6
+        size_t const maxBatchCount = 1000;
+
+        std::vector<BulkChunkResult> results;
+        size_t first = 0;
+        while (first < objs.size()) {
+            // Batch has at least one document, even if it is bigger than limit
+            size_t last = first + 1;
+            int bytes = objs[first].objsize();
+            while (last < objs.size() && last - first < maxBatchCount && 
+                   bytes + objs[last].objsize() <= batchBytesLimit) {
+                bytes += objs[last].objsize();
+                ++last;
+            }
+
+            int const count = static_cast<int>(last - first);
+            try {
+                if (overwrite)
+                    saveDocuments(objs, first, last, ns);
+                else {
+                    _dbclient->insert(ns.toString(), 
+                        std::vector<mongo::BSONObj>(objs.begin() + first, objs.begin() + last));
+                    checkLastErrorAndThrow(ns.databaseName());
+                }
+                results.push_back(BulkChunkResult(static_cast<int>(first), count));
+            }
+            catch (const std::exception &ex) {
+                results.push_back(BulkChunkResult(static_cast<int>(first), count, ex.what()));
+            }
+            first = last;
+        }
+        return results;
+    }
+
+    void MongoClient::saveDocuments(const std::vector<mongo::BSONObj> &objs, size_t first, size_t last,
+                                    const MongoNamespace &ns)
+    {
+        mongo::BSONArrayBuilder updates;
+        for (size_t i = first; i < last; ++i) {
+            mongo::BSONObjBuilder id;
+            id.append(objs[i].getField("_id"));
+            updates.append(BSON("q" << id.obj() << "u" << objs[i] << "upsert" << true));
+        }
+
+        mongo::BSONObjBuilder cmd;
+        cmd.append("update", ns.collectionName());
+        cmd.append("updates", updates.arr());
+        cmd.append("ordered", false);
+
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(ns.databaseName(), cmd.done(), result)) {
+            std::string errStr = result.getStringField("errmsg");
+            if (errStr.empty())
+                errStr = "Failed to get error message.";
+
+            throw std::runtime_error(errStr);
+        }
+
+        mongo::BSONElement writeErrors = result.getField("writeErrors");
+        if (writeErrors.type() == mongo::Array && !writeErrors.Array().empty()) {
+            std::vector<mongo::BSONElement> const errors = writeErrors.Array();
+            throw std::runtime_error(std::to_string(errors.size()) + " documents failed: " + 
+                                     errors.front().Obj().getStringField("errmsg"));
+        }
+    }
+
     void MongoClient::removeDocuments(const MongoNamespace &ns, mongo::Query query, bool justOne /*= true*/)
     {
         _dbclient->remove(ns.toString(), query, justOne);        
         checkLastErrorAndThrow(ns.databaseName());
     }
 
+    std::vector<BulkChunkResult> MongoClient::removeDocumentsById(const MongoNamespace &ns, 
+                                                                  const std::vector<mongo::BSONObj> &ids,
+                                                                  int chunkSize /*= 1000*/)
+    {
+        std::vector<BulkChunkResult> results;
+        size_t const step = std::max(1, chunkSize);
+        for (size_t first = 0; first < ids.size(); first += step) {
+            size_t const last = std::min(ids.size(), first + step);
+
+            mongo::BSONArrayBuilder idsBuilder;
+            for (size_t i = first; i < last; ++i)
+                idsBuilder.append(ids[i].firstElement());
+
+            mongo::BSONObj const bsonQuery = BSON("_id" << BSON("$in" << idsBuilder.arr()));
+            int const count = static_cast<int>(last - first);
+            try {
+                removeDocuments(ns, mongo::Query(bsonQuery), false);
+                results.push_back(BulkChunkResult(static_cast<int>(first), count));
+            }
+            catch (const std::exception &ex) {
+                results.push_back(BulkChunkResult(static_cast<int>(first), count, ex.what()));
+            }
+        }
+        return results;
+    }
+
     std::vector<MongoDocumentPtr> MongoClient::query(const MongoQueryInfo &info)
     {
-        MongoNamespace ns(info._info._ns);
+        std::vector<MongoDocumentPtr> docs;
+        query(info, [&docs](const std::vector<MongoDocumentPtr> &batch, bool) {
+            docs.insert(docs.end(), batch.begin(), batch.end());
+        });
+        return docs;
+    }
 
+    void MongoClient::query(const MongoQueryInfo &info, const QueryBatchHandler &onBatch)
+    {
         //int limit = (info.limit <= 0) ? 50 : info.limit;
 
-        std::vector<MongoDocumentPtr> docs;
+        if (info._limit == -1) { // it means that we do not need to load any documents
+            onBatch(std::vector<MongoDocumentPtr>(), true);
+            return;
+        }
 
-        if (info._limit == -1) // it means that we do not need to load any documents
-            return docs;
+        std::unique_ptr<mongo::DBClientCursor> cursor = openCursor(info);
+
+        // Only documents already received are drained here, so every batch is handed
+        // over before the cursor issues next getMore request.
+        std::string const batchKey = batchSizeKey(info);
+        // Documents point into buffer of the cursor until next getMore, then the whole
+        // batch is copied into one slab (see MongoDocument::fromBatch())
+        std::vector<mongo::BSONObj> views;
+        bool lastBatchSent = false;
+        while (more(*cursor, batchKey)) {
+            // Batch is received already, so its size is known (no regrowth of vector)
+            views.reserve(cursor->objsLeftInBatch());
+            do {
+                views.push_back(cursor->next());
+            } while (cursor->moreInCurrentBatch());
+
+            lastBatchSent = cursor->isDead();
+            onBatch(MongoDocument::fromBatch(views), lastBatchSent);
+            views.clear();
+        }
+
+        if (!lastBatchSent)
+            onBatch(std::vector<MongoDocumentPtr>(), true);
+    }
+
+    std::vector<mongo::BSONObj> MongoClient::splitIdRanges(const MongoNamespace &ns, int parts)
+    {
+        std::vector<mongo::BSONObj> bounds;
+        if (parts < 2)
+            return bounds;
+
+        mongo::BSONObj stats;
+        mongo::BSONObj result;
+        long long const size = 
+            _dbclient->runCommand(ns.databaseName(), BSON("collStats" << ns.collectionName()), stats, 
+                                  mongo::QueryOption_SlaveOk) ? stats["size"].safeNumberLong() : 0;
+        if (size <= 0)
+            return bounds;
+
+        long long const maxChunkSizeBytes = std::max(size / parts, 1024LL * 1024);
+        if (_dbclient->runCommand(ns.databaseName(),
+                                  BSON("splitVector" << ns.toString() << "keyPattern" << BSON("_id" << 1)
+                                       << "maxChunkSizeBytes" << maxChunkSizeBytes), 
+                                  result, mongo::QueryOption_SlaveOk)) {
+            // Chunks are never larger than requested, so there may be more of them than parts
+            std::vector<mongo::BSONElement> const keys = result["splitKeys"].Array();
+            size_t const count = std::min<size_t>(keys.size(), parts - 1);
+            for (size_t i = 1; i <= count; ++i)
+                bounds.push_back(keys[i * keys.size() / (count + 1)].Obj().getOwned());
+            return bounds;
+        }
+
+        // Small { $sample } is served by random cursor, without collection scan
+        mongo::BSONArray const pipeline = BSON_ARRAY(
+            BSON("$sample" << BSON("size" << parts * 100)) <<
+            BSON("$bucketAuto" << BSON("groupBy" << "$_id" << "buckets" << parts)));
+        std::vector<MongoDocumentPtr> const buckets = aggregate(ns, pipeline, mongo::BSONObj(), parts);
+        for (size_t i = 1; i < buckets.size(); ++i) {
+            mongo::BSONObj const bucket = buckets[i]->bsonObj();
+            bounds.push_back(BSON("_id" << bucket["_id"]["min"]));
+        }
+        return bounds;
+    }
 
+    std::unique_ptr<mongo::DBClientCursor> MongoClient::openCursor(const MongoQueryInfo &info)
+    {
+        MongoNamespace ns(info._info._ns);
+        // Server stops the query (and its getMores) once time limit of tab is spent
+        mongo::BSONObj const query = withMaxTime(info._query, info._special, info._maxTimeMs);
+        bool const special = info._special || info._maxTimeMs > 0;
         std::unique_ptr<mongo::DBClientCursor> cursor = _dbclient->query(
 			mongo::NamespaceString(ns.databaseName(), ns.collectionName()),          
-			info._query, info._limit, info._skip, info._fields.nFields() ? &info._fields : 0, 
-			info._options, info._batchSize
+			info._readPreference.applyToQuery(query, special), info._limit, info._skip,
+			info._fields.nFields() ? &info._fields : 0, info._readPreference.applyToOptions(info._options),
+			AdaptiveBatchSize::instance().batchSize(batchSizeKey(info), info._batchSize)
 		);
 
         // DBClientBase::query may return nullptr
         if (!cursor)
             throw std::runtime_error("Network error while attempting to run query");
 
-        while (cursor->more()) {
-            mongo::BSONObj bsonObj = cursor->next();
-            MongoDocumentPtr doc(new MongoDocument(bsonObj.getOwned()));
-            docs.push_back(doc);
+        return cursor;
+    }
+
+    bool MongoClient::more(mongo::DBClientCursor &cursor, const std::string &batchKey)
+    {
+        if (cursor.moreInCurrentBatch())
+            return true;
+
+        auto const start = std::chrono::steady_clock::now();
+        if (!cursor.more())
+            return false;
+
+        double const elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        // Documents of batch are in its reply buffer already, peek does not copy them
+        int const documents = cursor.objsLeftInBatch();
+        std::vector<mongo::BSONObj> batch;
+        cursor.peek(batch, documents);
+        long long bytes = 0;
+        for (auto const &obj : batch)
+            bytes += obj.objsize();
+
+        AdaptiveBatchSize::instance().addSample(batchKey, documents, bytes, elapsedMs);
+        return true;
+    }
+
+    std::string MongoClient::batchSizeKey(const MongoQueryInfo &info)
+    {
+        return info._info._serverAddress + "/" + info._info._ns.toString();
+    }
+
+    std::vector<MongoDocumentPtr> MongoClient::aggregate(const MongoNamespace &ns, 
+                                                         const mongo::BSONObj &pipeline,
+                                                         const mongo::BSONObj &options, int batchSize)
+    {
+        long long cursorId = 0;
+        std::vector<MongoDocumentPtr> documents = openAggregation(ns, pipeline, options, batchSize, cursorId);
+        if (cursorId != 0)
+            killCursor(ns, cursorId);
+        return documents;
+    }
+
+    std::vector<MongoDocumentPtr> MongoClient::openAggregation(const MongoNamespace &ns,
+                                                               const mongo::BSONObj &pipeline,
+                                                               const mongo::BSONObj &options, int batchSize, 
+                                                               long long &cursorId)
+    {
+        // { aggregate: "collection", pipeline: [...], cursor: { batchSize: N }, <options> } 
+        mongo::BSONObjBuilder command;
+        command.append("aggregate", ns.collectionName());
+        command.appendArray("pipeline", pipeline);
+        command.append("cursor", BSON("batchSize" << batchSize));
+        for (mongo::BSONObjIterator it(options); it.more();) {
+            mongo::BSONElement const option = it.next();
+            if (std::strcmp(option.fieldName(), "cursor") != 0)
+                command.append(option);
         }
 
-        return docs;
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(ns.databaseName(), command.obj(), result, mongo::QueryOption_SlaveOk))
+            throw std::runtime_error(result.getStringField("errmsg"));
+
+        mongo::BSONObj const cursor = result.getObjectField("cursor");
+        std::vector<mongo::BSONObj> batch;
+        for (mongo::BSONObjIterator it(cursor.getObjectField("firstBatch")); it.more();)
+            batch.push_back(it.next().Obj());
+
+        cursorId = cursor["id"].safeNumberLong();
+        return MongoDocument::fromBatch(batch);
+    }
+
+    std::vector<MongoDocumentPtr> MongoClient::getMore(const MongoNamespace &ns, long long &cursorId, 
+                                                       int batchSize)
+    {
+        mongo::BSONObj const command = BSON("getMore" << cursorId << "collection" << ns.collectionName() << 
+                                            "batchSize" << batchSize);
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(ns.databaseName(), command, result, mongo::QueryOption_SlaveOk))
+            throw std::runtime_error(result.getStringField("errmsg"));
+
+        mongo::BSONObj const cursor = result.getObjectField("cursor");
+        std::vector<mongo::BSONObj> batch;
+        for (mongo::BSONObjIterator it(cursor.getObjectField("nextBatch")); it.more();)
+            batch.push_back(it.next().Obj());
+
+        cursorId = cursor["id"].safeNumberLong();
+        return MongoDocument::fromBatch(batch);
+    }
+
+    std::vector<mongo::BSONObj> MongoClient::openChangeStream(const mongo::BSONArray &pipeline, MongoNamespace &ns,
+                                                              long long &cursorId)
+    {
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand("admin", BSON("aggregate" << 1 << "pipeline" << pipeline << "cursor" << mongo::BSONObj()),
+                                   result))
+            throw std::runtime_error(result.getStringField("errmsg"));
+
+        // Namespace of cursor is "admin.$cmd.aggregate", getMore needs the part after database
+        mongo::BSONObj const cursor = result.getObjectField("cursor");
+        std::string const cursorNs = cursor.getStringField("ns");
+        ns = MongoNamespace("admin", cursorNs.substr(cursorNs.find('.') + 1));
+        cursorId = cursor["id"].safeNumberLong();
+        return cursorBatch(cursor, "firstBatch");
+    }
+
+    std::vector<mongo::BSONObj> MongoClient::openChangeStream(const MongoNamespace &collection,
+                                                              const mongo::BSONArray &pipeline, int batchSize,
+                                                              MongoNamespace &ns, long long &cursorId)
+    {
+        mongo::BSONObjBuilder cursorOptions;
+        if (batchSize > 0)
+            cursorOptions.append("batchSize", batchSize);
+
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(collection.databaseName(),
+                                   BSON("aggregate" << collection.collectionName() << "pipeline" << pipeline <<
+                                        "cursor" << cursorOptions.obj()),
+                                   result))
+            throw std::runtime_error(result.getStringField("errmsg"));
+
+        mongo::BSONObj const cursor = result.getObjectField("cursor");
+        ns = collection;
+        cursorId = cursor["id"].safeNumberLong();
+        return cursorBatch(cursor, "firstBatch");
+    }
+
+    std::vector<mongo::BSONObj> MongoClient::openOplogTail(const mongo::BSONObj &query, int batchSize, 
+                                                           MongoNamespace &ns, long long &cursorId)
+    {
+        ns = MongoNamespace("local", "oplog.rs");
+        mongo::BSONObjBuilder find;
+        find.append("find", ns.collectionName());
+        find.append("filter", query);
+        find.append("tailable", true);
+        find.append("awaitData", true);
+        find.append("batchSize", batchSize);
+        // Server skips to the first matching 'ts' instead of scanning the whole oplog
+        if (query.hasField("ts"))
+            find.append("oplogReplay", true);
+
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(ns.databaseName(), find.obj(), result))
+            throw std::runtime_error(result.getStringField("errmsg"));
+
+        mongo::BSONObj const cursor = result.getObjectField("cursor");
+        cursorId = cursor["id"].safeNumberLong();
+        return cursorBatch(cursor, "firstBatch");
+    }
+
+    std::vector<mongo::BSONObj> MongoClient::awaitMore(const MongoNamespace &ns, long long &cursorId, int awaitMs,
+                                                       int batchSize)
+    {
+        mongo::BSONObjBuilder getMore;
+        getMore.append("getMore", cursorId);
+        getMore.append("collection", ns.collectionName());
+        if (batchSize > 0)
+            getMore.append("batchSize", batchSize);
+        getMore.append("maxTimeMS", awaitMs);
+
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(ns.databaseName(), getMore.obj(), result)) {
+            // Position of cursor was overwritten in capped collection
+            if (result["code"].numberInt() == mongo::ErrorCodes::CappedPositionLost) {
+                cursorId = 0;
+                return {};
+            }
+            throw std::runtime_error(result.getStringField("errmsg"));
+        }
+
+        mongo::BSONObj const cursor = result.getObjectField("cursor");
+        cursorId = cursor["id"].safeNumberLong();
+        return cursorBatch(cursor, "nextBatch");
+    }
+
+    mongo::Timestamp MongoClient::lastOplogTimestamp() const
+    {
+        mongo::BSONObj const last = _dbclient->findOne("local.oplog.rs", mongo::Query().sort(BSON("$natural" << -1)));
+        return last.isEmpty() ? mongo::Timestamp() : last["ts"].timestamp();
+    }
+
+    void MongoClient::killCursor(const MongoNamespace &ns, long long cursorId)
+    {
+        mongo::BSONObj ignored;
+        _dbclient->runCommand(ns.databaseName(), 
+            BSON("killCursors" << ns.collectionName() << "cursors" << BSON_ARRAY(cursorId)), ignored);
+    }
+
+    long long MongoClient::countDocuments(const MongoQueryInfo &info, int maxTimeMs, bool &estimated)
+    {
+        MongoNamespace const ns(info._info._ns);
+        // Query may be wrapped as { $query: ..., $orderby: ... }
+        mongo::BSONObj const filter = mongo::Query(info._query).getFilter();
+        mongo::BSONObj result;
+
+        estimated = filter.isEmpty();
+        if (estimated) {    // { count: "collection" } without query reads collection metadata
+            mongo::BSONObj const command = BSON("count" << ns.collectionName() << "maxTimeMS" << maxTimeMs);
+            if (!_dbclient->runCommand(ns.databaseName(), command, result, mongo::QueryOption_SlaveOk))
+                throw std::runtime_error("Failed to count documents: " + std::string(result.getStringField("errmsg")));
+
+            return result["n"].safeNumberLong();
+        }
+
+        // What countDocuments() of drivers does: [ { $match: ... }, { $group: { _id: 1, n: { $sum: 1 } } } ]
+        mongo::BSONObj const pipeline = BSON_ARRAY(
+            BSON("$match" << filter) << 
+            BSON("$group" << BSON("_id" << 1 << "n" << BSON("$sum" << 1))));
+        mongo::BSONObj const command = BSON("aggregate" << ns.collectionName() << "pipeline" << pipeline << 
+                                            "cursor" << mongo::BSONObj() << "maxTimeMS" << maxTimeMs);
+        if (!_dbclient->runCommand(ns.databaseName(), command, result, mongo::QueryOption_SlaveOk))
+            throw std::runtime_error("Failed to count documents: " + std::string(result.getStringField("errmsg")));
+
+        // No group at all, if nothing matched
+        mongo::BSONObj const batch = result.getObjectField("cursor").getObjectField("firstBatch");
+        if (batch.isEmpty())
+            return 0;
+
+        return batch.firstElement().Obj()["n"].safeNumberLong();
     }
 
     MongoCollectionInfo MongoClient::runCollStatsCommand(const std::string &ns)
     {
-        MongoCollectionInfo info(ns);
-        return info;
+        // Views and collections without access rights have no stats, info without stats is returned
+        mongo::BSONObj const stats = collStats(MongoNamespace(ns));
+        if (stats.isEmpty())
+            return MongoCollectionInfo(ns);
 
-/*      // Commented for now, to speedup load of collection names
-        MongoNamespace mongons(ns);
+        return MongoCollectionInfo(ns, stats);
+    }
 
-        mongo::BSONObjBuilder command; // { collStats: "db.collection", scale : 1 }
-        command.append("collStats", mongons.collectionName());
+    std::vector<ShardFanout::Target> MongoClient::shardTargets(const MongoNamespace &ns, 
+                                                                mongo::BSONObj &shardKey) const
+    {
+        auto const readAll = [this](const std::string &configCollection, const mongo::BSONObj &filter) {
+            std::vector<mongo::BSONObj> docs;
+            std::unique_ptr<mongo::DBClientCursor> cursor = _dbclient->query(
+                mongo::NamespaceString("config", configCollection), mongo::Query(filter));
+            if (!cursor)
+                throw std::runtime_error("Network error while reading config." + configCollection);
+
+            while (cursor->more())
+                docs.push_back(cursor->next().getOwned());
+            return docs;
+        };
+
+        mongo::BSONObj const collection = _dbclient->findOne("config.collections", 
+                                                             mongo::Query(BSON("_id" << ns.toString())));
+        if (collection.isEmpty() || collection.getBoolField("dropped"))
+            throw std::runtime_error("Collection " + ns.toString() + " is not sharded.");
+        shardKey = collection.getObjectField("key").getOwned();
+
+        // Chunks refer to collection by uuid since 5.0, by namespace before
+        mongo::BSONObj const chunksFilter = collection.hasField("uuid") ?
+            BSON("$or" << BSON_ARRAY(BSON("uuid" << collection["uuid"]) << BSON("ns" << ns.toString()))) :
+            BSON("ns" << ns.toString());
+        std::vector<mongo::BSONObj> const chunks = readAll("chunks", chunksFilter);
+        if (chunks.empty())
+            throw std::runtime_error("No chunks of " + ns.toString() + " found in config database.");
+
+        return ShardFanout::targets(readAll("shards", mongo::BSONObj()), chunks);
+    }
+
+    mongo::BSONObj MongoClient::collStats(const MongoNamespace &ns, bool indexDetails) const
+    {
+        mongo::BSONObjBuilder command; // { collStats: "collection", scale : 1 }
+        command.append("collStats", ns.collectionName());
         command.append("scale", 1);
+        if (indexDetails)
+            command.append("indexDetails", true);
 
         mongo::BSONObj result;
-        _dbclient->runCommand(mongons.databaseName(), command.obj(), result);
-        std::string isCV = result.toString();
-        MongoCollectionInfo newInfo(result);
-        return newInfo;
-        */
+        if (!_dbclient->runCommand(ns.databaseName(), command.obj(), result, mongo::QueryOption_SlaveOk))
+            return mongo::BSONObj();
+
+        return result.getOwned();
+    }
+
+    std::vector<IndexUsageInfo> MongoClient::indexUsage(const MongoNamespace &ns) const
+    {
+        std::vector<IndexUsageInfo> usage;
+        auto const find = [&usage](const std::string &name) -> IndexUsageInfo & {
+            for (auto &info : usage) {
+                if (info._name == name)
+                    return info;
+            }
+            usage.push_back(IndexUsageInfo());
+            usage.back()._name = name;
+            return usage.back();
+        };
+
+        // On mongos there is one document per index and shard
+        mongo::BSONObj const command = BSON("aggregate" << ns.collectionName() <<
+                                            "pipeline" << BSON_ARRAY(BSON("$indexStats" << mongo::BSONObj())) <<
+                                            "cursor" << mongo::BSONObj());
+        mongo::BSONObj result;
+        if (_dbclient->runCommand(ns.databaseName(), command, result, mongo::QueryOption_SlaveOk)) {
+            for (mongo::BSONObjIterator it(result.getObjectField("cursor").getObjectField("firstBatch")); it.more();) {
+                mongo::BSONObj const stats = it.next().Obj();
+                mongo::BSONObj const accesses = stats.getObjectField("accesses");
+                long long const sinceMs = accesses["since"].type() == mongo::Date ?
+                    accesses["since"].date().toMillisSinceEpoch() : 0;
+
+                IndexUsageInfo &info = find(stats.getStringField("name"));
+                info._ops = std::max(info._ops, 0LL) + accesses["ops"].safeNumberLong();
+                if (info._sinceMs == 0 || (sinceMs != 0 && sinceMs < info._sinceMs))
+                    info._sinceMs = sinceMs;
+            }
+        }
+
+        mongo::BSONObj const stats = collStats(ns);
+        for (mongo::BSONObjIterator it(stats.getObjectField("indexSizes")); it.more();) {
+            mongo::BSONElement const size = it.next();
+            find(size.fieldName())._sizeBytes = size.safeNumberLong();
+        }
+
+        return usage;
+    }
+
+    mongo::BSONObj MongoClient::dbStats(const std::string &dbName) const
+    {
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(dbName, BSON("dbStats" << 1 << "scale" << 1), result, 
+                                   mongo::QueryOption_SlaveOk))
+            return mongo::BSONObj();
+
+        return result.getOwned();
+    }
+
+    mongo::BSONObj MongoClient::serverStatusSample() const
+    {
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand("admin", BSON("serverStatus" << 1 << "metrics" << 0 << "locks" << 0), 
+                                   result, mongo::QueryOption_SlaveOk))
+            throw std::runtime_error("Failed to read server status: " + std::string(result.getStringField("errmsg")));
+
+        return result.getOwned();
+    }
+
+    std::vector<ProfileShapeInfo> MongoClient::profileSummary(const std::string &dbName, long long sinceMs,
+                                                               int minMillis, int limit) const
+    {
+        // system.profile may hold millions of operations, grouping may need disk
+        mongo::BSONObj const command = BSON("aggregate" << "system.profile" << 
+                                            "pipeline" << ProfileSummary::pipeline(sinceMs, minMillis, limit) <<
+                                            "cursor" << BSON("batchSize" << limit) <<
+                                            "allowDiskUse" << true << 
+                                            "comment" << ProfileSummary::Comment);
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(dbName, command, result, mongo::QueryOption_SlaveOk))
+            throw std::runtime_error("Failed to read profiler data: " + std::string(result.getStringField("errmsg")));
+
+        std::vector<ProfileShapeInfo> shapes;
+        for (mongo::BSONObjIterator it(result.getObjectField("cursor").getObjectField("firstBatch")); it.more();)
+            shapes.push_back(ProfileSummary::shapeFromGroup(it.next().Obj()));
+        return shapes;
+    }
+
+    std::vector<PlanCacheEntryInfo> MongoClient::planCacheStats(const MongoNamespace &ns, int limit) const
+    {
+        mongo::BSONObj const command = BSON("aggregate" << ns.collectionName() <<
+                                            "pipeline" << PlanCache::pipeline(limit) <<
+                                            "cursor" << BSON("batchSize" << limit));
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(ns.databaseName(), command, result, mongo::QueryOption_SlaveOk))
+            throw std::runtime_error("Failed to read plan cache: " + std::string(result.getStringField("errmsg")));
+
+        std::vector<PlanCacheEntryInfo> entries;
+        for (mongo::BSONObjIterator it(result.getObjectField("cursor").getObjectField("firstBatch")); it.more();)
+            entries.push_back(PlanCache::entryFromStats(it.next().Obj()));
+        return entries;
+    }
+
+    ShardDistribution::Snapshot MongoClient::shardDistribution(const MongoNamespace &ns, long long sinceMs) const
+    {
+        auto const aggregate = [this](const std::string &dbName, const std::string &collection,
+                                      const mongo::BSONArray &pipeline, bool required) {
+            std::vector<mongo::BSONObj> docs;
+            mongo::BSONObj const command = BSON("aggregate" << collection << "pipeline" << pipeline <<
+                                                "cursor" << mongo::BSONObj());
+            mongo::BSONObj result;
+            if (!_dbclient->runCommand(dbName, command, result, mongo::QueryOption_SlaveOk)) {
+                if (required)
+                    throw std::runtime_error("Failed to read " + dbName + "." + collection + ": " + 
+                                             std::string(result.getStringField("errmsg")));
+                return docs;
+            }
+
+            // Groups of shards and changelog entries fit into first batch
+            for (mongo::BSONObjIterator it(result.getObjectField("cursor").getObjectField("firstBatch")); it.more();)
+                docs.push_back(it.next().Obj().getOwned());
+            return docs;
+        };
+
+        mongo::BSONObj const collection = _dbclient->findOne("config.collections", 
+                                                             mongo::Query(BSON("_id" << ns.toString())));
+        if (collection.isEmpty() || collection.getBoolField("dropped"))
+            throw std::runtime_error("Collection " + ns.toString() + " is not sharded.");
+
+        ShardDistribution::Snapshot snapshot;
+        std::unique_ptr<mongo::DBClientCursor> shards = _dbclient->query(
+            mongo::NamespaceString("config", "shards"), mongo::Query(), 0, 0, nullptr);
+        if (!shards)
+            throw std::runtime_error("Network error while reading config.shards");
+        while (shards->more())
+            ShardDistribution::addShard(snapshot, shards->next().getStringField("_id"));
+
+        mongo::BSONObj const chunksFilter = ShardDistribution::chunksFilter(collection, ns.toString());
+        for (auto const &group : aggregate("config", "chunks", ShardDistribution::chunksPipeline(chunksFilter), true))
+            ShardDistribution::addChunkGroup(snapshot, group);
+
+        // Statistics and balancer state are optional, user may lack the privileges
+        mongo::BSONArray const collStats = BSON_ARRAY(BSON("$collStats" << BSON("storageStats" << mongo::BSONObj())));
+        for (auto const &stats : aggregate(ns.databaseName(), ns.collectionName(), collStats, false))
+            ShardDistribution::addStorageStats(snapshot, stats);
+
+        for (auto const &group : aggregate("config", "changelog", 
+                                           ShardDistribution::changelogPipeline(ns.toString(), sinceMs), false))
+            ShardDistribution::addChangelogGroup(snapshot, group);
+
+        mongo::BSONObj status;
+        if (_dbclient->runCommand("admin", BSON("balancerStatus" << 1), status)) {
+            snapshot.balancer.mode = status.getStringField("mode");
+            snapshot.balancer.inRound = status["inBalancerRound"].trueValue();
+        }
+        snapshot.balancer.noBalance = collection["noBalance"].trueValue();
+        return snapshot;
+    }
+
+    std::vector<GridFs::FileInfo> MongoClient::gridFsFiles(const std::string &dbName, const std::string &bucket,
+                                                           const std::string &filename, int limit) const
+    {
+        std::unique_ptr<mongo::DBClientCursor> cursor = _dbclient->query(
+            mongo::NamespaceString(dbName, GridFs::filesCollection(bucket)),
+            mongo::Query(GridFs::filesFilter(filename)).sort(BSON("uploadDate" << -1)), limit, 0,
+            nullptr, mongo::QueryOption_SlaveOk);
+
+        // DBClientBase::query may return nullptr
+        if (!cursor)
+            throw std::runtime_error("Network error while reading files of GridFS bucket " + bucket);
+
+        std::vector<GridFs::FileInfo> files;
+        while (cursor->more())
+            files.push_back(GridFs::fileFromDocument(cursor->next()));
+        return files;
+    }
+
+    void MongoClient::ensureGridFsIndexes(const std::string &dbName, const std::string &bucket) const
+    {
+        auto const create = [&](const std::string &collection, const mongo::BSONObj &index) {
+            mongo::BSONObj result;
+            mongo::BSONObj const command = BSON("createIndexes" << collection << "indexes" << BSON_ARRAY(index));
+            if (!_dbclient->runCommand(dbName, command, result))
+                throw std::runtime_error("Failed to create index of " + collection + ": " + 
+                                         std::string(result.getStringField("errmsg")));
+        };
+
+        // Names as created by drivers, so that existing indexes are not duplicated
+        create(GridFs::filesCollection(bucket), BSON("key" << BSON("filename" << 1 << "uploadDate" << 1) <<
+                                                     "name" << "filename_1_uploadDate_1"));
+        create(GridFs::chunksCollection(bucket), BSON("key" << BSON("files_id" << 1 << "n" << 1) <<
+                                                      "name" << "files_id_1_n_1" << "unique" << true));
+    }
+
+    int MongoClient::profilingLevel(const std::string &dbName, int &slowMs) const
+    {
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(dbName, BSON("profile" << -1), result))
+            return -1;
+
+        slowMs = result["slowms"].numberInt();
+        return result["was"].numberInt();
+    }
+
+    std::vector<WorkloadReplay::Operation> MongoClient::profileOperations(const std::string &dbName,
+                                                                          long long sinceMs, int limit,
+                                                                          long long &skipped) const
+    {
+        mongo::BSONObjBuilder filter;
+        filter.append("op", BSON("$in" << BSON_ARRAY("query" << "command")));
+        filter.append("command.comment", BSON("$ne" << ProfileSummary::Comment));
+        if (sinceMs > 0)
+            filter.append("ts", BSON("$gte" << mongo::Date_t::fromMillisSinceEpoch(sinceMs)));
+
+        std::unique_ptr<mongo::DBClientCursor> cursor = _dbclient->query(
+            mongo::NamespaceString(dbName, "system.profile"), mongo::Query(filter.obj()).sort("ts"), limit, 0,
+            nullptr, mongo::QueryOption_SlaveOk);
+
+        // DBClientBase::query may return nullptr
+        if (!cursor)
+            throw std::runtime_error("Network error while attempting to read profiler data");
+
+        std::vector<WorkloadReplay::Operation> operations;
+        while (cursor->more()) {
+            WorkloadReplay::Operation operation;
+            if (WorkloadReplay::fromProfileEntry(cursor->next(), operation))
+                operations.push_back(operation);
+            else
+                ++skipped;
+        }
+        return operations;
+    }
+
+    mongo::BSONObj MongoClient::explain(const std::string &dbName, const mongo::BSONObj &command) const
+    {
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(dbName, BSON("explain" << command << "verbosity" << "executionStats"), 
+                                   result, mongo::QueryOption_SlaveOk))
+            throw std::runtime_error("Failed to explain: " + std::string(result.getStringField("errmsg")));
+        return result.getOwned();
     }
 
     std::vector<MongoCollectionInfo> MongoClient::runCollStatsCommand(const std::vector<std::string> &namespaces)
@@ -608,6 +1643,115 @@ namespace Robomongo
         return infos;
     }
 
+    std::pair<int, int> MongoClient::killClientOperations(const std::vector<std::string> &clientAddresses)
+    {
+        mongo::BSONArrayBuilder clients;
+        for (auto const &address : clientAddresses)
+            clients.append(address);
+        mongo::BSONArray const clientsArray = clients.arr();
+
+        // { $or: [ { client: { $in: [...] } }, { client_s: { $in: [...] } } ] }, 
+        // 'client_s' is used for operations reported by mongos
+        mongo::BSONObj const filter = BSON("$or" << BSON_ARRAY(
+            BSON("client" << BSON("$in" << clientsArray)) <<
+            BSON("client_s" << BSON("$in" << clientsArray))));
+
+        std::vector<mongo::BSONObj> const ops = currentOps(filter, true, 0);
+
+        mongo::BSONObj result;
+        int killedOps = 0;
+        int killedCursors = 0;
+        for (mongo::BSONObj const &op : ops) {
+            if (std::string(op.getStringField("type")) == "idleCursor") {
+                mongo::BSONObj const cursor = op.getObjectField("cursor");
+                if (cursor.isEmpty())
+                    continue;
+
+                MongoNamespace const ns(op.getStringField("ns"));
+                mongo::BSONObj const command = BSON("killCursors" << ns.collectionName() << 
+                                                    "cursors" << BSON_ARRAY(cursor["cursorId"]));
+                if (_dbclient->runCommand(ns.databaseName(), command, result))
+                    ++killedCursors;
+                continue;
+            }
+
+            if (!op.hasField("opid"))
+                continue;
+
+            mongo::BSONObjBuilder killOp; // { killOp: 1, op: <opid> }
+            killOp.append("killOp", 1);
+            killOp.appendAs(op["opid"], "op");
+            if (_dbclient->runCommand("admin", killOp.obj(), result))
+                ++killedOps;
+        }
+
+        return { killedOps, killedCursors };
+    }
+
+    std::vector<mongo::BSONObj> MongoClient::currentOps(const mongo::BSONObj &filter, bool idleCursors, 
+                                                        int limit) const
+    {
+        // Aggregation of listing reports itself, it is recognized by comment
+        static const char *const listingComment = "Robo 3T currentOp";
+        mongo::BSONObj const ownFilter = BSON("command.comment" << BSON("$ne" << listingComment));
+
+        std::vector<mongo::BSONObj> ops;
+        mongo::BSONObj result;
+
+        // Users without inprog privilege get only their own operations
+        for (bool const allUsers : { true, false }) {
+            mongo::BSONArrayBuilder pipeline;
+            pipeline.append(BSON("$currentOp" << BSON("allUsers" << allUsers << "idleCursors" << idleCursors)));
+            pipeline.append(BSON("$match" << BSON("$and" << BSON_ARRAY(filter << ownFilter))));
+            if (limit > 0)
+                pipeline.append(BSON("$limit" << limit));
+
+            // Operations fit into the first batch, which server caps at 16MB
+            mongo::BSONObj const command = BSON("aggregate" << 1 << "pipeline" << pipeline.arr() <<
+                                                "cursor" << BSON("batchSize" << (limit > 0 ? limit : 100000)) <<
+                                                "comment" << listingComment);
+            if (!_dbclient->runCommand("admin", command, result))
+                continue;   // no privilege or older server
+
+            mongo::BSONObj const cursor = result.getObjectField("cursor");
+            for (mongo::BSONObjIterator it(cursor.getObjectField("firstBatch")); it.more();)
+                ops.push_back(it.next().Obj().getOwned());
+
+            long long const cursorId = cursor["id"].safeNumberLong();
+            if (cursorId != 0) {
+                mongo::BSONObj ignored;
+                _dbclient->runCommand("admin", BSON("killCursors" << "$cmd.aggregate" << 
+                                                    "cursors" << BSON_ARRAY(cursorId)), ignored);
+            }
+            return ops;
+        }
+
+        mongo::BSONObjBuilder currentOp;
+        currentOp.append("currentOp", 1);
+        currentOp.appendElements(filter);
+        if (!_dbclient->runCommand("admin", currentOp.obj(), result))
+            throw std::runtime_error("Failed to list operations: " + std::string(result.getStringField("errmsg")));
+
+        for (mongo::BSONObjIterator it(result.getObjectField("inprog")); it.more();) {
+            if (limit > 0 && static_cast<int>(ops.size()) >= limit)
+                break;
+            ops.push_back(it.next().Obj().getOwned());
+        }
+        return ops;
+    }
+
+    void MongoClient::killOp(const mongo::BSONElement &opid) const
+    {
+        mongo::BSONObjBuilder killOp; // { killOp: 1, op: <opid> }
+        killOp.append("killOp", 1);
+        killOp.appendAs(opid, "op");
+
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand("admin", killOp.obj(), result))
+            throw std::runtime_error("Failed to kill operation " + opid.toString(false) + ": " + 
+                                     std::string(result.getStringField("errmsg")));
+    }
+
     void MongoClient::done()
     {
         // do nothing here, because we are not using ScopedDbConnection now
@@ -1,22 +1,64 @@
 #pragma once
 
+#include <functional>
+#include <memory>
+
 #include <mongo/client/dbclient_base.h>
 #include <mongo/bson/bsonobj.h>
+#include <mongo/bson/timestamp.h>
 
 #include "robomongo/core/Core.h"
 #include "robomongo/core/domain/MongoQueryInfo.h"
 #include "robomongo/core/domain/MongoUser.h"
 #include "robomongo/core/domain/MongoFunction.h"
+#include "robomongo/core/domain/GridFs.h"
+#include "robomongo/core/domain/ShardDistribution.h"
+#include "robomongo/core/domain/ShardFanout.h"
+#include "robomongo/core/domain/TableChangeset.h"
+#include "robomongo/core/domain/WorkloadReplay.h"
 #include "robomongo/core/events/MongoEventsInfo.h"
+#include "robomongo/core/mongodb/DriverMetrics.h"
 
 namespace Robomongo
 {
+    /**
+     * @brief Server properties that do not change during lifetime of a connection
+     *        (buildInfo version, storage engine). Owned by MongoWorker and filled on
+     *        first use by its MongoClients, so that every helper does not repeat the commands.
+     */
+    struct ServerCapabilities
+    {
+        void clear() { *this = ServerCapabilities(); }
+
+        std::string _version;           // empty if buildInfo was not run yet
+        std::string _storageEngineType;
+        bool _isStorageEngineFetched = false;
+        int _transactions = -1;         // 1 if multi-document transactions are supported, -1 if not checked yet
+    };
+
     class MongoClient
     {
     public:
-        MongoClient(mongo::DBClientBase *const scopedConnection);
+        /**
+         * @param metricsRecord If set, wall time of this client (until destruction) is counted
+         *        in DriverMetrics of this connection record
+         */
+        MongoClient(mongo::DBClientBase *const scopedConnection, ServerCapabilities *capabilities = nullptr,
+                    const ConnectionSettings *metricsRecord = nullptr);
 
         std::vector<std::string> getCollectionNamesWithDbname(const std::string &dbname) const;
+
+        /**
+         * @brief Lists collection namespaces with { listCollections: 1, nameOnly: true, 
+         *        authorizedCollections: true } and calls 'onBatch' once for every cursor batch
+         *        of at most 'batchSize' names. Every batch is sorted, batches are not sorted
+         *        between each other. The last call has 'lastBatch' set to true (its batch may be empty).
+         * @param nameFilter If not empty, only names containing it (case insensitive) are listed
+         */
+        typedef std::function<void(const std::vector<std::string> &namespaces, bool lastBatch)>
+            CollectionNamesBatchHandler;
+        void getCollectionNamesWithDbname(const std::string &dbname, const std::string &nameFilter,
+                                          int batchSize, const CollectionNamesBatchHandler &onBatch) const;
         std::vector<std::string> getDatabaseNames() const;
         float getVersion() const;
         std::string dbVersionStr() const;
@@ -31,6 +73,20 @@ namespace Robomongo
         void dropIndexFromCollection(const MongoCollectionInfo &collection, const std::string &indexName) const;
         void addEditIndex(const IndexInfo &oldInfo, const IndexInfo &newInfo) const;
 
+        /**
+         * @brief Creates index, waits until it is built (see RollingIndexBuild)
+         * @throws std::exception, if build failed
+         */
+        void createIndex(const IndexInfo &info) const;
+
+        /**
+         * @brief Progress of build of index by $currentOp (keys inserted or documents scanned
+         *        by its current phase), read from another connection than the one of build
+         * @return false, if build is not in progress (yet or anymore)
+         */
+        bool indexBuildProgress(const MongoNamespace &ns, const std::string &indexName,
+                                long long &done, long long &total) const;
+
         void renameIndexFromCollection(const MongoCollectionInfo &collection, const std::string &oldIndexName,
                                        const std::string &newIndexName) const;
 
@@ -45,20 +101,306 @@ namespace Robomongo
         void renameCollection(const MongoNamespace &ns, const std::string &newCollectionName);
         void duplicateCollection(const MongoNamespace &ns, const std::string &newCollectionName);
         void dropCollection(const MongoNamespace &ns);
-        void copyCollectionToDiffServer(mongo::DBClientBase *const, const MongoNamespace &from, const MongoNamespace &to);
+
+        /**
+         * @brief Creates collection 'to' with options of collection 'from' read with 'fromServ'
+         *        (which may be connection of other server)
+         * @return false, if 'from' is view, so 'to' is view too and has no documents and indexes
+         */
+        bool createCollectionLike(mongo::DBClientBase *const fromServ, const MongoNamespace &from,
+                                  const MongoNamespace &to);
+
+        /**
+         * @brief Creates indexes of collection 'from' (read with 'fromServ') except _id on collection 'to'
+         */
+        void copyIndexes(mongo::DBClientBase *const fromServ, const MongoNamespace &from, const MongoNamespace &to);
 
         void insertDocument(const mongo::BSONObj &obj, const MongoNamespace &ns);
         void saveDocument(const mongo::BSONObj &obj, const MongoNamespace &ns);
+
+        /**
+         * @brief Saves edited document with $set/$unset of changed fields (see DocumentUpdate),
+         *        or as a whole, if changes cannot be expressed so
+         * @throws std::runtime_error, if changed fields were modified (or document removed)
+         *         since 'original' was loaded
+         */
+        void updateDocument(const mongo::BSONObj &original, const mongo::BSONObj &edited,
+                            const MongoNamespace &ns);
+
+        /**
+         * @brief True for members of replica sets (MongoDB 4.0+) and mongos (4.2+) with sessions
+         */
+        bool supportsTransactions() const;
+
+        /**
+         * @brief Runs all statements in one update command. On servers with transactions it is
+         *        a transaction, which is committed only if every statement matched its document,
+         *        otherwise statements are applied independently. Rows of statements that did
+         *        not match (or failed) are reported as conflicts in both cases.
+         */
+        TableChangeset::CommitResult commitChangeset(const std::vector<TableChangeset::Statement> &statements,
+                                                     const MongoNamespace &ns);
+
+        /**
+         * @brief Inserts (or upserts by _id, if 'overwrite' is true) documents in batches of at
+         *        most 'batchBytesLimit' bytes and 1000 documents. Failed batch does not stop
+         *        the next ones, it is reported in result.
+         */
+        std::vector<BulkChunkResult> insertDocuments(const std::vector<mongo::BSONObj> &objs, 
+                                                     const MongoNamespace &ns, bool overwrite,
+                                                     int batchBytesLimit);
         void removeDocuments(const MongoNamespace &ns, mongo::Query query, bool justOne = true);
+
+        /**
+         * @brief Removes documents with one { _id : { $in : [...] } } query per 'chunkSize' ids.
+         *        Failed chunk does not stop removal of the next ones, it is reported in result.
+         * @param ids Objects of form { _id : <value> }
+         */
+        std::vector<BulkChunkResult> removeDocumentsById(const MongoNamespace &ns, 
+                                                         const std::vector<mongo::BSONObj> &ids,
+                                                         int chunkSize = 1000);
         std::vector<MongoDocumentPtr> query(const MongoQueryInfo &info);
 
+        /**
+         * @brief Runs aggregation and returns its first 'batchSize' documents, the
+         *        rest of cursor is killed (as shell shows only the first batch too)
+         */
+        std::vector<MongoDocumentPtr> aggregate(const MongoNamespace &ns, const mongo::BSONObj &pipeline,
+                                                const mongo::BSONObj &options, int batchSize);
+
+        /**
+         * @brief Runs aggregation and returns its first 'batchSize' documents, cursor with the
+         *        rest stays open on server, it is read with getMore() and closed with killCursor()
+         * @param cursorId Set to id of cursor, 0 if all documents were returned
+         */
+        std::vector<MongoDocumentPtr> openAggregation(const MongoNamespace &ns, const mongo::BSONObj &pipeline,
+                                                      const mongo::BSONObj &options, int batchSize, 
+                                                      long long &cursorId);
+
+        /**
+         * @brief Reads at most 'batchSize' next documents of command cursor (i.e. of aggregation)
+         * @param cursorId Set to 0, if cursor is exhausted
+         * @throws std::runtime_error, if cursor is not found (i.e. timed out on server)
+         */
+        std::vector<MongoDocumentPtr> getMore(const MongoNamespace &ns, long long &cursorId, int batchSize);
+        void killCursor(const MongoNamespace &ns, long long cursorId);
+
+        /**
+         * @brief Opens cluster wide change stream ({ aggregate: 1 } on admin), its events are
+         *        read with awaitMore() and cursor is closed with killCursor()
+         * @param ns, cursorId Set to namespace and id of cursor
+         * @return First batch of events
+         * @throws std::runtime_error, i.e. if server is standalone
+         */
+        std::vector<mongo::BSONObj> openChangeStream(const mongo::BSONArray &pipeline, MongoNamespace &ns,
+                                                     long long &cursorId);
+
+        /**
+         * @brief Opens change stream of one collection ({ aggregate: <collection> }), read and
+         *        closed like the cluster wide one
+         * @param batchSize 0 for default of server
+         */
+        std::vector<mongo::BSONObj> openChangeStream(const MongoNamespace &collection, const mongo::BSONArray &pipeline,
+                                                     int batchSize, MongoNamespace &ns, long long &cursorId);
+
+        /**
+         * @brief Opens tailable awaitData cursor on local.oplog.rs from the newest entry matching
+         *        'query', entries are read with awaitMore() and cursor closed with killCursor()
+         * @return First batch of entries
+         * @throws std::runtime_error, i.e. if server is not member of replica set
+         */
+        std::vector<mongo::BSONObj> openOplogTail(const mongo::BSONObj &query, int batchSize, MongoNamespace &ns,
+                                                  long long &cursorId);
+
+        /**
+         * @brief getMore of tailable or change stream cursor, which waits at most 'awaitMs' for
+         *        new documents, so batch may be empty
+         * @param cursorId Set to 0, if cursor is dead (i.e. its position in capped collection was
+         *        overwritten), caller may open it again after the last seen document
+         * @param batchSize 0 for default of server
+         */
+        std::vector<mongo::BSONObj> awaitMore(const MongoNamespace &ns, long long &cursorId, int awaitMs,
+                                              int batchSize = 0);
+
+        /**
+         * @brief 'ts' of the newest oplog entry, null if oplog is empty
+         */
+        mongo::Timestamp lastOplogTimestamp() const;
+
+        /**
+         * @brief Counts documents matching filter of query, its skip and limit are ignored.
+         *        Without filter, count is taken from collection metadata (estimatedDocumentCount),
+         *        otherwise matching documents are counted by server within 'maxTimeMs'.
+         * @param estimated Set to true, if count was taken from metadata
+         */
+        long long countDocuments(const MongoQueryInfo &info, int maxTimeMs, bool &estimated);
+
+        /**
+         * @brief Runs query and calls 'onBatch' once for every batch received from server,
+         *        instead of materializing the whole result. The last call has 'lastBatch' set
+         *        to true (its batch may be empty).
+         */
+        typedef std::function<void(const std::vector<MongoDocumentPtr> &batch, bool lastBatch)> 
+            QueryBatchHandler;
+        void query(const MongoQueryInfo &info, const QueryBatchHandler &onBatch);
+
+        /**
+         * @brief Splits _id keyspace of collection into at most 'parts' ranges of similar size.
+         *        splitVector reads only the _id index, but needs clusterManager role and does not
+         *        run on mongos, sampled $bucketAuto is used then.
+         * @return Ascending boundaries between ranges, of form { _id : <value> }. Empty, if
+         *         collection cannot be split.
+         */
+        std::vector<mongo::BSONObj> splitIdRanges(const MongoNamespace &ns, int parts);
+
+        /**
+         * @brief Opens cursor of query (with its skip, limit and batch size), that caller may keep
+         *        between requests to read next pages with getMore. Cursor must be destroyed
+         *        before connection.
+         */
+        std::unique_ptr<mongo::DBClientCursor> openCursor(const MongoQueryInfo &info);
+
+        /**
+         * @brief DBClientCursor::more(), that times batch it receives from server and adds it
+         *        to observations of AdaptiveBatchSize under 'batchKey' (see batchSizeKey())
+         */
+        static bool more(mongo::DBClientCursor &cursor, const std::string &batchKey);
+        static std::string batchSizeKey(const MongoQueryInfo &info);
+
+        /**
+         * @brief Shards owning chunks of sharded collection and ranges of their chunks, read
+         *        from config database through mongos (see ShardFanout)
+         * @param shardKey Set to key pattern of collection
+         * @throws std::runtime_error, if collection is not sharded or config cannot be read
+         */
+        std::vector<ShardFanout::Target> shardTargets(const MongoNamespace &ns, mongo::BSONObj &shardKey) const;
+
+        /**
+         * @brief Runs { collStats: ... } command. Returned info has no stats (see 
+         *        MongoCollectionInfo::hasStats()), if command failed for this collection.
+         */
         MongoCollectionInfo runCollStatsCommand(const std::string &ns);
         std::vector<MongoCollectionInfo> runCollStatsCommand(const std::vector<std::string> &namespaces);
 
+        /**
+         * @brief Result of { collStats: ... } command, empty if command failed for this
+         *        collection (i.e. view or collection without access rights)
+         * @param indexDetails Adds storage engine statistics of every index (i.e. its cache usage)
+         */
+        mongo::BSONObj collStats(const MongoNamespace &ns, bool indexDetails = false) const;
+
+        /**
+         * @brief Usage of every index of collection with $indexStats (3.2+) and its size with
+         *        collStats. Either of them may be missing (see IndexUsageInfo), so that the
+         *        other one is shown anyway.
+         */
+        std::vector<IndexUsageInfo> indexUsage(const MongoNamespace &ns) const;
+
+        /**
+         * @brief Result of { dbStats: 1 } command, empty if command failed
+         */
+        mongo::BSONObj dbStats(const std::string &dbName) const;
+
+        /**
+         * @brief Result of { serverStatus: 1 } without its largest sections (metrics, locks),
+         *        cheap enough to be sampled every second
+         * @throws std::runtime_error, if command failed
+         */
+        mongo::BSONObj serverStatusSample() const;
+
+        /**
+         * @brief Groups system.profile of database by query shape on server (see ProfileSummary)
+         * @return At most 'limit' shapes with the largest total time
+         */
+        std::vector<ProfileShapeInfo> profileSummary(const std::string &dbName, long long sinceMs, 
+                                                     int minMillis, int limit) const;
+
+        /**
+         * @brief Entries of plan cache of collection (see PlanCache), of every shard on mongos
+         * @return At most 'limit' entries
+         * @throws std::runtime_error, if $planCacheStats failed (i.e. server older than 4.2)
+         */
+        std::vector<PlanCacheEntryInfo> planCacheStats(const MongoNamespace &ns, int limit) const;
+
+        /**
+         * @brief Chunks of sharded collection counted per shard on server, data size per
+         *        shard and balancer activity since 'sinceMs' (see ShardDistribution)
+         * @throws std::runtime_error, if collection is not sharded or config database cannot be read
+         */
+        ShardDistribution::Snapshot shardDistribution(const MongoNamespace &ns, long long sinceMs) const;
+
+        /**
+         * @brief Files of GridFS bucket, the most recently uploaded first
+         * @param filename Part of filename, empty for all files
+         */
+        std::vector<GridFs::FileInfo> gridFsFiles(const std::string &dbName, const std::string &bucket,
+                                                  const std::string &filename, int limit) const;
+
+        /**
+         * @brief Creates indexes of GridFS bucket required by the spec before the first upload:
+         *        { filename: 1, uploadDate: 1 } on files and unique { files_id: 1, n: 1 } on chunks
+         * @throws std::runtime_error, if index could not be created
+         */
+        void ensureGridFsIndexes(const std::string &dbName, const std::string &bucket) const;
+
+        /**
+         * @brief Profiling level of database ({ profile: -1 }), -1 if it cannot be read
+         */
+        int profilingLevel(const std::string &dbName, int &slowMs) const;
+
+        /**
+         * @brief Replayable operations of system.profile of database, oldest first
+         * @param limit Profile entries read, also the ones that are not replayable
+         * @param skipped Incremented for every entry that is not replayable
+         */
+        std::vector<WorkloadReplay::Operation> profileOperations(const std::string &dbName, long long sinceMs,
+                                                                 int limit, long long &skipped) const;
+
+        /**
+         * @brief Runs { explain: <command>, verbosity: "executionStats" }, so that the winning
+         *        plan is executed and its statistics returned (see ExplainPlan)
+         * @throws std::runtime_error, if command failed
+         */
+        mongo::BSONObj explain(const std::string &dbName, const mongo::BSONObj &command) const;
+
+        /**
+         * @brief Kills in-progress operations (killOp) and idle cursors (killCursors) of 
+         *        connections with these client addresses ("host:port", as 'whatsmyuri' returns).
+         * @return Pair of { killed ops, killed cursors }
+         */
+        std::pair<int, int> killClientOperations(const std::vector<std::string> &clientAddresses);
+
+        /**
+         * @brief Lists in-progress operations matching 'filter' with $currentOp aggregation stage
+         *        (3.6+), so that they are filtered by server, or with currentOp command on older
+         *        servers. Operations of all users are listed, if user has inprog privilege.
+         * @param limit Maximum number of operations, 0 for no limit
+         */
+        std::vector<mongo::BSONObj> currentOps(const mongo::BSONObj &filter, bool idleCursors, int limit) const;
+
+        /**
+         * @brief Runs { killOp: 1, op: <opid> }, opid is number or "shard:number" on mongos
+         */
+        void killOp(const mongo::BSONElement &opid) const;
+
         void done();
 
     private:
         mongo::DBClientBase *const _dbclient;
+        ServerCapabilities *const _capabilities;    // may be null, then nothing is cached
+        std::unique_ptr<DriverMetrics::Scope> const _metrics;
         void checkLastErrorAndThrow(const std::string &db);
+
+        // Upserts documents [first, last) of 'objs' with one 'update' command
+        void saveDocuments(const std::vector<mongo::BSONObj> &objs, size_t first, size_t last,
+                           const MongoNamespace &ns);
+
+        // Copies documents of existing collection 'from' into existing collection 'to' of the
+        // same server with aggregation $merge (or $out before 4.2), client side if it fails
+        void copyDocumentsOnServer(const MongoNamespace &from, const MongoNamespace &to);
+
+        // Reads documents of 'from' with 'fromServ' and inserts them in batches
+        void copyDocuments(mongo::DBClientBase *const fromServ, const MongoNamespace &from,
+                           const MongoNamespace &to);
     };
 }
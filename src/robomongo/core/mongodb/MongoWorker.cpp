@@ -1,56 +1,345 @@
 #include "robomongo/core/mongodb/MongoWorker.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
 #include <exception>
-
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QPointer>
 #include <QThread>
+#include <QTimer>
 
+#include <mongo/base/error_codes.h>
 #include <mongo/client/global_conn_pool.h>
 #include <mongo/client/replica_set_monitor.h>
-#include <mongo/util/net/ssl_manager.h>
-#include <mongo/util/net/ssl_options.h>
 
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/domain/App.h"
+#include "robomongo/core/domain/CollectionNamesVersion.h"
+#include "robomongo/core/domain/CreatedDatabases.h"
+#include "robomongo/core/domain/DataGenerator.h"
+#include "robomongo/core/domain/FirstPageCache.h"
 #include "robomongo/core/domain/MongoShellResult.h"
 #include "robomongo/core/domain/MongoCollectionInfo.h"
+#include "robomongo/core/domain/ExplainPlan.h"
+#include "robomongo/core/domain/PipelinePreview.h"
+#include "robomongo/core/domain/QueryBenchmark.h"
+#include "robomongo/core/domain/FieldBuckets.h"
+#include "robomongo/core/domain/FieldDistribution.h"
+#include "robomongo/core/domain/RollingIndexBuild.h"
+#include "robomongo/core/domain/SchemaAnalyzer.h"
+#include "robomongo/core/domain/ThrottledWrite.h"
 #include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/engine/NativeQuery.h"
+#include "robomongo/core/engine/ScopePool.h"
 #include "robomongo/core/engine/ScriptEngine.h"
 #include "robomongo/core/EventBus.h"
+#include "robomongo/core/EventTrace.h"
+#include "robomongo/core/mongodb/BulkInserter.h"
+#include "robomongo/core/mongodb/DriverMetrics.h"
 #include "robomongo/core/mongodb/MongoClient.h"
+#include "robomongo/core/mongodb/ScramAuth.h"
+#include "robomongo/core/mongodb/WarmConnections.h"
+#include "robomongo/core/mongodb/WireCompression.h"
 #include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/settings/ReplicaSetSettings.h"
 #include "robomongo/core/settings/CredentialSettings.h"
 #include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/settings/SshSettings.h"
+#include "robomongo/core/utils/MemberLatency.h"
 #include "robomongo/core/settings/SslSettings.h"
 #include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/HostResolver.h"
 #include "robomongo/core/utils/Logger.h"
 #include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/core/utils/ScratchArena.h"
+#include "robomongo/core/utils/ThreadPriority.h"
 #include "robomongo/utils/StringOperations.h"
 
+namespace
+{
+    bool isSameAggregation(const Robomongo::AggrInfo &left, const Robomongo::AggrInfo &right)
+    {
+        return left.dbName == right.dbName && left.collectionName == right.collectionName &&
+               left.pipeline.binaryEqual(right.pipeline) && left.options.binaryEqual(right.options) &&
+               left.maxTimeMs == right.maxTimeMs;
+    }
+
+    // Aggregation options with time limit of tab, unless it is 0 or pipeline has its own
+    mongo::BSONObj withMaxTime(const mongo::BSONObj &options, int maxTimeMs)
+    {
+        if (maxTimeMs <= 0 || options.hasField("maxTimeMS"))
+            return options;
+
+        mongo::BSONObjBuilder builder;
+        builder.appendElements(options);
+        builder.append("maxTimeMS", maxTimeMs);
+        return builder.obj();
+    }
+
+    long long elapsedMsSince(std::chrono::steady_clock::time_point since)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - since).count();
+    }
+
+    bool isSameQuery(const Robomongo::MongoQueryInfo &left, const Robomongo::MongoQueryInfo &right)
+    {
+        return left._info._ns.toString() == right._info._ns.toString() &&
+               left._query.binaryEqual(right._query) &&
+               left._fields.binaryEqual(right._fields) &&
+               left._options == right._options &&
+               left._readPreference == right._readPreference &&
+               left._maxTimeMs == right._maxTimeMs;
+    }
+
+    // 1 or -1, if query is sorted by _id only, otherwise 0
+    int idSortDirection(const mongo::BSONObj &query)
+    {
+        mongo::BSONObj const orderBy = query.hasField("orderby") ? query.getObjectField("orderby") : 
+                                                                   query.getObjectField("$orderby");
+        if (orderBy.nFields() != 1 || std::string(orderBy.firstElement().fieldName()) != "_id")
+            return 0;
+
+        return orderBy.firstElement().number() < 0 ? -1 : 1;
+    }
+
+    /**
+     * @brief Sorted query starting at _id 'id' by index bound: $min (inclusive) for ascending
+     *        order, $max (exclusive, 'id' itself is not read) for descending one. Bounds
+     *        instead of $gte/$lte, which would skip _id values of other types than 'id'.
+     * @return Empty, if query has hint or bounds of its own
+     */
+    mongo::BSONObj withIdBound(const mongo::BSONObj &query, const mongo::BSONObj &id, int direction)
+    {
+        for (const char *const field : { "$hint", "hint", "$min", "min", "$max", "max" }) {
+            if (query.hasField(field))
+                return mongo::BSONObj();
+        }
+
+        mongo::BSONObjBuilder builder;
+        builder.appendElements(query);
+        builder.append("$hint", BSON("_id" << 1));
+        builder.append(direction > 0 ? "$min" : "$max", id);
+        return builder.obj();
+    }
+
+    // Next step of MongoWorker::continueLater()
+    class ContinuationEvent : public QEvent
+    {
+    public:
+        explicit ContinuationEvent(const std::function<int()> &step) :
+            QEvent(type()),
+            step(step) {}
+
+        static QEvent::Type type()
+        {
+            static int const registered = QEvent::registerEventType();
+            return static_cast<QEvent::Type>(registered);
+        }
+
+        std::function<int()> const step;
+    };
+
+    enum class WriteFailure { Network, Authorization, Other };
+
+    // Driver reports network errors with codes, write errors of server come as text
+    WriteFailure writeFailure(const std::exception &ex)
+    {
+        if (auto const dbException = dynamic_cast<const mongo::DBException *>(&ex)) {
+            mongo::ErrorCodes::Error const code = dbException->code();
+            if (mongo::ErrorCodes::isNetworkError(code))
+                return WriteFailure::Network;
+            if (code == mongo::ErrorCodes::Unauthorized || code == mongo::ErrorCodes::AuthenticationFailed)
+                return WriteFailure::Authorization;
+        }
+
+        std::string const what = ex.what();
+        if (what.find("not authorized") != std::string::npos ||
+            what.find("requires authentication") != std::string::npos)
+            return WriteFailure::Authorization;
+        return WriteFailure::Other;
+    }
+
+    // Document with _id of 'obj' is stored exactly as 'obj'
+    bool isStored(mongo::DBClientBase *conn, const mongo::BSONObj &obj, const Robomongo::MongoNamespace &ns)
+    {
+        mongo::BSONElement const id = obj.getField("_id");
+        if (id.eoo())
+            return false;
+
+        mongo::BSONObjBuilder query;
+        query.append(id);
+        return conn->findOne(ns.toString(), mongo::Query(query.obj())).binaryEqual(obj);
+    }
+}
+
 namespace Robomongo
 {
     std::string const APP_VERSION = PROJECT_VERSION;
     std::string const APP_NAME_VERSION { "robo3t-" + APP_VERSION };
 
+    namespace
+    {
+        constexpr int KeepAliveIntervalMs { 60 * 1000 };  // 60 seconds
+
+        // Connections running collStats of one database at once, see DatabaseStatsRequest
+        constexpr size_t MaxStatsConcurrency { 8 };
+
+        // Connections searching collections of one database at once, see DatabaseSearchRequest
+        constexpr size_t MaxSearchConcurrency { 4 };
+
+        // Connections running one DDL action on collections at once, see CollectionMaintenanceRequest
+        constexpr size_t MaxMaintenanceConcurrency { 4 };
+
+        // Ranges of chunks of one GridFS file in flight at once, see GridFsTransferRequest
+        constexpr size_t MaxGridFsConcurrency { 4 };
+
+        // Connections running prefixes of one pipeline at once, see PipelinePreviewRequest
+        constexpr size_t MaxPreviewConcurrency { 4 };
+
+        // Batches of sample read, but not analyzed yet, see AnalyzeSchemaRequest
+        constexpr size_t MaxQueuedBatches { 2 };
+
+        // Documents measured by worker on servers without $bsonSize, see DocumentSizesRequest
+        constexpr int DocumentSizeBatchSize { 1000 };
+
+        // Pairs of source and target connections hashing ranges of _id at once, see CompareCollectionsRequest
+        constexpr size_t MaxCompareConcurrency { 4 };
+
+        // Connections inserting generated documents at once, see GenerateDataRequest
+        constexpr int MaxGenerateConcurrency { 16 };
+
+        // Connections replaying captured operations at once, see ReplayWorkloadRequest
+        constexpr int MaxReplayConcurrency { 32 };
+
+        /**
+         * @brief md5 of collection by dbHash, computed by server from documents in _id order
+         * @return Empty string, if not available (mongos, missing privilege)
+         */
+        std::string collectionDbHash(mongo::DBClientBase *connection, const MongoNamespace &ns)
+        {
+            mongo::BSONObj result;
+            if (!connection->runCommand(ns.databaseName(),
+                                        BSON("dbHash" << 1 << "collections" << BSON_ARRAY(ns.collectionName())),
+                                        result))
+                return std::string();
+
+            mongo::BSONElement const hash = result["collections"][ns.collectionName()];
+            return hash.type() == mongo::String ? hash.String() : std::string();
+        }
+
+        long long collectionCount(mongo::DBClientBase *connection, const MongoNamespace &ns)
+        {
+            mongo::BSONObj result;
+            connection->runCommand(ns.databaseName(), BSON("count" << ns.collectionName()), result);
+            return result["n"].safeNumberLong();
+        }
+
+        // Socket timeout of keep-alive and health check pings. Much shorter than timeout of
+        // user operations, so a dying server does not hold the worker thread for long.
+        constexpr double PingTimeoutSec { 3 };
+
+        // Sets short socket timeout on connection for the lifetime of this object
+        class PingTimeoutGuard
+        {
+        public:
+            PingTimeoutGuard(mongo::DBClientConnection *conn, double restoreTimeoutSec) :
+                _conn(conn), _restoreTimeoutSec(restoreTimeoutSec)
+            {
+                if (_conn)
+                    _conn->setSoTimeout(PingTimeoutSec);
+            }
+
+            ~PingTimeoutGuard()
+            {
+                if (_conn)
+                    _conn->setSoTimeout(_restoreTimeoutSec);
+            }
+
+        private:
+            mongo::DBClientConnection *const _conn;
+            double const _restoreTimeoutSec;
+        };
+
+        // State shared by probing threads, outlives connectAndGetReplicaSetName() if some
+        // members are still not answering when set name is found
+        struct ReplicaSetProbe
+        {
+            std::mutex mutex;
+            std::condition_variable finished;
+            std::string setName;
+            size_t pending = 0;
+        };
+
+        // Interactive requests wait at most this long for reconnect, see parkWhileDown()
+        constexpr int MaxParkedMs { 30 * 1000 };
+
+        // Result of background reachability probe is checked this often, see scheduleReconnect()
+        constexpr int ReconnectPollMs { 100 };
+
+        // Outcome of reachability probe, written by probing thread once
+        struct ReachabilityProbe
+        {
+            std::atomic<bool> done { false };
+            bool reachable = false;
+            std::string error;
+        };
+
+        std::string isMasterSetName(mongo::HostAndPort const& member, double timeoutSec)
+        {
+            try {
+                mongo::DBClientConnection conn { true, timeoutSec };
+                if (!conn.connect(member, APP_NAME_VERSION).isOK())
+                    return "";
+
+                mongo::BSONObj info;
+                if (!conn.runCommand("admin", mongo::BSONObjBuilder().append("isMaster", 1).obj(), info))
+                    return "";
+
+                return info.getStringField("setName");
+            }
+            catch (const std::exception&) {
+                return "";
+            }
+        }
+    }
+
     MongoWorker::MongoWorker(ConnectionSettings *connection, bool isLoadMongoRcJs, int batchSize,
-                             double mongoTimeoutSec, int shellTimeoutSec, QObject *parent) 
+                             double mongoTimeoutSec, int shellTimeoutSec, int shellResultBudgetMb,
+                             int jsHeapLimitMb, int scopePoolSize, bool hasScriptEngine, 
+                             QObject *parent) 
         : QObject(parent),
         _scriptEngine(nullptr),
         _isLoadMongoRcJs(isLoadMongoRcJs),
+        _hasScriptEngine(hasScriptEngine),
         _batchSize(batchSize),
         _timerId(-1),
-        _dbAutocompleteCacheTimerId(-1),
         _mongoTimeoutSec(mongoTimeoutSec),
         _shellTimeoutSec(shellTimeoutSec),
+        _shellResultBudgetMb(shellResultBudgetMb),
+        _jsHeapLimitMb(jsHeapLimitMb),
+        _scopePoolSize(scopePoolSize),
         _isQuiting(0),
         _dbclient(nullptr),
         _dbclientRepSet(nullptr),
-        _connSettings(connection)
+        _connSettings(connection),
+        _tlsContext(TlsContext::of(connection->sslSettings()))
     {
         // Whitespace removed from the start and the end of host string
         _connSettings->setServerHost(QString::fromStdString(_connSettings->serverHost()).trimmed().toStdString());
         _thread = new QThread();
+        _thread->setObjectName(hasScriptEngine ? "MongoWorker" : "MongoWorker (metadata)");  // see EventTrace
         moveToThread(_thread);
         VERIFY(connect( _thread, SIGNAL(finished()), _thread, SLOT(deleteLater()) ));
         VERIFY(connect( _thread, SIGNAL(finished()), this, SLOT(deleteLater()) ));
@@ -63,41 +352,225 @@ namespace Robomongo
             keepAlive();
             return;
         }
+    }
+
+    void MongoWorker::customEvent(QEvent *event)
+    {
+        if (event->type() != ContinuationEvent::type() || _isQuiting)
+            return;
+
+        // Continuations are posted below background requests, see continueLater()
+        ThreadPriority::Scope priorityScope(ThreadPriority::Background);
+        Continuation const step = static_cast<ContinuationEvent *>(event)->step;
+        int const delayMs = step();
+        if (delayMs != Done)
+            continueLater(step, delayMs);
+    }
+
+    void MongoWorker::continueLater(const Continuation &step, int delayMs)
+    {
+        if (_isQuiting)
+            return;
 
-        if (_dbAutocompleteCacheTimerId == event->timerId() && !_scriptEngine) {
-            _scriptEngine->invalidateDbCollectionsCache();
+        if (delayMs > 0) {
+            QTimer::singleShot(delayMs, this, [this, step]() { continueLater(step); });
             return;
         }
+
+        // Below requests of EventBus, even background ones, which are posted with low priority too
+        QCoreApplication::postEvent(this, new ContinuationEvent(step), Qt::LowEventPriority - 1);
+    }
+
+    bool MongoWorker::checkConnectionHealth()
+    {
+        mongo::DBClientBase *const conn = _connSettings->isReplicaSet() ? 
+            static_cast<mongo::DBClientBase *>(_dbclientRepSet.get()) : _dbclient.get();
+        if (!conn || (!conn->isFailed() && conn->isStillConnected()))
+            return false;
+
+        // Cursors of closed connection are gone
+        _pagedCursors.clear();
+        _pagedAggregations.clear();
+        if (_connSettings->isReplicaSet())
+            _dbclientRepSet.reset();
+        else
+            _dbclient.reset();
+
+        auto const connAndError = getConnection(true);
+        if (!connAndError.first)
+            throw std::runtime_error("Cannot reconnect: " + connAndError.second);
+
+        if (_connSettings->hasEnabledPrimaryCredential())
+            connAndError.first->auth(authParams());
+        return true;
     }
 
-    void MongoWorker::restartReplicaSetConnection()
+    void MongoWorker::markServerDown(const std::string &reason)
     {
-        if (!_connSettings->hasEnabledPrimaryCredential())
+        bool const wasUp = !_health.isDown();
+        _health.recordFailure(reason);
+        if (!wasUp)
             return;
 
-        CredentialSettings *credentials = _connSettings->primaryCredential();
-        mongo::BSONObj authParams {
-            mongo::BSONObjBuilder()
-            .append("user", credentials->userName())
-            .append("db", credentials->databaseName())
-            .append("pwd", credentials->userPassword())
-            .append("mechanism", credentials->mechanism())
-            .obj()
-        };
+        // Connection is replaced once server is back; cursors die with it
+        _pagedCursors.clear();
+        _pagedAggregations.clear();
+        sendLog(this, LogEvent::RBM_WARN, _health.describe());
+        scheduleReconnect();
+    }
+
+    void MongoWorker::scheduleReconnect()
+    {
+        int const delayMs = static_cast<int>(_health.untilNextProbe().count());
+        continueLater([this]() {
+            if (!_health.startProbe())
+                return Done;
+
+            // Probe does not touch connections of worker: isMaster on a throwaway connection
+            // with short timeout, to any member of replica set
+            std::vector<mongo::HostAndPort> const hosts = _connSettings->isReplicaSet() ?
+                _connSettings->replicaSetSettings()->membersToHostAndPort() :
+                std::vector<mongo::HostAndPort> { _connSettings->hostAndPort() };
+            auto const probe = std::make_shared<ReachabilityProbe>();
+            std::shared_ptr<const TlsContext> const tlsContext = _tlsContext;
+
+            std::thread([probe, hosts, tlsContext]() {
+                TlsContext::Guard tls(*tlsContext);
+                for (auto const& host : hosts) {
+                    try {
+                        mongo::DBClientConnection conn { false, PingTimeoutSec };
+                        mongo::Status const status = conn.connect(host, APP_NAME_VERSION);
+                        mongo::BSONObj info;
+                        if (status.isOK() && conn.runCommand("admin", BSON("isMaster" << 1), info)) {
+                            probe->reachable = true;
+                            break;
+                        }
+                        probe->error = status.isOK() ? info.toString() : status.reason();
+                    }
+                    catch (const std::exception &ex) {
+                        probe->error = ex.what();
+                    }
+                }
+                probe->done = true;
+            }).detach();
+
+            continueLater([this, probe]() {
+                return probe->done ? finishReconnect(probe->reachable, probe->error) : ReconnectPollMs;
+            }, ReconnectPollMs);
+            return Done;
+        }, delayMs);
+    }
+
+    int MongoWorker::finishReconnect(bool reachable, const std::string &error)
+    {
+        if (!reachable) {
+            _health.recordFailure(error);
+            sendLog(this, LogEvent::RBM_DEBUG, _health.describe());
+            scheduleReconnect();
+            return Done;
+        }
+
+        // Stale connections are dropped, the next getConnection() opens new ones
+        _health.recordSuccess();
+        _dbclient.reset();
+        _dbclientRepSet.reset();
+        _memberConnections.clear();
+        sendLog(this, LogEvent::RBM_INFO, "Server is reachable again, reconnecting");
+        replayParkedRequests();
+        return Done;
+    }
+
+    template <typename Request>
+    bool MongoWorker::parkWhileDown(Request *event)
+    {
+        if (!_health.isDown() || _isReplayingParked || event->priority() != EventPriority::Interactive ||
+            _parkedRequests.size() >= MaxParkedRequests)
+            return false;
+
+        if (_parkedRequests.empty()) {
+            _parkedSince = std::chrono::steady_clock::now();
+            continueLater([this]() {
+                if (!_parkedRequests.empty() &&
+                    std::chrono::steady_clock::now() - _parkedSince >= std::chrono::milliseconds(MaxParkedMs))
+                    replayParkedRequests();
+                return Done;
+            }, MaxParkedMs);
+        }
+
+        // Request is deleted once handled, so a copy waits; its sender may be gone by then
+        auto const copy = std::make_shared<Request>(*event);
+        QPointer<QObject> const sender = event->sender();
+        _parkedRequests.push_back([this, copy, sender]() {
+            if (sender)
+                handle(copy.get());
+        });
+        sendLog(this, LogEvent::RBM_DEBUG, std::string(event->typeString()) + " waits for reconnect");
+        return true;
+    }
+
+    void MongoWorker::replayParkedRequests()
+    {
+        // Handled in order of arrival. If server is still down, they fail at once now.
+        std::vector<std::function<void()>> parked;
+        parked.swap(_parkedRequests);
+
+        _isReplayingParked = true;
+        for (auto const& request : parked)
+            request();
+        _isReplayingParked = false;
+    }
+
+    void MongoWorker::runWrite(const std::string &operation, bool idempotent,
+                               const std::function<void(MongoClient &client, bool retry)> &write)
+    {
+        WriteFailure failure = WriteFailure::Other;
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            write(*client, false);
+            client->done();
+            return;
+        }
+        catch (const std::exception &ex) {
+            failure = writeFailure(ex);
+            bool const retry = (failure == WriteFailure::Authorization && _connSettings->hasEnabledPrimaryCredential()) ||
+                               (failure == WriteFailure::Network && idempotent);
+            if (!retry)
+                throw;
+
+            sendLog(this, LogEvent::RBM_DEBUG, operation + " is repeated after error: " + ex.what());
+        }
+
+        if (failure == WriteFailure::Authorization) {
+            DriverMetrics::recordRetry(_connSettings, "reauth");
+            getConnection().first->auth(authParams());
+        }
+        else {
+            DriverMetrics::recordRetry(_connSettings, "network");
+            checkConnectionHealth();
+        }
 
-        _dbclientRepSet.release();
-        if(mongo::DBClientBase *conn = getConnection(true).first)
-            conn->auth(authParams);
+        boost::scoped_ptr<MongoClient> client(getClient());
+        write(*client, true);
+        client->done();
     }
 
     void MongoWorker::keepAlive()
     {
+        // Connections used since the last tick are alive, and pinging them now could only
+        // delay the next user request
+        if (std::chrono::steady_clock::now() - _lastActivity < std::chrono::milliseconds(KeepAliveIntervalMs))
+            return;
+
+        // Background probe of reconnect checks known-down server instead
+        if (_health.isDown())
+            return;
+
         try {
             if (_dbclient)
-                pingDatabase(_dbclient.get());
+                pingWithShortTimeout(_dbclient.get());
 
             if (_dbclientRepSet)
-                pingDatabase(_dbclientRepSet.get());
+                pingWithShortTimeout(_dbclientRepSet.get());
 
             if (_scriptEngine)
                 _scriptEngine->ping();
@@ -106,28 +579,52 @@ namespace Robomongo
         catch(std::exception &ex) {
             sendLog(this, LogEvent::RBM_WARN, 
                 "Failed to ping the server. " + std::string(ex.what()));
+            if (writeFailure(ex) == WriteFailure::Network)
+                markServerDown(ex.what());
         }
     }
 
     void MongoWorker::init()
     {        
+        // Shell is not created here, see scriptEngine()
+        if (_timerId == -1)
+            _timerId = startTimer(KeepAliveIntervalMs);
+    }
+
+    ScriptEngine *MongoWorker::scriptEngine()
+    {
+        if (_scriptEngine || !_hasScriptEngine)
+            return _scriptEngine.get();
+
         try {
-            _scriptEngine.reset(new ScriptEngine(_connSettings, _shellTimeoutSec));
-            _scriptEngine->init(_isLoadMongoRcJs);
-            _scriptEngine->use(_connSettings->defaultDatabase());
-            _scriptEngine->setBatchSize(_batchSize);
-            constexpr int PING_INTERVAL_MSEC { 60 * 1000 };  // 60 seconds
-            _timerId = startTimer(PING_INTERVAL_MSEC);
-            _dbAutocompleteCacheTimerId = startTimer(30000);
+            int shellTimeoutSec = 0;
+            {
+                QMutexLocker lock(&_scriptEngineMutex);
+                shellTimeoutSec = _shellTimeoutSec;
+            }
+
+            std::unique_ptr<ScriptEngine> engine(
+                new ScriptEngine(_connSettings, shellTimeoutSec, _shellResultBudgetMb, _jsHeapLimitMb,
+                                 _scopePoolSize));
+            engine->init(_isLoadMongoRcJs);
+            engine->use(_connSettings->defaultDatabase());
+            engine->setBatchSize(_batchSize);
+            EventTrace::markCurrent("shell initialized");
+
+            QMutexLocker lock(&_scriptEngineMutex);
+            _scriptEngine = std::move(engine);
         } catch (const std::exception &ex) {
-            auto const msg { "Failed to initialize MongoWorker. Reason: "};
+            auto const msg { "Failed to initialize MongoDB shell. Reason: "};
             sendLog(this, LogEvent::RBM_ERROR, msg + std::string(ex.what()));
             throw std::runtime_error(msg + std::string(ex.what()));
         }
+        return _scriptEngine.get();
     }
 
     void MongoWorker::interrupt() {
+        _benchmarkStopped = true;
         try {
+            QMutexLocker lock(&_scriptEngineMutex);
             if (_isQuiting || !_scriptEngine)
                 return;
 
@@ -137,14 +634,55 @@ namespace Robomongo
         }
     }
 
+    std::vector<std::string> MongoWorker::activeClientAddresses() const
+    {
+        QMutexLocker lock(&_activeClientsMutex);
+        return _activeClientAddresses;
+    }
+
+    MongoWorker::ActiveClientsScope::ActiveClientsScope(MongoWorker *worker, 
+                                                         std::vector<std::string> addresses) :
+        _worker(worker)
+    {
+        addresses.erase(std::remove(addresses.begin(), addresses.end(), std::string()), addresses.end());
+        QMutexLocker lock(&_worker->_activeClientsMutex);
+        _worker->_activeClientAddresses = std::move(addresses);
+    }
+
+    MongoWorker::ActiveClientsScope::~ActiveClientsScope()
+    {
+        QMutexLocker lock(&_worker->_activeClientsMutex);
+        _worker->_activeClientAddresses.clear();
+    }
+
+    std::string MongoWorker::driverClientAddress()
+    {
+        if (!_driverClientAddress.empty())
+            return _driverClientAddress;
+
+        try {
+            mongo::DBClientBase *const connection = getConnection(true).first;
+            mongo::BSONObj result;
+            if (connection && connection->runCommand("admin", BSON("whatsmyuri" << 1), result))
+                _driverClientAddress = result.getStringField("you");
+        }
+        catch (const std::exception &) {
+            // Query itself will report connection problem
+        }
+        return _driverClientAddress;
+    }
+
     MongoWorker::~MongoWorker()
     {
         if (_timerId != -1)
             killTimer(_timerId);
 
-        if (_dbAutocompleteCacheTimerId != -1)
-            killTimer(_dbAutocompleteCacheTimerId);
+        _pagedCursors.clear();
+        _pagedAggregations.clear();
 
+        // Spare scopes hold authenticated connections, they are not left open after shell
+        if (_scriptEngine)
+            ScopePool::instance().evict(_scriptEngine->scopePoolKey());
         delete _connSettings;
 
         // QThread "_thread" and MongoWorker itself will be deleted later
@@ -159,7 +697,11 @@ namespace Robomongo
 
     void MongoWorker::changeTimeout(int newTimeout)
     {
-        _scriptEngine->changeTimeout(newTimeout);
+        // Shell, which is not created yet, takes the new timeout too
+        QMutexLocker lock(&_scriptEngineMutex);
+        _shellTimeoutSec = newTimeout;
+        if (_scriptEngine)
+            _scriptEngine->changeTimeout(newTimeout);
     }
 
     /**
@@ -173,6 +715,12 @@ namespace Robomongo
         auto errorCode = EventError::ErrorCode::Unknown;
 
         try {
+            // Server could be upgraded or replaced between connections
+            _capabilities.clear();
+            _driverClientAddress.clear();
+            _pagedCursors.clear();
+            _pagedAggregations.clear();
+
             auto const& connAndErrorStr = getConnection(true);
             mongo::DBClientBase *conn = connAndErrorStr.first;           
             
@@ -199,8 +747,6 @@ namespace Robomongo
                     else    // single server
                         errorReason = "Network is unreachable." + (connErrorStr.empty() ? "" : " Reason: " + connErrorStr);
                 }
-                resetGlobalSSLparams();
-
                 reply(event->sender(), new EstablishConnectionResponse(this, EventError(errorReason, errorCode),             
                       event->connectionType, event->uuid, *repSetInfo.release(), 
                       EstablishConnectionResponse::MongoConnection));
@@ -239,21 +785,9 @@ namespace Robomongo
                 }
             }
 
-            if (_connSettings->hasEnabledPrimaryCredential()) {
-                CredentialSettings const * const credentials = _connSettings->primaryCredential();
-
-                // Building BSON object:
-                mongo::BSONObj const authParams { 
-                    mongo::BSONObjBuilder()
-                    .append("user", credentials->userName())
-                    .append("db", credentials->databaseName())
-                    .append("pwd", credentials->userPassword())
-                    .append("mechanism", credentials->mechanism())
-                    .obj()
-                };
-
-                conn->auth(authParams);
-            }
+            // Warm connection is authenticated already
+            if (_connSettings->hasEnabledPrimaryCredential() && !std::exchange(_warmAuthenticated, false))
+                conn->auth(authParams());
 
             boost::scoped_ptr<MongoClient> client(getClient());
             std::vector<std::string> const dbNames = getDatabaseNamesSafe(event);
@@ -264,9 +798,7 @@ namespace Robomongo
                 throw std::runtime_error("Failed to execute \"listdatabases\" command.");
 
             if (!_connSettings->isReplicaSet())
-                init(); // Init MongoWorker for single server (for replica set connections early init is used)
-
-            resetGlobalSSLparams();
+                init(); // Timers of single server worker (replica set ones are started in getConnection())
 
             auto connInfo = ConnectionInfo(_connSettings->getFullAddress(), dbNames, client->getVersion(), 
                                            client->dbVersionStr(), client->getStorageEngineType(), event->uuid);
@@ -277,7 +809,6 @@ namespace Robomongo
             return true;
         } 
         catch(const std::exception &ex) {
-            resetGlobalSSLparams();
             auto errorReason = _connSettings->sslSettings()->sslEnabled() ?
                                EstablishConnectionResponse::ErrorReason::MongoSslConnection : 
                                EstablishConnectionResponse::ErrorReason::MongoAuth;
@@ -290,36 +821,62 @@ namespace Robomongo
         return false;
     }
 
+    void MongoWorker::handle(PingServerRequest *event)
+    {
+        try {
+            auto const connAndError = getConnection(true);
+            if (!connAndError.first) {
+                reply(event->sender(), new PingServerResponse(this, 
+                    EventError(connAndError.second, EventError::Unknown, false)));
+                return;
+            }
+
+            reply(event->sender(), new PingServerResponse(this, pingWithShortTimeout(connAndError.first)));
+        }
+        catch (const std::exception &ex) {
+            reply(event->sender(), new PingServerResponse(this, EventError(ex.what(), EventError::Unknown, false)));
+        }
+    }
+
     void MongoWorker::handle(RefreshReplicaSetFolderRequest *event)
     {
-		configureSSL();
+        TlsContext::Guard tls(*_tlsContext);
 
         try {
             ReplicaSet const& replicaSetInfo = getReplicaSetInfo();
             // Primary is unreachable, but there might be reachable secondary(ies)
+            // Errors of background polls are reported by MongoServer, only when topology changes
             if (replicaSetInfo.primary.empty()) {
                 reply(
                     event->sender(), 
                     new RefreshReplicaSetFolderResponse(
-                        this, replicaSetInfo, event->expanded, EventError(replicaSetInfo.errorStr)
+                        this, replicaSetInfo, event->expanded, 
+                        EventError(replicaSetInfo.errorStr, EventError::Unknown, !event->monitor), event->monitor
                     )
                 );
-                sendLog(this, LogEvent::RBM_ERROR, replicaSetInfo.errorStr);
+                if (!event->monitor)
+                    sendLog(this, LogEvent::RBM_ERROR, replicaSetInfo.errorStr);
                 return;
             }
             else { // Primary is reachable
                 reply(event->sender(), 
-                    new RefreshReplicaSetFolderResponse(this, replicaSetInfo, event->expanded));
+                    new RefreshReplicaSetFolderResponse(this, replicaSetInfo, event->expanded, event->monitor));
             }
+
+            // Members of tunnelled connection are not reachable from here
+            if (event->monitor && !_connSettings->sshSettings()->enabled())
+                measureMemberLatency(replicaSetInfo);
         }
         catch (const std::exception &ex) {
             reply(
                 event->sender(),
                 new RefreshReplicaSetFolderResponse(
-                    this, ReplicaSet(), event->expanded, EventError(ex.what())
+                    this, ReplicaSet(), event->expanded, 
+                    EventError(ex.what(), EventError::Unknown, !event->monitor), event->monitor
                 )
             );
-            sendLog(this, LogEvent::RBM_ERROR, ex.what());
+            if (!event->monitor)
+                sendLog(this, LogEvent::RBM_ERROR, ex.what());
         }
     }
 
@@ -333,13 +890,18 @@ namespace Robomongo
 
     std::vector<std::string> MongoWorker::getDatabaseNamesSafe(EstablishConnectionRequest* event /*= nullptr*/)
     {
-        std::set<std::string> dbNames;
+        // Nodes of the set are scratch of this call, they live in arena
+        ScratchArena arena;
+        std::set<std::string, std::less<std::string>, ArenaAllocator<std::string>> dbNames {
+            std::less<std::string>(), ArenaAllocator<std::string>(arena)
+        };
         auto const primaryCredential { _connSettings->primaryCredential() };
 
         try {
             boost::scoped_ptr<MongoClient> client(getClient());
             std::vector<std::string> dbNamesFetched { client->getDatabaseNames() };
-            dbNames = std::set<std::string> { dbNamesFetched.cbegin(), dbNamesFetched.cend() };
+            dbNames.insert(std::make_move_iterator(dbNamesFetched.begin()),
+                           std::make_move_iterator(dbNamesFetched.end()));
         } 
         catch(const std::exception &ex) {
 #if defined(__clang__) 
@@ -394,18 +956,9 @@ namespace Robomongo
             // Non admin user has access only to the single database he specified while performing auth.
             std::vector<std::string> dbNames = getDatabaseNamesSafe();
 
-            // Remove from list of created databases existing databases
-            for (std::vector<std::string>::iterator it = dbNames.begin(); it != dbNames.end(); ++it) {
-                std::unordered_set<std::string>::const_iterator exists = _createdDbs.find(*it);
-                if (exists != _createdDbs.end()) {
-                    _createdDbs.erase(*it);
-                }
-            }
-
-            // Merge with list of created databases
-            for (std::unordered_set<std::string>::iterator it = _createdDbs.begin(); it != _createdDbs.end(); ++it) {
-                dbNames.push_back(*it);
-            }
+            // Merge with databases created by workers of this connection, which exist
+            // on server only once they have a collection
+            dbNames = CreatedDatabases::merge(_connSettings->uuid(), std::move(dbNames));
 
             if (dbNames.size()) {
                 reply(event->sender(), new LoadDatabaseNamesResponse(this, dbNames));
@@ -424,95 +977,454 @@ namespace Robomongo
      */
     void MongoWorker::handle(LoadCollectionNamesRequest *event)
     {
+        // Names per listCollections batch, that is, per page of explorer tree
+        constexpr int CollectionNamesBatchSize { 1000 };
+        int batchIndex = 0;
         try {
             boost::scoped_ptr<MongoClient> client(getClient());
-            auto const& namespaces = client->getCollectionNamesWithDbname(event->databaseName());
-            std::vector<MongoCollectionInfo> const& collInfos = client->runCollStatsCommand(namespaces);
+            // Reply once per cursor batch, so huge databases are shown page by page
+            client->getCollectionNamesWithDbname(event->databaseName(), event->nameFilter(), 
+                CollectionNamesBatchSize,
+                [&](const std::vector<std::string> &namespaces, bool lastBatch) {
+                    // Names only, stats are loaded later for visible collections, see 
+                    // LoadCollectionStatsRequest
+                    EventTrace::markCurrent("driver batch " + std::to_string(batchIndex));
+                    std::vector<MongoCollectionInfo> infos(namespaces.begin(), namespaces.end());
+                    reply(event->sender(), 
+                        new LoadCollectionNamesResponse(this, event->databaseName(), infos, 
+                                                        batchIndex++, lastBatch)
+                    );
+                }
+            );
             client->done();
-            reply(event->sender(), new LoadCollectionNamesResponse(this, event->databaseName(), collInfos));
+
+            // Explorer shows names as they are now, completion in shells takes the same
+            CollectionNamesVersion::bump(_connSettings->uuid());
         } catch(const std::exception &ex) {
             reply(event->sender(), new LoadCollectionNamesResponse(this, EventError(ex.what())));
             // Logging handled in main thread
         }
     }
 
-    void MongoWorker::handle(LoadUsersRequest *event)
+    void MongoWorker::handle(LoadDatabaseMetadataRequest *event)
     {
+        std::string const databaseName = event->databaseName();
+        QObject *const sender = event->sender();
+
+        // Version is cached in capabilities before they are read from other threads
         try {
             boost::scoped_ptr<MongoClient> client(getClient());
-            const std::vector<MongoUser> &users = client->getUsers(event->databaseName());
-            client->done();
-
-            reply(event->sender(), new LoadUsersResponse(this, event->databaseName(), users));
+            client->getVersion();
         } catch(const std::exception &ex) {
-            reply(event->sender(), new LoadUsersResponse(this, EventError(ex.what())));
-            // Logging handled in main thread
+            reply(sender, new LoadCollectionNamesResponse(this, EventError(ex.what())));
+            return;
         }
+
+        // Errors of users and functions are not shown, i.e. user may have no usersInfo privilege
+        auto readOnSide = [this](const std::function<void(MongoClient &client)> &read) {
+            std::unique_ptr<mongo::DBClientBase> connection = takeSideConnection();
+            MongoClient client(connection.get(), &_capabilities, _connSettings);
+            read(client);
+            putSideConnection(std::move(connection));
+        };
+        std::thread users([&]() {
+            try {
+                readOnSide([&](MongoClient &client) {
+                    reply(sender, new LoadUsersResponse(this, databaseName, client.getUsers(databaseName)));
+                });
+            } catch(const std::exception &ex) {
+                reply(sender, new LoadUsersResponse(this, EventError(ex.what(), EventError::Unknown, false)));
+            }
+        });
+        std::thread functions([&]() {
+            try {
+                readOnSide([&](MongoClient &client) {
+                    reply(sender, new LoadFunctionsResponse(this, databaseName, client.getFunctions(databaseName)));
+                });
+            } catch(const std::exception &ex) {
+                reply(sender, new LoadFunctionsResponse(this, EventError(ex.what(), EventError::Unknown, false)));
+            }
+        });
+
+        LoadCollectionNamesRequest names(sender, databaseName, event->nameFilter());
+        handle(&names);
+
+        users.join();
+        functions.join();
     }
 
-    void MongoWorker::handle(LoadCollectionIndexesRequest *event)
+    std::unique_ptr<mongo::DBClientBase> MongoWorker::takeSideConnection()
     {
-        try {
-            boost::scoped_ptr<MongoClient> client(getClient());
-            const std::vector<IndexInfo> &ind = client->getIndexes(event->collection());
-            client->done();
-
-            reply(event->sender(), new LoadCollectionIndexesResponse(this, ind));
-        } catch(const std::exception &ex) {
-            reply(event->sender(), new LoadCollectionIndexesResponse(this, EventError(ex.what())));
-            sendLog(this, LogEvent::RBM_ERROR, ex.what());
+        {
+            QMutexLocker lock(&_sideConnectionsMutex);
+            while (!_sideConnections.empty()) {
+                std::unique_ptr<mongo::DBClientBase> connection = std::move(_sideConnections.back());
+                _sideConnections.pop_back();
+                if (!connection->isFailed() && connection->isStillConnected())
+                    return connection;
+            }
         }
+        return openExtraConnection();
     }
 
-    void MongoWorker::handle(AddEditIndexRequest *event)
+    void MongoWorker::putSideConnection(std::unique_ptr<mongo::DBClientBase> connection)
     {
-        const IndexInfo &newIndex = event->newInfo();
-        const IndexInfo &oldIndex = event->oldInfo();
-        try {
-            boost::scoped_ptr<MongoClient> client(getClient());
-            client->addEditIndex(oldIndex, newIndex);
-            client->done();
-            reply(event->sender(), new AddEditIndexResponse(this, oldIndex, newIndex));
-
-            std::vector<IndexInfo> const &indexes = client->getIndexes(newIndex._collection);
-            reply(event->sender(), new LoadCollectionIndexesResponse(this, indexes));
-        } catch(const std::exception &ex) {
-            reply(event->sender(), 
-                new AddEditIndexResponse(this, EventError(ex.what()), oldIndex, newIndex)
-            );
-            // Logging handled in main thread
-        }
+        QMutexLocker lock(&_sideConnectionsMutex);
+        if (_sideConnections.size() < MaxSideConnections)
+            _sideConnections.push_back(std::move(connection));
     }
 
-    void MongoWorker::handle(DropCollectionIndexRequest *event)
+    void MongoWorker::handle(LoadCollectionStatsRequest *event)
     {
+        std::vector<MongoCollectionInfo> infos;
         try {
             boost::scoped_ptr<MongoClient> client(getClient());
-            client->dropIndexFromCollection(event->collection(), event->index());
+            for (auto const& collectionName : event->collectionNames()) {
+                // Database was collapsed in the meantime, reply with what we have
+                if (event->isCancelled())
+                    break;
+
+                infos.push_back(client->runCollStatsCommand(
+                    MongoNamespace(event->databaseName(), collectionName).toString()));
+            }
             client->done();
-            reply(event->sender(), 
-                new DropCollectionIndexResponse(this, event->collection(), event->index()));
+
+            reply(event->sender(), new LoadCollectionStatsResponse(this, event->databaseName(), infos));
         } catch(const std::exception &ex) {
+            // Background request, error is not shown to user
             reply(event->sender(), 
-                new DropCollectionIndexResponse(this, EventError(ex.what()), event->index()));
-            // Logging handled in main thread
-        }            
+                  new LoadCollectionStatsResponse(this, EventError(ex.what(), EventError::Unknown, false)));
+        }
     }
 
-    void MongoWorker::handle(LoadFunctionsRequest *event)
+    void MongoWorker::handle(WatchNamespaceChangesRequest *event)
     {
-        try {
-            boost::scoped_ptr<MongoClient> client(getClient());
+        // Request is deleted after this handler, steps keep what they need
+        struct Stream
+        {
+            MongoNamespace ns;
+            long long cursorId = 0;
+            bool isOpen = false;
+            NamespaceChanges::Filter filter;
+        };
+        auto const stream = std::make_shared<Stream>();
+        QObject *const sender = event->sender();
+        std::shared_ptr<std::atomic<bool>> const cancelled = event->cancelled;
+
+        continueLater([this, stream, sender, cancelled]() {
+            try {
+                boost::scoped_ptr<MongoClient> client(getClient());
+                if (cancelled && *cancelled) {
+                    if (stream->cursorId != 0)
+                        client->killCursor(stream->ns, stream->cursorId);
+                    reply(sender, new WatchNamespaceChangesResponse(this));
+                    return Done;
+                }
+
+                std::vector<mongo::BSONObj> const batch = stream->isOpen ?
+                    client->awaitMore(stream->ns, stream->cursorId, WatchNamespaceChangesRequest::AwaitMs) :
+                    client->openChangeStream(NamespaceChanges::pipeline(), stream->ns, stream->cursorId);
+                stream->isOpen = true;
+                client->done();
+
+                std::vector<NamespaceChanges::Change> changes;
+                NamespaceChanges::Change change;
+                for (auto const &changeEvent : batch) {
+                    if (stream->filter.apply(changeEvent, change))
+                        changes.push_back(change);
+                }
+
+                if (!changes.empty()) {
+                    CollectionNamesVersion::bump(_connSettings->uuid());
+                    reply(sender, new NamespaceChangesEvent(this, changes));
+                }
+
+                // Server closed the stream, i.e. collection of it was dropped
+                if (stream->cursorId == 0) {
+                    reply(sender, new WatchNamespaceChangesResponse(this));
+                    return Done;
+                }
+                return 0;
+            } catch(const std::exception &ex) {
+                // Background request, explorer still works with manual refresh
+                reply(sender, new WatchNamespaceChangesResponse(this, EventError(ex.what(), EventError::Unknown, false)));
+                return Done;
+            }
+        });
+    }
+
+    void MongoWorker::handle(TailOplogRequest *event)
+    {
+        struct Tail
+        {
+            OplogTail::Filter filter;
+            MongoNamespace ns;
+            long long cursorId = 0;
+            bool isOpen = false;
+            bool received = false;      // by the current cursor
+            std::vector<mongo::BSONObj> pending;
+            std::chrono::steady_clock::time_point lastReply;
+        };
+        auto const tail = std::make_shared<Tail>();
+        tail->filter = event->filter;
+        tail->lastReply = std::chrono::steady_clock::now();
+        QObject *const sender = event->sender();
+        int const tailId = event->tailId;
+        std::shared_ptr<std::atomic<bool>> const cancelled = event->cancelled;
+
+        // Entries are replied in bulk, so that UI is not flooded by events at high rates
+        auto const flush = [this, tail, sender, tailId]() {
+            if (!tail->pending.empty())
+                reply(sender, new OplogEntriesEvent(this, tailId, tail->pending));
+            tail->pending.clear();
+            tail->lastReply = std::chrono::steady_clock::now();
+        };
+
+        continueLater([this, tail, sender, tailId, cancelled, flush]() {
+            try {
+                boost::scoped_ptr<MongoClient> client(getClient());
+                if (cancelled && *cancelled) {
+                    if (tail->cursorId != 0)
+                        client->killCursor(tail->ns, tail->cursorId);
+                    flush();
+                    reply(sender, new TailOplogResponse(this, tailId));
+                    return Done;
+                }
+
+                OplogTail::Filter &filter = tail->filter;
+                std::vector<mongo::BSONObj> batch;
+                if (tail->isOpen) {
+                    batch = client->awaitMore(tail->ns, tail->cursorId, TailOplogRequest::AwaitMs,
+                                              TailOplogRequest::BatchSize);
+                }
+                else {
+                    if (filter.from.isNull()) {
+                        filter.from = client->lastOplogTimestamp();
+                        filter.afterFrom = true;
+                    }
+                    batch = client->openOplogTail(OplogTail::query(filter), TailOplogRequest::BatchSize,
+                                                  tail->ns, tail->cursorId);
+                    tail->isOpen = true;
+                    tail->received = false;
+                }
+                client->done();
+
+                if (!batch.empty()) {
+                    tail->pending.insert(tail->pending.end(), batch.begin(), batch.end());
+                    filter.from = batch.back()["ts"].timestamp();
+                    filter.afterFrom = true;
+                    tail->received = true;
+                }
+
+                std::chrono::milliseconds const coalesce(static_cast<int>(TailOplogRequest::CoalesceMs));
+                size_t const maxPending = TailOplogRequest::BatchSize;
+                if (tail->pending.size() >= maxPending || std::chrono::steady_clock::now() - tail->lastReply >= coalesce)
+                    flush();
+
+                if (tail->cursorId != 0)
+                    return 0;
+
+                // Dead cursor is reopened after the last seen entry. Without entries (i.e. empty
+                // oplog) it is not reopened in a busy loop.
+                flush();
+                tail->isOpen = false;
+                return tail->received ? 0 : static_cast<int>(TailOplogRequest::AwaitMs);
+            } catch(const std::exception &ex) {
+                reply(sender, new TailOplogResponse(this, tailId, EventError(ex.what(), EventError::Unknown, false)));
+                return Done;
+            }
+        });
+    }
+
+    void MongoWorker::handle(WatchCollectionRequest *event)
+    {
+        struct Watch
+        {
+            MongoNamespace collection;
+            mongo::BSONArray pipeline;
+            MongoNamespace ns;
+            long long cursorId = 0;
+            bool isOpen = false;
+            std::vector<mongo::BSONObj> pending;
+            std::chrono::steady_clock::time_point lastReply;
+        };
+        auto const watch = std::make_shared<Watch>();
+        watch->collection = event->ns;
+        watch->pipeline = ChangeStreamWatch::pipeline(event->filter);
+        watch->lastReply = std::chrono::steady_clock::now();
+        QObject *const sender = event->sender();
+        int const watchId = event->watchId;
+        std::shared_ptr<std::atomic<bool>> const cancelled = event->cancelled;
+
+        // Events are replied in bulk, like entries of oplog tail
+        auto const flush = [this, watch, sender, watchId]() {
+            if (!watch->pending.empty())
+                reply(sender, new ChangeEventsEvent(this, watchId, watch->pending));
+            watch->pending.clear();
+            watch->lastReply = std::chrono::steady_clock::now();
+        };
+
+        continueLater([this, watch, sender, watchId, cancelled, flush]() {
+            try {
+                boost::scoped_ptr<MongoClient> client(getClient());
+                if (cancelled && *cancelled) {
+                    if (watch->cursorId != 0)
+                        client->killCursor(watch->ns, watch->cursorId);
+                    flush();
+                    reply(sender, new WatchCollectionResponse(this, watchId));
+                    return Done;
+                }
+
+                std::vector<mongo::BSONObj> const batch = watch->isOpen ?
+                    client->awaitMore(watch->ns, watch->cursorId, WatchCollectionRequest::AwaitMs,
+                                      WatchCollectionRequest::BatchSize) :
+                    client->openChangeStream(watch->collection, watch->pipeline, WatchCollectionRequest::BatchSize,
+                                             watch->ns, watch->cursorId);
+                watch->isOpen = true;
+                client->done();
+
+                watch->pending.insert(watch->pending.end(), batch.begin(), batch.end());
+
+                std::chrono::milliseconds const coalesce(static_cast<int>(WatchCollectionRequest::CoalesceMs));
+                size_t const maxPending = WatchCollectionRequest::BatchSize;
+                if (watch->pending.size() >= maxPending || std::chrono::steady_clock::now() - watch->lastReply >= coalesce)
+                    flush();
+
+                if (watch->cursorId != 0)
+                    return 0;
+
+                // Server closed the stream after drop, rename or invalidate event
+                flush();
+                reply(sender, new WatchCollectionResponse(this, watchId));
+                return Done;
+            } catch(const std::exception &ex) {
+                flush();
+                reply(sender, new WatchCollectionResponse(this, watchId, EventError(ex.what(), EventError::Unknown, false)));
+                return Done;
+            }
+        });
+    }
+
+    void MongoWorker::handle(LoadUsersRequest *event)
+    {
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            const std::vector<MongoUser> &users = client->getUsers(event->databaseName());
+            client->done();
+
+            reply(event->sender(), new LoadUsersResponse(this, event->databaseName(), users));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new LoadUsersResponse(this, EventError(ex.what())));
+            // Logging handled in main thread
+        }
+    }
+
+    void MongoWorker::handle(LoadCollectionIndexesRequest *event)
+    {
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            const std::vector<IndexInfo> &ind = client->getIndexes(event->collection());
+            client->done();
+
+            reply(event->sender(), new LoadCollectionIndexesResponse(this, ind));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new LoadCollectionIndexesResponse(this, EventError(ex.what())));
+            sendLog(this, LogEvent::RBM_ERROR, ex.what());
+        }
+    }
+
+    void MongoWorker::handle(PrefetchCollectionRequest *event)
+    {
+        FirstPageCache &cache = FirstPageCache::instance();
+        if (!cache.isWanted(event->generation))
+            return;
+
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            std::vector<IndexInfo> const indexes = client->getIndexes(event->collection);
+
+            // The same first batch as readNative() reads for find({}), unless focus moved meanwhile
+            if (event->readPage && cache.isWanted(event->generation)) {
+                MongoNamespace const ns = event->collection.ns();
+                MongoQueryInfo firstBatch { CollectionInfo(primaryAddress(), ns.databaseName(), ns.collectionName()),
+                                            mongo::BSONObj(), mongo::BSONObj(), 0, 0, 0, 0, false };
+                firstBatch._limit = firstBatch._batchSize = _batchSize;
+                cache.put(event->generation, _batchSize, client->query(firstBatch));
+            }
+            client->done();
+
+            reply(event->sender(), new PrefetchCollectionResponse(this, indexes));
+        } catch (const std::exception &ex) {
+            // Background request, error is not shown to user
+            reply(event->sender(), new PrefetchCollectionResponse(this, EventError(ex.what(), EventError::Unknown, false)));
+        }
+    }
+
+    void MongoWorker::handle(LoadIndexUsageRequest *event)
+    {
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            std::vector<IndexUsageInfo> const usage = client->indexUsage(event->ns());
+            client->done();
+
+            reply(event->sender(), new LoadIndexUsageResponse(this, event->ns(), usage));
+        } catch(const std::exception &ex) {
+            // Background request, error is not shown to user
+            reply(event->sender(), 
+                  new LoadIndexUsageResponse(this, event->ns(), EventError(ex.what(), EventError::Unknown, false)));
+        }
+    }
+
+    void MongoWorker::handle(AddEditIndexRequest *event)
+    {
+        const IndexInfo &newIndex = event->newInfo();
+        const IndexInfo &oldIndex = event->oldInfo();
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            client->addEditIndex(oldIndex, newIndex);
+            client->done();
+            reply(event->sender(), new AddEditIndexResponse(this, oldIndex, newIndex));
+
+            std::vector<IndexInfo> const &indexes = client->getIndexes(newIndex._collection);
+            reply(event->sender(), new LoadCollectionIndexesResponse(this, indexes));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), 
+                new AddEditIndexResponse(this, EventError(ex.what()), oldIndex, newIndex)
+            );
+            // Logging handled in main thread
+        }
+    }
+
+    void MongoWorker::handle(DropCollectionIndexRequest *event)
+    {
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            client->dropIndexFromCollection(event->collection(), event->index());
+            client->done();
+            reply(event->sender(), 
+                new DropCollectionIndexResponse(this, event->collection(), event->index()));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), 
+                new DropCollectionIndexResponse(this, EventError(ex.what()), event->index()));
+            // Logging handled in main thread
+        }            
+    }
+
+    void MongoWorker::handle(LoadFunctionsRequest *event)
+    {
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
             const std::vector<MongoFunction> &funcs = client->getFunctions(event->databaseName());
             client->done();
 
             // If list of functions from client is empty, try getting it with script engine
             if (funcs.empty()) {
-                MongoShellExecResult const& result = _scriptEngine->exec("db.system.js.find()", event->databaseName());
+                MongoShellExecResult const& result = 
+                    scriptEngine()->exec("db.system.js.find()", event->databaseName());
                 std::vector<MongoFunction> functions;
                 if (!result.results().empty()) {
                     auto const& resultDocs = result.results().front().documents();
-                    for (auto const res : resultDocs)
+                    for (auto const& res : resultDocs)
                         functions.push_back(MongoFunction(res->bsonObj()));
                 }
                 reply(event->sender(), new LoadFunctionsResponse(this, event->databaseName(), functions));
@@ -529,14 +1441,24 @@ namespace Robomongo
     void MongoWorker::handle(InsertDocumentRequest *event)
     {
         try {
-            boost::scoped_ptr<MongoClient> client(getClient());
-    
-            if (event->overwrite())
-                client->saveDocument(event->obj(), event->ns());
-            else
-                client->insertDocument(event->obj(), event->ns());
+            // Write could be applied before connection failed: update finds no original
+            // document then, and insert fails on duplicate _id, though document is stored
+            bool const idempotent = event->overwrite() || event->obj().hasField("_id");
+            runWrite("Write of document", idempotent, [this, event](MongoClient &client, bool retry) {
+                try {
+                    if (event->overwrite() && !event->original().isEmpty())
+                        client.updateDocument(event->original(), event->obj(), event->ns());
+                    else if (event->overwrite())
+                        client.saveDocument(event->obj(), event->ns());
+                    else
+                        client.insertDocument(event->obj(), event->ns());
+                }
+                catch (const std::exception &) {
+                    if (!retry || !isStored(getConnection().first, event->obj(), event->ns()))
+                        throw;
+                }
+            });
 
-            client->done();
             reply(event->sender(), new InsertDocumentResponse(this));
         } 
         catch(const std::exception &ex) {
@@ -545,156 +1467,2646 @@ namespace Robomongo
         }
     }
 
-    void MongoWorker::handle(RemoveDocumentRequest *event)
+    void MongoWorker::handle(GenerateDataRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+
+        // Throughput is measured from the first generated document, after sample was analyzed
+        auto generationStarted = started;
+        std::unique_ptr<BulkInserter> inserter;
+        auto stats = [&]() {
+            GenerateDataProgressEvent::Stats stats;
+            if (inserter) {
+                stats.inserted = inserter->inserted();
+                stats.failed = inserter->failed();
+                stats.latency = inserter->latency();
+                std::string const errors = inserter->errors();
+                stats.firstError = errors.substr(0, errors.find('\n'));
+            }
+            stats.elapsedMs = elapsedMsSince(generationStarted);
+            return stats;
+        };
+
+        try {
+            MongoNamespace const &ns = event->ns;
+
+            // Types and distributions of fields from $sample, its first document is the sample
+            // unless one was given
+            mongo::BSONObj sample = event->sample;
+            std::vector<FieldAnalysis> fields;
+            if (event->sampleSize > 0) {
+                SchemaAnalyzer analyzer;
+                boost::scoped_ptr<MongoClient> client(getClient());
+                long long cursorId = 0;
+                std::vector<MongoDocumentPtr> batch = client->openAggregation(ns,
+                    BSON_ARRAY(BSON("$sample" << BSON("size" << event->sampleSize))),
+                    BSON("allowDiskUse" << true), AnalyzeSchemaRequest::BatchSize, cursorId);
+                for (;;) {
+                    for (MongoDocumentPtr const &document : batch) {
+                        if (sample.isEmpty())
+                            sample = document->bsonObj().getOwned();
+                        analyzer.add(document->bsonObj());
+                    }
+                    if (cursorId == 0 || event->isCancelled())
+                        break;
+                    batch = client->getMore(ns, cursorId, AnalyzeSchemaRequest::BatchSize);
+                }
+                if (cursorId != 0)
+                    client->killCursor(ns, cursorId);
+                client->done();
+                fields = analyzer.summary();
+            }
+
+            if (sample.isEmpty())
+                throw std::runtime_error("Sample document is required, as no document of collection was analyzed.");
+
+            int const threads = std::max(1, std::min(event->threads, MaxGenerateConcurrency));
+            std::vector<std::unique_ptr<mongo::DBClientBase>> connections;
+            for (int i = 0; i < threads; ++i)
+                connections.push_back(openExtraConnection());
+            inserter.reset(new BulkInserter(std::move(connections), ns, false));
+
+            // Every thread generates batches of numbers it reserved, and waits until the time
+            // of the first of them at target rate, so rate does not depend on number of threads
+            uint64_t const seed = static_cast<uint64_t>(
+                std::chrono::system_clock::now().time_since_epoch().count());
+            generationStarted = std::chrono::steady_clock::now();
+            std::mutex mutex;
+            std::string error;
+            std::atomic<bool> failed { false };
+            std::atomic<long long> next { 0 };
+            std::atomic<int> running { threads };
+            std::vector<std::thread> producers;
+            for (int i = 0; i < threads; ++i) {
+                producers.emplace_back([&, i]() {
+                    try {
+                        DataGenerator generator(sample, fields, seed, static_cast<unsigned>(i));
+                        for (;;) {
+                            long long const first = next.fetch_add(GenerateDataRequest::BatchSize);
+                            if (first >= event->documents || failed || event->isCancelled())
+                                break;
+
+                            if (event->rate > 0) {
+                                auto const due = generationStarted +
+                                    std::chrono::microseconds(first * 1000 * 1000 / event->rate);
+                                while (std::chrono::steady_clock::now() < due && !event->isCancelled())
+                                    std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                                        due - std::chrono::steady_clock::now(), std::chrono::milliseconds(100)));
+                            }
+
+                            long long const last = std::min<long long>(first + GenerateDataRequest::BatchSize,
+                                                                       event->documents);
+                            std::vector<mongo::BSONObj> batch;
+                            batch.reserve(static_cast<size_t>(last - first));
+                            for (long long number = first; number < last; ++number)
+                                batch.push_back(generator.next(static_cast<uint64_t>(number)));
+
+                            if (event->isCancelled() || !inserter->push(std::move(batch)))
+                                break;
+                        }
+                    }
+                    catch (const std::exception &ex) {
+                        // I.e. document over 16 MB, the other threads stop too
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!failed.exchange(true))
+                            error = ex.what();
+                    }
+                    --running;
+                });
+            }
+
+            long long lastProgressMs = 0;
+            while (running > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(GenerateDataProgressEvent::IntervalMs / 5));
+                long long const now = elapsedMsSince(started);
+                if (now - lastProgressMs >= GenerateDataProgressEvent::IntervalMs) {
+                    lastProgressMs = now;
+                    reply(event->sender(), new GenerateDataProgressEvent(this, event->generateId, stats()));
+                }
+            }
+            for (std::thread &producer : producers)
+                producer.join();
+
+            if (failed || event->isCancelled())
+                inserter->cancel();
+            else
+                inserter->finish();
+
+            if (failed)
+                throw std::runtime_error(error);
+
+            // Documents inserted until stop are reported too
+            reply(event->sender(), new GenerateDataResponse(this, event->generateId, stats()));
+        } catch(const std::exception &ex) {
+            if (inserter)
+                inserter->cancel();
+            reply(event->sender(), new GenerateDataResponse(this, event->generateId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(ReplayWorkloadRequest *event)
+    {
+        try {
+            // Captured operations, oldest first
+            std::vector<WorkloadReplay::Operation> operations;
+            long long skipped = 0;
+            if (event->logFile.empty()) {
+                boost::scoped_ptr<MongoClient> client(getClient());
+                operations = client->profileOperations(event->profileDatabase, event->sinceMs,
+                                                       ReplayWorkloadRequest::MaxOperations, skipped);
+                client->done();
+            } else {
+                QFile file(QtUtils::toQString(event->logFile));
+                if (!file.open(QIODevice::ReadOnly))
+                    throw std::runtime_error("Cannot open " + event->logFile + ": " +
+                                             QtUtils::toStdString(file.errorString()));
+
+                while (!file.atEnd() && operations.size() < static_cast<size_t>(ReplayWorkloadRequest::MaxOperations)) {
+                    QByteArray const line = file.readLine();
+                    if (line.trimmed().isEmpty())
+                        continue;
+
+                    WorkloadReplay::Operation operation;
+                    if (WorkloadReplay::fromLine(line.toStdString(), operation))
+                        operations.push_back(operation);
+                    else
+                        ++skipped;
+                }
+                std::stable_sort(operations.begin(), operations.end(),
+                    [](const WorkloadReplay::Operation &left, const WorkloadReplay::Operation &right) {
+                        return left.timeMs < right.timeMs;
+                    });
+            }
+
+            if (operations.empty())
+                throw std::runtime_error("No find, aggregate or count operations to replay were captured.");
+
+            if (!event->targetDatabase.empty()) {
+                for (WorkloadReplay::Operation &operation : operations)
+                    operation.database = event->targetDatabase;
+            }
+
+            int const threads = std::max(1, std::min(event->threads, MaxReplayConcurrency));
+            std::vector<std::unique_ptr<mongo::DBClientBase>> connections;
+            for (int i = 0; i < threads; ++i)
+                connections.push_back(openExtraConnection());
+
+            // Every thread takes the next operation and waits until its captured time (relative
+            // to the first one) divided by speed, so spacing does not depend on number of threads
+            long long const firstMs = operations.front().timeMs;
+            auto const started = std::chrono::steady_clock::now();
+
+            std::vector<WorkloadReplay::Result> results(threads);
+            std::atomic<size_t> next { 0 };
+            std::atomic<long long> replayed { 0 };
+            std::atomic<long long> errors { 0 };
+            std::atomic<int> running { threads };
+            std::vector<std::thread> replayers;
+            for (int i = 0; i < threads; ++i) {
+                replayers.emplace_back([&, i]() {
+                    mongo::DBClientBase *connection = connections[i].get();
+                    for (;;) {
+                        size_t const index = next++;
+                        if (index >= operations.size() || event->isCancelled())
+                            break;
+
+                        WorkloadReplay::Operation const &operation = operations[index];
+                        if (event->speed > 0) {
+                            auto const due = started + std::chrono::microseconds(static_cast<long long>(
+                                (operation.timeMs - firstMs) * 1000 / event->speed));
+                            while (std::chrono::steady_clock::now() < due && !event->isCancelled())
+                                std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                                    due - std::chrono::steady_clock::now(), std::chrono::milliseconds(100)));
+                            if (event->isCancelled())
+                                break;
+                        }
+
+                        auto const operationStarted = std::chrono::steady_clock::now();
+                        std::string error;
+                        mongo::BSONObj info;
+                        try {
+                            if (!connection->runCommand(operation.database, operation.command, info,
+                                                        mongo::QueryOption_SlaveOk)) {
+                                error = info.getStringField("errmsg");
+                                if (error.empty())
+                                    error = "Command failed";
+                            }
+                        }
+                        catch (const std::exception &ex) {
+                            error = ex.what();
+                        }
+                        long long const us = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - operationStarted).count();
+                        results[i].add(operation, us, error);
+                        ++replayed;
+                        if (!error.empty())
+                            ++errors;
+
+                        // Cursors of replay are not read further
+                        long long const cursorId = info["cursor"]["id"].safeNumberLong();
+                        if (error.empty() && cursorId != 0) {
+                            try {
+                                connection->killCursor(mongo::NamespaceString(info["cursor"]["ns"].str()), cursorId);
+                            }
+                            catch (const std::exception &) {
+                                // Cursor times out on server
+                            }
+                        }
+
+                        // I.e. network error, the other connections continue
+                        if (connection->isFailed())
+                            break;
+                    }
+                    --running;
+                });
+            }
+
+            long long lastProgressMs = 0;
+            while (running > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(ReplayWorkloadProgressEvent::IntervalMs / 5));
+                long long const now = elapsedMsSince(started);
+                if (now - lastProgressMs >= ReplayWorkloadProgressEvent::IntervalMs) {
+                    lastProgressMs = now;
+                    reply(event->sender(), new ReplayWorkloadProgressEvent(this, event->replayId, replayed,
+                                                                           operations.size(), errors, now));
+                }
+            }
+            for (std::thread &replayer : replayers)
+                replayer.join();
+
+            // Operations replayed until stop are reported too
+            WorkloadReplay::Result result;
+            for (WorkloadReplay::Result const &threadResult : results)
+                result.merge(threadResult);
+            result.skipped = skipped;
+            result.speed = event->speed;
+            result.elapsedMs = elapsedMsSince(started);
+            reply(event->sender(), new ReplayWorkloadResponse(this, event->replayId, result));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new ReplayWorkloadResponse(this, event->replayId, EventError(ex.what())));
+            sendLog(this, LogEvent::RBM_ERROR, ex.what());
+        }
+    }
+
+    void MongoWorker::handle(ThrottledWriteRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+
+        ThrottledWriteProgressEvent::Progress progress;
+        long long lastProgressMs = 0;
+        auto sendProgress = [&](bool force) {
+            progress.elapsedMs = elapsedMsSince(started);
+            if (!force && progress.elapsedMs - lastProgressMs < ThrottledWriteProgressEvent::IntervalMs)
+                return;
+            lastProgressMs = progress.elapsedMs;
+            reply(event->sender(), new ThrottledWriteProgressEvent(this, event->writeId, progress));
+        };
+
+        // Waits 'ms' in short steps, so that stop takes effect
+        auto wait = [&](long long ms) {
+            auto const until = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+            while (std::chrono::steady_clock::now() < until && !event->isCancelled()) {
+                std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                    until - std::chrono::steady_clock::now(), std::chrono::milliseconds(100)));
+                sendProgress(false);
+            }
+        };
+
+        try {
+            MongoNamespace const &ns = event->ns;
+            bool const isUpdate = !event->update.isEmpty();
+            std::unique_ptr<mongo::DBClientBase> connection = takeSideConnection();
+
+            auto readLagMs = [&]() {
+                mongo::BSONObj status;
+                if (!connection->runCommand("admin", BSON("replSetGetStatus" << 1), status))
+                    return -1LL;    // standalone, mongos or missing privilege
+                return ThrottledWrite::replicationLagMs(status);
+            };
+
+            mongo::BSONObj countResult;
+            if (connection->runCommand(ns.databaseName(), BSON("count" << ns.collectionName() <<
+                                                              "query" << event->filter), countResult))
+                progress.total = countResult["n"].safeNumberLong();
+
+            ThrottledWrite::Throttle throttle(event->maxLagMs);
+            mongo::BSONObj lastId;      // { _id: <last of previous chunk> }, empty before the first one
+            mongo::BSONObj const idOnly = BSON("_id" << 1);
+            while (!event->isCancelled()) {
+                if (event->isPaused()) {
+                    progress.paused = true;
+                    auto const pausedAt = std::chrono::steady_clock::now();
+                    while (event->isPaused() && !event->isCancelled()) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                        sendProgress(false);
+                    }
+                    progress.pausedMs += elapsedMsSince(pausedAt);
+                    progress.paused = false;
+                    continue;
+                }
+
+                // _id of next chunk, read by index, so that the documents are known before
+                // writing. Index bound $min is inclusive, the last _id of previous chunk is skipped.
+                progress.chunkSize = throttle.chunkSize();
+                std::unique_ptr<mongo::DBClientCursor> cursor = connection->query(
+                    mongo::NamespaceString(ns.databaseName(), ns.collectionName()),
+                    mongo::Query(ThrottledWrite::remainingQuery(event->filter, lastId)),
+                    progress.chunkSize + (lastId.isEmpty() ? 0 : 1), 0, &idOnly);
+                if (!cursor)
+                    throw std::runtime_error("Network error while attempting to read _id of next chunk");
+
+                std::vector<mongo::BSONObj> ids;
+                while (cursor->more()) {
+                    mongo::BSONObj const id = cursor->next().getOwned();
+                    if (ids.empty() && !lastId.isEmpty() && id.woCompare(lastId) == 0)
+                        continue;
+                    ids.push_back(id);
+                }
+                if (ids.empty())
+                    break;
+
+                auto const chunkStarted = std::chrono::steady_clock::now();
+                mongo::BSONObj const chunkFilter = ThrottledWrite::chunkFilter(event->filter, ids);
+                mongo::BSONObj const command = isUpdate ?
+                    BSON("update" << ns.collectionName() << "updates" <<
+                         BSON_ARRAY(BSON("q" << chunkFilter << "u" << event->update << "multi" << true))) :
+                    BSON("delete" << ns.collectionName() << "deletes" <<
+                         BSON_ARRAY(BSON("q" << chunkFilter << "limit" << 0)));
+                mongo::BSONObj result;
+                if (!connection->runCommand(ns.databaseName(), command, result))
+                    throw std::runtime_error(result.getStringField("errmsg"));
+                if (result["writeErrors"].type() == mongo::Array && !result["writeErrors"].Obj().isEmpty())
+                    throw std::runtime_error(result["writeErrors"].Obj().firstElement().Obj().getStringField("errmsg"));
+
+                double const chunkMs = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - chunkStarted).count() / 1000.0;
+                progress.processed += result[isUpdate ? "nModified" : "n"].safeNumberLong();
+                ++progress.chunks;
+                lastId = ids.back();
+
+                // Secondaries catch up before the next chunk, if they fell behind
+                progress.lagMs = readLagMs();
+                long long waitMs = throttle.afterChunk(progress.lagMs, chunkMs);
+                sendProgress(false);
+                while (waitMs > 0 && !event->isCancelled()) {
+                    wait(waitMs);
+                    progress.throttledMs += waitMs;
+                    progress.lagMs = readLagMs();
+                    waitMs = throttle.whileWaiting(progress.lagMs);
+                    sendProgress(false);
+                }
+            }
+            putSideConnection(std::move(connection));
+
+            // Documents processed until stop are reported too
+            progress.elapsedMs = elapsedMsSince(started);
+            reply(event->sender(), new ThrottledWriteResponse(this, event->writeId, progress));
+        } catch(const std::exception &ex) {
+            progress.elapsedMs = elapsedMsSince(started);
+            reply(event->sender(), new ThrottledWriteResponse(this, event->writeId, EventError(ex.what()), progress));
+            sendLog(this, LogEvent::RBM_ERROR, ex.what());
+        }
+    }
+
+    void MongoWorker::handle(CommitChangesetRequest *event)
+    {
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            TableChangeset::CommitResult const result = client->commitChangeset(event->statements, event->ns);
+            client->done();
+            reply(event->sender(), new CommitChangesetResponse(this, event->changesetId, result));
+        }
+        catch(const std::exception &ex) {
+            reply(event->sender(), new CommitChangesetResponse(this, event->changesetId, EventError(ex.what())));
+            sendLog(this, LogEvent::RBM_ERROR, ex.what());
+        }
+    }
+
+    void MongoWorker::handle(InsertDocumentsRequest *event)
+    {
+        std::vector<BulkChunkResult> batches;
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            batches = client->insertDocuments(event->objs(), event->ns(), event->overwrite(), 
+                                              event->batchBytesLimit());
+            client->done();
+        } 
+        catch(const std::exception &ex) {
+            reply(event->sender(), new InsertDocumentsResponse(this, EventError(ex.what()), batches));
+            sendLog(this, LogEvent::RBM_ERROR, ex.what());
+            return;
+        }
+
+        std::string errors;
+        int failed = 0;
+        for (auto const& batch : batches) {
+            if (!batch.isError())
+                continue;
+            failed += batch._count;
+            errors += "\nDocuments " + std::to_string(batch._first + 1) + "-" + 
+                      std::to_string(batch._first + batch._count) + ": " + batch._error;
+        }
+
+        if (failed == 0) {
+            reply(event->sender(), new InsertDocumentsResponse(this, batches));
+            return;
+        }
+
+        std::string const error = std::to_string(failed) + " of " + std::to_string(event->objs().size()) + 
+                                  " documents were not written." + errors;
+        reply(event->sender(), new InsertDocumentsResponse(this, EventError(error), batches));
+        sendLog(this, LogEvent::RBM_ERROR, error);
+    }
+
+    void MongoWorker::handle(RemoveDocumentRequest *event)
+    {
+        try {
+            // Removing one of many matching documents again would remove another one
+            bool const justOne = event->removeCount() == RemoveDocumentCount::ONE;
+            mongo::BSONObj const filter = event->query().getFilter();
+            bool const idempotent = !justOne || (filter.nFields() == 1 && filter.hasField("_id"));
+            runWrite("Remove of documents", idempotent, [event, justOne](MongoClient &client, bool) {
+                client.removeDocuments(event->ns(), event->query(), justOne);
+            });
+
+            reply(event->sender(), new RemoveDocumentResponse(this, event->removeCount(), event->index()));
+        } 
+        catch(const std::exception &ex) {
+            reply(event->sender(), new RemoveDocumentResponse(this, EventError(ex.what()), 
+                event->removeCount(), event->index()));
+            // Logging handled in main thread
+        }
+    }
+
+    void MongoWorker::handle(RemoveDocumentsByIdRequest *event)
+    {
+        std::vector<BulkChunkResult> chunks;
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            chunks = client->removeDocumentsById(event->ns(), event->ids());
+            client->done();
+        } 
+        catch(const std::exception &ex) {
+            reply(event->sender(), new RemoveDocumentsByIdResponse(this, EventError(ex.what()), chunks));
+            return;
+        }
+
+        int failed = 0;
+        std::string firstError;
+        for (auto const& chunk : chunks) {
+            if (!chunk.isError())
+                continue;
+            if (firstError.empty())
+                firstError = chunk._error;
+            failed += chunk._count;
+        }
+
+        if (failed == 0) {
+            reply(event->sender(), new RemoveDocumentsByIdResponse(this, chunks));
+            return;
+        }
+
+        std::string const error = std::to_string(failed) + " of " + std::to_string(event->ids().size()) + 
+                                  " documents were not removed: " + firstError;
+        reply(event->sender(), new RemoveDocumentsByIdResponse(this, EventError(error), chunks));
+        // Logging handled in main thread
+    }
+
+    void MongoWorker::handle(ExecuteQueryRequest *event)
+    {
+        if (parkWhileDown(event))
+            return;
+
+        if (event->cursorKey() != 0) {
+            try {
+                ActiveClientsScope const activeClients(this, { driverClientAddress() });
+                std::vector<MongoDocumentPtr> const docs = readPage(event->cursorKey(), event->queryInfo());
+                EventTrace::markCurrent("page read");
+                auto response = new ExecuteQueryResponse(this, event->resultIndex(), event->queryInfo(), docs);
+                response->prefetch = event->isPrefetch();
+                reply(event->sender(), response);
+                return;
+            }
+            catch (const std::exception &ex) {
+                // Page will be read when user asks for it
+                if (event->isPrefetch()) {
+                    auto response = new ExecuteQueryResponse(this, EventError(ex.what()));
+                    response->prefetch = true;
+                    reply(event->sender(), response);
+                    return;
+                }
+
+                // Plain query below reports errors, and handles DocumentDB specifics
+                _pagedCursors.erase(event->cursorKey());
+                sendLog(this, LogEvent::RBM_DEBUG, "Paged cursor failed: " + std::string(ex.what()));
+            }
+        }
+
+        int batchIndex = 0;
+        ActiveClientsScope const activeClients(this, { driverClientAddress() });
+
+        auto const executeQuery = [&]() {
+            boost::scoped_ptr<MongoClient> client { queryClient(event->queryInfo()) };
+            // Reply once per server batch, so GUI can render first documents while
+            // the rest of the cursor is still being transferred
+            client->query(event->queryInfo(), 
+                [&](const std::vector<MongoDocumentPtr> &docs, bool lastBatch) {
+                    EventTrace::markCurrent("driver batch " + std::to_string(batchIndex));
+                    reply(event->sender(),
+                        new ExecuteQueryResponse(this, event->resultIndex(), event->queryInfo(), 
+                                                 docs, batchIndex++, lastBatch)
+                    );
+                }
+            );
+            client->done();
+        };
+
+        try {
+            executeQuery();
+        } catch(const std::exception &ex) {
+            QString const NTORETURN_ERROR { "unrecognized field: 'ntoreturn'" };
+            bool const ntoreturnError { 
+                QString(ex.what()).compare(NTORETURN_ERROR, Qt::CaseInsensitive) == 0 
+            };
+            // If we have this DocumentDB specific error, try again
+            if (ntoreturnError && _dbclient && batchIndex == 0) {
+                sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
+                try {
+                    DriverMetrics::recordRetry(_connSettings, "ntoreturn");
+                    _dbclient->tagAsDocDb(true);
+                    executeQuery();
+                    return;
+                } 
+                catch (const std::exception &ex) {
+                    sendLog(this, LogEvent::RBM_ERROR, "Re-try: " + std::string(ex.what()));
+                }
+            }
+
+            reply(event->sender(), new ExecuteQueryResponse(this, EventError(ex.what())));
+            sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
+        }
+    }
+
+    void MongoWorker::handle(CountDocumentsRequest *event)
+    {
+        try {
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            bool estimated = false;
+            long long const count = client->countDocuments(event->queryInfo, event->maxTimeMs, estimated);
+            client->done();
+            reply(event->sender(), new CountDocumentsResponse(this, event->resultIndex, 
+                                                              event->queryInfo, count, estimated));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new CountDocumentsResponse(this, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(SampleSchemaRequest *event)
+    {
+        try {
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            std::vector<MongoDocumentPtr> const sample = client->aggregate(event->ns, 
+                BSON_ARRAY(BSON("$sample" << BSON("size" << event->sampleSize))),
+                BSON("maxTimeMS" << event->maxTimeMs), event->sampleSize);
+            client->done();
+
+            std::vector<mongo::BSONObj> documents;
+            documents.reserve(sample.size());
+            for (MongoDocumentPtr const &document : sample)
+                documents.push_back(document->bsonObj());
+
+            CollectionSchema schema = CollectionSchema::infer(documents);
+            schema.sampledAt = std::time(nullptr);
+            reply(event->sender(), new SampleSchemaResponse(this, event->key, schema));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new SampleSchemaResponse(this, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(ExportDocumentsRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+
+        try {
+            // Blocks of archive are not merged from ranges, it is written by one cursor
+            if (event->options.parallelism > 1 && event->options.format != ExportFormat::ResultArchive) {
+                boost::scoped_ptr<MongoClient> client { getClient() };
+                std::vector<mongo::BSONObj> const bounds = 
+                    client->splitIdRanges(event->queryInfo._info._ns, event->options.parallelism);
+                client->done();
+
+                // Collection too small to split is exported with single cursor below
+                if (!bounds.empty()) {
+                    exportRanges(event, bounds, started);
+                    return;
+                }
+            }
+
+            ExportWriter writer(event->filePath, event->options);
+            long long lastProgressMs = 0;
+
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            client->query(event->queryInfo, [&](const std::vector<MongoDocumentPtr> &batch, bool) {
+                if (event->isCancelled())
+                    throw std::runtime_error("Export cancelled.");
+
+                std::vector<mongo::BSONObj> docs;
+                docs.reserve(batch.size());
+                for (MongoDocumentPtr const &doc : batch)
+                    docs.push_back(doc->bsonObj());
+                writer.push(std::move(docs));
+
+                long long const now = elapsedMsSince(started);
+                if (now - lastProgressMs >= ExportProgressEvent::IntervalMs) {
+                    lastProgressMs = now;
+                    reply(event->sender(), new ExportProgressEvent(this, event->exportId, 
+                        writer.documentsWritten(), writer.bytesWritten(), now));
+                }
+            });
+            client->done();
+            writer.finish();
+
+            reply(event->sender(), new ExportDocumentsResponse(this, event->exportId,
+                writer.documentsWritten(), writer.bytesWritten(), elapsedMsSince(started)));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new ExportDocumentsResponse(this, event->exportId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(ImportDocumentsRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+
+        std::unique_ptr<BulkInserter> inserter;
+        try {
+            ImportOptions const &options = event->options;
+            ImportReader reader(event->filePath, options);
+
+            // Batches of ordered import are inserted one after another
+            int const concurrency = options.ordered ? 1 : std::max(1, options.concurrency);
+            std::vector<std::unique_ptr<mongo::DBClientBase>> connections;
+            for (int i = 0; i < concurrency; ++i)
+                connections.push_back(openExtraConnection());
+            inserter.reset(new BulkInserter(std::move(connections), event->ns, options.ordered));
+
+            // Reader parses ahead while batches are inserted, push() waits for inserters
+            std::string readError;
+            long long lastProgressMs = 0;
+            while (true) {
+                if (event->isCancelled())
+                    throw std::runtime_error("Import cancelled.");
+
+                std::vector<mongo::BSONObj> batch;
+                try {
+                    if (!reader.next(batch))
+                        break;
+                }
+                catch (const std::exception &ex) {
+                    readError = ex.what();
+                    break;
+                }
+
+                if (!inserter->push(std::move(batch)))
+                    break;
+
+                long long const now = elapsedMsSince(started);
+                if (now - lastProgressMs >= ImportProgressEvent::IntervalMs) {
+                    lastProgressMs = now;
+                    reply(event->sender(), new ImportProgressEvent(this, event->importId, inserter->inserted(),
+                        inserter->failed(), reader.bytesRead(), reader.fileSize(), now, inserter->throttleMs()));
+                }
+            }
+            inserter->finish();
+
+            std::string errors = inserter->errors();
+            if (!readError.empty())
+                errors = readError + (errors.empty() ? "" : "\n" + errors);
+
+            reply(event->sender(), new ImportDocumentsResponse(this, event->importId, inserter->inserted(),
+                inserter->failed(), elapsedMsSince(started), errors));
+        } catch(const std::exception &ex) {
+            // Documents inserted until now are kept
+            if (inserter)
+                inserter->cancel();
+            reply(event->sender(), new ImportDocumentsResponse(this, event->importId, 
+                inserter ? inserter->inserted() : 0, inserter ? inserter->failed() : 0, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(DatabaseStatsRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            std::vector<std::string> const namespaces = client->getCollectionNamesWithDbname(event->databaseName);
+            mongo::BSONObj const dbStats = client->dbStats(event->databaseName);
+            client->done();
+
+            size_t const total = namespaces.size();
+            std::mutex mutex;
+            std::vector<MongoDocumentPtr> ready;    // not sent yet
+            std::atomic<int> done { 0 };
+            std::atomic<int> skipped { 0 };
+
+            // Rows are sent in batches, so that 5k collections are not 5k events
+            auto sendReady = [&]() {
+                std::vector<MongoDocumentPtr> batch;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    batch.swap(ready);
+                }
+                reply(event->sender(), new DatabaseStatsProgressEvent(this, event->statsId, batch, 
+                                                                      done, static_cast<int>(total)));
+            };
+
+            runOnExtraConnections(total, MaxStatsConcurrency, [&](const ConnectionItem &item) {
+                if (event->isCancelled())
+                    return;
+
+                MongoClient client(item.connection, nullptr, _connSettings);
+                mongo::BSONObj const stats = client.collStats(MongoNamespace(namespaces[item.index]),
+                                                             event->indexDetails);
+                if (stats.isEmpty()) {
+                    ++skipped;
+                }
+                else {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    ready.push_back(MongoDocumentPtr(new MongoDocument(stats)));
+                }
+                ++done;
+            }, sendReady, DatabaseStatsProgressEvent::IntervalMs);
+
+            MongoDocumentPtr const databaseStats = dbStats.isEmpty() ? MongoDocumentPtr() : 
+                                                   MongoDocumentPtr(new MongoDocument(dbStats));
+            reply(event->sender(), new DatabaseStatsResponse(this, event->statsId, databaseStats, 
+                                                             skipped, elapsedMsSince(started)));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new DatabaseStatsResponse(this, event->statsId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(DatabaseSearchRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+
+        DatabaseSearch::Options const &options = event->options;
+        DatabaseSearch::Cancellation const &cancellation = *event->cancellation;
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            std::vector<std::string> const namespaces = client->getCollectionNamesWithDbname(event->databaseName);
+            client->done();
+
+            size_t const total = namespaces.size();
+            mongo::BSONArray const candidates = DatabaseSearch::candidates(options.value);
+
+            std::mutex mutex;
+            std::vector<DatabaseSearch::Hit> hits;                      // not sent yet
+            std::vector<DatabaseSearch::CollectionResult> finished;     // not sent yet
+            std::vector<std::string> startedCollections;                // not sent yet
+            std::atomic<long long> hitCount { 0 };
+
+            // Queries of one collection, with index first; hits are handed over as they come
+            auto searchCollection = [&](mongo::DBClientBase *connection, const MongoNamespace &ns) {
+                DatabaseSearch::CollectionResult result;
+                result.collection = ns.collectionName();
+                mongo::NamespaceString const nss(ns.databaseName(), ns.collectionName());
+                auto const collectionStarted = std::chrono::steady_clock::now();
+                try {
+                    // Views and system collections may have no indexes to list
+                    std::vector<mongo::BSONObj> specs;
+                    try {
+                        for (mongo::BSONObj const &spec : connection->getIndexSpecs(ns.toString()))
+                            specs.push_back(spec.getOwned());
+                    }
+                    catch (const std::exception &) {}
+
+                    std::vector<std::string> const indexed = DatabaseSearch::indexedFields(specs);
+                    std::vector<std::string> scanned;
+                    if (options.scanUnindexed || options.substring) {
+                        std::vector<mongo::BSONObj> sample;
+                        std::unique_ptr<mongo::DBClientCursor> cursor =
+                            connection->query(nss, mongo::Query(), DatabaseSearch::SampleSize);
+                        while (cursor && cursor->more())
+                            sample.push_back(cursor->nextSafe().getOwned());
+                        scanned = DatabaseSearch::sampledFields(sample, indexed, DatabaseSearch::MaxScannedFields);
+                    }
+
+                    std::vector<mongo::BSONObj> filters;
+                    if (options.substring) {
+                        std::vector<std::string> fields(indexed);
+                        fields.insert(fields.end(), scanned.begin(), scanned.end());
+                        filters.push_back(DatabaseSearch::regexFilter(fields, options.value));
+                        result.plan = "regex";
+                    }
+                    else {
+                        bool const scan = options.scanUnindexed && !scanned.empty();
+                        bool const text = DatabaseSearch::hasTextIndex(specs);
+                        filters.push_back(DatabaseSearch::equalityFilter(indexed, candidates));
+                        if (scan)
+                            filters.push_back(DatabaseSearch::equalityFilter(scanned, candidates));
+                        if (text)
+                            filters.push_back(DatabaseSearch::textFilter(options.value));
+                        result.plan = DatabaseSearch::planName(!indexed.empty(), scan, text);
+                    }
+
+                    // Document found by several queries is reported once
+                    std::unordered_set<std::string> seenIds;
+                    for (mongo::BSONObj const &filter : filters) {
+                        int const limit = options.maxHitsPerCollection - result.hits;
+                        if (filter.isEmpty() || limit <= 0)
+                            continue;
+
+                        mongo::BSONObj const query = BSON("$query" << filter << "$maxTimeMS" << options.maxTimeMs);
+                        std::unique_ptr<mongo::DBClientCursor> cursor = connection->query(nss, mongo::Query(query), limit);
+                        if (!cursor)
+                            throw std::runtime_error("Network error while searching " + ns.toString());
+
+                        while (cursor->more()) {
+                            // Checked between batches, cursor is killed when destroyed
+                            if (cancellation.isCancelled(result.collection)) {
+                                result.state = DatabaseSearch::CollectionResult::Cancelled;
+                                result.elapsedMs = elapsedMsSince(collectionStarted);
+                                return result;
+                            }
+
+                            mongo::BSONObj const document = cursor->nextSafe().getOwned();
+                            if (!seenIds.insert(document["_id"].toString(false)).second)
+                                continue;
+
+                            ++result.hits;
+                            ++hitCount;
+                            std::lock_guard<std::mutex> lock(mutex);
+                            hits.push_back({ result.collection, MongoDocumentPtr(new MongoDocument(document)) });
+                        }
+                    }
+                }
+                catch (const std::exception &ex) {
+                    result.state = EventError::isServerTimeLimitExceeded(ex.what()) ?
+                        DatabaseSearch::CollectionResult::TimedOut : DatabaseSearch::CollectionResult::Failed;
+                    result.error = ex.what();
+                    if (connection->isFailed())
+                        throw;
+                }
+                result.elapsedMs = elapsedMsSince(collectionStarted);
+                return result;
+            };
+
+            // Hits are sent in batches, so that one result view is filled about 5 times a second
+            auto sendReady = [&]() {
+                std::vector<DatabaseSearch::Hit> hitBatch;
+                std::vector<DatabaseSearch::CollectionResult> finishedBatch;
+                std::vector<std::string> startedBatch;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    hitBatch.swap(hits);
+                    finishedBatch.swap(finished);
+                    startedBatch.swap(startedCollections);
+                }
+                if (hitBatch.empty() && finishedBatch.empty() && startedBatch.empty())
+                    return;
+
+                reply(event->sender(), new DatabaseSearchProgressEvent(this, event->searchId, hitBatch, finishedBatch,
+                                                                       startedBatch, static_cast<int>(total)));
+            };
+
+            runOnExtraConnections(total, MaxSearchConcurrency, [&](const ConnectionItem &item) {
+                if (cancellation.isCancelled())
+                    return;
+
+                MongoNamespace const ns(namespaces[item.index]);
+                DatabaseSearch::CollectionResult result;
+                if (cancellation.isCancelled(ns.collectionName())) {
+                    result.collection = ns.collectionName();
+                    result.state = DatabaseSearch::CollectionResult::Cancelled;
+                }
+                else {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        startedCollections.push_back(ns.collectionName());
+                    }
+                    result = searchCollection(item.connection, ns);
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.push_back(result);
+            }, sendReady, DatabaseSearchProgressEvent::IntervalMs);
+
+            reply(event->sender(), new DatabaseSearchResponse(this, event->searchId, hitCount, elapsedMsSince(started)));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new DatabaseSearchResponse(this, event->searchId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(CollectionMaintenanceRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+
+        CollectionMaintenance::Action const &action = event->action;
+        std::atomic<bool> const &cancelled = *event->cancelled;
+        try {
+            size_t const total = event->collections.size();
+            std::mutex mutex;
+            std::vector<std::string> startedCollections;                    // not sent yet
+            std::vector<CollectionMaintenance::ItemResult> finished;        // not sent yet
+            std::atomic<int> succeeded { 0 }, failedItems { 0 };
+
+            auto run = [&](MongoClient &client, const std::string &collection) {
+                MongoNamespace const ns(event->databaseName, collection);
+                switch (action.kind) {
+                case CollectionMaintenance::Action::CreateIndex:
+                    client.createIndex(CollectionMaintenance::indexFor(action, ns.toString()));
+                    break;
+                case CollectionMaintenance::Action::DropIndex:
+                    client.dropIndexFromCollection(MongoCollectionInfo(ns.toString()), action.index._name);
+                    break;
+                case CollectionMaintenance::Action::RenameCollection:
+                    client.renameCollection(ns, CollectionMaintenance::renamedName(action.renamePattern, collection));
+                    break;
+                case CollectionMaintenance::Action::DropCollection:
+                    client.dropCollection(ns);
+                    break;
+                }
+            };
+
+            auto sendReady = [&]() {
+                std::vector<std::string> startedBatch;
+                std::vector<CollectionMaintenance::ItemResult> finishedBatch;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    startedBatch.swap(startedCollections);
+                    finishedBatch.swap(finished);
+                }
+                if (startedBatch.empty() && finishedBatch.empty())
+                    return;
+
+                reply(event->sender(), new CollectionMaintenanceProgressEvent(this, event->runId, startedBatch,
+                                                                              finishedBatch));
+            };
+
+            // Index builds may take long, so connections have no socket timeout (as for
+            // RollingIndexBuildRequest)
+            runOnExtraConnections(total, MaxMaintenanceConcurrency, [&](const ConnectionItem &item) {
+                // Commands already sent are not interrupted, the rest is skipped
+                if (cancelled)
+                    return;
+
+                CollectionMaintenance::ItemResult result;
+                result.collection = event->collections[item.index];
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    startedCollections.push_back(result.collection);
+                }
+
+                auto const itemStarted = std::chrono::steady_clock::now();
+                try {
+                    MongoClient client(item.connection, nullptr, _connSettings);
+                    run(client, result.collection);
+                    ++succeeded;
+                }
+                catch (const std::exception &ex) {
+                    if (item.connection->isFailed())
+                        throw;
+                    result.ok = false;
+                    result.error = ex.what();
+                    ++failedItems;
+                }
+                result.elapsedMs = elapsedMsSince(itemStarted);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.push_back(result);
+            }, sendReady, CollectionMaintenanceProgressEvent::IntervalMs, 0);
+
+            reply(event->sender(), new CollectionMaintenanceResponse(this, event->runId, succeeded, failedItems,
+                                                                     elapsedMsSince(started)));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new CollectionMaintenanceResponse(this, event->runId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(AnalyzeSchemaRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+
+        try {
+            // Batch is analyzed in another thread while the next one is read, at most
+            // MaxQueuedBatches wait for it, so memory does not depend on sample size
+            SchemaAnalyzer analyzer;
+            std::mutex mutex;
+            std::condition_variable changed;
+            std::deque<std::vector<MongoDocumentPtr>> queue;
+            bool finished = false;
+            std::atomic<long long> analyzed { 0 };
+
+            std::thread analyzing([&]() {
+                ThreadPriority::setCurrent(ThreadPriority::Background);
+                for (;;) {
+                    std::vector<MongoDocumentPtr> batch;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        changed.wait(lock, [&]() { return !queue.empty() || finished; });
+                        if (queue.empty())
+                            return;
+                        batch = std::move(queue.front());
+                        queue.pop_front();
+                    }
+                    changed.notify_all();
+
+                    for (MongoDocumentPtr const &document : batch)
+                        analyzer.add(document->bsonObj());
+                    analyzed += batch.size();
+                }
+            });
+
+            auto finish = [&]() {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    finished = true;
+                }
+                changed.notify_all();
+                analyzing.join();
+            };
+
+            MongoNamespace const &ns = event->ns;
+            boost::scoped_ptr<MongoClient> client(getClient());
+            long long cursorId = 0;
+            try {
+                // Large sample is sorted randomly by server, which needs disk for more than 100 MB
+                std::vector<MongoDocumentPtr> batch = client->openAggregation(ns,
+                    BSON_ARRAY(BSON("$sample" << BSON("size" << event->sampleSize))),
+                    BSON("allowDiskUse" << true), AnalyzeSchemaRequest::BatchSize, cursorId);
+
+                long long lastProgressMs = 0;
+                for (;;) {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        changed.wait(lock, [&]() { return queue.size() < MaxQueuedBatches; });
+                        queue.push_back(std::move(batch));
+                    }
+                    changed.notify_all();
+
+                    long long const now = elapsedMsSince(started);
+                    if (now - lastProgressMs >= AnalyzeSchemaProgressEvent::IntervalMs) {
+                        lastProgressMs = now;
+                        reply(event->sender(), new AnalyzeSchemaProgressEvent(this, event->analysisId, 
+                                                                              analyzed, event->sampleSize));
+                    }
+
+                    if (cursorId == 0 || event->isCancelled())
+                        break;
+
+                    batch = client->getMore(ns, cursorId, AnalyzeSchemaRequest::BatchSize);
+                }
+
+                if (cursorId != 0)
+                    client->killCursor(ns, cursorId);
+                client->done();
+            }
+            catch (const std::exception &) {
+                finish();
+                throw;
+            }
+            finish();
+
+            if (event->isCancelled())
+                return;
+
+            reply(event->sender(), new AnalyzeSchemaResponse(this, event->analysisId, analyzer.summary(),
+                                                             analyzer.documents(), analyzer.droppedPaths(),
+                                                             elapsedMsSince(started)));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new AnalyzeSchemaResponse(this, event->analysisId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(DocumentSizesRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+
+        try {
+            MongoNamespace const &ns = event->ns;
+            boost::scoped_ptr<MongoClient> client(getClient());
+            DocumentSizeHistogram histogram(event->topCount);
+            bool serverSide = true;
+            try {
+                std::vector<MongoDocumentPtr> const result = client->aggregate(ns,
+                    DocumentSizeHistogram::pipeline(event->sampleSize, event->topCount),
+                    BSON("allowDiskUse" << true), 1);
+                if (!result.empty())
+                    histogram.addPipelineResult(result.front()->bsonObj());
+            }
+            catch (const std::exception &ex) {
+                // $bsonSize is new in MongoDB 4.4, older servers send documents to be measured here
+                if (std::string(ex.what()).find("$bsonSize") == std::string::npos)
+                    throw;
+
+                serverSide = false;
+                mongo::BSONArray const pipeline = event->sampleSize > 0 ?
+                    BSON_ARRAY(BSON("$sample" << BSON("size" << event->sampleSize))) : mongo::BSONArray();
+                long long cursorId = 0;
+                std::vector<MongoDocumentPtr> batch = client->openAggregation(ns, pipeline,
+                    BSON("allowDiskUse" << true), DocumentSizeBatchSize, cursorId);
+                for (;;) {
+                    for (MongoDocumentPtr const &document : batch)
+                        histogram.add(document->bsonObj());
+
+                    if (cursorId == 0 || event->isCancelled())
+                        break;
+                    batch = client->getMore(ns, cursorId, DocumentSizeBatchSize);
+                }
+                if (cursorId != 0)
+                    client->killCursor(ns, cursorId);
+            }
+            client->done();
+
+            if (event->isCancelled())
+                return;
+
+            long long const elapsedMs = elapsedMsSince(started);
+            reply(event->sender(), new DocumentSizesResponse(this, event->sizesId, histogram, serverSide,
+                                                             elapsedMs));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new DocumentSizesResponse(this, event->sizesId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(CompareCollectionsRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+
+        try {
+            typedef CollectionComparison::Digest Digest;
+            typedef CollectionComparison::Entry Entry;
+            CompareCollectionsResponse::Result result;
+
+            // Target connection is opened in this thread too, see runOnExtraConnections()
+            std::unique_ptr<mongo::DBClientBase> target = event->targetWorker->openExtraConnection();
+            mongo::DBClientBase *const source = getConnection().first;
+            boost::scoped_ptr<MongoClient> client(getClient());
+
+            // Servers hash whole collections without sending them, equal hashes need nothing else
+            std::string const sourceHash = collectionDbHash(source, event->source);
+            if (!sourceHash.empty() && sourceHash == collectionDbHash(target.get(), event->target)) {
+                result.sameDbHash = true;
+                result.sourceDocuments = result.targetDocuments = collectionCount(source, event->source);
+                client->done();
+                reply(event->sender(), new CompareCollectionsResponse(this, event->compareId, result, elapsedMsSince(started)));
+                return;
+            }
+
+            std::vector<mongo::BSONObj> const bounds = client->splitIdRanges(event->source, event->ranges);
+            client->done();
+
+            // Thread of every source connection has its target connection of the same slot
+            size_t const count = bounds.size() + 1;
+            std::vector<std::unique_ptr<mongo::DBClientBase>> targetConnections;
+            targetConnections.push_back(std::move(target));
+            for (size_t i = 1; i < std::min(count, MaxCompareConcurrency); ++i)
+                targetConnections.push_back(event->targetWorker->openExtraConnection());
+
+            CollectionInfo const sourceInfo(_connSettings->getFullAddress(),
+                                            event->source.databaseName(), event->source.collectionName());
+            CollectionInfo const targetInfo(event->targetAddress,
+                                            event->target.databaseName(), event->target.collectionName());
+
+            // Index bounds ($min inclusive, $max exclusive) instead of $gte/$lt, which would
+            // skip _id values of other types than the boundary
+            auto readRange = [&](mongo::DBClientBase *connection, const CollectionInfo &collection, size_t range,
+                                 const std::function<void(const mongo::BSONObj &)> &onDocument) {
+                mongo::BSONObjBuilder query;
+                query.append("$query", mongo::BSONObj());
+                query.append("$hint", BSON("_id" << 1));
+                if (range > 0)
+                    query.append("$min", bounds[range - 1]);
+                if (range < bounds.size())
+                    query.append("$max", bounds[range]);
+                MongoQueryInfo const info(collection, query.obj(), mongo::BSONObj(), 0, 0, 0, 0, true);
+
+                MongoClient client(connection, nullptr, _connSettings);
+                client.query(info, [&](const std::vector<MongoDocumentPtr> &batch, bool) {
+                    if (event->isCancelled())
+                        throw std::runtime_error("Comparison cancelled.");
+
+                    for (MongoDocumentPtr const &document : batch)
+                        onDocument(document->bsonObj());
+                });
+            };
+
+            std::atomic<int> compared { 0 };
+            std::atomic<int> mismatched { 0 };
+            std::atomic<long long> sourceDocuments { 0 };
+            std::atomic<long long> targetDocuments { 0 };
+            std::vector<CollectionComparison> comparisons(targetConnections.size());
+
+            // Cancelled comparison is not an error, readRange() stops with exception
+            try {
+                runOnExtraConnections(count, MaxCompareConcurrency, [&](const ConnectionItem &item) {
+                    if (event->isCancelled())
+                        return;
+
+                    // Digests first, only ranges which differ are read again by document
+                    mongo::DBClientBase *const targetConnection = targetConnections[item.slot].get();
+                    Digest sourceDigest, targetDigest;
+                    readRange(item.connection, sourceInfo, item.index, [&](const mongo::BSONObj &doc) {
+                        sourceDigest.add(CollectionComparison::documentHash(doc));
+                    });
+                    readRange(targetConnection, targetInfo, item.index, [&](const mongo::BSONObj &doc) {
+                        targetDigest.add(CollectionComparison::documentHash(doc));
+                    });
+                    sourceDocuments += sourceDigest.documents;
+                    targetDocuments += targetDigest.documents;
+
+                    if (sourceDigest != targetDigest) {
+                        ++mismatched;
+                        std::vector<Entry> sourceEntries, targetEntries;
+                        readRange(item.connection, sourceInfo, item.index, [&](const mongo::BSONObj &doc) {
+                            sourceEntries.push_back(CollectionComparison::entry(doc));
+                        });
+                        readRange(targetConnection, targetInfo, item.index, [&](const mongo::BSONObj &doc) {
+                            targetEntries.push_back(CollectionComparison::entry(doc));
+                        });
+                        comparisons[item.slot].diffRange(std::move(sourceEntries), std::move(targetEntries));
+                    }
+                    ++compared;
+                }, [&]() {
+                    reply(event->sender(), new CompareCollectionsProgressEvent(this, event->compareId, compared,
+                                                                               static_cast<int>(count), mismatched));
+                }, CompareCollectionsProgressEvent::IntervalMs);
+            }
+            catch (const std::exception &) {
+                if (!event->isCancelled())
+                    throw;
+            }
+            targetConnections.clear();
+
+            if (event->isCancelled())
+                return;
+
+            for (CollectionComparison const &comparison : comparisons)
+                result.comparison.merge(comparison);
+            result.sourceDocuments = sourceDocuments;
+            result.targetDocuments = targetDocuments;
+            result.ranges = static_cast<int>(count);
+            result.mismatchedRanges = mismatched;
+            reply(event->sender(), new CompareCollectionsResponse(this, event->compareId, result, elapsedMsSince(started)));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new CompareCollectionsResponse(this, event->compareId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::exportRanges(ExportDocumentsRequest *event, const std::vector<mongo::BSONObj> &bounds,
+                                   const std::chrono::steady_clock::time_point &started)
+    {
+
+        ExportOptions const &options = event->options;
+        size_t const count = bounds.size() + 1;
+
+        std::vector<std::unique_ptr<ExportWriter>> writers;
+        std::vector<QString> files;
+        for (size_t i = 0; i < count; ++i) {
+            QString const file = ExportWriter::partFilePath(event->filePath, static_cast<int>(i));
+            files.push_back(options.separateFiles ? file : file + ".tmp");
+            writers.emplace_back(new ExportWriter(files.back(), options.separateFiles ? 
+                                                  options : ExportWriter::partOptions(options)));
+        }
+        std::vector<char> committed(count, false);
+
+        auto written = [&writers](long long &documents, long long &bytes) {
+            documents = bytes = 0;
+            for (auto const &writer : writers) {
+                documents += writer->documentsWritten();
+                bytes += writer->bytesWritten();
+            }
+        };
+
+        long long documents = 0, bytes = 0;
+        try {
+            // One connection per range
+            runOnExtraConnections(count, count, [&](const ConnectionItem &item) {
+                // Index bounds ($min inclusive, $max exclusive) instead of $gte/$lt, which
+                // would skip _id values of other types than the boundary
+                size_t const i = item.index;
+                MongoQueryInfo info = event->queryInfo;
+                mongo::BSONObjBuilder query;
+                query.append("$query", info._query);
+                query.append("$hint", BSON("_id" << 1));
+                if (i > 0)
+                    query.append("$min", bounds[i - 1]);
+                if (i < bounds.size())
+                    query.append("$max", bounds[i]);
+                info._query = query.obj();
+                info._special = true;
+                if (options.readFromSecondaries)
+                    info._options |= mongo::QueryOption_SlaveOk;
+
+                MongoClient client(item.connection, nullptr, _connSettings);
+                client.query(info, [&](const std::vector<MongoDocumentPtr> &batch, bool) {
+                    if (item.stopped || event->isCancelled())
+                        throw std::runtime_error("Export cancelled.");
+
+                    std::vector<mongo::BSONObj> docs;
+                    docs.reserve(batch.size());
+                    for (MongoDocumentPtr const &doc : batch)
+                        docs.push_back(doc->bsonObj());
+                    writers[i]->push(std::move(docs));
+                });
+                writers[i]->finish();
+                committed[i] = true;
+            }, [&]() {
+                written(documents, bytes);
+                reply(event->sender(), new ExportProgressEvent(this, event->exportId, documents, bytes, 
+                                                               elapsedMsSince(started)));
+            }, ExportProgressEvent::IntervalMs);
+        }
+        catch (const std::exception &) {
+            // Files of other ranges are removed too, export is all or nothing
+            writers.clear();
+            for (size_t i = 0; i < count; ++i) {
+                if (committed[i])
+                    QFile::remove(files[i]);
+            }
+            throw;
+        }
+        written(documents, bytes);
+        writers.clear();
+
+        if (!options.separateFiles) {
+            ExportWriter::mergeParts(files, event->filePath, options);
+            bytes = QFileInfo(event->filePath).size();
+        }
+
+        reply(event->sender(), new ExportDocumentsResponse(this, event->exportId, documents, bytes, elapsedMsSince(started)));
+    }
+
+    std::vector<MongoDocumentPtr> MongoWorker::readPage(unsigned long long cursorKey, 
+                                                        const MongoQueryInfo &info)
+    {
+        // Connection first: (re)connect closes all paged cursors
+        boost::scoped_ptr<MongoClient> client { queryClient(info) };
+        auto const now = std::chrono::steady_clock::now();
+        PagedCursor &paged = _pagedCursors[cursorKey];
+        paged.lastUse = now;
+
+        // Part shows another query now (i.e. edited in place)
+        if (!isSameQuery(paged.query, info)) {
+            paged = PagedCursor();
+            paged.query = info;
+            paged.lastUse = now;
+        }
+
+        if (info._limit == -1)   // nothing to load, see OutputItemContentWidget::pageInfo()
+            return {};
+
+        int const idDirection = idSortDirection(info._query);
+        bool const continued = paged.cursor && paged.position == info._skip;
+        if (!continued) {
+            // Cursor is not limited, pages limit themselves
+            MongoQueryInfo open = info;
+            open._limit = 0;
+
+            // Descending bound is exclusive, the page start itself must be before skip
+            auto start = paged.pageStarts.upper_bound(idDirection > 0 ? info._skip : info._skip - 1);
+            if (idDirection != 0 && start != paged.pageStarts.begin()) {
+                --start;
+                mongo::BSONObj const bounded = withIdBound(info._query, start->second, idDirection);
+                if (!bounded.isEmpty()) {
+                    open._query = bounded;
+                    open._skip = info._skip - start->first - (idDirection > 0 ? 0 : 1);
+                }
+            }
+
+            paged.cursor = client->openCursor(open);
+            paged.position = info._skip;
+        }
+
+        std::string const batchKey = MongoClient::batchSizeKey(info);
+        std::vector<MongoDocumentPtr> docs;
+        std::vector<mongo::BSONObj> views;
+        try {
+            while (static_cast<int>(docs.size()) < info._limit && MongoClient::more(*paged.cursor, batchKey)) {
+                // Views into batch of cursor are copied to one slab before next getMore
+                do {
+                    views.push_back(paged.cursor->next());
+                } while (static_cast<int>(docs.size() + views.size()) < info._limit &&
+                         paged.cursor->moreInCurrentBatch());
+
+                std::vector<MongoDocumentPtr> const batch = MongoDocument::fromBatch(views);
+                docs.insert(docs.end(), batch.begin(), batch.end());
+                views.clear();
+            }
+        }
+        catch (const std::exception &) {
+            // Server drops idle cursors (after 10 minutes by default), page is read again from start
+            paged.cursor.reset();
+            if (!continued)
+                throw;
+
+            return readPage(cursorKey, info);
+        }
+
+        if (idDirection != 0 && !docs.empty()) {
+            mongo::BSONElement const id = docs.front()->bsonObj()["_id"];
+            if (!id.eoo())
+                paged.pageStarts[info._skip] = id.wrap();
+        }
+
+        paged.position += static_cast<int>(docs.size());
+        if (!MongoClient::more(*paged.cursor, batchKey))
+            paged.cursor.reset();
+
+        // Every cursor holds resources on server, the least recently used ones are closed
+        if (_pagedCursors.size() > MaxPagedCursors) {
+            auto oldest = std::min_element(_pagedCursors.begin(), _pagedCursors.end(),
+                [](const auto &left, const auto &right) { return left.second.lastUse < right.second.lastUse; });
+            _pagedCursors.erase(oldest);
+        }
+
+        return docs;
+    }
+
+    void MongoWorker::handle(AggregatePageRequest *event)
+    {
+        if (parkWhileDown(event))
+            return;
+
+        try {
+            ActiveClientsScope const activeClients(this, { driverClientAddress() });
+            std::vector<MongoDocumentPtr> const docs = 
+                readAggregationPage(event->cursorKey, event->aggrInfo, event->reread);
+            EventTrace::markCurrent("aggregation page read");
+            reply(event->sender(), new AggregatePageResponse(this, event->resultIndex, event->aggrInfo, docs));
+        }
+        catch (const std::exception &ex) {
+            _pagedAggregations.erase(event->cursorKey);
+            reply(event->sender(), new AggregatePageResponse(this, event->resultIndex, EventError(ex.what())));
+            sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
+        }
+    }
+
+    void MongoWorker::handle(PipelinePreviewRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+
+        try {
+            AggrInfo const &info = event->aggrInfo;
+            if (info.dbName.empty())
+                throw std::runtime_error("Database of aggregation is unknown, run the script again");
+
+            std::vector<mongo::BSONObj> const stages = PipelinePreview::previewedStages(info.pipeline);
+            if (stages.empty())
+                throw std::runtime_error("Pipeline has no stages to preview ($out and $merge are not run)");
+
+            std::vector<PipelinePreview::StageResult> results(stages.size());
+            for (size_t i = 0; i < stages.size(); ++i) {
+                results[i].name = stages[i].firstElementFieldName();
+                results[i].stage = BsonUtils::jsonString(stages[i], mongo::TenGen, 0, DefaultEncoding, Utc);
+            }
+
+            MongoNamespace const ns(info.dbName, info.collectionName);
+            mongo::BSONObj const options = withMaxTime(PipelinePreview::previewOptions(info.options), 
+                                                       info.maxTimeMs);
+
+            // Every prefix has its own result, failed one does not stop the others
+            runOnExtraConnections(stages.size(), MaxPreviewConcurrency, [&](const ConnectionItem &item) {
+                PipelinePreview::StageResult &result = results[item.index];
+                auto const stageStarted = std::chrono::steady_clock::now();
+                try {
+                    MongoClient client(item.connection, nullptr, _connSettings);
+                    std::vector<MongoDocumentPtr> const docs = client.aggregate(
+                        ns, PipelinePreview::prefixPipeline(stages, item.index + 1, event->sampleSize), 
+                        options, 1);
+                    if (!docs.empty())
+                        PipelinePreview::readResult(docs.front()->bsonObj(), result);
+                }
+                catch (const std::exception &ex) {
+                    result.error = ex.what();
+                }
+                result.elapsedMs = elapsedMsSince(stageStarted);
+            });
+
+            EventTrace::markCurrent("pipeline preview");
+            reply(event->sender(), new PipelinePreviewResponse(this, info, std::move(results), 
+                                                               event->sampleSize, elapsedMsSince(started)));
+        }
+        catch (const std::exception &ex) {
+            reply(event->sender(), new PipelinePreviewResponse(this, event->aggrInfo, EventError(ex.what())));
+            sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
+        }
+    }
+
+    void MongoWorker::handle(FieldDistributionRequest *event)
+    {
+        if (parkWhileDown(event))
+            return;
+
+        auto const started = std::chrono::steady_clock::now();
+        try {
+            // Query may be wrapped as { $query: ..., $orderby: ... }, only filter matters
+            MongoQueryInfo const &info = event->queryInfo;
+            mongo::BSONArray const pipeline = FieldDistribution::pipeline(
+                mongo::Query(info._query).getFilter(), event->field, event->topCount, event->sampleSize);
+
+            ActiveClientsScope const activeClients(this, { driverClientAddress() });
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            std::vector<MongoDocumentPtr> const docs = client->aggregate(MongoNamespace(info._info._ns), 
+                pipeline, BSON("maxTimeMS" << event->maxTimeMs), 1);
+            client->done();
+
+            FieldDistribution::Result result;
+            result.field = event->field;
+            if (!docs.empty())
+                FieldDistribution::readResult(docs.front()->bsonObj(), result);
+
+            long long const elapsedMs = elapsedMsSince(started);
+            EventTrace::markCurrent("field distribution");
+            reply(event->sender(), new FieldDistributionResponse(this, info, std::move(result), 
+                                                                 event->sampleSize, elapsedMs));
+        }
+        catch (const std::exception &ex) {
+            reply(event->sender(), new FieldDistributionResponse(this, event->queryInfo, EventError(ex.what())));
+            sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
+        }
+    }
+
+    void MongoWorker::handle(FieldBucketsRequest *event)
+    {
+        if (parkWhileDown(event))
+            return;
+
+        auto const started = std::chrono::steady_clock::now();
+        try {
+            MongoQueryInfo const &info = event->queryInfo;
+            mongo::BSONObj const filter = mongo::Query(info._query).getFilter();
+            mongo::BSONObj const options = BSON("maxTimeMS" << event->maxTimeMs << "allowDiskUse" << true);
+
+            ActiveClientsScope const activeClients(this, { driverClientAddress() });
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            std::vector<MongoDocumentPtr> docs;
+            try {
+                docs = client->aggregate(MongoNamespace(info._info._ns),
+                    FieldBuckets::pipeline(filter, event->field, event->spec), options,
+                    FieldBuckets::MaxDateBuckets + 1);
+            }
+            catch (const std::exception &ex) {
+                // $dateTrunc is new in MongoDB 5.0, older servers truncate dates with $dateFromParts
+                if (event->spec.kind != FieldBuckets::Kind::Dates ||
+                    std::string(ex.what()).find("$dateTrunc") == std::string::npos)
+                    throw;
+
+                docs = client->aggregate(MongoNamespace(info._info._ns),
+                    FieldBuckets::pipeline(filter, event->field, event->spec, true), options,
+                    FieldBuckets::MaxDateBuckets + 1);
+            }
+            client->done();
+
+            FieldBuckets::Result result;
+            result.field = event->field;
+            result.spec = event->spec;
+            std::vector<mongo::BSONObj> objects;
+            objects.reserve(docs.size());
+            for (MongoDocumentPtr const &doc : docs)
+                objects.push_back(doc->bsonObj());
+            FieldBuckets::readResult(objects, result);
+
+            long long const elapsedMs = elapsedMsSince(started);
+            EventTrace::markCurrent("field buckets");
+            reply(event->sender(), new FieldBucketsResponse(this, event->bucketsId, std::move(result), elapsedMs));
+        }
+        catch (const std::exception &ex) {
+            reply(event->sender(), new FieldBucketsResponse(this, event->bucketsId, EventError(ex.what())));
+            sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
+        }
+    }
+
+    std::vector<MongoDocumentPtr> MongoWorker::readAggregationPage(unsigned long long cursorKey,
+                                                                   const AggrInfo &info, bool reread)
+    {
+        if (info.dbName.empty())
+            throw std::runtime_error("Database of aggregation is unknown, run the script again");
+
+        // Connection first: (re)connect forgets all paged cursors
+        boost::scoped_ptr<MongoClient> client { getClient() };
+        PagedAggregation &paged = _pagedAggregations[cursorKey];
+        paged.lastUse = std::chrono::steady_clock::now();
+
+        // Part shows another aggregation now, or its current results are wanted
+        if (reread || !isSameAggregation(paged.aggregation, info)) {
+            if (paged.cursorId != 0)
+                client->killCursor(MongoNamespace(paged.aggregation.dbName, paged.aggregation.collectionName),
+                                   paged.cursorId);
+            paged.cursorId = 0;
+            paged.aggregation = info;
+        }
+
+        MongoNamespace const ns(info.dbName, info.collectionName);
+        std::vector<MongoDocumentPtr> docs;
+        bool const continued = paged.cursorId != 0 && paged.position <= info.skip;
+        if (!continued) {
+            if (paged.cursorId != 0)
+                client->killCursor(ns, paged.cursorId);
+
+            // Server skips documents before the page, the rest waits in cursor for next pages
+            mongo::BSONArrayBuilder pipeline;
+            for (mongo::BSONObjIterator it(info.pipeline); it.more();)
+                pipeline.append(it.next());
+            if (info.skip > 0)
+                pipeline.append(BSON("$skip" << info.skip));
+
+            paged.cursorId = 0;
+            docs = client->openAggregation(ns, pipeline.arr(), withMaxTime(info.options, info.maxTimeMs), 
+                                           info.batchSize, paged.cursorId);
+            paged.position = info.skip + static_cast<int>(docs.size());
+        }
+
+        try {
+            // Skip was moved forward by hand: documents before the page are read and dropped
+            while (continued && paged.position < info.skip && paged.cursorId != 0)
+                paged.position += static_cast<int>(client->getMore(ns, paged.cursorId, info.skip - paged.position).size());
+
+            while (static_cast<int>(docs.size()) < info.batchSize && paged.cursorId != 0) {
+                std::vector<MongoDocumentPtr> const more = 
+                    client->getMore(ns, paged.cursorId, info.batchSize - static_cast<int>(docs.size()));
+                paged.position += static_cast<int>(more.size());
+                docs.insert(docs.end(), more.begin(), more.end());
+            }
+        }
+        catch (const std::exception &) {
+            // Server drops idle cursors (after 10 minutes by default), pipeline runs again then
+            paged.cursorId = 0;
+            if (!continued)
+                throw;
+
+            return readAggregationPage(cursorKey, info, false);
+        }
+
+        // Every cursor holds resources on server, the least recently used ones are closed
+        if (_pagedAggregations.size() > MaxPagedCursors) {
+            auto oldest = std::min_element(_pagedAggregations.begin(), _pagedAggregations.end(),
+                [](const auto &left, const auto &right) { return left.second.lastUse < right.second.lastUse; });
+            if (oldest->second.cursorId != 0)
+                client->killCursor(MongoNamespace(oldest->second.aggregation.dbName, 
+                                                  oldest->second.aggregation.collectionName),
+                                   oldest->second.cursorId);
+            _pagedAggregations.erase(oldest);
+        }
+
+        client->done();
+        return docs;
+    }
+
+    /**
+     * @brief Execute javascript
+     */
+    void MongoWorker::handle(ExecuteScriptRequest *event)
+    {        
+        if (parkWhileDown(event))
+            return;
+
+        _lastActivity = std::chrono::steady_clock::now();
+        try {           
+            if(!_hasScriptEngine ||
+               (_connSettings->isReplicaSet() && !_dbclientRepSet)) {
+                auto const error{
+                    EventError("MongoDB Shell was not initialized or connection failure")
+                };
+                reply(event->sender(), new ExecuteScriptResponse(this, error));
+                return;
+            }
+
+            // Not parked (or waited for reconnect in vain): shell would wait for timeouts
+            if (_health.isDown()) {
+                reply(event->sender(), new ExecuteScriptResponse(this, EventError(_health.describe())));
+                return;
+            }
+
+            // Benchmark is run by worker only, shell has no .benchmark() of cursor
+            NativeQuery benchmarked;
+            int iterations = 0;
+            int concurrency = 0;
+            if (!event->profile &&
+                NativeQuery::parseBenchmark(event->script, benchmarked, iterations, concurrency)) {
+                try {
+                    reply(event->sender(), new ExecuteScriptResponse(
+                        this, execBenchmark(benchmarked, iterations, concurrency, event), false));
+                }
+                catch (const std::exception &ex) {
+                    reply(event->sender(), new ExecuteScriptResponse(this, EventError(ex.what())));
+                }
+                return;
+            }
+
+            // Queries generated by Robomongo (i.e. when collection is opened) are run with
+            // driver connection. Explain of profiling mode is done by shell only, and so is
+            // aggregation with read preference of tab (driver query takes it, command not).
+            // Queries of templates come compiled, their script is not parsed.
+            NativeQuery native;
+            bool isNative = event->nativeQuery != nullptr;
+            if (isNative)
+                native = *event->nativeQuery;
+            else
+                isNative = NativeQuery::parse(event->script, native);
+            if (!event->profile && isNative &&
+                (native.kind == NativeQuery::Find || event->readPreference.isDefault())) {
+                try {
+                    ActiveClientsScope const activeClients(this, { driverClientAddress() });
+                    reply(event->sender(), 
+                          new ExecuteScriptResponse(this, execNativeQuery(native, event), false));
+                    return;
+                }
+                catch (const std::exception &ex) {
+                    // Time limit is not spent on server once more by shell
+                    if (EventError::isServerTimeLimitExceeded(ex.what())) {
+                        reply(event->sender(), new ExecuteScriptResponse(this, EventError(ex.what())));
+                        return;
+                    }
+
+                    // Shell runs it once more and reports error in its usual way
+                    sendLog(this, LogEvent::RBM_DEBUG, "Native query failed: " + std::string(ex.what()));
+                }
+            }
+
+            // Opt-in: reports of several independent reads are read at once with side
+            // connections. On failure, shell runs them once more one by one, nothing was written.
+            std::vector<std::string> statements;
+            std::vector<NativeQuery> reads;
+            if (event->parallelReads && !event->profile && !event->aggrInfo.isValid &&
+                event->readPreference.isDefault() && NativeQuery::parseReads(event->script, statements, reads)) {
+                try {
+                    reply(event->sender(),
+                          new ExecuteScriptResponse(this, execParallelReads(statements, reads, event), false));
+                    return;
+                }
+                catch (const std::exception &ex) {
+                    if (EventError::isServerTimeLimitExceeded(ex.what())) {
+                        reply(event->sender(), new ExecuteScriptResponse(this, EventError(ex.what())));
+                        return;
+                    }
+                    sendLog(this, LogEvent::RBM_DEBUG, "Parallel reads failed: " + std::string(ex.what()));
+                }
+            }
+
+            // Shell is created by the first script, which is not run natively
+            scriptEngine();
+
+            // Try to handle case where new shell (which was opened when server unreachable) 
+            // was re-executed
+            if (_scriptEngine->failedScope()) {
+                try {
+                    _scriptEngine->init(_isLoadMongoRcJs);
+                }
+                catch (std::exception const& ex) {
+                    sendLog(this, LogEvent::RBM_ERROR, 
+                        captilizeFirstChar(ex.what()) + ", cannot init mongo scope");
+                }
+            }
+
+            // Shell and driver connections are both used by user scripts (i.e. db.coll.find() 
+            // goes through the shell connection, explorer helpers through the driver one)
+            ActiveClientsScope const activeClients(
+                this, { _scriptEngine->clientAddress(), driverClientAddress() });
+            _scriptEngine->setReadPreference(event->readPreference);
+            _scriptEngine->setMaxTimeMs(event->maxTimeMs);
+
+            // todo: should we use dbName from event or _connSettings? 
+            MongoShellExecResult result {
+                _scriptEngine->exec(
+                    event->script, _connSettings->defaultDatabase(), event->aggrInfo, event->profile
+                )
+            };
+            EventTrace::markCurrent("shell exec");
+
+            // Shells of other tabs list collections again, before they complete names
+            if (CollectionNamesVersion::mayChangeNames(event->script))
+                CollectionNamesVersion::bump(_connSettings->uuid());
+
+            // To fix the problem where 'result' comes with old primary address.
+            if (_connSettings->isReplicaSet()) 
+                result.setCurrentServer(
+                    _dbclientRepSet->getSuspectedPrimaryHostAndPort().toString()
+                );
+
+            if (!result.error()) {                
+                bool const timeoutReached = result.timeoutReached(); // todo: rename to shellTimeout...
+                reply(
+                    event->sender(),
+                    new ExecuteScriptResponse(this, std::move(result), event->script.empty(), timeoutReached)
+                );
+                return;
+            }
+
+            // Script ran out of JavaScript heap: running it again would only do the same,
+            // scope is created again by the next request
+            if (_scriptEngine->failedScope()) {
+                reply(event->sender(), new ExecuteScriptResponse(this, EventError(result.errorMessage())));
+                return;
+            }
+
+            retry(event);
+        } 
+        catch(const std::exception &ex) {
+            auto const error { EventError(ex.what(), EventError::Unknown) };
+            reply(event->sender(), new ExecuteScriptResponse(this, error));
+            sendLog(this, LogEvent::RBM_ERROR, ex.what());
+        }
+    }
+
+    void MongoWorker::handle(ExecuteScriptFileRequest *event)
+    {
+        _lastActivity = std::chrono::steady_clock::now();
+        try {
+            if(!_hasScriptEngine ||
+               (_connSettings->isReplicaSet() && !_dbclientRepSet)) {
+                auto const error{
+                    EventError("MongoDB Shell was not initialized or connection failure")
+                };
+                reply(event->sender(), new ExecuteScriptResponse(this, error));
+                return;
+            }
+
+            scriptEngine();
+            if (_scriptEngine->failedScope())
+                _scriptEngine->init(_isLoadMongoRcJs);
+
+            ActiveClientsScope const activeClients(
+                this, { _scriptEngine->clientAddress(), driverClientAddress() });
+            _scriptEngine->setReadPreference(event->readPreference);
+            _scriptEngine->setMaxTimeMs(event->maxTimeMs);
+
+            QObject *const sender = event->sender();
+            MongoShellExecResult result {
+                _scriptEngine->execFile(event->filePath, _connSettings->defaultDatabase(),
+                    [this, sender](qint64 done, qint64 total, long long statements) {
+                        reply(sender, new ExecuteScriptFileProgressEvent(this, done, total, statements));
+                    })
+            };
+            EventTrace::markCurrent("shell exec file");
+
+            // Data-fix scripts may create and drop collections
+            CollectionNamesVersion::bump(_connSettings->uuid());
+
+            if (_connSettings->isReplicaSet())
+                result.setCurrentServer(_dbclientRepSet->getSuspectedPrimaryHostAndPort().toString());
+
+            if (result.error()) {
+                reply(event->sender(), new ExecuteScriptResponse(this, EventError(result.errorMessage())));
+                return;
+            }
+
+            bool const timeoutReached = result.timeoutReached();
+            reply(event->sender(), new ExecuteScriptResponse(this, std::move(result), false, timeoutReached));
+        }
+        catch(const std::exception &ex) {
+            reply(event->sender(), new ExecuteScriptResponse(this, EventError(ex.what(), EventError::Unknown)));
+            sendLog(this, LogEvent::RBM_ERROR, ex.what());
+        }
+    }
+
+    MongoShellExecResult MongoWorker::execNativeQuery(const NativeQuery &native, 
+                                                      const ExecuteScriptRequest *event)
+    {
+        std::string const serverAddress = primaryAddress();
+
+        // Finds may go to nearest member of tab's read preference, see queryClient()
+        MongoQueryInfo readInfo;
+        readInfo._readPreference = event->readPreference;
+        boost::scoped_ptr<MongoClient> client {
+            native.kind == NativeQuery::Find ? queryClient(readInfo) : getClient()
+        };
+        std::vector<MongoShellResult> results = readNative(*client, native, event->script, serverAddress, event);
+        client->done();
+        EventTrace::markCurrent("native query");
+
+        std::string const dbName = _connSettings->defaultDatabase();
+        return MongoShellExecResult(std::move(results), serverAddress, true, dbName, true);
+    }
+
+    MongoShellExecResult MongoWorker::execParallelReads(const std::vector<std::string> &statements,
+                                                        const std::vector<NativeQuery> &queries,
+                                                        const ExecuteScriptRequest *event)
+    {
+        std::string const serverAddress = primaryAddress();
+        std::vector<std::vector<MongoShellResult>> results(queries.size());
+
+        std::mutex errorMutex;
+        std::string error;
+        std::atomic<bool> failed { false };
+        std::atomic<size_t> next { 0 };
+
+        // Every thread takes the next unread statement, until all of them are read
+        std::vector<std::thread> threads;
+        size_t const threadCount = std::min(queries.size(), MaxParallelReads);
+        for (size_t t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&]() {
+                try {
+                    std::unique_ptr<mongo::DBClientBase> connection = takeSideConnection();
+                    MongoClient client(connection.get(), &_capabilities, _connSettings);
+                    for (size_t i = next++; i < queries.size() && !failed; i = next++)
+                        results[i] = readNative(client, queries[i], statements[i], serverAddress, event);
+                    putSideConnection(std::move(connection));
+                }
+                catch (const std::exception &ex) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!failed.exchange(true))
+                        error = ex.what();
+                }
+            });
+        }
+        for (std::thread &thread : threads)
+            thread.join();
+        EventTrace::markCurrent("parallel reads");
+
+        if (failed)
+            throw std::runtime_error(error);
+
+        std::vector<MongoShellResult> ordered;
+        for (std::vector<MongoShellResult> &statementResults : results)
+            std::move(statementResults.begin(), statementResults.end(), std::back_inserter(ordered));
+
+        std::string const dbName = _connSettings->defaultDatabase();
+        return MongoShellExecResult(std::move(ordered), serverAddress, true, dbName, true);
+    }
+
+    MongoShellExecResult MongoWorker::execBenchmark(const NativeQuery &query, int iterations, int concurrency,
+                                                    const ExecuteScriptRequest *event)
+    {
+        if (iterations > QueryBenchmark::MaxIterations || concurrency > QueryBenchmark::MaxConcurrency)
+            throw std::runtime_error("Benchmark runs at most " + std::to_string(QueryBenchmark::MaxIterations) +
+                                     " iterations on " + std::to_string(QueryBenchmark::MaxConcurrency) +
+                                     " connections");
+
+        std::string const dbName = _connSettings->defaultDatabase();
+        mongo::BSONObj const command = QueryBenchmark::command(query, event->maxTimeMs);
+        int const options = event->readPreference.isDefault() ? 0 : mongo::QueryOption_SlaveOk;
+        int const threadCount = std::min(concurrency, iterations);
+        _benchmarkStopped = false;
+
+        // Connections are taken before timing starts, so that handshakes are not measured
+        std::vector<std::unique_ptr<mongo::DBClientBase>> connections;
+        for (int i = 0; i < threadCount; ++i)
+            connections.push_back(takeSideConnection());
+
+        std::vector<QueryBenchmark::Result> results(threadCount);
+        std::atomic<int> next { 0 };
+        auto const started = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threadCount; ++i) {
+            threads.emplace_back([&, i]() {
+                mongo::DBClientBase *const connection = connections[i].get();
+                while (next++ < iterations && !_benchmarkStopped) {
+                    auto const iterationStarted = std::chrono::steady_clock::now();
+                    long long serverUs = 0;
+                    long long documents = 0;
+                    long long cursorId = 0;
+                    std::string error;
+
+                    // Round trips of iteration, reading of documents is client time only
+                    auto const run = [&](const mongo::BSONObj &cmd) {
+                        mongo::BSONObj info;
+                        auto const sent = std::chrono::steady_clock::now();
+                        bool const ok = connection->runCommand(dbName, cmd, info, options);
+                        serverUs += std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - sent).count();
+                        if (!ok) {
+                            std::string const errmsg = info.getStringField("errmsg");
+                            throw std::runtime_error(errmsg.empty() ? "Command failed" : errmsg);
+                        }
+                        return info.getObjectField("cursor").getOwned();
+                    };
+
+                    try {
+                        mongo::BSONObj cursor = run(command);
+                        documents += cursor.getObjectField("firstBatch").nFields();
+                        cursorId = cursor["id"].safeNumberLong();
+                        while (cursorId != 0 && !_benchmarkStopped) {
+                            cursor = run(BSON("getMore" << cursorId << "collection" << query.collection));
+                            documents += cursor.getObjectField("nextBatch").nFields();
+                            cursorId = cursor["id"].safeNumberLong();
+                        }
+                    }
+                    catch (const std::exception &ex) {
+                        error = ex.what();
+                    }
+
+                    long long const clientUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - iterationStarted).count();
+                    results[i].add(clientUs, serverUs, documents, error);
+
+                    // Cursor of stopped iteration is not read further
+                    if (cursorId != 0) {
+                        try {
+                            connection->killCursor(mongo::NamespaceString(dbName, query.collection), cursorId);
+                        }
+                        catch (const std::exception &) {
+                            // Cursor times out on server
+                        }
+                    }
+
+                    // I.e. network error, the other connections continue
+                    if (connection->isFailed())
+                        break;
+                }
+            });
+        }
+        for (std::thread &thread : threads)
+            thread.join();
+
+        QueryBenchmark::Result result;
+        for (QueryBenchmark::Result const &threadResult : results)
+            result.merge(threadResult);
+        result.concurrency = threadCount;
+        result.elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started).count();
+
+        for (std::unique_ptr<mongo::DBClientBase> &connection : connections) {
+            if (!connection->isFailed())
+                putSideConnection(std::move(connection));
+        }
+
+        if (result.errors > 0 && result.errors == result.iterations)
+            throw std::runtime_error(result.firstError);
+
+        std::string const statement = event->script;
+        std::vector<MongoShellResult> shown;
+        shown.emplace_back("", "", MongoDocument::fromBsonObj(std::vector<mongo::BSONObj>{ result.toBson(statement) }),
+                           MongoQueryInfo(), statement, result.elapsedUs / 1000);
+        return MongoShellExecResult(std::move(shown), primaryAddress(), true, dbName, true);
+    }
+
+    std::vector<MongoShellResult> MongoWorker::readNative(MongoClient &client, const NativeQuery &native,
+                                                          const std::string &statement,
+                                                          const std::string &serverAddress,
+                                                          const ExecuteScriptRequest *event)
+    {
+        auto const start = std::chrono::steady_clock::now();
+        std::string const dbName = _connSettings->defaultDatabase();
+
+        std::vector<MongoShellResult> results;
+        if (native.kind == NativeQuery::Find) {
+            // Same info as ScriptEngine::prepareResult() takes from DBQuery, and the same 
+            // first batch as shell prints (DBQuery.shellBatchSize)
+            MongoQueryInfo info { CollectionInfo(serverAddress, dbName, native.collection),
+                                  native.filter, native.projection, 0, 0, 0, 0, false };
+            info._readPreference = event->readPreference;
+            info._maxTimeMs = event->maxTimeMs;
+            MongoQueryInfo firstBatch = info;
+            firstBatch._limit = firstBatch._batchSize = _batchSize;
+
+            // Collection opened from explorer may have been read ahead while it was focused
+            std::vector<MongoDocumentPtr> docs;
+            bool const isPrefetched = native.filter.isEmpty() && native.projection.isEmpty() &&
+                event->readPreference.isDefault() &&
+                FirstPageCache::instance().take(QtUtils::toStdString(_connSettings->uuid()),
+                                                dbName + "." + native.collection, _batchSize, docs);
+            if (!isPrefetched)
+                docs = client.query(firstBatch);
+            qint64 const elapsedMs = elapsedMsSince(start);
+            if (!docs.empty())
+                results.emplace_back("", "", std::move(docs), info, statement, elapsedMs);
+        }
+        else {
+            AggrInfo const& aggrInfo = event->aggrInfo;
+            // Paging of aggregation runs modified pipeline, original one is kept, see prepareResult()
+            mongo::BSONObj const origPipeline = aggrInfo.isValid ? aggrInfo.pipeline : native.pipeline;
+            int const skip = aggrInfo.isValid ? aggrInfo.skip : 0;
+            int const batchSize = aggrInfo.isValid ? aggrInfo.batchSize : 50;
+            int const resultIndex = aggrInfo.isValid ? aggrInfo.resultIndex : -1;
+
+            std::vector<MongoDocumentPtr> docs = client.aggregate(
+                MongoNamespace(dbName, native.collection), native.pipeline, 
+                withMaxTime(native.options, event->maxTimeMs), _batchSize);
+            qint64 const elapsedMs = elapsedMsSince(start);
+            if (!docs.empty()) {
+                AggrInfo const newAggrInfo { native.collection, skip, batchSize, origPipeline, 
+                                             native.options, resultIndex, dbName };
+                results.emplace_back("", "", std::move(docs), MongoQueryInfo(), statement, 
+                                     elapsedMs, newAggrInfo);
+            }
+        }
+        return results;
+    }
+
+    std::string MongoWorker::primaryAddress() const
+    {
+        return _connSettings->isReplicaSet() && _dbclientRepSet ?
+            _dbclientRepSet->getSuspectedPrimaryHostAndPort().toString() : _connSettings->getFullAddress();
+    }
+
+    void MongoWorker::retry(ExecuteScriptRequest * event)
+    {
+        DriverMetrics::recordRetry(_connSettings, "script");
+
+        mongo::DBClientBase* mongodbClient {
+            _dbclient ? _dbclient.get() :
+            dynamic_cast<mongo::DBClientBase*>(_dbclientRepSet.get())
+        };
+
+        if (_health.isDown())
+            throw std::runtime_error(_health.describe());
+
+        if (!mongodbClient->isStillConnected())
+            mongodbClient->checkConnection();
+
+        MongoShellExecResult result {
+            scriptEngine()->exec(event->script, _connSettings->defaultDatabase())
+        };
+        if (result.error()) {
+            auto const error { EventError(result.errorMessage()) };
+            reply(event->sender(), new ExecuteScriptResponse(this, error));
+        }
+        else {
+            bool const timeoutReached = result.timeoutReached();
+            reply(
+                event->sender(),
+                new ExecuteScriptResponse(this, std::move(result), event->script.empty(), timeoutReached)
+            );
+        }
+    }
+
+    /**
+     * @brief Interrupt javascript execution
+     */
+    void MongoWorker::handle(StopScriptRequest *)
+    {
+        try {
+            if (!_scriptEngine) {
+                return;
+            }
+
+            _scriptEngine->interrupt();
+        } catch(const std::exception &ex) {
+            sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
+        }
+    }
+
+    void MongoWorker::handle(KillOperationsRequest *event)
+    {
+        try {
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            auto const killed = client->killClientOperations(event->clientAddresses);
+            client->done();
+            reply(event->sender(), new KillOperationsResponse(this, killed.first, killed.second));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new KillOperationsResponse(this, EventError(ex.what())));
+            sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
+        }
+    }
+
+    void MongoWorker::handle(CurrentOpsRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+        try {
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            std::vector<mongo::BSONObj> const ops = client->currentOps(event->filter, false, event->limit);
+            client->done();
+
+            long long const elapsedMs = elapsedMsSince(started);
+            reply(event->sender(), new CurrentOpsResponse(this, event->monitorId, ops, elapsedMs));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new CurrentOpsResponse(this, event->monitorId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(KillOpRequest *event)
+    {
+        int killed = 0;
+        std::vector<std::string> errors;
+        try {
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            for (mongo::BSONObj const &opid : event->opids) {
+                try {
+                    client->killOp(opid.getField("op"));
+                    ++killed;
+                } catch(const std::exception &ex) {
+                    errors.push_back(ex.what());
+                }
+            }
+            client->done();
+        } catch(const std::exception &ex) {
+            errors.push_back(ex.what());
+        }
+
+        for (auto const &error : errors)
+            sendLog(this, LogEvent::RBM_ERROR, error);
+        reply(event->sender(), new KillOpResponse(this, event->monitorId, killed, errors));
+    }
+
+    void MongoWorker::handle(ServerStatusRequest *event)
+    {
+        try {
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            mongo::BSONObj const status = client->serverStatusSample();
+            client->done();
+            reply(event->sender(), new ServerStatusResponse(this, event->monitorId, status));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new ServerStatusResponse(this, event->monitorId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(ProfileSummaryRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+        try {
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            int slowMs = 0;
+            int const level = client->profilingLevel(event->databaseName, slowMs);
+            std::vector<ProfileShapeInfo> const shapes = client->profileSummary(event->databaseName, 
+                event->sinceMs, event->minMillis, event->limit);
+            client->done();
+
+            long long const elapsedMs = elapsedMsSince(started);
+            reply(event->sender(), new ProfileSummaryResponse(this, event->summaryId, shapes, level, 
+                                                              slowMs, elapsedMs));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new ProfileSummaryResponse(this, event->summaryId, EventError(ex.what())));
+            sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
+        }
+    }
+
+    void MongoWorker::handle(PlanCacheRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+        try {
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            std::vector<PlanCacheEntryInfo> const entries = client->planCacheStats(event->ns, event->limit);
+            client->done();
+
+            long long const elapsedMs = elapsedMsSince(started);
+            reply(event->sender(), new PlanCacheResponse(this, event->cacheId, entries, elapsedMs));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new PlanCacheResponse(this, event->cacheId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(ShardDistributionRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+        try {
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            ShardDistribution::Snapshot const snapshot = client->shardDistribution(event->ns, event->sinceMs);
+            client->done();
+
+            long long const elapsedMs = elapsedMsSince(started);
+            reply(event->sender(), new ShardDistributionResponse(this, event->distributionId, snapshot, elapsedMs));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new ShardDistributionResponse(this, event->distributionId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(GridFsFilesRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+        try {
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            std::vector<GridFs::FileInfo> const files = client->gridFsFiles(event->dbName, event->bucket,
+                                                                            event->filename, event->limit);
+            client->done();
+
+            long long const elapsedMs = elapsedMsSince(started);
+            reply(event->sender(), new GridFsFilesResponse(this, event->listId, files, elapsedMs));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new GridFsFilesResponse(this, event->listId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::handle(GridFsTransferRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+        try {
+            GridFs::FileInfo const file = event->direction == GridFsTransferRequest::Download ? 
+                downloadGridFsFile(event, started) : uploadGridFsFile(event, started);
+
+            long long const elapsedMs = elapsedMsSince(started);
+            reply(event->sender(), new GridFsTransferResponse(this, event->transferId, file, elapsedMs));
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new GridFsTransferResponse(this, event->transferId, EventError(ex.what())));
+        }
+    }
+
+    void MongoWorker::transferGridFsRanges(GridFsTransferRequest *event, const GridFs::FileInfo &file,
+                                           const std::chrono::steady_clock::time_point &started,
+                                           const std::function<long long(mongo::DBClientBase *, const GridFs::Range &)> &transfer)
+    {
+        std::vector<GridFs::Range> const ranges = GridFs::ranges(file);
+        std::atomic<long long> bytes { 0 };
+
+        runOnExtraConnections(ranges.size(), MaxGridFsConcurrency, [&](const ConnectionItem &item) {
+            if (event->isCancelled())
+                throw std::runtime_error("Transfer cancelled.");
+            bytes += transfer(item.connection, ranges[item.index]);
+        }, [&]() {
+            reply(event->sender(), new GridFsTransferProgressEvent(this, event->transferId, bytes, 
+                                                                   file.length, elapsedMsSince(started)));
+        }, GridFsTransferProgressEvent::IntervalMs);
+    }
+
+    GridFs::FileInfo MongoWorker::downloadGridFsFile(GridFsTransferRequest *event, 
+                                                     const std::chrono::steady_clock::time_point &started)
+    {
+        GridFs::FileInfo const &file = event->file;
+        std::string const path = QtUtils::toStdString(event->filePath);
+
+        // File has its final size at once, ranges are written where they belong as they come
+        QFile target(event->filePath);
+        if (!target.open(QIODevice::WriteOnly | QIODevice::Truncate) || !target.resize(file.length))
+            throw std::runtime_error("Cannot write " + path + ": " + QtUtils::toStdString(target.errorString()));
+
+        mongo::NamespaceString const chunks(event->dbName, GridFs::chunksCollection(event->bucket));
+        std::mutex targetMutex;
+        try {
+            transferGridFsRanges(event, file, started, [&](mongo::DBClientBase *conn, const GridFs::Range &range) {
+                // Batch is limited to the range, so that memory is bounded by ranges in flight
+                std::unique_ptr<mongo::DBClientCursor> cursor = conn->query(
+                    chunks, mongo::Query(GridFs::rangeFilter(file, range)).sort("n"),
+                    static_cast<int>(range.end - range.first), 0, nullptr, mongo::QueryOption_SlaveOk);
+                if (!cursor)
+                    throw std::runtime_error("Network error while reading chunks of " + file.filename);
+
+                long long bytes = 0;
+                long long n = range.first;
+                for (; cursor->more(); ++n) {
+                    mongo::BSONObj const chunk = cursor->next();
+                    int size = 0;
+                    const char *data = GridFs::chunkData(file, n, chunk, size);
+
+                    std::lock_guard<std::mutex> lock(targetMutex);
+                    if (!target.seek(n * file.chunkSize) || target.write(data, size) != size)
+                        throw std::runtime_error("Cannot write " + path + ": " + 
+                                                 QtUtils::toStdString(target.errorString()));
+                    bytes += size;
+                }
+                if (n != range.end)
+                    throw std::runtime_error("Chunk " + std::to_string(n) + " of " + file.filename + " is missing.");
+                return bytes;
+            });
+
+            if (!target.flush())
+                throw std::runtime_error("Cannot write " + path + ": " + QtUtils::toStdString(target.errorString()));
+        }
+        catch (const std::exception &) {
+            // Partial file is not left behind
+            target.remove();
+            throw;
+        }
+        return file;
+    }
+
+    GridFs::FileInfo MongoWorker::uploadGridFsFile(GridFsTransferRequest *event, 
+                                                   const std::chrono::steady_clock::time_point &started)
     {
-        try {
-            boost::scoped_ptr<MongoClient> client(getClient());
+        std::string const path = QtUtils::toStdString(event->filePath);
+        QFile source(event->filePath);
+        if (!source.open(QIODevice::ReadOnly))
+            throw std::runtime_error("Cannot read " + path + ": " + QtUtils::toStdString(source.errorString()));
+
+        GridFs::FileInfo file = event->file;
+        file.id = BSON("_id" << mongo::OID::gen());
+        file.length = source.size();
+        file.chunkSize = GridFs::DefaultChunkSize;
+        if (file.filename.empty())
+            file.filename = QtUtils::toStdString(QFileInfo(event->filePath).fileName());
 
-            client->removeDocuments(event->ns(), event->query(), 
-                                    event->removeCount() == RemoveDocumentCount::ONE);
+        {
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            client->ensureGridFsIndexes(event->dbName, event->bucket);
             client->done();
+        }
 
-            reply(event->sender(), new RemoveDocumentResponse(this, event->removeCount(), event->index()));
-        } 
-        catch(const std::exception &ex) {
-            reply(event->sender(), new RemoveDocumentResponse(this, EventError(ex.what()), 
-                event->removeCount(), event->index()));
-            // Logging handled in main thread
+        std::string const chunks = GridFs::chunksCollection(event->bucket);
+        std::mutex sourceMutex;
+        try {
+            transferGridFsRanges(event, file, started, [&](mongo::DBClientBase *conn, const GridFs::Range &range) {
+                long long const offset = range.first * file.chunkSize;
+                long long const size = std::min(file.length, range.end * file.chunkSize) - offset;
+
+                // Disk is read one range at a time, inserts of ranges overlap
+                QByteArray data;
+                {
+                    std::lock_guard<std::mutex> lock(sourceMutex);
+                    if (source.seek(offset))
+                        data = source.read(size);
+                }
+                if (data.size() != size)
+                    throw std::runtime_error("Cannot read " + path + ": " + QtUtils::toStdString(source.errorString()));
+
+                mongo::BSONObjBuilder command;
+                command.append("insert", chunks);
+                mongo::BSONArrayBuilder documents(command.subarrayStart("documents"));
+                for (long long n = range.first; n < range.end; ++n) {
+                    documents.append(GridFs::chunkDocument(file, n, data.constData() + (n - range.first) * file.chunkSize,
+                                                           GridFs::chunkLength(file, n)));
+                }
+                documents.done();
+
+                mongo::BSONObj result;
+                bool const ok = conn->runCommand(event->dbName, command.obj(), result);
+                if (!ok || result["writeErrors"].type() == mongo::Array) {
+                    std::string const error = ok ? result["writeErrors"].Obj().firstElement().Obj().getStringField("errmsg")
+                                                 : result.getStringField("errmsg");
+                    throw std::runtime_error("Failed to insert chunks of " + file.filename + ": " + error);
+                }
+                return size;
+            });
+
+            // Files document goes last, so that readers never see file with missing chunks
+            file.uploadDateMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            boost::scoped_ptr<MongoClient> client { getClient() };
+            client->insertDocument(GridFs::fileDocument(file), 
+                                   MongoNamespace(event->dbName, GridFs::filesCollection(event->bucket)));
+            client->done();
+        }
+        catch (const std::exception &) {
+            // Chunks of failed upload are removed, failure of removal does not hide the first error
+            try {
+                boost::scoped_ptr<MongoClient> client { getClient() };
+                mongo::BSONObjBuilder filter;
+                filter.appendAs(file.id.firstElement(), "files_id");
+                client->removeDocuments(MongoNamespace(event->dbName, chunks), mongo::Query(filter.obj()), false);
+                client->done();
+            }
+            catch (const std::exception &) {}
+            throw;
         }
+        return file;
     }
 
-    void MongoWorker::handle(ExecuteQueryRequest *event)
+    void MongoWorker::handle(ExplainRequest *event)
     {
-        auto const executeQuery = [&]() {
+        if (parkWhileDown(event))
+            return;
+
+        auto const started = std::chrono::steady_clock::now();
+        try {
             boost::scoped_ptr<MongoClient> client { getClient() };
-            std::vector<MongoDocumentPtr> docs = client->query(event->queryInfo());
+            mongo::BSONObj const explain = client->explain(event->databaseName, event->command);
             client->done();
-            reply(event->sender(),
-                new ExecuteQueryResponse(this, event->resultIndex(), event->queryInfo(), docs)
-            );
-        };
 
-        try {
-            executeQuery();
+            long long const elapsedMs = elapsedMsSince(started);
+            reply(event->sender(), new ExplainResponse(this, event->explainId, ExplainPlan::parse(explain), 
+                                                       explain, elapsedMs));
         } catch(const std::exception &ex) {
-            QString const NTORETURN_ERROR { "unrecognized field: 'ntoreturn'" };
-            bool const ntoreturnError { 
-                QString(ex.what()).compare(NTORETURN_ERROR, Qt::CaseInsensitive) == 0 
-            };
-            // If we have this DocumentDB specific error, try again
-            if (ntoreturnError && _dbclient) {
-                sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
-                try {
-                    _dbclient->tagAsDocDb(true);
-                    executeQuery();
-                    return;
-                } 
-                catch (const std::exception &ex) {
-                    sendLog(this, LogEvent::RBM_ERROR, "Re-try: " + std::string(ex.what()));
-                }
-            }
-
-            reply(event->sender(), new ExecuteQueryResponse(this, EventError(ex.what())));
+            reply(event->sender(), new ExplainResponse(this, event->explainId, EventError(ex.what())));
             sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
         }
     }
 
-    /**
-     * @brief Execute javascript
-     */
-    void MongoWorker::handle(ExecuteScriptRequest *event)
-    {        
-        try {           
-            if(!_scriptEngine ||
-               (_connSettings->isReplicaSet() && !_dbclientRepSet)) {
-                auto const error{
-                    EventError("MongoDB Shell was not initialized or connection failure")
-                };
-                reply(event->sender(), new ExecuteScriptResponse(this, error));
-                return;
-            }
+    void MongoWorker::handle(RollingIndexBuildRequest *event)
+    {
+        auto const started = std::chrono::steady_clock::now();
+        IndexInfo const &newInfo = event->newInfo;
+        MongoNamespace const ns = newInfo._collection.ns();
 
-            // Try to handle case where new shell (which was opened when server unreachable) 
-            // was re-executed
-            if (_scriptEngine->failedScope()) {
-                try {
-                    _scriptEngine->init(_isLoadMongoRcJs);
-                }
-                catch (std::exception const& ex) {
-                    sendLog(this, LogEvent::RBM_ERROR, 
-                        captilizeFirstChar(ex.what()) + ", cannot init mongo scope");
-                }
-            }
+        std::vector<RollingIndexBuild::Step> steps;
+        try {
+            steps = RollingIndexBuild::steps(event->oldInfo, newInfo);
+        } catch(const std::exception &ex) {
+            reply(event->sender(), new RollingIndexBuildResponse(this, event->oldInfo, newInfo, EventError(ex.what())));
+            return;
+        }
 
-            // todo: should we use dbName from event or _connSettings? 
-            MongoShellExecResult result {
-                _scriptEngine->exec(
-                    event->script, _connSettings->defaultDatabase(), event->aggrInfo
-                )
-            };
+        int const count = static_cast<int>(steps.size());
+        int current = 0;
+        try {
+            // Builds may take hours, so their connection has no socket timeout. Progress is 
+            // read with connection of this worker meanwhile.
+            std::unique_ptr<mongo::DBClientBase> connection = openExtraConnection(0);
+            boost::scoped_ptr<MongoClient> monitor { getClient() };
+
+            for (; current < count; ++current) {
+                RollingIndexBuild::Step const &step = steps[current];
+                std::string const description = RollingIndexBuild::describe(step);
+                reply(event->sender(), new RollingIndexBuildProgressEvent(this, newInfo, current, count, description));
+
+                MongoClient client(connection.get(), nullptr, _connSettings);
+                if (step.kind == RollingIndexBuild::Step::Drop) {
+                    client.dropIndexFromCollection(step.index._collection, step.index._name);
+                    continue;
+                }
 
-            // To fix the problem where 'result' comes with old primary address.
-            if (_connSettings->isReplicaSet()) 
-                result.setCurrentServer(
-                    _dbclientRepSet->getSuspectedPrimaryHostAndPort().toString()
-                );
+                std::string error;
+                std::atomic<bool> finished { false };
+                std::thread build([&]() {
+                    try {
+                        client.createIndex(step.index);
+                    } catch(const std::exception &ex) {
+                        error = ex.what();
+                    }
+                    finished = true;
+                });
+
+                auto lastProgress = std::chrono::steady_clock::now();
+                while (!finished) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(RollingIndexBuildProgressEvent::IntervalMs / 10));
+                    auto const now = std::chrono::steady_clock::now();
+                    if (now - lastProgress < std::chrono::milliseconds(RollingIndexBuildProgressEvent::IntervalMs))
+                        continue;
+
+                    lastProgress = now;
+                    long long done = 0, total = 0;
+                    try {
+                        if (monitor->indexBuildProgress(ns, step.index._name, done, total))
+                            reply(event->sender(), new RollingIndexBuildProgressEvent(this, newInfo, current, count, 
+                                                                                      description, done, total));
+                    } catch(const std::exception &) {
+                        // Progress is optional, build goes on without it (i.e. no inprog privilege)
+                    }
+                }
+                build.join();
 
-            if (!result.error()) {                
-                reply(
-                    event->sender(),
-                    new ExecuteScriptResponse(this, result, event->script.empty(), 
-                        result.timeoutReached()) // todo: rename to shellTimeout...
-                );
-                return;
+                if (!error.empty())
+                    throw std::runtime_error(error);
             }
+            monitor->done();
 
-            retry(event);
-        } 
-        catch(const std::exception &ex) {
-            auto const error { EventError(ex.what(), EventError::Unknown) };
-            reply(event->sender(), new ExecuteScriptResponse(this, error));
-            sendLog(this, LogEvent::RBM_ERROR, ex.what());
+            long long const elapsedMs = elapsedMsSince(started);
+            reply(event->sender(), new RollingIndexBuildResponse(this, event->oldInfo, newInfo, elapsedMs));
+        } catch(const std::exception &ex) {
+            // Done steps are not undone, the old or the temporary index still serves queries
+            std::string message = ex.what();
+            if (current < count)
+                message = RollingIndexBuild::describe(steps[current]) + " failed (step " + 
+                          std::to_string(current + 1) + " of " + std::to_string(count) + "). " + message;
+            reply(event->sender(), new RollingIndexBuildResponse(this, event->oldInfo, newInfo, EventError(message)));
+            sendLog(this, LogEvent::RBM_ERROR, message);
         }
     }
 
-    void MongoWorker::retry(ExecuteScriptRequest * event)
+    void MongoWorker::handle(ShardFanoutRequest *event)
     {
-        mongo::DBClientBase* mongodbClient {
-            _dbclient ? _dbclient.get() :
-            dynamic_cast<mongo::DBClientBase*>(_dbclientRepSet.get())
-        };
-
-        if (!mongodbClient->isStillConnected())
-            mongodbClient->checkConnection();
-
-        MongoShellExecResult const result {
-            _scriptEngine->exec(event->script, _connSettings->defaultDatabase())
-        };
-        if (result.error()) {
-            auto const error { EventError(result.errorMessage()) };
-            reply(event->sender(), new ExecuteScriptResponse(this, error));
-        }
-        else {
-            reply(
-                event->sender(),
-                new ExecuteScriptResponse(this, result, event->script.empty(),
-                    result.timeoutReached())
-            );
-        }
-    }
+        auto const started = std::chrono::steady_clock::now();
 
-    /**
-     * @brief Interrupt javascript execution
-     */
-    void MongoWorker::handle(StopScriptRequest *)
-    {
         try {
-            if (!_scriptEngine) {
-                return;
+            if (_connSettings->sshSettings()->enabled())
+                throw std::runtime_error("Shards cannot be queried directly through SSH tunnel.");
+
+            mongo::BSONObj shardKey;
+            std::vector<ShardFanout::Target> targets;
+            {
+                boost::scoped_ptr<MongoClient> client { getClient() };
+                targets = client->shardTargets(event->ns, shardKey);
+                client->done();
             }
 
-            _scriptEngine->interrupt();
+            // One connection per shard, opened here as in runOnExtraConnections()
+            std::vector<std::unique_ptr<mongo::DBClientBase>> connections;
+            for (auto const &target : targets)
+                connections.push_back(openShardConnection(target));
+
+            std::vector<ShardFanout::ShardResult> results(targets.size());
+            std::vector<std::vector<std::vector<mongo::BSONObj>>> streams(targets.size());
+
+            // Connection of every shard runs its own target
+            runOnConnections(std::move(connections), targets.size(), [&](const ConnectionItem &item) {
+                auto const shardStarted = std::chrono::steady_clock::now();
+                ShardFanout::ShardResult &result = results[item.index];
+                result.shard = targets[item.index].shard;
+                result.host = item.connection->getServerAddress();
+                result.ranges = targets[item.index].ranges.size();
+                try {
+                    MongoClient client(item.connection, nullptr, _connSettings);
+                    for (ShardFanout::Range const &range : targets[item.index].ranges) {
+                        if (item.stopped)
+                            break;
+
+                        // Owned chunks only, with index bounds as mongos routes them
+                        mongo::BSONObjBuilder query;
+                        query.append("$query", event->filter);
+                        query.append("$hint", shardKey);
+                        query.append("$min", range.min);
+                        query.append("$max", range.max);
+                        if (!event->sort.isEmpty())
+                            query.append("$orderby", event->sort);
+                        query.append("$comment", ShardFanout::Comment);
+
+                        MongoQueryInfo const info { 
+                            CollectionInfo(result.host, event->ns.databaseName(), event->ns.collectionName()),
+                            query.obj(), event->projection, event->limit, 0, 0,
+                            event->readFromSecondaries ? mongo::QueryOption_SlaveOk : 0, true };
+
+                        std::vector<mongo::BSONObj> docs;
+                        for (MongoDocumentPtr const &doc : client.query(info))
+                            docs.push_back(doc->bsonObj());
+                        result.documents += docs.size();
+                        streams[item.index].push_back(std::move(docs));
+                    }
+                }
+                catch (const std::exception &ex) {
+                    result.elapsedMs = elapsedMsSince(shardStarted);
+                    throw std::runtime_error("Shard " + result.shard + ": " + ex.what());
+                }
+                result.elapsedMs = elapsedMsSince(shardStarted);
+            });
+
+            std::vector<std::vector<mongo::BSONObj>> allStreams;
+            for (auto &shardStreams : streams)
+                std::move(shardStreams.begin(), shardStreams.end(), std::back_inserter(allStreams));
+
+            std::vector<MongoDocumentPtr> documents = MongoDocument::fromBsonObj(
+                ShardFanout::mergeSorted(allStreams, event->sort, event->limit));
+            reply(event->sender(), new ShardFanoutResponse(this, event->fanoutId, documents, results, 
+                                                           elapsedMsSince(started)));
         } catch(const std::exception &ex) {
+            reply(event->sender(), new ShardFanoutResponse(this, event->fanoutId, EventError(ex.what())));
             sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
         }
     }
@@ -702,7 +4114,7 @@ namespace Robomongo
     void MongoWorker::handle(AutocompleteRequest *event)
     {
         try {
-            if (!_scriptEngine) {
+            if (!scriptEngine()) {
                 reply(event->sender(), 
                     new AutocompleteResponse(this, EventError("MongoDB Shell was not initialized")));
                 return;
@@ -723,8 +4135,9 @@ namespace Robomongo
             boost::scoped_ptr<MongoClient> client(getClient());
             client->createDatabase(dbname);
 
-            // Insert to list of created database. Read docs for this hashset in the header
-            _createdDbs.insert(dbname);
+            // Listed until it exists on server, see CreatedDatabases
+            CreatedDatabases::add(_connSettings->uuid(), dbname);
+            CollectionNamesVersion::bump(_connSettings->uuid());
 
             reply(event->sender(), new CreateDatabaseResponse(this, dbname));
         } catch(const std::exception &ex) {
@@ -741,8 +4154,8 @@ namespace Robomongo
             boost::scoped_ptr<MongoClient> client(getClient());
             client->dropDatabase(event->database);
 
-            // Remove from the list of created database, Read docs for this hashset in the header
-            _createdDbs.erase(event->database);
+            CreatedDatabases::remove(_connSettings->uuid(), event->database);
+            CollectionNamesVersion::bump(_connSettings->uuid());
 
             reply(event->sender(), new DropDatabaseResponse(this, event->database));
         } 
@@ -763,6 +4176,7 @@ namespace Robomongo
             client->createCollection(event->ns().toString(), event->getSize(), event->getCapped(),
                 event->getMaxDocNum(), event->getExtraOptions());
             client->done();
+            CollectionNamesVersion::bump(_connSettings->uuid());
 
             reply(event->sender(), new CreateCollectionResponse(this, collection));
         } catch(const std::exception &ex) {
@@ -781,6 +4195,7 @@ namespace Robomongo
             boost::scoped_ptr<MongoClient> client(getClient());
             client->dropCollection(event->ns());
             client->done();
+            CollectionNamesVersion::bump(_connSettings->uuid());
 
             reply(event->sender(), new DropCollectionResponse(this, collection));
         } catch(const std::exception &ex) {
@@ -797,6 +4212,7 @@ namespace Robomongo
             boost::scoped_ptr<MongoClient> client(getClient());
             client->renameCollection(event->ns(), event->newCollection());
             client->done();
+            CollectionNamesVersion::bump(_connSettings->uuid());
 
             reply(event->sender(), new RenameCollectionResponse(this, event->ns().collectionName(),
                                                                 event->newCollection()));
@@ -814,6 +4230,7 @@ namespace Robomongo
             boost::scoped_ptr<MongoClient> client(getClient());
             client->duplicateCollection(event->ns(), event->newCollection());
             client->done();
+            CollectionNamesVersion::bump(_connSettings->uuid());
 
             reply(event->sender(), 
                 new DuplicateCollectionResponse(this, sourceCollection, event->newCollection())
@@ -829,20 +4246,80 @@ namespace Robomongo
     
     void MongoWorker::handle(CopyCollectionToDiffServerRequest *event)
     {
+        auto const started = std::chrono::steady_clock::now();
+
+        MongoNamespace const from = event->from();
+        MongoNamespace const to = event->to();
+        std::unique_ptr<BulkInserter> inserter;
         try {
+            // Worker of source server keeps serving its own requests, source is read with new
+            // connection instead of its _dbclient
+            std::unique_ptr<mongo::DBClientBase> source = event->worker()->openExtraConnection();
             boost::scoped_ptr<MongoClient> client(getClient());
-            MongoWorker *cl = event->worker();
-            client->copyCollectionToDiffServer(
-                cl->_dbclient.get(), event->from(), event->to()
-            );
+            if (!_dbclient->exists(to.toString()) && !client->createCollectionLike(source.get(), from, to)) {
+                client->done();
+                reply(event->sender(), new CopyCollectionToDiffServerResponse(this, to, 0, 0, elapsedMsSince(started), ""));
+                return;
+            }
+
+            mongo::BSONObj countResult;
+            source->runCommand(from.databaseName(), BSON("count" << from.collectionName()), countResult);
+            long long const total = countResult["n"].safeNumberLong();
+
+            // Documents of source have _id, so retried or repeated inserts fail with duplicate
+            // key and do not overwrite existing documents
+            std::vector<std::unique_ptr<mongo::DBClientBase>> connections;
+            for (int i = 0; i < CopyCollectionConnections; ++i)
+                connections.push_back(openExtraConnection());
+            inserter.reset(new BulkInserter(std::move(connections), to, false));
+
+            std::unique_ptr<mongo::DBClientCursor> cursor { 
+                source->query(mongo::NamespaceString(from.databaseName(), from.collectionName()), mongo::Query())
+            };
+            if (!cursor)
+                throw std::runtime_error("Network error while attempting to run query");
+
+            // Next batch is read while previous ones are inserted, push() waits for inserters
+            size_t const maxBatchCount = 1000;
+            int const maxBatchBytes = 8 * 1024 * 1024;
+            std::vector<mongo::BSONObj> batch;
+            int batchBytes = 0;
+            long long lastProgressMs = 0;
+            bool stopped = false;
+            while (!stopped && cursor->more()) {
+                mongo::BSONObj const obj = cursor->next().getOwned();
+                batchBytes += obj.objsize();
+                batch.push_back(obj);
+                if (batch.size() < maxBatchCount && batchBytes < maxBatchBytes && cursor->moreInCurrentBatch())
+                    continue;
+
+                stopped = !inserter->push(std::move(batch));
+                batch.clear();
+                batchBytes = 0;
+
+                long long const now = elapsedMsSince(started);
+                if (now - lastProgressMs >= CopyCollectionProgressEvent::IntervalMs) {
+                    lastProgressMs = now;
+                    reply(event->sender(), new CopyCollectionProgressEvent(this, to, inserter->inserted(),
+                        inserter->failed(), total, now));
+                }
+            }
+
+            if (!batch.empty())
+                inserter->push(std::move(batch));
+            inserter->finish();
+
+            client->copyIndexes(source.get(), from, to);
             client->done();
 
-            reply(event->sender(), new CopyCollectionToDiffServerResponse(this));
+            reply(event->sender(), new CopyCollectionToDiffServerResponse(this, to, inserter->inserted(),
+                inserter->failed(), elapsedMsSince(started), inserter->errors()));
         } catch(const std::exception &ex) {
-            reply(event->sender(), 
-                new CopyCollectionToDiffServerResponse(this, EventError(ex.what()))
-            );
-            sendLog(this, LogEvent::RBM_ERROR, std::string(ex.what()));
+            // Documents inserted until now are kept
+            if (inserter)
+                inserter->cancel();
+            reply(event->sender(), new CopyCollectionToDiffServerResponse(this, to,
+                inserter ? inserter->inserted() : 0, inserter ? inserter->failed() : 0, EventError(ex.what())));
         }
     }
 
@@ -885,7 +4362,7 @@ namespace Robomongo
         try {
             if (event->dbVersion() >= 3.4) {
                 auto const cmd = "db.system.js.save(" + event->function().toBson().toString() + ')';
-                MongoShellExecResult const& result = _scriptEngine->exec(cmd, event->database());
+                MongoShellExecResult const& result = scriptEngine()->exec(cmd, event->database());
                 if (result.error())
                     throw std::runtime_error(result.errorMessage());
             }
@@ -909,7 +4386,7 @@ namespace Robomongo
         try {
             if (event->dbVersion() >= 3.4) {
                 auto const cmd = "db.system.js.remove( { _id : \"" + event->functionName() + "\" } )";
-                MongoShellExecResult const& result = _scriptEngine->exec(cmd, event->database());
+                MongoShellExecResult const& result = scriptEngine()->exec(cmd, event->database());
                 if (result.error())
                     throw std::runtime_error(result.errorMessage());
             }
@@ -931,34 +4408,63 @@ namespace Robomongo
 
     std::pair<mongo::DBClientBase*, std::string> MongoWorker::getConnection(bool mayReturnNull /* = false */)
     {
-        configureSSL();
+        _lastActivity = std::chrono::steady_clock::now();
+
+        // Known-down server is not waited for, see markServerDown()
+        if (_health.isDown()) {
+            if (mayReturnNull)
+                return { nullptr, _health.describe() };
+            throw std::runtime_error(_health.describe());
+        }
+
+        TlsContext::Guard tls(*_tlsContext);
 
         // --- Perform connection ---
         if (_connSettings->isReplicaSet()) { // connection to replica set 
             if(_dbclientRepSet)
                 return { _dbclientRepSet.get(), "" };
 
-            init(); // Init mongoworker for early-use of _scriptEngine
+            init(); // Timers of replica set worker are started before its connection exists
 
             // Step-1: Use user entered set name or retrieve set name from cache or from a reachable member
-            std::string setName = _connSettings->replicaSetSettings()->setNameUserEntered();
+            ReplicaSetSettings *const repSetSettings = _connSettings->replicaSetSettings();
+            std::string setName = repSetSettings->setNameUserEntered();
             if (setName.empty()) {
-                setName = _connSettings->replicaSetSettings()->cachedSetName();
-                if (setName.empty()) // If there is no cached set name, get it from an on-line replica node
-                    setName = connectAndGetReplicaSetName();
+                // Discover set name from an on-line replica node, unless it was cached recently.
+                // Stale cached name is still used if no node answers.
+                setName = repSetSettings->cachedSetName();
+                if (!repSetSettings->isCachedTopologyFresh()) {
+                    std::string const discoveredSetName = connectAndGetReplicaSetName();
+                    if (!discoveredSetName.empty())
+                        setName = discoveredSetName;
+                }
 
                 if (setName.empty())   // It is not possible to continue with empty set name
                     return { nullptr, "It is not possible to continue with empty set name" };
             }
 
-            // Step-2: Try connect to replica set with set name
-            auto const& membersHostsAndPorts = _connSettings->replicaSetSettings()->membersToHostAndPort();
+            // Step-2: Try connect to replica set with set name, starting from the last known primary
+            auto membersHostsAndPorts = repSetSettings->membersToHostAndPort();
+            if (repSetSettings->isCachedTopologyFresh() && !repSetSettings->cachedPrimary().empty()) {
+                auto const primary = std::find(membersHostsAndPorts.begin(), membersHostsAndPorts.end(),
+                                               mongo::HostAndPort(repSetSettings->cachedPrimary()));
+                if (primary != membersHostsAndPorts.end())
+                    std::rotate(membersHostsAndPorts.begin(), primary, primary + 1);
+            }
+
+            _capabilities.clear();
+            _driverClientAddress.clear();
+            _pagedCursors.clear();
+            _pagedAggregations.clear();
             _dbclientRepSet.reset(new mongo::DBClientReplicaSet {
                  setName, membersHostsAndPorts, APP_NAME_VERSION, _mongoTimeoutSec                 
             });
+            DriverMetrics::install(_dbclientRepSet.get(), _connSettings);
                 
-            if (!_dbclientRepSet->connect()) 
+            if (!_dbclientRepSet->connect()) {
+                markServerDown("Connect failed");
                 return { nullptr, "Connect failed" };
+            }
             else 
                 return { _dbclientRepSet.get(), "" };
         }
@@ -968,65 +4474,288 @@ namespace Robomongo
             
             // Timeout for operations
             // Connect timeout is fixed, but short, at 5 seconds (see headers for DBClientConnection)
-            _dbclient.reset(new mongo::DBClientConnection { true, _mongoTimeoutSec });
-            mongo::Status const& status = _dbclient->connect(_connSettings->hostAndPort(), APP_NAME_VERSION);
-            if (!status.isOK() && mayReturnNull) 
-                return { nullptr, status.reason() };
-            else 
+            _capabilities.clear();
+            _driverClientAddress.clear();
+            _pagedCursors.clear();
+            _pagedAggregations.clear();
+
+            // Opened while record was selected in ConnectionsDialog
+            WarmConnections::Connection warm = WarmConnections::instance().take(_connSettings);
+            _warmAuthenticated = warm.authenticated;
+            if (warm.conn) {
+                _dbclient = std::move(warm.conn);
+                _dbclient->setSoTimeout(_mongoTimeoutSec);
                 return { _dbclient.get(), "" };
+            }
+
+            _dbclient.reset(new mongo::DBClientConnection { true, _mongoTimeoutSec });
+            WireCompression::configure(_dbclient.get(), _connSettings);
+            DriverMetrics::install(_dbclient.get(), _connSettings);
+            mongo::Status const& status = _dbclient->connect(connectAddress(_connSettings->hostAndPort()),
+                                                             APP_NAME_VERSION);
+            if (!status.isOK()) {
+                // Server may have moved, its name is looked up again on reconnect
+                HostResolver::instance().invalidate(_connSettings->serverHost());
+                markServerDown(status.reason());
+                if (mayReturnNull)
+                    return { nullptr, status.reason() };
+                throw std::runtime_error(_health.describe());
+            }
+            return { _dbclient.get(), "" };
         }
     }
 
     MongoClient *MongoWorker::getClient()
     {
-        return new MongoClient(getConnection().first);
+        return new MongoClient(getConnection().first, &_capabilities, _connSettings);
+    }
+
+    MongoClient *MongoWorker::queryClient(const MongoQueryInfo &info)
+    {
+        // Connection first: (re)connect closes all paged cursors
+        mongo::DBClientBase *const connection = getConnection().first;
+
+        ReadPreferenceInfo const& readPreference = info._readPreference;
+        if (readPreference._mode != ReadPreferenceInfo::Nearest || !readPreference._tags.isEmpty() ||
+            !_connSettings->isReplicaSet() || !_dbclientRepSet || _connSettings->sshSettings()->enabled())
+            return new MongoClient(connection, &_capabilities, _connSettings);
+
+        std::string const setName = _dbclientRepSet->getSetName();
+        std::string const nearest = MemberLatency::instance().nearest(setName);
+        if (nearest.empty())    // not measured yet, driver picks member by its own pings
+            return new MongoClient(connection, &_capabilities, _connSettings);
+
+        try {
+            mongo::DBClientConnection *const member = memberConnection(nearest);
+            if (nearest != _nearestMember) {
+                _nearestMember = nearest;
+                sendLog(this, LogEvent::RBM_INFO, "Nearest member of " + setName + " is " + nearest + " (" +
+                        std::to_string(static_cast<int>(MemberLatency::instance().smoothedMs(setName, nearest))) +
+                        " ms)");
+            }
+            return new MongoClient(member, &_capabilities, _connSettings);
+        }
+        catch (const std::exception &ex) {
+            MemberLatency::instance().addFailure(setName, nearest);
+            sendLog(this, LogEvent::RBM_WARN, "Cannot connect to nearest member " + nearest + ". " + ex.what());
+            return new MongoClient(connection, &_capabilities, _connSettings);
+        }
+    }
+
+    mongo::DBClientConnection *MongoWorker::memberConnection(const std::string &host)
+    {
+        auto const existing = _memberConnections.find(host);
+        if (existing != _memberConnections.end())
+            return existing->second.get();
+
+        TlsContext::Guard tls(*_tlsContext);
+        std::unique_ptr<mongo::DBClientConnection> conn { 
+            new mongo::DBClientConnection { true, _mongoTimeoutSec } 
+        };
+        WireCompression::configure(conn.get(), _connSettings);
+        DriverMetrics::install(conn.get(), _connSettings);
+        mongo::Status const status = conn->connect(connectAddress(mongo::HostAndPort(host)), APP_NAME_VERSION);
+        if (!status.isOK()) {
+            HostResolver::instance().invalidate(mongo::HostAndPort(host).host());
+            throw std::runtime_error(status.reason());
+        }
+
+        if (_connSettings->hasEnabledPrimaryCredential())
+            conn->auth(authParams());
+
+        mongo::DBClientConnection *const result = conn.get();
+        _memberConnections[host] = std::move(conn);
+        return result;
+    }
+
+    mongo::HostAndPort MongoWorker::connectAddress(const mongo::HostAndPort &host) const
+    {
+        if (_connSettings->sslSettings()->sslEnabled())
+            return host;
+
+        std::string const address = HostResolver::instance().resolve(host.host());
+        if (address.empty())
+            return host;    // driver reports the failure
+        return mongo::HostAndPort(address, host.port());
+    }
+
+    void MongoWorker::measureMemberLatency(const ReplicaSet &replicaSet)
+    {
+        MemberLatency &latency = MemberLatency::instance();
+        for (auto const &member : replicaSet.membersAndHealths) {
+            if (!member.second) {
+                latency.addFailure(replicaSet.setName, member.first);
+                continue;
+            }
+
+            try {
+                latency.addSample(replicaSet.setName, member.first, pingWithShortTimeout(memberConnection(member.first)));
+            }
+            catch (const std::exception &) {
+                // Reported by topology monitor, if member is down
+                latency.addFailure(replicaSet.setName, member.first);
+            }
+        }
     }
 
-    void MongoWorker::configureSSL()
+    std::unique_ptr<mongo::DBClientBase> MongoWorker::openExtraConnection(double socketTimeoutSec)
     {
-        // As a precaution reset SSL global params for any kind of connection request (SSL or non-SSL)
-        resetGlobalSSLparams();
-        // Update global SSL mode and global mongo SSL settings
-        if (_connSettings->sslSettings()->sslEnabled()) {
-            // Force SSL mode for outgoing connections
-            mongo::sslGlobalParams.sslMode.store(mongo::SSLParams::SSLMode_requireSSL);
-            updateGlobalSSLparams();
+        TlsContext::Guard tls(*_tlsContext);
+        if (socketTimeoutSec < 0)
+            socketTimeoutSec = _mongoTimeoutSec;
+
+        std::unique_ptr<mongo::DBClientBase> conn;
+        if (_connSettings->isReplicaSet()) {
+            if (!_dbclientRepSet)
+                throw std::runtime_error("Replica set is not connected");
+
+            std::string const setName = _dbclientRepSet->getSetName();
+            std::unique_ptr<mongo::DBClientReplicaSet> repSet { new mongo::DBClientReplicaSet {
+                setName, _connSettings->replicaSetSettings()->membersToHostAndPort(), APP_NAME_VERSION,
+                socketTimeoutSec
+            } };
+            DriverMetrics::install(repSet.get(), _connSettings);
+            if (!repSet->connect())
+                throw std::runtime_error("Cannot connect to replica set " + setName);
+            conn = std::move(repSet);
         }
         else {
-            // Disable forced SSL mode for outgoing connections
-            mongo::sslGlobalParams.sslMode.store(mongo::SSLParams::SSLMode_allowSSL);
+            std::unique_ptr<mongo::DBClientConnection> single { 
+                new mongo::DBClientConnection { true, socketTimeoutSec } 
+            };
+            WireCompression::configure(single.get(), _connSettings);
+            DriverMetrics::install(single.get(), _connSettings);
+            mongo::Status const status = single->connect(connectAddress(_connSettings->hostAndPort()),
+                                                         APP_NAME_VERSION);
+            if (!status.isOK())
+                throw std::runtime_error(status.reason());
+            conn = std::move(single);
         }
+
+        if (_connSettings->hasEnabledPrimaryCredential())
+            authenticate(conn.get(), !_connSettings->isReplicaSet());
+
+        return conn;
     }
 
-    void MongoWorker::updateGlobalSSLparams() const
+    void MongoWorker::runOnConnections(std::vector<std::unique_ptr<mongo::DBClientBase>> connections, size_t count,
+                                       const std::function<void(const ConnectionItem &)> &work,
+                                       const std::function<void()> &onProgress, int intervalMs)
     {
-        resetGlobalSSLparams();
-        const SslSettings * const sslSettings = _connSettings->sslSettings();
-        mongo::sslGlobalParams.sslAllowInvalidCertificates = sslSettings->allowInvalidCertificates();
-        if (!mongo::sslGlobalParams.sslAllowInvalidCertificates)
-        {
-            mongo::sslGlobalParams.sslCAFile = sslSettings->caFile();
+        std::mutex errorMutex;
+        std::string error;
+        std::atomic<size_t> next { connections.size() };
+        std::atomic<bool> failed { false };
+        std::atomic<size_t> running { connections.size() };
+
+        std::vector<std::thread> threads;
+        for (size_t slot = 0; slot < connections.size(); ++slot) {
+            threads.emplace_back([&, slot]() {
+                try {
+                    for (size_t index = slot; index < count && !failed; index = next++)
+                        work({ index, slot, connections[slot].get(), failed });
+                }
+                catch (const std::exception &ex) {
+                    // Connection is lost (or item failed), the other threads stop too
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!failed.exchange(true))
+                        error = ex.what();
+                }
+                --running;
+            });
         }
-        if (sslSettings->usePemFile())
-        {
-            mongo::sslGlobalParams.sslPEMKeyFile = sslSettings->pemKeyFile();
-            mongo::sslGlobalParams.sslPEMKeyPassword = sslSettings->pemPassPhrase();
+
+        auto const started = std::chrono::steady_clock::now();
+        long long lastProgressMs = 0;
+        while (onProgress && running > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::max(intervalMs / 5, 1)));
+            long long const now = elapsedMsSince(started);
+            if (now - lastProgressMs >= intervalMs) {
+                lastProgressMs = now;
+                onProgress();
+            }
         }
-        if (sslSettings->useAdvancedOptions())
-        {
-            mongo::sslGlobalParams.sslCRLFile = sslSettings->crlFile();
-            mongo::sslGlobalParams.sslAllowInvalidHostnames = sslSettings->allowInvalidHostnames();
+        for (std::thread &thread : threads)
+            thread.join();
+        connections.clear();
+        if (onProgress)
+            onProgress();
+
+        if (failed)
+            throw std::runtime_error(error);
+    }
+
+    void MongoWorker::runOnExtraConnections(size_t count, size_t maxConnections,
+                                            const std::function<void(const ConnectionItem &)> &work,
+                                            const std::function<void()> &onProgress, int intervalMs,
+                                            double socketTimeoutSec)
+    {
+        // Connections are opened here, in worker thread, as SSL setup of driver is global
+        std::vector<std::unique_ptr<mongo::DBClientBase>> connections;
+        for (size_t i = 0; i < std::min(count, maxConnections); ++i)
+            connections.push_back(openExtraConnection(socketTimeoutSec));
+
+        runOnConnections(std::move(connections), count, work, onProgress, intervalMs);
+    }
+
+    std::unique_ptr<mongo::DBClientBase> MongoWorker::openShardConnection(const ShardFanout::Target &shard)
+    {
+        TlsContext::Guard tls(*_tlsContext);
+
+        std::vector<mongo::HostAndPort> hosts;
+        for (auto const &host : shard.hosts)
+            hosts.emplace_back(host);
+
+        std::unique_ptr<mongo::DBClientBase> conn;
+        if (!shard.setName.empty()) {
+            std::unique_ptr<mongo::DBClientReplicaSet> repSet { new mongo::DBClientReplicaSet {
+                shard.setName, hosts, APP_NAME_VERSION, _mongoTimeoutSec
+            } };
+            DriverMetrics::install(repSet.get(), _connSettings);
+            if (!repSet->connect())
+                throw std::runtime_error("Cannot connect to replica set " + shard.setName + " of shard " + shard.shard);
+            conn = std::move(repSet);
+        }
+        else {
+            std::unique_ptr<mongo::DBClientConnection> single { 
+                new mongo::DBClientConnection { true, _mongoTimeoutSec } 
+            };
+            WireCompression::configure(single.get(), _connSettings);
+            DriverMetrics::install(single.get(), _connSettings);
+            mongo::Status const status = single->connect(hosts.front(), APP_NAME_VERSION);
+            if (!status.isOK())
+                throw std::runtime_error("Cannot connect to shard " + shard.shard + ": " + status.reason());
+            conn = std::move(single);
+        }
+
+        // Shards authenticate users of cluster (not shard local ones) as mongos does
+        if (_connSettings->hasEnabledPrimaryCredential())
+            authenticate(conn.get(), shard.setName.empty());
+
+        return conn;
+    }
+
+    void MongoWorker::authenticate(mongo::DBClientBase *conn, bool isDisposable) const
+    {
+        // Driver would not authenticate these again after auto reconnect, see ScramAuth
+        CredentialSettings const * const credentials = _connSettings->primaryCredential();
+        if (isDisposable && ScramAuth::isSupported(credentials)) {
+            ScramAuth::authenticate(conn, credentials);
+            return;
         }
+
+        conn->auth(authParams());
     }
 
-    void MongoWorker::resetGlobalSSLparams() const
+    mongo::BSONObj MongoWorker::authParams() const
     {
-        mongo::sslGlobalParams.sslAllowInvalidCertificates = false;
-        mongo::sslGlobalParams.sslCAFile = "";
-        mongo::sslGlobalParams.sslPEMKeyFile = "";
-        mongo::sslGlobalParams.sslPEMKeyPassword = "";
-        mongo::sslGlobalParams.sslCRLFile = "";
-        mongo::sslGlobalParams.sslAllowInvalidHostnames = false;
+        CredentialSettings const * const credentials = _connSettings->primaryCredential();
+        return mongo::BSONObjBuilder()
+            .append("user", credentials->userName())
+            .append("db", credentials->databaseName())
+            .append("pwd", credentials->userPassword())
+            .append("mechanism", credentials->mechanism())
+            .obj();
     }
 
     // todo: From 1.4, this function started to return incorrect member healths when set is unreachable. 
@@ -1078,28 +4807,31 @@ namespace Robomongo
 
     std::string MongoWorker::connectAndGetReplicaSetName() const
     {
-        auto const dbclientTemp { std::make_unique<mongo::DBClientConnection>(true, 10) };
-        std::string setName = "";
-
-        // Try connecting to the nodes one by one until getting replica set name.
-        for (auto const& node : _connSettings->replicaSetSettings()->membersToHostAndPort())
-        {
-            if (!dbclientTemp->connect(node, APP_NAME_VERSION).isOK())
-                return "";
-
-            _scriptEngine->init(_isLoadMongoRcJs, node.toString());
-            MongoShellExecResult const& result = _scriptEngine->exec("rs.status()", "");
-            if (!result.results().empty()) {
-                auto const& resultDocs = result.results().front().documents();
-                if (!resultDocs.empty()) {
-                    setName = resultDocs.front()->bsonObj().getStringField("set");
-                    if (!setName.empty()) // We get the information, finish the loop
-                        break;
-                }
-            }
+        auto const members = _connSettings->replicaSetSettings()->membersToHostAndPort();
+        if (members.empty())
+            return "";
+
+        // Probe all members at once and take the set name from the first one that answers
+        // isMaster, so that unreachable members do not add up their timeouts.
+        auto const probe = std::make_shared<ReplicaSetProbe>();
+        probe->pending = members.size();
+        double const timeoutSec = _mongoTimeoutSec;
+
+        for (auto const& member : members) {
+            std::thread([probe, member, timeoutSec]() {
+                std::string const setName = isMasterSetName(member, timeoutSec);
+
+                std::lock_guard<std::mutex> lock(probe->mutex);
+                --probe->pending;
+                if (probe->setName.empty())
+                    probe->setName = setName;
+                probe->finished.notify_all();
+            }).detach();
         }
 
-        return setName;
+        std::unique_lock<std::mutex> lock(probe->mutex);
+        probe->finished.wait(lock, [&probe]() { return !probe->setName.empty() || probe->pending == 0; });
+        return probe->setName;
     }
 
     /**
@@ -1124,13 +4856,28 @@ namespace Robomongo
         AppRegistry::instance().bus()->send(receiver, event);
     }
 
-    void MongoWorker::pingDatabase(mongo::DBClientBase *dbclient) const
+    bool MongoWorker::pingDatabase(mongo::DBClientBase *dbclient) const
     {
         // Building { ping: 1 }
         mongo::BSONObjBuilder command;
         command.append("ping", 1);
         mongo::BSONObj result;
         std::string const authBase = getAuthBase();
-        dbclient->runCommand(authBase.empty() ? "admin" : authBase, command.obj(), result);
+        return dbclient->runCommand(authBase.empty() ? "admin" : authBase, command.obj(), result);
+    }
+
+    double MongoWorker::pingWithShortTimeout(mongo::DBClientBase *dbclient) const
+    {
+        // Replica set connection has no socket timeout of its own, ping goes to its primary
+        mongo::DBClientConnection *conn = dynamic_cast<mongo::DBClientConnection*>(dbclient);
+        if (auto repSet = dynamic_cast<mongo::DBClientReplicaSet*>(dbclient))
+            conn = &repSet->masterConn();
+
+        PingTimeoutGuard const guard { conn, _mongoTimeoutSec };
+        auto const start = std::chrono::steady_clock::now();
+        if (!pingDatabase(conn ? conn : dbclient))
+            throw std::runtime_error("Command \"ping\" failed.");
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
     }
 }
@@ -2,11 +2,20 @@
 
 #include <QObject>
 #include <QMutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <mongo/client/dbclient_rs.h> 
+#include <mongo/client/dbclientcursor.h>
 
 #include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/mongodb/ConnectionHealth.h"
+#include "robomongo/core/mongodb/MongoClient.h"
+#include "robomongo/core/mongodb/TlsContext.h"
 
 QT_BEGIN_NAMESPACE
 class QThread;
@@ -15,20 +24,36 @@ QT_END_NAMESPACE
 
 namespace Robomongo
 {
-    class MongoClient;
     class ScriptEngine;
     class ConnectionSettings;
+    struct NativeQuery;
 
     class MongoWorker : public QObject
     {
         Q_OBJECT
 
     public:        
+        /**
+         * @param shellResultBudgetMb Memory budget of one shell result, see ScriptEngine
+         * @param jsHeapLimitMb JavaScript heap limit of shell scope, see ScriptEngine
+         * @param scopePoolSize Number of warm shell scopes prepared for next shells, see ScopePool
+         * @param hasScriptEngine If false, this worker does not create shell (ScriptEngine) and
+         *        serves only requests that use driver connection (i.e. explorer metadata)
+         */
         explicit MongoWorker(ConnectionSettings *connection, bool isLoadMongoRcJs, int batchSize,
-                             double mongoTimeoutSec, int shellTimeoutSec, QObject *parent = nullptr);
+                             double mongoTimeoutSec, int shellTimeoutSec, int shellResultBudgetMb,
+                             int jsHeapLimitMb, int scopePoolSize, bool hasScriptEngine = true,
+                             QObject *parent = nullptr);
 
         ~MongoWorker();
         void interrupt();
+
+        /**
+         * @brief Client addresses ("host:port") of connections used by the request this worker
+         *        is currently executing. Empty, if worker is idle. See KillOperationsRequest.
+         * @threadsafe
+         */
+        std::vector<std::string> activeClientAddresses() const;
         void stopAndDelete();
         void changeTimeout(int newTimeout);
 
@@ -37,11 +62,17 @@ namespace Robomongo
         void init();
 
         /**
-         * @brief Every minute we are issuing { ping : 1 } command to every used connection
-         * in order to avoid dropped connections.
+         * @brief Every minute we are issuing { ping : 1 } command to every connection that
+         * was idle since the last tick, in order to avoid dropped connections.
          */
         void keepAlive();
 
+        /**
+         * @brief Health check with short timeout, replies with round trip time.
+         *        Sent to metadata worker, so it does not wait behind user work.
+         */
+        void handle(PingServerRequest *event);
+
         /**
          * @brief Initiate connection to MongoDB
          */
@@ -63,6 +94,18 @@ namespace Robomongo
          */
         void handle(LoadCollectionNamesRequest *event);
 
+        /**
+         * @brief Lists collections on connection of worker, while users and functions are read
+         *        on two side connections (see takeSideConnection()), so all of them take about
+         *        one round trip
+         */
+        void handle(LoadDatabaseMetadataRequest *event);
+
+        /**
+         * @brief Load collStats of a few collections, see MongoDatabase::loadCollectionStats()
+         */
+        void handle(LoadCollectionStatsRequest *event);
+
         /**
          * @brief Load list of all users
          */
@@ -72,6 +115,12 @@ namespace Robomongo
         * @brief Load indexes in collection
         */
         void handle(LoadCollectionIndexesRequest *event);
+        void handle(LoadIndexUsageRequest *event);
+
+        /**
+         * @brief Indexes and first page of collection focused in explorer, see FirstPageCache
+         */
+        void handle(PrefetchCollectionRequest *event);
 
         /**
         * @brief Add/edit indexes in collection
@@ -93,23 +142,182 @@ namespace Robomongo
          */
         void handle(InsertDocumentRequest *event);
 
+        /**
+         * @brief Inserts or saves documents in batches
+         */
+        void handle(InsertDocumentsRequest *event);
+
+        /**
+         * @brief Inserts documents of DataGenerator with BulkInserter, generated by one
+         *        thread per connection at target rate
+         */
+        void handle(GenerateDataRequest *event);
+
+        /**
+         * @brief Runs captured operations (see WorkloadReplay) on one connection per thread,
+         *        each at its captured time divided by speed. Latency of find and aggregate is
+         *        the one of the first batch, cursors are killed after it.
+         */
+        void handle(ReplayWorkloadRequest *event);
+
+        /**
+         * @brief Removes or updates documents by chunks of _id ranges on a side connection,
+         *        waiting for secondaries between chunks (see ThrottledWrite)
+         */
+        void handle(ThrottledWriteRequest *event);
+
+        /**
+         * @brief Saves cells edited in table view, see MongoClient::commitChangeset
+         */
+        void handle(CommitChangesetRequest *event);
+
         /**
          * @brief Remove documents
          */
         void handle(RemoveDocumentRequest *event);
 
+        /**
+         * @brief Remove documents by _id, in chunks
+         */
+        void handle(RemoveDocumentsByIdRequest *event);
+
         /**
          * @brief Load list of all collection names
          */
         void handle(ExecuteQueryRequest *event);
 
+        /**
+         * @brief Read page of aggregation result, see readAggregationPage()
+         */
+        void handle(AggregatePageRequest *event);
+
+        /**
+         * @brief Run prefixes of aggregation pipeline on capped input, see PipelinePreviewRequest
+         */
+        void handle(PipelinePreviewRequest *event);
+
+        /**
+         * @brief Group values of field of query result on server, see FieldDistributionRequest
+         */
+        void handle(FieldDistributionRequest *event);
+
+        /**
+         * @brief Bucket values of field of query result on server, see FieldBucketsRequest
+         */
+        void handle(FieldBucketsRequest *event);
+
+        /**
+         * @brief Count documents of query result, see CountDocumentsRequest
+         */
+        void handle(CountDocumentsRequest *event);
+
+        /**
+         * @brief Sample documents of collection and infer its schema, see SampleSchemaRequest
+         */
+        void handle(SampleSchemaRequest *event);
+
+        /**
+         * @brief Streams documents of query to ExportWriter, see ExportDocumentsRequest.
+         *        With ExportOptions::parallelism, ranges of _id are exported concurrently
+         *        (see exportRanges()).
+         */
+        void handle(ExportDocumentsRequest *event);
+
+        /**
+         * @brief Parses file with ImportReader and inserts its documents with BulkInserter,
+         *        on ImportOptions::concurrency extra connections
+         */
+        void handle(ImportDocumentsRequest *event);
+
+        /**
+         * @brief Runs collStats for all collections of database on at most MaxStatsConcurrency
+         *        extra connections, results are sent in DatabaseStatsProgressEvent as they come
+         */
+        void handle(DatabaseStatsRequest *event);
+
+        /**
+         * @brief Searches value in collections of database on at most MaxSearchConcurrency
+         *        extra connections (see DatabaseSearch), hits are sent in
+         *        DatabaseSearchProgressEvent as they come
+         */
+        void handle(DatabaseSearchRequest *event);
+
+        /**
+         * @brief Runs action on collections on at most MaxMaintenanceConcurrency extra
+         *        connections (see CollectionMaintenance), finished collections are sent in
+         *        CollectionMaintenanceProgressEvent
+         */
+        void handle(CollectionMaintenanceRequest *event);
+
+        /**
+         * @brief Reads $sample of collection in batches, which are analyzed by SchemaAnalyzer
+         *        in another thread while the next batch is read
+         */
+        void handle(AnalyzeSchemaRequest *event);
+
+        /**
+         * @brief Histogram of document sizes by server, or by worker when server has
+         *        no $bsonSize
+         */
+        void handle(DocumentSizesRequest *event);
+
+        /**
+         * @brief Compares digests of _id ranges of both collections on at most
+         *        MaxCompareConcurrency pairs of connections, and documents of ranges that differ
+         */
+        void handle(CompareCollectionsRequest *event);
+
         /**
          * @brief Execute javascript
          */
         void handle(ExecuteScriptRequest *event);
         void retry(ExecuteScriptRequest *event);
+        void handle(ExecuteScriptFileRequest *event);
         void handle(StopScriptRequest *event);
 
+        /**
+         * @brief Kill server operations and cursors of another (busy) worker's connections
+         */
+        void handle(KillOperationsRequest *event);
+
+        /**
+         * @brief List and kill server operations for operations monitor
+         */
+        void handle(CurrentOpsRequest *event);
+        void handle(KillOpRequest *event);
+        void handle(ServerStatusRequest *event);
+        void handle(ProfileSummaryRequest *event);
+        void handle(PlanCacheRequest *event);
+        void handle(ShardDistributionRequest *event);
+        void handle(GridFsFilesRequest *event);
+
+        /**
+         * @brief Downloads or uploads GridFS file, ranges of chunks in flight on several
+         *        extra connections (see transferGridFsRanges())
+         */
+        void handle(GridFsTransferRequest *event);
+        void handle(ExplainRequest *event);
+        void handle(RollingIndexBuildRequest *event);
+        void handle(ShardFanoutRequest *event);
+
+        /**
+         * @brief Keeps change stream of the deployment open until request is cancelled, see
+         *        MongoServer::setLiveExplorer(). Runs as continuation, see continueLater().
+         */
+        void handle(WatchNamespaceChangesRequest *event);
+
+        /**
+         * @brief Keeps tailable cursor on oplog open until request is cancelled, it is reopened
+         *        after the last seen entry, if server closes it. Runs as continuation.
+         */
+        void handle(TailOplogRequest *event);
+
+        /**
+         * @brief Keeps change stream of collection open until request is cancelled or server
+         *        closes it, i.e. collection was dropped. Runs as continuation.
+         */
+        void handle(WatchCollectionRequest *event);
+
         void handle(AutocompleteRequest *event);
         void handle(CreateDatabaseRequest *event);
         void handle(DropDatabaseRequest *event);
@@ -118,7 +326,7 @@ namespace Robomongo
         void handle(DropCollectionRequest *event);
         void handle(RenameCollectionRequest *event);
         void handle(DuplicateCollectionRequest *event);       
-        void handle(CopyCollectionToDiffServerRequest *event); // todo: unused? remove
+        void handle(CopyCollectionToDiffServerRequest *event);
  
         void handle(CreateUserRequest *event);
         void handle(DropUserRequest *event);
@@ -128,10 +336,53 @@ namespace Robomongo
 
     protected:
         virtual void timerEvent(QTimerEvent *);
+        virtual void customEvent(QEvent *event);
 
     private:
-        // Added after Mongo 4.0 to fix connection failures seen after a first edit/add/remove doc. operation
-        void restartReplicaSetConnection();
+        /**
+         * @brief Runs 'step' in thread of this worker, again and again until it returns Done or
+         *        the worker is stopped. Steps are posted with low priority, so that
+         *        requests sent meanwhile are handled between them: a long running request (i.e.
+         *        a stream, which waits for server in every step) does not keep the worker busy
+         *        and several of them are in flight on one thread. Step checks cancellation of
+         *        its request itself, it is not called again once worker is stopping.
+         * @param delayMs Delay before the step, i.e. when there is nothing to wait for on server
+         */
+        typedef std::function<int()> Continuation;  // returns delay of the next step (ms) or Done
+        static const int Done = -1;
+        void continueLater(const Continuation &step, int delayMs = 0);
+
+        /**
+         * @brief Runs single document write on current connection. After authorization error
+         *        connection is authenticated again and write is repeated once; after network
+         *        error failed connection is replaced and write is repeated once, if 'idempotent'.
+         *        Second call of 'write' gets 'retry' true.
+         * @throws std::exception of the last attempt
+         */
+        void runWrite(const std::string &operation, bool idempotent,
+                      const std::function<void(MongoClient &client, bool retry)> &write);
+
+        // Reconnects, if connection was closed by error or by server; true if it was replaced
+        bool checkConnectionHealth();
+
+        /**
+         * @brief Opens circuit (see ConnectionHealth): getConnection() fails at once until
+         *        a background probe finds the server reachable again
+         */
+        void markServerDown(const std::string &reason);
+
+        // Probes reachability of server after backoff, in another thread
+        void scheduleReconnect();
+        int finishReconnect(bool reachable, const std::string &error);
+
+        /**
+         * @brief Keeps a copy of interactive request, which arrived while the server is down,
+         *        to be handled again once it is back (or after MaxParkedMs, failing then).
+         * @return True, if request was parked and should not be handled now
+         */
+        template <typename Request>
+        bool parkWhileDown(Request *event);
+        void replayParkedRequests();
 
         /**
          * @brief Send event to this MongoWorker
@@ -146,20 +397,114 @@ namespace Robomongo
         MongoClient *getClient();
 
         /**
-        *@brief Reset and update global mongo SSL settings (mongo::sslGlobalParams)
-        */
-        void configureSSL();
+         * @brief Client of the nearest replica set member (see MemberLatency), if this worker
+         *        routes the query: "nearest" read preference without tag sets, replica set not
+         *        behind SSH tunnel, member measured by topology monitor. Otherwise getClient().
+         */
+        MongoClient *queryClient(const MongoQueryInfo &info);
 
         /**
-        *@brief Update global mongo SSL settings (mongo::sslGlobalParams) according to active connection 
-        *       request's SSL settings.
-        */
-        void updateGlobalSSLparams() const;
+         * @brief Authenticated connection to one replica set member, kept for the lifetime of
+         *        worker, as paged cursors may use it
+         * @throws std::exception, if connect or auth failed
+         */
+        mongo::DBClientConnection *memberConnection(const std::string &host);
 
         /**
-        *@brief Reset global mongo SSL settings (mongo::sslGlobalParams) into default zero state
-        */
-        void resetGlobalSSLparams() const;
+         * @brief Host with name replaced by its address cached by HostResolver, so that driver
+         *        does not look it up on every (re)connect. Names are kept for TLS connections,
+         *        certificates are verified against them, and for hosts which cannot be resolved.
+         */
+        mongo::HostAndPort connectAddress(const mongo::HostAndPort &host) const;
+
+        /**
+         * @brief Pings healthy members of replica set one by one and stores their round trip
+         *        times in MemberLatency. Unreachable members are forgotten until they answer.
+         */
+        void measureMemberLatency(const ReplicaSet &replicaSet);
+
+        /**
+         * @brief Opens one more authenticated connection to server (or replica set) of this
+         *        worker, for work that runs in other threads, in parallel with getConnection()
+         * @param socketTimeoutSec Timeout of socket operations, 0 for none (i.e. index builds),
+         *        negative for the timeout of this worker
+         * @throws std::exception, if connect or auth failed
+         */
+        std::unique_ptr<mongo::DBClientBase> openExtraConnection(double socketTimeoutSec = -1);
+        mongo::BSONObj authParams() const;
+
+        /**
+         * @brief Item of runOnConnections(): its index, connection (and its slot) of thread
+         *        running it. 'stopped' is set once item of other thread failed, long items check it.
+         */
+        struct ConnectionItem
+        {
+            size_t index;
+            size_t slot;
+            mongo::DBClientBase *connection;
+            const std::atomic<bool> &stopped;
+        };
+
+        /**
+         * @brief Runs 'work' for items 0..count-1 in one thread per connection. Thread of
+         *        connection i runs item i first, the rest is taken by threads as they finish.
+         * @param onProgress Called (if set) in this thread every intervalMs while items run,
+         *        and once after all of them finished
+         * @throws std::runtime_error with message of the first failed item, the other threads
+         *         stop taking items then
+         */
+        void runOnConnections(std::vector<std::unique_ptr<mongo::DBClientBase>> connections, size_t count,
+                              const std::function<void(const ConnectionItem &)> &work,
+                              const std::function<void()> &onProgress = nullptr, int intervalMs = 0);
+
+        /**
+         * @brief runOnConnections() on at most maxConnections of openExtraConnection(socketTimeoutSec)
+         */
+        void runOnExtraConnections(size_t count, size_t maxConnections,
+                                   const std::function<void(const ConnectionItem &)> &work,
+                                   const std::function<void()> &onProgress = nullptr, int intervalMs = 0,
+                                   double socketTimeoutSec = -1);
+
+        /**
+         * @brief Authenticates with primary credential. Disposable connections (single server
+         *        ones, dropped once failed) use SCRAM keys cached for the session.
+         */
+        void authenticate(mongo::DBClientBase *conn, bool isDisposable) const;
+
+        /**
+         * @brief Opens authenticated connection to shard (its replica set, or standalone mongod)
+         *        with credential of this worker, bypassing mongos
+         * @throws std::exception, if connect or auth failed
+         */
+        std::unique_ptr<mongo::DBClientBase> openShardConnection(const ShardFanout::Target &shard);
+
+        /**
+         * @brief Exports ranges of _id delimited by 'bounds', in one thread and connection per
+         *        range, into file per range or merged (in _id order) into one file
+         * @throws std::exception
+         */
+        void exportRanges(ExportDocumentsRequest *event, const std::vector<mongo::BSONObj> &bounds,
+                          const std::chrono::steady_clock::time_point &started);
+
+        /**
+         * @brief Runs 'transfer' for every range of chunks of GridFS file, at most
+         *        MaxGridFsConcurrency ranges at once, and reports transferred bytes
+         * @param transfer Moves chunks of one range on given connection, returns their bytes
+         * @throws std::exception of the first failed range, std::runtime_error if cancelled
+         */
+        void transferGridFsRanges(GridFsTransferRequest *event, const GridFs::FileInfo &file,
+                                  const std::chrono::steady_clock::time_point &started,
+                                  const std::function<long long(mongo::DBClientBase *, const GridFs::Range &)> &transfer);
+        GridFs::FileInfo downloadGridFsFile(GridFsTransferRequest *event, const std::chrono::steady_clock::time_point &started);
+        GridFs::FileInfo uploadGridFsFile(GridFsTransferRequest *event, const std::chrono::steady_clock::time_point &started);
+
+        /**
+         * @brief Shell of this worker, created on first use (JavaScript scope, mongo shell JS,
+         *        .robomongorc.js), so that explorer is usable without waiting for it.
+         * @return nullptr for metadata worker
+         * @throws std::runtime_error, if shell could not be initialized
+         */
+        ScriptEngine *scriptEngine();
 
         /**
         *@brief Update Replica Set related parameters/settings.
@@ -168,6 +513,72 @@ namespace Robomongo
 
         std::string connectAndGetReplicaSetName() const;
 
+        /**
+         * @brief Runs recognized find/aggregate with driver connection, result is
+         *        the same as ScriptEngine::exec() would return for this script.
+         * @throws std::exception
+         */
+        MongoShellExecResult execNativeQuery(const NativeQuery &native, const ExecuteScriptRequest *event);
+
+        /**
+         * @brief Runs read-only queries of script (see NativeQuery::parseReads()) at once, on up
+         *        to MaxParallelReads side connections. Results are in order of statements.
+         * @throws std::exception, the first error of any query
+         */
+        MongoShellExecResult execParallelReads(const std::vector<std::string> &statements,
+                                               const std::vector<NativeQuery> &queries,
+                                               const ExecuteScriptRequest *event);
+
+        // Results of one native query read with 'client', as ScriptEngine::exec() returns them
+        std::vector<MongoShellResult> readNative(MongoClient &client, const NativeQuery &native,
+                                                 const std::string &statement, const std::string &serverAddress,
+                                                 const ExecuteScriptRequest *event);
+        std::string primaryAddress() const;
+
+        /**
+         * @brief Runs query 'iterations' times on 'concurrency' side connections and returns
+         *        latencies and throughput (see QueryBenchmark) as result of one document.
+         *        Stopped by interrupt() between batches.
+         * @throws std::exception, if counts exceed limits or no iteration succeeded
+         */
+        MongoShellExecResult execBenchmark(const NativeQuery &query, int iterations, int concurrency,
+                                           const ExecuteScriptRequest *event);
+
+        /**
+         * @brief Reads page of query with cursor kept under 'cursorKey'. Next page continues
+         *        the cursor (getMore). Other pages of queries sorted by _id start from _id of
+         *        the nearest page shown before, instead of skipping all documents before it.
+         * @throws std::exception
+         */
+        std::vector<MongoDocumentPtr> readPage(unsigned long long cursorKey, const MongoQueryInfo &info);
+
+        /**
+         * @brief Reads page of aggregation with cursor kept under 'cursorKey'. Pipeline runs
+         *        when cursor is opened (with $skip of the page), later pages continue the
+         *        cursor with getMore. Pages before cursor position open it again.
+         * @param reread Cursor is opened again even for the next page
+         * @throws std::exception
+         */
+        std::vector<MongoDocumentPtr> readAggregationPage(unsigned long long cursorKey, const AggrInfo &info,
+                                                          bool reread);
+
+        /**
+         * @brief Address of driver connection as server sees it ({ whatsmyuri: 1 }), 
+         *        cached until reconnect. Empty string, if server does not tell it.
+         */
+        std::string driverClientAddress();
+
+        // Publishes addresses for activeClientAddresses() for the lifetime of the scope
+        class ActiveClientsScope
+        {
+        public:
+            ActiveClientsScope(MongoWorker *worker, std::vector<std::string> addresses);
+            ~ActiveClientsScope();
+
+        private:
+            MongoWorker *const _worker;
+        };
+
         /**
          * @brief Send reply event to object 'obj'
          */
@@ -176,32 +587,103 @@ namespace Robomongo
         /**
         * @brief Send hear beat messages to database in order to keep connection alive
         */
-        void pingDatabase(mongo::DBClientBase *dbclient) const;
+        bool pingDatabase(mongo::DBClientBase *dbclient) const;
+
+        /**
+        * @brief Pings with PingTimeoutSec socket timeout. Returns round trip time in ms.
+        * @throws std::exception, if ping fails
+        */
+        double pingWithShortTimeout(mongo::DBClientBase *dbclient) const;
 
         QThread *_thread;
         QMutex _firstConnectionMutex;
 
+        mutable QMutex _activeClientsMutex;
+        std::vector<std::string> _activeClientAddresses;
+        std::string _driverClientAddress;
+
+        // Created on first use by scriptEngine(). Guarded by mutex against interrupt() and
+        // changeTimeout() of GUI thread, together with _shellTimeoutSec.
         std::unique_ptr<ScriptEngine> _scriptEngine;
+        mutable QMutex _scriptEngineMutex;
+
+        // Set by interrupt() of GUI thread, checked by threads of execBenchmark()
+        std::atomic<bool> _benchmarkStopped { false };
 
         const bool _isLoadMongoRcJs;
+        const bool _hasScriptEngine;
         const int _batchSize;
         int _timerId;
-        int _dbAutocompleteCacheTimerId;
         double _mongoTimeoutSec;
         int _shellTimeoutSec;
+        int _shellResultBudgetMb;
+        int _jsHeapLimitMb;
+        const int _scopePoolSize;
         QAtomicInteger<int> _isQuiting;
 
+        // Last use of connections by requests, see keepAlive()
+        std::chrono::steady_clock::time_point _lastActivity;
+
+        // Circuit breaker of driver connection, see markServerDown()
+        ConnectionHealth _health;
+        static const size_t MaxParkedRequests = 16;
+        std::vector<std::function<void()>> _parkedRequests;
+        std::chrono::steady_clock::time_point _parkedSince;
+        bool _isReplayingParked = false;
+
         std::unique_ptr<mongo::DBClientConnection> _dbclient;
+        bool _warmAuthenticated = false;    // _dbclient is authenticated warm connection, see WarmConnections
         std::unique_ptr<mongo::DBClientReplicaSet> _dbclientRepSet;
+        std::map<std::string, std::unique_ptr<mongo::DBClientConnection>> _memberConnections;
+        std::string _nearestMember;     // routed to by the last queryClient(), for logging
+
+        // Cursors of output parts, see readPage(). Declared after connections, 
+        // because cursors use them when destroyed.
+        struct PagedCursor
+        {
+            std::unique_ptr<mongo::DBClientCursor> cursor;
+            MongoQueryInfo query;           // skip, limit and batch size of pages differ
+            int position = 0;               // skip of the next document of cursor
+            std::map<int, mongo::BSONObj> pageStarts;   // skip -> { _id: <first _id of page> }
+            std::chrono::steady_clock::time_point lastUse;
+        };
+        static const size_t MaxPagedCursors = 8;
+        std::unordered_map<unsigned long long, PagedCursor> _pagedCursors;
+
+        // Aggregation cursors of output parts, see readAggregationPage()
+        struct PagedAggregation
+        {
+            AggrInfo aggregation;           // skip and batch size of pages differ
+            long long cursorId = 0;         // 0, if cursor is not open or exhausted
+            int position = 0;               // skip of the next document of cursor
+            std::chrono::steady_clock::time_point lastUse;
+        };
+        std::unordered_map<unsigned long long, PagedAggregation> _pagedAggregations;
+
+        /**
+         * @brief Idle connection of side pool for short metadata reads in parallel with
+         *        connection of worker, opened if there is no healthy one. Returned to pool
+         *        with putSideConnection(). Called from any thread.
+         * @throws std::exception, if connect or auth failed
+         */
+        std::unique_ptr<mongo::DBClientBase> takeSideConnection();
+        void putSideConnection(std::unique_ptr<mongo::DBClientBase> connection);
+
+        static const size_t MaxSideConnections = 4;
+        static const size_t MaxParallelReads = 4;
+        QMutex _sideConnectionsMutex;
+        std::vector<std::unique_ptr<mongo::DBClientBase>> _sideConnections;
+
+        // Destination connections of collection copy, each inserts batches read from source
+        static const int CopyCollectionConnections = 2;
 
         ConnectionSettings *_connSettings;
 
-        // Collection of created databases.
-        // Starting from 3.0, MongoDB drops empty databases.
-        // It means, we did not find a way to create "empty" database.
-        // We save all created databases in this collection and merge with
-        // list of real databases returned from MongoDB server.
-        std::unordered_set<std::string> _createdDbs;
+        // TLS parameters of connection record, held while driver connections are established
+        std::shared_ptr<const TlsContext> const _tlsContext;
+
+        // buildInfo/serverStatus results of current connection, cleared on (re)connect
+        ServerCapabilities _capabilities;
     };
 
 }
\ No newline at end of file
@@ -9,4 +9,10 @@ namespace Robomongo
                            : setName(setName), primary(primary), membersAndHealths(membersAndHealths), 
                            errorStr(errorStr)
     {}
+
+    bool ReplicaSet::sameTopology(ReplicaSet const& other) const
+    {
+        return setName == other.setName && primary == other.primary && 
+               membersAndHealths == other.membersAndHealths;
+    }
 }
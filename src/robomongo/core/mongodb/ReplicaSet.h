@@ -15,6 +15,11 @@ namespace Robomongo
 
         ReplicaSet() {};
 
+        /**
+        * @brief Returns true if set name, primary and members (with their health) are the same.
+        */
+        bool sameTopology(ReplicaSet const& other) const;
+
         std::string const setName;
         mongo::HostAndPort const primary;        
         std::string const errorStr;
@@ -0,0 +1,254 @@
+#include "robomongo/core/mongodb/ScramAuth.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <QMessageAuthenticationCode>
+#include <QRandomGenerator>
+
+#include <mongo/client/dbclient_base.h>
+
+#include "robomongo/core/settings/CredentialSettings.h"
+
+namespace Robomongo
+{
+namespace ScramAuth
+{
+    namespace
+    {
+        const int ClientNonceBytes = 24;
+        const int MaxEmptyExchanges = 8;
+
+        // Fewer iterations make proof easy to crack, driver rejects them too
+        const int MinIterations = 4096;
+
+        std::mutex cacheMutex;
+        std::map<std::string, Keys> cache;
+        std::atomic<unsigned long long> derivationCount { 0 };
+
+        QCryptographicHash::Algorithm algorithmOf(const std::string &mechanism)
+        {
+            return mechanism == "SCRAM-SHA-256" ? QCryptographicHash::Sha256 : QCryptographicHash::Sha1;
+        }
+
+        QByteArray hmac(QCryptographicHash::Algorithm algorithm, const QByteArray &key, const QByteArray &message)
+        {
+            return QMessageAuthenticationCode::hash(message, key, algorithm);
+        }
+
+        QByteArray exclusiveOr(QByteArray left, const QByteArray &right)
+        {
+            for (int i = 0; i < left.size() && i < right.size(); ++i)
+                left[i] = static_cast<char>(left[i] ^ right[i]);
+            return left;
+        }
+
+        // Saslname of RFC 5802: ',' and '=' are escaped
+        QByteArray saslName(const std::string &user)
+        {
+            QByteArray name = QByteArray::fromStdString(user);
+            name.replace("=", "=3D");
+            name.replace(",", "=2C");
+            return name;
+        }
+
+        // RFC 5802 requires unpredictable nonce, it comes from random generator of OS
+        QByteArray randomNonce()
+        {
+            quint32 words[ClientNonceBytes / sizeof(quint32)];
+            QRandomGenerator::system()->fillRange(words);
+            return QByteArray(reinterpret_cast<const char *>(words), sizeof(words)).toBase64();
+        }
+
+        // Value of "x=value" attribute of SCRAM message, empty if there is no such
+        QByteArray attribute(const QByteArray &message, char name)
+        {
+            for (const QByteArray &part : message.split(',')) {
+                if (part.size() >= 2 && part[0] == name && part[1] == '=')
+                    return part.mid(2);
+            }
+            return QByteArray();
+        }
+
+        // MongoDB uses the digest of SCRAM-SHA-1 for MONGODB-CR, server keeps the same one
+        QByteArray scramPassword(const CredentialSettings *credentials)
+        {
+            std::string const password = credentials->userPassword();
+            if (credentials->mechanism() == "SCRAM-SHA-256")
+                return QByteArray::fromStdString(password);
+
+            std::string const digest = credentials->userName() + ":mongo:" + password;
+            return QCryptographicHash::hash(QByteArray::fromStdString(digest), QCryptographicHash::Md5).toHex();
+        }
+
+        Keys cachedKeys(QCryptographicHash::Algorithm algorithm, const CredentialSettings *credentials,
+                        const QByteArray &salt, int iterations)
+        {
+            QByteArray const password = scramPassword(credentials);
+            std::string key = credentials->mechanism() + '\n' + credentials->userName() + '\n' +
+                              std::to_string(iterations) + '\n' + salt.toBase64().toStdString() + '\n';
+            key += QCryptographicHash::hash(password, QCryptographicHash::Sha256).toStdString();
+
+            {
+                std::lock_guard<std::mutex> lock(cacheMutex);
+                auto const found = cache.find(key);
+                if (found != cache.end())
+                    return found->second;
+            }
+
+            // Derived without lock: two connections may derive the same keys at once
+            Keys const keys = deriveKeys(algorithm, password, salt, iterations);
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            cache[key] = keys;
+            return keys;
+        }
+
+        mongo::BSONObj runSaslCommand(mongo::DBClientBase *conn, const std::string &database,
+                                      mongo::BSONObjBuilder &command, const QByteArray &payload)
+        {
+            command.appendBinData("payload", payload.size(), mongo::BinDataGeneral, payload.constData());
+
+            mongo::BSONObj reply;
+            if (!conn->runCommand(database, command.obj(), reply)) {
+                std::string const message = reply["errmsg"].str();
+                throw std::runtime_error("Authentication failed: " + (message.empty() ? reply.toString() : message));
+            }
+            return reply;
+        }
+
+        QByteArray payloadOf(const mongo::BSONObj &reply)
+        {
+            mongo::BSONElement const payload = reply["payload"];
+            if (payload.type() == mongo::BinData) {
+                int length = 0;
+                const char *data = payload.binData(length);
+                return QByteArray(data, length);
+            }
+            return QByteArray::fromStdString(payload.str());
+        }
+    }
+
+    bool isSupported(const CredentialSettings *credentials)
+    {
+        std::string const mechanism = credentials->mechanism();
+        if (mechanism != "SCRAM-SHA-1" && mechanism != "SCRAM-SHA-256")
+            return false;
+
+        // SASLprep leaves printable ASCII as it is
+        for (char const ch : credentials->userPassword()) {
+            if (ch < 0x20 || ch > 0x7E)
+                return false;
+        }
+        return true;
+    }
+
+    void authenticate(mongo::DBClientBase *conn, const CredentialSettings *credentials)
+    {
+        std::string const database = credentials->databaseName();
+        QCryptographicHash::Algorithm const algorithm = algorithmOf(credentials->mechanism());
+        Conversation conversation(algorithm, credentials->userName(), randomNonce());
+
+        mongo::BSONObjBuilder start;
+        start.append("saslStart", 1);
+        start.append("mechanism", credentials->mechanism());
+        start.append("options", BSON("skipEmptyExchange" << true));
+        mongo::BSONObj reply = runSaslCommand(conn, database, start, conversation.clientFirst());
+
+        if (!conversation.parseServerFirst(payloadOf(reply)))
+            throw std::runtime_error("Authentication failed: malformed SCRAM server-first message");
+
+        Keys const keys = cachedKeys(algorithm, credentials, conversation.salt(), conversation.iterations());
+        int const conversationId = reply["conversationId"].numberInt();
+
+        mongo::BSONObjBuilder next;
+        next.append("saslContinue", 1);
+        next.append("conversationId", conversationId);
+        reply = runSaslCommand(conn, database, next, conversation.clientFinal(keys));
+
+        if (!conversation.verifyServerFinal(keys, payloadOf(reply)))
+            throw std::runtime_error("Authentication failed: server signature does not match");
+
+        // Servers without skipEmptyExchange wait for one more empty message
+        for (int step = 0; !reply["done"].trueValue(); ++step) {
+            if (step == MaxEmptyExchanges)
+                throw std::runtime_error("Authentication failed: SCRAM conversation is not done");
+
+            mongo::BSONObjBuilder empty;
+            empty.append("saslContinue", 1);
+            empty.append("conversationId", conversationId);
+            reply = runSaslCommand(conn, database, empty, QByteArray());
+        }
+    }
+
+    unsigned long long derivations()
+    {
+        return derivationCount.load();
+    }
+
+    Keys deriveKeys(QCryptographicHash::Algorithm algorithm, const QByteArray &password,
+                    const QByteArray &salt, int iterations)
+    {
+        ++derivationCount;
+
+        // Hi() of RFC 5802 is PBKDF2 with HMAC, of one block
+        QMessageAuthenticationCode mac(algorithm, password);
+        mac.addData(salt);
+        mac.addData(QByteArray::fromRawData("\0\0\0\1", 4));
+        QByteArray previous = mac.result();
+        QByteArray saltedPassword = previous;
+        for (int i = 1; i < iterations; ++i) {
+            mac.reset();
+            mac.addData(previous);
+            previous = mac.result();
+            saltedPassword = exclusiveOr(saltedPassword, previous);
+        }
+
+        Keys keys;
+        keys.clientKey = hmac(algorithm, saltedPassword, "Client Key");
+        keys.storedKey = QCryptographicHash::hash(keys.clientKey, algorithm);
+        keys.serverKey = hmac(algorithm, saltedPassword, "Server Key");
+        return keys;
+    }
+
+    Conversation::Conversation(QCryptographicHash::Algorithm algorithm, const std::string &user,
+                               const QByteArray &clientNonce) :
+        _algorithm(algorithm),
+        _clientFirstBare("n=" + saslName(user) + ",r=" + clientNonce),
+        _clientNonce(clientNonce),
+        _iterations(0)
+    {
+    }
+
+    QByteArray Conversation::clientFirst() const
+    {
+        return "n,," + _clientFirstBare;
+    }
+
+    bool Conversation::parseServerFirst(const QByteArray &serverFirst)
+    {
+        _serverFirst = serverFirst;
+        _nonce = attribute(serverFirst, 'r');
+        _salt = QByteArray::fromBase64(attribute(serverFirst, 's'));
+        _iterations = attribute(serverFirst, 'i').toInt();
+        return _nonce.size() > _clientNonce.size() && _nonce.startsWith(_clientNonce) &&
+               !_salt.isEmpty() && _iterations >= MinIterations;
+    }
+
+    QByteArray Conversation::clientFinal(const Keys &keys)
+    {
+        // "biws" is base64 of "n,,": no channel binding
+        QByteArray const withoutProof = "c=biws,r=" + _nonce;
+        _authMessage = _clientFirstBare + "," + _serverFirst + "," + withoutProof;
+
+        QByteArray const signature = hmac(_algorithm, keys.storedKey, _authMessage);
+        return withoutProof + ",p=" + exclusiveOr(keys.clientKey, signature).toBase64();
+    }
+
+    bool Conversation::verifyServerFinal(const Keys &keys, const QByteArray &serverFinal) const
+    {
+        QByteArray const signature = QByteArray::fromBase64(attribute(serverFinal, 'v'));
+        return !signature.isEmpty() && signature == hmac(_algorithm, keys.serverKey, _authMessage);
+    }
+}
+}
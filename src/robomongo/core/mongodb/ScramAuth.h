@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <QByteArray>
+#include <QCryptographicHash>
+
+namespace mongo
+{
+    class DBClientBase;
+}
+
+namespace Robomongo
+{
+    class CredentialSettings;
+
+    /**
+     * @brief SCRAM-SHA-1 and SCRAM-SHA-256 authentication (RFC 5802, RFC 7677) by saslStart
+     *        and saslContinue commands. Unlike driver, which derives keys from password anew
+     *        for every host and port (every SSH forward is a new one), client and server keys
+     *        are kept for the session by mechanism, user, password, salt and iteration count,
+     *        so that PBKDF2 runs once per credential.
+     *
+     *        Driver does not know about connections authenticated here: they do not
+     *        authenticate again by auto reconnect, and must be dropped once failed.
+     * @threadsafe
+     */
+    namespace ScramAuth
+    {
+        /**
+         * @brief SCRAM mechanism, with password which needs no SASLprep (printable ASCII).
+         *        Other credentials are authenticated by driver.
+         */
+        bool isSupported(const CredentialSettings *credentials);
+
+        /**
+         * @brief Throws std::runtime_error if server rejects credentials, or does not prove
+         *        it knows them
+         */
+        void authenticate(mongo::DBClientBase *conn, const CredentialSettings *credentials);
+
+        // Derivations run since the start of session, that is, cache misses
+        unsigned long long derivations();
+
+        struct Keys
+        {
+            QByteArray clientKey;
+            QByteArray storedKey;
+            QByteArray serverKey;
+        };
+
+        /**
+         * @brief Client side of one conversation, without network and cache, so that it can be
+         *        checked against examples of RFCs. Password of SCRAM-SHA-1 is the MongoDB digest.
+         */
+        class Conversation
+        {
+        public:
+            Conversation(QCryptographicHash::Algorithm algorithm, const std::string &user,
+                         const QByteArray &clientNonce);
+
+            QByteArray clientFirst() const;
+
+            /**
+             * @brief Parses server-first message, returns false if it is malformed, server
+             *        nonce does not start with client one or it asks for fewer than 4096 iterations
+             */
+            bool parseServerFirst(const QByteArray &serverFirst);
+            const QByteArray &salt() const { return _salt; }
+            int iterations() const { return _iterations; }
+
+            QByteArray clientFinal(const Keys &keys);
+            bool verifyServerFinal(const Keys &keys, const QByteArray &serverFinal) const;
+
+        private:
+            QCryptographicHash::Algorithm const _algorithm;
+            QByteArray const _clientFirstBare;
+            QByteArray const _clientNonce;
+            QByteArray _serverFirst;
+            QByteArray _nonce;
+            QByteArray _salt;
+            int _iterations;
+            QByteArray _authMessage;
+        };
+
+        Keys deriveKeys(QCryptographicHash::Algorithm algorithm, const QByteArray &password,
+                        const QByteArray &salt, int iterations);
+    }
+}
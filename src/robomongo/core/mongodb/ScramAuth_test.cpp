@@ -0,0 +1,48 @@
+#include "gtest/gtest.h"
+#include "ScramAuth.h"
+
+using namespace Robomongo;
+
+// Examples of RFC 5802 (password is used as is, not as MongoDB digest) and of RFC 7677
+TEST(scram_auth_tests, sha1_conversation)
+{
+    ScramAuth::Conversation conversation(QCryptographicHash::Sha1, "user", "fyko+d2lbbFgONRv9qkxdawL");
+    EXPECT_EQ(QByteArray("n,,n=user,r=fyko+d2lbbFgONRv9qkxdawL"), conversation.clientFirst());
+
+    ASSERT_TRUE(conversation.parseServerFirst("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096"));
+    EXPECT_EQ(4096, conversation.iterations());
+
+    ScramAuth::Keys const keys = ScramAuth::deriveKeys(QCryptographicHash::Sha1, "pencil",
+                                                       conversation.salt(), conversation.iterations());
+    EXPECT_EQ(QByteArray("c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts="),
+              conversation.clientFinal(keys));
+    EXPECT_TRUE(conversation.verifyServerFinal(keys, "v=rmF9pqV8S7suAoZWja4dJRkFsKQ="));
+    EXPECT_FALSE(conversation.verifyServerFinal(keys, "v=AAAApqV8S7suAoZWja4dJRkFsKQ="));
+}
+
+TEST(scram_auth_tests, sha256_conversation)
+{
+    ScramAuth::Conversation conversation(QCryptographicHash::Sha256, "user", "rOprNGfwEbeRWgbNEkqO");
+    ASSERT_TRUE(conversation.parseServerFirst(
+        "r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4096"));
+
+    ScramAuth::Keys const keys = ScramAuth::deriveKeys(QCryptographicHash::Sha256, "pencil",
+                                                       conversation.salt(), conversation.iterations());
+    EXPECT_EQ(QByteArray("c=biws,r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,"
+                         "p=dHzbZapWIk4jUhN+Ute9ytag9zjfMHgsqmmiz7AndVQ="),
+              conversation.clientFinal(keys));
+    EXPECT_TRUE(conversation.verifyServerFinal(keys, "v=6rriTRBi23WpRR/wtup+mMhUZUn/dB5nLTJRsjl95G4="));
+}
+
+TEST(scram_auth_tests, server_nonce_must_extend_client_one)
+{
+    ScramAuth::Conversation conversation(QCryptographicHash::Sha256, "a=b,c", "abc");
+    EXPECT_EQ(QByteArray("n,,n=a=3Db=2Cc,r=abc"), conversation.clientFirst());
+    EXPECT_FALSE(conversation.parseServerFirst("r=xyz123,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4096"));
+    EXPECT_FALSE(conversation.parseServerFirst("r=abc123,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=0"));
+
+    // Hostile server asking for proof that is easy to crack
+    EXPECT_FALSE(conversation.parseServerFirst("r=abc123,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=1"));
+    EXPECT_FALSE(conversation.parseServerFirst("r=abc123,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4095"));
+    EXPECT_TRUE(conversation.parseServerFirst("r=abc123,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=10000"));
+}
@@ -1,10 +1,16 @@
 #include "robomongo/core/mongodb/SshTunnelWorker.h"
 
+#include <algorithm>
+
 #include <QThread>
 #include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
 
+#include "robomongo/core/utils/HostResolver.h"
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/core/utils/Logger.h"
+#include "robomongo/core/utils/LogQueue.h"
 #include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/EventBus.h"
@@ -13,6 +19,14 @@
 #include "robomongo/ssh/ssh.h"
 #include "robomongo/core/domain/App.h"
 
+namespace
+{
+    // Authenticated SSH sessions that accept more forwards, by SshTunnelWorker::sessionKey().
+    // Accessed from GUI thread and from threads of workers.
+    QMutex sharedSessionsMutex;
+    QHash<QString, Robomongo::SshTunnelWorker*> sharedSessions;
+}
+
 namespace Robomongo
 {
     SshTunnelWorker::SshTunnelWorker(ConnectionSettings *settings) : QObject(),
@@ -32,10 +46,74 @@ namespace Robomongo
         // QThread "_thread" and MongoWorker itself will be deleted later
         // (see MongoWorker() constructor)
 
+        if (_sshSession)
+            closeSession();
+
         delete _settings;
         printf("SSH tunnel closed.\n");
     }
 
+    int SshTunnelWorker::openSharedForward(ConnectionSettings *settings) {
+        QMutexLocker lock(&sharedSessionsMutex);
+        SshTunnelWorker *worker = sharedSessions.value(sessionKey(settings));
+        if (!worker || worker->_isQuiting)
+            return 0;
+
+        std::string remotehost = settings->serverHost();
+        unsigned int localport = 0;
+        if (rbm_ssh_session_add_forward(worker->_sshSession, const_cast<char*>(remotehost.c_str()),
+                                        static_cast<unsigned int>(settings->serverPort()), &localport) != 0)
+            return 0;
+
+        return static_cast<int>(localport);
+    }
+
+    std::string SshTunnelWorker::sharedSessionMethods(ConnectionSettings *settings) {
+        QMutexLocker lock(&sharedSessionsMutex);
+        SshTunnelWorker *worker = sharedSessions.value(sessionKey(settings));
+        if (!worker || worker->_isQuiting)
+            return std::string();
+
+        return rbm_ssh_session_methods(worker->_sshSession);
+    }
+
+    QString SshTunnelWorker::sessionKey(ConnectionSettings *settings) {
+        SshSettings *ssh = settings->sshSettings();
+        QString key = QString("%1:%2|%3|%4").arg(QtUtils::toQString(ssh->host())).arg(ssh->port())
+            .arg(QtUtils::toQString(ssh->userName())).arg(QtUtils::toQString(ssh->authMethod()));
+
+        if (ssh->authMethod() == "publickey")
+            key += "|" + QtUtils::toQString(ssh->privateKeyFile());
+
+        // Records with other algorithms get sessions of their own, so they can be compared
+        key += QString("|%1|%2|%3").arg(QtUtils::toQString(ssh->ciphers())).arg(QtUtils::toQString(ssh->macs()))
+            .arg(ssh->compression());
+
+        return key;
+    }
+
+    void SshTunnelWorker::shareSession() {
+        QMutexLocker lock(&sharedSessionsMutex);
+        QString const key = sessionKey(_settings);
+        if (!sharedSessions.contains(key))
+            sharedSessions.insert(key, this);
+    }
+
+    /**
+     * @brief Stops sharing and closes SSH session. Session should not be used after this call.
+     */
+    void SshTunnelWorker::closeSession() {
+        {
+            QMutexLocker lock(&sharedSessionsMutex);
+            QString const key = sessionKey(_settings);
+            if (sharedSessions.value(key) == this)
+                sharedSessions.remove(key);
+        }
+
+        rbm_ssh_session_close(_sshSession);
+        _sshSession = NULL;
+    }
+
     void SshTunnelWorker::stopAndDelete() {
         _isQuiting = 1;
         _thread->quit();
@@ -50,6 +128,7 @@ namespace Robomongo
             _configCreator.config()->logcontext = this;
             _configCreator.config()->logcallback = &SshTunnelWorker::logCallbackHandler;
             _configCreator.config()->loglevel = (rbm_ssh_log_type) _settings->sshSettings()->logLevel(); // RBM_SSH_LOG_TYPE_DEBUG;
+            _configCreator.resolveServerHost();
 
             if ((_sshSession = rbm_ssh_session_create(_configCreator.config())) == 0) {
                 // Not much we can say about this error
@@ -60,6 +139,9 @@ namespace Robomongo
                 // Prepare copy of error message (if any)
                 std::string error(_sshSession->lasterror);
 
+                // Server may have moved, its name is looked up again on retry
+                HostResolver::instance().invalidate(_settings->sshSettings()->host());
+
                 std::stringstream ss;
                 ss << "Failed to create SSH tunnel to "
                     << _settings->sshSettings()->host() << ":"
@@ -73,6 +155,9 @@ namespace Robomongo
                 throw std::runtime_error(ss.str());
             }
 
+            // Following connections through the same SSH server open channels in this session
+            shareSession();
+
             reply(event->sender(), new EstablishSshConnectionResponse(
                     this, event->serverHandle, event->worker, event->settings, event->connectionType, _configCreator.config()->localport));
 
@@ -129,12 +214,12 @@ namespace Robomongo
                 }
 
                 // Cleanup session
-                rbm_ssh_session_close(_sshSession);
-                _sshSession = NULL;
+                closeSession();
 
                 throw std::runtime_error(ss.str());
             }
 
+            closeSession();
             log("SSH tunnel stopped normally.", false);
 
         } catch (const std::exception& ex) {
@@ -162,9 +247,8 @@ namespace Robomongo
         if (_isQuiting)
             return;
 
-        AppRegistry::instance().bus()->send(
-            AppRegistry::instance().app(),
-            new LogEvent(this, message, (LogEvent::LogLevel)level));
+        // Called for every read with SSH debug logging, see sendLog()
+        LogQueue::instance().push({ message, level, false });
     }
 
     void SshTunnelWorker::logCallbackHandler(void *context, char *message, int level) {
@@ -192,6 +276,8 @@ namespace Robomongo
         _publicKeyFile = ssh->publicKeyFile();
         _passphrase = ssh->passphrase();
         _authMethod = ssh->authMethod(); // "password" or "publickey"
+        _ciphers = ssh->ciphers();
+        _macs = ssh->macs();
 
         // Use "askedPassword" for both passphrase and password if required
         if (ssh->askPassword()) {
@@ -213,6 +299,10 @@ namespace Robomongo
         _sshConfig->publickeyfile = _publicKeyFile.empty() ? NULL : const_cast<char*>(_publicKeyFile.c_str());
         _sshConfig->passphrase = const_cast<char*>(_passphrase.c_str());
         _sshConfig->authtype = (_authMethod == "publickey") ? RBM_SSH_AUTH_TYPE_PUBLICKEY : RBM_SSH_AUTH_TYPE_PASSWORD;
+        _sshConfig->ciphers = _ciphers.empty() ? NULL : const_cast<char*>(_ciphers.c_str());
+        _sshConfig->macs = _macs.empty() ? NULL : const_cast<char*>(_macs.c_str());
+        _sshConfig->compression = ssh->compression() ? 1 : 0;
+        _sshConfig->keepaliveinterval = static_cast<unsigned int>(std::max(0, ssh->keepAliveInterval()));
 
         // Default settings
         _sshConfig->logcontext = NULL;
@@ -224,6 +314,16 @@ namespace Robomongo
     SshTunnelConfigCreator::~SshTunnelConfigCreator() {
         delete _sshConfig;
     }
+
+    void SshTunnelConfigCreator::resolveServerHost() {
+        // Unresolved name is left to ssh.c, which reports the failure
+        std::string const address = HostResolver::instance().resolve(_sshhost);
+        if (address.empty())
+            return;
+
+        _sshhost = address;
+        _sshConfig->sshserverhost = const_cast<char*>(_sshhost.c_str());
+    }
 }
 
 
@@ -28,6 +28,12 @@ namespace Robomongo
         ~SshTunnelConfigCreator();
         rbm_ssh_tunnel_config *config() { return _sshConfig; }
 
+        /**
+         * @brief Replaces host name of SSH server with its address, cached by HostResolver
+         *        for reconnects. Blocks until host is resolved, so it is not called in GUI thread.
+         */
+        void resolveServerHost();
+
     private:
         std::string _sshhost;
         int _sshport;
@@ -42,6 +48,8 @@ namespace Robomongo
         std::string _publicKeyFile;
         std::string _passphrase;
         std::string _authMethod; // "password" or "publickey"
+        std::string _ciphers;
+        std::string _macs;
 
         rbm_ssh_tunnel_config* _sshConfig;
     };
@@ -56,6 +64,19 @@ namespace Robomongo
 
         static void logCallbackHandler(void* context, char *message, int level);
 
+        /**
+         * @brief Forwards one more local port to the server of "settings" through
+         * already authenticated SSH session to the same SSH server, user and key (if any).
+         * @return Local port, or 0 if there is no such session
+         */
+        static int openSharedForward(ConnectionSettings *settings);
+
+        /**
+         * @brief Cipher, MAC and compression of the shared session of "settings" (see
+         * rbm_ssh_session_methods), empty if there is no such session
+         */
+        static std::string sharedSessionMethods(ConnectionSettings *settings);
+
     protected:
         void stopAndDelete();
 
@@ -67,6 +88,10 @@ namespace Robomongo
         void reply(QObject *receiver, Event *event);
         void log(const std::string& message, int level = 3);
 
+        static QString sessionKey(ConnectionSettings *settings);
+        void shareSession();
+        void closeSession();
+
         QThread *_thread;
         QAtomicInteger<int> _isQuiting;
         ConnectionSettings* _settings;
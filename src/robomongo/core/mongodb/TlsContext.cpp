@@ -0,0 +1,137 @@
+#include "robomongo/core/mongodb/TlsContext.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include <mongo/util/net/ssl_options.h>
+
+#include "robomongo/core/settings/SslSettings.h"
+
+namespace
+{
+    using Robomongo::TlsContext;
+
+    std::mutex globalMutex;
+    std::condition_variable released;
+
+    // Parameters in sslGlobalParams, and number of Guards using them
+    TlsContext::Params applied;
+    bool anyApplied = false;
+    int holders = 0;
+    int waiting = 0;    // Guards of other parameters, new Guards of applied ones do not overtake them
+
+    // Guards of this thread, nested ones (i.e. member connection opened during refresh)
+    // share the outer one; a thread uses context of one connection record
+    thread_local int threadGuards = 0;
+
+    // Contexts in use, by their parameters. Expired ones are replaced on next lookup.
+    std::vector<std::weak_ptr<const TlsContext>> contexts;
+}
+
+namespace Robomongo
+{
+    bool TlsContext::Params::operator==(const Params &other) const
+    {
+        return std::tie(enabled, allowInvalidCertificates, allowInvalidHostnames,
+                        caFile, pemKeyFile, pemKeyPassword, crlFile) ==
+               std::tie(other.enabled, other.allowInvalidCertificates, other.allowInvalidHostnames,
+                        other.caFile, other.pemKeyFile, other.pemKeyPassword, other.crlFile);
+    }
+
+    TlsContext::Params TlsContext::paramsOf(const SslSettings *settings)
+    {
+        Params params;
+        if (!settings->sslEnabled())
+            return params;
+
+        params.enabled = true;
+        params.allowInvalidCertificates = settings->allowInvalidCertificates();
+        if (!params.allowInvalidCertificates)
+            params.caFile = settings->caFile();
+
+        if (settings->usePemFile()) {
+            params.pemKeyFile = settings->pemKeyFile();
+            params.pemKeyPassword = settings->pemPassPhrase();
+        }
+
+        if (settings->useAdvancedOptions()) {
+            params.crlFile = settings->crlFile();
+            params.allowInvalidHostnames = settings->allowInvalidHostnames();
+        }
+        return params;
+    }
+
+    std::shared_ptr<const TlsContext> TlsContext::of(const SslSettings *settings)
+    {
+        Params const params = paramsOf(settings);
+
+        std::lock_guard<std::mutex> lock(globalMutex);
+        std::shared_ptr<const TlsContext> result;
+        for (auto it = contexts.begin(); it != contexts.end(); ) {
+            std::shared_ptr<const TlsContext> context = it->lock();
+            if (!context) {
+                it = contexts.erase(it);
+                continue;
+            }
+            if (!result && context->params() == params)
+                result = context;
+            ++it;
+        }
+
+        if (!result) {
+            result = std::make_shared<const TlsContext>(params);
+            contexts.push_back(result);
+        }
+        return result;
+    }
+
+    void TlsContext::apply() const
+    {
+        mongo::sslGlobalParams.sslMode.store(_params.enabled ? mongo::SSLParams::SSLMode_requireSSL
+                                                             : mongo::SSLParams::SSLMode_allowSSL);
+        mongo::sslGlobalParams.sslAllowInvalidCertificates = _params.allowInvalidCertificates;
+        mongo::sslGlobalParams.sslCAFile = _params.caFile;
+        mongo::sslGlobalParams.sslPEMKeyFile = _params.pemKeyFile;
+        mongo::sslGlobalParams.sslPEMKeyPassword = _params.pemKeyPassword;
+        mongo::sslGlobalParams.sslCRLFile = _params.crlFile;
+        mongo::sslGlobalParams.sslAllowInvalidHostnames = _params.allowInvalidHostnames;
+    }
+
+    TlsContext::Guard::Guard(const TlsContext &context)
+    {
+        if (threadGuards++ > 0)
+            return;
+
+        std::unique_lock<std::mutex> lock(globalMutex);
+        bool const other = holders > 0 && applied != context.params();
+        if (other) {
+            ++waiting;
+            released.wait(lock, [] { return holders == 0; });
+            --waiting;
+        }
+        else if (waiting > 0) {
+            released.wait(lock, [] { return holders == 0; });
+        }
+
+        if (!anyApplied || applied != context.params()) {
+            context.apply();
+            applied = context.params();
+            anyApplied = true;
+        }
+        ++holders;
+    }
+
+    TlsContext::Guard::~Guard()
+    {
+        if (--threadGuards > 0)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(globalMutex);
+            --holders;
+        }
+        released.notify_all();
+    }
+}
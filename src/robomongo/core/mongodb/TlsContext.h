@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace Robomongo
+{
+    class SslSettings;
+
+    /**
+     * @brief TLS parameters of connection record. The driver takes them from process-wide
+     *        mongo::sslGlobalParams while connection is established, so they are written
+     *        there only by Guard of context: connections with equal parameters are opened
+     *        in parallel, others wait until those are connected.
+     *
+     *        Parameters stay applied after the last Guard is released, so reconnects with
+     *        the same context do not rewrite them (nor make driver drop its TLS setup).
+     */
+    class TlsContext
+    {
+    public:
+        struct Params
+        {
+            bool enabled = false;
+            bool allowInvalidCertificates = false;
+            bool allowInvalidHostnames = false;
+            std::string caFile;
+            std::string pemKeyFile;
+            std::string pemKeyPassword;
+            std::string crlFile;
+
+            bool operator==(const Params &other) const;
+            bool operator!=(const Params &other) const { return !(*this == other); }
+        };
+
+        // Parameters of settings, as they were put to sslGlobalParams before
+        static Params paramsOf(const SslSettings *settings);
+
+        // Context of settings, shared with other connections of the same parameters
+        static std::shared_ptr<const TlsContext> of(const SslSettings *settings);
+
+        explicit TlsContext(const Params &params) : _params(params) {}
+
+        const Params &params() const { return _params; }
+
+        /**
+         * @brief Keeps parameters of context in sslGlobalParams as long as it exists.
+         *        Blocks, while connections of other parameters are being established.
+         *        Guard nested in the same thread does nothing.
+         */
+        class Guard
+        {
+        public:
+            explicit Guard(const TlsContext &context);
+            ~Guard();
+
+            Guard(const Guard &) = delete;
+            Guard &operator=(const Guard &) = delete;
+        };
+
+    private:
+        void apply() const;
+
+        Params const _params;
+    };
+}
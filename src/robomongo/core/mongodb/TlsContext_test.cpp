@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+#include "TlsContext.h"
+
+#include "robomongo/core/settings/SslSettings.h"
+
+using namespace Robomongo;
+
+TEST(tls_context_tests, equal_settings_share_context)
+{
+    SslSettings first;
+    first.enableSSL(true);
+    first.setCaFile("/etc/ssl/ca.pem");
+    first.setCrlFile("/etc/ssl/crl.pem");   // ignored without advanced options
+
+    SslSettings second;
+    second.enableSSL(true);
+    second.setCaFile("/etc/ssl/ca.pem");
+
+    auto const context = TlsContext::of(&first);
+    EXPECT_EQ(context, TlsContext::of(&second));
+    EXPECT_EQ("", context->params().crlFile);
+
+    second.setAllowInvalidCertificates(true);
+    auto const other = TlsContext::of(&second);
+    EXPECT_NE(context, other);
+    EXPECT_EQ("", other->params().caFile);
+}
+
+TEST(tls_context_tests, disabled_settings_have_no_parameters)
+{
+    SslSettings settings;
+    settings.setCaFile("/etc/ssl/ca.pem");
+    settings.setUsePemFile(true);
+    settings.setPemKeyFile("/etc/ssl/client.pem");
+
+    TlsContext::Params const params = TlsContext::paramsOf(&settings);
+    EXPECT_FALSE(params.enabled);
+    EXPECT_TRUE(params == TlsContext::Params());
+}
@@ -0,0 +1,201 @@
+#include "robomongo/core/mongodb/WarmConnections.h"
+
+#include <thread>
+#include <QCryptographicHash>
+
+#include <mongo/bson/bsonobjbuilder.h>
+#include <mongo/client/dbclient_connection.h>
+
+#include "robomongo/core/mongodb/DriverMetrics.h"
+#include "robomongo/core/mongodb/TlsContext.h"
+#include "robomongo/core/mongodb/WireCompression.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/settings/CredentialSettings.h"
+#include "robomongo/core/settings/SshSettings.h"
+#include "robomongo/core/settings/SslSettings.h"
+#include "robomongo/core/utils/HostResolver.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace
+{
+    std::string const AppName { "robo3t-" + std::string(PROJECT_VERSION) };
+
+    std::string recordKey(const Robomongo::ConnectionSettings *settings)
+    {
+        QString const uuid = settings->uuid();
+        return uuid.isEmpty() ? settings->connectionName() : Robomongo::QtUtils::toStdString(uuid);
+    }
+
+    // Everything connection depends on, secrets hashed
+    std::string fingerprintOf(const Robomongo::ConnectionSettings *settings)
+    {
+        using namespace Robomongo;
+        SslSettings const *const ssl = settings->sslSettings();
+        std::string text = settings->hostAndPort().toString() + "|" + settings->compressors();
+        if (ssl->sslEnabled()) {
+            text += "|tls|" + ssl->caFile() + "|" + ssl->pemKeyFile() + "|" + ssl->pemPassPhrase() + "|" +
+                ssl->crlFile() + "|" + std::to_string(ssl->allowInvalidHostnames()) +
+                std::to_string(ssl->allowInvalidCertificates());
+        }
+
+        if (settings->hasEnabledPrimaryCredential()) {
+            CredentialSettings const *const credential = settings->primaryCredential();
+            text += "|auth|" + credential->databaseName() + "|" + credential->userName() + "|" +
+                credential->mechanism() + "|" + credential->userPassword();
+        }
+
+        QByteArray const hash = QCryptographicHash::hash(QByteArray::fromStdString(text),
+                                                         QCryptographicHash::Sha256);
+        return hash.toHex().toStdString();
+    }
+}
+
+namespace Robomongo
+{
+    constexpr std::chrono::seconds WarmConnections::Ttl;
+    constexpr int WarmConnections::PerRecord;
+
+    WarmConnections &WarmConnections::instance()
+    {
+        // Never deleted, threads of warm connections may outlive static destruction
+        static WarmConnections *const connections = new WarmConnections;
+        return *connections;
+    }
+
+    bool WarmConnections::isWarmable(const ConnectionSettings *settings)
+    {
+        return settings && !settings->isReplicaSet() && !settings->sshSettings()->enabled() &&
+            !(settings->sslSettings()->sslEnabled() && settings->sslSettings()->askPassphrase());
+    }
+
+    void WarmConnections::warm(const ConnectionSettings *settings, double timeoutSec)
+    {
+        if (!isWarmable(settings))
+            return;
+
+        std::string const key = recordKey(settings);
+        std::string const fingerprint = fingerprintOf(settings);
+        int missing = PerRecord;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            missing -= static_cast<int>(_opening.count(key));
+            auto const range = _entries.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second.fingerprint == fingerprint)
+                    --missing;
+            }
+
+            for (int i = 0; i < missing; ++i)
+                _opening.insert(key);
+        }
+
+        if (missing <= 0)
+            return;
+
+        // Threads own a copy, record may be edited or removed meanwhile
+        std::shared_ptr<ConnectionSettings> const copy(settings->clone());
+        for (int i = 0; i < missing; ++i)
+            std::thread(&WarmConnections::open, this, copy, key, fingerprint, timeoutSec).detach();
+    }
+
+    WarmConnections::Connection WarmConnections::take(const ConnectionSettings *settings)
+    {
+        Connection taken;
+        if (!isWarmable(settings))
+            return taken;
+
+        std::string const key = recordKey(settings);
+        std::string const fingerprint = fingerprintOf(settings);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto const range = _entries.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second.fingerprint != fingerprint || it->second.expiresAt <= Clock::now())
+                    continue;
+
+                taken = std::move(it->second.connection);
+                _entries.erase(it);
+                break;
+            }
+        }
+        _taken.notify_all();
+
+        // Server could have closed it meanwhile
+        if (taken.conn && (taken.conn->isFailed() || !taken.conn->isStillConnected()))
+            return Connection();
+        return taken;
+    }
+
+    void WarmConnections::open(std::shared_ptr<ConnectionSettings> settings, std::string key,
+                               std::string fingerprint, double timeoutSec)
+    {
+        Connection connection;
+        try {
+            std::shared_ptr<const TlsContext> const tlsContext = TlsContext::of(settings->sslSettings());
+            TlsContext::Guard tls(*tlsContext);
+            connection.conn.reset(new mongo::DBClientConnection { true, timeoutSec });
+            WireCompression::configure(connection.conn.get(), settings.get());
+            DriverMetrics::install(connection.conn.get(), settings.get());
+
+            // Name of TLS server is verified against its certificate, see MongoWorker::connectAddress()
+            mongo::HostAndPort address = settings->hostAndPort();
+            if (!settings->sslSettings()->sslEnabled()) {
+                std::string const resolved = HostResolver::instance().resolve(address.host());
+                if (!resolved.empty())
+                    address = mongo::HostAndPort(resolved, address.port());
+            }
+
+            mongo::Status const status = connection.conn->connect(address, AppName);
+            if (!status.isOK())
+                connection.conn.reset();
+            else if (settings->hasEnabledPrimaryCredential()) {
+                CredentialSettings const *const credential = settings->primaryCredential();
+                connection.conn->auth(mongo::BSONObjBuilder()
+                    .append("user", credential->userName())
+                    .append("db", credential->databaseName())
+                    .append("pwd", credential->userPassword())
+                    .append("mechanism", credential->mechanism())
+                    .obj());
+                connection.authenticated = true;
+            }
+        }
+        catch (const std::exception &) {
+            // Connect of worker reports the failure
+            connection = Connection();
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _opening.erase(_opening.find(key));
+        if (!connection.conn)
+            return;
+
+        Entry entry;
+        entry.fingerprint = fingerprint;
+        entry.expiresAt = Clock::now() + Ttl;
+        entry.connection = std::move(connection);
+        auto const added = _entries.emplace(key, std::move(entry));
+        mongo::DBClientConnection *const conn = added->second.connection.conn.get();
+
+        // Until taken or expired, then it is closed outside of lock (declared before it)
+        auto isTaken = [&]() {
+            auto const range = _entries.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second.connection.conn.get() == conn)
+                    return false;
+            }
+            return true;
+        };
+        Clock::time_point const expiresAt = added->second.expiresAt;
+        if (_taken.wait_until(lock, expiresAt, isTaken))
+            return;
+
+        auto const range = _entries.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.connection.conn.get() == conn) {
+                connection = std::move(it->second.connection);
+                _entries.erase(it);
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace mongo
+{
+    class DBClientConnection;
+}
+
+namespace Robomongo
+{
+    class ConnectionSettings;
+
+    /**
+     * @brief Connections opened speculatively while record is selected or hovered in
+     *        ConnectionsDialog: host resolved, TCP and TLS connected, handshake and
+     *        authentication done. MongoWorker of the record takes them instead of connecting,
+     *        those not taken are closed after Ttl.
+     *
+     *        Single servers only: replica set connection discovers topology first, and SSH
+     *        record (or one asking for TLS passphrase) would prompt or open sessions just
+     *        because it was looked at. Thread-safe.
+     */
+    class WarmConnections
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        static constexpr std::chrono::seconds Ttl { 30 };
+
+        // Worker and metadata worker of server connect in parallel
+        static constexpr int PerRecord = 2;
+
+        struct Connection
+        {
+            std::unique_ptr<mongo::DBClientConnection> conn;    // null if there was none
+            bool authenticated = false;     // by primary credential of record
+        };
+
+        static WarmConnections &instance();
+
+        static bool isWarmable(const ConnectionSettings *settings);
+
+        /**
+         * @brief Starts opening PerRecord connections of record in background, unless they
+         *        are open or being opened. Failures are not reported, connect does it again.
+         */
+        void warm(const ConnectionSettings *settings, double timeoutSec);
+
+        /**
+         * @brief Warm connection of record, if it was opened with the same address, TLS
+         *        parameters and credential as 'settings' have now. Socket timeout is the one
+         *        passed to warm().
+         */
+        Connection take(const ConnectionSettings *settings);
+
+    private:
+        struct Entry
+        {
+            std::string fingerprint;
+            Clock::time_point expiresAt;
+            Connection connection;
+        };
+
+        WarmConnections() = default;
+
+        // Opens connection of 'settings' (owned clone) and keeps it until taken or expired
+        void open(std::shared_ptr<ConnectionSettings> settings, std::string key,
+                  std::string fingerprint, double timeoutSec);
+
+        std::mutex _mutex;
+        std::condition_variable _taken;
+        std::multimap<std::string, Entry> _entries;     // by record
+        std::multiset<std::string> _opening;            // records being connected
+    };
+}
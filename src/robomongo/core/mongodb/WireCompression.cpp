@@ -0,0 +1,141 @@
+#include "robomongo/core/mongodb/WireCompression.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <mongo/client/dbclient_connection.h>
+#include <mongo/transport/message_compressor_manager.h>
+#include <mongo/transport/message_compressor_registry.h>
+#include <mongo/transport/message_compressor_snappy.h>
+#include <mongo/transport/message_compressor_zlib.h>
+#include <mongo/transport/message_compressor_zstd.h>
+
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace WireCompression
+    {
+        const std::vector<std::string> Available = { "zstd", "snappy", "zlib" };
+
+        namespace
+        {
+            std::mutex registriesMutex;
+
+            // Registry key -> registry. Registries are never destroyed: connections keep
+            // pointers to them, and totals of edited records are not lost.
+            std::map<std::string, std::unique_ptr<mongo::MessageCompressorRegistry>> registries;
+
+            std::string recordKey(const ConnectionSettings *settings)
+            {
+                QString const uuid = settings->uuid();
+                return uuid.isEmpty() ? settings->connectionName() : QtUtils::toStdString(uuid);
+            }
+
+            std::string formatBytes(long long bytes)
+            {
+                char buffer[32];
+                if (bytes >= 1024 * 1024)
+                    std::snprintf(buffer, sizeof(buffer), "%.1f MB", bytes / (1024.0 * 1024.0));
+                else
+                    std::snprintf(buffer, sizeof(buffer), "%.1f KB", bytes / 1024.0);
+                return buffer;
+            }
+        }
+
+        std::vector<std::string> parse(const std::string &list)
+        {
+            std::vector<std::string> names;
+            size_t start = 0;
+            while (start <= list.size()) {
+                size_t end = list.find(',', start);
+                if (end == std::string::npos)
+                    end = list.size();
+
+                std::string name = list.substr(start, end - start);
+                name.erase(0, name.find_first_not_of(" \t"));
+                name.erase(name.find_last_not_of(" \t") + 1);
+                if (std::find(Available.begin(), Available.end(), name) != Available.end() &&
+                    std::find(names.begin(), names.end(), name) == names.end())
+                    names.push_back(name);
+
+                start = end + 1;
+            }
+            return names;
+        }
+
+        void configure(mongo::DBClientConnection *conn, const ConnectionSettings *settings)
+        {
+            std::vector<std::string> names = parse(settings->compressors());
+            if (names.empty())
+                return;
+
+            std::string key = recordKey(settings);
+            for (auto const &name : names)
+                key += "|" + name;
+
+            std::lock_guard<std::mutex> lock(registriesMutex);
+            auto &registry = registries[key];
+            if (!registry) {
+                registry.reset(new mongo::MessageCompressorRegistry);
+                registry->setSupportedCompressors(std::move(names));
+                registry->registerImplementation(std::make_unique<mongo::ZstdMessageCompressor>());
+                registry->registerImplementation(std::make_unique<mongo::SnappyMessageCompressor>());
+                registry->registerImplementation(std::make_unique<mongo::ZlibMessageCompressor>());
+                uassertStatusOK(registry->finalizeSupportedCompressors());
+            }
+
+            conn->getCompressorManager() = mongo::MessageCompressorManager(registry.get());
+        }
+
+        Stats stats(const ConnectionSettings *settings)
+        {
+            std::string const prefix = recordKey(settings) + "|";
+
+            Stats result;
+            std::lock_guard<std::mutex> lock(registriesMutex);
+            for (auto const &entry : registries) {
+                if (entry.first.compare(0, prefix.size(), prefix) != 0)
+                    continue;
+
+                for (auto const &name : Available) {
+                    mongo::MessageCompressorBase *const compressor = entry.second->getCompressor(name);
+                    if (!compressor)
+                        continue;
+
+                    // Compressor: bytes in are plain, bytes out compressed. Decompressor the other way.
+                    long long const plain = compressor->getCompressorBytesIn() + compressor->getDecompressorBytesOut();
+                    long long const packed = compressor->getCompressorBytesOut() + compressor->getDecompressorBytesIn();
+                    if (plain == 0)
+                        continue;
+
+                    result.uncompressedBytes += plain;
+                    result.compressedBytes += packed;
+                    if (std::find(result.used.begin(), result.used.end(), name) == result.used.end())
+                        result.used.push_back(name);
+                }
+            }
+            return result;
+        }
+
+        std::string describe(const Stats &stats)
+        {
+            if (stats.used.empty() || stats.compressedBytes <= 0)
+                return std::string();
+
+            std::string names;
+            for (auto const &name : stats.used)
+                names += (names.empty() ? "" : ", ") + name;
+
+            char ratio[32];
+            std::snprintf(ratio, sizeof(ratio), "%.1fx", 
+                          static_cast<double>(stats.uncompressedBytes) / stats.compressedBytes);
+            return names + ", " + ratio + " (" + formatBytes(stats.uncompressedBytes) + " -> " +
+                   formatBytes(stats.compressedBytes) + ")";
+        }
+    }
+}
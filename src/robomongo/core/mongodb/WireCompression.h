@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace mongo
+{
+    class DBClientConnection;
+}
+
+namespace Robomongo
+{
+    class ConnectionSettings;
+
+    /**
+     * @brief Network message compression of driver connections. Compressors are offered in
+     *        the isMaster handshake in order of preference, the server picks the first one it
+     *        supports. Every connection record gets its own compressor registry, so that bytes
+     *        are counted per connection record (its clones included).
+     */
+    namespace WireCompression
+    {
+        // Compressors of this build, in default order of preference
+        extern const std::vector<std::string> Available;
+
+        // "zstd, snappy" -> { "zstd", "snappy" }. Unknown and repeated names are dropped.
+        std::vector<std::string> parse(const std::string &list);
+
+        /**
+         * @brief Makes not yet connected 'conn' offer compressors of connection record. Does
+         *        nothing, if there are none.
+         */
+        void configure(mongo::DBClientConnection *conn, const ConnectionSettings *settings);
+
+        struct Stats
+        {
+            std::vector<std::string> used;      // compressors which sent or received messages
+            long long uncompressedBytes = 0;    // sent and received, before compression
+            long long compressedBytes = 0;      // as they went over network
+        };
+
+        // Totals of all connections of connection record since the start of the program
+        Stats stats(const ConnectionSettings *settings);
+
+        // i.e. "zstd, 4.2x (12.1 MB -> 2.9 MB)", empty if nothing was compressed
+        std::string describe(const Stats &stats);
+    }
+}
@@ -0,0 +1,25 @@
+#include "gtest/gtest.h"
+#include "WireCompression.h"
+
+using namespace Robomongo;
+
+TEST(wire_compression_tests, parse_keeps_known_names_in_order)
+{
+    auto const names = WireCompression::parse(" snappy, lz4,zstd ,snappy,");
+    ASSERT_EQ(2u, names.size());
+    EXPECT_EQ("snappy", names[0]);
+    EXPECT_EQ("zstd", names[1]);
+
+    EXPECT_TRUE(WireCompression::parse("").empty());
+}
+
+TEST(wire_compression_tests, describe_ratio)
+{
+    WireCompression::Stats stats;
+    EXPECT_EQ("", WireCompression::describe(stats));
+
+    stats.used = { "zstd" };
+    stats.uncompressedBytes = 8 * 1024 * 1024;
+    stats.compressedBytes = 2 * 1024 * 1024;
+    EXPECT_EQ("zstd, 4.0x (8.0 MB -> 2.0 MB)", WireCompression::describe(stats));
+}
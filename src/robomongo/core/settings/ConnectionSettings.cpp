@@ -79,6 +79,8 @@ namespace Robomongo
         setServerHost(QtUtils::toStdString(map.value("serverHost").toString().left(maxLength)));
         setServerPort(map.value("serverPort").toInt());
         setDefaultDatabase(QtUtils::toStdString(map.value("defaultDatabase").toString()));
+        setCompressors(QtUtils::toStdString(map.value("compressors").toString()));
+        setAutoConnect(map.value("autoConnect").toBool());
         setReplicaSet(map.value("isReplicaSet").toBool());       
         
         QVariantList list = map.value("credentials").toList();
@@ -140,6 +142,8 @@ namespace Robomongo
         setServerHost(source->serverHost());
         setServerPort(source->serverPort());
         setDefaultDatabase(source->defaultDatabase());
+        setCompressors(source->compressors());
+        setAutoConnect(source->autoConnect());
         setImported(source->imported());
         setReplicaSet(source->isReplicaSet());
 
@@ -168,6 +172,10 @@ namespace Robomongo
         map.insert("serverHost", QtUtils::toQString(serverHost()));
         map.insert("serverPort", serverPort());
         map.insert("defaultDatabase", QtUtils::toQString(defaultDatabase()));
+        if (!compressors().empty())
+            map.insert("compressors", QtUtils::toQString(compressors()));
+        if (autoConnect())
+            map.insert("autoConnect", true);
         map.insert("isReplicaSet", isReplicaSet());
         if (isReplicaSet())
             map.insert("replicaSet", _replicaSetSettings->toVariant());
@@ -80,6 +80,20 @@ namespace Robomongo
         std::string defaultDatabase() const { return _defaultDatabase; }
         void setDefaultDatabase(const std::string &defaultDatabase) { _defaultDatabase = defaultDatabase; }
 
+        /**
+         * @brief Network compressors offered to server, in order of preference, comma
+         *        separated (i.e. "zstd,snappy"). Empty, if messages are not compressed.
+         */
+        std::string compressors() const { return _compressors; }
+        void setCompressors(const std::string &compressors) { _compressors = compressors; }
+
+        /**
+         * @brief Connection is opened when Robomongo starts, together with other such
+         *        connections (see ConnectionStartup)
+         */
+        bool autoConnect() const { return _autoConnect; }
+        void setAutoConnect(bool autoConnect) { _autoConnect = autoConnect; }
+
         /**
          * Was this connection imported from somewhere?
          */
@@ -158,6 +172,8 @@ namespace Robomongo
         std::string _host;
         int _port;
         std::string _defaultDatabase;
+        std::string _compressors;
+        bool _autoConnect = false;
         mutable QList<CredentialSettings *> _credentials;
         std::unique_ptr<SshSettings> _sshSettings;
         std::unique_ptr<SslSettings> _sslSettings;
@@ -1,7 +1,6 @@
 #include "robomongo/core/settings/CredentialSettings.h"
 
 #include "robomongo/core/utils/QtUtils.h"
-#include "robomongo/utils/RoboCrypt.h"
 
 namespace Robomongo
 {
@@ -28,7 +27,7 @@ namespace Robomongo
         if(map.contains("userPassword")) // Robo 1.2 and below
             _userPassword = map.value("userPassword").toString().toStdString();
         else if(map.contains("userPasswordEncrypted")) // From Robo 1.3
-            _userPassword = RoboCrypt::decrypt(map.value("userPasswordEncrypted").toString().toStdString());
+            _userPassword = StoredSecret::fromEncrypted(map.value("userPasswordEncrypted").toString().toStdString());
     }
 
     /**
@@ -44,8 +43,7 @@ namespace Robomongo
     {
         QVariantMap map;
         map.insert("userName", QtUtils::toQString(userName()));
-        map.insert("userPasswordEncrypted", userPassword().empty() ? "" :
-                                            QtUtils::toQString(RoboCrypt::encrypt(userPassword())));
+        map.insert("userPasswordEncrypted", QtUtils::toQString(_userPassword.encrypted()));
         map.insert("databaseName", QtUtils::toQString(databaseName()));
         map.insert("mechanism", QtUtils::toQString(mechanism()));
         map.insert("useManuallyVisibleDbs", _useManuallyVisibleDbs);
@@ -4,6 +4,8 @@
 #include <QVariant>
 #include <QVariantMap>
 
+#include "robomongo/core/settings/StoredSecret.h"
+
 namespace Robomongo
 {
     class CredentialSettings
@@ -31,7 +33,7 @@ namespace Robomongo
         /**
          * @brief Password
          */
-        std::string userPassword() const { return _userPassword; }
+        std::string userPassword() const { return _userPassword.plain(); }
         void setUserPassword(const std::string &userPassword) { _userPassword = userPassword; }
 
         /**
@@ -61,7 +63,7 @@ namespace Robomongo
 
     private:
         std::string _userName;
-        std::string _userPassword;  // clear text password (decrypted)
+        StoredSecret _userPassword;
         std::string _databaseName;
         std::string _mechanism;     // authentication mechanism (SCRAM-SHA-1, SCRAM-SHA-256 or MONGODB-CR)
         bool _useManuallyVisibleDbs;
@@ -1,5 +1,7 @@
 #include "robomongo/core/settings/ReplicaSetSettings.h"
 
+#include <QDateTime>
+
 #include "robomongo/core/utils/QtUtils.h"
 
 namespace Robomongo
@@ -29,6 +31,8 @@ namespace Robomongo
         QVariantMap map;
         map.insert("setNameUserEntered", QString::fromStdString(_setNameUserEntered));
         map.insert("cachedSetName", QString::fromStdString(_cachedSetName));
+        map.insert("cachedPrimary", QString::fromStdString(_cachedPrimary));
+        map.insert("topologyCachedAt", _topologyCachedAt);
         int idx = 0;
         for (std::string const& str : _members) {
             map.insert(QString::number(idx), QtUtils::toQString(str));
@@ -42,6 +46,8 @@ namespace Robomongo
     {
         setSetNameUserEntered(map.value("setNameUserEntered").toString().toStdString());
         setCachedSetName(map.value("cachedSetName").toString().toStdString());
+        _cachedPrimary = map.value("cachedPrimary").toString().toStdString();
+        _topologyCachedAt = map.value("topologyCachedAt").toLongLong();
         // Extract and set replica members
         std::vector<std::string> vec;
         auto itr = map.begin();
@@ -58,6 +64,19 @@ namespace Robomongo
         setReadPreference(static_cast<ReadPreference>(map.value("readPreference").toInt()));
     }
     
+    void ReplicaSetSettings::setCachedTopology(const std::string& setName, const std::string& primary)
+    {
+        _cachedSetName = setName;
+        _cachedPrimary = setName.empty() ? "" : primary;
+        _topologyCachedAt = setName.empty() ? 0 : QDateTime::currentMSecsSinceEpoch();
+    }
+
+    bool ReplicaSetSettings::isCachedTopologyFresh() const
+    {
+        return !_cachedSetName.empty() && 
+               QDateTime::currentMSecsSinceEpoch() - _topologyCachedAt < CachedTopologyTtlMs;
+    }
+
     void ReplicaSetSettings::setMembers(const std::vector<std::string>& members)
     {
         _members.clear();
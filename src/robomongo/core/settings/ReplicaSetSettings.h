@@ -34,9 +34,14 @@ namespace Robomongo
         QVariant toVariant() const;
         void fromVariant(const QVariantMap &map);
 
+        // Cached set name and primary are trusted without discovery for this time
+        static qint64 const CachedTopologyTtlMs = 10 * 60 * 1000;
+
         // Getters
         std::string const& setNameUserEntered() { return _setNameUserEntered; }
         std::string const& cachedSetName() { return _cachedSetName; }
+        std::string const& cachedPrimary() const { return _cachedPrimary; }
+        bool isCachedTopologyFresh() const;
         std::vector<std::string> const& members() const { return _members; }
         std::vector<mongo::HostAndPort> membersToHostAndPort() const;
 
@@ -50,7 +55,8 @@ namespace Robomongo
 
         // Setters
         void setSetNameUserEntered(const std::string& setName) { _setNameUserEntered = setName; }
-        void setCachedSetName(const std::string& setName) { _cachedSetName = setName; }
+        void setCachedSetName(const std::string& setName) { setCachedTopology(setName, ""); }
+        void setCachedTopology(const std::string& setName, const std::string& primary);
         void setMembers(const std::vector<std::string>& members);
         void setMembers(const std::vector<std::pair<std::string,bool>>& membersAndHealts);
         void deleteAllMembers() { _members.clear(); }
@@ -60,6 +66,8 @@ namespace Robomongo
     private:
         std::string _setNameUserEntered;
         std::string _cachedSetName;
+        std::string _cachedPrimary;
+        qint64 _topologyCachedAt = 0;   // ms since epoch, 0 if topology was never cached
         std::vector<std::string> _members;
         ReadPreference _readPreference = ReadPreference::PRIMARY;
     };
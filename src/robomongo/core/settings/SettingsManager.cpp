@@ -1,10 +1,13 @@
 #include "robomongo/core/settings/SettingsManager.h"
 
+#include <algorithm>
 #include <QDir>
 #include <QFile>
 #include <QVariantList>
 #include <QUuid>
 #include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QXmlStreamReader>
 #include <QDirIterator>
 
@@ -15,8 +18,11 @@
 #include "robomongo/core/settings/CredentialSettings.h"
 #include "robomongo/core/settings/SshSettings.h"
 #include "robomongo/core/settings/SslSettings.h"
+#include "robomongo/core/settings/SettingsWriter.h"
+#include "robomongo/core/utils/AdaptiveBatchSize.h"
 #include "robomongo/core/utils/Logger.h"
 #include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/core/utils/StartupProfile.h"
 #include "robomongo/core/utils/StdUtils.h"
 #include "robomongo/gui/AppStyle.h"
 #include "robomongo/utils/common.h"
@@ -25,6 +31,9 @@
 
 namespace Robomongo
 {
+    // Cache data of settings, kept out of config file so that it stays small and readable
+    auto const CacheDataFilePath = CacheDir + "settings-cache.json";
+
     // 3T config files
     auto const Studio3T_PropertiesDat {
         QString("%1/.3T/studio-3t/properties.dat").arg(QDir::homePath())
@@ -100,23 +109,40 @@ namespace Robomongo
         _version(SchemaVersion),
         _uuidEncoding(DefaultEncoding),
         _timeZone(Utc),
+        _jsonOutputMode(ShellJson),
         _viewMode(Robomongo::Tree),
         _autocompletionMode(AutocompleteAll),
         _loadMongoRcJs(false),
+        _profileQueries(false),
+        _parallelReads(false),
+        _prefetchPages(true),
+        _saveWorkspace(true),
+        _saveWorkspaceResults(true),
         _minimizeToTray(false),
         _lineNumbers(false),
         _disableConnectionShortcuts(false),
         _batchSize(50),
+        _adaptiveBatchKb(0),
         _textFontFamily(""),
         _textFontPointSize(-1),
         _mongoTimeoutSec(10),
         _shellTimeoutSec(15),
-        _imported(false)        
+        _shellResultMemoryBudgetMb(512),
+        _resultsMemoryBudgetMb(1024),
+        _jsHeapLimitMb(0),
+        _scopePoolSize(1),
+        _imported(false),
+        _writer(new SettingsWriter)
     {
         if (!QDir().mkpath(ConfigDir))
             LOG_MSG("ERROR: Could not create settings path: " + ConfigDir, mongo::logger::LogSeverity::Error());
 
-        RoboCrypt::initKey();
+        {
+            StartupProfile::Scope phase("password key");
+            RoboCrypt::initKey();
+        }
+
+        StartupProfile::Scope phase("settings");
         if (!load()) {  // if load fails (probably due to non-existing config. file or directory)
             save();     // create empty settings file
             load();     // try loading again for the purpose of import from previous Robomongo versions
@@ -136,6 +162,8 @@ namespace Robomongo
      */
     bool SettingsManager::load()
     {
+        _writer->flush();
+
         if (!QFile::exists(ConfigFilePath))
             return false;
 
@@ -143,11 +171,25 @@ namespace Robomongo
         if (!f.open(QIODevice::ReadOnly))
             return false;
 
-        bool ok;
-        QJson::Parser parser;
-        QVariantMap map = parser.parse(f.readAll(), &ok).toMap();
-        if (!ok)
-            return false;
+        // Mapped file is parsed in place, without reading it into buffer first
+        uchar const *data = f.size() > 0 ? f.map(0, f.size()) : nullptr;
+        QByteArray const json = data ? QByteArray::fromRawData(reinterpret_cast<const char *>(data), f.size())
+                                     : f.readAll();
+
+        QJsonParseError error;
+        QJsonDocument const doc = QJsonDocument::fromJson(json, &error);
+        QVariantMap map;
+        if (error.error == QJsonParseError::NoError && doc.isObject()) {
+            map = doc.object().toVariantMap();
+        }
+        else {
+            // Lenient parser of previous versions, in case file is not strict JSON
+            bool ok;
+            QJson::Parser parser;
+            map = parser.parse(json, &ok).toMap();
+            if (!ok)
+                return false;
+        }
 
         loadFromMap(map);
 
@@ -160,27 +202,23 @@ namespace Robomongo
      */
     bool SettingsManager::save()
     {
-        QVariantMap const& map = convertToMap();
+        _writer->write(ConfigFilePath, convertToMap(), true);
 
-        QFile f(ConfigFilePath);
-        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-            LOG_MSG("ERROR: Could not write settings to: " + ConfigFilePath, mongo::logger::LogSeverity::Error());
-            return false;
+        if (_cacheDataChanged) {
+            _writer->write(CacheDataFilePath, _cacheData, false);
+            _cacheDataChanged = false;
         }
 
-        bool ok;
-        QJson::Serializer s;
-        s.setIndentMode(QJson::IndentFull);
-        s.serialize(map, &f, &ok);
-
-        LOG_MSG("Settings saved to: " + ConfigFilePath, mongo::logger::LogSeverity::Info());
-
-        return ok;
+        return true;
     }
 
     void SettingsManager::addCacheData(QString const& key, QVariant const& value)
     {
+        if (_cacheData.value(key) == value)
+            return;
+
         _cacheData.insert(key, value);
+        _cacheDataChanged = true;
     }
 
     QVariant SettingsManager::cacheData(QString const& key) const
@@ -234,7 +272,21 @@ namespace Robomongo
             timeZone = 0;
 
         _timeZone = (SupportedTimes)timeZone;
+
+        int jsonOutputMode = map.value("jsonOutputMode").toInt();
+        if (jsonOutputMode > CompactJson || jsonOutputMode < 0)
+            jsonOutputMode = ShellJson;
+
+        _jsonOutputMode = (JsonOutputMode)jsonOutputMode;
         _loadMongoRcJs = map.value("loadMongoRcJs").toBool();
+        _profileQueries = map.value("profileQueries").toBool();
+        _parallelReads = map.value("parallelReads").toBool();
+        if (map.contains("prefetchPages"))
+            _prefetchPages = map.value("prefetchPages").toBool();
+        if (map.contains("saveWorkspace"))
+            _saveWorkspace = map.value("saveWorkspace").toBool();
+        if (map.contains("saveWorkspaceResults"))
+            _saveWorkspaceResults = map.value("saveWorkspaceResults").toBool();
         _disableConnectionShortcuts = map.value("disableConnectionShortcuts").toBool();
         
         if (map.contains("acceptedEulaVersions")) 
@@ -262,6 +314,9 @@ namespace Robomongo
         if (_batchSize == 0)
             _batchSize = 50;
 
+        if (map.contains("adaptiveBatchKb"))
+            setAdaptiveBatchKb(map.value("adaptiveBatchKb").toInt());
+
         if (map.contains("checkForUpdates"))
             _checkForUpdates = map.value("checkForUpdates").toBool();
 
@@ -282,6 +337,22 @@ namespace Robomongo
             _shellTimeoutSec = map.value("shellTimeoutSec").toInt();
         }
 
+        if (map.contains("shellResultMemoryBudgetMb")) {
+            _shellResultMemoryBudgetMb = map.value("shellResultMemoryBudgetMb").toInt();
+        }
+
+        if (map.contains("resultsMemoryBudgetMb")) {
+            _resultsMemoryBudgetMb = map.value("resultsMemoryBudgetMb").toInt();
+        }
+
+        if (map.contains("jsHeapLimitMb")) {
+            setJsHeapLimitMb(map.value("jsHeapLimitMb").toInt());
+        }
+
+        if (map.contains("scopePoolSize")) {
+            _scopePoolSize = map.value("scopePoolSize").toInt();
+        }
+
         // 5. Load connections
         _connections.clear();
 
@@ -313,7 +384,21 @@ namespace Robomongo
         if (_toolbars.end() == it)
             _toolbars["logs"] = false;
 
-        _cacheData = map.value("cacheData").toMap();
+        // Config files of earlier builds kept cache data inline
+        if (map.contains("cacheData")) {
+            _cacheData = map.value("cacheData").toMap();
+            _cacheDataChanged = true;
+        }
+        else {
+            QFile cacheFile(CacheDataFilePath);
+            if (cacheFile.open(QIODevice::ReadOnly)) {
+                bool ok = false;
+                QJson::Parser parser;
+                QVariantMap const cacheData = parser.parse(cacheFile.readAll(), &ok).toMap();
+                if (ok)
+                    _cacheData = cacheData;
+            }
+        }
 
         // Load connection settings from previous versions of Robomongo
         importFromOldVersion();
@@ -334,6 +419,7 @@ namespace Robomongo
 
         // 3. Save TimeZone encoding
         map.insert("timeZone", _timeZone);
+        map.insert("jsonOutputMode", _jsonOutputMode);
 
         // 4. Save view mode
         map.insert("viewMode", _viewMode);
@@ -345,6 +431,11 @@ namespace Robomongo
 
         // 6. Save loadInitJs
         map.insert("loadMongoRcJs", _loadMongoRcJs);
+        map.insert("profileQueries", _profileQueries);
+        map.insert("parallelReads", _parallelReads);
+        map.insert("prefetchPages", _prefetchPages);
+        map.insert("saveWorkspace", _saveWorkspace);
+        map.insert("saveWorkspaceResults", _saveWorkspaceResults);
 
         // 7. Save disableConnectionShortcuts
         map.insert("disableConnectionShortcuts", _disableConnectionShortcuts);
@@ -365,9 +456,14 @@ namespace Robomongo
 
         // 9. Save batchSize
         map.insert("batchSize", _batchSize);
+        map.insert("adaptiveBatchKb", _adaptiveBatchKb);
         map.insert("checkForUpdates", _checkForUpdates);
         map.insert("mongoTimeoutSec", _mongoTimeoutSec);
         map.insert("shellTimeoutSec", _shellTimeoutSec);
+        map.insert("shellResultMemoryBudgetMb", _shellResultMemoryBudgetMb);
+        map.insert("resultsMemoryBudgetMb", _resultsMemoryBudgetMb);
+        map.insert("jsHeapLimitMb", _jsHeapLimitMb);
+        map.insert("scopePoolSize", _scopePoolSize);
 
         // 10. Save style
         map.insert("style", _currentStyle);
@@ -387,7 +483,6 @@ namespace Robomongo
         map.insert("toolbars", _toolbars);
         map.insert("imported", _imported);
         map.insert("anonymousID", _anonymousID);
-        map.insert("cacheData", _cacheData);
         map.insert("programExitedNormally", _programExitedNormally);
         map.insert("disableHttpsFeatures", _disableHttpsFeatures);
         map.insert("debugMode", _debugMode);
@@ -515,6 +610,12 @@ namespace Robomongo
         _textFontPointSize = pointSize > 0 ? pointSize : -1;
     }
 
+    void SettingsManager::setAdaptiveBatchKb(int newValue)
+    {
+        _adaptiveBatchKb = std::max(newValue, 0);
+        AdaptiveBatchSize::instance().setByteBudget(_adaptiveBatchKb * 1024LL);
+    }
+
     void SettingsManager::reorderConnections(const ConnectionSettingsContainerType &connections)
     {
         _connections = connections;
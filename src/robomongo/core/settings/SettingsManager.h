@@ -6,6 +6,7 @@
 #include <QDir>
 
 #include <vector>
+#include <memory>
 #include <cstdlib>
 
 #include "robomongo/core/Enums.h"
@@ -13,6 +14,7 @@
 namespace Robomongo
 {
     class ConnectionSettings;
+    class SettingsWriter;
     struct ConfigFileAndImportFunction;
         
     // Current cache directory
@@ -61,8 +63,9 @@ namespace Robomongo
         bool load();
 
         /**
-         * @brief Saves all settings to config file.
-         * @return true if success, false otherwise
+         * @brief Saves all settings to config file. File is written in background, see
+         *        SettingsWriter, cache data (see addCacheData()) goes to separate file.
+         * @return true if settings are scheduled for writing
          */
         bool save();
 
@@ -104,6 +107,10 @@ namespace Robomongo
         void setTimeZone(SupportedTimes timeZ) { _timeZone = timeZ; }
         SupportedTimes timeZone() const { return _timeZone; }
 
+        // Format of text view, copied and exported JSON
+        void setJsonOutputMode(JsonOutputMode mode) { _jsonOutputMode = mode; }
+        JsonOutputMode jsonOutputMode() const { return _jsonOutputMode; }
+
         void setViewMode(ViewMode viewMode) { _viewMode = viewMode; }
         ViewMode viewMode() const { return _viewMode; }
 
@@ -125,6 +132,28 @@ namespace Robomongo
         void setLoadMongoRcJs(bool isLoadJs) { _loadMongoRcJs = isLoadJs; }
         bool loadMongoRcJs() const { return _loadMongoRcJs; }
 
+        // Collect explain("executionStats") of find/aggregate statements run in shell
+        void setProfileQueries(bool profile) { _profileQueries = profile; }
+        bool profileQueries() const { return _profileQueries; }
+
+        // Scripts of several find/aggregate statements with literal arguments only are read
+        // concurrently with driver connections, see MongoWorker::execParallelReads()
+        void setParallelReads(bool parallel) { _parallelReads = parallel; }
+        bool parallelReads() const { return _parallelReads; }
+
+        // Read next page of query result in background, while current one is shown, and
+        // indexes and first page of collection focused in explorer
+        void setPrefetchPages(bool prefetch) { _prefetchPages = prefetch; }
+        bool prefetchPages() const { return _prefetchPages; }
+
+        // Query tabs are saved at exit and reopened with their connections, see WorkspaceSnapshot
+        void setSaveWorkspace(bool save) { _saveWorkspace = save; }
+        bool saveWorkspace() const { return _saveWorkspace; }
+
+        // Documents of shown pages are saved with workspace, restored tabs show them without queries
+        void setSaveWorkspaceResults(bool save) { _saveWorkspaceResults = save; }
+        bool saveWorkspaceResults() const { return _saveWorkspaceResults; }
+
         void setDisableConnectionShortcuts(bool isDisable) { _disableConnectionShortcuts = isDisable; }
         bool disableConnectionShortcuts() const { return _disableConnectionShortcuts; }
 
@@ -142,6 +171,11 @@ namespace Robomongo
         void setBatchSize(int batchSize) { _batchSize = batchSize; }
         int batchSize() const { return _batchSize; }
 
+        // Bytes (in kilobytes) that one batch of find/getMore targets, see AdaptiveBatchSize.
+        // Pages keep batchSize() documents. 0 means fixed batches of batchSize() documents
+        int adaptiveBatchKb() const { return _adaptiveBatchKb; }
+        void setAdaptiveBatchKb(int newValue);
+
         QString currentStyle() const { return _currentStyle; }
         void setCurrentStyle(const QString& style);
 
@@ -156,6 +190,26 @@ namespace Robomongo
 
         void setShellTimeoutSec(int newValue) { _shellTimeoutSec = std::abs(newValue); }
 
+        // Memory (in megabytes) that one shell result may occupy, the rest is moved to
+        // temporary file. 0 means no limit
+        int shellResultMemoryBudgetMb() const { return _shellResultMemoryBudgetMb; }
+        void setShellResultMemoryBudgetMb(int newValue) { _shellResultMemoryBudgetMb = std::abs(newValue); }
+
+        // Memory (in megabytes) that results of all tabs may occupy, views and documents of
+        // background tabs are released past it, see ResultMemoryManager. 0 means no limit
+        int resultsMemoryBudgetMb() const { return _resultsMemoryBudgetMb; }
+        void setResultsMemoryBudgetMb(int newValue) { _resultsMemoryBudgetMb = std::abs(newValue); }
+
+        // JavaScript heap (in megabytes) of every shell scope, statements allocating past it fail.
+        // At least MinJsHeapLimitMb, 0 means default of ScriptEngine
+        int jsHeapLimitMb() const { return _jsHeapLimitMb; }
+        void setJsHeapLimitMb(int newValue) { _jsHeapLimitMb = newValue > 0 ? qMax(newValue, MinJsHeapLimitMb) : 0; }
+        static constexpr int MinJsHeapLimitMb = 64;
+
+        // Number of shell scopes kept initialized (per connection) for new shell tabs. 0 disables
+        int scopePoolSize() const { return _scopePoolSize; }
+        void setScopePoolSize(int newValue) { _scopePoolSize = std::abs(newValue); }
+
         // True when settings from previous versions of Robomongo are imported
         void setImported(bool imported) { _imported = imported; }
         bool imported() const { return _imported; }
@@ -210,9 +264,15 @@ namespace Robomongo
 
         UUIDEncoding _uuidEncoding;
         SupportedTimes _timeZone;
+        JsonOutputMode _jsonOutputMode;
         ViewMode _viewMode;
         AutocompletionMode _autocompletionMode;
         bool _loadMongoRcJs;
+        bool _profileQueries;
+        bool _parallelReads;
+        bool _prefetchPages;
+        bool _saveWorkspace;
+        bool _saveWorkspaceResults;
         bool _autoExpand;
         bool _autoExec;
         bool _minimizeToTray;
@@ -224,6 +284,7 @@ namespace Robomongo
         QSet<QString> _acceptedEulaVersions;
         QSet<QString> _dbVersionsConnected;
         int _batchSize;
+        int _adaptiveBatchKb;
         bool _checkForUpdates = true;
         QString _currentStyle;
         QString _textFontFamily;
@@ -231,6 +292,10 @@ namespace Robomongo
 
         int _mongoTimeoutSec;
         int _shellTimeoutSec;
+        int _shellResultMemoryBudgetMb;
+        int _resultsMemoryBudgetMb;
+        int _jsHeapLimitMb;
+        int _scopePoolSize;
 
         // True when settings from previous versions of Robomongo are imported
         bool _imported;
@@ -242,8 +307,11 @@ namespace Robomongo
         */
         QString _anonymousID;
 
-        // Various cache data
+        // Various cache data, saved to CacheDataFilePath when changed
         QMap<QString, QVariant> _cacheData;
+        bool _cacheDataChanged = false;
+
+        std::unique_ptr<SettingsWriter> _writer;
 
         /**
          * @brief List of connections
@@ -0,0 +1,99 @@
+#include "robomongo/core/settings/SettingsWriter.h"
+
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+
+#include <chrono>
+#include <serializer.h>
+
+#include "robomongo/core/utils/Logger.h"
+
+namespace Robomongo
+{
+    SettingsWriter::SettingsWriter() :
+        _thread(&SettingsWriter::run, this) {}
+
+    SettingsWriter::~SettingsWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _changed.notify_all();
+        _thread.join();
+    }
+
+    void SettingsWriter::write(const QString &path, const QVariantMap &map, bool indent)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pending[path] = PendingFile { map, indent };
+        }
+        _changed.notify_all();
+    }
+
+    void SettingsWriter::flush()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _flushing = true;
+        _changed.notify_all();
+        _changed.wait(lock, [this]() { return _pending.isEmpty() && !_writing; });
+        _flushing = false;
+    }
+
+    void SettingsWriter::run()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _changed.wait(lock, [this]() { return _stopping || !_pending.isEmpty(); });
+            if (_pending.isEmpty())
+                return;
+
+            // Wait for more changes, unless application exits or somebody waits in flush()
+            _changed.wait_for(lock, std::chrono::milliseconds(DebounceMs),
+                              [this]() { return _stopping || _flushing; });
+
+            QMap<QString, PendingFile> const files = _pending;
+            _pending.clear();
+            _writing = true;
+
+            lock.unlock();
+            for (auto it = files.begin(); it != files.end(); ++it)
+                writeFile(it.key(), it.value());
+            lock.lock();
+
+            _writing = false;
+            _changed.notify_all();
+        }
+    }
+
+    bool SettingsWriter::writeFile(const QString &path, const PendingFile &file)
+    {
+        bool ok = false;
+        QJson::Serializer serializer;
+        serializer.setIndentMode(file.indent ? QJson::IndentFull : QJson::IndentCompact);
+        QByteArray const json = serializer.serialize(file.map, &ok);
+        if (!ok) {
+            LOG_MSG("ERROR: Could not serialize settings for: " + path, mongo::logger::LogSeverity::Error());
+            return false;
+        }
+
+        // Only this thread touches _written
+        if (_written.value(path) == json)
+            return true;
+
+        QDir().mkpath(QFileInfo(path).absolutePath());
+
+        // Replaced on commit(), old file is kept if anything fails before
+        QSaveFile out(path);
+        if (!out.open(QIODevice::WriteOnly) || out.write(json) != json.size() || !out.commit()) {
+            LOG_MSG("ERROR: Could not write settings to: " + path, mongo::logger::LogSeverity::Error());
+            return false;
+        }
+
+        _written[path] = json;
+        LOG_MSG("Settings saved to: " + path, mongo::logger::LogSeverity::Info());
+        return true;
+    }
+}
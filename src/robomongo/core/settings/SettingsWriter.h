@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QByteArray>
+#include <QMap>
+#include <QString>
+#include <QVariantMap>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Robomongo
+{
+    /**
+     * @brief Writes JSON files of SettingsManager in background thread. Files are replaced
+     *        atomically (written to temporary file, then renamed), so crash during write does
+     *        not corrupt them. Writes of one file that follow within DebounceMs are merged,
+     *        and file is not rewritten when its contents did not change.
+     *
+     * @threadsafe
+     */
+    class SettingsWriter
+    {
+    public:
+        SettingsWriter();
+
+        /**
+         * @brief Writes all pending files, then stops writer thread
+         */
+        ~SettingsWriter();
+
+        /**
+         * @brief Schedules write of 'map' to 'path', replacing not yet written map of this path
+         * @param indent Human readable (indented) JSON, otherwise compact
+         */
+        void write(const QString &path, const QVariantMap &map, bool indent);
+
+        /**
+         * @brief Blocks until all scheduled files are written
+         */
+        void flush();
+
+    private:
+        struct PendingFile
+        {
+            QVariantMap map;
+            bool indent;
+        };
+
+        void run();
+
+        /**
+         * @return true if file was written (or it already has these contents)
+         */
+        bool writeFile(const QString &path, const PendingFile &file);
+
+        static const int DebounceMs = 300;
+
+        std::mutex _mutex;
+        std::condition_variable _changed;
+        QMap<QString, PendingFile> _pending;
+        QMap<QString, QByteArray> _written;     // last written contents, by path
+        bool _writing = false;
+        bool _flushing = false;
+        bool _stopping = false;
+        std::thread _thread;
+    };
+}
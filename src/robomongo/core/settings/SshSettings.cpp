@@ -1,13 +1,19 @@
 #include "robomongo/core/settings/SshSettings.h"
 
 #include "robomongo/core/utils/QtUtils.h"
-#include "robomongo/utils/RoboCrypt.h"
 
 namespace Robomongo
 {
+    const char *const SshSettings::DefaultCiphers =
+        "aes128-gcm@openssh.com,chacha20-poly1305@openssh.com,aes256-gcm@openssh.com,"
+        "aes128-ctr,aes192-ctr,aes256-ctr,aes256-cbc,aes128-cbc";
+
     SshSettings::SshSettings() :
         _port(22),
         _authMethod("publickey"),
+        _ciphers(DefaultCiphers),
+        _compression(false),
+        _keepAliveInterval(0),
         _enabled(false),
         _askPassword(false),
         _logLevel(1) {
@@ -24,15 +30,17 @@ namespace Robomongo
         map.insert("host", QtUtils::toQString(host()));
         map.insert("port", port());
         map.insert("userName", QtUtils::toQString(userName()));
-        map.insert("userPasswordEncrypted", userPassword().empty() ? "" : 
-                                            QtUtils::toQString(RoboCrypt::encrypt(userPassword())));
+        map.insert("userPasswordEncrypted", QtUtils::toQString(_userPassword.encrypted()));
         map.insert("privateKeyFile", QtUtils::toQString(privateKeyFile()));
         map.insert("publicKeyFile", QtUtils::toQString(publicKeyFile()));
-        map.insert("passphraseEncrypted", passphrase().empty() ? "" : 
-                                          QtUtils::toQString(RoboCrypt::encrypt(passphrase())));
+        map.insert("passphraseEncrypted", QtUtils::toQString(_passphrase.encrypted()));
         map.insert("method", QtUtils::toQString(authMethod()));
         map.insert("enabled", enabled());
         map.insert("askPassword", askPassword());
+        map.insert("ciphers", QtUtils::toQString(ciphers()));
+        map.insert("macs", QtUtils::toQString(macs()));
+        map.insert("compression", compression());
+        map.insert("keepAliveInterval", keepAliveInterval());
         return map;
     }
 
@@ -45,7 +53,7 @@ namespace Robomongo
         if (map.contains("userPassword")) // Robo 1.2 and below
             setUserPassword((map.value("userPassword").toString().toStdString()));
         else if (map.contains("userPasswordEncrypted")) // From Robo 1.3
-            setUserPassword(RoboCrypt::decrypt((map.value("userPasswordEncrypted").toString().toStdString())));
+            _userPassword = StoredSecret::fromEncrypted(map.value("userPasswordEncrypted").toString().toStdString());
 
         setPrivateKeyFile(QtUtils::toStdString(map.value("privateKeyFile").toString()));
         setPublicKeyFile(QtUtils::toStdString(map.value("publicKeyFile").toString()));
@@ -54,10 +62,16 @@ namespace Robomongo
         if (map.contains("passphrase")) // Robo 1.2 and below
             setPassphrase((map.value("passphrase").toString().toStdString()));
         else if (map.contains("passphraseEncrypted")) // From Robo 1.3
-            setPassphrase(RoboCrypt::decrypt((map.value("passphraseEncrypted").toString().toStdString())));
+            _passphrase = StoredSecret::fromEncrypted(map.value("passphraseEncrypted").toString().toStdString());
 
         setAuthMethod(QtUtils::toStdString(map.value("method").toString()));
         setEnabled(map.value("enabled").toBool());
         setAskPassword(map.value("askPassword").toBool());
+
+        // Absent in config files of older versions
+        setCiphers(QtUtils::toStdString(map.value("ciphers", QString(DefaultCiphers)).toString()));
+        setMacs(QtUtils::toStdString(map.value("macs").toString()));
+        setCompression(map.value("compression").toBool());
+        setKeepAliveInterval(map.value("keepAliveInterval").toInt());
     }
 }
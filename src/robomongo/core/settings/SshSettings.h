@@ -4,11 +4,16 @@
 #include <QVariant>
 #include <QVariantMap>
 
+#include "robomongo/core/settings/StoredSecret.h"
+
 namespace Robomongo
 {
     class SshSettings
     {
     public:
+        // AEAD ciphers first, they need no separate MAC; libssh2 skips names it does not support
+        static const char *const DefaultCiphers;
+
         SshSettings();
 
         /**
@@ -34,7 +39,7 @@ namespace Robomongo
         std::string userName() const { return _userName; }
         void setUserName(const std::string &userName) { _userName = userName; }
 
-        std::string userPassword() const { return _userPassword; }
+        std::string userPassword() const { return _userPassword.plain(); }
         void setUserPassword(const std::string &userPassword) { _userPassword = userPassword; }
 
         std::string privateKeyFile() const { return _privateKeyFile; }
@@ -43,7 +48,7 @@ namespace Robomongo
         std::string publicKeyFile() const { return _publicKeyFile; }
         void setPublicKeyFile(const std::string &path) { _publicKeyFile = path; }
 
-        std::string passphrase() const { return _passphrase; }
+        std::string passphrase() const { return _passphrase.plain(); }
         void setPassphrase(const std::string &passphrase) { _passphrase = passphrase; }
 
         // "password" or "publickey"
@@ -63,6 +68,24 @@ namespace Robomongo
         std::string askedPassword() const { return _askedPassword; }
         void setAskedPassword(const std::string &asked) { _askedPassword = asked; }
 
+        /**
+         * @brief Ciphers and MACs offered to SSH server, comma separated in order of
+         *        preference. Empty to keep defaults of libssh2.
+         */
+        std::string ciphers() const { return _ciphers; }
+        void setCiphers(const std::string &ciphers) { _ciphers = ciphers; }
+
+        std::string macs() const { return _macs; }
+        void setMacs(const std::string &macs) { _macs = macs; }
+
+        // zlib compression of tunnel, worth it on slow links only
+        bool compression() const { return _compression; }
+        void setCompression(bool compression) { _compression = compression; }
+
+        // Seconds between keep-alive messages, 0 if they are not sent
+        int keepAliveInterval() const { return _keepAliveInterval; }
+        void setKeepAliveInterval(int seconds) { _keepAliveInterval = seconds; }
+
         int logLevel() const { return _logLevel; }
         void setLogLevel(const int logLevel) { _logLevel = logLevel; }
 
@@ -70,11 +93,15 @@ namespace Robomongo
         std::string _host;  // domain or IPv4/v6
         int _port;
         std::string _userName;
-        std::string _userPassword;      // clear text password (decrypted)
+        StoredSecret _userPassword;
         std::string _privateKeyFile;
         std::string _publicKeyFile;
-        std::string _passphrase;        // clear text passphrase (decrypted)
+        StoredSecret _passphrase;
         std::string _authMethod; // "password" or "publickey"
+        std::string _ciphers;
+        std::string _macs;
+        bool _compression;
+        int _keepAliveInterval;
 
         // Should we ask user about password or passphrase
         // each time when we try to connect
@@ -1,7 +1,6 @@
 #include "robomongo/core/settings/SslSettings.h"
 
 #include "robomongo/core/utils/QtUtils.h"
-#include "robomongo/utils/RoboCrypt.h"
 
 namespace Robomongo
 {
@@ -24,8 +23,7 @@ namespace Robomongo
         map.insert("caFile", QtUtils::toQString(caFile()));
         map.insert("usePemFile", usePemFile());
         map.insert("pemKeyFile", QtUtils::toQString(pemKeyFile()));
-        map.insert("pemPassPhraseEncrypted", pemPassPhrase().empty() ? "" :
-                                             QtUtils::toQString(RoboCrypt::encrypt(pemPassPhrase())));
+        map.insert("pemPassPhraseEncrypted", QtUtils::toQString(_pemPassPhrase.encrypted()));
         map.insert("useAdvancedOptions", useAdvancedOptions());
         map.insert("crlFile", QtUtils::toQString(crlFile()));
         map.insert("allowInvalidHostnames", allowInvalidHostnames());
@@ -46,7 +44,7 @@ namespace Robomongo
         if (map.contains("pemPassPhrase")) // Robo 1.2 and below
             setPemPassPhrase((map.value("pemPassPhrase").toString().toStdString()));
         else if (map.contains("pemPassPhraseEncrypted")) // From Robo 1.3
-            setPemPassPhrase(RoboCrypt::decrypt((map.value("pemPassPhraseEncrypted").toString().toStdString())));
+            _pemPassPhrase = StoredSecret::fromEncrypted(map.value("pemPassPhraseEncrypted").toString().toStdString());
 
         setUseAdvancedOptions(map.value("useAdvancedOptions").toBool());
         setCrlFile(QtUtils::toStdString(map.value("crlFile").toString()));
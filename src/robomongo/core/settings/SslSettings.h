@@ -4,6 +4,8 @@
 #include <QVariant>
 #include <QVariantMap>
 
+#include "robomongo/core/settings/StoredSecret.h"
+
 namespace Robomongo
 {
     class SslSettings
@@ -26,7 +28,7 @@ namespace Robomongo
         // Getters for mongo:: SSLGlobalParams related settings
         std::string pemKeyFile() const { return _pemKeyFile; }
         std::string caFile() const { return _caFile; }
-        std::string pemPassPhrase() const { return _pemPassPhrase; }
+        std::string pemPassPhrase() const { return _pemPassPhrase.plain(); }
         std::string crlFile() const { return _crlFile; }
         bool allowInvalidHostnames() const { return _allowInvalidHostnames; }
         bool allowInvalidCertificates() const { return _allowInvalidCertificates; }
@@ -61,7 +63,7 @@ namespace Robomongo
         // mongo:: SSL Global params related settings
         std::string _caFile;
         std::string _pemKeyFile;
-        std::string _pemPassPhrase;
+        StoredSecret _pemPassPhrase;
         std::string _crlFile;
         bool _allowInvalidHostnames;
         bool _allowInvalidCertificates;
@@ -0,0 +1,70 @@
+#include "robomongo/core/settings/StoredSecret.h"
+
+#include <mutex>
+
+#include "robomongo/utils/RoboCrypt.h"
+
+namespace
+{
+    // Copies of settings are used by worker threads, and the crypter is shared
+    std::mutex cryptMutex;
+}
+
+namespace Robomongo
+{
+    StoredSecret StoredSecret::fromEncrypted(const std::string &encrypted)
+    {
+        StoredSecret secret;
+        secret._encrypted = encrypted;
+        secret._isDecrypted = encrypted.empty();
+        return secret;
+    }
+
+    StoredSecret &StoredSecret::operator=(const StoredSecret &other)
+    {
+        if (this != &other) {
+            wipe(_plain);
+            _plain = other._plain;
+            _encrypted = other._encrypted;
+            _isDecrypted = other._isDecrypted;
+        }
+        return *this;
+    }
+
+    StoredSecret::~StoredSecret()
+    {
+        wipe(_plain);
+    }
+
+    void StoredSecret::wipe(std::string &text)
+    {
+        // Volatile, so that compiler does not drop writes to memory which is freed next
+        volatile char *data = &text[0];
+        for (size_t i = 0; i < text.size(); ++i)
+            data[i] = '\0';
+
+        text.clear();
+    }
+
+    const std::string &StoredSecret::plain() const
+    {
+        if (!_isDecrypted) {
+            std::lock_guard<std::mutex> lock(cryptMutex);
+            _plain = RoboCrypt::decrypt(_encrypted);
+            _isDecrypted = true;
+        }
+        return _plain;
+    }
+
+    std::string StoredSecret::encrypted() const
+    {
+        if (!_isDecrypted)
+            return _encrypted;
+
+        if (_plain.empty())
+            return std::string();
+
+        std::lock_guard<std::mutex> lock(cryptMutex);
+        return RoboCrypt::encrypt(_plain);
+    }
+}
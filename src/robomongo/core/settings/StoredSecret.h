@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+
+namespace Robomongo
+{
+    /**
+     * @brief Password or passphrase of settings. Secret loaded from config file is decrypted
+     *        only when it is used first time (i.e. connection is opened), and it is saved
+     *        back without being decrypted and encrypted again.
+     */
+    class StoredSecret
+    {
+    public:
+        StoredSecret() {}
+        StoredSecret(const std::string &plain) : _plain(plain) {}
+        StoredSecret(const StoredSecret &other) = default;
+
+        /**
+         * @brief Clear text is overwritten with zeros, before its memory is released
+         */
+        StoredSecret &operator=(const StoredSecret &other);
+        ~StoredSecret();
+
+        /**
+         * @param encrypted Secret encrypted by RoboCrypt::encrypt()
+         */
+        static StoredSecret fromEncrypted(const std::string &encrypted);
+
+        /**
+         * @brief Clear text secret
+         */
+        const std::string &plain() const;
+
+        /**
+         * @brief Secret encrypted for config file, empty for empty secret
+         */
+        std::string encrypted() const;
+
+    private:
+        static void wipe(std::string &text);
+
+        mutable std::string _plain;
+        std::string _encrypted;         // not yet decrypted secret of config file
+        mutable bool _isDecrypted = true;
+    };
+}
@@ -0,0 +1,70 @@
+#include "robomongo/core/utils/AdaptiveBatchSize.h"
+
+#include <algorithm>
+
+namespace Robomongo
+{
+    constexpr double AdaptiveBatchSize::SmoothingFactor;
+    constexpr double AdaptiveBatchSize::MinTransferToRtt;
+    constexpr double AdaptiveBatchSize::MaxBatchMs;
+    const long long AdaptiveBatchSize::MaxBatchBytes;
+    const int AdaptiveBatchSize::MaxBatchSize;
+
+    AdaptiveBatchSize &AdaptiveBatchSize::instance()
+    {
+        static AdaptiveBatchSize batchSize;
+        return batchSize;
+    }
+
+    int AdaptiveBatchSize::batchSize(const std::string &key, int fixed) const
+    {
+        long long const budget = _byteBudget;
+        if (budget <= 0)
+            return fixed;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto const it = _estimates.find(key);
+        if (it == _estimates.end())
+            return fixed;
+
+        Estimate const &estimate = it->second;
+        double bytes = static_cast<double>(budget);
+        if (estimate.msPerByte > 0) {
+            bytes = std::max(bytes, MinTransferToRtt * estimate.rttMs / estimate.msPerByte);
+            bytes = std::min(bytes, MaxBatchMs / estimate.msPerByte);
+        }
+        bytes = std::min<double>(bytes, MaxBatchBytes);
+
+        double const documents = bytes / std::max(estimate.objSize, 1.0);
+        return static_cast<int>(std::max(1.0, std::min<double>(documents, MaxBatchSize)));
+    }
+
+    void AdaptiveBatchSize::addSample(const std::string &key, int documents, long long bytes, double elapsedMs)
+    {
+        if (documents <= 0 || bytes <= 0)
+            return;
+
+        double const objSize = static_cast<double>(bytes) / documents;
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto const it = _estimates.find(key);
+        if (it == _estimates.end()) {
+            // Round trip is not known from one sample, it is the whole latency for now
+            _estimates[key] = Estimate{ objSize, elapsedMs, 0 };
+            return;
+        }
+
+        Estimate &estimate = it->second;
+        estimate.objSize = SmoothingFactor * objSize + (1 - SmoothingFactor) * estimate.objSize;
+
+        // Batches never take less than round trip; it rises slowly, if network gets slower
+        if (elapsedMs < estimate.rttMs)
+            estimate.rttMs = elapsedMs;
+        else
+            estimate.rttMs += SmoothingFactor * 0.1 * (elapsedMs - estimate.rttMs);
+
+        double const msPerByte = std::max(elapsedMs - estimate.rttMs, 0.0) / bytes;
+        estimate.msPerByte = estimate.msPerByte > 0
+            ? SmoothingFactor * msPerByte + (1 - SmoothingFactor) * estimate.msPerByte
+            : msPerByte;
+    }
+}
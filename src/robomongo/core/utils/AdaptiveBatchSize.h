@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace Robomongo
+{
+    /**
+     * @brief Batch sizes of find/getMore, that target a byte budget per batch instead of a fixed
+     *        number of documents. Average document size, round trip time and transfer rate are
+     *        observed per key ("server/db.collection") in MongoClient::query(). Only batch size
+     *        on the wire changes, limit of page stays the same. Thread-safe.
+     */
+    class AdaptiveBatchSize
+    {
+    public:
+        // Weight of a new sample in moving averages
+        static constexpr double SmoothingFactor = 0.3;
+
+        // Round trip may take at most a quarter of a batch, so batch grows on slow links...
+        static constexpr double MinTransferToRtt = 3;
+
+        // ...while one batch is transferred in about a second at most
+        static constexpr double MaxBatchMs = 1000;
+
+        static const long long MaxBatchBytes = 16 * 1024 * 1024;  // reply of server is not larger
+        static const int MaxBatchSize = 100000;
+
+        static AdaptiveBatchSize &instance();
+
+        // 0 turns adaptive mode off, see SettingsManager::adaptiveBatchKb()
+        void setByteBudget(long long bytes) { _byteBudget = bytes; }
+        long long byteBudget() const { return _byteBudget; }
+
+        /**
+         * @return Number of documents of next batch for 'key', 'fixed' if adaptive mode is off
+         *         or nothing was observed yet
+         */
+        int batchSize(const std::string &key, int fixed) const;
+
+        void addSample(const std::string &key, int documents, long long bytes, double elapsedMs);
+
+    private:
+        struct Estimate
+        {
+            double objSize;     // average bytes of document
+            double rttMs;       // the lowest batch latency, slowly rising
+            double msPerByte;   // transfer time past round trip
+        };
+
+        std::atomic<long long> _byteBudget { 0 };
+        mutable std::mutex _mutex;
+        std::map<std::string, Estimate> _estimates;
+    };
+}
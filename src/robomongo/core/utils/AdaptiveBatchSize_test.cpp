@@ -0,0 +1,42 @@
+#include "gtest/gtest.h"
+#include "AdaptiveBatchSize.h"
+
+using namespace Robomongo;
+
+TEST(adaptive_batch_size_tests, fixed_until_enabled_and_observed)
+{
+    AdaptiveBatchSize batchSize;
+    batchSize.addSample("a/db.small", 100, 100 * 100, 10);
+    EXPECT_EQ(50, batchSize.batchSize("a/db.small", 50));
+
+    batchSize.setByteBudget(1024 * 1024);
+    EXPECT_EQ(50, batchSize.batchSize("a/db.other", 50));
+
+    // Tiny documents: many of them per batch, budget over average size
+    EXPECT_EQ(1024 * 1024 / 100, batchSize.batchSize("a/db.small", 50));
+}
+
+TEST(adaptive_batch_size_tests, huge_documents_are_limited_by_transfer_time)
+{
+    AdaptiveBatchSize batchSize;
+    batchSize.setByteBudget(64 * 1024 * 1024);
+
+    // 1 MB documents on a link of about 1 MB per 100 ms, round trip of 5 ms
+    batchSize.addSample("a/db.huge", 1, 1024 * 1024, 105);
+    batchSize.addSample("a/db.huge", 4, 4 * 1024 * 1024, 405);
+    int const documents = batchSize.batchSize("a/db.huge", 50);
+    EXPECT_GE(documents, 1);
+    EXPECT_LT(documents, 16);
+}
+
+TEST(adaptive_batch_size_tests, slow_round_trip_grows_batch_past_budget)
+{
+    AdaptiveBatchSize batchSize;
+    batchSize.setByteBudget(16 * 1024);
+
+    // 200 ms round trip, fast transfer: 100 bytes documents
+    batchSize.addSample("a/db.far", 100, 100 * 100, 200);
+    batchSize.addSample("a/db.far", 100, 100 * 100, 201);
+    EXPECT_GT(batchSize.batchSize("a/db.far", 50), 16 * 1024 / 100);
+    EXPECT_LE(batchSize.batchSize("a/db.far", 50), AdaptiveBatchSize::MaxBatchSize);
+}
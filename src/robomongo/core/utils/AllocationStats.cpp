@@ -0,0 +1,182 @@
+#include "robomongo/core/utils/AllocationStats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace Robomongo
+{
+namespace AllocationStats
+{
+#ifdef ROBOMONGO_ALLOCATION_STATS
+    namespace
+    {
+        // Fixed table, because counting must not allocate
+        const int MaxHandlers = 512;
+
+        struct Slot
+        {
+            std::atomic<const char *> handler { nullptr };
+            std::atomic<long long> calls { 0 };
+            std::atomic<long long> allocations { 0 };
+            std::atomic<long long> bytes { 0 };
+        };
+
+        Slot slots[MaxHandlers];
+        std::atomic<int> slotCount { 0 };
+        std::mutex slotMutex;
+        std::atomic<long long> total { 0 };
+
+        thread_local int currentSlot = -1;
+
+        int slotOf(const char *handler)
+        {
+            int const count = slotCount.load(std::memory_order_acquire);
+            for (int i = 0; i < count; ++i) {
+                if (slots[i].handler.load(std::memory_order_relaxed) == handler)
+                    return i;
+            }
+
+            std::lock_guard<std::mutex> lock(slotMutex);
+            int const locked = slotCount.load(std::memory_order_relaxed);
+            for (int i = count; i < locked; ++i) {
+                if (slots[i].handler.load(std::memory_order_relaxed) == handler)
+                    return i;
+            }
+
+            if (locked == MaxHandlers)
+                return -1;
+
+            slots[locked].handler.store(handler, std::memory_order_relaxed);
+            slotCount.store(locked + 1, std::memory_order_release);
+            return locked;
+        }
+
+        void count(size_t size)
+        {
+            total.fetch_add(1, std::memory_order_relaxed);
+            int const slot = currentSlot;
+            if (slot >= 0) {
+                slots[slot].allocations.fetch_add(1, std::memory_order_relaxed);
+                slots[slot].bytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+            }
+        }
+
+        void *allocate(size_t size)
+        {
+            count(size);
+            if (void *ptr = std::malloc(size ? size : 1))
+                return ptr;
+            throw std::bad_alloc();
+        }
+    }
+
+    Scope::Scope(const char *handler) :
+        _previous(currentSlot)
+    {
+        int const slot = slotOf(handler);
+        if (slot >= 0)
+            slots[slot].calls.fetch_add(1, std::memory_order_relaxed);
+        currentSlot = slot;
+    }
+
+    Scope::~Scope()
+    {
+        currentSlot = _previous;
+    }
+
+    bool enabled()
+    {
+        return true;
+    }
+
+    long long totalAllocations()
+    {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    std::vector<Entry> snapshot()
+    {
+        std::vector<Entry> entries;
+        int const count = slotCount.load(std::memory_order_acquire);
+        for (int i = 0; i < count; ++i) {
+            Entry entry;
+            entry.handler = slots[i].handler.load(std::memory_order_relaxed);
+            entry.calls = slots[i].calls.load(std::memory_order_relaxed);
+            entry.allocations = slots[i].allocations.load(std::memory_order_relaxed);
+            entry.bytes = slots[i].bytes.load(std::memory_order_relaxed);
+            entries.push_back(entry);
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+            return a.allocations > b.allocations;
+        });
+        return entries;
+    }
+#else
+    bool enabled()
+    {
+        return false;
+    }
+
+    long long totalAllocations()
+    {
+        return 0;
+    }
+
+    std::vector<Entry> snapshot()
+    {
+        return std::vector<Entry>();
+    }
+#endif
+
+    std::string report()
+    {
+        std::string result;
+        char line[256];
+        for (auto const &entry : snapshot()) {
+            double const calls = entry.calls > 0 ? static_cast<double>(entry.calls) : 1;
+            snprintf(line, sizeof(line), "%-45s calls %8lld  allocs/call %10.1f  bytes/call %12.0f\n",
+                     entry.handler.c_str(), entry.calls, entry.allocations / calls, entry.bytes / calls);
+            result += line;
+        }
+        return result;
+    }
+}
+}
+
+#ifdef ROBOMONGO_ALLOCATION_STATS
+// Replaceable global allocation functions (aligned and nothrow ones are left to the library)
+void *operator new(std::size_t size)
+{
+    return Robomongo::AllocationStats::allocate(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return Robomongo::AllocationStats::allocate(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Robomongo
+{
+    /**
+     * @brief Heap allocations (global operator new) counted per event handler, in builds
+     *        configured with -DALLOCATION_STATS=ON (ROBOMONGO_ALLOCATION_STATS). Handler is
+     *        the type of event being dispatched on the thread, see EventBusDispatcher.
+     *        In other builds nothing is counted and Scope is empty.
+     * @threadsafe
+     */
+    namespace AllocationStats
+    {
+        struct Entry
+        {
+            std::string handler;        // type of event, i.e. "LoadDatabaseNamesRequest*"
+            long long calls = 0;
+            long long allocations = 0;
+            long long bytes = 0;
+        };
+
+        bool enabled();
+
+        // All threads, in handlers or not
+        long long totalAllocations();
+
+        // Handlers with most allocations first
+        std::vector<Entry> snapshot();
+
+        // One line per handler: calls, allocations per call, bytes per call
+        std::string report();
+
+        /**
+         * @brief Allocations of this thread are counted for 'handler' during lifetime
+         *        of Scope. Handler must be a string with static storage (typeString()).
+         */
+        class Scope
+        {
+        public:
+#ifdef ROBOMONGO_ALLOCATION_STATS
+            explicit Scope(const char *handler);
+            ~Scope();
+
+        private:
+            int _previous;
+#else
+            explicit Scope(const char *) {}
+#endif
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+        };
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <mongo/bson/bsontypes.h>
+
+namespace Robomongo
+{
+    namespace BsonUtils
+    {
+        /**
+         * @brief Icon of value in tree view, resolved to QIcon by BsonTreeModel
+         */
+        enum class TypeIcon : unsigned char
+        {
+            Circle,
+            Double,
+            Decimal,
+            String,
+            Object,
+            Array,
+            Binary,
+            Boolean,
+            DateTime,
+            Null,
+            Integer
+        };
+
+        /**
+         * @brief Everything views need to know of BSON type, that does not depend on value.
+         *        BinData is named "Binary" here, UUID subtypes are resolved by BSONTypeToString().
+         */
+        struct TypeTraits
+        {
+            const char *name;
+            bool isSimple;      // edited and shown in one line, see isSimpleType()
+            bool isDocument;    // Object or Array, has child elements
+            TypeIcon icon;
+        };
+
+        namespace detail
+        {
+            constexpr TypeTraits traitsOf(int type)
+            {
+                switch (type) {
+                case mongo::NumberDouble:   return { "Double", true, false, TypeIcon::Double };
+                case mongo::NumberDecimal:  return { "Decimal128", true, false, TypeIcon::Decimal };
+                case mongo::String:         return { "String", true, false, TypeIcon::String };
+                case mongo::Object:         return { "Object", false, true, TypeIcon::Object };
+                case mongo::Array:          return { "Array", false, true, TypeIcon::Array };
+                case mongo::BinData:        return { "Binary", false, false, TypeIcon::Binary };
+                case mongo::Undefined:      return { "Undefined", false, false, TypeIcon::Circle };
+                case mongo::jstOID:         return { "ObjectId", true, false, TypeIcon::Circle };
+                case mongo::Bool:           return { "Boolean", true, false, TypeIcon::Boolean };
+                case mongo::Date:           return { "Date", true, false, TypeIcon::DateTime };
+                case mongo::jstNULL:        return { "Null", false, false, TypeIcon::Null };
+                case mongo::RegEx:          return { "Regular Expression", false, false, TypeIcon::Circle };
+                case mongo::DBRef:          return { "DBRef", false, false, TypeIcon::Circle };
+                case mongo::Code:           return { "Code", false, false, TypeIcon::Circle };
+                case mongo::Symbol:         return { "Symbol", false, false, TypeIcon::Circle };
+                case mongo::CodeWScope:     return { "CodeWScope", false, false, TypeIcon::Circle };
+                case mongo::NumberInt:      return { "Int32", true, false, TypeIcon::Integer };
+                case mongo::bsonTimestamp:  return { "Timestamp", false, false, TypeIcon::DateTime };
+                case mongo::NumberLong:     return { "Int64", true, false, TypeIcon::Integer };
+                default:                    return { "Type is not supported", false, false, TypeIcon::Circle };
+                }
+            }
+
+            // Indexed by type byte as stored in BSON, so MinKey (-1) is the last entry
+            constexpr std::array<TypeTraits, 256> makeTypeTraitsTable()
+            {
+                std::array<TypeTraits, 256> table {};
+                for (int i = 0; i < 256; ++i)
+                    table[i] = traitsOf(static_cast<signed char>(i));
+                return table;
+            }
+
+            inline constexpr std::array<TypeTraits, 256> typeTraitsTable = makeTypeTraitsTable();
+        }
+
+        /**
+         * @brief Traits of BSON type by one table lookup, instead of switch per property
+         */
+        constexpr const TypeTraits &typeTraits(mongo::BSONType type)
+        {
+            return detail::typeTraitsTable[static_cast<unsigned char>(type)];
+        }
+    }
+}
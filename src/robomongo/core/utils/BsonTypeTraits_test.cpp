@@ -0,0 +1,48 @@
+#include "gtest/gtest.h"
+#include "BsonTypeTraits.h"
+
+#include <string>
+
+#include "robomongo/core/utils/BsonUtils.h"
+
+using namespace Robomongo;
+
+// Table is generated at compile time
+static_assert(BsonUtils::typeTraits(mongo::Array).isDocument, "Array has child elements");
+static_assert(!BsonUtils::typeTraits(mongo::MinKey).isSimple, "MinKey is unsupported");
+
+TEST(bson_type_traits_tests, classification)
+{
+    EXPECT_TRUE(BsonUtils::isDocument(mongo::Object));
+    EXPECT_TRUE(BsonUtils::isDocument(mongo::Array));
+    EXPECT_FALSE(BsonUtils::isDocument(mongo::String));
+
+    for (mongo::BSONType type : { mongo::NumberLong, mongo::NumberDouble, mongo::NumberDecimal, mongo::NumberInt,
+                                  mongo::String, mongo::Bool, mongo::Date, mongo::jstOID })
+        EXPECT_TRUE(BsonUtils::isSimpleType(type)) << type;
+
+    for (mongo::BSONType type : { mongo::MinKey, mongo::EOO, mongo::Object, mongo::BinData, mongo::jstNULL,
+                                  mongo::RegEx, mongo::bsonTimestamp, mongo::MaxKey })
+        EXPECT_FALSE(BsonUtils::isSimpleType(type)) << type;
+}
+
+TEST(bson_type_traits_tests, names)
+{
+    EXPECT_EQ(std::string("Int32"), BsonUtils::BSONTypeToString(mongo::NumberInt, mongo::BinDataGeneral, DefaultEncoding));
+    EXPECT_EQ(std::string("Regular Expression"), BsonUtils::BSONTypeToString(mongo::RegEx, mongo::BinDataGeneral, DefaultEncoding));
+    EXPECT_EQ(std::string("Type is not supported"), BsonUtils::BSONTypeToString(mongo::MaxKey, mongo::BinDataGeneral, DefaultEncoding));
+    EXPECT_EQ(std::string("Type is not supported"), BsonUtils::BSONTypeToString(mongo::MinKey, mongo::BinDataGeneral, DefaultEncoding));
+
+    EXPECT_EQ(std::string("Binary"), BsonUtils::BSONTypeToString(mongo::BinData, mongo::BinDataGeneral, DefaultEncoding));
+    EXPECT_EQ(std::string("UUID"), BsonUtils::BSONTypeToString(mongo::BinData, mongo::newUUID, JavaLegacy));
+    EXPECT_EQ(std::string("Legacy UUID"), BsonUtils::BSONTypeToString(mongo::BinData, mongo::bdtUUID, DefaultEncoding));
+    EXPECT_EQ(std::string(".NET UUID (Legacy)"), BsonUtils::BSONTypeToString(mongo::BinData, mongo::bdtUUID, CSharpLegacy));
+}
+
+TEST(bson_type_traits_tests, icons)
+{
+    EXPECT_EQ(BsonUtils::TypeIcon::Integer, BsonUtils::typeTraits(mongo::NumberLong).icon);
+    EXPECT_EQ(BsonUtils::TypeIcon::DateTime, BsonUtils::typeTraits(mongo::bsonTimestamp).icon);
+    EXPECT_EQ(BsonUtils::TypeIcon::Circle, BsonUtils::typeTraits(mongo::jstOID).icon);
+    EXPECT_EQ(BsonUtils::TypeIcon::Circle, BsonUtils::typeTraits(mongo::MaxKey).icon);
+}
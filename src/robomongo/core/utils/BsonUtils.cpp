@@ -1,10 +1,16 @@
 #include "robomongo/core/utils/BsonUtils.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <sstream>
+
 #include <mongo/client/dbclient_base.h>
 //#include <mongo/bson/bsonobjiterator.h>
 #include "mongo/util/base64.h"
 #include "mongo/util/str.h"
 
+#include "robomongo/core/utils/BsonTypeTraits.h"
 #include "robomongo/core/utils/Logger.h"
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/core/HexUtils.h"
@@ -60,12 +66,257 @@ namespace Robomongo
             {
                 return elem.safeNumberLong();
             }
+
+            template<typename int_t>
+            void appendInteger(std::string &con, int_t value)
+            {
+                char buff[24];
+                std::to_chars_result const result = std::to_chars(buff, buff + sizeof(buff), value);
+                con.append(buff, result.ptr);
+            }
+
+            void appendIndent(std::string &con, int pretty)
+            {
+                for (int x = 0; x < pretty; x++) {
+                    con.append("    ");
+                }
+            }
+
+            // Formats 'value' into 'buff' as printf("%.15g") or printf("%.15f") would do,
+            // but independently of C locale (which is changed by Qt on Unix)
+            int formatDouble(char *buff, int size, double value, bool fixed)
+            {
+                int const precision = std::numeric_limits<double>::digits10;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+                std::to_chars_result const result = std::to_chars(buff, buff + size, value, 
+                    fixed ? std::chars_format::fixed : std::chars_format::general, precision);
+                return result.ptr - buff;
+#else
+                std::ostringstream ss;
+                ss.imbue(std::locale::classic());
+                ss.precision(precision);
+                if (fixed)
+                    ss << std::fixed;
+                ss << value;
+                std::string const str = ss.str();
+                int const length = std::min<int>(str.size(), size);
+                memcpy(buff, str.data(), length);
+                return length;
+#endif
+            }
+
+            // Same output as reformatDoubleString(), without intermediate strings
+            void appendDouble(std::string &con, double value)
+            {
+                char buff[64];
+                int length = formatDouble(buff, sizeof(buff), value, false);
+                mongo::StringData const str(buff, length);
+
+                bool const scientific = str.find("e+") != std::string::npos || 
+                                        str.find("e-") != std::string::npos;
+
+                // Leave trailing zero if needed
+                if (!scientific && value == (long long)value) {
+                    con.append(buff, length);
+                    con.append(".0");
+                    return;
+                }
+
+                if (str.endsWith("e+15") || str.endsWith("e+16")) {
+                    // Disable scientific format
+                    length = formatDouble(buff, sizeof(buff), value, true);
+                    mongo::StringData const fixedStr(buff, length);
+                    while (fixedStr.find('.') != std::string::npos && length >= 2 && 
+                           buff[length - 1] == '0' && buff[length - 2] == '0')
+                        --length;
+                }
+
+                con.append(buff, length);
+            }
+
+            // Shortest form that parses back to the same double, as Extended JSON v2 requires
+            void appendExactDouble(std::string &con, double value)
+            {
+                char buff[64];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+                std::to_chars_result const result = std::to_chars(buff, buff + sizeof(buff), value);
+                int const length = result.ptr - buff;
+#else
+                std::ostringstream ss;
+                ss.imbue(std::locale::classic());
+                ss.precision(std::numeric_limits<double>::max_digits10);
+                ss << value;
+                std::string const str = ss.str();
+                int const length = std::min<int>(str.size(), sizeof(buff));
+                memcpy(buff, str.data(), length);
+#endif
+                con.append(buff, length);
+
+                // Integral doubles keep their type when parsed back
+                if (!std::memchr(buff, '.', length) && !std::memchr(buff, 'e', length))
+                    con.append(".0");
+            }
+
+            void appendQuoted(std::string &con, mongo::StringData str)
+            {
+                con += '"';
+                con.append(mongo::str::escape(str));
+                con += '"';
+            }
+
+            // {"$key": "value"}
+            void appendWrapper(std::string &con, const char *key, mongo::StringData value, bool pretty)
+            {
+                con.append("{\"").append(key).append(pretty ? "\": " : "\":");
+                appendQuoted(con, value);
+                con += '}';
+            }
+
+            void appendExtendedValue(std::string &con, const BSONElement &elem, int pretty)
+            {
+                const char *const colon = pretty ? ": " : ":";
+                const char *const comma = pretty ? ", " : ",";
+
+                switch (elem.type()) {
+                case mongo::String:
+                    appendQuoted(con, mongo::StringData(elem.valuestr(), elem.valuestrsize() - 1));
+                    break;
+                case NumberInt:
+                    appendInteger(con, elem._numberInt());
+                    break;
+                case NumberLong:
+                    appendInteger(con, elem._numberLong());
+                    break;
+                case NumberDouble: {
+                    double const value = elem._numberDouble();
+                    if (std::isnan(value))
+                        appendWrapper(con, "$numberDouble", "NaN", pretty);
+                    else if (std::isinf(value))
+                        appendWrapper(con, "$numberDouble", value > 0 ? "Infinity" : "-Infinity", pretty);
+                    else
+                        appendExactDouble(con, value);
+                    break;
+                }
+                case NumberDecimal:
+                    appendWrapper(con, "$numberDecimal", elem._numberDecimal().toString(), pretty);
+                    break;
+                case mongo::Bool:
+                    con.append(elem.boolean() ? "true" : "false");
+                    break;
+                case jstNULL:
+                    con.append("null");
+                    break;
+                case Undefined:
+                    con.append("{\"$undefined\"").append(colon).append("true}");
+                    break;
+                case Object:
+                case mongo::Array:
+                    extendedJsonString(elem.embeddedObject(), con, pretty ? pretty + 1 : 0,
+                                       elem.type() == mongo::Array);
+                    break;
+                case jstOID:
+                    appendWrapper(con, "$oid", elem.__oid().toString(), pretty);
+                    break;
+                case BinData: {
+                    int length = 0;
+                    const char *const data = elem.binData(length);
+                    char subType[8] = {0};
+                    snprintf(subType, sizeof(subType), "%02x", static_cast<int>(elem.binDataType()));
+                    con.append("{\"$binary\"").append(colon).append("{\"base64\"").append(colon);
+                    appendQuoted(con, base64::encode(data, length));
+                    con.append(comma).append("\"subType\"").append(colon);
+                    appendQuoted(con, subType);
+                    con.append("}}");
+                    break;
+                }
+                case mongo::Date: {
+                    // Relaxed format: ISO-8601 for years 1970..9999, milliseconds otherwise
+                    long long const ms = elem.date().toMillisSinceEpoch();
+                    con.append("{\"$date\"").append(colon);
+                    if (ms >= 0 && ms < 253402300800000LL) {
+                        con += '"';
+                        miutil::appendIsoDate(con, ms, true, false);
+                        con += '"';
+                    }
+                    else {
+                        con.append("{\"$numberLong\"").append(colon).append("\"");
+                        appendInteger(con, ms);
+                        con.append("\"}");
+                    }
+                    con += '}';
+                    break;
+                }
+                case RegEx: {
+                    std::string options = elem.regexFlags();
+                    std::sort(options.begin(), options.end());
+                    con.append("{\"$regularExpression\"").append(colon).append("{\"pattern\"").append(colon);
+                    appendQuoted(con, elem.regex());
+                    con.append(comma).append("\"options\"").append(colon);
+                    appendQuoted(con, options);
+                    con.append("}}");
+                    break;
+                }
+                case DBRef: {
+                    const mongo::OID *const oid = reinterpret_cast<const mongo::OID *>(elem.valuestr() + elem.valuestrsize());
+                    con.append("{\"$dbPointer\"").append(colon).append("{\"$ref\"").append(colon);
+                    appendQuoted(con, elem.valuestr());
+                    con.append(comma).append("\"$id\"").append(colon);
+                    appendWrapper(con, "$oid", oid->toString(), pretty);
+                    con.append("}}");
+                    break;
+                }
+                case Symbol:
+                    appendWrapper(con, "$symbol", mongo::StringData(elem.valuestr(), elem.valuestrsize() - 1), pretty);
+                    break;
+                case Code:
+                    appendWrapper(con, "$code", elem._asCode(), pretty);
+                    break;
+                case CodeWScope:
+                    con.append("{\"$code\"").append(colon);
+                    appendQuoted(con, elem._asCode());
+                    con.append(comma).append("\"$scope\"").append(colon);
+                    extendedJsonString(elem.codeWScopeObject(), con, pretty ? pretty + 1 : 0);
+                    con += '}';
+                    break;
+                case bsonTimestamp:
+                    con.append("{\"$timestamp\"").append(colon).append("{\"t\"").append(colon);
+                    appendInteger(con, elem.timestamp().getSecs());
+                    con.append(comma).append("\"i\"").append(colon);
+                    appendInteger(con, elem.timestampInc());
+                    con.append("}}");
+                    break;
+                case MinKey:
+                    con.append("{\"$minKey\"").append(colon).append("1}");
+                    break;
+                case MaxKey:
+                    con.append("{\"$maxKey\"").append(colon).append("1}");
+                    break;
+                default:
+                    con.append("null");
+                    break;
+                }
+            }
         }
 
         std::string jsonString(const BSONObj &obj, JsonStringFormat format, int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
         {
-            using namespace std;
+            std::string con;
+            con.reserve(obj.objsize() * 2);
+            jsonString(obj, con, format, pretty, uuidEncoding, timeFormat, isArray);
+            return con;
+        }
 
+        std::string jsonString(const BSONElement &elem, JsonStringFormat format, bool includeFieldNames, 
+                               int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
+        {
+            std::string con;
+            jsonString(elem, con, format, includeFieldNames, pretty, uuidEncoding, timeFormat, isArray);
+            return con;
+        }
+
+        void jsonString(const BSONObj &obj, std::string &con, JsonStringFormat format, int pretty, 
+                        UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
+        {
             // Use of method, that is implemented in Robomongo Shell
             // Method "isArray()" is not part of MongoDB.
             // In order for this method to work, someone should
@@ -76,86 +327,79 @@ namespace Robomongo
             }
 
             if ( obj.isEmpty() ) {
-                return isArray? "[]" : "{}";
+                con.append(isArray ? "[]" : "{}");
+                return;
             }
 
-            StringBuilder s;
-            s << (isArray ? "[" : "{");
+            con += (isArray ? '[' : '{');
             BSONObjIterator i(obj);
             BSONElement e = i.next();
 
             if ( !e.eoo() ) {
                 while ( 1 ) {
                     if ( pretty ) {
-                        s << '\n';
-                        for( int x = 0; x < pretty; x++ ) {
-                            s << "    ";
-                        }
+                        con += '\n';
+                        detail::appendIndent(con, pretty);
                     }
                     else {
-                        s << " ";
+                        con += ' ';
                     }
 
-                    s << jsonString(e, format, true, pretty ? pretty + 1 : 0, uuidEncoding, timeFormat, isArray);
+                    jsonString(e, con, format, true, pretty ? pretty + 1 : 0, uuidEncoding, timeFormat, isArray);
                     e = i.next();
 
                     if (e.eoo()) {
-                        s << '\n';
-                        for( int x = 0; x < pretty - 1; x++ ) {
-                            s << "    ";
-                        }
-                        s << (isArray ? "]" : "}");
+                        con += '\n';
+                        detail::appendIndent(con, pretty - 1);
+                        con += (isArray ? ']' : '}');
                         break;
                     }
 
-                    s << ",";
+                    con += ',';
                 }
             }
-            return s.str();
         }
 
-        std::string jsonString(const BSONElement &elem, JsonStringFormat format, bool includeFieldNames, 
-                               int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
+        void jsonString(const BSONElement &elem, std::string &con, JsonStringFormat format, bool includeFieldNames, 
+                        int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
         {
-            using namespace std;
             BSONType t = elem.type();            
 
-            std::stringstream s;
-            if ( includeFieldNames && !isArray)
-                s << '"' << mongo::str::escape(elem.fieldName()) << "\" : ";
+            if ( includeFieldNames && !isArray) {
+                con += '"';
+                con.append(mongo::str::escape(elem.fieldName()));
+                con.append("\" : ");
+            }
 
             switch ( t ) {
             case Undefined:
-                s << "undefined";
+                con.append("undefined");
                 break;
             case mongo::String:
             case Symbol:
-                s << '"' << mongo::str::escape(std::string(elem.valuestr(), elem.valuestrsize() - 1))
-                  << '"';
+                con += '"';
+                con.append(mongo::str::escape(std::string(elem.valuestr(), elem.valuestrsize() - 1)));
+                con += '"';
                 break;
             case NumberLong:
-                s << "NumberLong(" << elem._numberLong() << ")";
+                con.append("NumberLong(");
+                detail::appendInteger(con, elem._numberLong());
+                con += ')';
                 break;
             case NumberInt:
-                s << elem._numberInt();
+                detail::appendInteger(con, elem._numberInt());
                 break;
             case NumberDouble:
                 {
                     if ( elem.number() >= -std::numeric_limits< double >::max() &&
                          elem.number() <= std::numeric_limits< double >::max() ) {
-                        std::stringstream ss;
-                        ss.precision(std::numeric_limits<double>::digits10);
-                        ss << elem.Double();
-                        std::string const str =
-                            reformatDoubleString(QString::fromStdString(ss.str()), elem.Double());
-
-                        s << (str);
+                        detail::appendDouble(con, elem.Double());
                     }
                     else if (std::isnan(elem.number()) ) {                        
-                        s << "NaN";
+                        con.append("NaN");
                     }
                     else if (std::isinf(elem.number()) ) {
-                        s << (std::to_string(elem.number()) == "inf" ? "Infinity" : "-Infinity");
+                        con.append(elem.number() > 0 ? "Infinity" : "-Infinity");
                     }
                     else {
                         StringBuilder ss;
@@ -166,52 +410,52 @@ namespace Robomongo
                     break;
                 }
             case NumberDecimal:
-                s << "NumberDecimal(\"" << elem._numberDecimal().toString() << "\")";
+                con.append("NumberDecimal(\"");
+                con.append(elem._numberDecimal().toString());
+                con.append("\")");
                 break;
             case mongo::Bool:
-                s << ( elem.boolean() ? "true" : "false" );
+                con.append( elem.boolean() ? "true" : "false" );
                 break;
             case jstNULL:
-                s << "null";
+                con.append("null");
                 break;
             case Object: {
                 BSONObj obj = elem.embeddedObject();
-                s << jsonString(obj, format, pretty, uuidEncoding, timeFormat);
+                jsonString(obj, con, format, pretty, uuidEncoding, timeFormat);
                 }
                 break;
             case mongo::Array: {
                 if ( elem.embeddedObject().isEmpty() ) {
-                    s << "[]";
+                    con.append("[]");
                     break;
                 }
-                s << "[ ";
+                con.append("[ ");
                 BSONObjIterator i( elem.embeddedObject() );
                 BSONElement e = i.next();
                 if ( !e.eoo() ) {
                     int count = 0;
                     while ( 1 ) {
                         if ( pretty ) {
-                            s << '\n';
-                            for( int x = 0; x < pretty; x++ )
-                                s << "    ";
+                            con += '\n';
+                            detail::appendIndent(con, pretty);
                         }
 
                         if (strtol(e.fieldName(), 0, 10) > count) {
-                            s << "undefined";
+                            con.append("undefined");
                         }
                         else {
-                            s << jsonString(e, format, false, pretty ? pretty + 1 : 0, uuidEncoding, timeFormat, true);
+                            jsonString(e, con, format, false, pretty ? pretty + 1 : 0, uuidEncoding, timeFormat, true);
                             e = i.next();
                         }
                         count++;
                         if ( e.eoo() ) {
-                            s << '\n';
-                            for( int x = 0; x < pretty - 1; x++ )
-                                s << "    ";
-                            s << "]";
+                            con += '\n';
+                            detail::appendIndent(con, pretty - 1);
+                            con += ']';
                             break;
                         }
-                        s << ", ";
+                        con.append(", ");
                     }
                 }
                 //s << " ]";
@@ -220,32 +464,38 @@ namespace Robomongo
             case DBRef: {
                 mongo::OID *x = (mongo::OID *) (elem.valuestr() + elem.valuestrsize());
                 if ( format == TenGen )
-                    s << "DBRef(";
+                    con.append("DBRef(");
                 else
-                    s << "{ \"$ref\" : ";
-                s << '"' << elem.valuestr() << "\", ";
+                    con.append("{ \"$ref\" : ");
+                con += '"';
+                con.append(elem.valuestr());
+                con.append("\", ");
                 if ( format != TenGen )
-                    s << "\"$id\" : ";
-                s << '"' << *x << "\"";
+                    con.append("\"$id\" : ");
+                con += '"';
+                con.append(x->toString());
+                con += '"';
                 if ( format == TenGen )
-                    s << ')';
+                    con += ')';
                 else
-                    s << '}';
+                    con += '}';
                 break;
             }
             case jstOID:
                 if ( format == TenGen ) {
-                    s << "ObjectId(";
+                    con.append("ObjectId(");
                 }
                 else {
-                    s << "{ \"$oid\" : ";
+                    con.append("{ \"$oid\" : ");
                 }
-                s << '"' << elem.__oid() << '"';
+                con += '"';
+                con.append(elem.__oid().toString());
+                con += '"';
                 if ( format == TenGen ) {
-                    s << ")";
+                    con += ')';
                 }
                 else {
-                    s << " }";
+                    con.append(" }");
                 }
                 break;
             case BinData: {
@@ -253,18 +503,18 @@ namespace Robomongo
                 BinDataType type = BinDataType( *(char *)( (int *)( elem.value() ) + 1 ) );
 
                 if (type == mongo::bdtUUID || type == mongo::newUUID) {
-                    s << HexUtils::formatUuid(elem, uuidEncoding);
+                    con.append(HexUtils::formatUuid(elem, uuidEncoding));
                     break;
                 }
 
-                s << "{ \"$binary\" : \"";
+                con.append("{ \"$binary\" : \"");
                 char *start = ( char * )( elem.value() ) + sizeof( int ) + 1;
-                base64::encode( s , start , len );
-                s << "\", \"$type\" : \"" << hex;
-                s.width( 2 );
-                s.fill( '0' );
-                s << type << dec;
-                s << "\" }";
+                con.append(base64::encode(start, len));
+                con.append("\", \"$type\" : \"");
+                char typeHex[8] = {0};
+                snprintf(typeHex, sizeof(typeHex), "%02x", static_cast<int>(type));
+                con.append(typeHex);
+                con.append("\" }");
                 break;
             }
             case mongo::Date:
@@ -274,46 +524,49 @@ namespace Robomongo
                     bool isSupportedDate = miutil::minDate < ms && ms < miutil::maxDate;
 
                     if ( format == Strict )
-                        s << "{ \"$date\" : ";
+                        con.append("{ \"$date\" : ");
                     else{
                         if (isSupportedDate) {
-                            s << "ISODate(";
+                            con.append("ISODate(");
                         }
                         else{
-                            s << "Date(";
+                            con.append("Date(");
                         }
                     }
 
                     if ( pretty && isSupportedDate) {
-                        boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
-                        boost::posix_time::time_duration diff = boost::posix_time::millisec(ms);
-                        boost::posix_time::ptime time = epoch + diff;
-                        std::string timestr = miutil::isotimeString(time, true, timeFormat == LocalTime);
-                        s << '"' << timestr << '"';
+                        con += '"';
+                        miutil::appendIsoDate(con, ms, true, timeFormat == LocalTime);
+                        con += '"';
                     }
                     else
-                        s << ms;
+                        detail::appendInteger(con, ms);
 
                     if ( format == Strict )
-                        s << " }";
+                        con.append(" }");
                     else
-                        s << ")";
+                        con += ')';
                     break;
                 }
             case RegEx:
                 if ( format == Strict ) {
-                    s << "{ \"$regex\" : \"" << mongo::str::escape(elem.regex());
-                    s << "\", \"$options\" : \"" << elem.regexFlags() << "\" }";
+                    con.append("{ \"$regex\" : \"");
+                    con.append(mongo::str::escape(elem.regex()));
+                    con.append("\", \"$options\" : \"");
+                    con.append(elem.regexFlags());
+                    con.append("\" }");
                 }
                 else {
-                    s << "/" << mongo::str::escape(elem.regex(), true) << "/";
+                    con += '/';
+                    con.append(mongo::str::escape(elem.regex(), true));
+                    con += '/';
                     // FIXME Worry about alpha order?
                     for ( const char *f = elem.regexFlags(); *f; ++f ) {
                         switch ( *f ) {
                         case 'g':
                         case 'i':
                         case 'm':
-                            s << *f;
+                            con += *f;
                         default:
                             break;
                         }
@@ -324,30 +577,42 @@ namespace Robomongo
             case CodeWScope: {
                 BSONObj scope = elem.codeWScopeObject();
                 if ( ! scope.isEmpty() ) {
-                    s << "{ \"$code\" : " << elem._asCode() << " , "
-                      << " \"$scope\" : " << scope.jsonString() << " }";
+                    con.append("{ \"$code\" : ");
+                    con.append(elem._asCode());
+                    con.append(" ,  \"$scope\" : ");
+                    con.append(scope.jsonString());
+                    con.append(" }");
                     break;
                 }
             }
 
             case Code:
-                s << elem._asCode();
+                con.append(elem._asCode());
                 break;
 
             case bsonTimestamp:
-                if ( format == TenGen )
-                    s << "Timestamp(" << elem.timestamp().getSecs() << ", " << elem.timestampInc() << ")";
-                else 
-                    s << "{ \"$timestamp\" : { \"t\" : " << elem.timestamp().getSecs() << ", \"i\" : " 
-                      << elem.timestampInc() << " } }";
+                if ( format == TenGen ) {
+                    con.append("Timestamp(");
+                    detail::appendInteger(con, elem.timestamp().getSecs());
+                    con.append(", ");
+                    detail::appendInteger(con, elem.timestampInc());
+                    con += ')';
+                }
+                else {
+                    con.append("{ \"$timestamp\" : { \"t\" : ");
+                    detail::appendInteger(con, elem.timestamp().getSecs());
+                    con.append(", \"i\" : ");
+                    detail::appendInteger(con, elem.timestampInc());
+                    con.append(" } }");
+                }
                 break;
 
             case MinKey:
-                s << "{ \"$minKey\" : 1 }";
+                con.append("{ \"$minKey\" : 1 }");
                 break;
 
             case MaxKey:
-                s << "{ \"$maxKey\" : 1 }";
+                con.append("{ \"$maxKey\" : 1 }");
                 break;
 
             default:
@@ -355,9 +620,65 @@ namespace Robomongo
                 ss << "Cannot create a properly formatted JSON string with "
                    << "element: " << elem.toString() << " of type: " << elem.type();
             }
-            return s.str();
         }
     
+        void extendedJsonString(const BSONObj &obj, std::string &con, int pretty, bool isArray)
+        {
+            // See jsonString() about isArray()
+            if (obj.isArray())
+                isArray = true;
+
+            con += (isArray ? '[' : '{');
+            bool first = true;
+            for (BSONElement const &elem : obj) {
+                if (!first)
+                    con += ',';
+                first = false;
+
+                if (pretty) {
+                    con += '\n';
+                    detail::appendIndent(con, pretty);
+                }
+
+                if (!isArray) {
+                    detail::appendQuoted(con, elem.fieldNameStringData());
+                    con.append(pretty ? ": " : ":");
+                }
+                detail::appendExtendedValue(con, elem, pretty);
+            }
+
+            if (pretty && !first) {
+                con += '\n';
+                detail::appendIndent(con, pretty - 1);
+            }
+            con += (isArray ? ']' : '}');
+        }
+
+        void jsonString(const BSONObj &obj, std::string &con, JsonOutputMode mode,
+                        UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
+        {
+            switch (mode) {
+            case RelaxedJson:
+                extendedJsonString(obj, con, 1, isArray);
+                break;
+            case CompactJson:
+                extendedJsonString(obj, con, 0, isArray);
+                break;
+            default:
+                jsonString(obj, con, mongo::TenGen, 1, uuidEncoding, timeFormat, isArray);
+                break;
+            }
+        }
+
+        std::string jsonString(const BSONObj &obj, JsonOutputMode mode, UUIDEncoding uuidEncoding,
+                               SupportedTimes timeFormat, bool isArray)
+        {
+            std::string con;
+            con.reserve(obj.objsize() * 2);
+            jsonString(obj, con, mode, uuidEncoding, timeFormat, isArray);
+            return con;
+        }
+
         bool isArray(const mongo::BSONElement &elem)
         {
             return isArray(elem.type());
@@ -375,30 +696,12 @@ namespace Robomongo
 
         bool isDocument(mongo::BSONType type)
         {
-            switch( type ) {
-            case mongo::Object:
-            case mongo::Array:
-                return true;
-            default:
-                return false;
-            }
+            return typeTraits(type).isDocument;
         }
 
         bool isSimpleType(const mongo::BSONType type)
         {
-            switch( type ) {
-            case NumberLong:
-            case NumberDouble:
-            case NumberDecimal:
-            case NumberInt:
-            case mongo::String:
-            case mongo::Bool:
-            case mongo::Date:
-            case jstOID:
-                return true;
-            default:
-                return false;
-            }
+            return typeTraits(type).isSimple;
         }
 
         bool isUuidType(const mongo::BSONType type, mongo::BinDataType binDataType)
@@ -425,140 +728,62 @@ namespace Robomongo
 
         const char* BSONTypeToString(mongo::BSONType type, mongo::BinDataType binDataType, UUIDEncoding uuidEncoding)
         {
-            switch (type)
-            {
-                /** double precision floating point value */
-            case NumberDouble:
-                {
-                    return "Double";
-                }
-                /** double precision floating point value */
-            case NumberDecimal:
-                {
-                    return "Decimal128";
-                }
-                /** character string, stored in utf8 */
-            case String:
-                {
-                    return "String";
-                }
-
-                /** an embedded object */
-            case Object:
-                {
-                    return "Object";
-                }
-                /** an embedded array */
-            case Array:
-                {
-                    return "Array";
-                }
-            case BinData:
-                {
-                    if (binDataType == mongo::newUUID) {
-                        return "UUID";
-                    } else if (binDataType == mongo::bdtUUID) {
-                        const char* type;
-                        switch(uuidEncoding) {
-                        case DefaultEncoding: type = "Legacy UUID"; break;
-                        case JavaLegacy:      type = "Java UUID (Legacy)"; break;
-                        case CSharpLegacy:    type = ".NET UUID (Legacy)"; break;
-                        case PythonLegacy:    type = "Python UUID (Legacy)"; break;
-                        default:              type = "Legacy UUID"; break;
-                        }
-
-                        return type;
-                    } else {
-                        return "Binary";
-                    }
-                }
-
-                /** Undefined type */
-            case Undefined:
-                {
-                    return "Undefined";
-                }
-
-                /** ObjectId */
-            case jstOID:
-                {
-                    return "ObjectId";
-                }
-
-                /** boolean type */
-            case Bool:
-                {
-                    return "Boolean";
+            // Only name of binary data depends on more than type
+            if (type == BinData && binDataType == mongo::newUUID)
+                return "UUID";
+
+            if (type == BinData && binDataType == mongo::bdtUUID) {
+                switch(uuidEncoding) {
+                case DefaultEncoding: return "Legacy UUID";
+                case JavaLegacy:      return "Java UUID (Legacy)";
+                case CSharpLegacy:    return ".NET UUID (Legacy)";
+                case PythonLegacy:    return "Python UUID (Legacy)";
+                default:              return "Legacy UUID";
                 }
+            }
 
-                /** date type */
-            case Date:
-                {
-                    return "Date";
-                }
+            return typeTraits(type).name;
+        }
 
-                /** null type */
+        void csvField(const BSONElement &elem, std::string &con, UUIDEncoding uuidEncoding,
+                      SupportedTimes timeFormat)
+        {
+            std::string value;
+            switch (elem.type()) {
+            case EOO:
             case jstNULL:
-                {
-                    return "Null";
-                }
+            case Undefined:
+                return;
+            case String:
+            case Symbol:
+                value.assign(elem.valuestr(), elem.valuestrsize() - 1);
                 break;
-
-                /** regular expression, a pattern with options */
-            case RegEx:
-                {
-                    return "Regular Expression";
-                }
-
-                /** deprecated / will be redesigned */
-            case DBRef:
-                {
-                    return "DBRef";
-                }
-
-                /** deprecated / use CodeWScope */
-            case Code:
-                {
-                    return "Code";
-                }
+            case Bool:
+                value = elem.Bool() ? "true" : "false";
                 break;
-
-                /** a programming language (e.g., Python) symbol */
-            case Symbol:
-                {
-                    return "Symbol";
-                }
-
-                /** javascript code that can execute on the database server, with SavedContext */
-            case CodeWScope:
-                {
-                    return "CodeWScope";
-                }
-
-                /** 32 bit signed integer */
             case NumberInt:
-                {
-                    return "Int32";
-                }
-
-                /** Updated to a Date with value next OpTime on insert */
-            case bsonTimestamp:
-                {
-                    return "Timestamp";
-                }
-
-                /** 64 bit integer */
+                value = std::to_string(elem._numberInt());
+                break;
             case NumberLong:
-                {
-                    return "Int64";
-                }
+                value = std::to_string(elem._numberLong());
                 break;
-
             default:
-                {
-                    return "Type is not supported";
-                }
+                jsonString(elem, value, Strict, false, 0, uuidEncoding, timeFormat);
+                break;
             }
+
+            if (value.find_first_of(",\"\r\n") == std::string::npos) {
+                con.append(value);
+                return;
+            }
+
+            con.push_back('"');
+            for (char const ch : value) {
+                if (ch == '"')
+                    con.push_back('"');
+                con.push_back(ch);
+            }
+            con.push_back('"');
         }
 
         void buildJsonString(const mongo::BSONObj &obj, std::string &con, UUIDEncoding uuid, SupportedTimes tz)
@@ -586,19 +811,13 @@ namespace Robomongo
                 {
                     if (elem.number() >= -std::numeric_limits< double >::max() &&
                         elem.number() <= std::numeric_limits< double >::max()) {
-                        std::stringstream ss;
-                        ss.precision(std::numeric_limits<double>::digits10);
-                        ss << elem.Double();          
-                        std::string const str = 
-                            reformatDoubleString(QString::fromStdString(ss.str()), elem.Double());
-
-                        con.append(str);
+                        detail::appendDouble(con, elem.Double());
                     }
                     else if (std::isnan(elem.number())) {
                         con.append("NaN");
                     }
                     else if (std::isinf(elem.number())) {
-                        con.append(std::to_string(elem.number()) == "inf" ? "Infinity" : "-Infinity");
+                        con.append(elem.number() > 0 ? "Infinity" : "-Infinity");
                     }
                     else {
                         StringBuilder ss;
@@ -631,7 +850,10 @@ namespace Robomongo
                         con.append(uu);
                         break;
                     }
-                    con.append("<binary>");
+                    // Only a prefix is formatted, whole value is paged by BinaryViewerDialog
+                    int len = 0;
+                    const char *data = elem.binData(len);
+                    con.append(HexUtils::formatBinaryPreview(data, len, BinaryPreviewBytes));
                 }
                 break;
             case Undefined:
@@ -639,10 +861,9 @@ namespace Robomongo
                 break;
             case jstOID:
                 {
-                    std::string idValue = elem.OID().toString();
-                    char buff[256] = {0};
-                    sprintf(buff, "ObjectId(\"%s\")", idValue.c_str());
-                    con.append(buff);
+                    con.append("ObjectId(\"");
+                    con.append(elem.OID().toString());
+                    con.append("\")");
                 }
                 break;
             case Bool:
@@ -653,17 +874,10 @@ namespace Robomongo
                     long long ms = (long long) elem.Date().toMillisSinceEpoch();
                     bool isSupportedDate = miutil::minDate < ms && ms < miutil::maxDate;
 
-                    boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
-                    boost::posix_time::time_duration diff = boost::posix_time::millisec(ms);
-                    boost::posix_time::ptime time = epoch + diff;
-
-                    std::string date;
                     if (isSupportedDate)
-                        date = miutil::isotimeString(time, false, tz == LocalTime);
+                        miutil::appendIsoDate(con, ms, false, tz == LocalTime);
                     else
-                        date = boost::lexical_cast<std::string>(ms);
-
-                    con.append(date);
+                        detail::appendInteger(con, ms);
                     break;
                 }
             case jstNULL:
@@ -705,9 +919,7 @@ namespace Robomongo
                 break;
             case NumberInt:
                 {
-                    char num[16] = {0};
-                    sprintf(num, "%d", elem.Int());
-                    con.append(num);
+                    detail::appendInteger(con, elem.Int());
                     break;
                 }           
             case bsonTimestamp:
@@ -722,9 +934,7 @@ namespace Robomongo
                 }
             case NumberLong:
                 {
-                    char num[32] = {0};
-                    sprintf(num, "%lld", elem.Long());
-                    con.append(num);
+                    detail::appendInteger(con, elem.Long());
                     break; 
                 }
 			case NumberDecimal:
@@ -762,6 +972,36 @@ namespace Robomongo
             return i;
         }
 
+        const std::vector<int> &ElementIndex::offsets(const mongo::BSONObj &doc)
+        {
+            auto const found = _offsets.find(doc.objdata());
+            if (found != _offsets.end())
+                return found->second;
+
+            std::vector<int> &offsets = _offsets[doc.objdata()];
+            mongo::BSONObjIterator iterator(doc);
+            while (iterator.more())
+                offsets.push_back(static_cast<int>(iterator.next().rawdata() - doc.objdata()));
+            offsets.shrink_to_fit();
+
+            _bytes += sizeof(std::pair<const char *, std::vector<int>>) + 2 * sizeof(void *) +
+                      offsets.capacity() * sizeof(int);
+            return offsets;
+        }
+
+        mongo::BSONElement indexOf(const mongo::BSONObj &doc, int index, ElementIndex &elements)
+        {
+            std::vector<int> const &offsets = elements.offsets(doc);
+            if (index < 0 || static_cast<size_t>(index) >= offsets.size())
+                return mongo::BSONElement();
+            return mongo::BSONElement(doc.objdata() + offsets[index]);
+        }
+
+        int elementsCount(const mongo::BSONObj &doc, ElementIndex &elements)
+        {
+            return static_cast<int>(elements.offsets(doc).size());
+        }
+
         std::string reformatDoubleString(QString str, double elemDouble)
         {
             // Leave trailing zero if needed
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_map>
+#include <vector>
 #include <mongo/bson/bsonelement.h>
 #include <mongo/bson/bsonobj.h>
 
@@ -90,6 +92,40 @@ namespace Robomongo
         std::string jsonString(const mongo::BSONElement &elem, mongo::JsonStringFormat format, bool includeFieldNames, int pretty,
             UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray = false);
 
+        /**
+         * @brief Same as above, but appends JSON to 'con'. Lets callers reuse one buffer
+         *        for many documents instead of allocating a string per document.
+         */
+        void jsonString(const mongo::BSONObj &obj, std::string &con, mongo::JsonStringFormat format, int pretty,
+            UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray = false);
+
+        void jsonString(const mongo::BSONElement &elem, std::string &con, mongo::JsonStringFormat format, bool includeFieldNames, 
+            int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray = false);
+
+        /**
+         * @brief Appends 'obj' as relaxed Extended JSON v2: type wrappers like {"$oid": ...}
+         *        instead of shell constructors, int64 as plain number and dates in ISO-8601.
+         *        Single line without spaces, if 'pretty' is 0.
+         */
+        void extendedJsonString(const mongo::BSONObj &obj, std::string &con, int pretty, bool isArray = false);
+
+        /**
+         * @brief JSON of 'obj' in output mode preset, see JsonOutputMode. Legacy UUID encoding
+         *        and time zone apply to shell syntax only, Extended JSON has fixed formats.
+         */
+        void jsonString(const mongo::BSONObj &obj, std::string &con, JsonOutputMode mode,
+            UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray = false);
+
+        std::string jsonString(const mongo::BSONObj &obj, JsonOutputMode mode,
+            UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray = false);
+
+        /**
+         * @brief Appends value of 'elem' as CSV field: strings and numbers as they are, other
+         *        types as Extended JSON, missing field as empty. Quoted when necessary.
+         */
+        void csvField(const mongo::BSONElement &elem, std::string &con, UUIDEncoding uuidEncoding,
+            SupportedTimes timeFormat);
+
         bool isArray(const mongo::BSONElement &elem);
         bool isArray(mongo::BSONType type);
         bool isDocument(const mongo::BSONElement &elem);
@@ -102,12 +138,38 @@ namespace Robomongo
 
         const char* BSONTypeToString(mongo::BSONType type, mongo::BinDataType binDataType, UUIDEncoding uuidEncoding);
 
+        // Bytes of BinData shown by buildJsonString(), cells show few characters of it anyway
+        const int BinaryPreviewBytes = 16;
+
         void buildJsonString(const mongo::BSONObj &obj, std::string &con, UUIDEncoding uuid, SupportedTimes tz);
         void buildJsonString(const mongo::BSONElement &elem, std::string &con, UUIDEncoding uuid, SupportedTimes tz);
 
         mongo::BSONElement indexOf(const mongo::BSONObj &doc, int index);
         int elementsCount(const mongo::BSONObj &doc);
 
+        /**
+         * @brief Offsets of elements of BSON objects, collected when object is indexed into
+         *        for the first time, so that next lookups by position and counts are O(1).
+         *        Objects are identified by address of their data: owner of the index keeps
+         *        documents alive, or clears the index. Not thread safe.
+         */
+        class ElementIndex
+        {
+        public:
+            // Offsets of elements from objdata(), in order of fields
+            const std::vector<int> &offsets(const mongo::BSONObj &doc);
+
+            void clear() { _offsets.clear(); _bytes = 0; }
+            size_t memoryBytes() const { return _bytes; }
+
+        private:
+            std::unordered_map<const char *, std::vector<int>> _offsets;
+            size_t _bytes = 0;
+        };
+
+        mongo::BSONElement indexOf(const mongo::BSONObj &doc, int index, ElementIndex &elements);
+        int elementsCount(const mongo::BSONObj &doc, ElementIndex &elements);
+
         std::string reformatDoubleString(QString str, double elemDouble);
     }
 }
@@ -0,0 +1,84 @@
+#include "gtest/gtest.h"
+#include "BsonUtils.h"
+
+#include <limits>
+#include <mongo/bson/bsonobjbuilder.h>
+
+using namespace Robomongo;
+
+namespace
+{
+    std::string compact(const mongo::BSONObj &obj)
+    {
+        std::string json;
+        BsonUtils::extendedJsonString(obj, json, 0);
+        return json;
+    }
+}
+
+TEST(bson_utils_tests, relaxed_extended_json_of_types)
+{
+    mongo::OID const oid("5f1e2d3c4b5a697887960504");
+    mongo::BSONObjBuilder builder;
+    builder.append("_id", oid);
+    builder.append("int", 5);
+    builder.append("long", 1234567890123LL);
+    builder.append("double", 1.0);
+    builder.append("fraction", 0.1);
+    builder.append("nan", std::numeric_limits<double>::quiet_NaN());
+    builder.appendDate("date", mongo::Date_t::fromMillisSinceEpoch(1500000000123LL));
+    builder.appendDate("old", mongo::Date_t::fromMillisSinceEpoch(-1000));
+    builder.appendRegex("re", "^a\"b", "mi");
+    builder.appendTimestamp("ts", 10ULL << 32 | 3);
+    builder.appendNull("null");
+    builder.appendMinKey("min");
+
+    EXPECT_EQ("{\"_id\":{\"$oid\":\"5f1e2d3c4b5a697887960504\"},\"int\":5,\"long\":1234567890123,"
+              "\"double\":1.0,\"fraction\":0.1,\"nan\":{\"$numberDouble\":\"NaN\"},"
+              "\"date\":{\"$date\":\"2017-07-14T02:40:00.123Z\"},"
+              "\"old\":{\"$date\":{\"$numberLong\":\"-1000\"}},"
+              "\"re\":{\"$regularExpression\":{\"pattern\":\"^a\\\"b\",\"options\":\"im\"}},"
+              "\"ts\":{\"$timestamp\":{\"t\":10,\"i\":3}},\"null\":null,\"min\":{\"$minKey\":1}}",
+              compact(builder.obj()));
+}
+
+TEST(bson_utils_tests, relaxed_extended_json_of_nested_and_binary)
+{
+    char const data[] = { 1, 2, 3 };
+    mongo::BSONObjBuilder builder;
+    builder.appendBinData("bin", sizeof(data), mongo::BinDataGeneral, data);
+    builder.append("list", BSON_ARRAY(1 << "two" << BSON("three" << 3)));
+    builder.append("empty", mongo::BSONObj());
+
+    EXPECT_EQ("{\"bin\":{\"$binary\":{\"base64\":\"AQID\",\"subType\":\"00\"}},"
+              "\"list\":[1,\"two\",{\"three\":3}],\"empty\":{}}",
+              compact(builder.obj()));
+}
+
+TEST(bson_utils_tests, output_modes)
+{
+    mongo::BSONObj const obj = BSON("a" << 1 << "b" << BSON("c" << 2LL));
+
+    EXPECT_EQ("{\"a\":1,\"b\":{\"c\":2}}", BsonUtils::jsonString(obj, CompactJson, DefaultEncoding, Utc));
+    EXPECT_EQ("{\n    \"a\": 1,\n    \"b\": {\n        \"c\": 2\n    }\n}",
+              BsonUtils::jsonString(obj, RelaxedJson, DefaultEncoding, Utc));
+    EXPECT_NE(std::string::npos, BsonUtils::jsonString(obj, ShellJson, DefaultEncoding, Utc).find("NumberLong(2)"));
+}
+
+TEST(bson_utils_tests, element_index_memory_after_clear)
+{
+    mongo::BSONObj const doc = BSON("a" << 1 << "b" << "x" << "c" << BSON("d" << 2));
+    BsonUtils::ElementIndex elements;
+    EXPECT_EQ(0u, elements.memoryBytes());
+
+    EXPECT_EQ("x", BsonUtils::indexOf(doc, 1, elements).String());
+    size_t const indexed = elements.memoryBytes();
+    EXPECT_GT(indexed, 0u);
+
+    elements.clear();
+    EXPECT_EQ(0u, elements.memoryBytes());
+
+    // Index made again is counted once, as after the first indexing
+    EXPECT_EQ(3, BsonUtils::elementsCount(doc, elements));
+    EXPECT_EQ(indexed, elements.memoryBytes());
+}
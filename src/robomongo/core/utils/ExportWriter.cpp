@@ -0,0 +1,282 @@
+#include "robomongo/core/utils/ExportWriter.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <stdexcept>
+
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    ExportWriter::ExportWriter(const QString &filePath, const ExportOptions &options) :
+        _options(options),
+        _file(new QSaveFile(filePath))
+    {
+        _archiveIndex.ns = options.ns;
+
+        if (!_file->open(QIODevice::WriteOnly))
+            throw std::runtime_error("Cannot create file " + QtUtils::toStdString(filePath) + ": " +
+                                     QtUtils::toStdString(_file->errorString()));
+
+        _thread = std::thread(&ExportWriter::run, this);
+    }
+
+    ExportWriter::~ExportWriter()
+    {
+        if (_thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _queue.clear();
+                _finishing = true;
+            }
+            _changed.notify_all();
+            _thread.join();
+        }
+
+        // Not committed file is removed
+        _file->cancelWriting();
+    }
+
+    void ExportWriter::push(std::vector<mongo::BSONObj> batch)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _changed.wait(lock, [this]() { return _queue.size() < MaxQueuedBatches || !_error.empty(); });
+        if (!_error.empty())
+            throw std::runtime_error(_error);
+
+        _queue.push_back(std::move(batch));
+        _changed.notify_all();
+    }
+
+    void ExportWriter::finish()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _finishing = true;
+        }
+        _changed.notify_all();
+        _thread.join();
+
+        throwIfFailed();
+        if (!_file->commit())
+            throw std::runtime_error("Cannot write file: " + QtUtils::toStdString(_file->errorString()));
+    }
+
+    QString ExportWriter::partFilePath(const QString &filePath, int index)
+    {
+        QFileInfo const file(filePath);
+        QString name = file.completeBaseName() + "." + QString::number(index + 1);
+        if (!file.suffix().isEmpty())
+            name += "." + file.suffix();
+        return file.dir().filePath(name);
+    }
+
+    ExportOptions ExportWriter::partOptions(const ExportOptions &options)
+    {
+        ExportOptions part = options;
+        part.header = false;
+        if (part.format == ExportFormat::JsonArray)
+            part.format = ExportFormat::JsonLines;
+        return part;
+    }
+
+    void ExportWriter::mergeParts(const std::vector<QString> &parts, const QString &filePath,
+                                  const ExportOptions &options)
+    {
+        try {
+            QSaveFile out(filePath);
+            if (!out.open(QIODevice::WriteOnly))
+                throw std::runtime_error("Cannot create file " + QtUtils::toStdString(filePath) + ": " +
+                                         QtUtils::toStdString(out.errorString()));
+
+            auto write = [&out](const QByteArray &data) {
+                if (out.write(data) != data.size())
+                    throw std::runtime_error("Cannot write file: " + QtUtils::toStdString(out.errorString()));
+            };
+
+            bool const isArray = options.format == ExportFormat::JsonArray;
+            if (isArray) {
+                write("[");
+            }
+            else if (options.format == ExportFormat::Csv && options.header) {
+                std::string header;
+                for (size_t i = 0; i < options.fields.size(); ++i) {
+                    if (i > 0)
+                        header.push_back(',');
+                    header.append(options.fields[i]);
+                }
+                header.push_back('\n');
+                write(QByteArray::fromStdString(header));
+            }
+
+            bool empty = true;
+            for (QString const &part : parts) {
+                QFile in(part);
+                if (!in.open(QIODevice::ReadOnly))
+                    throw std::runtime_error("Cannot read file " + QtUtils::toStdString(part) + ": " +
+                                             QtUtils::toStdString(in.errorString()));
+
+                while (!in.atEnd()) {
+                    if (!isArray) {
+                        write(in.read(FlushBytes));
+                        continue;
+                    }
+
+                    // Part has one document per line
+                    QByteArray const line = in.readLine().trimmed();
+                    if (line.isEmpty())
+                        continue;
+                    write(empty ? "\n" : ",\n");
+                    write(line);
+                    empty = false;
+                }
+            }
+
+            if (isArray)
+                write(empty ? "]\n" : "\n]\n");
+
+            if (!out.commit())
+                throw std::runtime_error("Cannot write file: " + QtUtils::toStdString(out.errorString()));
+        }
+        catch (const std::exception &) {
+            for (QString const &part : parts)
+                QFile::remove(part);
+            throw;
+        }
+
+        for (QString const &part : parts)
+            QFile::remove(part);
+    }
+
+    void ExportWriter::run()
+    {
+        std::string buffer;
+        buffer.reserve(FlushBytes * 2);
+
+        try {
+            if (_options.format == ExportFormat::JsonArray) {
+                buffer.push_back('[');
+            }
+            else if (_options.format == ExportFormat::ResultArchive) {
+                QByteArray const header = ResultArchive::header();
+                writeBytes(header.constData(), header.size());
+            }
+            else if (_options.format == ExportFormat::Csv && _options.header) {
+                for (size_t i = 0; i < _options.fields.size(); ++i) {
+                    if (i > 0)
+                        buffer.push_back(',');
+                    buffer.append(_options.fields[i]);
+                }
+                buffer.push_back('\n');
+            }
+
+            while (true) {
+                std::vector<mongo::BSONObj> batch;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _changed.wait(lock, [this]() { return _finishing || !_queue.empty(); });
+                    if (_queue.empty())
+                        break;
+
+                    batch = std::move(_queue.front());
+                    _queue.pop_front();
+                }
+                _changed.notify_all();
+
+                for (mongo::BSONObj const &doc : batch) {
+                    format(doc, buffer);
+                    if (buffer.size() >= FlushBytes)
+                        write(buffer);
+                }
+            }
+
+            if (_options.format == ExportFormat::JsonArray)
+                buffer.append(_documents > 0 ? "\n]\n" : "]\n");
+
+            write(buffer);
+
+            if (_options.format == ExportFormat::ResultArchive) {
+                QByteArray const footer = ResultArchive::footer(_archiveIndex, _bytes);
+                writeBytes(footer.constData(), footer.size());
+            }
+        }
+        catch (const std::exception &ex) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _error = ex.what();
+            _queue.clear();
+        }
+        _changed.notify_all();
+    }
+
+    void ExportWriter::format(const mongo::BSONObj &doc, std::string &buffer)
+    {
+        switch (_options.format) {
+        case ExportFormat::JsonLines:
+            formatJson(doc, buffer);
+            buffer.push_back('\n');
+            break;
+        case ExportFormat::JsonArray:
+            buffer.append(_documents > 0 ? ",\n" : "\n");
+            formatJson(doc, buffer);
+            break;
+        case ExportFormat::Csv:
+            for (size_t i = 0; i < _options.fields.size(); ++i) {
+                if (i > 0)
+                    buffer.push_back(',');
+                BsonUtils::csvField(doc.getFieldDotted(_options.fields[i]), buffer,
+                                    _options.uuidEncoding, _options.timeFormat);
+            }
+            buffer.push_back('\n');
+            break;
+        case ExportFormat::ResultArchive:
+            // Buffer of FlushBytes becomes one compressed block, see write()
+            buffer.append(doc.objdata(), doc.objsize());
+            ++_blockDocuments;
+            break;
+        }
+        ++_documents;
+    }
+
+    void ExportWriter::formatJson(const mongo::BSONObj &doc, std::string &buffer)
+    {
+        if (_options.jsonMode == ShellJson)
+            BsonUtils::jsonString(doc, buffer, mongo::Strict, 0, _options.uuidEncoding, _options.timeFormat);
+        else
+            BsonUtils::extendedJsonString(doc, buffer, 0);
+    }
+
+    void ExportWriter::write(std::string &buffer)
+    {
+        if (buffer.empty())
+            return;
+
+        if (_options.format == ExportFormat::ResultArchive) {
+            QByteArray const block = ResultArchive::compressBlock(buffer.data(), static_cast<int>(buffer.size()),
+                                                                  _blockDocuments, _bytes, _archiveIndex);
+            _blockDocuments = 0;
+            writeBytes(block.constData(), block.size());
+        }
+        else {
+            writeBytes(buffer.data(), static_cast<qint64>(buffer.size()));
+        }
+        buffer.clear();
+    }
+
+    void ExportWriter::writeBytes(const char *data, qint64 size)
+    {
+        if (_file->write(data, size) != size)
+            throw std::runtime_error("Cannot write file: " + QtUtils::toStdString(_file->errorString()));
+
+        _bytes += size;
+    }
+
+    void ExportWriter::throwIfFailed()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_error.empty())
+            throw std::runtime_error(_error);
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/Enums.h"
+#include "robomongo/core/domain/ResultArchive.h"
+
+QT_BEGIN_NAMESPACE
+class QSaveFile;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    enum class ExportFormat
+    {
+        JsonLines,      // one Extended JSON document per line
+        JsonArray,      // Extended JSON array of documents
+        Csv,            // values of selected fields, with header line
+        ResultArchive   // compressed BSON, see ResultArchive; not split to parallel ranges
+    };
+
+    struct ExportOptions
+    {
+        ExportFormat format = ExportFormat::JsonLines;
+        std::vector<std::string> fields;    // dotted paths, required for CSV
+        UUIDEncoding uuidEncoding = DefaultEncoding;
+        SupportedTimes timeFormat = Utc;
+        bool header = true;                 // CSV header line
+        std::string ns;                     // "db.collection", kept in index of ResultArchive
+
+        // Documents are always written on single line: relaxed Extended JSON v2 for both
+        // Extended JSON presets, legacy strict JSON for shell one (shell syntax is not JSON)
+        JsonOutputMode jsonMode = ShellJson;
+
+        // Large collections: _id keyspace is split into 'parallelism' ranges, which are
+        // exported concurrently, each on its own connection
+        int parallelism = 1;
+        bool readFromSecondaries = false;
+        bool separateFiles = false;         // file per range (see partFilePath()), otherwise
+                                            // ranges are merged in _id order
+    };
+
+    /**
+     * @brief Formats and writes exported documents in its own thread. Producer (cursor of
+     *        MongoWorker) pushes batches through bounded queue and waits, when writer is
+     *        behind by MaxQueuedBatches. File is replaced on finish() only: export which
+     *        failed or was cancelled leaves no partial file.
+     */
+    class ExportWriter
+    {
+    public:
+        /**
+         * @throws std::runtime_error, if file cannot be created
+         */
+        ExportWriter(const QString &filePath, const ExportOptions &options);
+
+        /**
+         * @brief Stops writer thread, file is discarded if finish() was not called
+         */
+        ~ExportWriter();
+
+        /**
+         * @brief Queues batch, waits while queue is full
+         * @throws std::runtime_error, if writing failed
+         */
+        void push(std::vector<mongo::BSONObj> batch);
+
+        /**
+         * @brief Writes the rest of queue and commits file
+         * @throws std::runtime_error, if writing failed
+         */
+        void finish();
+
+        /**
+         * @brief Path of file with range 'index' of parallel export, i.e. "dir/name.3.json"
+         */
+        static QString partFilePath(const QString &filePath, int index);
+
+        /**
+         * @brief Concatenates files written with partOptions() into 'filePath', in given order,
+         *        and removes them (also on failure). Like writer, 'filePath' is replaced only
+         *        if all parts were copied.
+         * @throws std::runtime_error
+         */
+        static void mergeParts(const std::vector<QString> &parts, const QString &filePath, 
+                               const ExportOptions &options);
+
+        /**
+         * @brief Options of parts that mergeParts() joins: lines without CSV header or
+         *        JSON array brackets
+         */
+        static ExportOptions partOptions(const ExportOptions &options);
+
+        long long documentsWritten() const { return _documents; }
+        long long bytesWritten() const { return _bytes; }
+
+    private:
+        void run();
+        void format(const mongo::BSONObj &doc, std::string &buffer);
+        void formatJson(const mongo::BSONObj &doc, std::string &buffer);
+        void write(std::string &buffer);
+        void writeBytes(const char *data, qint64 size);
+        void throwIfFailed();
+
+        static const size_t MaxQueuedBatches = 4;
+        static const size_t FlushBytes = 1024 * 1024;
+
+        ExportOptions const _options;
+        std::unique_ptr<QSaveFile> _file;
+
+        std::mutex _mutex;
+        std::condition_variable _changed;
+        std::deque<std::vector<mongo::BSONObj>> _queue;
+        bool _finishing = false;
+        std::string _error;
+
+        ResultArchive::Index _archiveIndex;     // of blocks written so far
+        long long _blockDocuments = 0;          // in buffer, not yet compressed into block
+
+        std::atomic<long long> _documents { 0 };
+        std::atomic<long long> _bytes { 0 };
+        std::thread _thread;
+    };
+}
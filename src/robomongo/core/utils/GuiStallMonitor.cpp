@@ -0,0 +1,184 @@
+#include "robomongo/core/utils/GuiStallMonitor.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <QAbstractEventDispatcher>
+#include <QDateTime>
+
+#include "robomongo/core/utils/Logger.h"
+
+namespace Robomongo
+{
+namespace GuiStallMonitor
+{
+    namespace
+    {
+        // Watchdog looks at GUI thread this often, so stalls are sampled within a quarter of threshold
+        const long long WatchdogPollMs = StallThresholdMs / 4;
+        const char *const UnknownActivity = "Qt events";
+
+        long long nowUs()
+        {
+            using namespace std::chrono;
+            return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+        }
+
+        std::thread::id guiThread;
+        std::atomic<bool> started { false };
+
+        // Shared with watchdog
+        std::atomic<const char *> activity { nullptr };
+        std::atomic<long long> busySinceUs { 0 };      // 0 while event loop waits for events
+        std::atomic<const char *> sampledActivity { nullptr };
+        std::atomic<long long> sampledIteration { 0 }; // busySinceUs of iteration sampled by watchdog
+
+        // GUI thread only: the longest scope of current iteration, if watchdog did not sample it
+        const char *longestActivity = nullptr;
+        long long longestUs = 0;
+
+        std::mutex statsMutex;
+        FrameStats stats;
+
+        void awake()
+        {
+            if (busySinceUs.load(std::memory_order_relaxed) != 0)
+                return;
+
+            longestActivity = nullptr;
+            longestUs = 0;
+            busySinceUs.store(nowUs(), std::memory_order_release);
+        }
+
+        void aboutToBlock()
+        {
+            long long const since = busySinceUs.exchange(0, std::memory_order_acq_rel);
+            if (since == 0)
+                return;
+
+            long long const frameUs = nowUs() - since;
+            const char *stallActivity = longestActivity;
+            if (sampledIteration.load(std::memory_order_acquire) == since)
+                stallActivity = sampledActivity.load(std::memory_order_relaxed);
+            std::string const label = stallActivity ? stallActivity : UnknownActivity;
+
+            bool isStall = false;
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                isStall = stats.record(frameUs, label, QDateTime::currentMSecsSinceEpoch());
+            }
+
+            // To log file only: status bar would be repainted by the very stall it reports
+            if (isStall) {
+                LOG_MSG(QString("GUI thread stalled for %1 ms in %2").arg(frameUs / 1000)
+                            .arg(QString::fromStdString(label)), mongo::logger::LogSeverity::Warning(), false);
+            }
+        }
+
+        class Watchdog
+        {
+        public:
+            Watchdog() :
+                _stop(false), _thread([this] { run(); }) {}
+
+            ~Watchdog()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _stop = true;
+                }
+                _wake.notify_one();
+                _thread.join();
+            }
+
+        private:
+            void run()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                while (!_wake.wait_for(lock, std::chrono::milliseconds(WatchdogPollMs), [this] { return _stop; })) {
+                    long long const since = busySinceUs.load(std::memory_order_acquire);
+                    if (since == 0 || sampledIteration.load(std::memory_order_relaxed) == since ||
+                        nowUs() - since < StallThresholdMs * 1000)
+                        continue;
+
+                    // Activity is published before iteration, so that GUI thread sees both
+                    sampledActivity.store(activity.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    sampledIteration.store(since, std::memory_order_release);
+                }
+            }
+
+            std::mutex _mutex;
+            std::condition_variable _wake;
+            bool _stop;
+            std::thread _thread;
+        };
+    }
+
+    bool FrameStats::record(long long frameUs, const std::string &activity, long long endedAtMs)
+    {
+        _frames.record(frameUs);
+        if (frameUs < _thresholdUs)
+            return false;
+
+        ++_stallCount;
+        _stalledUs += frameUs;
+        if (_stalls.size() == MaxStalls)
+            _stalls.pop_front();
+        _stalls.push_back({ endedAtMs, frameUs, activity });
+        return true;
+    }
+
+    void start()
+    {
+        if (started.exchange(true))
+            return;
+
+        guiThread = std::this_thread::get_id();
+        QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance();
+        QObject::connect(dispatcher, &QAbstractEventDispatcher::awake, &awake);
+        QObject::connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, &aboutToBlock);
+
+        // Joined at exit
+        static Watchdog watchdog;
+    }
+
+    FrameStats snapshot()
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        return stats;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats = FrameStats();
+    }
+
+    Scope::Scope(const char *handler) :
+        _previous(nullptr),
+        _started(0),
+        _isGui(started.load(std::memory_order_relaxed) && std::this_thread::get_id() == guiThread)
+    {
+        if (!_isGui)
+            return;
+
+        _previous = activity.exchange(handler, std::memory_order_relaxed);
+        _started = nowUs();
+    }
+
+    Scope::~Scope()
+    {
+        if (!_isGui)
+            return;
+
+        long long const us = nowUs() - _started;
+        if (us > longestUs) {
+            longestUs = us;
+            longestActivity = activity.load(std::memory_order_relaxed);
+        }
+        activity.store(_previous, std::memory_order_relaxed);
+    }
+}
+}
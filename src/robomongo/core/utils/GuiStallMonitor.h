@@ -0,0 +1,86 @@
+#pragma once
+
+#include <deque>
+#include <string>
+
+#include "robomongo/core/utils/LatencyHistogram.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Frame times of GUI thread: every iteration of its event loop, from wake up to
+     *        going idle again, is measured. Iterations longer than StallThresholdMs are stalls,
+     *        attributed to the activity (type of event being dispatched, see EventBusDispatcher)
+     *        which the watchdog thread saw running once the threshold was crossed.
+     * @threadsafe
+     */
+    namespace GuiStallMonitor
+    {
+        constexpr long long StallThresholdMs = 200;
+
+        struct Stall
+        {
+            long long endedAtMs = 0;        // since epoch
+            long long durationUs = 0;
+            std::string activity;           // i.e. "ExecuteQueryResponse*", "Qt events" if not known
+        };
+
+        /**
+         * @brief Histogram of frame times and the most recent stalls. Not thread safe.
+         */
+        class FrameStats
+        {
+        public:
+            static constexpr size_t MaxStalls = 100;
+
+            explicit FrameStats(long long thresholdUs = StallThresholdMs * 1000) :
+                _thresholdUs(thresholdUs) {}
+
+            // Returns true if frame is a stall
+            bool record(long long frameUs, const std::string &activity, long long endedAtMs);
+
+            long long thresholdUs() const { return _thresholdUs; }
+            const LatencyHistogram &frames() const { return _frames; }
+            unsigned long long stallCount() const { return _stallCount; }
+            long long stalledUs() const { return _stalledUs; }
+
+            // Oldest first, at most MaxStalls
+            const std::deque<Stall> &stalls() const { return _stalls; }
+
+        private:
+            long long _thresholdUs;
+            LatencyHistogram _frames;
+            unsigned long long _stallCount = 0;
+            long long _stalledUs = 0;
+            std::deque<Stall> _stalls;
+        };
+
+        /**
+         * @brief Starts measuring event loop of the calling (GUI) thread and the watchdog.
+         *        Call once, after QApplication is created.
+         */
+        void start();
+
+        FrameStats snapshot();
+        void clear();
+
+        /**
+         * @brief What GUI thread is doing during lifetime of Scope. Handler must be a string
+         *        with static storage (typeString()). Scopes of other threads are ignored.
+         */
+        class Scope
+        {
+        public:
+            explicit Scope(const char *handler);
+            ~Scope();
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            const char *_previous;
+            long long _started;
+            bool const _isGui;
+        };
+    }
+}
@@ -0,0 +1,31 @@
+#include "gtest/gtest.h"
+#include "GuiStallMonitor.h"
+
+using namespace Robomongo;
+
+TEST(gui_stall_monitor_tests, frames_over_threshold_are_stalls)
+{
+    GuiStallMonitor::FrameStats stats(200000);
+    EXPECT_FALSE(stats.record(1500, "Qt events", 1));
+    EXPECT_FALSE(stats.record(199999, "LoadCollectionNamesResponse*", 2));
+    EXPECT_TRUE(stats.record(250000, "ExecuteQueryResponse*", 3));
+
+    EXPECT_EQ(3u, stats.frames().count());
+    EXPECT_EQ(250000, stats.frames().maxUs());
+    EXPECT_EQ(1u, stats.stallCount());
+    EXPECT_EQ(250000, stats.stalledUs());
+    ASSERT_EQ(1u, stats.stalls().size());
+    EXPECT_EQ("ExecuteQueryResponse*", stats.stalls().front().activity);
+    EXPECT_EQ(3, stats.stalls().front().endedAtMs);
+}
+
+TEST(gui_stall_monitor_tests, only_recent_stalls_are_kept)
+{
+    GuiStallMonitor::FrameStats stats(1000);
+    for (size_t i = 0; i < GuiStallMonitor::FrameStats::MaxStalls + 5; ++i)
+        stats.record(2000, "Qt events", static_cast<long long>(i));
+
+    EXPECT_EQ(GuiStallMonitor::FrameStats::MaxStalls + 5, stats.stallCount());
+    ASSERT_EQ(GuiStallMonitor::FrameStats::MaxStalls, stats.stalls().size());
+    EXPECT_EQ(5, stats.stalls().front().endedAtMs);
+}
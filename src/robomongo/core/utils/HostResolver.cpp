@@ -0,0 +1,132 @@
+#include "robomongo/core/utils/HostResolver.h"
+
+#include <algorithm>
+#include <cctype>
+#include <thread>
+#include <QHostAddress>
+#include <QHostInfo>
+
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace
+{
+    // Host names are case-insensitive
+    std::string keyOf(const std::string &host)
+    {
+        std::string key = host;
+        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char ch) { return std::tolower(ch); });
+        return key;
+    }
+}
+
+namespace Robomongo
+{
+    constexpr std::chrono::seconds HostResolver::Ttl;
+    constexpr std::chrono::seconds HostResolver::FailureTtl;
+
+    HostResolver &HostResolver::instance()
+    {
+        // Never deleted, prefetch() threads may outlive static destruction
+        static HostResolver *const resolver = new HostResolver;
+        return *resolver;
+    }
+
+    HostResolver::HostResolver(Lookup lookup) :
+        _lookup(std::move(lookup))
+    {
+    }
+
+    std::string HostResolver::resolve(const std::string &host, std::string *error, Clock::time_point now)
+    {
+        if (host.empty() || isNumeric(host))
+            return host;
+
+        std::string const key = keyOf(host);
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;) {
+            auto const it = _entries.find(key);
+            if (it != _entries.end() && it->second.expiresAt > now) {
+                if (error)
+                    *error = it->second.error;
+                return it->second.addresses.empty() ? std::string() : it->second.addresses.front();
+            }
+
+            if (_pending.count(key) == 0)
+                break;
+
+            _lookedUp.wait(lock);
+        }
+
+        _pending.insert(key);
+        lock.unlock();
+
+        Entry entry;
+        entry.addresses = _lookup(host, entry.error);
+        if (entry.addresses.empty() && entry.error.empty())
+            entry.error = "No addresses of " + host;
+        entry.expiresAt = now + (entry.addresses.empty() ? FailureTtl : Ttl);
+
+        lock.lock();
+        _entries[key] = entry;
+        _pending.erase(key);
+        lock.unlock();
+        _lookedUp.notify_all();
+
+        if (error)
+            *error = entry.error;
+        return entry.addresses.empty() ? std::string() : entry.addresses.front();
+    }
+
+    void HostResolver::prefetch(const std::vector<std::string> &hosts)
+    {
+        for (auto const &host : hosts) {
+            if (host.empty() || isNumeric(host) || isCached(host))
+                continue;
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_pending.count(keyOf(host)))
+                    continue;
+            }
+
+            std::thread([this, host] { resolve(host); }).detach();
+        }
+    }
+
+    void HostResolver::invalidate(const std::string &host)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.erase(keyOf(host));
+    }
+
+    bool HostResolver::isCached(const std::string &host, Clock::time_point now) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto const it = _entries.find(keyOf(host));
+        return it != _entries.end() && it->second.expiresAt > now;
+    }
+
+    bool HostResolver::isNumeric(const std::string &host)
+    {
+        return !QHostAddress(QtUtils::toQString(host)).isNull();
+    }
+
+    std::vector<std::string> HostResolver::systemLookup(const std::string &host, std::string &error)
+    {
+        std::vector<std::string> addresses;
+        QHostInfo const info = QHostInfo::fromName(QtUtils::toQString(host));
+        if (info.error() != QHostInfo::NoError) {
+            error = "Cannot resolve " + host + ": " + QtUtils::toStdString(info.errorString());
+            return addresses;
+        }
+
+        // IPv4 first, as getaddrinfo() of driver orders them on most systems
+        QList<QHostAddress> all = info.addresses();
+        std::stable_partition(all.begin(), all.end(), [](const QHostAddress &address) {
+            return address.protocol() == QAbstractSocket::IPv4Protocol;
+        });
+        for (QHostAddress const &address : all)
+            addresses.push_back(QtUtils::toStdString(address.toString()));
+        return addresses;
+    }
+}
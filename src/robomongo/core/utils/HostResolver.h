@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace Robomongo
+{
+    /**
+     * @brief Addresses of host names, shared by workers of all connections, so that reconnects
+     *        and extra connections to the same host do not wait for DNS. Concurrent lookups of
+     *        one host are done once, others wait for its answer. Thread-safe.
+     */
+    class HostResolver
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        // System resolver does not tell TTL of records, answers are kept for fixed times
+        static constexpr std::chrono::seconds Ttl { 300 };
+        static constexpr std::chrono::seconds FailureTtl { 10 };
+
+        // Addresses of host, or empty list and error
+        typedef std::function<std::vector<std::string>(const std::string &host, std::string &error)> Lookup;
+
+        static HostResolver &instance();
+
+        explicit HostResolver(Lookup lookup = systemLookup);
+
+        /**
+         * @brief First address of host, looked up unless it is cached. Numeric addresses
+         *        are returned as they are.
+         * @return Empty, if host cannot be resolved ('error' tells why)
+         */
+        std::string resolve(const std::string &host, std::string *error = nullptr,
+                            Clock::time_point now = Clock::now());
+
+        // Starts lookups of hosts, which are not cached, in background
+        void prefetch(const std::vector<std::string> &hosts);
+
+        // Host is looked up again on next resolve(), i.e. after connection to its address failed
+        void invalidate(const std::string &host);
+
+        bool isCached(const std::string &host, Clock::time_point now = Clock::now()) const;
+
+        static bool isNumeric(const std::string &host);
+        static std::vector<std::string> systemLookup(const std::string &host, std::string &error);
+
+    private:
+        struct Entry
+        {
+            std::vector<std::string> addresses;
+            std::string error;
+            Clock::time_point expiresAt;
+        };
+
+        Lookup const _lookup;
+        mutable std::mutex _mutex;
+        std::condition_variable _lookedUp;
+        std::map<std::string, Entry> _entries;
+        std::set<std::string> _pending;     // hosts being looked up
+    };
+}
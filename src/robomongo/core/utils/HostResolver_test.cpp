@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+#include "HostResolver.h"
+
+using namespace Robomongo;
+
+namespace
+{
+    struct FakeDns
+    {
+        std::map<std::string, std::string> records;
+        int lookups = 0;
+
+        HostResolver::Lookup lookup()
+        {
+            return [this](const std::string &host, std::string &error) {
+                ++lookups;
+                auto const it = records.find(host);
+                if (it == records.end()) {
+                    error = "Host not found";
+                    return std::vector<std::string>();
+                }
+                return std::vector<std::string> { it->second };
+            };
+        }
+    };
+}
+
+TEST(host_resolver_tests, caches_answers_for_ttl)
+{
+    FakeDns dns;
+    dns.records["db.example.com"] = "10.0.0.5";
+    HostResolver resolver(dns.lookup());
+    auto const now = HostResolver::Clock::now();
+
+    EXPECT_EQ("10.0.0.5", resolver.resolve("db.example.com", nullptr, now));
+    EXPECT_EQ("10.0.0.5", resolver.resolve("DB.Example.com", nullptr, now + std::chrono::seconds(1)));
+    EXPECT_EQ(1, dns.lookups);
+    EXPECT_TRUE(resolver.isCached("db.example.com", now));
+
+    dns.records["db.example.com"] = "10.0.0.6";
+    EXPECT_EQ("10.0.0.6", resolver.resolve("db.example.com", nullptr, now + HostResolver::Ttl));
+    EXPECT_EQ(2, dns.lookups);
+}
+
+TEST(host_resolver_tests, failures_are_cached_briefly)
+{
+    FakeDns dns;
+    HostResolver resolver(dns.lookup());
+    auto const now = HostResolver::Clock::now();
+
+    std::string error;
+    EXPECT_EQ("", resolver.resolve("missing", &error, now));
+    EXPECT_EQ("Host not found", error);
+    EXPECT_EQ("", resolver.resolve("missing", nullptr, now));
+    EXPECT_EQ(1, dns.lookups);
+
+    dns.records["missing"] = "10.0.0.7";
+    EXPECT_EQ("10.0.0.7", resolver.resolve("missing", &error, now + HostResolver::FailureTtl));
+    EXPECT_EQ("", error);
+}
+
+TEST(host_resolver_tests, numeric_and_invalidated_hosts)
+{
+    FakeDns dns;
+    dns.records["db"] = "10.0.0.5";
+    HostResolver resolver(dns.lookup());
+
+    EXPECT_EQ("127.0.0.1", resolver.resolve("127.0.0.1"));
+    EXPECT_EQ("::1", resolver.resolve("::1"));
+    EXPECT_EQ(0, dns.lookups);
+
+    resolver.resolve("db");
+    resolver.invalidate("db");
+    EXPECT_FALSE(resolver.isCached("db"));
+    resolver.resolve("db");
+    EXPECT_EQ(2, dns.lookups);
+}
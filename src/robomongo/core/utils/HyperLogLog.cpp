@@ -0,0 +1,64 @@
+#include "robomongo/core/utils/HyperLogLog.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Robomongo
+{
+    void HyperLogLog::addHash(uint64_t hash)
+    {
+        // Top bits select register, it keeps the longest run of leading zeros of the rest (+1)
+        size_t const index = hash >> (64 - Precision);
+        uint64_t const rest = (hash << Precision) | (1ULL << (Precision - 1));
+        uint8_t rank = 1;
+        for (uint64_t bit = 1ULL << 63; !(rest & bit); bit >>= 1)
+            ++rank;
+
+        _registers[index] = std::max(_registers[index], rank);
+    }
+
+    void HyperLogLog::merge(const HyperLogLog &other)
+    {
+        for (int i = 0; i < RegisterCount; ++i)
+            _registers[i] = std::max(_registers[i], other._registers[i]);
+    }
+
+    double HyperLogLog::estimate() const
+    {
+        double sum = 0;
+        int zeros = 0;
+        for (uint8_t const rank : _registers) {
+            sum += std::ldexp(1.0, -rank);
+            if (rank == 0)
+                ++zeros;
+        }
+
+        double const m = RegisterCount;
+        double const alpha = 0.7213 / (1 + 1.079 / m);
+        double const raw = alpha * m * m / sum;
+
+        // Linear counting is more precise while many registers are empty
+        if (raw <= 2.5 * m && zeros > 0)
+            return m * std::log(m / zeros);
+
+        return raw;
+    }
+
+    uint64_t HyperLogLog::hash(const void *data, size_t size)
+    {
+        // FNV-1a over bytes, then finalizer of splitmix64 spreads it over all bits
+        auto const bytes = static_cast<const unsigned char *>(data);
+        uint64_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i < size; ++i) {
+            h ^= bytes[i];
+            h *= 1099511628211ULL;
+        }
+
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Robomongo
+{
+    /**
+     * @brief Approximate count of distinct values in fixed memory (HyperLogLog with 2^Precision
+     *        one-byte registers, about 2.3% standard error). Small counts are corrected with
+     *        linear counting, so they are nearly exact. Not thread safe.
+     */
+    class HyperLogLog
+    {
+    public:
+        static constexpr int Precision = 11;
+        static constexpr int RegisterCount = 1 << Precision;
+
+        void add(const void *data, size_t size) { addHash(hash(data, size)); }
+        void addHash(uint64_t hash);
+        void merge(const HyperLogLog &other);
+
+        double estimate() const;
+
+        // 64-bit hash with well mixed bits, as the estimate needs
+        static uint64_t hash(const void *data, size_t size);
+
+    private:
+        std::array<uint8_t, RegisterCount> _registers {};
+    };
+}
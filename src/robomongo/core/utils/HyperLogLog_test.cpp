@@ -0,0 +1,35 @@
+#include "gtest/gtest.h"
+#include "HyperLogLog.h"
+
+#include <string>
+
+using namespace Robomongo;
+
+TEST(hyper_log_log_tests, small_counts_are_nearly_exact)
+{
+    HyperLogLog distinct;
+    EXPECT_EQ(0, distinct.estimate());
+
+    for (int repeat = 0; repeat < 3; ++repeat) {
+        for (int i = 0; i < 100; ++i) {
+            std::string const value = "value" + std::to_string(i);
+            distinct.add(value.data(), value.size());
+        }
+    }
+    EXPECT_NEAR(100, distinct.estimate(), 2);
+}
+
+TEST(hyper_log_log_tests, large_counts_within_error)
+{
+    HyperLogLog first;
+    HyperLogLog second;
+    for (int i = 0; i < 200000; ++i) {
+        (i % 2 ? first : second).add(&i, sizeof(i));
+        first.add(&i, sizeof(i));
+    }
+    EXPECT_NEAR(200000, first.estimate(), 200000 * 0.07);
+
+    // Union of the same values does not grow
+    second.merge(first);
+    EXPECT_NEAR(first.estimate(), second.estimate(), 1);
+}
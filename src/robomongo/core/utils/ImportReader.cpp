@@ -0,0 +1,423 @@
+#include "robomongo/core/utils/ImportReader.h"
+
+#include <QFile>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <mongo/base/string_data.h>
+
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/shell/bson/json.h"
+
+namespace Robomongo
+{
+    ImportReader::ImportReader(const QString &filePath, const ImportOptions &options) :
+        _options(options),
+        _file(new QFile(filePath)),
+        _data(nullptr),
+        _size(0),
+        _csvColumns(0),
+        _csvHasId(false),
+        _position(0),
+        _inArray(false),
+        _scanned(false),
+        _chunkCount(0),
+        _taken(0),
+        _stopping(false),
+        _bytesRead(0),
+        _threadCount(0)
+    {
+        if (!_file->open(QIODevice::ReadOnly))
+            throw std::runtime_error("Cannot open file " + QtUtils::toStdString(filePath) + ": " +
+                                     QtUtils::toStdString(_file->errorString()));
+
+        _size = static_cast<size_t>(_file->size());
+        if (_size > 0) {
+            _data = reinterpret_cast<const char *>(_file->map(0, _file->size()));
+            if (!_data)
+                throw std::runtime_error("Cannot read file " + QtUtils::toStdString(filePath) + ": " +
+                                         QtUtils::toStdString(_file->errorString()));
+        }
+
+        // UTF-8 byte order mark
+        if (_size >= 3 && std::memcmp(_data, "\xEF\xBB\xBF", 3) == 0)
+            _position = 3;
+
+        if (_options.format == ImportFormat::Csv)
+            readCsvHeader();
+
+        int const threads = _options.parserThreads > 0 ? _options.parserThreads :
+                            static_cast<int>(std::thread::hardware_concurrency());
+        _threadCount = static_cast<size_t>(std::max(1, std::min<int>(threads, MaxParserThreads)));
+        for (size_t i = 0; i < _threadCount; ++i)
+            _threads.emplace_back(&ImportReader::run, this);
+    }
+
+    ImportReader::~ImportReader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _changed.notify_all();
+        for (std::thread &thread : _threads)
+            thread.join();
+    }
+
+    bool ImportReader::next(std::vector<mongo::BSONObj> &batch)
+    {
+        if (!_pendingError.empty())
+            throw std::runtime_error(_pendingError);
+
+        Chunk chunk;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _changed.wait(lock, [this]() {
+                return _parsed.count(_taken) || (_scanned && _taken >= _chunkCount);
+            });
+
+            auto const it = _parsed.find(_taken);
+            if (it == _parsed.end())
+                return false;
+
+            chunk = std::move(it->second);
+            _parsed.erase(it);
+            ++_taken;
+            _bytesRead = static_cast<long long>(chunk.end);
+        }
+        _changed.notify_all();
+
+        // Documents before invalid one are returned, error is thrown by the next call
+        batch = std::move(chunk.documents);
+        if (!chunk.error.empty()) {
+            if (batch.empty())
+                throw std::runtime_error(chunk.error);
+            _pendingError = chunk.error;
+        }
+        return true;
+    }
+
+    void ImportReader::run()
+    {
+        while (true) {
+            std::vector<Span> spans;
+            std::string error;
+            Chunk chunk;
+            size_t index = 0;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _changed.wait(lock, [this]() {
+                    return _stopping || _scanned || _chunkCount - _taken < MaxChunksAhead * _threadCount;
+                });
+                if (_stopping || _scanned)
+                    return;
+
+                spans = scan(error);
+                if (spans.empty() && error.empty()) {
+                    _scanned = true;
+                    _changed.notify_all();
+                    return;
+                }
+
+                index = _chunkCount++;
+                if (!error.empty())
+                    _scanned = true;
+                chunk.end = _position;
+            }
+
+            parse(spans, chunk);
+            if (chunk.error.empty())
+                chunk.error = error;
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _parsed[index] = std::move(chunk);
+            }
+            _changed.notify_all();
+        }
+    }
+
+    std::vector<ImportReader::Span> ImportReader::scan(std::string &error)
+    {
+        size_t const batchSize = static_cast<size_t>(std::max(1, _options.batchSize));
+        std::vector<Span> spans;
+        spans.reserve(batchSize);
+
+        Span span;
+        while (spans.size() < batchSize) {
+            bool const found = _options.format == ImportFormat::Csv ? scanCsvRow(span) :
+                                                                      scanJsonDocument(span, error);
+            if (!found)
+                break;
+            spans.push_back(span);
+        }
+        return spans;
+    }
+
+    bool ImportReader::scanJsonDocument(Span &span, std::string &error)
+    {
+        // Documents may be separated by whitespace (JSON Lines) or be items of array
+        size_t i = _position;
+        for (; i < _size; ++i) {
+            char const c = _data[i];
+            if (std::isspace(static_cast<unsigned char>(c)) || c == ',')
+                continue;
+            if (c == '[' && !_inArray)
+                _inArray = true;
+            else if (c == ']' && _inArray)
+                _inArray = false;
+            else
+                break;
+        }
+
+        _position = _size;
+        if (i >= _size)
+            return false;
+
+        if (_data[i] != '{') {
+            error = lineError(i, "Expecting '{'");
+            return false;
+        }
+
+        // Only strings and nesting are tracked, JParse validates the rest
+        size_t const begin = i;
+        int depth = 0;
+        char quote = 0;
+        for (; i < _size; ++i) {
+            char const c = _data[i];
+            if (quote) {
+                if (c == '\\')
+                    ++i;
+                else if (c == quote)
+                    quote = 0;
+            }
+            else if (c == '"' || c == '\'') {
+                quote = c;
+            }
+            else if (c == '{' || c == '[') {
+                ++depth;
+            }
+            else if ((c == '}' || c == ']') && --depth == 0) {
+                span = Span { begin, i + 1 };
+                _position = i + 1;
+                return true;
+            }
+        }
+
+        error = lineError(begin, "Unexpected end of file in document");
+        return false;
+    }
+
+    bool ImportReader::scanCsvRow(Span &span)
+    {
+        while (_position < _size && (_data[_position] == '\n' || _data[_position] == '\r'))
+            ++_position;
+
+        if (_position >= _size)
+            return false;
+
+        // Quoted values may contain line breaks
+        size_t const begin = _position;
+        size_t i = begin;
+        bool quoted = false;
+        for (; i < _size; ++i) {
+            if (_data[i] == '"')
+                quoted = !quoted;
+            else if (_data[i] == '\n' && !quoted)
+                break;
+        }
+
+        size_t end = i;
+        if (end > begin && _data[end - 1] == '\r')
+            --end;
+
+        span = Span { begin, end };
+        _position = std::min(i + 1, _size);
+        return true;
+    }
+
+    void ImportReader::parse(const std::vector<Span> &spans, Chunk &chunk) const
+    {
+        chunk.documents.reserve(spans.size());
+        try {
+            for (Span const &span : spans)
+                chunk.documents.push_back(_options.format == ImportFormat::Csv ? parseCsv(span) :
+                                                                                 parseJson(span));
+        }
+        catch (const std::exception &ex) {
+            chunk.error = ex.what();
+        }
+    }
+
+    mongo::BSONObj ImportReader::parseJson(const Span &span) const
+    {
+        mongo::Robomongo::JParse parser(mongo::StringData(_data + span.begin, span.end - span.begin));
+        mongo::BSONObjBuilder builder;
+        mongo::Status status = mongo::Status::OK();
+        try {
+            status = parser.parse(builder);
+        }
+        catch (const std::exception &ex) {
+            throw std::runtime_error(lineError(span.begin + parser.offset(), ex.what()));
+        }
+
+        if (!status.isOK())
+            throw std::runtime_error(lineError(span.begin + parser.offset(), status.reason()));
+
+        mongo::BSONObj const obj = builder.obj();
+        if (obj.hasField("_id"))
+            return obj;
+
+        mongo::BSONObjBuilder withId(obj.objsize() + 32);
+        withId.append("_id", mongo::OID::gen());
+        withId.appendElements(obj);
+        return withId.obj();
+    }
+
+    mongo::BSONObj ImportReader::parseCsv(const Span &span) const
+    {
+        std::vector<std::string> const values = splitCsvRow(span);
+        if (values.size() != _csvColumns) {
+            throw std::runtime_error(lineError(span.begin, "Expected " + std::to_string(_csvColumns) +
+                                               " values, found " + std::to_string(values.size())));
+        }
+
+        mongo::BSONObjBuilder builder;
+        if (!_csvHasId)
+            builder.append("_id", mongo::OID::gen());
+        appendCsvFields(builder, _csvFields, values);
+        return builder.obj();
+    }
+
+    void ImportReader::readCsvHeader()
+    {
+        Span span;
+        if (!scanCsvRow(span))
+            throw std::runtime_error("CSV file has no header line");
+
+        std::vector<std::string> const names = splitCsvRow(span);
+        _csvColumns = names.size();
+        for (size_t column = 0; column < names.size(); ++column) {
+            std::string const &name = names[column];
+            if (name == "_id")
+                _csvHasId = true;
+
+            // "address.city" is field of subdocument "address"
+            std::vector<CsvField> *level = &_csvFields;
+            size_t start = 0;
+            while (true) {
+                size_t const dot = name.find('.', start);
+                bool const last = dot == std::string::npos;
+                std::string const part = name.substr(start, last ? std::string::npos : dot - start);
+                if (part.empty())
+                    throw std::runtime_error("Invalid field name in CSV header: \"" + name + "\"");
+
+                auto field = std::find_if(level->begin(), level->end(),
+                                          [&part](const CsvField &f) { return f.name == part; });
+                if (field == level->end())
+                    field = level->insert(level->end(), CsvField { part, -1, {} });
+
+                if (field->column >= 0 || (last && !field->children.empty()))
+                    throw std::runtime_error("Duplicate field in CSV header: \"" + name + "\"");
+
+                if (last) {
+                    field->column = static_cast<int>(column);
+                    break;
+                }
+
+                level = &field->children;
+                start = dot + 1;
+            }
+        }
+    }
+
+    std::vector<std::string> ImportReader::splitCsvRow(const Span &span) const
+    {
+        std::vector<std::string> values;
+        std::string value;
+        bool quoted = false;
+        for (size_t i = span.begin; i < span.end; ++i) {
+            char const c = _data[i];
+            if (quoted) {
+                if (c != '"')
+                    value.push_back(c);
+                else if (i + 1 < span.end && _data[i + 1] == '"')
+                    value.push_back(_data[++i]);
+                else
+                    quoted = false;
+            }
+            else if (c == '"') {
+                quoted = true;
+            }
+            else if (c == ',') {
+                values.push_back(std::move(value));
+                value.clear();
+            }
+            else {
+                value.push_back(c);
+            }
+        }
+        values.push_back(std::move(value));
+        return values;
+    }
+
+    void ImportReader::appendCsvFields(mongo::BSONObjBuilder &builder, const std::vector<CsvField> &fields,
+                                       const std::vector<std::string> &values)
+    {
+        for (CsvField const &field : fields) {
+            if (field.column >= 0) {
+                appendCsvValue(builder, field.name, values[field.column]);
+                continue;
+            }
+
+            mongo::BSONObjBuilder sub(builder.subobjStart(field.name));
+            appendCsvFields(sub, field.children, values);
+            sub.done();
+        }
+    }
+
+    void ImportReader::appendCsvValue(mongo::BSONObjBuilder &builder, const std::string &name,
+                                      const std::string &value)
+    {
+        if (value.empty())
+            return;
+
+        // Numbers only of these characters, so that "nan", "0x1F" or " 1" stay strings
+        if (value.find_first_not_of("0123456789+-.eE") == std::string::npos) {
+            char *end = nullptr;
+            errno = 0;
+            long long const integer = std::strtoll(value.c_str(), &end, 10);
+            if (*end == '\0' && errno == 0) {
+                if (integer >= std::numeric_limits<int>::min() && integer <= std::numeric_limits<int>::max())
+                    builder.append(name, static_cast<int>(integer));
+                else
+                    builder.append(name, integer);
+                return;
+            }
+
+            double const number = std::strtod(value.c_str(), &end);
+            if (*end == '\0') {
+                builder.append(name, number);
+                return;
+            }
+        }
+
+        if (value == "true" || value == "false") {
+            builder.append(name, value == "true");
+            return;
+        }
+
+        builder.append(name, value);
+    }
+
+    std::string ImportReader::lineError(size_t offset, const std::string &message) const
+    {
+        long long const line = 1 + std::count(_data, _data + std::min(offset, _size), '\n');
+        return "Line " + std::to_string(line) + ": " + message;
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <QString>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+QT_BEGIN_NAMESPACE
+class QFile;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    enum class ImportFormat
+    {
+        Json,           // JSON Lines, concatenated Extended JSON documents or array of them
+        Csv             // header line with field names (dotted for subdocuments), then values
+    };
+
+    struct ImportOptions
+    {
+        ImportFormat format = ImportFormat::Json;
+        int batchSize = 1000;       // documents per insert command
+        int concurrency = 1;        // insert commands in flight, each on its own connection
+        bool ordered = true;        // stop at the first failed document (then concurrency is 1)
+        int parserThreads = 0;      // 0 to use one per core, up to MaxParserThreads
+    };
+
+    /**
+     * @brief Reads documents of file for import. File is memory-mapped and split into chunks
+     *        of ImportOptions::batchSize documents, which are parsed by several threads ahead
+     *        of consumer (but not more than a few chunks ahead). Documents without _id get
+     *        ObjectId here, so that retried inserts do not duplicate them.
+     *
+     *        CSV values are typed: integers, doubles and true/false become numbers and
+     *        booleans, empty values are skipped, anything else is string.
+     */
+    class ImportReader
+    {
+    public:
+        /**
+         * @throws std::runtime_error, if file cannot be read
+         */
+        ImportReader(const QString &filePath, const ImportOptions &options);
+        ~ImportReader();
+
+        /**
+         * @brief Takes the next batch of documents, in file order
+         * @return false, if there are no more documents
+         * @throws std::runtime_error, with line of document that could not be parsed
+         */
+        bool next(std::vector<mongo::BSONObj> &batch);
+
+        long long fileSize() const { return static_cast<long long>(_size); }
+
+        /**
+         * @brief Bytes of the file taken by next() so far
+         */
+        long long bytesRead() const { return _bytesRead; }
+
+    private:
+        struct Span
+        {
+            size_t begin;
+            size_t end;
+        };
+
+        struct CsvField
+        {
+            std::string name;
+            int column;                         // -1 for subdocument
+            std::vector<CsvField> children;
+        };
+
+        struct Chunk
+        {
+            std::vector<mongo::BSONObj> documents;
+            std::string error;
+            size_t end;
+        };
+
+        void run();
+
+        /**
+         * @brief Finds spans of the next ImportOptions::batchSize documents (or rows)
+         *        from _position, it is quick compared to parsing. Called under _mutex.
+         */
+        std::vector<Span> scan(std::string &error);
+        bool scanJsonDocument(Span &span, std::string &error);
+        bool scanCsvRow(Span &span);
+
+        void parse(const std::vector<Span> &spans, Chunk &chunk) const;
+        mongo::BSONObj parseJson(const Span &span) const;
+        mongo::BSONObj parseCsv(const Span &span) const;
+        void readCsvHeader();
+
+        std::vector<std::string> splitCsvRow(const Span &span) const;
+        static void appendCsvFields(mongo::BSONObjBuilder &builder, const std::vector<CsvField> &fields,
+                                    const std::vector<std::string> &values);
+        static void appendCsvValue(mongo::BSONObjBuilder &builder, const std::string &name,
+                                   const std::string &value);
+
+        std::string lineError(size_t offset, const std::string &message) const;
+
+        static constexpr int MaxParserThreads = 8;
+        static const size_t MaxChunksAhead = 2;     // per parser thread
+
+        ImportOptions const _options;
+        std::unique_ptr<QFile> _file;
+        const char *_data;
+        size_t _size;
+
+        std::vector<CsvField> _csvFields;
+        size_t _csvColumns;
+        bool _csvHasId;
+
+        std::mutex _mutex;
+        std::condition_variable _changed;
+        size_t _position;           // where scan() continues
+        bool _inArray;
+        bool _scanned;              // all chunks are known, there are _chunkCount of them
+        size_t _chunkCount;         // chunks found so far
+        size_t _taken;              // chunks taken by next()
+        std::map<size_t, Chunk> _parsed;
+        bool _stopping;
+        long long _bytesRead;
+        std::string _pendingError;  // of chunk which next() returned partially
+
+        size_t _threadCount;
+        std::vector<std::thread> _threads;
+    };
+}
@@ -0,0 +1,146 @@
+#include "robomongo/core/utils/JsonDocuments.h"
+
+#include <cctype>
+
+#include "robomongo/shell/bson/json.h"
+
+namespace
+{
+    size_t skipSpaces(const std::string &text, size_t pos)
+    {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+            ++pos;
+        return pos;
+    }
+
+    /**
+     * @brief End of top-level object or array starting at 'begin', found by brackets outside
+     *        of quoted strings. End of text, if it is not terminated or does not start with bracket.
+     */
+    size_t documentEnd(const std::string &text, size_t begin)
+    {
+        if (text[begin] != '{' && text[begin] != '[')
+            return text.size();
+
+        int depth = 0;
+        char quote = 0;
+        for (size_t i = begin; i < text.size(); ++i) {
+            char const c = text[i];
+            if (quote) {
+                if (c == '\\')
+                    ++i;
+                else if (c == quote)
+                    quote = 0;
+                continue;
+            }
+
+            switch (c) {
+            case '"': case '\'':
+                quote = c;
+                break;
+            case '{': case '[':
+                ++depth;
+                break;
+            case '}': case ']':
+                if (--depth == 0)
+                    return i + 1;
+                break;
+            }
+        }
+        return text.size();
+    }
+
+    struct Region
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    std::vector<Region> splitDocuments(const std::string &text, size_t pos)
+    {
+        std::vector<Region> regions;
+        for (pos = skipSpaces(text, pos); pos < text.size(); pos = skipSpaces(text, pos)) {
+            size_t const end = documentEnd(text, pos);
+            regions.push_back({ pos, end });
+            pos = end;
+        }
+        return regions;
+    }
+}
+
+namespace Robomongo
+{
+    std::shared_ptr<const JsonDocuments> JsonDocuments::parse(const std::string &text,
+                                                              const std::shared_ptr<const JsonDocuments> &previous,
+                                                              const std::atomic<bool> *stop)
+    {
+        auto result = std::make_shared<JsonDocuments>();
+        size_t const previousCount = previous ? previous->_documents.size() : 0;
+
+        std::vector<Region> regions = splitDocuments(text, 0);
+        for (size_t i = 0; i < regions.size(); ++i) {
+            if (stop && *stop)
+                return nullptr;
+
+            Region const region = regions[i];
+            size_t const size = region.end - region.begin;
+
+            // Unchanged document is either at the same index (documents before it were not
+            // changed) or at the same index from the end (documents after it)
+            std::shared_ptr<const Document> reused;
+            size_t const fromEnd = regions.size() - i;
+            for (size_t candidate : { i, previousCount - fromEnd }) {
+                if (candidate >= previousCount)
+                    continue;
+
+                auto const &doc = previous->_documents[candidate];
+                if (doc->text.size() == size && text.compare(region.begin, size, doc->text) == 0) {
+                    reused = doc;
+                    break;
+                }
+            }
+
+            if (reused) {
+                result->_documents.push_back(reused);
+                continue;
+            }
+
+            ++result->_parsedCount;
+            int length = 0;
+            auto doc = std::make_shared<Document>();
+            try {
+                doc->obj = mongo::Robomongo::fromjson(text.c_str() + region.begin, &length);
+            }
+            catch (const mongo::Robomongo::ParseMsgAssertionException &ex) {
+                if (result->isValid()) {
+                    result->_errorOffset = static_cast<int>(region.begin) + ex.offset();
+                    result->_errorReason = ex.reason();
+                }
+                // Documents after invalid one are parsed too, so that they can be reused
+                continue;
+            }
+
+            // Brackets may be not where parser ended (e.g. inside of regular expression), then
+            // the rest of text is split again after this document, which is not reused
+            size_t const parsedEnd = length > 0 ? region.begin + length : region.end;
+            if (skipSpaces(text, parsedEnd) == skipSpaces(text, region.end))
+                doc->text = text.substr(region.begin, size);
+            else {
+                std::vector<Region> const rest = splitDocuments(text, parsedEnd);
+                regions.resize(i + 1);
+                regions.insert(regions.end(), rest.begin(), rest.end());
+            }
+            result->_documents.push_back(doc);
+        }
+        return result;
+    }
+
+    std::vector<mongo::BSONObj> JsonDocuments::documents() const
+    {
+        std::vector<mongo::BSONObj> documents;
+        documents.reserve(_documents.size());
+        for (auto const &doc : _documents)
+            documents.push_back(doc->obj);
+        return documents;
+    }
+}
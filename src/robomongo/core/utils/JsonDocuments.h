@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Documents parsed from text of concatenated JSON documents (as DocumentTextEditor
+     *        shows them). Text is split into top-level documents by brackets and parse() takes
+     *        documents whose text did not change from previous result, so editing one document
+     *        of text parses only this document again. Results are immutable and may be shared
+     *        between threads.
+     */
+    class JsonDocuments
+    {
+    public:
+        /**
+         * @param text UTF-8, so that error offset is Scintilla position
+         * @param previous Result for previous version of text, may be null
+         * @param stop If set, parse returns null early
+         */
+        static std::shared_ptr<const JsonDocuments> parse(const std::string &text,
+                                                          const std::shared_ptr<const JsonDocuments> &previous,
+                                                          const std::atomic<bool> *stop = nullptr);
+
+        bool isValid() const { return _errorOffset < 0; }
+
+        /**
+         * @brief Byte offset (in whole text) where parsing of the first invalid document
+         *        failed, -1 if text is valid
+         */
+        int errorOffset() const { return _errorOffset; }
+        const std::string &errorReason() const { return _errorReason; }
+
+        /**
+         * @brief Parsed documents, complete only if text is valid
+         */
+        std::vector<mongo::BSONObj> documents() const;
+
+        /**
+         * @brief Number of documents parsed by parse(), the rest was taken from previous result
+         */
+        int parsedCount() const { return _parsedCount; }
+
+    private:
+        struct Document
+        {
+            std::string text;       // empty, if document cannot be reused
+            mongo::BSONObj obj;
+        };
+
+        std::vector<std::shared_ptr<const Document>> _documents;
+        int _errorOffset = -1;
+        std::string _errorReason;
+        int _parsedCount = 0;
+    };
+}
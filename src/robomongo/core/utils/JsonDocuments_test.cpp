@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+#include "JsonDocuments.h"
+
+using namespace Robomongo;
+
+TEST(json_documents_tests, concatenated_documents)
+{
+    auto const parsed = JsonDocuments::parse("\n{ \"a\" : 1 }\n{ \"b\" : \"}\" }\n", nullptr);
+    ASSERT_TRUE(parsed->isValid());
+    ASSERT_EQ(2u, parsed->documents().size());
+    EXPECT_EQ(1, parsed->documents()[0].getIntField("a"));
+    EXPECT_EQ("}", parsed->documents()[1].getStringField("b"));
+    EXPECT_TRUE(JsonDocuments::parse("  ", nullptr)->documents().empty());
+}
+
+TEST(json_documents_tests, only_changed_documents_are_parsed)
+{
+    auto const first = JsonDocuments::parse("{ a: 1 } { b: 2 } { c: 3 }", nullptr);
+    EXPECT_EQ(3, first->parsedCount());
+
+    auto const changed = JsonDocuments::parse("{ a: 1 } { b: 5 } { c: 3 }", first);
+    ASSERT_TRUE(changed->isValid());
+    EXPECT_EQ(1, changed->parsedCount());
+    EXPECT_EQ(5, changed->documents()[1].getIntField("b"));
+
+    // Documents after inserted one are found from the end
+    auto const inserted = JsonDocuments::parse("{ x: 0 } { a: 1 } { b: 5 } { c: 3 }", changed);
+    EXPECT_EQ(1, inserted->parsedCount());
+    EXPECT_EQ(4u, inserted->documents().size());
+}
+
+TEST(json_documents_tests, error_offset_in_whole_text)
+{
+    std::string const text = "{ a: 1 }\n{ b: }";
+    auto const parsed = JsonDocuments::parse(text, nullptr);
+    ASSERT_FALSE(parsed->isValid());
+    EXPECT_GE(parsed->errorOffset(), static_cast<int>(text.find('b')));
+    EXPECT_FALSE(parsed->errorReason().empty());
+}
@@ -0,0 +1,72 @@
+#include "robomongo/core/utils/LatencyHistogram.h"
+
+#include <algorithm>
+
+namespace Robomongo
+{
+    constexpr int LatencyHistogram::SubBuckets;
+    constexpr int LatencyHistogram::MaxExponent;
+    static_assert(LatencyHistogram::SubBuckets == 16, "bucketIndex() shifts by 4 bits");
+
+    void LatencyHistogram::record(long long us)
+    {
+        us = std::max(us, 0LL);
+        ++_buckets[bucketIndex(us)];
+        ++_count;
+        _totalUs += us;
+        _maxUs = std::max(_maxUs, us);
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram &other)
+    {
+        for (int i = 0; i < BucketCount; ++i)
+            _buckets[i] += other._buckets[i];
+        _count += other._count;
+        _totalUs += other._totalUs;
+        _maxUs = std::max(_maxUs, other._maxUs);
+    }
+
+    long long LatencyHistogram::percentileUs(double p) const
+    {
+        if (_count == 0)
+            return 0;
+
+        auto const rank = std::max(static_cast<unsigned long long>(_count * p / 100.0 + 0.5), 1ULL);
+        unsigned long long seen = 0;
+        for (int i = 0; i < BucketCount; ++i) {
+            seen += _buckets[i];
+            if (seen >= rank)
+                return std::min(bucketUpperUs(i), _maxUs);
+        }
+
+        return _maxUs;
+    }
+
+    int LatencyHistogram::bucketIndex(long long us)
+    {
+        if (us < SubBuckets)
+            return static_cast<int>(us);
+
+        // Position of the highest set bit, portable and cheap next to a round trip
+        int exponent = 4;
+        while (exponent <= MaxExponent && (us >> (exponent + 1)) != 0)
+            ++exponent;
+        if (exponent > MaxExponent)
+            return BucketCount - 1;
+
+        // Exponent >= 4, top 5 bits are 1xxxx, the lower 4 of them select the sub bucket
+        int const sub = static_cast<int>(us >> (exponent - 4)) - SubBuckets;
+        return SubBuckets + (exponent - 4) * SubBuckets + sub;
+    }
+
+    long long LatencyHistogram::bucketUpperUs(int index)
+    {
+        if (index < SubBuckets)
+            return index;
+
+        int const exponent = (index - SubBuckets) / SubBuckets + 4;
+        int const sub = (index - SubBuckets) % SubBuckets;
+        long long const width = 1LL << (exponent - 4);
+        return (SubBuckets + sub) * width + width - 1;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+
+namespace Robomongo
+{
+    /**
+     * @brief Latencies in microseconds, recorded HDR histogram style: values below SubBuckets
+     *        are exact, larger ones are counted in SubBuckets linear buckets per power of two,
+     *        so every percentile is within about 6% of the real value from 1 us to hours.
+     *        Not thread safe.
+     */
+    class LatencyHistogram
+    {
+    public:
+        static constexpr int SubBuckets = 16;
+        static constexpr int MaxExponent = 40;      // 2^40 us, about 12 days; longer ones are clamped
+
+        void record(long long us);
+        void merge(const LatencyHistogram &other);
+
+        unsigned long long count() const { return _count; }
+        long long totalUs() const { return _totalUs; }
+        long long maxUs() const { return _maxUs; }
+
+        /**
+         * @brief Highest value, which is equivalent (counted in the same bucket) to the p-th
+         *        percentile (0 < p <= 100), or 0 if there are no samples
+         */
+        long long percentileUs(double p) const;
+
+    private:
+        static constexpr int BucketCount = SubBuckets + (MaxExponent - 4 + 1) * SubBuckets;
+
+        static int bucketIndex(long long us);
+        static long long bucketUpperUs(int index);
+
+        std::array<unsigned long long, BucketCount> _buckets {};
+        unsigned long long _count = 0;
+        long long _totalUs = 0;
+        long long _maxUs = 0;
+    };
+}
@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+#include "LatencyHistogram.h"
+
+using namespace Robomongo;
+
+TEST(latency_histogram_tests, small_values_are_exact)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(0, histogram.percentileUs(50));
+
+    for (long long us = 1; us <= 10; ++us)
+        histogram.record(us);
+
+    EXPECT_EQ(10u, histogram.count());
+    EXPECT_EQ(55, histogram.totalUs());
+    EXPECT_EQ(5, histogram.percentileUs(50));
+    EXPECT_EQ(10, histogram.percentileUs(100));
+}
+
+TEST(latency_histogram_tests, large_values_within_precision)
+{
+    LatencyHistogram histogram;
+    for (int i = 0; i < 99; ++i)
+        histogram.record(1500);
+    histogram.record(2500000);
+
+    // 1500 is counted in [1472, 1535], percentile is the top of it
+    long long const p50 = histogram.percentileUs(50);
+    EXPECT_GE(p50, 1500);
+    EXPECT_LE(p50, 1500 * 107 / 100);
+    EXPECT_EQ(2500000, histogram.percentileUs(100));
+    EXPECT_EQ(2500000, histogram.maxUs());
+
+    LatencyHistogram other;
+    other.record(7);
+    other.merge(histogram);
+    EXPECT_EQ(101u, other.count());
+    EXPECT_EQ(7, other.percentileUs(0.5));
+}
@@ -0,0 +1,76 @@
+#include "robomongo/core/utils/LogQueue.h"
+
+#include <cstdint>
+
+namespace
+{
+    size_t roundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 2;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+}
+
+namespace Robomongo
+{
+    // Bounded MPMC queue of D. Vyukov: every cell has sequence number, which tells
+    // whether the cell is free for producer at 'pos' or ready for consumer at 'pos'.
+    LogQueue::LogQueue(size_t capacity) :
+        _mask(roundUpToPowerOfTwo(capacity) - 1),
+        _cells(new Cell[_mask + 1]),
+        _enqueuePos(0),
+        _dequeuePos(0),
+        _dropped(0)
+    {
+        for (size_t i = 0; i <= _mask; ++i)
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    LogQueue &LogQueue::instance()
+    {
+        static LogQueue queue;
+        return queue;
+    }
+
+    bool LogQueue::push(Entry entry)
+    {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell = nullptr;
+        for (;;) {
+            cell = &_cells[pos & _mask];
+            size_t const sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t const diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0) {    // consumer did not free this cell yet, queue is full
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->entry = std::move(entry);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool LogQueue::pop(Entry &entry)
+    {
+        size_t const pos = _dequeuePos.load(std::memory_order_relaxed);
+        Cell &cell = _cells[pos & _mask];
+        size_t const sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) < 0)
+            return false;
+
+        entry = std::move(cell.entry);
+        _dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace Robomongo
+{
+    /**
+     * @brief Bounded lock-free queue of log messages: many producers (worker and SSH
+     *        threads, see sendLog()), one consumer (App, in main thread).
+     *        When queue is full, message is dropped and counted, producer never waits.
+     * @threadsafe
+     */
+    class LogQueue
+    {
+    public:
+        struct Entry
+        {
+            std::string message;
+            int level = 0;          // LogEvent::LogLevel
+            bool informUser = false;
+        };
+
+        static const size_t DefaultCapacity = 8192;
+
+        /**
+         * @param capacity Rounded up to power of two
+         */
+        explicit LogQueue(size_t capacity = DefaultCapacity);
+
+        /**
+         * @brief Queue of application log, drained by App
+         */
+        static LogQueue &instance();
+
+        /**
+         * @return false, if queue was full and entry was dropped
+         */
+        bool push(Entry entry);
+
+        /**
+         * @brief Must be called by one thread only.
+         * @return false, if queue is empty
+         */
+        bool pop(Entry &entry);
+
+        /**
+         * @brief Number of entries dropped since previous call
+         */
+        long long takeDropped() { return _dropped.exchange(0); }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            Entry entry;
+        };
+
+        const size_t _mask;
+        std::unique_ptr<Cell[]> _cells;
+
+        // On separate cache lines, producers and consumer do not slow down each other
+        alignas(64) std::atomic<size_t> _enqueuePos;
+        alignas(64) std::atomic<size_t> _dequeuePos;
+        alignas(64) std::atomic<long long> _dropped;
+    };
+}
@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+#include "LogQueue.h"
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Robomongo::LogQueue;
+
+TEST(log_queue_tests, push_pop_in_order)
+{
+    LogQueue queue(4);
+    EXPECT_TRUE(queue.push({ "first", 1, false }));
+    EXPECT_TRUE(queue.push({ "second", 3, true }));
+
+    LogQueue::Entry entry;
+    ASSERT_TRUE(queue.pop(entry));
+    EXPECT_EQ("first", entry.message);
+    EXPECT_EQ(1, entry.level);
+    ASSERT_TRUE(queue.pop(entry));
+    EXPECT_EQ("second", entry.message);
+    EXPECT_TRUE(entry.informUser);
+    EXPECT_FALSE(queue.pop(entry));
+}
+
+TEST(log_queue_tests, full_queue_drops_and_counts)
+{
+    LogQueue queue(4);
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(queue.push({ std::to_string(i), 0, false }));
+
+    EXPECT_FALSE(queue.push({ "dropped", 0, false }));
+    EXPECT_FALSE(queue.push({ "dropped", 0, false }));
+    EXPECT_EQ(2, queue.takeDropped());
+    EXPECT_EQ(0, queue.takeDropped());
+
+    // Cells are reused after pop
+    LogQueue::Entry entry;
+    ASSERT_TRUE(queue.pop(entry));
+    EXPECT_EQ("0", entry.message);
+    EXPECT_TRUE(queue.push({ "4", 0, false }));
+}
+
+TEST(log_queue_tests, concurrent_producers_lose_nothing_or_count_it)
+{
+    LogQueue queue(1024);
+    int const producers = 4;
+    int const perProducer = 10000;
+
+    std::atomic<int> finished(0);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, &finished, p]() {
+            for (int i = 0; i < perProducer; ++i)
+                queue.push({ std::to_string(p * perProducer + i), p, false });
+            ++finished;
+        });
+    }
+
+    // Consumer drains while producers are still writing
+    std::set<std::string> received;
+    long long dropped = 0;
+    LogQueue::Entry entry;
+    auto drain = [&]() {
+        while (queue.pop(entry))
+            EXPECT_TRUE(received.insert(entry.message).second);
+        dropped += queue.takeDropped();
+    };
+
+    while (finished < producers) {
+        drain();
+        std::this_thread::yield();
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+    drain();
+
+    EXPECT_EQ(producers * perProducer, static_cast<long long>(received.size()) + dropped);
+}
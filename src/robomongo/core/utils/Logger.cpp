@@ -1,5 +1,6 @@
 #include "robomongo/core/utils/Logger.h"
 
+#include <QDateTime>
 #include <QDir>
 #include <QMetaType>
 
@@ -8,18 +9,14 @@
 #include "robomongo/core/EventBus.h"
 #include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/core/utils/LogQueue.h"
+#include "robomongo/core/utils/RotatingLogFile.h"
 
 namespace Robomongo
 {
-    Logger::Logger()
-    {
-        QFile file {
-            QString("%1/" PROJECT_NAME_LOWERCASE ".log").arg(QDir::tempPath()) 
-        }; 
-        //delete file if it size more than 5mb
-        if (file.exists() && file.size() > 5 * 1024 * 1024)
-            file.remove();      
-    }
+    Logger::Logger() :
+        _file(new RotatingLogFile(QString("%1/" PROJECT_NAME_LOWERCASE ".log").arg(QDir::tempPath()), 
+                                  LogFileMaxBytes, LogFileBackups)) {}
 
     Logger::~Logger()
     {   
@@ -37,9 +34,6 @@ namespace Robomongo
 
     void Logger::print(const QString &msg, mongo::logger::LogSeverity level, bool notify)
     {
-        if (!notify)
-            return;
-
         // Make uniform log level strings e.g "Error: ", "Info: " etc...
         auto logLevelStr = QString::fromStdString(level.toStringData().toString());
         if (!logLevelStr.isEmpty()) {
@@ -47,17 +41,23 @@ namespace Robomongo
             logLevelStr[0] = logLevelStr[0].toUpper();
             logLevelStr += ": ";
         }
-        emit printed(logLevelStr + msg.simplified(), level);
+        QString const line = logLevelStr + msg.simplified();
+
+        // File keeps all messages for post-mortems, even the ones not shown to user
+        _file->writeLine(QDateTime::currentDateTime().toString(Qt::ISODateWithMs) + " " + line);
+
+        if (!notify)
+            return;
+
+        emit printed(line, level);
     }
 
     void sendLog(
         QObject *sender, LogEvent::LogLevel const& severity,
         std::string const& msg, bool const informUser /*= false*/)
     {
-        AppRegistry::instance().bus()->send(
-            AppRegistry::instance().app(),
-            new LogEvent(sender, msg, severity, informUser)
-        );
+        // No Qt events or signals here: it is called from worker threads for every message
+        LogQueue::instance().push({ msg, severity, informUser });
     }
 
     void debugLog(std::string_view msg) {
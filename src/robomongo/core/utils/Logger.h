@@ -2,6 +2,7 @@
 
 #include <QObject>
 #include <QString>
+#include <memory>
 #include <string>
 
 #include <mongo/logger/log_severity.h>
@@ -11,6 +12,8 @@
 
 namespace Robomongo
 {  
+    class RotatingLogFile;
+
     class Logger : public QObject, public Patterns::LazySingleton<Logger>
     {
         Q_OBJECT
@@ -27,6 +30,11 @@ namespace Robomongo
     private:
         Logger();
         ~Logger();
+
+        // Log in temp directory, PROJECT_NAME_LOWERCASE.log plus backups .1, .2 ...
+        static const qint64 LogFileMaxBytes = 5 * 1024 * 1024;
+        static const int LogFileBackups = 3;
+        std::unique_ptr<RotatingLogFile> _file;
     };
 
     // Use in main thread
@@ -37,7 +45,7 @@ namespace Robomongo
     }
     
     // Use in worker threads (e.g. MongoWorker) to log anything 
-    // Sends LogEvent to main thread (App class) 
+    // Pushes message to LogQueue (lock-free), App drains it in main thread
     void sendLog(
         QObject *sender, LogEvent::LogLevel const& severity,
         std::string const& msg, bool const informUser = false
@@ -0,0 +1,68 @@
+#include "robomongo/core/utils/MemberLatency.h"
+
+namespace Robomongo
+{
+    constexpr double MemberLatency::SmoothingFactor;
+    constexpr std::chrono::seconds MemberLatency::MaxAge;
+
+    MemberLatency &MemberLatency::instance()
+    {
+        static MemberLatency latency;
+        return latency;
+    }
+
+    void MemberLatency::addSample(const std::string &setName, const std::string &host, double rttMs,
+                                  Clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto &members = _sets[setName];
+        auto const it = members.find(host);
+        if (it == members.end()) {
+            members[host] = Sample{ rttMs, now };
+            return;
+        }
+
+        it->second.smoothedMs = SmoothingFactor * rttMs + (1 - SmoothingFactor) * it->second.smoothedMs;
+        it->second.measuredAt = now;
+    }
+
+    void MemberLatency::addFailure(const std::string &setName, const std::string &host)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto const set = _sets.find(setName);
+        if (set != _sets.end())
+            set->second.erase(host);
+    }
+
+    double MemberLatency::smoothedMs(const std::string &setName, const std::string &host) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto const set = _sets.find(setName);
+        if (set == _sets.end())
+            return -1;
+
+        auto const member = set->second.find(host);
+        return member == set->second.end() ? -1 : member->second.smoothedMs;
+    }
+
+    std::string MemberLatency::nearest(const std::string &setName, Clock::time_point now) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto const set = _sets.find(setName);
+        if (set == _sets.end())
+            return std::string();
+
+        std::string best;
+        double bestMs = 0;
+        for (auto const &member : set->second) {
+            if (now - member.second.measuredAt > MaxAge)
+                continue;
+
+            if (best.empty() || member.second.smoothedMs < bestMs) {
+                best = member.first;
+                bestMs = member.second.smoothedMs;
+            }
+        }
+        return best;
+    }
+}
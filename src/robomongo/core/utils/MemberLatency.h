@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace Robomongo
+{
+    /**
+     * @brief Smoothed round trip times of replica set members of all connections, by set
+     *        name and "host:port". Measured by topology monitor, used to route queries with
+     *        "nearest" read preference (see MongoWorker::queryClient()). Thread-safe.
+     */
+    class MemberLatency
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        // Weight of a new sample in moving average, as in server selection of drivers
+        static constexpr double SmoothingFactor = 0.2;
+
+        // Samples older than this (4 topology monitor polls) are not used for routing
+        static constexpr std::chrono::seconds MaxAge { 60 };
+
+        static MemberLatency &instance();
+
+        void addSample(const std::string &setName, const std::string &host, double rttMs,
+                       Clock::time_point now = Clock::now());
+
+        // Member is not routed to until its next sample
+        void addFailure(const std::string &setName, const std::string &host);
+
+        // -1, if member is not measured
+        double smoothedMs(const std::string &setName, const std::string &host) const;
+
+        /**
+         * @return Member of set with the lowest smoothed round trip time among members
+         *         measured during MaxAge, empty if there are none
+         */
+        std::string nearest(const std::string &setName, Clock::time_point now = Clock::now()) const;
+
+    private:
+        struct Sample
+        {
+            double smoothedMs;
+            Clock::time_point measuredAt;
+        };
+
+        mutable std::mutex _mutex;
+        std::map<std::string, std::map<std::string, Sample>> _sets;   // set name -> host -> sample
+    };
+}
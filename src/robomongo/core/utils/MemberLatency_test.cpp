@@ -0,0 +1,33 @@
+#include "gtest/gtest.h"
+#include "MemberLatency.h"
+
+using namespace Robomongo;
+
+TEST(member_latency_tests, smooths_samples)
+{
+    MemberLatency latency;
+    EXPECT_EQ(-1, latency.smoothedMs("rs0", "a:27017"));
+
+    latency.addSample("rs0", "a:27017", 100);
+    EXPECT_DOUBLE_EQ(100, latency.smoothedMs("rs0", "a:27017"));
+
+    // One slow ping moves average only by SmoothingFactor of the difference
+    latency.addSample("rs0", "a:27017", 200);
+    EXPECT_DOUBLE_EQ(120, latency.smoothedMs("rs0", "a:27017"));
+}
+
+TEST(member_latency_tests, nearest_skips_failed_and_stale_members)
+{
+    MemberLatency latency;
+    auto const now = MemberLatency::Clock::now();
+    latency.addSample("rs0", "far:27017", 150, now);
+    latency.addSample("rs0", "near:27017", 20, now);
+    latency.addSample("rs1", "other:27017", 1, now);
+    EXPECT_EQ("near:27017", latency.nearest("rs0", now));
+
+    latency.addFailure("rs0", "near:27017");
+    EXPECT_EQ("far:27017", latency.nearest("rs0", now));
+
+    EXPECT_EQ("", latency.nearest("rs0", now + MemberLatency::MaxAge + std::chrono::seconds(1)));
+    EXPECT_EQ("", latency.nearest("rs2", now));
+}
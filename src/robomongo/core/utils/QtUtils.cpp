@@ -3,6 +3,11 @@
 #include <QThread>
 #include <QTreeWidgetItem>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ROBOMONGO_QTUTILS_SSE2 1
+#endif
+
 namespace Robomongo
 {
     namespace QtUtils
@@ -11,7 +16,41 @@ namespace Robomongo
         QString toQString<std::string>(const std::string &value)
         {
             //static QTextCodec *LOCALECODEC = QTextCodec::codecForLocale();
-            return QString::fromUtf8(value.c_str(), value.size());
+            return fromUtf8(value.c_str(), value.size());
+        }
+
+        bool isAscii(const char *data, size_t size)
+        {
+            size_t i = 0;
+#if defined(ROBOMONGO_QTUTILS_SSE2)
+            // High bit of any of 16 bytes is set for non-ASCII text
+            for (; i + 16 <= size; i += 16) {
+                if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))))
+                    return false;
+            }
+#endif
+            for (; i < size; ++i) {
+                if (static_cast<unsigned char>(data[i]) & 0x80)
+                    return false;
+            }
+            return true;
+        }
+
+        QString fromUtf8(const char *data, size_t size)
+        {
+            int const length = static_cast<int>(size);
+            if (isAscii(data, size))
+                return QString::fromLatin1(data, length);
+            return QString::fromUtf8(data, length);
+        }
+
+        QStringList toQStringList(const std::vector<std::string> &values)
+        {
+            QStringList list;
+            list.reserve(static_cast<int>(values.size()));
+            for (std::string const &value : values)
+                list.append(fromUtf8(value.data(), value.size()));
+            return list;
         }
 
         template<>
@@ -1,6 +1,9 @@
 #pragma once
 #include <QString>
+#include <QStringList>
 #include <QModelIndex>
+#include <string>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 class QThread;
@@ -21,6 +24,19 @@ namespace Robomongo
         template<typename T>
         QString toQString(const T &value);
 
+        /**
+         * @brief QString from UTF-8 bytes. Pure ASCII text (most field names and many values)
+         *        is detected 16 bytes at once and widened as Latin-1, without UTF-8 decoding.
+         */
+        QString fromUtf8(const char *data, size_t size);
+
+        bool isAscii(const char *data, size_t size);
+
+        /**
+         * @brief Converts all 'values' at once, e.g. names of completion list
+         */
+        QStringList toQStringList(const std::vector<std::string> &values);
+
         std::string toStdString(const QString &value);
 
         std::string toStdStringSafe(const QString &value);
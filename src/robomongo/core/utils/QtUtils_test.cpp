@@ -0,0 +1,29 @@
+#include "gtest/gtest.h"
+#include "QtUtils.h"
+
+using namespace Robomongo;
+
+TEST(qt_utils_tests, ascii_detection)
+{
+    std::string const ascii = "customer.addresses.postalCode";
+    EXPECT_TRUE(QtUtils::isAscii(ascii.data(), ascii.size()));
+    EXPECT_TRUE(QtUtils::isAscii("", 0));
+
+    // Non-ASCII byte in the SIMD part and in the tail
+    std::string const first = "\xc3\xa9" + ascii;
+    std::string const last = ascii + "\xc3\xa9";
+    EXPECT_FALSE(QtUtils::isAscii(first.data(), first.size()));
+    EXPECT_FALSE(QtUtils::isAscii(last.data(), last.size()));
+}
+
+TEST(qt_utils_tests, from_utf8)
+{
+    EXPECT_EQ(QString("customer.addresses.postalCode"), QtUtils::toQString(std::string("customer.addresses.postalCode")));
+    EXPECT_EQ(QString::fromUtf8("r\xc3\xa9sum\xc3\xa9 of candidate \xe2\x82\xac"),
+              QtUtils::toQString(std::string("r\xc3\xa9sum\xc3\xa9 of candidate \xe2\x82\xac")));
+
+    QStringList const list = QtUtils::toQStringList({ "name", "\xc3\xa9t\xc3\xa9", "" });
+    ASSERT_EQ(3, list.size());
+    EXPECT_EQ(QString::fromUtf8("\xc3\xa9t\xc3\xa9"), list[1]);
+    EXPECT_TRUE(list[2].isEmpty());
+}
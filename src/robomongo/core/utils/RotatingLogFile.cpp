@@ -0,0 +1,47 @@
+#include "robomongo/core/utils/RotatingLogFile.h"
+
+namespace Robomongo
+{
+    RotatingLogFile::RotatingLogFile(const QString &path, qint64 maxBytes, int maxBackups) :
+        _path(path), _maxBytes(maxBytes), _maxBackups(maxBackups), _file(path), _failed(false) {}
+
+    void RotatingLogFile::writeLine(const QString &line)
+    {
+        if (!_file.isOpen() && !open())
+            return;
+
+        QByteArray const bytes = line.toUtf8().append('\n');
+        if (_file.size() + bytes.size() > _maxBytes) {
+            rotate();
+            if (!open())
+                return;
+        }
+
+        _file.write(bytes);
+        _file.flush();
+    }
+
+    bool RotatingLogFile::open()
+    {
+        if (_failed)
+            return false;
+
+        _failed = !_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+        return !_failed;
+    }
+
+    void RotatingLogFile::rotate()
+    {
+        _file.close();
+
+        // robo3t.log.2 -> robo3t.log.3, robo3t.log.1 -> robo3t.log.2 ...
+        QFile::remove(QString("%1.%2").arg(_path).arg(_maxBackups));
+        for (int i = _maxBackups - 1; i >= 1; --i)
+            QFile::rename(QString("%1.%2").arg(_path).arg(i), QString("%1.%2").arg(_path).arg(i + 1));
+
+        if (_maxBackups > 0)
+            QFile::rename(_path, _path + ".1");
+        else
+            QFile::remove(_path);
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+
+namespace Robomongo
+{
+    /**
+     * @brief Append-only log file, that is renamed to "<path>.1" when it grows above
+     *        'maxBytes' ("<path>.1" to "<path>.2" and so on, up to 'maxBackups' files).
+     *        Every line is flushed, so that the log survives crash of application.
+     */
+    class RotatingLogFile
+    {
+    public:
+        RotatingLogFile(const QString &path, qint64 maxBytes, int maxBackups);
+
+        void writeLine(const QString &line);
+
+        const QString &path() const { return _path; }
+
+    private:
+        bool open();
+        void rotate();
+
+        const QString _path;
+        const qint64 _maxBytes;
+        const int _maxBackups;
+        QFile _file;
+        bool _failed;   // do not retry to open file for every line
+    };
+}
@@ -0,0 +1,61 @@
+#include "robomongo/core/utils/RttHistogram.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace Robomongo
+{
+    constexpr std::array<double, 12> RttHistogram::UpperBoundsMs;
+
+    void RttHistogram::addSample(double rttMs)
+    {
+        auto const bound = std::lower_bound(UpperBoundsMs.begin(), UpperBoundsMs.end(), rttMs);
+        ++_buckets[bound - UpperBoundsMs.begin()];
+        ++_samples;
+        _lastMs = rttMs;
+        _maxMs = std::max(_maxMs, rttMs);
+    }
+
+    double RttHistogram::percentileMs(double p) const
+    {
+        if (_samples == 0)
+            return -1;
+
+        // Number of samples that must be at or below the result
+        auto const rank = static_cast<unsigned long long>(_samples * p / 100.0 + 0.5);
+        unsigned long long seen = 0;
+        for (size_t i = 0; i < UpperBoundsMs.size(); ++i) {
+            seen += _buckets[i];
+            if (seen >= std::max(rank, 1ULL))
+                return UpperBoundsMs[i];
+        }
+
+        return -1;
+    }
+
+    std::string RttHistogram::toString() const
+    {
+        std::stringstream ss;
+        if (_samples == 0) {
+            ss << "no successful pings";
+        }
+        else {
+            auto const percentile = [this](double p) {
+                double const bound = percentileMs(p);
+                return bound < 0 ? std::string("> 5000 ms") : "<= " + std::to_string(int(bound)) + " ms";
+            };
+
+            ss << "last " << int(_lastMs + 0.5) << " ms, p50 " << percentile(50) 
+               << ", p99 " << percentile(99) << ", max " << int(_maxMs + 0.5) << " ms"
+               << " (" << _samples << " pings";
+            if (_failures)
+                ss << ", " << _failures << " failed";
+            ss << ")";
+        }
+
+        if (_samples == 0 && _failures)
+            ss << " (" << _failures << " failed)";
+
+        return ss.str();
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+namespace Robomongo
+{
+    /**
+     * @brief Round trip times of health check pings of one server.
+     *        Samples are counted in buckets with fixed upper bounds (1 ms ... 5 s),
+     *        slower samples go to the last, unbounded, bucket.
+     */
+    class RttHistogram
+    {
+    public:
+        static constexpr std::array<double, 12> UpperBoundsMs {
+            1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000
+        };
+
+        void addSample(double rttMs);
+        void addFailure() { ++_failures; }
+
+        unsigned long long samples() const { return _samples; }
+        unsigned long long failures() const { return _failures; }
+        double lastMs() const { return _lastMs; }
+        double maxMs() const { return _maxMs; }
+
+        /**
+         * @brief Upper bound (ms) of the bucket with p-th percentile (0 < p <= 100),
+         *        or -1 if there are no samples or percentile is in the last bucket.
+         */
+        double percentileMs(double p) const;
+
+        /**
+         * @brief Short human readable summary, i.e. "last 3 ms, p50 <= 5 ms, p99 <= 20 ms, 
+         *        max 14 ms (120 pings, 1 failed)"
+         */
+        std::string toString() const;
+
+    private:
+        std::array<unsigned long long, UpperBoundsMs.size() + 1> _buckets {};
+        unsigned long long _samples = 0;
+        unsigned long long _failures = 0;
+        double _lastMs = 0;
+        double _maxMs = 0;
+    };
+}
@@ -0,0 +1,47 @@
+#include "robomongo/core/utils/ScratchArena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace Robomongo
+{
+    ScratchArena::~ScratchArena()
+    {
+        while (_blocks) {
+            Block *const previous = _blocks->previous;
+            std::free(_blocks);
+            _blocks = previous;
+        }
+    }
+
+    void *ScratchArena::allocate(size_t bytes, size_t alignment)
+    {
+        auto const align = [alignment](char *ptr) {
+            uintptr_t const address = reinterpret_cast<uintptr_t>(ptr);
+            return reinterpret_cast<char *>((address + alignment - 1) & ~(uintptr_t(alignment) - 1));
+        };
+
+        char *result = align(_current);
+        if (result + bytes > _end) {
+            // Every block is at least twice the previous one (inline buffer first)
+            size_t const header = sizeof(Block) + alignment;
+            size_t const size = std::max(bytes + header, std::max<size_t>(InlineBytes, _heapBytes) * 2);
+            Block *const block = static_cast<Block *>(std::malloc(size));
+            if (!block)
+                throw std::bad_alloc();
+
+            block->previous = _blocks;
+            _blocks = block;
+            _heapBytes += size;
+            _current = reinterpret_cast<char *>(block + 1);
+            _end = reinterpret_cast<char *>(block) + size;
+            result = align(_current);
+        }
+
+        _used += (result - _current) + bytes;
+        _current = result + bytes;
+        return result;
+    }
+}
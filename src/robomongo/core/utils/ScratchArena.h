@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Robomongo
+{
+    /**
+     * @brief Monotonic memory of one request handler for its temporary containers:
+     *        first InlineBytes are on stack, then blocks of growing size are taken from
+     *        heap. Nothing is freed before arena is destroyed. Not thread safe.
+     *
+     *        std::set<std::string, std::less<std::string>, ArenaAllocator<std::string>>
+     *            names { std::less<std::string>(), ArenaAllocator<std::string>(arena) };
+     */
+    class ScratchArena
+    {
+    public:
+        static constexpr size_t InlineBytes = 4096;
+
+        ScratchArena() {}
+        ~ScratchArena();
+
+        ScratchArena(const ScratchArena &) = delete;
+        ScratchArena &operator=(const ScratchArena &) = delete;
+
+        void *allocate(size_t bytes, size_t alignment);
+
+        // Handed out by allocate(), with padding
+        size_t used() const { return _used; }
+
+        // Taken from heap, when inline buffer was not enough
+        size_t heapBytes() const { return _heapBytes; }
+
+    private:
+        struct Block
+        {
+            Block *previous;
+        };
+
+        alignas(std::max_align_t) char _inline[InlineBytes];
+        char *_current = _inline;
+        char *_end = _inline + InlineBytes;
+        Block *_blocks = nullptr;
+        size_t _used = 0;
+        size_t _heapBytes = 0;
+    };
+
+    /**
+     * @brief Allocator of standard containers, which takes memory from ScratchArena.
+     *        Container must not outlive arena.
+     */
+    template <typename T>
+    class ArenaAllocator
+    {
+    public:
+        typedef T value_type;
+
+        explicit ArenaAllocator(ScratchArena &arena) : _arena(&arena) {}
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) : _arena(other.arena()) {}
+
+        T *allocate(size_t count) {
+            return static_cast<T *>(_arena->allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *, size_t) {}
+
+        ScratchArena *arena() const { return _arena; }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U> &other) const { return _arena == other.arena(); }
+
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U> &other) const { return _arena != other.arena(); }
+
+    private:
+        ScratchArena *_arena;
+    };
+}
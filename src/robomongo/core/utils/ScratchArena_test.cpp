@@ -0,0 +1,38 @@
+#include "gtest/gtest.h"
+#include "ScratchArena.h"
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace Robomongo;
+
+TEST(scratch_arena_tests, small_containers_stay_inline)
+{
+    ScratchArena arena;
+    std::set<std::string, std::less<std::string>, ArenaAllocator<std::string>>
+        names { std::less<std::string>(), ArenaAllocator<std::string>(arena) };
+    for (auto const name : { "admin", "local", "config", "shop", "admin" })
+        names.insert(name);
+
+    EXPECT_EQ(4u, names.size());
+    EXPECT_EQ("admin", *names.begin());
+    EXPECT_GT(arena.used(), 0u);
+    EXPECT_EQ(0u, arena.heapBytes());
+}
+
+TEST(scratch_arena_tests, grows_into_heap_blocks_with_alignment)
+{
+    ScratchArena arena;
+    std::vector<double, ArenaAllocator<double>> values { ArenaAllocator<double>(arena) };
+    for (int i = 0; i < 10000; ++i)
+        values.push_back(i);
+
+    EXPECT_EQ(9999.0, values.back());
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(values.data()) % alignof(double));
+    EXPECT_GT(arena.heapBytes(), 0u);
+
+    void *const big = arena.allocate(ScratchArena::InlineBytes * 10, 64);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(big) % 64);
+}
@@ -0,0 +1,102 @@
+#include "robomongo/core/utils/StartupProfile.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace Robomongo
+{
+namespace StartupProfile
+{
+    namespace
+    {
+        const char *const ProfileArgument = "--startup-profile";
+
+        // Static initialization is the closest to process start, that is portable
+        std::chrono::steady_clock::time_point const loadedAt = std::chrono::steady_clock::now();
+
+        long long elapsedUs()
+        {
+            using namespace std::chrono;
+            return duration_cast<microseconds>(steady_clock::now() - loadedAt).count();
+        }
+
+        bool isEnabled = false;
+        bool isFinished = false;
+        int depth = 0;
+        std::vector<Phase> recorded;
+    }
+
+    void parseArguments(int &argc, char *argv[])
+    {
+        int kept = 1;
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], ProfileArgument) == 0)
+                isEnabled = true;
+            else
+                argv[kept++] = argv[i];
+        }
+        argc = kept;
+        argv[argc] = nullptr;
+    }
+
+    bool enabled()
+    {
+        return isEnabled;
+    }
+
+    void mark(const char *name)
+    {
+        if (!isFinished)
+            recorded.push_back({ name, elapsedUs(), 0, depth });
+    }
+
+    void finish()
+    {
+        if (isFinished)
+            return;
+
+        mark("startup finished");
+        isFinished = true;
+
+        if (isEnabled)
+            fprintf(stderr, "Startup profile:\n%s", report().c_str());
+    }
+
+    std::vector<Phase> phases()
+    {
+        return recorded;
+    }
+
+    std::string report()
+    {
+        std::string result;
+        char line[256];
+        for (Phase const &phase : recorded) {
+            snprintf(line, sizeof(line), "%9.1f ms %9.1f ms  %*s%s\n", phase.startUs / 1000.0,
+                     phase.durationUs / 1000.0, phase.depth * 2, "", phase.name);
+            result += line;
+        }
+        return result;
+    }
+
+    Scope::Scope(const char *name) :
+        _index(-1)
+    {
+        if (isFinished)
+            return;
+
+        _index = static_cast<int>(recorded.size());
+        recorded.push_back({ name, elapsedUs(), 0, depth++ });
+    }
+
+    Scope::~Scope()
+    {
+        if (_index < 0)
+            return;
+
+        --depth;
+        recorded[_index].durationUs = elapsedUs() - recorded[_index].startUs;
+    }
+}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Robomongo
+{
+    /**
+     * @brief Timeline of program startup, from loading of executable to the first frame of
+     *        main window. Phases are recorded always (there are a few dozens of them), they
+     *        are reported to stderr and log only when started with --startup-profile.
+     *        Use in main thread only.
+     */
+    namespace StartupProfile
+    {
+        struct Phase
+        {
+            const char *name;
+            long long startUs;      // since executable was loaded
+            long long durationUs;
+            int depth;              // nesting of Scope
+        };
+
+        // Removes --startup-profile from arguments, enables report if it was there
+        void parseArguments(int &argc, char *argv[]);
+        bool enabled();
+
+        // Moment of startup without duration, i.e. "first frame"
+        void mark(const char *name);
+
+        // Startup is done: nothing is recorded anymore, report is printed if enabled
+        void finish();
+
+        // Phases by start, outer ones before nested
+        std::vector<Phase> phases();
+
+        // One line per phase: start, duration and name, nested ones indented
+        std::string report();
+
+        /**
+         * @brief Phase of startup during lifetime of Scope, name must be a string literal.
+         *        Does nothing once startup is finished.
+         */
+        class Scope
+        {
+        public:
+            explicit Scope(const char *name);
+            ~Scope();
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            int _index;
+        };
+    }
+}
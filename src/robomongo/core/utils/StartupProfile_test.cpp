@@ -0,0 +1,34 @@
+#include "gtest/gtest.h"
+#include "StartupProfile.h"
+
+using namespace Robomongo;
+
+TEST(startup_profile_tests, argument_is_removed)
+{
+    char program[] = "robo3t", profile[] = "--startup-profile", other[] = "--debug";
+    char *argv[] = { program, profile, other, nullptr };
+    int argc = 3;
+
+    StartupProfile::parseArguments(argc, argv);
+    EXPECT_TRUE(StartupProfile::enabled());
+    ASSERT_EQ(2, argc);
+    EXPECT_STREQ("--debug", argv[1]);
+    EXPECT_EQ(nullptr, argv[2]);
+}
+
+TEST(startup_profile_tests, nested_phases)
+{
+    size_t const before = StartupProfile::phases().size();
+    {
+        StartupProfile::Scope outer("outer");
+        StartupProfile::Scope inner("inner");
+    }
+
+    std::vector<StartupProfile::Phase> const phases = StartupProfile::phases();
+    ASSERT_EQ(before + 2, phases.size());
+    EXPECT_STREQ("outer", phases[before].name);
+    EXPECT_STREQ("inner", phases[before + 1].name);
+    EXPECT_EQ(phases[before].depth + 1, phases[before + 1].depth);
+    EXPECT_GE(phases[before].durationUs, phases[before + 1].durationUs);
+    EXPECT_NE(std::string::npos, StartupProfile::report().find("  inner\n"));
+}
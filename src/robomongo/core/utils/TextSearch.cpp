@@ -0,0 +1,167 @@
+#include "robomongo/core/utils/TextSearch.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#define ROBOMONGO_SEARCH_SSE2 1
+#endif
+
+namespace Robomongo
+{
+    namespace TextSearch
+    {
+        namespace
+        {
+            // Stop flag is checked once per this many bytes
+            const size_t StopCheckBytes = 64 * 1024;
+
+            inline unsigned char lowerAscii(unsigned char c)
+            {
+                return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c + ('a' - 'A')) : c;
+            }
+
+            inline bool isAsciiLetter(unsigned char c)
+            {
+                c = lowerAscii(c);
+                return c >= 'a' && c <= 'z';
+            }
+
+#if defined(ROBOMONGO_SEARCH_SSE2)
+            inline unsigned firstSetBit(unsigned mask)
+            {
+#if defined(_MSC_VER)
+                unsigned long index;
+                _BitScanForward(&index, mask);
+                return index;
+#else
+                return __builtin_ctz(mask);
+#endif
+            }
+#endif
+
+            class Matcher
+            {
+            public:
+                Matcher(const char *text, const std::string &pattern, bool caseSensitive,
+                        std::vector<size_t> &offsets, size_t maxOffsets) :
+                    _text(text), _pattern(pattern), _caseSensitive(caseSensitive),
+                    _offsets(offsets), _maxOffsets(maxOffsets), _total(0), _next(0) {}
+
+                // Records match at 'pos', if it is there and does not overlap previous one
+                void tryAt(size_t pos)
+                {
+                    if (pos < _next || !matchesAt(pos))
+                        return;
+
+                    if (_offsets.size() < _maxOffsets)
+                        _offsets.push_back(pos);
+                    ++_total;
+                    _next = pos + _pattern.size();
+                }
+
+                size_t total() const { return _total; }
+
+            private:
+                bool matchesAt(size_t pos) const
+                {
+                    const char *p = _text + pos;
+                    if (_caseSensitive)
+                        return std::memcmp(p, _pattern.data(), _pattern.size()) == 0;
+
+                    for (size_t k = 0; k < _pattern.size(); ++k) {
+                        if (lowerAscii(p[k]) != static_cast<unsigned char>(_pattern[k]))
+                            return false;
+                    }
+                    return true;
+                }
+
+                const char *const _text;
+                const std::string &_pattern;   // lower case, if search is case insensitive
+                const bool _caseSensitive;
+                std::vector<size_t> &_offsets;
+                const size_t _maxOffsets;
+                size_t _total;
+                size_t _next;                   // first position where next match may start
+            };
+
+            inline bool isStopped(const std::atomic<bool> *stop)
+            {
+                return stop && stop->load(std::memory_order_relaxed);
+            }
+        }
+
+        size_t findAll(const char *text, size_t size, const std::string &needle, bool caseSensitive,
+                       std::vector<size_t> &offsets, size_t maxOffsets, const std::atomic<bool> *stop)
+        {
+            offsets.clear();
+            size_t const length = needle.size();
+            if (length == 0 || length > size)
+                return 0;
+
+            std::string pattern = needle;
+            if (!caseSensitive) {
+                for (char &c : pattern)
+                    c = static_cast<char>(lowerAscii(c));
+            }
+
+            Matcher matcher(text, pattern, caseSensitive, offsets, maxOffsets);
+            size_t const lastStart = size - length;
+            size_t i = 0;
+
+#if defined(ROBOMONGO_SEARCH_SSE2)
+            // Bytes at i and i + length - 1 are compared with first and last byte of needle
+            // for 16 consecutive i at once. Letters of case insensitive search are folded
+            // with | 0x20, which maps only 'X' and 'x' to 'x'.
+            unsigned char const firstByte = pattern[0];
+            unsigned char const lastByte = pattern[length - 1];
+            const __m128i first = _mm_set1_epi8(static_cast<char>(firstByte));
+            const __m128i last = _mm_set1_epi8(static_cast<char>(lastByte));
+            const __m128i foldFirst = _mm_set1_epi8(!caseSensitive && isAsciiLetter(firstByte) ? 0x20 : 0);
+            const __m128i foldLast = _mm_set1_epi8(!caseSensitive && isAsciiLetter(lastByte) ? 0x20 : 0);
+
+            for (; i + 16 <= lastStart + 1; i += 16) {
+                if (i % StopCheckBytes == 0 && isStopped(stop))
+                    return matcher.total();
+
+                __m128i const blockFirst = _mm_or_si128(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i)), foldFirst);
+                __m128i const blockLast = _mm_or_si128(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + length - 1)), foldLast);
+                unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first),
+                                                                _mm_cmpeq_epi8(blockLast, last)));
+                while (mask) {
+                    matcher.tryAt(i + firstSetBit(mask));
+                    mask &= mask - 1;
+                }
+            }
+#else
+            if (caseSensitive) {
+                // memchr() jumps to candidates
+                while (i <= lastStart) {
+                    if (isStopped(stop))
+                        return matcher.total();
+
+                    const void *found = std::memchr(text + i, pattern[0], lastStart - i + 1);
+                    if (!found)
+                        return matcher.total();
+
+                    size_t const pos = static_cast<const char*>(found) - text;
+                    matcher.tryAt(pos);
+                    i = pos + 1;
+                }
+            }
+#endif
+
+            for (; i <= lastStart; ++i) {
+                if (i % StopCheckBytes == 0 && isStopped(stop))
+                    break;
+                matcher.tryAt(i);
+            }
+            return matcher.total();
+        }
+    }
+}
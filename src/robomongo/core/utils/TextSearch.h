@@ -0,0 +1,25 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace Robomongo
+{
+    namespace TextSearch
+    {
+        /**
+         * @brief Finds non-overlapping occurrences of 'needle' in UTF-8 'text', left to right
+         *        (as consecutive "find next" do). Candidates are filtered 16 positions at a time
+         *        by first and last byte of needle (SSE2), then compared in full.
+         * @param caseSensitive If false, ASCII letters are compared case insensitive, other
+         *        characters must match exactly.
+         * @param offsets Out param - byte offsets of the first 'maxOffsets' matches.
+         * @param stop If set, search returns early (with matches found so far).
+         * @return Number of matches, may be greater than size of 'offsets'.
+         */
+        size_t findAll(const char *text, size_t size, const std::string &needle, bool caseSensitive,
+                       std::vector<size_t> &offsets, size_t maxOffsets,
+                       const std::atomic<bool> *stop = nullptr);
+    }
+}
@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+#include "TextSearch.h"
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+using namespace Robomongo;
+
+namespace
+{
+    // Reference: non-overlapping matches found one after another from the left
+    std::vector<size_t> naiveFindAll(const std::string &text, const std::string &needle, bool caseSensitive)
+    {
+        auto lower = [](std::string s) {
+            for (char &c : s) {
+                if (c >= 'A' && c <= 'Z')
+                    c = static_cast<char>(c + ('a' - 'A'));
+            }
+            return s;
+        };
+        std::string const haystack = caseSensitive ? text : lower(text);
+        std::string const pattern = caseSensitive ? needle : lower(needle);
+
+        std::vector<size_t> offsets;
+        for (size_t pos = haystack.find(pattern); pos != std::string::npos;
+             pos = haystack.find(pattern, pos + pattern.size()))
+            offsets.push_back(pos);
+        return offsets;
+    }
+}
+
+TEST(text_search_tests, finds_all_like_naive_search)
+{
+    std::string text;
+    for (int i = 0; i < 5000; ++i)
+        text += static_cast<char>("aAbB{}\"\xc3\xa9 \n"[(i * 7 + i / 13) % 12]);
+
+    std::string const needles[] = { "a", "ab", "aA", "bb\"", "{}\"", "\xc3\xa9", "b\n", "aaaaaaaaaaaaaaaaaaaa" };
+    for (const std::string &needle : needles) {
+        for (bool caseSensitive : { true, false }) {
+            std::vector<size_t> offsets;
+            size_t const total = TextSearch::findAll(text.data(), text.size(), needle, caseSensitive,
+                                                     offsets, text.size());
+            EXPECT_EQ(naiveFindAll(text, needle, caseSensitive), offsets) << needle << " " << caseSensitive;
+            EXPECT_EQ(offsets.size(), total);
+        }
+    }
+}
+
+TEST(text_search_tests, matches_do_not_overlap)
+{
+    std::string const text(37, 'a');
+    std::vector<size_t> offsets;
+    EXPECT_EQ(18u, TextSearch::findAll(text.data(), text.size(), "aa", true, offsets, 100));
+    ASSERT_EQ(18u, offsets.size());
+    EXPECT_EQ(34u, offsets.back());
+}
+
+TEST(text_search_tests, limits_offsets_but_counts_all)
+{
+    std::string const text = "{ \"name\" : \"x\" }, { \"NAME\" : \"y\" }, { \"Name\" : \"z\" }";
+    std::vector<size_t> offsets;
+    EXPECT_EQ(3u, TextSearch::findAll(text.data(), text.size(), "name", false, offsets, 2));
+    ASSERT_EQ(2u, offsets.size());
+    EXPECT_EQ(3u, offsets[0]);
+    EXPECT_EQ(1u, TextSearch::findAll(text.data(), text.size(), "name", true, offsets, 2));
+    EXPECT_EQ(0u, TextSearch::findAll(text.data(), text.size(), "", true, offsets, 2));
+    EXPECT_EQ(0u, TextSearch::findAll(text.data(), 3, "name", true, offsets, 2));
+    EXPECT_TRUE(offsets.empty());
+}
+
+TEST(text_search_tests, stops_when_requested)
+{
+    std::string const text(1024 * 1024, 'a');
+    std::atomic<bool> stop(true);
+    std::vector<size_t> offsets;
+    EXPECT_EQ(0u, TextSearch::findAll(text.data(), text.size(), "a", true, offsets, 10, &stop));
+}
@@ -0,0 +1,64 @@
+#include "robomongo/core/utils/ThreadPriority.h"
+
+#include <QtGlobal>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_MAC)
+#include <pthread.h>
+#include <pthread/qos.h>
+#elif defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    thread_local Robomongo::ThreadPriority::Class currentClass = Robomongo::ThreadPriority::Normal;
+
+    bool applyClass(Robomongo::ThreadPriority::Class priorityClass)
+    {
+        using namespace Robomongo::ThreadPriority;
+#if defined(Q_OS_WIN)
+        int const priority = priorityClass == Background ? THREAD_PRIORITY_BELOW_NORMAL :
+                             priorityClass == Interactive ? THREAD_PRIORITY_ABOVE_NORMAL : THREAD_PRIORITY_NORMAL;
+        return SetThreadPriority(GetCurrentThread(), priority) != 0;
+#elif defined(Q_OS_MAC)
+        qos_class_t const qos = priorityClass == Background ? QOS_CLASS_UTILITY :
+                                priorityClass == Interactive ? QOS_CLASS_USER_INTERACTIVE : QOS_CLASS_USER_INITIATED;
+        return pthread_set_qos_class_self_np(qos, 0) == 0;
+#elif defined(Q_OS_LINUX)
+        // Switching between SCHED_BATCH and SCHED_OTHER does not need privileges
+        sched_param param = {};
+        param.sched_priority = 0;
+        int const policy = priorityClass == Background ? SCHED_BATCH : SCHED_OTHER;
+        return pthread_setschedparam(pthread_self(), policy, &param) == 0;
+#else
+        Q_UNUSED(priorityClass);
+        return true;
+#endif
+    }
+}
+
+namespace Robomongo
+{
+    namespace ThreadPriority
+    {
+        Class current()
+        {
+            return currentClass;
+        }
+
+        bool setCurrent(Class priorityClass)
+        {
+            if (priorityClass == currentClass)
+                return true;
+
+            if (!applyClass(priorityClass))
+                return false;
+
+            currentClass = priorityClass;
+            return true;
+        }
+    }
+}
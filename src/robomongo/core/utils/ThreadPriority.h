@@ -0,0 +1,44 @@
+#pragma once
+
+namespace Robomongo
+{
+    /**
+     * @brief OS scheduling class of the calling thread, so that background work of worker
+     *        threads (prefetch, stats, sampling, view preparation) yields CPU to GUI thread
+     *        and to interactive requests.
+     *
+     *  macOS: QoS class (utility, user initiated, user interactive).
+     *  Windows: THREAD_PRIORITY_BELOW_NORMAL, NORMAL, ABOVE_NORMAL.
+     *  Linux: SCHED_BATCH for background, SCHED_OTHER otherwise. Nice value is not changed,
+     *  since unprivileged thread could not restore it, and Interactive is not raised.
+     *
+     *  Class is cached per thread, setting the same class again does no system call.
+     */
+    namespace ThreadPriority
+    {
+        enum Class { Background, Normal, Interactive };
+
+        // Class last set for calling thread, Normal if it was never set
+        Class current();
+
+        // Returns false if OS refused the change, thread keeps its previous class then
+        bool setCurrent(Class priorityClass);
+
+        /**
+         * @brief Sets class of calling thread and restores the previous one when destroyed
+         */
+        class Scope
+        {
+        public:
+            explicit Scope(Class priorityClass) :
+                _previous(current()) { setCurrent(priorityClass); }
+            ~Scope() { setCurrent(_previous); }
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            Class const _previous;
+        };
+    }
+}
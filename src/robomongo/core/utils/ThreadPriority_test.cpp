@@ -0,0 +1,34 @@
+#include "gtest/gtest.h"
+#include "ThreadPriority.h"
+
+#include <thread>
+
+using namespace Robomongo;
+
+TEST(thread_priority_tests, scope_restores_previous_class)
+{
+    std::thread([]() {
+        EXPECT_EQ(ThreadPriority::Normal, ThreadPriority::current());
+        {
+            ThreadPriority::Scope background(ThreadPriority::Background);
+            EXPECT_EQ(ThreadPriority::Background, ThreadPriority::current());
+            {
+                ThreadPriority::Scope normal(ThreadPriority::Normal);
+                EXPECT_EQ(ThreadPriority::Normal, ThreadPriority::current());
+            }
+            EXPECT_EQ(ThreadPriority::Background, ThreadPriority::current());
+        }
+        EXPECT_EQ(ThreadPriority::Normal, ThreadPriority::current());
+    }).join();
+}
+
+TEST(thread_priority_tests, class_is_per_thread)
+{
+    std::thread([]() {
+        ASSERT_TRUE(ThreadPriority::setCurrent(ThreadPriority::Background));
+        std::thread([]() {
+            EXPECT_EQ(ThreadPriority::Normal, ThreadPriority::current());
+        }).join();
+        EXPECT_EQ(ThreadPriority::Background, ThreadPriority::current());
+    }).join();
+}
@@ -3,6 +3,7 @@
 #include <QApplication>
 #include <QToolButton>
 #include <QMessageBox>
+#include <QFileDialog>
 #include <QWidgetAction>
 #include <QMenuBar>
 #include <QMenu>
@@ -23,9 +24,12 @@
 #include <QNetworkReply>
 #include <QUrl>
 #include <QTextDocument>
+#include <algorithm>
+#include <set>
 
 #include <mongo/logger/log_severity.h>
 #include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/settings/SshSettings.h"
 #include "robomongo/core/domain/MongoServer.h"
 #include "robomongo/core/domain/App.h"
@@ -33,8 +37,10 @@
 #include "robomongo/core/EventBus.h"
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/core/utils/Logger.h"
+#include "robomongo/core/utils/StartupProfile.h"
 
 #include "robomongo/gui/widgets/LogWidget.h"
+#include "robomongo/gui/widgets/PerformanceWidget.h"
 #include "robomongo/gui/widgets/explorer/ExplorerWidget.h"
 #include "robomongo/gui/widgets/explorer/ExplorerCollectionTreeItem.h"
 #include "robomongo/gui/widgets/explorer/ExplorerTreeWidget.h"
@@ -47,6 +53,7 @@
 #include "robomongo/gui/dialogs/PreferencesDialog.h"
 #include "robomongo/gui/dialogs/ExportDialog.h"
 #include "robomongo/gui/dialogs/ChangeShellTimeoutDialog.h"
+#include "robomongo/gui/dialogs/NamespaceFinderDialog.h"
 #include "robomongo/gui/GuiRegistry.h"
 #include "robomongo/gui/AppStyle.h"
 
@@ -125,15 +132,17 @@ namespace Robomongo
 
     MainWindow::MainWindow()
         : BaseClass(),
-        _logDock(nullptr), _workArea(nullptr), _explorer(nullptr), _app(AppRegistry::instance().app()), 
+        _logDock(nullptr), _performanceDock(nullptr), _workArea(nullptr), _explorer(nullptr), _app(AppRegistry::instance().app()), 
         _connectionsMenu(nullptr), _connectButton(nullptr), _viewMenu(nullptr), _toolbarsMenu(nullptr), 
-        _connectAction(nullptr), _openAction(nullptr), _saveAction(nullptr), _saveAsAction(nullptr),
+        _connectAction(nullptr), _openAction(nullptr), _runFileAction(nullptr), _saveAction(nullptr), _saveAsAction(nullptr),
         _executeAction(nullptr), _stopAction(nullptr), _orientationAction(nullptr), _execToolBar(nullptr),
 #if defined(Q_OS_WIN)
         _trayIcon(nullptr),
 #endif
-        _allowExit(false)
+        _allowExit(false), _isFirstFramePainted(false)
      {
+        StartupProfile::Scope phase("MainWindow");
+
         QColor background = palette().window().color();
         QString controlKey = "Ctrl";
 
@@ -158,6 +167,10 @@ namespace Robomongo
         _openAction->setShortcuts(QKeySequence::Open);
         VERIFY(connect(_openAction, SIGNAL(triggered()), this, SLOT(open())));
 
+        _runFileAction = new QAction(tr("&Run File..."), this);
+        _runFileAction->setToolTip("Execute script file in the currently opened shell, without loading it to the editor");
+        VERIFY(connect(_runFileAction, SIGNAL(triggered()), this, SLOT(runFile())));
+
         _saveAction = new QAction(GuiRegistry::instance().saveIcon(), tr("&Save"), this);
         _saveAction->setShortcuts(QKeySequence::Save);
         _saveAction->setToolTip(QString("Save script of the currently opened shell to the file <b>(%1 + S)</b>").arg(controlKey));
@@ -167,6 +180,11 @@ namespace Robomongo
         _saveAsAction->setShortcuts(QKeySequence::SaveAs);
         VERIFY(connect(_saveAsAction, SIGNAL(triggered()), this, SLOT(saveAs())));
 
+        // Open mongodump output action
+        QAction *openBsonFileAction = new QAction(tr("Open &BSON File..."), this);
+        openBsonFileAction->setToolTip("View documents of mongodump .bson or archive file, or of saved result set, without server");
+        VERIFY(connect(openBsonFileAction, SIGNAL(triggered()), this, SLOT(openBsonFile())));
+
         // Exit action
         QAction *exitAction = new QAction("&Exit", this);
         exitAction->setShortcuts(QKeySequence::Quit);
@@ -295,9 +313,12 @@ namespace Robomongo
         fileMenu->addAction(_connectAction);
         fileMenu->addSeparator();
         fileMenu->addAction(_openAction);
+        fileMenu->addAction(_runFileAction);
         fileMenu->addAction(_saveAction);
         fileMenu->addAction(_saveAsAction);
         fileMenu->addSeparator();
+        fileMenu->addAction(openBsonFileAction);
+        fileMenu->addSeparator();
         fileMenu->addAction(exitAction);
 
 
@@ -348,6 +369,33 @@ namespace Robomongo
         timeZoneGroup->addAction(utcTime);
         timeZoneGroup->addAction(localTime);
 
+        // JSON output mode
+        JsonOutputMode const jsonOutputMode = AppRegistry::instance().settingsManager()->jsonOutputMode();
+        QAction *shellJson = new QAction(convertJsonOutputModeToString(ShellJson), this);
+        shellJson->setCheckable(true);
+        shellJson->setChecked(jsonOutputMode == ShellJson);
+        VERIFY(connect(shellJson, SIGNAL(triggered()), this, SLOT(setShellJsonOutput())));
+
+        QAction *relaxedJson = new QAction(convertJsonOutputModeToString(RelaxedJson), this);
+        relaxedJson->setCheckable(true);
+        relaxedJson->setChecked(jsonOutputMode == RelaxedJson);
+        VERIFY(connect(relaxedJson, SIGNAL(triggered()), this, SLOT(setRelaxedJsonOutput())));
+
+        QAction *compactJson = new QAction(convertJsonOutputModeToString(CompactJson), this);
+        compactJson->setCheckable(true);
+        compactJson->setChecked(jsonOutputMode == CompactJson);
+        VERIFY(connect(compactJson, SIGNAL(triggered()), this, SLOT(setCompactJsonOutput())));
+
+        QMenu *jsonMenu = optionsMenu->addMenu("JSON Output Format");
+        jsonMenu->addAction(shellJson);
+        jsonMenu->addAction(relaxedJson);
+        jsonMenu->addAction(compactJson);
+
+        QActionGroup *jsonOutputGroup = new QActionGroup(this);
+        jsonOutputGroup->addAction(shellJson);
+        jsonOutputGroup->addAction(relaxedJson);
+        jsonOutputGroup->addAction(compactJson);
+
         // UUID encoding
         QAction *defaultEncodingAction = new QAction("Do not decode (show as is)", this);
         defaultEncodingAction->setCheckable(true);
@@ -411,6 +459,44 @@ namespace Robomongo
         optionsMenu->addSeparator();
         optionsMenu->addAction(loadMongoRcJs);
 
+        QAction *profileQueries = new QAction("Explain Queries (executionStats)", this);
+        profileQueries->setCheckable(true);
+        profileQueries->setChecked(AppRegistry::instance().settingsManager()->profileQueries());
+        profileQueries->setToolTip("Run explain() for every find/aggregate statement executed in shell "
+                                   "and show plan summary in result header");
+        VERIFY(connect(profileQueries, SIGNAL(triggered()), this, SLOT(setProfileQueries())));
+        optionsMenu->addAction(profileQueries);
+
+        QAction *parallelReads = new QAction("Run Independent Reads in Parallel", this);
+        parallelReads->setCheckable(true);
+        parallelReads->setChecked(AppRegistry::instance().settingsManager()->parallelReads());
+        parallelReads->setToolTip("Run scripts, which consist only of find/aggregate statements with literal "
+                                  "arguments, on several connections at once");
+        VERIFY(connect(parallelReads, SIGNAL(triggered()), this, SLOT(setParallelReads())));
+        optionsMenu->addAction(parallelReads);
+
+        QAction *prefetchPages = new QAction("Prefetch Pages", this);
+        prefetchPages->setCheckable(true);
+        prefetchPages->setChecked(AppRegistry::instance().settingsManager()->prefetchPages());
+        VERIFY(connect(prefetchPages, SIGNAL(triggered()), this, SLOT(setPrefetchPages())));
+        optionsMenu->addAction(prefetchPages);
+
+        QAction *saveWorkspace = new QAction("Restore Query Tabs on Startup", this);
+        saveWorkspace->setCheckable(true);
+        saveWorkspace->setChecked(AppRegistry::instance().settingsManager()->saveWorkspace());
+        saveWorkspace->setToolTip("Save scripts and results of open query tabs at exit and reopen them "
+                                  "with their connections");
+        VERIFY(connect(saveWorkspace, SIGNAL(triggered()), this, SLOT(setSaveWorkspace())));
+        optionsMenu->addAction(saveWorkspace);
+
+        QAction *saveWorkspaceResults = new QAction("Restore Results of Query Tabs", this);
+        saveWorkspaceResults->setCheckable(true);
+        saveWorkspaceResults->setChecked(AppRegistry::instance().settingsManager()->saveWorkspaceResults());
+        saveWorkspaceResults->setToolTip("Save documents of shown pages with query tabs, so that restored tabs "
+                                         "show them without running scripts again");
+        VERIFY(connect(saveWorkspaceResults, SIGNAL(triggered()), this, SLOT(setSaveWorkspaceResults())));
+        optionsMenu->addAction(saveWorkspaceResults);
+
         optionsMenu->addSeparator();
 
         QAction *autoExpand = new QAction("Auto Expand First Document", this);
@@ -507,6 +593,12 @@ namespace Robomongo
         duplicateAction->setVisible(true);
         VERIFY(connect(duplicateAction, SIGNAL(triggered()), SLOT(duplicateTab())));
 
+        // Collection of any connected server, found by fuzzy search
+        QAction *goToNamespaceAction = new QAction("Go to Namespace...", this);
+        goToNamespaceAction->setShortcut(Qt::CTRL + Qt::SHIFT + Qt::Key_O);
+        goToNamespaceAction->setVisible(true);
+        VERIFY(connect(goToNamespaceAction, SIGNAL(triggered()), SLOT(goToNamespace())));
+
         // Window menu
         QMenu *windowMenu = menuBar()->addMenu("Window");
         //minimize
@@ -518,6 +610,7 @@ namespace Robomongo
         windowMenu->addSeparator();
         windowMenu->addAction(reloadAction);
         windowMenu->addAction(duplicateAction);
+        windowMenu->addAction(goToNamespaceAction);
         windowMenu->addSeparator();
 
         auto const& settings { AppRegistry::instance().settingsManager() };
@@ -614,11 +707,12 @@ namespace Robomongo
         setWindowTitle("Robo 3T - " + QString(PROJECT_VERSION_SHORT));
         setWindowIcon(GuiRegistry::instance().mainWindowIcon());
 
-        QTimer::singleShot(0, this, SLOT(manageConnections()));       
+        QTimer::singleShot(0, this, SLOT(openStartupConnections()));
         updateMenus();
         _updateMenusAtStart = false;
 
         AppRegistry::instance().bus()->subscribe(this, ConnectionFailedEvent::Type);
+        AppRegistry::instance().bus()->subscribe(this, ConnectionEstablishedEvent::Type);
         AppRegistry::instance().bus()->subscribe(this, ScriptExecutedEvent::Type);
         AppRegistry::instance().bus()->subscribe(this, ScriptExecutingEvent::Type);
         AppRegistry::instance().bus()->subscribe(this, QueryWidgetUpdatedEvent::Type);
@@ -666,6 +760,7 @@ namespace Robomongo
 
     void MainWindow::createStatusBar()
     {
+        StartupProfile::Scope phase("status bar");
         QColor windowColor = palette().window().color();
         QColor buttonBgColor = windowColor.lighter(105);
         QColor buttonBorderBgColor = windowColor.darker(112);
@@ -713,6 +808,7 @@ namespace Robomongo
 
     void MainWindow::restoreWindowSettings()
     {
+        StartupProfile::Scope phase("restore window settings");
         QSettings settings("3T", "Robomongo");
         // Restore settings if registery key exists, otherwise resize as app started for the first time.
         if (settings.contains("MainWindow/geometry"))
@@ -763,6 +859,12 @@ namespace Robomongo
 #endif
     }
 
+    void MainWindow::runFile()
+    {
+        if (QueryWidget *wid = _workArea->currentQueryWidget())
+            wid->runFile();
+    }
+
     void MainWindow::open()
     {
         QueryWidget *wid = _workArea->currentQueryWidget();
@@ -798,6 +900,14 @@ namespace Robomongo
         }
     }
 
+    void MainWindow::openBsonFile()
+    {
+        QString const filePath = QFileDialog::getOpenFileName(this, tr("Open BSON File"), QString(),
+                                                              tr("BSON files (*.bson *.archive *.bsonz);;All files (*)"));
+        if (!filePath.isEmpty())
+            _workArea->openBsonFile(filePath);
+    }
+
     void MainWindow::updateConnectionsMenu()
     {
         _connectionsMenu->clear();
@@ -846,6 +956,35 @@ namespace Robomongo
             widget->hideProgress();
     }
     
+    void MainWindow::openStartupConnections()
+    {
+        SettingsManager *settings = AppRegistry::instance().settingsManager();
+        if (settings->saveWorkspace())
+            _pendingTabs = WorkspaceSnapshot::load();
+
+        // Tabs of removed connections are dropped
+        _pendingTabs.erase(std::remove_if(_pendingTabs.begin(), _pendingTabs.end(),
+            [&](const WorkspaceSnapshot::Tab &tab) { return !settings->getConnectionSettingsByUuid(tab.connection); }),
+            _pendingTabs.end());
+
+        std::set<QString> tabConnections;
+        for (auto const &tab : _pendingTabs)
+            tabConnections.insert(tab.connection);
+
+        std::vector<ConnectionSettings *> connections;
+        for (ConnectionSettings *connection : settings->connections()) {
+            if (connection->autoConnect() || tabConnections.count(connection->uuid()))
+                connections.push_back(connection);
+        }
+
+        if (connections.empty()) {
+            manageConnections();
+            return;
+        }
+
+        _app->openServers(connections);
+    }
+
     void MainWindow::manageConnections()
     {
     #if defined(Q_OS_WIN)
@@ -1016,6 +1155,12 @@ namespace Robomongo
         widget->duplicate();
     }
 
+    void MainWindow::goToNamespace()
+    {
+        auto dlg = new NamespaceFinderDialog(this);
+        dlg->show();
+    }
+
     void MainWindow::refreshConnections()
     {
         QToolTip::showText(QPoint(0, 0),
@@ -1094,6 +1239,24 @@ namespace Robomongo
         AppRegistry::instance().settingsManager()->save();
     }
 
+    void MainWindow::setShellJsonOutput()
+    {
+        AppRegistry::instance().settingsManager()->setJsonOutputMode(ShellJson);
+        AppRegistry::instance().settingsManager()->save();
+    }
+
+    void MainWindow::setRelaxedJsonOutput()
+    {
+        AppRegistry::instance().settingsManager()->setJsonOutputMode(RelaxedJson);
+        AppRegistry::instance().settingsManager()->save();
+    }
+
+    void MainWindow::setCompactJsonOutput()
+    {
+        AppRegistry::instance().settingsManager()->setJsonOutputMode(CompactJson);
+        AppRegistry::instance().settingsManager()->save();
+    }
+
     void MainWindow::setDisableConnectionShortcuts()
     {
         QAction *send = qobject_cast<QAction*>(sender());
@@ -1109,6 +1272,41 @@ namespace Robomongo
         AppRegistry::instance().settingsManager()->save();
     }
 
+    void MainWindow::setProfileQueries()
+    {
+        QAction *send = qobject_cast<QAction*>(sender());
+        AppRegistry::instance().settingsManager()->setProfileQueries(send->isChecked());
+        AppRegistry::instance().settingsManager()->save();
+    }
+
+    void MainWindow::setParallelReads()
+    {
+        QAction *send = qobject_cast<QAction*>(sender());
+        AppRegistry::instance().settingsManager()->setParallelReads(send->isChecked());
+        AppRegistry::instance().settingsManager()->save();
+    }
+
+    void MainWindow::setPrefetchPages()
+    {
+        QAction *send = qobject_cast<QAction*>(sender());
+        AppRegistry::instance().settingsManager()->setPrefetchPages(send->isChecked());
+        AppRegistry::instance().settingsManager()->save();
+    }
+
+    void MainWindow::setSaveWorkspace()
+    {
+        QAction *send = qobject_cast<QAction*>(sender());
+        AppRegistry::instance().settingsManager()->setSaveWorkspace(send->isChecked());
+        AppRegistry::instance().settingsManager()->save();
+    }
+
+    void MainWindow::setSaveWorkspaceResults()
+    {
+        QAction *send = qobject_cast<QAction*>(sender());
+        AppRegistry::instance().settingsManager()->setSaveWorkspaceResults(send->isChecked());
+        AppRegistry::instance().settingsManager()->save();
+    }
+
     void MainWindow::toggleLogs(bool show)
     {
         _logDock->setVisible(show);
@@ -1135,15 +1333,32 @@ namespace Robomongo
             return;
 
         // Very temporary solution to prevent multiple connection error messages
-        // from both SshTunnelWorker and MongoWorker
-        static int lastServerHandle = -1;
-        if (event->serverHandle <= lastServerHandle)
+        // from both SshTunnelWorker and MongoWorker. Connections opened at startup
+        // fail in any order, so every handle is remembered.
+        static std::set<int> reportedServerHandles;
+        if (!reportedServerHandles.insert(event->serverHandle).second)
             return;
 
-        lastServerHandle = event->serverHandle;
         QMessageBox::critical(this, "Error", QtUtils::toQString(event->message));
     }
 
+    void MainWindow::handle(ConnectionEstablishedEvent *event)
+    {
+        if (event->connectionType != ConnectionPrimary || _pendingTabs.empty())
+            return;
+
+        // Each saved tab is restored once, with the first connection of its settings
+        QString const uuid = event->server->connectionRecord()->uuid();
+        std::vector<WorkspaceSnapshot::Tab> restored;
+        auto const pending = std::stable_partition(_pendingTabs.begin(), _pendingTabs.end(),
+            [&](const WorkspaceSnapshot::Tab &tab) { return tab.connection != uuid; });
+        restored.assign(pending, _pendingTabs.end());
+        _pendingTabs.erase(pending, _pendingTabs.end());
+
+        for (auto const &tab : restored)
+            _workArea->restoreTab(event->server, tab);
+    }
+
     void MainWindow::handle(ScriptExecutingEvent *)
     {
         _stopAction->setDisabled(false);
@@ -1177,8 +1392,12 @@ namespace Robomongo
 
     void MainWindow::closeEvent(QCloseEvent *event)
     {
-        AppRegistry::instance().settingsManager()->setProgramExitedNormally(true);
-        AppRegistry::instance().settingsManager()->save();
+        SettingsManager *settings = AppRegistry::instance().settingsManager();
+        if (settings->saveWorkspace())
+            _workArea->saveWorkspace(settings->saveWorkspaceResults(), _pendingTabs);
+
+        settings->setProgramExitedNormally(true);
+        settings->save();
         saveWindowSettings();
     #if defined(Q_OS_WIN)
         if (AppRegistry::instance().settingsManager()->minimizeToTray() && !_allowExit) {
@@ -1214,6 +1433,39 @@ namespace Robomongo
 #endif
     }
 
+    void MainWindow::paintEvent(QPaintEvent *event)
+    {
+        BaseClass::paintEvent(event);
+        if (_isFirstFramePainted)
+            return;
+
+        _isFirstFramePainted = true;
+        StartupProfile::mark("first frame");
+        QTimer::singleShot(0, this, SLOT(createDeferredWidgets()));
+    }
+
+    void MainWindow::createDeferredWidgets()
+    {
+        {
+            StartupProfile::Scope phase("welcome tab");
+            _workArea->createWelcomeTab();
+            updateMenus();
+        }
+
+        StartupProfile::finish();
+        if (StartupProfile::enabled()) {
+            LOG_MSG("Startup profile (start, duration, phase):", mongo::logger::LogSeverity::Info());
+            for (QString const &line : QtUtils::toQString(StartupProfile::report()).split('\n', QString::SkipEmptyParts))
+                LOG_MSG(line, mongo::logger::LogSeverity::Info());
+        }
+    }
+
+    void MainWindow::createPerformanceWidget(bool visible)
+    {
+        if (visible && !_performanceDock->widget())
+            _performanceDock->setWidget(new PerformanceWidget(this));
+    }
+
     bool MainWindow::eventFilter(QObject *target, QEvent *event)
     {
         auto closeUpdatesBarButton = qobject_cast<QPushButton*>(target);
@@ -1245,10 +1497,12 @@ namespace Robomongo
 
     void MainWindow::createDatabaseExplorer()
     {
+        StartupProfile::Scope phase("explorer and docks");
         _explorer = new ExplorerWidget(this);
         AppRegistry::instance().bus()->subscribe(_explorer, ConnectingEvent::Type);
         AppRegistry::instance().bus()->subscribe(_explorer, ConnectionFailedEvent::Type);
         AppRegistry::instance().bus()->subscribe(_explorer, ConnectionEstablishedEvent::Type);
+        AppRegistry::instance().bus()->subscribe(_explorer, ConnectionStartupEvent::Type);
 
         QDockWidget *explorerDock = new QDockWidget(tr("Database Explorer"));
         explorerDock->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
@@ -1292,6 +1546,21 @@ namespace Robomongo
         _viewMenu->addAction(action);
         
         addDockWidget(Qt::BottomDockWidgetArea, _logDock);
+
+        _performanceDock = new QDockWidget(tr("Performance"));
+        _performanceDock->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea | Qt::BottomDockWidgetArea | Qt::TopDockWidgetArea);
+        // Panel is created once shown, it is not needed for the first frame
+        VERIFY(connect(_performanceDock, SIGNAL(visibilityChanged(bool)), this, SLOT(createPerformanceWidget(bool))));
+        _performanceDock->setFeatures(QDockWidget::DockWidgetClosable);
+        _performanceDock->setVisible(false);
+
+        QAction *performanceAction = _performanceDock->toggleViewAction();
+        performanceAction->setText(QString("&Performance"));
+        performanceAction->setChecked(_performanceDock->isVisible());
+        _viewMenu->addAction(performanceAction);
+
+        addDockWidget(Qt::BottomDockWidgetArea, _performanceDock);
+        tabifyDockWidget(_logDock, _performanceDock);
     }
 
     void MainWindow::updateMenus()
@@ -1313,12 +1582,14 @@ namespace Robomongo
 
         _execToolBar->setEnabled(isEnable);
         _openAction->setEnabled(isEnable);
+        _runFileAction->setEnabled(isEnable);
         _saveAction->setEnabled(isEnable);
         _saveAsAction->setEnabled(isEnable);
     }
 
     void MainWindow::createTabs()
     {
+        StartupProfile::Scope phase("tabs");
         _workArea = new WorkAreaTabWidget(this);
         AppRegistry::instance().bus()->subscribe(_workArea, OpeningShellEvent::Type);
         VERIFY(connect(_workArea, SIGNAL(currentChanged(int)), this, SLOT(updateMenus())));
@@ -14,8 +14,11 @@ class QNetworkReply;
 class QNetworkAccessManager;
 QT_END_NAMESPACE
 
+#include "robomongo/core/domain/WorkspaceSnapshot.h"
+
 namespace Robomongo
 {
+    struct ConnectionEstablishedEvent;
     class ConnectionFailedEvent;
     class ScriptExecutingEvent;
     class ScriptExecutedEvent;
@@ -42,6 +45,10 @@ namespace Robomongo
 
     public Q_SLOTS:
         void manageConnections();
+
+        // Opens "Connect at startup" connections and ones of saved workspace tabs,
+        // or connections dialog if there are none
+        void openStartupConnections();
         void toggleOrientation();
         void enterTextMode();
         void enterTreeMode();
@@ -56,11 +63,14 @@ namespace Robomongo
         void selectNextTab();
         void selectPrevTab();
         void duplicateTab();
+        void goToNamespace();
         void refreshConnections();
         void aboutRobomongo();
         void open();
+        void runFile();
         void save();
         void saveAs();
+        void openBsonFile();
         void changeStyle(QAction *);
         void exit();
 
@@ -72,11 +82,18 @@ namespace Robomongo
         void setShellAutocompletionNoCollectionNames();
         void setShellAutocompletionNone();
         void setLoadMongoRcJs();
+        void setProfileQueries();
+        void setParallelReads();
+        void setPrefetchPages();
+        void setSaveWorkspace();
+        void setSaveWorkspaceResults();
         void setDisableConnectionShortcuts();
 
         void toggleLogs(bool show);
         void connectToServer(QAction *action);
         void handle(ConnectionFailedEvent *event);
+        // Restores saved workspace tabs of connected server
+        void handle(ConnectionEstablishedEvent *event);
         void handle(ScriptExecutingEvent *event);
         void handle(ScriptExecutedEvent *event);
         void handle(QueryWidgetUpdatedEvent *event);
@@ -87,6 +104,7 @@ namespace Robomongo
         void closeEvent(QCloseEvent *event) override;
         void hideEvent(QHideEvent *event) override;
         void showEvent(QShowEvent *event) override;
+        void paintEvent(QPaintEvent *event) override;
         bool eventFilter(QObject *target, QEvent *event) override;
         void resizeEvent(QResizeEvent* event) override;
         
@@ -94,9 +112,16 @@ namespace Robomongo
         void updateMenus();
         void setUtcTimeZone();
         void setLocalTimeZone();
+        void setShellJsonOutput();
+        void setRelaxedJsonOutput();
+        void setCompactJsonOutput();
         void openPreferences();
         void openWelcomeTab();
 
+        // Parts of window not needed for the first frame, created once it is painted
+        void createDeferredWidgets();
+        void createPerformanceWidget(bool visible);
+
         void onConnectToolbarVisibilityChanged(bool isVisisble);
         void onOpenSaveToolbarVisibilityChanged(bool isVisisble);
         void onExecToolbarVisibilityChanged(bool isVisisble);
@@ -128,9 +153,13 @@ namespace Robomongo
         void adjustUpdatesBarHeight();
 
         QDockWidget *_logDock;
+        QDockWidget *_performanceDock;
 
         WorkAreaTabWidget *_workArea;
 
+        // Saved workspace tabs, whose connections are not established yet
+        std::vector<WorkspaceSnapshot::Tab> _pendingTabs;
+
         ExplorerWidget* _explorer;
 
         App *_app;
@@ -142,6 +171,7 @@ namespace Robomongo
         QAction *_connectAction;
         // Open/Save tool bar
         QAction *_openAction;
+        QAction *_runFileAction;
         QAction *_saveAction;
         QAction *_saveAsAction;
         // Execution tool bar
@@ -160,6 +190,7 @@ namespace Robomongo
 #endif
 
         bool _allowExit;
+        bool _isFirstFramePainted;
         bool _updateMenusAtStart = true;
     };
 
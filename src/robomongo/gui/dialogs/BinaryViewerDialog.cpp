@@ -0,0 +1,102 @@
+#include "robomongo/gui/dialogs/BinaryViewerDialog.h"
+
+#include <algorithm>
+
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+#include "robomongo/core/HexUtils.h"
+#include "robomongo/core/domain/MongoUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/gui/GuiRegistry.h"
+
+namespace Robomongo
+{
+    BinaryViewerDialog::BinaryViewerDialog(const QString &name, const char *data, int length, QWidget *parent) :
+        QDialog(parent),
+        _data(data, length),
+        _offset(0)
+    {
+        setWindowTitle(QString("Binary %1 (%2 bytes)").arg(name).arg(length));
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(720, 600);
+
+        _text = new QPlainTextEdit;
+        _text->setReadOnly(true);
+        _text->setLineWrapMode(QPlainTextEdit::NoWrap);
+        _text->setFont(GuiRegistry::instance().font());
+
+        _firstButton = new QPushButton("<< First");
+        _previousButton = new QPushButton("< Previous");
+        _nextButton = new QPushButton("Next >");
+        _lastButton = new QPushButton("Last >>");
+        _positionLabel = new QLabel;
+
+        auto pagingLayout = new QHBoxLayout;
+        pagingLayout->addWidget(_firstButton);
+        pagingLayout->addWidget(_previousButton);
+        pagingLayout->addWidget(_positionLabel, 1, Qt::AlignCenter);
+        pagingLayout->addWidget(_nextButton);
+        pagingLayout->addWidget(_lastButton);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_firstButton, SIGNAL(clicked()), this, SLOT(showFirst())));
+        VERIFY(connect(_previousButton, SIGNAL(clicked()), this, SLOT(showPrevious())));
+        VERIFY(connect(_nextButton, SIGNAL(clicked()), this, SLOT(showNext())));
+        VERIFY(connect(_lastButton, SIGNAL(clicked()), this, SLOT(showLast())));
+
+        auto layout = new QVBoxLayout;
+        layout->addWidget(_text, 1);
+        layout->addLayout(pagingLayout);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        showWindow(0);
+    }
+
+    void BinaryViewerDialog::showPrevious()
+    {
+        showWindow(_offset - WindowBytes);
+    }
+
+    void BinaryViewerDialog::showNext()
+    {
+        showWindow(_offset + WindowBytes);
+    }
+
+    void BinaryViewerDialog::showFirst()
+    {
+        showWindow(0);
+    }
+
+    void BinaryViewerDialog::showLast()
+    {
+        showWindow((std::max(0, _data.size() - 1) / WindowBytes) * WindowBytes);
+    }
+
+    void BinaryViewerDialog::showWindow(int offset)
+    {
+        int const size = _data.size();
+        _offset = std::max(0, std::min(offset, (std::max(0, size - 1) / WindowBytes) * WindowBytes));
+        int const count = std::min(WindowBytes, size - _offset);
+
+        _text->setPlainText(QtUtils::toQString(HexUtils::hexDump(_data.constData() + _offset, count, _offset)));
+        _positionLabel->setText(size == 0 ? QString("Empty")
+                                          : QString("Bytes %1 - %2 of %3 (%4)")
+                                                .arg(_offset).arg(_offset + count - 1).arg(size)
+                                                .arg(MongoUtils::buildNiceSizeString(size)));
+
+        bool const atStart = _offset == 0;
+        bool const atEnd = _offset + count >= size;
+        _firstButton->setEnabled(!atStart);
+        _previousButton->setEnabled(!atStart);
+        _nextButton->setEnabled(!atEnd);
+        _lastButton->setEnabled(!atEnd);
+    }
+}
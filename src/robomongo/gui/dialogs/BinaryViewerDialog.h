@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDialog>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QPlainTextEdit;
+class QPushButton;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    /**
+     * @brief Hex dump of BinData value, one window of WindowBytes at a time. Views of
+     *        documents show only a short prefix of binary values, whole value is
+     *        formatted here page by page, on demand.
+     */
+    class BinaryViewerDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        static const int WindowBytes = 16 * 1024;
+
+        /**
+         * @param data Bytes of value, copied so that dialog outlives the result it was opened from
+         */
+        BinaryViewerDialog(const QString &name, const char *data, int length, QWidget *parent = 0);
+
+    private Q_SLOTS:
+        void showPrevious();
+        void showNext();
+        void showFirst();
+        void showLast();
+
+    private:
+        void showWindow(int offset);
+
+        QByteArray const _data;
+        int _offset;
+
+        QPlainTextEdit *_text;
+        QLabel *_positionLabel;
+        QPushButton *_firstButton;
+        QPushButton *_previousButton;
+        QPushButton *_nextButton;
+        QPushButton *_lastButton;
+    };
+}
@@ -0,0 +1,270 @@
+#include "robomongo/gui/dialogs/CacheResidencyDialog.h"
+
+#include <algorithm>
+
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/MongoUtils.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            NameColumn, CachedColumn, SizeColumn, ResidencyColumn, ShareColumn, ReadColumn,
+            ColumnCount
+        };
+
+        // Share of cache held by the collections and indexes listed as hot
+        const double HotShare = 0.8;
+        const size_t MaxHotNames = 10;
+
+        // Items sort by numbers stored in UserRole, not by display text
+        class ResidencyItem : public QTreeWidgetItem
+        {
+        public:
+            explicit ResidencyItem(QTreeWidget *parent) : QTreeWidgetItem(parent) {}
+            explicit ResidencyItem(QTreeWidgetItem *parent) : QTreeWidgetItem(parent) {}
+
+            bool operator<(const QTreeWidgetItem &other) const override
+            {
+                int const column = treeWidget()->sortColumn();
+                QVariant const left = data(column, Qt::UserRole);
+                if (!left.isValid())
+                    return QTreeWidgetItem::operator<(other);
+                return left.toDouble() < other.data(column, Qt::UserRole).toDouble();
+            }
+
+            void setNumber(int column, const QString &text, double number)
+            {
+                setText(column, text);
+                setData(column, Qt::UserRole, number);
+                setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+            }
+
+            void setItem(const CacheResidency::Item &item)
+            {
+                setNumber(CachedColumn, MongoUtils::buildNiceSizeString(item.cachedBytes), item.cachedBytes);
+                setNumber(SizeColumn, MongoUtils::buildNiceSizeString(item.sizeBytes), item.sizeBytes);
+                double const residency = CacheResidency::residency(item);
+                setNumber(ResidencyColumn, QString::number(100 * residency, 'f', 1) + " %", residency);
+                setNumber(ReadColumn, MongoUtils::buildNiceSizeString(item.readIntoCacheBytes),
+                          item.readIntoCacheBytes);
+            }
+        };
+
+        QString collectionName(const std::string &ns)
+        {
+            QString const name = QtUtils::toQString(ns);
+            return name.mid(name.indexOf('.') + 1);
+        }
+
+        QString itemName(const CacheResidency::Item &item)
+        {
+            return collectionName(item.ns) + (item.index.empty() ? QString() : " index " + QtUtils::toQString(item.index));
+        }
+    }
+
+    CacheResidencyDialog::CacheResidencyDialog(MongoServer *server, const QString &dbName, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _statsId(0)
+    {
+        setWindowTitle("Cache Residency of " + dbName);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(900, 600);
+
+        AppRegistry::instance().bus()->subscribe(this, DatabaseStatsProgressEvent::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, DatabaseStatsResponse::Type, server);
+
+        _summaryLabel = new QLabel;
+        _summaryLabel->setWordWrap(true);
+        _summaryLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        _tree = new QTreeWidget;
+        _tree->setColumnCount(ColumnCount);
+        _tree->setHeaderLabels(QStringList() << "Collection / index" << "In cache" << "Size" << "Cached"
+                                             << "% of cache" << "Read into cache");
+        _tree->headerItem()->setToolTip(SizeColumn, "Uncompressed data size of collection, file size of index");
+        _tree->headerItem()->setToolTip(ResidencyColumn, "Bytes in cache to size");
+        _tree->headerItem()->setToolTip(ShareColumn, "Share of cache used by this database");
+        _tree->headerItem()->setToolTip(ReadColumn, "Bytes read into cache since server start");
+        _tree->setUniformRowHeights(true);
+        _tree->setSortingEnabled(true);
+        _tree->sortByColumn(CachedColumn, Qt::DescendingOrder);
+        _tree->header()->resizeSection(NameColumn, 300);
+
+        _progressBar = new QProgressBar;
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        _refreshButton = new QPushButton("Refresh");
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        buttonBox->addButton(_refreshButton, QDialogButtonBox::ActionRole);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_refreshButton, SIGNAL(clicked()), this, SLOT(refresh())));
+
+        auto layout = new QVBoxLayout;
+        layout->addWidget(_summaryLabel);
+        layout->addWidget(_tree, 1);
+        layout->addWidget(_progressBar);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        refresh();
+    }
+
+    CacheResidencyDialog::~CacheResidencyDialog()
+    {
+        // Statistics of closed dialog are not read further
+        if (_cancelled)
+            *_cancelled = true;
+    }
+
+    void CacheResidencyDialog::refresh()
+    {
+        if (_statsId)
+            return;
+
+        _items.clear();
+        _tree->clear();
+        _summaryLabel->clear();
+        _statusLabel->setText("Reading statistics...");
+        _progressBar->setRange(0, 0);
+        _progressBar->show();
+        _refreshButton->setEnabled(false);
+
+        static int lastStatsId = 0;
+        _statsId = ++lastStatsId;
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+        _server->databaseStats(_statsId, QtUtils::toStdString(_dbName), _cancelled, true);
+    }
+
+    void CacheResidencyDialog::handle(DatabaseStatsProgressEvent *event)
+    {
+        if (event->statsId != _statsId)
+            return;
+
+        _progressBar->setRange(0, event->total);
+        _progressBar->setValue(event->done);
+
+        _tree->setSortingEnabled(false);
+        for (MongoDocumentPtr const &stats : event->collections)
+            addCollection(CacheResidency::itemsOf(stats->bsonObj()));
+        _tree->setSortingEnabled(true);
+    }
+
+    void CacheResidencyDialog::handle(DatabaseStatsResponse *event)
+    {
+        if (event->statsId != _statsId)
+            return;
+
+        _statsId = 0;
+        _cancelled.reset();
+        _progressBar->hide();
+        _refreshButton->setEnabled(true);
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        updateSummary();
+        QString text = QString("Read in %1 s.").arg(event->elapsedMs / 1000.0, 0, 'f', 1);
+        if (event->skipped > 0)
+            text += QString(" %1 views or collections without access rights have no statistics.")
+                .arg(event->skipped);
+        _statusLabel->setText(text);
+    }
+
+    void CacheResidencyDialog::addCollection(const std::vector<CacheResidency::Item> &items)
+    {
+        // Not WiredTiger
+        if (items.empty())
+            return;
+
+        // Collection row sums its data and indexes, children show them one by one
+        CacheResidency::Item total;
+        total.ns = items.front().ns;
+        for (CacheResidency::Item const &item : items) {
+            total.cachedBytes += item.cachedBytes;
+            total.sizeBytes += item.sizeBytes;
+            total.readIntoCacheBytes += item.readIntoCacheBytes;
+        }
+
+        auto collectionItem = new ResidencyItem(_tree);
+        collectionItem->setText(NameColumn, collectionName(total.ns));
+        collectionItem->setItem(total);
+        for (CacheResidency::Item const &item : items) {
+            auto child = new ResidencyItem(collectionItem);
+            child->setText(NameColumn, item.index.empty() ? QString("data") : QtUtils::toQString(item.index));
+            child->setItem(item);
+        }
+
+        _items.insert(_items.end(), items.begin(), items.end());
+    }
+
+    void CacheResidencyDialog::updateSummary()
+    {
+        if (_items.empty()) {
+            _summaryLabel->setText("No WiredTiger cache statistics, storage engine of server is not WiredTiger.");
+            return;
+        }
+
+        CacheResidency::rank(_items);
+        long long totalCached = 0;
+        for (CacheResidency::Item const &item : _items)
+            totalCached += item.cachedBytes;
+
+        // Share of cache is known only when all collections are read
+        auto const setShare = [totalCached](QTreeWidgetItem *item) {
+            double const share = totalCached > 0 ? item->data(CachedColumn, Qt::UserRole).toDouble() / totalCached : 0.0;
+            static_cast<ResidencyItem *>(item)->setNumber(ShareColumn, QString::number(100 * share, 'f', 1) + " %", share);
+        };
+
+        _tree->setSortingEnabled(false);
+        for (int i = 0; i < _tree->topLevelItemCount(); ++i) {
+            QTreeWidgetItem *collectionItem = _tree->topLevelItem(i);
+            setShare(collectionItem);
+            for (int j = 0; j < collectionItem->childCount(); ++j)
+                setShare(collectionItem->child(j));
+        }
+        _tree->setSortingEnabled(true);
+
+        size_t const hot = CacheResidency::hotCount(_items, HotShare);
+        if (hot == 0) {
+            _summaryLabel->setText("Nothing of this database is in cache.");
+            return;
+        }
+
+        QStringList names;
+        for (size_t i = 0; i < std::min(hot, MaxHotNames); ++i) {
+            names << QString("<b>%1</b> %2").arg(itemName(_items[i]).toHtmlEscaped(),
+                                                 MongoUtils::buildNiceSizeString(_items[i].cachedBytes));
+        }
+        if (hot > MaxHotNames)
+            names << QString("and %1 more").arg(hot - MaxHotNames);
+
+        _summaryLabel->setText(QString("%1 % of %2 in cache is held by %3 of %4 collections and indexes: %5")
+            .arg(100 * HotShare, 0, 'f', 0).arg(MongoUtils::buildNiceSizeString(totalCached))
+            .arg(hot).arg(_items.size()).arg(names.join(", ")));
+    }
+}
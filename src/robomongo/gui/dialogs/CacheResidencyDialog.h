@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QDialog>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "robomongo/core/domain/CacheResidency.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class DatabaseStatsProgressEvent;
+    class DatabaseStatsResponse;
+
+    /**
+     * @brief Bytes of every collection and index of database in WiredTiger cache against
+     *        its size (see CacheResidency). collStats with indexDetails is read on several
+     *        connections by the same loader as DatabaseStatsDialog, rows are added as they
+     *        come and a summary of the collections and indexes holding most of the cache
+     *        is shown at the end.
+     */
+    class CacheResidencyDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        CacheResidencyDialog(MongoServer *server, const QString &dbName, QWidget *parent = 0);
+        ~CacheResidencyDialog();
+
+    public Q_SLOTS:
+        void handle(DatabaseStatsProgressEvent *event);
+        void handle(DatabaseStatsResponse *event);
+
+    private Q_SLOTS:
+        void refresh();
+
+    private:
+        void addCollection(const std::vector<CacheResidency::Item> &items);
+        void updateSummary();
+
+        MongoServer *const _server;
+        QString const _dbName;
+        int _statsId;                                   // 0, if statistics were read
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+        std::vector<CacheResidency::Item> _items;       // of all collections read so far
+
+        QLabel *_summaryLabel;
+        QTreeWidget *_tree;
+        QProgressBar *_progressBar;
+        QLabel *_statusLabel;
+        QPushButton *_refreshButton;
+    };
+}
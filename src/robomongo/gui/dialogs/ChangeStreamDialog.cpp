@@ -0,0 +1,407 @@
+#include "robomongo/gui/dialogs/ChangeStreamDialog.h"
+
+#include <QAbstractTableModel>
+#include <QCheckBox>
+#include <QDateTime>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QStringList>
+#include <QTableView>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/OplogTail.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/shell/bson/json.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            TimeColumn, OperationColumn, KeyColumn, ChangeColumn,
+            ColumnCount
+        };
+
+        const int MaxSummaryLength = 200;
+        const int MaxTooltipLength = 4000;
+
+        QString jsonOf(const mongo::BSONObj &obj, int maxLength)
+        {
+            QString const json = QtUtils::toQString(BsonUtils::jsonString(obj, mongo::TenGen, 0, DefaultEncoding, Utc));
+            return json.length() > maxLength ? json.left(maxLength) + "..." : json;
+        }
+
+        QString timeOf(const mongo::BSONObj &event)
+        {
+            mongo::Timestamp const ts = event["clusterTime"].timestamp();
+            return QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(ts.getSecs()) * 1000)
+                .toString("yyyy-MM-dd hh:mm:ss") + QString(" #%1").arg(ts.getInc());
+        }
+
+        // Updates show changed fields, unless the whole document was looked up
+        QString summaryOf(const mongo::BSONObj &event)
+        {
+            if (event.hasField("fullDocument") && event["fullDocument"].isABSONObj())
+                return jsonOf(event.getObjectField("fullDocument"), MaxSummaryLength);
+            if (event.hasField("updateDescription"))
+                return jsonOf(event.getObjectField("updateDescription"), MaxSummaryLength);
+            if (event.hasField("to"))
+                return "to " + jsonOf(event.getObjectField("to"), MaxSummaryLength);
+            return QString();
+        }
+
+        mongo::BSONObj parseMatch(const QString &text)
+        {
+            QString const trimmed = text.trimmed();
+            return mongo::Robomongo::fromjson(QtUtils::toStdString(trimmed.isEmpty() ? "{}" : trimmed));
+        }
+    }
+
+    /**
+     * @brief Rows of ring buffer, cells are formatted only when they are painted
+     */
+    class ChangeStreamModel : public QAbstractTableModel
+    {
+    public:
+        explicit ChangeStreamModel(size_t capacity, QObject *parent) :
+            QAbstractTableModel(parent),
+            _buffer(capacity) {}
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override
+        {
+            return parent.isValid() ? 0 : static_cast<int>(_buffer.size());
+        }
+
+        int columnCount(const QModelIndex &parent = QModelIndex()) const override
+        {
+            return parent.isValid() ? 0 : ColumnCount;
+        }
+
+        QVariant data(const QModelIndex &index, int role) const override
+        {
+            if (!index.isValid() || index.row() >= rowCount())
+                return QVariant();
+
+            mongo::BSONObj const &event = _buffer.at(index.row());
+            if (role == Qt::ToolTipRole) {
+                QString tooltip = QtUtils::toQString(
+                    BsonUtils::jsonString(event, mongo::TenGen, 1, DefaultEncoding, Utc));
+                return tooltip.length() > MaxTooltipLength ? tooltip.left(MaxTooltipLength) + "\n..." : tooltip;
+            }
+
+            if (role != Qt::DisplayRole)
+                return QVariant();
+
+            switch (index.column()) {
+            case TimeColumn: return timeOf(event);
+            case OperationColumn: return QtUtils::toQString(ChangeStreamWatch::operationType(event));
+            case KeyColumn: return jsonOf(event.getObjectField("documentKey"), MaxSummaryLength);
+            case ChangeColumn: return summaryOf(event);
+            default: return QVariant();
+            }
+        }
+
+        QVariant headerData(int section, Qt::Orientation orientation, int role) const override
+        {
+            if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+                return QVariant();
+
+            switch (section) {
+            case TimeColumn: return "Time";
+            case OperationColumn: return "Operation";
+            case KeyColumn: return "Document Key";
+            case ChangeColumn: return "Change";
+            default: return QVariant();
+            }
+        }
+
+        void append(std::vector<mongo::BSONObj> events)
+        {
+            if (events.empty())
+                return;
+
+            // More than fits, only the newest ones are kept
+            if (events.size() > _buffer.capacity())
+                events.erase(events.begin(), events.end() - _buffer.capacity());
+
+            size_t const overflow = _buffer.size() + events.size() > _buffer.capacity() ?
+                                    _buffer.size() + events.size() - _buffer.capacity() : 0;
+            if (overflow > 0) {
+                beginRemoveRows(QModelIndex(), 0, static_cast<int>(overflow) - 1);
+                _buffer.dropOldest(overflow);
+                endRemoveRows();
+            }
+
+            int const first = rowCount();
+            beginInsertRows(QModelIndex(), first, first + static_cast<int>(events.size()) - 1);
+            _buffer.append(events);
+            endInsertRows();
+        }
+
+        void clear()
+        {
+            beginResetModel();
+            _buffer.clear();
+            endResetModel();
+        }
+
+    private:
+        OplogTail::Buffer _buffer;
+    };
+
+    ChangeStreamDialog::ChangeStreamDialog(MongoServer *server, const QString &dbName, const QString &collectionName,
+                                           QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _collectionName(collectionName),
+        _watchId(0),
+        _received(0),
+        _lastStatusMs(0)
+    {
+        setWindowTitle("Changes of " + dbName + "." + collectionName);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(1000, 600);
+
+        AppRegistry::instance().bus()->subscribe(this, ChangeEventsEvent::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, WatchCollectionResponse::Type, server);
+
+        auto filterLayout = new QHBoxLayout;
+        for (auto const &type : { "insert", "update", "replace", "delete" }) {
+            auto checkBox = new QCheckBox(type);
+            checkBox->setChecked(true);
+            _operations.push_back(std::make_pair(checkBox, std::string(type)));
+            filterLayout->addWidget(checkBox);
+            VERIFY(connect(checkBox, SIGNAL(toggled(bool)), this, SLOT(applyFilter())));
+        }
+        _fullDocument = new QCheckBox("Full document of updates");
+        _fullDocument->setToolTip("Server looks up the current document for every update, which costs a read each");
+        filterLayout->addWidget(_fullDocument);
+        filterLayout->addStretch(1);
+        VERIFY(connect(_fullDocument, SIGNAL(toggled(bool)), this, SLOT(applyFilter())));
+
+        _match = new QLineEdit;
+        _match->setPlaceholderText("{ \"fullDocument.status\": \"A\" }");
+        _match->setToolTip("$match on change events, only matching ones are read from server");
+        _applyButton = new QPushButton("Apply");
+        _follow = new QCheckBox("Follow");
+        _follow->setChecked(true);
+        _pauseButton = new QPushButton("Pause");
+        _pauseButton->setCheckable(true);
+        _clearButton = new QPushButton("Clear");
+
+        auto matchLayout = new QHBoxLayout;
+        matchLayout->addWidget(new QLabel("Match:"));
+        matchLayout->addWidget(_match, 1);
+        matchLayout->addWidget(_applyButton);
+        matchLayout->addWidget(_follow);
+        matchLayout->addWidget(_pauseButton);
+        matchLayout->addWidget(_clearButton);
+
+        _ratesLabel = new QLabel;
+        _ratesLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        _model = new ChangeStreamModel(MaxEvents, this);
+        _view = new QTableView;
+        _view->setModel(_model);
+        _view->setSelectionBehavior(QAbstractItemView::SelectRows);
+        _view->setWordWrap(false);
+        _view->verticalHeader()->hide();
+        // Fixed rows, so that view does not measure inserted rows
+        _view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+        _view->verticalHeader()->setDefaultSectionSize(_view->fontMetrics().height() + 4);
+        _view->horizontalHeader()->setStretchLastSection(true);
+        _view->setColumnWidth(TimeColumn, 190);
+        _view->setColumnWidth(OperationColumn, 80);
+        _view->setColumnWidth(KeyColumn, 250);
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(filterLayout);
+        layout->addLayout(matchLayout);
+        layout->addWidget(_ratesLabel);
+        layout->addWidget(_view, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        _timer = new QTimer(this);
+        _timer->setInterval(RepaintIntervalMs);
+
+        VERIFY(connect(_timer, SIGNAL(timeout()), this, SLOT(applyPending())));
+        VERIFY(connect(_applyButton, SIGNAL(clicked()), this, SLOT(applyFilter())));
+        VERIFY(connect(_match, SIGNAL(returnPressed()), this, SLOT(applyFilter())));
+        VERIFY(connect(_pauseButton, SIGNAL(toggled(bool)), this, SLOT(togglePause(bool))));
+        VERIFY(connect(_clearButton, SIGNAL(clicked()), this, SLOT(clear())));
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+
+        _clock.start();
+        _timer->start();
+        startWatch();
+    }
+
+    ChangeStreamDialog::~ChangeStreamDialog()
+    {
+        stopWatch();
+    }
+
+    void ChangeStreamDialog::handle(ChangeEventsEvent *event)
+    {
+        if (event->watchId != _watchId)
+            return;
+
+        // Applied with the next repaint, only what fits in the view is kept meanwhile
+        _pending.insert(_pending.end(), event->events.begin(), event->events.end());
+        size_t const maxEvents = MaxEvents;
+        if (_pending.size() > maxEvents)
+            _pending.erase(_pending.begin(), _pending.end() - maxEvents);
+
+        qint64 const now = _clock.elapsed();
+        for (auto const &changeEvent : event->events)
+            _meter.add(ChangeStreamWatch::operationType(changeEvent), now);
+
+        if (!event->events.empty()) {
+            mongo::BSONObj const &last = event->events.back();
+            // Invalidated stream cannot be resumed, the next one starts from now
+            _resumeToken = ChangeStreamWatch::operationType(last) == "invalidate" ?
+                           mongo::BSONObj() : last.getObjectField("_id").getOwned();
+        }
+        _received += event->events.size();
+    }
+
+    void ChangeStreamDialog::handle(WatchCollectionResponse *event)
+    {
+        if (event->watchId != _watchId)
+            return;
+
+        if (event->isError())
+            _error = QtUtils::toQString(event->error().errorMessage());
+        _cancelled.reset();
+        updateStatus();
+    }
+
+    void ChangeStreamDialog::applyPending()
+    {
+        if (!_pending.empty()) {
+            std::vector<mongo::BSONObj> events;
+            events.swap(_pending);
+            _model->append(std::move(events));
+            if (_follow->isChecked())
+                _view->scrollToBottom();
+        }
+
+        if (_clock.elapsed() - _lastStatusMs >= 1000)
+            updateStatus();
+    }
+
+    void ChangeStreamDialog::applyFilter()
+    {
+        // Events shown so far are kept, new ones match the filter
+        if (!_pauseButton->isChecked())
+            startWatch();
+    }
+
+    void ChangeStreamDialog::togglePause(bool paused)
+    {
+        _pauseButton->setText(paused ? "Resume" : "Pause");
+        if (paused) {
+            stopWatch();
+            updateStatus();
+        }
+        else {
+            startWatch();
+        }
+    }
+
+    void ChangeStreamDialog::clear()
+    {
+        _pending.clear();
+        _model->clear();
+        _meter.clear();
+        _received = 0;
+        updateStatus();
+    }
+
+    void ChangeStreamDialog::startWatch()
+    {
+        ChangeStreamWatch::Filter filter;
+        try {
+            filter.match = parseMatch(_match->text());
+        } catch (const std::exception &ex) {
+            _error = "Match is not valid JSON: " + QtUtils::toQString(ex.what());
+            updateStatus();
+            return;
+        }
+
+        stopWatch();
+
+        for (auto const &op : _operations) {
+            if (op.first->isChecked())
+                filter.operationTypes.push_back(op.second);
+        }
+        // Nothing is unchecked, so filter by operation is not needed
+        if (filter.operationTypes.size() == _operations.size())
+            filter.operationTypes.clear();
+        filter.fullDocument = _fullDocument->isChecked();
+        // Events between pause and resume are not lost, if they are still in the oplog
+        filter.resumeAfter = _resumeToken;
+
+        static int lastWatchId = 0;
+        _watchId = ++lastWatchId;
+        _error.clear();
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+        _server->watchCollection(_watchId, MongoNamespace(QtUtils::toStdString(_dbName),
+                                                          QtUtils::toStdString(_collectionName)),
+                                 filter, _cancelled);
+        updateStatus();
+    }
+
+    void ChangeStreamDialog::stopWatch()
+    {
+        // Worker closes the stream within WatchCollectionRequest::AwaitMs
+        if (_cancelled)
+            *_cancelled = true;
+        _cancelled.reset();
+    }
+
+    void ChangeStreamDialog::updateStatus()
+    {
+        qint64 const now = _clock.elapsed();
+        _lastStatusMs = now;
+
+        QStringList rates;
+        for (auto const &rate : _meter.rates(now)) {
+            rates << QString("%1: <b>%2/s</b> (%3)")
+                .arg(QtUtils::toQString(rate.operationType))
+                .arg(rate.perSecond, 0, 'f', 1)
+                .arg(rate.total);
+        }
+        _ratesLabel->setText(rates.isEmpty() ? "No events yet" : rates.join("&nbsp;&nbsp;&nbsp;"));
+
+        QString text = QString("%1 events shown of %2 received").arg(_model->rowCount()).arg(_received);
+        if (_cancelled)
+            text += QString(", rates over the last %1 s.").arg(ChangeStreamWatch::RateMeter::WindowSeconds);
+        else
+            text += _pauseButton->isChecked() ? ". Paused." : ". Stopped.";
+        if (!_error.isEmpty())
+            text += " " + _error;
+        _statusLabel->setText(text);
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QDialog>
+#include <QElapsedTimer>
+#include <mongo/bson/bsonobj.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "robomongo/core/domain/ChangeStreamWatch.h"
+
+QT_BEGIN_NAMESPACE
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QPushButton;
+class QTableView;
+class QTimer;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class ChangeEventsEvent;
+    class ChangeStreamModel;
+    class WatchCollectionResponse;
+
+    /**
+     * @brief Live change stream of one collection, opened in MongoServer's worker of streams
+     *        and filtered by server with $match (see ChangeStreamWatch). Events are kept in a
+     *        ring buffer of MaxEvents and applied to the view in bulk every RepaintIntervalMs.
+     *        Rates per operation type show write load without polling queries.
+     */
+    class ChangeStreamDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        ChangeStreamDialog(MongoServer *server, const QString &dbName, const QString &collectionName,
+                           QWidget *parent = 0);
+        ~ChangeStreamDialog();
+
+    public Q_SLOTS:
+        void handle(ChangeEventsEvent *event);
+        void handle(WatchCollectionResponse *event);
+
+    private Q_SLOTS:
+        void applyPending();
+        void applyFilter();
+        void togglePause(bool paused);
+        void clear();
+
+    private:
+        static const int MaxEvents = 100000;
+        static const int RepaintIntervalMs = 100;
+
+        // Cancels current stream and opens new one after the last seen event
+        void startWatch();
+        void stopWatch();
+        void updateStatus();
+
+        MongoServer *const _server;
+        QString const _dbName;
+        QString const _collectionName;
+        int _watchId;
+        std::shared_ptr<std::atomic<bool>> _cancelled;     // of current stream, null if stopped
+
+        std::vector<std::pair<QCheckBox *, std::string>> _operations;
+        QCheckBox *_fullDocument;
+        QLineEdit *_match;
+        QPushButton *_applyButton;
+        QPushButton *_pauseButton;
+        QPushButton *_clearButton;
+        QCheckBox *_follow;
+        QLabel *_ratesLabel;
+        QTableView *_view;
+        QLabel *_statusLabel;
+        QTimer *_timer;
+
+        ChangeStreamModel *_model;
+        std::vector<mongo::BSONObj> _pending;   // received since last repaint
+        mongo::BSONObj _resumeToken;            // _id of the newest received event
+        long long _received;
+        ChangeStreamWatch::RateMeter _meter;
+        QElapsedTimer _clock;
+        qint64 _lastStatusMs;
+        QString _error;
+    };
+}
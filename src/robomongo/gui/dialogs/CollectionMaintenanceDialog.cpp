@@ -0,0 +1,193 @@
+#include "robomongo/gui/dialogs/CollectionMaintenanceDialog.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column { CollectionColumn, StatusColumn, TimeColumn, ErrorColumn };
+    }
+
+    CollectionMaintenanceDialog::CollectionMaintenanceDialog(MongoServer *server, const QString &dbName,
+                                                             const std::vector<std::string> &collections,
+                                                             const CollectionMaintenance::Action &action,
+                                                             QWidget *parent) :
+        QDialog(parent), _server(server), _dbName(QtUtils::toStdString(dbName)), _action(action), _runId(0)
+    {
+        setWindowTitle(QString("%1 on %2 collections of %3")
+                       .arg(QtUtils::toQString(CollectionMaintenance::describe(action)))
+                       .arg(collections.size()).arg(dbName));
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(760, 520);
+
+        AppRegistry::instance().bus()->subscribe(this, CollectionMaintenanceProgressEvent::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, CollectionMaintenanceResponse::Type, server);
+
+        _items = new QTreeWidget;
+        _items->setRootIsDecorated(false);
+        _items->setUniformRowHeights(true);
+        _items->setHeaderLabels(QStringList() << "Collection" << "Status" << "Time" << "Error");
+        _items->header()->setStretchLastSection(true);
+
+        _progressBar = new QProgressBar;
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        _stopButton = new QPushButton("Stop");
+        _stopButton->setToolTip("Skip collections not started yet, running commands finish");
+        _retryButton = new QPushButton("Retry Failed");
+        _retryButton->setEnabled(false);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        buttonBox->addButton(_retryButton, QDialogButtonBox::ActionRole);
+        buttonBox->addButton(_stopButton, QDialogButtonBox::ActionRole);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_stopButton, SIGNAL(clicked()), this, SLOT(stop())));
+        VERIFY(connect(_retryButton, SIGNAL(clicked()), this, SLOT(retryFailed())));
+
+        auto layout = new QVBoxLayout;
+        layout->addWidget(_items, 1);
+        layout->addWidget(_progressBar);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        start(collections);
+    }
+
+    CollectionMaintenanceDialog::~CollectionMaintenanceDialog()
+    {
+        // Collections not started yet are skipped for closed dialog
+        if (_cancelled)
+            *_cancelled = true;
+    }
+
+    void CollectionMaintenanceDialog::start(const std::vector<std::string> &collections)
+    {
+        _results.clear();
+        for (auto const &collection : collections) {
+            QString const name = QtUtils::toQString(collection);
+            QTreeWidgetItem *&item = _itemsByName[name];
+            if (!item) {
+                item = new QTreeWidgetItem(_items);
+                item->setText(CollectionColumn, name);
+            }
+            item->setText(StatusColumn, "Waiting");
+            item->setText(TimeColumn, QString());
+            item->setText(ErrorColumn, QString());
+            item->setToolTip(ErrorColumn, QString());
+        }
+
+        _progressBar->setRange(0, static_cast<int>(collections.size()));
+        _progressBar->setValue(0);
+        _progressBar->show();
+        _statusLabel->setText("Running...");
+        _stopButton->setEnabled(true);
+        _retryButton->setEnabled(false);
+
+        static int lastRunId = 0;
+        _runId = ++lastRunId;
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+        _server->maintainCollections(_runId, _dbName, collections, _action, _cancelled);
+    }
+
+    void CollectionMaintenanceDialog::stop()
+    {
+        if (!_cancelled)
+            return;
+
+        *_cancelled = true;
+        _stopButton->setEnabled(false);
+        _statusLabel->setText("Stopping, waiting for running commands...");
+    }
+
+    void CollectionMaintenanceDialog::retryFailed()
+    {
+        std::vector<std::string> failed;
+        for (auto const &result : _results) {
+            if (!result.ok)
+                failed.push_back(result.collection);
+        }
+        if (!failed.empty())
+            start(failed);
+    }
+
+    void CollectionMaintenanceDialog::handle(CollectionMaintenanceProgressEvent *event)
+    {
+        if (event->runId != _runId)
+            return;
+
+        for (auto const &collection : event->started) {
+            if (QTreeWidgetItem *item = _itemsByName.value(QtUtils::toQString(collection)))
+                item->setText(StatusColumn, "Running...");
+        }
+
+        for (auto const &result : event->finished) {
+            _results.push_back(result);
+            QTreeWidgetItem *item = _itemsByName.value(QtUtils::toQString(result.collection));
+            if (!item)
+                continue;
+
+            QString const error = QtUtils::toQString(result.error);
+            item->setText(StatusColumn, result.ok ? "Done" : "Failed");
+            item->setText(TimeColumn, QString::number(result.elapsedMs / 1000.0, 'f', 2) + " s");
+            item->setText(ErrorColumn, error);
+            item->setToolTip(ErrorColumn, error);
+        }
+        _progressBar->setValue(_progressBar->value() + static_cast<int>(event->finished.size()));
+    }
+
+    void CollectionMaintenanceDialog::handle(CollectionMaintenanceResponse *event)
+    {
+        if (event->runId != _runId)
+            return;
+
+        _runId = 0;
+        _cancelled.reset();
+        _progressBar->hide();
+        _stopButton->setEnabled(false);
+
+        // Collections not started before stop
+        int skipped = 0;
+        for (QTreeWidgetItem *item : _itemsByName) {
+            if (item->text(StatusColumn) == "Waiting") {
+                item->setText(StatusColumn, "Skipped");
+                ++skipped;
+            }
+        }
+
+        std::string const failures = CollectionMaintenance::failureSummary(_results);
+        _retryButton->setEnabled(!failures.empty());
+
+        QString text;
+        if (event->isError()) {
+            text = QtUtils::toQString(event->error().errorMessage());
+        }
+        else {
+            text = QString("%1 succeeded, %2 failed in %3 s.")
+                .arg(event->succeeded).arg(event->failed).arg(event->elapsedMs / 1000.0, 0, 'f', 1);
+            if (skipped > 0)
+                text += QString(" %1 skipped.").arg(skipped);
+        }
+        if (!failures.empty())
+            text += "\n\nFailures:\n" + QtUtils::toQString(failures);
+        _statusLabel->setText(text);
+
+        emit collectionsChanged();
+    }
+}
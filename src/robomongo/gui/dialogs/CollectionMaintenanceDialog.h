@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QDialog>
+#include <QHash>
+#include <atomic>
+#include <memory>
+
+#include "robomongo/core/domain/CollectionMaintenance.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QTreeWidget;
+class QTreeWidgetItem;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class CollectionMaintenanceProgressEvent;
+    class CollectionMaintenanceResponse;
+
+    /**
+     * @brief Runs one action on collections selected in explorer (see MongoServer::maintainCollections())
+     *        and shows state of every collection as it finishes, with summary of failures at the end.
+     *        Failed collections may be run again.
+     */
+    class CollectionMaintenanceDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        CollectionMaintenanceDialog(MongoServer *server, const QString &dbName,
+                                    const std::vector<std::string> &collections,
+                                    const CollectionMaintenance::Action &action, QWidget *parent = 0);
+        ~CollectionMaintenanceDialog();
+
+    Q_SIGNALS:
+        // Emitted when a run finishes, collections (or their indexes) may be changed
+        void collectionsChanged();
+
+    public Q_SLOTS:
+        void handle(CollectionMaintenanceProgressEvent *event);
+        void handle(CollectionMaintenanceResponse *event);
+
+    private Q_SLOTS:
+        void stop();
+        void retryFailed();
+
+    private:
+        void start(const std::vector<std::string> &collections);
+
+        MongoServer *_server;
+        std::string _dbName;
+        CollectionMaintenance::Action const _action;
+
+        QTreeWidget *_items;
+        QProgressBar *_progressBar;
+        QLabel *_statusLabel;
+        QPushButton *_stopButton;
+        QPushButton *_retryButton;
+
+        QHash<QString, QTreeWidgetItem *> _itemsByName;
+        std::vector<CollectionMaintenance::ItemResult> _results;     // of current run
+        int _runId;                                                   // 0, if not running
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+}
@@ -0,0 +1,260 @@
+#include "robomongo/gui/dialogs/CompareCollectionsDialog.h"
+
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/App.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            DifferenceColumn, IdColumn, ColumnCount
+        };
+
+        // _id in shell syntax, data of items of differences
+        const int IdRole = Qt::UserRole + 1;
+
+        QString differenceText(CollectionComparison::DifferenceKind kind)
+        {
+            switch (kind) {
+            case CollectionComparison::MissingInTarget: return "Missing in target";
+            case CollectionComparison::OnlyInTarget: return "Only in target";
+            case CollectionComparison::Changed: return "Changed";
+            default: return QString();
+            }
+        }
+    }
+
+    CompareCollectionsDialog::CompareCollectionsDialog(MongoServer *server, const QString &dbName,
+                                                       const QString &collectionName, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _collectionName(collectionName),
+        _compareId(0)
+    {
+        setWindowTitle("Compare " + dbName + "." + collectionName);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(700, 500);
+
+        AppRegistry::instance().bus()->subscribe(this, CompareCollectionsProgressEvent::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, CompareCollectionsResponse::Type, server);
+
+        _serverComboBox = new QComboBox;
+        _databaseComboBox = new QComboBox;
+        _collectionEdit = new QLineEdit(collectionName);
+        _compareButton = new QPushButton("Compare");
+        _compareButton->setDefault(true);
+        VERIFY(connect(_serverComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(updateDatabaseComboBox(int))));
+
+        auto targetLayout = new QHBoxLayout;
+        targetLayout->addWidget(new QLabel("Target:"));
+        targetLayout->addWidget(_serverComboBox, 1);
+        targetLayout->addWidget(_databaseComboBox, 1);
+        targetLayout->addWidget(_collectionEdit, 1);
+        targetLayout->addWidget(_compareButton);
+
+        _differences = new QTreeWidget;
+        _differences->setColumnCount(ColumnCount);
+        _differences->setHeaderLabels(QStringList() << "Difference" << "_id");
+        _differences->setRootIsDecorated(false);
+        _differences->setUniformRowHeights(true);
+        _differences->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+        _progressBar = new QProgressBar;
+        _progressBar->hide();
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        _openButton = buttonBox->addButton("Open in Shell", QDialogButtonBox::ActionRole);
+        _openButton->setToolTip("Opens source documents of selected differences (all, if none is selected)");
+        _openButton->setEnabled(false);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_openButton, SIGNAL(clicked()), this, SLOT(openSelected())));
+        VERIFY(connect(_compareButton, SIGNAL(clicked()), this, SLOT(compare())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(targetLayout);
+        layout->addWidget(_differences, 1);
+        layout->addWidget(_progressBar);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        // Target is to be connected already, the same as for copy of collection
+        int current = 0;
+        for (auto const &connected : AppRegistry::instance().app()->getServers()) {
+            if (!connected->isConnected())
+                continue;
+
+            if (connected.get() == server)
+                current = static_cast<int>(_servers.size());
+            _servers.push_back(connected.get());
+            _serverComboBox->addItem(QtUtils::toQString(connected->connectionRecord()->connectionName()));
+        }
+        _serverComboBox->setCurrentIndex(current);
+        updateDatabaseComboBox(current);
+    }
+
+    CompareCollectionsDialog::~CompareCollectionsDialog()
+    {
+        // Collections of closed dialog are not read further
+        cancel();
+    }
+
+    void CompareCollectionsDialog::cancel()
+    {
+        if (_cancelled)
+            *_cancelled = true;
+        _cancelled.reset();
+    }
+
+    void CompareCollectionsDialog::updateDatabaseComboBox(int index)
+    {
+        _databaseComboBox->clear();
+        if (index < 0 || index >= static_cast<int>(_servers.size()))
+            return;
+
+        _databaseComboBox->addItems(_servers[index]->getDatabasesNames());
+        int const same = _databaseComboBox->findText(_dbName);
+        if (same >= 0)
+            _databaseComboBox->setCurrentIndex(same);
+    }
+
+    void CompareCollectionsDialog::compare()
+    {
+        int const index = _serverComboBox->currentIndex();
+        QString const database = _databaseComboBox->currentText();
+        QString const collection = _collectionEdit->text().trimmed();
+        if (index < 0 || index >= static_cast<int>(_servers.size()) || database.isEmpty() || collection.isEmpty())
+            return;
+
+        MongoServer *const target = _servers[index];
+        if (target == _server && database == _dbName && collection == _collectionName) {
+            _statusLabel->setText("Select other collection to compare with.");
+            return;
+        }
+
+        cancel();
+
+        static int lastCompareId = 0;
+        _compareId = ++lastCompareId;
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+
+        _compareButton->setEnabled(false);
+        _openButton->setEnabled(false);
+        _differences->clear();
+        _progressBar->setRange(0, 0);
+        _progressBar->show();
+        _statusLabel->setText("Comparing...");
+        _server->compareCollections(_compareId,
+                                    MongoNamespace(QtUtils::toStdString(_dbName), QtUtils::toStdString(_collectionName)),
+                                    target,
+                                    MongoNamespace(QtUtils::toStdString(database), QtUtils::toStdString(collection)),
+                                    _cancelled);
+    }
+
+    void CompareCollectionsDialog::handle(CompareCollectionsProgressEvent *event)
+    {
+        if (event->compareId != _compareId)
+            return;
+
+        _progressBar->setRange(0, event->ranges);
+        _progressBar->setValue(event->rangesCompared);
+        _statusLabel->setText(QString("%1 of %2 ranges of _id compared, %3 differ.")
+            .arg(event->rangesCompared).arg(event->ranges).arg(event->mismatchedRanges));
+    }
+
+    void CompareCollectionsDialog::handle(CompareCollectionsResponse *event)
+    {
+        if (event->compareId != _compareId)
+            return;
+
+        _compareId = 0;
+        _cancelled.reset();
+        _compareButton->setEnabled(true);
+        _progressBar->hide();
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        CompareCollectionsResponse::Result const &result = event->result;
+        CollectionComparison const &comparison = result.comparison;
+        QString const seconds = QString::number(event->elapsedMs / 1000.0, 'f', 1);
+        if (result.sameDbHash) {
+            _statusLabel->setText(QString("Collections are identical (dbHash of both servers), %1 documents. "
+                                          "Compared in %2 s.").arg(result.sourceDocuments).arg(seconds));
+            return;
+        }
+
+        UUIDEncoding const uuidEncoding = AppRegistry::instance().settingsManager()->uuidEncoding();
+        SupportedTimes const timeZone = AppRegistry::instance().settingsManager()->timeZone();
+        for (CollectionComparison::Difference const &difference : comparison.differences()) {
+            QString const id = QtUtils::toQString(BsonUtils::jsonString(difference.id.firstElement(),
+                mongo::TenGen, false, 0, uuidEncoding, timeZone));
+            auto item = new QTreeWidgetItem(_differences);
+            item->setText(DifferenceColumn, differenceText(difference.kind));
+            item->setText(IdColumn, id);
+            item->setData(IdColumn, IdRole, id);
+        }
+        for (int column = 0; column < ColumnCount; ++column)
+            _differences->resizeColumnToContents(column);
+        _openButton->setEnabled(_differences->topLevelItemCount() > 0);
+
+        QString text = QString("%1 documents in source, %2 in target, %3 of %4 ranges of _id differ. ")
+            .arg(result.sourceDocuments).arg(result.targetDocuments)
+            .arg(result.mismatchedRanges).arg(result.ranges);
+        if (comparison.differenceCount() == 0) {
+            text += "Collections are identical.";
+        }
+        else {
+            text += QString("%1 missing in target, %2 only in target, %3 changed.")
+                .arg(comparison.count(CollectionComparison::MissingInTarget))
+                .arg(comparison.count(CollectionComparison::OnlyInTarget))
+                .arg(comparison.count(CollectionComparison::Changed));
+            if (comparison.differenceCount() > static_cast<long long>(comparison.differences().size()))
+                text += QString(" The first %1 are listed.").arg(comparison.differences().size());
+        }
+        _statusLabel->setText(text + QString(" Compared in %1 s.").arg(seconds));
+    }
+
+    void CompareCollectionsDialog::openSelected()
+    {
+        QList<QTreeWidgetItem *> items = _differences->selectedItems();
+        if (items.isEmpty()) {
+            for (int i = 0; i < _differences->topLevelItemCount(); ++i)
+                items << _differences->topLevelItem(i);
+        }
+
+        QStringList ids;
+        for (QTreeWidgetItem *item : items)
+            ids << item->data(IdColumn, IdRole).toString();
+        if (ids.isEmpty())
+            return;
+
+        emit openDocumentsRequested(QString("find({ _id: { $in: [ %1 ] } })").arg(ids.join(", ")));
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QDialog>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QProgressBar;
+class QPushButton;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class CompareCollectionsProgressEvent;
+    class CompareCollectionsResponse;
+
+    /**
+     * @brief Compares collection with collection of this or another connected server, e.g.
+     *        after copy: digests of _id ranges first, documents of ranges that differ then
+     *        (see MongoServer::compareCollections()).
+     */
+    class CompareCollectionsDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        CompareCollectionsDialog(MongoServer *server, const QString &dbName, const QString &collectionName,
+                                 QWidget *parent = 0);
+        ~CompareCollectionsDialog();
+
+    Q_SIGNALS:
+        // 'script' is find() of ids of selected differences, to be run on the source collection
+        void openDocumentsRequested(const QString &script);
+
+    public Q_SLOTS:
+        void handle(CompareCollectionsProgressEvent *event);
+        void handle(CompareCollectionsResponse *event);
+
+    private Q_SLOTS:
+        void compare();
+        void openSelected();
+        void updateDatabaseComboBox(int index);
+
+    private:
+        void cancel();
+
+        MongoServer *const _server;
+        QString const _dbName;
+        QString const _collectionName;
+
+        std::vector<MongoServer *> _servers;           // in order of _serverComboBox
+        QComboBox *_serverComboBox;
+        QComboBox *_databaseComboBox;
+        QLineEdit *_collectionEdit;
+        QPushButton *_compareButton;
+        QPushButton *_openButton;
+        QProgressBar *_progressBar;
+        QLabel *_statusLabel;
+        QTreeWidget *_differences;
+
+        int _compareId;                                 // 0, if nothing is being compared
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+}
@@ -1,5 +1,6 @@
 #include "robomongo/gui/dialogs/ConnectionAdvancedTab.h"
 
+#include <QCheckBox>
 #include <QLabel>
 #include <QGridLayout>
 #include <QLineEdit>
@@ -14,6 +15,7 @@
 
 #include <mongo/client/mongo_uri.h>
 
+#include "robomongo/core/mongodb/WireCompression.h"
 #include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/utils/QtUtils.h"
 /* --- Disabling unfinished export URI connection string feature 
@@ -69,11 +71,34 @@ namespace Robomongo
         defaultDbLabel->setMaximumWidth(140); // Linux
 #endif
 
+        auto compressorsDescriptionLabel = new QLabel(
+            "Network compressors offered to server, in order of preference, comma separated "
+            "(<code>zstd</code>, <code>snappy</code>, <code>zlib</code>). Server picks the first one it "
+            "supports. Applies to connections of Robo 3T to single server (also through SSH tunnel), not to "
+            "replica set members and shell scripts. Leave this field empty to send messages uncompressed.");
+        compressorsDescriptionLabel->setWordWrap(true);
+        compressorsDescriptionLabel->setContentsMargins(0, -2, 0, 20);
+        _compressors = new QLineEdit(QtUtils::toQString(_settings->compressors()));
+        _compressors->setPlaceholderText("zstd,snappy,zlib");
+
+        _autoConnect = new QCheckBox("Connect at startup");
+        _autoConnect->setChecked(_settings->autoConnect());
+        auto autoConnectDescriptionLabel = new QLabel(
+            "Connections with this option are opened in parallel when Robo 3T starts and are listed "
+            "in Explorer in the order of the connections list.");
+        autoConnectDescriptionLabel->setWordWrap(true);
+        autoConnectDescriptionLabel->setContentsMargins(0, -2, 0, 20);
+
         auto mainLayout = new QGridLayout;
         mainLayout->setAlignment(Qt::AlignTop);
         mainLayout->addWidget(defaultDbLabel,                           1, 0);
         mainLayout->addWidget(_defaultDatabaseName,                     1, 1, 1, 2);
         mainLayout->addWidget(defaultDatabaseDescriptionLabel,          2, 1, 1, 2);
+        mainLayout->addWidget(new QLabel("Compressors:"),                3, 0);
+        mainLayout->addWidget(_compressors,                             3, 1, 1, 2);
+        mainLayout->addWidget(compressorsDescriptionLabel,              4, 1, 1, 2);
+        mainLayout->addWidget(_autoConnect,                             5, 1, 1, 2);
+        mainLayout->addWidget(autoConnectDescriptionLabel,              6, 1, 1, 2);
         /* --- Disabling unfinished export URI connection string feature
         mainLayout->addWidget(new QLabel{ "URI Connection String:" },   3, 0);
         mainLayout->addWidget(_uriString,                               3, 1);
@@ -85,6 +110,13 @@ namespace Robomongo
     void ConnectionAdvancedTab::accept()
     {
         _settings->setDefaultDatabase(QtUtils::toStdString(_defaultDatabaseName->text()));
+
+        // Unknown names are dropped, as server would reject the handshake with them
+        std::string compressors;
+        for (auto const &name : WireCompression::parse(QtUtils::toStdString(_compressors->text())))
+            compressors += (compressors.empty() ? "" : ",") + name;
+        _settings->setCompressors(compressors);
+        _settings->setAutoConnect(_autoConnect->isChecked());
     }
 
     void ConnectionAdvancedTab::setDefaultDb(const QString& defaultDb)
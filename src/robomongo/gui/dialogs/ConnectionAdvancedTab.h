@@ -30,6 +30,8 @@ namespace Robomongo
 
     private:
         QLineEdit *_defaultDatabaseName;
+        QLineEdit *_compressors;
+        QCheckBox *_autoConnect;
 
         /* --- Disabling unfinished export URI connection string feature
         QLineEdit *_uriString;
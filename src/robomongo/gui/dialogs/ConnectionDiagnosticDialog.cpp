@@ -2,6 +2,9 @@
 
 #include <QGridLayout>
 #include <QApplication>
+#include <QClipboard>
+#include <QHeaderView>
+#include <QTreeWidget>
 #include <QLabel>
 #include <QPushButton>
 #include <QMovie>
@@ -12,19 +15,45 @@
 #include "robomongo/core/settings/SshSettings.h"
 #include "robomongo/core/settings/SslSettings.h"
 #include "robomongo/core/settings/ReplicaSetSettings.h"
+#include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/gui/GuiRegistry.h"
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/domain/App.h"
 #include "robomongo/core/domain/MongoServer.h"
 #include "robomongo/core/EventBus.h"
 #include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/core/mongodb/DriverMetrics.h"
 #include "robomongo/core/mongodb/SshTunnelWorker.h"
+#include "robomongo/gui/dialogs/ConnectionProbeThread.h"
+
+namespace
+{
+    QString formatUs(long long us)
+    {
+        if (us < 1000)
+            return QString("%1 us").arg(us);
+        if (us < 1000 * 1000)
+            return QString("%1 ms").arg(us / 1000.0, 0, 'f', 1);
+        return QString("%1 s").arg(us / (1000.0 * 1000.0), 0, 'f', 2);
+    }
+
+    QString formatBytes(long long bytes)
+    {
+        if (bytes < 1024)
+            return QString("%1 B").arg(bytes);
+        if (bytes < 1024 * 1024)
+            return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+        return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+}
 
 namespace Robomongo
 {
     ConnectionDiagnosticDialog::ConnectionDiagnosticDialog(ConnectionSettings *connection, QWidget *parent) :
         QDialog(parent),
         _connSettings(connection->clone()),
+        _probeThread(NULL),
+        _tunnelThread(NULL),
         _server(NULL),
         _serverHandle(0),
         _continueExec(true)
@@ -52,10 +81,62 @@ namespace Robomongo
         _sshLabel = new QLabel;
         _listIconLabel = new QLabel;
         _listLabel = new QLabel;
+        _probeIconLabel = new QLabel;
+        _probeLabel = new QLabel;
+        _tunnelIconLabel = new QLabel;
+        _tunnelLabel = new QLabel;
+        _tunnelLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        _phasesTree = new QTreeWidget;
+        _phasesTree->setRootIsDecorated(false);
+        QStringList phaseLabels("Check");
+        for (int phase = 0; phase < ConnectionProbe::PhaseCount; ++phase)
+            phaseLabels << ConnectionProbe::phaseName(static_cast<ConnectionProbe::Phase>(phase));
+        phaseLabels << "Total";
+        _phasesTree->setHeaderLabels(phaseLabels);
+        _phasesTree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+        _phasesTree->setMinimumWidth(520);
+        _phasesTree->setMaximumHeight(160);
+        _phasesTree->hide();
 
         _viewErrorLink = new QLabel("<a href='error' style='color: #777777;'>Show error details</a>");
         VERIFY(connect(_viewErrorLink, SIGNAL(linkActivated(QString)), this, SLOT(errorLinkActivated(QString))));
 
+        _viewMetricsLink = new QLabel("<a href='metrics' style='color: #777777;'>Show driver metrics</a>");
+        VERIFY(connect(_viewMetricsLink, SIGNAL(linkActivated(QString)), this, SLOT(metricsLinkActivated(QString))));
+
+        // Transfers a few MB through the tunnel, so only on request
+        _testTunnelLink = new QLabel("<a href='tunnel' style='color: #777777;'>Test tunnel throughput</a>");
+        _testTunnelLink->setToolTip("Measure latency and throughput of SSH tunnel with its cipher, MAC and "
+                                    "compression, to compare settings of SSH tab");
+        VERIFY(connect(_testTunnelLink, SIGNAL(linkActivated(QString)), this, SLOT(tunnelLinkActivated(QString))));
+
+        // Totals of all connections of this record in this session, not only of the test
+        _metricsSummary = new QLabel;
+        _metricsSummary->setWordWrap(true);
+        _metricsTree = new QTreeWidget;
+        _metricsTree->setRootIsDecorated(false);
+        _metricsTree->setHeaderLabels({ "Operation", "Count", "Failed", "Sent", "Received", 
+                                        "p50", "p99", "Max" });
+        _metricsTree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+        _metricsTree->setMinimumWidth(520);
+
+        QPushButton *copyJsonButton = new QPushButton("Copy as JSON");
+        VERIFY(connect(copyJsonButton, SIGNAL(clicked()), this, SLOT(copyMetricsJson())));
+
+        QHBoxLayout *metricsButtons = new QHBoxLayout;
+        metricsButtons->addStretch(1);
+        metricsButtons->addWidget(copyJsonButton);
+
+        QVBoxLayout *metricsBox = new QVBoxLayout;
+        metricsBox->setContentsMargins(20, 0, 20, 0);
+        metricsBox->addWidget(_metricsSummary);
+        metricsBox->addWidget(_metricsTree, 1);
+        metricsBox->addLayout(metricsButtons);
+        _metricsPanel = new QWidget;
+        _metricsPanel->setLayout(metricsBox);
+        _metricsPanel->hide();
+
         _loadingMovie = new QMovie(":robomongo/icons/loading_ticks_40x40.gif", QByteArray(), this);
         _loadingMovie->setScaledSize(QSize(20, 20));
         _loadingMovie->start();
@@ -64,6 +145,7 @@ namespace Robomongo
         _sshIconLabel->setMovie(_loadingMovie);
         _authIconLabel->setMovie(_loadingMovie);
         _listIconLabel->setMovie(_loadingMovie);
+        _probeIconLabel->setMovie(_loadingMovie);
 
         QGridLayout *layout = new QGridLayout();
         layout->setContentsMargins(20, 20, 20, 10);
@@ -75,16 +157,26 @@ namespace Robomongo
         layout->addWidget(_authLabel,           2, 1, Qt::AlignLeft);
         layout->addWidget(_listIconLabel,       3, 0);
         layout->addWidget(_listLabel,           3, 1, Qt::AlignLeft);
+        layout->addWidget(_probeIconLabel,      4, 0);
+        layout->addWidget(_probeLabel,          4, 1, Qt::AlignLeft);
+        layout->addWidget(_phasesTree,          5, 1);
+        layout->addWidget(_tunnelIconLabel,     6, 0);
+        layout->addWidget(_tunnelLabel,         6, 1, Qt::AlignLeft);
         layout->setColumnStretch(0, 0) ; // Give column 0 no stretch ability
         layout->setColumnStretch(1, 1) ; // Give column 1 stretch ability of ratio 1
 
         QHBoxLayout *hbox = new QHBoxLayout;
         hbox->addSpacing(21);
-        hbox->addWidget(_viewErrorLink, 1, Qt::AlignLeft);
+        hbox->addWidget(_viewErrorLink, 0, Qt::AlignLeft);
+        hbox->addSpacing(10);
+        hbox->addWidget(_viewMetricsLink, 0, Qt::AlignLeft);
+        hbox->addSpacing(10);
+        hbox->addWidget(_testTunnelLink, 1, Qt::AlignLeft);
         hbox->addWidget(closeButton, 0, Qt::AlignRight);
 
         QVBoxLayout *box = new QVBoxLayout;
         box->addLayout(layout);
+        box->addWidget(_metricsPanel, 1);
         box->addSpacing(10);
         box->addLayout(hbox);
         setLayout(box);
@@ -95,6 +187,11 @@ namespace Robomongo
         listStatus(InitialState);
 
         _viewErrorLink->hide();
+        _probeIconLabel->hide();
+        _probeLabel->hide();
+        _tunnelIconLabel->hide();
+        _tunnelLabel->hide();
+        _testTunnelLink->hide();
 
         if (!AppRegistry::instance().app()->openServer(_connSettings, ConnectionTest)) {
             _continueExec = false;
@@ -105,6 +202,12 @@ namespace Robomongo
     }
 
     ConnectionDiagnosticDialog::~ConnectionDiagnosticDialog() {
+        // Probe is left to finish on its own, it deletes itself then
+        if (_probeThread)
+            disconnect(_probeThread, SIGNAL(probed()), this, SLOT(probeDone()));
+        if (_tunnelThread)
+            disconnect(_tunnelThread, SIGNAL(probed()), this, SLOT(tunnelTested()));
+
         if (_server)
             AppRegistry::instance().app()->closeServer(_server);
     }
@@ -116,6 +219,177 @@ namespace Robomongo
         QMessageBox::information(this, "Error details", QtUtils::toQString(_lastErrorMessage));
     }
 
+    void ConnectionDiagnosticDialog::metricsLinkActivated(const QString &link) {
+        _metricsPanel->setVisible(!_metricsPanel->isVisible());
+        _viewMetricsLink->setText(QString("<a href='metrics' style='color: #777777;'>%1</a>")
+            .arg(_metricsPanel->isVisible() ? "Hide driver metrics" : "Show driver metrics"));
+        updateMetrics();
+        adjustSize();
+    }
+
+    void ConnectionDiagnosticDialog::copyMetricsJson() {
+        QApplication::clipboard()->setText(QtUtils::toQString(DriverMetrics::toJson(DriverMetrics::stats(_connSettings))));
+    }
+
+    void ConnectionDiagnosticDialog::updateMetrics()
+    {
+        if (!_metricsPanel->isVisible())
+            return;
+
+        DriverMetrics::Stats const stats = DriverMetrics::stats(_connSettings);
+        QString summary = QString("%1 requests, wall time p50 %2, p99 %3, total %4, of which %5 waiting for server")
+            .arg(stats.clientOperations)
+            .arg(formatUs(stats.wall.percentileUs(50)))
+            .arg(formatUs(stats.wall.percentileUs(99)))
+            .arg(formatUs(stats.wall.totalUs()))
+            .arg(formatUs(stats.roundTripUs));
+
+        QStringList retries;
+        for (auto const &retry : stats.retries)
+            retries << QString("%1 %2").arg(QtUtils::toQString(retry.first)).arg(retry.second);
+        if (!retries.isEmpty())
+            summary += ". Retries: " + retries.join(", ");
+        _metricsSummary->setText(summary);
+
+        _metricsTree->clear();
+        for (auto const &entry : stats.operations) {
+            DriverMetrics::OperationStats const &operation = entry.second;
+            auto item = new QTreeWidgetItem(_metricsTree);
+            item->setText(0, QtUtils::toQString(entry.first));
+            item->setText(1, QString::number(operation.count));
+            item->setText(2, QString::number(operation.failures));
+            item->setText(3, formatBytes(operation.requestBytes));
+            item->setText(4, formatBytes(operation.responseBytes));
+            item->setText(5, formatUs(operation.roundTrip.percentileUs(50)));
+            item->setText(6, formatUs(operation.roundTrip.percentileUs(99)));
+            item->setText(7, formatUs(operation.roundTrip.maxUs()));
+            for (int column = 1; column < _metricsTree->columnCount(); ++column)
+                item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+        }
+    }
+
+    void ConnectionDiagnosticDialog::startProbe()
+    {
+        if (_probeThread)
+            return;
+
+        _probeIconLabel->setMovie(_loadingMovie);
+        _probeLabel->setText("Timing connection phases...");
+        _probeIconLabel->show();
+        _probeLabel->show();
+
+        _probeThread = new ConnectionProbeThread(_connSettings, 
+                                                 AppRegistry::instance().settingsManager()->mongoTimeoutSec());
+        VERIFY(connect(_probeThread, SIGNAL(probed()), this, SLOT(probeDone())));
+        VERIFY(connect(_probeThread, SIGNAL(finished()), _probeThread, SLOT(deleteLater())));
+        _probeThread->start();
+    }
+
+    void ConnectionDiagnosticDialog::probeDone()
+    {
+        if (sender() != _probeThread)
+            return;
+
+        std::vector<ConnectionProbe::Result> const &results = _probeThread->results();
+        std::vector<bool> isMeasured(ConnectionProbe::PhaseCount, false);
+        int failures = 0;
+
+        _phasesTree->clear();
+        for (ConnectionProbe::Result const &result : results) {
+            auto item = new QTreeWidgetItem(_phasesTree);
+            item->setText(0, QtUtils::toQString(result.target));
+            for (int phase = 0; phase < ConnectionProbe::PhaseCount; ++phase) {
+                long long const us = result.us[phase];
+                if (us == ConnectionProbe::NotMeasured)
+                    continue;
+
+                isMeasured[phase] = true;
+                int const column = phase + 1;
+                item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+                if (phase != result.failedPhase) {
+                    item->setText(column, formatUs(us));
+                    continue;
+                }
+
+                item->setText(column, QString("failed, %1").arg(formatUs(us)));
+                item->setForeground(column, QColor("#CC0000"));
+                item->setToolTip(column, QtUtils::toQString(result.error));
+            }
+
+            // Phase which failed without being started, i.e. no SSH tunnel
+            if (result.failed() && result.us[result.failedPhase] == ConnectionProbe::NotMeasured) {
+                isMeasured[result.failedPhase] = true;
+                item->setText(result.failedPhase + 1, "failed");
+                item->setForeground(result.failedPhase + 1, QColor("#CC0000"));
+                item->setToolTip(result.failedPhase + 1, QtUtils::toQString(result.error));
+            }
+
+            int const totalColumn = ConnectionProbe::PhaseCount + 1;
+            item->setText(totalColumn, formatUs(result.totalUs()));
+            item->setTextAlignment(totalColumn, Qt::AlignRight | Qt::AlignVCenter);
+            if (result.failed())
+                ++failures;
+        }
+
+        // Only phases of this record: no TLS column without TLS, no SSH one without SSH
+        for (int phase = 0; phase < ConnectionProbe::PhaseCount; ++phase)
+            _phasesTree->setColumnHidden(phase + 1, !isMeasured[phase]);
+
+        _probeIconLabel->setPixmap(failures ? _noPixmap : _yesPixmap);
+        _probeLabel->setText(failures
+            ? QString("Connection phases timed, %1 of %2 checks failed (hover for details)").arg(failures).arg(results.size())
+            : QString("Connection phases timed"));
+        _phasesTree->show();
+        adjustSize();
+    }
+
+    void ConnectionDiagnosticDialog::tunnelLinkActivated(const QString &link)
+    {
+        if (_tunnelThread)
+            return;
+
+        _tunnelIconLabel->setMovie(_loadingMovie);
+        _tunnelLabel->setText("Testing SSH tunnel...");
+        _tunnelIconLabel->show();
+        _tunnelLabel->show();
+        _testTunnelLink->setEnabled(false);
+
+        _tunnelThread = new ConnectionProbeThread(_connSettings, AppRegistry::instance().settingsManager()->mongoTimeoutSec(),
+                                                  ConnectionProbeThread::Tunnel);
+        VERIFY(connect(_tunnelThread, SIGNAL(probed()), this, SLOT(tunnelTested())));
+        VERIFY(connect(_tunnelThread, SIGNAL(finished()), _tunnelThread, SLOT(deleteLater())));
+        _tunnelThread->start();
+    }
+
+    void ConnectionDiagnosticDialog::tunnelTested()
+    {
+        if (sender() != _tunnelThread)
+            return;
+
+        ConnectionProbe::TunnelResult const tunnel = _tunnelThread->tunnel();
+        _tunnelThread = NULL;
+        _testTunnelLink->setEnabled(true);
+
+        QString const methods = tunnel.methods.empty() ? QString()
+                              : QString(" (%1)").arg(QtUtils::toQString(tunnel.methods));
+        if (!tunnel.error.empty()) {
+            _tunnelIconLabel->setPixmap(_noPixmap);
+            _tunnelLabel->setText(QString("Tunnel%1 test failed").arg(methods));
+            _tunnelLabel->setToolTip(QtUtils::toQString(tunnel.error));
+        }
+        else {
+            _tunnelIconLabel->setPixmap(_yesPixmap);
+            _tunnelLabel->setText(QString("Tunnel%1: latency %2 (min %3), download %4/s, upload %5/s")
+                .arg(methods)
+                .arg(formatUs(tunnel.latencyUs))
+                .arg(formatUs(tunnel.minLatencyUs))
+                .arg(formatBytes(static_cast<long long>(tunnel.downloadBytesPerSec)))
+                .arg(formatBytes(static_cast<long long>(tunnel.uploadBytesPerSec))));
+            _tunnelLabel->setToolTip(QString());
+        }
+        adjustSize();
+    }
+
     void ConnectionDiagnosticDialog::sshStatus(State state)
     {
         if (!_connSettings->sshSettings()->enabled()) {
@@ -245,6 +519,12 @@ namespace Robomongo
 
         // Remember in order to delete on dialog close
         _server = static_cast<MongoServer*>(event->sender());
+        updateMetrics();
+        startProbe();
+
+        // Tunnel of this test connection stays open until dialog is closed
+        if (_connSettings->sshSettings()->enabled())
+            _testTunnelLink->show();
     }
 
     void ConnectionDiagnosticDialog::handle(ConnectionFailedEvent *event) {
@@ -285,5 +565,7 @@ namespace Robomongo
             _lastErrorMessage = event->message;
             _viewErrorLink->show();
         }
+
+        startProbe();
     }
 }
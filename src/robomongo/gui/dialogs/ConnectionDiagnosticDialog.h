@@ -5,6 +5,7 @@
 
 class QLabel;
 class QMovie;
+class QTreeWidget;
 
 namespace Robomongo
 {
@@ -12,6 +13,7 @@ namespace Robomongo
     class ConnectionFailedEvent;
     class ConnectionSettings;
     class MongoServer;
+    class ConnectionProbeThread;
 
     class ConnectionDiagnosticDialog : public QDialog
     {
@@ -26,6 +28,11 @@ namespace Robomongo
         void handle(ConnectionEstablishedEvent *event);
         void handle(ConnectionFailedEvent *event);
         void errorLinkActivated(const QString &link);
+        void metricsLinkActivated(const QString &link);
+        void copyMetricsJson();
+        void probeDone();
+        void tunnelLinkActivated(const QString &link);
+        void tunnelTested();
 
     private:
 
@@ -42,6 +49,12 @@ namespace Robomongo
         void authStatus(State state);
         void listStatus(State state);
 
+        // Driver metrics of connection record, see DriverMetrics
+        void updateMetrics();
+
+        // Times phases on connections of their own, once test connection is done (see ConnectionProbe)
+        void startProbe();
+
         ConnectionSettings *_connSettings;
         QIcon _yesIcon;
         QIcon _noIcon;
@@ -60,8 +73,20 @@ namespace Robomongo
         QLabel *_authLabel;
         QLabel *_listIconLabel;  // List database names
         QLabel *_listLabel;
+        QLabel *_probeIconLabel;
+        QLabel *_probeLabel;
+        QTreeWidget *_phasesTree;
+        ConnectionProbeThread *_probeThread;
+        QLabel *_tunnelIconLabel;
+        QLabel *_tunnelLabel;
+        ConnectionProbeThread *_tunnelThread;   // running test of SSH tunnel, or NULL
 
         QLabel *_viewErrorLink;
+        QLabel *_viewMetricsLink;
+        QLabel *_testTunnelLink;
+        QWidget *_metricsPanel;
+        QLabel *_metricsSummary;
+        QTreeWidget *_metricsTree;
         std::string _lastErrorMessage;
 
         MongoServer *_server;
@@ -0,0 +1,26 @@
+#include "robomongo/gui/dialogs/ConnectionProbeThread.h"
+
+#include "robomongo/core/settings/ConnectionSettings.h"
+
+namespace Robomongo
+{
+    ConnectionProbeThread::ConnectionProbeThread(const ConnectionSettings *settings, double timeoutSec, Check check) :
+        _settings(settings->clone()),
+        _timeoutSec(timeoutSec),
+        _check(check)
+    {
+    }
+
+    ConnectionProbeThread::~ConnectionProbeThread()
+    {
+    }
+
+    void ConnectionProbeThread::run()
+    {
+        if (_check == Tunnel)
+            _tunnel = ConnectionProbe::testTunnel(_settings.get(), _timeoutSec);
+        else
+            _results = ConnectionProbe::probe(_settings.get(), _timeoutSec);
+        emit probed();
+    }
+}
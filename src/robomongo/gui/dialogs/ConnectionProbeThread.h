@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QThread>
+#include <memory>
+#include <vector>
+
+#include "robomongo/core/mongodb/ConnectionProbe.h"
+
+namespace Robomongo
+{
+    class ConnectionSettings;
+
+    /**
+     * @brief Runs ConnectionProbe for a copy of connection record off the GUI thread:
+     *        phases of connection, or test of SSH tunnel. Results are read after probed().
+     */
+    class ConnectionProbeThread : public QThread
+    {
+        Q_OBJECT
+
+    public:
+        enum Check
+        {
+            Phases,
+            Tunnel
+        };
+
+        ConnectionProbeThread(const ConnectionSettings *settings, double timeoutSec, Check check = Phases);
+        ~ConnectionProbeThread();
+
+        Check check() const { return _check; }
+        const std::vector<ConnectionProbe::Result> &results() const { return _results; }
+        const ConnectionProbe::TunnelResult &tunnel() const { return _tunnel; }
+
+    Q_SIGNALS:
+        void probed();
+
+    protected:
+        virtual void run();
+
+    private:
+        std::unique_ptr<ConnectionSettings> const _settings;
+        double const _timeoutSec;
+        Check const _check;
+        std::vector<ConnectionProbe::Result> _results;
+        ConnectionProbe::TunnelResult _tunnel;
+    };
+}
@@ -1,5 +1,6 @@
 #include "robomongo/gui/dialogs/ConnectionsDialog.h"
 
+#include <algorithm>
 #include <QPushButton>
 #include <QHBoxLayout>
 #include <QAction>
@@ -7,13 +8,19 @@
 #include <QLabel>
 #include <QHeaderView>
 #include <QDialogButtonBox>
-#include <QTreeWidgetItem>
+#include <QAbstractTableModel>
 #include <QKeyEvent>
+#include <QLineEdit>
+#include <QMimeData>
+#include <QTreeView>
 #include <QApplication>
 #include <QSettings>
+#include <QTimer>
 #include <QUuid>
 
 #include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/domain/ConnectionSearchIndex.h"
+#include "robomongo/core/mongodb/WarmConnections.h"
 #include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/settings/ReplicaSetSettings.h"
 #include "robomongo/core/settings/SettingsManager.h"
@@ -24,6 +31,8 @@
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/gui/GuiRegistry.h"
 #include "robomongo/gui/dialogs/ConnectionDialog.h"
+#include "robomongo/gui/dialogs/ScriptBroadcastDialog.h"
+#include "robomongo/gui/utils/ColumnSizing.h"
 #include "robomongo/gui/MainWindow.h"
 #include "robomongo/gui/widgets/workarea/WelcomeTab.h"
 #include "robomongo/utils/common.h"
@@ -31,82 +40,232 @@
 namespace Robomongo
 {
     
-    /* ------------------------ ConnectionListWidgetItem ------------------------ */
+    /* ------------------------ ConnectionsModel ------------------------ */
 
     /**
-     * @brief Simple ListWidgetItem that has several convenience methods.
+     * @brief Connections of SettingsManager, in their order, filtered by ConnectionSearchIndex.
+     *        Texts and icons are made only for rows asked by view, i.e. the visible ones.
+     *        Connections are reordered by drag'n'drop while list is not filtered.
      */
-    class ConnectionListWidgetItem : public QTreeWidgetItem
+    class ConnectionsModel : public QAbstractTableModel
     {
     public:
-        /**
-         * @brief Creates ConnectionListWidgetItem with specified ConnectionSettings
-         */
-        ConnectionListWidgetItem(ConnectionSettings *connection) { setConnection(connection); }
+        enum Column { NameColumn, AddressColumn, AttributesColumn, AuthColumn, ColumnCount };
 
-        /**
-         * @brief Returns attached ConnectionSettings.
-         */
-        ConnectionSettings *connection() { return _connection; }
+        ConnectionsModel(SettingsManager *settingsManager, QObject *parent) :
+            QAbstractTableModel(parent), _settingsManager(settingsManager)
+        {
+            reload();
+        }
 
         /**
-         * @brief Attach ConnectionSettings to this item
+         * @brief Reads connections from SettingsManager again, e.g. after add or edit
          */
-        void setConnection(ConnectionSettings *connection)
+        void reload()
         {
-            _connection = connection;
-
-            if (_connection->isReplicaSet()) {
-                setIcon(0, GuiRegistry::instance().replicaSetIcon());
-                setText(0, QtUtils::toQString(_connection->connectionName()));
-                auto const repSetSize = _connection->replicaSetSettings()->members().size();
-                auto addrText = QString::number(repSetSize) + ((repSetSize > 1) ? " nodes" : " node");
-                if (!_connection->replicaSetSettings()->members().empty()) {
-                    addrText += QString::fromStdString(" (" + _connection->replicaSetSettings()->members().front() + ")");
-                }
-                setText(1, addrText);
+            beginResetModel();
+            _connections = _settingsManager->connections();
+            _index.clear();
+            for (ConnectionSettings *connection : _connections)
+                _index.add(searchFields(connection));
+            _visible = _index.find(_filter);
+            endResetModel();
+        }
+
+        void setFilter(const QString &text)
+        {
+            beginResetModel();
+            _filter = QtUtils::toStdString(text.trimmed());
+            _visible = _index.find(_filter);
+            endResetModel();
+        }
+
+        bool isFiltered() const { return !_filter.empty(); }
+
+        ConnectionSettings *connection(const QModelIndex &index) const
+        {
+            if (!index.isValid() || index.row() >= static_cast<int>(_visible.size()))
+                return nullptr;
+            return _connections[_visible[index.row()]];
+        }
+
+        QModelIndex indexOf(ConnectionSettings *connection) const
+        {
+            for (size_t row = 0; row < _visible.size(); ++row) {
+                if (_connections[_visible[row]] == connection)
+                    return index(static_cast<int>(row), NameColumn);
             }
-            else {
-                setIcon(0, GuiRegistry::instance().serverIcon());
-                setText(0, QtUtils::toQString(_connection->connectionName()));
-                setText(1, QtUtils::toQString(_connection->getFullAddress()));
+            return QModelIndex();
+        }
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override
+        {
+            return parent.isValid() ? 0 : static_cast<int>(_visible.size());
+        }
+
+        int columnCount(const QModelIndex &parent = QModelIndex()) const override
+        {
+            return parent.isValid() ? 0 : ColumnCount;
+        }
+
+        QVariant headerData(int section, Qt::Orientation orientation, int role) const override
+        {
+            if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+                return QVariant();
+
+            switch (section) {
+            case NameColumn: return "Name";
+            case AddressColumn: return "Address";
+            case AttributesColumn: return "Attributes";
+            case AuthColumn: return "Auth. Database / User";
+            default: return QVariant();
             }
+        }
 
-            if (_connection->imported()) {
-                setIcon(0, GuiRegistry::instance().serverImportedIcon());
+        QVariant data(const QModelIndex &index, int role) const override
+        {
+            ConnectionSettings *const connection = this->connection(index);
+            if (!connection)
+                return QVariant();
+
+            if (role == Qt::DisplayRole)
+                return text(connection, index.column());
+
+            if (role == Qt::DecorationRole && index.column() == NameColumn) {
+                if (connection->imported())
+                    return GuiRegistry::instance().serverImportedIcon();
+                return connection->isReplicaSet() ? GuiRegistry::instance().replicaSetIcon()
+                                                  : GuiRegistry::instance().serverIcon();
             }
 
-            // Header "Attributes" (column[2])
-            setText(2, _connection->isReplicaSet() ? "Replica Set" : "");
-            
-            if (_connection->sslSettings()->sslEnabled())
-                setText(2, text(2) + (text(2).isEmpty() ? "TLS" : ", TLS"));
-
-            if (!_connection->isReplicaSet() && _connection->sshSettings()->enabled())
-                setText(2, text(2) + (text(2).isEmpty() ? "SSH" : ", SSH"));
-
-            // Header "Auth. Database/User" (column[3])
-            if (_connection->hasEnabledPrimaryCredential()) {
-                auto primaryCredential { _connection->primaryCredential() };
-                auto const authString = 
-                    QString("%1 / %2").arg(QtUtils::toQString(primaryCredential->databaseName()))
-                                      .arg(QtUtils::toQString(primaryCredential->userName()));
-                setText(3, authString + "    ");
-                setIcon(3, GuiRegistry::instance().keyIcon());
+            if (role == Qt::DecorationRole && index.column() == AuthColumn &&
+                connection->hasEnabledPrimaryCredential())
+                return GuiRegistry::instance().keyIcon();
+
+            return QVariant();
+        }
+
+        Qt::ItemFlags flags(const QModelIndex &index) const override
+        {
+            // Rows are dropped between other rows, not onto them
+            Qt::ItemFlags const dragDrop = isFiltered() ? Qt::NoItemFlags : 
+                                           index.isValid() ? Qt::ItemIsDragEnabled : Qt::ItemIsDropEnabled;
+            if (!index.isValid())
+                return dragDrop;
+            return Qt::ItemIsSelectable | Qt::ItemIsEnabled | dragDrop;
+        }
+
+        Qt::DropActions supportedDropActions() const override { return Qt::MoveAction; }
+
+        QStringList mimeTypes() const override { return QStringList() << MimeType; }
+
+        QMimeData *mimeData(const QModelIndexList &indexes) const override
+        {
+            if (indexes.isEmpty() || isFiltered())
+                return nullptr;
+
+            auto data = new QMimeData;
+            data->setData(MimeType, QByteArray::number(indexes.front().row()));
+            return data;
+        }
+
+        bool dropMimeData(const QMimeData *data, Qt::DropAction action, int row, int column,
+                          const QModelIndex &parent) override
+        {
+            if (action != Qt::MoveAction || isFiltered() || !data->hasFormat(MimeType))
+                return false;
+
+            bool ok = false;
+            int const from = data->data(MimeType).toInt(&ok);
+            int const size = static_cast<int>(_connections.size());
+            if (!ok || from < 0 || from >= size)
+                return false;
+
+            int to = row >= 0 ? row : parent.isValid() ? parent.row() : size;
+            if (!beginMoveRows(QModelIndex(), from, from, QModelIndex(), to))
+                return false;
+
+            // Destination is counted before source is taken out
+            if (to > from)
+                --to;
+            ConnectionSettings *const moved = _connections[from];
+            _connections.erase(_connections.begin() + from);
+            _connections.insert(_connections.begin() + to, moved);
+
+            _index.clear();
+            for (ConnectionSettings *connection : _connections)
+                _index.add(searchFields(connection));
+            _visible = _index.find(_filter);
+            endMoveRows();
+
+            _settingsManager->reorderConnections(_connections);
+            return false;   // moved already, view must not remove source row
+        }
+
+    private:
+        static constexpr const char *MimeType = "application/x-robomongo-connection-row";
+
+        static std::vector<std::string> searchFields(ConnectionSettings *connection)
+        {
+            std::vector<std::string> fields { connection->connectionName() };
+            if (connection->isReplicaSet()) {
+                ReplicaSetSettings *const replicaSet = connection->replicaSetSettings();
+                fields.push_back(replicaSet->setNameUserEntered());
+                fields.push_back(replicaSet->cachedSetName());
+                for (std::string const &member : replicaSet->members())
+                    fields.push_back(member);
             }
             else {
-                setIcon(3, QIcon());
-                setText(3, "");
+                fields.push_back(connection->getFullAddress());
+                if (connection->sshSettings()->enabled())
+                    fields.push_back(connection->sshSettings()->host());
             }
+            return fields;
+        }
 
+        static QString text(ConnectionSettings *connection, int column)
+        {
+            switch (column) {
+            case NameColumn:
+                return QtUtils::toQString(connection->connectionName());
+            case AddressColumn:
+                if (connection->isReplicaSet()) {
+                    auto const &members = connection->replicaSetSettings()->members();
+                    auto addrText = QString::number(members.size()) + ((members.size() > 1) ? " nodes" : " node");
+                    if (!members.empty())
+                        addrText += QtUtils::toQString(" (" + members.front() + ")");
+                    return addrText;
+                }
+                return QtUtils::toQString(connection->getFullAddress());
+            case AttributesColumn: {
+                QStringList attributes;
+                if (connection->isReplicaSet())
+                    attributes << "Replica Set";
+                if (connection->sslSettings()->sslEnabled())
+                    attributes << "TLS";
+                if (!connection->isReplicaSet() && connection->sshSettings()->enabled())
+                    attributes << "SSH";
+                return attributes.join(", ");
+            }
+            case AuthColumn:
+                if (connection->hasEnabledPrimaryCredential()) {
+                    auto primaryCredential { connection->primaryCredential() };
+                    return QString("%1 / %2    ").arg(QtUtils::toQString(primaryCredential->databaseName()))
+                                                 .arg(QtUtils::toQString(primaryCredential->userName()));
+                }
+                return QString();
+            default:
+                return QString();
+            }
         }
 
-    private:
-        ConnectionSettings *_connection;
+        SettingsManager *const _settingsManager;
+        std::vector<ConnectionSettings *> _connections;     // in order of SettingsManager
+        std::vector<size_t> _visible;                      // positions in _connections
+        ConnectionSearchIndex _index;                      // by positions in _connections
+        std::string _filter;
     };
 
-
-
     /* ------------------------ ConnectionsDialog ------------------------ */
 
     /**
@@ -133,41 +292,60 @@ namespace Robomongo
         QAction *removeAction = new QAction("&Remove...", this);
         VERIFY(connect(removeAction, SIGNAL(triggered()), this, SLOT(remove())));
 
-        _listWidget = new ConnectionsTreeWidget;
-        GuiRegistry::instance().setAlternatingColor(_listWidget);
+        _model = new ConnectionsModel(_settingsManager, this);
+        _listView = new QTreeView;
+        _listView->setModel(_model);
+        GuiRegistry::instance().setAlternatingColor(_listView);
 #if defined(Q_OS_MAC)
-        _listWidget->setAttribute(Qt::WA_MacShowFocusRect, false);
+        _listView->setAttribute(Qt::WA_MacShowFocusRect, false);
 #endif
-        _listWidget->setIndentation(5);
-
-        QStringList colums;
-        colums << "Name" << "Address" << "Attributes" << "Auth. Database / User";
-        _listWidget->setHeaderLabels(colums);
+        _listView->setIndentation(5);
+        _listView->setRootIsDecorated(false);
+        _listView->setUniformRowHeights(true);  // so that size of rows out of sight is not asked
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
-        _listWidget->header()->setSectionResizeMode(0, QHeaderView::Stretch);
-        _listWidget->header()->setSectionResizeMode(1, QHeaderView::Stretch);
-        _listWidget->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
-        _listWidget->header()->setSectionResizeMode(3, QHeaderView::ResizeToContents);
+        _listView->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+        _listView->header()->setSectionResizeMode(1, QHeaderView::Stretch);
 #endif
-        //_listWidget->setViewMode(QListView::ListMode);
-        _listWidget->setContextMenuPolicy(Qt::ActionsContextMenu);
-        _listWidget->addAction(addAction);
-        _listWidget->addAction(editAction);
-        _listWidget->addAction(cloneAction);
-        _listWidget->addAction(removeAction);
-        _listWidget->setSelectionMode(QAbstractItemView::SingleSelection); // single item can be draged or droped
-        _listWidget->setDragEnabled(true);
-        _listWidget->setDragDropMode(QAbstractItemView::InternalMove);
-        _listWidget->setMinimumHeight(290);
-        _listWidget->setMinimumWidth(630);
-        VERIFY(connect(_listWidget, SIGNAL(itemDoubleClicked(QTreeWidgetItem*, int)), this, SLOT(accept())));
-        VERIFY(connect(_listWidget, SIGNAL(layoutChanged()), this, SLOT(listWidget_layoutChanged())));
+        // Sampled rows only, ResizeToContents would measure all connections on every change
+        VERIFY(connect(_model, SIGNAL(modelReset()), this, SLOT(resizeColumns())));
+        resizeColumns();
+        _listView->setContextMenuPolicy(Qt::ActionsContextMenu);
+        _listView->addAction(addAction);
+        _listView->addAction(editAction);
+        _listView->addAction(cloneAction);
+        _listView->addAction(removeAction);
+        _listView->setSelectionMode(QAbstractItemView::SingleSelection); // single item can be draged or droped
+        _listView->setDragEnabled(true);
+        _listView->setAcceptDrops(true);
+        _listView->setDropIndicatorShown(true);
+        _listView->setDragDropMode(QAbstractItemView::InternalMove);
+        _listView->setMinimumHeight(290);
+        _listView->setMinimumWidth(630);
+        VERIFY(connect(_listView, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(accept())));
+
+        // Record selected or hovered for a while is connected speculatively, see WarmConnections
+        _warmUpTimer = new QTimer(this);
+        _warmUpTimer->setSingleShot(true);
+        _warmUpTimer->setInterval(WarmUpDelayMs);
+        VERIFY(connect(_warmUpTimer, SIGNAL(timeout()), this, SLOT(warmUp())));
+        _listView->setMouseTracking(true);
+        VERIFY(connect(_listView, SIGNAL(entered(QModelIndex)), this, SLOT(scheduleWarmUp(QModelIndex))));
+        VERIFY(connect(_listView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)),
+                       this, SLOT(scheduleWarmUp(QModelIndex))));
+
+        _searchEdit = new QLineEdit;
+        _searchEdit->setPlaceholderText("Search by name, address, replica set member or SSH host");
+        _searchEdit->setClearButtonEnabled(true);
+        VERIFY(connect(_searchEdit, SIGNAL(textChanged(QString)), this, SLOT(filter(QString))));
 
         QDialogButtonBox *buttonBox = new QDialogButtonBox(this);
         buttonBox->setOrientation(Qt::Horizontal);
         buttonBox->setStandardButtons(QDialogButtonBox::Cancel | QDialogButtonBox::Save);
         buttonBox->button(QDialogButtonBox::Save)->setIcon(GuiRegistry::instance().serverIcon());
         buttonBox->button(QDialogButtonBox::Save)->setText("C&onnect");
+        QPushButton *runScriptButton = buttonBox->addButton("Run Script...", QDialogButtonBox::ActionRole);
+        runScriptButton->setToolTip("Run one script on several connections in parallel");
+        VERIFY(connect(runScriptButton, SIGNAL(clicked()), this, SLOT(runScript())));
         VERIFY(connect(buttonBox, SIGNAL(accepted()), this, SLOT(accept())));
         VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
 
@@ -205,24 +383,19 @@ namespace Robomongo
 
         QVBoxLayout *firstColumnLayout = new QVBoxLayout;
         firstColumnLayout->addWidget(intro);
-        firstColumnLayout->addWidget(_listWidget, 1);
+        firstColumnLayout->addWidget(_searchEdit);
+        firstColumnLayout->addWidget(_listView, 1);
         firstColumnLayout->addLayout(bottomLayout);
 
         QHBoxLayout *mainLayout = new QHBoxLayout(this);
         mainLayout->addLayout(firstColumnLayout, 1);
 
-        // Populate list with connections
-        std::vector<ConnectionSettings*> connectionSettings = _settingsManager->connections();
-        for (auto const& connSetting : connectionSettings) {
-            ConnectionSettings *connectionModel { connSetting };
-            add(connectionModel);
-        }
-
         // Highlight last item
-        if (_listWidget->topLevelItemCount() > 0)
-            _listWidget->setCurrentItem(_listWidget->topLevelItem(_listWidget->topLevelItemCount()-1));
+        int const count = _model->rowCount();
+        if (count > 0)
+            _listView->setCurrentIndex(_model->index(count - 1, 0));
 
-        _listWidget->setFocus();
+        _listView->setFocus();
         resize(getSetting("ConnectionsDialog/size").toSize());
     }
 
@@ -231,17 +404,45 @@ namespace Robomongo
      */
     void ConnectionsDialog::accept()
     {
-        auto currentItem = dynamic_cast<ConnectionListWidgetItem*>(_listWidget->currentItem());
+        ConnectionSettings *const connection = _model->connection(_listView->currentIndex());
 
         // Do nothing if no item selected
-        if (!currentItem)
+        if (!connection)
             return;
 
-        _selectedConnection = currentItem->connection();
+        _selectedConnection = connection;
 
         QDialog::accept();
     }
 
+    void ConnectionsDialog::scheduleWarmUp(const QModelIndex &index)
+    {
+        _warmUpIndex = index;
+        _warmUpTimer->start();
+    }
+
+    void ConnectionsDialog::resizeColumns()
+    {
+        utils::fitColumns(_listView, _listView->header(), 2, 3);
+    }
+
+    void ConnectionsDialog::warmUp()
+    {
+        // Index is invalid once row is removed or filtered out
+        ConnectionSettings *const connection = _model->connection(_warmUpIndex);
+        if (connection)
+            WarmConnections::instance().warm(connection, _settingsManager->mongoTimeoutSec());
+    }
+
+    void ConnectionsDialog::runScript()
+    {
+        // Opened non-modal when this dialog is closed, as results come in for a while
+        auto dlg = new ScriptBroadcastDialog(_settingsManager->connections(),
+                                             _model->connection(_listView->currentIndex()), parentWidget());
+        reject();
+        dlg->show();
+    }
+
     void ConnectionsDialog::reject()
     {
         QDialog::reject();
@@ -277,10 +478,11 @@ namespace Robomongo
             return;
         }
 
-        add(newConnSettings.get());
+        ConnectionSettings *const connection = newConnSettings.get();
         _settingsManager->addConnection(newConnSettings.release());
+        add(connection);
         
-        _listWidget->setFocus();
+        _listView->setFocus();
     }
 
     /**
@@ -288,13 +490,12 @@ namespace Robomongo
      */
     void ConnectionsDialog::edit()
     {
-        auto currentItem = dynamic_cast<ConnectionListWidgetItem*>(_listWidget->currentItem());
+        auto connection = _model->connection(_listView->currentIndex());
 
         // Do nothing if no item selected
-        if (!currentItem)
+        if (!connection)
             return;
 
-        auto connection = currentItem->connection();
         boost::scoped_ptr<ConnectionSettings> clonedConnection(connection->clone());
         ConnectionDialog editDialog(clonedConnection.get(), this);
 
@@ -310,15 +511,9 @@ namespace Robomongo
         // on linux focus is lost - we need to activate connections dialog
         activateWindow();
 
-        int size = _connectionItems.size();
-        for (int i = 0; i<size; ++i)
-        {
-            ConnectionListWidgetItem *item = _connectionItems[i];
-            if (_connectionItems[i]->connection() == connection) {
-                item->setConnection(connection);
-                break;
-            }
-        }        
+        // Texts and search index are made again, connection stays selected if still matching
+        _model->reload();
+        _listView->setCurrentIndex(_model->indexOf(connection));
     }
 
     /**
@@ -326,14 +521,12 @@ namespace Robomongo
      */
     void ConnectionsDialog::remove()
     {
-        auto currentItem = dynamic_cast<ConnectionListWidgetItem*>(_listWidget->currentItem());
+        ConnectionSettings *connSettings = _model->connection(_listView->currentIndex());
 
         // Do nothing if no item selected
-        if (!currentItem)
+        if (!connSettings)
             return;
 
-        ConnectionSettings *connSettings = currentItem->connection();
-
         // Ask user
         QString const question { "Are you sure you want to delete \"%1\" connection?" };
         int const answer = QMessageBox::question(this,
@@ -353,21 +546,25 @@ namespace Robomongo
         }
         */
 
+        int const row = _listView->currentIndex().row();
         _settingsManager->removeConnection(connSettings);
+        _model->reload();
 
-        delete currentItem;
+        int const count = _model->rowCount();
+        if (count > 0)
+            _listView->setCurrentIndex(_model->index(std::min(row, count - 1), 0));
     }
 
     void ConnectionsDialog::clone()
     {
-        auto currentItem = dynamic_cast<ConnectionListWidgetItem*>(_listWidget->currentItem());
+        ConnectionSettings *const current = _model->connection(_listView->currentIndex());
 
         // Do nothing if no item selected
-        if (!currentItem)
+        if (!current)
             return;
 
         // Clone connection
-        ConnectionSettings *connection = currentItem->connection()->clone();
+        ConnectionSettings *connection = current->clone();
         // This is a special clone which will actually be a new connection and must have unique UUID
         connection->setUuid(QUuid::createUuid().toString());    
         std::string newConnectionName = "Copy of " + connection->connectionName();
@@ -388,33 +585,13 @@ namespace Robomongo
         add(connection);
     }
 
-    /**
-     * @brief Handles ListWidget layoutChanged() signal
-     */
-    void ConnectionsDialog::listWidget_layoutChanged()
+    void ConnectionsDialog::filter(const QString &text)
     {
-        // Make childrens toplevel again. This is a bad, but quickiest item reordering
-        // implementation.
-        for (int i = 0; i < _listWidget->topLevelItemCount(); i++)
-        {
-            auto item = (ConnectionListWidgetItem *) _listWidget->topLevelItem(i);
-            if (item->childCount() > 0) {
-                auto childItem = (ConnectionListWidgetItem *) item->child(0);
-                item->removeChild(childItem);
-                _listWidget->insertTopLevelItem(++i, childItem);
-                _listWidget->setCurrentItem(childItem);
-                break;
-            }
-        }
-
-        SettingsManager::ConnectionSettingsContainerType items;
-        for (int i = 0; i < _listWidget->topLevelItemCount(); i++)
-        {
-            auto item = (ConnectionListWidgetItem *) _listWidget->topLevelItem(i);
-            items.push_back(item->connection());
-        }
+        ConnectionSettings *const current = _model->connection(_listView->currentIndex());
+        _model->setFilter(text);
 
-        _settingsManager->reorderConnections(items);
+        QModelIndex const index = _model->indexOf(current);
+        _listView->setCurrentIndex(index.isValid() || _model->rowCount() == 0 ? index : _model->index(0, 0));
     }
 
     /**
@@ -422,10 +599,12 @@ namespace Robomongo
      */
     void ConnectionsDialog::add(ConnectionSettings *connection)
     {
-        auto item = new ConnectionListWidgetItem(connection);
-        _listWidget->addTopLevelItem(item);
-        _listWidget->setCurrentItem(item);
-        _connectionItems.push_back(item);
+        // New connection is shown even if it does not match search text
+        if (_model->isFiltered())
+            _searchEdit->clear();
+
+        _model->reload();
+        _listView->setCurrentIndex(_model->indexOf(connection));
     }
 
     void ConnectionsDialog::keyPressEvent(QKeyEvent *event) {
@@ -440,6 +619,12 @@ namespace Robomongo
             return;
         }
 
+        // Down arrow moves from search box to found connections
+        if (event->key() == Qt::Key_Down && _searchEdit->hasFocus()) {
+            _listView->setFocus();
+            return;
+        }
+
         // Shift + Return also accepts connection (this shortcut is handled
         // to support DEBUG level logging)
         if (event->key() == Qt::Key_Return && (event->modifiers() & Qt::ShiftModifier)) {
@@ -449,25 +634,4 @@ namespace Robomongo
 
         QDialog::keyPressEvent(event);
     }
-
-    ConnectionsTreeWidget::ConnectionsTreeWidget()
-    {
-        setDragDropMode(QAbstractItemView::InternalMove);
-        setSelectionMode(QAbstractItemView::SingleSelection);
-        setDragEnabled(true);
-        setAcceptDrops(true);
-    }
-
-    void ConnectionsTreeWidget::dropEvent(QDropEvent *event)
-    {
-#ifdef __APPLE__
-        if(_dragDropCount > 0)
-            return;
-#endif
-        QTreeWidget::dropEvent(event);
-        emit layoutChanged();
-#ifdef __APPLE__
-        ++_dragDropCount;
-#endif
-    }
 }
\ No newline at end of file
@@ -1,13 +1,19 @@
 #pragma once
 
 #include <QDialog>
-#include <QTreeWidget>
+#include <QPersistentModelIndex>
 
 #include "robomongo/core/Core.h"
 
+QT_BEGIN_NAMESPACE
+class QLineEdit;
+class QTimer;
+class QTreeView;
+QT_END_NAMESPACE
+
 namespace Robomongo
 {
-    class ConnectionListWidgetItem;
+    class ConnectionsModel;
     class SettingsManager;
     class ConnectionSettings;
 
@@ -19,8 +25,6 @@ namespace Robomongo
         Q_OBJECT
 
     public:
-        typedef std::vector<ConnectionListWidgetItem *> ConnectionListItemContainerType; 
-
         ConnectionsDialog(SettingsManager *manager, bool checkForImported, QWidget *parent = 0);
         ~ConnectionsDialog();
 
@@ -73,13 +77,30 @@ namespace Robomongo
         void clone();
 
         /**
-         * @brief Handles ListWidget layoutChanged() signal
+         * @brief Opens ScriptBroadcastDialog with current connection checked
+         */
+        void runScript();
+
+        /**
+         * @brief Shows only connections containing 'text' in name, address or SSH host
          */
-        void listWidget_layoutChanged();
+        void filter(const QString &text);
+
+        /**
+         * @brief Warms up connection of row, unless another one is selected or hovered
+         *        within WarmUpDelayMs
+         */
+        void scheduleWarmUp(const QModelIndex &index);
+        void warmUp();
+
+        // Fits attributes and auth columns to sampled rows, see utils::fitColumns()
+        void resizeColumns();
 
         void keyPressEvent(QKeyEvent* event) override;
 
     private:
+        static const int WarmUpDelayMs = 300;
+
         /**
          * @brief ConnectionSettings, that was selected after pressing on
          * "Connect" button
@@ -87,42 +108,19 @@ namespace Robomongo
         ConnectionSettings *_selectedConnection;
 
         /**
-         * @brief Main list widget
+         * @brief Main list view, rows are created only when visible
          */
-        QTreeWidget *_listWidget;
+        QTreeView *_listView;
+        ConnectionsModel *_model;
+        QLineEdit *_searchEdit;
+        QTimer *_warmUpTimer;
+        QPersistentModelIndex _warmUpIndex;
 
         /**
          * @brief Settings manager
          */
         SettingsManager *_settingsManager;
 
-        /**
-         * @brief Hash that helps to connect ConnectionSettings with
-         * ConnectionListWidgetItem*
-         */
-        ConnectionListItemContainerType _connectionItems;
-
         bool _checkForImported;
     };    
-
-    class ConnectionsTreeWidget : public QTreeWidget
-    {
-        Q_OBJECT
-    public:
-        ConnectionsTreeWidget();
-
-    Q_SIGNALS:
-        void layoutChanged();
-
-    protected:
-        void dropEvent(QDropEvent *event);
-
-#ifdef __APPLE__
-    // macOS: Set one re-order limit per new connections window. 
-    // Workaround for Qt bug came in Qt 5.12.8.
-    // https://github.com/Studio3T/robomongo/issues/1790
-    private:
-        int _dragDropCount = 0;    
-#endif
-    };
 }
\ No newline at end of file
@@ -26,11 +26,12 @@ namespace Robomongo
         _currentServerName(serverName),
         _currentDatabase(database)
     {
-        QSet<QString> uniqueConnectionsNames;
+        // Items of server combo box are in order of _servers
+        QStringList connectionNames;
         for (auto const& server : AppRegistry::instance().app()->getServers()) {
              if (server->isConnected()) {
                  _servers.push_back(server.get());
-                 uniqueConnectionsNames.insert(QtUtils::toQString(server->connectionRecord()->connectionName()));
+                 connectionNames.append(QtUtils::toQString(server->connectionRecord()->connectionName()));
              }
         }
         
@@ -84,7 +85,7 @@ namespace Robomongo
         databaselayout->addWidget(_databaseComboBox);        
         VERIFY(connect(_serverComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(updateDatabaseComboBox(int))));
 
-        _serverComboBox->addItems(uniqueConnectionsNames.toList());
+        _serverComboBox->addItems(connectionNames);
         QVBoxLayout *layout = new QVBoxLayout();
         layout->addLayout(vlayout);
         layout->addWidget(hline);
@@ -97,15 +98,10 @@ namespace Robomongo
     void CopyCollection::updateDatabaseComboBox(int index)
     {
         _databaseComboBox->clear();
-        const QString &curentServerName = _serverComboBox->currentText();
-        MongoServer *server = nullptr;
-        for (auto const& ser : _servers) {            
-            if (curentServerName == QtUtils::toQString(ser->connectionRecord()->connectionName())) {
-                server = ser;
-                break;
-            }
-        }  
-        if (!server) return;
+        if (index < 0 || index >= static_cast<int>(_servers.size()))
+            return;
+
+        MongoServer *server = _servers[index];
 
         _databaseComboBox->addItems(server->getDatabasesNames());
         if (_currentServerName == QtUtils::toQString(server->connectionRecord()->getFullAddress())) {
@@ -0,0 +1,366 @@
+#include "robomongo/gui/dialogs/CurrentOpsDialog.h"
+
+#include <cstring>
+#include <QCheckBox>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSet>
+#include <QSpinBox>
+#include <QTime>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            OpidColumn, OpColumn, NamespaceColumn, RunningColumn, ClientColumn, 
+            AppNameColumn, DescriptionColumn, PlanColumn, WaitingColumn, CommandColumn, 
+            ColumnCount
+        };
+
+        const int MaxCommandLength = 200;
+        const int MaxTooltipLength = 4000;
+
+        std::string escapeRegex(const std::string &text)
+        {
+            std::string escaped;
+            for (char const c : text) {
+                if (std::strchr("\\^$.|?*+()[]{}", c))
+                    escaped += '\\';
+                escaped += c;
+            }
+            return escaped;
+        }
+
+        // Servers before 3.6 report filter of operation as 'query'
+        mongo::BSONObj commandOf(const mongo::BSONObj &op)
+        {
+            return op.hasField("command") ? op.getObjectField("command") : op.getObjectField("query");
+        }
+
+        QVariant cellValue(const mongo::BSONObj &op, int column)
+        {
+            switch (column) {
+            case OpidColumn: return QtUtils::toQString(op["opid"].toString(false));
+            case OpColumn: return QtUtils::toQString(op.getStringField("op"));
+            case NamespaceColumn: return QtUtils::toQString(op.getStringField("ns"));
+            case RunningColumn: {
+                // Seconds with one decimal, as number so that column sorts numerically
+                mongo::BSONElement const micros = op["microsecs_running"];
+                if (micros.isNumber())
+                    return qRound64(micros.numberLong() / 100000.0) / 10.0;
+                mongo::BSONElement const secs = op["secs_running"];
+                return secs.isNumber() ? QVariant(secs.numberDouble()) : QVariant();
+            }
+            case ClientColumn:
+                return QtUtils::toQString(op.hasField("client") ? op.getStringField("client") 
+                                                                : op.getStringField("client_s"));
+            case AppNameColumn: return QtUtils::toQString(op.getStringField("appName"));
+            case DescriptionColumn: return QtUtils::toQString(op.getStringField("desc"));
+            case PlanColumn: return QtUtils::toQString(op.getStringField("planSummary"));
+            case WaitingColumn: return op["waitingForLock"].trueValue() ? QString("yes") : QString();
+            case CommandColumn: {
+                mongo::BSONObj const command = commandOf(op);
+                if (command.isEmpty())
+                    return QString();
+                QString const json = QtUtils::toQString(
+                    BsonUtils::jsonString(command, mongo::TenGen, 0, DefaultEncoding, Utc));
+                return json.length() > MaxCommandLength ? json.left(MaxCommandLength) + "..." : json;
+            }
+            default: return QVariant();
+            }
+        }
+
+        void setIfChanged(QTreeWidgetItem *item, int column, const QVariant &value, bool &changed)
+        {
+            if (item->data(column, Qt::DisplayRole) == value)
+                return;
+
+            item->setData(column, Qt::DisplayRole, value);
+            changed = true;
+        }
+    }
+
+    CurrentOpsDialog::CurrentOpsDialog(MongoServer *server, const QString &dbName, QWidget *parent) :
+        QDialog(parent), 
+        _server(server),
+        _dbName(dbName),
+        _monitorId(0),
+        _isRefreshing(false),
+        _isRefreshPending(false)
+    {
+        setWindowTitle("Current Operations");
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(1000, 550);
+
+        static int lastMonitorId = 0;
+        _monitorId = ++lastMonitorId;
+
+        AppRegistry::instance().bus()->subscribe(this, CurrentOpsResponse::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, KillOpResponse::Type, server);
+
+        _activeOnly = new QCheckBox("Active only");
+        _activeOnly->setChecked(true);
+        _databaseOnly = new QCheckBox(QString("Database %1 only").arg(dbName));
+        _databaseOnly->setChecked(true);
+
+        _minSecsRunning = new QSpinBox;
+        _minSecsRunning->setRange(0, 24 * 60 * 60);
+        _minSecsRunning->setSuffix(" s");
+
+        _interval = new QSpinBox;
+        _interval->setRange(1, 60);
+        _interval->setValue(2);
+        _interval->setSuffix(" s");
+
+        _pauseButton = new QPushButton("Pause");
+        _pauseButton->setCheckable(true);
+
+        auto filterLayout = new QHBoxLayout;
+        filterLayout->addWidget(_activeOnly);
+        filterLayout->addWidget(_databaseOnly);
+        filterLayout->addWidget(new QLabel("Running at least:"));
+        filterLayout->addWidget(_minSecsRunning);
+        filterLayout->addStretch(1);
+        filterLayout->addWidget(new QLabel("Refresh every:"));
+        filterLayout->addWidget(_interval);
+        filterLayout->addWidget(_pauseButton);
+
+        _tree = new QTreeWidget;
+        _tree->setColumnCount(ColumnCount);
+        _tree->setHeaderLabels(QStringList() << "Opid" << "Op" << "Namespace" << "Running (s)" << "Client" 
+                                             << "Application" << "Description" << "Plan" << "Waiting for lock"
+                                             << "Command");
+        _tree->setRootIsDecorated(false);
+        _tree->setUniformRowHeights(true);
+        _tree->setSelectionMode(QAbstractItemView::ExtendedSelection);
+        _tree->setSortingEnabled(true);
+        _tree->sortByColumn(RunningColumn, Qt::DescendingOrder);
+        _tree->header()->setStretchLastSection(true);
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        _killButton = buttonBox->addButton("Kill Selected", QDialogButtonBox::ActionRole);
+        _killButton->setEnabled(false);
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(filterLayout);
+        layout->addWidget(_tree, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        _timer = new QTimer(this);
+        _timer->setSingleShot(true);
+
+        VERIFY(connect(_timer, SIGNAL(timeout()), this, SLOT(refresh())));
+        VERIFY(connect(_activeOnly, SIGNAL(toggled(bool)), this, SLOT(refreshNow())));
+        VERIFY(connect(_databaseOnly, SIGNAL(toggled(bool)), this, SLOT(refreshNow())));
+        VERIFY(connect(_minSecsRunning, SIGNAL(valueChanged(int)), this, SLOT(refreshNow())));
+        VERIFY(connect(_pauseButton, SIGNAL(toggled(bool)), this, SLOT(togglePause(bool))));
+        VERIFY(connect(_killButton, SIGNAL(clicked()), this, SLOT(killSelected())));
+        VERIFY(connect(_tree, SIGNAL(itemSelectionChanged()), this, SLOT(updateKillButton())));
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+
+        refresh();
+    }
+
+    void CurrentOpsDialog::handle(CurrentOpsResponse *event)
+    {
+        if (event->monitorId != _monitorId)
+            return;
+
+        _isRefreshing = false;
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+        }
+        else {
+            int added = 0, updated = 0, removed = 0;
+            applySnapshot(event->ops, added, updated, removed);
+
+            QString text = QString("%1 operations").arg(event->ops.size());
+            if (event->ops.size() >= MaxOperations)
+                text += QString(" (only first %1 are shown)").arg(MaxOperations);
+            text += QString(", %1 new, %2 changed, %3 finished. Read in %4 ms at %5.")
+                .arg(added).arg(updated).arg(removed).arg(event->elapsedMs)
+                .arg(QTime::currentTime().toString("hh:mm:ss"));
+            _statusLabel->setText(text);
+        }
+
+        if (_isRefreshPending) {
+            _isRefreshPending = false;
+            refresh();
+            return;
+        }
+
+        scheduleRefresh();
+    }
+
+    void CurrentOpsDialog::handle(KillOpResponse *event)
+    {
+        if (event->monitorId != _monitorId)
+            return;
+
+        if (!event->errors.empty()) {
+            QStringList errors;
+            for (auto const &error : event->errors)
+                errors << QtUtils::toQString(error);
+            QMessageBox::warning(this, "Kill Operations", 
+                QString("%1 operations killed, %2 failed:\n\n%3")
+                    .arg(event->killed).arg(event->errors.size()).arg(errors.join("\n")));
+        }
+
+        refreshNow();
+    }
+
+    void CurrentOpsDialog::refresh()
+    {
+        if (_isRefreshing)
+            return;
+
+        _timer->stop();
+        _isRefreshing = true;
+        _server->currentOps(_monitorId, filter(), MaxOperations);
+    }
+
+    void CurrentOpsDialog::refreshNow()
+    {
+        if (_isRefreshing) {
+            _isRefreshPending = true;
+            return;
+        }
+
+        refresh();
+    }
+
+    void CurrentOpsDialog::togglePause(bool paused)
+    {
+        _pauseButton->setText(paused ? "Resume" : "Pause");
+        if (paused)
+            _timer->stop();
+        else
+            refreshNow();
+    }
+
+    void CurrentOpsDialog::killSelected()
+    {
+        QList<QTreeWidgetItem *> const selected = _tree->selectedItems();
+        if (selected.isEmpty())
+            return;
+
+        int const answer = QMessageBox::question(this, "Kill Operations",
+            QString("Kill %1 selected operations?").arg(selected.size()),
+            QMessageBox::Yes, QMessageBox::No, QMessageBox::NoButton);
+        if (answer != QMessageBox::Yes)
+            return;
+
+        std::vector<mongo::BSONObj> opids;
+        for (QTreeWidgetItem *item : selected) {
+            auto const it = _operations.find(item->text(OpidColumn));
+            if (it != _operations.end())
+                opids.push_back(it->opid);
+        }
+        _server->killOps(_monitorId, opids);
+    }
+
+    void CurrentOpsDialog::updateKillButton()
+    {
+        _killButton->setEnabled(!_tree->selectedItems().isEmpty());
+    }
+
+    mongo::BSONObj CurrentOpsDialog::filter() const
+    {
+        mongo::BSONObjBuilder filter;
+        if (_activeOnly->isChecked())
+            filter.append("active", true);
+        if (_databaseOnly->isChecked())
+            filter.appendRegex("ns", "^" + escapeRegex(QtUtils::toStdString(_dbName)) + "\\.");
+        if (_minSecsRunning->value() > 0)
+            filter.append("secs_running", BSON("$gte" << _minSecsRunning->value()));
+        return filter.obj();
+    }
+
+    void CurrentOpsDialog::scheduleRefresh()
+    {
+        // Next snapshot is requested after this one came, so slow server is not flooded
+        if (!_pauseButton->isChecked())
+            _timer->start(_interval->value() * 1000);
+    }
+
+    void CurrentOpsDialog::applySnapshot(const std::vector<mongo::BSONObj> &ops, 
+                                         int &added, int &updated, int &removed)
+    {
+        // Sorting is suspended, otherwise every changed cell moves its row
+        _tree->setSortingEnabled(false);
+
+        QSet<QString> seen;
+        for (mongo::BSONObj const &op : ops) {
+            mongo::BSONElement const opid = op["opid"];
+            if (opid.eoo())
+                continue;
+
+            QString const key = QtUtils::toQString(opid.toString(false));
+            seen.insert(key);
+
+            auto it = _operations.find(key);
+            bool const isNew = it == _operations.end();
+            if (isNew) {
+                mongo::BSONObjBuilder opidObj;
+                opidObj.appendAs(opid, "op");
+                it = _operations.insert(key, Operation { new QTreeWidgetItem(_tree), opidObj.obj() });
+            }
+
+            QTreeWidgetItem *const item = it->item;
+            bool changed = false;
+            for (int column = 0; column < ColumnCount; ++column)
+                setIfChanged(item, column, cellValue(op, column), changed);
+
+            if (changed) {
+                QString tooltip = QtUtils::toQString(
+                    BsonUtils::jsonString(op, mongo::TenGen, 1, DefaultEncoding, Utc));
+                if (tooltip.length() > MaxTooltipLength)
+                    tooltip = tooltip.left(MaxTooltipLength) + "\n...";
+                item->setToolTip(CommandColumn, tooltip);
+            }
+
+            if (isNew)
+                ++added;
+            else if (changed)
+                ++updated;
+        }
+
+        for (auto it = _operations.begin(); it != _operations.end();) {
+            if (seen.contains(it.key())) {
+                ++it;
+                continue;
+            }
+
+            delete it->item;
+            it = _operations.erase(it);
+            ++removed;
+        }
+
+        _tree->setSortingEnabled(true);
+        if (added > 0)
+            _tree->resizeColumnToContents(OpidColumn);
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <QDialog>
+#include <QHash>
+#include <mongo/bson/bsonobj.h>
+
+QT_BEGIN_NAMESPACE
+class QCheckBox;
+class QSpinBox;
+class QPushButton;
+class QLabel;
+class QTimer;
+class QTreeWidget;
+class QTreeWidgetItem;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class CurrentOpsResponse;
+    class KillOpResponse;
+
+    /**
+     * @brief Live list of in-progress operations of server, polled with $currentOp (filtered by
+     *        server) in MongoServer::metadataWorker(). Rows are kept by opid between snapshots,
+     *        so only changed cells are updated and selection survives refresh. Selected
+     *        operations can be killed with killOp.
+     */
+    class CurrentOpsDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * @param dbName Database, which operations are listed when "This database only" is checked
+         */
+        CurrentOpsDialog(MongoServer *server, const QString &dbName, QWidget *parent = 0);
+
+    public Q_SLOTS:
+        void handle(CurrentOpsResponse *event);
+        void handle(KillOpResponse *event);
+
+    private Q_SLOTS:
+        void refresh();
+        void refreshNow();
+        void togglePause(bool paused);
+        void killSelected();
+        void updateKillButton();
+
+    private:
+        struct Operation
+        {
+            QTreeWidgetItem *item;
+            mongo::BSONObj opid;    // { op: <opid> }
+        };
+
+        static const int MaxOperations = 1000;
+
+        mongo::BSONObj filter() const;
+        void scheduleRefresh();
+
+        // Updates rows of operations in snapshot 'ops', removes rows of finished operations
+        void applySnapshot(const std::vector<mongo::BSONObj> &ops, int &added, int &updated, int &removed);
+
+        MongoServer *const _server;
+        QString const _dbName;
+        int _monitorId;
+
+        QCheckBox *_activeOnly;
+        QCheckBox *_databaseOnly;
+        QSpinBox *_minSecsRunning;
+        QSpinBox *_interval;
+        QPushButton *_pauseButton;
+        QPushButton *_killButton;
+        QTreeWidget *_tree;
+        QLabel *_statusLabel;
+        QTimer *_timer;
+
+        QHash<QString, Operation> _operations;  // by opid
+        bool _isRefreshing;
+        bool _isRefreshPending;     // filter changed (or ops were killed) while refreshing
+    };
+}
@@ -0,0 +1,215 @@
+#include "robomongo/gui/dialogs/DataGeneratorDialog.h"
+
+#include <stdexcept>
+#include <QDialogButtonBox>
+#include <QFont>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/shell/bson/json.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        const int DefaultDocuments = 100 * 1000;
+        const int MaxThreads = 16;
+
+        QString millis(long long us)
+        {
+            return QString::number(us / 1000.0, 'f', 1);
+        }
+
+        QString statsText(const GenerateDataProgressEvent::Stats &stats)
+        {
+            double const seconds = stats.elapsedMs / 1000.0;
+            QString text = QString("%1 inserted, %2 failed in %3 s, %4 documents/s.")
+                .arg(stats.inserted)
+                .arg(stats.failed)
+                .arg(seconds, 0, 'f', 1)
+                .arg(seconds > 0 ? stats.inserted / seconds : 0, 0, 'f', 0);
+
+            LatencyHistogram const &latency = stats.latency;
+            if (latency.count() > 0) {
+                text += QString("\nLatency of %1 bulk inserts, ms: p50 %2, p95 %3, p99 %4, max %5.")
+                    .arg(latency.count())
+                    .arg(millis(latency.percentileUs(50)))
+                    .arg(millis(latency.percentileUs(95)))
+                    .arg(millis(latency.percentileUs(99)))
+                    .arg(millis(latency.maxUs()));
+            }
+
+            if (!stats.firstError.empty())
+                text += "\nFirst error: " + QtUtils::toQString(stats.firstError);
+            return text;
+        }
+    }
+
+    DataGeneratorDialog::DataGeneratorDialog(MongoServer *server, const QString &dbName,
+                                             const QString &collectionName, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _collectionName(collectionName),
+        _generateId(0)
+    {
+        setWindowTitle("Generate documents into " + dbName + "." + collectionName);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(640, 480);
+
+        AppRegistry::instance().bus()->subscribe(this, GenerateDataProgressEvent::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, GenerateDataResponse::Type, server);
+
+        _sampleEdit = new QPlainTextEdit;
+        _sampleEdit->setFont(QFont("Courier"));
+        _sampleEdit->setPlaceholderText("Sample document, e.g. { name: \"abc\", age: 30, created: new Date() }\n"
+                                        "Leave empty to take a document of the collection.");
+        _sampleEdit->setToolTip("Fields found in analyzed documents of collection follow their types, "
+                                "missing ratio, distinct values and ranges. Others vary around sample values.");
+
+        _documentsSpin = new QSpinBox;
+        _documentsSpin->setRange(1, 1000 * 1000 * 1000);
+        _documentsSpin->setSingleStep(10 * 1000);
+        _documentsSpin->setValue(DefaultDocuments);
+        _rateSpin = new QSpinBox;
+        _rateSpin->setRange(0, 10 * 1000 * 1000);
+        _rateSpin->setSingleStep(1000);
+        _rateSpin->setSpecialValueText("Unlimited");
+        _rateSpin->setSuffix(" documents/s");
+        _threadsSpin = new QSpinBox;
+        _threadsSpin->setRange(1, MaxThreads);
+        _threadsSpin->setValue(GenerateDataRequest::DefaultThreads);
+        _threadsSpin->setToolTip("Connections inserting in parallel");
+        _sampleSizeSpin = new QSpinBox;
+        _sampleSizeSpin->setRange(0, 1000 * 1000);
+        _sampleSizeSpin->setSingleStep(1000);
+        _sampleSizeSpin->setSpecialValueText("Do not analyze");
+        _sampleSizeSpin->setValue(GenerateDataRequest::DefaultSampleSize);
+        _sampleSizeSpin->setToolTip("Random documents ($sample) of collection analyzed for value distributions");
+
+        auto optionsLayout = new QFormLayout;
+        optionsLayout->addRow("Documents:", _documentsSpin);
+        optionsLayout->addRow("Rate:", _rateSpin);
+        optionsLayout->addRow("Threads:", _threadsSpin);
+        optionsLayout->addRow("Analyzed documents:", _sampleSizeSpin);
+
+        _startButton = new QPushButton("Start");
+        _startButton->setDefault(true);
+        _stopButton = new QPushButton("Stop");
+
+        auto commandLayout = new QHBoxLayout;
+        commandLayout->addWidget(_startButton);
+        commandLayout->addWidget(_stopButton);
+        commandLayout->addStretch(1);
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_startButton, SIGNAL(clicked()), this, SLOT(start())));
+        VERIFY(connect(_stopButton, SIGNAL(clicked()), this, SLOT(stop())));
+
+        auto layout = new QVBoxLayout;
+        layout->addWidget(new QLabel("Sample document:"));
+        layout->addWidget(_sampleEdit, 1);
+        layout->addLayout(optionsLayout);
+        layout->addLayout(commandLayout);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        updateButtons();
+    }
+
+    DataGeneratorDialog::~DataGeneratorDialog()
+    {
+        // Documents are not inserted further, once dialog is closed
+        cancel();
+    }
+
+    void DataGeneratorDialog::cancel()
+    {
+        if (_cancelled)
+            *_cancelled = true;
+        _cancelled.reset();
+    }
+
+    void DataGeneratorDialog::updateButtons()
+    {
+        _startButton->setEnabled(_generateId == 0);
+        _stopButton->setEnabled(_generateId != 0 && _cancelled);
+    }
+
+    void DataGeneratorDialog::start()
+    {
+        mongo::BSONObj sample;
+        QString const text = _sampleEdit->toPlainText().trimmed();
+        if (!text.isEmpty()) {
+            try {
+                sample = mongo::Robomongo::fromjson(QtUtils::toStdString(text));
+            }
+            catch (const std::exception &ex) {
+                _statusLabel->setText("Invalid sample document: " + QtUtils::toQString(ex.what()));
+                return;
+            }
+        }
+
+        static int lastGenerateId = 0;
+        _generateId = ++lastGenerateId;
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+        updateButtons();
+
+        _statusLabel->setText(_sampleSizeSpin->value() > 0 ? "Analyzing documents..." : "Generating documents...");
+        _server->generateData(_generateId,
+                              MongoNamespace(QtUtils::toStdString(_dbName), QtUtils::toStdString(_collectionName)),
+                              sample, _sampleSizeSpin->value(), _documentsSpin->value(), _rateSpin->value(),
+                              _threadsSpin->value(), _cancelled);
+    }
+
+    void DataGeneratorDialog::stop()
+    {
+        // Response with documents inserted so far still comes, once running batches are done
+        cancel();
+        updateButtons();
+        _statusLabel->setText(_statusLabel->text() + "\nStopping...");
+    }
+
+    void DataGeneratorDialog::handle(GenerateDataProgressEvent *event)
+    {
+        if (event->generateId != _generateId)
+            return;
+
+        _statusLabel->setText(statsText(event->stats));
+    }
+
+    void DataGeneratorDialog::handle(GenerateDataResponse *event)
+    {
+        if (event->generateId != _generateId)
+            return;
+
+        bool const stopped = !_cancelled;
+        _generateId = 0;
+        _cancelled.reset();
+        updateButtons();
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        _statusLabel->setText((stopped ? "Stopped. " : "Done. ") + statsText(event->stats));
+    }
+}
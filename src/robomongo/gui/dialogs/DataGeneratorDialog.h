@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QDialog>
+#include <atomic>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QPlainTextEdit;
+class QPushButton;
+class QSpinBox;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class GenerateDataProgressEvent;
+    class GenerateDataResponse;
+
+    /**
+     * @brief Inserts synthetic documents into collection, shaped like sample document and
+     *        following value distributions of collection (see DataGenerator), at given rate.
+     *        Shows throughput and latency percentiles of bulk inserts while it runs.
+     */
+    class DataGeneratorDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        DataGeneratorDialog(MongoServer *server, const QString &dbName, const QString &collectionName,
+                            QWidget *parent = 0);
+        ~DataGeneratorDialog();
+
+    public Q_SLOTS:
+        void handle(GenerateDataProgressEvent *event);
+        void handle(GenerateDataResponse *event);
+
+    private Q_SLOTS:
+        void start();
+        void stop();
+
+    private:
+        void cancel();
+        void updateButtons();
+
+        MongoServer *const _server;
+        QString const _dbName;
+        QString const _collectionName;
+
+        QPlainTextEdit *_sampleEdit;
+        QSpinBox *_documentsSpin;
+        QSpinBox *_rateSpin;
+        QSpinBox *_threadsSpin;
+        QSpinBox *_sampleSizeSpin;
+        QPushButton *_startButton;
+        QPushButton *_stopButton;
+        QLabel *_statusLabel;
+
+        int _generateId;                                // 0, if nothing is being generated
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+}
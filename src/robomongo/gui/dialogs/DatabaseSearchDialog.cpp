@@ -0,0 +1,282 @@
+#include "robomongo/gui/dialogs/DatabaseSearchDialog.h"
+
+#include <QCheckBox>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPlainTextEdit>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QSplitter>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum CollectionColumn { NameColumn, StatusColumn, PlanColumn, HitsColumn, TimeColumn };
+        enum HitColumn { HitCollectionColumn, IdColumn, DocumentColumn };
+
+        QString stateText(const DatabaseSearch::CollectionResult &result)
+        {
+            switch (result.state) {
+            case DatabaseSearch::CollectionResult::Done: return "Done";
+            case DatabaseSearch::CollectionResult::TimedOut: return "Time limit exceeded";
+            case DatabaseSearch::CollectionResult::Cancelled: return "Cancelled";
+            case DatabaseSearch::CollectionResult::Failed: return "Failed";
+            }
+            return QString();
+        }
+    }
+
+    DatabaseSearchDialog::DatabaseSearchDialog(MongoServer *server, const QString &dbName, QWidget *parent) :
+        QDialog(parent), _server(server), _dbName(QtUtils::toStdString(dbName)), _searchId(0)
+    {
+        setWindowTitle("Search Values in " + dbName);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(900, 640);
+
+        AppRegistry::instance().bus()->subscribe(this, DatabaseSearchProgressEvent::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, DatabaseSearchResponse::Type, server);
+
+        _valueEdit = new QLineEdit;
+        _valueEdit->setPlaceholderText("Value, e.g. customer id (number and ObjectId forms are matched too)");
+        _substringCheck = new QCheckBox("Substring (regex)");
+        _substringCheck->setToolTip("Case insensitive substring of string fields, no index is used");
+        _scanCheck = new QCheckBox("Scan fields without index");
+        _scanCheck->setToolTip("Query also sampled top level fields, which have no index");
+        _scanCheck->setChecked(true);
+        _timeLimitSpin = new QSpinBox;
+        _timeLimitSpin->setRange(1, 600);
+        _timeLimitSpin->setValue(5);
+        _timeLimitSpin->setSuffix(" s");
+        _timeLimitSpin->setToolTip("Time limit ($maxTimeMS) of every query");
+        _searchButton = new QPushButton("Search");
+        _searchButton->setDefault(true);
+
+        auto inputLayout = new QHBoxLayout;
+        inputLayout->addWidget(_valueEdit, 1);
+        inputLayout->addWidget(_searchButton);
+        auto optionsLayout = new QHBoxLayout;
+        optionsLayout->addWidget(_substringCheck);
+        optionsLayout->addWidget(_scanCheck);
+        optionsLayout->addStretch(1);
+        optionsLayout->addWidget(new QLabel("Time limit:"));
+        optionsLayout->addWidget(_timeLimitSpin);
+
+        _collections = new QTreeWidget;
+        _collections->setRootIsDecorated(false);
+        _collections->setUniformRowHeights(true);
+        _collections->setSortingEnabled(true);
+        _collections->setHeaderLabels(QStringList() << "Collection" << "Status" << "Plan" << "Hits" << "Time");
+        _collections->header()->setSectionResizeMode(NameColumn, QHeaderView::Stretch);
+        _collections->header()->setStretchLastSection(false);
+        _cancelCollectionButton = new QPushButton("Cancel Collection");
+        _cancelCollectionButton->setToolTip("Stop searching selected collection, the others go on");
+        _cancelCollectionButton->setEnabled(false);
+
+        auto collectionsWidget = new QWidget;
+        auto collectionsLayout = new QVBoxLayout(collectionsWidget);
+        collectionsLayout->setContentsMargins(0, 0, 0, 0);
+        collectionsLayout->addWidget(_collections, 1);
+        collectionsLayout->addWidget(_cancelCollectionButton, 0, Qt::AlignRight);
+
+        _hits = new QTreeWidget;
+        _hits->setRootIsDecorated(false);
+        _hits->setUniformRowHeights(true);
+        _hits->setHeaderLabels(QStringList() << "Collection" << "_id" << "Document");
+        _document = new QPlainTextEdit;
+        _document->setReadOnly(true);
+
+        auto hitsSplitter = new QSplitter(Qt::Vertical);
+        hitsSplitter->addWidget(_hits);
+        hitsSplitter->addWidget(_document);
+        hitsSplitter->setStretchFactor(0, 2);
+        hitsSplitter->setStretchFactor(1, 1);
+
+        auto splitter = new QSplitter(Qt::Horizontal);
+        splitter->addWidget(collectionsWidget);
+        splitter->addWidget(hitsSplitter);
+        splitter->setStretchFactor(0, 2);
+        splitter->setStretchFactor(1, 3);
+
+        _progressBar = new QProgressBar;
+        _progressBar->hide();
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_searchButton, SIGNAL(clicked()), this, SLOT(startOrStop())));
+        VERIFY(connect(_valueEdit, SIGNAL(returnPressed()), this, SLOT(startOrStop())));
+        VERIFY(connect(_cancelCollectionButton, SIGNAL(clicked()), this, SLOT(cancelCollection())));
+        VERIFY(connect(_hits, SIGNAL(currentItemChanged(QTreeWidgetItem *, QTreeWidgetItem *)),
+                       this, SLOT(showHit())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(inputLayout);
+        layout->addLayout(optionsLayout);
+        layout->addWidget(splitter, 1);
+        layout->addWidget(_progressBar);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        _valueEdit->setFocus();
+    }
+
+    DatabaseSearchDialog::~DatabaseSearchDialog()
+    {
+        // Collections are not searched further for closed dialog
+        if (_cancellation)
+            _cancellation->cancelAll();
+    }
+
+    void DatabaseSearchDialog::startOrStop()
+    {
+        if (_searchId) {
+            _cancellation->cancelAll();
+            _statusLabel->setText("Stopping...");
+            _searchButton->setEnabled(false);
+            return;
+        }
+
+        if (_valueEdit->text().isEmpty())
+            return;
+
+        DatabaseSearch::Options options;
+        options.value = QtUtils::toStdString(_valueEdit->text());
+        options.substring = _substringCheck->isChecked();
+        options.scanUnindexed = _scanCheck->isChecked();
+        options.maxTimeMs = _timeLimitSpin->value() * 1000;
+
+        _collections->clear();
+        _collectionItems.clear();
+        _hits->clear();
+        _document->clear();
+        _progressBar->setRange(0, 0);
+        _statusLabel->setText("Searching...");
+        setRunning(true);
+
+        static int lastSearchId = 0;
+        _searchId = ++lastSearchId;
+        _cancellation = std::make_shared<DatabaseSearch::Cancellation>();
+        _server->searchDatabase(_searchId, _dbName, options, _cancellation);
+    }
+
+    void DatabaseSearchDialog::cancelCollection()
+    {
+        if (!_cancellation)
+            return;
+
+        for (QTreeWidgetItem *item : _collections->selectedItems()) {
+            if (!item->text(StatusColumn).startsWith("Searching"))
+                continue;
+            _cancellation->cancel(QtUtils::toStdString(item->text(NameColumn)));
+            item->setText(StatusColumn, "Cancelling...");
+        }
+    }
+
+    void DatabaseSearchDialog::showHit()
+    {
+        QTreeWidgetItem *item = _hits->currentItem();
+        _document->setPlainText(item ? item->data(DocumentColumn, Qt::UserRole).toString() : QString());
+    }
+
+    void DatabaseSearchDialog::handle(DatabaseSearchProgressEvent *event)
+    {
+        if (event->searchId != _searchId)
+            return;
+
+        _progressBar->setRange(0, event->total);
+        for (auto const &collection : event->started)
+            collectionItem(collection)->setText(StatusColumn, "Searching...");
+
+        for (auto const &result : event->finished) {
+            QTreeWidgetItem *item = collectionItem(result.collection);
+            item->setText(StatusColumn, stateText(result));
+            item->setText(PlanColumn, QtUtils::toQString(result.plan));
+            item->setData(HitsColumn, Qt::DisplayRole, result.hits);
+            item->setData(TimeColumn, Qt::DisplayRole, QString::number(result.elapsedMs / 1000.0, 'f', 2) + " s");
+            item->setToolTip(StatusColumn, QtUtils::toQString(result.error));
+        }
+        _progressBar->setValue(_progressBar->value() + static_cast<int>(event->finished.size()));
+
+        QList<QTreeWidgetItem *> items;
+        for (auto const &hit : event->hits) {
+            mongo::BSONObj const obj = hit.document->bsonObj();
+            auto item = new QTreeWidgetItem;
+            item->setText(HitCollectionColumn, QtUtils::toQString(hit.collection));
+            item->setText(IdColumn, QtUtils::toQString(obj["_id"].toString(false)));
+            item->setText(DocumentColumn, QtUtils::toQString(
+                BsonUtils::jsonString(obj, mongo::TenGen, 0, DefaultEncoding, Utc)));
+            item->setData(DocumentColumn, Qt::UserRole, QtUtils::toQString(
+                BsonUtils::jsonString(obj, mongo::TenGen, 1, DefaultEncoding, Utc)));
+            items.append(item);
+        }
+        _hits->addTopLevelItems(items);
+    }
+
+    void DatabaseSearchDialog::handle(DatabaseSearchResponse *event)
+    {
+        if (event->searchId != _searchId)
+            return;
+
+        _searchId = 0;
+        bool const stopped = _cancellation->isCancelled();
+        _cancellation.reset();
+        setRunning(false);
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        // Collections not started before stop are left without state
+        for (QTreeWidgetItem *item : _collectionItems) {
+            if (item->text(StatusColumn).endsWith("..."))
+                item->setText(StatusColumn, "Cancelled");
+        }
+
+        _statusLabel->setText(QString("%1 documents found in %2 s%3.")
+                              .arg(event->hits).arg(event->elapsedMs / 1000.0, 0, 'f', 1)
+                              .arg(stopped ? ", search was stopped" : ""));
+    }
+
+    void DatabaseSearchDialog::setRunning(bool running)
+    {
+        _searchButton->setText(running ? "Stop" : "Search");
+        _searchButton->setEnabled(true);
+        _valueEdit->setEnabled(!running);
+        _substringCheck->setEnabled(!running);
+        _scanCheck->setEnabled(!running);
+        _timeLimitSpin->setEnabled(!running);
+        _cancelCollectionButton->setEnabled(running);
+        _progressBar->setVisible(running);
+        _progressBar->setValue(0);
+    }
+
+    QTreeWidgetItem *DatabaseSearchDialog::collectionItem(const std::string &collection)
+    {
+        QString const name = QtUtils::toQString(collection);
+        QTreeWidgetItem *&item = _collectionItems[name];
+        if (!item) {
+            item = new QTreeWidgetItem(_collections);
+            item->setText(NameColumn, name);
+        }
+        return item;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QDialog>
+#include <QHash>
+#include <memory>
+
+#include "robomongo/core/domain/DatabaseSearch.h"
+
+QT_BEGIN_NAMESPACE
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QPlainTextEdit;
+class QProgressBar;
+class QPushButton;
+class QSpinBox;
+class QTreeWidget;
+class QTreeWidgetItem;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class DatabaseSearchProgressEvent;
+    class DatabaseSearchResponse;
+
+    /**
+     * @brief Finds value (i.e. customer id) in all collections of database. Collections are
+     *        searched in the worker of server on several connections (see
+     *        MongoServer::searchDatabase()); hits and state of every collection are shown as
+     *        they come, slow collections may be cancelled one by one.
+     */
+    class DatabaseSearchDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        DatabaseSearchDialog(MongoServer *server, const QString &dbName, QWidget *parent = 0);
+        ~DatabaseSearchDialog();
+
+    public Q_SLOTS:
+        void handle(DatabaseSearchProgressEvent *event);
+        void handle(DatabaseSearchResponse *event);
+
+    private Q_SLOTS:
+        void startOrStop();
+        void cancelCollection();
+        void showHit();
+
+    private:
+        void setRunning(bool running);
+        QTreeWidgetItem *collectionItem(const std::string &collection);
+
+        MongoServer *_server;
+        std::string _dbName;
+
+        QLineEdit *_valueEdit;
+        QCheckBox *_substringCheck;
+        QCheckBox *_scanCheck;
+        QSpinBox *_timeLimitSpin;
+        QPushButton *_searchButton;
+        QTreeWidget *_collections;
+        QPushButton *_cancelCollectionButton;
+        QTreeWidget *_hits;
+        QPlainTextEdit *_document;
+        QProgressBar *_progressBar;
+        QLabel *_statusLabel;
+
+        QHash<QString, QTreeWidgetItem *> _collectionItems;
+        int _searchId;                                  // 0, if search is not running
+        std::shared_ptr<DatabaseSearch::Cancellation> _cancellation;
+    };
+}
@@ -0,0 +1,112 @@
+#include "robomongo/gui/dialogs/DatabaseStatsDialog.h"
+
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QDialogButtonBox>
+#include <QProgressBar>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/domain/MongoUtils.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/gui/widgets/workarea/CollectionStatsTreeWidget.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        QString summaryText(const mongo::BSONObj &stats)
+        {
+            return QString("%1 collections, %2 views, %3 objects, %4 indexes<br/>"
+                           "Data: %5, storage: %6, indexes: %7")
+                .arg(stats.getField("collections").numberLong())
+                .arg(stats.getField("views").numberLong())
+                .arg(stats.getField("objects").numberLong())
+                .arg(stats.getField("indexes").numberLong())
+                .arg(MongoUtils::buildNiceSizeString(stats.getField("dataSize").numberDouble()))
+                .arg(MongoUtils::buildNiceSizeString(stats.getField("storageSize").numberDouble()))
+                .arg(MongoUtils::buildNiceSizeString(stats.getField("indexSize").numberDouble()));
+        }
+    }
+
+    DatabaseStatsDialog::DatabaseStatsDialog(MongoServer *server, const QString &dbName, QWidget *parent) :
+        QDialog(parent), _statsId(0)
+    {
+        setWindowTitle("Statistics of " + dbName);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        resize(800, 500);
+
+        AppRegistry::instance().bus()->subscribe(this, DatabaseStatsProgressEvent::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, DatabaseStatsResponse::Type, server);
+
+        _summaryLabel = new QLabel;
+        _summaryLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        _progressBar = new QProgressBar;
+        _progressBar->setRange(0, 0);
+        _statusLabel = new QLabel("Reading statistics...");
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        _statsWidget = new CollectionStatsTreeWidget(std::vector<MongoDocumentPtr>(), this, true);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+
+        auto layout = new QVBoxLayout();
+        layout->addWidget(_summaryLabel);
+        layout->addWidget(_statsWidget, 1);
+        layout->addWidget(_progressBar);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        static int lastStatsId = 0;
+        _statsId = ++lastStatsId;
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+        server->databaseStats(_statsId, QtUtils::toStdString(dbName), _cancelled);
+    }
+
+    DatabaseStatsDialog::~DatabaseStatsDialog()
+    {
+        // Statistics of closed dialog are not read further
+        if (_cancelled)
+            *_cancelled = true;
+    }
+
+    void DatabaseStatsDialog::handle(DatabaseStatsProgressEvent *event)
+    {
+        if (event->statsId != _statsId)
+            return;
+
+        _progressBar->setRange(0, event->total);
+        _progressBar->setValue(event->done);
+        _statsWidget->appendDocuments(event->collections);
+    }
+
+    void DatabaseStatsDialog::handle(DatabaseStatsResponse *event)
+    {
+        if (event->statsId != _statsId)
+            return;
+
+        _statsId = 0;
+        _cancelled.reset();
+        _progressBar->hide();
+        _statsWidget->resizeColumns();
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        if (event->databaseStats)
+            _summaryLabel->setText(summaryText(event->databaseStats->bsonObj()));
+
+        QString text = QString("Read in %1 s.").arg(event->elapsedMs / 1000.0, 0, 'f', 1);
+        if (event->skipped > 0)
+            text += QString(" %1 views or collections without access rights have no statistics.")
+                .arg(event->skipped);
+        _statusLabel->setText(text);
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QDialog>
+#include <atomic>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QProgressBar;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class CollectionStatsTreeWidget;
+    class DatabaseStatsProgressEvent;
+    class DatabaseStatsResponse;
+
+    /**
+     * @brief Shows dbStats of database and collStats of all its collections with totals.
+     *        Statistics are read in the worker of server on several connections (see
+     *        MongoServer::databaseStats()), rows are added as they come.
+     */
+    class DatabaseStatsDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        DatabaseStatsDialog(MongoServer *server, const QString &dbName, QWidget *parent = 0);
+        ~DatabaseStatsDialog();
+
+    public Q_SLOTS:
+        void handle(DatabaseStatsProgressEvent *event);
+        void handle(DatabaseStatsResponse *event);
+
+    private:
+        QLabel *_summaryLabel;
+        QProgressBar *_progressBar;
+        QLabel *_statusLabel;
+        CollectionStatsTreeWidget *_statsWidget;
+
+        int _statsId;                                   // 0, if statistics were read
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+}
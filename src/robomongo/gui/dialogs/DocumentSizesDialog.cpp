@@ -0,0 +1,246 @@
+#include "robomongo/gui/dialogs/DocumentSizesDialog.h"
+
+#include <algorithm>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QSplitter>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/MongoUtils.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum HistogramColumn
+        {
+            RangeColumn, DocumentsColumn, PercentColumn, BarColumn, HistogramColumnCount
+        };
+
+        enum LargestColumn
+        {
+            IdColumn, SizeColumn, LargestColumnCount
+        };
+
+        // _id in shell syntax, data of items of largest documents
+        const int IdRole = Qt::UserRole + 1;
+
+        const int DefaultSampleSize = 100 * 1000;
+        const int BarWidth = 40;
+    }
+
+    DocumentSizesDialog::DocumentSizesDialog(MongoServer *server, const QString &dbName,
+                                             const QString &collectionName, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _collectionName(collectionName),
+        _sizesId(0)
+    {
+        setWindowTitle("Document sizes of " + dbName + "." + collectionName);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(800, 600);
+
+        AppRegistry::instance().bus()->subscribe(this, DocumentSizesResponse::Type, server);
+
+        _sampleSizeSpin = new QSpinBox;
+        _sampleSizeSpin->setRange(0, 100 * 1000 * 1000);
+        _sampleSizeSpin->setSingleStep(10 * 1000);
+        _sampleSizeSpin->setSpecialValueText("Whole collection");
+        _sampleSizeSpin->setValue(DefaultSampleSize);
+        _sampleSizeSpin->setToolTip("Random documents ($sample) measured. Memory used does not depend on it.");
+        _topCountSpin = new QSpinBox;
+        _topCountSpin->setRange(1, 1000);
+        _topCountSpin->setValue(DocumentSizesRequest::DefaultTopCount);
+        _analyzeButton = new QPushButton("Analyze");
+        _analyzeButton->setDefault(true);
+
+        auto commandLayout = new QHBoxLayout;
+        commandLayout->addWidget(new QLabel("Sample size:"));
+        commandLayout->addWidget(_sampleSizeSpin);
+        commandLayout->addWidget(new QLabel("Largest:"));
+        commandLayout->addWidget(_topCountSpin);
+        commandLayout->addWidget(_analyzeButton);
+        commandLayout->addStretch(1);
+
+        _histogram = new QTreeWidget;
+        _histogram->setColumnCount(HistogramColumnCount);
+        _histogram->setHeaderLabels(QStringList() << "Size" << "Documents" << "%" << "");
+        _histogram->setRootIsDecorated(false);
+        _histogram->setUniformRowHeights(true);
+
+        _largest = new QTreeWidget;
+        _largest->setColumnCount(LargestColumnCount);
+        _largest->setHeaderLabels(QStringList() << "_id" << "Size");
+        _largest->setRootIsDecorated(false);
+        _largest->setUniformRowHeights(true);
+        _largest->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+        auto splitter = new QSplitter(Qt::Vertical);
+        splitter->addWidget(_histogram);
+        splitter->addWidget(_largest);
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        _openButton = buttonBox->addButton("Open in Shell", QDialogButtonBox::ActionRole);
+        _openButton->setToolTip("Opens selected largest documents (all, if none is selected)");
+        _openButton->setEnabled(false);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_openButton, SIGNAL(clicked()), this, SLOT(openSelected())));
+        VERIFY(connect(_analyzeButton, SIGNAL(clicked()), this, SLOT(analyze())));
+        VERIFY(connect(_largest, SIGNAL(itemDoubleClicked(QTreeWidgetItem *, int)), this, SLOT(openSelected())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(commandLayout);
+        layout->addWidget(splitter, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        analyze();
+    }
+
+    DocumentSizesDialog::~DocumentSizesDialog()
+    {
+        // Documents of closed dialog are not read further
+        cancel();
+    }
+
+    void DocumentSizesDialog::cancel()
+    {
+        if (_cancelled)
+            *_cancelled = true;
+        _cancelled.reset();
+    }
+
+    void DocumentSizesDialog::analyze()
+    {
+        cancel();
+
+        static int lastSizesId = 0;
+        _sizesId = ++lastSizesId;
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+
+        _analyzeButton->setEnabled(false);
+        _statusLabel->setText("Measuring documents...");
+        _server->documentSizes(_sizesId,
+                               MongoNamespace(QtUtils::toStdString(_dbName), QtUtils::toStdString(_collectionName)),
+                               _sampleSizeSpin->value(), _topCountSpin->value(), _cancelled);
+    }
+
+    void DocumentSizesDialog::handle(DocumentSizesResponse *event)
+    {
+        if (event->sizesId != _sizesId)
+            return;
+
+        _sizesId = 0;
+        _cancelled.reset();
+        _analyzeButton->setEnabled(true);
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        DocumentSizeHistogram const &histogram = event->histogram;
+
+        // Empty buckets at both ends are not shown
+        int first = 0;
+        int last = DocumentSizeHistogram::BucketCount - 1;
+        while (first < last && histogram.count(first) == 0)
+            ++first;
+        while (last > first && histogram.count(last) == 0)
+            --last;
+
+        long long maxCount = 1;
+        for (int bucket = first; bucket <= last; ++bucket)
+            maxCount = std::max(maxCount, histogram.count(bucket));
+
+        _histogram->clear();
+        for (int bucket = first; bucket <= last && histogram.documents() > 0; ++bucket) {
+            long long const count = histogram.count(bucket);
+            auto item = new QTreeWidgetItem(_histogram);
+            item->setText(RangeColumn, QString("%1 - %2")
+                .arg(MongoUtils::buildNiceSizeString(DocumentSizeHistogram::bucketLowerBytes(bucket)))
+                .arg(MongoUtils::buildNiceSizeString(DocumentSizeHistogram::bucketLowerBytes(bucket + 1))));
+            item->setText(DocumentsColumn, QString::number(count));
+            item->setText(PercentColumn, QString::number(100.0 * count / histogram.documents(), 'f', 1));
+            item->setText(BarColumn, QString(static_cast<int>((BarWidth * count + maxCount - 1) / maxCount),
+                                             QChar(0x2588)));
+            item->setTextAlignment(DocumentsColumn, Qt::AlignRight | Qt::AlignVCenter);
+            item->setTextAlignment(PercentColumn, Qt::AlignRight | Qt::AlignVCenter);
+        }
+        for (int column = 0; column < HistogramColumnCount; ++column)
+            _histogram->resizeColumnToContents(column);
+
+        UUIDEncoding const uuidEncoding = AppRegistry::instance().settingsManager()->uuidEncoding();
+        SupportedTimes const timeZone = AppRegistry::instance().settingsManager()->timeZone();
+        _largest->clear();
+        for (DocumentSizeHistogram::Document const &document : histogram.largest()) {
+            auto item = new QTreeWidgetItem(_largest);
+            if (document.id.isEmpty()) {
+                // Cannot be found again, e.g. in collections with autoIndexId: false
+                item->setText(IdColumn, "(no _id)");
+            } else {
+                QString const id = QtUtils::toQString(BsonUtils::jsonString(document.id.firstElement(),
+                    mongo::TenGen, false, 0, uuidEncoding, timeZone));
+                item->setText(IdColumn, id);
+                item->setData(IdColumn, IdRole, id);
+            }
+            item->setText(SizeColumn, MongoUtils::buildNiceSizeString(document.size));
+            item->setTextAlignment(SizeColumn, Qt::AlignRight | Qt::AlignVCenter);
+        }
+        for (int column = 0; column < LargestColumnCount; ++column)
+            _largest->resizeColumnToContents(column);
+        updateOpenButton();
+
+        double const average = histogram.documents() > 0 ?
+            static_cast<double>(histogram.totalBytes()) / histogram.documents() : 0;
+        _statusLabel->setText(QString("%1 documents, %2 in total, %3 on average, measured %4 in %5 s.")
+            .arg(histogram.documents())
+            .arg(MongoUtils::buildNiceSizeString(histogram.totalBytes()))
+            .arg(MongoUtils::buildNiceSizeString(average))
+            .arg(event->serverSide ? "by server" : "by client (server has no $bsonSize)")
+            .arg(event->elapsedMs / 1000.0, 0, 'f', 1));
+    }
+
+    void DocumentSizesDialog::updateOpenButton()
+    {
+        _openButton->setEnabled(_largest->topLevelItemCount() > 0);
+    }
+
+    void DocumentSizesDialog::openSelected()
+    {
+        QList<QTreeWidgetItem *> items = _largest->selectedItems();
+        if (items.isEmpty()) {
+            for (int i = 0; i < _largest->topLevelItemCount(); ++i)
+                items << _largest->topLevelItem(i);
+        }
+
+        QStringList ids;
+        for (QTreeWidgetItem *item : items) {
+            QString const id = item->data(IdColumn, IdRole).toString();
+            if (!id.isEmpty())
+                ids << id;
+        }
+        if (ids.isEmpty())
+            return;
+
+        emit openDocumentsRequested(QString("find({ _id: { $in: [ %1 ] } })").arg(ids.join(", ")));
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QDialog>
+#include <atomic>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QPushButton;
+class QSpinBox;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class DocumentSizesResponse;
+
+    /**
+     * @brief Shows log-scale histogram of document sizes of collection and its largest
+     *        documents (see DocumentSizeHistogram). Selected documents can be opened in shell.
+     */
+    class DocumentSizesDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        DocumentSizesDialog(MongoServer *server, const QString &dbName, const QString &collectionName,
+                            QWidget *parent = 0);
+        ~DocumentSizesDialog();
+
+    Q_SIGNALS:
+        // 'script' is find() of ids of selected documents, to be run on the collection
+        void openDocumentsRequested(const QString &script);
+
+    public Q_SLOTS:
+        void handle(DocumentSizesResponse *event);
+
+    private Q_SLOTS:
+        void analyze();
+        void openSelected();
+
+    private:
+        void cancel();
+        void updateOpenButton();
+
+        MongoServer *const _server;
+        QString const _dbName;
+        QString const _collectionName;
+
+        QSpinBox *_sampleSizeSpin;
+        QSpinBox *_topCountSpin;
+        QPushButton *_analyzeButton;
+        QPushButton *_openButton;
+        QLabel *_statusLabel;
+        QTreeWidget *_histogram;
+        QTreeWidget *_largest;
+
+        int _sizesId;                                   // 0, if nothing is being analyzed
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+}
@@ -1,5 +1,7 @@
 #include "robomongo/gui/dialogs/DocumentTextEditor.h"
 
+#include <algorithm>
+
 #include <QApplication>
 #include <QHBoxLayout>
 #include <QPushButton>
@@ -7,19 +9,27 @@
 #include <QDialogButtonBox>
 #include <QDesktopWidget>
 #include <QSettings>
+#include <QLabel>
+#include <QTimer>
 #include <Qsci/qscilexerjavascript.h>
 
 #include <mongo/client/dbclient_base.h>
 
+#include "robomongo/gui/dialogs/DocumentValidateThread.h"
 #include "robomongo/gui/editors/JSLexer.h"
 #include "robomongo/gui/editors/FindFrame.h"
 #include "robomongo/gui/editors/PlainJavaScriptEditor.h"
 #include "robomongo/gui/widgets/workarea/IndicatorLabel.h"
 #include "robomongo/gui/GuiRegistry.h"
 
+#include "robomongo/core/utils/JsonDocuments.h"
 #include "robomongo/core/utils/QtUtils.h"
-#include "robomongo/shell/bson/json.h"
 
+namespace
+{
+    // Delay after last change of text before it is validated
+    const int validateDelayMs = 300;
+}
 
 namespace Robomongo
 {
@@ -28,7 +38,11 @@ namespace Robomongo
     DocumentTextEditor::DocumentTextEditor(const CollectionInfo &info, const QString &json, bool readonly /* = false */, QWidget *parent) :
         QDialog(parent),
         _info(info),
-        _readonly(readonly)
+        _errorIndicator(0),
+        _readonly(readonly),
+        _validateThread(NULL),
+        _parsedRevision(-1),
+        _revision(0)
     {
         QRect screenGeometry = QApplication::desktop()->availableGeometry();
         int horizontalMargin = (int)(screenGeometry.width() * 0.35);
@@ -64,6 +78,15 @@ namespace Robomongo
 
         VERIFY(connect(_queryText->sciScintilla(), SIGNAL(textChanged()), this, SLOT(onQueryTextChanged())));
 
+        _validationStatus = new QLabel;
+        _validationStatus->setStyleSheet("QLabel { color: #c00000; }");
+        _validationStatus->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        _validateTimer = new QTimer(this);
+        _validateTimer->setSingleShot(true);
+        _validateTimer->setInterval(validateDelayMs);
+        VERIFY(connect(_validateTimer, SIGNAL(timeout()), this, SLOT(startValidation())));
+
         QHBoxLayout *hlayout = new QHBoxLayout();
         hlayout->setContentsMargins(2, 0, 5, 1);
         hlayout->setSpacing(0);
@@ -80,7 +103,7 @@ namespace Robomongo
 
         QHBoxLayout *bottomlayout = new QHBoxLayout();
         bottomlayout->addWidget(validate);
-        bottomlayout->addStretch(1);
+        bottomlayout->addWidget(_validationStatus, 1);
         bottomlayout->addWidget(buttonBox);
 
         QVBoxLayout *layout = new QVBoxLayout();
@@ -98,6 +121,16 @@ namespace Robomongo
             buttonBox->button(QDialogButtonBox::Save)->hide();
             _queryText->sciScintilla()->setReadOnly(true);
         }
+        else {
+            // Documents of initial text are parsed in advance, so that saving
+            // parses only documents changed since
+            startValidation();
+        }
+    }
+
+    DocumentTextEditor::~DocumentTextEditor()
+    {
+        stopValidation();
     }
 
     QString DocumentTextEditor::jsonText() const
@@ -146,34 +179,26 @@ namespace Robomongo
 
     bool DocumentTextEditor::validate(bool silentOnSuccess /* = true */)
     {
-        QString text = jsonText();
-        int len = 0;
-        try {
-            std::string textString = QtUtils::toStdString(text);
-            const char *json = textString.c_str();
-            int jsonLen = textString.length();
-            int offset = 0;
-            _obj.clear();
-            while (offset != jsonLen)
-            {
-                mongo::BSONObj doc = mongo::Robomongo::fromjson(json+offset, &len);
-                _obj.push_back(doc);
-                offset += len;
-            }
-        } catch (const mongo::Robomongo::ParseMsgAssertionException &ex) {
-//            v0.9
-            QString message = QtUtils::toQString(ex.reason());
-            int offset = ex.offset();
+        // Background result is used if text did not change since, otherwise only
+        // documents changed after it are parsed
+        if (!_parsed || _parsedRevision != _revision) {
+            stopValidation();
+            _validateTimer->stop();
+            _parsed = JsonDocuments::parse(textSnapshot(), _parsed);
+            _parsedRevision = _revision;
+        }
 
-            int line = 0, pos = 0;
-            _queryText->sciScintilla()->lineIndexFromPosition(offset, &line, &pos);
-            _queryText->sciScintilla()->setCursorPosition(line, pos);
+        showValidationResult();
+        _obj.clear();
 
-            int lineHeight = _queryText->sciScintilla()->lineLength(line);
-            _queryText->sciScintilla()->fillIndicatorRange(line, pos, line, lineHeight, 0);
+        if (!_parsed->isValid()) {
+            QsciScintilla *sci = _queryText->sciScintilla();
+            int line = 0, pos = 0;
+            sci->lineIndexFromPosition(_parsed->errorOffset(), &line, &pos);
+            sci->setCursorPosition(line, pos);
 
-            message = QString("Unable to parse JSON:<br /> <b>%1</b>, at (%2, %3).")
-                .arg(message).arg(line + 1).arg(pos + 1);
+            QString const message = QString("Unable to parse JSON:<br /> <b>%1</b>, at (%2, %3).")
+                .arg(QtUtils::toQString(_parsed->errorReason())).arg(line + 1).arg(pos + 1);
 
             QMessageBox::critical(NULL, "Parsing error", message);
             _queryText->setFocus();
@@ -181,6 +206,8 @@ namespace Robomongo
             return false;
         }
 
+        _obj = _parsed->documents();
+
         if (!silentOnSuccess) {
             QMessageBox::information(NULL, "Validation", "JSON is valid!");
             _queryText->setFocus();
@@ -192,7 +219,18 @@ namespace Robomongo
 
     void DocumentTextEditor::onQueryTextChanged()
     {
-        _queryText->sciScintilla()->clearIndicatorRange(0, 0, _queryText->sciScintilla()->lines(), 40, 0);
+        ++_revision;
+        stopValidation();
+
+        // Error of previous text is hidden until new text is validated
+        long const length = _queryText->sciScintilla()->SendScintilla(QsciScintilla::SCI_GETLENGTH);
+        _queryText->sciScintilla()->SendScintilla(QsciScintilla::SCI_SETINDICATORCURRENT,
+                                                  static_cast<unsigned long>(_errorIndicator));
+        _queryText->sciScintilla()->SendScintilla(QsciScintilla::SCI_INDICATORCLEARRANGE, 0ul, length);
+        _validationStatus->clear();
+
+        if (!_readonly)
+            _validateTimer->start();
     }
 
     void DocumentTextEditor::onValidateButtonClicked()
@@ -200,6 +238,69 @@ namespace Robomongo
         validate(false);
     }
 
+    std::string DocumentTextEditor::textSnapshot() const
+    {
+        QsciScintilla *sci = _queryText->sciScintilla();
+        const char *data = static_cast<const char *>(sci->SendScintillaPtrResult(QsciScintilla::SCI_GETCHARACTERPOINTER));
+        long const length = sci->SendScintilla(QsciScintilla::SCI_GETLENGTH);
+        return data && length > 0 ? std::string(data, length) : std::string();
+    }
+
+    void DocumentTextEditor::startValidation()
+    {
+        stopValidation();
+        _validateThread = new DocumentValidateThread(textSnapshot(), _parsed, _revision);
+        VERIFY(connect(_validateThread, SIGNAL(validated()), this, SLOT(validationDone())));
+        VERIFY(connect(_validateThread, SIGNAL(finished()), _validateThread, SLOT(deleteLater())));
+        _validateThread->start();
+    }
+
+    void DocumentTextEditor::stopValidation()
+    {
+        if (!_validateThread)
+            return;
+
+        // Thread deletes itself when finished
+        _validateThread->stop();
+        _validateThread = NULL;
+    }
+
+    void DocumentTextEditor::validationDone()
+    {
+        DocumentValidateThread *thread = qobject_cast<DocumentValidateThread *>(sender());
+        if (!thread || thread != _validateThread || thread->revision() != _revision)
+            return;
+
+        _validateThread = NULL;
+        _parsed = thread->result();
+        _parsedRevision = thread->revision();
+        showValidationResult();
+    }
+
+    void DocumentTextEditor::showValidationResult()
+    {
+        QsciScintilla *sci = _queryText->sciScintilla();
+        long const length = sci->SendScintilla(QsciScintilla::SCI_GETLENGTH);
+        sci->SendScintilla(QsciScintilla::SCI_SETINDICATORCURRENT, static_cast<unsigned long>(_errorIndicator));
+        sci->SendScintilla(QsciScintilla::SCI_INDICATORCLEARRANGE, 0ul, length);
+
+        if (_parsed->isValid()) {
+            _validationStatus->clear();
+            return;
+        }
+
+        // Rest of line from error position is marked, at least one character
+        long const offset = std::min<long>(_parsed->errorOffset(), std::max(0L, length - 1));
+        int line = 0, pos = 0;
+        sci->lineIndexFromPosition(offset, &line, &pos);
+        long const lineEnd = sci->SendScintilla(QsciScintilla::SCI_GETLINEENDPOSITION, static_cast<unsigned long>(line));
+        sci->SendScintilla(QsciScintilla::SCI_INDICATORFILLRANGE, static_cast<unsigned long>(offset),
+                           std::max(1L, lineEnd - offset));
+
+        _validationStatus->setText(QString("Line %1, column %2: %3").arg(line + 1).arg(pos + 1)
+                                   .arg(QtUtils::toQString(_parsed->errorReason())));
+    }
+
     void DocumentTextEditor::closeEvent(QCloseEvent *event)
     {
         saveWindowSettings();
@@ -218,6 +319,8 @@ namespace Robomongo
         _queryText->sciScintilla()->setFont(font);
         _queryText->sciScintilla()->setPaper(QColor(255, 0, 0, 127));
         _queryText->sciScintilla()->setLexer(javaScriptLexer);
+        _errorIndicator = _queryText->sciScintilla()->indicatorDefine(QsciScintilla::SquiggleIndicator);
+        _queryText->sciScintilla()->setIndicatorForegroundColor(QColor(Qt::red), _errorIndicator);
         _queryText->sciScintilla()->setWrapMode((QsciScintilla::WrapMode)QsciScintilla::SC_WRAP_WORD);
         _queryText->sciScintilla()->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
         _queryText->sciScintilla()->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
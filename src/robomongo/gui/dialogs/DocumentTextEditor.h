@@ -1,12 +1,20 @@
 #pragma once
 
 #include <QDialog>
+#include <memory>
 #include <mongo/bson/bsonobj.h>
 #include "robomongo/core/domain/MongoQueryInfo.h"
 
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QTimer;
+QT_END_NAMESPACE
+
 namespace Robomongo
 {
     class FindFrame;
+    class JsonDocuments;
+    class DocumentValidateThread;
 
     class DocumentTextEditor : public QDialog
     {
@@ -17,6 +25,7 @@ namespace Robomongo
         static const QSize minimumSize;
 
         explicit DocumentTextEditor(const CollectionInfo &info, const QString &json, bool readonly = false, QWidget *parent = 0);
+        ~DocumentTextEditor();
 
         QString jsonText() const;
 
@@ -35,6 +44,8 @@ namespace Robomongo
     private Q_SLOTS:
         void onQueryTextChanged();
         void onValidateButtonClicked();
+        void startValidation();
+        void validationDone();
 
     protected:
         /**
@@ -55,10 +66,29 @@ namespace Robomongo
         */
         void saveWindowSettings() const;
 
+        // UTF-8 text of editor, so that offsets are Scintilla positions
+        std::string textSnapshot() const;
+        void stopValidation();
+
+        /**
+         * @brief Marks error of _parsed with indicator and shows its message under editor
+         */
+        void showValidationResult();
+
         const CollectionInfo _info;
         FindFrame *_queryText;
+        QLabel *_validationStatus;
+        QTimer *_validateTimer;
+        int _errorIndicator;
         bool _readonly;
         ReturnType _obj;
+
+        // Text is validated in background after every change, only changed documents
+        // are parsed again. Revision is incremented on every change of text.
+        DocumentValidateThread *_validateThread;
+        std::shared_ptr<const JsonDocuments> _parsed;
+        int _parsedRevision;
+        int _revision;
     };
 }
 
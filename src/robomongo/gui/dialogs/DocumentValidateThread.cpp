@@ -0,0 +1,28 @@
+#include "robomongo/gui/dialogs/DocumentValidateThread.h"
+
+#include "robomongo/core/utils/JsonDocuments.h"
+
+namespace Robomongo
+{
+    DocumentValidateThread::DocumentValidateThread(const std::string &text,
+                                                   const std::shared_ptr<const JsonDocuments> &previous,
+                                                   int revision) :
+        _text(text),
+        _previous(previous),
+        _revision(revision),
+        _stop(false)
+    {
+    }
+
+    void DocumentValidateThread::stop()
+    {
+        _stop = true;
+    }
+
+    void DocumentValidateThread::run()
+    {
+        _result = JsonDocuments::parse(_text, _previous, &_stop);
+        if (!_stop && _result)
+            emit validated();
+    }
+}
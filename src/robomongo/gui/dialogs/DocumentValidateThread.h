@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace Robomongo
+{
+    class JsonDocuments;
+
+    /**
+     * @brief Parses snapshot of DocumentTextEditor text off the GUI thread, reusing documents
+     *        of previous result (see JsonDocuments). Result is read after validated().
+     */
+    class DocumentValidateThread : public QThread
+    {
+        Q_OBJECT
+
+    public:
+        DocumentValidateThread(const std::string &text, const std::shared_ptr<const JsonDocuments> &previous,
+                               int revision);
+        void stop();
+
+        std::shared_ptr<const JsonDocuments> result() const { return _result; }
+        int revision() const { return _revision; }
+
+    Q_SIGNALS:
+        /**
+         * @brief Signals when text is parsed, not emitted if stopped
+         */
+        void validated();
+
+    protected:
+        virtual void run();
+
+    private:
+        const std::string _text;
+        const std::shared_ptr<const JsonDocuments> _previous;
+        const int _revision;
+        std::shared_ptr<const JsonDocuments> _result;
+        std::atomic<bool> _stop;
+    };
+}
@@ -0,0 +1,262 @@
+#include "robomongo/gui/dialogs/ExplainDialog.h"
+
+#include <stdexcept>
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QTabWidget>
+#include <QTreeWidget>
+#include <QTreeWidgetItemIterator>
+#include <QVBoxLayout>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/ExplainPlan.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/shell/bson/json.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            StageColumn, DetailsColumn, ReturnedColumn, DocsColumn, KeysColumn, TimeColumn, ColumnCount
+        };
+
+        enum Mode { FindMode, AggregateMode };
+
+        QString numberText(long long number)
+        {
+            return number < 0 ? QString() : QString::number(number);
+        }
+
+        QString jsonText(const mongo::BSONObj &obj, int pretty = 0)
+        {
+            return QtUtils::toQString(BsonUtils::jsonString(obj, mongo::TenGen, pretty, DefaultEncoding, Utc));
+        }
+
+        mongo::BSONObj parseObject(const QString &text)
+        {
+            QString const trimmed = text.trimmed();
+            return mongo::Robomongo::fromjson(QtUtils::toStdString(trimmed.isEmpty() ? "{}" : trimmed));
+        }
+    }
+
+    ExplainDialog::ExplainDialog(MongoServer *server, const QString &dbName, const QString &collectionName,
+                                 QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _collectionName(collectionName),
+        _explainId(0)
+    {
+        setWindowTitle("Explain " + dbName + "." + collectionName);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(900, 600);
+
+        AppRegistry::instance().bus()->subscribe(this, ExplainResponse::Type, server);
+
+        _mode = new QComboBox;
+        _mode->addItems(QStringList() << "find" << "aggregate");
+        _filterEdit = new QLineEdit("{}");
+        _sortEdit = new QLineEdit("{}");
+        _pipelineEdit = new QLineEdit("[ { $match: {} } ]");
+        _explainButton = new QPushButton("Explain");
+        _explainButton->setDefault(true);
+
+        auto queryLayout = new QFormLayout;
+        queryLayout->addRow("Command:", _mode);
+        queryLayout->addRow("Filter:", _filterEdit);
+        queryLayout->addRow("Sort:", _sortEdit);
+        queryLayout->addRow("Pipeline:", _pipelineEdit);
+
+        auto commandLayout = new QHBoxLayout;
+        commandLayout->addLayout(queryLayout, 1);
+        commandLayout->addWidget(_explainButton, 0, Qt::AlignBottom);
+
+        _summaryLabel = new QLabel;
+        _summaryLabel->setWordWrap(true);
+        _summaryLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        _tree = new QTreeWidget;
+        _tree->setColumnCount(ColumnCount);
+        _tree->setHeaderLabels(QStringList() << "Stage" << "Details" << "Returned" << "Docs examined"
+                                             << "Keys examined" << "ms (estimated)");
+        _tree->setUniformRowHeights(true);
+        _tree->header()->setStretchLastSection(false);
+
+        _rawText = new QPlainTextEdit;
+        _rawText->setReadOnly(true);
+
+        auto tabs = new QTabWidget;
+        tabs->addTab(_tree, "Plans");
+        tabs->addTab(_rawText, "Raw");
+
+        _suggestionLabel = new QLabel;
+        _suggestionLabel->setWordWrap(true);
+        _suggestionLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        _createIndexButton = new QPushButton("Create Index...");
+        _createIndexButton->hide();
+
+        auto suggestionLayout = new QHBoxLayout;
+        suggestionLayout->addWidget(_suggestionLabel, 1);
+        suggestionLayout->addWidget(_createIndexButton);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_explainButton, SIGNAL(clicked()), this, SLOT(explain())));
+        VERIFY(connect(_mode, SIGNAL(currentIndexChanged(int)), this, SLOT(modeChanged(int))));
+        VERIFY(connect(_createIndexButton, SIGNAL(clicked()), this, SLOT(createIndex())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(commandLayout);
+        layout->addWidget(_summaryLabel);
+        layout->addWidget(tabs, 1);
+        layout->addLayout(suggestionLayout);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        modeChanged(FindMode);
+    }
+
+    void ExplainDialog::modeChanged(int index)
+    {
+        bool const aggregate = index == AggregateMode;
+        _filterEdit->setEnabled(!aggregate);
+        _sortEdit->setEnabled(!aggregate);
+        _pipelineEdit->setEnabled(aggregate);
+    }
+
+    void ExplainDialog::explain()
+    {
+        std::string const collection = QtUtils::toStdString(_collectionName);
+        mongo::BSONObjBuilder command;
+        try {
+            if (_mode->currentIndex() == AggregateMode) {
+                mongo::BSONObj const wrapped = parseObject("{ pipeline: " + _pipelineEdit->text() + " }");
+                if (wrapped["pipeline"].type() != mongo::Array)
+                    throw std::runtime_error("Pipeline must be an array of stages");
+
+                mongo::BSONObj const pipeline = wrapped.getObjectField("pipeline");
+                ExplainPlan::pipelineFilterAndSort(pipeline, _filter, _sort);
+                command.append("aggregate", collection);
+                command.appendArray("pipeline", pipeline);
+                command.append("cursor", mongo::BSONObj());
+            }
+            else {
+                _filter = parseObject(_filterEdit->text());
+                _sort = parseObject(_sortEdit->text());
+                command.append("find", collection);
+                command.append("filter", _filter);
+                if (!_sort.isEmpty())
+                    command.append("sort", _sort);
+            }
+        }
+        catch (const std::exception &ex) {
+            _summaryLabel->setText("Invalid JSON: " + QtUtils::toQString(ex.what()));
+            return;
+        }
+
+        static int lastExplainId = 0;
+        _explainId = ++lastExplainId;
+        _explainButton->setEnabled(false);
+        _summaryLabel->setText("Explaining...");
+        _server->explain(_explainId, QtUtils::toStdString(_dbName), command.obj());
+    }
+
+    void ExplainDialog::handle(ExplainResponse *event)
+    {
+        if (event->explainId != _explainId)
+            return;
+
+        _explainId = 0;
+        _explainButton->setEnabled(true);
+        _tree->clear();
+        _rawText->clear();
+        _suggestionLabel->clear();
+        _createIndexButton->hide();
+        _suggestedKeys.clear();
+
+        if (event->isError()) {
+            _summaryLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        ExplainPlan::Plan const &plan = event->plan;
+        _summaryLabel->setText(QString("%1 returned, %2 documents and %3 index keys examined, "
+                                       "executed in %4 ms (explained in %5 ms).")
+            .arg(plan.nReturned).arg(plan.docsExamined).arg(plan.keysExamined)
+            .arg(plan.timeMs).arg(event->elapsedMs));
+
+        auto winning = new QTreeWidgetItem(_tree, QStringList() << "Winning plan");
+        addStage(winning, plan.winning);
+        for (size_t i = 0; i < plan.rejected.size(); ++i) {
+            auto rejected = new QTreeWidgetItem(_tree, QStringList() << QString("Rejected plan %1").arg(i + 1));
+            addStage(rejected, plan.rejected[i]);
+        }
+        _tree->expandItem(winning);
+        for (QTreeWidgetItemIterator it(winning); *it; ++it)
+            (*it)->setExpanded(true);
+        for (int column = 0; column < ColumnCount; ++column)
+            _tree->resizeColumnToContents(column);
+
+        _rawText->setPlainText(jsonText(event->explain, 1));
+
+        if (!ExplainPlan::needsIndex(plan.winning)) {
+            _suggestionLabel->setText("Winning plan neither scans collection nor sorts in memory.");
+            return;
+        }
+
+        mongo::BSONObj const keys = ExplainPlan::suggestIndex(_filter, _sort);
+        if (keys.isEmpty()) {
+            _suggestionLabel->setText("Plan scans collection or sorts in memory, but filter and sort have "
+                                      "no fields an index could be suggested for.");
+            return;
+        }
+
+        _suggestedKeys = jsonText(keys);
+        _suggestionLabel->setText(QString("Plan scans collection or sorts in memory. Suggested index "
+                                          "(equality, sort, range fields): %1").arg(_suggestedKeys));
+        _createIndexButton->show();
+    }
+
+    void ExplainDialog::createIndex()
+    {
+        if (!_suggestedKeys.isEmpty())
+            emit createIndexRequested(_suggestedKeys);
+    }
+
+    void ExplainDialog::addStage(QTreeWidgetItem *parent, const ExplainPlan::Stage &stage)
+    {
+        auto item = new QTreeWidgetItem(parent);
+        item->setText(StageColumn, QtUtils::toQString(stage.stage));
+        item->setText(DetailsColumn, QtUtils::toQString(stage.details));
+        item->setToolTip(DetailsColumn, item->text(DetailsColumn));
+        item->setText(ReturnedColumn, numberText(stage.nReturned));
+        item->setText(DocsColumn, numberText(stage.docsExamined));
+        item->setText(KeysColumn, numberText(stage.keysExamined));
+        item->setText(TimeColumn, numberText(stage.timeMs));
+        for (int column = ReturnedColumn; column < ColumnCount; ++column)
+            item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+
+        // Whole collection is read, the usual sign of missing index
+        if (stage.stage == "COLLSCAN")
+            item->setForeground(StageColumn, Qt::red);
+
+        for (ExplainPlan::Stage const &child : stage.children)
+            addStage(item, child);
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QDialog>
+
+#include <mongo/bson/bsonobj.h>
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QPlainTextEdit;
+class QPushButton;
+class QTreeWidget;
+class QTreeWidgetItem;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class ExplainResponse;
+    namespace ExplainPlan { struct Stage; }
+
+    /**
+     * @brief Explains find or aggregate on collection at "executionStats" verbosity and shows
+     *        winning and rejected plan trees with returned and examined counts per stage.
+     *        Plans that scan collection or sort in memory get compound index suggested from
+     *        filter and sort (see ExplainPlan::suggestIndex()).
+     */
+    class ExplainDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        ExplainDialog(MongoServer *server, const QString &dbName, const QString &collectionName,
+                      QWidget *parent = 0);
+
+    Q_SIGNALS:
+        // Suggested index is to be created, 'keys' is JSON of key pattern
+        void createIndexRequested(const QString &keys);
+
+    public Q_SLOTS:
+        void handle(ExplainResponse *event);
+
+    private Q_SLOTS:
+        void explain();
+        void modeChanged(int index);
+        void createIndex();
+
+    private:
+        void addStage(QTreeWidgetItem *parent, const ExplainPlan::Stage &stage);
+
+        MongoServer *const _server;
+        QString const _dbName;
+        QString const _collectionName;
+        int _explainId;             // 0, if nothing is being explained
+
+        // Filter and sort of explained command, index is suggested for them
+        mongo::BSONObj _filter;
+        mongo::BSONObj _sort;
+        QString _suggestedKeys;
+
+        QComboBox *_mode;
+        QLineEdit *_filterEdit;
+        QLineEdit *_sortEdit;
+        QLineEdit *_pipelineEdit;
+        QPushButton *_explainButton;
+        QLabel *_summaryLabel;
+        QTreeWidget *_tree;
+        QPlainTextEdit *_rawText;
+        QLabel *_suggestionLabel;
+        QPushButton *_createIndexButton;
+    };
+}
@@ -3,106 +3,69 @@
 #include <QPushButton>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
+#include <QGridLayout>
 #include <QLineEdit>
-#include <QTextEdit>
 #include <QLabel>
 #include <QDialogButtonBox>
-#include <QTreeWidget>
+#include <QCheckBox>
 #include <QComboBox>
 #include <QGroupBox>
 #include <QApplication>
-#include <QProcess>
 #include <QDir>
 #include <QFileDialog>
 #include <QDateTime>
 #include <QMessageBox>
-#include <QPlainTextEdit>
 #include <QFileInfo>
-#include <QSizePolicy>
-#include <QProgressDialog>
+#include <QProgressBar>
+#include <QSpinBox>
+
+#include <mongo/bson/bsonobjbuilder.h>
 
-#include "robomongo/core/utils/QtUtils.h"
-#include "robomongo/core/domain/App.h"
 #include "robomongo/core/AppRegistry.h"
-#include "robomongo/core/domain/MongoCollection.h"
-#include "robomongo/core/domain/MongoDatabase.h"
-#include "robomongo/gui/widgets/explorer/ExplorerServerTreeItem.h"
-#include "robomongo/gui/widgets/workarea/IndicatorLabel.h"
-#include "robomongo/gui/widgets/explorer/ExplorerWidget.h"
-#include "robomongo/gui/widgets/explorer/ExplorerTreeWidget.h"
-#include "robomongo/gui/widgets/explorer/ExplorerServerTreeItem.h"
-#include "robomongo/gui/widgets/explorer/ExplorerCollectionTreeItem.h"
-#include "robomongo/gui/widgets/explorer/ExplorerCollectionIndexesDir.h"
-#include "robomongo/gui/widgets/explorer/ExplorerDatabaseCategoryTreeItem.h"
-#include "robomongo/gui/widgets/explorer/ExplorerDatabaseTreeItem.h"
-#include "robomongo/gui/widgets/explorer/ExplorerReplicaSetTreeItem.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/domain/ResultArchive.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/gui/utils/GuiConstants.h"
-#include "robomongo/gui/GuiRegistry.h"
+#include "robomongo/shell/bson/json.h"
 
 namespace Robomongo
 {
     namespace
     {
-        const QString defaultDir = "D:\\exports\\";     // Default location
-
-        auto const AUTO_MODE_SIZE = QSize(500, 450);
-        auto const MANUAL_MODE_SIZE = QSize(500, 400);
+        enum FormatIndex
+        {
+            JsonLinesIndex = 0,
+            JsonArrayIndex = 1,
+            CsvIndex = 2,
+            ResultArchiveIndex = 3
+        };
 
-        auto const SHOW_DETAILS = "<a href='error' style='color: #777777;'>Show details</a>";
-        auto const HIDE_DETAILS = "<a href='error' style='color: #777777;'>Hide details</a>";
+        int const ExportBatchSize = 1000;
+        int const MaxParallelism = 16;
 
-        // This structure represents the arguments as in "mongoexport.exe --help"
-        // See http://docs.mongodb.org/manual/reference/program/mongoexport/ for more information
-        struct MongoExportArgs
+        QString megabytes(long long bytes)
         {
-            static QString db(const QString& dbName) { return ("--db" + dbName); }
-            static QString collection(const QString& collection) { return ("--collection" + collection); }
-            
-            // i.e. absFilePath: "/exports/coll1.json"
-            static QString out(const QString& absFilePath) { return ("--out " + absFilePath); }  
-        };
+            return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MB";
+        }
     }
 
-    ExportDialog::ExportDialog(QString const& dbName, QString const& collName, QWidget *parent) :
-        QDialog(parent), _mode(AUTO), _mongoExportArgs(), _activeProcess(nullptr)
+    ExportDialog::ExportDialog(MongoServer *server, const QString &dbName, const QString &collName,
+                               QWidget *parent) :
+        QDialog(parent), _server(server), _dbName(dbName), _collName(collName), _exportId(0)
     {
         setWindowTitle("Export Collection");
         setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
-        setMinimumSize(AUTO_MODE_SIZE);
-        //setFixedHeight(AUTO_MODE_SIZE.height());
-
-        _activeProcess = new QProcess(this);
-        //_activeProcess->setProcessChannelMode(QProcess::MergedChannels);
-        VERIFY(connect(_activeProcess, SIGNAL(finished(int, QProcess::ExitStatus)),
-            this, SLOT(on_exportFinished(int, QProcess::ExitStatus))));
-        VERIFY(connect(_activeProcess, SIGNAL(errorOccurred(QProcess::ProcessError)),
-            this, SLOT(on_processErrorOccurred(QProcess::ProcessError))));
-
-        // todo: move to a global location
-        // Enable copyable text for QMessageBox
-        qApp->setStyleSheet("QMessageBox { messagebox-text-interaction-flags: 5; }");
-
-        const QString serverName = "localhost:20017"; // todo: remove
-        Indicator *serverIndicator = new Indicator(GuiRegistry::instance().serverIcon(), serverName);
-
-        // Horizontal line
-        QFrame *horline = new QFrame();
-        horline->setFrameShape(QFrame::HLine);
-        horline->setFrameShadow(QFrame::Sunken);
-
-        // Widgets related to Input
-        auto dbNameLabel = new QLabel("Database Name:");
-        auto dbNameLineEdit = new QLineEdit;
-        auto dbNameLay = new QHBoxLayout;
-        dbNameLay->addWidget(dbNameLabel);
-        dbNameLay->addWidget(dbNameLineEdit);
-
-        auto collNameLabel = new QLabel("Collection Name:");
-        auto collNameLineEdit = new QLineEdit;
-        auto collNameLay = new QHBoxLayout;
-        collNameLay->addWidget(collNameLabel);
-        collNameLay->addWidget(collNameLineEdit);
+        setMinimumWidth(500);
+
+        AppRegistry::instance().bus()->subscribe(this, ExportProgressEvent::Type, _server);
+        AppRegistry::instance().bus()->subscribe(this, ExportDocumentsResponse::Type, _server);
 
+        // Selected collection
         auto selectedCollLay = new QGridLayout;
         selectedCollLay->setAlignment(Qt::AlignTop);
         selectedCollLay->setColumnStretch(2, 1);
@@ -110,10 +73,11 @@ namespace Robomongo
         auto serverIcon = new QLabel("<html><img src=':/robomongo/icons/server_16x16.png'></html>");
         auto dbIcon = new QLabel("<html><img src=':/robomongo/icons/database_16x16.png'></html>");
         auto collIcon = new QLabel("<html><img src=':/robomongo/icons/collection_16x16.png'></html>");
+        QString const serverName = QtUtils::toQString(_server->connectionRecord()->getFullAddress());
 
         selectedCollLay->addWidget(serverIcon,                      1, 0);
         selectedCollLay->addWidget(new QLabel("Server: "),          1, 1);
-        selectedCollLay->addWidget(new QLabel("local_(2)"),         1, 2);
+        selectedCollLay->addWidget(new QLabel(serverName),          1, 2);
         selectedCollLay->addWidget(dbIcon,                          2, 0);
         selectedCollLay->addWidget(new QLabel("Database: "),        2, 1);
         selectedCollLay->addWidget(new QLabel(dbName),              2, 2);
@@ -121,369 +85,319 @@ namespace Robomongo
         selectedCollLay->addWidget(new QLabel("Collection: "),      3, 1);
         selectedCollLay->addWidget(new QLabel(collName),            3, 2);
 
-        // Widgets related to Output 
+        // Output properties
         _formatComboBox = new QComboBox;
-        _formatComboBox->addItem("JSON");
+        _formatComboBox->addItem("JSON Lines");
+        _formatComboBox->addItem("JSON Array (Extended JSON)");
         _formatComboBox->addItem("CSV");
+        _formatComboBox->addItem("Compressed BSON Archive");
+        _formatComboBox->setItemData(ResultArchiveIndex, "All documents, compressed. Opened with File > Open BSON File, "
+                                                         "without server", Qt::ToolTipRole);
         VERIFY(connect(_formatComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(on_formatComboBox_change(int))));
 
         _fieldsLabel = new QLabel("Fields:");
-        _fields = new QLineEdit; // todo: use textedit
+        _fields = new QLineEdit;
+        _fields->setPlaceholderText("name, address.city, ...");
         // Initially hidden
         _fieldsLabel->setHidden(true);
         _fields->setHidden(true);
 
-        _query = new QLineEdit("{}"); // todo: JSON frame can be used
+        _query = new QLineEdit("{}");
+
+        // Large collections are split to ranges of _id, exported concurrently
+        _parallelism = new QSpinBox;
+        _parallelism->setRange(1, MaxParallelism);
+        _parallelism->setValue(1);
+        _parallelism->setToolTip("Number of _id ranges exported at the same time, each on its own connection");
+        _readFromSecondaries = new QCheckBox("Read from secondaries");
+        _separateFiles = new QCheckBox("File per range");
+        _separateFiles->setToolTip("Otherwise ranges are merged into one file, in _id order");
+        auto parallelLay = new QHBoxLayout;
+        parallelLay->addWidget(_parallelism);
+        parallelLay->addWidget(_readFromSecondaries);
+        parallelLay->addWidget(_separateFiles);
+        parallelLay->addStretch(1);
         _outputFileName = new QLineEdit;
-        _outputDir = new QLineEdit;
+        _outputDir = new QLineEdit(QDir::toNativeSeparators(QDir::homePath()));
         _browseButton = new QPushButton("...");
         _browseButton->setMaximumWidth(50);
         VERIFY(connect(_browseButton, SIGNAL(clicked()), this, SLOT(on_browseButton_clicked())));
 
-        // Export summary widgets
-        _exportOutput = new QTextEdit;
-        QFontMetrics font(_exportOutput->font());
-        _exportOutput->setFixedHeight((4+1.5) * (font.lineSpacing()));  // 4-line text edit
-        _exportOutput->setReadOnly(true);
-
-        _mongoExportOutput = new QTextEdit;
-        _mongoExportOutput->setFixedHeight(4 * (font.lineSpacing() + 8));  // 4-line text edit
-        _mongoExportOutput->setReadOnly(true);
-        _mongoExportOutput->setHidden(true);
-
-        // Attempt to fix issue for Windows High DPI button height is slightly taller than other widgets 
+        // Attempt to fix issue for Windows High DPI button height is slightly taller than other widgets
 #ifdef Q_OS_WIN
         _browseButton->setMaximumHeight(HighDpiConstants::WIN_HIGH_DPI_BUTTON_HEIGHT);
 #endif
         auto outputsInnerLay = new QGridLayout;
         outputsInnerLay->addWidget(new QLabel("Format:"),       0, 0);
         outputsInnerLay->addWidget(_formatComboBox,             0, 1, 1, 2);
-        outputsInnerLay->addWidget(_fieldsLabel,                1, 0, Qt::AlignTop);
+        outputsInnerLay->addWidget(_fieldsLabel,                1, 0);
         outputsInnerLay->addWidget(_fields,                     1, 1, 1, 2);
         outputsInnerLay->addWidget(new QLabel("Query:"),        2, 0);
         outputsInnerLay->addWidget(_query,                      2, 1, 1, 2);
-        outputsInnerLay->addWidget(new QLabel("File Name:"),    3, 0);
-        outputsInnerLay->addWidget(_outputFileName,             3, 1, 1, 2);
-        outputsInnerLay->addWidget(new QLabel("Directory:"),    4, 0);
-        outputsInnerLay->addWidget(_outputDir,                  4, 1);
-        outputsInnerLay->addWidget(_browseButton,               4, 2);
-        //outputsInnerLay->addWidget(new QLabel("Result:"),       5, 0, Qt::AlignTop);
-        //outputsInnerLay->addWidget(_exportOutput,           6, 0, 1, 3, Qt::AlignTop);
-
-        auto manualLayout = new QGridLayout;
-        auto cmdLabel = new QLabel("Command:");
-        cmdLabel->setFixedHeight(cmdLabel->sizeHint().height());
-        _manualExportCmd = new QTextEdit;
-        QFontMetrics font1(_manualExportCmd->font());
-        _manualExportCmd->setFixedHeight(2 * (font1.lineSpacing()+8));  // 2-line text edit
-        manualLayout->addWidget(cmdLabel,                   0, 0, Qt::AlignTop);
-        manualLayout->addWidget(_manualExportCmd,           1, 0, Qt::AlignTop);
-
-        // Button box and Manual Mode button
-        _modeButton = new QPushButton("Manual Mode");
-        VERIFY(connect(_modeButton, SIGNAL(clicked()), this, SLOT(on_modeButton_clicked())));
+        outputsInnerLay->addWidget(new QLabel("Parallel:"),     3, 0);
+        outputsInnerLay->addLayout(parallelLay,                 3, 1, 1, 2);
+        outputsInnerLay->addWidget(new QLabel("File Name:"),    4, 0);
+        outputsInnerLay->addWidget(_outputFileName,             4, 1, 1, 2);
+        outputsInnerLay->addWidget(new QLabel("Directory:"),    5, 0);
+        outputsInnerLay->addWidget(_outputDir,                  5, 1);
+        outputsInnerLay->addWidget(_browseButton,               5, 2);
+
+        // Progress
+        _progressBar = new QProgressBar;
+        _progressBar->setRange(0, 1);   // Busy indicator while export runs
+        _progressBar->setValue(0);
+        _progressBar->setTextVisible(false);
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        auto progressLay = new QVBoxLayout;
+        progressLay->addWidget(_progressBar);
+        progressLay->addWidget(_statusLabel);
+
         _buttonBox = new QDialogButtonBox(this);
         _buttonBox->setOrientation(Qt::Horizontal);
         _buttonBox->setStandardButtons(QDialogButtonBox::Cancel | QDialogButtonBox::Save);
         _buttonBox->button(QDialogButtonBox::Save)->setText("E&xport");
-        _buttonBox->button(QDialogButtonBox::Save)->setMaximumWidth(70);
-        _buttonBox->button(QDialogButtonBox::Cancel)->setMaximumWidth(70);
         VERIFY(connect(_buttonBox, SIGNAL(accepted()), this, SLOT(accept())));
         VERIFY(connect(_buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
 
-        // Sub layouts
-        auto serverIndicatorlayout = new QHBoxLayout();
-        if (!serverName.isEmpty()) {
-            serverIndicatorlayout->addWidget(serverIndicator, 0, Qt::AlignLeft);
-        }
+        auto inputsGroupBox = new QGroupBox("Selected Collection");
+        inputsGroupBox->setLayout(selectedCollLay);
+        inputsGroupBox->setStyleSheet("QGroupBox::title { left: 0px }");
+
+        auto outputsGroupBox = new QGroupBox("Output Properties");
+        outputsGroupBox->setLayout(outputsInnerLay);
+        outputsGroupBox->setStyleSheet("QGroupBox::title { left: 0px }");
+
+        auto progressGroupBox = new QGroupBox("Progress");
+        progressGroupBox->setLayout(progressLay);
+        progressGroupBox->setStyleSheet("QGroupBox::title { left: 0px }");
 
-        // Input layout
-        _inputsGroupBox = new QGroupBox("Selected Collection");
-        _inputsGroupBox->setLayout(selectedCollLay);
-        _inputsGroupBox->setStyleSheet("QGroupBox::title { left: 0px }");
-        _inputsGroupBox->setFixedHeight(_inputsGroupBox->sizeHint().height());
-
-        // Outputs
-        _autoOutputsGroup = new QGroupBox("Output Properties");
-        _autoOutputsGroup->setLayout(outputsInnerLay);
-        _autoOutputsGroup->setStyleSheet("QGroupBox::title { left: 0px }");
-        _autoOutputsGroup->setFixedHeight(_autoOutputsGroup->sizeHint().height());
-
-        // Manual Groupbox
-        _manualGroupBox = new QGroupBox("Manual Export");
-        _manualGroupBox->setLayout(manualLayout);
-        _manualGroupBox->setStyleSheet("QGroupBox::title { left: 0px }");
-        _manualGroupBox->setHidden(true);
-
-        // Export Summary
-        auto exportSummaryGroup = new QGroupBox("Export Summary");
-        exportSummaryGroup->setStyleSheet("QGroupBox::title { left: 0px }");
-        _viewOutputLink = new QLabel(SHOW_DETAILS);
-        VERIFY(connect(_viewOutputLink, SIGNAL(linkActivated(QString)), this, SLOT(on_viewOutputLink(QString))));
-        _viewOutputLink->setFixedHeight(_viewOutputLink->sizeHint().height());
-        auto tempLayout = new QVBoxLayout();
-        //tempLayout->setSizeConstraint(QLayout::SetFixedSize);
-        tempLayout->addWidget(_exportOutput, Qt::AlignTop);
-        tempLayout->addWidget(_viewOutputLink, Qt::AlignLeft | Qt::AlignTop);
-        //tempLayout->addWidget(_mongoExportOutput);
-        exportSummaryGroup->setLayout(tempLayout);
-        exportSummaryGroup->setFixedHeight(exportSummaryGroup->sizeHint().height());
-
-        // Buttonbox layout
-        auto hButtonBoxlayout = new QHBoxLayout();
-        hButtonBoxlayout->addStretch(1);
-        hButtonBoxlayout->addWidget(_buttonBox);
-        hButtonBoxlayout->addWidget(_modeButton);
-
-        // Main Layout
         auto layout = new QVBoxLayout();
-        layout->addWidget(_inputsGroupBox, Qt::AlignTop);
-        //layout->addWidget(horline, Qt::AlignTop);
-        layout->addWidget(_autoOutputsGroup, Qt::AlignTop);
-        layout->addWidget(_manualGroupBox);
-        layout->addWidget(exportSummaryGroup, Qt::AlignTop);
-        layout->addLayout(hButtonBoxlayout);
+        layout->addWidget(inputsGroupBox);
+        layout->addWidget(outputsGroupBox);
+        layout->addWidget(progressGroupBox);
+        layout->addWidget(_buttonBox);
         setLayout(layout);
 
-        // todo: move to a function
         // Help user filling inputs automatically
-        auto date = QDateTime::currentDateTime().toString("dd.MM.yyyy");
-        auto time = QDateTime::currentDateTime().toString("hh.mm.ss");
-        auto timeStamp = date + "_" + time;
-        auto format = _formatComboBox->currentIndex() == 0 ? "json" : "csv";
-
-        _outputFileName->setText(dbName + "." + collName + "_" + timeStamp + "." + format);
-        _outputDir->setText(defaultDir);
-        _manualExportCmd->setText("mongoexport --db " + dbName + " --collection " + collName +
-                                             " --out " + _outputDir->text() + _outputFileName->text());
-
-        // todo: setExportArgs()
-        // First set db and coll 
-        _mongoExportArgs = " --db " + dbName + " --collection " + collName;
-
+        auto const timeStamp = QDateTime::currentDateTime().toString("dd.MM.yyyy_hh.mm.ss");
+        _outputFileName->setText(dbName + "." + collName + "_" + timeStamp + "." + fileExtension());
         _outputFileName->setFocus();
     }
 
-    void ExportDialog::setOkButtonText(const QString &text)
+    ExportDialog::~ExportDialog()
     {
-        _buttonBox->button(QDialogButtonBox::Save)->setText(text);
-    }
-
-    // todo: remove
-    void ExportDialog::setInputLabelText(const QString &text)
-    {
-        //_inputLabel->setText(text);
+        // Export of closed dialog is not needed anymore
+        if (_cancelled)
+            *_cancelled = true;
     }
 
     void ExportDialog::accept()
     {
-        QString mongoExport = "D:\\mongo_export\\bin\\mongoexport.exe";
-        
-        bool disable = false;
-        enableDisableWidgets(disable);
+        if (_exportId)
+            return;
 
-        if (AUTO == _mode)
-        {
-            _exportOutput->clear();
-            _exportOutput->setText("Exporting...");
-
-            // If CSV append output format and fields
-            if (_formatComboBox->currentIndex() == 1) {
-                if (_fields->text().isEmpty()) {
-                    QMessageBox::critical(this, "Error", "\"Fields\" option is required in CSV mode.");
-                    return;
-                }
-                _mongoExportArgs.append(" --type=csv");
-                _mongoExportArgs.append(" --fields " + _fields->text().replace(" ", ""));
+        int const format = _formatComboBox->currentIndex();
+
+        ExportOptions options;
+        options.format = format == CsvIndex ? ExportFormat::Csv :
+                         format == JsonArrayIndex ? ExportFormat::JsonArray :
+                         format == ResultArchiveIndex ? ExportFormat::ResultArchive : ExportFormat::JsonLines;
+        options.ns = QtUtils::toStdString(_dbName + "." + _collName);
+        options.uuidEncoding = AppRegistry::instance().settingsManager()->uuidEncoding();
+        options.timeFormat = AppRegistry::instance().settingsManager()->timeZone();
+        options.jsonMode = AppRegistry::instance().settingsManager()->jsonOutputMode();
+        // Result set keeps its order, archive is written by one cursor
+        bool const isResultSet = _resultSet._info.isValid();
+        options.parallelism = isResultSet || format == ResultArchiveIndex ? 1 : _parallelism->value();
+        options.readFromSecondaries = _readFromSecondaries->isChecked();
+        options.separateFiles = _separateFiles->isChecked();
+
+        // Only selected fields are fetched for CSV
+        mongo::BSONObjBuilder projection;
+        if (format == CsvIndex) {
+            for (QString const &field : _fields->text().split(',', QString::SkipEmptyParts)) {
+                std::string const path = QtUtils::toStdString(field.trimmed());
+                if (path.empty())
+                    continue;
+                options.fields.push_back(path);
+                projection.append(path, 1);
             }
 
-            if (!_query->text().isEmpty() && _query->text() != "{}") {
-                _mongoExportArgs.append(" --query " + _query->text());
+            if (options.fields.empty()) {
+                QMessageBox::critical(this, "Error", "\"Fields\" option is required in CSV mode.");
+                return;
             }
-
-            // Append file path and name
-            auto absFilePath = _outputDir->text() + _outputFileName->text();
-            _mongoExportArgs.append(" --out " + absFilePath);
-
-            // Start mongoexport non-blocking
-            _activeProcess->start(mongoExport + _mongoExportArgs);
         }
-        else if (MANUAL == _mode)
-        {
-            _exportOutput->clear();
-            _exportOutput->setText("Exporting...");
 
-            // todo: check if _activeProcess->state() is QProcess::NotRunning
-            // Start mongoexport non-blocking
-            _activeProcess->start("D:\\mongo_export\\bin\\" + _manualExportCmd->toPlainText());
+        mongo::BSONObj query;
+        try {
+            QString const text = _query->text().trimmed();
+            query = mongo::Robomongo::fromjson(QtUtils::toStdString(text.isEmpty() ? "{}" : text));
         }
-    }
-
-    void ExportDialog::ui_itemExpanded(QTreeWidgetItem *item)
-    {
-        auto categoryItem = dynamic_cast<ExplorerDatabaseCategoryTreeItem *>(item);
-        if (categoryItem) {
-            categoryItem->expand();
+        catch (const std::exception &ex) {
+            QMessageBox::critical(this, "Error", "Unable to parse query: " + QString::fromUtf8(ex.what()));
             return;
         }
 
-        ExplorerServerTreeItem *serverItem = dynamic_cast<ExplorerServerTreeItem *>(item);
-        if (serverItem) {
-            serverItem->expand();
-            return;
+        QString const filePath = QDir(_outputDir->text()).filePath(_outputFileName->text().trimmed());
+        if (QFileInfo(filePath).exists()) {
+            int const answer = QMessageBox::question(this, "Export", "File " + filePath +
+                                                     " already exists. Do you want to replace it?",
+                                                     QMessageBox::Yes, QMessageBox::No);
+            if (answer != QMessageBox::Yes)
+                return;
         }
 
-        auto dirItem = dynamic_cast<ExplorerCollectionIndexesDir *>(item);
-        if (dirItem) {
-            dirItem->expand();
+        CollectionInfo const info(_server->connectionRecord()->getFullAddress(),
+                                  QtUtils::toStdString(_dbName), QtUtils::toStdString(_collName));
+        MongoQueryInfo queryInfo(info, query, projection.obj(), 0, 0, ExportBatchSize, 0, false);
+        if (isResultSet) {
+            queryInfo = _resultSet;
+            queryInfo._batchSize = ExportBatchSize;
+            if (format == CsvIndex)
+                queryInfo._fields = projection.obj();
         }
+
+        static int lastExportId = 0;
+        _exportId = ++lastExportId;
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+
+        enableDisableWidgets(false);
+        _progressBar->setRange(0, 0);
+        _statusLabel->setText("Exporting...");
+
+        _server->exportDocuments(_exportId, queryInfo, options, QDir::toNativeSeparators(filePath), _cancelled);
     }
 
-    void ExportDialog::ui_itemDoubleClicked(QTreeWidgetItem *item, int column)
+    void ExportDialog::setResultSet(const MongoQueryInfo &queryInfo)
     {
-        // todo
+        _resultSet = queryInfo;
+        setWindowTitle("Save Result Set");
+        _buttonBox->button(QDialogButtonBox::Save)->setText("&Save");
+
+        QString const query = QtUtils::toQString(BsonUtils::jsonString(queryInfo._query, mongo::Strict, 0,
+                                                                       DefaultEncoding, Utc));
+        _query->setText(query);
+        _query->setReadOnly(true);
+        _parallelism->setValue(1);
+        _parallelism->setEnabled(false);
+        _readFromSecondaries->setEnabled(false);
+        _separateFiles->setEnabled(false);
+        _formatComboBox->setCurrentIndex(ResultArchiveIndex);
     }
 
-    void ExportDialog::on_browseButton_clicked()
+    void ExportDialog::reject()
     {
-        // Select output directory
-        QString origDir = QFileDialog::getExistingDirectory(this, tr("Select Directory"), defaultDir,
-                                             QFileDialog::ShowDirsOnly | QFileDialog::DontResolveSymlinks);
-        auto dir = QDir::toNativeSeparators(origDir);
-
-        QApplication::activeModalWidget()->raise();
-        QApplication::activeModalWidget()->activateWindow();
-
-        if (dir.isNull())
+        if (!_exportId) {
+            QDialog::reject();
             return;
+        }
 
-        _outputDir->setText(dir + "\\");
+        // Dialog stays open until worker replies, file is discarded then
+        *_cancelled = true;
+        _statusLabel->setText("Cancelling...");
     }
 
-    void ExportDialog::on_formatComboBox_change(int index)
+    void ExportDialog::handle(ExportProgressEvent *event)
     {
-        bool const isCsv = static_cast<bool>(index);
-        _fieldsLabel->setVisible(isCsv);
-        _fields->setVisible(isCsv);
-        
-        // todo: divide ui_itemClicked()
-        //ui_itemClicked(_treeWidget->currentItem());
-    }
+        if (event->exportId != _exportId)
+            return;
 
-    void ExportDialog::on_modeButton_clicked()
-    {
-        _exportOutput->clear();
-        _mode = (AUTO == _mode ? MANUAL : AUTO);
-        _modeButton->setText(AUTO == _mode ? "Manual Mode" : "Auto Mode");
-        _autoOutputsGroup->setVisible(AUTO == _mode);
-        _manualGroupBox->setVisible(MANUAL == _mode);
-        setMinimumSize(AUTO == _mode ? AUTO_MODE_SIZE : MANUAL_MODE_SIZE);
-        _inputsGroupBox->setTitle(AUTO == _mode ? "Selected Collection" : "Selected Server");
-        adjustSize();
+        _statusLabel->setText("Exporting... " + progressText(event->documents, event->bytes, event->elapsedMs));
     }
 
-    void ExportDialog::on_exportFinished(int exitCode, QProcess::ExitStatus exitStatus)
+    void ExportDialog::handle(ExportDocumentsResponse *event)
     {
-        bool enable = true;
-        enableDisableWidgets(enable);
+        if (event->exportId != _exportId)
+            return;
 
-        // Extract absolute file path
-        QString absFilePath;
-        if (AUTO == _mode) 
-        {
-            absFilePath = _outputDir->text() + _outputFileName->text();
-        }
-        else if (MANUAL == _mode)
-        {
-            // extract absolute file path string
-            QStringList strlist1 = _manualExportCmd->toPlainText().split("--out");
-            if (strlist1.size() > 1) {
-                QString str1 = strlist1[1];
-                QStringList strlist2 = str1.split("--");
-                if (strlist2.size() > 1) {
-                    absFilePath = strlist2[0];
-                }
-                else {
-                    absFilePath = str1;
-                }
-            }
-        }
-        absFilePath.replace(" ", "");  // todo: handle paths with white spaces
-
-        // todo: also check process exit code
-        // Check exported file exists and mongoexport output does not contain error
-        QFileInfo const file(absFilePath);
-        _mongoExportOutputStr = _activeProcess->readAllStandardError(); // Extract mongoexport command output
-        if (file.exists() && file.isFile() && _mongoExportOutputStr.contains("exported")) {
-            QStringList splitA = _mongoExportOutputStr.split("exported");
-            QStringList splitB = splitA[1].split("records");
-            _exportResult = "Export Successful: \n" 
-                            "Exported file: " + absFilePath + "\n"
-                            "Number of records exported:" + splitB[0];
-            _exportOutput->setText(_exportResult);
-        }
-        else {
-            _exportOutput->setText("Export Failed.\n");
-            _exportOutput->append("Output:\n" + _mongoExportOutputStr);
+        bool const cancelled = *_cancelled;
+        _exportId = 0;
+        _cancelled.reset();
+
+        enableDisableWidgets(true);
+        _progressBar->setRange(0, 1);
+
+        if (event->isError()) {
+            _progressBar->setValue(0);
+            _statusLabel->setText(cancelled ? QString("Export cancelled.") :
+                                  "Export failed: " + QtUtils::toQString(event->error().errorMessage()));
+            return;
         }
 
-        _exportOutput->moveCursor(QTextCursor::Start);
+        _progressBar->setValue(1);
+        _statusLabel->setText("Export finished: " + progressText(event->documents, event->bytes, event->elapsedMs));
     }
 
-    void ExportDialog::on_processErrorOccurred(QProcess::ProcessError error)
+    void ExportDialog::on_browseButton_clicked()
     {
-        bool enable = true;
-        enableDisableWidgets(enable);
+        // Select output directory
+        QString const dir = QFileDialog::getExistingDirectory(this, tr("Select Directory"), _outputDir->text(),
+                                             QFileDialog::ShowDirsOnly | QFileDialog::DontResolveSymlinks);
+        raise();
+        activateWindow();
 
-        if (QProcess::FailedToStart == error) {
-            _exportOutput->setText("Error: \"mongoexport\" process failed to start. Either the "
-                "invoked program is missing, or you may have insufficient permissions to invoke the program.");
-        }
-        else if (QProcess::Crashed == error) {
-            _exportOutput->setText("Error: \"mongoexport\" process crashed some time after starting"
-                " successfully..");
-        }
-        else {
-            _exportOutput->setText("Error: \"mongoexport\" process failed. Error code: "
-                + QString::number(error));
-        }
+        if (dir.isEmpty())
+            return;
 
-        _exportOutput->moveCursor(QTextCursor::Start);
+        _outputDir->setText(QDir::toNativeSeparators(dir));
     }
 
-    void ExportDialog::on_viewOutputLink(QString)
+    void ExportDialog::on_formatComboBox_change(int index)
     {
-        QMessageBox::information(this, "Details", _mongoExportOutputStr);
+        bool const isCsv = index == CsvIndex;
+        _fieldsLabel->setVisible(isCsv);
+        _fields->setVisible(isCsv);
+
+        // Blocks of archive are written by one cursor
+        bool const isParallel = index != ResultArchiveIndex && !_resultSet._info.isValid();
+        _parallelism->setEnabled(isParallel);
+        _readFromSecondaries->setEnabled(isParallel);
+        _separateFiles->setEnabled(isParallel);
+
+        // Keep file name in sync with format
+        QFileInfo const file(_outputFileName->text());
+        _outputFileName->setText(file.completeBaseName() + "." + fileExtension());
     }
-    
-    Indicator *ExportDialog::createDatabaseIndicator(const QString &database)
+
+    QString ExportDialog::fileExtension() const
     {
-        return new Indicator(GuiRegistry::instance().databaseIcon(), database);
+        switch (_formatComboBox->currentIndex()) {
+        case CsvIndex: return "csv";
+        case JsonArrayIndex: return "json";
+        case ResultArchiveIndex: return ResultArchive::FileSuffix;
+        default: return "jsonl";
+        }
     }
 
-    Indicator *ExportDialog::createCollectionIndicator(const QString &collection)
+    QString ExportDialog::progressText(long long documents, long long bytes, long long elapsedMs) const
     {
-        return new Indicator(GuiRegistry::instance().collectionIcon(), collection);
+        double const seconds = elapsedMs / 1000.0;
+        QString text = QString::number(documents) + " documents, " + megabytes(bytes);
+        if (seconds > 0) {
+            text += QString(" in %1 s (%2 docs/s, %3/s)")
+                .arg(seconds, 0, 'f', 1)
+                .arg(static_cast<long long>(documents / seconds))
+                .arg(megabytes(static_cast<long long>(bytes / seconds)));
+        }
+        return text;
     }
 
     void ExportDialog::enableDisableWidgets(bool enable) const
     {
-        // Auto mode widgets
-        //_treeWidget->setEnabled(enable);
         _formatComboBox->setEnabled(enable);
         _fieldsLabel->setEnabled(enable);
         _fields->setEnabled(enable);
         _query->setEnabled(enable);
+        bool const isParallel = _formatComboBox->currentIndex() != ResultArchiveIndex && !_resultSet._info.isValid();
+        _parallelism->setEnabled(enable && isParallel);
+        _readFromSecondaries->setEnabled(enable && isParallel);
+        _separateFiles->setEnabled(enable && isParallel);
         _outputFileName->setEnabled(enable);
         _outputDir->setEnabled(enable);
         _browseButton->setEnabled(enable);
         _buttonBox->button(QDialogButtonBox::Save)->setEnabled(enable);
-        _modeButton->setEnabled(enable);
-
-        // Manual mode widgets
-        //_treeWidget->setEnabled(enable);
-        _manualExportCmd->setEnabled(enable);
-        _buttonBox->button(QDialogButtonBox::Save)->setEnabled(enable);
-        _modeButton->setEnabled(enable);
     }
 }
@@ -1,106 +1,89 @@
 #pragma once
 
 #include <QDialog>
-#include <QProcess>
+#include <atomic>
+#include <memory>
+
+#include "robomongo/core/domain/MongoQueryInfo.h"
 
 QT_BEGIN_NAMESPACE
 class QLabel;
 class QDialogButtonBox;
 class QLineEdit;
-class QTreeWidgetItem;
-class QTreeWidget;
 class QComboBox;
+class QCheckBox;
+class QSpinBox;
 class QPushButton;
-class QGroupBox;
-class QTextEdit;
-class QProcess;
+class QProgressBar;
 QT_END_NAMESPACE
 
 namespace Robomongo
 {
-    class Indicator;
+    class MongoServer;
+    class ExportProgressEvent;
+    class ExportDocumentsResponse;
 
     /**
-    * @brief This class is not finished, it is still under development.
-    *        Currently export is disabled in the GUI. If enabled in GUI, export 
-    *        will work with current code. However, the code is unfinished; 
-    *        it needs to finished, reviewed and tested.
-    *        Currently, there is support for simultaneous export which can be done 
-    *        on multiple export dialogs without blocking each other or main window. 
-    *        So user can still work while multiple export dialogs are doing export. 
-    *        This achieved by the assumption that there will be usable export executable for 
-    *        Robomongo to use. Currently, this location is hard coded as 
-    *        "D:\\mongo_export\\bin\\mongoexport.exe". One of the next actions will be 
-    *        to design the location of mongoexport which should be cross-platform, 
-    *        generic and not hard coded.
-    */
+     * @brief Exports documents of collection to JSON Lines, Extended JSON array, CSV file or
+     *        compressed ResultArchive (opened with File > Open BSON File).
+     *        Export runs in the worker of server (see MongoServer::exportDocuments()), using
+     *        the connection (and SSH tunnel) of server, so no external mongoexport is needed.
+     *        Dialog shows progress and throughput, and cancels export when closed.
+     */
     class ExportDialog : public QDialog
     {
         Q_OBJECT
 
-        enum MODE 
-        {
-            AUTO = 0,
-            MANUAL = 1
-        };
-
     public:
-        explicit ExportDialog(QString const& dbName, QString const& collName, QWidget *parent = 0);
-        void setOkButtonText(const QString &text);
-        void setInputLabelText(const QString &text);
-        void setInputText(const QString &text);
-        enum { maxLenghtName = 60 };
+        ExportDialog(MongoServer *server, const QString &dbName, const QString &collName,
+                     QWidget *parent = 0);
+        ~ExportDialog();
+
+        /**
+         * @brief Exports documents of query result instead (with its projection, sort, skip and
+         *        limit) as ResultArchive by default. Query is shown, but cannot be changed.
+         */
+        void setResultSet(const MongoQueryInfo &queryInfo);
 
     public Q_SLOTS:
         virtual void accept();
+        virtual void reject();
+
+        void handle(ExportProgressEvent *event);
+        void handle(ExportDocumentsResponse *event);
 
     private Q_SLOTS:
-        void ui_itemExpanded(QTreeWidgetItem *item);
-        void ui_itemDoubleClicked(QTreeWidgetItem *item, int column);
         void on_browseButton_clicked();
         void on_formatComboBox_change(int index);
-        void on_modeButton_clicked();
-        void on_exportFinished(int exitCode, QProcess::ExitStatus exitStatus);
-        void on_processErrorOccurred(QProcess::ProcessError);
-        void on_viewOutputLink(QString);
 
     private:
-        // todo: remove if unused
-        Indicator *createDatabaseIndicator(const QString &database);
-        Indicator *createCollectionIndicator(const QString &collection);
+        QString fileExtension() const;
+        QString progressText(long long documents, long long bytes, long long elapsedMs) const;
 
         // Enable/Disable widgets during/after export operation
         // @param enable: true to enable, false to disable widgets
         void enableDisableWidgets(bool enable) const;
 
-        // Auto Mode
-        QGroupBox* _inputsGroupBox;
         QComboBox* _formatComboBox;
         QLabel* _fieldsLabel;
         QLineEdit* _fields;
         QLineEdit* _query;
+        QSpinBox* _parallelism;
+        QCheckBox* _readFromSecondaries;
+        QCheckBox* _separateFiles;
         QLineEdit* _outputFileName;
         QLineEdit* _outputDir;
         QPushButton* _browseButton;
-        QGroupBox* _autoOutputsGroup;
-        QTextEdit* _exportOutput;
-        QLabel* _viewOutputLink;
-        //
-        QTextEdit* _mongoExportOutput;
-
-        // Manual Mode
-        QTextEdit* _manualExportCmd;
-        QPushButton* _modeButton;
-        QGroupBox* _manualGroupBox;
-        // Common
+        QProgressBar* _progressBar;
+        QLabel* _statusLabel;
         QDialogButtonBox* _buttonBox;
 
-        MODE _mode;
+        MongoServer* _server;
         QString _dbName;
         QString _collName;
-        QString _mongoExportArgs;
-        QString _exportResult;
-        QString _mongoExportOutputStr;
-        QProcess* _activeProcess;          // pointer to running/finished process
+        MongoQueryInfo _resultSet;                      // invalid, unless setResultSet() was called
+
+        int _exportId;                                  // 0, if no export is running
+        std::shared_ptr<std::atomic<bool>> _cancelled;  // of running export
     };
 }
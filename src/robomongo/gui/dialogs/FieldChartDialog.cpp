@@ -0,0 +1,247 @@
+#include "robomongo/gui/dialogs/FieldChartDialog.h"
+
+#include <algorithm>
+#include <QComboBox>
+#include <QDateTime>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QToolTip>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoShell.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        const char *const UnitLabels[FieldBuckets::DateUnitCount] = {
+            "Minute", "Hour", "Day", "Week", "Month", "Year"
+        };
+
+        QString boundText(const FieldBuckets::Result &result, double value)
+        {
+            if (result.spec.kind == FieldBuckets::Kind::Numbers)
+                return QString::number(value, 'g', 10);
+
+            QString const format = result.spec.unit <= FieldBuckets::DateUnit::Hour ? "yyyy-MM-dd HH:mm" : "yyyy-MM-dd";
+            return QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(value), Qt::UTC).toString(format);
+        }
+    }
+
+    namespace detail
+    {
+        /**
+         * @brief Bars of buckets on linear axis. Buckets of numbers differ in width, so height of
+         *        their bars is density (count per unit), area of bar is count.
+         */
+        class BucketChart : public QWidget
+        {
+        public:
+            explicit BucketChart(QWidget *parent = 0) : QWidget(parent)
+            {
+                setMinimumSize(480, 240);
+                setMouseTracking(true);
+            }
+
+            void setResult(FieldBuckets::Result result)
+            {
+                _result = std::move(result);
+                update();
+            }
+
+        protected:
+            void paintEvent(QPaintEvent *) override
+            {
+                QPainter painter(this);
+                QRectF const area = plotArea();
+                painter.setPen(palette().color(QPalette::Mid));
+                painter.drawLine(area.bottomLeft(), area.bottomRight());
+                if (_result.buckets.empty())
+                    return;
+
+                QColor const color = palette().color(QPalette::Highlight);
+                for (size_t i = 0; i < _result.buckets.size(); ++i) {
+                    QRectF const bar = barRect(i);
+                    painter.fillRect(bar, color);
+                    if (bar.width() > 3)
+                        painter.fillRect(QRectF(bar.right() - 1, bar.top(), 1, bar.height()), palette().color(QPalette::Base));
+                }
+
+                painter.setPen(palette().color(QPalette::Text));
+                QRectF const labels(area.left(), area.bottom() + 2, area.width(), fontMetrics().height());
+                painter.drawText(labels, Qt::AlignLeft | Qt::AlignTop, boundText(_result, _result.buckets.front().from));
+                painter.drawText(labels, Qt::AlignRight | Qt::AlignTop, boundText(_result, _result.buckets.back().to));
+            }
+
+            void mouseMoveEvent(QMouseEvent *event) override
+            {
+                for (size_t i = 0; i < _result.buckets.size(); ++i) {
+                    QRectF const bar = barRect(i);
+                    if (event->pos().x() < bar.left() || event->pos().x() >= bar.right())
+                        continue;
+
+                    FieldBuckets::Bucket const &bucket = _result.buckets[i];
+                    QToolTip::showText(event->globalPos(), QString("%1 - %2\n%3 documents")
+                                       .arg(boundText(_result, bucket.from)).arg(boundText(_result, bucket.to))
+                                       .arg(bucket.count), this);
+                    return;
+                }
+                QToolTip::hideText();
+            }
+
+        private:
+            QRectF plotArea() const
+            {
+                return QRectF(8, 8, width() - 16, height() - 16 - fontMetrics().height());
+            }
+
+            double barValue(const FieldBuckets::Bucket &bucket) const
+            {
+                if (_result.spec.kind == FieldBuckets::Kind::Dates)
+                    return static_cast<double>(bucket.count);
+
+                // Bucket of equal bounds holds one repeated value, it is drawn as if of unit width
+                double const width = bucket.to - bucket.from;
+                return width > 0 ? bucket.count / width : bucket.count;
+            }
+
+            QRectF barRect(size_t index) const
+            {
+                QRectF const area = plotArea();
+                double const from = _result.buckets.front().from;
+                double const to = _result.buckets.back().to;
+                double const span = to > from ? to - from : 1;
+
+                double maxValue = 0;
+                for (FieldBuckets::Bucket const &bucket : _result.buckets)
+                    maxValue = std::max(maxValue, barValue(bucket));
+
+                FieldBuckets::Bucket const &bucket = _result.buckets[index];
+                qreal const left = area.left() + area.width() * (bucket.from - from) / span;
+                qreal const right = std::max(left + 1, area.left() + area.width() * (bucket.to - from) / span);
+                qreal const top = area.bottom() - (maxValue > 0 ? area.height() * barValue(bucket) / maxValue : 0);
+                return QRectF(QPointF(left, top), QPointF(right, area.bottom()));
+            }
+
+            FieldBuckets::Result _result;
+        };
+    }
+
+    FieldChartDialog::FieldChartDialog(MongoShell *shell, const MongoQueryInfo &queryInfo, const QString &field,
+                                       FieldBuckets::Kind kind, FieldBuckets::DateUnit unit, QWidget *parent) :
+        QDialog(parent),
+        _shell(shell),
+        _queryInfo(queryInfo),
+        _field(field),
+        _bucketsId(0)
+    {
+        setWindowTitle(QString("Chart of \"%1\"").arg(field));
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(800, 450);
+
+        AppRegistry::instance().bus()->subscribe(this, FieldBucketsResponse::Type, shell);
+
+        _kindCombo = new QComboBox;
+        _kindCombo->addItem("Histogram of numbers");
+        _kindCombo->addItem("Time series of dates");
+        _kindCombo->setCurrentIndex(kind == FieldBuckets::Kind::Dates ? 1 : 0);
+        _bucketsSpin = new QSpinBox;
+        _bucketsSpin->setRange(2, 500);
+        _bucketsSpin->setValue(FieldBuckets::DefaultBucketCount);
+        _bucketsSpin->setToolTip("Buckets of about the same number of documents ($bucketAuto)");
+        _unitCombo = new QComboBox;
+        for (const char *label : UnitLabels)
+            _unitCombo->addItem(label);
+        _unitCombo->setCurrentIndex(static_cast<int>(unit));
+        _unitCombo->setToolTip("Length of bucket, in UTC; weeks start on Monday");
+        _refreshButton = new QPushButton("Refresh");
+        _refreshButton->setDefault(true);
+
+        auto commandLayout = new QHBoxLayout;
+        commandLayout->addWidget(_kindCombo);
+        commandLayout->addWidget(new QLabel("Buckets:"));
+        commandLayout->addWidget(_bucketsSpin);
+        commandLayout->addWidget(new QLabel("Interval:"));
+        commandLayout->addWidget(_unitCombo);
+        commandLayout->addWidget(_refreshButton);
+        commandLayout->addStretch(1);
+
+        _chart = new detail::BucketChart;
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_refreshButton, SIGNAL(clicked()), this, SLOT(refresh())));
+        VERIFY(connect(_kindCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(updateControls())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(commandLayout);
+        layout->addWidget(_chart, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        updateControls();
+        refresh();
+    }
+
+    void FieldChartDialog::updateControls()
+    {
+        bool const dates = _kindCombo->currentIndex() == 1;
+        _bucketsSpin->setEnabled(!dates);
+        _unitCombo->setEnabled(dates);
+    }
+
+    void FieldChartDialog::refresh()
+    {
+        FieldBuckets::Spec spec;
+        spec.kind = _kindCombo->currentIndex() == 1 ? FieldBuckets::Kind::Dates : FieldBuckets::Kind::Numbers;
+        spec.buckets = _bucketsSpin->value();
+        spec.unit = static_cast<FieldBuckets::DateUnit>(_unitCombo->currentIndex());
+
+        static int lastBucketsId = 0;
+        _bucketsId = ++lastBucketsId;
+
+        _refreshButton->setEnabled(false);
+        _statusLabel->setText("Bucketing values on server...");
+        _shell->bucketField(_bucketsId, _queryInfo, QtUtils::toStdString(_field), spec);
+    }
+
+    void FieldChartDialog::handle(FieldBucketsResponse *event)
+    {
+        if (event->bucketsId != _bucketsId)
+            return;
+
+        _bucketsId = 0;
+        _refreshButton->setEnabled(true);
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        FieldBuckets::Result const &result = event->result;
+        bool const dates = result.spec.kind == FieldBuckets::Kind::Dates;
+        QString status = result.documents == 0 ?
+            QString("No matching documents have %1 in this field").arg(dates ? "dates" : "numbers") :
+            QString("%1 documents in %2 buckets").arg(result.documents).arg(result.buckets.size());
+        if (result.truncated)
+            status += QString(", only the first %1 buckets are shown, choose longer interval").arg(FieldBuckets::MaxDateBuckets);
+        _statusLabel->setText(status + QString(" (%1 ms)").arg(event->elapsedMs));
+
+        _chart->setResult(std::move(event->result));
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QDialog>
+
+#include "robomongo/core/domain/FieldBuckets.h"
+#include "robomongo/core/domain/MongoQueryInfo.h"
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+class QLabel;
+class QPushButton;
+class QSpinBox;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoShell;
+    class FieldBucketsResponse;
+
+    namespace detail
+    {
+        class BucketChart;
+    }
+
+    /**
+     * @brief Shows histogram of numeric field or time series of date field among all documents
+     *        of query, bucketed on server (see FieldBuckets)
+     */
+    class FieldChartDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        FieldChartDialog(MongoShell *shell, const MongoQueryInfo &queryInfo, const QString &field,
+                         FieldBuckets::Kind kind, FieldBuckets::DateUnit unit, QWidget *parent = 0);
+
+    public Q_SLOTS:
+        void handle(FieldBucketsResponse *event);
+
+    private Q_SLOTS:
+        void refresh();
+        void updateControls();
+
+    private:
+        MongoShell *const _shell;
+        MongoQueryInfo const _queryInfo;
+        QString const _field;
+
+        QComboBox *_kindCombo;
+        QSpinBox *_bucketsSpin;
+        QComboBox *_unitCombo;
+        QPushButton *_refreshButton;
+        QLabel *_statusLabel;
+        detail::BucketChart *_chart;
+
+        int _bucketsId;     // 0, if nothing is being bucketed
+    };
+}
@@ -0,0 +1,279 @@
+#include "robomongo/gui/dialogs/GridFsDialog.h"
+
+#include <algorithm>
+
+#include <QDateTime>
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/MongoUtils.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            FilenameColumn, SizeColumn, UploadedColumn, ContentTypeColumn, ChunkSizeColumn, IdColumn,
+            ColumnCount
+        };
+
+        QString throughputText(long long bytes, long long elapsedMs)
+        {
+            if (elapsedMs <= 0)
+                return QString();
+            return MongoUtils::buildNiceSizeString(bytes * 1000.0 / elapsedMs) + "/s";
+        }
+    }
+
+    GridFsDialog::GridFsDialog(MongoServer *server, const QString &dbName, const QString &bucket, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _bucket(bucket),
+        _listId(0),
+        _transferId(0),
+        _direction(GridFsTransferRequest::Download)
+    {
+        setWindowTitle("GridFS Bucket " + dbName + "." + bucket);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(900, 550);
+
+        AppRegistry::instance().bus()->subscribe(this, GridFsFilesResponse::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, GridFsTransferProgressEvent::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, GridFsTransferResponse::Type, server);
+
+        _filenameEdit = new QLineEdit;
+        _filenameEdit->setPlaceholderText("Part of filename");
+        _findButton = new QPushButton("Find");
+        _findButton->setDefault(true);
+        _countLabel = new QLabel;
+
+        auto findLayout = new QHBoxLayout;
+        findLayout->addWidget(_filenameEdit, 1);
+        findLayout->addWidget(_findButton);
+        findLayout->addWidget(_countLabel);
+
+        _tree = new QTreeWidget;
+        _tree->setColumnCount(ColumnCount);
+        _tree->setHeaderLabels(QStringList() << "Filename" << "Size" << "Uploaded" << "Content type"
+                                             << "Chunk size" << "_id");
+        _tree->setRootIsDecorated(false);
+        _tree->setUniformRowHeights(true);
+        _tree->setSelectionMode(QAbstractItemView::SingleSelection);
+        _tree->header()->resizeSection(FilenameColumn, 300);
+
+        _downloadButton = new QPushButton("Download...");
+        _uploadButton = new QPushButton("Upload...");
+        _cancelButton = new QPushButton("Cancel Transfer");
+        _progressBar = new QProgressBar;
+        _progressBar->hide();
+
+        auto transferLayout = new QHBoxLayout;
+        transferLayout->addWidget(_downloadButton);
+        transferLayout->addWidget(_uploadButton);
+        transferLayout->addWidget(_progressBar, 1);
+        transferLayout->addWidget(_cancelButton);
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_findButton, SIGNAL(clicked()), this, SLOT(refresh())));
+        VERIFY(connect(_filenameEdit, SIGNAL(returnPressed()), this, SLOT(refresh())));
+        VERIFY(connect(_downloadButton, SIGNAL(clicked()), this, SLOT(download())));
+        VERIFY(connect(_tree, SIGNAL(itemDoubleClicked(QTreeWidgetItem *, int)), this, SLOT(download())));
+        VERIFY(connect(_uploadButton, SIGNAL(clicked()), this, SLOT(upload())));
+        VERIFY(connect(_cancelButton, SIGNAL(clicked()), this, SLOT(cancelTransfer())));
+        VERIFY(connect(_tree, SIGNAL(itemSelectionChanged()), this, SLOT(updateButtons())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(findLayout);
+        layout->addWidget(_tree, 1);
+        layout->addLayout(transferLayout);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        updateButtons();
+        refresh();
+    }
+
+    GridFsDialog::~GridFsDialog()
+    {
+        // Transfer of closed dialog is stopped, its partial file removed by worker
+        if (_cancelled)
+            *_cancelled = true;
+    }
+
+    void GridFsDialog::refresh()
+    {
+        if (_listId)
+            return;
+
+        static int lastListId = 0;
+        _listId = ++lastListId;
+        _findButton->setEnabled(false);
+        _server->gridFsFiles(_listId, QtUtils::toStdString(_dbName), QtUtils::toStdString(_bucket),
+                             QtUtils::toStdString(_filenameEdit->text().trimmed()), MaxFiles);
+    }
+
+    void GridFsDialog::handle(GridFsFilesResponse *event)
+    {
+        if (event->listId != _listId)
+            return;
+
+        _listId = 0;
+        _findButton->setEnabled(true);
+
+        if (event->isError()) {
+            _countLabel->clear();
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        _files = event->files;
+        _tree->clear();
+        for (size_t i = 0; i < _files.size(); ++i) {
+            GridFs::FileInfo const &file = _files[i];
+            auto item = new QTreeWidgetItem(_tree);
+            item->setData(FilenameColumn, Qt::UserRole, static_cast<qulonglong>(i));
+            item->setText(FilenameColumn, QtUtils::toQString(file.filename));
+            item->setText(SizeColumn, MongoUtils::buildNiceSizeString(file.length));
+            item->setTextAlignment(SizeColumn, Qt::AlignRight | Qt::AlignVCenter);
+            if (file.uploadDateMs > 0)
+                item->setText(UploadedColumn, QDateTime::fromMSecsSinceEpoch(file.uploadDateMs)
+                                                  .toString("yyyy-MM-dd hh:mm:ss"));
+            item->setText(ContentTypeColumn, QtUtils::toQString(file.contentType));
+            item->setText(ChunkSizeColumn, MongoUtils::buildNiceSizeString(file.chunkSize));
+            item->setTextAlignment(ChunkSizeColumn, Qt::AlignRight | Qt::AlignVCenter);
+            item->setText(IdColumn, QtUtils::toQString(BsonUtils::jsonString(file.id, mongo::TenGen, 0,
+                                                                             DefaultEncoding, Utc)));
+        }
+
+        QString text = QString("%1 files").arg(_files.size());
+        if (_files.size() >= MaxFiles)
+            text += QString(", only the %1 most recent").arg(MaxFiles);
+        _countLabel->setText(text);
+        updateButtons();
+    }
+
+    void GridFsDialog::download()
+    {
+        QTreeWidgetItem *item = _tree->currentItem();
+        if (_transferId || !item)
+            return;
+
+        GridFs::FileInfo const &file = _files[item->data(FilenameColumn, Qt::UserRole).toULongLong()];
+        QString const suggested = QDir::home().filePath(QtUtils::toQString(file.filename).section('/', -1));
+        QString const path = QFileDialog::getSaveFileName(this, "Download File", suggested);
+        if (path.isEmpty())
+            return;
+
+        startTransfer(GridFsTransferRequest::Download, file, path);
+    }
+
+    void GridFsDialog::upload()
+    {
+        if (_transferId)
+            return;
+
+        QString const path = QFileDialog::getOpenFileName(this, "Upload File", QDir::homePath());
+        if (path.isEmpty())
+            return;
+
+        // Name and chunks are set by worker
+        startTransfer(GridFsTransferRequest::Upload, GridFs::FileInfo(), path);
+    }
+
+    void GridFsDialog::startTransfer(int direction, const GridFs::FileInfo &file, const QString &filePath)
+    {
+        static int lastTransferId = 0;
+        _transferId = ++lastTransferId;
+        _direction = direction;
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+
+        _progressBar->setRange(0, 0);
+        _progressBar->show();
+        _statusLabel->setText((direction == GridFsTransferRequest::Download ? "Downloading " : "Uploading ") +
+                              filePath + "...");
+        updateButtons();
+
+        _server->gridFsTransfer(_transferId, static_cast<GridFsTransferRequest::Direction>(direction),
+                                QtUtils::toStdString(_dbName), QtUtils::toStdString(_bucket), file, filePath,
+                                _cancelled);
+    }
+
+    void GridFsDialog::cancelTransfer()
+    {
+        if (_cancelled)
+            *_cancelled = true;
+        _cancelButton->setEnabled(false);
+    }
+
+    void GridFsDialog::handle(GridFsTransferProgressEvent *event)
+    {
+        if (event->transferId != _transferId)
+            return;
+
+        // Progress bar works in KB, int is not enough for bytes of large files
+        _progressBar->setRange(0, static_cast<int>(std::max(1LL, event->total / 1024)));
+        _progressBar->setValue(static_cast<int>(event->bytes / 1024));
+        _statusLabel->setText(QString("%1 of %2, %3")
+            .arg(MongoUtils::buildNiceSizeString(event->bytes))
+            .arg(MongoUtils::buildNiceSizeString(event->total))
+            .arg(throughputText(event->bytes, event->elapsedMs)));
+    }
+
+    void GridFsDialog::handle(GridFsTransferResponse *event)
+    {
+        if (event->transferId != _transferId)
+            return;
+
+        _transferId = 0;
+        _cancelled.reset();
+        _progressBar->hide();
+        updateButtons();
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        _statusLabel->setText(QString("%1 %2 (%3) in %4 s, %5.")
+            .arg(_direction == GridFsTransferRequest::Download ? "Downloaded" : "Uploaded")
+            .arg(QtUtils::toQString(event->file.filename))
+            .arg(MongoUtils::buildNiceSizeString(event->file.length))
+            .arg(event->elapsedMs / 1000.0, 0, 'f', 1)
+            .arg(throughputText(event->file.length, event->elapsedMs)));
+
+        if (_direction == GridFsTransferRequest::Upload)
+            refresh();
+    }
+
+    void GridFsDialog::updateButtons()
+    {
+        bool const transferring = _transferId != 0;
+        _downloadButton->setEnabled(!transferring && _tree->currentItem());
+        _uploadButton->setEnabled(!transferring);
+        _cancelButton->setEnabled(transferring);
+    }
+}
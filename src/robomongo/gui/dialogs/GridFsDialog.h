@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QDialog>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "robomongo/core/domain/GridFs.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QLineEdit;
+class QProgressBar;
+class QPushButton;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class GridFsFilesResponse;
+    class GridFsTransferProgressEvent;
+    class GridFsTransferResponse;
+
+    /**
+     * @brief Files of GridFS bucket with download to disk and upload from disk. Content is
+     *        streamed by the worker chunk range by chunk range (see GridFs), so that neither
+     *        this dialog nor the document viewer ever holds the chunks of a file.
+     */
+    class GridFsDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        GridFsDialog(MongoServer *server, const QString &dbName, const QString &bucket, QWidget *parent = 0);
+        ~GridFsDialog();
+
+    public Q_SLOTS:
+        void handle(GridFsFilesResponse *event);
+        void handle(GridFsTransferProgressEvent *event);
+        void handle(GridFsTransferResponse *event);
+
+    private Q_SLOTS:
+        void refresh();
+        void download();
+        void upload();
+        void cancelTransfer();
+        void updateButtons();
+
+    private:
+        static const int MaxFiles = 1000;
+
+        // direction is GridFsTransferRequest::Direction
+        void startTransfer(int direction, const GridFs::FileInfo &file, const QString &filePath);
+
+        MongoServer *const _server;
+        QString const _dbName;
+        QString const _bucket;
+        int _listId;                                    // 0, if files are not being read
+        int _transferId;                                // 0, if no transfer is running
+        int _direction;                                 // GridFsTransferRequest::Direction of running transfer
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+        std::vector<GridFs::FileInfo> _files;
+
+        QLineEdit *_filenameEdit;
+        QPushButton *_findButton;
+        QLabel *_countLabel;
+        QTreeWidget *_tree;
+        QPushButton *_downloadButton;
+        QPushButton *_uploadButton;
+        QPushButton *_cancelButton;
+        QProgressBar *_progressBar;
+        QLabel *_statusLabel;
+    };
+}
@@ -0,0 +1,283 @@
+#include "robomongo/gui/dialogs/ImportDialog.h"
+
+#include <QPushButton>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QGridLayout>
+#include <QLineEdit>
+#include <QLabel>
+#include <QDialogButtonBox>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QGroupBox>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QProgressBar>
+#include <QSpinBox>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/gui/utils/GuiConstants.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum FormatIndex
+        {
+            JsonIndex = 0,
+            CsvIndex = 1
+        };
+
+        int const ProgressRange = 1000;
+        int const MaxConcurrency = 16;
+
+        QString countsText(long long inserted, long long failed, long long elapsedMs)
+        {
+            QString text = QString::number(inserted) + " documents inserted";
+            if (failed > 0)
+                text += ", " + QString::number(failed) + " failed";
+
+            double const seconds = elapsedMs / 1000.0;
+            if (seconds > 0) {
+                text += QString(" in %1 s (%2 docs/s)")
+                    .arg(seconds, 0, 'f', 1)
+                    .arg(static_cast<long long>(inserted / seconds));
+            }
+            return text;
+        }
+    }
+
+    ImportDialog::ImportDialog(MongoServer *server, const QString &dbName, const QString &collName,
+                               QWidget *parent) :
+        QDialog(parent), _server(server), _dbName(dbName), _collName(collName), _importId(0)
+    {
+        setWindowTitle("Import Documents");
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setMinimumWidth(500);
+
+        AppRegistry::instance().bus()->subscribe(this, ImportProgressEvent::Type, _server);
+        AppRegistry::instance().bus()->subscribe(this, ImportDocumentsResponse::Type, _server);
+
+        // Target collection
+        auto selectedCollLay = new QGridLayout;
+        selectedCollLay->setAlignment(Qt::AlignTop);
+        selectedCollLay->setColumnStretch(2, 1);
+
+        auto serverIcon = new QLabel("<html><img src=':/robomongo/icons/server_16x16.png'></html>");
+        auto dbIcon = new QLabel("<html><img src=':/robomongo/icons/database_16x16.png'></html>");
+        auto collIcon = new QLabel("<html><img src=':/robomongo/icons/collection_16x16.png'></html>");
+        QString const serverName = QtUtils::toQString(_server->connectionRecord()->getFullAddress());
+
+        selectedCollLay->addWidget(serverIcon,                      1, 0);
+        selectedCollLay->addWidget(new QLabel("Server: "),          1, 1);
+        selectedCollLay->addWidget(new QLabel(serverName),          1, 2);
+        selectedCollLay->addWidget(dbIcon,                          2, 0);
+        selectedCollLay->addWidget(new QLabel("Database: "),        2, 1);
+        selectedCollLay->addWidget(new QLabel(dbName),              2, 2);
+        selectedCollLay->addWidget(collIcon,                        3, 0);
+        selectedCollLay->addWidget(new QLabel("Collection: "),      3, 1);
+        selectedCollLay->addWidget(new QLabel(collName),            3, 2);
+
+        // Input properties
+        _inputFile = new QLineEdit;
+        _browseButton = new QPushButton("...");
+        _browseButton->setMaximumWidth(50);
+        VERIFY(connect(_browseButton, SIGNAL(clicked()), this, SLOT(on_browseButton_clicked())));
+#ifdef Q_OS_WIN
+        _browseButton->setMaximumHeight(HighDpiConstants::WIN_HIGH_DPI_BUTTON_HEIGHT);
+#endif
+
+        _formatComboBox = new QComboBox;
+        _formatComboBox->addItem("JSON (JSON Lines, documents or array)");
+        _formatComboBox->addItem("CSV (with header line)");
+
+        _batchSize = new QSpinBox;
+        _batchSize->setRange(1, 100000);
+        _batchSize->setValue(1000);
+        _batchSize->setToolTip("Documents per insert command");
+
+        _concurrency = new QSpinBox;
+        _concurrency->setRange(1, MaxConcurrency);
+        _concurrency->setValue(1);
+        _concurrency->setToolTip("Insert commands in flight, each on its own connection");
+        _concurrency->setEnabled(false);
+
+        _ordered = new QCheckBox("Ordered (stop at the first failed document)");
+        _ordered->setChecked(true);
+        VERIFY(connect(_ordered, SIGNAL(toggled(bool)), this, SLOT(on_orderedCheckBox_toggled(bool))));
+
+        auto inputsInnerLay = new QGridLayout;
+        inputsInnerLay->addWidget(new QLabel("File:"),          0, 0);
+        inputsInnerLay->addWidget(_inputFile,                   0, 1);
+        inputsInnerLay->addWidget(_browseButton,                0, 2);
+        inputsInnerLay->addWidget(new QLabel("Format:"),        1, 0);
+        inputsInnerLay->addWidget(_formatComboBox,              1, 1, 1, 2);
+        inputsInnerLay->addWidget(new QLabel("Batch Size:"),    2, 0);
+        inputsInnerLay->addWidget(_batchSize,                   2, 1, 1, 2, Qt::AlignLeft);
+        inputsInnerLay->addWidget(new QLabel("Concurrency:"),   3, 0);
+        inputsInnerLay->addWidget(_concurrency,                 3, 1, 1, 2, Qt::AlignLeft);
+        inputsInnerLay->addWidget(_ordered,                     4, 1, 1, 2);
+
+        // Progress
+        _progressBar = new QProgressBar;
+        _progressBar->setRange(0, ProgressRange);
+        _progressBar->setValue(0);
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        auto progressLay = new QVBoxLayout;
+        progressLay->addWidget(_progressBar);
+        progressLay->addWidget(_statusLabel);
+
+        _buttonBox = new QDialogButtonBox(this);
+        _buttonBox->setOrientation(Qt::Horizontal);
+        _buttonBox->setStandardButtons(QDialogButtonBox::Cancel | QDialogButtonBox::Ok);
+        _buttonBox->button(QDialogButtonBox::Ok)->setText("&Import");
+        VERIFY(connect(_buttonBox, SIGNAL(accepted()), this, SLOT(accept())));
+        VERIFY(connect(_buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+
+        auto targetGroupBox = new QGroupBox("Target Collection");
+        targetGroupBox->setLayout(selectedCollLay);
+        targetGroupBox->setStyleSheet("QGroupBox::title { left: 0px }");
+
+        auto inputsGroupBox = new QGroupBox("Input Properties");
+        inputsGroupBox->setLayout(inputsInnerLay);
+        inputsGroupBox->setStyleSheet("QGroupBox::title { left: 0px }");
+
+        auto progressGroupBox = new QGroupBox("Progress");
+        progressGroupBox->setLayout(progressLay);
+        progressGroupBox->setStyleSheet("QGroupBox::title { left: 0px }");
+
+        auto layout = new QVBoxLayout();
+        layout->addWidget(targetGroupBox);
+        layout->addWidget(inputsGroupBox);
+        layout->addWidget(progressGroupBox);
+        layout->addWidget(_buttonBox);
+        setLayout(layout);
+
+        _inputFile->setFocus();
+    }
+
+    ImportDialog::~ImportDialog()
+    {
+        // Import of closed dialog is stopped, inserted documents are kept
+        if (_cancelled)
+            *_cancelled = true;
+    }
+
+    void ImportDialog::accept()
+    {
+        if (_importId)
+            return;
+
+        QString const filePath = _inputFile->text().trimmed();
+        if (filePath.isEmpty() || !QFileInfo(filePath).isFile()) {
+            QMessageBox::critical(this, "Error", "Please select file to import.");
+            return;
+        }
+
+        ImportOptions options;
+        options.format = _formatComboBox->currentIndex() == CsvIndex ? ImportFormat::Csv : ImportFormat::Json;
+        options.batchSize = _batchSize->value();
+        options.ordered = _ordered->isChecked();
+        options.concurrency = options.ordered ? 1 : _concurrency->value();
+
+        static int lastImportId = 0;
+        _importId = ++lastImportId;
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+
+        enableDisableWidgets(false);
+        _progressBar->setValue(0);
+        _statusLabel->setText("Importing...");
+
+        _server->importDocuments(_importId, MongoNamespace(QtUtils::toStdString(_dbName), QtUtils::toStdString(_collName)),
+                                 QDir::toNativeSeparators(filePath), options, _cancelled);
+    }
+
+    void ImportDialog::reject()
+    {
+        if (!_importId) {
+            QDialog::reject();
+            return;
+        }
+
+        // Dialog stays open until worker replies
+        *_cancelled = true;
+        _statusLabel->setText("Cancelling...");
+    }
+
+    void ImportDialog::handle(ImportProgressEvent *event)
+    {
+        if (event->importId != _importId)
+            return;
+
+        if (event->fileSize > 0)
+            _progressBar->setValue(static_cast<int>(event->bytesRead * ProgressRange / event->fileSize));
+
+        QString text = "Importing... " + countsText(event->inserted, event->failed, event->elapsedMs);
+        if (event->throttleMs > 0)
+            text += QString("\nServer is busy, inserts are slowed down by %1 ms.").arg(event->throttleMs);
+        _statusLabel->setText(text);
+    }
+
+    void ImportDialog::handle(ImportDocumentsResponse *event)
+    {
+        if (event->importId != _importId)
+            return;
+
+        _importId = 0;
+        _cancelled.reset();
+        enableDisableWidgets(true);
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()) + "\n" +
+                                  countsText(event->inserted, event->failed, 0) + ".");
+            return;
+        }
+
+        _progressBar->setValue(ProgressRange);
+        QString text = "Import finished: " + countsText(event->inserted, event->failed, event->elapsedMs) + ".";
+        if (!event->errors.empty())
+            text += "\n" + QtUtils::toQString(event->errors);
+        _statusLabel->setText(text);
+    }
+
+    void ImportDialog::on_browseButton_clicked()
+    {
+        QString const file = QFileDialog::getOpenFileName(this, tr("Select File"), QDir::homePath(),
+                                                          tr("JSON or CSV (*.json *.jsonl *.csv);;All Files (*)"));
+        raise();
+        activateWindow();
+
+        if (file.isEmpty())
+            return;
+
+        _inputFile->setText(QDir::toNativeSeparators(file));
+        bool const isCsv = QFileInfo(file).suffix().compare("csv", Qt::CaseInsensitive) == 0;
+        _formatComboBox->setCurrentIndex(isCsv ? CsvIndex : JsonIndex);
+    }
+
+    void ImportDialog::on_orderedCheckBox_toggled(bool ordered)
+    {
+        // Ordered import inserts batches one after another
+        _concurrency->setEnabled(!ordered);
+    }
+
+    void ImportDialog::enableDisableWidgets(bool enable) const
+    {
+        _inputFile->setEnabled(enable);
+        _browseButton->setEnabled(enable);
+        _formatComboBox->setEnabled(enable);
+        _batchSize->setEnabled(enable);
+        _concurrency->setEnabled(enable && !_ordered->isChecked());
+        _ordered->setEnabled(enable);
+        _buttonBox->button(QDialogButtonBox::Ok)->setEnabled(enable);
+    }
+}
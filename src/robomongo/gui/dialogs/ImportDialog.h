@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QDialog>
+#include <atomic>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QDialogButtonBox;
+class QLineEdit;
+class QComboBox;
+class QCheckBox;
+class QSpinBox;
+class QPushButton;
+class QProgressBar;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class ImportProgressEvent;
+    class ImportDocumentsResponse;
+
+    /**
+     * @brief Imports JSON (JSON Lines, documents or array of them) or CSV file into collection.
+     *        Import runs in the worker of server (see MongoServer::importDocuments()), dialog
+     *        shows progress and throughput, and cancels import when closed.
+     */
+    class ImportDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        ImportDialog(MongoServer *server, const QString &dbName, const QString &collName,
+                     QWidget *parent = 0);
+        ~ImportDialog();
+
+    public Q_SLOTS:
+        virtual void accept();
+        virtual void reject();
+
+        void handle(ImportProgressEvent *event);
+        void handle(ImportDocumentsResponse *event);
+
+    private Q_SLOTS:
+        void on_browseButton_clicked();
+        void on_orderedCheckBox_toggled(bool ordered);
+
+    private:
+        // Enable/Disable widgets during/after import operation
+        void enableDisableWidgets(bool enable) const;
+
+        QLineEdit* _inputFile;
+        QPushButton* _browseButton;
+        QComboBox* _formatComboBox;
+        QSpinBox* _batchSize;
+        QSpinBox* _concurrency;
+        QCheckBox* _ordered;
+        QProgressBar* _progressBar;
+        QLabel* _statusLabel;
+        QDialogButtonBox* _buttonBox;
+
+        MongoServer* _server;
+        QString _dbName;
+        QString _collName;
+
+        int _importId;                                  // 0, if no import is running
+        std::shared_ptr<std::atomic<bool>> _cancelled;  // of running import
+    };
+}
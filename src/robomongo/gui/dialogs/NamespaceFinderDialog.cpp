@@ -0,0 +1,163 @@
+#include "robomongo/gui/dialogs/NamespaceFinderDialog.h"
+
+#include <chrono>
+#include <set>
+#include <QCoreApplication>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/domain/App.h"
+#include "robomongo/core/domain/CursorPosition.h"
+#include "robomongo/core/domain/MetadataSnapshot.h"
+#include "robomongo/core/domain/MongoCollection.h"
+#include "robomongo/core/domain/MongoDatabase.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column { CollectionColumn, DatabaseColumn, ConnectionColumn };
+    }
+
+    NamespaceFinderDialog::NamespaceFinderDialog(QWidget *parent) :
+        QDialog(parent)
+    {
+        setWindowTitle("Go to Namespace");
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(700, 460);
+
+        _searchEdit = new QLineEdit;
+        _searchEdit->setPlaceholderText("Collection of any connected server, e.g. shop.ordv2");
+        _searchEdit->installEventFilter(this);
+
+        _list = new QTreeWidget;
+        _list->setRootIsDecorated(false);
+        _list->setUniformRowHeights(true);
+        _list->setHeaderLabels(QStringList() << "Collection" << "Database" << "Connection");
+        _list->header()->setSectionResizeMode(CollectionColumn, QHeaderView::Stretch);
+        _list->header()->setStretchLastSection(false);
+
+        _statusLabel = new QLabel;
+
+        auto openButton = new QPushButton("Open");
+        openButton->setToolTip("Open collection in new shell");
+        openButton->setDefault(true);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        buttonBox->addButton(openButton, QDialogButtonBox::AcceptRole);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(buttonBox, SIGNAL(accepted()), this, SLOT(openSelected())));
+        VERIFY(connect(_searchEdit, SIGNAL(textChanged(QString)), this, SLOT(search())));
+        VERIFY(connect(_list, SIGNAL(itemActivated(QTreeWidgetItem *, int)), this, SLOT(openSelected())));
+
+        auto layout = new QVBoxLayout;
+        layout->addWidget(_searchEdit);
+        layout->addWidget(_list, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        buildIndex();
+        search();
+        _searchEdit->setFocus();
+    }
+
+    void NamespaceFinderDialog::buildIndex()
+    {
+        for (auto const &server : AppRegistry::instance().app()->getServers()) {
+            if (!server->isConnected())
+                continue;
+
+            size_t const serverIndex = _servers.size();
+            _servers.push_back(server.get());
+
+            // Collections explorer loaded (possibly filtered by name) and the last known ones
+            QString const uuid = server->connectionRecord()->uuid();
+            for (MongoDatabase *database : server->databases()) {
+                std::set<std::string> names;
+                for (MongoCollection *collection : database->collections())
+                    names.insert(collection->name());
+                if (auto const cached = MetadataSnapshot::instance().collections(uuid, database->name()))
+                    names.insert(cached->begin(), cached->end());
+
+                for (auto const &name : names)
+                    _index.add(serverIndex, database->name(), name);
+            }
+        }
+    }
+
+    void NamespaceFinderDialog::search()
+    {
+        auto const started = std::chrono::steady_clock::now();
+        std::vector<size_t> const ids = _index.find(QtUtils::toStdString(_searchEdit->text()), MaxShown);
+        double const elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - started).count();
+
+        _list->setUpdatesEnabled(false);
+        _list->clear();
+        QList<QTreeWidgetItem *> items;
+        for (size_t id : ids) {
+            NamespaceIndex::Entry const &entry = _index.entry(id);
+            MongoServer *const server = _servers[entry.server];
+            if (!server)
+                continue;
+
+            auto item = new QTreeWidgetItem;
+            item->setText(CollectionColumn, QtUtils::toQString(entry.collection));
+            item->setText(DatabaseColumn, QtUtils::toQString(entry.database));
+            item->setText(ConnectionColumn, QtUtils::toQString(server->connectionRecord()->getReadableName()));
+            item->setData(CollectionColumn, Qt::UserRole, static_cast<qulonglong>(id));
+            items.append(item);
+        }
+        _list->addTopLevelItems(items);
+        _list->setUpdatesEnabled(true);
+        if (!items.isEmpty())
+            _list->setCurrentItem(items.first());
+
+        _statusLabel->setText(QString("%1 of %2 collections in %3 connections, searched in %4 ms.")
+                              .arg(ids.size()).arg(_index.size()).arg(_servers.size())
+                              .arg(elapsedMs, 0, 'f', 2));
+    }
+
+    void NamespaceFinderDialog::openSelected()
+    {
+        QTreeWidgetItem *item = _list->currentItem();
+        if (!item)
+            return;
+
+        NamespaceIndex::Entry const &entry = _index.entry(item->data(CollectionColumn, Qt::UserRole).toULongLong());
+        MongoServer *const server = _servers[entry.server];
+        if (!server)
+            return;
+
+        // The same shell explorer opens for double clicked collection
+        QString const script = detail::buildCollectionQuery(entry.collection, "find({})");
+        AppRegistry::instance().app()->openShell(server, script, entry.database, true,
+                                                 QtUtils::toQString(entry.database), CursorPosition(0, -2));
+        accept();
+    }
+
+    bool NamespaceFinderDialog::eventFilter(QObject *watched, QEvent *event)
+    {
+        // Arrows move selection of list, while typing goes on in search box
+        if (watched == _searchEdit && event->type() == QEvent::KeyPress) {
+            int const key = static_cast<QKeyEvent *>(event)->key();
+            if (key == Qt::Key_Up || key == Qt::Key_Down || key == Qt::Key_PageUp || key == Qt::Key_PageDown) {
+                QCoreApplication::sendEvent(_list, event);
+                return true;
+            }
+        }
+        return QDialog::eventFilter(watched, event);
+    }
+}
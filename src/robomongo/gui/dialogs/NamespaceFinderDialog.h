@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QDialog>
+#include <QPointer>
+#include <vector>
+
+#include "robomongo/core/domain/NamespaceIndex.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QLineEdit;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+
+    /**
+     * @brief "Go to Namespace": collections of all connected servers, as explorer loaded them
+     *        or as MetadataSnapshot remembers them, fuzzy searched (see NamespaceIndex) as
+     *        user types. Enter opens the collection in new shell, as explorer does.
+     */
+    class NamespaceFinderDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        explicit NamespaceFinderDialog(QWidget *parent = 0);
+
+    protected:
+        bool eventFilter(QObject *watched, QEvent *event) override;
+
+    private Q_SLOTS:
+        void search();
+        void openSelected();
+
+    private:
+        static constexpr size_t MaxShown = 200;
+
+        void buildIndex();
+
+        // Servers closed while dialog is open become null
+        std::vector<QPointer<MongoServer>> _servers;
+        NamespaceIndex _index;
+
+        QLineEdit *_searchEdit;
+        QTreeWidget *_list;
+        QLabel *_statusLabel;
+    };
+}
@@ -0,0 +1,400 @@
+#include "robomongo/gui/dialogs/OplogDialog.h"
+
+#include <algorithm>
+#include <QAbstractTableModel>
+#include <QCheckBox>
+#include <QDateTime>
+#include <QDateTimeEdit>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QSignalBlocker>
+#include <QTableView>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/OplogTail.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            TimeColumn, OpColumn, NamespaceColumn, SummaryColumn,
+            ColumnCount
+        };
+
+        const int MaxSummaryLength = 200;
+        const int MaxTooltipLength = 4000;
+
+        QString timeOf(mongo::Timestamp ts)
+        {
+            return QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(ts.getSecs()) * 1000)
+                .toString("yyyy-MM-dd hh:mm:ss") + QString(" #%1").arg(ts.getInc());
+        }
+
+        QString jsonOf(const mongo::BSONObj &obj, int maxLength)
+        {
+            QString const json = QtUtils::toQString(BsonUtils::jsonString(obj, mongo::TenGen, 0, DefaultEncoding, Utc));
+            return json.length() > maxLength ? json.left(maxLength) + "..." : json;
+        }
+
+        // Updates show their query (o2) before the change (o)
+        QString summaryOf(const mongo::BSONObj &entry)
+        {
+            QString summary = jsonOf(entry.getObjectField("o"), MaxSummaryLength);
+            if (entry.hasField("o2"))
+                summary = jsonOf(entry.getObjectField("o2"), MaxSummaryLength) + "  " + summary;
+            return summary;
+        }
+    }
+
+    /**
+     * @brief Rows of ring buffer, cells are formatted only when they are painted
+     */
+    class OplogModel : public QAbstractTableModel
+    {
+    public:
+        explicit OplogModel(size_t capacity, QObject *parent) :
+            QAbstractTableModel(parent),
+            _buffer(capacity) {}
+
+        const OplogTail::Buffer &buffer() const { return _buffer; }
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override
+        {
+            return parent.isValid() ? 0 : static_cast<int>(_buffer.size());
+        }
+
+        int columnCount(const QModelIndex &parent = QModelIndex()) const override
+        {
+            return parent.isValid() ? 0 : ColumnCount;
+        }
+
+        QVariant data(const QModelIndex &index, int role) const override
+        {
+            if (!index.isValid() || index.row() >= rowCount())
+                return QVariant();
+
+            mongo::BSONObj const &entry = _buffer.at(index.row());
+            if (role == Qt::ToolTipRole) {
+                QString tooltip = QtUtils::toQString(
+                    BsonUtils::jsonString(entry, mongo::TenGen, 1, DefaultEncoding, Utc));
+                return tooltip.length() > MaxTooltipLength ? tooltip.left(MaxTooltipLength) + "\n..." : tooltip;
+            }
+
+            if (role != Qt::DisplayRole)
+                return QVariant();
+
+            switch (index.column()) {
+            case TimeColumn: return timeOf(entry["ts"].timestamp());
+            case OpColumn: return QtUtils::toQString(OplogTail::operationName(entry.getStringField("op")));
+            case NamespaceColumn: return QtUtils::toQString(entry.getStringField("ns"));
+            case SummaryColumn: return summaryOf(entry);
+            default: return QVariant();
+            }
+        }
+
+        QVariant headerData(int section, Qt::Orientation orientation, int role) const override
+        {
+            if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+                return QVariant();
+
+            switch (section) {
+            case TimeColumn: return "Time";
+            case OpColumn: return "Op";
+            case NamespaceColumn: return "Namespace";
+            case SummaryColumn: return "Document";
+            default: return QVariant();
+            }
+        }
+
+        /**
+         * @return Number of dropped oldest entries
+         */
+        size_t append(std::vector<mongo::BSONObj> entries)
+        {
+            if (entries.empty())
+                return 0;
+
+            // More than fits, only the newest ones are kept
+            size_t dropped = 0;
+            if (entries.size() > _buffer.capacity()) {
+                dropped = entries.size() - _buffer.capacity();
+                entries.erase(entries.begin(), entries.begin() + dropped);
+            }
+
+            size_t const overflow = _buffer.size() + entries.size() > _buffer.capacity() ?
+                                    _buffer.size() + entries.size() - _buffer.capacity() : 0;
+            if (overflow > 0) {
+                beginRemoveRows(QModelIndex(), 0, static_cast<int>(overflow) - 1);
+                _buffer.dropOldest(overflow);
+                endRemoveRows();
+            }
+
+            int const first = rowCount();
+            beginInsertRows(QModelIndex(), first, first + static_cast<int>(entries.size()) - 1);
+            _buffer.append(entries);
+            endInsertRows();
+            return dropped + overflow;
+        }
+
+        void clear()
+        {
+            beginResetModel();
+            _buffer.clear();
+            endResetModel();
+        }
+
+    private:
+        OplogTail::Buffer _buffer;
+    };
+
+    OplogDialog::OplogDialog(MongoServer *server, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _tailId(0),
+        _received(0),
+        _receivedSinceStatus(0)
+    {
+        setWindowTitle(QString("Oplog of %1").arg(
+            QtUtils::toQString(server->connectionRecord()->getReadableName())));
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(1000, 600);
+
+        AppRegistry::instance().bus()->subscribe(this, OplogEntriesEvent::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, TailOplogResponse::Type, server);
+
+        _namespace = new QLineEdit;
+        _namespace->setPlaceholderText("database or database.collection");
+        _namespace->setToolTip("Only entries of namespaces with this prefix are read from server");
+
+        auto filterLayout = new QHBoxLayout;
+        filterLayout->addWidget(new QLabel("Namespace:"));
+        filterLayout->addWidget(_namespace, 1);
+        for (auto const &op : { "i", "u", "d", "c", "n" }) {
+            auto checkBox = new QCheckBox(QtUtils::toQString(OplogTail::operationName(op)));
+            checkBox->setChecked(true);
+            _operations.push_back(std::make_pair(checkBox, std::string(op)));
+            filterLayout->addWidget(checkBox);
+            VERIFY(connect(checkBox, SIGNAL(toggled(bool)), this, SLOT(applyFilter())));
+        }
+
+        _from = new QDateTimeEdit(QDateTime::currentDateTime());
+        _from->setDisplayFormat("yyyy-MM-dd hh:mm:ss");
+        _from->setCalendarPopup(true);
+        _seekButton = new QPushButton("Seek");
+        _seekButton->setToolTip("Shows entries from this time, they are read again if they are not in the list");
+
+        _follow = new QCheckBox("Follow");
+        _follow->setChecked(true);
+        _pauseButton = new QPushButton("Pause");
+        _pauseButton->setCheckable(true);
+
+        auto tailLayout = new QHBoxLayout;
+        tailLayout->addWidget(new QLabel("From:"));
+        tailLayout->addWidget(_from);
+        tailLayout->addWidget(_seekButton);
+        tailLayout->addStretch(1);
+        tailLayout->addWidget(_follow);
+        tailLayout->addWidget(_pauseButton);
+
+        _model = new OplogModel(MaxEntries, this);
+        _view = new QTableView;
+        _view->setModel(_model);
+        _view->setSelectionBehavior(QAbstractItemView::SelectRows);
+        _view->setWordWrap(false);
+        _view->verticalHeader()->hide();
+        // Fixed rows, so that view does not measure inserted rows
+        _view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+        _view->verticalHeader()->setDefaultSectionSize(_view->fontMetrics().height() + 4);
+        _view->horizontalHeader()->setStretchLastSection(true);
+        _view->setColumnWidth(TimeColumn, 190);
+        _view->setColumnWidth(OpColumn, 70);
+        _view->setColumnWidth(NamespaceColumn, 200);
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(filterLayout);
+        layout->addLayout(tailLayout);
+        layout->addWidget(_view, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        _timer = new QTimer(this);
+        _timer->setInterval(RepaintIntervalMs);
+
+        VERIFY(connect(_timer, SIGNAL(timeout()), this, SLOT(applyPending())));
+        VERIFY(connect(_namespace, SIGNAL(editingFinished()), this, SLOT(applyFilter())));
+        VERIFY(connect(_seekButton, SIGNAL(clicked()), this, SLOT(seek())));
+        VERIFY(connect(_pauseButton, SIGNAL(toggled(bool)), this, SLOT(togglePause(bool))));
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+
+        _timer->start();
+        _rateTimer.start();
+        startTail(mongo::Timestamp(), false);
+    }
+
+    OplogDialog::~OplogDialog()
+    {
+        stopTail();
+    }
+
+    void OplogDialog::handle(OplogEntriesEvent *event)
+    {
+        if (event->tailId != _tailId)
+            return;
+
+        // Applied with the next repaint, only what fits in the view is kept meanwhile
+        _pending.insert(_pending.end(), event->entries.begin(), event->entries.end());
+        size_t const maxEntries = MaxEntries;
+        if (_pending.size() > maxEntries)
+            _pending.erase(_pending.begin(), _pending.end() - maxEntries);
+
+        if (!event->entries.empty())
+            _lastTs = event->entries.back()["ts"].timestamp();
+        _received += event->entries.size();
+        _receivedSinceStatus += event->entries.size();
+    }
+
+    void OplogDialog::handle(TailOplogResponse *event)
+    {
+        if (event->tailId != _tailId)
+            return;
+
+        if (event->isError())
+            _error = QtUtils::toQString(event->error().errorMessage());
+        _cancelled.reset();
+        updateStatus();
+    }
+
+    void OplogDialog::applyPending()
+    {
+        if (!_pending.empty()) {
+            std::vector<mongo::BSONObj> entries;
+            entries.swap(_pending);
+            _model->append(std::move(entries));
+            if (_follow->isChecked())
+                _view->scrollToBottom();
+        }
+
+        if (_rateTimer.elapsed() >= 1000)
+            updateStatus();
+    }
+
+    void OplogDialog::applyFilter()
+    {
+        // Entries shown so far are kept, new ones match the filter
+        if (!_pauseButton->isChecked())
+            startTail(_lastTs, true);
+    }
+
+    void OplogDialog::togglePause(bool paused)
+    {
+        _pauseButton->setText(paused ? "Resume" : "Pause");
+        if (paused) {
+            stopTail();
+            updateStatus();
+        }
+        else {
+            startTail(_lastTs, true);
+        }
+    }
+
+    void OplogDialog::seek()
+    {
+        mongo::Timestamp const ts(static_cast<unsigned>(_from->dateTime().toMSecsSinceEpoch() / 1000), 0);
+
+        // Entries from this time are in the list already
+        OplogTail::Buffer const &buffer = _model->buffer();
+        if (buffer.size() > 0 && !(ts < buffer.at(0)["ts"].timestamp())) {
+            size_t const row = buffer.lowerBound(ts);
+            if (row < buffer.size()) {
+                _follow->setChecked(false);
+                QModelIndex const index = _model->index(static_cast<int>(row), TimeColumn);
+                _view->scrollTo(index, QAbstractItemView::PositionAtTop);
+                _view->setCurrentIndex(index);
+                return;
+            }
+        }
+
+        _follow->setChecked(false);
+        _pending.clear();
+        _model->clear();
+        _lastTs = mongo::Timestamp();
+        startTail(ts, false);
+        if (_pauseButton->isChecked()) {
+            const QSignalBlocker blocker(_pauseButton);
+            _pauseButton->setChecked(false);
+            _pauseButton->setText("Pause");
+        }
+    }
+
+    void OplogDialog::startTail(mongo::Timestamp from, bool afterFrom)
+    {
+        stopTail();
+
+        OplogTail::Filter filter;
+        filter.nsPrefix = QtUtils::toStdString(_namespace->text().trimmed());
+        for (auto const &op : _operations) {
+            if (op.first->isChecked())
+                filter.ops.push_back(op.second);
+        }
+        // Nothing is unchecked, so filter by operation is not needed
+        if (filter.ops.size() == _operations.size())
+            filter.ops.clear();
+        filter.from = from;
+        filter.afterFrom = afterFrom;
+
+        static int lastTailId = 0;
+        _tailId = ++lastTailId;
+        _error.clear();
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+        _server->tailOplog(_tailId, filter, _cancelled);
+        updateStatus();
+    }
+
+    void OplogDialog::stopTail()
+    {
+        // Worker closes the cursor within TailOplogRequest::AwaitMs
+        if (_cancelled)
+            *_cancelled = true;
+        _cancelled.reset();
+    }
+
+    void OplogDialog::updateStatus()
+    {
+        qint64 const elapsedMs = std::max<qint64>(_rateTimer.restart(), 1);
+        long long const rate = _receivedSinceStatus * 1000 / elapsedMs;
+        _receivedSinceStatus = 0;
+
+        QString text = QString("%1 entries shown of %2 received").arg(_model->rowCount()).arg(_received);
+        if (!_lastTs.isNull())
+            text += QString(", the last at %1").arg(timeOf(_lastTs));
+        if (_cancelled)
+            text += QString(", %1 entries/s.").arg(rate);
+        else
+            text += _pauseButton->isChecked() ? ". Paused." : ". Stopped.";
+        if (!_error.isEmpty())
+            text += " " + _error;
+        _statusLabel->setText(text);
+    }
+}
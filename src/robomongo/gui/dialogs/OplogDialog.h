@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QDialog>
+#include <QElapsedTimer>
+#include <mongo/bson/bsonobj.h>
+#include <mongo/bson/timestamp.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QCheckBox;
+class QDateTimeEdit;
+class QLabel;
+class QLineEdit;
+class QPushButton;
+class QTableView;
+class QTimer;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class OplogEntriesEvent;
+    class OplogModel;
+    class TailOplogResponse;
+
+    /**
+     * @brief Live oplog of replica set, tailed with awaitData cursor in MongoServer's own
+     *        oplog worker and filtered by server (see OplogTail). Entries are kept in a ring
+     *        buffer of MaxEntries and are applied to the view in bulk every RepaintIntervalMs,
+     *        so that view keeps up with high rates. Tail can be paused and restarted from timestamp.
+     */
+    class OplogDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        OplogDialog(MongoServer *server, QWidget *parent = 0);
+        ~OplogDialog();
+
+    public Q_SLOTS:
+        void handle(OplogEntriesEvent *event);
+        void handle(TailOplogResponse *event);
+
+    private Q_SLOTS:
+        void applyPending();
+        void applyFilter();
+        void togglePause(bool paused);
+        void seek();
+
+    private:
+        static const int MaxEntries = 100000;
+        static const int RepaintIntervalMs = 100;
+
+        // Cancels current tail and opens new one from 'from', newest entry if it is null
+        void startTail(mongo::Timestamp from, bool afterFrom);
+        void stopTail();
+        void updateStatus();
+
+        MongoServer *const _server;
+        int _tailId;
+        std::shared_ptr<std::atomic<bool>> _cancelled;     // of current tail, null if stopped
+
+        QLineEdit *_namespace;
+        std::vector<std::pair<QCheckBox *, std::string>> _operations;
+        QDateTimeEdit *_from;
+        QPushButton *_seekButton;
+        QPushButton *_pauseButton;
+        QCheckBox *_follow;
+        QTableView *_view;
+        QLabel *_statusLabel;
+        QTimer *_timer;
+
+        OplogModel *_model;
+        std::vector<mongo::BSONObj> _pending;   // received since last repaint
+        mongo::Timestamp _lastTs;               // of the newest received entry
+        long long _received;
+        long long _receivedSinceStatus;
+        QElapsedTimer _rateTimer;
+        QString _error;
+    };
+}
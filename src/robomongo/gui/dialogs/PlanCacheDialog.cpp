@@ -0,0 +1,265 @@
+#include "robomongo/gui/dialogs/PlanCacheDialog.h"
+
+#include <QCheckBox>
+#include <QDateTime>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSet>
+#include <QSpinBox>
+#include <QSplitter>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/PlanCache.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            ShapeColumn, PlanColumn, WorksColumn, ActiveColumn, CreatedColumn, HostColumn, EngineColumn,
+            ColumnCount
+        };
+
+        QString timeText(long long ms)
+        {
+            return ms > 0 ? QDateTime::fromMSecsSinceEpoch(ms).toString("yyyy-MM-dd hh:mm:ss") : QString();
+        }
+
+        // Entries with flipped plan stay marked until dialog is closed
+        void markFlipped(QTreeWidgetItem *item, const QString &toolTip)
+        {
+            QFont font = item->font(PlanColumn);
+            font.setBold(true);
+            for (int column = 0; column < ColumnCount; ++column) {
+                item->setFont(column, font);
+                item->setForeground(column, Qt::darkRed);
+            }
+            item->setToolTip(PlanColumn, toolTip);
+        }
+    }
+
+    PlanCacheDialog::PlanCacheDialog(MongoServer *server, const QString &dbName, const QString &collection,
+                                     QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _collection(collection),
+        _cacheId(0),
+        _hasSnapshot(false)
+    {
+        setWindowTitle("Plan Cache of " + dbName + "." + collection);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(1100, 650);
+
+        AppRegistry::instance().bus()->subscribe(this, PlanCacheResponse::Type, server);
+
+        _autoRefresh = new QCheckBox("Refresh every");
+        _autoRefresh->setChecked(true);
+        _interval = new QSpinBox;
+        _interval->setRange(1, 3600);
+        _interval->setValue(10);
+        _interval->setSuffix(" s");
+        _refreshButton = new QPushButton("Refresh");
+
+        _timer = new QTimer(this);
+        VERIFY(connect(_timer, SIGNAL(timeout()), this, SLOT(refresh())));
+
+        auto refreshLayout = new QHBoxLayout;
+        refreshLayout->addWidget(_autoRefresh);
+        refreshLayout->addWidget(_interval);
+        refreshLayout->addStretch(1);
+        refreshLayout->addWidget(_refreshButton);
+
+        _tree = new QTreeWidget;
+        _tree->setColumnCount(ColumnCount);
+        _tree->setHeaderLabels(QStringList() << "Query shape" << "Cached plan" << "Works" << "Active"
+                                             << "Created" << "Host" << "Engine");
+        _tree->setUniformRowHeights(true);
+        _tree->header()->setStretchLastSection(false);
+        _tree->header()->resizeSection(ShapeColumn, 380);
+        _tree->header()->resizeSection(PlanColumn, 320);
+
+        _changes = new QPlainTextEdit;
+        _changes->setReadOnly(true);
+        _changes->setPlaceholderText("Changes of plan cache since the dialog was opened");
+
+        auto splitter = new QSplitter(Qt::Vertical);
+        splitter->addWidget(_tree);
+        splitter->addWidget(_changes);
+        splitter->setStretchFactor(0, 4);
+        splitter->setStretchFactor(1, 1);
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_refreshButton, SIGNAL(clicked()), this, SLOT(refresh())));
+        VERIFY(connect(_autoRefresh, SIGNAL(toggled(bool)), this, SLOT(autoRefreshChanged())));
+        VERIFY(connect(_interval, SIGNAL(valueChanged(int)), this, SLOT(autoRefreshChanged())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(refreshLayout);
+        layout->addWidget(splitter, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        autoRefreshChanged();
+        refresh();
+    }
+
+    void PlanCacheDialog::refresh()
+    {
+        // Slow server is not asked again before it answers
+        if (_cacheId)
+            return;
+
+        static int lastCacheId = 0;
+        _cacheId = ++lastCacheId;
+        _refreshButton->setEnabled(false);
+        _server->planCacheStats(_cacheId, MongoNamespace(QtUtils::toStdString(_dbName),
+                                                         QtUtils::toStdString(_collection)), MaxEntries);
+    }
+
+    void PlanCacheDialog::autoRefreshChanged()
+    {
+        _interval->setEnabled(_autoRefresh->isChecked());
+        if (_autoRefresh->isChecked())
+            _timer->start(_interval->value() * 1000);
+        else
+            _timer->stop();
+    }
+
+    void PlanCacheDialog::handle(PlanCacheResponse *event)
+    {
+        if (event->cacheId != _cacheId)
+            return;
+
+        _cacheId = 0;
+        _refreshButton->setEnabled(true);
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        if (_hasSnapshot)
+            logChanges(event->entries);
+        _entries = event->entries;
+        _hasSnapshot = true;
+        updateTree();
+
+        QString text = QString("%1 shapes, %2 entries").arg(_shapeItems.size()).arg(_entries.size());
+        if (_entries.size() >= MaxEntries)
+            text += QString(" (only the first %1)").arg(MaxEntries);
+        text += QString(", read at %1 in %2 ms.")
+            .arg(QDateTime::currentDateTime().toString("hh:mm:ss")).arg(event->elapsedMs);
+        _statusLabel->setText(text);
+    }
+
+    void PlanCacheDialog::logChanges(const std::vector<PlanCacheEntryInfo> &current)
+    {
+        QString const now = QDateTime::currentDateTime().toString("hh:mm:ss");
+        for (PlanCache::Change const &change : PlanCache::diff(_entries, current)) {
+            QString const key = QtUtils::toQString(change.key);
+            QString const oldPlan = QtUtils::toQString(change.oldPlan);
+            QString const newPlan = QtUtils::toQString(change.newPlan);
+            QString line;
+            switch (change.kind) {
+            case PlanCache::Change::Added: line = "added: " + newPlan; break;
+            case PlanCache::Change::Removed: line = "evicted: " + oldPlan; break;
+            case PlanCache::Change::PlanChanged: line = "PLAN CHANGED: " + oldPlan + " -> " + newPlan; break;
+            case PlanCache::Change::Replanned: line = "replanned, same plan: " + newPlan; break;
+            case PlanCache::Change::Activated: line = "activated"; break;
+            case PlanCache::Change::Deactivated: line = "deactivated"; break;
+            }
+            _changes->appendPlainText(QString("%1  %2  %3").arg(now, key, line));
+
+            // Item is updated by updateTree(), its mark stays
+            if (change.kind == PlanCache::Change::PlanChanged) {
+                QString const toolTip = QString("Plan changed at %1 from %2").arg(now, oldPlan);
+                if (QTreeWidgetItem *item = _entryItems.value(key)) {
+                    markFlipped(item, toolTip);
+                    if (item->parent())
+                        markFlipped(item->parent(), toolTip);
+                }
+            }
+        }
+    }
+
+    void PlanCacheDialog::updateTree()
+    {
+        QSet<QString> seenShapes, seenEntries;
+        for (PlanCache::ShapeGroup const &group : PlanCache::groupByShape(_entries)) {
+            QString const shapeKey = QtUtils::toQString(group.queryHash.empty() ? group.shape : group.queryHash);
+            seenShapes.insert(shapeKey);
+
+            QTreeWidgetItem *&shapeItem = _shapeItems[shapeKey];
+            if (!shapeItem)
+                shapeItem = new QTreeWidgetItem(_tree);
+
+            QString shape = QtUtils::toQString(group.shape);
+            if (!group.queryHash.empty())
+                shape = shape.isEmpty() ? "queryHash " + shapeKey : shape + "  (" + shapeKey + ")";
+            shapeItem->setText(ShapeColumn, shape);
+            shapeItem->setToolTip(ShapeColumn, shape);
+            shapeItem->setText(PlanColumn, group.plans > 1 ? QString("%1 different plans").arg(group.plans)
+                : QtUtils::toQString(_entries[group.entries.front()]._planSummary));
+            shapeItem->setText(ActiveColumn, QString("%1 of %2").arg(group.active).arg(group.entries.size()));
+
+            for (size_t index : group.entries) {
+                PlanCacheEntryInfo const &entry = _entries[index];
+                QString const entryKey = QtUtils::toQString(PlanCache::entryKey(entry));
+                seenEntries.insert(entryKey);
+
+                QTreeWidgetItem *&item = _entryItems[entryKey];
+                if (!item)
+                    item = new QTreeWidgetItem(shapeItem);
+
+                item->setText(ShapeColumn, "planCacheKey " + QtUtils::toQString(entry._planCacheKey));
+                item->setText(PlanColumn, QtUtils::toQString(entry._planSummary));
+                if (!item->font(PlanColumn).bold())
+                    item->setToolTip(PlanColumn, item->text(PlanColumn));
+                item->setText(WorksColumn, entry._works < 0 ? QString() : QString::number(entry._works));
+                item->setTextAlignment(WorksColumn, Qt::AlignRight | Qt::AlignVCenter);
+                item->setText(ActiveColumn, QString(entry._isActive ? "yes" : "no") + (entry._isPinned ? ", pinned" : ""));
+                item->setText(CreatedColumn, timeText(entry._createdMs));
+                item->setText(HostColumn, QtUtils::toQString(entry._host));
+                item->setText(EngineColumn, QtUtils::toQString(entry._engine));
+            }
+        }
+
+        // Evicted entries and shapes without entries
+        for (auto it = _entryItems.begin(); it != _entryItems.end();) {
+            if (seenEntries.contains(it.key())) {
+                ++it;
+                continue;
+            }
+            delete it.value();
+            it = _entryItems.erase(it);
+        }
+        for (auto it = _shapeItems.begin(); it != _shapeItems.end();) {
+            if (seenShapes.contains(it.key())) {
+                ++it;
+                continue;
+            }
+            delete it.value();
+            it = _shapeItems.erase(it);
+        }
+    }
+}
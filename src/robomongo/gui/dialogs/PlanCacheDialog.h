@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QDialog>
+#include <QHash>
+#include <vector>
+
+#include "robomongo/core/events/MongoEventsInfo.h"
+
+QT_BEGIN_NAMESPACE
+class QCheckBox;
+class QLabel;
+class QPlainTextEdit;
+class QPushButton;
+class QSpinBox;
+class QTimer;
+class QTreeWidget;
+class QTreeWidgetItem;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class PlanCacheResponse;
+
+    /**
+     * @brief Plan cache of collection grouped by query shape (see PlanCache): cached plan,
+     *        works and state of every entry. Tree is updated in place on every refresh and
+     *        entries whose cached plan changed since the dialog opened are highlighted and
+     *        logged, so that plan flips are caught while they happen.
+     */
+    class PlanCacheDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        PlanCacheDialog(MongoServer *server, const QString &dbName, const QString &collection,
+                        QWidget *parent = 0);
+
+    public Q_SLOTS:
+        void handle(PlanCacheResponse *event);
+
+    private Q_SLOTS:
+        void refresh();
+        void autoRefreshChanged();
+
+    private:
+        static const int MaxEntries = 5000;
+
+        void updateTree();
+        void logChanges(const std::vector<PlanCacheEntryInfo> &current);
+
+        MongoServer *const _server;
+        QString const _dbName;
+        QString const _collection;
+        int _cacheId;                           // 0, if plan cache is not being read
+        bool _hasSnapshot;
+        std::vector<PlanCacheEntryInfo> _entries;
+
+        QHash<QString, QTreeWidgetItem *> _shapeItems;     // by queryHash or shape
+        QHash<QString, QTreeWidgetItem *> _entryItems;     // by PlanCache::entryKey()
+
+        QCheckBox *_autoRefresh;
+        QSpinBox *_interval;
+        QPushButton *_refreshButton;
+        QTimer *_timer;
+        QTreeWidget *_tree;
+        QPlainTextEdit *_changes;
+        QLabel *_statusLabel;
+    };
+}
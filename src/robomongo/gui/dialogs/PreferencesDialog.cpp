@@ -7,10 +7,12 @@
 #include <QComboBox>
 #include <QPushButton>
 #include <QCheckBox>
+#include <QSpinBox>
 
 #include "robomongo/gui/GuiRegistry.h"
 #include "robomongo/gui/AppStyle.h"
 #include "robomongo/gui/utils/ComboBoxUtils.h"
+#include "robomongo/gui/widgets/workarea/ResultMemoryManager.h"
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/settings/SettingsManager.h"
@@ -81,6 +83,53 @@ namespace Robomongo
         stylesLayout->addWidget(_stylesComboBox);
         layout->addLayout(stylesLayout);   
 
+        QHBoxLayout *resultMemoryBudgetLayout = new QHBoxLayout(this);
+        QLabel *resultMemoryBudgetLabel = new QLabel("Memory limit of shell result (MB):");
+        resultMemoryBudgetLabel->setToolTip("Documents past this limit are moved to temporary file. "
+                                            "0 means no limit. Applied to new connections.");
+        resultMemoryBudgetLayout->addWidget(resultMemoryBudgetLabel);
+        _resultMemoryBudgetSpinBox = new QSpinBox();
+        _resultMemoryBudgetSpinBox->setRange(0, 1024 * 1024);
+        _resultMemoryBudgetSpinBox->setSpecialValueText("No limit");
+        resultMemoryBudgetLayout->addWidget(_resultMemoryBudgetSpinBox);
+        layout->addLayout(resultMemoryBudgetLayout);
+
+        QHBoxLayout *jsHeapLimitLayout = new QHBoxLayout(this);
+        QLabel *jsHeapLimitLabel = new QLabel("JavaScript heap limit of shell (MB):");
+        jsHeapLimitLabel->setToolTip(QString("Statement which allocates more JavaScript memory fails and shell "
+                                             "is started again. At least %1 MB. Applied to new connections.")
+                                     .arg(SettingsManager::MinJsHeapLimitMb));
+        jsHeapLimitLayout->addWidget(jsHeapLimitLabel);
+        _jsHeapLimitSpinBox = new QSpinBox();
+        _jsHeapLimitSpinBox->setRange(0, 64 * 1024);
+        _jsHeapLimitSpinBox->setSpecialValueText("Default");
+        jsHeapLimitLayout->addWidget(_jsHeapLimitSpinBox);
+        layout->addLayout(jsHeapLimitLayout);
+
+        QHBoxLayout *adaptiveBatchLayout = new QHBoxLayout(this);
+        QLabel *adaptiveBatchLabel = new QLabel("Adaptive batch size, bytes per batch (KB):");
+        adaptiveBatchLabel->setToolTip("Batches of find and getMore are sized to about this many bytes, "
+                                       "after average document size and round trip of the collection. "
+                                       "Number of documents per page is not changed.");
+        adaptiveBatchLayout->addWidget(adaptiveBatchLabel);
+        _adaptiveBatchSpinBox = new QSpinBox();
+        _adaptiveBatchSpinBox->setRange(0, 16 * 1024);
+        _adaptiveBatchSpinBox->setSpecialValueText("Off");
+        adaptiveBatchLayout->addWidget(_adaptiveBatchSpinBox);
+        layout->addLayout(adaptiveBatchLayout);
+
+        QHBoxLayout *resultsMemoryBudgetLayout = new QHBoxLayout(this);
+        QLabel *resultsMemoryBudgetLabel = new QLabel("Memory limit of results of all tabs (MB):");
+        resultsMemoryBudgetLabel->setToolTip("Past this limit, views and then documents of results "
+                                             "not shown are released. Released query results are "
+                                             "read again when shown. 0 means no limit.");
+        resultsMemoryBudgetLayout->addWidget(resultsMemoryBudgetLabel);
+        _resultsMemoryBudgetSpinBox = new QSpinBox();
+        _resultsMemoryBudgetSpinBox->setRange(0, 1024 * 1024);
+        _resultsMemoryBudgetSpinBox->setSpecialValueText("No limit");
+        resultsMemoryBudgetLayout->addWidget(_resultsMemoryBudgetSpinBox);
+        layout->addLayout(resultsMemoryBudgetLayout);
+
         QDialogButtonBox *buttonBox = new QDialogButtonBox(this);
         buttonBox->setOrientation(Qt::Horizontal);
         buttonBox->setStandardButtons(QDialogButtonBox::Cancel | QDialogButtonBox::Save);
@@ -101,6 +150,10 @@ namespace Robomongo
         _loadMongoRcJsCheckBox->setChecked(AppRegistry::instance().settingsManager()->loadMongoRcJs());
         _disabelConnectionShortcutsCheckBox->setChecked(AppRegistry::instance().settingsManager()->disableConnectionShortcuts());
         utils::setCurrentText(_stylesComboBox, Robomongo::AppRegistry::instance().settingsManager()->currentStyle());
+        _resultMemoryBudgetSpinBox->setValue(AppRegistry::instance().settingsManager()->shellResultMemoryBudgetMb());
+        _jsHeapLimitSpinBox->setValue(AppRegistry::instance().settingsManager()->jsHeapLimitMb());
+        _adaptiveBatchSpinBox->setValue(AppRegistry::instance().settingsManager()->adaptiveBatchKb());
+        _resultsMemoryBudgetSpinBox->setValue(AppRegistry::instance().settingsManager()->resultsMemoryBudgetMb());
     }
 
     void PreferencesDialog::accept()
@@ -118,6 +171,11 @@ namespace Robomongo
         AppRegistry::instance().settingsManager()->setDisableConnectionShortcuts(_disabelConnectionShortcutsCheckBox->isChecked());
         Robomongo::AppRegistry::instance().settingsManager()->setCurrentStyle(_stylesComboBox->currentText());
         AppStyleUtils::applyStyle(_stylesComboBox->currentText());
+        AppRegistry::instance().settingsManager()->setShellResultMemoryBudgetMb(_resultMemoryBudgetSpinBox->value());
+        AppRegistry::instance().settingsManager()->setJsHeapLimitMb(_jsHeapLimitSpinBox->value());
+        AppRegistry::instance().settingsManager()->setAdaptiveBatchKb(_adaptiveBatchSpinBox->value());
+        AppRegistry::instance().settingsManager()->setResultsMemoryBudgetMb(_resultsMemoryBudgetSpinBox->value());
+        ResultMemoryManager::instance().enforceBudgetLater();
         Robomongo::AppRegistry::instance().settingsManager()->save();
 
         return BaseClass::accept();
@@ -4,6 +4,7 @@
 QT_BEGIN_NAMESPACE
 class QComboBox;
 class QCheckBox;
+class QSpinBox;
 QT_END_NAMESPACE
 
 namespace Robomongo
@@ -27,5 +28,9 @@ namespace Robomongo
         QCheckBox *_loadMongoRcJsCheckBox;
         QCheckBox *_disabelConnectionShortcutsCheckBox;
         QComboBox *_stylesComboBox;
+        QSpinBox *_resultMemoryBudgetSpinBox;
+        QSpinBox *_jsHeapLimitSpinBox;
+        QSpinBox *_adaptiveBatchSpinBox;
+        QSpinBox *_resultsMemoryBudgetSpinBox;
     };
 }
@@ -0,0 +1,201 @@
+#include "robomongo/gui/dialogs/ProfilerDialog.h"
+
+#include <algorithm>
+#include <QDateTime>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/ProfileSummary.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            NamespaceColumn, OpColumn, CommandColumn, ShapeColumn, PlanColumn, CountColumn, 
+            TotalColumn, MaxColumn, P50Column, P95Column, ExaminedRatioColumn, KeysColumn, 
+            LastSeenColumn, ColumnCount
+        };
+
+        // Percentile is upper bound of bucket, so it is shown as "<= N"
+        QString percentileText(double ms)
+        {
+            return ms < 0 ? QString("> %1").arg(ProfileSummary::UpperBoundsMs.back()) 
+                          : QString("<= %1").arg(ms);
+        }
+
+        // Items sort by numbers stored in UserRole, not by display text
+        class ShapeItem : public QTreeWidgetItem
+        {
+        public:
+            explicit ShapeItem(QTreeWidget *parent) : QTreeWidgetItem(parent) {}
+
+            bool operator<(const QTreeWidgetItem &other) const override
+            {
+                int const column = treeWidget()->sortColumn();
+                QVariant const left = data(column, Qt::UserRole);
+                if (!left.isValid())
+                    return QTreeWidgetItem::operator<(other);
+                return left.toDouble() < other.data(column, Qt::UserRole).toDouble();
+            }
+
+            void setNumber(int column, const QString &text, double number)
+            {
+                setText(column, text);
+                setData(column, Qt::UserRole, number);
+                setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+            }
+        };
+    }
+
+    ProfilerDialog::ProfilerDialog(MongoServer *server, const QString &dbName, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _summaryId(0)
+    {
+        setWindowTitle("Profiler of " + dbName);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(1100, 550);
+
+        AppRegistry::instance().bus()->subscribe(this, ProfileSummaryResponse::Type, server);
+
+        _lastMinutes = new QSpinBox;
+        _lastMinutes->setRange(0, 7 * 24 * 60);
+        _lastMinutes->setValue(60);
+        _lastMinutes->setSuffix(" min");
+        _lastMinutes->setSpecialValueText("All");
+
+        _minMillis = new QSpinBox;
+        _minMillis->setRange(0, 24 * 60 * 60 * 1000);
+        _minMillis->setSuffix(" ms");
+
+        _refreshButton = new QPushButton("Refresh");
+
+        auto filterLayout = new QHBoxLayout;
+        filterLayout->addWidget(new QLabel("Last:"));
+        filterLayout->addWidget(_lastMinutes);
+        filterLayout->addWidget(new QLabel("Slower than:"));
+        filterLayout->addWidget(_minMillis);
+        filterLayout->addStretch(1);
+        filterLayout->addWidget(_refreshButton);
+
+        _tree = new QTreeWidget;
+        _tree->setColumnCount(ColumnCount);
+        _tree->setHeaderLabels(QStringList() << "Namespace" << "Op" << "Command" << "Shape" << "Plan" 
+                                             << "Count" << "Total ms" << "Max ms" << "p50 ms" << "p95 ms" 
+                                             << "Examined / returned" << "Keys examined" << "Last seen");
+        _tree->setRootIsDecorated(false);
+        _tree->setUniformRowHeights(true);
+        _tree->setSortingEnabled(true);
+        _tree->header()->setStretchLastSection(false);
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_refreshButton, SIGNAL(clicked()), this, SLOT(refresh())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(filterLayout);
+        layout->addWidget(_tree, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        refresh();
+    }
+
+    void ProfilerDialog::handle(ProfileSummaryResponse *event)
+    {
+        if (event->summaryId != _summaryId)
+            return;
+
+        _summaryId = 0;
+        _refreshButton->setEnabled(true);
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        _tree->setSortingEnabled(false);
+        _tree->clear();
+
+        long long operations = 0;
+        for (ProfileShapeInfo const &shape : event->shapes) {
+            auto item = new ShapeItem(_tree);
+            item->setText(NamespaceColumn, QtUtils::toQString(shape._ns));
+            item->setText(OpColumn, QtUtils::toQString(shape._op));
+            item->setText(CommandColumn, QtUtils::toQString(shape._command));
+            item->setText(ShapeColumn, QtUtils::toQString(shape._shape));
+            item->setText(PlanColumn, QtUtils::toQString(shape._planSummary));
+            item->setToolTip(PlanColumn, item->text(PlanColumn));
+
+            item->setNumber(CountColumn, QString::number(shape._count), shape._count);
+            item->setNumber(TotalColumn, QString::number(shape._totalMillis), shape._totalMillis);
+            item->setNumber(MaxColumn, QString::number(shape._maxMillis), shape._maxMillis);
+            item->setNumber(P50Column, percentileText(shape._p50Ms), 
+                            shape._p50Ms < 0 ? 1e18 : shape._p50Ms);
+            item->setNumber(P95Column, percentileText(shape._p95Ms), 
+                            shape._p95Ms < 0 ? 1e18 : shape._p95Ms);
+
+            // Many documents examined per returned one means missing or poor index
+            double const ratio = static_cast<double>(shape._docsExamined) / std::max(shape._nreturned, 1LL);
+            item->setNumber(ExaminedRatioColumn, QString::number(ratio, 'f', 1), ratio);
+            item->setNumber(KeysColumn, QString::number(shape._keysExamined), shape._keysExamined);
+
+            QDateTime const lastSeen = QDateTime::fromMSecsSinceEpoch(shape._lastSeenMs);
+            item->setText(LastSeenColumn, lastSeen.toString("yyyy-MM-dd hh:mm:ss"));
+            item->setData(LastSeenColumn, Qt::UserRole, static_cast<double>(shape._lastSeenMs));
+
+            operations += shape._count;
+        }
+
+        _tree->setSortingEnabled(true);
+        _tree->sortByColumn(TotalColumn, Qt::DescendingOrder);
+        for (int column = 0; column < ColumnCount; ++column)
+            _tree->resizeColumnToContents(column);
+
+        QString text;
+        if (event->profilingLevel == 0)
+            text = "Profiling is off for this database, slow operations are collected after "
+                   "db.setProfilingLevel(1). ";
+        else if (event->profilingLevel > 0)
+            text = QString("Profiling level %1, slow operations take more than %2 ms. ")
+                .arg(event->profilingLevel).arg(event->slowMs);
+
+        text += QString("%1 shapes of %2 operations").arg(event->shapes.size()).arg(operations);
+        if (event->shapes.size() >= MaxShapes)
+            text += QString(" (only %1 shapes with the largest total time)").arg(MaxShapes);
+        text += QString(", read in %1 ms.").arg(event->elapsedMs);
+        _statusLabel->setText(text);
+    }
+
+    void ProfilerDialog::refresh()
+    {
+        static int lastSummaryId = 0;
+        _summaryId = ++lastSummaryId;
+        _refreshButton->setEnabled(false);
+        _statusLabel->setText("Reading system.profile...");
+
+        long long const sinceMs = _lastMinutes->value() > 0 
+            ? QDateTime::currentMSecsSinceEpoch() - _lastMinutes->value() * 60LL * 1000LL : 0;
+        _server->profileSummary(_summaryId, QtUtils::toStdString(_dbName), sinceMs, _minMillis->value(), MaxShapes);
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QDialog>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QPushButton;
+class QSpinBox;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class ProfileSummaryResponse;
+
+    /**
+     * @brief Slow operations of database from system.profile, grouped by query shape on server
+     *        (see ProfileSummary): count, total/max time, p50/p95 and documents examined per
+     *        returned one, so that hot paths are found without paging through raw entries.
+     */
+    class ProfilerDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        ProfilerDialog(MongoServer *server, const QString &dbName, QWidget *parent = 0);
+
+    public Q_SLOTS:
+        void handle(ProfileSummaryResponse *event);
+
+    private Q_SLOTS:
+        void refresh();
+
+    private:
+        static const int MaxShapes = 500;
+
+        MongoServer *const _server;
+        QString const _dbName;
+        int _summaryId;             // 0, if no summary is being read
+
+        QSpinBox *_lastMinutes;
+        QSpinBox *_minMillis;
+        QPushButton *_refreshButton;
+        QTreeWidget *_tree;
+        QLabel *_statusLabel;
+    };
+}
@@ -0,0 +1,220 @@
+#include "robomongo/gui/dialogs/QueryHistoryDialog.h"
+
+#include <atomic>
+#include <QDateTime>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSplitter>
+#include <QThread>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/domain/App.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/QueryHistory.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column { ExecutedColumn, DatabaseColumn, ScriptColumn, DurationColumn, ResultsColumn, ServerColumn };
+
+        // The first line of script, so that every run takes one row
+        QString scriptLine(const std::string &script)
+        {
+            QString const text = QtUtils::toQString(script).trimmed();
+            int const lineEnd = text.indexOf('\n');
+            return lineEnd < 0 ? text : text.left(lineEnd) + " ...";
+        }
+    }
+
+    // Reads both segments of history and builds index, dialog takes it once thread is finished
+    class QueryHistoryDialog::LoadThread : public QThread
+    {
+    public:
+        explicit LoadThread(const QString &connection) :
+            _connection(connection), _index(new QueryHistoryIndex), _stop(false) {}
+
+        void stop() { _stop = true; }
+        std::unique_ptr<QueryHistoryIndex> takeIndex() { return std::move(_index); }
+
+    protected:
+        void run() override
+        {
+            for (QueryHistoryEntry &entry : QueryHistory::load(_connection)) {
+                if (_stop)
+                    return;
+                _index->add(std::move(entry));
+            }
+        }
+
+    private:
+        QString const _connection;
+        std::unique_ptr<QueryHistoryIndex> _index;
+        std::atomic<bool> _stop;
+    };
+
+    QueryHistoryDialog::QueryHistoryDialog(MongoServer *server, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _loadThread(nullptr)
+    {
+        setWindowTitle("Query History of " + QtUtils::toQString(server->connectionRecord()->getReadableName()));
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(900, 560);
+
+        _searchEdit = new QLineEdit;
+        _searchEdit->setPlaceholderText("Search scripts, e.g. orders aggregate");
+        _searchEdit->setEnabled(false);
+
+        _list = new QTreeWidget;
+        _list->setRootIsDecorated(false);
+        _list->setUniformRowHeights(true);
+        _list->setHeaderLabels(QStringList() << "Executed" << "Database" << "Script" << "Duration"
+                                             << "Results" << "Server time");
+        _list->header()->setSectionResizeMode(ScriptColumn, QHeaderView::Stretch);
+        _list->header()->setStretchLastSection(false);
+
+        _scriptView = new QPlainTextEdit;
+        _scriptView->setReadOnly(true);
+
+        auto splitter = new QSplitter(Qt::Vertical);
+        splitter->addWidget(_list);
+        splitter->addWidget(_scriptView);
+        splitter->setStretchFactor(0, 3);
+        splitter->setStretchFactor(1, 1);
+
+        _openButton = new QPushButton("Open in Shell");
+        _openButton->setToolTip("Open script in new shell of its database, without executing it");
+        _replayButton = new QPushButton("Replay");
+        _replayButton->setToolTip("Execute script again in new shell of its database");
+        _openButton->setEnabled(false);
+        _replayButton->setEnabled(false);
+
+        _statusLabel = new QLabel("Loading history...");
+        _statusLabel->setWordWrap(true);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        buttonBox->addButton(_openButton, QDialogButtonBox::ActionRole);
+        buttonBox->addButton(_replayButton, QDialogButtonBox::ActionRole);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_openButton, SIGNAL(clicked()), this, SLOT(openInShell())));
+        VERIFY(connect(_replayButton, SIGNAL(clicked()), this, SLOT(replay())));
+        VERIFY(connect(_searchEdit, SIGNAL(textChanged(QString)), this, SLOT(search())));
+        VERIFY(connect(_list, SIGNAL(currentItemChanged(QTreeWidgetItem *, QTreeWidgetItem *)),
+                       this, SLOT(showScript())));
+        VERIFY(connect(_list, SIGNAL(itemDoubleClicked(QTreeWidgetItem *, int)), this, SLOT(openInShell())));
+
+        auto layout = new QVBoxLayout;
+        layout->addWidget(_searchEdit);
+        layout->addWidget(splitter, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        _loadThread = new LoadThread(server->connectionRecord()->uuid());
+        VERIFY(connect(_loadThread, SIGNAL(finished()), this, SLOT(loaded())));
+        _loadThread->start();
+    }
+
+    QueryHistoryDialog::~QueryHistoryDialog()
+    {
+        if (_loadThread) {
+            _loadThread->stop();
+            _loadThread->wait();
+            delete _loadThread;
+        }
+    }
+
+    void QueryHistoryDialog::loaded()
+    {
+        _index = _loadThread->takeIndex();
+        delete _loadThread;
+        _loadThread = nullptr;
+
+        _searchEdit->setEnabled(true);
+        _searchEdit->setFocus();
+        search();
+    }
+
+    void QueryHistoryDialog::search()
+    {
+        if (!_index)
+            return;
+
+        std::vector<size_t> const ids = _index->find(QtUtils::toStdString(_searchEdit->text()), MaxShown);
+
+        _list->setUpdatesEnabled(false);
+        _list->clear();
+        QList<QTreeWidgetItem *> items;
+        for (size_t id : ids) {
+            QueryHistoryEntry const &entry = _index->entry(id);
+            auto item = new QTreeWidgetItem;
+            item->setText(ExecutedColumn, QDateTime::fromSecsSinceEpoch(entry.executedAt).toString("yyyy-MM-dd HH:mm:ss"));
+            item->setText(DatabaseColumn, QtUtils::toQString(entry.database));
+            item->setText(ScriptColumn, scriptLine(entry.script));
+            item->setText(DurationColumn, QString("%1 ms").arg(entry.durationMs));
+            item->setText(ResultsColumn, entry.failed ? QString("Failed") : QString::number(entry.results));
+            item->setText(ServerColumn, entry.serverMs < 0 ? QString() : QString("%1 ms").arg(entry.serverMs));
+            item->setData(ExecutedColumn, Qt::UserRole, static_cast<qulonglong>(id));
+            items.append(item);
+        }
+        _list->addTopLevelItems(items);
+        _list->setUpdatesEnabled(true);
+
+        if (!items.isEmpty())
+            _list->setCurrentItem(items.first());
+        else
+            showScript();
+
+        QString status = QString("%1 of %2 runs").arg(ids.size()).arg(_index->size());
+        if (ids.size() == MaxShown)
+            status += QString(", only the newest %1 matching are shown").arg(MaxShown);
+        _statusLabel->setText(status + ".");
+    }
+
+    void QueryHistoryDialog::showScript()
+    {
+        QTreeWidgetItem *item = _list->currentItem();
+        _openButton->setEnabled(item != nullptr);
+        _replayButton->setEnabled(item != nullptr);
+        if (!item) {
+            _scriptView->clear();
+            return;
+        }
+
+        size_t const id = item->data(ExecutedColumn, Qt::UserRole).toULongLong();
+        _scriptView->setPlainText(QtUtils::toQString(_index->entry(id).script));
+    }
+
+    void QueryHistoryDialog::openInShell()
+    {
+        openSelected(false);
+    }
+
+    void QueryHistoryDialog::replay()
+    {
+        openSelected(true);
+    }
+
+    void QueryHistoryDialog::openSelected(bool execute)
+    {
+        QTreeWidgetItem *item = _list->currentItem();
+        if (!item || !_index)
+            return;
+
+        // Statements of replayed script are found in statementize() cache of ScriptEngine
+        QueryHistoryEntry const &entry = _index->entry(item->data(ExecutedColumn, Qt::UserRole).toULongLong());
+        QString const connName = QtUtils::toQString(_server->connectionRecord()->getReadableName());
+        AppRegistry::instance().app()->openShell(_server, QtUtils::toQString(entry.script), entry.database,
+                                                 execute, connName);
+    }
+}
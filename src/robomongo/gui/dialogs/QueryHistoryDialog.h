@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QDialog>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QLineEdit;
+class QPlainTextEdit;
+class QPushButton;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class QueryHistoryIndex;
+
+    /**
+     * @brief Scripts executed with connection of server (see QueryHistory), searched by words
+     *        as they are typed. History file is read and indexed in background thread. Script
+     *        can be opened or replayed in new shell of the database it was executed in.
+     */
+    class QueryHistoryDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        QueryHistoryDialog(MongoServer *server, QWidget *parent = 0);
+        ~QueryHistoryDialog();
+
+    private Q_SLOTS:
+        void loaded();
+        void search();
+        void showScript();
+        void openInShell();
+        void replay();
+
+    private:
+        static constexpr size_t MaxShown = 500;
+
+        class LoadThread;
+
+        void openSelected(bool execute);
+
+        MongoServer *const _server;
+        LoadThread *_loadThread;
+        std::unique_ptr<QueryHistoryIndex> _index;      // null, while history is loaded
+
+        QLineEdit *_searchEdit;
+        QTreeWidget *_list;
+        QPlainTextEdit *_scriptView;
+        QPushButton *_openButton;
+        QPushButton *_replayButton;
+        QLabel *_statusLabel;
+    };
+}
@@ -0,0 +1,285 @@
+#include "robomongo/gui/dialogs/QueryTemplatesDialog.h"
+
+#include <algorithm>
+#include <memory>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QMessageBox>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSplitter>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/domain/App.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/ScriptInfo.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/gui/GuiRegistry.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        const char *const NewTemplateScript =
+            "db.getCollection('collection').find({ _id: \"{{id:objectId}}\" })";
+    }
+
+    QueryTemplatesDialog::QueryTemplatesDialog(MongoServer *server, QWidget *parent) :
+        QDialog(parent),
+        _server(server)
+    {
+        setWindowTitle("Query Templates");
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(900, 560);
+
+        _list = new QListWidget;
+        auto addButton = new QPushButton("New");
+        _removeButton = new QPushButton("Delete");
+
+        auto listButtons = new QHBoxLayout;
+        listButtons->addWidget(addButton);
+        listButtons->addWidget(_removeButton);
+        listButtons->addStretch(1);
+
+        auto listLayout = new QVBoxLayout;
+        listLayout->setContentsMargins(0, 0, 0, 0);
+        listLayout->addWidget(_list, 1);
+        listLayout->addLayout(listButtons);
+        auto listWidget = new QWidget;
+        listWidget->setLayout(listLayout);
+
+        _nameEdit = new QLineEdit;
+        _databaseEdit = new QLineEdit;
+        _databaseEdit->setPlaceholderText(QtUtils::toQString(server->connectionRecord()->defaultDatabase()));
+        _scriptEdit = new QPlainTextEdit;
+        _scriptEdit->setFont(GuiRegistry::instance().font());
+        _scriptEdit->setToolTip("One find() or aggregate() with JSON arguments. Parameters are values "
+                                "\"{{name}}\" or \"{{name:type}}\", type is string, int, long, double, "
+                                "bool, objectId or date.");
+        _saveButton = new QPushButton("Save");
+
+        auto formLayout = new QFormLayout;
+        formLayout->addRow("Name:", _nameEdit);
+        formLayout->addRow("Database:", _databaseEdit);
+        formLayout->addRow("Query:", _scriptEdit);
+
+        auto saveLayout = new QHBoxLayout;
+        saveLayout->addStretch(1);
+        saveLayout->addWidget(_saveButton);
+
+        _parametersLayout = new QFormLayout;
+        auto parametersBox = new QGroupBox("Parameters");
+        parametersBox->setLayout(_parametersLayout);
+        _runButton = new QPushButton("Run");
+        _runButton->setDefault(true);
+
+        auto runLayout = new QHBoxLayout;
+        runLayout->addStretch(1);
+        runLayout->addWidget(_runButton);
+
+        auto editLayout = new QVBoxLayout;
+        editLayout->setContentsMargins(0, 0, 0, 0);
+        editLayout->addLayout(formLayout, 1);
+        editLayout->addLayout(saveLayout);
+        editLayout->addWidget(parametersBox);
+        editLayout->addLayout(runLayout);
+        auto editWidget = new QWidget;
+        editWidget->setLayout(editLayout);
+
+        auto splitter = new QSplitter(Qt::Horizontal);
+        splitter->addWidget(listWidget);
+        splitter->addWidget(editWidget);
+        splitter->setStretchFactor(0, 1);
+        splitter->setStretchFactor(1, 3);
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_list, SIGNAL(currentRowChanged(int)), this, SLOT(select())));
+        VERIFY(connect(addButton, SIGNAL(clicked()), this, SLOT(addTemplate())));
+        VERIFY(connect(_removeButton, SIGNAL(clicked()), this, SLOT(removeTemplate())));
+        VERIFY(connect(_saveButton, SIGNAL(clicked()), this, SLOT(saveTemplate())));
+        VERIFY(connect(_runButton, SIGNAL(clicked()), this, SLOT(run())));
+
+        auto layout = new QVBoxLayout;
+        layout->addWidget(splitter, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        // Every template is compiled once here, runs only bind values
+        for (auto const &saved : QueryTemplate::load())
+            _entries.push_back(compileEntry(saved));
+        fillList(0);
+    }
+
+    QueryTemplatesDialog::Entry QueryTemplatesDialog::compileEntry(const QueryTemplate::Template &saved)
+    {
+        Entry entry;
+        entry.saved = saved;
+        try {
+            entry.compiled = QueryTemplate::compile(saved.script);
+        } catch (const std::exception &ex) {
+            entry.error = QtUtils::toQString(ex.what());
+        }
+        return entry;
+    }
+
+    void QueryTemplatesDialog::fillList(int current)
+    {
+        _list->clear();
+        for (auto const &entry : _entries)
+            _list->addItem(QtUtils::toQString(entry.saved.name));
+        if (current >= 0 && current < _list->count())
+            _list->setCurrentRow(current);
+        else
+            select();
+    }
+
+    void QueryTemplatesDialog::select()
+    {
+        int const row = _list->currentRow();
+        bool const selected = row >= 0 && row < static_cast<int>(_entries.size());
+        _removeButton->setEnabled(selected);
+        if (!selected) {
+            _nameEdit->clear();
+            _databaseEdit->clear();
+            _scriptEdit->setPlainText(NewTemplateScript);
+        }
+        else {
+            Entry const &entry = _entries[row];
+            _nameEdit->setText(QtUtils::toQString(entry.saved.name));
+            _databaseEdit->setText(QtUtils::toQString(entry.saved.database));
+            _scriptEdit->setPlainText(QtUtils::toQString(entry.saved.script));
+            _statusLabel->setText(entry.error);
+        }
+        showParameters();
+    }
+
+    void QueryTemplatesDialog::showParameters()
+    {
+        while (_parametersLayout->rowCount() > 0)
+            _parametersLayout->removeRow(0);
+        _values.clear();
+
+        int const row = _list->currentRow();
+        bool const runnable = row >= 0 && row < static_cast<int>(_entries.size()) && _entries[row].error.isEmpty();
+        _runButton->setEnabled(runnable);
+        if (!runnable)
+            return;
+
+        for (auto const &parameter : _entries[row].compiled.parameters) {
+            auto edit = new QLineEdit;
+            edit->setPlaceholderText(QtUtils::toQString(QueryTemplate::typeName(parameter.type)));
+            VERIFY(connect(edit, SIGNAL(returnPressed()), this, SLOT(run())));
+            _parametersLayout->addRow(QtUtils::toQString(parameter.name) + ":", edit);
+            _values.push_back(edit);
+        }
+        if (_values.empty())
+            _parametersLayout->addRow(new QLabel("Template has no parameters."));
+    }
+
+    void QueryTemplatesDialog::addTemplate()
+    {
+        _list->setCurrentRow(-1);
+        _nameEdit->setFocus();
+        _statusLabel->clear();
+    }
+
+    void QueryTemplatesDialog::saveTemplate()
+    {
+        QueryTemplate::Template saved;
+        saved.name = QtUtils::toStdString(_nameEdit->text().trimmed());
+        saved.database = QtUtils::toStdString(_databaseEdit->text().trimmed());
+        saved.script = QtUtils::toStdString(_scriptEdit->toPlainText().trimmed());
+        if (saved.name.empty()) {
+            _statusLabel->setText("Template needs a name.");
+            return;
+        }
+
+        // Template, which cannot be compiled, is not saved
+        Entry const entry = compileEntry(saved);
+        if (!entry.error.isEmpty()) {
+            _statusLabel->setText(entry.error);
+            return;
+        }
+
+        int row = _list->currentRow();
+        if (row >= 0 && row < static_cast<int>(_entries.size())) {
+            _entries[row] = entry;
+        }
+        else {
+            _entries.push_back(entry);
+            row = static_cast<int>(_entries.size()) - 1;
+        }
+        store();
+        fillList(row);
+        _statusLabel->setText(QString("Saved with %1 parameters.").arg(entry.compiled.parameters.size()));
+    }
+
+    void QueryTemplatesDialog::removeTemplate()
+    {
+        int const row = _list->currentRow();
+        if (row < 0 || row >= static_cast<int>(_entries.size()))
+            return;
+
+        QString const name = QtUtils::toQString(_entries[row].saved.name);
+        if (QMessageBox::question(this, "Delete Template", "Delete template " + name + "?",
+                                  QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes)
+            return;
+
+        _entries.erase(_entries.begin() + row);
+        store();
+        fillList(std::min(row, static_cast<int>(_entries.size()) - 1));
+    }
+
+    void QueryTemplatesDialog::run()
+    {
+        int const row = _list->currentRow();
+        if (row < 0 || row >= static_cast<int>(_entries.size()) || !_entries[row].error.isEmpty())
+            return;
+
+        Entry const &entry = _entries[row];
+        std::map<std::string, std::string> values;
+        for (size_t i = 0; i < _values.size(); ++i)
+            values[entry.compiled.parameters[i].name] = QtUtils::toStdString(_values[i]->text().trimmed());
+
+        NativeQuery bound;
+        try {
+            bound = QueryTemplate::bind(entry.compiled, values);
+        } catch (const std::exception &ex) {
+            _statusLabel->setText(QtUtils::toQString(ex.what()));
+            return;
+        }
+
+        // Shell shows script of bound query, worker runs the bound query itself
+        ConnectionSettings *connection = _server->connectionRecord();
+        std::string const database = entry.saved.database.empty() ? connection->defaultDatabase()
+                                                                   : entry.saved.database;
+        connection->setDefaultDatabase(database);
+        ScriptInfo info(QtUtils::toQString(QueryTemplate::scriptOf(bound)), true, database, CursorPosition(),
+                        QtUtils::toQString(entry.saved.name));
+        info.setNativeQuery(std::make_shared<NativeQuery>(bound));
+        AppRegistry::instance().app()->openShell(_server, connection, info);
+        _statusLabel->clear();
+    }
+
+    void QueryTemplatesDialog::store()
+    {
+        std::vector<QueryTemplate::Template> templates;
+        for (auto const &entry : _entries)
+            templates.push_back(entry.saved);
+        QueryTemplate::save(templates);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QDialog>
+#include <vector>
+
+#include "robomongo/core/domain/QueryTemplate.h"
+
+QT_BEGIN_NAMESPACE
+class QFormLayout;
+class QLabel;
+class QLineEdit;
+class QListWidget;
+class QPlainTextEdit;
+class QPushButton;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+
+    /**
+     * @brief Saved query templates (see QueryTemplate). Template is compiled when it is saved
+     *        or loaded, its parameters get typed inputs, and Run opens new shell with the bound
+     *        query, which worker runs with driver connection without parsing its script.
+     */
+    class QueryTemplatesDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        QueryTemplatesDialog(MongoServer *server, QWidget *parent = 0);
+
+    private Q_SLOTS:
+        void select();
+        void addTemplate();
+        void saveTemplate();
+        void removeTemplate();
+        void run();
+
+    private:
+        struct Entry
+        {
+            QueryTemplate::Template saved;
+            QueryTemplate::Compiled compiled;
+            QString error;              // of compilation, template cannot run if set
+        };
+
+        static Entry compileEntry(const QueryTemplate::Template &saved);
+        void fillList(int current);
+        void showParameters();
+        void store();
+
+        MongoServer *const _server;
+        std::vector<Entry> _entries;
+        std::vector<QLineEdit *> _values;   // in order of parameters of selected template
+
+        QListWidget *_list;
+        QLineEdit *_nameEdit;
+        QLineEdit *_databaseEdit;
+        QPlainTextEdit *_scriptEdit;
+        QFormLayout *_parametersLayout;
+        QPushButton *_saveButton;
+        QPushButton *_removeButton;
+        QPushButton *_runButton;
+        QLabel *_statusLabel;
+    };
+}
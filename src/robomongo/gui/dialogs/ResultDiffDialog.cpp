@@ -0,0 +1,175 @@
+#include "robomongo/gui/dialogs/ResultDiffDialog.h"
+
+#include <algorithm>
+#include <QDialogButtonBox>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/gui/widgets/workarea/ResultDiffThread.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            IdColumn, DifferenceColumn, LeftColumn, RightColumn, ColumnCount
+        };
+
+        // Index of row in ResultDiff rows, data of document items
+        const int RowRole = Qt::UserRole + 1;
+
+        // Values are cut in cells, the whole of them is in tool tip
+        const int MaxValueLength = 200;
+
+        QString changeText(ResultDiff::FieldChange::Kind kind)
+        {
+            switch (kind) {
+            case ResultDiff::FieldChange::Added: return "Added";
+            case ResultDiff::FieldChange::Removed: return "Removed";
+            case ResultDiff::FieldChange::Modified: return "Modified";
+            case ResultDiff::FieldChange::Reordered: return "Field order";
+            default: return QString();
+            }
+        }
+    }
+
+    ResultDiffDialog::ResultDiffDialog(const std::vector<MongoDocumentPtr> &left, const QString &leftCaption,
+                                       const std::vector<MongoDocumentPtr> &right, const QString &rightCaption,
+                                       QWidget *parent) :
+        QDialog(parent),
+        _left(left),
+        _right(right),
+        _thread(new ResultDiffThread(left, right))
+    {
+        setWindowTitle(QString("Diff of %1 and %2").arg(leftCaption, rightCaption));
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(900, 600);
+
+        _differences = new QTreeWidget;
+        _differences->setColumnCount(ColumnCount);
+        _differences->setHeaderLabels(QStringList() << "_id" << "Difference" << leftCaption << rightCaption);
+        _differences->setUniformRowHeights(true);
+        VERIFY(connect(_differences, SIGNAL(itemExpanded(QTreeWidgetItem *)), this, SLOT(expandRow(QTreeWidgetItem *))));
+
+        _statusLabel = new QLabel("Comparing...");
+        _statusLabel->setWordWrap(true);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+
+        auto layout = new QVBoxLayout;
+        layout->addWidget(_differences, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        VERIFY(connect(_thread, SIGNAL(done()), this, SLOT(diffDone())));
+        VERIFY(connect(_thread, SIGNAL(finished()), _thread, SLOT(deleteLater())));
+        _thread->start();
+    }
+
+    ResultDiffDialog::~ResultDiffDialog()
+    {
+        // Thread deletes itself when finished, its rows are ignored
+        if (_thread)
+            _thread->stop();
+    }
+
+    QString ResultDiffDialog::valueText(const mongo::BSONElement &element) const
+    {
+        if (element.eoo())
+            return QString();
+
+        SettingsManager const *settings = AppRegistry::instance().settingsManager();
+        return QtUtils::toQString(BsonUtils::jsonString(element, mongo::TenGen, false, 0,
+                                                        settings->uuidEncoding(), settings->timeZone()));
+    }
+
+    void ResultDiffDialog::diffDone()
+    {
+        if (sender() != _thread)
+            return;
+
+        _rows = _thread->rows();
+        _thread = nullptr;
+
+        int counts[ResultDiff::OnlyRight + 1] = {};
+        int shown = 0;
+        for (size_t i = 0; i < _rows.size(); ++i) {
+            ResultDiff::Row const &row = _rows[i];
+            ++counts[row.status];
+            if (row.status == ResultDiff::Same || shown == MaxShownRows)
+                continue;
+
+            ++shown;
+            mongo::BSONObj const document = row.left >= 0 ? _left[row.left]->bsonObj() : _right[row.right]->bsonObj();
+            mongo::BSONElement const id = document["_id"];
+            auto item = new QTreeWidgetItem(_differences);
+            item->setText(IdColumn, id.eoo() ? QString("(document %1)").arg(std::max(row.left, row.right) + 1)
+                                             : valueText(id));
+            item->setData(IdColumn, RowRole, static_cast<int>(i));
+            switch (row.status) {
+            case ResultDiff::Changed:
+                item->setText(DifferenceColumn, QString("%1 fields").arg(row.changedFields));
+                item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+                break;
+            case ResultDiff::OnlyLeft:
+                item->setText(DifferenceColumn, "Only left");
+                item->setText(LeftColumn, "present");
+                break;
+            case ResultDiff::OnlyRight:
+                item->setText(DifferenceColumn, "Only right");
+                item->setText(RightColumn, "present");
+                break;
+            default:
+                break;
+            }
+        }
+        for (int column = 0; column < DifferenceColumn + 1; ++column)
+            _differences->resizeColumnToContents(column);
+
+        QString text = QString("%1 same, %2 changed, %3 only left, %4 only right.")
+            .arg(counts[ResultDiff::Same]).arg(counts[ResultDiff::Changed])
+            .arg(counts[ResultDiff::OnlyLeft]).arg(counts[ResultDiff::OnlyRight]);
+        if (shown == MaxShownRows)
+            text += QString(" The first %1 differences are listed.").arg(MaxShownRows);
+        _statusLabel->setText(text);
+    }
+
+    void ResultDiffDialog::expandRow(QTreeWidgetItem *item)
+    {
+        // Fields are listed on first expand, only for documents looked at
+        if (item->parent() || item->childCount() > 0)
+            return;
+
+        QVariant const index = item->data(IdColumn, RowRole);
+        if (!index.isValid())
+            return;
+
+        ResultDiff::Row const &row = _rows[index.toInt()];
+        if (row.status != ResultDiff::Changed)
+            return;
+
+        mongo::BSONObj const left = _left[row.left]->bsonObj();
+        mongo::BSONObj const right = _right[row.right]->bsonObj();
+        for (ResultDiff::FieldChange const &change : ResultDiff::fieldChanges(left, right)) {
+            auto child = new QTreeWidgetItem(item);
+            child->setText(IdColumn, change.path.empty() ? QString("(document)") : QtUtils::toQString(change.path));
+            child->setText(DifferenceColumn, changeText(change.kind));
+            QString const leftValue = valueText(change.left);
+            QString const rightValue = valueText(change.right);
+            child->setText(LeftColumn, leftValue.left(MaxValueLength));
+            child->setText(RightColumn, rightValue.left(MaxValueLength));
+            child->setToolTip(LeftColumn, leftValue.left(MaxValueLength * 20));
+            child->setToolTip(RightColumn, rightValue.left(MaxValueLength * 20));
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QDialog>
+#include <vector>
+
+#include "robomongo/core/Core.h"
+#include "robomongo/core/domain/ResultDiff.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QTreeWidget;
+class QTreeWidgetItem;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class ResultDiffThread;
+
+    /**
+     * @brief Differences of documents of two output parts, side by side. One row per document
+     *        that differs, fields of changed documents are listed only when row is expanded,
+     *        so neither result is built into BsonTreeModel.
+     */
+    class ResultDiffDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        static const int MaxShownRows = 10000;
+
+        ResultDiffDialog(const std::vector<MongoDocumentPtr> &left, const QString &leftCaption,
+                         const std::vector<MongoDocumentPtr> &right, const QString &rightCaption,
+                         QWidget *parent = 0);
+        ~ResultDiffDialog();
+
+    private Q_SLOTS:
+        void diffDone();
+        void expandRow(QTreeWidgetItem *item);
+
+    private:
+        QString valueText(const mongo::BSONElement &element) const;
+
+        std::vector<MongoDocumentPtr> const _left;
+        std::vector<MongoDocumentPtr> const _right;
+        std::vector<ResultDiff::Row> _rows;
+
+        QTreeWidget *_differences;
+        QLabel *_statusLabel;
+        ResultDiffThread *_thread;
+    };
+}
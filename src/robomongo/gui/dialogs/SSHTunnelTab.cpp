@@ -12,6 +12,7 @@
 #include <QMessageBox>
 #include <QFileInfo>
 #include <QFrame>
+#include <QSpinBox>
 
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/gui/GuiRegistry.h"
@@ -23,6 +24,11 @@
 namespace {
     const QString askPasswordText = "Ask for password each time";
     const QString askPassphraseText = "Ask for passphrase each time";
+
+    // Presets of editable algorithm lists, empty one keeps defaults of libssh2
+    const char *const chachaFirstCiphers =
+        "chacha20-poly1305@openssh.com,aes128-gcm@openssh.com,aes256-gcm@openssh.com,aes128-ctr,aes256-ctr";
+    const char *const defaultMacs = "hmac-sha2-256-etm@openssh.com,hmac-sha2-256,hmac-sha2-512,hmac-sha1";
     bool isFileExists(const QString &path) {
         QFileInfo fileInfo(path);
         return fileInfo.exists() && fileInfo.isFile();
@@ -73,6 +79,37 @@ namespace Robomongo
         _passphraseEchoModeButton->setIcon(GuiRegistry::instance().hideIcon());
         VERIFY(connect(_passphraseEchoModeButton, SIGNAL(clicked()), this, SLOT(togglePassphraseEchoMode())));
 
+        _ciphers = new QComboBox;
+        _ciphers->setEditable(true);
+        _ciphers->addItems(QStringList() << SshSettings::DefaultCiphers << chachaFirstCiphers << "");
+        _ciphers->setEditText(QtUtils::toQString(info->ciphers()));
+        _ciphers->lineEdit()->setPlaceholderText("Defaults of libssh2");
+        _ciphers->setToolTip("Ciphers offered to SSH server, in order of preference. "
+                             "Ones that are not supported are skipped.");
+
+        _macs = new QComboBox;
+        _macs->setEditable(true);
+        _macs->addItems(QStringList() << "" << defaultMacs);
+        _macs->setEditText(QtUtils::toQString(info->macs()));
+        _macs->lineEdit()->setPlaceholderText("Defaults of libssh2");
+        _macs->setToolTip("Message authentication codes offered to SSH server, not used with "
+                          "GCM and ChaCha20-Poly1305 ciphers");
+
+        _compression = new QCheckBox("Compress traffic (zlib), for slow links");
+        _compression->setChecked(info->compression());
+
+        _keepAlive = new QSpinBox;
+        _keepAlive->setRange(0, 3600);
+        _keepAlive->setSuffix(" s");
+        _keepAlive->setSpecialValueText("Off");
+        _keepAlive->setValue(info->keepAliveInterval());
+        _keepAlive->setToolTip("Interval of keep-alive messages, which keep idle tunnel open "
+                               "through firewalls that drop idle connections");
+
+        _ciphersLabel = new QLabel("Ciphers:");
+        _macsLabel = new QLabel("MACs:");
+        _keepAliveLabel = new QLabel("Keep-alive:");
+
         _passwordLabel = new QLabel("User Password:");
         _sshPrivateKeyLabel = new QLabel("Private key:");
         _sshPassphraseLabel = new QLabel("Passphrase:");
@@ -128,6 +165,14 @@ namespace Robomongo
         connectionLayout->addWidget(_passphraseEchoModeButton,     8, 2);
         connectionLayout->addWidget(_askForPassword,               9, 1, 1, 2);
 
+        connectionLayout->addWidget(_ciphersLabel,                 10, 0);
+        connectionLayout->addWidget(_ciphers,                      10, 1, 1, 2);
+        connectionLayout->addWidget(_macsLabel,                    11, 0);
+        connectionLayout->addWidget(_macs,                         11, 1, 1, 2);
+        connectionLayout->addWidget(_keepAliveLabel,               12, 0);
+        connectionLayout->addWidget(_keepAlive,                    12, 1, Qt::AlignLeft);
+        connectionLayout->addWidget(_compression,                  13, 1, 1, 2);
+
         QVBoxLayout *mainLayout = new QVBoxLayout;
         mainLayout->addWidget(_useSsh);
         mainLayout->addLayout(connectionLayout);
@@ -209,6 +254,14 @@ namespace Robomongo
 
         _askForPassword->setEnabled(checked);
 
+        _ciphersLabel->setEnabled(checked);
+        _ciphers->setEnabled(checked);
+        _macsLabel->setEnabled(checked);
+        _macs->setEnabled(checked);
+        _keepAliveLabel->setEnabled(checked);
+        _keepAlive->setEnabled(checked);
+        _compression->setEnabled(checked);
+
         askForPasswordStateChanged(_askForPassword->checkState());
 
         if (checked)
@@ -297,6 +350,10 @@ namespace Robomongo
         info->setPrivateKeyFile(QtUtils::toStdString(privateKey));
         info->setPassphrase(QtUtils::toStdString(_passphraseBox->text()));
         info->setAuthMethod(QtUtils::toStdString(authMethod));
+        info->setCiphers(QtUtils::toStdString(_ciphers->currentText().remove(' ')));
+        info->setMacs(QtUtils::toStdString(_macs->currentText().remove(' ')));
+        info->setCompression(_compression->isChecked());
+        info->setKeepAliveInterval(_keepAlive->value());
         info->setEnabled(sshEnabled);
         return true;
     }
@@ -11,6 +11,7 @@ class QCheckBox;
 class QPushButton;
 class QComboBox;
 class QFrame;
+class QSpinBox;
 QT_END_NAMESPACE
 
 namespace Robomongo
@@ -60,6 +61,14 @@ namespace Robomongo
         QLineEdit *_passphraseBox;
         QPushButton *_passphraseEchoModeButton;
 
+        QLabel *_ciphersLabel;
+        QComboBox *_ciphers;
+        QLabel *_macsLabel;
+        QComboBox *_macs;
+        QCheckBox *_compression;
+        QLabel *_keepAliveLabel;
+        QSpinBox *_keepAlive;
+
         ConnectionSettings *const _settings;
     };
 }
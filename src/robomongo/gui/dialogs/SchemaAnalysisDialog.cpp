@@ -0,0 +1,182 @@
+#include "robomongo/gui/dialogs/SchemaAnalysisDialog.h"
+
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            PathColumn, TypesColumn, MissingColumn, NullColumn, DistinctColumn, SizeColumn, ColumnCount
+        };
+
+        // Percent with one decimal, as number, so that column is sorted by value
+        double percent(double ratio)
+        {
+            return qRound(ratio * 1000) / 10.0;
+        }
+
+        QString typesText(const FieldAnalysis &field)
+        {
+            QStringList types;
+            for (auto const &type : field.types) {
+                types << QString("%1 %2%").arg(QtUtils::toQString(type.first))
+                                          .arg(percent(static_cast<double>(type.second) / field.values));
+            }
+            return types.join(", ");
+        }
+    }
+
+    SchemaAnalysisDialog::SchemaAnalysisDialog(MongoServer *server, const QString &dbName, 
+                                               const QString &collectionName, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _collectionName(collectionName),
+        _analysisId(0)
+    {
+        setWindowTitle("Schema of " + dbName + "." + collectionName);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(900, 600);
+
+        AppRegistry::instance().bus()->subscribe(this, AnalyzeSchemaProgressEvent::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, AnalyzeSchemaResponse::Type, server);
+
+        _sampleSizeSpin = new QSpinBox;
+        _sampleSizeSpin->setRange(100, 10 * 1000 * 1000);
+        _sampleSizeSpin->setSingleStep(1000);
+        _sampleSizeSpin->setValue(AnalyzeSchemaRequest::DefaultSampleSize);
+        _sampleSizeSpin->setToolTip("Random documents ($sample) analyzed. Memory used does not depend on it.");
+        _analyzeButton = new QPushButton("Analyze");
+        _analyzeButton->setDefault(true);
+
+        auto commandLayout = new QHBoxLayout;
+        commandLayout->addWidget(new QLabel("Sample size:"));
+        commandLayout->addWidget(_sampleSizeSpin);
+        commandLayout->addWidget(_analyzeButton);
+        commandLayout->addStretch(1);
+
+        _fields = new QTreeWidget;
+        _fields->setColumnCount(ColumnCount);
+        _fields->setHeaderLabels(QStringList() << "Field" << "Types" << "Missing %" << "Null %" 
+                                               << "Distinct (approx.)" << "Avg. size, bytes");
+        _fields->setRootIsDecorated(false);
+        _fields->setUniformRowHeights(true);
+        _fields->setSortingEnabled(true);
+
+        _progressBar = new QProgressBar;
+        _progressBar->hide();
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_analyzeButton, SIGNAL(clicked()), this, SLOT(analyze())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(commandLayout);
+        layout->addWidget(_fields, 1);
+        layout->addWidget(_progressBar);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        analyze();
+    }
+
+    SchemaAnalysisDialog::~SchemaAnalysisDialog()
+    {
+        // Sample of closed dialog is not read further
+        cancel();
+    }
+
+    void SchemaAnalysisDialog::cancel()
+    {
+        if (_cancelled)
+            *_cancelled = true;
+        _cancelled.reset();
+    }
+
+    void SchemaAnalysisDialog::analyze()
+    {
+        cancel();
+
+        static int lastAnalysisId = 0;
+        _analysisId = ++lastAnalysisId;
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+
+        _analyzeButton->setEnabled(false);
+        _progressBar->setRange(0, _sampleSizeSpin->value());
+        _progressBar->setValue(0);
+        _progressBar->show();
+        _statusLabel->setText("Analyzing sample...");
+        _server->analyzeSchema(_analysisId, 
+                               MongoNamespace(QtUtils::toStdString(_dbName), QtUtils::toStdString(_collectionName)),
+                               _sampleSizeSpin->value(), _cancelled);
+    }
+
+    void SchemaAnalysisDialog::handle(AnalyzeSchemaProgressEvent *event)
+    {
+        if (event->analysisId != _analysisId)
+            return;
+
+        _progressBar->setValue(static_cast<int>(event->analyzed));
+    }
+
+    void SchemaAnalysisDialog::handle(AnalyzeSchemaResponse *event)
+    {
+        if (event->analysisId != _analysisId)
+            return;
+
+        _analysisId = 0;
+        _cancelled.reset();
+        _analyzeButton->setEnabled(true);
+        _progressBar->hide();
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        // Sorting is off while rows are added, so that they are not sorted one by one
+        _fields->setSortingEnabled(false);
+        _fields->clear();
+        for (FieldAnalysis const &field : event->fields) {
+            auto item = new QTreeWidgetItem(_fields);
+            item->setText(PathColumn, QtUtils::toQString(field.path));
+            item->setText(TypesColumn, typesText(field));
+            item->setData(MissingColumn, Qt::DisplayRole, percent(field.missingRatio));
+            item->setData(NullColumn, Qt::DisplayRole, percent(field.nullRatio));
+            item->setData(DistinctColumn, Qt::DisplayRole, qRound64(field.distinct));
+            item->setData(SizeColumn, Qt::DisplayRole, qRound64(field.averageSize));
+        }
+        _fields->setSortingEnabled(true);
+        _fields->sortByColumn(PathColumn, Qt::AscendingOrder);
+        for (int column = 0; column < ColumnCount; ++column)
+            _fields->resizeColumnToContents(column);
+
+        QString text = QString("%1 documents analyzed in %2 s.")
+            .arg(event->documents).arg(event->elapsedMs / 1000.0, 0, 'f', 1);
+        if (event->droppedPaths > 0)
+            text += QString(" %1 values of fields over the limit of %2 fields were not analyzed.")
+                .arg(event->droppedPaths).arg(SchemaAnalyzer::DefaultMaxFields);
+        _statusLabel->setText(text);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QDialog>
+#include <atomic>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QSpinBox;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class AnalyzeSchemaProgressEvent;
+    class AnalyzeSchemaResponse;
+
+    /**
+     * @brief Shows type histogram, approximate distinct count, null and missing ratio and
+     *        average size of every field path of random sample of collection. Sample is
+     *        streamed through SchemaAnalyzer in the worker of server (see MongoServer::analyzeSchema()).
+     */
+    class SchemaAnalysisDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        SchemaAnalysisDialog(MongoServer *server, const QString &dbName, const QString &collectionName,
+                             QWidget *parent = 0);
+        ~SchemaAnalysisDialog();
+
+    public Q_SLOTS:
+        void handle(AnalyzeSchemaProgressEvent *event);
+        void handle(AnalyzeSchemaResponse *event);
+
+    private Q_SLOTS:
+        void analyze();
+
+    private:
+        void cancel();
+
+        MongoServer *const _server;
+        QString const _dbName;
+        QString const _collectionName;
+
+        QSpinBox *_sampleSizeSpin;
+        QPushButton *_analyzeButton;
+        QProgressBar *_progressBar;
+        QLabel *_statusLabel;
+        QTreeWidget *_fields;
+
+        int _analysisId;                                // 0, if nothing is being analyzed
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+}
@@ -0,0 +1,303 @@
+#include "robomongo/gui/dialogs/ScriptBroadcastDialog.h"
+
+#include <algorithm>
+#include <QApplication>
+#include <QClipboard>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QSplitter>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include <mongo/bson/bsonobjbuilder.h>
+
+#include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/domain/ScriptBroadcast.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/gui/GuiRegistry.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            ConnectionColumn, StatusColumn, ConnectColumn, ScriptColumn, DocumentsColumn, ResultColumn,
+            ColumnCount
+        };
+
+        const int MaxResultLength = 300;
+        const int MaxDocumentRows = 1000;       // per connection, all of them are copied
+
+        QString statusName(ScriptBroadcast::Result::Status status)
+        {
+            switch (status) {
+            case ScriptBroadcast::Result::Pending: return "Pending";
+            case ScriptBroadcast::Result::Connecting: return "Connecting";
+            case ScriptBroadcast::Result::Running: return "Running";
+            case ScriptBroadcast::Result::Done: return "Done";
+            case ScriptBroadcast::Result::Failed: return "Failed";
+            case ScriptBroadcast::Result::Cancelled: return "Cancelled";
+            default: return QString();
+            }
+        }
+
+        bool isFinal(ScriptBroadcast::Result::Status status)
+        {
+            return status == ScriptBroadcast::Result::Done || status == ScriptBroadcast::Result::Failed ||
+                   status == ScriptBroadcast::Result::Cancelled;
+        }
+
+        QString jsonOf(const mongo::BSONObj &obj)
+        {
+            QString const json = QtUtils::toQString(BsonUtils::jsonString(obj, mongo::TenGen, 0, DefaultEncoding, Utc));
+            return json.length() > MaxResultLength ? json.left(MaxResultLength) + "..." : json;
+        }
+    }
+
+    ScriptBroadcastDialog::ScriptBroadcastDialog(const std::vector<ConnectionSettings *> &connections,
+                                                 ConnectionSettings *checked, QWidget *parent) :
+        QDialog(parent),
+        _broadcast(nullptr)
+    {
+        setWindowTitle("Run Script on Connections");
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(1000, 700);
+
+        _connectionList = new QListWidget;
+        for (ConnectionSettings *connection : connections) {
+            _connections.emplace_back(connection->clone());
+            auto item = new QListWidgetItem(QtUtils::toQString(connection->getReadableName()), _connectionList);
+            item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+            item->setCheckState(connection == checked ? Qt::Checked : Qt::Unchecked);
+        }
+
+        _script = new QPlainTextEdit;
+        _script->setFont(GuiRegistry::instance().font());
+        _script->setPlaceholderText("db.serverStatus().connections");
+
+        _database = new QLineEdit;
+        _database->setPlaceholderText("Default database of connection");
+
+        _concurrency = new QSpinBox;
+        _concurrency->setRange(1, MaxConcurrency);
+        _concurrency->setValue(DefaultConcurrency);
+        _concurrency->setToolTip("Connections, which run the script at the same time");
+
+        auto optionsLayout = new QFormLayout;
+        optionsLayout->addRow("Database:", _database);
+        optionsLayout->addRow("Parallel:", _concurrency);
+
+        auto scriptLayout = new QVBoxLayout;
+        scriptLayout->setContentsMargins(0, 0, 0, 0);
+        scriptLayout->addWidget(_script, 1);
+        scriptLayout->addLayout(optionsLayout);
+        auto scriptWidget = new QWidget;
+        scriptWidget->setLayout(scriptLayout);
+
+        auto topSplitter = new QSplitter(Qt::Horizontal);
+        topSplitter->addWidget(_connectionList);
+        topSplitter->addWidget(scriptWidget);
+        topSplitter->setStretchFactor(1, 1);
+
+        _results = new QTreeWidget;
+        _results->setColumnCount(ColumnCount);
+        _results->setHeaderLabels(QStringList() << "Connection" << "Status" << "Connect (ms)" << "Script (ms)"
+                                                << "Documents" << "Result");
+        _results->setUniformRowHeights(true);
+        _results->header()->setStretchLastSection(true);
+        _results->setColumnWidth(ConnectionColumn, 220);
+
+        auto splitter = new QSplitter(Qt::Vertical);
+        splitter->addWidget(topSplitter);
+        splitter->addWidget(_results);
+        splitter->setStretchFactor(1, 1);
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        _runButton = buttonBox->addButton("Run", QDialogButtonBox::ActionRole);
+        _cancelButton = buttonBox->addButton("Cancel", QDialogButtonBox::ActionRole);
+        _cancelButton->setEnabled(false);
+        _copyButton = buttonBox->addButton("Copy Results as JSON", QDialogButtonBox::ActionRole);
+        _copyButton->setEnabled(false);
+
+        auto layout = new QVBoxLayout;
+        layout->addWidget(splitter, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        VERIFY(connect(_runButton, SIGNAL(clicked()), this, SLOT(run())));
+        VERIFY(connect(_cancelButton, SIGNAL(clicked()), this, SLOT(cancel())));
+        VERIFY(connect(_copyButton, SIGNAL(clicked()), this, SLOT(copyJson())));
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+    }
+
+    ScriptBroadcastDialog::~ScriptBroadcastDialog()
+    {
+        // Stops workers of running scripts
+        delete _broadcast;
+    }
+
+    void ScriptBroadcastDialog::run()
+    {
+        std::string const script = QtUtils::toStdString(_script->toPlainText());
+        if (script.find_first_not_of(" \t\r\n") == std::string::npos) {
+            _statusLabel->setText("Script is empty.");
+            return;
+        }
+
+        std::vector<ConnectionSettings *> checked;
+        for (int i = 0; i < _connectionList->count(); ++i) {
+            if (_connectionList->item(i)->checkState() == Qt::Checked)
+                checked.push_back(_connections[i].get());
+        }
+        if (checked.empty()) {
+            _statusLabel->setText("No connection is checked.");
+            return;
+        }
+
+        delete _broadcast;
+        _results->clear();
+        _broadcast = new ScriptBroadcast(checked, script, QtUtils::toStdString(_database->text().trimmed()),
+                                         _concurrency->value());
+        for (auto const &result : _broadcast->results()) {
+            auto item = new QTreeWidgetItem(_results);
+            item->setText(ConnectionColumn, QtUtils::toQString(result.connection));
+        }
+
+        VERIFY(connect(_broadcast, SIGNAL(resultChanged(int)), this, SLOT(updateResult(int))));
+        VERIFY(connect(_broadcast, SIGNAL(finished()), this, SLOT(broadcastFinished())));
+
+        _runButton->setEnabled(false);
+        _cancelButton->setEnabled(true);
+        _copyButton->setEnabled(false);
+        _broadcast->start();
+        updateStatus();
+    }
+
+    void ScriptBroadcastDialog::cancel()
+    {
+        if (_broadcast)
+            _broadcast->cancel();
+    }
+
+    void ScriptBroadcastDialog::updateResult(int index)
+    {
+        QTreeWidgetItem *item = _results->topLevelItem(index);
+        if (!item)
+            return;
+
+        ScriptBroadcast::Result const &result = _broadcast->results()[index];
+        item->setText(StatusColumn, statusName(result.status));
+        if (result.connectMs > 0)
+            item->setText(ConnectColumn, QString::number(result.connectMs));
+
+        if (isFinal(result.status)) {
+            if (result.status != ScriptBroadcast::Result::Cancelled && result.scriptMs > 0)
+                item->setText(ScriptColumn, QString::number(result.scriptMs));
+            item->setText(DocumentsColumn, QString::number(result.documents.size()));
+
+            // Single document (i.e. serverStatus extract) is shown in the row of connection
+            QString text;
+            if (!result.error.empty())
+                text = QtUtils::toQString(result.error);
+            else if (result.documents.size() == 1)
+                text = jsonOf(result.documents.front()->bsonObj());
+            else if (result.documents.empty() && !result.responses.empty())
+                text = QtUtils::toQString(result.responses.front());
+            item->setText(ResultColumn, text.left(MaxResultLength));
+            item->setToolTip(ResultColumn, text.left(MaxResultLength * 10));
+            if (!result.error.empty())
+                item->setForeground(StatusColumn, Qt::red);
+
+            if (result.documents.size() > 1) {
+                int const rows = std::min<int>(result.documents.size(), MaxDocumentRows);
+                for (int i = 0; i < rows; ++i) {
+                    auto child = new QTreeWidgetItem(item);
+                    child->setText(DocumentsColumn, QString::number(i + 1));
+                    child->setText(ResultColumn, jsonOf(result.documents[i]->bsonObj()));
+                }
+            }
+        }
+
+        updateStatus();
+    }
+
+    void ScriptBroadcastDialog::broadcastFinished()
+    {
+        _runButton->setEnabled(true);
+        _cancelButton->setEnabled(false);
+        _copyButton->setEnabled(true);
+        for (int column = StatusColumn; column < ResultColumn; ++column)
+            _results->resizeColumnToContents(column);
+        updateStatus();
+    }
+
+    void ScriptBroadcastDialog::copyJson()
+    {
+        if (!_broadcast)
+            return;
+
+        // One object per connection, in order of the table
+        mongo::BSONArrayBuilder connections;
+        for (auto const &result : _broadcast->results()) {
+            mongo::BSONObjBuilder connection;
+            connection.append("connection", result.connection);
+            connection.append("status", QtUtils::toStdString(statusName(result.status)));
+            connection.append("connectMs", static_cast<long long>(result.connectMs));
+            connection.append("scriptMs", static_cast<long long>(result.scriptMs));
+            if (!result.error.empty())
+                connection.append("error", result.error);
+
+            mongo::BSONArrayBuilder documents(connection.subarrayStart("documents"));
+            for (auto const &document : result.documents)
+                documents.append(document->bsonObj());
+            documents.done();
+
+            if (!result.responses.empty()) {
+                mongo::BSONArrayBuilder responses(connection.subarrayStart("responses"));
+                for (auto const &response : result.responses)
+                    responses.append(response);
+                responses.done();
+            }
+            connections.append(connection.obj());
+        }
+
+        QApplication::clipboard()->setText(QtUtils::toQString(
+            BsonUtils::jsonString(connections.arr(), mongo::TenGen, 1, DefaultEncoding, Utc, true)));
+    }
+
+    void ScriptBroadcastDialog::updateStatus()
+    {
+        if (!_broadcast)
+            return;
+
+        int done = 0, failed = 0, running = 0;
+        for (auto const &result : _broadcast->results()) {
+            switch (result.status) {
+            case ScriptBroadcast::Result::Done: ++done; break;
+            case ScriptBroadcast::Result::Failed: ++failed; break;
+            case ScriptBroadcast::Result::Connecting:
+            case ScriptBroadcast::Result::Running: ++running; break;
+            default: break;
+            }
+        }
+
+        _statusLabel->setText(QString("%1 of %2 connections done, %3 failed, %4 running.")
+            .arg(done).arg(_broadcast->results().size()).arg(failed).arg(running));
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <QDialog>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QLineEdit;
+class QListWidget;
+class QPlainTextEdit;
+class QPushButton;
+class QSpinBox;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class ConnectionSettings;
+    class ScriptBroadcast;
+
+    /**
+     * @brief Runs the same script on checked connections in parallel (see ScriptBroadcast),
+     *        results of all of them are merged into one table with a row per connection and
+     *        its timings. Documents of a connection are rows under it.
+     */
+    class ScriptBroadcastDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * @param checked Connection, which is checked initially
+         */
+        ScriptBroadcastDialog(const std::vector<ConnectionSettings *> &connections, ConnectionSettings *checked,
+                              QWidget *parent = 0);
+        ~ScriptBroadcastDialog();
+
+    private Q_SLOTS:
+        void run();
+        void cancel();
+        void copyJson();
+        void updateResult(int index);
+        void broadcastFinished();
+
+    private:
+        static const int DefaultConcurrency = 8;
+        static const int MaxConcurrency = 64;
+
+        void updateStatus();
+
+        // Copies, as connections may be edited or removed while broadcast is running
+        std::vector<std::unique_ptr<ConnectionSettings>> _connections;
+
+        QListWidget *_connectionList;
+        QPlainTextEdit *_script;
+        QLineEdit *_database;
+        QSpinBox *_concurrency;
+        QPushButton *_runButton;
+        QPushButton *_cancelButton;
+        QPushButton *_copyButton;
+        QTreeWidget *_results;
+        QLabel *_statusLabel;
+
+        ScriptBroadcast *_broadcast;
+    };
+}
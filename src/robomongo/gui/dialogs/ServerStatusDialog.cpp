@@ -0,0 +1,182 @@
+#include "robomongo/gui/dialogs/ServerStatusDialog.h"
+
+#include <QDialogButtonBox>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPainter>
+#include <QSpinBox>
+#include <QTime>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/MongoUtils.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        /**
+         * @brief Line of recent values of one metric, scaled to their maximum.
+         *        Points are kept in a member array, so repaint does not allocate.
+         */
+        class Sparkline : public QWidget
+        {
+        public:
+            Sparkline(const ServerStatusSeries &series, ServerStatusSeries::Metric metric, QWidget *parent = 0) :
+                QWidget(parent), _series(series), _metric(metric)
+            {
+                setMinimumSize(240, 28);
+                setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+            }
+
+        protected:
+            void paintEvent(QPaintEvent *) override
+            {
+                int const size = _series.size();
+                if (size < 2)
+                    return;
+
+                double const max = _series.max(_metric);
+                qreal const height = this->height() - 2;
+                qreal const step = static_cast<qreal>(width() - 1) / (ServerStatusSeries::Capacity - 1);
+                qreal const left = (ServerStatusSeries::Capacity - size) * step;   // newest on the right
+                for (int i = 0; i < size; ++i) {
+                    double const ratio = max > 0 ? _series.value(_metric, i) / max : 0;
+                    _points[i] = QPointF(left + i * step, 1 + height * (1 - ratio));
+                }
+
+                QPainter painter(this);
+                painter.setRenderHint(QPainter::Antialiasing);
+                painter.setPen(QPen(palette().color(QPalette::Highlight), 1.5));
+                painter.drawPolyline(_points.data(), size);
+            }
+
+        private:
+            const ServerStatusSeries &_series;
+            ServerStatusSeries::Metric const _metric;
+            std::array<QPointF, ServerStatusSeries::Capacity> _points;
+        };
+    }
+
+    ServerStatusDialog::ServerStatusDialog(MongoServer *server, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _monitorId(0)
+    {
+        setWindowTitle("Server Status");
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+
+        static int lastMonitorId = 0;
+        _monitorId = ++lastMonitorId;
+
+        AppRegistry::instance().bus()->subscribe(this, ServerStatusResponse::Type, server);
+
+        _serverLabel = new QLabel;
+        _serverLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        _interval = new QSpinBox;
+        _interval->setRange(1, 5);
+        _interval->setValue(2);
+        _interval->setSuffix(" s");
+
+        auto topLayout = new QHBoxLayout;
+        topLayout->addWidget(_serverLabel, 1);
+        topLayout->addWidget(new QLabel("Sample every:"));
+        topLayout->addWidget(_interval);
+
+        auto grid = new QGridLayout;
+        grid->setColumnStretch(2, 1);
+        for (int i = 0; i < ServerStatusSeries::MetricCount; ++i) {
+            auto const metric = ServerStatusSeries::Metric(i);
+            _valueLabels[i] = new QLabel;
+            _valueLabels[i]->setMinimumWidth(90);
+            _valueLabels[i]->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            _sparklines[i] = new Sparkline(_series, metric);
+
+            grid->addWidget(new QLabel(ServerStatusSeries::metricName(metric)), i, 0);
+            grid->addWidget(_valueLabels[i], i, 1);
+            grid->addWidget(_sparklines[i], i, 2);
+        }
+
+        _statusLabel = new QLabel("Sampling...");
+        _statusLabel->setWordWrap(true);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(topLayout);
+        layout->addLayout(grid);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        _timer = new QTimer(this);
+        _timer->setSingleShot(true);
+        VERIFY(connect(_timer, SIGNAL(timeout()), this, SLOT(sample())));
+
+        sample();
+    }
+
+    void ServerStatusDialog::handle(ServerStatusResponse *event)
+    {
+        if (event->monitorId != _monitorId)
+            return;
+
+        // Next sample is requested after this one came, so slow server is not flooded
+        _timer->start(_interval->value() * 1000);
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        mongo::BSONObj const &status = event->status;
+        _serverLabel->setText(QString("%1, MongoDB %2, up %3 h")
+            .arg(QtUtils::toQString(status.getStringField("host")))
+            .arg(QtUtils::toQString(status.getStringField("version")))
+            .arg(status["uptime"].numberDouble() / 3600, 0, 'f', 1));
+
+        if (!_series.addSample(status)) {
+            _statusLabel->setText("Waiting for the next sample to compute rates...");
+            return;
+        }
+
+        for (int i = 0; i < ServerStatusSeries::MetricCount; ++i) {
+            auto const metric = ServerStatusSeries::Metric(i);
+            _valueLabels[i]->setText(_series.isAvailable(metric) ? formatValue(metric, _series.last(metric)) 
+                                                                 : QString("n/a"));
+            _sparklines[i]->update();
+        }
+
+        _statusLabel->setText(QString("%1 samples, last at %2")
+            .arg(_series.size()).arg(QTime::currentTime().toString("hh:mm:ss")));
+    }
+
+    void ServerStatusDialog::sample()
+    {
+        _server->sampleServerStatus(_monitorId);
+    }
+
+    QString ServerStatusDialog::formatValue(ServerStatusSeries::Metric metric, double value)
+    {
+        switch (metric) {
+        case ServerStatusSeries::NetworkIn:
+        case ServerStatusSeries::NetworkOut:
+            return MongoUtils::buildNiceSizeString(value) + "/s";
+        case ServerStatusSeries::CacheUsed:
+        case ServerStatusSeries::CacheDirty:
+            return QString("%1 %").arg(value, 0, 'f', 1);
+        default:
+            return ServerStatusSeries::isRate(metric) ? QString::number(value, 'f', 1) 
+                                                      : QString::number(value, 'f', 0);
+        }
+    }
+}
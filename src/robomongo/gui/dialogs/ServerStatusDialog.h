@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QDialog>
+#include <array>
+
+#include "robomongo/core/domain/ServerStatusSeries.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QSpinBox;
+class QTimer;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class ServerStatusResponse;
+
+    /**
+     * @brief Dashboard of server metrics (operation rates, network, WiredTiger cache, queues)
+     *        sampled from serverStatus every 1-5 seconds in MongoServer::metadataWorker(),
+     *        with sparklines of the last ServerStatusSeries::Capacity samples.
+     */
+    class ServerStatusDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        explicit ServerStatusDialog(MongoServer *server, QWidget *parent = 0);
+
+    public Q_SLOTS:
+        void handle(ServerStatusResponse *event);
+
+    private Q_SLOTS:
+        void sample();
+
+    private:
+        static QString formatValue(ServerStatusSeries::Metric metric, double value);
+
+        MongoServer *const _server;
+        int _monitorId;
+        ServerStatusSeries _series;
+
+        QLabel *_serverLabel;
+        QLabel *_statusLabel;
+        QSpinBox *_interval;
+        QTimer *_timer;
+        std::array<QLabel *, ServerStatusSeries::MetricCount> _valueLabels;
+        std::array<QWidget *, ServerStatusSeries::MetricCount> _sparklines;
+    };
+}
@@ -0,0 +1,236 @@
+#include "robomongo/gui/dialogs/ShardDistributionDialog.h"
+
+#include <algorithm>
+
+#include <QCheckBox>
+#include <QDateTime>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QSet>
+#include <QSpinBox>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/MongoUtils.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            ShardColumn, ChunksColumn, ChangeColumn, JumboColumn, ShareColumn, SizeColumn, DocumentsColumn,
+            MovedInColumn, MovedOutColumn,
+            ColumnCount
+        };
+
+        QString timeText(long long ms)
+        {
+            return QDateTime::fromMSecsSinceEpoch(ms).toString("yyyy-MM-dd hh:mm:ss");
+        }
+    }
+
+    ShardDistributionDialog::ShardDistributionDialog(MongoServer *server, const QString &dbName,
+                                                     const QString &collection, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _collection(collection),
+        _distributionId(0),
+        _activityFromMs(QDateTime::currentMSecsSinceEpoch() - ActivityHours * 3600 * 1000LL),
+        _sinceMs(_activityFromMs),
+        _hasSnapshot(false)
+    {
+        setWindowTitle("Shard Distribution of " + dbName + "." + collection);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(950, 450);
+
+        AppRegistry::instance().bus()->subscribe(this, ShardDistributionResponse::Type, server);
+
+        _autoRefresh = new QCheckBox("Refresh every");
+        _autoRefresh->setChecked(true);
+        _interval = new QSpinBox;
+        _interval->setRange(1, 3600);
+        _interval->setValue(10);
+        _interval->setSuffix(" s");
+        _refreshButton = new QPushButton("Refresh");
+
+        _timer = new QTimer(this);
+        VERIFY(connect(_timer, SIGNAL(timeout()), this, SLOT(refresh())));
+
+        auto refreshLayout = new QHBoxLayout;
+        refreshLayout->addWidget(_autoRefresh);
+        refreshLayout->addWidget(_interval);
+        refreshLayout->addStretch(1);
+        refreshLayout->addWidget(_refreshButton);
+
+        _balancerLabel = new QLabel;
+        _balancerLabel->setWordWrap(true);
+        _balancerLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        _tree = new QTreeWidget;
+        _tree->setColumnCount(ColumnCount);
+        _tree->setHeaderLabels(QStringList() << "Shard" << "Chunks" << "Change" << "Jumbo" << "% of chunks"
+                                             << "Data size" << "Documents" << "Moved in" << "Moved out");
+        _tree->setRootIsDecorated(false);
+        _tree->setUniformRowHeights(true);
+        _tree->setSortingEnabled(true);
+        _tree->sortByColumn(ShardColumn, Qt::AscendingOrder);
+        _tree->header()->resizeSection(ShardColumn, 200);
+        _tree->headerItem()->setToolTip(ChangeColumn, "Chunks gained or lost since the previous refresh");
+        _tree->headerItem()->setToolTip(MovedInColumn, "Migrations committed since " + 
+                                                       timeText(_activityFromMs));
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_refreshButton, SIGNAL(clicked()), this, SLOT(refresh())));
+        VERIFY(connect(_autoRefresh, SIGNAL(toggled(bool)), this, SLOT(autoRefreshChanged())));
+        VERIFY(connect(_interval, SIGNAL(valueChanged(int)), this, SLOT(autoRefreshChanged())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(refreshLayout);
+        layout->addWidget(_balancerLabel);
+        layout->addWidget(_tree, 1);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        autoRefreshChanged();
+        refresh();
+    }
+
+    void ShardDistributionDialog::refresh()
+    {
+        // Slow server is not asked again before it answers
+        if (_distributionId)
+            return;
+
+        static int lastDistributionId = 0;
+        _distributionId = ++lastDistributionId;
+        _refreshButton->setEnabled(false);
+        _server->shardDistribution(_distributionId, MongoNamespace(QtUtils::toStdString(_dbName),
+                                                                   QtUtils::toStdString(_collection)), _sinceMs);
+    }
+
+    void ShardDistributionDialog::autoRefreshChanged()
+    {
+        _interval->setEnabled(_autoRefresh->isChecked());
+        if (_autoRefresh->isChecked())
+            _timer->start(_interval->value() * 1000);
+        else
+            _timer->stop();
+    }
+
+    void ShardDistributionDialog::handle(ShardDistributionResponse *event)
+    {
+        if (event->distributionId != _distributionId)
+            return;
+
+        _distributionId = 0;
+        _refreshButton->setEnabled(true);
+
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        // Response has only activity since the previous one
+        ShardDistribution::Snapshot snapshot = event->snapshot;
+        _previousChunks.clear();
+        if (_hasSnapshot) {
+            ShardDistribution::addActivity(snapshot, _snapshot);
+            for (ShardDistribution::ShardInfo const &shard : _snapshot.shards)
+                _previousChunks.insert(QtUtils::toQString(shard.shard), shard.chunks);
+        }
+        _snapshot = snapshot;
+        _sinceMs = std::max(_sinceMs, _snapshot.balancer.lastActivityMs);
+        _hasSnapshot = true;
+
+        updateTree();
+        updateBalancer();
+        _statusLabel->setText(QString("%1 chunks on %2 shards, read at %3 in %4 ms.")
+            .arg(_snapshot.totalChunks).arg(_snapshot.shards.size())
+            .arg(QDateTime::currentDateTime().toString("hh:mm:ss")).arg(event->elapsedMs));
+    }
+
+    void ShardDistributionDialog::updateTree()
+    {
+        _tree->setSortingEnabled(false);
+
+        QSet<QString> seen;
+        for (ShardDistribution::ShardInfo const &shard : _snapshot.shards) {
+            QString const name = QtUtils::toQString(shard.shard);
+            seen.insert(name);
+
+            QTreeWidgetItem *&item = _shardItems[name];
+            if (!item) {
+                item = new QTreeWidgetItem(_tree);
+                for (int column = ChunksColumn; column < ColumnCount; ++column)
+                    item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+            }
+
+            item->setText(ShardColumn, name);
+            item->setData(ChunksColumn, Qt::DisplayRole, shard.chunks);
+
+            long long const change = _previousChunks.contains(name) ? shard.chunks - _previousChunks.value(name) : 0;
+            item->setText(ChangeColumn, change == 0 ? QString() : (change > 0 ? "+" : "") + QString::number(change));
+            item->setForeground(ChangeColumn, change < 0 ? Qt::darkRed : Qt::darkGreen);
+
+            item->setData(JumboColumn, Qt::DisplayRole, shard.jumboChunks);
+            item->setForeground(JumboColumn, shard.jumboChunks > 0 ? Qt::darkRed : item->foreground(ShardColumn));
+
+            double const share = _snapshot.totalChunks > 0 ? 100.0 * shard.chunks / _snapshot.totalChunks : 0.0;
+            item->setText(ShareColumn, QString::number(share, 'f', 1) + " %");
+            item->setText(SizeColumn, shard.dataBytes < 0 ? QString() : MongoUtils::buildNiceSizeString(shard.dataBytes));
+            item->setText(DocumentsColumn, shard.documents < 0 ? QString() : QString::number(shard.documents));
+            item->setData(MovedInColumn, Qt::DisplayRole, shard.movedIn);
+            item->setData(MovedOutColumn, Qt::DisplayRole, shard.movedOut);
+        }
+
+        // Removed shards
+        for (auto it = _shardItems.begin(); it != _shardItems.end();) {
+            if (seen.contains(it.key())) {
+                ++it;
+                continue;
+            }
+            delete it.value();
+            it = _shardItems.erase(it);
+        }
+
+        _tree->setSortingEnabled(true);
+    }
+
+    void ShardDistributionDialog::updateBalancer()
+    {
+        ShardDistribution::BalancerInfo const &balancer = _snapshot.balancer;
+
+        QString text = "Balancer: " + (balancer.mode.empty() ? QString("state unknown")
+                                                             : QtUtils::toQString(balancer.mode));
+        if (balancer.inRound)
+            text += ", in balancing round";
+        if (balancer.noBalance)
+            text += ", <b>disabled for this collection</b>";
+
+        text += QString(". Since %1: %2 migrations, %3 failed, %4 splits")
+            .arg(timeText(_activityFromMs)).arg(balancer.migrations).arg(balancer.failedMigrations).arg(balancer.splits);
+        if (balancer.lastMigrationMs > 0)
+            text += ", last migration at " + timeText(balancer.lastMigrationMs);
+        text += QString(". Spread between fullest and emptiest shard: %1 chunks.")
+            .arg(ShardDistribution::chunkSpread(_snapshot));
+        _balancerLabel->setText(text);
+    }
+}
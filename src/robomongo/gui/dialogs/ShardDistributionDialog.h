@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QDialog>
+#include <QHash>
+
+#include "robomongo/core/domain/ShardDistribution.h"
+
+QT_BEGIN_NAMESPACE
+class QCheckBox;
+class QLabel;
+class QPushButton;
+class QSpinBox;
+class QTimer;
+class QTreeWidget;
+class QTreeWidgetItem;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class ShardDistributionResponse;
+
+    /**
+     * @brief Chunks, jumbo chunks and data size of sharded collection per shard, with
+     *        migrations and splits of the last day (see ShardDistribution). Rows are updated
+     *        in place on every refresh and show how many chunks each shard gained or lost
+     *        since the previous one; only new changelog entries are read after the first refresh.
+     */
+    class ShardDistributionDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        ShardDistributionDialog(MongoServer *server, const QString &dbName, const QString &collection,
+                                QWidget *parent = 0);
+
+    public Q_SLOTS:
+        void handle(ShardDistributionResponse *event);
+
+    private Q_SLOTS:
+        void refresh();
+        void autoRefreshChanged();
+
+    private:
+        static const int ActivityHours = 24;
+
+        void updateTree();
+        void updateBalancer();
+
+        MongoServer *const _server;
+        QString const _dbName;
+        QString const _collection;
+        int _distributionId;                    // 0, if distribution is not being read
+        long long const _activityFromMs;        // balancer activity is summed from this time
+        long long _sinceMs;                     // changelog is read after this time
+        bool _hasSnapshot;
+        ShardDistribution::Snapshot _snapshot;
+        QHash<QString, long long> _previousChunks;
+        QHash<QString, QTreeWidgetItem *> _shardItems;
+
+        QCheckBox *_autoRefresh;
+        QSpinBox *_interval;
+        QPushButton *_refreshButton;
+        QTimer *_timer;
+        QLabel *_balancerLabel;
+        QTreeWidget *_tree;
+        QLabel *_statusLabel;
+    };
+}
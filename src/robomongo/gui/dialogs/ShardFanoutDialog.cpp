@@ -0,0 +1,171 @@
+#include "robomongo/gui/dialogs/ShardFanoutDialog.h"
+
+#include <stdexcept>
+#include <QCheckBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QSplitter>
+#include <QTreeView>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/gui/widgets/workarea/BsonTreeModel.h"
+#include "robomongo/shell/bson/json.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            ShardColumn, HostColumn, RangesColumn, DocumentsColumn, TimeColumn, ColumnCount
+        };
+
+        mongo::BSONObj parseObject(const QString &text)
+        {
+            QString const trimmed = text.trimmed();
+            return mongo::Robomongo::fromjson(QtUtils::toStdString(trimmed.isEmpty() ? "{}" : trimmed));
+        }
+    }
+
+    ShardFanoutDialog::ShardFanoutDialog(MongoServer *server, const QString &dbName,
+                                         const QString &collectionName, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _collectionName(collectionName),
+        _fanoutId(0)
+    {
+        setWindowTitle("Shard Fan-out " + dbName + "." + collectionName);
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(900, 600);
+
+        AppRegistry::instance().bus()->subscribe(this, ShardFanoutResponse::Type, server);
+
+        _filterEdit = new QLineEdit("{}");
+        _projectionEdit = new QLineEdit("{}");
+        _sortEdit = new QLineEdit("{}");
+        _limitSpin = new QSpinBox;
+        _limitSpin->setRange(1, 100000);
+        _limitSpin->setValue(1000);
+        _secondariesCheckBox = new QCheckBox("Read from secondaries");
+        _runButton = new QPushButton("Run");
+        _runButton->setDefault(true);
+
+        auto queryLayout = new QFormLayout;
+        queryLayout->addRow("Filter:", _filterEdit);
+        queryLayout->addRow("Projection:", _projectionEdit);
+        queryLayout->addRow("Sort:", _sortEdit);
+        queryLayout->addRow("Limit:", _limitSpin);
+        queryLayout->addRow("", _secondariesCheckBox);
+
+        auto commandLayout = new QHBoxLayout;
+        commandLayout->addLayout(queryLayout, 1);
+        commandLayout->addWidget(_runButton, 0, Qt::AlignBottom);
+
+        auto helpLabel = new QLabel(
+            "Read-only find sent to every shard owning chunks of the collection, bypassing mongos. "
+            "Every shard is queried only for key ranges of its chunks, results are merged here. "
+            "Shards are authenticated with credentials of this connection, so the user has to exist "
+            "on shards too. Not available through SSH tunnel.");
+        helpLabel->setWordWrap(true);
+
+        _summaryLabel = new QLabel;
+        _summaryLabel->setWordWrap(true);
+        _summaryLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        _shards = new QTreeWidget;
+        _shards->setColumnCount(ColumnCount);
+        _shards->setHeaderLabels(QStringList() << "Shard" << "Host" << "Ranges" << "Documents" << "ms");
+        _shards->setRootIsDecorated(false);
+        _shards->setUniformRowHeights(true);
+
+        _documents = new QTreeView;
+        _documents->setUniformRowHeights(true);
+
+        auto splitter = new QSplitter(Qt::Vertical);
+        splitter->addWidget(_shards);
+        splitter->addWidget(_documents);
+        splitter->setStretchFactor(1, 1);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_runButton, SIGNAL(clicked()), this, SLOT(run())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(commandLayout);
+        layout->addWidget(helpLabel);
+        layout->addWidget(_summaryLabel);
+        layout->addWidget(splitter, 1);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+    }
+
+    void ShardFanoutDialog::run()
+    {
+        mongo::BSONObj filter, projection, sort;
+        try {
+            filter = parseObject(_filterEdit->text());
+            projection = parseObject(_projectionEdit->text());
+            sort = parseObject(_sortEdit->text());
+        }
+        catch (const std::exception &ex) {
+            _summaryLabel->setText("Invalid JSON: " + QtUtils::toQString(ex.what()));
+            return;
+        }
+
+        static int lastFanoutId = 0;
+        _fanoutId = ++lastFanoutId;
+        _runButton->setEnabled(false);
+        _summaryLabel->setText("Querying shards...");
+        _server->shardFanout(_fanoutId,
+                             MongoNamespace(QtUtils::toStdString(_dbName), QtUtils::toStdString(_collectionName)),
+                             filter, projection, sort, _limitSpin->value(), _secondariesCheckBox->isChecked());
+    }
+
+    void ShardFanoutDialog::handle(ShardFanoutResponse *event)
+    {
+        if (event->fanoutId != _fanoutId)
+            return;
+
+        _fanoutId = 0;
+        _runButton->setEnabled(true);
+        _shards->clear();
+
+        QAbstractItemModel *previous = _documents->model();
+        _documents->setModel(NULL);
+        delete previous;
+
+        if (event->isError()) {
+            _summaryLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        for (ShardFanout::ShardResult const &shard : event->shards) {
+            new QTreeWidgetItem(_shards, QStringList()
+                << QtUtils::toQString(shard.shard) << QtUtils::toQString(shard.host)
+                << QString::number(shard.ranges) << QString::number(shard.documents)
+                << QString::number(shard.elapsedMs));
+        }
+        for (int column = 0; column < ColumnCount; ++column)
+            _shards->resizeColumnToContents(column);
+
+        _documents->setModel(new BsonTreeModel(event->documents, _documents));
+        _documents->header()->resizeSection(0, 250);
+
+        _summaryLabel->setText(QString("%1 documents merged from %2 shards in %3 ms.")
+            .arg(event->documents.size()).arg(event->shards.size()).arg(event->elapsedMs));
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QDialog>
+
+QT_BEGIN_NAMESPACE
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QPushButton;
+class QSpinBox;
+class QTreeView;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class ShardFanoutResponse;
+
+    /**
+     * @brief Runs find on every shard of sharded collection directly (see ShardFanout) and
+     *        shows merged documents together with documents and time of every shard.
+     */
+    class ShardFanoutDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        ShardFanoutDialog(MongoServer *server, const QString &dbName, const QString &collectionName,
+                          QWidget *parent = 0);
+
+    public Q_SLOTS:
+        void handle(ShardFanoutResponse *event);
+
+    private Q_SLOTS:
+        void run();
+
+    private:
+        MongoServer *const _server;
+        QString const _dbName;
+        QString const _collectionName;
+        int _fanoutId;              // 0, if nothing is being queried
+
+        QLineEdit *_filterEdit;
+        QLineEdit *_projectionEdit;
+        QLineEdit *_sortEdit;
+        QSpinBox *_limitSpin;
+        QCheckBox *_secondariesCheckBox;
+        QPushButton *_runButton;
+        QLabel *_summaryLabel;
+        QTreeWidget *_shards;
+        QTreeView *_documents;
+    };
+}
@@ -0,0 +1,233 @@
+#include "robomongo/gui/dialogs/ThrottledWriteDialog.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/shell/bson/json.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        mongo::BSONObj parseObject(const QString &text)
+        {
+            QString const trimmed = text.trimmed();
+            return mongo::Robomongo::fromjson(QtUtils::toStdString(trimmed.isEmpty() ? "{}" : trimmed));
+        }
+
+        QString progressText(const ThrottledWriteProgressEvent::Progress &progress, bool isUpdate)
+        {
+            QString text = QString("%1 documents %2").arg(progress.processed).arg(isUpdate ? "updated" : "removed");
+            if (progress.total >= 0)
+                text += QString(" of %1 matching").arg(progress.total);
+            text += QString(" in %1 chunks, %2 s").arg(progress.chunks).arg(progress.elapsedMs / 1000.0, 0, 'f', 1);
+            text += QString(". Chunk size %1, ").arg(progress.chunkSize);
+            text += progress.lagMs >= 0 ? QString("replication lag %1 s").arg(progress.lagMs / 1000.0, 0, 'f', 1)
+                                        : QString("no secondaries to wait for");
+            if (progress.throttledMs > 0)
+                text += QString(", waited %1 s for secondaries").arg(progress.throttledMs / 1000.0, 0, 'f', 1);
+            if (progress.pausedMs > 0)
+                text += QString(", paused %1 s").arg(progress.pausedMs / 1000.0, 0, 'f', 1);
+            return text + ".";
+        }
+    }
+
+    ThrottledWriteDialog::ThrottledWriteDialog(MongoServer *server, const QString &dbName,
+                                               const QString &collectionName, bool isUpdate, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _collectionName(collectionName),
+        _isUpdate(isUpdate),
+        _updateEdit(nullptr),
+        _writeId(0)
+    {
+        setWindowTitle(QString(isUpdate ? "Update" : "Remove") + " documents of " + dbName + "." + collectionName +
+                       " in batches");
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(640, 260);
+
+        AppRegistry::instance().bus()->subscribe(this, ThrottledWriteProgressEvent::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, ThrottledWriteResponse::Type, server);
+
+        _filterEdit = new QLineEdit("{}");
+        _maxLagSpin = new QSpinBox;
+        _maxLagSpin->setRange(0, 24 * 60 * 60);
+        _maxLagSpin->setValue(ThrottledWriteRequest::DefaultMaxLagMs / 1000);
+        _maxLagSpin->setSuffix(" s");
+        _maxLagSpin->setSpecialValueText("Do not wait for secondaries");
+        _maxLagSpin->setToolTip("Chunks wait while the slowest secondary is behind primary by more than this");
+
+        auto optionsLayout = new QFormLayout;
+        optionsLayout->addRow("Filter:", _filterEdit);
+        if (isUpdate) {
+            _updateEdit = new QLineEdit;
+            _updateEdit->setPlaceholderText("{ $set: { archived: true } }");
+            optionsLayout->addRow("Update:", _updateEdit);
+        }
+        optionsLayout->addRow("Max replication lag:", _maxLagSpin);
+
+        _startButton = new QPushButton(isUpdate ? "Update" : "Remove");
+        _pauseButton = new QPushButton("Pause");
+        _stopButton = new QPushButton("Stop");
+
+        auto commandLayout = new QHBoxLayout;
+        commandLayout->addWidget(_startButton);
+        commandLayout->addWidget(_pauseButton);
+        commandLayout->addWidget(_stopButton);
+        commandLayout->addStretch(1);
+
+        _progressBar = new QProgressBar;
+        _progressBar->setRange(0, 100);
+        _progressBar->setValue(0);
+
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_startButton, SIGNAL(clicked()), this, SLOT(start())));
+        VERIFY(connect(_pauseButton, SIGNAL(clicked()), this, SLOT(pause())));
+        VERIFY(connect(_stopButton, SIGNAL(clicked()), this, SLOT(stop())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(optionsLayout);
+        layout->addLayout(commandLayout);
+        layout->addWidget(_progressBar);
+        layout->addWidget(_statusLabel);
+        layout->addStretch(1);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        updateButtons();
+    }
+
+    ThrottledWriteDialog::~ThrottledWriteDialog()
+    {
+        // Chunks are not written further, once dialog is closed
+        cancel();
+    }
+
+    void ThrottledWriteDialog::cancel()
+    {
+        if (_cancelled)
+            *_cancelled = true;
+        _cancelled.reset();
+        _paused.reset();
+    }
+
+    void ThrottledWriteDialog::updateButtons()
+    {
+        bool const isRunning = _writeId != 0 && _cancelled;
+        _startButton->setEnabled(_writeId == 0);
+        _pauseButton->setEnabled(isRunning);
+        _pauseButton->setText(_paused && *_paused ? "Resume" : "Pause");
+        _stopButton->setEnabled(isRunning);
+    }
+
+    void ThrottledWriteDialog::start()
+    {
+        mongo::BSONObj filter, update;
+        try {
+            filter = parseObject(_filterEdit->text());
+            if (_isUpdate)
+                update = parseObject(_updateEdit->text());
+        }
+        catch (const std::exception &ex) {
+            _statusLabel->setText("Invalid JSON: " + QtUtils::toQString(ex.what()));
+            return;
+        }
+
+        // Chunks run multi-document updates, which take update operators only
+        if (_isUpdate && (update.isEmpty() || update.firstElementFieldName()[0] != '$')) {
+            _statusLabel->setText("Update must consist of update operators, e.g. { $set: { field: value } }.");
+            return;
+        }
+
+        QString const question = QString("%1 all documents of <b>%2</b> matching <b>%3</b>?")
+            .arg(_isUpdate ? "Update" : "Remove")
+            .arg(_collectionName.toHtmlEscaped())
+            .arg(QtUtils::toQString(filter.toString()).toHtmlEscaped());
+        if (QMessageBox::question(this, windowTitle(), question, QMessageBox::Yes, QMessageBox::No) != QMessageBox::Yes)
+            return;
+
+        static int lastWriteId = 0;
+        _writeId = ++lastWriteId;
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+        _paused = std::make_shared<std::atomic<bool>>(false);
+        updateButtons();
+
+        _progressBar->setValue(0);
+        _statusLabel->setText("Counting documents...");
+        _server->throttledWrite(_writeId,
+                                MongoNamespace(QtUtils::toStdString(_dbName), QtUtils::toStdString(_collectionName)),
+                                filter, update, _maxLagSpin->value() * 1000LL, _cancelled, _paused);
+    }
+
+    void ThrottledWriteDialog::pause()
+    {
+        if (!_paused)
+            return;
+
+        *_paused = !*_paused;
+        updateButtons();
+    }
+
+    void ThrottledWriteDialog::stop()
+    {
+        // Response with documents processed so far still comes, once running chunk is done
+        cancel();
+        updateButtons();
+        _statusLabel->setText(_statusLabel->text() + " Stopping...");
+    }
+
+    void ThrottledWriteDialog::handle(ThrottledWriteProgressEvent *event)
+    {
+        if (event->writeId != _writeId)
+            return;
+
+        ThrottledWriteProgressEvent::Progress const &progress = event->progress;
+        if (progress.total > 0)
+            _progressBar->setValue(static_cast<int>(std::min(100LL, progress.processed * 100 / progress.total)));
+        _statusLabel->setText((progress.paused ? "Paused. " : "") + progressText(progress, _isUpdate));
+    }
+
+    void ThrottledWriteDialog::handle(ThrottledWriteResponse *event)
+    {
+        if (event->writeId != _writeId)
+            return;
+
+        bool const stopped = !_cancelled;
+        _writeId = 0;
+        _cancelled.reset();
+        _paused.reset();
+        updateButtons();
+
+        QString const text = progressText(event->progress, _isUpdate);
+        if (event->isError()) {
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()) + "\n" + text);
+            return;
+        }
+
+        if (!stopped)
+            _progressBar->setValue(100);
+        _statusLabel->setText((stopped ? "Stopped. " : "Done. ") + text);
+    }
+}
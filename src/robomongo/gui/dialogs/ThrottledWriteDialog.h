@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QDialog>
+#include <atomic>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QLineEdit;
+class QProgressBar;
+class QPushButton;
+class QSpinBox;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class ThrottledWriteProgressEvent;
+    class ThrottledWriteResponse;
+
+    /**
+     * @brief Removes or updates documents of collection in chunks of _id ranges (see
+     *        ThrottledWrite), so that secondaries stay within given lag. Can be paused,
+     *        resumed and stopped between chunks.
+     */
+    class ThrottledWriteDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * @param isUpdate Updates documents with update operators, removes them otherwise
+         */
+        ThrottledWriteDialog(MongoServer *server, const QString &dbName, const QString &collectionName,
+                             bool isUpdate, QWidget *parent = 0);
+        ~ThrottledWriteDialog();
+
+    public Q_SLOTS:
+        void handle(ThrottledWriteProgressEvent *event);
+        void handle(ThrottledWriteResponse *event);
+
+    private Q_SLOTS:
+        void start();
+        void pause();
+        void stop();
+
+    private:
+        void cancel();
+        void updateButtons();
+
+        MongoServer *const _server;
+        QString const _dbName;
+        QString const _collectionName;
+        bool const _isUpdate;
+
+        QLineEdit *_filterEdit;
+        QLineEdit *_updateEdit;
+        QSpinBox *_maxLagSpin;
+        QPushButton *_startButton;
+        QPushButton *_pauseButton;
+        QPushButton *_stopButton;
+        QProgressBar *_progressBar;
+        QLabel *_statusLabel;
+
+        int _writeId;                                   // 0, if nothing is being written
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+        std::shared_ptr<std::atomic<bool>> _paused;
+    };
+}
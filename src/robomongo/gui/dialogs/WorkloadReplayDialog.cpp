@@ -0,0 +1,381 @@
+#include "robomongo/gui/dialogs/WorkloadReplayDialog.h"
+
+#include <algorithm>
+#include <QColor>
+#include <QComboBox>
+#include <QDateTime>
+#include <QDialogButtonBox>
+#include <QDoubleSpinBox>
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/WorkloadReplay.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    namespace
+    {
+        enum Column
+        {
+            ShapeColumn, CountColumn, ErrorsColumn, P50Column, P95Column, P99Column, MaxColumn,
+            BaselineP50Column, BaselineP95Column, BaselineP99Column, P95ChangeColumn, ColumnCount
+        };
+
+        enum Source
+        {
+            ProfilerSource, LogFileSource
+        };
+
+        const int MaxThreads = 32;
+
+        // Changes of p95 smaller than this are not highlighted, they are within noise of a replay
+        const double SignificantChange = 0.1;
+
+        // Baseline is shared by dialogs of all servers, so that staging can be compared with production
+        struct Baseline
+        {
+            WorkloadReplay::Result result;
+            QString description;
+        };
+
+        std::unique_ptr<Baseline> &baseline()
+        {
+            static std::unique_ptr<Baseline> baseline;
+            return baseline;
+        }
+
+        // Items sort by numbers stored in UserRole, not by display text
+        class ShapeItem : public QTreeWidgetItem
+        {
+        public:
+            explicit ShapeItem(QTreeWidget *parent) : QTreeWidgetItem(parent) {}
+
+            bool operator<(const QTreeWidgetItem &other) const override
+            {
+                int const column = treeWidget()->sortColumn();
+                QVariant const left = data(column, Qt::UserRole);
+                if (!left.isValid())
+                    return QTreeWidgetItem::operator<(other);
+                return left.toDouble() < other.data(column, Qt::UserRole).toDouble();
+            }
+
+            void setNumber(int column, const QString &text, double number)
+            {
+                setText(column, text);
+                setData(column, Qt::UserRole, number);
+                setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+            }
+
+            void setMillis(int column, long long us)
+            {
+                setNumber(column, QString::number(us / 1000.0, 'f', 1), static_cast<double>(us));
+            }
+        };
+
+        QString speedText(double speed)
+        {
+            return speed > 0 ? QString("%1x").arg(speed) : QString("as fast as possible");
+        }
+    }
+
+    WorkloadReplayDialog::WorkloadReplayDialog(MongoServer *server, const QString &dbName, QWidget *parent) :
+        QDialog(parent),
+        _server(server),
+        _dbName(dbName),
+        _replayId(0)
+    {
+        setWindowTitle("Replay workload on " + QtUtils::toQString(server->connectionRecord()->getFullAddress()));
+        setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint); // Remove help button (?)
+        setAttribute(Qt::WA_DeleteOnClose);
+        resize(1100, 600);
+
+        AppRegistry::instance().bus()->subscribe(this, ReplayWorkloadProgressEvent::Type, server);
+        AppRegistry::instance().bus()->subscribe(this, ReplayWorkloadResponse::Type, server);
+
+        _sourceCombo = new QComboBox;
+        _sourceCombo->addItem("Profiler of " + dbName, ProfilerSource);
+        _sourceCombo->addItem("Log file (structured log or exported system.profile)", LogFileSource);
+        _logFileEdit = new QLineEdit;
+        _browseButton = new QPushButton("...");
+        _browseButton->setFixedWidth(30);
+        _lastMinutes = new QSpinBox;
+        _lastMinutes->setRange(0, 7 * 24 * 60);
+        _lastMinutes->setValue(60);
+        _lastMinutes->setSuffix(" min");
+        _lastMinutes->setSpecialValueText("All");
+
+        auto fileLayout = new QHBoxLayout;
+        fileLayout->addWidget(_logFileEdit, 1);
+        fileLayout->addWidget(_browseButton);
+
+        _targetDatabaseEdit = new QLineEdit;
+        _targetDatabaseEdit->setPlaceholderText("As captured");
+        _speedSpin = new QDoubleSpinBox;
+        _speedSpin->setRange(0, 1000);
+        _speedSpin->setDecimals(1);
+        _speedSpin->setValue(1);
+        _speedSpin->setSuffix("x");
+        _speedSpin->setSpecialValueText("As fast as possible");
+        _speedSpin->setToolTip("Multiple of captured rate: operations keep their spacing in time divided by it");
+        _threadsSpin = new QSpinBox;
+        _threadsSpin->setRange(1, MaxThreads);
+        _threadsSpin->setValue(ReplayWorkloadRequest::DefaultThreads);
+        _threadsSpin->setToolTip("Connections running operations in parallel");
+
+        auto optionsLayout = new QFormLayout;
+        optionsLayout->addRow("Source:", _sourceCombo);
+        optionsLayout->addRow("Log file:", fileLayout);
+        optionsLayout->addRow("Last:", _lastMinutes);
+        optionsLayout->addRow("Target database:", _targetDatabaseEdit);
+        optionsLayout->addRow("Speed:", _speedSpin);
+        optionsLayout->addRow("Threads:", _threadsSpin);
+
+        _startButton = new QPushButton("Replay");
+        _startButton->setDefault(true);
+        _stopButton = new QPushButton("Stop");
+        _baselineButton = new QPushButton("Keep as Baseline");
+        _baselineButton->setToolTip("Next runs, also on other servers, are compared with this one");
+
+        auto commandLayout = new QHBoxLayout;
+        commandLayout->addWidget(_startButton);
+        commandLayout->addWidget(_stopButton);
+        commandLayout->addWidget(_baselineButton);
+        commandLayout->addStretch(1);
+
+        _tree = new QTreeWidget;
+        _tree->setColumnCount(ColumnCount);
+        _tree->setHeaderLabels(QStringList() << "Shape" << "Count" << "Errors" << "p50 ms" << "p95 ms" << "p99 ms"
+                                             << "Max ms" << "Baseline p50" << "Baseline p95" << "Baseline p99"
+                                             << "p95 change");
+        _tree->setRootIsDecorated(false);
+        _tree->setUniformRowHeights(true);
+        _tree->setSortingEnabled(true);
+        _tree->header()->setStretchLastSection(false);
+
+        _baselineLabel = new QLabel;
+        _baselineLabel->setWordWrap(true);
+        _statusLabel = new QLabel;
+        _statusLabel->setWordWrap(true);
+        _statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, this);
+        VERIFY(connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject())));
+        VERIFY(connect(_startButton, SIGNAL(clicked()), this, SLOT(start())));
+        VERIFY(connect(_stopButton, SIGNAL(clicked()), this, SLOT(stop())));
+        VERIFY(connect(_baselineButton, SIGNAL(clicked()), this, SLOT(keepAsBaseline())));
+        VERIFY(connect(_browseButton, SIGNAL(clicked()), this, SLOT(browse())));
+        VERIFY(connect(_sourceCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(updateSource())));
+
+        auto layout = new QVBoxLayout;
+        layout->addLayout(optionsLayout);
+        layout->addLayout(commandLayout);
+        layout->addWidget(_tree, 1);
+        layout->addWidget(_baselineLabel);
+        layout->addWidget(_statusLabel);
+        layout->addWidget(buttonBox);
+        setLayout(layout);
+
+        updateSource();
+        updateButtons();
+        showResult();
+    }
+
+    WorkloadReplayDialog::~WorkloadReplayDialog()
+    {
+        // Operations are not replayed further, once dialog is closed
+        cancel();
+    }
+
+    void WorkloadReplayDialog::cancel()
+    {
+        if (_cancelled)
+            *_cancelled = true;
+        _cancelled.reset();
+    }
+
+    void WorkloadReplayDialog::updateSource()
+    {
+        bool const isLogFile = _sourceCombo->currentData().toInt() == LogFileSource;
+        _logFileEdit->setEnabled(isLogFile);
+        _browseButton->setEnabled(isLogFile);
+        _lastMinutes->setEnabled(!isLogFile);
+    }
+
+    void WorkloadReplayDialog::updateButtons()
+    {
+        _startButton->setEnabled(_replayId == 0);
+        _stopButton->setEnabled(_replayId != 0 && _cancelled);
+        _baselineButton->setEnabled(_replayId == 0 && _result);
+    }
+
+    void WorkloadReplayDialog::browse()
+    {
+        QString const path = QFileDialog::getOpenFileName(this, "Open log file", _logFileEdit->text(),
+                                                          "Log files (*.log *.json);;All files (*)");
+        if (!path.isEmpty())
+            _logFileEdit->setText(path);
+    }
+
+    void WorkloadReplayDialog::start()
+    {
+        bool const isLogFile = _sourceCombo->currentData().toInt() == LogFileSource;
+        QString const logFile = _logFileEdit->text().trimmed();
+        if (isLogFile && logFile.isEmpty()) {
+            _statusLabel->setText("Choose log file to replay.");
+            return;
+        }
+
+        long long const sinceMs = _lastMinutes->value() > 0 ?
+            QDateTime::currentMSecsSinceEpoch() - _lastMinutes->value() * 60LL * 1000 : 0;
+
+        static int lastReplayId = 0;
+        _replayId = ++lastReplayId;
+        _cancelled = std::make_shared<std::atomic<bool>>(false);
+        updateButtons();
+
+        _statusLabel->setText("Reading captured operations...");
+        _server->replayWorkload(_replayId, QtUtils::toStdString(_dbName),
+                                isLogFile ? QtUtils::toStdString(logFile) : std::string(), isLogFile ? 0 : sinceMs,
+                                QtUtils::toStdString(_targetDatabaseEdit->text().trimmed()), _speedSpin->value(),
+                                _threadsSpin->value(), _cancelled);
+    }
+
+    void WorkloadReplayDialog::stop()
+    {
+        // Response with operations replayed so far still comes, once running ones are done
+        cancel();
+        updateButtons();
+        _statusLabel->setText(_statusLabel->text() + " Stopping...");
+    }
+
+    void WorkloadReplayDialog::keepAsBaseline()
+    {
+        if (!_result)
+            return;
+
+        baseline().reset(new Baseline{ *_result, QString("%1 operations at %2 on %3, %4")
+            .arg(_result->operations)
+            .arg(speedText(_result->speed))
+            .arg(QtUtils::toQString(_server->connectionRecord()->getFullAddress()))
+            .arg(QDateTime::currentDateTime().toString("HH:mm:ss")) });
+        showResult();
+    }
+
+    void WorkloadReplayDialog::handle(ReplayWorkloadProgressEvent *event)
+    {
+        if (event->replayId != _replayId)
+            return;
+
+        double const seconds = event->elapsedMs / 1000.0;
+        _statusLabel->setText(QString("Replayed %1 of %2 operations (%3 errors) in %4 s, %5 operations/s.")
+            .arg(event->replayed)
+            .arg(event->total)
+            .arg(event->errors)
+            .arg(seconds, 0, 'f', 1)
+            .arg(seconds > 0 ? event->replayed / seconds : 0, 0, 'f', 0));
+    }
+
+    void WorkloadReplayDialog::handle(ReplayWorkloadResponse *event)
+    {
+        if (event->replayId != _replayId)
+            return;
+
+        bool const stopped = !_cancelled;
+        _replayId = 0;
+        _cancelled.reset();
+
+        if (event->isError()) {
+            updateButtons();
+            _statusLabel->setText(QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        _result.reset(new WorkloadReplay::Result(event->result));
+        updateButtons();
+        showResult();
+
+        WorkloadReplay::Result const &result = *_result;
+        QString status = QString("%1 %2 operations at %3 in %4 s, %5 errors, %6 captured entries not replayable.")
+            .arg(stopped ? "Stopped after" : "Replayed")
+            .arg(result.operations)
+            .arg(speedText(result.speed))
+            .arg(result.elapsedMs / 1000.0, 0, 'f', 1)
+            .arg(result.errors)
+            .arg(result.skipped);
+        if (!result.firstError.empty())
+            status += " First error: " + QtUtils::toQString(result.firstError);
+        _statusLabel->setText(status);
+    }
+
+    void WorkloadReplayDialog::showResult()
+    {
+        Baseline const *const base = baseline().get();
+        _baselineLabel->setText(base ? "Baseline: " + base->description :
+                                       "No baseline, keep a run as baseline to compare the next ones with it.");
+
+        _tree->setSortingEnabled(false);
+        _tree->clear();
+
+        WorkloadReplay::Result const empty;
+        WorkloadReplay::Result const &current = _result ? *_result : empty;
+        for (WorkloadReplay::ShapeComparison const &shape :
+             WorkloadReplay::compare(base ? base->result : empty, current)) {
+            if (!base && !shape.current)
+                continue;
+
+            auto item = new ShapeItem(_tree);
+            item->setText(ShapeColumn, QtUtils::toQString(shape.shape));
+            item->setToolTip(ShapeColumn, QtUtils::toQString(shape.shape));
+
+            if (shape.current) {
+                LatencyHistogram const &latency = shape.current->latency;
+                item->setNumber(CountColumn, QString::number(latency.count()), static_cast<double>(latency.count()));
+                item->setNumber(ErrorsColumn, QString::number(shape.current->errors),
+                                static_cast<double>(shape.current->errors));
+                item->setMillis(P50Column, latency.percentileUs(50));
+                item->setMillis(P95Column, latency.percentileUs(95));
+                item->setMillis(P99Column, latency.percentileUs(99));
+                item->setMillis(MaxColumn, latency.maxUs());
+            }
+
+            if (shape.baseline) {
+                LatencyHistogram const &latency = shape.baseline->latency;
+                item->setMillis(BaselineP50Column, latency.percentileUs(50));
+                item->setMillis(BaselineP95Column, latency.percentileUs(95));
+                item->setMillis(BaselineP99Column, latency.percentileUs(99));
+            }
+
+            if (shape.current && shape.baseline && shape.baseline->latency.count() > 0 &&
+                shape.current->latency.count() > 0) {
+                double const change = WorkloadReplay::change(shape.baseline->latency.percentileUs(95),
+                                                             shape.current->latency.percentileUs(95));
+                item->setNumber(P95ChangeColumn, QString("%1%2%").arg(change > 0 ? "+" : "")
+                                                                 .arg(change * 100, 0, 'f', 0), change);
+                if (change > SignificantChange)
+                    item->setForeground(P95ChangeColumn, QColor("#c62828"));
+                else if (change < -SignificantChange)
+                    item->setForeground(P95ChangeColumn, QColor("#2e7d32"));
+            }
+        }
+
+        _tree->setSortingEnabled(true);
+        _tree->sortByColumn(P95Column, Qt::DescendingOrder);
+        for (int column = 0; column < ColumnCount; ++column)
+            _tree->resizeColumnToContents(column);
+        _tree->setColumnWidth(ShapeColumn, std::min(_tree->columnWidth(ShapeColumn), 500));
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QDialog>
+#include <atomic>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+class QDoubleSpinBox;
+class QLabel;
+class QLineEdit;
+class QPushButton;
+class QSpinBox;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class MongoServer;
+    class ReplayWorkloadProgressEvent;
+    class ReplayWorkloadResponse;
+
+    namespace WorkloadReplay
+    {
+        struct Result;
+    }
+
+    /**
+     * @brief Replays find, aggregate and count operations captured in profiler of database or
+     *        in log file (see WorkloadReplay) on this server, and shows latency percentiles per
+     *        query shape. Result of a run can be kept as baseline, which the next runs (also
+     *        of other servers, e.g. staging after index change) are compared with.
+     */
+    class WorkloadReplayDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        WorkloadReplayDialog(MongoServer *server, const QString &dbName, QWidget *parent = 0);
+        ~WorkloadReplayDialog();
+
+    public Q_SLOTS:
+        void handle(ReplayWorkloadProgressEvent *event);
+        void handle(ReplayWorkloadResponse *event);
+
+    private Q_SLOTS:
+        void start();
+        void stop();
+        void browse();
+        void keepAsBaseline();
+        void updateSource();
+
+    private:
+        void cancel();
+        void updateButtons();
+        void showResult();
+
+        MongoServer *const _server;
+        QString const _dbName;
+
+        QComboBox *_sourceCombo;
+        QLineEdit *_logFileEdit;
+        QPushButton *_browseButton;
+        QSpinBox *_lastMinutes;
+        QLineEdit *_targetDatabaseEdit;
+        QDoubleSpinBox *_speedSpin;
+        QSpinBox *_threadsSpin;
+        QPushButton *_startButton;
+        QPushButton *_stopButton;
+        QPushButton *_baselineButton;
+        QTreeWidget *_tree;
+        QLabel *_baselineLabel;
+        QLabel *_statusLabel;
+
+        int _replayId;                                  // 0, if nothing is being replayed
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+        std::unique_ptr<WorkloadReplay::Result> _result;
+    };
+}
@@ -9,12 +9,27 @@
 #include <Qsci/qsciscintilla.h>
 #include <QMessageBox>
 #include <QKeyEvent>
+#include <QLabel>
+#include <QComboBox>
+#include <QTimer>
+#include <algorithm>
 
 #include "robomongo/gui/editors/PlainJavaScriptEditor.h"
+#include "robomongo/gui/editors/TextSearchThread.h"
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/core/KeyboardManager.h"
 #include "robomongo/gui/widgets/workarea/ScriptWidget.h"
 
+namespace
+{
+    // Pause in typing, after which matches are searched
+    const int searchDelayMs = 150;
+
+    // Matches listed in jump list and length of their previews
+    const int maxListedMatches = 1000;
+    const int maxPreviewLength = 60;
+}
+
 namespace Robomongo
 {
     FindFrame::FindFrame(QWidget *parent) : 
@@ -27,6 +42,12 @@ namespace Robomongo
         _next(new QPushButton("Next", this)),
         _prev(new QPushButton("Previous", this)),
         _caseSensitive(new QCheckBox("Match case", this)),
+        _matchCount(new QLabel(this)),
+        _matchList(new QComboBox(this)),
+        _searchTimer(new QTimer(this)),
+        _searchThread(NULL),
+        _matchTotal(0),
+        _matchesValid(false),
         _commentSign("// "),
         _commentSignLength(3)
     {
@@ -37,6 +58,14 @@ namespace Robomongo
 
         _findLine->setAlignment(Qt::AlignLeft | Qt::AlignAbsolute);
 
+        _matchList->setSizeAdjustPolicy(QComboBox::AdjustToMinimumContentsLengthWithIcon);
+        _matchList->setMinimumContentsLength(20);
+        _matchList->setToolTip("Jump to match");
+        _matchList->hide();
+
+        _searchTimer->setSingleShot(true);
+        _searchTimer->setInterval(searchDelayMs);
+
         QHBoxLayout *layout = new QHBoxLayout();
         layout->setContentsMargins(2, 0, 6, 0);
         layout->setSpacing(7);
@@ -44,6 +73,8 @@ namespace Robomongo
         layout->addWidget(_next);
         layout->addWidget(_prev);
         layout->addWidget(_caseSensitive);
+        layout->addWidget(_matchCount);
+        layout->addWidget(_matchList);
 
         _findPanel->setFixedHeight(HeightFindPanel);
         _findPanel->setLayout(layout);
@@ -60,6 +91,11 @@ namespace Robomongo
         VERIFY(connect(_close, SIGNAL(clicked()), _findPanel, SLOT(hide())));
         VERIFY(connect(_next, SIGNAL(clicked()), this, SLOT(goToNextElement())));
         VERIFY(connect(_prev, SIGNAL(clicked()), this, SLOT(goToPrevElement())));
+        VERIFY(connect(_findLine, SIGNAL(textChanged(const QString&)), this, SLOT(scheduleSearch())));
+        VERIFY(connect(_caseSensitive, SIGNAL(stateChanged(int)), this, SLOT(scheduleSearch())));
+        VERIFY(connect(_searchTimer, SIGNAL(timeout()), this, SLOT(startSearch())));
+        VERIFY(connect(_scin, SIGNAL(textChanged()), this, SLOT(textModified())));
+        VERIFY(connect(_matchList, SIGNAL(activated(int)), this, SLOT(jumpToListedMatch(int))));
     }
 
     void FindFrame::wheelEvent(QWheelEvent *e)
@@ -108,27 +144,184 @@ namespace Robomongo
     void FindFrame::findElement(bool forward)
     {
         const QString &text = _findLine->text();
-        if (!text.isEmpty()) {
-            bool re = false;
-            bool wo = false;
-            bool looped = true;
-            int index = 0;
-            int line = 0;
-            _scin->getCursorPosition(&line, &index);
-
-            if (!forward)
-               index -= _scin->selectedText().length();
-
-            _scin->setCursorPosition(line, 0);
-            bool isFounded = _scin->findFirst(text, re, _caseSensitive->checkState() == Qt::Checked, wo, looped, forward, line, index);
-
-            if (isFounded) {
-                _scin->ensureCursorVisible(); 
-            }
-            else {
+        if (text.isEmpty())
+            return;
+
+        // Matches of background search, unless it is not finished yet
+        if (_matchesValid && _matchesNeedle == QtUtils::toStdString(text)) {
+            if (_matches.empty()) {
                 QMessageBox::warning(this, tr("Search"), tr("The specified text was not found."));
-            }            
+                return;
+            }
+
+            size_t const selectionStart = _scin->SendScintilla(QsciScintilla::SCI_GETSELECTIONSTART);
+            size_t const selectionEnd = _scin->SendScintilla(QsciScintilla::SCI_GETSELECTIONEND);
+            if (forward) {
+                auto const next = std::lower_bound(_matches.begin(), _matches.end(), selectionEnd);
+                // Offsets of matches after the last kept one are unknown, Scintilla finds them
+                bool const isBeyondKept = next == _matches.end() && _matchTotal > _matches.size();
+                if (!isBeyondKept) {
+                    selectMatch(next == _matches.end() ? 0 : next - _matches.begin());
+                    return;
+                }
+            } else {
+                auto const next = std::lower_bound(_matches.begin(), _matches.end(), selectionStart);
+                selectMatch(next == _matches.begin() ? _matches.size() - 1 : next - _matches.begin() - 1);
+                return;
+            }
         }
+
+        bool re = false;
+        bool wo = false;
+        bool looped = true;
+        int index = 0;
+        int line = 0;
+        _scin->getCursorPosition(&line, &index);
+
+        if (!forward)
+           index -= _scin->selectedText().length();
+
+        _scin->setCursorPosition(line, 0);
+        bool isFounded = _scin->findFirst(text, re, _caseSensitive->checkState() == Qt::Checked, wo, looped, forward, line, index);
+
+        if (isFounded) {
+            _scin->ensureCursorVisible(); 
+        }
+        else {
+            QMessageBox::warning(this, tr("Search"), tr("The specified text was not found."));
+        }            
+    }
+
+    void FindFrame::scheduleSearch()
+    {
+        stopSearch();
+        _matchesValid = false;
+        _searchTimer->stop();
+
+        if (_findLine->text().isEmpty()) {
+            _matches.clear();
+            _matchTotal = 0;
+            _matchCount->clear();
+            _matchList->clear();
+            _matchList->hide();
+            return;
+        }
+
+        _searchTimer->start();
+    }
+
+    void FindFrame::startSearch()
+    {
+        const std::string needle = QtUtils::toStdString(_findLine->text());
+        if (needle.empty())
+            return;
+
+        // Document is UTF-8, so byte offsets of snapshot are Scintilla positions
+        if (!_snapshot) {
+            const char *data = static_cast<const char *>(
+                _scin->SendScintillaPtrResult(QsciScintilla::SCI_GETCHARACTERPOINTER));
+            long const length = _scin->SendScintilla(QsciScintilla::SCI_GETLENGTH);
+            _snapshot = std::make_shared<const std::string>(data && length > 0 ? std::string(data, length) : std::string());
+        }
+
+        stopSearch();
+        _matchCount->setText(tr("Searching..."));
+        _searchThread = new TextSearchThread(_snapshot, needle, _caseSensitive->checkState() == Qt::Checked);
+        VERIFY(connect(_searchThread, SIGNAL(searchDone()), this, SLOT(searchDone())));
+        VERIFY(connect(_searchThread, SIGNAL(finished()), _searchThread, SLOT(deleteLater())));
+        _searchThread->start();
+    }
+
+    void FindFrame::stopSearch()
+    {
+        if (!_searchThread)
+            return;
+
+        // Thread deletes itself when finished
+        _searchThread->stop();
+        _searchThread = NULL;
+    }
+
+    void FindFrame::searchDone()
+    {
+        TextSearchThread *thread = qobject_cast<TextSearchThread *>(sender());
+        if (!thread || thread != _searchThread)
+            return;
+
+        _searchThread = NULL;
+        _matches = thread->offsets();
+        _matchTotal = thread->total();
+        _matchesNeedle = thread->needle();
+        _matchesValid = true;
+
+        updateMatchList();
+        updateMatchCount(_matches.size());
+    }
+
+    void FindFrame::textModified()
+    {
+        _snapshot.reset();
+        if (_findPanel->isVisible() && !_findLine->text().isEmpty())
+            scheduleSearch();
+    }
+
+    void FindFrame::jumpToListedMatch(int index)
+    {
+        if (!_matchesValid || index < 0)
+            return;
+
+        size_t const match = _matchList->itemData(index).toULongLong();
+        if (match < _matches.size())
+            selectMatch(match);
+    }
+
+    void FindFrame::selectMatch(size_t index)
+    {
+        size_t const start = _matches[index];
+        _scin->SendScintilla(QsciScintilla::SCI_SETSEL, static_cast<unsigned long>(start),
+                             static_cast<long>(start + _matchesNeedle.size()));
+        _scin->ensureCursorVisible();
+        updateMatchCount(index);
+
+        if (index < static_cast<size_t>(_matchList->count())) {
+            _matchList->blockSignals(true);
+            _matchList->setCurrentIndex(index);
+            _matchList->blockSignals(false);
+        }
+    }
+
+    void FindFrame::updateMatchCount(size_t current)
+    {
+        if (_matchTotal == 0) {
+            _matchCount->setText(tr("No matches"));
+            return;
+        }
+
+        QString const total = QString::number(_matchTotal);
+        if (current < _matches.size())
+            _matchCount->setText(tr("%1 of %2").arg(current + 1).arg(total));
+        else
+            _matchCount->setText(_matchTotal == 1 ? tr("1 match") : tr("%1 matches").arg(total));
+    }
+
+    void FindFrame::updateMatchList()
+    {
+        _matchList->blockSignals(true);
+        _matchList->clear();
+
+        size_t const listed = std::min(_matches.size(), static_cast<size_t>(maxListedMatches));
+        for (size_t i = 0; i < listed; ++i) {
+            int const line = _scin->SendScintilla(QsciScintilla::SCI_LINEFROMPOSITION,
+                                                    static_cast<unsigned long>(_matches[i]));
+            QString preview = _scin->text(line).trimmed();
+            if (preview.length() > maxPreviewLength)
+                preview = preview.left(maxPreviewLength) + "...";
+            _matchList->addItem(tr("Line %1: %2").arg(line + 1).arg(preview), QVariant::fromValue<qulonglong>(i));
+        }
+
+        _matchList->setCurrentIndex(-1);
+        _matchList->setVisible(listed > 0);
+        _matchList->blockSignals(false);
     }
     
     void FindFrame::toggleComments()
@@ -206,6 +399,7 @@ namespace Robomongo
 
     FindFrame::~FindFrame()
     {
+        stopSearch();
         delete _scin;
     }
 }
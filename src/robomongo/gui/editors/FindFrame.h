@@ -1,6 +1,9 @@
 #pragma once
 
 #include <QFrame>
+#include <memory>
+#include <string>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 class QTextEdit;
@@ -8,12 +11,16 @@ class QPushButton;
 class QToolButton;
 class QCheckBox;
 class QLineEdit;
+class QLabel;
+class QComboBox;
+class QTimer;
 QT_END_NAMESPACE
 class QsciScintilla;
 
 namespace Robomongo
 {
     class RoboScintilla;
+    class TextSearchThread;
 
     class FindFrame : public QFrame
     {
@@ -39,8 +46,21 @@ namespace Robomongo
         void goToNextElement();
         void goToPrevElement();
 
+        // Matches are searched in background once typing pauses, see TextSearchThread
+        void scheduleSearch();
+        void startSearch();
+        void searchDone();
+        void textModified();
+        void jumpToListedMatch(int index);
+
     private:
         void findElement(bool forward);
+
+        // Stops running search, its result is ignored
+        void stopSearch();
+        void selectMatch(size_t index);
+        void updateMatchCount(size_t current);
+        void updateMatchList();
         void setLineComment(const int lineIndex, const bool commentOut);
         RoboScintilla *const _scin;
         QFrame *const _findPanel;
@@ -49,6 +69,15 @@ namespace Robomongo
         QPushButton *const _next;
         QPushButton *const _prev;
         QCheckBox *const  _caseSensitive;
+        QLabel *const _matchCount;
+        QComboBox *const _matchList;    // jump list of the first matches
+        QTimer *const _searchTimer;
+        TextSearchThread *_searchThread;
+        std::shared_ptr<const std::string> _snapshot;   // UTF-8 text, null if modified since
+        std::vector<size_t> _matches;   // offsets of matches of _matchesNeedle
+        size_t _matchTotal;             // may be greater than _matches.size()
+        std::string _matchesNeedle;
+        bool _matchesValid;             // false, if text, needle or case changed since search
         const char *_commentSign;
         const int _commentSignLength;
         QWidget *_parent;
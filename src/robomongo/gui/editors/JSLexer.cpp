@@ -9,12 +9,22 @@ namespace Robomongo
     }
 
     QColor JSLexer::defaultPaper(int style) const
+    {
+        return paperColor();
+    }
+
+    QColor JSLexer::defaultColor(int style) const
+    {
+        return styleColor(style);
+    }
+
+    QColor JSLexer::paperColor()
     {
         return QColor(73, 76, 78);
         //return QColor(48, 10, 36); // Ubuntu-style background
     }
 
-    QColor JSLexer::defaultColor(int style) const
+    QColor JSLexer::styleColor(int style)
     {
         switch (style)
         {
@@ -111,16 +121,21 @@ namespace Robomongo
     const char *JSLexer::keywords(int set) const
     {
         if (set == 1)
-            return
-                "abstract boolean break byte case catch char class const continue "
-                "debugger default delete do double else enum export extends final "
-                "finally float for function goto if implements import in instanceof "
-                "int interface long native new package private protected public "
-                "return short static super switch synchronized this throw throws "
-                "transient try typeof var void volatile while with "
-                "ISODate ObjectId Mongo Date NumberInt Number NumberLong Timestamp _id null false true "
-                "UUID LUUID PYUUID CSUUID JUUID NUUID ";
+            return keywordsList();
 
         return 0;
     }
+
+    const char *JSLexer::keywordsList()
+    {
+        return
+            "abstract boolean break byte case catch char class const continue "
+            "debugger default delete do double else enum export extends final "
+            "finally float for function goto if implements import in instanceof "
+            "int interface long native new package private protected public "
+            "return short static super switch synchronized this throw throws "
+            "transient try typeof var void volatile while with "
+            "ISODate ObjectId Mongo Date NumberInt Number NumberLong Timestamp _id null false true "
+            "UUID LUUID PYUUID CSUUID JUUID NUUID ";
+    }
 }
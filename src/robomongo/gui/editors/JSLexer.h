@@ -18,5 +18,16 @@ namespace Robomongo
         QColor defaultPaper(int style) const;
         QColor defaultColor(int style) const;
         const char *keywords(int set) const;
+
+        /**
+         * @brief Colors of QsciLexerJavaScript styles, shared with JsonLexer
+         */
+        static QColor paperColor();
+        static QColor styleColor(int style);
+
+        /**
+         * @brief Space separated keywords and shell types (ObjectId, ISODate, ...)
+         */
+        static const char *keywordsList();
     };
 }
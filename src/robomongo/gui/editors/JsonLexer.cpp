@@ -0,0 +1,162 @@
+#include "robomongo/gui/editors/JsonLexer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <vector>
+
+#include <Qsci/qsciscintilla.h>
+#include <Qsci/qscilexerjavascript.h>
+
+#include "robomongo/gui/editors/JSLexer.h"
+
+namespace
+{
+    bool isIdentifierStart(char c)
+    {
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+    }
+
+    bool isIdentifierChar(char c)
+    {
+        return isIdentifierStart(c) || std::isdigit(static_cast<unsigned char>(c));
+    }
+
+    bool isOperator(char c)
+    {
+        switch (c) {
+        case '{': case '}': case '[': case ']': case '(': case ')': case ':': case ',': case ';':
+        case '.': case '=': case '+': case '-': case '*': case '/': case '%': case '<': case '>':
+        case '!': case '&': case '|': case '?': case '^': case '~':
+            return true;
+        }
+        return false;
+    }
+}
+
+namespace Robomongo
+{
+    JsonLexer::JsonLexer(QObject *parent) : QsciLexerCustom(parent)
+    {
+        for (QByteArray const &word : QByteArray(JSLexer::keywordsList()).split(' ')) {
+            if (!word.isEmpty())
+                _keywords.insert(word);
+        }
+    }
+
+    const char *JsonLexer::language() const
+    {
+        return "JSON";
+    }
+
+    QString JsonLexer::description(int style) const
+    {
+        switch (style) {
+        case Default: return "Default";
+        case LineComment: return "Line comment";
+        case BlockComment: return "Comment";
+        case Number: return "Number";
+        case Keyword: return "Keyword";
+        case String: return "String";
+        case Operator: return "Operator";
+        }
+        return QString();
+    }
+
+    QColor JsonLexer::defaultColor(int style) const
+    {
+        switch (style) {
+        case LineComment: return JSLexer::styleColor(QsciLexerJavaScript::CommentLine);
+        case BlockComment: return JSLexer::styleColor(QsciLexerJavaScript::Comment);
+        case Number: return JSLexer::styleColor(QsciLexerJavaScript::Number);
+        case Keyword: return JSLexer::styleColor(QsciLexerJavaScript::Keyword);
+        case String: return JSLexer::styleColor(QsciLexerJavaScript::DoubleQuotedString);
+        case Operator: return JSLexer::styleColor(QsciLexerJavaScript::Operator);
+        }
+        return JSLexer::styleColor(QsciLexerJavaScript::Default);
+    }
+
+    QColor JsonLexer::defaultPaper(int style) const
+    {
+        return JSLexer::paperColor();
+    }
+
+    void JsonLexer::styleText(int start, int end)
+    {
+        if (!editor() || end <= start)
+            return;
+
+        std::vector<char> text(end - start + 1);
+        editor()->SendScintilla(QsciScintillaBase::SCI_GETTEXTRANGE, start, end, text.data());
+
+        // Range starts at line start, only block comments continue from previous line
+        int state = Default;
+        if (start > 0 && editor()->SendScintilla(QsciScintillaBase::SCI_GETSTYLEAT,
+                                                 static_cast<unsigned long>(start - 1)) == BlockComment)
+            state = BlockComment;
+
+        startStyling(start);
+        int const size = end - start;
+        int i = 0;
+        while (i < size) {
+            int const begin = i;
+            char const c = text[i];
+            int style = Default;
+
+            if (state == BlockComment || (c == '/' && i + 1 < size && text[i + 1] == '*')) {
+                if (state != BlockComment) {
+                    i += 2;
+                    state = BlockComment;
+                }
+                while (i < size && !(text[i] == '*' && i + 1 < size && text[i + 1] == '/'))
+                    ++i;
+                if (i < size) {
+                    i += 2;
+                    state = Default;
+                }
+                style = BlockComment;
+            }
+            else if (c == '"' || c == '\'') {
+                // Strings of JSON output are single line, unterminated one ends at line end
+                ++i;
+                while (i < size && text[i] != c && text[i] != '\n') {
+                    if (text[i] == '\\')
+                        ++i;
+                    ++i;
+                }
+                if (i < size && text[i] == c)
+                    ++i;
+                style = String;
+            }
+            else if (c == '/' && i + 1 < size && text[i + 1] == '/') {
+                while (i < size && text[i] != '\n')
+                    ++i;
+                style = LineComment;
+            }
+            else if (std::isdigit(static_cast<unsigned char>(c))) {
+                ++i;
+                while (i < size && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '.' ||
+                       ((text[i] == '+' || text[i] == '-') && (text[i - 1] == 'e' || text[i - 1] == 'E'))))
+                    ++i;
+                style = Number;
+            }
+            else if (isIdentifierStart(c)) {
+                while (i < size && isIdentifierChar(text[i]))
+                    ++i;
+                style = _keywords.contains(QByteArray::fromRawData(&text[begin], i - begin)) ? Keyword : Default;
+            }
+            else if (isOperator(c)) {
+                while (i < size && isOperator(text[i]) && !(text[i] == '/' && i + 1 < size && 
+                       (text[i + 1] == '/' || text[i + 1] == '*')))
+                    ++i;
+                style = Operator;
+            }
+            else {
+                while (i < size && !isOperator(text[i]) && !isIdentifierChar(text[i]) && 
+                       text[i] != '"' && text[i] != '\'')
+                    ++i;
+            }
+
+            setStyling(std::min(i, size) - begin, style);
+        }
+    }
+}
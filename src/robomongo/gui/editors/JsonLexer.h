@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QColor>
+#include <QSet>
+#include <QByteArray>
+#include <Qsci/qscilexercustom.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Quick lexer for JSON shown in output panes, and for scripts too large for JSLexer.
+     *        Styles only the range Scintilla asks for (text being painted), with a few styles:
+     *        strings, numbers, keywords and shell types, operators and JavaScript comments.
+     *        Colors are those of JSLexer.
+     */
+    class JsonLexer : public QsciLexerCustom
+    {
+        Q_OBJECT
+
+    public:
+        enum Style
+        {
+            Default = 0,
+            LineComment = 1,
+            BlockComment = 2,
+            Number = 3,
+            Keyword = 4,
+            String = 5,
+            Operator = 6
+        };
+
+        JsonLexer(QObject *parent = 0);
+
+        const char *language() const;
+        QString description(int style) const;
+        QColor defaultColor(int style) const;
+        QColor defaultPaper(int style) const;
+
+        void styleText(int start, int end);
+
+    private:
+        QSet<QByteArray> _keywords;
+    };
+}
@@ -0,0 +1,29 @@
+#include "robomongo/gui/editors/TextSearchThread.h"
+
+#include "robomongo/core/utils/TextSearch.h"
+
+namespace Robomongo
+{
+    TextSearchThread::TextSearchThread(const std::shared_ptr<const std::string> &text, const std::string &needle,
+                                       bool caseSensitive) :
+        _text(text),
+        _needle(needle),
+        _caseSensitive(caseSensitive),
+        _total(0),
+        _stop(false)
+    {
+    }
+
+    void TextSearchThread::stop()
+    {
+        _stop = true;
+    }
+
+    void TextSearchThread::run()
+    {
+        _total = TextSearch::findAll(_text->data(), _text->size(), _needle, _caseSensitive,
+                                     _offsets, MaxOffsets, &_stop);
+        if (!_stop)
+            emit searchDone();
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Robomongo
+{
+    /**
+     * @brief Finds all matches of text in snapshot of editor buffer (UTF-8, so offsets are
+     *        Scintilla positions), off the GUI thread. Results are read after searchDone().
+     */
+    class TextSearchThread : public QThread
+    {
+        Q_OBJECT
+
+    public:
+        // Matches beyond this are counted, but their offsets are not kept
+        enum { MaxOffsets = 100000 };
+
+        TextSearchThread(const std::shared_ptr<const std::string> &text, const std::string &needle,
+                         bool caseSensitive);
+        void stop();
+
+        const std::string &needle() const { return _needle; }
+        bool caseSensitive() const { return _caseSensitive; }
+        const std::vector<size_t> &offsets() const { return _offsets; }
+        size_t total() const { return _total; }
+
+    Q_SIGNALS:
+        /**
+         * @brief Signals when search completed, not emitted if stopped
+         */
+        void searchDone();
+
+    protected:
+        virtual void run();
+
+    private:
+        const std::shared_ptr<const std::string> _text;
+        const std::string _needle;
+        const bool _caseSensitive;
+        std::vector<size_t> _offsets;
+        size_t _total;
+        std::atomic<bool> _stop;
+    };
+}
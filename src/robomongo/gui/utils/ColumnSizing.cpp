@@ -0,0 +1,116 @@
+#include "robomongo/gui/utils/ColumnSizing.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+#include <QAbstractItemView>
+#include <QFontMetrics>
+#include <QHeaderView>
+#include <QStyle>
+#include <QTreeView>
+
+namespace
+{
+    // Rows of model root measured, visible rows first
+    std::vector<int> sampledRows(QAbstractItemView *view, int rowCount)
+    {
+        std::vector<int> rows;
+        if (rowCount <= Robomongo::utils::MaxSampledRows) {
+            for (int row = 0; row < rowCount; ++row)
+                rows.push_back(row);
+            return rows;
+        }
+
+        QModelIndex const top = view->indexAt(QPoint(0, 0));
+        QModelIndex const bottom = view->indexAt(QPoint(0, view->viewport()->height() - 1));
+        int const firstVisible = top.isValid() && !top.parent().isValid() ? top.row() : 0;
+        int const lastVisible = bottom.isValid() && !bottom.parent().isValid() ? bottom.row() : firstVisible;
+        for (int row = firstVisible; row <= lastVisible && rows.size() < Robomongo::utils::MaxSampledRows / 2; ++row)
+            rows.push_back(row);
+
+        std::minstd_rand random(static_cast<unsigned>(rowCount));
+        std::uniform_int_distribution<int> any(0, rowCount - 1);
+        while (rows.size() < Robomongo::utils::MaxSampledRows)
+            rows.push_back(any(random));
+        return rows;
+    }
+
+    // Metrics of fonts of cells, most cells use the font of view
+    class TextWidths
+    {
+    public:
+        explicit TextWidths(const QFont &font) : _default(font) {}
+
+        int width(const QModelIndex &index)
+        {
+            QString const text = index.data(Qt::DisplayRole).toString();
+            if (text.isEmpty())
+                return 0;
+
+            QVariant const font = index.data(Qt::FontRole);
+            if (!font.isValid())
+                return _default.width(text);
+
+            QFont const cellFont = qvariant_cast<QFont>(font);
+            QString const key = cellFont.key();
+            auto metrics = _fonts.find(key);
+            if (metrics == _fonts.end())
+                metrics = _fonts.emplace(key, QFontMetrics(cellFont)).first;
+            return metrics->second.width(text);
+        }
+
+    private:
+        QFontMetrics const _default;
+        std::map<QString, QFontMetrics> _fonts;
+    };
+}
+
+namespace Robomongo
+{
+    namespace utils
+    {
+        void fitColumns(QAbstractItemView *view, QHeaderView *header, int first, int last, int maxWidth)
+        {
+            QAbstractItemModel *const model = view->model();
+            if (!model || first > last)
+                return;
+
+            std::vector<int> const rows = sampledRows(view, model->rowCount());
+            TextWidths widths(view->font());
+
+            // Margins of text in item delegate, on both sides of cell
+            int const margin = 2 * (view->style()->pixelMetric(QStyle::PM_FocusFrameHMargin, 0, view) + 1);
+            int const iconWidth = view->iconSize().isValid() ? view->iconSize().width() :
+                                  view->style()->pixelMetric(QStyle::PM_SmallIconSize, 0, view);
+            QTreeView *const tree = qobject_cast<QTreeView *>(view);
+
+            for (int column = first; column <= last; ++column) {
+                if (header->isSectionHidden(column))
+                    continue;
+
+                int width = header->sectionSizeHint(column);
+                int indentation = 0;
+                if (tree && tree->rootIsDecorated() && header->visualIndex(column) == 0)
+                    indentation = tree->indentation();
+
+                for (int row : rows) {
+                    QModelIndex const index = model->index(row, column);
+                    int cell = widths.width(index) + margin + indentation;
+                    if (!index.data(Qt::DecorationRole).isNull())
+                        cell += iconWidth + margin;
+                    width = std::max(width, cell);
+                }
+
+                if (maxWidth > 0)
+                    width = std::min(width, std::max(maxWidth, header->sectionSizeHint(column)));
+                header->resizeSection(column, width);
+            }
+        }
+
+        void fitColumns(QAbstractItemView *view, QHeaderView *header, int maxWidth)
+        {
+            fitColumns(view, header, 0, header->count() - 1, maxWidth);
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+class QAbstractItemView;
+class QHeaderView;
+
+namespace Robomongo
+{
+    namespace utils
+    {
+        // Rows measured by fitColumns(), the visible ones first and then random others
+        int const MaxSampledRows = 200;
+
+        /**
+         * @brief Resizes sections 'first'..'last' of 'header' of 'view' to fit header text and
+         *        text of sampled top-level rows, at most 'maxWidth' pixels (0 for no limit).
+         *
+         *  Unlike QHeaderView::ResizeToContents, which asks every row for its size hint, only
+         *  MaxSampledRows rows are measured, so that resizing costs the same for long models.
+         *  Random rows are chosen with seed of row count, repeated calls give the same widths.
+         */
+        void fitColumns(QAbstractItemView *view, QHeaderView *header, int first, int last, int maxWidth = 0);
+
+        // All sections of 'header'
+        void fitColumns(QAbstractItemView *view, QHeaderView *header, int maxWidth = 0);
+    }
+}
@@ -0,0 +1,90 @@
+#include "robomongo/gui/widgets/LogModel.h"
+
+#include <QColor>
+#include <algorithm>
+
+namespace Robomongo
+{
+    LogModel::LogModel(int capacity, QObject *parent) :
+        BaseClass(parent), _capacity(std::max(1, capacity)), _head(0), _count(0) {}
+
+    void LogModel::append(const std::vector<Entry> &entries)
+    {
+        if (entries.empty())
+            return;
+
+        // Only the last 'capacity' entries would survive anyway
+        auto first = entries.begin();
+        if (static_cast<int>(entries.size()) > _capacity)
+            first = entries.end() - _capacity;
+        int const added = static_cast<int>(entries.end() - first);
+
+        int const overflow = _count + added - _capacity;
+        if (overflow > 0) {
+            beginRemoveRows(QModelIndex(), 0, overflow - 1);
+            _head = (_head + overflow) % _capacity;
+            _count -= overflow;
+            endRemoveRows();
+        }
+
+        beginInsertRows(QModelIndex(), _count, _count + added - 1);
+        for (auto it = first; it != entries.end(); ++it) {
+            size_t const slot = (_head + _count) % _capacity;
+            if (slot == _entries.size())
+                _entries.push_back(*it);
+            else
+                _entries[slot] = *it;
+            ++_count;
+        }
+        endInsertRows();
+    }
+
+    void LogModel::clear()
+    {
+        beginResetModel();
+        _entries.clear();
+        _head = _count = 0;
+        endResetModel();
+    }
+
+    QString LogModel::severityGroup(int severity)
+    {
+        if (severity <= mongo::logger::LogSeverity::Error().toInt())
+            return "Error";
+        if (severity == mongo::logger::LogSeverity::Warning().toInt())
+            return "Warning";
+        if (severity == mongo::logger::LogSeverity::Info().toInt())
+            return "Info";
+        return "Debug";
+    }
+
+    int LogModel::rowCount(const QModelIndex &parent) const
+    {
+        return parent.isValid() ? 0 : _count;
+    }
+
+    QVariant LogModel::data(const QModelIndex &index, int role) const
+    {
+        if (!index.isValid() || index.row() >= _count)
+            return QVariant();
+
+        const Entry &e = entry(index.row());
+        switch (role) {
+            case Qt::DisplayRole:
+                return e.time + "\t" + e.message;
+            case SeverityRole:
+                return severityGroup(e.severity);
+            case Qt::ForegroundRole:
+                // Nice color for the future: "#CD9800" :)
+                if (e.severity <= mongo::logger::LogSeverity::Error().toInt())
+                    return QColor("#CD0000");
+                if (e.severity == mongo::logger::LogSeverity::Warning().toInt())
+                    return QColor("#CD9800");
+                if (e.severity == mongo::logger::LogSeverity::Log().toInt())
+                    return QColor("#777777");
+                return QColor(Qt::black);
+            default:
+                return QVariant();
+        }
+    }
+}
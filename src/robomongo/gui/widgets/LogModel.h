@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <vector>
+#include <mongo/logger/log_severity.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Fixed capacity ring buffer of log messages. When it is full, the oldest
+     *        messages are removed as new ones are appended.
+     */
+    class LogModel : public QAbstractListModel
+    {
+        Q_OBJECT
+
+    public:
+        typedef QAbstractListModel BaseClass;
+
+        // Severity group of message ("Error", "Warning", "Info" or "Debug"), used by filter
+        static const int SeverityRole = Qt::UserRole + 1;
+
+        struct Entry
+        {
+            QString time;
+            QString message;
+            int severity;   // mongo::logger::LogSeverity::toInt()
+        };
+
+        explicit LogModel(int capacity, QObject *parent = 0);
+
+        /**
+         * @brief Appends all 'entries' with one insert (and at most one remove) of rows
+         */
+        void append(const std::vector<Entry> &entries);
+        void clear();
+
+        static QString severityGroup(int severity);
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    private:
+        const Entry &entry(int row) const { return _entries[(_head + row) % _capacity]; }
+
+        const int _capacity;
+        std::vector<Entry> _entries;    // grows up to capacity, then reused
+        int _head;                      // slot of the oldest entry
+        int _count;
+    };
+}
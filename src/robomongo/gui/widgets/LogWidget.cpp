@@ -1,72 +1,152 @@
 #include "robomongo/gui/widgets/LogWidget.h"
 
+#include <QAction>
+#include <QApplication>
+#include <QClipboard>
 #include <QHBoxLayout>
-#include <QScrollBar>
+#include <QListView>
 #include <QMenu>
+#include <QScrollBar>
+#include <QSortFilterProxyModel>
 #include <QTime>
-#include <QAction>
-#include <QPlainTextEdit>
+#include <QTimer>
+#include <algorithm>
 #include "robomongo/core/utils/QtUtils.h"
 
+namespace
+{
+    QAction *createFilterAction(const QString &text, QObject *parent)
+    {
+        QAction *action = new QAction(text, parent);
+        action->setCheckable(true);
+        action->setChecked(true);
+        VERIFY(QObject::connect(action, SIGNAL(toggled(bool)), parent, SLOT(updateFilter())));
+        return action;
+    }
+}
+
 namespace Robomongo
 {
-    LogWidget::LogWidget(QWidget* parent) 
-        : BaseClass(parent), _logTextEdit(new QTextEdit(this))
+    LogWidget::LogWidget(QWidget* parent)
+        : BaseClass(parent),
+        _model(new LogModel(MaxMessages, this)),
+        _filter(new QSortFilterProxyModel(this)),
+        _view(new QListView(this)),
+        _flushTimer(new QTimer(this))
     {
-        _logTextEdit->setReadOnly(true);
-        _logTextEdit->setContextMenuPolicy(Qt::CustomContextMenu);
-        VERIFY(connect(_logTextEdit, SIGNAL(customContextMenuRequested(const QPoint&)), this, SLOT(showContextMenu(const QPoint &))));
+        _filter->setSourceModel(_model);
+        _filter->setFilterRole(LogModel::SeverityRole);
+
+        // Only visible rows are painted, so the view does not slow down as log grows
+        _view->setModel(_filter);
+        _view->setUniformItemSizes(true);
+        _view->setSelectionMode(QAbstractItemView::ExtendedSelection);
+        _view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        _view->setContextMenuPolicy(Qt::CustomContextMenu);
+        VERIFY(connect(_view, SIGNAL(customContextMenuRequested(const QPoint&)), this, SLOT(showContextMenu(const QPoint &))));
+
+        _flushTimer->setSingleShot(true);
+        _flushTimer->setInterval(FlushIntervalMs);
+        VERIFY(connect(_flushTimer, SIGNAL(timeout()), this, SLOT(flushMessages())));
+
         QHBoxLayout *hlayout = new QHBoxLayout;
         hlayout->setContentsMargins(0, 0, 0, 0);
-        hlayout->addWidget(_logTextEdit);
+        hlayout->addWidget(_view);
+
+        _copy = new QAction("Copy", this);
+        VERIFY(connect(_copy, SIGNAL(triggered()), this, SLOT(copySelected())));
         _clear = new QAction("Clear All", this);
-        VERIFY(connect(_clear, SIGNAL(triggered()), _logTextEdit, SLOT(clear())));
-        setLayout(hlayout);      
+        VERIFY(connect(_clear, SIGNAL(triggered()), this, SLOT(clear())));
+
+        _showErrors = createFilterAction("Show Errors", this);
+        _showWarnings = createFilterAction("Show Warnings", this);
+        _showInfo = createFilterAction("Show Info", this);
+        _showDebug = createFilterAction("Show Debug", this);
+        updateFilter();
+
+        setLayout(hlayout);
     }
 
     void LogWidget::showContextMenu(const QPoint &pt)
     {
-        QMenu *menu = _logTextEdit->createStandardContextMenu();
-        menu->addAction(_clear);
-        _clear->setEnabled(!_logTextEdit->toPlainText().isEmpty());
+        QMenu menu;
+        menu.addAction(_copy);
+        menu.addAction(_clear);
+        menu.addSeparator();
+        menu.addAction(_showErrors);
+        menu.addAction(_showWarnings);
+        menu.addAction(_showInfo);
+        menu.addAction(_showDebug);
+        _copy->setEnabled(_view->selectionModel()->hasSelection());
+        _clear->setEnabled(_model->rowCount() > 0);
 
-        menu->exec(_logTextEdit->mapToGlobal(pt));
-        delete menu;
+        menu.exec(_view->mapToGlobal(pt));
     }
 
     void LogWidget::addMessage(const QString &message, mongo::logger::LogSeverity level)
     {
-        // Print time
-        QTime time = QTime::currentTime();
-        _logTextEdit->moveCursor (QTextCursor::End);
-        _logTextEdit->setTextColor(QColor("#aaaaaa"));
-        _logTextEdit->insertPlainText(time.toString("h:mm:ss AP") + "\t");
+        const int maxLength = 500;
+        LogModel::Entry entry;
+        entry.time = QTime::currentTime().toString("h:mm:ss AP");
+        entry.severity = level.toInt();
+        if (message.length() <= maxLength)
+            entry.message = message.trimmed();
+        else
+            entry.message = QString("(truncated) ") + message.left(maxLength).trimmed() + "...";
+
+        _pending.push_back(entry);
+        if (!_flushTimer->isActive())
+            _flushTimer->start();
+    }
+
+    void LogWidget::flushMessages()
+    {
+        // Follow new messages only if user did not scroll up to read older ones
+        QScrollBar *sb = _view->verticalScrollBar();
+        bool const atBottom = sb->value() == sb->maximum();
 
-        // Print message
-        _logTextEdit->moveCursor (QTextCursor::End);
+        // Drop messages that would be removed by the model right away
+        if (static_cast<int>(_pending.size()) > MaxMessages)
+            _pending.erase(_pending.begin(), _pending.end() - MaxMessages);
 
-        // Nice color for the future: "#CD9800" :)
+        _model->append(_pending);
+        _pending.clear();
 
-        QColor textColor = QColor(Qt::black);
+        if (atBottom)
+            _view->scrollToBottom();
+    }
 
-        if (level == mongo::logger::LogSeverity::Error())
-            textColor = QColor("#CD0000");
-        else if (level == mongo::logger::LogSeverity::Log())
-            textColor = QColor("#777777");
-        else if (level == mongo::logger::LogSeverity::Warning())
-            textColor = QColor("#CD9800");
+    void LogWidget::copySelected()
+    {
+        QModelIndexList rows = _view->selectionModel()->selectedRows();
+        std::sort(rows.begin(), rows.end());
 
-        _logTextEdit->setTextColor(textColor);
+        QStringList lines;
+        for (const QModelIndex &row : rows)
+            lines.append(row.data().toString());
 
-        const int maxLength = 500;
-        if (message.length() <= maxLength) {
-            _logTextEdit->insertPlainText(message.trimmed() + "\n");
-        } else {
-            _logTextEdit->insertPlainText(QString("(truncated) ") + message.left(maxLength).trimmed() + "...\n");
-        }
-
-        // Scroll to the bottom
-        QScrollBar *sb = _logTextEdit->verticalScrollBar();
-        sb->setValue(sb->maximum());
+        QApplication::clipboard()->setText(lines.join("\n"));
+    }
+
+    void LogWidget::clear()
+    {
+        _pending.clear();
+        _model->clear();
+    }
+
+    void LogWidget::updateFilter()
+    {
+        QStringList groups;
+        if (_showErrors->isChecked())
+            groups << "Error";
+        if (_showWarnings->isChecked())
+            groups << "Warning";
+        if (_showInfo->isChecked())
+            groups << "Info";
+        if (_showDebug->isChecked())
+            groups << "Debug";
+
+        // Severity group is never empty, so "^()$" hides everything
+        _filter->setFilterRegExp(QRegExp(QString("^(%1)$").arg(groups.join("|"))));
     }
 }
@@ -2,10 +2,16 @@
 
 
 #include <QWidget>
+#include <vector>
 #include <mongo/logger/log_severity.h>
+
+#include "robomongo/gui/widgets/LogModel.h"
+
 QT_BEGIN_NAMESPACE
-class QTextEdit;
+class QListView;
 class QAction;
+class QTimer;
+class QSortFilterProxyModel;
 QT_END_NAMESPACE
 
 namespace Robomongo
@@ -16,17 +22,37 @@ namespace Robomongo
 
     public:
         typedef QWidget BaseClass;
-        LogWidget(QWidget* parent = 0);        
+        LogWidget(QWidget* parent = 0);
+
+        // Older messages are dropped from the view (but not from log file, see Logger)
+        static const int MaxMessages = 10000;
+
+        // Messages are added to the view in batches, not more often than this
+        static const int FlushIntervalMs = 50;
 
     public Q_SLOTS:
         void addMessage(const QString &message, mongo::logger::LogSeverity level);
 
     private Q_SLOTS:
         void showContextMenu(const QPoint &pt);
+        void flushMessages();
+        void copySelected();
+        void clear();
+        void updateFilter();
+
+    private:
+        LogModel *const _model;
+        QSortFilterProxyModel *const _filter;
+        QListView *const _view;
+        QTimer *const _flushTimer;
+        std::vector<LogModel::Entry> _pending;
 
-    private:        
-        QTextEdit *const _logTextEdit;
         QAction *_clear;
+        QAction *_copy;
+        QAction *_showErrors;
+        QAction *_showWarnings;
+        QAction *_showInfo;
+        QAction *_showDebug;
     };
 
 }
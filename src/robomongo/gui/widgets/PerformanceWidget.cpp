@@ -0,0 +1,218 @@
+#include "robomongo/gui/widgets/PerformanceWidget.h"
+
+#include <algorithm>
+#include <QDateTime>
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSplitter>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "robomongo/core/EventTrace.h"
+#include "robomongo/core/utils/GuiStallMonitor.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace
+{
+    const int RefreshIntervalMs = 1000;
+
+    enum Column { NameColumn, TotalColumn, QueueColumn, WorkerColumn, GuiColumn };
+    enum StallColumn { StallTimeColumn, StallDurationColumn, StallActivityColumn };
+
+    QString msString(long long us)
+    {
+        return QString::number(us / 1000.0, 'f', 1);
+    }
+}
+
+namespace Robomongo
+{
+    PerformanceWidget::PerformanceWidget(QWidget *parent)
+        : BaseClass(parent), _tree(new QTreeWidget(this)), _framesLabel(new QLabel(this)),
+          _stallsTree(new QTreeWidget(this)), _shownStalls(0)
+    {
+        _tree->setColumnCount(5);
+        _tree->setHeaderLabels(QStringList() << "Request" << "Total, ms" << "Queue, ms"
+                                             << "Worker, ms" << "GUI, ms");
+        _tree->header()->setSectionResizeMode(NameColumn, QHeaderView::Stretch);
+        _tree->header()->setStretchLastSection(false);
+        _tree->setUniformRowHeights(true);
+
+        _framesLabel->setWordWrap(true);
+        _framesLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        _stallsTree->setColumnCount(3);
+        _stallsTree->setHeaderLabels(QStringList() << "GUI stall" << "Duration, ms" << "Handling");
+        _stallsTree->header()->setSectionResizeMode(StallActivityColumn, QHeaderView::Stretch);
+        _stallsTree->setRootIsDecorated(false);
+        _stallsTree->setUniformRowHeights(true);
+
+        QPushButton *refreshButton = new QPushButton("Refresh", this);
+        VERIFY(connect(refreshButton, SIGNAL(clicked()), this, SLOT(refresh())));
+
+        QPushButton *clearButton = new QPushButton("Clear", this);
+        VERIFY(connect(clearButton, SIGNAL(clicked()), this, SLOT(clear())));
+
+        QPushButton *exportButton = new QPushButton("Export Chrome Trace...", this);
+        VERIFY(connect(exportButton, SIGNAL(clicked()), this, SLOT(exportChromeTrace())));
+
+        QHBoxLayout *buttons = new QHBoxLayout;
+        buttons->setContentsMargins(0, 0, 0, 0);
+        buttons->addWidget(refreshButton);
+        buttons->addWidget(clearButton);
+        buttons->addStretch(1);
+        buttons->addWidget(exportButton);
+
+        QVBoxLayout *vlayout = new QVBoxLayout;
+        vlayout->setContentsMargins(0, 0, 0, 0);
+        QWidget *frames = new QWidget(this);
+        QVBoxLayout *framesLayout = new QVBoxLayout;
+        framesLayout->setContentsMargins(0, 0, 0, 0);
+        framesLayout->addWidget(_framesLabel);
+        framesLayout->addWidget(_stallsTree);
+        frames->setLayout(framesLayout);
+
+        QSplitter *splitter = new QSplitter(Qt::Vertical, this);
+        splitter->addWidget(_tree);
+        splitter->addWidget(frames);
+        splitter->setStretchFactor(0, 3);
+        splitter->setStretchFactor(1, 1);
+
+        vlayout->addLayout(buttons);
+        vlayout->addWidget(splitter);
+        setLayout(vlayout);
+
+        // Traces are cheap to record, but not to show: panel is updated only while visible
+        _refreshTimer = new QTimer(this);
+        _refreshTimer->setInterval(RefreshIntervalMs);
+        VERIFY(connect(_refreshTimer, SIGNAL(timeout()), this, SLOT(autoRefresh())));
+        _refreshTimer->start();
+    }
+
+    void PerformanceWidget::autoRefresh()
+    {
+        if (isVisible())
+            refresh();
+    }
+
+    void PerformanceWidget::refresh()
+    {
+        std::vector<std::shared_ptr<EventTrace>> const traces = EventTraceRecorder::instance().traces();
+
+        // Items of traces that were dropped by recorder
+        QHash<int, QTreeWidgetItem *> items;
+        items.swap(_itemsByTraceId);
+        for (auto const& trace : traces) {
+            QTreeWidgetItem *item = items.take(trace->id());
+            if (!item) {
+                item = new QTreeWidgetItem;
+                _tree->insertTopLevelItem(0, item);     // most recent first
+            }
+            _itemsByTraceId.insert(trace->id(), item);
+            updateTraceItem(item, *trace);
+        }
+        qDeleteAll(items);
+
+        refreshFrames();
+    }
+
+    void PerformanceWidget::refreshFrames()
+    {
+        GuiStallMonitor::FrameStats const stats = GuiStallMonitor::snapshot();
+        LatencyHistogram const &frames = stats.frames();
+        _framesLabel->setText(QString("GUI frames: %1, p50 %2 ms, p99 %3 ms, max %4 ms. "
+                                      "Stalls over %5 ms: %6, %7 s in total.")
+            .arg(frames.count())
+            .arg(msString(frames.percentileUs(50)))
+            .arg(msString(frames.percentileUs(99)))
+            .arg(msString(frames.maxUs()))
+            .arg(stats.thresholdUs() / 1000)
+            .arg(stats.stallCount())
+            .arg(stats.stalledUs() / 1000000.0, 0, 'f', 1));
+
+        // Only stalls recorded since the last refresh are added, the oldest ones are dropped
+        std::deque<GuiStallMonitor::Stall> const &stalls = stats.stalls();
+        unsigned long long const added = std::min<unsigned long long>(stats.stallCount() - _shownStalls, stalls.size());
+        for (size_t i = stalls.size() - added; i < stalls.size(); ++i) {
+            QTreeWidgetItem *item = new QTreeWidgetItem;
+            item->setText(StallTimeColumn, QDateTime::fromMSecsSinceEpoch(stalls[i].endedAtMs).toString("HH:mm:ss.zzz"));
+            item->setText(StallDurationColumn, msString(stalls[i].durationUs));
+            item->setText(StallActivityColumn, QtUtils::toQString(stalls[i].activity));
+            _stallsTree->insertTopLevelItem(0, item);     // most recent first
+        }
+        while (_stallsTree->topLevelItemCount() > static_cast<int>(GuiStallMonitor::FrameStats::MaxStalls))
+            delete _stallsTree->takeTopLevelItem(_stallsTree->topLevelItemCount() - 1);
+        _shownStalls = stats.stallCount();
+    }
+
+    void PerformanceWidget::updateTraceItem(QTreeWidgetItem *item, const EventTrace &trace)
+    {
+        std::vector<EventTrace::Mark> const marks = trace.marks();
+        if (marks.empty() || item->childCount() == static_cast<int>(marks.size()))
+            return;
+
+        // Every step is attributed by where it ended: waiting for delivery to a thread,
+        // running in worker (including driver) or in GUI (including views)
+        long long queueUs = 0, workerUs = 0, guiUs = 0;
+        QList<QTreeWidgetItem *> steps;
+        for (size_t i = 0; i < marks.size(); ++i) {
+            long long const stepUs = i == 0 ? 0 : marks[i].timestampUs - marks[i - 1].timestampUs;
+            if (marks[i].label.compare(0, 8, "deliver ") == 0)
+                queueUs += stepUs;
+            else if (marks[i].threadName == "GUI")
+                guiUs += stepUs;
+            else
+                workerUs += stepUs;
+
+            QTreeWidgetItem *step = new QTreeWidgetItem;
+            step->setText(NameColumn, QString("+%1 ms  %2  [%3]")
+                .arg(msString(marks[i].timestampUs - marks.front().timestampUs))
+                .arg(QtUtils::toQString(marks[i].label))
+                .arg(QtUtils::toQString(marks[i].threadName)));
+            step->setText(TotalColumn, msString(stepUs));
+            steps.append(step);
+        }
+
+        qDeleteAll(item->takeChildren());
+        item->addChildren(steps);
+
+        item->setText(NameColumn, QString("#%1 %2").arg(trace.id()).arg(QtUtils::toQString(trace.name())));
+        item->setText(TotalColumn, msString(marks.back().timestampUs - marks.front().timestampUs));
+        item->setText(QueueColumn, msString(queueUs));
+        item->setText(WorkerColumn, msString(workerUs));
+        item->setText(GuiColumn, msString(guiUs));
+    }
+
+    void PerformanceWidget::clear()
+    {
+        EventTraceRecorder::instance().clear();
+        _tree->clear();
+        _itemsByTraceId.clear();
+
+        GuiStallMonitor::clear();
+        _stallsTree->clear();
+        _shownStalls = 0;
+        refreshFrames();
+    }
+
+    void PerformanceWidget::exportChromeTrace()
+    {
+        QString const fileName = QFileDialog::getSaveFileName(this, tr("Export Chrome Trace"),
+                                                              "robomongo-trace.json", tr("JSON (*.json)"));
+        if (fileName.isEmpty())
+            return;
+
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+            file.write(EventTraceRecorder::instance().toChromeTraceJson()) < 0) {
+            QMessageBox::warning(this, tr("Export Chrome Trace"),
+                                 tr("Cannot write file %1: %2").arg(fileName).arg(file.errorString()));
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QWidget>
+#include <QHash>
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QTreeWidget;
+class QTreeWidgetItem;
+class QTimer;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class EventTrace;
+
+    /**
+     * @brief Shows recent request traces (see EventTrace): where time of every request was
+     *        spent - waiting in queue, in worker/driver or in GUI. Traces can be exported
+     *        in Chrome trace format. Below traces are frame times of GUI thread and its
+     *        recent stalls, see GuiStallMonitor.
+     */
+    class PerformanceWidget : public QWidget
+    {
+        Q_OBJECT
+
+    public:
+        typedef QWidget BaseClass;
+        PerformanceWidget(QWidget *parent = 0);
+
+    public Q_SLOTS:
+        void refresh();
+
+    private Q_SLOTS:
+        void autoRefresh();
+        void clear();
+        void exportChromeTrace();
+
+    private:
+        void updateTraceItem(QTreeWidgetItem *item, const EventTrace &trace);
+        void refreshFrames();
+
+        QTreeWidget *_tree;
+        QLabel *_framesLabel;
+        QTreeWidget *_stallsTree;
+        unsigned long long _shownStalls;
+        QTimer *_refreshTimer;
+        QHash<int, QTreeWidgetItem *> _itemsByTraceId;
+    };
+}
@@ -166,6 +166,7 @@ namespace Robomongo
         _sparceCheckBox->setChecked(_info._sparse);
         _backGroundCheckBox = new QCheckBox(tr("Create index in background"), advanced);
         _backGroundCheckBox->setChecked(_info._backGround);
+        _rollingCheckBox = new QCheckBox(tr("Rolling build"), advanced);
 
         QHBoxLayout *expireLayout = new QHBoxLayout;
         _expireAfterLineEdit = new QLineEdit(advanced);
@@ -196,6 +197,12 @@ namespace Robomongo
             "Builds the index in the background so that building an index does not block other database activities.",
             20, -2, 0, 20);
 
+        QLabel *rollingHelpLabel = createHelpLabel(
+            "Builds the new index in background next to the old one and drops the old one only then, "
+            "so that queries never run without index. If the name is kept, index is built twice, "
+            "the first time under a temporary name. Progress is shown in explorer.",
+            20, -2, 0, 20);
+
         QLabel *expireHelpLabel = createHelpLabel(
             "Specifies a <i>time to live</i>, in seconds, to control how long MongoDB retains documents in this collection",
             20, -2, 0, 20);
@@ -205,9 +212,11 @@ namespace Robomongo
         layout->addWidget(sparseHelpLabel,           1, 0, 1, 2);
         layout->addWidget(_backGroundCheckBox,       2, 0, 1, 2);
         layout->addWidget(backgroundHelpLabel,       3, 0, 1, 2);
-        layout->addWidget(expireCheckBox,            4, 0);
-        layout->addLayout(expireLayout,              4, 1);
-        layout->addWidget(expireHelpLabel,           5, 0, 1, 2);
+        layout->addWidget(_rollingCheckBox,          4, 0, 1, 2);
+        layout->addWidget(rollingHelpLabel,          5, 0, 1, 2);
+        layout->addWidget(expireCheckBox,            6, 0);
+        layout->addLayout(expireLayout,              6, 1);
+        layout->addWidget(expireHelpLabel,           7, 0, 1, 2);
         layout->setAlignment(Qt::AlignTop);
         advanced->setLayout(layout);
 
@@ -271,6 +280,11 @@ namespace Robomongo
             QtUtils::toStdString(_textWeightsLineEdit->sciScintilla()->text()));
     }
 
+    bool AddEditIndexDialog::isRollingBuild() const
+    {
+        return _rollingCheckBox->isChecked();
+    }
+
     void AddEditIndexDialog::accept()
     {
         if (isValidJson(_jsonText->sciScintilla()->text())) {
@@ -281,7 +295,7 @@ namespace Robomongo
                 return ;
             }
 
-            if (!_isAddIndex) {
+            if (!_isAddIndex && !isRollingBuild()) {
                 // Ask user
                 int const answer = QMessageBox::question(this, "Warning",
                     QString("MongoDB does not support direct (one step) edit index. "
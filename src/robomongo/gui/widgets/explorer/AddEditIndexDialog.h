@@ -26,6 +26,9 @@ namespace Robomongo
         );
         IndexInfo info() const;
 
+        // Index is built with steps of RollingIndexBuild, see MongoServer::rollingIndexBuild()
+        bool isRollingBuild() const;
+
     public Q_SLOTS:
         virtual void accept();
         void expireStateChanged(int value);
@@ -42,6 +45,7 @@ namespace Robomongo
        QCheckBox *_uniqueCheckBox;
 
        QCheckBox *_backGroundCheckBox;
+       QCheckBox *_rollingCheckBox;
        QCheckBox *_sparceCheckBox;
        QLineEdit *_expireAfterLineEdit;
 
@@ -1,9 +1,11 @@
 #include "ExplorerCollectionIndexItem.h"
 
 #include <QAction>
+#include <QDateTime>
 #include <QMenu>
 
 #include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/MongoUtils.h"
 #include "robomongo/core/utils/QtUtils.h"
 
 #include "robomongo/gui/GuiRegistry.h"
@@ -24,17 +26,43 @@ namespace Robomongo
         auto editIndex = new QAction("Edit Index...", this);
         connect(editIndex, SIGNAL(triggered()), SLOT(ui_edit()));
 
-        BaseClass::_contextMenu->addAction(editIndex);
-        BaseClass::_contextMenu->addAction(dropIndex);
+        contextMenu()->addAction(editIndex);
+        contextMenu()->addAction(dropIndex);
 
         setText(0, QtUtils::toQString(_info._name));
         setIcon(0, Robomongo::GuiRegistry::instance().indexIcon());
     }
 
+    void ExplorerCollectionIndexItem::setUsage(const IndexUsageInfo &usage)
+    {
+        QStringList details;
+        if (usage._sizeBytes >= 0)
+            details << MongoUtils::buildNiceSizeString(usage._sizeBytes);
+        if (usage._ops >= 0)
+            details << (usage._ops == 0 ? QString("unused") : QString("%1 ops").arg(usage._ops));
+
+        QString const name = QtUtils::toQString(_info._name);
+        setText(0, details.isEmpty() ? name : QString("%1 (%2)").arg(name, details.join(", ")));
+
+        if (usage._ops < 0) {
+            setToolTip(0, QString());
+            return;
+        }
+
+        // Counters are reset on restart of mongod and on rebuild of index
+        QString const since = usage._sinceMs > 0 ? 
+            QDateTime::fromMSecsSinceEpoch(usage._sinceMs).toString("yyyy-MM-dd hh:mm:ss") : "server start";
+        setToolTip(0, usage._ops == 0 ?
+            QString("Not used by any operation since %1.<br/>Unused index only slows down writes "
+                    "and takes memory.").arg(since) :
+            QString("Used by %1 operations since %2.").arg(usage._ops).arg(since));
+    }
+
     void ExplorerCollectionIndexItem::ui_dropIndex()
     {
         // Ask user
-        auto const answer = utils::questionDialog(treeWidget(), "Drop", "Index", text(0));
+        auto const answer = utils::questionDialog(treeWidget(), "Drop", "Index", 
+                                                       QtUtils::toQString(_info._name));
         if (answer != QMessageBox::Yes)
             return;
 
@@ -74,7 +102,7 @@ namespace Robomongo
             if (!databaseTreeItem)
                 return;
 
-            databaseTreeItem->addEditIndex(grPar, _info, dlg.info());
+            databaseTreeItem->addEditIndex(grPar, _info, dlg.info(), dlg.isRollingBuild());
         }
     }
 }
\ No newline at end of file
@@ -16,6 +16,13 @@ namespace Robomongo
         explicit ExplorerCollectionIndexItem(
             ExplorerCollectionIndexesDir *parent, const IndexInfo &info);
 
+        const IndexInfo &info() const { return _info; }
+
+        /**
+         * @brief Shows size and number of operations after name, see MongoDatabase::indexUsage()
+         */
+        void setUsage(const IndexUsageInfo &usage);
+
     private Q_SLOTS:
         void ui_dropIndex();
         void ui_edit();
@@ -28,11 +28,11 @@ namespace Robomongo
         QAction *refreshIndex = new QAction("Refresh", this);
         VERIFY(connect(refreshIndex, SIGNAL(triggered()), SLOT(ui_refreshIndex())));
 
-        BaseClass::_contextMenu->addAction(viewIndex);
-        BaseClass::_contextMenu->addAction(addIndex);
-        BaseClass::_contextMenu->addAction(reIndex);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(refreshIndex);
+        contextMenu()->addAction(viewIndex);
+        contextMenu()->addAction(addIndex);
+        contextMenu()->addAction(reIndex);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(refreshIndex);
 
         setText(0, "Indexes");
         setIcon(0, Robomongo::GuiRegistry::instance().folderIcon());
@@ -61,7 +61,7 @@ namespace Robomongo
     {
         auto const par = dynamic_cast<ExplorerCollectionTreeItem *>(parent());
         if (par)
-            par->expand();
+            par->refreshIndexes();
     }
 
     void ExplorerCollectionIndexesDir::ui_addIndex()
@@ -87,7 +87,7 @@ namespace Robomongo
         if (!databaseTreeItem)
             return;
 
-        databaseTreeItem->addEditIndex(par, fakeInfo, dlg.info());
+        databaseTreeItem->addEditIndex(par, fakeInfo, dlg.info(), dlg.isRollingBuild());
     }
 
     void ExplorerCollectionIndexesDir::ui_reIndex()
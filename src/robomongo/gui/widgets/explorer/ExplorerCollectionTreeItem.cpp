@@ -1,7 +1,11 @@
 #include "robomongo/gui/widgets/explorer/ExplorerCollectionTreeItem.h"
 
+#include <algorithm>
 #include <QAction>
 #include <QMenu>
+#include <QMessageBox>
+#include <QProgressBar>
+#include <QPushButton>
 
 #include "robomongo/gui/widgets/explorer/AddEditIndexDialog.h"
 #include "robomongo/gui/widgets/explorer/ExplorerCollectionIndexesDir.h"
@@ -10,12 +14,29 @@
 #include "robomongo/gui/dialogs/CreateDatabaseDialog.h"
 #include "robomongo/gui/dialogs/CopyCollectionDialog.h"
 #include "robomongo/gui/dialogs/DocumentTextEditor.h"
+#include "robomongo/gui/dialogs/ExplainDialog.h"
+#include "robomongo/gui/dialogs/PlanCacheDialog.h"
+#include "robomongo/gui/dialogs/SchemaAnalysisDialog.h"
+#include "robomongo/gui/dialogs/DataGeneratorDialog.h"
+#include "robomongo/gui/dialogs/DocumentSizesDialog.h"
+#include "robomongo/gui/dialogs/CompareCollectionsDialog.h"
+#include "robomongo/gui/dialogs/ShardDistributionDialog.h"
+#include "robomongo/gui/dialogs/ShardFanoutDialog.h"
+#include "robomongo/gui/dialogs/ThrottledWriteDialog.h"
+#include "robomongo/gui/dialogs/ExportDialog.h"
+#include "robomongo/gui/dialogs/GridFsDialog.h"
+#include "robomongo/gui/dialogs/ChangeStreamDialog.h"
+#include "robomongo/gui/dialogs/ImportDialog.h"
 #include "robomongo/gui/GuiRegistry.h"
 #include "robomongo/gui/utils/DialogUtils.h"
 
 #include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/domain/FirstPageCache.h"
 #include "robomongo/core/domain/MongoCollection.h"
+#include "robomongo/core/domain/MetadataSnapshot.h"
 #include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/MongoUtils.h"
 #include "robomongo/core/domain/App.h"
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/core/utils/Logger.h"
@@ -25,12 +46,17 @@
 namespace
 {
     const char *tooltipTemplate =
-        "%s "
+        "%1 "
         "<table>"
-        "<tr><td>Count:</td> <td><b>&nbsp;&nbsp;%lld</b></td></tr>"
-        "<tr><td>Size:</td><td><b>&nbsp;&nbsp;%s</b></td></tr>"
+        "<tr><td>Count:</td> <td><b>&nbsp;&nbsp;%2</b></td></tr>"
+        "<tr><td>Size:</td><td><b>&nbsp;&nbsp;%3</b></td></tr>"
+        "<tr><td>Storage Size:</td><td><b>&nbsp;&nbsp;%4</b></td></tr>"
+        "<tr><td>Total Index Size:</td><td><b>&nbsp;&nbsp;%5</b></td></tr>"
         "</table>"
         ;
+
+    // Documents, above which "Remove All Documents" suggests removing them in batches
+    const long long LargeCollectionCount = 100 * 1000;
 }
 
 namespace Robomongo
@@ -39,7 +65,31 @@ namespace Robomongo
 
     ExplorerCollectionTreeItem::ExplorerCollectionTreeItem(
         QTreeWidgetItem *parent, ExplorerDatabaseTreeItem *databaseItem, MongoCollection *collection) 
-        : BaseClass(parent), _collection(collection), _databaseItem(databaseItem)
+        : BaseClass(parent), _indexDir(nullptr), _forceIndexUsage(false), _indexBuildItem(nullptr), 
+          _collection(collection), 
+          _databaseItem(databaseItem)
+    {
+        // Databases may have a huge number of collections, so context menu and "Indexes" folder
+        // are created only when needed, see showContextMenuAtPos() and ensureIndexDir()
+        setText(0, QtUtils::toQString(_collection->name()));
+        setIcon(0, GuiRegistry::instance().collectionIcon());
+
+        setExpanded(false);
+        setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+
+        // Stats may be already cached by database, i.e. after refresh of collections
+        updateToolTip();
+    }
+
+    void ExplorerCollectionTreeItem::showContextMenuAtPos(const QPoint &pos)
+    {
+        if (contextMenu()->isEmpty())
+            buildContextMenu();
+
+        BaseClass::showContextMenuAtPos(pos);
+    }
+
+    void ExplorerCollectionTreeItem::buildContextMenu()
     {
         QAction *addDocument = new QAction("Insert Document...", this);
         VERIFY(connect(addDocument, SIGNAL(triggered()), SLOT(ui_addDocument())));
@@ -52,6 +102,9 @@ namespace Robomongo
         QAction *removeAllDocuments = new QAction("Remove All Documents...", this);
         VERIFY(connect(removeAllDocuments, SIGNAL(triggered()), SLOT(ui_removeAllDocuments())));
 
+        QAction *updateInBatches = new QAction("Update Documents in Batches...", this);
+        VERIFY(connect(updateInBatches, SIGNAL(triggered()), SLOT(ui_updateInBatches())));
+
         QAction *collectionStats = new QAction("Statistics", this);
         VERIFY(connect(collectionStats, SIGNAL(triggered()), SLOT(ui_collectionStatistics())));
 
@@ -66,8 +119,10 @@ namespace Robomongo
         QAction *shardVersion = new QAction("Shard Version", this);
         VERIFY(connect(shardVersion, SIGNAL(triggered()), SLOT(ui_shardVersion())));
 
-        QAction *shardDistribution = new QAction("Shard Distribution", this);
+        QAction *shardDistribution = new QAction("Shard Distribution...", this);
         VERIFY(connect(shardDistribution, SIGNAL(triggered()), SLOT(ui_shardDistribution())));
+        QAction *shardFanout = new QAction("Shard Fan-out Query...", this);
+        VERIFY(connect(shardFanout, SIGNAL(triggered()), SLOT(ui_shardFanout())));
 
         QAction *dropCollection = new QAction("Drop Collection...", this);
         VERIFY(connect(dropCollection, SIGNAL(triggered()), SLOT(ui_dropCollection())));
@@ -77,44 +132,95 @@ namespace Robomongo
         QAction *duplicateCollection = new QAction("Duplicate Collection...", this);
         VERIFY(connect(duplicateCollection, SIGNAL(triggered()), SLOT(ui_duplicateCollection())));
 
-        // Disabling for 0.8.5 release as this is currently a broken misfeature (see discussion on issue #398)
-        // QAction *copyCollectionToDiffrentServer = new QAction("Copy Collection to Database...", this);
-        // VERIFY(connect(copyCollectionToDiffrentServer, SIGNAL(triggered()), SLOT(ui_copyToCollectionToDiffrentServer())));
+        QAction *copyCollectionToDiffrentServer = new QAction("Copy Collection to Database...", this);
+        VERIFY(connect(copyCollectionToDiffrentServer, SIGNAL(triggered()), SLOT(ui_copyToCollectionToDiffrentServer())));
+
+        QAction *exportDocuments = new QAction("Export Documents...", this);
+        VERIFY(connect(exportDocuments, SIGNAL(triggered()), SLOT(ui_exportDocuments())));
+
+        QAction *importDocuments = new QAction("Import Documents...", this);
+        VERIFY(connect(importDocuments, SIGNAL(triggered()), SLOT(ui_importDocuments())));
 
         QAction *viewCollection = new QAction("View Documents", this);
         VERIFY(connect(viewCollection, SIGNAL(triggered()), SLOT(ui_viewCollection())));
 
-        BaseClass::_contextMenu->addAction(viewCollection);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(addDocument);
-        BaseClass::_contextMenu->addAction(updateDocument);
-        BaseClass::_contextMenu->addAction(removeDocument);
-        BaseClass::_contextMenu->addAction(removeAllDocuments);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(renameCollection);
-        BaseClass::_contextMenu->addAction(duplicateCollection);
-        // Disabling for 0.8.5 release as this is currently a broken misfeature (see discussion on issue #398)
-        // BaseClass::_contextMenu->addAction(copyCollectionToDiffrentServer);
-        BaseClass::_contextMenu->addAction(dropCollection);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(collectionStats);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(shardVersion);
-        BaseClass::_contextMenu->addAction(shardDistribution);
+        QAction *explainQuery = new QAction("Explain Query...", this);
+        VERIFY(connect(explainQuery, SIGNAL(triggered()), SLOT(ui_explainQuery())));
+
+        QAction *planCache = new QAction("Plan Cache...", this);
+        VERIFY(connect(planCache, SIGNAL(triggered()), SLOT(ui_planCache())));
+
+        QAction *analyzeSchema = new QAction("Analyze Schema...", this);
+        VERIFY(connect(analyzeSchema, SIGNAL(triggered()), SLOT(ui_analyzeSchema())));
+
+        QAction *documentSizes = new QAction("Document Sizes...", this);
+        VERIFY(connect(documentSizes, SIGNAL(triggered()), SLOT(ui_documentSizes())));
+
+        QAction *generateData = new QAction("Generate Documents...", this);
+        VERIFY(connect(generateData, SIGNAL(triggered()), SLOT(ui_generateData())));
+
+        QAction *compareCollection = new QAction("Compare With...", this);
+        VERIFY(connect(compareCollection, SIGNAL(triggered()), SLOT(ui_compareCollection())));
+
+        QAction *watchCollection = new QAction("Watch Collection...", this);
+        VERIFY(connect(watchCollection, SIGNAL(triggered()), SLOT(ui_watchCollection())));
+
+        contextMenu()->addAction(viewCollection);
+
+        // fs.files and fs.chunks are browsed as bucket, not as documents of 255 KB binary chunks
+        std::string bucket;
+        if (GridFs::bucketOf(_collection->name(), bucket)) {
+            QAction *openBucket = new QAction("Open GridFS Bucket...", this);
+            VERIFY(connect(openBucket, SIGNAL(triggered()), SLOT(ui_openGridFsBucket())));
+            contextMenu()->addAction(openBucket);
+        }
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(addDocument);
+        contextMenu()->addAction(updateDocument);
+        contextMenu()->addAction(removeDocument);
+        contextMenu()->addAction(removeAllDocuments);
+        contextMenu()->addAction(updateInBatches);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(importDocuments);
+        contextMenu()->addAction(generateData);
+        contextMenu()->addAction(exportDocuments);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(renameCollection);
+        contextMenu()->addAction(duplicateCollection);
+        contextMenu()->addAction(copyCollectionToDiffrentServer);
+        contextMenu()->addAction(compareCollection);
+        contextMenu()->addAction(dropCollection);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(collectionStats);
+        contextMenu()->addAction(explainQuery);
+        contextMenu()->addAction(planCache);
+        contextMenu()->addAction(analyzeSchema);
+        contextMenu()->addAction(documentSizes);
+        contextMenu()->addAction(watchCollection);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(shardVersion);
+        contextMenu()->addAction(shardDistribution);
+        contextMenu()->addAction(shardFanout);
+    }
+
+    void ExplorerCollectionTreeItem::ensureIndexDir()
+    {
+        if (_indexDir)
+            return;
 
         AppRegistry::instance().bus()->subscribe(_databaseItem, LoadCollectionIndexesResponse::Type, this);
         AppRegistry::instance().bus()->subscribe(_databaseItem, AddEditIndexResponse::Type, this);
         AppRegistry::instance().bus()->subscribe(_databaseItem, DropCollectionIndexResponse::Type, this);
         AppRegistry::instance().bus()->subscribe(this, CollectionIndexesLoadingEvent::Type, this);
-
-        setText(0, QtUtils::toQString(_collection->name()));
-        setIcon(0, GuiRegistry::instance().collectionIcon());
+        AppRegistry::instance().bus()->subscribe(this, MongoDatabaseIndexUsageLoadedEvent::Type, 
+                                                 _collection->database());
+        AppRegistry::instance().bus()->subscribe(this, RollingIndexBuildProgressEvent::Type, 
+                                                 _collection->database()->server());
+        AppRegistry::instance().bus()->subscribe(this, RollingIndexBuildResponse::Type, 
+                                                 _collection->database()->server());
 
         _indexDir = new ExplorerCollectionIndexesDir(this);
         addChild(_indexDir);
-
-        setExpanded(false);
-        setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
     }
 
     void ExplorerCollectionTreeItem::handle(LoadCollectionIndexesResponse *event)
@@ -131,8 +237,29 @@ namespace Robomongo
             return;
         }
 
-        QtUtils::clearChildItems(_indexDir);
         const std::vector<IndexInfo> &indexes = event->indexes();
+        showIndexes(indexes);
+        MetadataSnapshot::instance().setIndexes(_collection->database()->server()->connectionRecord()->uuid(),
+                                                _collection->info().ns(), indexes);
+
+        updateIndexUsage();
+        _collection->database()->loadIndexUsage(_collection->name(), _forceIndexUsage);
+        _forceIndexUsage = false;
+    }
+
+    void ExplorerCollectionTreeItem::handle(PrefetchCollectionResponse *event)
+    {
+        // Background request, expand() loads indexes again and reports errors
+        if (event->isError())
+            return;
+
+        MetadataSnapshot::instance().setIndexes(_collection->database()->server()->connectionRecord()->uuid(),
+                                                _collection->info().ns(), event->indexes);
+    }
+
+    void ExplorerCollectionTreeItem::showIndexes(const std::vector<IndexInfo> &indexes)
+    {
+        QtUtils::clearChildItems(_indexDir);
 
         // Do not expand, when we do not have functions
         if (indexes.size() == 0)
@@ -144,6 +271,30 @@ namespace Robomongo
         _indexDir->setText(0, detail::buildName("Indexes", _indexDir->childCount()));
     }
 
+    void ExplorerCollectionTreeItem::handle(MongoDatabaseIndexUsageLoadedEvent *event)
+    {
+        if (event->collectionName == _collection->name())
+            updateIndexUsage();
+    }
+
+    void ExplorerCollectionTreeItem::updateIndexUsage()
+    {
+        const std::vector<IndexUsageInfo> *usage = _collection->database()->indexUsage(_collection->name());
+        if (!usage)
+            return;
+
+        for (int i = 0; i < _indexDir->childCount(); ++i) {
+            auto const item = dynamic_cast<ExplorerCollectionIndexItem *>(_indexDir->child(i));
+            if (!item)
+                continue;
+
+            auto const found = std::find_if(usage->begin(), usage->end(), 
+                [item](const IndexUsageInfo &info) { return info._name == item->info()._name; });
+            if (found != usage->end())
+                item->setUsage(*found);
+        }
+    }
+
     void ExplorerCollectionTreeItem::handle(AddEditIndexResponse *event)
     {
         bool const isAddIndex{ event->oldIndex_._name.empty() };
@@ -161,6 +312,9 @@ namespace Robomongo
         }
         LOG_MSG(("Succeeded to " + action + " index \"" + index + '\"').toStdString(), 
             mongo::logger::LogSeverity::Info());
+
+        // Indexes are sent again by worker, new index has no usage yet
+        _forceIndexUsage = true;
     }
 
     void ExplorerCollectionTreeItem::handle(DropCollectionIndexResponse *event)
@@ -177,8 +331,8 @@ namespace Robomongo
         }
 
         for (int i = 0; i < _indexDir->childCount(); ++i) {
-            QTreeWidgetItem *item = _indexDir->child(i);
-            if (item->text(0) == QString::fromStdString(event->index())) {
+            auto const item = dynamic_cast<ExplorerCollectionIndexItem *>(_indexDir->child(i));
+            if (item && item->info()._name == event->index()) {
                 removeChild(item);
                 delete item;
                 break;
@@ -191,6 +345,67 @@ namespace Robomongo
         _indexDir->setText(0, detail::buildName("Indexes", _indexDir->childCount()));
     }
 
+    bool ExplorerCollectionTreeItem::isOfThisCollection(const IndexInfo &info) const
+    {
+        return info._collection.ns().toString() == _collection->fullName();
+    }
+
+    void ExplorerCollectionTreeItem::handle(RollingIndexBuildProgressEvent *event)
+    {
+        if (!isOfThisCollection(event->newInfo) || !treeWidget())
+            return;
+
+        QProgressBar *progress = nullptr;
+        if (_indexBuildItem) {
+            progress = static_cast<QProgressBar *>(treeWidget()->itemWidget(_indexBuildItem, 0));
+        }
+        else {
+            _indexBuildItem = new QTreeWidgetItem(this);
+            progress = new QProgressBar;
+            progress->setMaximumHeight(treeWidget()->fontMetrics().height() + 4);
+            treeWidget()->setItemWidget(_indexBuildItem, 0, progress);
+        }
+
+        // Busy indicator, until server reports progress of build
+        if (event->total > 0) {
+            progress->setRange(0, 1000);
+            progress->setValue(static_cast<int>(event->done * 1000 / event->total));
+        }
+        else {
+            progress->setRange(0, 0);
+        }
+        progress->setFormat(QString("%1/%2 %3 %4")
+            .arg(event->step + 1).arg(event->steps)
+            .arg(QtUtils::toQString(event->description).replace('%', "%%"))
+            .arg(event->total > 0 ? "%p%" : "..."));
+        progress->setTextVisible(true);
+    }
+
+    void ExplorerCollectionTreeItem::handle(RollingIndexBuildResponse *event)
+    {
+        if (!isOfThisCollection(event->newInfo))
+            return;
+
+        delete _indexBuildItem;
+        _indexBuildItem = nullptr;
+
+        QString const index = QtUtils::toQString(event->newInfo._name);
+        if (event->isError()) {
+            QString const msg = "Rolling build of index \"" + index + "\" failed";
+            QString const err = QtUtils::toQString(event->error().errorMessage());
+            LOG_MSG((msg + ". " + err).toStdString(), mongo::logger::LogSeverity::Error());
+            QMessageBox::critical(nullptr, "Error: Operation failed", msg + "\n\n" + err);
+        }
+        else {
+            LOG_MSG(QString("Rolling build of index \"%1\" finished in %2 s.")
+                .arg(index).arg(event->elapsedMs / 1000.0, 0, 'f', 1).toStdString(),
+                mongo::logger::LogSeverity::Info());
+        }
+
+        // Failed build may leave temporary index, list shows it
+        refreshIndexes();
+    }
+
     void ExplorerCollectionTreeItem::handle(CollectionIndexesLoadingEvent *event)
     {
         _indexDir->setText(0, detail::buildName("Indexes", -1));
@@ -198,26 +413,66 @@ namespace Robomongo
 
     void ExplorerCollectionTreeItem::expand()
     {
+         ensureIndexDir();
+
+         // Indexes of the last session are shown until the server answers
+         if (_indexDir->childCount() == 0) {
+             auto const cached = MetadataSnapshot::instance().indexes(
+                 _collection->database()->server()->connectionRecord()->uuid(), _collection->info().ns());
+             if (cached && !cached->empty())
+                 showIndexes(*cached);
+         }
+
          AppRegistry::instance().bus()->publish(new CollectionIndexesLoadingEvent(this));
          if (_databaseItem) {
              _databaseItem->expandColection(this);
          }
     }
 
+    void ExplorerCollectionTreeItem::prefetch()
+    {
+        MongoServer *const server = _collection->database()->server();
+        MongoCollectionInfo const &info = _collection->info();
+        unsigned long long const generation = FirstPageCache::instance().focus(
+            QtUtils::toStdString(server->connectionRecord()->uuid()), info.fullName());
+
+        // Page is not read, if average size of documents (once stats are loaded) exceeds budget
+        int const batchSize = AppRegistry::instance().settingsManager()->batchSize();
+        const MongoCollectionInfo *stats = _collection->database()->collectionStats(_collection->name());
+        bool const readPage = !stats || stats->count() <= 0 ||
+            stats->sizeBytes() / stats->count() * batchSize <= FirstPageCache::BudgetBytes;
+        AppRegistry::instance().bus()->send(server->metadataWorker(),
+                                            new PrefetchCollectionRequest(this, info, generation, readPage));
+    }
+
+    void ExplorerCollectionTreeItem::refreshIndexes()
+    {
+        _forceIndexUsage = true;
+        expand();
+    }
+
     void ExplorerCollectionTreeItem::dropIndex(const QTreeWidgetItem * const ind)
     {
         if (!_databaseItem)
             return;
 
-        _databaseItem->dropIndexFromCollection(this, QtUtils::toStdString(ind->text(0)));
+        auto const item = dynamic_cast<const ExplorerCollectionIndexItem *>(ind);
+        if (item)
+            _databaseItem->dropIndexFromCollection(this, item->info()._name);
     }
 
-    QString ExplorerCollectionTreeItem::buildToolTip(MongoCollection *collection)
+    void ExplorerCollectionTreeItem::updateToolTip()
     {
-        // This function does not used now
-        char buff[2048] = {0};
-//        sprintf(buff,tooltipTemplate,collection->name().c_str(),collection->info().count(),collection->sizeString().c_str());
-        return buff;
+        const MongoCollectionInfo *stats = _collection->database()->collectionStats(_collection->name());
+        if (!stats)
+            return;
+
+        setToolTip(0, QString(tooltipTemplate)
+            .arg(QtUtils::toQString(_collection->name()).toHtmlEscaped())
+            .arg(stats->count())
+            .arg(MongoUtils::buildNiceSizeString(stats->sizeBytes()))
+            .arg(MongoUtils::buildNiceSizeString(stats->storageSizeBytes()))
+            .arg(MongoUtils::buildNiceSizeString(stats->totalIndexSizeBytes())));
     }
 
     void ExplorerCollectionTreeItem::ui_addDocument()
@@ -249,13 +504,24 @@ namespace Robomongo
     void ExplorerCollectionTreeItem::ui_removeAllDocuments()
     {
         MongoDatabase *database = _collection->database();
-        // Ask user
-        int answer = QMessageBox::question(treeWidget(),
-            "Remove All Documents",
+        // Ask user, one delete spikes oplog and lag of secondaries on large collections
+        QMessageBox question(QMessageBox::Question, "Remove All Documents",
             QString("Remove all documents from <b>%1</b> collection?").arg(QtUtils::toQString(_collection->name())),
-            QMessageBox::Yes, QMessageBox::No, QMessageBox::NoButton);
+            QMessageBox::NoButton, treeWidget());
+        QPushButton *removeNow = question.addButton(QMessageBox::Yes);
+        QPushButton *removeInBatches = question.addButton("In Batches...", QMessageBox::AcceptRole);
+        question.addButton(QMessageBox::No);
+        question.setDefaultButton(_collection->info().count() > LargeCollectionCount ? removeInBatches : removeNow);
+        question.exec();
+
+        if (question.clickedButton() == removeInBatches) {
+            auto dlg = new ThrottledWriteDialog(database->server(), QtUtils::toQString(database->name()),
+                                                QtUtils::toQString(_collection->name()), false, treeWidget());
+            dlg->show();
+            return;
+        }
 
-        if (answer == QMessageBox::Yes) {
+        if (question.clickedButton() == removeNow) {
             MongoServer *server = database->server();
             mongo::BSONObjBuilder builder;
             mongo::BSONObj bsonQuery = builder.obj();
@@ -322,6 +588,127 @@ namespace Robomongo
         }
     }
 
+    void ExplorerCollectionTreeItem::ui_exportDocuments()
+    {
+        MongoDatabase *database = _collection->database();
+        ExportDialog dlg(database->server(), QtUtils::toQString(database->name()),
+                         QtUtils::toQString(_collection->name()), treeWidget());
+        dlg.exec();
+    }
+
+    void ExplorerCollectionTreeItem::ui_explainQuery()
+    {
+        MongoDatabase *database = _collection->database();
+        auto dlg = new ExplainDialog(database->server(), QtUtils::toQString(database->name()),
+                                     QtUtils::toQString(_collection->name()), treeWidget());
+        VERIFY(connect(dlg, SIGNAL(createIndexRequested(const QString &)), 
+                       this, SLOT(ui_createSuggestedIndex(const QString &))));
+        dlg->show();
+    }
+
+    void ExplorerCollectionTreeItem::ui_planCache()
+    {
+        MongoDatabase *database = _collection->database();
+        auto dlg = new PlanCacheDialog(database->server(), QtUtils::toQString(database->name()),
+                                       QtUtils::toQString(_collection->name()), treeWidget());
+        dlg->show();
+    }
+
+    void ExplorerCollectionTreeItem::ui_openGridFsBucket()
+    {
+        std::string bucket;
+        if (!GridFs::bucketOf(_collection->name(), bucket))
+            return;
+
+        MongoDatabase *database = _collection->database();
+        auto dlg = new GridFsDialog(database->server(), QtUtils::toQString(database->name()),
+                                    QtUtils::toQString(bucket), treeWidget());
+        dlg->show();
+    }
+
+    void ExplorerCollectionTreeItem::ui_watchCollection()
+    {
+        MongoDatabase *database = _collection->database();
+        auto dlg = new ChangeStreamDialog(database->server(), QtUtils::toQString(database->name()),
+                                          QtUtils::toQString(_collection->name()), treeWidget());
+        dlg->show();
+    }
+
+    void ExplorerCollectionTreeItem::ui_analyzeSchema()
+    {
+        MongoDatabase *database = _collection->database();
+        auto dlg = new SchemaAnalysisDialog(database->server(), QtUtils::toQString(database->name()),
+                                            QtUtils::toQString(_collection->name()), treeWidget());
+        dlg->show();
+    }
+
+    void ExplorerCollectionTreeItem::ui_documentSizes()
+    {
+        MongoDatabase *database = _collection->database();
+        auto dlg = new DocumentSizesDialog(database->server(), QtUtils::toQString(database->name()),
+                                           QtUtils::toQString(_collection->name()), treeWidget());
+        VERIFY(connect(dlg, SIGNAL(openDocumentsRequested(const QString &)),
+                       this, SLOT(ui_openDocuments(const QString &))));
+        dlg->show();
+    }
+
+    void ExplorerCollectionTreeItem::ui_updateInBatches()
+    {
+        MongoDatabase *database = _collection->database();
+        auto dlg = new ThrottledWriteDialog(database->server(), QtUtils::toQString(database->name()),
+                                            QtUtils::toQString(_collection->name()), true, treeWidget());
+        dlg->show();
+    }
+
+    void ExplorerCollectionTreeItem::ui_generateData()
+    {
+        MongoDatabase *database = _collection->database();
+        auto dlg = new DataGeneratorDialog(database->server(), QtUtils::toQString(database->name()),
+                                           QtUtils::toQString(_collection->name()), treeWidget());
+        dlg->show();
+    }
+
+    void ExplorerCollectionTreeItem::ui_compareCollection()
+    {
+        MongoDatabase *database = _collection->database();
+        auto dlg = new CompareCollectionsDialog(database->server(), QtUtils::toQString(database->name()),
+                                                QtUtils::toQString(_collection->name()), treeWidget());
+        VERIFY(connect(dlg, SIGNAL(openDocumentsRequested(const QString &)),
+                       this, SLOT(ui_openDocuments(const QString &))));
+        dlg->show();
+    }
+
+    void ExplorerCollectionTreeItem::ui_openDocuments(const QString &script)
+    {
+        openCurrentCollectionShell(script);
+    }
+
+    void ExplorerCollectionTreeItem::ui_createSuggestedIndex(const QString &keys)
+    {
+        IndexInfo const fakeInfo(_collection->info(), "", QtUtils::toStdString(keys));
+        auto const& db { _databaseItem->database() };
+        AddEditIndexDialog dlg {
+            fakeInfo,
+            QtUtils::toQString(db->name()),
+            QtUtils::toQString(db->server()->connectionRecord()->getFullAddress()),
+            true,
+            treeWidget()
+        };
+        if (dlg.exec() != QDialog::Accepted)
+            return;
+
+        ensureIndexDir();   // to show progress of rolling build
+        _databaseItem->addEditIndex(this, fakeInfo, dlg.info(), dlg.isRollingBuild());
+    }
+
+    void ExplorerCollectionTreeItem::ui_importDocuments()
+    {
+        MongoDatabase *database = _collection->database();
+        ImportDialog dlg(database->server(), QtUtils::toQString(database->name()),
+                         QtUtils::toQString(_collection->name()), treeWidget());
+        dlg.exec();
+    }
+
     void ExplorerCollectionTreeItem::ui_copyToCollectionToDiffrentServer()
     {
         MongoDatabase *databaseFrom = _collection->database();
@@ -386,7 +773,18 @@ namespace Robomongo
 
     void ExplorerCollectionTreeItem::ui_shardDistribution()
     {
-        openCurrentCollectionShell("getShardDistribution()");
+        MongoDatabase *database = _collection->database();
+        auto dlg = new ShardDistributionDialog(database->server(), QtUtils::toQString(database->name()),
+                                               QtUtils::toQString(_collection->name()), treeWidget());
+        dlg->show();
+    }
+
+    void ExplorerCollectionTreeItem::ui_shardFanout()
+    {
+        MongoDatabase *database = _collection->database();
+        auto dlg = new ShardFanoutDialog(database->server(), QtUtils::toQString(database->name()),
+                                         QtUtils::toQString(_collection->name()), treeWidget());
+        dlg->show();
     }
 
     void ExplorerCollectionTreeItem::openCurrentCollectionShell(const QString &script, bool execute, const CursorPosition &cursor)
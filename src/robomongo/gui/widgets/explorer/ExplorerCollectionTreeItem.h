@@ -10,8 +10,12 @@
 namespace Robomongo
 {
     class LoadCollectionIndexesResponse;
+    class PrefetchCollectionResponse;
     struct AddEditIndexResponse;
     class DropCollectionIndexResponse;
+    class MongoDatabaseIndexUsageLoadedEvent;
+    class RollingIndexBuildProgressEvent;
+    class RollingIndexBuildResponse;
     class ExplorerCollectionIndexesDir;
     class ExplorerDatabaseTreeItem;
 
@@ -29,15 +33,35 @@ namespace Robomongo
         ExplorerCollectionTreeItem(QTreeWidgetItem *parent, ExplorerDatabaseTreeItem *databaseItem, MongoCollection *collection);
         MongoCollection *collection() const { return _collection; }
         void expand();
+
+        // Reloads indexes with their usage, even if cached usage is fresh
+        void refreshIndexes();
+
+        /**
+         * @brief Reads indexes and first page ahead, while item is focused, so that expand
+         *        and open show them at once (see FirstPageCache)
+         */
+        void prefetch();
+        void showContextMenuAtPos(const QPoint &pos) override;
         void dropIndex(const QTreeWidgetItem * const ind);
         void openCurrentCollectionShell(const QString &script, bool execute = true, const CursorPosition &cursor = CursorPosition());
         ExplorerDatabaseTreeItem *const databaseItem() const { return _databaseItem; }
 
+        /**
+         * @brief Shows count and sizes in tooltip, if database has stats of this collection
+         *        (see MongoDatabase::loadCollectionStats())
+         */
+        void updateToolTip();
+
     public Q_SLOTS:
         void handle(LoadCollectionIndexesResponse *event);
+        void handle(PrefetchCollectionResponse *event);
         void handle(AddEditIndexResponse *event);
         void handle(DropCollectionIndexResponse *event);
         void handle(CollectionIndexesLoadingEvent *event);
+        void handle(MongoDatabaseIndexUsageLoadedEvent *event);
+        void handle(RollingIndexBuildProgressEvent *event);
+        void handle(RollingIndexBuildResponse *event);
 
     private Q_SLOTS:
         void ui_addDocument();
@@ -50,15 +74,44 @@ namespace Robomongo
         void ui_totalSize();
         void ui_shardVersion();
         void ui_shardDistribution();
+        void ui_shardFanout();
         void ui_dropCollection();
         void ui_renameCollection();
         void ui_duplicateCollection();
+        void ui_exportDocuments();
+        void ui_importDocuments();
         void ui_copyToCollectionToDiffrentServer();
         void ui_viewCollection();
+        void ui_explainQuery();
+        void ui_planCache();
+        void ui_openGridFsBucket();
+        void ui_watchCollection();
+        void ui_analyzeSchema();
+        void ui_documentSizes();
+        void ui_generateData();
+        void ui_updateInBatches();
+        void ui_compareCollection();
+
+        // Opens documents picked in DocumentSizesDialog or CompareCollectionsDialog, 'script' is find() of them
+        void ui_openDocuments(const QString &script);
+
+        // Opens AddEditIndexDialog with key pattern suggested by ExplainDialog
+        void ui_createSuggestedIndex(const QString &keys);
 
     private:
-        QString buildToolTip(MongoCollection *collection);
-        ExplorerCollectionIndexesDir *_indexDir;
+        void buildContextMenu();
+        void ensureIndexDir();
+
+        bool isOfThisCollection(const IndexInfo &info) const;
+
+        // Replaces items of index folder, indexes are loaded or taken from MetadataSnapshot
+        void showIndexes(const std::vector<IndexInfo> &indexes);
+
+        // Shows cached usage of indexes (see MongoDatabase::indexUsage()) in their items
+        void updateIndexUsage();
+        ExplorerCollectionIndexesDir *_indexDir;   // created on first expand
+        bool _forceIndexUsage;                      // reload usage with the next indexes
+        QTreeWidgetItem *_indexBuildItem;           // progress of rolling index build, if running
         MongoCollection *const _collection;
         ExplorerDatabaseTreeItem *const _databaseItem;
     };
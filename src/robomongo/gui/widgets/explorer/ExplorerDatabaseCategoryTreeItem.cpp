@@ -1,6 +1,7 @@
 #include "robomongo/gui/widgets/explorer/ExplorerDatabaseCategoryTreeItem.h"
 
 #include <QAction>
+#include <QInputDialog>
 #include <QMenu>
 
 #include "robomongo/gui/dialogs/FunctionTextEditor.h"
@@ -41,10 +42,14 @@ namespace Robomongo
             QAction *refreshCollections = new QAction("Refresh", this);
             VERIFY(connect(refreshCollections, SIGNAL(triggered()), SLOT(ui_refreshCollections())));
 
-            BaseClass::_contextMenu->addAction(dbCollectionsStats);
-            BaseClass::_contextMenu->addAction(createCollection);
-            BaseClass::_contextMenu->addSeparator();
-            BaseClass::_contextMenu->addAction(refreshCollections);
+            QAction *filterCollections = new QAction("Filter...", this);
+            VERIFY(connect(filterCollections, SIGNAL(triggered()), SLOT(ui_filterCollections())));
+
+            contextMenu()->addAction(dbCollectionsStats);
+            contextMenu()->addAction(createCollection);
+            contextMenu()->addSeparator();
+            contextMenu()->addAction(filterCollections);
+            contextMenu()->addAction(refreshCollections);
         }
         else if (_category == Users) {
 
@@ -57,10 +62,10 @@ namespace Robomongo
             QAction *addUser = new QAction("Add User...", this);
             VERIFY(connect(addUser, SIGNAL(triggered()), SLOT(ui_addUser())));
 
-            BaseClass::_contextMenu->addAction(viewUsers);
-            BaseClass::_contextMenu->addAction(addUser);
-            BaseClass::_contextMenu->addSeparator();
-            BaseClass::_contextMenu->addAction(refreshUsers);
+            contextMenu()->addAction(viewUsers);
+            contextMenu()->addAction(addUser);
+            contextMenu()->addSeparator();
+            contextMenu()->addAction(refreshUsers);
         }
         else if (_category == Functions) {
 
@@ -73,10 +78,10 @@ namespace Robomongo
             QAction *addFunction = new QAction("Add Function...", this);
             VERIFY(connect(addFunction, SIGNAL(triggered()), SLOT(ui_addFunction())));
 
-            BaseClass::_contextMenu->addAction(viewFunctions);
-            BaseClass::_contextMenu->addAction(addFunction);
-            BaseClass::_contextMenu->addSeparator();
-            BaseClass::_contextMenu->addAction(refreshFunctions);
+            contextMenu()->addAction(viewFunctions);
+            contextMenu()->addAction(addFunction);
+            contextMenu()->addSeparator();
+            contextMenu()->addAction(refreshFunctions);
         }
 
         setExpanded(false);
@@ -85,8 +90,9 @@ namespace Robomongo
     
     void ExplorerDatabaseCategoryTreeItem::expand()
     {
+        // Folders were just loaded together with database, see ExplorerDatabaseTreeItem::expand()
         ExplorerDatabaseTreeItem *databaseItem = ExplorerDatabaseCategoryTreeItem::databaseItem();
-        if (!databaseItem)
+        if (!databaseItem || databaseItem->isMetadataFresh())
             return;
 
         switch(_category) {
@@ -225,4 +231,25 @@ namespace Robomongo
         if (databaseItem) 
             databaseItem->expandCollections();
     }
+
+    void ExplorerDatabaseCategoryTreeItem::ui_filterCollections()
+    {
+        ExplorerDatabaseTreeItem *databaseItem = ExplorerDatabaseCategoryTreeItem::databaseItem();
+        if (!databaseItem)
+            return;
+
+        // Filter is applied by server (listCollections), so huge databases are not loaded in full
+        bool ok = false;
+        QString const filter = QInputDialog::getText(treeWidget(), "Filter Collections",
+            "Show collections with names containing (empty to show all):", QLineEdit::Normal,
+            QtUtils::toQString(databaseItem->database()->collectionNameFilter()), &ok);
+        if (!ok)
+            return;
+
+        databaseItem->database()->setCollectionNameFilter(QtUtils::toStdString(filter.trimmed()));
+        if (isExpanded())
+            databaseItem->expandCollections();
+        else
+            setExpanded(true);  // Collections are loaded by expand()
+    }
 }
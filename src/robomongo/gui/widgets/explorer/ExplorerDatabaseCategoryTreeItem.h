@@ -24,12 +24,15 @@ namespace Robomongo
         typedef ExplorerTreeItem BaseClass;
         ExplorerDatabaseCategoryTreeItem(ExplorerDatabaseTreeItem *databaseItem, ExplorerDatabaseCategory category);
         void expand();
+        ExplorerDatabaseCategory category() const { return _category; }
+        ExplorerDatabaseTreeItem *databaseItem() const;
 
     private Q_SLOTS:
         void ui_createCollection();
         void ui_addUser();
         void ui_addFunction();
         void ui_refreshCollections();    
+        void ui_filterCollections();
         void ui_dbCollectionsStatistics();
         void ui_refreshUsers();
         void ui_refreshFunctions();
@@ -37,7 +40,6 @@ namespace Robomongo
         void ui_viewFunctions();
 
     private:
-        ExplorerDatabaseTreeItem *databaseItem() const;
         const ExplorerDatabaseCategory _category;
     };
 }
@@ -1,7 +1,9 @@
 #include "robomongo/gui/widgets/explorer/ExplorerDatabaseTreeItem.h"
 
+#include <memory>
 #include <QMessageBox>
 #include <QAction>
+#include <QInputDialog>
 #include <QMenu>
 
 #include "robomongo/core/domain/MongoDatabase.h"
@@ -15,11 +17,19 @@
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/EventBus.h"
 
+#include "robomongo/gui/widgets/explorer/AddEditIndexDialog.h"
 #include "robomongo/gui/widgets/explorer/ExplorerCollectionTreeItem.h"
 #include "robomongo/gui/widgets/explorer/ExplorerDatabaseCategoryTreeItem.h"
 #include "robomongo/gui/widgets/explorer/ExplorerUserTreeItem.h"
 #include "robomongo/gui/widgets/explorer/ExplorerFunctionTreeItem.h"
 #include "robomongo/gui/GuiRegistry.h"
+#include "robomongo/gui/dialogs/CollectionMaintenanceDialog.h"
+#include "robomongo/gui/dialogs/CurrentOpsDialog.h"
+#include "robomongo/gui/dialogs/DatabaseSearchDialog.h"
+#include "robomongo/gui/dialogs/CacheResidencyDialog.h"
+#include "robomongo/gui/dialogs/DatabaseStatsDialog.h"
+#include "robomongo/gui/dialogs/ProfilerDialog.h"
+#include "robomongo/gui/dialogs/WorkloadReplayDialog.h"
 
 
 namespace
@@ -61,6 +71,18 @@ namespace Robomongo
         QAction *dbStats = new QAction("Database Statistics", this);
         VERIFY(connect(dbStats, SIGNAL(triggered()), SLOT(ui_dbStatistics())));
 
+        QAction *dbCache = new QAction("Cache Residency", this);
+        VERIFY(connect(dbCache, SIGNAL(triggered()), SLOT(ui_dbCacheResidency())));
+
+        QAction *dbSearch = new QAction("Search Values...", this);
+        VERIFY(connect(dbSearch, SIGNAL(triggered()), SLOT(ui_dbSearch())));
+
+        QAction *dbProfiler = new QAction("Profiler", this);
+        VERIFY(connect(dbProfiler, SIGNAL(triggered()), SLOT(ui_dbProfiler())));
+
+        QAction *dbReplay = new QAction("Replay Workload...", this);
+        VERIFY(connect(dbReplay, SIGNAL(triggered()), SLOT(ui_dbReplayWorkload())));
+
         QAction *dbCurrOps = new QAction("Current Operations", this);
         VERIFY(connect(dbCurrOps, SIGNAL(triggered()), SLOT(ui_dbCurrentOps())));
 
@@ -76,18 +98,23 @@ namespace Robomongo
         QAction *refreshDatabase = new QAction("Refresh", this);
         VERIFY(connect(refreshDatabase, SIGNAL(triggered()), SLOT(ui_refreshDatabase())));
 
-        BaseClass::_contextMenu->addAction(openDbShellAction);
-        BaseClass::_contextMenu->addAction(refreshDatabase);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(dbStats);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(dbCurrOps);
-        BaseClass::_contextMenu->addAction(dbKillOp);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(dbRepair);
-        BaseClass::_contextMenu->addAction(dbDrop);
+        contextMenu()->addAction(openDbShellAction);
+        contextMenu()->addAction(refreshDatabase);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(dbStats);
+        contextMenu()->addAction(dbCache);
+        contextMenu()->addAction(dbSearch);
+        contextMenu()->addAction(dbProfiler);
+        contextMenu()->addAction(dbReplay);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(dbCurrOps);
+        contextMenu()->addAction(dbKillOp);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(dbRepair);
+        contextMenu()->addAction(dbDrop);
 
         _bus->subscribe(this, MongoDatabaseCollectionListLoadedEvent::Type, _database);
+        _bus->subscribe(this, MongoDatabaseCollectionStatsLoadedEvent::Type, _database);
         _bus->subscribe(this, MongoDatabaseUsersLoadedEvent::Type, _database);
         _bus->subscribe(this, MongoDatabaseFunctionsLoadedEvent::Type, _database);
         _bus->subscribe(this, MongoDatabaseCollectionsLoadingEvent::Type, _database);
@@ -117,13 +144,27 @@ namespace Robomongo
         setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
     }
 
+    void ExplorerDatabaseTreeItem::expand()
+    {
+        if (isMetadataFresh())
+            return;
+
+        _database->loadMetadata();
+        _metadataLoadedAt.start();
+    }
+
+    bool ExplorerDatabaseTreeItem::isMetadataFresh() const
+    {
+        return _metadataLoadedAt.isValid() && _metadataLoadedAt.elapsed() < MetadataFreshMs;
+    }
+
     void ExplorerDatabaseTreeItem::expandCollections() { _database->loadCollections(); }
 
     void ExplorerDatabaseTreeItem::expandUsers() { _database->loadUsers(); }
 
     void ExplorerDatabaseTreeItem::expandColection(ExplorerCollectionTreeItem *const item)
     {        
-         _bus->send(_database->server()->worker(), new LoadCollectionIndexesRequest(item, item->collection()->info()));
+         _bus->send(_database->server()->metadataWorker(), new LoadCollectionIndexesRequest(item, item->collection()->info()));
     }
 
     void ExplorerDatabaseTreeItem::dropIndexFromCollection(ExplorerCollectionTreeItem *const item, const std::string &indexName)
@@ -132,11 +173,89 @@ namespace Robomongo
     }
 
     void ExplorerDatabaseTreeItem::addEditIndex(
-        ExplorerCollectionTreeItem *const item, const IndexInfo &oldInfo, const IndexInfo &newInfo) const
+        ExplorerCollectionTreeItem *const item, const IndexInfo &oldInfo, const IndexInfo &newInfo, 
+        bool rolling) const
     {
+        if (rolling) {
+            _database->server()->rollingIndexBuild(oldInfo, newInfo);
+            return;
+        }
+
         _bus->send(_database->server()->worker(), new AddEditIndexRequest(item, oldInfo, newInfo));
     }
 
+    void ExplorerDatabaseTreeItem::showCollectionsContextMenu(const std::vector<std::string> &collections,
+                                                               const QPoint &pos)
+    {
+        int const count = static_cast<int>(collections.size());
+        QMenu menu(treeWidget());
+        QAction *createIndex = menu.addAction(QString("Create Index on %1 Collections...").arg(count));
+        QAction *dropIndex = menu.addAction(QString("Drop Index of %1 Collections...").arg(count));
+        menu.addSeparator();
+        QAction *renameCollections = menu.addAction(QString("Rename %1 Collections...").arg(count));
+        QAction *dropCollections = menu.addAction(QString("Drop %1 Collections...").arg(count));
+
+        QAction *const chosen = menu.exec(pos);
+        if (!chosen)
+            return;
+
+        QString const dbName = QtUtils::toQString(_database->name());
+        MongoCollectionInfo const first(MongoNamespace(_database->name(), collections.front()).toString());
+        std::unique_ptr<CollectionMaintenance::Action> action;
+        if (chosen == createIndex) {
+            AddEditIndexDialog dlg(IndexInfo(first, ""), dbName,
+                                   QtUtils::toQString(_database->server()->connectionRecord()->getFullAddress()),
+                                   true, treeWidget());
+            dlg.setWindowTitle(QString("Create Index on %1 Collections").arg(count));
+            if (dlg.exec() != QDialog::Accepted)
+                return;
+
+            action.reset(new CollectionMaintenance::Action(CollectionMaintenance::Action::CreateIndex, dlg.info()));
+        }
+        else if (chosen == dropIndex) {
+            bool ok = false;
+            QString const name = QInputDialog::getText(treeWidget(), "Drop Index",
+                QString("Name of index to drop from %1 collections:").arg(count), QLineEdit::Normal, "", &ok);
+            if (!ok || name.trimmed().isEmpty())
+                return;
+
+            action.reset(new CollectionMaintenance::Action(CollectionMaintenance::Action::DropIndex,
+                                                           IndexInfo(first, QtUtils::toStdString(name.trimmed()))));
+        }
+        else if (chosen == renameCollections) {
+            bool ok = false;
+            QString const placeholder = CollectionMaintenance::NamePlaceholder;
+            QString const pattern = QInputDialog::getText(treeWidget(), "Rename Collections",
+                QString("New names of %1 collections, %2 is the current name:").arg(count).arg(placeholder),
+                QLineEdit::Normal, placeholder + "_old", &ok);
+            if (!ok)
+                return;
+
+            if (!pattern.contains(placeholder)) {
+                QMessageBox::warning(treeWidget(), "Rename Collections",
+                                     QString("New names must contain %1.").arg(placeholder));
+                return;
+            }
+            action.reset(new CollectionMaintenance::Action(CollectionMaintenance::Action::RenameCollection,
+                                                           IndexInfo(first), QtUtils::toStdString(pattern)));
+        }
+        else if (chosen == dropCollections) {
+            auto const& buff = QString("Drop <b>%1</b> collections of <b>%2</b> database?").arg(count).arg(dbName);
+            int const answer = QMessageBox::question(treeWidget(), "Drop Collections", buff,
+                                                     QMessageBox::Yes, QMessageBox::No, QMessageBox::NoButton);
+            if (answer != QMessageBox::Yes)
+                return;
+
+            action.reset(new CollectionMaintenance::Action(CollectionMaintenance::Action::DropCollection));
+        }
+        if (!action)
+            return;
+
+        auto dlg = new CollectionMaintenanceDialog(_database->server(), dbName, collections, *action, treeWidget());
+        VERIFY(connect(dlg, SIGNAL(collectionsChanged()), this, SLOT(ui_refreshDatabase())));
+        dlg->show();
+    }
+
     void ExplorerDatabaseTreeItem::expandFunctions()
     {
         _database->loadFunctions();
@@ -145,38 +264,87 @@ namespace Robomongo
     void ExplorerDatabaseTreeItem::handle(MongoDatabaseCollectionListLoadedEvent *event)
     {
         if (event->isError()) {
-            _collectionFolderItem->setText(0, "Collections");
+            _collectionFolderItem->setText(0, collectionsFolderName());
             _collectionFolderItem->setExpanded(false);
             return;
         }
 
-        std::vector<MongoCollection *> collections = event->collections;
-        int count = collections.size();
-        _collectionFolderItem->setText(0, detail::buildName("Collections", count));
-        QtUtils::clearChildItems(_collectionFolderItem);
+        // First batch replaces previously loaded collections
+        if (event->batchIndex == 0) {
+            QtUtils::clearChildItems(_collectionFolderItem);
+            _collectionItems.clear();
+            _collectionCount = 0;
+
+            _collectionSystemFolderItem = new ExplorerTreeItem(_collectionFolderItem);
+            _collectionSystemFolderItem->setIcon(0, GuiRegistry::instance().folderIcon());
+            _collectionSystemFolderItem->setText(0, "System");
+            _collectionFolderItem->addChild(_collectionSystemFolderItem);
+        }
+
+        // Refresh removes only dropped collections, items of the others keep loaded indexes
+        for (auto const& name : event->removedNames) {
+            auto const item = _collectionItems.find(name);
+            if (item == _collectionItems.end())
+                continue;
+
+            delete item->second;
+            _collectionItems.erase(item);
+            --_collectionCount;
+        }
+
+        // Items of the whole batch are inserted at once, it is much faster than one by one
+        QList<QTreeWidgetItem *> items;
+        QList<QTreeWidgetItem *> systemItems;
+        for (MongoCollection *collection : event->collections) {
+            if (collection->isSystem())
+                systemItems.append(createCollectionItem(collection));
+            else
+                items.append(createCollectionItem(collection));
+        }
+        _collectionFolderItem->addChildren(items);
+        _collectionSystemFolderItem->addChildren(systemItems);
+        _collectionCount += event->collections.size();
+
+        if (!event->lastBatch) {    // Next page is on the way
+            _collectionFolderItem->setText(0, 
+                detail::buildName(collectionsFolderName(), _collectionCount).append(" ..."));
+            showCollectionSystemFolderIfNeeded();
+            return;
+        }
+
+        _collectionFolderItem->setText(0, detail::buildName(collectionsFolderName(), _collectionCount));
 
         // Do not expand, when we do not have collections
-        if (count == 0) {
+        if (_collectionCount == 0) {
             _collectionFolderItem->setExpanded(false);
             return;
         }
 
-        _collectionSystemFolderItem = new ExplorerTreeItem(_collectionFolderItem);
-        _collectionSystemFolderItem->setIcon(0, GuiRegistry::instance().folderIcon());
-        _collectionSystemFolderItem->setText(0, "System");
-        _collectionFolderItem->addChild(_collectionSystemFolderItem);
+        // Every batch is sorted, but batches are not sorted between each other
+        if (event->batchIndex > 0) {
+            _collectionFolderItem->removeChild(_collectionSystemFolderItem);
+            _collectionFolderItem->sortChildren(0, Qt::AscendingOrder);
+            _collectionFolderItem->insertChild(0, _collectionSystemFolderItem);
+        }
 
-        for (int i = 0; i < collections.size(); ++i) {
-            MongoCollection *collection = collections[i];
+        showCollectionSystemFolderIfNeeded();
+    }
 
-            if (collection->isSystem()) {
-                addSystemCollectionItem(collection);
-            } else {
-                addCollectionItem(collection);
-            }
+    void ExplorerDatabaseTreeItem::handle(MongoDatabaseCollectionStatsLoadedEvent *event)
+    {
+        for (auto const& name : event->collectionNames) {
+            auto const item = _collectionItems.find(name);
+            if (item != _collectionItems.end())
+                item->second->updateToolTip();
         }
+    }
 
-        showCollectionSystemFolderIfNeeded();
+    QString ExplorerDatabaseTreeItem::collectionsFolderName() const
+    {
+        if (_database->collectionNameFilter().empty())
+            return "Collections";
+
+        return QString("Collections [%1]").arg(QtUtils::toQString(_database->collectionNameFilter()));
     }
 
     void ExplorerDatabaseTreeItem::handle(MongoDatabaseUsersLoadedEvent *event)
@@ -226,7 +394,7 @@ namespace Robomongo
 
     void ExplorerDatabaseTreeItem::handle(MongoDatabaseCollectionsLoadingEvent *event)
     {
-        _collectionFolderItem->setText(0, detail::buildName("Collections", -1));
+        _collectionFolderItem->setText(0, detail::buildName(collectionsFolderName(), -1));
     }
 
     void ExplorerDatabaseTreeItem::handle(MongoDatabaseFunctionsLoadingEvent *event)
@@ -239,18 +407,13 @@ namespace Robomongo
         _usersFolderItem->setText(0, detail::buildName("Users", -1));
     }
 
-    void ExplorerDatabaseTreeItem::addCollectionItem(MongoCollection *collection)
+    ExplorerCollectionTreeItem *ExplorerDatabaseTreeItem::createCollectionItem(MongoCollection *collection)
     {
-        auto collectionItem = new ExplorerCollectionTreeItem(_collectionFolderItem, this, collection);
+        // Created without parent, so that the view is updated once per batch and not per item
+        auto collectionItem = new ExplorerCollectionTreeItem(nullptr, this, collection);
         collectionItem->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
-        _collectionFolderItem->addChild(collectionItem);
-    }
-
-    void ExplorerDatabaseTreeItem::addSystemCollectionItem(MongoCollection *collection)
-    {
-        auto collectionItem = new ExplorerCollectionTreeItem(_collectionSystemFolderItem, this, collection);
-        collectionItem->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
-        _collectionSystemFolderItem->addChild(collectionItem);
+        _collectionItems[collection->name()] = collectionItem;
+        return collectionItem;
     }
 
     void ExplorerDatabaseTreeItem::showCollectionSystemFolderIfNeeded()
@@ -277,17 +440,45 @@ namespace Robomongo
 
     void ExplorerDatabaseTreeItem::ui_dbStatistics()
     {
-        openCurrentDatabaseShell(_database, "db.stats()");
+        DatabaseStatsDialog dlg(_database->server(), QtUtils::toQString(_database->name()), treeWidget());
+        dlg.exec();
+    }
+
+    void ExplorerDatabaseTreeItem::ui_dbCacheResidency()
+    {
+        auto dlg = new CacheResidencyDialog(_database->server(), QtUtils::toQString(_database->name()), treeWidget());
+        dlg->show();
+    }
+
+    void ExplorerDatabaseTreeItem::ui_dbSearch()
+    {
+        auto dlg = new DatabaseSearchDialog(_database->server(), QtUtils::toQString(_database->name()), treeWidget());
+        dlg->show();
+    }
+
+    void ExplorerDatabaseTreeItem::ui_dbProfiler()
+    {
+        auto dlg = new ProfilerDialog(_database->server(), QtUtils::toQString(_database->name()), treeWidget());
+        dlg->show();
+    }
+
+    void ExplorerDatabaseTreeItem::ui_dbReplayWorkload()
+    {
+        auto dlg = new WorkloadReplayDialog(_database->server(), QtUtils::toQString(_database->name()),
+                                            treeWidget());
+        dlg->show();
     }
 
     void ExplorerDatabaseTreeItem::ui_dbCurrentOps()
     {
-        openCurrentDatabaseShell(_database, "db.currentOp()");
+        auto dlg = new CurrentOpsDialog(_database->server(), QtUtils::toQString(_database->name()), treeWidget());
+        dlg->show();
     }
 
     void ExplorerDatabaseTreeItem::ui_dbKillOp()
     {
-        openCurrentDatabaseShell(_database, "db.killOp()", false, CursorPosition(0, -1));
+        // Operations are killed by selection in monitor
+        ui_dbCurrentOps();
     }
 
     void ExplorerDatabaseTreeItem::ui_dbDrop()
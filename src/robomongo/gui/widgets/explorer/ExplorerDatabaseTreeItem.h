@@ -1,5 +1,10 @@
 #pragma once
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <QElapsedTimer>
+
 #include "robomongo/gui/widgets/explorer/ExplorerTreeItem.h"
 
 namespace Robomongo
@@ -13,6 +18,7 @@ namespace Robomongo
     class ExplorerDatabaseCategoryTreeItem;
     class EventBus;
     class MongoDatabaseCollectionListLoadedEvent;
+    class MongoDatabaseCollectionStatsLoadedEvent;
     class MongoDatabaseUsersLoadedEvent;
     class MongoDatabaseFunctionsLoadedEvent;
     class MongoDatabaseCollectionsLoadingEvent;
@@ -33,16 +39,34 @@ namespace Robomongo
         ExplorerDatabaseTreeItem(QTreeWidgetItem *parent, MongoDatabase *const database);
 
         MongoDatabase *database() const { return _database; }
+
+        // Loads all folders at once, see MongoDatabase::loadMetadata()
+        void expand();
+
+        // True shortly after expand(), folders expanded then are not loaded again
+        bool isMetadataFresh() const;
+
         void expandCollections();
         void expandUsers();
         void expandFunctions();
         void expandColection(ExplorerCollectionTreeItem *const item);
         void dropIndexFromCollection(ExplorerCollectionTreeItem *const item, const std::string &indexName);
+        /**
+         * @param rolling Build index with MongoServer::rollingIndexBuild(), its progress is
+         *        shown by 'item'
+         */
         void addEditIndex(ExplorerCollectionTreeItem *const item, 
-                          const IndexInfo &oldInfo, const IndexInfo &newInfo) const;
+                          const IndexInfo &oldInfo, const IndexInfo &newInfo, bool rolling = false) const;
+
+        /**
+         * @brief Menu of actions run on all 'collections' at once (see CollectionMaintenanceDialog),
+         *        shown instead of menu of collection, when several are selected
+         */
+        void showCollectionsContextMenu(const std::vector<std::string> &collections, const QPoint &pos);
 
     public Q_SLOTS:
         void handle(MongoDatabaseCollectionListLoadedEvent *event);
+        void handle(MongoDatabaseCollectionStatsLoadedEvent *event);
         void handle(MongoDatabaseUsersLoadedEvent *event);
         void handle(MongoDatabaseFunctionsLoadedEvent *event);
         void handle(MongoDatabaseCollectionsLoadingEvent *event);
@@ -51,6 +75,10 @@ namespace Robomongo
 
     private Q_SLOTS:
         void ui_dbStatistics();
+        void ui_dbCacheResidency();
+        void ui_dbSearch();
+        void ui_dbProfiler();
+        void ui_dbReplayWorkload();
         void ui_dbCurrentOps();
         void ui_dbKillOp();
         void ui_dbDrop();
@@ -59,9 +87,9 @@ namespace Robomongo
         void ui_refreshDatabase();
 
     private:
-        void addCollectionItem(MongoCollection *collection);
-        void addSystemCollectionItem(MongoCollection *collection);
+        ExplorerCollectionTreeItem *createCollectionItem(MongoCollection *collection);
         void showCollectionSystemFolderIfNeeded();
+        QString collectionsFolderName() const;     // with name filter, if any
 
         void addUserItem(MongoDatabase *database, const MongoUser &user);
         void addFunctionItem(MongoDatabase *database, const MongoFunction &function);
@@ -71,6 +99,10 @@ namespace Robomongo
         ExplorerDatabaseCategoryTreeItem *_functionsFolderItem;
         ExplorerDatabaseCategoryTreeItem *_usersFolderItem;
         ExplorerTreeItem *_collectionSystemFolderItem;
+        int _collectionCount = 0;   // loaded so far, collections are loaded in batches
+        std::unordered_map<std::string, ExplorerCollectionTreeItem *> _collectionItems;  // by name
         MongoDatabase *const _database;
+        QElapsedTimer _metadataLoadedAt;
+        static const int MetadataFreshMs = 10000;
     };
 }
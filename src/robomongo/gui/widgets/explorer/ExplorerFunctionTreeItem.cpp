@@ -27,8 +27,8 @@ namespace Robomongo
         QAction *editFunction = new QAction("Edit Function", this);
         VERIFY(connect(editFunction, SIGNAL(triggered()), SLOT(ui_editFunction())));
 
-        BaseClass::_contextMenu->addAction(editFunction);
-        BaseClass::_contextMenu->addAction(dropFunction);
+        contextMenu()->addAction(editFunction);
+        contextMenu()->addAction(dropFunction);
 
         setText(0, QtUtils::toQString(_function.name()));
         setIcon(0, GuiRegistry::instance().functionIcon());
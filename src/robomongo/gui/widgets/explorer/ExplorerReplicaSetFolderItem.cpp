@@ -41,9 +41,9 @@ namespace Robomongo
         auto refresh = new QAction("Refresh", this);
         VERIFY(connect(refresh, SIGNAL(triggered()), SLOT(on_refresh())));
 
-        BaseClass::_contextMenu->addAction(repSetStatus);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(refresh);
+        contextMenu()->addAction(repSetStatus);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(refresh);
 
         AppRegistry::instance().bus()->subscribe(this, ReplicaSetFolderLoading::Type, _server);
 
@@ -61,7 +61,7 @@ namespace Robomongo
 
     void ExplorerReplicaSetFolderItem::disableSomeContextMenuActions()
     {
-        if (BaseClass::_contextMenu->actions().size() < 1)
+        if (contextMenu()->actions().size() < 1)
             return;
 
         // Find out if there is at least one reachable member  
@@ -75,7 +75,7 @@ namespace Robomongo
 
         // Show menu item "Status of Replica Set" only if there is at least one reachable member
         // If there is no reachable member, disable it.
-        BaseClass::_contextMenu->actions().at(0)->setDisabled(onlineMember.empty());
+        contextMenu()->actions().at(0)->setDisabled(onlineMember.empty());
     }
 
     void ExplorerReplicaSetFolderItem::expand()
@@ -85,7 +85,7 @@ namespace Robomongo
             return;
         }
 
-        _server->tryRefreshReplicaSetFolder(true);
+        _server->expandReplicaSetFolder();
     }
 
     void ExplorerReplicaSetFolderItem::on_repSetStatus()
@@ -72,14 +72,14 @@ namespace Robomongo
         auto showLog = new QAction("Show Log", this);
         VERIFY(connect(showLog, SIGNAL(triggered()), SLOT(ui_showLog()))); 
 
-        BaseClass::_contextMenu->addAction(openShellAction);
-        BaseClass::_contextMenu->addAction(openDirectConnection);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(serverStatus);
-        BaseClass::_contextMenu->addAction(serverHostInfo);
-        BaseClass::_contextMenu->addAction(serverVersion);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(showLog);
+        contextMenu()->addAction(openShellAction);
+        contextMenu()->addAction(openDirectConnection);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(serverStatus);
+        contextMenu()->addAction(serverHostInfo);
+        contextMenu()->addAction(serverVersion);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(showLog);
 
         updateTextAndIcon(_isUp, _isPrimary);
 
@@ -1,5 +1,7 @@
 #include "robomongo/gui/widgets/explorer/ExplorerServerTreeItem.h"
 
+#include <unordered_set>
+
 #include <QAction>
 #include <QMenu>
 #include <QMessageBox>
@@ -7,6 +9,7 @@
 #include "robomongo/core/domain/MongoServer.h"
 #include "robomongo/core/domain/MongoDatabase.h"
 #include "robomongo/core/domain/App.h"
+#include "robomongo/core/mongodb/WireCompression.h"
 #include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/settings/ReplicaSetSettings.h"
 #include "robomongo/core/utils/QtUtils.h"
@@ -17,6 +20,10 @@
 #include "robomongo/gui/widgets/explorer/ExplorerReplicaSetFolderItem.h"
 #include "robomongo/gui/widgets/explorer/ExplorerReplicaSetTreeItem.h"
 #include "robomongo/gui/dialogs/CreateDatabaseDialog.h"
+#include "robomongo/gui/dialogs/OplogDialog.h"
+#include "robomongo/gui/dialogs/QueryHistoryDialog.h"
+#include "robomongo/gui/dialogs/QueryTemplatesDialog.h"
+#include "robomongo/gui/dialogs/ServerStatusDialog.h"
 #include "robomongo/gui/GuiRegistry.h"
 
 
@@ -34,7 +41,7 @@ namespace Robomongo
 {
     ExplorerServerTreeItem::ExplorerServerTreeItem(QTreeWidget *view, MongoServer *const server, ConnectionInfo connInfo)
         : BaseClass(view), _server(server), _bus(AppRegistry::instance().bus()), _replicaSetFolder(nullptr),
-        _primaryWasUnreachable(false), _systemFolder(nullptr)
+        _primaryWasUnreachable(false), _systemFolder(nullptr), _liveUpdates(nullptr), _oplog(nullptr)
     {
         auto openShellAction = new QAction("Open Shell", this);        
 #ifdef __APPLE__
@@ -53,6 +60,9 @@ namespace Robomongo
         QAction *serverStatus = new QAction("Server Status", this);
         VERIFY(connect(serverStatus, SIGNAL(triggered()), SLOT(ui_serverStatus())));
 
+        QAction *serverStatusDashboard = new QAction("Server Status Dashboard", this);
+        VERIFY(connect(serverStatusDashboard, SIGNAL(triggered()), SLOT(ui_serverStatusDashboard())));
+
         QAction *serverVersion = new QAction("MongoDB Version", this);
         VERIFY(connect(serverVersion, SIGNAL(triggered()), SLOT(ui_serverVersion())));
 
@@ -62,26 +72,52 @@ namespace Robomongo
         QAction *showLog = new QAction("Show Log", this);
         VERIFY(connect(showLog, SIGNAL(triggered()), SLOT(ui_showLog())));
 
+        QAction *queryHistory = new QAction("Query History...", this);
+        queryHistory->setToolTip("Search and replay scripts executed with this connection");
+        VERIFY(connect(queryHistory, SIGNAL(triggered()), SLOT(ui_queryHistory())));
+
+        QAction *queryTemplates = new QAction("Query Templates...", this);
+        queryTemplates->setToolTip("Run saved queries with parameters, without JavaScript");
+        VERIFY(connect(queryTemplates, SIGNAL(triggered()), SLOT(ui_queryTemplates())));
+
         QAction *disconnectAction = new QAction("Disconnect", this);
         disconnectAction->setIconText("Disconnect");
         VERIFY(connect(disconnectAction, SIGNAL(triggered()), SLOT(ui_disconnectServer())));
 
-        BaseClass::_contextMenu->addAction(openShellAction);
-        BaseClass::_contextMenu->addAction(refreshServer);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(createDatabase);
-        BaseClass::_contextMenu->addAction(serverStatus);
-        BaseClass::_contextMenu->addAction(serverHostInfo);
-        BaseClass::_contextMenu->addAction(serverVersion);
-        BaseClass::_contextMenu->addSeparator();
-        BaseClass::_contextMenu->addAction(showLog);
-        BaseClass::_contextMenu->addAction(disconnectAction);
+        _liveUpdates = new QAction("Live Updates", this);
+        _liveUpdates->setCheckable(true);
+        _liveUpdates->setToolTip("Follow created, dropped and renamed collections and databases "
+                                 "with change stream (replica set or sharded cluster only)");
+        VERIFY(connect(_liveUpdates, SIGNAL(triggered(bool)), SLOT(ui_liveUpdates(bool))));
+
+        _oplog = new QAction("Oplog...", this);
+        _oplog->setToolTip("Live entries of local.oplog.rs (replica set only)");
+        VERIFY(connect(_oplog, SIGNAL(triggered()), SLOT(ui_oplog())));
+        VERIFY(connect(contextMenu(), SIGNAL(aboutToShow()), SLOT(ui_contextMenuAboutToShow())));
+
+        contextMenu()->addAction(openShellAction);
+        contextMenu()->addAction(refreshServer);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(createDatabase);
+        contextMenu()->addAction(serverStatus);
+        contextMenu()->addAction(serverStatusDashboard);
+        contextMenu()->addAction(serverHostInfo);
+        contextMenu()->addAction(serverVersion);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(showLog);
+        contextMenu()->addAction(queryHistory);
+        contextMenu()->addAction(queryTemplates);
+        contextMenu()->addAction(disconnectAction);
+        contextMenu()->addSeparator();
+        contextMenu()->addAction(_liveUpdates);
+        contextMenu()->addAction(_oplog);
 
         _bus->subscribe(this, DatabaseListLoadedEvent::Type, _server);
         _bus->subscribe(this, MongoServerLoadingDatabasesEvent::Type, _server);
         _bus->subscribe(this, ReplicaSetFolderRefreshed::Type, _server);
         _bus->subscribe(this, ConnectionEstablishedEvent::Type, _server);
         _bus->subscribe(this, ConnectionFailedEvent::Type, _server);
+        _bus->subscribe(this, ServerHealthCheckedEvent::Type, _server);
 
         setText(0, buildServerName());
         setIcon(0, _server->connectionRecord()->isReplicaSet() ? GuiRegistry::instance().replicaSetIcon()
@@ -107,18 +143,18 @@ namespace Robomongo
 
     void ExplorerServerTreeItem::disableSomeContextMenuActions(bool disable)
     {
-        if (BaseClass::_contextMenu->actions().size() < 10 || 
+        if (contextMenu()->actions().size() < 10 || 
             !_server->connectionRecord()->isReplicaSet())
             return;
 
         // [1]:Refresh and [9]:Disconnect are always enabled
-        BaseClass::_contextMenu->actions().at(0)->setDisabled(disable);
-        BaseClass::_contextMenu->actions().at(2)->setDisabled(disable);
-        BaseClass::_contextMenu->actions().at(3)->setDisabled(disable);
-        BaseClass::_contextMenu->actions().at(4)->setDisabled(disable);
-        BaseClass::_contextMenu->actions().at(5)->setDisabled(disable);
-        BaseClass::_contextMenu->actions().at(6)->setDisabled(disable);
-        BaseClass::_contextMenu->actions().at(8)->setDisabled(disable);
+        contextMenu()->actions().at(0)->setDisabled(disable);
+        contextMenu()->actions().at(2)->setDisabled(disable);
+        contextMenu()->actions().at(3)->setDisabled(disable);
+        contextMenu()->actions().at(4)->setDisabled(disable);
+        contextMenu()->actions().at(5)->setDisabled(disable);
+        contextMenu()->actions().at(6)->setDisabled(disable);
+        contextMenu()->actions().at(8)->setDisabled(disable);
     }
 
     void ExplorerServerTreeItem::databaseRefreshed(const QList<MongoDatabase *> &dbs)
@@ -177,7 +213,48 @@ namespace Robomongo
             return;
         }
 
-        databaseRefreshed(event->list);
+        // The first list builds items, refreshes only add and remove them, so that expanded
+        // databases keep their loaded collections
+        if (!_systemFolder)
+            databaseRefreshed(event->list);
+        else
+            applyDatabaseChanges(event->list.count(), event->added, event->removedNames);
+    }
+
+    void ExplorerServerTreeItem::applyDatabaseChanges(int count, const QList<MongoDatabase *> &added,
+                                                      const std::vector<std::string> &removedNames)
+    {
+        setText(0, buildServerName(&count));
+
+        std::unordered_set<std::string> const removed(removedNames.begin(), removedNames.end());
+        for (QTreeWidgetItem *parent : { static_cast<QTreeWidgetItem *>(this), 
+                                         static_cast<QTreeWidgetItem *>(_systemFolder) }) {
+            for (int i = parent->childCount() - 1; i >= 0; --i) {
+                auto const dbItem = dynamic_cast<ExplorerDatabaseTreeItem *>(parent->child(i));
+                if (dbItem && removed.count(dbItem->database()->name()))
+                    delete dbItem;
+            }
+        }
+
+        for (MongoDatabase *database : added) {
+            QTreeWidgetItem *parent = database->isSystem() ? static_cast<QTreeWidgetItem *>(_systemFolder) 
+                                                           : static_cast<QTreeWidgetItem *>(this);
+
+            // Databases are listed by name, as server returns them
+            int index = parent->childCount();
+            for (int i = 0; i < parent->childCount(); ++i) {
+                auto const dbItem = dynamic_cast<ExplorerDatabaseTreeItem *>(parent->child(i));
+                if (dbItem && dbItem->database()->name() > database->name()) {
+                    index = i;
+                    break;
+                }
+            }
+            auto dbItem = new ExplorerDatabaseTreeItem(parent, database);
+            parent->takeChild(parent->indexOfChild(dbItem));
+            parent->insertChild(index, dbItem);
+        }
+
+        _systemFolder->setHidden(_systemFolder->childCount() == 0);
     }
 
     void ExplorerServerTreeItem::handle(MongoServerLoadingDatabasesEvent *event)
@@ -186,9 +263,20 @@ namespace Robomongo
         setText(0, buildServerName(&count));
     }
 
+    void ExplorerServerTreeItem::handle(ServerHealthCheckedEvent *event)
+    {
+        QString toolTip = "Ping: " + QtUtils::toQString(_server->rttHistogram().toString());
+        std::string const compression = 
+            WireCompression::describe(WireCompression::stats(_server->connectionRecord()));
+        if (!compression.empty())
+            toolTip += "\nWire compression: " + QtUtils::toQString(compression);
+        setToolTip(0, toolTip);
+    }
+
     void ExplorerServerTreeItem::handle(ReplicaSetFolderRefreshed *event)
     {
-        buildReplicaSetFolder(event->expanded);    // Rebuild replica set folder in any case
+        // Rebuild replica set folder in any case. Updates pushed by topology monitor keep it expanded.
+        buildReplicaSetFolder(event->expanded || (_replicaSetFolder && _replicaSetFolder->isExpanded()));
 
         // ---Primary is unreachable
         if (event->isError()) {
@@ -259,11 +347,50 @@ namespace Robomongo
         openCurrentServerShell(_server, "db.serverStatus()");
     }
 
+    void ExplorerServerTreeItem::ui_serverStatusDashboard()
+    {
+        auto dlg = new ServerStatusDialog(_server, treeWidget());
+        dlg->show();
+    }
+
+    void ExplorerServerTreeItem::ui_queryHistory()
+    {
+        auto dlg = new QueryHistoryDialog(_server, treeWidget());
+        dlg->show();
+    }
+
+    void ExplorerServerTreeItem::ui_queryTemplates()
+    {
+        auto dlg = new QueryTemplatesDialog(_server, treeWidget());
+        dlg->show();
+    }
+
     void ExplorerServerTreeItem::ui_serverVersion()
     {
         openCurrentServerShell(_server, "db.version()");
     }
 
+    void ExplorerServerTreeItem::ui_liveUpdates(bool enabled)
+    {
+        _server->setLiveExplorer(enabled);
+    }
+
+    void ExplorerServerTreeItem::ui_oplog()
+    {
+        // One panel per replica set, it is raised if it is open already
+        if (!_oplogDialog)
+            _oplogDialog = new OplogDialog(_server, treeWidget());
+        _oplogDialog->show();
+        _oplogDialog->raise();
+        _oplogDialog->activateWindow();
+    }
+
+    void ExplorerServerTreeItem::ui_contextMenuAboutToShow()
+    {
+        _liveUpdates->setChecked(_server->liveExplorer());
+        _oplog->setVisible(_server->connectionRecord()->isReplicaSet());
+    }
+
     void ExplorerServerTreeItem::ui_showLog()
     {
         openCurrentServerShell(_server, "show log");
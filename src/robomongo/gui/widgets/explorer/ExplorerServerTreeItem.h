@@ -3,12 +3,20 @@
 #include "robomongo/core/events/MongoEvents.h"
 #include "robomongo/gui/widgets/explorer/ExplorerTreeItem.h"
 
+#include <QPointer>
+
+QT_BEGIN_NAMESPACE
+class QAction;
+QT_END_NAMESPACE
+
 namespace Robomongo
 {
     class EventBus;
     class MongoServerLoadingDatabasesEvent;
+    class ServerHealthCheckedEvent;
     class ExplorerReplicaSetFolderItem;
     class ExplorerTreeItem;
+    class OplogDialog;
 
     class ExplorerServerTreeItem : public ExplorerTreeItem
     {
@@ -36,6 +44,7 @@ namespace Robomongo
         void handle(DatabaseListLoadedEvent *event);
         void handle(MongoServerLoadingDatabasesEvent *event);
         void handle(ReplicaSetFolderRefreshed *event);
+        void handle(ServerHealthCheckedEvent *event);
 
         // Special handle for server refresh events for replica set connections only
         void handle(ConnectionEstablishedEvent *event);
@@ -45,13 +54,21 @@ namespace Robomongo
 
     private Q_SLOTS:
         void ui_showLog();
+        void ui_queryHistory();
+        void ui_queryTemplates();
         void ui_openShell();
         void ui_disconnectServer();
         void ui_refreshServer();
         void ui_createDatabase();
         void ui_serverHostInfo();
         void ui_serverStatus();
+        void ui_serverStatusDashboard();
         void ui_serverVersion();
+        void ui_liveUpdates(bool enabled);
+        void ui_oplog();
+
+        // Stream is closed by server on errors, check mark follows it
+        void ui_contextMenuAboutToShow();
 
     private:
 
@@ -66,6 +83,10 @@ namespace Robomongo
         // so existing db items should be deleted before calling this function.
         void buildDatabaseItems();  
 
+        // Adds and removes database items after refresh of single server, keeps the other ones
+        void applyDatabaseChanges(int count, const QList<MongoDatabase *> &added,
+                                  const std::vector<std::string> &removedNames);
+
         void replicaSetPrimaryReachable();
         void replicaSetPrimaryUnreachable();
 
@@ -79,6 +100,9 @@ namespace Robomongo
 
         ExplorerReplicaSetFolderItem *_replicaSetFolder;
         ExplorerTreeItem *_systemFolder;
+        QAction *_liveUpdates;
+        QAction *_oplog;
+        QPointer<OplogDialog> _oplogDialog;
 
         MongoServer *const _server;
         EventBus *_bus;
@@ -7,25 +7,35 @@
 namespace Robomongo
 {
     ExplorerTreeItem::ExplorerTreeItem(QTreeWidgetItem *parent)
-        :QObject(), BaseClass(parent), _contextMenu(new QMenu(treeWidget()) )
+        :QObject(), BaseClass(parent)
     {
 
     }
 
     ExplorerTreeItem::ExplorerTreeItem(QTreeWidget *view)
-        :QObject(view), BaseClass(view), _contextMenu(new QMenu(view) )
+        :QObject(view), BaseClass(view)
     {
 
     }
 
+    QMenu *ExplorerTreeItem::contextMenu()
+    {
+        if (!_contextMenu)
+            _contextMenu = new QMenu(treeWidget());
+
+        return _contextMenu;
+    }
+
     void ExplorerTreeItem::showContextMenuAtPos(const QPoint &pos)
     {
-        _contextMenu->exec(pos);
+        contextMenu()->exec(pos);
     }
 
     ExplorerTreeItem::~ExplorerTreeItem()
     {
-        _contextMenu->deleteLater();
+        if (_contextMenu)
+            _contextMenu->deleteLater();
+
         QtUtils::clearChildItems(this);
     }
 }
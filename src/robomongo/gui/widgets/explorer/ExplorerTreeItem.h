@@ -19,6 +19,12 @@ namespace Robomongo
         virtual ~ExplorerTreeItem();
 
     protected:
-        QMenu *const _contextMenu;
+        /**
+         * @brief Context menu of this item, created on first use
+         */
+        QMenu *contextMenu();
+
+    private:
+        QMenu *_contextMenu = nullptr;
     };
 }
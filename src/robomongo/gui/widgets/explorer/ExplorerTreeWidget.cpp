@@ -2,10 +2,24 @@
 
 #include "robomongo/gui/widgets/explorer/ExplorerTreeItem.h"
 #include "robomongo/gui/widgets/explorer/ExplorerDatabaseTreeItem.h"
+#include "robomongo/gui/widgets/explorer/ExplorerDatabaseCategoryTreeItem.h"
+#include "robomongo/gui/widgets/explorer/ExplorerCollectionTreeItem.h"
 #include "robomongo/gui/widgets/explorer/ExplorerReplicaSetTreeItem.h"
+#include "robomongo/core/domain/MongoCollection.h"
+#include "robomongo/core/domain/MongoDatabase.h"
+#include "robomongo/core/utils/QtUtils.h"
 #include <QContextMenuEvent>
+#include <QScrollBar>
+#include <QTimer>
+#include <map>
 #include <robomongo/gui/GuiRegistry.h>
 
+namespace
+{
+    // Collections are not requested while user is scrolling through them
+    const int VisibleStatsDelayMs = 300;
+}
+
 namespace Robomongo
 {
     ExplorerTreeWidget::ExplorerTreeWidget(QWidget *parent) : QTreeWidget(parent)
@@ -20,8 +34,53 @@ namespace Robomongo
         setObjectName("explorerTree");
         setIndentation(15);
         setHeaderHidden(true);
-        setSelectionMode(QAbstractItemView::SingleSelection);
+        // Several collections may be selected for actions run on all of them, see contextMenuEvent()
+        setSelectionMode(QAbstractItemView::ExtendedSelection);
         setExpandsOnDoubleClick(false);
+        // Rows are not measured one by one, keeps scrolling smooth with huge number of collections
+        setUniformRowHeights(true);
+
+        _visibleStatsTimer = new QTimer(this);
+        _visibleStatsTimer->setSingleShot(true);
+        _visibleStatsTimer->setInterval(VisibleStatsDelayMs);
+        VERIFY(connect(_visibleStatsTimer, SIGNAL(timeout()), this, SLOT(loadVisibleCollectionStats())));
+        VERIFY(connect(verticalScrollBar(), SIGNAL(valueChanged(int)), _visibleStatsTimer, SLOT(start())));
+        VERIFY(connect(this, SIGNAL(itemExpanded(QTreeWidgetItem *)), _visibleStatsTimer, SLOT(start())));
+        VERIFY(connect(model(), SIGNAL(rowsInserted(const QModelIndex &, int, int)), 
+                       _visibleStatsTimer, SLOT(start())));
+        VERIFY(connect(this, SIGNAL(itemCollapsed(QTreeWidgetItem *)), 
+                       this, SLOT(ui_itemCollapsed(QTreeWidgetItem *))));
+    }
+
+    void ExplorerTreeWidget::loadVisibleCollectionStats()
+    {
+        std::map<MongoDatabase *, std::vector<std::string>> visible;
+        int const bottom = viewport()->height();
+        for (QTreeWidgetItem *item = itemAt(0, 0); item; item = itemBelow(item)) {
+            if (visualItemRect(item).top() > bottom)
+                break;
+
+            if (auto collectionItem = dynamic_cast<ExplorerCollectionTreeItem *>(item)) {
+                MongoCollection *collection = collectionItem->collection();
+                visible[collection->database()].push_back(collection->name());
+            }
+        }
+
+        for (auto const& databaseCollections : visible)
+            databaseCollections.first->loadCollectionStats(databaseCollections.second);
+    }
+
+    void ExplorerTreeWidget::ui_itemCollapsed(QTreeWidgetItem *item)
+    {
+        // Collections are not visible anymore, do not load their stats
+        if (auto dbItem = dynamic_cast<ExplorerDatabaseTreeItem *>(item)) {
+            dbItem->database()->cancelCollectionStats();
+            return;
+        }
+
+        auto categoryItem = dynamic_cast<ExplorerDatabaseCategoryTreeItem *>(item);
+        if (categoryItem && categoryItem->category() == Collections)
+            categoryItem->databaseItem()->database()->cancelCollectionStats();
     }
 
     void ExplorerTreeWidget::contextMenuEvent(QContextMenuEvent *event)
@@ -38,6 +97,21 @@ namespace Robomongo
         if (dbItem && dbItem->isDisabled()) 
             return;
 
+        // Several selected collections of one database share a menu of their database
+        auto collectionItem = dynamic_cast<ExplorerCollectionTreeItem *>(item);
+        if (collectionItem && collectionItem->isSelected()) {
+            std::vector<std::string> collections;
+            for (QTreeWidgetItem *selected : selectedItems()) {
+                auto selectedCollection = dynamic_cast<ExplorerCollectionTreeItem *>(selected);
+                if (selectedCollection && selectedCollection->databaseItem() == collectionItem->databaseItem())
+                    collections.push_back(selectedCollection->collection()->name());
+            }
+            if (collections.size() > 1) {
+                collectionItem->databaseItem()->showCollectionsContextMenu(collections, mapToGlobal(event->pos()));
+                return;
+            }
+        }
+
         if (item) {
             auto explorerItem = dynamic_cast<ExplorerTreeItem *>(item);
             if (explorerItem) 
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <QTreeWidget>
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
 
 namespace Robomongo
 {
@@ -11,5 +14,16 @@ namespace Robomongo
         explicit ExplorerTreeWidget(QWidget *parent = 0);
     protected:
         virtual void contextMenuEvent(QContextMenuEvent *event);
+
+    private Q_SLOTS:
+        /**
+         * @brief Requests stats of collections that are currently in viewport.
+         *        Called with small delay after scroll, expand and insert of items.
+         */
+        void loadVisibleCollectionStats();
+        void ui_itemCollapsed(QTreeWidgetItem *item);
+
+    private:
+        QTimer *_visibleStatsTimer;
     };
 }
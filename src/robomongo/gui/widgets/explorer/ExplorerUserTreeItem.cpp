@@ -26,8 +26,8 @@ namespace Robomongo
         auto const viewUser { new QAction("View User", this) };
         VERIFY(connect(viewUser, SIGNAL(triggered()), SLOT(ui_viewUser())));
 
-        BaseClass::_contextMenu->addAction(viewUser);
-        BaseClass::_contextMenu->addAction(dropUser);
+        contextMenu()->addAction(viewUser);
+        contextMenu()->addAction(dropUser);
 
         setText(0, QtUtils::toQString(_user.name()));
         setIcon(0, GuiRegistry::instance().userIcon());
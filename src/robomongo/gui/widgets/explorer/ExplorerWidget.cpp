@@ -4,16 +4,23 @@
 #include <QLabel>
 #include <QMovie>
 #include <QKeyEvent>
+#include <QTimer>
 
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/domain/App.h"
+#include "robomongo/core/domain/FirstPageCache.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/gui/GuiRegistry.h"
 #include "robomongo/gui/MainWindow.h"
 #include "robomongo/gui/widgets/explorer/ExplorerTreeWidget.h"
 #include "robomongo/gui/widgets/explorer/ExplorerServerTreeItem.h"
 #include "robomongo/gui/widgets/explorer/ExplorerCollectionTreeItem.h"
 #include "robomongo/gui/widgets/explorer/ExplorerCollectionIndexesDir.h"
 #include "robomongo/gui/widgets/explorer/ExplorerDatabaseCategoryTreeItem.h"
+#include "robomongo/gui/widgets/explorer/ExplorerDatabaseTreeItem.h"
 #include "robomongo/gui/widgets/explorer/ExplorerReplicaSetTreeItem.h"
 #include "robomongo/gui/widgets/explorer/ExplorerReplicaSetFolderItem.h"
 #include "robomongo/gui/widgets/explorer/ExplorerUserTreeItem.h"
@@ -35,6 +42,13 @@ namespace Robomongo
         VERIFY(connect(_treeWidget, SIGNAL(itemDoubleClicked(QTreeWidgetItem *, int)), 
                        this, SLOT(ui_itemDoubleClicked(QTreeWidgetItem *, int))));
 
+        _prefetchTimer = new QTimer(this);
+        _prefetchTimer->setSingleShot(true);
+        _prefetchTimer->setInterval(PrefetchDelayMs);
+        VERIFY(connect(_prefetchTimer, SIGNAL(timeout()), this, SLOT(prefetchFocused())));
+        VERIFY(connect(_treeWidget, SIGNAL(currentItemChanged(QTreeWidgetItem *, QTreeWidgetItem *)),
+                       this, SLOT(ui_currentItemChanged(QTreeWidgetItem *))));
+
         setLayout(vlaout);
 
         QMovie *movie = new QMovie(":robomongo/icons/loading.gif", QByteArray(), this);
@@ -122,6 +136,17 @@ namespace Robomongo
 
         auto item = new ExplorerServerTreeItem(_treeWidget, event->server, event->connInfo);
         _treeWidget->addTopLevelItem(item);
+
+        auto const placeholder = _connectingItems.find(event->server->handle());
+        if (placeholder != _connectingItems.end()) {
+            int const index = _treeWidget->indexOfTopLevelItem(placeholder->second);
+            delete placeholder->second;
+            _connectingItems.erase(placeholder);
+
+            _treeWidget->takeTopLevelItem(_treeWidget->indexOfTopLevelItem(item));
+            _treeWidget->insertTopLevelItem(index, item);
+        }
+
         _treeWidget->setCurrentItem(item);
         _treeWidget->setFocus();
     }
@@ -131,6 +156,48 @@ namespace Robomongo
         decreaseProgress();
     }
 
+    void ExplorerWidget::handle(ConnectionStartupEvent *event)
+    {
+        QString const name = QtUtils::toQString(event->connection->connectionName());
+
+        switch (event->state) {
+        case ConnectionStartupEvent::Queued: {
+            auto item = new QTreeWidgetItem(_treeWidget, QStringList() << name + " (queued)");
+            item->setIcon(0, GuiRegistry::instance().serverIcon());
+            item->setDisabled(true);
+            _queuedItems[event->connection] = item;
+            break;
+        }
+        case ConnectionStartupEvent::Connecting: {
+            auto const it = _queuedItems.find(event->connection);
+            if (it == _queuedItems.end())
+                return;
+
+            it->second->setText(0, name + " (connecting...)");
+            _connectingItems[event->serverHandle] = it->second;
+            _queuedItems.erase(it);
+            break;
+        }
+        case ConnectionStartupEvent::Failed: {
+            // Error itself is shown by MainWindow
+            auto const queued = _queuedItems.find(event->connection);
+            if (queued != _queuedItems.end()) {
+                delete queued->second;
+                _queuedItems.erase(queued);
+            }
+
+            auto const connecting = _connectingItems.find(event->serverHandle);
+            if (event->serverHandle && connecting != _connectingItems.end()) {
+                delete connecting->second;
+                _connectingItems.erase(connecting);
+            }
+            break;
+        }
+        case ConnectionStartupEvent::Connected:
+            break;  // item is replaced on ConnectionEstablishedEvent
+        }
+    }
+
     void ExplorerWidget::ui_itemExpanded(QTreeWidgetItem *item)
     {
         auto categoryItem = dynamic_cast<ExplorerDatabaseCategoryTreeItem *>(item);
@@ -145,6 +212,12 @@ namespace Robomongo
             return;
         }
 
+        auto databaseItem = dynamic_cast<ExplorerDatabaseTreeItem *>(item);
+        if (databaseItem) {
+            databaseItem->expand();
+            return;
+        }
+
         auto replicaSetFolder = dynamic_cast<ExplorerReplicaSetFolderItem *>(item);
         if (replicaSetFolder) {
             replicaSetFolder->expand();
@@ -157,6 +230,25 @@ namespace Robomongo
         }
     }
 
+    void ExplorerWidget::ui_currentItemChanged(QTreeWidgetItem *current)
+    {
+        // Prefetch of collection focused before is cancelled, and its page dropped
+        if (_focusedCollection)
+            FirstPageCache::instance().focus(std::string(), std::string());
+
+        _focusedCollection = dynamic_cast<ExplorerCollectionTreeItem *>(current);
+        if (_focusedCollection && AppRegistry::instance().settingsManager()->prefetchPages())
+            _prefetchTimer->start();
+        else
+            _prefetchTimer->stop();
+    }
+
+    void ExplorerWidget::prefetchFocused()
+    {
+        if (_focusedCollection)
+            _focusedCollection->prefetch();
+    }
+
     void ExplorerWidget::ui_itemDoubleClicked(QTreeWidgetItem *item, int column)
     {        
         if (auto collectionItem = dynamic_cast<ExplorerCollectionTreeItem *>(item)) {
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <map>
+#include <QPointer>
 #include <QWidget>
 QT_BEGIN_NAMESPACE
+class QTimer;
 class QTreeWidget;
 class QTreeWidgetItem;
 class QLabel;
@@ -12,6 +15,7 @@ QT_END_NAMESPACE
 namespace Robomongo
 {
     class MainWindow;
+    class ExplorerCollectionTreeItem;
 
     /**
      * @brief Explorer widget (usually you'll see it at the left of main window)
@@ -31,14 +35,21 @@ namespace Robomongo
         void handle(ConnectingEvent *event);
         void handle(ConnectionEstablishedEvent *event);
         void handle(ConnectionFailedEvent *event);
+        void handle(ConnectionStartupEvent *event);
     private Q_SLOTS:
         void ui_itemExpanded(QTreeWidgetItem *item);
         void ui_itemDoubleClicked(QTreeWidgetItem *item, int column);
 
+        // Collection focused for PrefetchDelayMs is read ahead, see ExplorerCollectionTreeItem::prefetch()
+        void ui_currentItemChanged(QTreeWidgetItem *current);
+        void prefetchFocused();
+
     protected:
         void keyPressEvent(QKeyEvent *event) override;   
 
     private:
+        static const int PrefetchDelayMs = 300;
+
         QSize sizeHint() const override;
 
         int _progress;
@@ -46,5 +57,12 @@ namespace Robomongo
         void decreaseProgress();
         QLabel *_progressLabel;
         QTreeWidget *_treeWidget;
+        QTimer *_prefetchTimer;
+        QPointer<ExplorerCollectionTreeItem> _focusedCollection;
+
+        // Placeholders of connections opened by ConnectionStartup, replaced by server items
+        // at the same position, so that servers are listed in order of connection list
+        std::map<ConnectionSettings *, QTreeWidgetItem *> _queuedItems;
+        std::map<int, QTreeWidgetItem *> _connectingItems;     // by server handle
     };
 }
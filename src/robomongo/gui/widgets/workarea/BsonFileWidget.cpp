@@ -0,0 +1,97 @@
+#include "robomongo/gui/widgets/workarea/BsonFileWidget.h"
+
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QSignalBlocker>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/domain/BsonDumpFile.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+#include "robomongo/gui/widgets/workarea/OutputWidget.h"
+
+namespace Robomongo
+{
+    BsonFileWidget::BsonFileWidget(const QString &filePath, QWidget *parent) :
+        BaseClass(parent),
+        _file(new BsonDumpFile(filePath)),
+        _isShown(false)
+    {
+        _namespaces = new QComboBox;
+        _namespaces->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+        _namespaces->setVisible(_file->isArchive());
+        VERIFY(connect(_namespaces, SIGNAL(currentIndexChanged(int)), this, SLOT(namespaceSelected(int))));
+
+        _status = new QLabel;
+        _output = new OutputWidget(this);
+
+        QHBoxLayout *barLayout = new QHBoxLayout;
+        barLayout->setContentsMargins(4, 2, 4, 2);
+        barLayout->addWidget(_namespaces);
+        barLayout->addStretch(1);
+        barLayout->addWidget(_status);
+
+        QVBoxLayout *layout = new QVBoxLayout;
+        layout->setContentsMargins(0, 0, 0, 0);
+        layout->setSpacing(0);
+        layout->addLayout(barLayout);
+        layout->addWidget(_output, 1);
+        setLayout(layout);
+        setToolTip(filePath);
+
+        _timer = new QTimer(this);
+        _timer->setInterval(UpdateIntervalMs);
+        VERIFY(connect(_timer, SIGNAL(timeout()), this, SLOT(updateIndexing())));
+        _timer->start();
+        updateIndexing();
+    }
+
+    void BsonFileWidget::updateIndexing()
+    {
+        // Read before namespaces, so that the last update sees all of them
+        bool const indexed = _file->isIndexed();
+
+        std::vector<std::string> const names = _file->namespaces();
+        {
+            // The first one becomes current, it is presented below
+            QSignalBlocker const blocker(_namespaces);
+            for (size_t i = _namespaces->count(); i < names.size(); ++i)
+                _namespaces->addItem(QtUtils::toQString(names[i]));
+        }
+
+        std::string const error = _file->error();
+        if (!error.empty())
+            _status->setText(QString("Indexing stopped: %1").arg(QtUtils::toQString(error)));
+        else if (!indexed && _file->size() > 0)
+            _status->setText(QString("Indexing... %1%").arg(_file->indexedBytes() * 100 / _file->size()));
+        else
+            _status->setText(QString("%1 MB").arg(_file->size() / (1024.0 * 1024.0), 0, 'f', 1));
+
+        // First page is shown when it is complete, or the whole namespace is indexed
+        if (!_isShown && _namespaces->currentIndex() >= 0) {
+            std::string const ns = QtUtils::toStdString(_namespaces->currentText());
+            int const batchSize = AppRegistry::instance().settingsManager()->batchSize();
+            if (indexed || _file->count(ns) >= batchSize) {
+                _output->presentDump(_file, ns);
+                _isShown = true;
+            }
+        }
+
+        _output->updateDumpCounts();
+        if (indexed)
+            _timer->stop();
+    }
+
+    void BsonFileWidget::namespaceSelected(int index)
+    {
+        if (index < 0)
+            return;
+
+        _isShown = false;
+        updateIndexing();
+    }
+}
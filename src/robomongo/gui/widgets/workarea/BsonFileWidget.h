@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QWidget>
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+class QLabel;
+class QTimer;
+QT_END_NAMESPACE
+
+#include "robomongo/core/Core.h"
+
+namespace Robomongo
+{
+    class OutputWidget;
+
+    /**
+     * @brief Tab with contents of mongodump file (.bson or --archive), shown without server
+     *        in the same views as query results. Namespace of archive is chosen in combo box.
+     *        Pages come from BsonDumpFile, while it is indexed in background.
+     */
+    class BsonFileWidget : public QWidget
+    {
+        Q_OBJECT
+
+    public:
+        typedef QWidget BaseClass;
+
+        /**
+         * @throws std::runtime_error, if file cannot be opened
+         */
+        explicit BsonFileWidget(const QString &filePath, QWidget *parent = nullptr);
+
+    private Q_SLOTS:
+        // Adds namespaces found so far, shows progress and first page, once it is indexed
+        void updateIndexing();
+        void namespaceSelected(int index);
+
+    private:
+        static const int UpdateIntervalMs = 250;
+
+        BsonDumpFilePtr const _file;
+        QComboBox *_namespaces;
+        QLabel *_status;
+        OutputWidget *_output;
+        QTimer *_timer;
+        bool _isShown;      // namespace of combo box is presented in _output
+    };
+}
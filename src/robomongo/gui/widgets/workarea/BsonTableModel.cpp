@@ -5,12 +5,26 @@
 
 #include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
 #include "robomongo/gui/widgets/workarea/BsonTreeModel.h"
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/domain/ResultColumn.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/BsonUtils.h"
 #include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/shell/bson/json.h"
+
+namespace
+{
+    // Extracted columns kept at once
+    const size_t maxCachedColumns = 8;
+
+    const size_t NoColumn = static_cast<size_t>(-1);
+}
 
 namespace Robomongo
 {
     BsonTableModelProxy::BsonTableModelProxy(QObject *parent) 
-        : BaseClass(parent)
+        : BaseClass(parent), _fieldNames(&_ownFieldNames), _root(NULL), _fieldOffsets(4096),
+          _isEditable(false)
     {
        
     }
@@ -37,13 +51,12 @@ namespace Robomongo
         int row = sourceIndex.row();
         int col = sourceIndex.column();
 
+        // Only top-level documents are rows of the table
         BsonTreeItem *node = QtUtils::item<BsonTreeItem *>(sourceIndex);
-        if (!node || _columns.size() <= col)
+        if (!node || sourceIndex.parent().isValid() || _columns.size() <= col)
             return QModelIndex();
 
-        BsonTreeItem *child = node->childByKey(_columns[col]);
-
-        return createIndex( row, col, child );
+        return createIndex( proxyRow(row), col, node );
     }
 
     QModelIndex BsonTableModelProxy::sibling(int row, int column, const QModelIndex &idx) const
@@ -53,13 +66,22 @@ namespace Robomongo
 
     QModelIndex BsonTableModelProxy::index( int row, int col, const QModelIndex& parent ) const
     {
-        BsonTreeItem *node = QtUtils::item<BsonTreeItem *>(sourceModel()->index(row, 0, parent));
+        BsonTreeItem *node = QtUtils::item<BsonTreeItem *>(sourceModel()->index(sourceRow(row), 0, parent));
         if (!node || _columns.size() <= col)
             return QModelIndex();
 
-        BsonTreeItem *child = node->childByKey(_columns[col]);
+        return createIndex( row, col, node );
+    }
 
-        return createIndex( row, col, child );
+    QModelIndex BsonTableModelProxy::cellIndex(const QModelIndex &index) const
+    {
+        BsonTreeItem *node = QtUtils::item<BsonTreeItem *>(index);
+        if (!node || _columns.size() <= index.column())
+            return QModelIndex();
+
+        BsonTreeItem *child = cell(node, index.column());
+
+        return createIndex( index.row(), index.column(), child );
     }
 
     QModelIndex BsonTableModelProxy::mapToSource( const QModelIndex &proxyIndex ) const
@@ -69,40 +91,211 @@ namespace Robomongo
 
         Q_ASSERT( proxyIndex.model() == this );
 
-        QModelIndex sourceIndex;
-        BsonTreeItem *child = static_cast<BsonTreeItem *>(proxyIndex.internalPointer());
-        if (child) {
-            QtUtils::HackQModelIndex* hack = reinterpret_cast<QtUtils::HackQModelIndex*>(&sourceIndex);
-            BsonTreeItem *parent = static_cast<BsonTreeItem *>(child->parent());
-            hack->r = proxyIndex.row();
-            hack->c = proxyIndex.column();
-            hack->i = parent;
-            hack->m = sourceModel();
+        // Every row of the table is a top-level document of source model
+        if (!proxyIndex.internalPointer())
+            return QModelIndex();
+
+        return sourceModel()->index(sourceRow(proxyIndex.row()), 0);
+    }
+
+    int BsonTableModelProxy::sourceRow(int row) const
+    {
+        return row >= 0 && static_cast<size_t>(row) < _rowOrder.size() ? _rowOrder[row] : row;
+    }
+
+    int BsonTableModelProxy::proxyRow(int sourceRow) const
+    {
+        return sourceRow >= 0 && static_cast<size_t>(sourceRow) < _proxyRows.size() ? _proxyRows[sourceRow] : sourceRow;
+    }
+
+    void BsonTableModelProxy::sort(int column, Qt::SortOrder order)
+    {
+        std::vector<int> rowOrder;
+        if (column >= 0 && static_cast<size_t>(column) < _columns.size())
+            rowOrder = columnValues(column)->sortedRows(order == Qt::AscendingOrder);
+        else if (_rowOrder.empty())
+            return;
+
+        emit layoutAboutToBeChanged();
+
+        // Selection and current cell stay at the same documents
+        QModelIndexList const persistent = persistentIndexList();
+        std::vector<int> persistentSourceRows;
+        for (const QModelIndex &index : persistent)
+            persistentSourceRows.push_back(sourceRow(index.row()));
+
+        _rowOrder.swap(rowOrder);
+        _proxyRows.assign(_rowOrder.size(), 0);
+        for (size_t row = 0; row < _rowOrder.size(); ++row)
+            _proxyRows[_rowOrder[row]] = static_cast<int>(row);
+
+        QModelIndexList moved;
+        for (int i = 0; i < persistent.size(); ++i) {
+            const QModelIndex &index = persistent[i];
+            moved.append(createIndex(proxyRow(persistentSourceRows[i]), index.column(), index.internalPointer()));
+        }
+        changePersistentIndexList(persistent, moved);
+
+        emit layoutChanged();
+    }
+
+    std::shared_ptr<const ResultColumn> BsonTableModelProxy::columnValues(int col) const
+    {
+        auto const cached = _columnValues.find(col);
+        if (cached != _columnValues.end())
+            return cached->second;
+
+        // Source rows, documents point into the items of source model
+        std::vector<mongo::BSONObj> documents;
+        int const count = sourceModel() ? sourceModel()->rowCount() : 0;
+        documents.reserve(count);
+        for (int row = 0; row < count; ++row) {
+            BsonTreeItem *item = QtUtils::item<BsonTreeItem *>(sourceModel()->index(row, 0));
+            documents.push_back(item ? item->root() : mongo::BSONObj());
         }
-        return sourceIndex;
+
+        if (_columnValues.size() >= maxCachedColumns)
+            _columnValues.clear();
+
+        auto values = std::make_shared<const ResultColumn>(documents, _fieldNames->utf8(_columns[col]));
+        _columnValues[col] = values;
+        return values;
     }
 
     void BsonTableModelProxy::setSourceModel( QAbstractItemModel* model )
     {
+        _fieldOffsets.clear();
+        _columnValues.clear();
+        _changeset.clear();
+        _conflicts.clear();
+        _rowOrder.clear();
+        _proxyRows.clear();
+        BsonTreeModel *treeModel = qobject_cast<BsonTreeModel *>(model);
+        _fieldNames = treeModel ? &treeModel->fieldNames() : &_ownFieldNames;
         if (model) {
             BsonTreeItem *child = QtUtils::item<BsonTreeItem *>(model->index(0, 0));
             if (child) {
-                _root = qobject_cast<BsonTreeItem *>(child->parent());
+                _root = child->parent();
                 if (_root) {
+                    // Columns are collected from raw documents, so that child items are 
+                    // created only for rows that are actually shown (see cell())
                     int count = _root->childrenCount();
                     for (int i = 0; i < count; ++i) {
-                        BsonTreeItem *child = _root->child(i);
-                        int countc = child->childrenCount();
-                        for (int j = 0; j < countc; ++j) {
-                            addColumn(child->child(j)->key());
-                        }
+                        for (auto const& key : documentColumns(model->index(i, 0)))
+                            addColumn(key);
                     }
                 }
             }
+            VERIFY(connect(model, SIGNAL(rowsAboutToBeInserted(const QModelIndex &, int, int)), 
+                           this, SLOT(sourceRowsAboutToBeInserted(const QModelIndex &, int, int))));
+            VERIFY(connect(model, SIGNAL(rowsInserted(const QModelIndex &, int, int)), 
+                           this, SLOT(sourceRowsInserted(const QModelIndex &, int, int))));
+            VERIFY(connect(model, SIGNAL(rowsAboutToBeRemoved(const QModelIndex &, int, int)),
+                           this, SLOT(sourceRowsAboutToBeRemoved(const QModelIndex &, int, int))));
+            VERIFY(connect(model, SIGNAL(rowsRemoved(const QModelIndex &, int, int)),
+                           this, SLOT(sourceRowsRemoved(const QModelIndex &, int, int))));
+            VERIFY(connect(model, SIGNAL(dataChanged(const QModelIndex &, const QModelIndex &)),
+                           this, SLOT(sourceDataChanged(const QModelIndex &, const QModelIndex &))));
         }
         return BaseClass::setSourceModel(model);
     }
 
+    BsonTableModelProxy::ColumnsValuesType BsonTableModelProxy::documentColumns(const QModelIndex &document) const
+    {
+        ColumnsValuesType columns;
+        BsonTreeItem *item = QtUtils::item<BsonTreeItem *>(document);
+        if (!item)
+            return columns;
+
+        mongo::BSONObj const doc = item->root();
+        bool const isArray = doc.isArray();
+        mongo::BSONObjIterator iterator(doc);
+        while (iterator.more())
+            columns.push_back(_fieldNames->intern(iterator.next().fieldName(), isArray));
+        return columns;
+    }
+
+    void BsonTableModelProxy::sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last)
+    {
+        if (!parent.isValid())
+            beginInsertRows(QModelIndex(), first, last);
+    }
+
+    void BsonTableModelProxy::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+    {
+        // Nested fields fetched by tree view are not table rows
+        if (parent.isValid())
+            return;
+
+        endInsertRows();
+        _columnValues.clear();
+
+        // Rows inserted before others (by patch) move cached offsets of the following rows
+        if (last + 1 < rowCount())
+            _fieldOffsets.clear();
+
+        addColumnsOf(first, last);
+    }
+
+    void BsonTableModelProxy::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+    {
+        if (!parent.isValid())
+            beginRemoveRows(QModelIndex(), proxyRow(first), proxyRow(last));
+    }
+
+    void BsonTableModelProxy::sourceRowsRemoved(const QModelIndex &parent, int first, int last)
+    {
+        if (parent.isValid())
+            return;
+
+        // Columns, which only removed documents had, stay until the next query
+        _fieldOffsets.clear();
+        _columnValues.clear();
+        _conflicts.clear();
+        endRemoveRows();
+    }
+
+    void BsonTableModelProxy::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+    {
+        // Only changed documents matter, not values of nested items fetched by tree view
+        if (topLeft.parent().isValid() || !topLeft.isValid())
+            return;
+
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+            _fieldOffsets.remove(row);
+        _columnValues.clear();
+        addColumnsOf(topLeft.row(), bottomRight.row());
+
+        if (!_columns.empty())
+            emit dataChanged(index(proxyRow(topLeft.row()), 0, QModelIndex()),
+                             index(proxyRow(bottomRight.row()), _columns.size() - 1, QModelIndex()));
+    }
+
+    void BsonTableModelProxy::addColumnsOf(int first, int last)
+    {
+        ColumnsValuesType newColumns;
+        std::vector<bool> pending;
+        for (int row = first; row <= last; ++row) {
+            for (auto const key : documentColumns(sourceModel()->index(row, 0))) {
+                if (key >= pending.size())
+                    pending.resize(key + 1, false);
+                if (findIndexColumn(key) == _columns.size() && !pending[key]) {
+                    pending[key] = true;
+                    newColumns.push_back(key);
+                }
+            }
+        }
+
+        if (newColumns.empty())
+            return;
+
+        int const firstColumn = _columns.size();
+        beginInsertColumns(QModelIndex(), firstColumn, firstColumn + newColumns.size() - 1);
+        for (auto const& key : newColumns)
+            addColumn(key);
+        endInsertColumns();
+    }
+
     QVariant BsonTableModelProxy::data(const QModelIndex &index, int role) const
     {
         QVariant result;
@@ -110,31 +303,141 @@ namespace Robomongo
         if (!index.isValid())
             return result;
 
-        BsonTreeItem *node = QtUtils::item<BsonTreeItem *>(index);
+        BsonTreeItem *document = QtUtils::item<BsonTreeItem *>(index);
+        int const row = sourceRow(index.row());
+        mongo::BSONElement element;
+        if (document)
+            element = cellElement(document, row, index.column());
+
+        // Edited value is shown instead of loaded one until changes are saved or discarded
+        mongo::BSONElement const edited = _changeset.value(row, _fieldNames->utf8(_columns[index.column()]));
+        if (!edited.eoo())
+            element = edited;
+
+        auto const conflict = _conflicts.find(row);
+        if (conflict != _conflicts.end()) {
+            if (role == Qt::BackgroundRole)
+                return QBrush("#f8d0cc");
+            if (role == Qt::ToolTipRole)
+                return QtUtils::toQString(conflict->second);
+        }
 
-        if (!node) {
+        if (!edited.eoo() && role == Qt::BackgroundRole)
+            return QBrush("#fff1b8");
+
+        if (element.eoo()) {
             if (role == Qt::BackgroundRole) {
                 return QBrush("#f5f3f2");
             }
             return result;
         }
 
+        if (role == Qt::EditRole) {
+            if (element.type() == mongo::String)
+                return QtUtils::toQString(element.String());
+
+            SettingsManager const *settings = AppRegistry::instance().settingsManager();
+            return QtUtils::toQString(BsonUtils::jsonString(element, mongo::TenGen, false, 0,
+                                                            settings->uuidEncoding(), settings->timeZone()));
+        }
+
         if (role == Qt::DisplayRole || role == Qt::ToolTipRole) {
-            bool isCut = node->type() == mongo::String ||  node->type() == mongo::Code || node->type() == mongo::CodeWScope;  
+            mongo::BSONType const type = element.type();
+            bool isCut = type == mongo::String || type == mongo::Code || type == mongo::CodeWScope;  
+            QString const value = BsonTreeItem::valueOf(element);
             if (role == Qt::ToolTipRole) {
-                result = isCut ? node->value() : node->value().left(500); 
+                result = isCut ? value : value.left(500); 
             }
             else{
-                result = isCut ? node->value() : node->value().simplified().left(300); 
+                result = isCut ? value : value.simplified().left(300); 
             }
         }
         else if (role == Qt::DecorationRole) {
-            return BsonTreeModel::getIcon(node);
+            return BsonTreeModel::getIcon(element.type());
         }
 
         return result;
     }
 
+    Qt::ItemFlags BsonTableModelProxy::flags(const QModelIndex &index) const
+    {
+        Qt::ItemFlags result = BaseClass::flags(index);
+        BsonTreeItem *document = QtUtils::item<BsonTreeItem *>(index);
+        if (!_isEditable || !document || _columns.size() <= index.column())
+            return result;
+
+        // _id identifies document, nested documents are edited as a whole in editor
+        mongo::BSONObj const doc = document->root();
+        if (doc.isArray() || !doc.hasField("_id") || column(index.column()) == "_id")
+            return result;
+
+        mongo::BSONElement const element = cellElement(document, sourceRow(index.row()), index.column());
+        if (element.type() == mongo::Object || element.type() == mongo::Array)
+            return result;
+
+        return result | Qt::ItemIsEditable;
+    }
+
+    bool BsonTableModelProxy::setData(const QModelIndex &index, const QVariant &value, int role)
+    {
+        if (role != Qt::EditRole || !(flags(index) & Qt::ItemIsEditable))
+            return false;
+
+        BsonTreeItem *document = QtUtils::item<BsonTreeItem *>(index);
+        int const row = sourceRow(index.row());
+        std::string const &field = _fieldNames->utf8(_columns[index.column()]);
+        std::string const text = QtUtils::toStdString(value.toString());
+        if (value.toString() == data(index, Qt::EditRole).toString())
+            return false;
+
+        mongo::BSONObj parsed;
+        mongo::BSONElement const loaded = cellElement(document, row, index.column());
+        if (loaded.type() != mongo::String) {
+            try {
+                parsed = mongo::Robomongo::fromjson("{ v: " + text + " }");
+            }
+            catch (const std::exception &) {
+                parsed = mongo::BSONObj();
+            }
+        }
+        if (parsed.nFields() != 1)
+            parsed = BSON("v" << text);
+
+        _changeset.set(row, document->root(), field, parsed.firstElement());
+        emit dataChanged(index, index);
+        return true;
+    }
+
+    void BsonTableModelProxy::discardChanges()
+    {
+        _changeset.clear();
+        _conflicts.clear();
+        emitAllChanged();
+    }
+
+    void BsonTableModelProxy::discardRows(const std::vector<int> &sourceRows)
+    {
+        for (int const row : sourceRows) {
+            _changeset.discard(row);
+            _conflicts.erase(row);
+        }
+        emitAllChanged();
+    }
+
+    void BsonTableModelProxy::setConflicts(const std::vector<TableChangeset::Conflict> &conflicts)
+    {
+        _conflicts.clear();
+        for (TableChangeset::Conflict const &conflict : conflicts)
+            _conflicts[conflict.row] = conflict.error;
+        emitAllChanged();
+    }
+
+    void BsonTableModelProxy::emitAllChanged()
+    {
+        if (rowCount() > 0 && !_columns.empty())
+            emit dataChanged(index(0, 0, QModelIndex()), index(rowCount() - 1, _columns.size() - 1, QModelIndex()));
+    }
+
     QVariant BsonTableModelProxy::headerData(int section, Qt::Orientation orientation, int role) const
     {
         if (role != Qt::DisplayRole)
@@ -147,25 +450,60 @@ namespace Robomongo
         }
     }
 
-    QString BsonTableModelProxy::column(int col) const
+    BsonTreeItem *BsonTableModelProxy::cell(BsonTreeItem *node, int col) const
     {
-        return _columns[col];
+        BsonTreeModel *model = qobject_cast<BsonTreeModel *>(sourceModel());
+        if (model)
+            model->fetchChildren(node);
+
+        return node->childByNameId(_columns[col]);
     }
 
-    size_t BsonTableModelProxy::findIndexColumn(const QString &col) const
+    mongo::BSONElement BsonTableModelProxy::cellElement(BsonTreeItem *document, int row, int col) const
     {
-        for (int i = 0; i < _columns.size(); ++i) {
-            if (_columns[i] == col) {
-                return i;
+        mongo::BSONObj const doc = document->root();
+        std::vector<int> *offsets = _fieldOffsets.object(row);
+
+        // Columns could be added by later batches, in this case offsets are collected again
+        if (!offsets || offsets->size() != _columns.size()) {
+            offsets = new std::vector<int>(_columns.size(), -1);
+            bool const isArray = doc.isArray();
+            mongo::BSONObjIterator iterator(doc);
+            while (iterator.more()) {
+                mongo::BSONElement const elem = iterator.next();
+                size_t const column = findIndexColumn(_fieldNames->find(elem.fieldName(), isArray));
+                if (column < offsets->size())
+                    (*offsets)[column] = static_cast<int>(elem.rawdata() - doc.objdata());
             }
+            _fieldOffsets.insert(row, offsets);
         }
-        return _columns.size();
+
+        int const offset = (*offsets)[col];
+        if (offset < 0)
+            return mongo::BSONElement();
+
+        return mongo::BSONElement(doc.objdata() + offset);
+    }
+
+    QString BsonTableModelProxy::column(int col) const
+    {
+        return _fieldNames->name(_columns[col]);
+    }
+
+    size_t BsonTableModelProxy::findIndexColumn(FieldNameInterner::Id col) const
+    {
+        if (col >= _columnIndexes.size() || _columnIndexes[col] == NoColumn)
+            return _columns.size();
+        return _columnIndexes[col];
     }
 
-    size_t BsonTableModelProxy::addColumn(const QString &col)
+    size_t BsonTableModelProxy::addColumn(FieldNameInterner::Id col)
     {
         size_t column = findIndexColumn(col);
         if (column == _columns.size()) {
+            if (col >= _columnIndexes.size())
+                _columnIndexes.resize(col + 1, NoColumn);
+            _columnIndexes[col] = column;
             _columns.push_back(col);
         }
         return column;
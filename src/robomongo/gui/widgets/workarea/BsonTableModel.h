@@ -1,11 +1,19 @@
 #pragma once
+#include <map>
+#include <memory>
 #include <vector>
 
 #include <QAbstractProxyModel>
+#include <QCache>
+#include <mongo/bson/bsonelement.h>
+
+#include "robomongo/core/domain/FieldNameInterner.h"
+#include "robomongo/core/domain/TableChangeset.h"
 
 namespace Robomongo
 {
     class BsonTreeItem;
+    class ResultColumn;
 
     class BsonTableModelProxy : public QAbstractProxyModel
     {
@@ -13,11 +21,19 @@ namespace Robomongo
 
     public:
         typedef QAbstractProxyModel BaseClass;
-        typedef std::vector<QString> ColumnsValuesType;
+        typedef std::vector<FieldNameInterner::Id> ColumnsValuesType;
 
         explicit BsonTableModelProxy(QObject *parent = 0);
         QVariant data(const QModelIndex &index, int role) const;
 
+        /**
+         * @brief Cells are edited into changeset(), documents of source model are not changed.
+         *        Value is parsed as JSON of shell (e.g. ISODate(...), 5, true), text stays a
+         *        string if it is not valid JSON or if field was a string.
+         */
+        Qt::ItemFlags flags(const QModelIndex &index) const;
+        bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
+
         int rowCount(const QModelIndex &parent = QModelIndex()) const;
         int columnCount(const QModelIndex &parent) const;
 
@@ -28,12 +44,99 @@ namespace Robomongo
         virtual void setSourceModel( QAbstractItemModel* model );
         virtual QModelIndex parent( const QModelIndex& index ) const;
         virtual QModelIndex sibling(int row, int column, const QModelIndex &idx) const;
+
+        /**
+         * @brief Cells of this model point to the document (row) item and are rendered
+         *        directly from its raw BSON. This function returns the same cell with
+         *        child item of the field attached (created on demand), as expected by Notifier.
+         *        Internal pointer of returned index is NULL, if document has no such field.
+         */
+        QModelIndex cellIndex(const QModelIndex &index) const;
+
+        /**
+         * @brief Orders rows by values of column, without query. Column -1 restores order
+         *        of documents. Rows appended later are shown after sorted ones.
+         */
+        virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+        /**
+         * @brief Values of column in typed buffer, extracted on first use and kept
+         *        until rows are appended
+         */
+        std::shared_ptr<const ResultColumn> columnValues(int col) const;
+
+        /**
+         * @brief Top-level fields other than _id, objects and arrays of documents with _id
+         *        can be edited, if set (i.e. rows are documents of collection)
+         */
+        void setEditable(bool editable) { _isEditable = editable; }
+        bool isEditable() const { return _isEditable; }
+
+        // Row of source model shown at (sorted) row of table, and backwards
+        int sourceRow(int row) const;
+        int proxyRow(int sourceRow) const;
+
+        /**
+         * @brief Rows of source model can be removed and changed (see BsonTreeModel::applyPatch()):
+         *        table is not sorted and has no edited cells
+         */
+        bool isPatchable() const { return _rowOrder.empty() && _changeset.isEmpty(); }
+
+        // Rows of changeset are rows of source model
+        const TableChangeset &changeset() const { return _changeset; }
+        void discardChanges();
+        void discardRows(const std::vector<int> &sourceRows);
+
+        /**
+         * @brief Rows that failed to be saved, highlighted until changes are discarded
+         */
+        void setConflicts(const std::vector<TableChangeset::Conflict> &conflicts);
+
+    private Q_SLOTS:
+        /**
+         * @brief Documents appended to source model (i.e. next batch of streamed results):
+         *        only their fields are added to the column set, existing rows are not rescanned.
+         */
+        void sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+        void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+
+        /**
+         * @brief Documents removed or replaced in source model, while table is patchable
+         */
+        void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+        void sourceRowsRemoved(const QModelIndex &parent, int first, int last);
+        void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
     private:
         QString column(int col) const;
-        size_t addColumn(const QString &col);
-        size_t findIndexColumn(const QString &col) const;
+        BsonTreeItem *cell(BsonTreeItem *node, int col) const;
+        mongo::BSONElement cellElement(BsonTreeItem *document, int row, int col) const;
+        void emitAllChanged();
+        size_t addColumn(FieldNameInterner::Id col);
+        size_t findIndexColumn(FieldNameInterner::Id col) const;
+        ColumnsValuesType documentColumns(const QModelIndex &document) const;
 
+        // Columns of source rows [first, last], which table does not have yet, are appended
+        void addColumnsOf(int first, int last);
+
+        // Columns are keys of FieldNameInterner of source model, so that cells are matched
+        // to fields without converting names. Own interner is used for other models.
+        FieldNameInterner *_fieldNames;
+        FieldNameInterner _ownFieldNames;
         ColumnsValuesType _columns;
+        std::vector<size_t> _columnIndexes;    // name id -> position in _columns, NoColumn if none
         BsonTreeItem *_root;
+
+        // Row -> offsets of the fields of the document, in order of _columns (-1 if no field).
+        // Only recently shown rows are kept, so memory does not grow with number of documents.
+        mutable QCache<int, std::vector<int>> _fieldOffsets;    // by source row
+
+        std::vector<int> _rowOrder;     // table row -> source row, empty if not sorted
+        std::vector<int> _proxyRows;    // source row -> table row
+        mutable std::map<int, std::shared_ptr<const ResultColumn>> _columnValues;
+
+        bool _isEditable;
+        TableChangeset _changeset;
+        std::map<int, std::string> _conflicts;     // source row -> error
     };
 }
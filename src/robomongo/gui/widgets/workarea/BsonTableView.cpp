@@ -1,18 +1,32 @@
 #include "robomongo/gui/widgets/workarea/BsonTableView.h"
 
+#include <algorithm>
 #include <QHeaderView>
 #include <QAction>
 #include <QMenu>
 #include <QKeyEvent>
+#include <QMessageBox>
 
 #include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
+#include "robomongo/gui/widgets/workarea/BsonTableModel.h"
 #include "robomongo/gui/GuiRegistry.h"
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/FieldBuckets.h"
+#include "robomongo/core/domain/FieldDistribution.h"
+#include "robomongo/core/domain/MongoShell.h"
+#include "robomongo/core/domain/ResultColumn.h"
+#include "robomongo/core/events/MongoEvents.h"
 #include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/gui/dialogs/FieldChartDialog.h"
+#include "robomongo/gui/utils/ColumnSizing.h"
 
 namespace Robomongo
 {
     BsonTableView::BsonTableView(MongoShell *shell, const MongoQueryInfo &queryInfo, QWidget *parent) 
-        :BaseClass(parent), _notifier(this, shell, queryInfo)
+        :BaseClass(parent), _notifier(this, shell, queryInfo), _shell(shell), _queryInfo(queryInfo),
+        _isEditable(shell && queryInfo._info.isValid() && queryInfo._fields.isEmpty()), _changesetId(0)
     {
 #if defined(Q_OS_MAC)
         setAttribute(Qt::WA_MacShowFocusRect, false);
@@ -27,6 +41,39 @@ namespace Robomongo
         setSelectionBehavior(QAbstractItemView::SelectItems);
         setContextMenuPolicy(Qt::CustomContextMenu);
         VERIFY(connect(this, SIGNAL(customContextMenuRequested(const QPoint&)), this, SLOT(showContextMenu(const QPoint&))));
+
+        // Rows are sorted on the client (see BsonTableModelProxy::sort()), documents are
+        // shown in their original order until a header is clicked
+        horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+        setSortingEnabled(true);
+        horizontalHeader()->setContextMenuPolicy(Qt::CustomContextMenu);
+        VERIFY(connect(horizontalHeader(), SIGNAL(customContextMenuRequested(const QPoint&)), this, SLOT(showHeaderContextMenu(const QPoint&))));
+        VERIFY(connect(horizontalHeader(), SIGNAL(sectionCountChanged(int, int)), this, SLOT(fitNewColumns(int, int))));
+
+        // Edited cells are kept in proxy until they are saved together, see commitChanges()
+        if (_isEditable) {
+            setEditTriggers(QAbstractItemView::DoubleClicked | QAbstractItemView::EditKeyPressed);
+            AppRegistry::instance().bus()->subscribe(this, CommitChangesetResponse::Type, _shell->server());
+        }
+        else {
+            setEditTriggers(QAbstractItemView::NoEditTriggers);
+        }
+    }
+
+    void BsonTableView::setModel(QAbstractItemModel *model)
+    {
+        BsonTableModelProxy *proxy = qobject_cast<BsonTableModelProxy *>(model);
+        if (proxy)
+            proxy->setEditable(_isEditable);
+        BaseClass::setModel(model);
+        utils::fitColumns(this, horizontalHeader(), MaxFittedWidth);
+    }
+
+    void BsonTableView::fitNewColumns(int oldCount, int newCount)
+    {
+        // Columns sized (or resized by user) before keep their widths
+        if (newCount > oldCount)
+            utils::fitColumns(this, horizontalHeader(), oldCount, newCount - 1, MaxFittedWidth);
     }
 
     void BsonTableView::keyPressEvent(QKeyEvent *event)
@@ -39,7 +86,7 @@ namespace Robomongo
 
     QModelIndex BsonTableView::selectedIndex() const
     {
-        QModelIndexList indexes = detail::uniqueRows(selectionModel()->selectedIndexes());
+        QModelIndexList indexes = selectedIndexes();
 
         if (indexes.count() != 1)
             return QModelIndex();
@@ -49,7 +96,14 @@ namespace Robomongo
 
     QModelIndexList BsonTableView::selectedIndexes() const
     {
-        return detail::uniqueRows(selectionModel()->selectedIndexes());
+        // Table cells are rendered from raw BSON, items of fields are created only for selected cells
+        QModelIndexList indexes = selectionModel()->selectedIndexes();
+        BsonTableModelProxy *proxy = qobject_cast<BsonTableModelProxy *>(model());
+        if (proxy) {
+            for (QModelIndexList::iterator it = indexes.begin(); it != indexes.end(); ++it)
+                *it = proxy->cellIndex(*it);
+        }
+        return detail::uniqueRows(indexes);
     }
 
     void BsonTableView::showContextMenu( const QPoint &point )
@@ -62,6 +116,7 @@ namespace Robomongo
         if (detail::isMultiSelection(indexes)) {
             QMenu menu(this);
             _notifier.initMultiSelectionMenu(&menu);
+            addChangesetActions(&menu);
             menu.exec(menuPoint);
         }
         else{
@@ -69,8 +124,230 @@ namespace Robomongo
             BsonTreeItem *documentItem = QtUtils::item<BsonTreeItem*>(selectedInd);
             QMenu menu(this);
             _notifier.initMenu(&menu, documentItem);
+            addChangesetActions(&menu);
             menu.exec(menuPoint);
         }
     }
 
+    void BsonTableView::addChangesetActions(QMenu *menu)
+    {
+        BsonTableModelProxy *proxy = qobject_cast<BsonTableModelProxy *>(model());
+        if (!proxy || proxy->changeset().isEmpty())
+            return;
+
+        int const changes = proxy->changeset().changeCount();
+        QAction *before = menu->actions().isEmpty() ? nullptr : menu->actions().first();
+        QAction *commit = new QAction(changes == 1 ? QString("Save 1 Change") : QString("Save %1 Changes").arg(changes), menu);
+        commit->setEnabled(_changesetId == 0);
+        VERIFY(connect(commit, SIGNAL(triggered()), this, SLOT(commitChanges())));
+        QAction *discard = new QAction("Discard Changes", menu);
+        discard->setEnabled(_changesetId == 0);
+        VERIFY(connect(discard, SIGNAL(triggered()), this, SLOT(discardChanges())));
+
+        menu->insertAction(before, commit);
+        menu->insertAction(before, discard);
+        if (before)
+            menu->insertSeparator(before);
+    }
+
+    void BsonTableView::commitChanges()
+    {
+        BsonTableModelProxy *proxy = qobject_cast<BsonTableModelProxy *>(model());
+        if (!proxy || _changesetId != 0)
+            return;
+
+        std::vector<TableChangeset::Statement> const statements = proxy->changeset().statements();
+        if (statements.empty())
+            return;
+
+        static int lastChangesetId = 0;
+        _changesetId = ++lastChangesetId;
+        _shell->server()->commitChangeset(_changesetId, _queryInfo._info._ns, statements);
+    }
+
+    void BsonTableView::discardChanges()
+    {
+        BsonTableModelProxy *proxy = qobject_cast<BsonTableModelProxy *>(model());
+        if (proxy && _changesetId == 0)
+            proxy->discardChanges();
+    }
+
+    void BsonTableView::handle(CommitChangesetResponse *event)
+    {
+        if (event->changesetId != _changesetId)
+            return;
+        _changesetId = 0;
+
+        BsonTableModelProxy *proxy = qobject_cast<BsonTableModelProxy *>(model());
+        if (!proxy)
+            return;
+
+        if (event->isError()) {
+            QMessageBox::warning(this, "Database Error", QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        TableChangeset::CommitResult const &result = event->result;
+        if (!result.aborted && result.conflicts.empty()) {
+            proxy->discardChanges();
+            AppRegistry::instance().bus()->publish(new DocumentsChangedEvent(this, _queryInfo._info));
+            _shell->query(0, _queryInfo);
+            return;
+        }
+
+        QString text;
+        int const conflicts = static_cast<int>(result.conflicts.size());
+        int const maxListed = 20;
+        for (int i = 0; i < conflicts && i < maxListed; ++i) {
+            TableChangeset::Conflict const &conflict = result.conflicts[i];
+            text += QString("\nRow %1: %2").arg(proxy->proxyRow(conflict.row) + 1)
+                                             .arg(QtUtils::toQString(conflict.error));
+        }
+        if (conflicts > maxListed)
+            text += QString("\n... and %1 more").arg(conflicts - maxListed);
+
+        if (!result.aborted) {
+            // Without transaction the other rows are saved, results are read again
+            QMessageBox::warning(this, "Save Changes",
+                QString("%1 documents saved, %2 failed:\n%3").arg(result.updated).arg(conflicts).arg(text));
+            proxy->discardChanges();
+            AppRegistry::instance().bus()->publish(new DocumentsChangedEvent(this, _queryInfo._info));
+            _shell->query(0, _queryInfo);
+            return;
+        }
+
+        // Transaction was aborted, all edits are kept and conflicting rows are highlighted
+        proxy->setConflicts(result.conflicts);
+        int const others = proxy->changeset().rowCount() - conflicts;
+        if (conflicts == 0 || others <= 0) {
+            QMessageBox::warning(this, "Save Changes",
+                QString("Transaction was aborted, nothing was saved.%1").arg(text.isEmpty() ? "" : "\n" + text));
+            return;
+        }
+
+        QMessageBox::StandardButton const answer = QMessageBox::question(this, "Save Changes",
+            QString("Transaction was aborted, nothing was saved.\n%1\n\nDiscard changes of these rows and save the other %2?")
+                .arg(text).arg(others), QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+        if (answer != QMessageBox::Yes)
+            return;
+
+        std::vector<int> rows;
+        for (TableChangeset::Conflict const &conflict : result.conflicts)
+            rows.push_back(conflict.row);
+        proxy->discardRows(rows);
+        commitChanges();
+    }
+
+    void BsonTableView::showHeaderContextMenu(const QPoint &point)
+    {
+        int const column = horizontalHeader()->logicalIndexAt(point);
+        if (column < 0)
+            return;
+
+        QMenu menu(this);
+        QAction *ascending = menu.addAction("Sort Ascending");
+        QAction *descending = menu.addAction("Sort Descending");
+        QAction *original = menu.addAction("Original Order");
+        menu.addSeparator();
+        QAction *summary = menu.addAction("Column Summary...");
+        original->setEnabled(horizontalHeader()->sortIndicatorSection() >= 0);
+
+        // Grouped on server among all documents of query, not only the shown page
+        QAction *groupBy = nullptr;
+        QAction *groupBySample = nullptr;
+        QAction *chart = nullptr;
+        if (_shell && _queryInfo._info.isValid()) {
+            menu.addSeparator();
+            groupBy = menu.addAction("Group by This Field");
+            groupBySample = menu.addAction(QString("Group by This Field on %1 Sampled Documents")
+                                           .arg(FieldDistribution::DefaultSampleSize));
+            chart = menu.addAction("Chart This Field...");
+        }
+
+        QAction *selected = menu.exec(horizontalHeader()->mapToGlobal(point));
+        if (selected == ascending)
+            sortByColumn(column, Qt::AscendingOrder);
+        else if (selected == descending)
+            sortByColumn(column, Qt::DescendingOrder);
+        else if (selected == original)
+            horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+        else if (selected == summary)
+            showColumnSummary(column);
+        else if (selected && selected == groupBy)
+            emit groupByFieldRequested(model()->headerData(column, Qt::Horizontal).toString(), 0);
+        else if (selected && selected == groupBySample)
+            emit groupByFieldRequested(model()->headerData(column, Qt::Horizontal).toString(),
+                                       FieldDistribution::DefaultSampleSize);
+        else if (selected && selected == chart)
+            showFieldChart(column);
+    }
+
+    void BsonTableView::showFieldChart(int column)
+    {
+        BsonTableModelProxy *proxy = qobject_cast<BsonTableModelProxy *>(model());
+        if (!proxy)
+            return;
+
+        // Kind and interval are guessed from shown page, the chart itself covers all documents of query
+        std::shared_ptr<const ResultColumn> const values = proxy->columnValues(column);
+        size_t numbers = 0, dates = 0;
+        long long minDate = 0, maxDate = 0;
+        for (size_t row = 0; row < values->size(); ++row) {
+            mongo::BSONElement const element = values->element(static_cast<int>(row));
+            if (element.isNumber()) {
+                ++numbers;
+            }
+            else if (element.type() == mongo::Date) {
+                long long const ms = element.date().toMillisSinceEpoch();
+                minDate = dates == 0 ? ms : std::min(minDate, ms);
+                maxDate = dates == 0 ? ms : std::max(maxDate, ms);
+                ++dates;
+            }
+        }
+
+        QString const field = model()->headerData(column, Qt::Horizontal).toString();
+        if (numbers == 0 && dates == 0) {
+            QMessageBox::information(this, QString("Column \"%1\"").arg(field),
+                                     "Only numbers and dates can be charted, this page has none of them in the column.");
+            return;
+        }
+
+        auto dialog = new FieldChartDialog(_shell, _queryInfo, field,
+                                           dates > numbers ? FieldBuckets::Kind::Dates : FieldBuckets::Kind::Numbers,
+                                           FieldBuckets::suitableUnit(minDate, maxDate), this);
+        dialog->show();
+    }
+
+    void BsonTableView::showColumnSummary(int column)
+    {
+        BsonTableModelProxy *proxy = qobject_cast<BsonTableModelProxy *>(model());
+        if (!proxy)
+            return;
+
+        std::shared_ptr<const ResultColumn> const values = proxy->columnValues(column);
+        auto valueText = [&values](int row) {
+            mongo::BSONElement const element = values->element(row);
+            if (element.eoo())
+                return QString("(missing)");
+            QString const text = BsonTreeItem::valueOf(element).simplified();
+            return text.size() > 100 ? text.left(100) + "..." : text;
+        };
+
+        ResultColumn::Summary const summary = values->summarize();
+        QString text = QString("%1 values, %2 missing").arg(summary.values).arg(summary.missing);
+        if (summary.values > 0) {
+            text += QString("\nMin: %1\nMax: %2").arg(valueText(summary.minRow)).arg(valueText(summary.maxRow));
+        }
+        if (summary.numbers > 0) {
+            text += QString("\n\n%1 numbers\nSum: %2\nAverage: %3")
+                .arg(summary.numbers).arg(summary.sum, 0, 'g', 15).arg(summary.sum / summary.numbers, 0, 'g', 15);
+        }
+
+        text += "\n\nMost frequent values:";
+        for (const ResultColumn::Group &group : values->groups(10))
+            text += QString("\n%1  (%2)").arg(valueText(group.row)).arg(group.count);
+
+        QMessageBox::information(this, QString("Column \"%1\"").arg(model()->headerData(column, Qt::Horizontal).toString()), text);
+    }
+
 }
@@ -5,6 +5,8 @@
 
 namespace Robomongo
 {
+    class CommitChangesetResponse;
+
     class BsonTableView : public QTableView , public INotifierObserver
     {
         Q_OBJECT
@@ -14,13 +16,49 @@ namespace Robomongo
         virtual QModelIndex selectedIndex() const;
         virtual QModelIndexList selectedIndexes() const;
 
+        // Cells of BsonTableModelProxy are editable, if results are documents of collection
+        void setModel(QAbstractItemModel *model) override;
+
+    Q_SIGNALS:
+        /**
+         * @brief Most frequent values of column are asked from server, see MongoShell::groupByField()
+         * @param sampleSize Documents grouped, 0 for all matching query
+         */
+        void groupByFieldRequested(const QString &field, int sampleSize);
+
     public Q_SLOTS:
         void showContextMenu(const QPoint &point);
+        void showHeaderContextMenu(const QPoint &point);
+
+        /**
+         * @brief Saves edited cells of all rows together, see MongoServer::commitChangeset
+         */
+        void commitChanges();
+        void discardChanges();
+        void handle(CommitChangesetResponse *event);
+
+    private Q_SLOTS:
+        // Fits columns of fields found in later pages, see utils::fitColumns()
+        void fitNewColumns(int oldCount, int newCount);
 
     protected:
         virtual void keyPressEvent(QKeyEvent *event);
 
     private:
+        // Long values (nested documents as text) do not push other columns out of sight
+        static const int MaxFittedWidth = 300;
+
+        // Count, min, max, sum and most frequent values of column, from typed buffer of proxy
+        void showColumnSummary(int column);
+        void showFieldChart(int column);
+
+        // Save and Discard actions at top of 'menu', if cells were edited
+        void addChangesetActions(QMenu *menu);
+
         Notifier _notifier;
+        MongoShell *const _shell;
+        MongoQueryInfo const _queryInfo;
+        bool const _isEditable;
+        int _changesetId;   // 0, if nothing is being saved
     };
 }
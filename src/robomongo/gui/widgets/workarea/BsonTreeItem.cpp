@@ -1,74 +1,59 @@
 #include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
+#include <algorithm>
 #include <mongo/client/dbclient_base.h>
 
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+
 using namespace mongo;
 namespace
 {
-    struct removeIfFound
-    {
-        removeIfFound(Robomongo::BsonTreeItem *item) :_whatSearch(item) {}
-        bool operator()(const Robomongo::BsonTreeItem* item) const
-        {
-            if (item == _whatSearch) {
-                delete _whatSearch;
-                return true;
-            }
-            return false;
-        }
-        const Robomongo::BsonTreeItem *const _whatSearch;
-    };
-
     const Robomongo::BsonTreeItem *findSuperRoot(const Robomongo::BsonTreeItem *const item)
     {
-        Robomongo::BsonTreeItem *parent = qobject_cast<Robomongo::BsonTreeItem *>(item->parent());
-        if (parent) {
-            Robomongo::BsonTreeItem *grParent = qobject_cast<Robomongo::BsonTreeItem *>(parent->parent());
-            if (grParent) {
-               return findSuperRoot(parent);
-            }
-        }
+        Robomongo::BsonTreeItem *parent = item->parent();
+        if (parent && parent->parent())
+            return findSuperRoot(parent);
         return item;
     }
-}
-namespace Robomongo
-{
-    BsonTreeItem::BsonTreeItem(QObject *parent) 
-        :BaseClass(parent)
-    {
-       
-    }
-
-    BsonTreeItem::BsonTreeItem(const mongo::BSONObj &bsonObjRoot, QObject *parent)
-        :BaseClass(parent),
-        _root(bsonObjRoot)
-    {
 
+    QString arrayValue(int itemsCount) {
+        QString elements = itemsCount == 1 ? "element" : "elements";
+        return QString("[ %1 %2 ]").arg(itemsCount).arg(elements);
     }
 
-    unsigned BsonTreeItem::childrenCount() const
-    {
-        return _items.size();
+    QString objectValue(int itemsCount) {
+        QString fields = itemsCount == 1 ? "field" : "fields";
+        return QString("{ %1 %2 }").arg(itemsCount).arg(fields);
     }
-
-    void BsonTreeItem::clear()
+}
+namespace Robomongo
+{
+    BsonTreeItem::BsonTreeItem(BsonTreeItem *parent, const char *root, int row) :
+        _parent(parent),
+        _root(root),
+        _row(row)
     {
-        _items.clear();
+        static_assert(std::is_trivially_destructible<BsonTreeItem>::value,
+                      "Items are freed by BsonTreeItemArena without destructors");
     }
 
-    void BsonTreeItem::addChild(BsonTreeItem *item)
+    void BsonTreeItem::setChildren(BsonTreeItem *const *children, unsigned count)
     {
-        _items.push_back(item);
+        _children = children;
+        _childrenCount = count;
     }
 
     BsonTreeItem* BsonTreeItem::child(unsigned pos) const
     {
-        return _items[pos];
+        return _children[pos];
     }
 
     BsonTreeItem* BsonTreeItem::childSafe(unsigned pos) const
     {
         if (childrenCount() > pos) {
-            return _items[pos];
+            return _children[pos];
         }
         else {
             return NULL;
@@ -77,9 +62,19 @@ namespace Robomongo
 
     BsonTreeItem* BsonTreeItem::childByKey(const QString &val)
     {
-        for (unsigned i = 0; i < _items.size(); ++i) {
-            if (_items[i]->key() == val) {
-                return _items[i];
+        for (unsigned i = 0; i < _childrenCount; ++i) {
+            if (_children[i]->key() == val) {
+                return _children[i];
+            }
+        }
+        return NULL;
+    }
+
+    BsonTreeItem* BsonTreeItem::childByNameId(uint32_t nameId) const
+    {
+        for (unsigned i = 0; i < _childrenCount; ++i) {
+            if (_children[i]->nameId() == nameId) {
+                return _children[i];
             }
         }
         return NULL;
@@ -97,42 +92,84 @@ namespace Robomongo
 
     mongo::BSONObj BsonTreeItem::root() const
     {
-        return _root;
+        // Not owned, buffer of document is kept by model
+        return _root ? mongo::BSONObj(_root) : mongo::BSONObj();
     }
 
-    int BsonTreeItem::indexOf(BsonTreeItem *item) const
+    std::string BsonTreeItem::fieldName() const
     {
-        for (unsigned i = 0; i < _items.size(); ++i) {
-            if (item == _items[i]) {
-                return i;
-            }
-        }
-        return -1;
+        mongo::BSONElement const elem = element();
+        return elem.eoo() ? std::string() : std::string(elem.fieldName());
     }
 
     QString BsonTreeItem::key() const
     {
-        return _fields._key;
+        mongo::BSONElement const elem = element();
+        if (!elem.eoo()) {
+            // Field names of arrays are numeric, starting from 0
+            QString const name = QtUtils::fromUtf8(elem.fieldName(), elem.fieldNameSize() - 1);
+            return _isArrayElement ? "[" + name + "]" : name;
+        }
+
+        if (isRange())
+            return QString("[%1...%2]").arg(_rangeFirst).arg(_rangeFirst + _rangeCount - 1);
+
+        if (_position <= 0)
+            return QString();
+
+        QString idValue;
+        mongo::BSONElement const idElement = root().getField("_id");
+        if (!idElement.eoo())
+            idValue = valueOf(idElement);
+        return QString("(%1) %2").arg(_position).arg(idValue);
     }
 
     QString BsonTreeItem::value() const
     {
-        return _fields._value;
+        if (_elementOffset >= 0)
+            return valueOf(element());
+
+        if (_position <= 0)
+            return QString();
+
+        mongo::BSONObj const doc = root();
+        int const count = Robomongo::BsonUtils::elementsCount(doc);
+        return doc.isArray() ? arrayValue(count) : objectValue(count);
     }
 
-    mongo::BSONType BsonTreeItem::type() const
+    mongo::BSONElement BsonTreeItem::element() const
     {
-        return _fields._type;
+        if (_elementOffset < 0)
+            return mongo::BSONElement();
+
+        return mongo::BSONElement(_root + _elementOffset);
     }
 
-    void BsonTreeItem::setKey(const QString &key)
+    QString BsonTreeItem::documentValue(bool isArray, int elementsCount)
     {
-        _fields._key = key;
+        return isArray ? arrayValue(elementsCount) : objectValue(elementsCount);
     }
 
-    void BsonTreeItem::setValue(const QString &value)
+    QString BsonTreeItem::valueOf(const mongo::BSONElement &element)
     {
-        _fields._value = value;
+        if (element.eoo())
+            return QString();
+
+        if (Robomongo::BsonUtils::isArray(element))
+            return arrayValue(Robomongo::BsonUtils::elementsCount(element.Obj()));
+
+        if (Robomongo::BsonUtils::isDocument(element))
+            return objectValue(Robomongo::BsonUtils::elementsCount(element.Obj()));
+
+        std::string result;
+        SettingsManager const *settings = AppRegistry::instance().settingsManager();
+        Robomongo::BsonUtils::buildJsonString(element, result, settings->uuidEncoding(), settings->timeZone());
+        return QtUtils::toQString(result);
+    }
+
+    mongo::BSONType BsonTreeItem::type() const
+    {
+        return _fields._type;
     }
 
     void BsonTreeItem::setType(mongo::BSONType type)
@@ -150,8 +187,17 @@ namespace Robomongo
         _fields._binType = type;
     }
 
-    void BsonTreeItem::removeChild(BsonTreeItem *item)
+    void *BsonTreeItemArena::allocate(size_t size, size_t alignment)
     {
-        _items.erase(std::remove_if(_items.begin(), _items.end(), removeIfFound(item)), _items.end());
+        size_t offset = (_used + alignment - 1) & ~(alignment - 1);
+        if (_blocks.empty() || offset + size > _blockSize) {
+            // Large arrays of children get a block of their own
+            _blockSize = std::max(size, BlockSize);
+            _blocks.emplace_back(new char[_blockSize]);
+            _allocatedBytes += _blockSize;
+            offset = 0;
+        }
+        _used = offset + size;
+        return _blocks.back().get() + offset;
     }
-}
+}
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <type_traits>
 #include <vector>
-#include <QObject>
+#include <QString>
 #include <mongo/bson/bsonobj.h>
 #include <mongo/bson/bsonelement.h>
 
@@ -12,15 +15,19 @@ namespace Robomongo
      */
     struct BsonItemFields
     {
-        QString _key;
-        QString _value;
         mongo::BSONType _type;
         mongo::BinDataType _binType;
     };
 
-    class BsonTreeItem : public QObject
+    /**
+     * @brief Item keeps only offset of its element inside root(), key and value strings
+     *        are built on every request (BsonTreeModel caches recently shown ones).
+     *        Items are plain and trivially destructible: they are allocated from
+     *        BsonTreeItemArena of model and freed all at once with it. root() points
+     *        into documents that model keeps alive.
+     */
+    class BsonTreeItem
     {
-        Q_OBJECT
     public:
         enum eColumn
         {
@@ -30,33 +37,100 @@ namespace Robomongo
             eCountColumns = 3
         };
 
-        typedef QObject BaseClass;
-        typedef std::vector<BsonTreeItem*> ChildContainerType;
+        /**
+         * @param root Data of document that contains element of item (or is represented
+         *        by it), may be null for invisible root item of model
+         * @param row Index of item among children of 'parent'
+         */
+        BsonTreeItem(BsonTreeItem *parent, const char *root, int row);
 
-        explicit BsonTreeItem(QObject *parent = 0);
-        explicit BsonTreeItem(const mongo::BSONObj &bsonObjRoot, QObject *parent = 0);
+        BsonTreeItem* parent() const { return _parent; }
+        int row() const { return _row; }
 
-        unsigned childrenCount() const;
-        void clear();
-        void addChild(BsonTreeItem *item);
-        void removeChild(BsonTreeItem *item);
+        // Document items move, and unexpanded ones point to new version of their document,
+        // when refreshed page is patched into model
+        void setRow(int row) { _row = row; }
+        void setRoot(const char *root) { _root = root; }
+
+        unsigned childrenCount() const { return _childrenCount; }
         BsonTreeItem* child(unsigned pos) const;
         BsonTreeItem* childSafe(unsigned pos) const;
         BsonTreeItem* childByKey(const QString &val);
-        int indexOf(BsonTreeItem *item) const;
+
+        // Child with key 'nameId' of model's FieldNameInterner, or NULL
+        BsonTreeItem* childByNameId(uint32_t nameId) const;
+
+        /**
+         * @brief Sets array of children, which is owned by model (usually by its arena)
+         */
+        void setChildren(BsonTreeItem *const *children, unsigned count);
 
         const BsonTreeItem* superParent() const;
         mongo::BSONObj root() const;
         mongo::BSONObj superRoot() const;
 
-        std::string fieldName() const { return _fieldName; };
-        void setFieldName(const std::string &fieldName) { _fieldName = fieldName; };
+        /**
+         * @brief Element this item represents, located by its offset inside root().
+         *        Returns EOO element for document items (which have no parent element).
+         */
+        mongo::BSONElement element() const;
+        void setElementOffset(int offset) { _elementOffset = offset; }
+
+        /**
+         * @brief Id of key in FieldNameInterner of model, FieldNameInterner::NoId for
+         *        document items
+         */
+        uint32_t nameId() const { return _nameId; }
+        void setNameId(uint32_t nameId) { _nameId = nameId; }
+
+        /**
+         * @brief Children are not created until item is expanded (or shown as table row)
+         */
+        bool isChildrenFetched() const { return _childrenFetched; }
+        void setChildrenFetched(bool fetched) { _childrenFetched = fetched; }
 
+        /**
+         * @brief UI representation of element value, as shown in 'Value' column
+         */
+        static QString valueOf(const mongo::BSONElement &element);
+
+        // Value shown for object or array of 'elementsCount' fields, i.e. "{ 3 fields }"
+        static QString documentValue(bool isArray, int elementsCount);
+
+        /**
+         * @brief Name of element, empty for document items
+         */
+        std::string fieldName() const;
+
+        /**
+         * @brief Field name ("[name]" for elements of arrays), number and _id of document,
+         *        or "[first...last]" of range item
+         */
         QString key() const;
-        void setKey(const QString &key);
 
+        /**
+         * @brief 1-based number of document item in result, 0 for other items
+         */
+        void setPosition(int position) { _position = position; }
+
+        /**
+         * @brief Element of array, its key is shown in square brackets
+         */
+        void setArrayElement(bool isArrayElement) { _isArrayElement = isArrayElement; }
+
+        /**
+         * @brief Virtual item of large array, groups its elements [first, first + count).
+         *        root() of range item is the array itself, it has no element.
+         */
+        bool isRange() const { return _rangeCount > 0; }
+        unsigned rangeFirst() const { return _rangeFirst; }
+        unsigned rangeCount() const { return _rangeCount; }
+        void setRange(unsigned first, unsigned count) { _rangeFirst = first; _rangeCount = count; }
+
+        /**
+         * @brief valueOf(element()), or number of fields of document item
+         */
         QString value() const;
-        void setValue(const QString &value);
 
         mongo::BSONType type() const;
         void setType(mongo::BSONType type);
@@ -64,11 +138,56 @@ namespace Robomongo
         mongo::BinDataType binType() const;
         void setBinType(mongo::BinDataType type);
 
-    protected:
-
-        const mongo::BSONObj _root;
-        ChildContainerType _items;
+    private:
+        BsonTreeItem *const _parent;
+        const char *_root;
+        BsonTreeItem *const *_children = nullptr;
+        unsigned _childrenCount = 0;
+        int _row;
         BsonItemFields _fields;
-        std::string _fieldName;
+        int _elementOffset = -1;
+        int _position = 0;
+        bool _isArrayElement = false;
+        bool _childrenFetched = false;
+        uint32_t _nameId = UINT32_MAX;
+        uint32_t _rangeFirst = 0;
+        uint32_t _rangeCount = 0;
+    };
+
+    /**
+     * @brief Memory of items of one model. Blocks are released together when arena is
+     *        destroyed, without running destructors of items (they have none), so freeing
+     *        result does not depend on number of items.
+     */
+    class BsonTreeItemArena
+    {
+    public:
+        BsonTreeItemArena() = default;
+        BsonTreeItemArena(const BsonTreeItemArena &) = delete;
+        BsonTreeItemArena &operator=(const BsonTreeItemArena &) = delete;
+
+        /**
+         * @brief Uninitialized memory for 'count' objects of trivially destructible type T,
+         *        valid until arena is destroyed
+         */
+        template <typename T>
+        T *allocate(size_t count)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "Arena does not run destructors");
+            return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+        }
+
+        // Bytes of all blocks
+        size_t allocatedBytes() const { return _allocatedBytes; }
+
+    private:
+        void *allocate(size_t size, size_t alignment);
+
+        static const size_t BlockSize = 64 * 1024;
+
+        std::vector<std::unique_ptr<char[]>> _blocks;
+        size_t _used = BlockSize;   // in the last block
+        size_t _blockSize = 0;      // of the last block
+        size_t _allocatedBytes = 0;
     };
 }
@@ -1,8 +1,11 @@
 #include "robomongo/gui/widgets/workarea/BsonTreeModel.h"
 
+#include <algorithm>
+#include <new>
 #include <mongo/client/dbclient_base.h>
 #include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/utils/BsonTypeTraits.h"
 #include "robomongo/core/utils/BsonUtils.h"
 #include "robomongo/core/domain/MongoDocument.h"
 #include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
@@ -13,106 +16,234 @@ namespace
 {
     using namespace Robomongo;
 
-    QString arrayValue(int itemsCount) {
-        QString elements = itemsCount == 1 ? "element" : "elements";
-        return QString("[ %1 %2 ]").arg(itemsCount).arg(elements);
-    }
-
-    QString objectValue(int itemsCount) {
-        QString fields = itemsCount == 1 ? "field" : "fields";
-        return QString("{ %1 %2 }").arg(itemsCount).arg(fields);
-    }
+    // Key and value strings of recently shown items
+    const int maxCachedStrings = 4096;
 
-    void parseDocument(BsonTreeItem *root, const mongo::BSONObj &doc, bool isArray)
-    {            
-            mongo::BSONObjIterator iterator(doc);
-            while (iterator.more())
-            {
-                mongo::BSONElement element = iterator.next();                
-                BsonTreeItem *childItemInner = new BsonTreeItem(doc, root);
-                std::string fieldName = std::string(element.fieldName());
-                childItemInner->setFieldName(fieldName);
-
-                QString uiFieldName = QtUtils::toQString(fieldName);
-                childItemInner->setKey(uiFieldName);
-
-                if (isArray) {
-                    // When we iterate array, show field names in square brackets
-                    // In this case field names are numeric, starting from 0.
-                    childItemInner->setKey("[" + uiFieldName + "]");
-                }
+    // Rough size of cached string with its cache node, strings of tree are short
+    const int cachedStringBytes = 96;
 
-                if (BsonUtils::isArray(element)) {
-                    int itemsCount = element.Array().size();
-                    childItemInner->setValue(arrayValue(itemsCount));
-                }
-                else if (BsonUtils::isDocument(element)) {
-                    int count = BsonUtils::elementsCount(element.Obj());
-                    childItemInner->setValue(objectValue(count));
-                }
-                else {
-                    std::string result;
-                    BsonUtils::buildJsonString(element, result, AppRegistry::instance().settingsManager()->uuidEncoding(), AppRegistry::instance().settingsManager()->timeZone());
-                    childItemInner->setValue(QtUtils::toQString(result));
-                }
-                childItemInner->setType(element.type());
-                if (element.type() == mongo::BinData) {
-                    childItemInner->setBinType(element.binDataType());
-                }
-                root->addChild(childItemInner);
-                //root->setValue(QString("{ %1 fields }").arg(root->childrenCount()));
-            }            
-    }
+    // Nested arrays longer than this are shown as range items of this many elements
+    const unsigned ArrayRangeSize = 1000;
 }
 
 namespace Robomongo
 {
     BsonTreeModel::BsonTreeModel(const std::vector<MongoDocumentPtr> &documents, QObject *parent) :
         BaseClass(parent),
-        _root(new BsonTreeItem(this))
+        _root(new (_arena.allocate<BsonTreeItem>(1)) BsonTreeItem(nullptr, nullptr, 0)),
+        _keys(maxCachedStrings),
+        _values(maxCachedStrings)
+    {
+        _documents.reserve(documents.size());
+        _documentItems.reserve(documents.size());
+        for (int i = 0; i < documents.size(); ++i) {
+            addDocument(documents[i]);
+        }
+    }
+
+    void BsonTreeModel::appendDocuments(const std::vector<MongoDocumentPtr> &documents)
     {
+        if (documents.empty())
+            return;
+
+        int const first = _root->childrenCount();
+        beginInsertRows(QModelIndex(), first, first + documents.size() - 1);
         for (int i = 0; i < documents.size(); ++i) {
-            MongoDocumentPtr doc = documents[i]; 
-            BsonTreeItem *child = new BsonTreeItem(doc->bsonObj(), _root);
-            parseDocument(child, doc->bsonObj(), doc->bsonObj().isArray());
-
-            QString idValue;
-            BsonTreeItem *idItem = child->childByKey("_id");
-            if (idItem) {
-                idValue = idItem->value();
+            addDocument(documents[i]);
+        }
+        endInsertRows();
+    }
+
+    void BsonTreeModel::applyPatch(const PagePatch &patch, const std::vector<MongoDocumentPtr> &documents)
+    {
+        if (patch.isEmpty())
+            return;
+
+        // Items of removed documents stay in arena, but nothing cached may point into their
+        // documents: caches are dropped before views are signaled and once more in the end
+        _elementIndex.clear();
+        _keys.clear();
+        _values.clear();
+
+        // Contiguous rows are removed and inserted at once, removed ones from the end
+        for (size_t k = patch.removed.size(); k > 0;) {
+            int const last = patch.removed[--k];
+            int first = last;
+            while (k > 0 && patch.removed[k - 1] == first - 1)
+                first = patch.removed[--k];
+            removeDocuments(first, last);
+        }
+
+        for (size_t k = 0; k < patch.inserted.size(); ++k) {
+            int const first = patch.inserted[k];
+            int last = first;
+            while (k + 1 < patch.inserted.size() && patch.inserted[k + 1] == last + 1)
+                last = patch.inserted[++k];
+            insertDocuments(documents, first, last);
+        }
+
+        for (int const row : patch.updated) {
+            // Children of expanded (or shown in table) document are replaced by removing it
+            if (_documentItems[row]->isChildrenFetched()) {
+                removeDocuments(row, row);
+                insertDocuments(documents, row, row);
+                continue;
             }
 
-            child->setKey(QString("(%1) %2").arg(i + 1).arg(idValue));
+            // The same item, so that indexes kept by views stay valid
+            _documents[row] = documents[row];
+            _documentItems[row]->setRoot(documents[row]->bsonObj().objdata());
+            _documentItems[row]->setType(documents[row]->bsonObj().isArray() ? mongo::Array : mongo::Object);
+            emit dataChanged(index(row, 0), index(row, BsonTreeItem::eCountColumns - 1));
+        }
 
-            int count = BsonUtils::elementsCount(doc->bsonObj());
+        _elementIndex.clear();
+        _keys.clear();
+        _values.clear();
+
+        // Numbers of documents shown in keys have changed after the first removed or inserted row
+        int firstMoved = static_cast<int>(_documentItems.size());
+        if (!patch.removed.empty())
+            firstMoved = std::min(firstMoved, patch.removed.front());
+        if (!patch.inserted.empty())
+            firstMoved = std::min(firstMoved, patch.inserted.front());
+        if (firstMoved < static_cast<int>(_documentItems.size()))
+            emit dataChanged(index(firstMoved, BsonTreeItem::eKey),
+                             index(_documentItems.size() - 1, BsonTreeItem::eKey));
+    }
 
-            if (doc->bsonObj().isArray()) {
-                child->setValue(arrayValue(count));
-                child->setType(mongo::Array);
-            } else {
-                child->setValue(objectValue(count));
-                child->setType(mongo::Object);
+    void BsonTreeModel::removeDocuments(int first, int last)
+    {
+        beginRemoveRows(QModelIndex(), first, last);
+        for (int row = first; row <= last; ++row)
+            _expansionCuts.remove(_documentItems[row]);
+        _documents.erase(_documents.begin() + first, _documents.begin() + last + 1);
+        _documentItems.erase(_documentItems.begin() + first, _documentItems.begin() + last + 1);
+        renumberDocuments(first);
+        endRemoveRows();
+    }
+
+    void BsonTreeModel::insertDocuments(const std::vector<MongoDocumentPtr> &documents, int first, int last)
+    {
+        beginInsertRows(QModelIndex(), first, last);
+        _documents.insert(_documents.begin() + first, documents.begin() + first, documents.begin() + last + 1);
+        for (int row = first; row <= last; ++row)
+            _documentItems.insert(_documentItems.begin() + row, createDocumentItem(documents[row], row));
+        renumberDocuments(first);
+        endInsertRows();
+    }
+
+    void BsonTreeModel::addDocument(const MongoDocumentPtr &doc)
+    {
+        _documents.push_back(doc);
+        _documentItems.push_back(createDocumentItem(doc, _documentItems.size()));
+        _root->setChildren(_documentItems.data(), _documentItems.size());
+    }
+
+    BsonTreeItem *BsonTreeModel::createDocumentItem(const MongoDocumentPtr &doc, int row)
+    {
+        // Fields of document are parsed only when it gets expanded, see fetchMore()
+        BsonTreeItem *child = new (_arena.allocate<BsonTreeItem>(1))
+            BsonTreeItem(_root, doc->bsonObj().objdata(), row);
+        child->setPosition(row + 1);
+        child->setType(doc->bsonObj().isArray() ? mongo::Array : mongo::Object);
+        return child;
+    }
+
+    void BsonTreeModel::renumberDocuments(int first)
+    {
+        for (size_t row = first; row < _documentItems.size(); ++row) {
+            _documentItems[row]->setRow(static_cast<int>(row));
+            _documentItems[row]->setPosition(static_cast<int>(row) + 1);
+        }
+        _root->setChildren(_documentItems.data(), _documentItems.size());
+    }
+
+    void BsonTreeModel::parseDocument(BsonTreeItem *node, const mongo::BSONObj &doc, bool isArray)
+    {
+        // Usually indexed already, when value of collapsed item was shown
+        std::vector<int> const &offsets = _elementIndex.offsets(doc);
+        unsigned const size = offsets.size();
+
+        // Elements of large arrays (but not of top-level documents, which are table
+        // rows too) are created per range, when it is expanded
+        if (isArray && size > ArrayRangeSize && !node->element().eoo()) {
+            unsigned const count = (size + ArrayRangeSize - 1) / ArrayRangeSize;
+            BsonTreeItem *items = _arena.allocate<BsonTreeItem>(count);
+            BsonTreeItem **children = _arena.allocate<BsonTreeItem *>(count);
+            for (unsigned row = 0; row < count; ++row) {
+                BsonTreeItem *range = new (items + row) BsonTreeItem(node, doc.objdata(), row);
+                range->setRange(row * ArrayRangeSize, std::min(ArrayRangeSize, size - row * ArrayRangeSize));
+                range->setType(mongo::Array);
+                children[row] = range;
             }
-            _root->addChild(child);
+            node->setChildren(children, count);
+            node->setChildrenFetched(true);
+            return;
         }
+
+        parseElements(node, doc, isArray, 0, size);
+    }
+
+    void BsonTreeModel::parseElements(BsonTreeItem *node, const mongo::BSONObj &doc, bool isArray,
+                                      unsigned first, unsigned count)
+    {
+        // Children and array of pointers to them are allocated at once
+        std::vector<int> const &offsets = _elementIndex.offsets(doc);
+        BsonTreeItem *items = _arena.allocate<BsonTreeItem>(count);
+        BsonTreeItem **children = _arena.allocate<BsonTreeItem *>(count);
+
+        for (unsigned row = 0; row < count; ++row) {
+            int const offset = offsets[first + row];
+            mongo::BSONElement element(doc.objdata() + offset);
+            BsonTreeItem *child = new (items + row) BsonTreeItem(node, doc.objdata(), row);
+            child->setElementOffset(offset);
+            child->setNameId(_fieldNames.intern(element.fieldName(), isArray));
+            child->setArrayElement(isArray);
+            child->setType(element.type());
+            if (element.type() == mongo::BinData) {
+                child->setBinType(element.binDataType());
+            }
+            children[row] = child;
+        }
+        node->setChildren(children, count);
+        node->setChildrenFetched(true);
     }
 
     void BsonTreeModel::fetchMore(const QModelIndex &parent)
     {
         BsonTreeItem *node = QtUtils::item<BsonTreeItem*>(parent);
         if (node) {
-            mongo::BSONElement elem = BsonUtils::indexOf(node->root(), parent.row());
-            if (!elem.isNull() && elem.isABSONObj()) {
-                parseDocument(node, elem.Obj(), elem.type() == mongo::Array);
-            }            
+            fetchChildren(node);
         }
         return BaseClass::fetchMore(parent);
     }
 
+    void BsonTreeModel::fetchChildren(BsonTreeItem *node)
+    {
+        if (node->isChildrenFetched() || !BsonUtils::isDocument(node->type()))
+            return;
+
+        // Elements of range are located with offsets of the whole array
+        if (node->isRange()) {
+            parseElements(node, node->root(), true, node->rangeFirst(), node->rangeCount());
+            return;
+        }
+
+        // Items of top-level documents have no parent element, they represent root() itself
+        mongo::BSONElement elem = node->element();
+        if (elem.eoo()) {
+            parseDocument(node, node->root(), node->root().isArray());
+        }
+        else if (elem.isABSONObj()) {
+            parseDocument(node, elem.Obj(), elem.type() == mongo::Array);
+        }
+    }
+
     bool BsonTreeModel::canFetchMore(const QModelIndex &parent) const
     {
         BsonTreeItem *node = QtUtils::item<BsonTreeItem*>(parent);
-        if (node && !node->childrenCount()) {
+        if (node && !node->isChildrenFetched()) {
             return BsonUtils::isDocument(node->type());
         }
         return false;
@@ -127,28 +258,38 @@ namespace Robomongo
         return true;
     }
 
+    long long BsonTreeModel::memoryBytes() const
+    {
+        return _arena.allocatedBytes() + _documentItems.capacity() * sizeof(BsonTreeItem *) +
+               (_keys.size() + _values.size()) * cachedStringBytes + _elementIndex.memoryBytes();
+    }
+
     const QIcon &BsonTreeModel::getIcon(BsonTreeItem *item)
     {
-        switch(item->type()) {
-        case mongo::NumberDouble: return GuiRegistry::instance().bsonDoubleIcon();
-        case mongo::NumberDecimal: return GuiRegistry::instance().bsonNumberDecimalIcon();
-        case mongo::String: return GuiRegistry::instance().bsonStringIcon();
-        case mongo::Object: return GuiRegistry::instance().bsonObjectIcon();
-        case mongo::Array: return GuiRegistry::instance().bsonArrayIcon();
-        case mongo::BinData: return GuiRegistry::instance().bsonBinaryIcon();
-        case mongo::Undefined: return GuiRegistry::instance().circleIcon();
-        case mongo::jstOID: return GuiRegistry::instance().circleIcon();
-        case mongo::Bool: return GuiRegistry::instance().bsonBooleanIcon();
-        case mongo::Date: return GuiRegistry::instance().bsonDateTimeIcon();
-        case mongo::jstNULL: return GuiRegistry::instance().bsonNullIcon();
-        case mongo::RegEx: return GuiRegistry::instance().circleIcon();
-        case mongo::DBRef: return GuiRegistry::instance().circleIcon();
-        case mongo::Code: case mongo::CodeWScope: return GuiRegistry::instance().circleIcon();
-        case mongo::NumberInt: return GuiRegistry::instance().bsonIntegerIcon();
-        case mongo::bsonTimestamp: return GuiRegistry::instance().bsonDateTimeIcon();
-        case mongo::NumberLong: return GuiRegistry::instance().bsonIntegerIcon();
-        default: return GuiRegistry::instance().circleIcon();
-        }
+        return getIcon(item->type());
+    }
+
+    const QIcon &BsonTreeModel::getIcon(mongo::BSONType type)
+    {
+        // In order of BsonUtils::TypeIcon
+        GuiRegistry const &registry = GuiRegistry::instance();
+        static const QIcon *const icons[] = {
+            &registry.circleIcon(),
+            &registry.bsonDoubleIcon(),
+            &registry.bsonNumberDecimalIcon(),
+            &registry.bsonStringIcon(),
+            &registry.bsonObjectIcon(),
+            &registry.bsonArrayIcon(),
+            &registry.bsonBinaryIcon(),
+            &registry.bsonBooleanIcon(),
+            &registry.bsonDateTimeIcon(),
+            &registry.bsonNullIcon(),
+            &registry.bsonIntegerIcon()
+        };
+        static_assert(sizeof(icons) / sizeof(icons[0]) == static_cast<size_t>(BsonUtils::TypeIcon::Integer) + 1,
+                      "Icon is missing for BsonUtils::TypeIcon");
+
+        return *icons[static_cast<size_t>(BsonUtils::typeTraits(type).icon)];
     }
 
     QVariant BsonTreeModel::data(const QModelIndex &index, int role) const
@@ -176,16 +317,22 @@ namespace Robomongo
         if (role == Qt::DisplayRole || role == Qt::ToolTipRole) {
             if (col == BsonTreeItem::eKey) {
                 if (role == Qt::DisplayRole) {
-                    result = node->key();
+                    result = cachedKey(node);
                 }
             }
             else if (col == BsonTreeItem::eValue) {
                 bool isCut = node->type() == mongo::String ||  node->type() == mongo::Code || node->type() == mongo::CodeWScope;  
+                QString const value = cachedValue(node);
                 if (role == Qt::ToolTipRole) {
-                    result = isCut ? node->value().left(500) : node->value(); 
+                    result = isCut ? value.left(500) : value; 
                 }
                 else{
-                    result = isCut ? node->value().simplified().left(300) : node->value(); 
+                    result = isCut ? value.simplified().left(300) : value; 
+                }
+
+                // Placeholder of fields not shown by budgeted "Expand Recursively"
+                if (role == Qt::DisplayRole && _expansionCuts.contains(node)) {
+                    result = value + "   " + tr("%1 more...").arg(fieldsCount(node));
                 }
             }
             else if (col == BsonTreeItem::eType) {
@@ -196,6 +343,86 @@ namespace Robomongo
         return result;
     }
 
+    QString BsonTreeModel::cachedKey(const BsonTreeItem *node) const
+    {
+        // Fields share interned key, only keys of documents ("(1) <_id>") are cached
+        if (node->nameId() != FieldNameInterner::NoId)
+            return _fieldNames.name(node->nameId());
+
+        if (const QString *key = _keys.object(node))
+            return *key;
+
+        QString *key = new QString(node->key());
+        QString const result = *key;
+        _keys.insert(node, key);
+        return result;
+    }
+
+    QString BsonTreeModel::cachedValue(const BsonTreeItem *node) const
+    {
+        if (const QString *value = _values.object(node))
+            return *value;
+
+        QString *value = new QString(documentValue(node));
+        QString const result = *value;
+        _values.insert(node, value);
+        return result;
+    }
+
+    QString BsonTreeModel::documentValue(const BsonTreeItem *node) const
+    {
+        if (!BsonUtils::isDocument(node->type()))
+            return node->value();
+
+        return BsonTreeItem::documentValue(node->type() == mongo::Array, fieldsCount(node));
+    }
+
+    int BsonTreeModel::fieldsCount(const BsonTreeItem *node) const
+    {
+        if (node->isRange())
+            return node->rangeCount();
+
+        // Fetched large array has range items as children
+        if (node->isChildrenFetched() && !(node->childrenCount() > 0 && node->child(0)->isRange()))
+            return node->childrenCount();
+
+        return BsonUtils::elementsCount(nodeObject(node), _elementIndex);
+    }
+
+    mongo::BSONObj BsonTreeModel::nodeObject(const BsonTreeItem *node)
+    {
+        mongo::BSONElement const elem = node->element();
+        return elem.eoo() ? node->root() : elem.Obj();
+    }
+
+    void BsonTreeModel::setExpansionCut(const QModelIndex &index, bool cut)
+    {
+        BsonTreeItem const *node = QtUtils::item<BsonTreeItem*>(index);
+        if (!node || _expansionCuts.contains(node) == cut)
+            return;
+
+        if (cut)
+            _expansionCuts.insert(node);
+        else
+            _expansionCuts.remove(node);
+
+        QModelIndex const value = index.sibling(index.row(), BsonTreeItem::eValue);
+        emit dataChanged(value, value);
+    }
+
+    void BsonTreeModel::clearExpansionCuts()
+    {
+        if (_expansionCuts.isEmpty())
+            return;
+
+        QSet<const BsonTreeItem *> const cuts = std::move(_expansionCuts);
+        _expansionCuts.clear();
+        for (const BsonTreeItem *node : cuts) {
+            QModelIndex const value = createIndex(node->row(), BsonTreeItem::eValue, const_cast<BsonTreeItem *>(node));
+            emit dataChanged(value, value);
+        }
+    }
+
     Qt::ItemFlags BsonTreeModel::flags(const QModelIndex &index) const
     {
         Qt::ItemFlags result = 0;
@@ -246,11 +473,9 @@ namespace Robomongo
         QModelIndex result;
         if (index.isValid()) {
             BsonTreeItem *const childItem = QtUtils::item<BsonTreeItem*const>(index);
-            BsonTreeItem *const parentItem = static_cast<BsonTreeItem*const>(childItem->parent());
+            BsonTreeItem *const parentItem = childItem->parent();
             if (parentItem && parentItem != _root) {
-                BsonTreeItem *const grandParent = static_cast<BsonTreeItem*const>(parentItem->parent());
-                int row = grandParent->indexOf(parentItem);
-                result = createIndex(row, 0, parentItem);
+                result = createIndex(parentItem->row(), 0, parentItem);
             }
         }
         return result;
@@ -274,25 +499,4 @@ namespace Robomongo
         }
         return index;
     }
-
-    void BsonTreeModel::insertItem(BsonTreeItem *parent, BsonTreeItem *children)
-    {
-        QModelIndex index = createIndex(0, 0, parent);
-        unsigned child_count = parent->childrenCount();
-        beginInsertRows(index, child_count, child_count);
-        parent->addChild(children);
-        endInsertRows();
-    }
-
-    void BsonTreeModel::removeitem(BsonTreeItem *children)
-    {
-        BsonTreeItem *parent = static_cast<BsonTreeItem *>(children->parent());
-        if (parent) {
-            QModelIndex index = createIndex(0, 0, parent);
-            int row = parent->indexOf(children);
-            beginRemoveRows(index, row, row);
-            parent->removeChild(children);
-            endRemoveRows();
-        }
-    }
-}
+}
\ No newline at end of file
@@ -1,12 +1,21 @@
 #pragma once
 #include <vector>
 #include <QAbstractItemModel>
+#include <QCache>
+#include <QSet>
+#include <mongo/bson/bsontypes.h>
 #include "robomongo/core/Core.h"
+#include "robomongo/core/domain/FieldNameInterner.h"
+#include "robomongo/core/domain/PagePatch.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
 
 namespace Robomongo
 {
-    class BsonTreeItem;
-
+    /**
+     * @brief Items of model are allocated from its arena and point into its documents,
+     *        so destroying model frees them without visiting every item
+     */
     class BsonTreeModel : public QAbstractItemModel
     {
         Q_OBJECT
@@ -14,6 +23,7 @@ namespace Robomongo
     public:
         typedef QAbstractItemModel BaseClass;
         static const QIcon &getIcon(BsonTreeItem *item);
+        static const QIcon &getIcon(mongo::BSONType type);
         explicit BsonTreeModel(const std::vector<MongoDocumentPtr> &documents, QObject *parent = 0);
         QVariant data(const QModelIndex &index, int role) const;
 
@@ -25,13 +35,88 @@ namespace Robomongo
         virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
         virtual QModelIndex parent(const QModelIndex& index) const;
 
-        void insertItem(BsonTreeItem *parent, BsonTreeItem *children);
-        void removeitem(BsonTreeItem *children);
+        /**
+         * @brief Appends top-level documents, numbering them after existing ones
+         */
+        void appendDocuments(const std::vector<MongoDocumentPtr> &documents);
+
+        /**
+         * @brief Turns documents of model into 'documents' (page read again) with rows removed,
+         *        inserted and changed by 'patch', so that views keep expansion and scrolling.
+         *        Documents of unchanged rows are kept, documents() then hold the new page.
+         */
+        void applyPatch(const PagePatch &patch, const std::vector<MongoDocumentPtr> &documents);
+
+        /**
+         * @brief Creates child items of 'node', if they were not created yet
+         */
+        void fetchChildren(BsonTreeItem *node);
 
         virtual void fetchMore(const QModelIndex &parent);
         virtual bool canFetchMore(const QModelIndex &parent) const;
         virtual bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+
+        /**
+         * @brief Estimated memory of items and cached strings, documents are not counted
+         */
+        long long memoryBytes() const;
+
+        /**
+         * @brief Keys of all fetched items of this result, see BsonTreeItem::nameId()
+         */
+        FieldNameInterner &fieldNames() const { return _fieldNames; }
+
+        /**
+         * @brief Top-level documents of this result, in order of rows
+         */
+        const std::vector<MongoDocumentPtr> &documents() const { return _documents; }
+
+        /**
+         * @brief Marks document left collapsed by budgeted recursive expansion, its value
+         *        gets "N more..." placeholder (see BsonTreeView::expandNode())
+         */
+        void setExpansionCut(const QModelIndex &index, bool cut);
+        void clearExpansionCuts();
+
     protected:
+        void addDocument(const MongoDocumentPtr &doc);
+        BsonTreeItem *createDocumentItem(const MongoDocumentPtr &doc, int row);
+
+        // Rows and positions of document items from 'first' on, after rows were inserted or removed
+        void renumberDocuments(int first);
+
+        // Rows [first, last] of documents, rows of 'documents' when inserted
+        void removeDocuments(int first, int last);
+        void insertDocuments(const std::vector<MongoDocumentPtr> &documents, int first, int last);
+
+        // Key and value strings of item, built on first request and kept in LRU caches
+        QString cachedKey(const BsonTreeItem *node) const;
+        QString cachedValue(const BsonTreeItem *node) const;
+
+        // Value of item; fields of objects and arrays are counted with _elementIndex
+        QString documentValue(const BsonTreeItem *node) const;
+
+        // Fields of object or array item, elements of range item
+        int fieldsCount(const BsonTreeItem *node) const;
+
+        // Object or array of document item, or of field item
+        static mongo::BSONObj nodeObject(const BsonTreeItem *node);
+
+        // Creates one child per field of 'doc', without key and value strings
+        void parseDocument(BsonTreeItem *node, const mongo::BSONObj &doc, bool isArray);
+
+        // Creates children of 'node' for elements [first, first + count) of 'doc'
+        void parseElements(BsonTreeItem *node, const mongo::BSONObj &doc, bool isArray,
+                           unsigned first, unsigned count);
+
+        BsonTreeItemArena _arena;
         BsonTreeItem *const _root;
+        std::vector<MongoDocumentPtr> _documents;   // keep data of items alive
+        std::vector<BsonTreeItem *> _documentItems; // children of _root
+        mutable FieldNameInterner _fieldNames;
+        mutable BsonUtils::ElementIndex _elementIndex;   // of documents and their nested objects
+        mutable QCache<const BsonTreeItem *, QString> _keys;
+        mutable QCache<const BsonTreeItem *, QString> _values;
+        QSet<const BsonTreeItem *> _expansionCuts;
     };
 }
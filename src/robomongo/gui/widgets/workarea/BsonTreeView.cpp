@@ -4,17 +4,31 @@
 #include <QAction>
 #include <QMenu>
 #include <QKeyEvent>
+#include <QElapsedTimer>
+#include <QTimer>
 
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/gui/GuiRegistry.h"
 #include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
+#include "robomongo/gui/widgets/workarea/BsonTreeModel.h"
 #include "robomongo/gui/widgets/workarea/OutputWidget.h"
 
+namespace
+{
+    // Items created by one "Expand Recursively", deep documents with large arrays
+    // could otherwise create millions of them
+    const long long ExpandItemsBudget = 50000;
+
+    // Expansion yields to event loop after this time, so view stays responsive
+    const qint64 ExpandSliceMs = 30;
+}
+
 namespace Robomongo
 {
     BsonTreeView::BsonTreeView(MongoShell *shell, const MongoQueryInfo &queryInfo, QWidget *parent)
         : BaseClass(parent), _notifier(this, shell, queryInfo), 
-          _outputItemContentWidget(dynamic_cast<const OutputItemContentWidget*>(parent))
+          _outputItemContentWidget(dynamic_cast<const OutputItemContentWidget*>(parent)),
+          _expandBudget(0), _expandScheduled(false)
     {
 #if defined(Q_OS_MAC)
         setAttribute(Qt::WA_MacShowFocusRect, false);
@@ -32,6 +46,7 @@ namespace Robomongo
         _collapseRecursive = new QAction(tr("Collapse Recursively"), this);
         _collapseRecursive->setShortcut(QKeySequence(Qt::ALT + Qt::Key_Left));
         VERIFY(connect(_collapseRecursive, SIGNAL(triggered()), SLOT(onCollapseRecursive())));
+        VERIFY(connect(this, SIGNAL(expanded(const QModelIndex &)), SLOT(onExpanded(const QModelIndex &))));
 
         setStyleSheet("QTreeView { border-left: 1px solid #c7c5c4; border-top: 1px solid #c7c5c4; }");
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
@@ -111,16 +126,72 @@ namespace Robomongo
 
     void BsonTreeView::expandNode(const QModelIndex &index)
     {
-        if (index.isValid()) {
-            BaseClass::expand(index);
+        if (!index.isValid())
+            return;
+
+        // New expansion starts with full budget, nodes cut by previous one are shown as they are
+        if (_expandQueue.empty()) {
+            _expandBudget = ExpandItemsBudget;
+            if (BsonTreeModel *treeModel = qobject_cast<BsonTreeModel*>(model()))
+                treeModel->clearExpansionCuts();
+        }
+
+        _expandQueue.push_back(index);
+        expandSlice();
+    }
+
+    void BsonTreeView::expandSlice()
+    {
+        _expandScheduled = false;
+        BsonTreeModel *treeModel = qobject_cast<BsonTreeModel*>(model());
+
+        QElapsedTimer timer;
+        timer.start();
+        while (!_expandQueue.empty() && _expandBudget > 0 && timer.elapsed() < ExpandSliceMs) {
+            QModelIndex const index = _expandQueue.front();
+            _expandQueue.pop_front();
+
             BsonTreeItem *item = QtUtils::item<BsonTreeItem*>(index);
+            if (!item)  // model was replaced meanwhile
+                continue;
+
+            // Children are created lazily; expand() may postpone fetching them
+            if (treeModel && !item->isChildrenFetched()) {
+                treeModel->fetchChildren(item);
+                _expandBudget -= item->childrenCount();
+            }
+            BaseClass::expand(index);
+
             for (unsigned i = 0; i < item->childrenCount(); ++i) {
                 BsonTreeItem *tritem = item->child(i);
-                if (tritem && detail::isDocumentType(tritem)) {
-                    expandNode(model()->index(i, 0, index));
-                }
+                if (tritem && detail::isDocumentType(tritem))
+                    _expandQueue.push_back(model()->index(i, 0, index));
+            }
+        }
+
+        if (_expandQueue.empty())
+            return;
+
+        if (_expandBudget > 0) {
+            if (!_expandScheduled) {
+                _expandScheduled = true;
+                QTimer::singleShot(0, this, SLOT(expandSlice()));
             }
+            return;
+        }
+
+        // Budget is used up: the rest stays collapsed, with "N more..." in its value
+        for (auto const &index : _expandQueue) {
+            if (treeModel && index.isValid())
+                treeModel->setExpansionCut(index, true);
         }
+        _expandQueue.clear();
+    }
+
+    void BsonTreeView::onExpanded(const QModelIndex &index)
+    {
+        if (BsonTreeModel *treeModel = qobject_cast<BsonTreeModel*>(model()))
+            treeModel->setExpansionCut(index, false);
     }
     
     void BsonTreeView::collapseNode(const QModelIndex &index)
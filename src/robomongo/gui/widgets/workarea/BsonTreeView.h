@@ -1,5 +1,7 @@
 #pragma once
 
+#include <deque>
+#include <QPersistentModelIndex>
 #include <QTreeView>
 
 #include "robomongo/core/domain/Notifier.h"
@@ -18,10 +20,17 @@ namespace Robomongo
         BsonTreeView(MongoShell *shell, const MongoQueryInfo &queryInfo, QWidget *parent = NULL);
         virtual QModelIndex selectedIndex() const;
         virtual QModelIndexList selectedIndexes() const;
+        /**
+         * @brief Expands 'index' and its nested documents, level by level, in slices of
+         *        event loop. Expansion stops when budget of created items is used up;
+         *        documents left collapsed show how many fields they have more.
+         */
         void expandNode(const QModelIndex &index);
         void collapseNode(const QModelIndex &index);
         
     private Q_SLOTS:
+        void expandSlice();
+        void onExpanded(const QModelIndex &index);
         void onExpandRecursive();
         void onCollapseRecursive();
         void showContextMenu(const QPoint &point);
@@ -35,5 +44,10 @@ namespace Robomongo
         QAction *_expandRecursive;
         QAction *_collapseRecursive;
         const OutputItemContentWidget* _outputItemContentWidget;
+
+        // Documents to expand next, in breadth-first order, see expandNode()
+        std::deque<QPersistentModelIndex> _expandQueue;
+        long long _expandBudget;
+        bool _expandScheduled;
     };
 }
@@ -1,5 +1,6 @@
 #include "robomongo/gui/widgets/workarea/CollectionStatsTreeItem.h"
 
+#include <QFont>
 #include <mongo/db/jsobj.h>
 #include <mongo/bson/bsonobj.h>
 
@@ -29,11 +30,43 @@ namespace Robomongo
 
         setText(0, prepareValue(QtUtils::toQString(ns.collectionName())));
         setIcon(0, GuiRegistry::instance().collectionIcon());
-        setText(1, prepareValue(QString::number(BsonUtils::getField<mongo::NumberLong>(_obj, "count"))));
-        setText(2, prepareValue(MongoUtils::buildNiceSizeString(BsonUtils::getField<mongo::NumberDouble>(_obj, "size"))));
-        setText(3, prepareValue(MongoUtils::buildNiceSizeString(BsonUtils::getField<mongo::NumberDouble>(_obj, "storageSize"))));
-        setText(4, prepareValue(MongoUtils::buildNiceSizeString(BsonUtils::getField<mongo::NumberDouble>(_obj, "totalIndexSize"))));
+        setSizes(BsonUtils::getField<mongo::NumberLong>(_obj, "count"),
+                 BsonUtils::getField<mongo::NumberDouble>(_obj, "size"),
+                 BsonUtils::getField<mongo::NumberDouble>(_obj, "storageSize"),
+                 BsonUtils::getField<mongo::NumberDouble>(_obj, "totalIndexSize"));
         setText(5, prepareValue(MongoUtils::buildNiceSizeString(BsonUtils::getField<mongo::NumberDouble>(_obj, "avgObjSize"))));
         setText(6, prepareValue(QString::number(BsonUtils::getField<mongo::NumberDouble>(_obj, "paddingFactor"))));
     }
+
+    CollectionStatsTreeItem::CollectionStatsTreeItem()
+    {
+        setTotals(0, 0, 0, 0, 0);
+
+        QFont font = this->font(0);
+        font.setBold(true);
+        for (int column = 0; column < columnCount(); ++column)
+            setFont(column, font);
+    }
+
+    void CollectionStatsTreeItem::setTotals(int collections, long long count, double size, double storageSize,
+                                            double totalIndexSize)
+    {
+        setText(0, prepareValue(QString("Total (%1 collections)").arg(collections)));
+        setSizes(count, size, storageSize, totalIndexSize);
+        setText(5, prepareValue(MongoUtils::buildNiceSizeString(count > 0 ? size / count : 0)));
+    }
+
+    void CollectionStatsTreeItem::setSizes(long long count, double size, double storageSize, 
+                                           double totalIndexSize)
+    {
+        _count = count;
+        _size = size;
+        _storageSize = storageSize;
+        _totalIndexSize = totalIndexSize;
+
+        setText(1, prepareValue(QString::number(count)));
+        setText(2, prepareValue(MongoUtils::buildNiceSizeString(size)));
+        setText(3, prepareValue(MongoUtils::buildNiceSizeString(storageSize)));
+        setText(4, prepareValue(MongoUtils::buildNiceSizeString(totalIndexSize)));
+    }
 }
@@ -8,5 +8,25 @@ namespace Robomongo
     {
     public:
         CollectionStatsTreeItem(MongoDocumentPtr document);
+
+        /**
+         * @brief Row of totals (in bold), they are set with setTotals()
+         */
+        CollectionStatsTreeItem();
+        void setTotals(int collections, long long count, double size, double storageSize,
+                       double totalIndexSize);
+
+        long long count() const { return _count; }
+        double size() const { return _size; }
+        double storageSize() const { return _storageSize; }
+        double totalIndexSize() const { return _totalIndexSize; }
+
+    private:
+        void setSizes(long long count, double size, double storageSize, double totalIndexSize);
+
+        long long _count;
+        double _size;
+        double _storageSize;
+        double _totalIndexSize;
     };
 }
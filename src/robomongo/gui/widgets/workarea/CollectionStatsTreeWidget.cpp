@@ -2,13 +2,23 @@
 
 #include <QHeaderView>
 
+#include "robomongo/gui/utils/ColumnSizing.h"
 #include "robomongo/gui/widgets/workarea/CollectionStatsTreeItem.h"
 
+namespace
+{
+    // Columns are fitted to contents of the first rows only, later rows of a long
+    // (streamed) list do not change widths anymore
+    int const MaxFittedRows = 500;
+}
+
 namespace Robomongo
 {
 
-    CollectionStatsTreeWidget::CollectionStatsTreeWidget(const std::vector<MongoDocumentPtr> &documents, QWidget *parent) 
-        : QTreeWidget(parent)
+    CollectionStatsTreeWidget::CollectionStatsTreeWidget(const std::vector<MongoDocumentPtr> &documents, QWidget *parent,
+                                                         bool withTotals)
+        : QTreeWidget(parent), _totals(NULL), _collections(0), _count(0), _size(0), _storageSize(0),
+          _totalIndexSize(0)
     {
         QStringList colums;
         colums << "Name" << "Count" << "Size" << "Storage" << "Index" << "Average Object" << "Padding";
@@ -18,16 +28,46 @@ namespace Robomongo
             "QTreeWidget { border-left: 1px solid #c7c5c4; border-top: 1px solid #c7c5c4; }"
         );
 
+        if (withTotals) {
+            _totals = new CollectionStatsTreeItem();
+            addTopLevelItem(_totals);
+        }
+
+        appendDocuments(documents);
+        resizeColumns();
+    }
+
+    void CollectionStatsTreeWidget::appendDocuments(const std::vector<MongoDocumentPtr> &documents)
+    {
+        if (documents.empty())
+            return;
+
         QList<QTreeWidgetItem *> items;
         size_t documentsCount = documents.size();
         for (int i = 0; i < documentsCount; i++) {
             MongoDocumentPtr document = documents[i];
             CollectionStatsTreeItem *item = new CollectionStatsTreeItem(document);
             items.append(item);
+
+            _count += item->count();
+            _size += item->size();
+            _storageSize += item->storageSize();
+            _totalIndexSize += item->totalIndexSize();
         }
+        _collections += items.size();
 
+        bool const fit = topLevelItemCount() < MaxFittedRows;
         addTopLevelItems(items);
 
-        header()->resizeSections(QHeaderView::ResizeToContents);
+        if (_totals)
+            _totals->setTotals(_collections, _count, _size, _storageSize, _totalIndexSize);
+
+        if (fit)
+            resizeColumns();
+    }
+
+    void CollectionStatsTreeWidget::resizeColumns()
+    {
+        utils::fitColumns(this, header());
     }
 }
@@ -6,10 +6,31 @@
 
 namespace Robomongo
 {
+    class CollectionStatsTreeItem;
+
     class CollectionStatsTreeWidget : public QTreeWidget
     {
         Q_OBJECT
     public:
-        CollectionStatsTreeWidget(const std::vector<MongoDocumentPtr> &documents, QWidget *parent = NULL);
+        /**
+         * @param withTotals Show row of totals above collections, see appendDocuments()
+         */
+        CollectionStatsTreeWidget(const std::vector<MongoDocumentPtr> &documents, QWidget *parent = NULL,
+                                  bool withTotals = false);
+
+        /**
+         * @brief Adds rows of collStats results and counts them into totals
+         */
+        void appendDocuments(const std::vector<MongoDocumentPtr> &documents);
+
+        void resizeColumns();
+
+    private:
+        CollectionStatsTreeItem *_totals;   // null if not shown
+        int _collections;
+        long long _count;
+        double _size;
+        double _storageSize;
+        double _totalIndexSize;
     };
 }
@@ -0,0 +1,70 @@
+#include "robomongo/gui/widgets/workarea/DocumentFilterThread.h"
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+    // Upper bound of documents per work item
+    const size_t maxDocumentsPerChunk = 4096;
+}
+
+namespace Robomongo
+{
+    class DocumentFilterThread::FilterChunkTask : public QRunnable
+    {
+    public:
+        FilterChunkTask(const DocumentFilterThread &owner, size_t first, size_t last, std::vector<size_t> &selection) :
+            _owner(owner), _first(first), _last(last), _selection(selection) {}
+
+        void run() override
+        {
+            _owner._filter.select(_owner._documents, _first, _last, _selection, &_owner._stop);
+        }
+
+    private:
+        const DocumentFilterThread &_owner;
+        const size_t _first;
+        const size_t _last;
+        std::vector<size_t> &_selection;
+    };
+
+    DocumentFilterThread::DocumentFilterThread(const std::vector<MongoDocumentPtr> &documents,
+                                               const DocumentFilter &filter) :
+        _documents(documents),
+        _filter(filter),
+        _stop(false)
+    {
+    }
+
+    void DocumentFilterThread::stop()
+    {
+        _stop = true;
+    }
+
+    void DocumentFilterThread::run()
+    {
+        size_t const count = _documents.size();
+
+        // Every chunk has its own selection, they are concatenated in order of chunks
+        QThreadPool pool;
+        pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
+        size_t const chunkSize = std::max<size_t>(1, std::min(maxDocumentsPerChunk, count / (pool.maxThreadCount() * 4)));
+
+        std::vector<std::unique_ptr<std::vector<size_t>>> selections;
+        for (size_t first = 0; first < count; first += chunkSize) {
+            selections.emplace_back(new std::vector<size_t>);
+            pool.start(new FilterChunkTask(*this, first, std::min(first + chunkSize, count), *selections.back()));
+        }
+        pool.waitForDone();
+
+        if (_stop)
+            return;
+
+        for (auto const &selection : selections)
+            _selection.insert(_selection.end(), selection->begin(), selection->end());
+        emit done();
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QThread>
+#include <atomic>
+#include <vector>
+
+#include "robomongo/core/Core.h"
+#include "robomongo/core/domain/DocumentFilter.h"
+
+namespace Robomongo
+{
+    /*
+    ** In this thread documents of result are filtered with DocumentFilter, in chunks on a
+    ** thread pool. Indexes of matched documents are read with selection() after done().
+    */
+    class DocumentFilterThread : public QThread
+    {
+        Q_OBJECT
+
+    public:
+        DocumentFilterThread(const std::vector<MongoDocumentPtr> &documents, const DocumentFilter &filter);
+        void stop();
+
+        const std::vector<size_t> &selection() const { return _selection; }
+
+    Q_SIGNALS:
+        /**
+         * @brief Signals when selection is complete, not emitted if stopped
+         */
+        void done();
+
+    protected:
+        virtual void run();
+
+    private:
+        class FilterChunkTask;
+
+        const std::vector<MongoDocumentPtr> _documents;
+        const DocumentFilter _filter;
+        std::vector<size_t> _selection;
+        std::atomic<bool> _stop;
+    };
+}
@@ -0,0 +1,187 @@
+#include "robomongo/gui/widgets/workarea/JsonPrepareJob.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <QThread>
+
+#include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace
+{
+    // Upper bounds of work item and of single partReady() string
+    const int maxDocumentsPerChunk = 256;
+    const int maxPartLength = 4 * 1024 * 1024;
+}
+
+namespace Robomongo
+{
+    /*
+    ** Documents and their chunks, shared with threads of pool, which may outlive the job
+    */
+    class JsonPrepareJob::Work : public ViewPreparePool::Job
+    {
+    public:
+        /*
+        ** Range [first, last) of documents and its JSON, 'ready' is set once json is complete
+        */
+        struct JsonChunk
+        {
+            JsonChunk(int first, int last) : first(first), last(last), ready(false) {}
+            const int first;
+            const int last;
+            std::string json;
+            std::atomic<bool> ready;
+        };
+
+        Work(const std::vector<MongoDocumentPtr> &bsonObjects, UUIDEncoding uuidEncoding, SupportedTimes timeZone,
+             JsonOutputMode mode, int firstPosition, JsonPrepareJob *owner) :
+            _bsonObjects(bsonObjects),
+            _uuidEncoding(uuidEncoding),
+            _timeZone(timeZone),
+            _mode(mode),
+            _firstPosition(firstPosition),
+            _next(0),
+            _stop(false),
+            _owner(owner)
+        {
+            // Enough chunks to keep all threads busy, small enough to be rescheduled often
+            int const count = _bsonObjects.size();
+            int const threads = std::max(1, QThread::idealThreadCount());
+            int const chunkSize = std::max(1, std::min(maxDocumentsPerChunk, count / (threads * 4)));
+            for (int first = 0; first < count; first += chunkSize)
+                chunks.emplace_back(new JsonChunk(first, std::min(first + chunkSize, count)));
+        }
+
+        bool runChunk() override
+        {
+            size_t const index = _next++;
+            if (index >= chunks.size() || _stop)
+                return false;
+
+            prepareChunk(*chunks[index]);
+
+            std::lock_guard<std::mutex> lock(_ownerMutex);
+            if (_owner)
+                QMetaObject::invokeMethod(_owner, "emitReadyChunks", Qt::QueuedConnection);
+
+            return index + 1 < chunks.size();
+        }
+
+        void stop()
+        {
+            _stop = true;
+            std::lock_guard<std::mutex> lock(_ownerMutex);
+            _owner = nullptr;
+        }
+
+        std::vector<std::unique_ptr<JsonChunk>> chunks;
+
+    private:
+        void prepareChunk(JsonChunk &chunk) const
+        {
+            // One buffer for the whole chunk, JSON of every document is appended to it
+            std::string &json = chunk.json;
+            size_t bsonSize = 0;
+            for (int i = chunk.first; i < chunk.last; ++i)
+                bsonSize += _bsonObjects[i]->bsonObj().objsize();
+            json.reserve(bsonSize * 2);
+
+            for (int i = chunk.first; i < chunk.last && !_stop; ++i) {
+                int const position = _firstPosition + i; // 1-based numbering to match tree & table views
+                if (_mode == CompactJson) {
+                    // Line per document, numbers are line numbers of editor
+                    if (position > 1)
+                        json += '\n';
+                }
+                else if (position == 1)
+                    json.append("/* 1 */\n");
+                else
+                    json.append("\n\n/* ").append(std::to_string(position)).append(" */\n");
+
+                mongo::BSONObj obj = _bsonObjects[i]->bsonObj();
+                BsonUtils::jsonString(obj, json, _mode, _uuidEncoding, _timeZone);
+            }
+            chunk.ready = true;
+        }
+
+        const std::vector<MongoDocumentPtr> _bsonObjects;
+        const UUIDEncoding _uuidEncoding;
+        const SupportedTimes _timeZone;
+        const JsonOutputMode _mode;
+        const int _firstPosition; // number of the first document, when appending to existing output
+        std::atomic<size_t> _next;
+        std::atomic<bool> _stop;
+
+        // Ready chunks are announced to job while it exists, queued calls are dropped with it
+        std::mutex _ownerMutex;
+        JsonPrepareJob *_owner;
+    };
+
+    JsonPrepareJob::JsonPrepareJob(const std::vector<MongoDocumentPtr> &bsonObjects, UUIDEncoding uuidEncoding, SupportedTimes timeZone,
+                                   JsonOutputMode mode, int firstPosition, QObject *parent)
+        : QObject(parent),
+        _work(std::make_shared<Work>(bsonObjects, uuidEncoding, timeZone, mode, firstPosition, this)),
+        _nextChunk(0),
+        _isStopped(false)
+    {
+    }
+
+    JsonPrepareJob::~JsonPrepareJob()
+    {
+        stop();
+    }
+
+    void JsonPrepareJob::start(int priority)
+    {
+        if (_work->chunks.empty()) {
+            // Signals are never emitted from start(), the same as with chunks
+            QMetaObject::invokeMethod(this, "emitReadyChunks", Qt::QueuedConnection);
+            return;
+        }
+
+        ViewPreparePool::instance().add(_work, priority);
+    }
+
+    void JsonPrepareJob::setPriority(int priority)
+    {
+        ViewPreparePool::instance().setPriority(_work.get(), priority);
+    }
+
+    void JsonPrepareJob::stop()
+    {
+        _isStopped = true;
+        _work->stop();
+        ViewPreparePool::instance().remove(_work.get());
+    }
+
+    void JsonPrepareJob::emitReadyChunks()
+    {
+        if (_isStopped)
+            return;
+
+        // Chunks already completed are coalesced into one partReady() signal
+        QString part;
+        auto const &chunks = _work->chunks;
+        for (; _nextChunk < chunks.size() && chunks[_nextChunk]->ready; ++_nextChunk) {
+            std::string &json = chunks[_nextChunk]->json;
+            part += QtUtils::toQString(json);
+            std::string().swap(json);
+
+            if (part.size() >= maxPartLength) {
+                emit partReady(part);
+                part.clear();
+            }
+        }
+
+        if (!part.isEmpty())
+            emit partReady(part);
+
+        if (_nextChunk == chunks.size()) {
+            _isStopped = true;
+            emit done();
+        }
+    }
+}
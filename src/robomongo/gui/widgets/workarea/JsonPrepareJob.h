@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QObject>
+#include <vector>
+#include <memory>
+
+#include "robomongo/core/Core.h"
+
+#include "robomongo/core/Enums.h"
+#include "robomongo/gui/widgets/workarea/ViewPreparePool.h"
+
+namespace Robomongo
+{
+    /*
+    ** Prepares JSON string from list of BSON objects. Documents are split into chunks formatted
+    ** on shared ViewPreparePool, the job reassembles them in original order in thread it lives in.
+    */
+    class JsonPrepareJob : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        /*
+        ** Constructor
+        */
+        JsonPrepareJob(const std::vector<MongoDocumentPtr> &bsonObjects, UUIDEncoding uuidEncoding, SupportedTimes timeZone,
+                       JsonOutputMode mode, int firstPosition = 1, QObject *parent = 0);
+        ~JsonPrepareJob();
+
+        // See ViewPreparePool::Priority
+        void start(int priority = ViewPreparePool::Visible);
+        void setPriority(int priority);
+
+        // No signal is emitted after stop
+        void stop();
+
+   Q_SIGNALS:
+        /**
+         * @brief Signals when all parts prepared
+         */
+        void done();
+
+        /**
+         * @brief Signals when json part (one or more consecutive documents) is ready
+         */
+        void partReady(const QString &part);
+
+    private Q_SLOTS:
+        // Emits chunks completed so far, strictly in order
+        void emitReadyChunks();
+
+    private:
+        class Work;
+
+        std::shared_ptr<Work> _work;
+        size_t _nextChunk;
+        bool _isStopped;
+    };
+}
@@ -1,17 +1,34 @@
 #include "robomongo/gui/widgets/workarea/OutputItemContentWidget.h"
 
 #include <QVBoxLayout>
-#include <Qsci/qscilexerjavascript.h>
+#include <QHBoxLayout>
+#include <QLineEdit>
+#include <QLabel>
+#include <QTimer>
 
 #include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/EventTrace.h"
+#include "robomongo/core/events/MongoEvents.h"
 #include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/core/domain/MongoShell.h"
 #include "robomongo/core/domain/MongoAggregateInfo.h"
+#include "robomongo/core/domain/BsonDumpFile.h"
+#include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/domain/BsonSegmentFile.h"
+#include "robomongo/core/domain/SharedDocuments.h"
+#include "robomongo/core/domain/PagePatch.h"
+#include "robomongo/core/domain/DocumentFilter.h"
+#include "robomongo/core/domain/PipelinePreview.h"
+#include "robomongo/shell/bson/json.h"
 
+#include "robomongo/gui/dialogs/ExportDialog.h"
 #include "robomongo/gui/widgets/workarea/OutputWidget.h"
 #include "robomongo/gui/widgets/workarea/OutputItemHeaderWidget.h"
-#include "robomongo/gui/widgets/workarea/JsonPrepareThread.h"
+#include "robomongo/gui/widgets/workarea/JsonPrepareJob.h"
+#include "robomongo/gui/widgets/workarea/DocumentFilterThread.h"
+#include "robomongo/gui/widgets/workarea/ResultMemoryManager.h"
 #include "robomongo/gui/widgets/workarea/BsonTreeView.h"
 #include "robomongo/gui/widgets/workarea/BsonTreeModel.h"
 #include "robomongo/gui/widgets/workarea/BsonTableView.h"
@@ -19,9 +36,39 @@
 #include "robomongo/gui/editors/PlainJavaScriptEditor.h"
 #include "robomongo/gui/widgets/workarea/CollectionStatsTreeWidget.h"
 #include "robomongo/gui/GuiRegistry.h"
-#include "robomongo/gui/editors/JSLexer.h"
+#include "robomongo/gui/editors/JsonLexer.h"
 #include "robomongo/gui/editors/FindFrame.h"
 
+namespace
+{
+    // Results smaller than this are cheaper to keep in memory than in separate file
+    long long const MinStoredBytes = 1024 * 1024;
+
+    int const MaxCachedPages = 16;
+
+    // Next page is not read ahead after pages bigger than this
+    long long const MaxPrefetchBytes = 4 * 1024 * 1024;
+
+    // Text views bigger than this are not lexed, styling of the whole text (and brace
+    // matching over it) costs more than it helps
+    long long const LargeTextBytes = 16 * 1024 * 1024;
+
+    // Parts of JSON text are appended once per frame, not once per part
+    int const TextFlushIntervalMs = 16;
+
+    // Views of other modes are built in advance for results up to this size, one view
+    // per this delay after the last change of part
+    long long const MaxPrebuildBytes = 8 * 1024 * 1024;
+    int const PrebuildDelayMs = 300;
+
+    // Keys are not reused, so cursor of deleted part is never continued by a new one
+    unsigned long long nextCursorKey()
+    {
+        static unsigned long long lastKey = 0;
+        return ++lastKey;
+    }
+}
+
 namespace Robomongo
 {
     OutputItemContentWidget::OutputItemContentWidget(ViewMode viewMode, MongoShell *shell, 
@@ -31,7 +78,7 @@ namespace Robomongo
         BaseClass(parent),
         _textView(NULL),
         _bsonTreeview(NULL),
-        _thread(NULL),
+        _jsonJob(NULL),
         _bsonTable(NULL),
         _isTextModeSupported(true),
         _isTreeModeSupported(false),
@@ -49,7 +96,8 @@ namespace Robomongo
         _initialLimit(0),
         _mod(NULL),
         _viewMode(viewMode),
-        _aggrInfo(aggrInfo)
+        _aggrInfo(aggrInfo),
+        _cursorKey(nextCursorKey())
     {
         setup(secs, multipleResults, tabbedResults, firstItem, lastItem);
     }
@@ -64,7 +112,7 @@ namespace Robomongo
         BaseClass(parent),
         _textView(NULL),
         _bsonTreeview(NULL),
-        _thread(NULL),
+        _jsonJob(NULL),
         _bsonTable(NULL),
         _isTextModeSupported(true),
         _isTreeModeSupported(true),
@@ -84,7 +132,8 @@ namespace Robomongo
         _outputWidget(dynamic_cast<OutputWidget*>(parentWidget())),
         _mod(NULL),
         _viewMode(viewMode),
-        _aggrInfo(aggrInfo)
+        _aggrInfo(aggrInfo),
+        _cursorKey(nextCursorKey())
     {
         setup(secs, multipleResults, tabbedResults, firstItem, lastItem);
     }
@@ -110,12 +159,59 @@ namespace Robomongo
             _header->paging()->setSkip(_aggrInfo.skip);
         }
 
+        _secs = secs;
         _header->setTime(QString("%1 sec.").arg(secs, 0, 'g', 3));
+        _retainedBytes = _spilledBytes = 0;
+        _documents = storeDocuments(_documents);
+        addRetainedBytes(_documents);
+
+        // First page of query is cached too, so that paging back to it is instant
+        _pageCache.setMaxCost(MaxCachedPages);
+        if (_queryInfo._info.isValid()) {
+            AppRegistry::instance().bus()->subscribe(this, DocumentsChangedEvent::Type);
+            _pageSkip = _initialSkip;
+            _pageBatchSize = _queryInfo._batchSize;
+            _pageKey = pageKey(pageInfo(_pageSkip, _pageBatchSize));
+            cacheCurrentPage();
+        }
+        else if (_aggrInfo.isValid) {
+            _pageSkip = _aggrInfo.skip;
+            _pageBatchSize = _aggrInfo.batchSize;
+            _pageKey = pageKey(_pageSkip, _pageBatchSize);
+            cacheCurrentPage();
+        }
+
+        _textFlushTimer = new QTimer(this);
+        _textFlushTimer->setSingleShot(true);
+        _textFlushTimer->setInterval(TextFlushIntervalMs);
+        VERIFY(connect(_textFlushTimer, SIGNAL(timeout()), this, SLOT(flushText())));
+
+        _prebuildTimer = new QTimer(this);
+        _prebuildTimer->setSingleShot(true);
+        _prebuildTimer->setInterval(PrebuildDelayMs);
+        VERIFY(connect(_prebuildTimer, SIGNAL(timeout()), this, SLOT(prebuildViews())));
 
         QVBoxLayout *layout = new QVBoxLayout();
         layout->setContentsMargins(0, 0, 0, 0);
         layout->setSpacing(0);
         layout->addWidget(_header);
+
+        // Filter bar is shown for documents only
+        _filterLine = new QLineEdit;
+        _filterLine->setPlaceholderText("Filter shown documents, i.e. { status: \"failed\" }");
+        _filterLine->setClearButtonEnabled(true);
+        _filterStatus = new QLabel;
+        QHBoxLayout *filterLayout = new QHBoxLayout;
+        filterLayout->setContentsMargins(2, 2, 2, 2);
+        filterLayout->addWidget(_filterLine, 1);
+        filterLayout->addWidget(_filterStatus);
+        _filterBar = new QWidget;
+        _filterBar->setLayout(filterLayout);
+        _filterBar->setVisible(_isTreeModeSupported);
+        layout->addWidget(_filterBar);
+        VERIFY(connect(_filterLine, SIGNAL(returnPressed()), this, SLOT(applyFilter())));
+        VERIFY(connect(_filterLine, SIGNAL(textChanged(const QString&)), this, SLOT(filterTextChanged(const QString&))));
+
         _stack = new QStackedWidget;
         layout->addWidget(_stack);
         setLayout(layout);
@@ -128,6 +224,89 @@ namespace Robomongo
         VERIFY(connect(_header, SIGNAL(restoredSize()), this, SIGNAL(restoredSize())));
 
         refreshOutputItem();
+        ResultMemoryManager::instance().add(this);
+    }
+
+    OutputItemContentWidget::~OutputItemContentWidget()
+    {
+        ResultMemoryManager::instance().remove(this);
+    }
+
+    long long OutputItemContentWidget::footprintBytes() const
+    {
+        long long bytes = _retainedBytes + cachedPagesBytes() + _text.size() * sizeof(QChar);
+        if (_mod)
+            bytes += _mod->memoryBytes();
+
+        // Scintilla keeps style byte next to every byte of text
+        if (_textView)
+            bytes += 2 * (_text.isEmpty() ? _renderedTextBytes : _text.size()) + _pendingText.size();
+
+        return bytes;
+    }
+
+    bool OutputItemContentWidget::releaseViews()
+    {
+        // Custom views are small and are not created twice
+        if (isVisible() || _areViewsReleased || _isCustomModeSupported ||
+            (!_textView && !_bsonTreeview && !_bsonTable))
+            return false;
+
+        resetViews();
+        _areViewsReleased = true;
+        return true;
+    }
+
+    bool OutputItemContentWidget::releaseDocuments()
+    {
+        if (isVisible() || _areDocumentsReleased || _isLoading || !_queryInfo._info.isValid() ||
+            _aggrInfo.isValid || (_documents.empty() && _pageCache.isEmpty()))
+            return false;
+
+        // Filter stays active, it is applied to documents read again (see update())
+        bool const filtered = isFilterActive();
+        stopFilter();
+        _filteredDocuments.clear();
+        _isFiltered = filtered;
+
+        _documents.clear();
+        clearPageCache();
+        resetViews();
+        _store.reset();
+        _retainedBytes = _spilledBytes = 0;
+        _header->setRetainedBytes(0, 0);
+
+        _areViewsReleased = true;
+        _areDocumentsReleased = true;
+        return true;
+    }
+
+    void OutputItemContentWidget::showEvent(QShowEvent *event)
+    {
+        BaseClass::showEvent(event);
+        ResultMemoryManager::instance().touch(this);
+
+        if (_jsonJob)
+            _jsonJob->setPriority(jsonJobPriority());
+
+        if (_areViewsReleased) {
+            _areViewsReleased = false;
+            refreshOutputItem();
+        }
+
+        if (_areDocumentsReleased) {
+            _areDocumentsReleased = false;
+            refresh(_pageSkip, _pageBatchSize);
+        }
+    }
+
+    void OutputItemContentWidget::hideEvent(QHideEvent *event)
+    {
+        BaseClass::hideEvent(event);
+
+        // Threads are given to parts on screen, this one continues once shown again
+        if (_jsonJob)
+            _jsonJob->setPriority(ViewPreparePool::Suspended);
     }
 
     void OutputItemContentWidget::paging_leftClicked(int skip, int limit)
@@ -137,7 +316,91 @@ namespace Robomongo
         if (s < 0)
             s = 0;
 
-        refresh(s, limit);
+        loadPage(s, limit);
+    }
+
+    void OutputItemContentWidget::setExplainInfo(const ExplainInfo &explain, qint64 elapsedMs)
+    {
+        _header->setExplain(explain, elapsedMs);
+    }
+
+    void OutputItemContentWidget::setJsHeapBytes(long long bytes)
+    {
+        _header->setJsHeapBytes(bytes);
+    }
+
+    void OutputItemContentWidget::setCaption(const QString &caption, const QString &toolTip)
+    {
+        _header->setCaption(caption, toolTip);
+    }
+
+    void OutputItemContentWidget::previewPipeline()
+    {
+        if (!_aggrInfo.isValid)
+            return;
+
+        _outputWidget->showProgress();
+        _shell->previewPipeline(_aggrInfo, PipelinePreview::DefaultSampleSize);
+    }
+
+    void OutputItemContentWidget::diffWithPart()
+    {
+        _outputWidget->diffPart(this);
+    }
+
+    void OutputItemContentWidget::saveResultSet()
+    {
+        if (!_shell || !_queryInfo._info.isValid())
+            return;
+
+        // The whole result, not the shown page
+        MongoQueryInfo info(_queryInfo);
+        info._skip = _initialSkip;
+        info._limit = _initialLimit;
+
+        MongoNamespace const &ns = _queryInfo._info._ns;
+        ExportDialog dialog(_shell->server(), QtUtils::toQString(ns.databaseName()),
+                            QtUtils::toQString(ns.collectionName()), this);
+        dialog.setResultSet(info);
+        dialog.exec();
+    }
+
+    void OutputItemContentWidget::groupByField(const QString &field, int sampleSize)
+    {
+        if (!_shell || !_queryInfo._info.isValid())
+            return;
+
+        _outputWidget->showProgress();
+        _shell->groupByField(_queryInfo, QtUtils::toStdString(field), sampleSize);
+    }
+
+    void OutputItemContentWidget::setTotalCount(const MongoQueryInfo &queryInfo, long long count, 
+                                                bool estimated)
+    {
+        if (!_queryInfo._info.isValid() || 
+            _queryInfo._info._ns.toString() != queryInfo._info._ns.toString() ||
+            !_queryInfo._query.binaryEqual(queryInfo._query))
+            return;
+
+        _header->paging()->setTotalCount(count, estimated);
+    }
+
+    void OutputItemContentWidget::setDumpFile(const BsonDumpFilePtr &file, const std::string &ns, int batchSize)
+    {
+        _dumpFile = file;
+        _dumpNamespace = ns;
+        _pageSkip = 0;
+        _pageBatchSize = batchSize;
+        _header->setCollection(QtUtils::toQString(ns));
+        _header->paging()->setBatchSize(batchSize);
+        _header->paging()->setSkip(0);
+        updateDumpCount();
+    }
+
+    void OutputItemContentWidget::updateDumpCount()
+    {
+        if (_dumpFile)
+            _header->paging()->setTotalCount(_dumpFile->count(_dumpNamespace), !_dumpFile->isIndexed());
     }
 
     void OutputItemContentWidget::refreshOutputItem()
@@ -149,22 +412,60 @@ namespace Robomongo
             case Custom: showCustom(); break;
             default: showTree();
         }
+        _prebuildTimer->start();
+    }
+
+    void OutputItemContentWidget::prebuildViews()
+    {
+        if (!isVisible() || _isLoading || _retainedBytes + _spilledBytes > MaxPrebuildBytes)
+            return;
+
+        // Tree and table share model, text is prepared in background
+        ViewMode const modes[] = { Tree, Table, Text };
+        for (ViewMode const mode : modes) {
+            if (mode == _viewMode)
+                continue;
+
+            bool built = false;
+            switch (mode) {
+                case Text: built = prepareTextView(); break;
+                case Tree: built = prepareTreeView(); break;
+                case Table: built = prepareTableView(); break;
+                default: break;
+            }
+
+            // The next one on the next run, so that input is not blocked meanwhile
+            if (built) {
+                _prebuildTimer->start();
+                return;
+            }
+        }
     }
 
     void OutputItemContentWidget::paging_rightClicked(int skip, int limit)
     {
         skip += limit;
-        refresh(skip, limit);
+        loadPage(skip, limit);
     }
 
-    void OutputItemContentWidget::refresh(int skip, int batchSize)
+    void OutputItemContentWidget::loadPage(int skip, int batchSize)
     {
-        // Cannot set skip lower than in the text query
-        if (skip <  _initialSkip) {
-            _header->paging()->setSkip(_initialSkip);
-            skip = _initialSkip;
+        if (skip >= _initialSkip) {
+            QString const key = pageKey(skip, batchSize);
+            if (Page const *page = _pageCache.object(key)) {
+                update(*page, skip, batchSize);
+                _pageKey = key;
+                refreshOutputItem();
+                prefetchNextPage();
+                return;
+            }
         }
 
+        requestPage(skip, batchSize, false);
+    }
+
+    MongoQueryInfo OutputItemContentWidget::pageInfo(int skip, int batchSize) const
+    {
         int skipDelta = skip - _initialSkip;
         int limit = batchSize;
 
@@ -183,57 +484,258 @@ namespace Robomongo
         info._limit = limit;
         info._skip = skip;
         info._batchSize = batchSize;
+        return info;
+    }
+
+    QString OutputItemContentWidget::pageKey(const MongoQueryInfo &info)
+    {
+        return QString("%1|%2|%3|%4|%5|%6|%7")
+            .arg(QtUtils::toQString(info._info._ns.toString()))
+            .arg(QtUtils::toQString(info._query.toString()))
+            .arg(QtUtils::toQString(info._fields.toString()))
+            .arg(info._skip).arg(info._limit).arg(info._batchSize).arg(info._options);
+    }
+
+    QString OutputItemContentWidget::pageKey(int skip, int batchSize) const
+    {
+        // Pipeline of part does not change, its pages differ by skip and batch size only
+        if (_aggrInfo.isValid)
+            return QString("aggregate|%1|%2").arg(skip).arg(batchSize);
+
+        return pageKey(pageInfo(skip, batchSize));
+    }
+
+    void OutputItemContentWidget::cacheCurrentPage()
+    {
+        if (!_pageKey.isEmpty())
+            cachePage(_pageKey, _documents);
+    }
+
+    void OutputItemContentWidget::cachePage(const QString &key, const std::vector<MongoDocumentPtr> &documents)
+    {
+        _pageCache.insert(key, new Page(documents));
+
+        // Forget sizes of pages evicted by cache
+        for (auto it = _pageBytes.begin(); it != _pageBytes.end(); ) {
+            if (_pageCache.contains(it.key()))
+                ++it;
+            else
+                it = _pageBytes.erase(it);
+        }
+        if (_pageCache.contains(key))
+            _pageBytes.insert(key, MongoDocument::bsonSize(documents, false));
+
+        ResultMemoryManager::instance().changed();
+    }
+
+    void OutputItemContentWidget::clearPageCache()
+    {
+        _pageCache.clear();
+        _pageBytes.clear();
+        _prefetchKey.clear();
+    }
+
+    long long OutputItemContentWidget::cachedPagesBytes() const
+    {
+        // Current page shares documents with _documents
+        long long bytes = 0;
+        for (auto it = _pageBytes.constBegin(); it != _pageBytes.constEnd(); ++it) {
+            if (it.key() != _pageKey && _pageCache.contains(it.key()))
+                bytes += it.value();
+        }
+        return bytes;
+    }
+
+    void OutputItemContentWidget::prefetchNextPage()
+    {
+        if (!AppRegistry::instance().settingsManager()->prefetchPages())
+            return;
+
+        // Short page is the last one. Documents are not counted, when page is bigger than budget.
+        if (!_queryInfo._info.isValid() || _aggrInfo.isValid || _pageKey.isEmpty() ||
+            _pageBatchSize <= 0 || _documents.size() < static_cast<size_t>(_pageBatchSize) ||
+            MongoDocument::bsonSize(_documents) > MaxPrefetchBytes)
+            return;
+
+        MongoQueryInfo const next = pageInfo(_pageSkip + _pageBatchSize, _pageBatchSize);
+        QString const key = pageKey(next);
+        if (next._limit == -1 || key == _prefetchKey || _pageCache.contains(key))
+            return;
+
+        _prefetchKey = key;
+        _shell->prefetch(_outputWidget->resultIndex(this), next, _cursorKey);
+    }
+
+    void OutputItemContentWidget::cachePrefetchedPage(const MongoQueryInfo &queryInfo,
+                                                      const std::vector<MongoDocumentPtr> &documents)
+    {
+        QString const key = pageKey(queryInfo);
+        if (key != _prefetchKey)
+            return;
+
+        _prefetchKey.clear();
+        if (MongoDocument::bsonSize(documents) <= MaxPrefetchBytes)
+            cachePage(key, documents);
+    }
+
+    void OutputItemContentWidget::handle(DocumentsChangedEvent *event)
+    {
+        CollectionInfo const& info = event->info();
+        if (info._serverAddress == _queryInfo._info._serverAddress &&
+            info._ns.toString() == _queryInfo._info._ns.toString()) {
+            clearPageCache();
+            ResultMemoryManager::instance().changed();
+        }
+    }
+
+    void OutputItemContentWidget::refresh(int skip, int batchSize)
+    {
+        if (_aggrInfo.isValid)
+            clearPageCache();
+
+        // The same page is patched, pages at other skip are shown anew
+        _isPatchPending = !_dumpFile && skip == _pageSkip && batchSize == _pageBatchSize;
+        _refreshedDocuments.clear();
+        requestPage(skip, batchSize, true);
+    }
+
+    void OutputItemContentWidget::requestPage(int skip, int batchSize, bool reread)
+    {
+        // Other page replaces refreshed one, which may have failed to be read
+        if (!reread)
+            _isPatchPending = false;
+
+        // Cannot set skip lower than in the text query
+        if (skip <  _initialSkip) {
+            _header->paging()->setSkip(_initialSkip);
+            skip = _initialSkip;
+        }
+
+        // Page of dump is copied from its mapping, without round trip
+        if (_dumpFile) {
+            update(_dumpFile->documents(_dumpNamespace, skip, batchSize), skip, batchSize);
+            refreshOutputItem();
+            return;
+        }
+
         _outputWidget->showProgress();
-                
-        _shell->setScriptExecutable(true);
+        _isLoading = true;
+
         if (_aggrInfo.isValid) {
-            // Build original pipeline object, and append extra skip and limit for paging
-            std::string pipelineModified = "[";
-            for (int i = 0; ; i++) {
-                auto const obj = mongo::tojson(_aggrInfo.pipeline.getObjectField(std::to_string(i)));
-                if (obj.empty() || "{}" == obj)
-                    break;
-
-                pipelineModified.append(obj + ",");
-            }
-            pipelineModified.append("{$skip:" + std::to_string(skip) + "}, " +
-                                    "{$limit:" + std::to_string(batchSize) + "}" + 
-                                    "]");
-
-            std::string const query = "db.getCollection('" + _aggrInfo.collectionName + "').aggregate(" +
-                                      pipelineModified + ", " + _aggrInfo.options.toString() + ")";
-            
-            // Create aggr. info with new skip and batchsize
-            AggrInfo const aggrInfo { _aggrInfo.collectionName, skip, batchSize, _aggrInfo.pipeline, 
-                                      _aggrInfo.options, _outputWidget->resultIndex(this) };
-            _shell->setAggrInfo(aggrInfo);
-            _shell->execute(query);
+            AggrInfo page = _aggrInfo;
+            page.skip = skip;
+            page.batchSize = batchSize;
+            page.resultIndex = _outputWidget->resultIndex(this);
+            _shell->aggregatePage(page.resultIndex, page, _cursorKey, reread);
         }
         else
-            _shell->query(_outputWidget->resultIndex(this), info);
+            _shell->query(_outputWidget->resultIndex(this), pageInfo(skip, batchSize), _cursorKey);
     }
 
     void OutputItemContentWidget::updateWithInfo(const MongoQueryInfo &inf, 
-                                                 const std::vector<MongoDocumentPtr> &documents)
+                                                 const std::vector<MongoDocumentPtr> &documents,
+                                                 bool lastBatch)
     {
+        if (_isPatchPending) {
+            _refreshedDocuments = documents;
+            _pageKey = pageKey(inf);
+            if (lastBatch) {
+                _isLoading = false;
+                applyRefreshedPage();
+                prefetchNextPage();
+            }
+            return;
+        }
+
         update(documents, inf._skip, inf._batchSize);
+        _pageKey = pageKey(inf);
+        if (lastBatch) {
+            _isLoading = false;
+            cacheCurrentPage();
+            prefetchNextPage();
+        }
     }
 
     void OutputItemContentWidget::updateWithInfo(const AggrInfo &aggrInfo, 
                                                  const std::vector<MongoDocumentPtr> &documents)
     {
+        if (_isPatchPending) {
+            _refreshedDocuments = documents;
+            _pageKey = pageKey(aggrInfo.skip, aggrInfo.batchSize);
+            _isLoading = false;
+            applyRefreshedPage();
+            return;
+        }
+
         update(documents, aggrInfo.skip, aggrInfo.batchSize);
+        _pageKey = pageKey(aggrInfo.skip, aggrInfo.batchSize);
+        _isLoading = false;
+        cacheCurrentPage();
     }
 
     void OutputItemContentWidget::update(const std::vector<MongoDocumentPtr> &documents, int skip, int batchSize)
     {
-        _documents = documents;
+        _isPatchPending = false;
+        _refreshedDocuments.clear();
+
+        // Documents of previous page keep their file alive while they are still in use
+        _store.reset();
+        _retainedBytes = _spilledBytes = 0;
+        _documents = storeDocuments(documents);
+        addRetainedBytes(_documents);
 
         _header->paging()->setSkip(skip);
         _header->paging()->setBatchSize(batchSize);
+        _pageSkip = skip;
+        _pageBatchSize = batchSize;
+
+        // New page is filtered again, it is shown unfiltered meanwhile
+        bool const refilter = isFilterActive();
+        stopFilter();
+        _isFiltered = false;
+        _filteredDocuments.clear();
 
         _text.clear();
-        _isFirstPartRendered = false;
+        resetViews();
+        EventTrace::markCurrent("model built");
+
+        if (refilter)
+            applyFilter();
+    }
+
+    WorkspaceSnapshot::Part OutputItemContentWidget::snapshot(const QString &resultFile) const
+    {
+        WorkspaceSnapshot::Part part;
+        part.elapsedMs = static_cast<long long>(_secs * 1000);
+        part.aggrInfo = _aggrInfo;
+        if (!_isTreeModeSupported) {
+            part.response = QtUtils::toStdString(_text);
+            return part;
+        }
+
+        part.type = QtUtils::toStdString(_type);
+        part.queryInfo = _queryInfo;
+        part.queryInfo._limit = _initialLimit;     // setup() defaults limit of the shown query
+        part.pageSkip = _pageSkip;
+        part.pageBatchSize = _pageBatchSize;
+        if (!resultFile.isEmpty() && !_areDocumentsReleased &&
+            WorkspaceSnapshot::writeResults(resultFile, _documents))
+            part.resultFile = resultFile;
+        return part;
+    }
+
+    void OutputItemContentWidget::restorePage(int skip, int batchSize)
+    {
+        // First page was cached by setup() under key of the initial page
+        clearPageCache();
+        update(_documents, skip, batchSize);
+        _pageKey = pageKey(skip, batchSize);
+        cacheCurrentPage();
+    }
+
+    void OutputItemContentWidget::resetViews()
+    {
+        resetTextView();
         markUninitialized();
 
         if (_bsonTable) {
@@ -247,13 +749,187 @@ namespace Robomongo
             delete _bsonTreeview;
             _bsonTreeview = NULL;
         }
+        configureModel();
+    }
+
+    void OutputItemContentWidget::resetTextView()
+    {
+        stopJsonPrepareJob();
+        _pendingTextDocuments.clear();
+        _pendingText.clear();
+        _textFlushTimer->stop();
+        _renderedTextBytes = 0;
+        _isLargeText = false;
+        _isFirstPartRendered = false;
+        _isTextModeInitialized = false;
 
         if (_textView) {
             _stack->removeWidget(_textView);
             delete _textView;
             _textView = NULL;
         }
-        configureModel();
+    }
+
+    void OutputItemContentWidget::applyRefreshedPage()
+    {
+        std::vector<MongoDocumentPtr> documents;
+        documents.swap(_refreshedDocuments);
+        _isPatchPending = false;
+
+        // Filtered, sorted or edited rows are not rows of page
+        BsonTableModelProxy const *proxy =
+            _bsonTable ? qobject_cast<BsonTableModelProxy *>(_bsonTable->model()) : nullptr;
+        if (!_mod || isFilterActive() || (proxy && !proxy->isPatchable())) {
+            update(documents, _pageSkip, _pageBatchSize);
+            cacheCurrentPage();
+            refreshOutputItem();
+            return;
+        }
+
+        PagePatch const patch = PagePatch::compute(_mod->documents(), documents);
+        if (!patch.isEmpty()) {
+            // Only inserted and changed documents are kept, they are stored as any other batch
+            std::vector<MongoDocumentPtr> fresh;
+            for (int const row : patch.inserted)
+                fresh.push_back(documents[row]);
+            for (int const row : patch.updated)
+                fresh.push_back(documents[row]);
+            fresh = storeDocuments(fresh);
+
+            size_t next = 0;
+            for (int const row : patch.inserted)
+                documents[row] = fresh[next++];
+            for (int const row : patch.updated)
+                documents[row] = fresh[next++];
+
+            _mod->applyPatch(patch, documents);
+            EventTrace::markCurrent("model patched");
+
+            // Text is prepared again, when it is shown
+            resetTextView();
+            _text.clear();
+        }
+
+        _documents = _mod->documents();
+        _retainedBytes = _spilledBytes = 0;
+        addRetainedBytes(_documents);
+        cacheCurrentPage();
+        refreshOutputItem();
+    }
+
+    void OutputItemContentWidget::appendDocuments(const std::vector<MongoDocumentPtr> &newDocuments,
+                                                  bool lastBatch)
+    {
+        if (lastBatch)
+            _isLoading = false;
+
+        if (_isPatchPending) {
+            _refreshedDocuments.insert(_refreshedDocuments.end(), newDocuments.begin(), newDocuments.end());
+            if (lastBatch) {
+                applyRefreshedPage();
+                prefetchNextPage();
+            }
+            return;
+        }
+
+        if (newDocuments.empty()) {
+            if (lastBatch) {
+                cacheCurrentPage();
+                prefetchNextPage();
+            }
+            return;
+        }
+
+        std::vector<MongoDocumentPtr> const documents = storeDocuments(newDocuments);
+        int const firstPosition = _documents.size() + 1;
+        _documents.insert(_documents.end(), documents.begin(), documents.end());
+        addRetainedBytes(documents);
+
+        // Filtered views are rebuilt once appended documents are filtered too
+        if (isFilterActive()) {
+            applyFilter();
+            if (lastBatch) {
+                cacheCurrentPage();
+                prefetchNextPage();
+            }
+            return;
+        }
+
+        // Tree view and table proxy are updated through model's rowsInserted signal
+        _mod->appendDocuments(documents);
+        EventTrace::markCurrent("model appended");
+
+        if (_isTextModeInitialized && _text.isEmpty()) {
+            if (_jsonJob)   // keep order of parts: wait until current job is done
+                _pendingTextDocuments.insert(_pendingTextDocuments.end(), documents.begin(), documents.end());
+            else
+                startJsonPrepareJob(documents, firstPosition);
+        }
+
+    }
+
+    std::vector<MongoDocumentPtr> OutputItemContentWidget::storeDocuments(
+        const std::vector<MongoDocumentPtr> &documents)
+    {
+        // The same documents held by another result (i.e. duplicated tab) are not kept twice
+        std::vector<MongoDocumentPtr> shared;
+        if (SharedDocuments::instance().find(documents, shared))
+            return shared;
+
+        if (!_store) {
+            if (_retainedBytes + MongoDocument::bsonSize(documents, false) < MinStoredBytes) {
+                SharedDocuments::instance().add(documents);
+                return documents;
+            }
+
+            _store.reset(new BsonSegmentFile);
+        }
+
+        std::vector<MongoDocumentPtr> const stored = MongoDocument::moveToStorage(documents, _store);
+        SharedDocuments::instance().add(stored);
+        return stored;
+    }
+
+    void OutputItemContentWidget::addRetainedBytes(const std::vector<MongoDocumentPtr> &documents)
+    {
+        long long const inMemory = MongoDocument::bsonSize(documents, false);
+        _retainedBytes += inMemory;
+        _spilledBytes += MongoDocument::bsonSize(documents) - inMemory;
+        _header->setRetainedBytes(_retainedBytes, _spilledBytes);
+        ResultMemoryManager::instance().changed();
+    }
+
+    void OutputItemContentWidget::startJsonPrepareJob(const std::vector<MongoDocumentPtr> &documents, 
+                                                      int firstPosition)
+    {
+        _jsonJob = new JsonPrepareJob(documents, AppRegistry::instance().settingsManager()->uuidEncoding(), 
+                                      AppRegistry::instance().settingsManager()->timeZone(),
+                                      AppRegistry::instance().settingsManager()->jsonOutputMode(), firstPosition, this);
+        VERIFY(connect(_jsonJob, SIGNAL(partReady(const QString&)), this, SLOT(jsonPartReady(const QString&))));
+        VERIFY(connect(_jsonJob, SIGNAL(done()), this, SLOT(jsonPrepared())));
+
+        _jsonJob->start(jsonJobPriority());
+    }
+
+    int OutputItemContentWidget::jsonJobPriority() const
+    {
+        // Parts on screen are prepared first, text prebuilt behind other view after them.
+        // Work of hidden parts waits until they are shown.
+        if (!isVisible())
+            return ViewPreparePool::Suspended;
+
+        return _viewMode == Text ? ViewPreparePool::Visible : ViewPreparePool::Background;
+    }
+
+    void OutputItemContentWidget::stopJsonPrepareJob()
+    {
+        if (!_jsonJob)
+            return;
+
+        // Chunks not started yet are dropped from pool
+        _jsonJob->stop();
+        _jsonJob->deleteLater();
+        _jsonJob = NULL;
     }
 
     void OutputItemContentWidget::showText()
@@ -263,26 +939,33 @@ namespace Robomongo
         if (!_isTextModeSupported)
             return;
 
-        if (!_isTextModeInitialized)
-        {
-            _textView = configureLogText();
-            if (!_text.isEmpty()) {
-                _textView->sciScintilla()->setText(_text);
-            }
-            else {
-                if (_documents.size() > 0) {
-                    _textView->sciScintilla()->setText("Loading...");
-                    _thread = new JsonPrepareThread(_documents, AppRegistry::instance().settingsManager()->uuidEncoding(), AppRegistry::instance().settingsManager()->timeZone());
-                    VERIFY(connect(_thread, SIGNAL(partReady(const QString&)), this, SLOT(jsonPartReady(const QString&))));
-                    VERIFY(connect(_thread, SIGNAL(finished()), _thread, SLOT(deleteLater())));
-                    _thread->start();
-                }
+        prepareTextView();
+        _stack->setCurrentWidget(_textView);
+        if (_jsonJob)
+            _jsonJob->setPriority(jsonJobPriority());
+    }
+
+    bool OutputItemContentWidget::prepareTextView()
+    {
+        if (!_isTextModeSupported || _isTextModeInitialized)
+            return false;
+
+        _textView = configureLogText();
+        if (!_text.isEmpty()) {
+            if (_text.size() > LargeTextBytes)
+                enableLargeTextMode();
+            _textView->sciScintilla()->setText(_text);
+        }
+        else {
+            if (shownDocuments().size() > 0) {
+                _textView->sciScintilla()->setText("Loading...");
+                _pendingTextDocuments.clear();
+                startJsonPrepareJob(shownDocuments(), 1);
             }
-            _stack->addWidget(_textView);
-            _isTextModeInitialized = true;
         }
-
-        _stack->setCurrentWidget(_textView);
+        _stack->addWidget(_textView);
+        _isTextModeInitialized = true;
+        return true;
     }
 
     void OutputItemContentWidget::showTree()
@@ -296,20 +979,26 @@ namespace Robomongo
             return;
         }
 
-        if (!_isTreeModeInitialized) {
-            _bsonTreeview = new BsonTreeView(_shell, _queryInfo, this);
-            _bsonTreeview->setModel(_mod);
-            _stack->addWidget(_bsonTreeview);
+        prepareTreeView();
+        _stack->setCurrentWidget(_bsonTreeview);
+    }
+
+    bool OutputItemContentWidget::prepareTreeView()
+    {
+        if (!_isTreeModeSupported || _isTreeModeInitialized)
+            return false;
 
-            if (true == AppRegistry::instance().settingsManager()->autoExpand())
-                // Expanding only one level, because on large
-                // documents it can take much time
-                _bsonTreeview->expand(_mod->index(0, 0, QModelIndex()));
+        _bsonTreeview = new BsonTreeView(_shell, _queryInfo, this);
+        _bsonTreeview->setModel(_mod);
+        _stack->addWidget(_bsonTreeview);
 
-            _isTreeModeInitialized = true;
-        }
+        if (true == AppRegistry::instance().settingsManager()->autoExpand())
+            // Expanding only one level, because on large
+            // documents it can take much time
+            _bsonTreeview->expand(_mod->index(0, 0, QModelIndex()));
 
-        _stack->setCurrentWidget(_bsonTreeview);
+        _isTreeModeInitialized = true;
+        return true;
     }
 
     void OutputItemContentWidget::showCustom()
@@ -348,18 +1037,26 @@ namespace Robomongo
             return;
         }
 
-        if (!_isTableModeInitialized) {
-            _bsonTable = new BsonTableView(_shell, _queryInfo);
-            BsonTableModelProxy *modp = new BsonTableModelProxy(_bsonTable);
-            modp->setSourceModel(_mod);
-            _bsonTable->setModel(modp);
-            _stack->addWidget(_bsonTable);
-            _isTableModeInitialized = true;
-        }
-
+        prepareTableView();
         _stack->setCurrentWidget(_bsonTable);
     }
 
+    bool OutputItemContentWidget::prepareTableView()
+    {
+        if (!_isTableModeSupported || _isTableModeInitialized)
+            return false;
+
+        _bsonTable = new BsonTableView(_shell, _queryInfo);
+        VERIFY(connect(_bsonTable, SIGNAL(groupByFieldRequested(const QString&, int)),
+                       this, SLOT(groupByField(const QString&, int))));
+        BsonTableModelProxy *modp = new BsonTableModelProxy(_bsonTable);
+        modp->setSourceModel(_mod);
+        _bsonTable->setModel(modp);
+        _stack->addWidget(_bsonTable);
+        _isTableModeInitialized = true;
+        return true;
+    }
+
     void OutputItemContentWidget::markUninitialized()
     {
         _isTextModeInitialized = false;
@@ -380,31 +1077,137 @@ namespace Robomongo
 
     void OutputItemContentWidget::jsonPartReady(const QString &json)
     {
-        // check that this is our current thread
-        JsonPrepareThread *thread = qobject_cast<JsonPrepareThread *>(sender());
-        if (thread && thread != _thread)
-        {
-            // close previous thread
-            thread->stop();
-            thread->wait();
+        // Previous jobs are stopped, see stopJsonPrepareJob()
+        if (sender() != _jsonJob || !_textView)
+            return;
+
+        _pendingText += json.toUtf8();
+        if (!_textFlushTimer->isActive())
+            _textFlushTimer->start();
+    }
+
+    void OutputItemContentWidget::flushText()
+    {
+        if (!_textView || _pendingText.isEmpty())
+            return;
+
+        RoboScintilla *sci = _textView->sciScintilla();
+        _renderedTextBytes = (_isFirstPartRendered ? _renderedTextBytes : 0) + _pendingText.size();
+        if (!_isLargeText && _renderedTextBytes > LargeTextBytes)
+            enableLargeTextMode();
+
+        // View is read-only for user, text is appended directly, without conversion
+        // from QString and without re-layout of text already shown
+        sci->SendScintilla(QsciScintilla::SCI_SETREADONLY, 0ul);
+        if (!_isFirstPartRendered)
+            sci->SendScintilla(QsciScintilla::SCI_CLEARALL);    // "Loading..."
+        sci->SendScintilla(QsciScintilla::SCI_APPENDTEXT, static_cast<unsigned long>(_pendingText.size()),
+                           _pendingText.constData());
+        sci->SendScintilla(QsciScintilla::SCI_SETREADONLY, 1ul);
+
+        _pendingText.clear();
+        _isFirstPartRendered = true;
+        ResultMemoryManager::instance().changed();
+    }
+
+    void OutputItemContentWidget::enableLargeTextMode()
+    {
+        _isLargeText = true;
+
+        // Without lexer whole text has default style, nothing is styled while scrolling
+        RoboScintilla *sci = _textView->sciScintilla();
+        sci->setLexer(NULL);
+        sci->setFont(GuiRegistry::instance().font());
+        sci->setBraceMatching(QsciScintilla::NoBraceMatch);
+    }
+    
+    void OutputItemContentWidget::jsonPrepared()
+    {
+        if (sender() != _jsonJob)
+            return;
+
+        _jsonJob->deleteLater();
+        _jsonJob = NULL;
+        if (_pendingTextDocuments.empty())
+            return;
+
+        std::vector<MongoDocumentPtr> documents;
+        documents.swap(_pendingTextDocuments);
+        startJsonPrepareJob(documents, _documents.size() - documents.size() + 1);
+    }
+
+    void OutputItemContentWidget::applyFilter()
+    {
+        stopFilter();
+
+        QString const text = _filterLine->text().trimmed();
+        if (text.isEmpty()) {
+            filterTextChanged(text);
+            return;
         }
-        else
-        {
-            if (_textView)
-            {
-                if (_isFirstPartRendered)
-                    _textView->sciScintilla()->append(json);
-                else
-                    _textView->sciScintilla()->setText(json);
-                _isFirstPartRendered = true;
-            }
+
+        try {
+            DocumentFilter const filter(mongo::Robomongo::fromjson(QtUtils::toStdString(text)));
+            _filterThread = new DocumentFilterThread(_documents, filter);
+        } catch (const std::exception &ex) {
+            _filterStatus->setText(QString("Invalid filter: %1").arg(QtUtils::toQString(ex.what())));
+            return;
         }
+
+        _filterStatus->setText("Filtering...");
+        VERIFY(connect(_filterThread, SIGNAL(done()), this, SLOT(filterDone())));
+        VERIFY(connect(_filterThread, SIGNAL(finished()), _filterThread, SLOT(deleteLater())));
+        _filterThread->start();
     }
-    
+
+    void OutputItemContentWidget::filterTextChanged(const QString &text)
+    {
+        // Filter is applied with Enter, cleared filter shows all documents at once
+        if (!text.trimmed().isEmpty())
+            return;
+
+        stopFilter();
+        _filterStatus->clear();
+        if (!_isFiltered)
+            return;
+
+        _isFiltered = false;
+        _filteredDocuments.clear();
+        resetViews();
+        refreshOutputItem();
+    }
+
+    void OutputItemContentWidget::filterDone()
+    {
+        DocumentFilterThread *thread = qobject_cast<DocumentFilterThread *>(sender());
+        if (!thread || thread != _filterThread)
+            return;
+
+        _filterThread = NULL;
+        _filteredDocuments.clear();
+        for (size_t index : thread->selection())
+            _filteredDocuments.push_back(_documents[index]);
+        _isFiltered = true;
+
+        _filterStatus->setText(QString("%1 of %2 documents").arg(_filteredDocuments.size()).arg(_documents.size()));
+        resetViews();
+        refreshOutputItem();
+    }
+
+    void OutputItemContentWidget::stopFilter()
+    {
+        if (!_filterThread)
+            return;
+
+        // Thread deletes itself when finished, its selection is ignored
+        _filterThread->stop();
+        _filterThread = NULL;
+    }
+
     BsonTreeModel *OutputItemContentWidget::configureModel()
     {
         delete _mod;
-        _mod = new BsonTreeModel(_documents, this);
+        _mod = new BsonTreeModel(shownDocuments(), this);
         return _mod;
     }
 
@@ -412,15 +1215,18 @@ namespace Robomongo
     {
         const QFont &textFont = GuiRegistry::instance().font();
 
-        QsciLexerJavaScript *javaScriptLexer = new JSLexer(this);
-        javaScriptLexer->setFont(textFont);
+        // Output is JSON, it is styled by quick lexer as it is shown
+        JsonLexer *jsonLexer = new JsonLexer(this);
+        jsonLexer->setFont(textFont);
 
         FindFrame *_logText = new FindFrame(this);
-        _logText->sciScintilla()->setLexer(javaScriptLexer);
+        _logText->sciScintilla()->setLexer(jsonLexer);
         _logText->sciScintilla()->setTabWidth(4);        
         _logText->sciScintilla()->setAppropriateBraceMatching();
         _logText->sciScintilla()->setFont(textFont);
         _logText->sciScintilla()->setReadOnly(true);
+        // Text is never edited, undo history would only double memory of large results
+        _logText->sciScintilla()->SendScintilla(QsciScintilla::SCI_SETUNDOCOLLECTION, 0ul);
         _logText->sciScintilla()->setWrapMode((QsciScintilla::WrapMode) QsciScintilla::SC_WRAP_NONE);
         _logText->sciScintilla()->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
         _logText->sciScintilla()->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
@@ -1,10 +1,20 @@
 #pragma once
 
 #include <QStackedWidget>
+#include <QCache>
+#include <QHash>
+
+QT_BEGIN_NAMESPACE
+class QLineEdit;
+class QLabel;
+class QTimer;
+QT_END_NAMESPACE
 
 #include "robomongo/core/Core.h"
 #include "robomongo/core/domain/MongoQueryInfo.h"
 #include "robomongo/core/domain/MongoAggregateInfo.h"
+#include "robomongo/core/domain/MongoShellResult.h"
+#include "robomongo/core/domain/WorkspaceSnapshot.h"
 #include "robomongo/core/Enums.h"
 #include <vector>
 
@@ -14,11 +24,13 @@ namespace Robomongo
     class BsonTreeView;
     class BsonTableView;
     class BsonTreeModel;
-    class JsonPrepareThread;
+    class JsonPrepareJob;
+    class DocumentFilterThread;
     class CollectionStatsTreeWidget;
     class MongoShell;
     class OutputItemHeaderWidget;
     class OutputWidget;
+    class DocumentsChangedEvent;
 
     class OutputItemContentWidget : public QWidget
     {
@@ -35,11 +47,18 @@ namespace Robomongo
                                 const MongoQueryInfo &queryInfo, double secs, bool multipleResults,
                                 bool tabbedResults, bool firstItem, bool lastItem, AggrInfo aggrInfo,
                                 QWidget *parent);
+        ~OutputItemContentWidget();
         int _initialSkip;
         int _initialLimit;
-        void updateWithInfo(const MongoQueryInfo &inf, const std::vector<MongoDocumentPtr> &documents);
+        void updateWithInfo(const MongoQueryInfo &inf, const std::vector<MongoDocumentPtr> &documents,
+                            bool lastBatch = true);
         void updateWithInfo(const AggrInfo &aggrInfo, const std::vector<MongoDocumentPtr> &documents);
         void update(const std::vector<MongoDocumentPtr> &documents, int skip, int batchSize);
+
+        /**
+         * @brief Appends next batch of streamed query results to already shown documents
+         */
+        void appendDocuments(const std::vector<MongoDocumentPtr> &documents, bool lastBatch = true);
         bool isTextModeSupported() const { return _isTextModeSupported; }
         bool isTreeModeSupported() const { return _isTreeModeSupported; }
         bool isCustomModeSupported() const { return _isCustomModeSupported; }
@@ -49,11 +68,85 @@ namespace Robomongo
         void refreshOutputItem();
         void markUninitialized();
 
+        /**
+         * @brief Shows plan summary of this result in header, see SettingsManager::profileQueries()
+         */
+        void setExplainInfo(const ExplainInfo &explain, qint64 elapsedMs);
+
+        /**
+         * @brief Shows JavaScript heap of shell after statement in header, see MongoShellResult::jsHeapBytes()
+         */
+        void setJsHeapBytes(long long bytes);
+
+        /**
+         * @brief Replaces collection name in header, i.e. with stage of pipeline preview
+         */
+        void setCaption(const QString &caption, const QString &toolTip);
+        AggrInfo const& aggrInfo() const { return _aggrInfo; }
+        MongoQueryInfo const& queryInfo() const { return _queryInfo; }
+
+        /**
+         * @brief Shows total count in paging, unless this part shows other query by now
+         */
+        void setTotalCount(const MongoQueryInfo &queryInfo, long long count, bool estimated);
+
+        /**
+         * @brief Pages of this part are read from namespace 'ns' of opened dump file,
+         *        instead of server (see BsonFileWidget)
+         */
+        void setDumpFile(const BsonDumpFilePtr &file, const std::string &ns, int batchSize);
+
+        /**
+         * @brief Shows documents of dump indexed so far as total count of paging
+         */
+        void updateDumpCount();
+
+        /**
+         * @brief Reads next page of query in background, when current one is complete.
+         *        Page is put into page cache by cachePrefetchedPage().
+         */
+        void prefetchNextPage();
+        void cachePrefetchedPage(const MongoQueryInfo &queryInfo, const std::vector<MongoDocumentPtr> &documents);
+
         void applyDockUndockSettings(bool isDocking) const;
         void toggleOrientation(Qt::Orientation orientation) const;
 
         const OutputWidget* outputWidget() const { return _outputWidget; }
 
+        /**
+         * @brief Estimated memory of documents, cached pages and views of this part
+         */
+        long long footprintBytes() const;
+
+        /**
+         * @brief Deletes views of hidden part, they are created again when part is shown
+         * @return false, if part is visible or has no views to delete
+         */
+        bool releaseViews();
+
+        /**
+         * @brief Drops documents of hidden part of find query, they are read again with
+         *        the query when part is shown
+         * @return false, if part is visible or its documents cannot be read again
+         */
+        bool releaseDocuments();
+
+        // Documents of this part, as shown before filter. See ResultDiffDialog.
+        const std::vector<MongoDocumentPtr> &documents() const { return _documents; }
+        bool areDocumentsReleased() const { return _areDocumentsReleased; }
+
+        /**
+         * @brief Query and current page of this part. Documents of the page are written
+         *        to 'resultFile' of WorkspaceSnapshot, unless it is empty or they are released.
+         */
+        WorkspaceSnapshot::Part snapshot(const QString &resultFile) const;
+
+        /**
+         * @brief Shows documents of restored part as page at 'skip', instead of the first one
+         *        (see OutputWidget::presentSnapshot())
+         */
+        void restorePage(int skip, int batchSize);
+
     Q_SIGNALS:
         void restoredSize();
         void maximizedPart();
@@ -64,17 +157,93 @@ namespace Robomongo
         void showTable();
         void showCustom();
 
+        // Runs prefixes of pipeline of this aggregation result, see MongoShell::previewPipeline()
+        void previewPipeline();
+
+        // Lets user pick other part to compare documents with, see OutputWidget::diffPart()
+        void diffWithPart();
+
+        // Saves all documents of this query to file (ResultArchive by default), see ExportDialog
+        void saveResultSet();
+
+        // Groups values of field among documents of this query on server, see MongoShell::groupByField()
+        void groupByField(const QString &field, int sampleSize);
+
+    protected Q_SLOTS:
+        void handle(DocumentsChangedEvent *event);
+
+    protected:
+        virtual void showEvent(QShowEvent *event);
+        virtual void hideEvent(QHideEvent *event);
+
     private Q_SLOTS:
         void jsonPartReady(const QString &json);
+        void jsonPrepared();
+        void flushText();
+
+        // Builds one view of mode other than current, while part is idle and small enough
+        void prebuildViews();
+        // Reads page from server again, aggregation cursor is reopened (see requestPage())
         void refresh(int skip, int batchSize);
         void paging_rightClicked(int skip, int batchSize);
         void paging_leftClicked(int skip, int limit);      
 
+        // Filter bar narrows documents already shown, see DocumentFilter
+        void applyFilter();
+        void filterTextChanged(const QString &text);
+        void filterDone();
+
     private:
         void setup(double secs, bool multipleResults, bool tabbedResults, bool firstItem, bool lastItem);
         FindFrame *configureLogText();
+
+        // Text of result above LargeTextBytes is shown without lexer and brace matching
+        void enableLargeTextMode();
         BsonTreeModel *configureModel();
 
+        // Create view of mode (without showing it), if it is supported and not created yet
+        // @return false, if nothing was created
+        bool prepareTextView();
+        bool prepareTreeView();
+        bool prepareTableView();
+        void startJsonPrepareJob(const std::vector<MongoDocumentPtr> &documents, int firstPosition);
+        void stopJsonPrepareJob();
+        int jsonJobPriority() const;     // see ViewPreparePool::Priority
+        void addRetainedBytes(const std::vector<MongoDocumentPtr> &documents);
+
+        // Deletes tree, table and text views, they are created again for shownDocuments()
+        void resetViews();
+
+        // Deletes text view and stops preparing its text, it is prepared again when shown
+        void resetTextView();
+
+        // Patches model with page read again by refresh() (see BsonTreeModel::applyPatch()),
+        // views are built anew only if they show other rows than those of page
+        void applyRefreshedPage();
+        const std::vector<MongoDocumentPtr> &shownDocuments() const
+        {
+            return _isFiltered ? _filteredDocuments : _documents;
+        }
+        bool isFilterActive() const { return _isFiltered || _filterThread; }
+        void stopFilter();
+
+        // Query of page at 'skip' with respect to skip and limit of original query
+        MongoQueryInfo pageInfo(int skip, int batchSize) const;
+        static QString pageKey(const MongoQueryInfo &info);
+        QString pageKey(int skip, int batchSize) const;
+
+        // Shows page from cache, or loads it from server
+        void loadPage(int skip, int batchSize);
+
+        // Reads page with cursor kept for this part by worker. Next page of aggregation
+        // continues its cursor, unless 'reread' is set, then pipeline runs again.
+        void requestPage(int skip, int batchSize, bool reread);
+        void cacheCurrentPage();
+        void cachePage(const QString &key, const std::vector<MongoDocumentPtr> &documents);
+        void clearPageCache();
+        long long cachedPagesBytes() const;
+        std::vector<MongoDocumentPtr> storeDocuments(const std::vector<MongoDocumentPtr> &documents);
+
         FindFrame *_textView;
         BsonTreeView *_bsonTreeview;
         BsonTableView *_bsonTable;
@@ -84,11 +253,56 @@ namespace Robomongo
         QString _text;
         QString _type; // type of request
         std::vector<MongoDocumentPtr> _documents;
+        BsonSegmentFilePtr _store;      // memory-mapped file, which _documents point into
+        long long _retainedBytes = 0;   // BSON bytes of _documents in memory, shown in header
+        long long _spilledBytes = 0;    // BSON bytes of _documents moved to temporary file
         MongoQueryInfo _queryInfo;
         AggrInfo _aggrInfo;
+        double _secs = 0;               // execution time shown in header
+        BsonDumpFilePtr _dumpFile;      // source of pages instead of _shell, if set
+        std::string _dumpNamespace;
+
+        // Recently shown pages of query or aggregation, by pageKey(). Dropped when collection
+        // is changed by Notifier, and pages of aggregation on refresh()
+        typedef std::vector<MongoDocumentPtr> Page;
+        QCache<QString, Page> _pageCache;
+        QHash<QString, long long> _pageBytes;   // BSON bytes in memory of pages put into _pageCache
+        QString _pageKey;   // key of current page, empty if page is not cacheable
+        int _pageSkip = 0;
+        int _pageBatchSize = 0;
+        QString _prefetchKey;   // key of page being read ahead, one at a time
+        bool _isLoading = false;    // page requested by refresh() is not read completely yet
+
+        // Page read again by refresh() is collected and patched into views once complete,
+        // previous documents are shown meanwhile
+        bool _isPatchPending = false;
+        std::vector<MongoDocumentPtr> _refreshedDocuments;
+
+        // Memory released by ResultMemoryManager, it is restored when part is shown
+        bool _areViewsReleased = false;
+        bool _areDocumentsReleased = false;
+
+        // Server cursor of this part, kept open by MongoWorker between pages
+        unsigned long long const _cursorKey;
 
         QStackedWidget *_stack;
-        JsonPrepareThread *_thread;
+        JsonPrepareJob *_jsonJob;   // runs while part is shown, see ViewPreparePool
+        // Appended documents waiting for current JsonPrepareJob to finish
+        std::vector<MongoDocumentPtr> _pendingTextDocuments;
+
+        // Parts of JsonPrepareJob are appended to text view together, at most once per frame
+        QByteArray _pendingText;    // UTF-8
+        QTimer *_textFlushTimer;
+        long long _renderedTextBytes = 0;
+        QTimer *_prebuildTimer;
+        bool _isLargeText = false;
+
+        QWidget *_filterBar;
+        QLineEdit *_filterLine;
+        QLabel *_filterStatus;
+        DocumentFilterThread *_filterThread = nullptr;
+        std::vector<MongoDocumentPtr> _filteredDocuments;   // subset of _documents, in order
+        bool _isFiltered = false;                           // views show _filteredDocuments
 
         MongoShell *_shell;
         OutputItemHeaderWidget *_header;
@@ -4,8 +4,11 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QSplitter>
+#include <algorithm>
 
 #include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/core/domain/MongoUtils.h"
+#include "robomongo/core/domain/PipelinePreview.h"
 #include "robomongo/gui/GuiRegistry.h"
 #include "robomongo/gui/widgets/workarea/QueryWidget.h"
 #include "robomongo/gui/widgets/workarea/OutputWidget.h"
@@ -33,9 +36,10 @@ namespace Robomongo
             OutputItemContentWidget *outputItemContentWidget, bool multipleResults, 
             bool tabbedResults, bool firstItem, bool lastItem, QWidget *parent) :
         QFrame(parent),
-        _maxButton(nullptr), _dockUndockButton(nullptr), _maximized(false), 
+        _maxButton(nullptr), _previewButton(nullptr), _diffButton(nullptr), _saveButton(nullptr), _dockUndockButton(nullptr),
+        _maximized(false), 
         _multipleResults(multipleResults), 
-        _firstItem(firstItem), _lastItem(lastItem), _orientation(Qt::Vertical)
+        _firstItem(firstItem), _lastItem(lastItem), _isDockable(false), _orientation(Qt::Vertical)
     {
         setContentsMargins(5, 0, 0, 0);
 
@@ -89,15 +93,18 @@ namespace Robomongo
             VERIFY(connect(_maxButton, SIGNAL(clicked()), this, SLOT(maximizeMinimizePart())));
         }
 
+        // Results of opened dump file (see BsonFileWidget) are not in dock of query widget
         auto dockWidget = qobject_cast<QueryWidget::CustomDockWidget*>(outputItemContentWidget->parentWidget()->parentWidget());
-        auto queryWidget = dockWidget->getParentQueryWidget();
-        
+        _isDockable = dockWidget != nullptr;
+
         _dockUndockButton = new QPushButton;
         _dockUndockButton->setFixedSize(18, 18);
         _dockUndockButton->setFlat(true);
         _dockUndockButton->setHidden(true);
-        applyDockUndockSettings(!dockWidget->isFloating());
-        VERIFY(connect(_dockUndockButton, SIGNAL(clicked()), queryWidget, SLOT(dockUndock())));
+        if (_isDockable) {
+            applyDockUndockSettings(!dockWidget->isFloating());
+            VERIFY(connect(_dockUndockButton, SIGNAL(clicked()), dockWidget->getParentQueryWidget(), SLOT(dockUndock())));
+        }
 
         VERIFY(connect(_textButton, SIGNAL(clicked()), outputItemContentWidget, SLOT(showText())));
         VERIFY(connect(_treeButton, SIGNAL(clicked()), outputItemContentWidget, SLOT(showTree())));
@@ -106,12 +113,48 @@ namespace Robomongo
 
         _collectionIndicator = new Indicator(GuiRegistry::instance().collectionIcon());
         _timeIndicator = new Indicator(GuiRegistry::instance().timeIcon());
+        _memoryIndicator = new Indicator(GuiRegistry::instance().bsonBinaryIcon());
+        _memoryIndicator->setToolTip("Memory retained by documents of this result");
+        _jsHeapIndicator = new Indicator(GuiRegistry::instance().functionIcon());
+        _jsHeapIndicator->setToolTip("JavaScript heap of shell right after this statement, "
+                                     "before its garbage was collected");
+        _explainIndicator = new Indicator(GuiRegistry::instance().indexIcon());
         _paging = new PagingWidget();
 
         _collectionIndicator->hide();
         _timeIndicator->hide();
+        _memoryIndicator->hide();
+        _jsHeapIndicator->hide();
+        _explainIndicator->hide();
         _paging->hide();
 
+        // Aggregation results can be previewed stage by stage
+        if (outputItemContentWidget->aggrInfo().isValid) {
+            _previewButton = new QPushButton("Stages");
+            _previewButton->setToolTip(QString("Run every stage of pipeline on the first %1 input documents "
+                                               "and show documents after each stage")
+                                       .arg(PipelinePreview::DefaultSampleSize));
+            _previewButton->setFlat(true);
+            VERIFY(connect(_previewButton, SIGNAL(clicked()), outputItemContentWidget, SLOT(previewPipeline())));
+        }
+
+        // Documents of parts of one script can be compared, i.e. before and after update
+        if (_multipleResults && outputItemContentWidget->isTreeModeSupported()) {
+            _diffButton = new QPushButton("Diff");
+            _diffButton->setToolTip("Compare documents of this result with other result, matched by _id");
+            _diffButton->setFlat(true);
+            VERIFY(connect(_diffButton, SIGNAL(clicked()), outputItemContentWidget, SLOT(diffWithPart())));
+        }
+
+        // All documents of query, to be opened later without server
+        if (outputItemContentWidget->queryInfo()._info.isValid()) {
+            _saveButton = new QPushButton("Save");
+            _saveButton->setToolTip("Save all documents of this query to compressed archive, which is "
+                                    "opened with File > Open BSON File, without server");
+            _saveButton->setFlat(true);
+            VERIFY(connect(_saveButton, SIGNAL(clicked()), outputItemContentWidget, SLOT(saveResultSet())));
+        }
+
         QHBoxLayout *layout = new QHBoxLayout();
 #ifdef __APPLE__
         layout->setContentsMargins(2, 8, 5, 1);
@@ -121,9 +164,18 @@ namespace Robomongo
         layout->setSpacing(0);
         layout->addWidget(_collectionIndicator);
         layout->addWidget(_timeIndicator);
+        layout->addWidget(_memoryIndicator);
+        layout->addWidget(_jsHeapIndicator);
+        layout->addWidget(_explainIndicator);
         QSpacerItem *hSpacer = new QSpacerItem(2000, 24, QSizePolicy::Preferred, QSizePolicy::Minimum);
         layout->addSpacerItem(hSpacer);
         layout->addWidget(_paging);
+        if (_previewButton)
+            layout->addWidget(_previewButton);
+        if (_diffButton)
+            layout->addWidget(_diffButton);
+        if (_saveButton)
+            layout->addWidget(_saveButton);
         layout->addWidget(createVerticalLine());
         layout->addSpacing(2);
 
@@ -160,8 +212,8 @@ namespace Robomongo
         if (_multipleResults)
             updateDockButtonOnToggleOrientation();
         else {
-            _verticalLine->setVisible(true);
-            _dockUndockButton->setVisible(true);
+            _verticalLine->setVisible(_isDockable);
+            _dockUndockButton->setVisible(_isDockable);
         }
       
         if(tabbedResults)
@@ -248,12 +300,68 @@ namespace Robomongo
         _timeIndicator->setText(time);
     }
 
+    void OutputItemHeaderWidget::setRetainedBytes(long long bytes, long long spilledBytes)
+    {
+        QString text = MongoUtils::buildNiceSizeString(bytes);
+        if (spilledBytes > 0)
+            text += QString(" (+%1 on disk)").arg(MongoUtils::buildNiceSizeString(spilledBytes));
+
+        _memoryIndicator->setVisible(bytes > 0 || spilledBytes > 0);
+        _memoryIndicator->setText(text);
+    }
+
+    void OutputItemHeaderWidget::setJsHeapBytes(long long bytes)
+    {
+        _jsHeapIndicator->setVisible(bytes > 0);
+        _jsHeapIndicator->setText(QString("JS %1").arg(MongoUtils::buildNiceSizeString(bytes)));
+    }
+
+    void OutputItemHeaderWidget::setExplain(const ExplainInfo &explain, qint64 elapsedMs)
+    {
+        _explainIndicator->setVisible(explain.isValid);
+        if (!explain.isValid)
+            return;
+
+        if (!explain.error.empty()) {
+            _explainIndicator->setText("explain failed");
+            _explainIndicator->setToolTip(QtUtils::toQString(explain.error));
+            return;
+        }
+
+        // Collection scan is what user looks for, so it wins over indexes in mixed plans (i.e. $or)
+        QString const plan = explain.collScan ? QString("COLLSCAN") : 
+                             explain.indexes.empty() ? QString("no scan") :
+                             QString("IXSCAN %1").arg(QtUtils::toQString(explain.indexes));
+        _explainIndicator->setText(QString("%1, %2 keys / %3 docs examined")
+            .arg(plan).arg(explain.keysExamined).arg(explain.docsExamined));
+
+        // Explain runs statement once more, so split of time between server and 
+        // transfer (cursor batches, shell and BSON conversion) is an estimate
+        qint64 const transferMs = std::max<qint64>(0, elapsedMs - explain.serverMs);
+        QStringList tip;
+        tip << QString("Plan: %1").arg(plan);
+        if (explain.collScan && !explain.indexes.empty())
+            tip << QString("Indexes: %1").arg(QtUtils::toQString(explain.indexes));
+        tip << QString("Keys examined: %1").arg(explain.keysExamined)
+            << QString("Documents examined: %1").arg(explain.docsExamined)
+            << QString("Documents returned: %1").arg(explain.returned)
+            << QString("Server execution: %1 ms").arg(explain.serverMs)
+            << QString("Transfer and client: ~%1 ms").arg(transferMs);
+        _explainIndicator->setToolTip(tip.join("\n"));
+    }
+
     void OutputItemHeaderWidget::setCollection(const QString &collection)
     {
         _collectionIndicator->setVisible(!collection.isEmpty());
         _collectionIndicator->setText(collection);
     }
 
+    void OutputItemHeaderWidget::setCaption(const QString &caption, const QString &toolTip)
+    {
+        setCollection(caption);
+        _collectionIndicator->setToolTip(toolTip);
+    }
+
     void OutputItemHeaderWidget::maximizeMinimizePart()
     {
         // No maximize/minimize behaviour if there is only one query result
@@ -279,7 +387,7 @@ namespace Robomongo
     
     void OutputItemHeaderWidget::updateDockButtonOnToggleOrientation() const
     {
-        if (!_multipleResults)
+        if (!_multipleResults || !_isDockable)
             return;
 
         if (_firstItem) {
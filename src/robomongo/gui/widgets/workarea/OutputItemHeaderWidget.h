@@ -39,6 +39,10 @@ namespace Robomongo
     public Q_SLOTS:        
         void setTime(const QString &time);
         void setCollection(const QString &collection);
+        void setCaption(const QString &caption, const QString &toolTip);
+        void setRetainedBytes(long long bytes, long long spilledBytes = 0);
+        void setJsHeapBytes(long long bytes);
+        void setExplain(const ExplainInfo &explain, qint64 elapsedMs);
         void maximizeMinimizePart();
 
     private:
@@ -49,16 +53,23 @@ namespace Robomongo
         QPushButton *_tableButton;
         QPushButton *_customButton;
         QPushButton *_maxButton;
+        QPushButton *_previewButton;
+        QPushButton *_diffButton;
+        QPushButton *_saveButton;
         QFrame *_verticalLine;
         QPushButton *_dockUndockButton;
         Indicator *_collectionIndicator;
         Indicator *_timeIndicator;
+        Indicator *_memoryIndicator;
+        Indicator *_jsHeapIndicator;
+        Indicator *_explainIndicator;
         PagingWidget *_paging;
 
         bool _maximized;
         bool _multipleResults;
         bool _firstItem;
         bool _lastItem;
+        bool _isDockable;
         Qt::Orientation _orientation;
     };
 }
@@ -1,15 +1,20 @@
 #include "robomongo/gui/widgets/workarea/OutputWidget.h"
 
+#include <algorithm>
+#include <QCursor>
 #include <QHBoxLayout>
+#include <QMenu>
 #include <QSplitter>
 #include <QWidget>
 #include <QMouseEvent>
 
 #include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/domain/BsonDumpFile.h"
 #include "robomongo/core/domain/MongoShell.h"
 #include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/core/utils/QtUtils.h"
 
+#include "robomongo/gui/dialogs/ResultDiffDialog.h"
 #include "robomongo/gui/widgets/workarea/OutputItemContentWidget.h"
 #include "robomongo/gui/widgets/workarea/ProgressBarPopup.h"
 #include "robomongo/gui/widgets/workarea/WorkAreaTabBar.h"
@@ -43,7 +48,7 @@ namespace Robomongo
         _progressBarPopup = new ProgressBarPopup(this);
     }
 
-    void OutputWidget::present(MongoShell *shell, const std::vector<MongoShellResult> &results)
+    void OutputWidget::present(MongoShell *shell, const std::vector<MongoShellResult> &results, bool fromServer)
     {
         if (_prevResultsCount > 0)
             clearAllParts();
@@ -58,7 +63,7 @@ namespace Robomongo
             removeTab(count()-1);
 
         for (int i = 0; i < RESULTS_SIZE; ++i) {
-            MongoShellResult shellResult = results[i];
+            MongoShellResult const& shellResult = results[i];
             double secs = shellResult.elapsedMs() / 1000.f;
             ViewMode viewMode = AppRegistry::instance().settingsManager()->viewMode();
             if (_prevViewModes.size()) {
@@ -80,6 +85,10 @@ namespace Robomongo
                                                    secs, multipleResults, _tabbedResults, firstItem, lastItem,
                                                    shellResult.aggrInfo(), this);
             }
+            if (shellResult.explainInfo().isValid)
+                item->setExplainInfo(shellResult.explainInfo(), shellResult.elapsedMs());
+            item->setJsHeapBytes(shellResult.jsHeapBytes());
+
             VERIFY(connect(item, SIGNAL(maximizedPart()), this, SLOT(maximizePart())));
             VERIFY(connect(item, SIGNAL(restoredSize()), this, SLOT(restoreSize())));
 
@@ -91,13 +100,153 @@ namespace Robomongo
                 _splitter->addWidget(item);
              
             _outputItemContentWidgets.push_back(item);
+
+            // Total is counted natively, while documents of the first page are shown
+            if (fromServer && shellResult.queryInfo()._info.isValid()) {
+                shell->countDocuments(i, shellResult.queryInfo());
+                item->prefetchNextPage();
+            }
         }
         
         tryToMakeAllPartsEqualInSize();
     }
 
+    void OutputWidget::presentPipelinePreview(MongoShell *shell, 
+                                              const std::vector<PipelinePreview::StageResult> &stages,
+                                              int sampleSize)
+    {
+        // Parts are not aggregation results, they cannot be paged or previewed again
+        std::vector<MongoShellResult> results;
+        for (size_t i = 0; i < stages.size(); ++i) {
+            PipelinePreview::StageResult const &stage = stages[i];
+            std::string const response = !stage.error.empty() ? "Error: " + stage.error : 
+                                         stage.documents.empty() ? "No documents after this stage." : "";
+            std::string const statement = std::to_string(i + 1) + ". " + stage.name;
+            results.emplace_back("", response, stage.documents, MongoQueryInfo(), statement, stage.elapsedMs);
+        }
+        present(shell, results);
+
+        for (size_t i = 0; i < stages.size() && i < _outputItemContentWidgets.size(); ++i) {
+            PipelinePreview::StageResult const &stage = stages[i];
+            QString caption = QString("%1. %2").arg(i + 1).arg(QtUtils::toQString(stage.name));
+            if (stage.error.empty()) {
+                caption += QString(": %1 document%2").arg(stage.count).arg(stage.count == 1 ? "" : "s");
+                if (stage.count > static_cast<long long>(stage.documents.size()))
+                    caption += QString(", first %1 shown").arg(stage.documents.size());
+            }
+            QString const toolTip = QString("%1\n\nInput is capped to the first %2 documents")
+                .arg(QtUtils::toQString(stage.stage)).arg(sampleSize);
+            _outputItemContentWidgets[i]->setCaption(caption, toolTip);
+        }
+    }
+
+    void OutputWidget::presentFieldDistribution(MongoShell *shell, const FieldDistribution::Result &result,
+                                                int sampleSize, long long elapsedMs)
+    {
+        // Groups are not documents of collection, part cannot be paged or edited
+        ViewMode const viewMode = AppRegistry::instance().settingsManager()->viewMode();
+        double const secs = elapsedMs / 1000.f;
+        OutputItemContentWidget *item = nullptr;
+        if (!result.groups.empty()) {
+            item = new OutputItemContentWidget(viewMode, shell, "Group", result.groups, MongoQueryInfo(), secs,
+                                               true, _tabbedResults, false, true, AggrInfo(), this);
+        } else {
+            item = new OutputItemContentWidget(viewMode, shell, "No documents matched.", secs,
+                                               true, _tabbedResults, false, true, AggrInfo(), this);
+        }
+        VERIFY(connect(item, SIGNAL(maximizedPart()), this, SLOT(maximizePart())));
+        VERIFY(connect(item, SIGNAL(restoredSize()), this, SLOT(restoreSize())));
+
+        QString const field = QtUtils::toQString(result.field);
+        QString caption = QString("Group by %1: %2 documents, %3 distinct values")
+            .arg(field).arg(result.documents).arg(result.distinct);
+        if (result.distinct > static_cast<long long>(result.groups.size()))
+            caption += QString(", top %1 shown").arg(result.groups.size());
+        QString const toolTip = sampleSize > 0 ? QString("Grouped on server, among %1 sampled documents of query")
+                                                     .arg(sampleSize)
+                                               : QString("Grouped on server, among all documents of query");
+        item->setCaption(caption, toolTip);
+
+        if (_tabbedResults) {
+            setCurrentIndex(addTab(item, "Group by " + field));
+            setTabToolTip(currentIndex(), toolTip);
+        }
+        else {
+            _splitter->addWidget(item);
+        }
+        _outputItemContentWidgets.push_back(item);
+        ++_prevResultsCount;
+        tryToMakeAllPartsEqualInSize();
+    }
+
+    void OutputWidget::presentSnapshot(MongoShell *shell, const std::vector<WorkspaceSnapshot::Part> &parts)
+    {
+        std::vector<MongoShellResult> results;
+        for (auto const &part : parts) {
+            std::vector<MongoDocumentPtr> documents;
+            if (WorkspaceSnapshot::readResults(part.resultFile, documents) && !documents.empty()) {
+                results.emplace_back(part.type, "", std::move(documents), part.queryInfo, part.statement,
+                                     part.elapsedMs, part.aggrInfo);
+            }
+            else if (!part.response.empty()) {
+                results.emplace_back("", part.response, documents, MongoQueryInfo(), part.statement,
+                                     part.elapsedMs, part.aggrInfo);
+            }
+            else {
+                results.emplace_back("", "Results of this part were not saved, run the script again to see them.",
+                                     documents, MongoQueryInfo(), part.statement, part.elapsedMs);
+            }
+        }
+        present(shell, results, false);
+
+        // Parts are restored at the page user was on, paging further goes to server
+        for (size_t i = 0; i < parts.size() && i < _outputItemContentWidgets.size(); ++i) {
+            WorkspaceSnapshot::Part const &part = parts[i];
+            OutputItemContentWidget *item = _outputItemContentWidgets[i];
+            int const initialSkip = part.queryInfo._info.isValid() ? part.queryInfo._skip : part.aggrInfo.skip;
+            if (!item->documents().empty() && part.pageBatchSize > 0 && part.pageSkip != initialSkip)
+                item->restorePage(part.pageSkip, part.pageBatchSize);
+        }
+    }
+
+    std::vector<WorkspaceSnapshot::Part> OutputWidget::snapshot(const QString &resultPrefix) const
+    {
+        std::vector<WorkspaceSnapshot::Part> parts;
+        for (size_t i = 0; i < _outputItemContentWidgets.size(); ++i) {
+            OutputItemContentWidget *item = _outputItemContentWidgets[i];
+            if (_tabbedResults && indexOf(item) < 0)
+                continue;   // closed by user
+
+            QString const resultFile = resultPrefix.isEmpty() ? QString()
+                                                              : QString("%1-%2.bson").arg(resultPrefix).arg(i);
+            WorkspaceSnapshot::Part part = item->snapshot(resultFile);
+            if (_tabbedResults)
+                part.statement = QtUtils::toStdString(tabToolTip(indexOf(item)));
+            parts.push_back(part);
+        }
+        return parts;
+    }
+
+    void OutputWidget::presentDump(const BsonDumpFilePtr &file, const std::string &ns)
+    {
+        int const batchSize = AppRegistry::instance().settingsManager()->batchSize();
+        std::vector<MongoShellResult> results;
+        std::vector<MongoDocumentPtr> const documents = file->documents(ns, 0, batchSize);
+        results.emplace_back("", documents.empty() ? "No documents." : "", documents, MongoQueryInfo(), ns, 0);
+        present(nullptr, results);
+
+        if (!documents.empty())
+            _outputItemContentWidgets.front()->setDumpFile(file, ns, batchSize);
+    }
+
+    void OutputWidget::updateDumpCounts()
+    {
+        for (auto part : _outputItemContentWidgets)
+            part->updateDumpCount();
+    }
+
     void OutputWidget::updatePart(int partIndex, const MongoQueryInfo &queryInfo, 
-                                  const std::vector<MongoDocumentPtr> &documents)
+                                  const std::vector<MongoDocumentPtr> &documents, bool lastBatch)
     {
         if (!_tabbedResults && partIndex >= _splitter->count())
             return;
@@ -108,21 +257,56 @@ namespace Robomongo
         else
             outputItemContentWidget = qobject_cast<OutputItemContentWidget*>(_splitter->widget(partIndex));
         
-        outputItemContentWidget->updateWithInfo(queryInfo, documents);
+        outputItemContentWidget->updateWithInfo(queryInfo, documents, lastBatch);
         outputItemContentWidget->refreshOutputItem();
     }
 
+    void OutputWidget::appendToPart(int partIndex, const std::vector<MongoDocumentPtr> &documents,
+                                    bool lastBatch)
+    {
+        if (!_tabbedResults && partIndex >= _splitter->count())
+            return;
+
+        OutputItemContentWidget* outputItemContentWidget = nullptr;
+        if (_tabbedResults)
+            outputItemContentWidget = qobject_cast<OutputItemContentWidget*>(currentWidget());
+        else
+            outputItemContentWidget = qobject_cast<OutputItemContentWidget*>(_splitter->widget(partIndex));
+
+        if (outputItemContentWidget)
+            outputItemContentWidget->appendDocuments(documents, lastBatch);
+    }
+
     void OutputWidget::updatePart(int partIndex, const AggrInfo &agrrInfo, 
                                   const std::vector<MongoDocumentPtr> &documents)
     {
-        if (partIndex >= _splitter->count())
+        // Paging of tabbed results is done in current tab only, as for queries
+        QWidget *part = _tabbedResults ? currentWidget() : _splitter->widget(partIndex);
+        auto outputItemContentWidget = qobject_cast<OutputItemContentWidget*>(part);
+        if (!outputItemContentWidget)
             return;
 
-        auto outputItemContentWidget = qobject_cast<OutputItemContentWidget*>(_splitter->widget(partIndex));
         outputItemContentWidget->updateWithInfo(agrrInfo, documents);
         outputItemContentWidget->refreshOutputItem();
     }
 
+    void OutputWidget::cachePrefetchedPage(int partIndex, const MongoQueryInfo &queryInfo,
+                                           const std::vector<MongoDocumentPtr> &documents)
+    {
+        // Paging of tabbed results is done in current tab only, see updatePart()
+        QWidget *part = _tabbedResults ? currentWidget() : _splitter->widget(partIndex);
+        if (auto outputItemContentWidget = qobject_cast<OutputItemContentWidget*>(part))
+            outputItemContentWidget->cachePrefetchedPage(queryInfo, documents);
+    }
+
+    void OutputWidget::setPartTotalCount(int partIndex, const MongoQueryInfo &queryInfo, 
+                                         long long count, bool estimated)
+    {
+        QWidget *part = _tabbedResults ? widget(partIndex) : _splitter->widget(partIndex);
+        if (auto outputItemContentWidget = qobject_cast<OutputItemContentWidget*>(part))
+            outputItemContentWidget->setTotalCount(queryInfo, count, estimated);
+    }
+
     void OutputWidget::toggleOrientation()
     {
         bool const horizontal = _splitter->orientation() == Qt::Horizontal;
@@ -184,6 +368,14 @@ namespace Robomongo
         }
     }
 
+    long long OutputWidget::footprintBytes() const
+    {
+        long long bytes = 0;
+        for (OutputItemContentWidget const *item : _outputItemContentWidgets)
+            bytes += item->footprintBytes();
+        return bytes;
+    }
+
     void OutputWidget::tabCloseRequested(int index)
     {
         removeTab(index);
@@ -203,6 +395,39 @@ namespace Robomongo
         return _splitter->indexOf(result);
     }
 
+    void OutputWidget::diffPart(OutputItemContentWidget *part)
+    {
+        auto const &parts = _outputItemContentWidgets;
+        auto const current = std::find(parts.begin(), parts.end(), part);
+        if (current == parts.end() || part->areDocumentsReleased())
+            return;
+
+        QMenu menu;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            if (parts[i] == part || !parts[i]->isTreeModeSupported())
+                continue;
+
+            QAction *action = menu.addAction(QString("Diff with Result %1").arg(i + 1));
+            action->setData(static_cast<int>(i));
+            if (parts[i]->areDocumentsReleased()) {
+                action->setEnabled(false);
+                action->setText(action->text() + " (released from memory, show it first)");
+            }
+        }
+        if (menu.isEmpty())
+            return;
+
+        QAction *const chosen = menu.exec(QCursor::pos());
+        if (!chosen)
+            return;
+
+        OutputItemContentWidget *const other = parts[chosen->data().toInt()];
+        auto dlg = new ResultDiffDialog(part->documents(), QString("Result %1").arg(current - parts.begin() + 1),
+                                        other->documents(), QString("Result %1").arg(chosen->data().toInt() + 1),
+                                        this);
+        dlg->show();
+    }
+
     void OutputWidget::showProgress()
     {
         QSize siz = size();
@@ -6,6 +6,9 @@ class QSplitter;
 QT_END_NAMESPACE
 
 #include "robomongo/core/domain/MongoShellResult.h"
+#include "robomongo/core/domain/PipelinePreview.h"
+#include "robomongo/core/domain/FieldDistribution.h"
+#include "robomongo/core/domain/WorkspaceSnapshot.h"
 #include "robomongo/core/Enums.h"
 
 namespace Robomongo
@@ -21,11 +24,57 @@ namespace Robomongo
     public:
         explicit OutputWidget(QWidget *parent);
 
-        void present(MongoShell *shell, const std::vector<MongoShellResult> &documents);
+        /**
+         * @brief Replaces shown parts. Total counts and next pages of queries are read in
+         *        background, unless results are not from server (i.e. restored ones).
+         */
+        void present(MongoShell *shell, const std::vector<MongoShellResult> &documents, bool fromServer = true);
+
+        /**
+         * @brief Shows parts of restored tab at their saved pages. Documents are mapped from
+         *        result files of snapshot, parts without one tell to run the script again.
+         */
+        void presentSnapshot(MongoShell *shell, const std::vector<WorkspaceSnapshot::Part> &parts);
+
+        /**
+         * @brief Shown parts in order. Documents of part 'i' are written to result file
+         *        "<resultPrefix>-<i>.bson", unless prefix is empty.
+         */
+        std::vector<WorkspaceSnapshot::Part> snapshot(const QString &resultPrefix) const;
+
+        /**
+         * @brief Shows one part per stage of pipeline preview, with count of documents after
+         *        the stage and time of its prefix in header
+         */
+        void presentPipelinePreview(MongoShell *shell, const std::vector<PipelinePreview::StageResult> &stages,
+                                    int sampleSize);
+
+        /**
+         * @brief Adds part with the most frequent values of field after the shown parts,
+         *        count of grouped documents and distinct values are in its header
+         */
+        void presentFieldDistribution(MongoShell *shell, const FieldDistribution::Result &result,
+                                      int sampleSize, long long elapsedMs);
+
+        /**
+         * @brief Shows first page of namespace 'ns' of opened dump file in one part,
+         *        which reads further pages from the file
+         */
+        void presentDump(const BsonDumpFilePtr &file, const std::string &ns);
+
+        // Total counts of dump parts follow indexing of their file
+        void updateDumpCounts();
+
         void updatePart(int partIndex, const MongoQueryInfo &queryInfo, 
-                        const std::vector<MongoDocumentPtr> &documents);
+                        const std::vector<MongoDocumentPtr> &documents, bool lastBatch = true);
         void updatePart(int partIndex, const AggrInfo &agrrInfo,
                         const std::vector<MongoDocumentPtr> &documents);
+        void appendToPart(int partIndex, const std::vector<MongoDocumentPtr> &documents,
+                          bool lastBatch = true);
+        void cachePrefetchedPage(int partIndex, const MongoQueryInfo &queryInfo,
+                                 const std::vector<MongoDocumentPtr> &documents);
+        void setPartTotalCount(int partIndex, const MongoQueryInfo &queryInfo, long long count,
+                               bool estimated);
         void toggleOrientation();
 
         void switchMode(std::function<void(OutputItemContentWidget*)> modeFunc);
@@ -36,6 +85,15 @@ namespace Robomongo
 
         int resultIndex(OutputItemContentWidget *result);
 
+        /**
+         * @brief Shows menu of other parts with documents, and ResultDiffDialog of 'part'
+         *        and the one picked. Parts released by ResultMemoryManager are to be shown first.
+         */
+        void diffPart(OutputItemContentWidget *part);
+
+        // Estimated memory of shown results, see OutputItemContentWidget::footprintBytes()
+        long long footprintBytes() const;
+
         void showProgress();
         void hideProgress();
         bool progressBarActive() const;
@@ -1,6 +1,7 @@
 #include "robomongo/gui/widgets/workarea/PagingWidget.h"
 
 #include <QHBoxLayout>
+#include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
 
@@ -41,6 +42,10 @@ namespace Robomongo
         _skipEdit->setFixedWidth(width);
         _batchSizeEdit->setFixedWidth(width);
 
+        _totalLabel = new QLabel;
+        _totalLabel->setContentsMargins(4, 0, 2, 0);
+        _totalLabel->hide();
+
         QPushButton *leftButton = createButtonWithIcon(GuiRegistry::instance().leftIcon());
         QPushButton *rightButton = createButtonWithIcon(GuiRegistry::instance().rightIcon());
         VERIFY(connect(leftButton, SIGNAL(clicked()), this, SLOT(leftButton_clicked())));
@@ -58,6 +63,7 @@ namespace Robomongo
         layout->addWidget(_skipEdit);
         layout->addSpacing(1);
         layout->addWidget(_batchSizeEdit);
+        layout->addWidget(_totalLabel);
         layout->addSpacing(0);
         layout->addWidget(rightButton);
         setLayout(layout);
@@ -78,6 +84,14 @@ namespace Robomongo
         show();
     }
 
+    void PagingWidget::setTotalCount(long long count, bool estimated)
+    {
+        _totalLabel->setText(QString(estimated ? "of ~%1" : "of %1").arg(count));
+        _totalLabel->setToolTip(estimated ? "Total documents, from collection metadata" : 
+                                            "Total documents matching query");
+        _totalLabel->show();
+    }
+
     void PagingWidget::refresh()
     {
         int limit = _batchSizeEdit->text().toInt();
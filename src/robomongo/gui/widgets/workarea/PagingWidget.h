@@ -3,6 +3,7 @@
 #include <QWidget>
 QT_BEGIN_NAMESPACE
 class QLineEdit;
+class QLabel;
 QT_END_NAMESPACE
 
 namespace Robomongo
@@ -18,6 +19,11 @@ namespace Robomongo
         void setSkip(int skip);
         void setBatchSize(int limit);
 
+        /**
+         * @brief Shows "of N" after batch size. Estimated count is shown as "of ~N".
+         */
+        void setTotalCount(long long count, bool estimated);
+
     Q_SIGNALS:
         void leftClicked(int skip, int limit);
         void rightClicked(int skip, int limit);
@@ -31,5 +37,6 @@ namespace Robomongo
     private:
         QLineEdit *_skipEdit;
         QLineEdit *_batchSizeEdit;
+        QLabel *_totalLabel;
     };
 }
@@ -4,6 +4,7 @@
 #include <QPushButton>
 #include <QApplication>
 #include <QLabel>
+#include <QFileDialog>
 #include <QFileInfo>
 #include <QVBoxLayout>
 #include <QMessageBox>
@@ -21,6 +22,7 @@
 #include "robomongo/core/domain/MongoServer.h"
 #include "robomongo/core/domain/MongoShell.h"
 #include "robomongo/core/domain/MongoAggregateInfo.h"
+#include "robomongo/core/domain/MongoUtils.h"
 #include "robomongo/core/events/MongoEvents.h"
 #include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/settings/SettingsManager.h"
@@ -32,6 +34,7 @@
 #include "robomongo/gui/widgets/workarea/ScriptWidget.h"
 #include "robomongo/gui/widgets/workarea/OutputItemContentWidget.h"
 #include "robomongo/gui/widgets/workarea/OutputItemHeaderWidget.h"
+#include "robomongo/gui/widgets/workarea/ResultMemoryManager.h"
 #include "robomongo/gui/editors/PlainJavaScriptEditor.h"
 #include "robomongo/gui/editors/JSLexer.h"
 #include "robomongo/gui/dialogs/ChangeShellTimeoutDialog.h"
@@ -48,7 +51,13 @@ namespace Robomongo
         _isTextChanged(false)
     {
         AppRegistry::instance().bus()->subscribe(this, DocumentListLoadedEvent::Type, shell);
+        AppRegistry::instance().bus()->subscribe(this, DocumentsCountedEvent::Type, shell);
+        AppRegistry::instance().bus()->subscribe(this, PagePrefetchedEvent::Type, shell);
+        AppRegistry::instance().bus()->subscribe(this, AggregatePageResponse::Type, shell);
+        AppRegistry::instance().bus()->subscribe(this, PipelinePreviewResponse::Type, shell);
+        AppRegistry::instance().bus()->subscribe(this, FieldDistributionResponse::Type, shell);
         AppRegistry::instance().bus()->subscribe(this, ScriptExecutedEvent::Type, shell);
+        AppRegistry::instance().bus()->subscribe(this, ExecuteScriptFileProgressEvent::Type, shell);
         AppRegistry::instance().bus()->subscribe(this, AutocompleteResponse::Type, shell);
 
         // Make QMessageBox text selectable
@@ -60,6 +69,7 @@ namespace Robomongo
         // Need to use QMainWindow in order to make use of all features of docking.
         // (Note: Qt full support for dock windows implemented only for QMainWindow)
         _viewer = new OutputWidget(this);
+        VERIFY(connect(&ResultMemoryManager::instance(), SIGNAL(footprintChanged()), this, SLOT(updateCurrentTab())));
         _outputWindow = new QMainWindow;
         _dock = new CustomDockWidget(this);
         _dock->setAllowedAreas(Qt::NoDockWidgetArea);
@@ -123,6 +133,25 @@ namespace Robomongo
         }
     }
 
+    WorkspaceSnapshot::Tab QueryWidget::snapshot(const QString &resultPrefix) const
+    {
+        WorkspaceSnapshot::Tab tab;
+        tab.connection = _shell->server()->connectionRecord()->uuid();
+        tab.title = QtUtils::toStdString(_shell->title());
+        tab.database = _currentResult.currentDatabase().empty() ? _shell->dbname() : _currentResult.currentDatabase();
+        tab.script = QtUtils::toStdString(_scriptWidget->text());
+        tab.filePath = _shell->filePath();
+        tab.parts = _viewer->snapshot(resultPrefix);
+        return tab;
+    }
+
+    void QueryWidget::restoreSnapshot(const WorkspaceSnapshot::Tab &tab)
+    {
+        hideProgress();
+        _viewer->presentSnapshot(_shell, tab.parts);
+        updateCurrentTab();
+    }
+
     void QueryWidget::execute()
     {
         QString query = _scriptWidget->selectedText();
@@ -185,6 +214,23 @@ namespace Robomongo
         }
     }
 
+    void QueryWidget::runFile()
+    {
+        if (!_shell)
+            return;
+
+        // File is mapped and executed by worker, editor keeps its own script
+        QString const filePath = QFileDialog::getOpenFileName(this, tr("Run File"), QString(),
+                                                              tr("JavaScript (*.js);; All Files (*.*)"));
+        if (filePath.isEmpty())
+            return;
+
+        _outputLabel->setText("  Running " + QFileInfo(filePath).fileName() + "...");
+        _outputLabel->setVisible(true);
+        showProgress();
+        _shell->executeFile(filePath);
+    }
+
     void QueryWidget::textChange()
     {
         _isTextChanged = true;
@@ -251,6 +297,7 @@ namespace Robomongo
     void QueryWidget::handle(DocumentListLoadedEvent *event)
     {
         hideProgress();
+        _scriptWidget->setMaxTimeExceeded(event->isError() && event->error().isServerTimeLimitExceeded());
 
         if (event->isError()) {
             QString message = QString("Failed to load documents.\n\nError:\n%1")
@@ -259,29 +306,118 @@ namespace Robomongo
             return;
         }
 
+        // Documents arrive one server batch per event: the first batch replaces
+        // current part content, the next ones are appended to it
+        if (!event->isFirstBatch()) {
+            _viewer->appendToPart(event->resultIndex(), event->documents(), event->isLastBatch());
+            return;
+        }
+
         // this should be in viewer, subscribed to ScriptExecutedEvent
-        _viewer->updatePart(event->resultIndex(), event->queryInfo(), event->documents()); 
+        _viewer->updatePart(event->resultIndex(), event->queryInfo(), event->documents(), event->isLastBatch()); 
+    }
+
+    void QueryWidget::handle(PagePrefetchedEvent *event)
+    {
+        _viewer->cachePrefetchedPage(event->resultIndex, event->queryInfo, event->documents);
+    }
+
+    void QueryWidget::handle(AggregatePageResponse *event)
+    {
+        hideProgress();
+        _scriptWidget->setMaxTimeExceeded(event->isError() && event->error().isServerTimeLimitExceeded());
+
+        if (event->isError()) {
+            QString message = QString("Failed to load documents.\n\nError:\n%1")
+                .arg(QtUtils::toQString(event->error().errorMessage()));
+            QMessageBox::information(this, "Error", message);
+            return;
+        }
+
+        _viewer->updatePart(event->resultIndex, event->aggrInfo, event->documents);
+    }
+
+    void QueryWidget::handle(PipelinePreviewResponse *event)
+    {
+        hideProgress();
+        _scriptWidget->setMaxTimeExceeded(event->isError() && event->error().isServerTimeLimitExceeded());
+
+        if (event->isError()) {
+            QString message = QString("Failed to preview pipeline.\n\nError:\n%1")
+                .arg(QtUtils::toQString(event->error().errorMessage()));
+            QMessageBox::information(this, "Error", message);
+            return;
+        }
+
+        // Results of script are replaced by preview, they are shown again by execute()
+        _viewer->presentPipelinePreview(_shell, event->stages, event->sampleSize);
+        _outputLabel->setVisible(false);
+        updateCurrentTab();
+    }
+
+    void QueryWidget::handle(FieldDistributionResponse *event)
+    {
+        hideProgress();
+        _scriptWidget->setMaxTimeExceeded(event->isError() && event->error().isServerTimeLimitExceeded());
+
+        if (event->isError()) {
+            QString message = QString("Failed to group by field.\n\nError:\n%1")
+                .arg(QtUtils::toQString(event->error().errorMessage()));
+            QMessageBox::information(this, "Error", message);
+            return;
+        }
+
+        // Shown results stay, groups are added as one more part
+        _viewer->presentFieldDistribution(_shell, event->result, event->sampleSize, event->elapsedMs);
+        _outputLabel->setVisible(false);
+        updateCurrentTab();
+    }
+
+    void QueryWidget::handle(DocumentsCountedEvent *event)
+    {
+        _viewer->setPartTotalCount(event->resultIndex, event->queryInfo, event->count, event->estimated);
+    }
+
+    void QueryWidget::handle(ExecuteScriptFileProgressEvent *event)
+    {
+        double const mb = 1024.0 * 1024.0;
+        _outputLabel->setText(QString("  Running file: %1 of %2 MB (%3 statements)")
+            .arg(event->doneBytes / mb, 0, 'f', 1)
+            .arg(event->totalBytes / mb, 0, 'f', 1)
+            .arg(event->statements));
+        _outputLabel->setVisible(true);
     }
 
     void QueryWidget::handle(ScriptExecutedEvent *event)
     {
         hideProgress();        
-        _currentResult = event->result();
+        _outputLabel->setVisible(false);
+        _currentResult = event->takeResult();
+
+        // Errors caught by script itself are only printed, so output is checked too
+        bool maxTimeExceeded = event->isError() && event->error().isServerTimeLimitExceeded();
+        maxTimeExceeded |= EventError::isServerTimeLimitExceeded(_currentResult.errorMessage());
+        for (MongoShellResult const &result : _currentResult.results())
+            maxTimeExceeded |= EventError::isServerTimeLimitExceeded(result.response());
+        _scriptWidget->setMaxTimeExceeded(maxTimeExceeded);
 
         if (_currentResult.results().size() == 1) {
             MongoShellResult const& result = _currentResult.results().front();
             AggrInfo const& aggrInfo = result.aggrInfo();
             if (aggrInfo.isValid && aggrInfo.resultIndex > -1) {
                 _viewer->updatePart(aggrInfo.resultIndex, aggrInfo, _currentResult.results().front().documents());
+                _currentResult.clearDocuments();
                 return;
             }
         }
 
         updateCurrentTab();
 
-        displayData(event->result().results(), event->empty());
+        displayData(_currentResult.results(), event->empty());
+        // Output views keep documents in their own memory-mapped stores
+        _currentResult.clearDocuments();
         // this should be in ScriptWidget, which is subscribed to ScriptExecutedEvent              
-        _scriptWidget->setup(event->result()); 
+        _scriptWidget->setup(_currentResult); 
         activateTabContent();
 
         if (event->isError()) {
@@ -390,6 +526,13 @@ namespace Robomongo
             tabTitle = "* " + tabTitle;
         }
 
+        long long const resultBytes = _viewer->footprintBytes();
+        if (resultBytes > 0) {
+            if (!toolTipText.isEmpty())
+                toolTipText += "<br/>";
+            toolTipText += QString("Results in memory: %1").arg(MongoUtils::buildNiceSizeString(resultBytes));
+        }
+
         emit titleChanged(tabTitle);
         emit toolTipChanged(toolTipText);
     }
@@ -14,12 +14,18 @@ QT_END_NAMESPACE
 
 #include "robomongo/core/Core.h"
 #include "robomongo/core/domain/MongoShellResult.h"
+#include "robomongo/core/domain/WorkspaceSnapshot.h"
 
 namespace Robomongo
 {
     class BsonWidget;
     class DocumentListLoadedEvent;
+    class DocumentsCountedEvent;
+    class PagePrefetchedEvent;
+    class PipelinePreviewResponse;
+    class FieldDistributionResponse;
     class ScriptExecutedEvent;
+    class ExecuteScriptFileProgressEvent;
     class AutocompleteResponse;
     class OutputWidget;
     class ScriptWidget;
@@ -56,6 +62,15 @@ namespace Robomongo
         // Get output window's dock status
         bool outputWindowDocked() const;
 
+        /**
+         * @brief Script and result parts of this tab. Documents of shown pages are written
+         *        to result files named after 'resultPrefix', unless it is empty.
+         */
+        WorkspaceSnapshot::Tab snapshot(const QString &resultPrefix) const;
+
+        // Shows saved parts of tab opened by WorkAreaTabWidget::restoreTab()
+        void restoreSnapshot(const WorkspaceSnapshot::Tab &tab);
+
     Q_SIGNALS:
         void titleChanged(const QString &text);
         void toolTipChanged(const QString &text);
@@ -67,12 +82,19 @@ namespace Robomongo
         void saveToFile();
         void savebToFileAs();
         void openFile();
+        void runFile();
         void textChange();
         void showProgress();
         void hideProgress();
 
         void handle(DocumentListLoadedEvent *event);
+        void handle(DocumentsCountedEvent *event);
+        void handle(PagePrefetchedEvent *event);
+        void handle(AggregatePageResponse *event);
+        void handle(PipelinePreviewResponse *event);
+        void handle(FieldDistributionResponse *event);
         void handle(ScriptExecutedEvent *event);
+        void handle(ExecuteScriptFileProgressEvent *event);
         void handle(AutocompleteResponse *event);
 
     private Q_SLOTS:
@@ -83,8 +105,10 @@ namespace Robomongo
         void dockUndock();         
         void changeShellTimeout();
 
-    private:        
+        // Title and tooltip (with memory of results) of tab
         void updateCurrentTab();
+
+    private:        
         void displayData(const std::vector<MongoShellResult> &results, bool empty);
 
         MongoShell *_shell;
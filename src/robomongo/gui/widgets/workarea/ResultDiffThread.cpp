@@ -0,0 +1,63 @@
+#include "robomongo/gui/widgets/workarea/ResultDiffThread.h"
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <algorithm>
+
+namespace
+{
+    // Upper bound of rows per work item
+    const size_t maxRowsPerChunk = 4096;
+}
+
+namespace Robomongo
+{
+    class ResultDiffThread::CompareChunkTask : public QRunnable
+    {
+    public:
+        CompareChunkTask(ResultDiffThread &owner, size_t first, size_t last) :
+            _owner(owner), _first(first), _last(last) {}
+
+        void run() override
+        {
+            // Chunks write disjoint rows
+            ResultDiff::compare(_owner._left, _owner._right, _owner._rows, _first, _last, &_owner._stop);
+        }
+
+    private:
+        ResultDiffThread &_owner;
+        const size_t _first;
+        const size_t _last;
+    };
+
+    ResultDiffThread::ResultDiffThread(const std::vector<MongoDocumentPtr> &left,
+                                       const std::vector<MongoDocumentPtr> &right) :
+        _left(left),
+        _right(right),
+        _stop(false)
+    {
+    }
+
+    void ResultDiffThread::stop()
+    {
+        _stop = true;
+    }
+
+    void ResultDiffThread::run()
+    {
+        _rows = ResultDiff::align(_left, _right);
+        size_t const count = _rows.size();
+
+        QThreadPool pool;
+        pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
+        size_t const chunkSize = std::max<size_t>(1, std::min(maxRowsPerChunk, count / (pool.maxThreadCount() * 4)));
+        for (size_t first = 0; first < count && !_stop; first += chunkSize)
+            pool.start(new CompareChunkTask(*this, first, std::min(first + chunkSize, count)));
+        pool.waitForDone();
+
+        if (_stop)
+            return;
+
+        emit done();
+    }
+}
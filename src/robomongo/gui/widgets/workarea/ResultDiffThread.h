@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QThread>
+#include <atomic>
+#include <vector>
+
+#include "robomongo/core/Core.h"
+#include "robomongo/core/domain/ResultDiff.h"
+
+namespace Robomongo
+{
+    /*
+    ** In this thread documents of two results are aligned by _id, and paired documents are
+    ** compared in chunks on a thread pool (see ResultDiff). Rows are read with rows() after done().
+    */
+    class ResultDiffThread : public QThread
+    {
+        Q_OBJECT
+
+    public:
+        ResultDiffThread(const std::vector<MongoDocumentPtr> &left, const std::vector<MongoDocumentPtr> &right);
+        void stop();
+
+        const std::vector<ResultDiff::Row> &rows() const { return _rows; }
+
+    Q_SIGNALS:
+        /**
+         * @brief Signals when rows are complete, not emitted if stopped
+         */
+        void done();
+
+    protected:
+        virtual void run();
+
+    private:
+        class CompareChunkTask;
+
+        const std::vector<MongoDocumentPtr> _left;
+        const std::vector<MongoDocumentPtr> _right;
+        std::vector<ResultDiff::Row> _rows;
+        std::atomic<bool> _stop;
+    };
+}
@@ -0,0 +1,88 @@
+#include "robomongo/gui/widgets/workarea/ResultMemoryManager.h"
+
+#include <algorithm>
+#include <QTimer>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/gui/widgets/workarea/OutputItemContentWidget.h"
+
+namespace Robomongo
+{
+    ResultMemoryManager::ResultMemoryManager() :
+        _timer(new QTimer(this)),
+        _isEnforcing(false)
+    {
+        _timer->setSingleShot(true);
+        _timer->setInterval(EnforceDelayMs);
+        VERIFY(connect(_timer, SIGNAL(timeout()), this, SLOT(enforceBudget())));
+    }
+
+    void ResultMemoryManager::add(OutputItemContentWidget *part)
+    {
+        _parts.push_back(part);
+        enforceBudgetLater();
+    }
+
+    void ResultMemoryManager::remove(OutputItemContentWidget *part)
+    {
+        _parts.erase(std::remove(_parts.begin(), _parts.end(), part), _parts.end());
+        enforceBudgetLater();
+    }
+
+    void ResultMemoryManager::touch(OutputItemContentWidget *part)
+    {
+        auto const it = std::find(_parts.begin(), _parts.end(), part);
+        if (it != _parts.end())
+            std::rotate(it, it + 1, _parts.end());
+    }
+
+    void ResultMemoryManager::changed()
+    {
+        // Releasing memory changes footprints too, they are reported once enforcement is done
+        if (!_isEnforcing)
+            enforceBudgetLater();
+    }
+
+    void ResultMemoryManager::enforceBudgetLater()
+    {
+        // Not restarted, so that results streamed for long are not left over budget
+        if (!_timer->isActive())
+            _timer->start();
+    }
+
+    long long ResultMemoryManager::totalBytes() const
+    {
+        long long total = 0;
+        for (OutputItemContentWidget const *part : _parts)
+            total += part->footprintBytes();
+        return total;
+    }
+
+    void ResultMemoryManager::enforceBudget()
+    {
+        long long const budget =
+            AppRegistry::instance().settingsManager()->resultsMemoryBudgetMb() * 1024LL * 1024LL;
+
+        _isEnforcing = true;
+        if (budget > 0) {
+            long long total = totalBytes();
+
+            for (auto it = _parts.begin(); it != _parts.end() && total > budget; ++it) {
+                long long const before = (*it)->footprintBytes();
+                if ((*it)->releaseViews())
+                    total -= before - (*it)->footprintBytes();
+            }
+
+            for (auto it = _parts.begin(); it != _parts.end() && total > budget; ++it) {
+                long long const before = (*it)->footprintBytes();
+                if ((*it)->releaseDocuments())
+                    total -= before - (*it)->footprintBytes();
+            }
+        }
+        _isEnforcing = false;
+
+        emit footprintChanged();
+    }
+}
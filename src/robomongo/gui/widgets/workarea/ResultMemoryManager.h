@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QObject>
+#include <vector>
+
+#include "robomongo/core/utils/SingletonPattern.hpp"
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class OutputItemContentWidget;
+
+    /**
+     * @brief Keeps memory of results of all tabs under SettingsManager::resultsMemoryBudgetMb().
+     *        Parts report changes of their footprint, budget is enforced shortly after (once for
+     *        many changes): first views of hidden parts are released, then documents of hidden
+     *        parts that can be read again with their query. Least recently shown parts go first.
+     *        Use in main thread.
+     */
+    class ResultMemoryManager : public QObject, public Patterns::LazySingleton<ResultMemoryManager>
+    {
+        Q_OBJECT
+        friend class Patterns::LazySingleton<ResultMemoryManager>;
+
+    public:
+        void add(OutputItemContentWidget *part);
+        void remove(OutputItemContentWidget *part);
+
+        // Part was shown, it is released after all other parts
+        void touch(OutputItemContentWidget *part);
+
+        // Footprint of some part changed
+        void changed();
+
+        void enforceBudgetLater();
+        long long totalBytes() const;
+
+    Q_SIGNALS:
+        // Footprint of some parts changed, emitted at most once per enforcement
+        void footprintChanged();
+
+    private Q_SLOTS:
+        void enforceBudget();
+
+    private:
+        ResultMemoryManager();
+
+        static const int EnforceDelayMs = 500;
+
+        std::vector<OutputItemContentWidget *> _parts;  // least recently shown first
+        QTimer *_timer;
+        bool _isEnforcing;
+    };
+}
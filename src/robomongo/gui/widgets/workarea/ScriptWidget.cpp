@@ -1,21 +1,30 @@
 #include "robomongo/gui/widgets/workarea/ScriptWidget.h"
 
+#include <algorithm>
+#include <stdexcept>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QSpinBox>
 #include <QVBoxLayout>
 #include <QKeyEvent>
 #include <QCompleter>
 #include <QStringListModel>
+#include <QTimer>
 #include <Qsci/qscilexerjavascript.h>
 #include <Qsci/qsciscintilla.h>
 
 #include "robomongo/core/domain/MongoShell.h"
+#include "robomongo/core/engine/SyntaxChecker.h"
 #include "robomongo/core/domain/MongoServer.h"
 #include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/shell/bson/json.h"
 
 #include "robomongo/gui/widgets/workarea/IndicatorLabel.h"
 #include "robomongo/gui/widgets/workarea/QueryWidget.h"
 #include "robomongo/gui/GuiRegistry.h"
 #include "robomongo/gui/editors/JSLexer.h"
+#include "robomongo/gui/editors/JsonLexer.h"
 #include "robomongo/gui/editors/FindFrame.h"
 #include "robomongo/gui/editors/PlainJavaScriptEditor.h"
 
@@ -41,6 +50,18 @@ namespace
         return false;
     }
 
+    int const MaxCompletionContextLines = 20;
+
+    // Scripts longer than this are styled by quick JsonLexer. Lexer is switched back for
+    // scripts shorter than half of it, so that it is not switched on every line around limit.
+    int const LargeScriptLines = 10000;
+
+    // Delay after last change of script before its syntax is checked
+    int const SyntaxCheckDelayMs = 400;
+
+    const char *const MaxTimeToolTip = "Server time limit (maxTimeMS) of finds, aggregations and counts of this tab.\n"
+                                       "Server stops the operation once it runs longer.";
+
     bool isForbiddenChar(const QChar &ch)
     {
         return ch == '\"' ||  ch == '\'';
@@ -50,10 +71,14 @@ namespace
 namespace Robomongo
 {
     ScriptWidget::ScriptWidget(MongoShell *shell, QueryWidget *parent) :
+        _javaScriptLexer(NULL),
+        _largeScriptLexer(NULL),
         _shell(shell),
         _parent(parent),
         _textChanged(false),
-        _disableTextAndCursorNotifications(false)
+        _disableTextAndCursorNotifications(false),
+        _syntaxIndicator(0),
+        _syntaxRevision(0)
     {
         setStyleSheet("QFrame {background-color: rgb(255, 255, 255); border: 0px solid #c7c5c4;"
                       "border-radius: 0px; margin: 0px; padding: 0px;}");
@@ -61,6 +86,8 @@ namespace Robomongo
         _queryText = new FindFrame(this);
         _topStatusBar = new TopStatusBar(_shell->server()->connectionRecord()->connectionName(), 
                                          _shell->server()->connectionRecord()->getFullAddress(), "loading...");
+        VERIFY(connect(_topStatusBar, SIGNAL(readPreferenceChanged()), this, SLOT(onReadPreferenceChanged())));
+        VERIFY(connect(_topStatusBar, SIGNAL(maxTimeChanged()), this, SLOT(onMaxTimeChanged())));
 
         QVBoxLayout *layout = new QVBoxLayout;
         layout->setSpacing(0);
@@ -69,6 +96,13 @@ namespace Robomongo
         layout->addWidget(_queryText);
         setLayout(layout);
 
+        _syntaxTimer = new QTimer(this);
+        _syntaxTimer->setSingleShot(true);
+        _syntaxTimer->setInterval(SyntaxCheckDelayMs);
+        VERIFY(connect(_syntaxTimer, SIGNAL(timeout()), this, SLOT(checkSyntax())));
+        VERIFY(connect(&SyntaxChecker::instance(), SIGNAL(checked(QObject *, int, const QString &, int, int)),
+                       this, SLOT(onSyntaxChecked(QObject *, int, const QString &, int, int))));
+
         // Query text widget
         configureQueryText();
         _queryText->sciScintilla()->setFocus();
@@ -91,6 +125,11 @@ namespace Robomongo
         setTextCursor(shell->cursor());
     }
 
+    ScriptWidget::~ScriptWidget()
+    {
+        SyntaxChecker::instance().cancel(this);
+    }
+
     bool ScriptWidget::eventFilter(QObject *obj, QEvent *event)
     {
         if (obj == _queryText->sciScintilla()) {
@@ -163,6 +202,44 @@ namespace Robomongo
         _topStatusBar->setCurrentServer(address, isValid);
     }
 
+    void ScriptWidget::onReadPreferenceChanged()
+    {
+        ReadPreferenceInfo readPreference(_topStatusBar->readPreferenceMode());
+        QString const tags = _topStatusBar->readPreferenceTags().trimmed();
+        if (readPreference.allowsTags() && !tags.isEmpty()) {
+            try {
+                mongo::BSONObj const wrapper = mongo::Robomongo::fromjson(QtUtils::toStdString("{ tags: " + tags + " }"));
+                mongo::BSONElement const tagSets = wrapper["tags"];
+                if (tagSets.type() != mongo::Array)
+                    throw std::runtime_error("Tag sets must be an array of documents");
+                for (mongo::BSONObjIterator it(tagSets.Obj()); it.more();) {
+                    if (it.next().type() != mongo::Object)
+                        throw std::runtime_error("Tag sets must be an array of documents");
+                }
+                readPreference._tags = mongo::BSONArray(tagSets.Obj().getOwned());
+            }
+            catch (const std::exception &ex) {
+                // Previous read preference stays in effect
+                _topStatusBar->setReadPreferenceTagsValid(false, QtUtils::toQString(ex.what()));
+                return;
+            }
+        }
+
+        _topStatusBar->setReadPreferenceTagsValid(true);
+        _shell->setReadPreference(readPreference);
+    }
+
+    void ScriptWidget::onMaxTimeChanged()
+    {
+        _topStatusBar->setMaxTimeExceeded(false);
+        _shell->setMaxTimeMs(_topStatusBar->maxTimeMs());
+    }
+
+    void ScriptWidget::setMaxTimeExceeded(bool exceeded)
+    {
+        _topStatusBar->setMaxTimeExceeded(exceeded);
+    }
+
     void ScriptWidget::showAutocompletion(const QStringList &list, const QString &prefix)
     {
         // do not show single autocompletion which is identical to existing prefix
@@ -207,7 +284,23 @@ namespace Robomongo
             return;
         }
 
-        _shell->autocomplete(QtUtils::toStdString(_currentAutoCompletionInfo.text()));
+        std::string const prefix = QtUtils::toStdString(_currentAutoCompletionInfo.text());
+
+        // Known names are completed in place, shell is asked only for the rest (i.e. variables).
+        // A few previous lines are enough to see which collection is queried.
+        int const row = _currentAutoCompletionInfo.line();
+        QString textBefore;
+        for (int i = std::max(0, row - MaxCompletionContextLines); i < row; ++i)
+            textBefore += _queryText->sciScintilla()->text(i);
+        textBefore += _queryText->sciScintilla()->text(row).left(_currentAutoCompletionInfo.lineIndexLeft());
+
+        QStringList const list = _shell->complete(prefix, QtUtils::toStdString(textBefore));
+        if (!list.isEmpty()) {
+            showAutocompletion(list, _currentAutoCompletionInfo.text());
+            return;
+        }
+
+        _shell->autocomplete(prefix);
     }
 
     void ScriptWidget::hideAutocompletion()
@@ -229,6 +322,8 @@ namespace Robomongo
 
     void ScriptWidget::ui_queryLinesCountChanged()
     {
+        updateLexer();
+
         // Set fixed size only if output widget is docked
         if (_parent->outputWindowDocked())
         {
@@ -255,6 +350,48 @@ namespace Robomongo
         emit textChanged();
         if (!_disableTextAndCursorNotifications)
             _textChanged = true;
+
+        // Error of previous text is hidden until new text is checked
+        ++_syntaxRevision;
+        QsciScintilla *sci = _queryText->sciScintilla();
+        long const length = sci->SendScintilla(QsciScintilla::SCI_GETLENGTH);
+        sci->SendScintilla(QsciScintilla::SCI_SETINDICATORCURRENT, static_cast<unsigned long>(_syntaxIndicator));
+        sci->SendScintilla(QsciScintilla::SCI_INDICATORCLEARRANGE, 0ul, length);
+        sci->setToolTip(QString());
+
+        // Large scripts are not styled as JavaScript either, see updateLexer()
+        if (sci->lines() <= LargeScriptLines)
+            _syntaxTimer->start();
+        else
+            _syntaxTimer->stop();
+    }
+
+    void ScriptWidget::checkSyntax()
+    {
+        SyntaxChecker::instance().check(this, _syntaxRevision, text());
+    }
+
+    void ScriptWidget::onSyntaxChecked(QObject *requester, int revision, const QString &error, int line, int column)
+    {
+        if (requester != this || revision != _syntaxRevision || error.isEmpty())
+            return;
+
+        QsciScintilla *sci = _queryText->sciScintilla();
+        if (line >= sci->lines())
+            return;
+
+        // Column is in characters, Scintilla positions are in bytes of UTF-8.
+        // Rest of line from error position is marked, at least one character.
+        long const length = sci->SendScintilla(QsciScintilla::SCI_GETLENGTH);
+        long const lineStart = sci->SendScintilla(QsciScintilla::SCI_POSITIONFROMLINE, static_cast<unsigned long>(line));
+        long const lineEnd = sci->SendScintilla(QsciScintilla::SCI_GETLINEENDPOSITION, static_cast<unsigned long>(line));
+        long const offset = std::min(lineStart + sci->text(line).left(column).toUtf8().size(),
+                                     std::max(0L, length - 1));
+        sci->SendScintilla(QsciScintilla::SCI_SETINDICATORCURRENT, static_cast<unsigned long>(_syntaxIndicator));
+        sci->SendScintilla(QsciScintilla::SCI_INDICATORFILLRANGE, static_cast<unsigned long>(offset),
+                           std::max(1L, lineEnd - offset));
+
+        sci->setToolTip(QString("Line %1, column %2: %3").arg(line + 1).arg(column + 1).arg(error));
     }
 
     void ScriptWidget::onCursorPositionChanged(int line, int index)
@@ -296,15 +433,17 @@ namespace Robomongo
     */
     void ScriptWidget::configureQueryText()
     {
-        QsciLexerJavaScript *javaScriptLexer = new JSLexer(this);
-        javaScriptLexer->setFont(GuiRegistry::instance().font());
+        _javaScriptLexer = new JSLexer(this);
+        _javaScriptLexer->setFont(GuiRegistry::instance().font());
         int height = editorHeight(1);
         _queryText->sciScintilla()->setMinimumHeight(height);
         _queryText->sciScintilla()->setFixedHeight(height);
         _queryText->sciScintilla()->setAppropriateBraceMatching();
         _queryText->sciScintilla()->setFont(GuiRegistry::instance().font());
         _queryText->sciScintilla()->setPaper(QColor(255, 0, 0, 127));
-        _queryText->sciScintilla()->setLexer(javaScriptLexer);
+        _queryText->sciScintilla()->setLexer(_javaScriptLexer);
+        _syntaxIndicator = _queryText->sciScintilla()->indicatorDefine(QsciScintilla::SquiggleIndicator);
+        _queryText->sciScintilla()->setIndicatorForegroundColor(QColor(Qt::red), _syntaxIndicator);
 
         _queryText->sciScintilla()->setStyleSheet("QFrame { background-color: rgb(73, 76, 78); border: 1px solid #c7c5c4; border-radius: 4px; margin: 0px; padding: 0px;}");
         VERIFY(connect(_queryText->sciScintilla(), SIGNAL(linesChanged()), SLOT(ui_queryLinesCountChanged())));
@@ -312,6 +451,23 @@ namespace Robomongo
         VERIFY(connect(_queryText->sciScintilla(), SIGNAL(cursorPositionChanged(int, int)), SLOT(onCursorPositionChanged(int, int))));
     }
 
+    void ScriptWidget::updateLexer()
+    {
+        int const lines = _queryText->sciScintilla()->lines();
+        QsciLexer *const current = _queryText->sciScintilla()->lexer();
+
+        if (current == _javaScriptLexer && lines > LargeScriptLines) {
+            if (!_largeScriptLexer) {
+                _largeScriptLexer = new JsonLexer(this);
+                _largeScriptLexer->setFont(GuiRegistry::instance().font());
+            }
+            _queryText->sciScintilla()->setLexer(_largeScriptLexer);
+        }
+        else if (current == _largeScriptLexer && lines < LargeScriptLines / 2) {
+            _queryText->sciScintilla()->setLexer(_javaScriptLexer);
+        }
+    }
+
     /**
      * @brief Calculates line height of text editor
      */
@@ -404,6 +560,32 @@ namespace Robomongo
         _currentDatabaseLabel = new Indicator(GuiRegistry::instance().databaseIcon(), 
             QString("<font color='%1'>%2</font>").arg(_textColor.name()).arg(dbName.c_str()));
         _currentDatabaseLabel->setDisabled(true);
+
+        _readPreferenceMode = new QComboBox;
+        _readPreferenceMode->setToolTip("Read preference of scripts and results of this tab.\n"
+                                        "Default reads as shell with rs.slaveOk().");
+        _readPreferenceMode->addItem("Default", ReadPreferenceInfo::Default);
+        for (int mode = ReadPreferenceInfo::Primary; mode <= ReadPreferenceInfo::Nearest; ++mode) {
+            _readPreferenceMode->addItem(
+                ReadPreferenceInfo::modeName(static_cast<ReadPreferenceInfo::Mode>(mode)), mode);
+        }
+
+        _readPreferenceTags = new QLineEdit;
+        _readPreferenceTags->setPlaceholderText("Tag sets, i.e. [ { dc: \"analytics\" } ]");
+        _readPreferenceTags->setMinimumWidth(200);
+        _readPreferenceTags->hide();
+
+        VERIFY(connect(_readPreferenceMode, SIGNAL(currentIndexChanged(int)), this, SLOT(onReadPreferenceModeChanged())));
+        VERIFY(connect(_readPreferenceTags, SIGNAL(editingFinished()), this, SIGNAL(readPreferenceChanged())));
+
+        // Shell timeout only stops script in Robomongo, this limit stops operations on server
+        _maxTime = new QSpinBox;
+        _maxTime->setRange(0, 24 * 60 * 60 * 1000);
+        _maxTime->setSingleStep(1000);
+        _maxTime->setSuffix(" ms");
+        _maxTime->setSpecialValueText("No time limit");
+        _maxTime->setToolTip(MaxTimeToolTip);
+        VERIFY(connect(_maxTime, SIGNAL(editingFinished()), this, SIGNAL(maxTimeChanged())));
         
         QHBoxLayout *topLayout = new QHBoxLayout;
         topLayout->setSpacing(0);
@@ -416,6 +598,9 @@ namespace Robomongo
         topLayout->addWidget(_currentServerLabel, 0, Qt::AlignLeft);
         topLayout->addWidget(_currentDatabaseLabel, 0, Qt::AlignLeft);
         topLayout->addStretch(1);
+        topLayout->addWidget(_maxTime);
+        topLayout->addWidget(_readPreferenceTags);
+        topLayout->addWidget(_readPreferenceMode);
 
         setLayout(topLayout);
     }
@@ -441,4 +626,43 @@ namespace Robomongo
 
         _currentServerLabel->setText(text);
     }
+
+    ReadPreferenceInfo::Mode TopStatusBar::readPreferenceMode() const
+    {
+        return static_cast<ReadPreferenceInfo::Mode>(_readPreferenceMode->currentData().toInt());
+    }
+
+    QString TopStatusBar::readPreferenceTags() const
+    {
+        return _readPreferenceTags->text();
+    }
+
+    void TopStatusBar::setReadPreferenceTagsValid(bool isValid, const QString &error)
+    {
+        _readPreferenceTags->setStyleSheet(isValid ? QString() : QString("QLineEdit { color: red; }"));
+        _readPreferenceTags->setToolTip(error);
+    }
+
+    int TopStatusBar::maxTimeMs() const
+    {
+        return _maxTime->value();
+    }
+
+    void TopStatusBar::setMaxTimeExceeded(bool exceeded)
+    {
+        // Called for every batch of results, style is not reapplied each time
+        if (exceeded == _maxTimeExceeded)
+            return;
+
+        _maxTimeExceeded = exceeded;
+        _maxTime->setStyleSheet(exceeded ? QString("QSpinBox { color: red; }") : QString());
+        _maxTime->setToolTip(exceeded ? QString("The last operation exceeded this limit and was stopped by server.\n\n") + 
+                                        MaxTimeToolTip : QString(MaxTimeToolTip));
+    }
+
+    void TopStatusBar::onReadPreferenceModeChanged()
+    {
+        _readPreferenceTags->setVisible(ReadPreferenceInfo(readPreferenceMode()).allowsTags());
+        emit readPreferenceChanged();
+    }
 }
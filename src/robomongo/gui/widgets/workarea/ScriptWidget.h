@@ -2,8 +2,12 @@
 
 #include <QFrame>
 QT_BEGIN_NAMESPACE
+class QComboBox;
 class QLabel;
+class QLineEdit;
+class QSpinBox;
 class QCompleter;
+class QTimer;
 QT_END_NAMESPACE
 
 #include "robomongo/core/domain/MongoShellResult.h"
@@ -12,6 +16,8 @@ QT_END_NAMESPACE
 namespace Robomongo
 {
     class FindFrame;
+    class JSLexer;
+    class JsonLexer;
     class TopStatusBar;
     class MongoShell;
     class Indicator;
@@ -51,6 +57,7 @@ namespace Robomongo
 
     public:
         ScriptWidget(MongoShell *shell, QueryWidget* parent);
+        ~ScriptWidget();
 
         /**
          * @reimp
@@ -65,6 +72,9 @@ namespace Robomongo
         void setScriptFocus();
         void setCurrentDatabase(const std::string &database, bool isValid = true);
         void setCurrentServer(const std::string &address, bool isValid = true);
+
+        // Shows whether the last operation of tab was stopped by its server time limit
+        void setMaxTimeExceeded(bool exceeded);
         void showAutocompletion(const QStringList &list, const QString &prefix);
         void showAutocompletion();
         void hideAutocompletion();
@@ -84,6 +94,10 @@ namespace Robomongo
         void onTextChanged();
         void onCursorPositionChanged(int line, int index);
         void onCompletionActivated(const QString&);
+        void onReadPreferenceChanged();
+        void onMaxTimeChanged();
+        void checkSyntax();
+        void onSyntaxChecked(QObject *requester, int revision, const QString &error, int line, int column);
 
     private:
         void configureQueryText();
@@ -111,7 +125,13 @@ namespace Robomongo
         int editorHeight(int lines) const;
         
         AutoCompletionInfo sanitizeForAutocompletion();
+
+        // Switches to JsonLexer for scripts longer than LargeScriptLines, and back
+        void updateLexer();
+
         FindFrame *_queryText;
+        JSLexer *_javaScriptLexer;
+        JsonLexer *_largeScriptLexer;   // created for the first large script
         TopStatusBar *_topStatusBar;
         QCompleter *_completer;
         MongoShell *_shell;
@@ -121,6 +141,11 @@ namespace Robomongo
 
         bool _textChanged;
         bool _disableTextAndCursorNotifications;
+
+        // Syntax is checked by SyntaxChecker once user stops typing, error is underlined
+        QTimer *_syntaxTimer;
+        int _syntaxIndicator;
+        int _syntaxRevision;
     };
 
     class TopStatusBar : public QFrame
@@ -134,10 +159,33 @@ namespace Robomongo
         void showProgress();
         void hideProgress();
 
+        ReadPreferenceInfo::Mode readPreferenceMode() const;
+        QString readPreferenceTags() const;
+
+        // Tag sets are shown in red, if they are not valid JSON array of documents
+        void setReadPreferenceTagsValid(bool isValid, const QString &error = QString());
+
+        // Server time limit in milliseconds, 0 for no limit
+        int maxTimeMs() const;
+
+        // Time limit is shown in red while the last operation exceeded it
+        void setMaxTimeExceeded(bool exceeded);
+
+    Q_SIGNALS:
+        void readPreferenceChanged();
+        void maxTimeChanged();
+
+    private Q_SLOTS:
+        void onReadPreferenceModeChanged();
+
     private:
         Indicator *_currentDatabaseLabel;
         Indicator *_currentServerLabel;
         Indicator *_currentConnectionLabel;
+        QComboBox *_readPreferenceMode;
+        QLineEdit *_readPreferenceTags;
+        QSpinBox *_maxTime;
+        bool _maxTimeExceeded = false;
         QColor _textColor;
     };
 }
@@ -0,0 +1,113 @@
+#include "robomongo/gui/widgets/workarea/ViewPreparePool.h"
+
+#include <algorithm>
+#include <QRunnable>
+#include <QThread>
+
+#include "robomongo/core/utils/ThreadPriority.h"
+
+namespace Robomongo
+{
+    class ViewPreparePool::Worker : public QRunnable
+    {
+    public:
+        explicit Worker(ViewPreparePool &owner) : _owner(owner) {}
+
+        void run() override { _owner.work(); }
+
+    private:
+        ViewPreparePool &_owner;
+    };
+
+    ViewPreparePool &ViewPreparePool::instance()
+    {
+        static ViewPreparePool pool;
+        return pool;
+    }
+
+    ViewPreparePool::ViewPreparePool() :
+        _nextOrder(0),
+        _workers(0)
+    {
+        _pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+    }
+
+    void ViewPreparePool::add(const std::shared_ptr<Job> &job, int priority)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.push_back(Entry{ job, priority, _nextOrder++ });
+        startWorkers();
+    }
+
+    void ViewPreparePool::setPriority(const Job *job, int priority)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (Entry &entry : _entries) {
+            if (entry.job.get() == job)
+                entry.priority = priority;
+        }
+        startWorkers();
+    }
+
+    void ViewPreparePool::remove(const Job *job)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.erase(std::remove_if(_entries.begin(), _entries.end(),
+                                      [job](const Entry &entry) { return entry.job.get() == job; }),
+                       _entries.end());
+    }
+
+    std::shared_ptr<ViewPreparePool::Job> ViewPreparePool::nextJob(int *priority) const
+    {
+        const Entry *next = nullptr;
+        for (const Entry &entry : _entries) {
+            if (entry.priority == Suspended)
+                continue;
+
+            if (!next || entry.priority > next->priority ||
+                (entry.priority == next->priority && entry.order < next->order))
+                next = &entry;
+        }
+
+        if (!next)
+            return nullptr;
+
+        *priority = next->priority;
+        return next->job;
+    }
+
+    void ViewPreparePool::startWorkers()
+    {
+        // Workers leave once nothing is scheduled, see work()
+        bool const scheduled = std::any_of(_entries.begin(), _entries.end(),
+                                           [](const Entry &entry) { return entry.priority != Suspended; });
+        if (!scheduled)
+            return;
+
+        for (; _workers < _pool.maxThreadCount(); ++_workers)
+            _pool.start(new Worker(*this));
+    }
+
+    void ViewPreparePool::work()
+    {
+        // Pooled thread goes back to the pool with the priority it came with
+        ThreadPriority::Scope priorityScope(ThreadPriority::current());
+        for (;;) {
+            std::shared_ptr<Job> job;
+            int priority = Background;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                job = nextJob(&priority);
+                if (!job) {
+                    --_workers;
+                    return;
+                }
+            }
+
+            // Parts being looked at are prepared with normal priority, hidden ones yield CPU
+            ThreadPriority::setCurrent(priority == Visible ? ThreadPriority::Normal : ThreadPriority::Background);
+            if (!job->runChunk())
+                remove(job.get());
+        }
+    }
+}
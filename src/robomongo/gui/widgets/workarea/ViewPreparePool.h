@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QThreadPool>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Robomongo
+{
+    /*
+    ** Bounded pool of threads shared by views of all output parts (see JsonPrepareJob). Jobs
+    ** are split into small chunks, and every thread takes the next chunk of the most important
+    ** job when it is free, so parts shown on screen are prepared first, whatever the number of
+    ** parts. One core is left to GUI thread.
+    */
+    class ViewPreparePool
+    {
+    public:
+        enum Priority
+        {
+            Suspended = -1,     // not scheduled, i.e. part is hidden
+            Background = 0,
+            Visible = 1
+        };
+
+        class Job
+        {
+        public:
+            virtual ~Job() {}
+
+            /**
+             * @brief Runs one chunk of work, called from threads of pool (in parallel)
+             * @return false, if there is no chunk left to start
+             */
+            virtual bool runChunk() = 0;
+        };
+
+        static ViewPreparePool &instance();
+
+        // Jobs of the same priority are run in order they were added
+        void add(const std::shared_ptr<Job> &job, int priority);
+        void setPriority(const Job *job, int priority);
+
+        // Chunks already running are not interrupted, job is kept alive until they finish
+        void remove(const Job *job);
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<Job> job;
+            int priority;
+            unsigned long long order;
+        };
+        class Worker;
+
+        ViewPreparePool();
+
+        // Takes job of the next chunk and its priority, called with _mutex locked
+        std::shared_ptr<Job> nextJob(int *priority) const;
+        void startWorkers();
+        void work();
+
+        std::mutex _mutex;
+        std::vector<Entry> _entries;
+        unsigned long long _nextOrder;
+        int _workers;
+
+        // The last one, so that it waits for workers before other members are destroyed
+        QThreadPool _pool;
+    };
+}
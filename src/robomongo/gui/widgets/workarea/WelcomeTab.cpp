@@ -48,8 +48,10 @@ namespace Robomongo {
 #include <QVBoxLayout>
 #include <QPixmap>
 #include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
 #include <QNetworkRequest>
 #include <QNetworkReply>
+#include <QTimer>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
@@ -67,6 +69,7 @@ namespace Robomongo {
 #include "robomongo/gui/MainWindow.h"
 #include "robomongo/core/domain/App.h"
 #include "robomongo/core/EventBus.h"
+#include "robomongo/core/events/MongoEvents.h"
 #include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/utils/Logger.h"       
@@ -77,14 +80,16 @@ namespace Robomongo
 {
     bool deleteOldCacheFile(QString const& absFilePath);
 
-    bool saveIntoCache(QString const& fileName, QString const& fileData,
-                       QString const& lastModifiedKey, QString const& lastModifiedDate);
+    bool saveIntoCache(QString const& fileName, QString const& fileData);
+    bool saveIntoCache(QString const& fileName, QPixmap const& pixMap);
+    bool saveIntoCache(QString const& fileName, QByteArray const& data);
 
-    bool saveIntoCache(QString const& fileName, QPixmap const& pixMap,
-                       QString const& lastModifiedKey, QString const& lastModifiedDate);
-
-    bool saveIntoCache(QString const& fileName, QByteArray* data,
-                       QString const& lastModifiedKey, QString const& lastModifiedDate);
+    // Reply is not modified (HTTP cache answered it) and its file is already in cache dir
+    bool isFromCache(QNetworkReply* reply, QString const& fileName)
+    {
+        return reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool() &&
+               fileExists(CacheDir + fileName);
+    }
 
     /**
     * @brief Container structure to hold data of a blog link
@@ -128,9 +133,12 @@ namespace Robomongo
 
     QString const RssFileName = "rss.xml";
 
-    QString const Text1_LastModifiedDateKey("wtText1LastModifiedDate");
-    QString const Image1_LastModifiedDateKey("wtImage1LastModifiedDate");
-    QString const Rss_LastModifiedDateKey("wtRssLastModifiedDate");
+    // Responses of welcome tab requests, with their ETag and Last-Modified headers
+    QString const HttpCacheDir = CacheDir + "http";
+    qint64 const HttpCacheMaxBytes = 10 * 1024 * 1024;
+
+    int const FetchDelayMs = 30 * 1000;
+    int const RequestTimeoutMs = 15 * 1000;
 
     auto const TEXT_TO_TAB_RATIO = 0.6; 
     auto const IMAGE_TO_TAB_RATIO = 0.25;
@@ -175,22 +183,10 @@ namespace Robomongo
         _blogsHeader->setHidden(true);
         _blogsHeader->setFont(headerFont);
 
-        //// --- Network Access Managers
+        //// --- Network, deferred until the first connection
         if (!AppRegistry::instance().settingsManager()->disableHttpsFeatures()) {
-            auto text1Downloader = new QNetworkAccessManager;
-            VERIFY(connect(text1Downloader, SIGNAL(finished(QNetworkReply*)),
-                this, SLOT(on_downloadTextReply(QNetworkReply*))));
-            text1Downloader->head(QNetworkRequest(_text1_URL));
-
-            auto pic1Downloader = new QNetworkAccessManager;
-            VERIFY(connect(pic1Downloader, SIGNAL(finished(QNetworkReply*)),
-                this, SLOT(on_downloadPictureReply(QNetworkReply*))));
-            pic1Downloader->head(QNetworkRequest(_pic1_URL));
-
-            auto rssDownloader = new QNetworkAccessManager;
-            VERIFY(connect(rssDownloader, SIGNAL(finished(QNetworkReply*)),
-                this, SLOT(on_downloadRssReply(QNetworkReply*))));
-            rssDownloader->get(QNetworkRequest(_rss_URL));
+            AppRegistry::instance().bus()->subscribe(this, ConnectionEstablishedEvent::Type);
+            QTimer::singleShot(FetchDelayMs, this, SLOT(fetch()));
         }
 
         //// --- Layouts
@@ -227,6 +223,8 @@ namespace Robomongo
         mainLayout->setSizeConstraint(QLayout::SetMinimumSize);
 
         setLayout(mainLayout);
+
+        loadFromCache();
     }
 
     WelcomeTab::~WelcomeTab()
@@ -234,151 +232,157 @@ namespace Robomongo
 
     }
 
-    void WelcomeTab::on_downloadTextReply(QNetworkReply* reply)
+    void WelcomeTab::handle(ConnectionEstablishedEvent *)
     {
-        auto hideOrShowWhatsNewHeader = [this]() {
-            if ((!_pic1->pixmap() || _pic1->pixmap()->isNull()) && _whatsNewText->text().isEmpty())
-                _whatsNewHeader->setHidden(true);
-            else 
-                _whatsNewHeader->setVisible(true);
-        };
+        fetch();
+    }
 
-        if (reply->operation() == QNetworkAccessManager::HeadOperation) {
-            if (reply->error() == QNetworkReply::NoError) { // No network error
-                QString const& createDate = reply->header(QNetworkRequest::LastModifiedHeader).toString();
-                if (createDate == AppRegistry::instance().settingsManager()->cacheData(Text1_LastModifiedDateKey)
-                    && fileExists(CacheDir + _text1_URL.fileName()))
-                {
-                    // Load from cache
-                    QFile file(CacheDir + _text1_URL.fileName());
-                    if (!file.open(QFile::ReadOnly | QFile::Text))
-                        return;
-
-                    QTextStream in(&file);
-                    QString str(in.readAll());
-                    setWhatsNewHeaderAndText(str);
-                    hideOrShowWhatsNewHeader();
-                    return;
-                }
-                else {  // Get from internet
-                    reply->manager()->get(QNetworkRequest(_text1_URL));
-                }
-            }
-            else {  // There is a network error 
-                // Load from cache
-                QFile file(CacheDir + _text1_URL.fileName());
-                if (!file.open(QFile::ReadOnly | QFile::Text))
-                    return;
-
-                QTextStream in(&file);
-                QString str(in.readAll());
-                setWhatsNewHeaderAndText(str);
-                hideOrShowWhatsNewHeader();
-                return;
-            }
-        }
-        else if (reply->operation() == QNetworkAccessManager::GetOperation) {
-            // todo: handle get operation fails
-            QString str(QUrl::fromPercentEncoding(reply->readAll()));
-            if (str.isEmpty()) {
-                LOG_MSG("WelcomeTab: Failed to download text file from URL. Reason: " + reply->errorString(),
-                    mongo::logger::LogSeverity::Warning());
-                hideOrShowWhatsNewHeader();
-                return;
-            }
+    void WelcomeTab::fetch()
+    {
+        if (_fetchStarted)
+            return;
 
-            setWhatsNewHeaderAndText(str);
-            hideOrShowWhatsNewHeader();
-            saveIntoCache(_text1_URL.fileName(), str, Text1_LastModifiedDateKey,
-                          reply->header(QNetworkRequest::LastModifiedHeader).toString());
-        }
+        _fetchStarted = true;
+        AppRegistry::instance().bus()->unsubscibe(this);
+
+        // Replies are aborted together with manager, when tab is closed
+        _network = new QNetworkAccessManager(this);
+        auto diskCache = new QNetworkDiskCache(_network);
+        diskCache->setCacheDirectory(HttpCacheDir);
+        diskCache->setMaximumCacheSize(HttpCacheMaxBytes);
+        _network->setCache(diskCache);
+
+        VERIFY(connect(get(_text1_URL), SIGNAL(finished()), this, SLOT(on_downloadTextReply())));
+        VERIFY(connect(get(_pic1_URL), SIGNAL(finished()), this, SLOT(on_downloadPictureReply())));
+        VERIFY(connect(get(_rss_URL), SIGNAL(finished()), this, SLOT(on_downloadRssReply())));
     }
 
-    void WelcomeTab::on_downloadPictureReply(QNetworkReply* reply)
+    QNetworkReply* WelcomeTab::get(QUrl const& url)
     {
-        auto const FIFTY_PERCENT_OF_TAB = _parent->width() * IMAGE_TO_TAB_RATIO;
+        QNetworkRequest request(url);
+        request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferNetwork);
+        request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
 
-        QPixmap image;
-        auto hideOrShowWhatsNewHeader = [this]() {
-            if ((!_pic1->pixmap() || _pic1->pixmap()->isNull()) && _whatsNewText->text().isEmpty())
-                _whatsNewHeader->setHidden(true);
-            else
-                _whatsNewHeader->setVisible(true);
-        };
+        QNetworkReply* reply = _network->get(request);
+        QTimer::singleShot(RequestTimeoutMs, reply, SLOT(abort()));
+        return reply;
+    }
 
-        // Network error, load from cache
-        if (reply->error() != QNetworkReply::NoError) { 
-            image = QPixmap(CacheDir + _pic1_URL.fileName());
-            if (image.isNull())
-                return;
+    void WelcomeTab::loadFromCache()
+    {
+        QFile textFile(CacheDir + _text1_URL.fileName());
+        if (textFile.open(QFile::ReadOnly | QFile::Text))
+            setWhatsNewHeaderAndText(QTextStream(&textFile).readAll());
+
+        setImage(QPixmap(CacheDir + _pic1_URL.fileName()));
 
-            _image = image;
-            _pic1->setPixmap(_image);
+        QFile rssFile(CacheDir + RssFileName);
+        if (rssFile.open(QFile::ReadOnly | QFile::Text))
+            setBlogLinks(rssFile.readAll());
+
+        hideOrShowWhatsNewHeader();
+    }
 
-            if (0 == _image.size().width())
-                return;
+    void WelcomeTab::hideOrShowWhatsNewHeader()
+    {
+        if ((!_pic1->pixmap() || _pic1->pixmap()->isNull()) && _whatsNewText->text().isEmpty())
+            _whatsNewHeader->setHidden(true);
+        else
+            _whatsNewHeader->setVisible(true);
+    }
 
-            _pic1->setFixedSize(FIFTY_PERCENT_OF_TAB, (FIFTY_PERCENT_OF_TAB / _image.size().width()) * _image.size().height());
-            adjustSize();
-            hideOrShowWhatsNewHeader();
+    void WelcomeTab::on_downloadTextReply()
+    {
+        auto reply = qobject_cast<QNetworkReply*>(sender());
+        if (!reply)
             return;
-        }
 
-        // No network error
-        if (reply->operation() == QNetworkAccessManager::HeadOperation) {
-            QString const& createDate = reply->header(QNetworkRequest::LastModifiedHeader).toString();
-            // If the file in URL is not newer load from cache, otherwise get from internet
-            if (createDate == AppRegistry::instance().settingsManager()->cacheData(Image1_LastModifiedDateKey)
-                && fileExists(CacheDir + _pic1_URL.fileName())) 
-            {
-                image = QPixmap(CacheDir + _pic1_URL.fileName());    // Load from cache
-            }
-            else {   // Get from internet
-                reply->manager()->get(QNetworkRequest(_pic1_URL));
-                return;
-            }
+        reply->deleteLater();
+
+        // Cached contents are shown already, nothing to update
+        if (reply->error() != QNetworkReply::NoError) {
+            LOG_MSG("WelcomeTab: Failed to download text file from URL. Reason: " + reply->errorString(),
+                    mongo::logger::LogSeverity::Warning());
+            return;
         }
-        else if (reply->operation() == QNetworkAccessManager::GetOperation) {
-            image.loadFromData(reply->readAll());
 
-            if (image.isNull()) {
-                LOG_MSG("WelcomeTab: Failed to download image file from internet. Reason: " + reply->errorString(),
-                         mongo::logger::LogSeverity::Warning());
-                image = QPixmap(CacheDir + _pic1_URL.fileName());
-            }
-            else {
-                saveIntoCache(_pic1_URL.fileName(), image, Image1_LastModifiedDateKey,
-                              reply->header(QNetworkRequest::LastModifiedHeader).toString());
-            }
+        QString const str(QUrl::fromPercentEncoding(reply->readAll()));
+        if (str.isEmpty())
+            return;
+
+        setWhatsNewHeaderAndText(str);
+        hideOrShowWhatsNewHeader();
+        if (!isFromCache(reply, _text1_URL.fileName()))
+            saveIntoCache(_text1_URL.fileName(), str);
+    }
+
+    void WelcomeTab::on_downloadPictureReply()
+    {
+        auto reply = qobject_cast<QNetworkReply*>(sender());
+        if (!reply)
+            return;
+
+        reply->deleteLater();
+
+        if (reply->error() != QNetworkReply::NoError) {
+            LOG_MSG("WelcomeTab: Failed to download image file from internet. Reason: " + reply->errorString(),
+                    mongo::logger::LogSeverity::Warning());
+            return;
         }
 
-        // Set the image
+        QPixmap image;
+        image.loadFromData(reply->readAll());
         if (image.isNull())
             return;
 
-        _image = image;
+        setImage(image);
+        hideOrShowWhatsNewHeader();
+        if (!isFromCache(reply, _pic1_URL.fileName()))
+            saveIntoCache(_pic1_URL.fileName(), image);
+    }
 
-        if (0 == _image.size().width()) 
-            return
+    void WelcomeTab::on_downloadRssReply()
+    {
+        auto reply = qobject_cast<QNetworkReply*>(sender());
+        if (!reply)
+            return;
 
-        hideOrShowWhatsNewHeader();
+        reply->deleteLater();
+
+        if (reply->error() != QNetworkReply::NoError) {
+            LOG_MSG("WelcomeTab: Failed to download blog feed. Reason: " + reply->errorString(),
+                    mongo::logger::LogSeverity::Warning());
+            return;
+        }
+
+        QByteArray const data = reply->readAll();
+        if (data.isEmpty())
+            return;
+
+        setBlogLinks(data);
+        if (!isFromCache(reply, RssFileName))
+            saveIntoCache(RssFileName, data);
+    }
+
+    void WelcomeTab::setImage(QPixmap const& image)
+    {
+        if (image.isNull() || 0 == image.size().width())
+            return;
+
+        _image = image;
         resize();
     }
 
-    void WelcomeTab::on_downloadRssReply(QNetworkReply* reply)
+    void WelcomeTab::setBlogLinks(QByteArray const& data)
     {
         auto const THIRTY_PERCENT_OF_TAB = _parent->width() * BLOG_TO_TAB_RATIO;
 
-        QByteArray data = reply->readAll();
-        if (data.isEmpty() || reply->error() != QNetworkReply::NoError) {
-            // Load from cache
-            QFile file(CacheDir + RssFileName);
-            if (!file.open(QFile::ReadOnly | QFile::Text))
-                return;
-
-            data = file.readAll();
+        // Links of cached feed are replaced
+        while (QLayoutItem* item = _blogLinksLay->takeAt(0)) {
+            delete item->widget();
+            delete item;
         }
-        
+
         QXmlStreamReader xmlReader(data);
 
         int count = 0;
@@ -418,8 +422,6 @@ namespace Robomongo
         _allBlogsButton->setVisible(true);
         adjustSize();
 
-        // Save into cache
-        saveIntoCache(RssFileName, data, Rss_LastModifiedDateKey, "NotImplemented");    // todo
     }
 
     void WelcomeTab::on_allBlogsButton_clicked()
@@ -497,8 +499,7 @@ namespace Robomongo
         return true;
     }
 
-    bool saveIntoCache(QString const& fileName, QString const& fileData,
-                       QString const& lastModifiedKey, QString const& lastModifiedDate)
+    bool saveIntoCache(QString const& fileName, QString const& fileData)
     {
         if (!QDir(CacheDir).exists())
             QDir().mkdir(CacheDir);
@@ -512,14 +513,10 @@ namespace Robomongo
         QTextStream out(&file);
         out << fileData;
 
-        // Save file's last modified date into settings
-        AppRegistry::instance().settingsManager()->addCacheData(lastModifiedKey, lastModifiedDate);
-        AppRegistry::instance().settingsManager()->save();
         return true;
     }
 
-    bool saveIntoCache(QString const& fileName, QPixmap const& pixMap,
-                       QString const& lastModifiedKey, QString const& lastModifiedDate)
+    bool saveIntoCache(QString const& fileName, QPixmap const& pixMap)
     {
         if (!QDir(CacheDir).exists())
             QDir().mkdir(CacheDir);
@@ -532,14 +529,10 @@ namespace Robomongo
 
         pixMap.save(CacheDir + fileName);
 
-        // Save file's last modified date into settings
-        AppRegistry::instance().settingsManager()->addCacheData(lastModifiedKey, lastModifiedDate);
-        AppRegistry::instance().settingsManager()->save();
         return true;
     }
 
-    bool saveIntoCache(QString const& fileName, QByteArray* data,
-                       QString const& lastModifiedKey, QString const& lastModifiedDate)
+    bool saveIntoCache(QString const& fileName, QByteArray const& data)
     {
         if (!QDir(CacheDir).exists())
             QDir().mkdir(CacheDir);
@@ -550,11 +543,8 @@ namespace Robomongo
         if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
             return false;
 
-        file.write(*data);
+        file.write(data);
 
-        // Save file's last modified date into settings
-        AppRegistry::instance().settingsManager()->addCacheData(lastModifiedKey, lastModifiedDate);
-        AppRegistry::instance().settingsManager()->save();
         return true;
     }
 
@@ -42,6 +42,7 @@ namespace Robomongo
 
 QT_BEGIN_NAMESPACE
 class QPushButton;
+class QNetworkAccessManager;
 class QNetworkReply;
 class QLabel;
 class QVBoxLayout;
@@ -68,14 +69,34 @@ namespace Robomongo
     protected:
         bool eventFilter(QObject *target, QEvent *event) override;
 
+    protected Q_SLOTS:
+        /**
+         * @brief Contents are downloaded after the first connection is established,
+         *        so that they do not compete with it (or after FetchDelayMs without it)
+         */
+        void handle(ConnectionEstablishedEvent *event);
+
     private Q_SLOTS:
-        void on_downloadTextReply(QNetworkReply* reply);
-        void on_downloadPictureReply(QNetworkReply* reply);
-        void on_downloadRssReply(QNetworkReply* reply);
+        void fetch();
+        void on_downloadTextReply();
+        void on_downloadPictureReply();
+        void on_downloadRssReply();
         void on_allBlogsButton_clicked();
 
     private:
+        // Shows contents downloaded by previous sessions, without waiting for network
+        void loadFromCache();
         void setWhatsNewHeaderAndText(QString const& str);
+        void setImage(QPixmap const& image);
+        void setBlogLinks(QByteArray const& rss);
+        void hideOrShowWhatsNewHeader();
+
+        // Request, which is served from HTTP cache (revalidated with If-None-Match or
+        // If-Modified-Since) and aborted after RequestTimeoutMs
+        QNetworkReply* get(QUrl const& url);
+
+        QNetworkAccessManager* _network = nullptr;
+        bool _fetchStarted = false;
 
         QLabel* _pic1 = nullptr;
         QLabel* _blogsSection;
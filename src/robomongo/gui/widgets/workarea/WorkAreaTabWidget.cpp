@@ -1,14 +1,19 @@
 #include "robomongo/gui/widgets/workarea/WorkAreaTabWidget.h"
 
+#include <QDateTime>
+#include <QFileInfo>
 #include <QKeyEvent>
+#include <QMessageBox>
 #include <QScrollArea>
 
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/core/KeyboardManager.h"
+#include "robomongo/core/domain/App.h"
 #include "robomongo/core/domain/MongoShell.h"
 #include "robomongo/core/settings/SettingsManager.h"
 
+#include "robomongo/gui/widgets/workarea/BsonFileWidget.h"
 #include "robomongo/gui/widgets/workarea/WorkAreaTabBar.h"
 #include "robomongo/gui/widgets/workarea/QueryWidget.h"
 #include "robomongo/gui/widgets/workarea/WelcomeTab.h"
@@ -22,7 +27,9 @@ namespace Robomongo
      * @param workAreaWidget: WorkAreaWidget this tab belongs to.
      */
     WorkAreaTabWidget::WorkAreaTabWidget(QWidget *parent) :
-        QTabWidget(parent)
+        QTabWidget(parent),
+        _welcomeTab(nullptr),
+        _welcomeArea(nullptr)
     {
         auto tab = new WorkAreaTabBar(this);
         // This line (setTabBar()) should go before setTabsClosable(true)
@@ -66,20 +73,28 @@ namespace Robomongo
         VERIFY(connect(tab, SIGNAL(closeOtherTabsRequested(int)), SLOT(ui_closeOtherTabsRequested(int))));
         VERIFY(connect(tab, SIGNAL(closeTabsToTheRightRequested(int)), SLOT(ui_closeTabsToTheRightRequested(int))));
 
-        auto scrollArea = new QScrollArea;
-        _welcomeTab = new WelcomeTab(scrollArea);
-        scrollArea->setWidget(_welcomeTab);
-        scrollArea->setBackgroundRole(QPalette::Base);
-        scrollArea->setWidgetResizable(true);
+        // Welcome tab itself (a web view on Windows and macOS) is created after the first frame
+        _welcomeArea = new QScrollArea;
+        _welcomeArea->setBackgroundRole(QPalette::Base);
+        _welcomeArea->setWidgetResizable(true);
 
         if (!AppRegistry::instance().settingsManager()->disableHttpsFeatures()) {
 #ifdef __APPLE__
-            addTab(scrollArea, QIcon(), "Welcome");
+            addTab(_welcomeArea, QIcon(), "Welcome");
 #else
-            addTab(scrollArea, GuiRegistry::instance().welcomeTabIcon(), "Welcome");
+            addTab(_welcomeArea, GuiRegistry::instance().welcomeTabIcon(), "Welcome");
 #endif        
         }
-        scrollArea->setFrameShape(QFrame::NoFrame);
+        _welcomeArea->setFrameShape(QFrame::NoFrame);
+    }
+
+    void WorkAreaTabWidget::createWelcomeTab()
+    {
+        if (_welcomeTab)
+            return;
+
+        _welcomeTab = new WelcomeTab(_welcomeArea);
+        _welcomeArea->setWidget(_welcomeTab);
     }
 
     void WorkAreaTabWidget::closeTab(int index)
@@ -87,8 +102,10 @@ namespace Robomongo
         if (index >= 0)
         {
             QueryWidget *tabWidget = queryWidget(index);
+            auto fileWidget = qobject_cast<BsonFileWidget*>(widget(index));
             removeTab(index);
             delete tabWidget;
+            delete fileWidget;
         }
     }
 
@@ -140,10 +157,7 @@ namespace Robomongo
 
     void WorkAreaTabWidget::openWelcomeTab()
     {
-        auto scrollArea = qobject_cast<QScrollArea*>(_welcomeTab->getParent());
-        if (!scrollArea)
-            return;
-
+        auto scrollArea = _welcomeArea;
         _welcomeTab = new WelcomeTab(scrollArea);
         scrollArea->setWidget(_welcomeTab);
         scrollArea->setBackgroundRole(QPalette::Base);
@@ -164,6 +178,47 @@ namespace Robomongo
         setCurrentIndex(indexOf(scrollArea));
     }
 
+    void WorkAreaTabWidget::openBsonFile(const QString &filePath)
+    {
+        BsonFileWidget *fileWidget = nullptr;
+        try {
+            fileWidget = new BsonFileWidget(filePath, this);
+        }
+        catch (const std::exception &ex) {
+            QMessageBox::warning(this, "Open BSON File", QtUtils::toQString(ex.what()));
+            return;
+        }
+
+        addTab(fileWidget, QFileInfo(filePath).fileName());
+        setTabToolTip(count() - 1, filePath);
+        setCurrentIndex(count() - 1);
+    }
+
+    void WorkAreaTabWidget::saveWorkspace(bool withResults, const std::vector<WorkspaceSnapshot::Tab> &pendingTabs)
+    {
+        // Result files of each save are new, previous ones may still be mapped by restored parts
+        QString const stamp = QString::number(QDateTime::currentMSecsSinceEpoch());
+        std::vector<WorkspaceSnapshot::Tab> tabs;
+        for (int i = 0; i < count(); ++i) {
+            if (QueryWidget *query = queryWidget(i))
+                tabs.push_back(query->snapshot(withResults ? QString("%1-%2").arg(stamp).arg(i) : QString()));
+        }
+        tabs.insert(tabs.end(), pendingTabs.begin(), pendingTabs.end());
+        WorkspaceSnapshot::save(tabs);
+    }
+
+    void WorkAreaTabWidget::restoreTab(MongoServer *server, const WorkspaceSnapshot::Tab &tab)
+    {
+        // Tab is added synchronously by handle(OpeningShellEvent*)
+        int const tabCount = count();
+        AppRegistry::instance().app()->openShell(server, QtUtils::toQString(tab.script), tab.database, false,
+                                                 QtUtils::toQString(tab.title), CursorPosition(), tab.filePath);
+        if (count() > tabCount) {
+            if (QueryWidget *query = queryWidget(count() - 1))
+                query->restoreSnapshot(tab);
+        }
+    }
+
     /**
      * @brief Overrides QTabWidget::keyPressEvent() in order to intercept
      * tab close key shortcuts (Ctrl+F4 and Ctrl+W)
@@ -1,9 +1,15 @@
 #pragma once
 
 #include <QTabWidget>
+QT_BEGIN_NAMESPACE
+class QScrollArea;
+QT_END_NAMESPACE
+
+#include "robomongo/core/domain/WorkspaceSnapshot.h"
 
 namespace Robomongo
 {
+    class MongoServer;
     class QueryWidget;
     class OpeningShellEvent;
     class WelcomeTab;
@@ -28,9 +34,28 @@ namespace Robomongo
 
         QueryWidget *currentQueryWidget();
         QueryWidget *queryWidget(int index);
-        WelcomeTab *getWelcomeTab();
+        WelcomeTab *getWelcomeTab();   // null until createWelcomeTab()
+        void createWelcomeTab();
         void openWelcomeTab();
 
+        /**
+         * @brief Opens mongodump file in new tab, see BsonFileWidget
+         */
+        void openBsonFile(const QString &filePath);
+
+        /**
+         * @brief Writes query tabs to WorkspaceSnapshot, with documents of their shown
+         *        pages if 'withResults' is set. Saved tabs not restored yet (their server
+         *        was not connected) are kept after the open ones.
+         */
+        void saveWorkspace(bool withResults, const std::vector<WorkspaceSnapshot::Tab> &pendingTabs);
+
+        /**
+         * @brief Opens saved tab on connected 'server', its parts are shown from snapshot
+         *        without running the script
+         */
+        void restoreTab(MongoServer *server, const WorkspaceSnapshot::Tab &tab);
+
     public Q_SLOTS:
         void handle(OpeningShellEvent *event);
         void tabBar_tabCloseRequested(int index);
@@ -54,5 +79,6 @@ namespace Robomongo
 
     private:
         WelcomeTab* _welcomeTab;
+        QScrollArea* _welcomeArea;
     };
 }
@@ -35,6 +35,14 @@
 
 #include <cstdint>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ROBOMONGO_JSON_SSE2 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
 #include "mongo/base/parse_number.h"
 #include "mongo/bson/json.h"
 #include "mongo/db/jsobj.h"
@@ -72,8 +80,8 @@ enum {
     ID_RESERVE_SIZE = 64,
     PAT_RESERVE_SIZE = 4096,
     OPT_RESERVE_SIZE = 64,
-    FIELD_RESERVE_SIZE = 4096,
-    STRINGVAL_RESERVE_SIZE = 4096,
+    FIELD_RESERVE_SIZE = 64,        // heap allocation per field and string value, if bigger
+    STRINGVAL_RESERVE_SIZE = 64,
     BINDATA_RESERVE_SIZE = 4096,
     BINDATATYPE_RESERVE_SIZE = 4096,
     NS_RESERVE_SIZE = 64,
@@ -87,6 +95,95 @@ static const char* LBRACE = "{", * RBRACE = "}", * LBRACKET = "[", * RBRACKET =
                    * RPAREN = ")", * COLON = ":", * COMMA = ",", * FORWARDSLASH = "/",
                    * SINGLEQUOTE = "'", * DOUBLEQUOTE = "\"";
 
+namespace {
+
+// Character classes of the C locale, without calls of isspace()/strchr() per character
+enum : unsigned char { WHITESPACE_CLASS = 1, FIELD_CLASS = 2 };
+
+struct CharClasses {
+    unsigned char classes[256];
+
+    CharClasses() : classes() {
+        for (const char* c = " \t\n\v\f\r"; *c; ++c)
+            classes[static_cast<unsigned char>(*c)] |= WHITESPACE_CLASS;
+        for (const char* c = ALPHA DIGIT "_$"; *c; ++c)
+            classes[static_cast<unsigned char>(*c)] |= FIELD_CLASS;
+    }
+
+    bool is(char c, unsigned char charClass) const {
+        return (classes[static_cast<unsigned char>(c)] & charClass) != 0;
+    }
+};
+
+const CharClasses charClasses;
+
+#ifdef ROBOMONGO_JSON_SSE2
+inline int firstSetBit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+/**
+ * @return the first character in [p, end) which is not whitespace, or end.
+ * Indentation of pretty printed JSON is skipped 16 characters at a time.
+ */
+inline const char* skipWhitespace(const char* p, const char* end) {
+#ifdef ROBOMONGO_JSON_SSE2
+    if (end - p >= 16 && charClasses.is(*p, WHITESPACE_CLASS)) {
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i rangeSize = _mm_set1_epi8('\r' - '\t');
+        for (; end - p >= 16; p += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            // '\t' <= c <= '\r' as unsigned (c - '\t') <= 4
+            const __m128i offset = _mm_sub_epi8(chunk, tab);
+            const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(offset, rangeSize), offset);
+            const __m128i whitespace = _mm_or_si128(control, _mm_cmpeq_epi8(chunk, space));
+            const unsigned other = ~static_cast<unsigned>(_mm_movemask_epi8(whitespace)) & 0xFFFF;
+            if (other != 0)
+                return p + firstSetBit(other);
+        }
+    }
+#endif
+    while (p < end && charClasses.is(*p, WHITESPACE_CLASS))
+        ++p;
+    return p;
+}
+
+/**
+ * @return the first character in [p, end) which ends plain part of quoted string:
+ * 'quote', backslash or control character (0x00 - 0x1F), or end.
+ */
+inline const char* findStringSpecial(const char* p, const char* end, char quote) {
+#ifdef ROBOMONGO_JSON_SSE2
+    const __m128i quotes = _mm_set1_epi8(quote);
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i maxControl = _mm_set1_epi8(0x1F);
+    for (; end - p >= 16; p += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, maxControl), chunk);
+        const __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quotes), _mm_cmpeq_epi8(chunk, backslash)), control);
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0)
+            return p + firstSetBit(mask);
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == quote || *p == '\\' || static_cast<unsigned char>(*p) <= 0x1F)
+            return p;
+    }
+    return end;
+}
+
+}  // namespace
+
 JParse::JParse(StringData str)
     : _buf(str.rawData()), _input(_buf), _input_end(_input + str.size()) {}
 
@@ -105,6 +202,16 @@ Status JParse::parseError(StringData msg) {
 
 Status JParse::value(StringData fieldName, BSONObjBuilder& builder) {
     MONGO_JSON_DEBUG("fieldName: " << fieldName);
+    // Numbers and strings, the most common values, do not need to be tried against every keyword
+    _input = skipWhitespace(_input, _input_end);
+    if (_input < _input_end) {
+        const char c = *_input;
+        const bool minusInfinity = c == '-' && _input + 1 < _input_end && _input[1] == 'I';
+        if ((c >= '0' && c <= '9') || c == '.' || c == '+' || (c == '-' && !minusInfinity)) {
+            return number(fieldName, builder);
+        }
+    }
+
     if (peekToken(LBRACE)) {
         Status ret = object(fieldName, builder);
         if (ret != Status::OK()) {
@@ -851,15 +958,10 @@ Status JParse::date(StringData fieldName, BSONObjBuilder& builder) {
         //    return parseError("Invalid date format");
         // }
 
-        bool isSuccessfull = false;
-        boost::posix_time::ptime isotime = miutil::ptimeFromIsoString(datestr, isSuccessfull);
-        if (!isSuccessfull) {
+        long long millis = 0;
+        if (!miutil::isoDateToMillis(datestr, millis)) {
             return parseError("Invalid date format");
         }
-
-        boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
-        boost::posix_time::time_duration diff = isotime - epoch;
-        int64_t millis = diff.total_milliseconds();
         Date_t datet = Date_t::fromMillisSinceEpoch(millis);
 
         if (!readToken(RPAREN)) {
@@ -1200,19 +1302,24 @@ Status JParse::field(std::string* result) {
         return quotedString(result);
     } else {
         // Unquoted key
-        // 'isspace()' takes an 'int' (signed), so (default signed) 'char's get sign-extended
-        // and therefore 'corrupted' unless we force them to be unsigned ... 0x80 becomes
-        // 0xffffff80 as seen by isspace when sign-extended ... we want it to be 0x00000080
-        while (_input < _input_end && isspace(*reinterpret_cast<const unsigned char*>(_input))) {
-            ++_input;
-        }
+        _input = skipWhitespace(_input, _input_end);
         if (_input >= _input_end) {
             return parseError("Field name expected");
         }
         if (!match(*_input, ALPHA "_$")) {
             return parseError("First character in field must be [A-Za-z$_]");
         }
-        return chars(result, "", ALPHA DIGIT "_$");
+        // Same as chars(result, "", ALPHA DIGIT "_$")
+        const char* q = _input;
+        while (q < _input_end && charClasses.is(*q, FIELD_CLASS)) {
+            ++q;
+        }
+        if (q >= _input_end) {
+            return parseError("Unexpected end of input");
+        }
+        result->append(_input, q - _input);
+        _input = q;
+        return Status::OK();
     }
 }
 
@@ -1250,8 +1357,19 @@ Status JParse::chars(std::string* result, const char* terminalSet, const char* a
         return parseError("Unexpected end of input");
     }
     const char* q = _input;
+    // Quoted strings and regex patterns end with one character, plain characters
+    // up to it (or to escape sequence or control character) are copied at once
+    const char terminal = terminalSet[0] != '\0' && terminalSet[1] == '\0' ? terminalSet[0] : '\0';
     while (q < _input_end && !match(*q, terminalSet)) {
         MONGO_JSON_DEBUG("q: " << q);
+        if (allowedSet == NULL && terminal != '\0') {
+            const char* const special = findStringSpecial(q, _input_end, terminal);
+            if (special != q) {
+                result->append(q, special - q);
+                q = special;
+                continue;
+            }
+        }
         if (allowedSet != NULL) {
             if (!match(*q, allowedSet)) {
                 _input = q;
@@ -1373,12 +1491,7 @@ bool JParse::readTokenImpl(const char* token, bool advance) {
     if (token == NULL) {
         return false;
     }
-    // 'isspace()' takes an 'int' (signed), so (default signed) 'char's get sign-extended
-    // and therefore 'corrupted' unless we force them to be unsigned ... 0x80 becomes
-    // 0xffffff80 as seen by isspace when sign-extended ... we want it to be 0x00000080
-    while (check < _input_end && isspace(*reinterpret_cast<const unsigned char*>(check))) {
-        ++check;
-    }
+    check = skipWhitespace(check, _input_end);
     while (*token != '\0') {
         if (check >= _input_end) {
             return false;
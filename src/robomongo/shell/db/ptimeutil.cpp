@@ -26,9 +26,13 @@
     MA  02110-1301, USA
 */
 #include "ptimeutil.h"
+#include <atomic>
+#include <climits>
+#include <ctime>
 #include <ctype.h>
 #include <iostream>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 //#include <trimstr.h>
 #include <sstream>
@@ -50,6 +54,137 @@ namespace
         }
         return atoi( buf );
     }
+
+    const long long millisPerDay = 86400000LL;
+
+    // "00" - "99", formatted two digits at a time
+    struct TwoDigits
+    {
+        char digits[200];
+
+        TwoDigits()
+        {
+            for (int i = 0; i < 100; ++i) {
+                digits[2 * i] = static_cast<char>('0' + i / 10);
+                digits[2 * i + 1] = static_cast<char>('0' + i % 10);
+            }
+        }
+
+        char *put(char *out, int value) const
+        {
+            memcpy(out, digits + 2 * value, 2);
+            return out + 2;
+        }
+    };
+
+    const TwoDigits twoDigits;
+
+    const unsigned char daysInMonth[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+    bool isLeapYear(int year)
+    {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    }
+
+    // Days since 1970-01-01 of proleptic Gregorian date and back, see
+    // http://howardhinnant.github.io/date_algorithms.html
+    long long daysFromCivil(long long year, unsigned month, unsigned day)
+    {
+        year -= month <= 2;
+        long long const era = (year >= 0 ? year : year - 399) / 400;
+        unsigned const yearOfEra = static_cast<unsigned>(year - era * 400);
+        unsigned const dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        unsigned const dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + static_cast<long long>(dayOfEra) - 719468;
+    }
+
+    void civilFromDays(long long days, int &year, int &month, int &day)
+    {
+        days += 719468;
+        long long const era = (days >= 0 ? days : days - 146096) / 146097;
+        unsigned const dayOfEra = static_cast<unsigned>(days - era * 146097);
+        unsigned const yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        unsigned const dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        unsigned const monthIndex = (5 * dayOfYear + 2) / 153;    // from March
+        day = static_cast<int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+        month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+        year = static_cast<int>(yearOfEra + era * 400 + (month <= 2));
+    }
+
+    // Reads exactly 'count' digits
+    bool readDigits(const char *&p, const char *end, int count, int &value)
+    {
+        if (end - p < count)
+            return false;
+
+        value = 0;
+        for (int i = 0; i < count; ++i, ++p) {
+            if (*p < '0' || *p > '9')
+                return false;
+            value = value * 10 + (*p - '0');
+        }
+        return true;
+    }
+
+    bool readChar(const char *&p, const char *end, char c)
+    {
+        if (p == end || *p != c)
+            return false;
+        ++p;
+        return true;
+    }
+
+    // YYYY-MM-DD[(T| )hh:mm:ss[.mmm]][Z|ShhMM|Shh:MM|Shh]
+    bool parseIsoDate(const char *p, const char *end, long long &millis)
+    {
+        int year, month, day, hour = 0, minute = 0, second = 0, millisecond = 0;
+        if (!readDigits(p, end, 4, year) || !readChar(p, end, '-') || !readDigits(p, end, 2, month) ||
+            !readChar(p, end, '-') || !readDigits(p, end, 2, day))
+            return false;
+
+        // Years boost::gregorian::date does not support are left to ptimeFromIsoString()
+        if (year < 1400 || month < 1 || month > 12)
+            return false;
+        int const monthDays = daysInMonth[month - 1] + (month == 2 && isLeapYear(year) ? 1 : 0);
+        if (day < 1 || day > monthDays)
+            return false;
+
+        if (p != end && (*p == 'T' || *p == ' ')) {
+            ++p;
+            if (!readDigits(p, end, 2, hour) || !readChar(p, end, ':') || !readDigits(p, end, 2, minute) ||
+                !readChar(p, end, ':') || !readDigits(p, end, 2, second))
+                return false;
+            if (hour > 23 || minute > 59 || second > 59)
+                return false;
+            if (p != end && *p == '.' && !readDigits(++p, end, 3, millisecond))
+                return false;
+        }
+
+        int offsetMinutes = 0;
+        if (p != end && *p == 'Z') {
+            ++p;
+        }
+        else if (p != end && (*p == '+' || *p == '-')) {
+            int const sign = *p++ == '-' ? -1 : 1;
+            int offsetHours, offsetMins = 0;
+            if (!readDigits(p, end, 2, offsetHours))
+                return false;
+            if (p != end) {
+                readChar(p, end, ':');
+                if (!readDigits(p, end, 2, offsetMins))
+                    return false;
+            }
+            offsetMinutes = sign * (offsetHours * 60 + offsetMins);
+        }
+
+        if (p != end)
+            return false;
+
+        long long const days = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+        millis = days * millisPerDay + ((hour * 60LL + minute) * 60 + second) * 1000 + millisecond -
+                 offsetMinutes * 60000LL;
+        return true;
+    }
 }
 namespace miutil 
 {
@@ -203,81 +338,106 @@ namespace miutil
         if( pt.is_special() )
             return "";
 
-        char buf[64]={0};
-        char sep=' '; 
-
-        if( useTseparator )
-            sep = 'T';
+        boost::posix_time::ptime const epoch(boost::gregorian::date(1970, 1, 1));
+        std::string result;
+        appendIsoDate(result, (pt - epoch).total_milliseconds(), useTseparator, isLocalFormat);
+        return result;
+    }
 
-        boost::gregorian::date d( pt.date() );
-        boost::posix_time::time_duration t( pt.time_of_day() );
+    int localUtcOffsetMinutes()
+    {
+        static std::atomic<long long> cachedAt { LLONG_MIN };
+        static std::atomic<int> cachedOffset { 0 };
+
+        time_t const now = time(NULL);
+        if (cachedAt == now)
+            return cachedOffset;
+
+        struct tm local;
+#ifdef _WIN32
+        localtime_s(&local, &now);
+#else
+        localtime_r(&now, &local);
+#endif
+        // Local wall clock time read as UTC, minus UTC
+        long long const localSeconds =
+            daysFromCivil(local.tm_year + 1900LL, local.tm_mon + 1, local.tm_mday) * 86400 +
+            local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec;
+        int const offset = static_cast<int>((localSeconds - static_cast<long long>(now)) / 60);
+
+        cachedOffset = offset;
+        cachedAt = now;
+        return offset;
+    }
 
-        if( !isLocalFormat ){
-#if defined(__clang__) 
-#pragma clang diagnostic push    
-#pragma clang diagnostic ignored "-Wformat"
-#elif defined(__GNUG__)  // gcc
-#pragma GCC diagnostic push    
-#pragma GCC diagnostic ignored "-Wformat"
-#endif                    
-            sprintf( buf, "%04d-%02d-%02d%c%02d:%02d:%02d.%03dZ", 
-                static_cast<int>(d.year()), d.month().as_number(), d.day().as_number(), sep,
-                t.hours(), t.minutes(), t.seconds(), (static_cast<int>(t.total_milliseconds()))%1000 );
-#if defined(__clang__) 
-#pragma clang diagnostic pop
-#elif defined(__GNUG__)  // gcc
-#pragma GCC diagnostic pop
-#endif                         
+    void appendIsoDate(std::string &out, long long millis, bool useTseparator, bool isLocalFormat)
+    {
+        int const offset = isLocalFormat ? localUtcOffsetMinutes() : 0;
+        long long const local = millis + offset * 60000LL;
+        long long days = local / millisPerDay;
+        long long msOfDay = local % millisPerDay;
+        if (msOfDay < 0) {
+            msOfDay += millisPerDay;
+            --days;
         }
-        else{
-            boost::posix_time::ptime timeP(d, t);
-            time_t rawtime;
-            time ( &rawtime );
 
-            struct tm *ptm = std::gmtime ( &rawtime );
-            int utcD = ptm->tm_mday;
-            int utcH = ptm->tm_hour;
-            int utcM = ptm->tm_min;
+        int year, month, day;
+        civilFromDays(days, year, month, day);
 
-            struct tm *timeinfo = std::localtime (&rawtime);
-            int diffH = timeinfo->tm_hour - utcH;
-            
-            // Time zone calculation
-            if (timeinfo->tm_mday < utcD && diffH > 0)
-                diffH -= 24;
-            else if (timeinfo->tm_mday > utcD && diffH < 0)
-                diffH += 24;
+        int const ms = static_cast<int>(msOfDay % 1000);
+        int const secondsOfDay = static_cast<int>(msOfDay / 1000);
 
-            int diffM = timeinfo->tm_min - utcM;
-
-            boost::posix_time::time_duration diffT = boost::posix_time::time_duration(diffH, diffM, 0);
-            timeP += diffT;
+        // YYYY-MM-DDThh:mm:ss.mmm+hh:mm
+        char buf[40];
+        char *p = buf;
+        if (year >= 0 && year <= 9999) {
+            p = twoDigits.put(p, year / 100);
+            p = twoDigits.put(p, year % 100);
+        }
+        else {
+            p += snprintf(p, 12, "%d", year);
+        }
+        *p++ = '-';
+        p = twoDigits.put(p, month);
+        *p++ = '-';
+        p = twoDigits.put(p, day);
+        *p++ = useTseparator ? 'T' : ' ';
+        p = twoDigits.put(p, secondsOfDay / 3600);
+        *p++ = ':';
+        p = twoDigits.put(p, secondsOfDay / 60 % 60);
+        *p++ = ':';
+        p = twoDigits.put(p, secondsOfDay % 60);
+        *p++ = '.';
+        *p++ = static_cast<char>('0' + ms / 100);
+        p = twoDigits.put(p, ms % 100);
+
+        if (!isLocalFormat) {
+            *p++ = 'Z';
+        }
+        else {
+            int const absOffset = abs(offset);
+            *p++ = offset < 0 ? '-' : '+';
+            p = twoDigits.put(p, absOffset / 60 % 100);
+            *p++ = ':';
+            p = twoDigits.put(p, absOffset % 60);
+        }
 
-            d = timeP.date();
-            t = timeP.time_of_day();
+        out.append(buf, p - buf);
+    }
 
-            char utc_buff[8]={0};
+    bool isoDateToMillis(const std::string &isoTime, long long &millis)
+    {
+        if (parseIsoDate(isoTime.data(), isoTime.data() + isoTime.size(), millis))
+            return true;
 
-#if defined(__clang__) 
-#pragma clang diagnostic push    
-#pragma clang diagnostic ignored "-Wformat"
-#elif defined(__GNUG__)  // gcc
-#pragma GCC diagnostic push    
-#pragma GCC diagnostic ignored "-Wformat"
-#endif              
-            sprintf(utc_buff, (diffT.hours() >= 0) ? "+%02d:%02d" : "%03d:%02d", diffT.hours(), abs(diffM));
-            sprintf(buf, "%04d-%02d-%02d%c%02d:%02d:%02d.%03d",
-                static_cast<int>(d.year()), d.month().as_number(), d.day().as_number(), sep,
-                t.hours(), t.minutes(), t.seconds(), (static_cast<int>(t.total_milliseconds()))%1000);
-#if defined(__clang__) 
-#pragma clang diagnostic pop
-#elif defined(__GNUG__)  // gcc
-#pragma GCC diagnostic pop
-#endif                         
-            strcat(buf, utc_buff);
-        }
+        bool isSuccessfull = false;
+        boost::posix_time::ptime const pt = ptimeFromIsoString(isoTime, isSuccessfull);
+        if (!isSuccessfull || pt.is_special())
+            return false;
 
-        return buf;   
+        boost::posix_time::ptime const epoch(boost::gregorian::date(1970, 1, 1));
+        millis = (pt - epoch).total_milliseconds();
+        return true;
     }
 
     boost::posix_time::ptime ptimeFromIsoString( const std::string &isoTime)
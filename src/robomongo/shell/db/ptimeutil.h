@@ -121,6 +121,33 @@ namespace miutil {
     */
    boost::posix_time::ptime ptimeFromIsoString( const std::string &isoTime);
    boost::posix_time::ptime ptimeFromIsoString( const std::string &isoTime, bool &isSuccessfull);
+
+   /**
+    * localUtcOffsetMinutes returns UTC offset of the local time zone at the current
+    * time, as used by isotimeString() with isLocalFormat. It is computed at most once
+    * a second, so all dates of a result set are formatted with one localtime() call.
+    */
+   int localUtcOffsetMinutes();
+
+   /**
+    * appendIsoDate appends milliseconds since epoch to \em out in the format of
+    * isotimeString(), without boost, stdio or locale:
+    *
+    *  - YYYY-MM-DDThh:mm:ss.mmmZ
+    *  - YYYY-MM-DDThh:mm:ss.mmm+hh:mm   (isLocalFormat)
+    *
+    * @param useTseparator is true if we want the datepart and timepart separated with a T.
+    */
+   void appendIsoDate(std::string &out, long long millis, bool useTseparator=false, bool isLocalFormat=false);
+
+   /**
+    * isoDateToMillis decodes YYYY-MM-DD[Thh:mm:ss[.mmm]][Z|ShhMM|Shh:MM] directly and
+    * other formats accepted by ptimeFromIsoString() through it.
+    *
+    * @param millis Milliseconds since epoch, on success.
+    * @return false if the timestring is invalid.
+    */
+   bool isoDateToMillis(const std::string &isoTime, long long &millis);
    
 }
 #endif 
@@ -55,3 +55,25 @@ int rbm_array_remove(void ***array, int *currentsize, void *data) {
 
     return RBM_ERROR;
 }
+
+/*
+ * Doubles size of the buffer, up to RBM_BUFSIZE_MAX. Content of buffer is preserved.
+ * Returns RBM_ERROR if buffer already has maximum size or memory cannot be allocated,
+ * buffer and size are not modified in this case.
+ */
+int rbm_buffer_grow(char **buffer, int *size) {
+    if (*size >= RBM_BUFSIZE_MAX)
+        return RBM_ERROR;
+
+    int newsize = *size * 2;
+    if (newsize > RBM_BUFSIZE_MAX)
+        newsize = RBM_BUFSIZE_MAX;
+
+    char *newbuffer = realloc(*buffer, newsize);
+    if (!newbuffer)
+        return RBM_ERROR;
+
+    *buffer = newbuffer;
+    *size = newsize;
+    return RBM_SUCCESS;
+}
@@ -0,0 +1,277 @@
+#include "robomongo/ssh/private.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#elif defined(__linux__)
+#include <sys/epoll.h>
+#include <poll.h>
+#include <unistd.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/time.h>
+#include <poll.h>
+#include <unistd.h>
+#define RBM_POLLER_KQUEUE
+#else
+#include <poll.h>
+#endif
+
+#if defined(__linux__)
+#define RBM_POLLER_EPOLL
+#endif
+
+#ifdef _WIN32
+typedef WSAPOLLFD rbm_pollfd;
+#define rbm_poll WSAPoll
+#else
+typedef struct pollfd rbm_pollfd;
+#define rbm_poll poll
+#endif
+
+#include <stdlib.h>
+#include <errno.h>
+
+/*
+ * Readiness notification for sockets of the tunnel.
+ *
+ * Backend is chosen at compile time: epoll on Linux, kqueue on macOS and BSD,
+ * WSAPoll on Windows (and poll() on other systems). All of them are used in
+ * level-triggered mode, so sockets that still have unread data are reported
+ * again on the next rbm_poller_wait().
+ */
+struct rbm_poller {
+    rbm_socket_t *sockets;  // registered sockets
+    int count;
+    int capacity;
+
+#if defined(RBM_POLLER_EPOLL)
+    int epollfd;
+    struct epoll_event *events;
+#elif defined(RBM_POLLER_KQUEUE)
+    int kqueuefd;
+    struct kevent *events;
+#else
+    rbm_pollfd *fds;        // rebuilt from "sockets" when registration changes
+    int fdsdirty;
+#endif
+};
+
+static int rbm_poller_index(struct rbm_poller *poller, rbm_socket_t socket) {
+    for (int i = 0; i < poller->count; i++)
+        if (poller->sockets[i] == socket)
+            return i;
+
+    return -1;
+}
+
+// Returns NULL on error
+struct rbm_poller *rbm_poller_create() {
+    struct rbm_poller *poller = malloc(sizeof(struct rbm_poller));
+    if (!poller)
+        return NULL;
+
+    poller->sockets = NULL;
+    poller->count = 0;
+    poller->capacity = 0;
+
+#if defined(RBM_POLLER_EPOLL)
+    poller->events = NULL;
+    poller->epollfd = epoll_create(16); // size is ignored, but must be positive
+    if (poller->epollfd == -1) {
+        free(poller);
+        return NULL;
+    }
+#elif defined(RBM_POLLER_KQUEUE)
+    poller->events = NULL;
+    poller->kqueuefd = kqueue();
+    if (poller->kqueuefd == -1) {
+        free(poller);
+        return NULL;
+    }
+#else
+    poller->fds = NULL;
+    poller->fdsdirty = 1;
+#endif
+
+    return poller;
+}
+
+void rbm_poller_free(struct rbm_poller *poller) {
+    if (!poller)
+        return;
+
+#if defined(RBM_POLLER_EPOLL)
+    close(poller->epollfd);
+    free(poller->events);
+#elif defined(RBM_POLLER_KQUEUE)
+    close(poller->kqueuefd);
+    free(poller->events);
+#else
+    free(poller->fds);
+#endif
+
+    free(poller->sockets);
+    free(poller);
+}
+
+/*
+ * Starts watching socket for readability.
+ * Returns -1 on error, 0 when otherwise
+ */
+int rbm_poller_add(struct rbm_poller *poller, rbm_socket_t socket) {
+    if (rbm_poller_index(poller, socket) != -1)
+        return RBM_SUCCESS;
+
+    if (poller->count == poller->capacity) {
+        int newcapacity = poller->capacity ? poller->capacity * 2 : 16;
+        rbm_socket_t *sockets = realloc(poller->sockets, newcapacity * sizeof(rbm_socket_t));
+        if (!sockets)
+            return RBM_ERROR;
+        poller->sockets = sockets;
+
+#if defined(RBM_POLLER_EPOLL)
+        struct epoll_event *events = realloc(poller->events, newcapacity * sizeof(struct epoll_event));
+        if (!events)
+            return RBM_ERROR;
+        poller->events = events;
+#elif defined(RBM_POLLER_KQUEUE)
+        struct kevent *events = realloc(poller->events, newcapacity * sizeof(struct kevent));
+        if (!events)
+            return RBM_ERROR;
+        poller->events = events;
+#else
+        rbm_pollfd *fds = realloc(poller->fds, newcapacity * sizeof(rbm_pollfd));
+        if (!fds)
+            return RBM_ERROR;
+        poller->fds = fds;
+#endif
+        poller->capacity = newcapacity;
+    }
+
+#if defined(RBM_POLLER_EPOLL)
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = socket;
+    if (epoll_ctl(poller->epollfd, EPOLL_CTL_ADD, socket, &event) == -1)
+        return RBM_ERROR;
+#elif defined(RBM_POLLER_KQUEUE)
+    struct kevent change;
+    EV_SET(&change, socket, EVFILT_READ, EV_ADD, 0, 0, NULL);
+    if (kevent(poller->kqueuefd, &change, 1, NULL, 0, NULL) == -1)
+        return RBM_ERROR;
+#else
+    poller->fdsdirty = 1;
+#endif
+
+    poller->sockets[poller->count++] = socket;
+    return RBM_SUCCESS;
+}
+
+/*
+ * Stops watching socket. Should be called before socket is closed.
+ */
+void rbm_poller_remove(struct rbm_poller *poller, rbm_socket_t socket) {
+    int index = rbm_poller_index(poller, socket);
+    if (index == -1)
+        return;
+
+#if defined(RBM_POLLER_EPOLL)
+    struct epoll_event event; // must be non-NULL for kernels before 2.6.9
+    epoll_ctl(poller->epollfd, EPOLL_CTL_DEL, socket, &event);
+#elif defined(RBM_POLLER_KQUEUE)
+    struct kevent change;
+    EV_SET(&change, socket, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+    kevent(poller->kqueuefd, &change, 1, NULL, 0, NULL);
+#else
+    poller->fdsdirty = 1;
+#endif
+
+    poller->sockets[index] = poller->sockets[--poller->count];
+}
+
+int rbm_poller_contains(struct rbm_poller *poller, rbm_socket_t socket) {
+    return rbm_poller_index(poller, socket) != -1;
+}
+
+/*
+ * Waits until at least one of registered sockets is readable, closed or failed,
+ * and stores up to "maxready" such sockets to "ready". Negative "timeoutms" means
+ * no timeout. Returns number of stored sockets (0 on timeout or if wait was
+ * interrupted), or -1 on error.
+ */
+int rbm_poller_wait(struct rbm_poller *poller, rbm_socket_t *ready, int maxready, int timeoutms) {
+    if (poller->count == 0)
+        return RBM_ERROR;
+
+    int max = poller->count < maxready ? poller->count : maxready;
+    int nready = 0;
+
+#if defined(RBM_POLLER_EPOLL)
+    int n = epoll_wait(poller->epollfd, poller->events, max, timeoutms);
+    if (n == -1)
+        return errno == EINTR ? 0 : RBM_ERROR;
+
+    for (int i = 0; i < n; i++)
+        ready[nready++] = poller->events[i].data.fd;
+#elif defined(RBM_POLLER_KQUEUE)
+    struct timespec timeout;
+    timeout.tv_sec = timeoutms / 1000;
+    timeout.tv_nsec = (timeoutms % 1000) * 1000000L;
+
+    int n = kevent(poller->kqueuefd, NULL, 0, poller->events, max, timeoutms < 0 ? NULL : &timeout);
+    if (n == -1)
+        return errno == EINTR ? 0 : RBM_ERROR;
+
+    for (int i = 0; i < n; i++)
+        ready[nready++] = (rbm_socket_t) poller->events[i].ident;
+#else
+    if (poller->fdsdirty) {
+        for (int i = 0; i < poller->count; i++) {
+            poller->fds[i].fd = poller->sockets[i];
+            poller->fds[i].events = POLLIN;
+        }
+        poller->fdsdirty = 0;
+    }
+
+    for (int i = 0; i < poller->count; i++)
+        poller->fds[i].revents = 0;
+
+    int n = rbm_poll(poller->fds, poller->count, timeoutms);
+    if (n < 0) {
+#ifdef _WIN32
+        return RBM_ERROR;
+#else
+        return errno == EINTR ? 0 : RBM_ERROR;
+#endif
+    }
+
+    for (int i = 0; i < poller->count && nready < max; i++)
+        if (poller->fds[i].revents)
+            ready[nready++] = poller->fds[i].fd;
+#endif
+
+    return nready;
+}
+
+/*
+ * Waits until socket is ready for reading (RBM_WAIT_READ) and/or writing (RBM_WAIT_WRITE),
+ * or until timeout expires. Used to drive non-blocking libssh2 calls that returned EAGAIN.
+ * Returns 1 if socket is ready, 0 on timeout, -1 on error.
+ */
+int rbm_socket_wait(rbm_socket_t socket, int directions, int timeoutms) {
+    rbm_pollfd fd;
+    fd.fd = socket;
+    fd.events = 0;
+    fd.revents = 0;
+    if (directions & RBM_WAIT_READ)
+        fd.events |= POLLIN;
+    if (directions & RBM_WAIT_WRITE)
+        fd.events |= POLLOUT;
+
+    int n = rbm_poll(&fd, 1, timeoutms);
+    if (n < 0)
+        return RBM_ERROR;
+
+    return n > 0 ? 1 : 0;
+}
@@ -29,24 +29,52 @@ enum {
     RBM_SUCCESS = 0,
     RBM_ERROR   = -1,
     RBM_CHANNEL_CREATION_ERROR   = -10,
-    RBM_BUFSIZE = 16384, // Size of the in/out buffers
+    RBM_BUFSIZE = 16384, // Initial size of the in/out buffers
+    RBM_BUFSIZE_MAX = 262144, // Buffers grow up to this size while reads keep filling them
+    RBM_CHANNEL_WINDOW = 4194304, // Receive window of every SSH channel
+    RBM_POLL_EVENTS = 64, // Max number of ready sockets handled per one wait
+    RBM_POLL_TIMEOUT = 250, // ms, how often tunnel loop picks up forwards added by other threads
+};
+
+// Directions for rbm_socket_wait()
+enum {
+    RBM_WAIT_READ  = 1,
+    RBM_WAIT_WRITE = 2
 };
 
 //===----------------------------------------------------------------------===//
 // Data structures
 //===----------------------------------------------------------------------===//
 
+/*
+ * Local port forwarded to the remote host through SSH session
+ */
+struct rbm_forward {
+    rbm_socket_t localsocket;   // accept socket
+    unsigned int localport;
+    char *remotehost;           // owned copy
+    unsigned int remoteport;
+    int channels;               // number of open channels, accepted on localsocket
+    int used;                   // forward is closed when used and has no channels
+};
+
 struct rbm_channel {
     struct rbm_session* session;
+    struct rbm_forward *forward;
     LIBSSH2_CHANNEL *channel;
     rbm_socket_t socket;
     char *inbuf;
     char *outbuf;
-    int bufmaxsize;
+    int insize;     // current size of inbuf (client -> tunnel)
+    int outsize;    // current size of outbuf (tunnel -> client)
+
+    // Traffic of this channel, in bytes
+    unsigned long long bytestotunnel;
+    unsigned long long bytesfromtunnel;
+    long long opentime;     // ms, see rbm_time_ms()
 };
 
 struct rbm_session {
-    rbm_socket_t localsocket;
     rbm_socket_t sshsocket;
     LIBSSH2_SESSION *sshsession;
     struct rbm_ssh_tunnel_config *config;
@@ -54,15 +82,40 @@ struct rbm_session {
     struct rbm_channel **channels;      // array of channels
     int channelssize;                       // number of channels
 
+    struct rbm_forward **forwards;      // forwards served by tunnel loop
+    int forwardssize;
+
+    // Forwards added by rbm_ssh_session_add_forward(), not yet picked up by tunnel loop.
+    // Protected by "lock", together with "closing".
+    struct rbm_forward **pending;
+    int pendingsize;
+    int closing;                        // no more forwards are accepted
+    rbm_mutex_t lock;
+
     struct rbm_ssh_session *publicsession;
+    struct rbm_poller *poller;          // sockets of the running tunnel loop, or NULL
     char lasterror[2048];
+    char methods[256];                  // see rbm_ssh_session_methods()
+    long long nextkeepalive;            // ms, see rbm_time_ms(); 0 if keep-alive is disabled
+
+    // Throughput counters of the whole tunnel (all channels, all reconnects)
+    unsigned long long bytestotunnel;
+    unsigned long long bytesfromtunnel;
+    long long opentime;     // ms, see rbm_time_ms()
 };
 
 
 // Channels
-struct rbm_channel *rbm_channel_create(struct rbm_session* session, rbm_socket_t socket, LIBSSH2_CHANNEL *lchannel);
+struct rbm_channel *rbm_channel_create(struct rbm_session* session, struct rbm_forward *forward, rbm_socket_t socket,
+                                       LIBSSH2_CHANNEL *lchannel);
 void rbm_channel_close(struct rbm_channel *channel);
 struct rbm_channel *rbm_channel_find_by_socket(struct rbm_session *session, rbm_socket_t socket);
+int rbm_channel_tune_window(struct rbm_session *session, LIBSSH2_CHANNEL *lchannel);
+
+// Forwards
+struct rbm_forward *rbm_forward_create(struct rbm_session *session, char *remotehost, unsigned int remoteport);
+void rbm_forward_close(struct rbm_session *session, struct rbm_forward *forward);
+struct rbm_forward *rbm_forward_find_by_socket(struct rbm_session *session, rbm_socket_t socket);
 
 void rbm_session_cleanup(struct rbm_session *session);
 int rbm_open_tunnel(struct rbm_session *connection);
@@ -72,6 +125,20 @@ LIBSSH2_SESSION *ssh_connect(struct rbm_session *rsession, rbm_socket_t sock, en
                              char *publickeypath, char *privatekeypath, char *passphrase);
 rbm_socket_t socket_listen(struct rbm_session *rsession, char *ip, int *port);
 
+//===----------------------------------------------------------------------===//
+// Polling
+//===----------------------------------------------------------------------===//
+
+struct rbm_poller;
+
+struct rbm_poller *rbm_poller_create();
+void rbm_poller_free(struct rbm_poller *poller);
+int rbm_poller_add(struct rbm_poller *poller, rbm_socket_t socket);
+void rbm_poller_remove(struct rbm_poller *poller, rbm_socket_t socket);
+int rbm_poller_contains(struct rbm_poller *poller, rbm_socket_t socket);
+int rbm_poller_wait(struct rbm_poller *poller, rbm_socket_t *ready, int maxready, int timeoutms);
+int rbm_socket_wait(rbm_socket_t socket, int directions, int timeoutms);
+
 //===----------------------------------------------------------------------===//
 // Logging
 //===----------------------------------------------------------------------===//
@@ -92,6 +159,7 @@ void ssh_log_error(struct rbm_session *session, const char *format, ...);
 
 int rbm_array_add(void ***array, int *currentsize, void *data);
 int rbm_array_remove(void ***array, int *currentsize, void *data);
+int rbm_buffer_grow(char **buffer, int *size);
 
 #ifdef __cplusplus
 }
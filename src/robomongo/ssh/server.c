@@ -23,6 +23,10 @@ int main(int argc, char *argv[]) {
     config.sshserverport = 22;
     config.remotehost = "localhost";
     config.remoteport = 27017;
+    config.ciphers = NULL;
+    config.macs = NULL;
+    config.compression = 0;
+    config.keepaliveinterval = 0;
     config.logcontext = NULL;
     config.loglevel = RBM_SSH_LOG_TYPE_DEBUG;
 
@@ -52,7 +56,8 @@ int main(int argc, char *argv[]) {
         printf("Tunnel stopped because of error.\n");
         return 1;
     }
-//
+
+    rbm_ssh_session_close(session);
 //    printf("Planned shutdown of the tunnel.");
     rbm_ssh_cleanup();
     return 0;
@@ -24,13 +24,28 @@
 #include <signal.h>
 #include <stdio.h>
 
-static int handle_new_client_connections(struct rbm_session *connection, int *fdmax, fd_set *masterset);
-static int handle_ssh_connections(struct rbm_session *connection, fd_set *masterset);
-static int handle_client_connections(struct rbm_session *connection, rbm_socket_t i, fd_set *masterset);
+static int handle_new_client_connections(struct rbm_session *connection, struct rbm_forward *forward);
+static int handle_ssh_connections(struct rbm_session *connection);
+static int handle_client_connections(struct rbm_session *connection, rbm_socket_t i);
+static int rbm_channel_has_data(LIBSSH2_CHANNEL *lchannel);
+static int rbm_ssh_wait(struct rbm_session *connection, int timeoutms);
+
+static int rbm_send_all(struct rbm_session *connection, struct rbm_channel *context, const char *data, int len);
+static void ssh_log_throughput(struct rbm_session *session, const char *what, unsigned long long totunnel,
+                               unsigned long long fromtunnel, long long opentime);
+
+static int ssh_set_method_pref(struct rbm_session *rsession, LIBSSH2_SESSION *session, int method, char *prefs);
+static void rbm_send_keepalive(struct rbm_session *session);
 
 static void rbm_sleep_ms(int ms);
+static long long rbm_time_ms();
 static void rbm_socket_close(rbm_socket_t socket);
 
+static void rbm_mutex_init(rbm_mutex_t *mutex);
+static void rbm_mutex_destroy(rbm_mutex_t *mutex);
+static void rbm_mutex_lock(rbm_mutex_t *mutex);
+static void rbm_mutex_unlock(rbm_mutex_t *mutex);
+
 //===----------------------------------------------------------------------===//
 // Public API
 //===----------------------------------------------------------------------===//
@@ -89,13 +104,23 @@ struct rbm_ssh_session *rbm_ssh_session_create(struct rbm_ssh_tunnel_config *con
     if (!session)
         return NULL;
 
-    session->localsocket = rbm_socket_invalid;
     session->sshsocket = rbm_socket_invalid;
     session->sshsession = NULL;
     session->config = config;
     session->channels = NULL;
     session->channelssize = 0;
+    session->forwards = NULL;
+    session->forwardssize = 0;
+    session->pending = NULL;
+    session->pendingsize = 0;
+    session->closing = 0;
+    session->poller = NULL;
     session->lasterror[0] = '\0';
+    session->methods[0] = '\0';
+    session->nextkeepalive = 0;
+    session->bytestotunnel = 0;
+    session->bytesfromtunnel = 0;
+    session->opentime = rbm_time_ms();
 
     // Check that loglevel is valid
     if (config->loglevel != RBM_SSH_LOG_TYPE_ERROR &&
@@ -111,6 +136,7 @@ struct rbm_ssh_session *rbm_ssh_session_create(struct rbm_ssh_tunnel_config *con
         return NULL;
 
     publicsession->lasterror = session->lasterror;
+    rbm_mutex_init(&session->lock);
 
     // Point to each other
     publicsession->handle = session;
@@ -122,15 +148,28 @@ struct rbm_ssh_session *rbm_ssh_session_create(struct rbm_ssh_tunnel_config *con
 
 void rbm_ssh_session_close(struct rbm_ssh_session *sshsession) {
     struct rbm_session *session = (struct rbm_session*)sshsession->handle;
-    if (session->localsocket != rbm_socket_invalid) {
-        ssh_log_debug(session, "Closing local accept socket");
-        rbm_socket_close(session->localsocket);
-        session->localsocket = rbm_socket_invalid;
+
+    rbm_mutex_lock(&session->lock);
+    session->closing = 1;
+    while (session->pendingsize > 0) {
+        struct rbm_forward *forward = session->pending[0];
+        rbm_array_remove((void ***)&session->pending, &session->pendingsize, forward);
+        rbm_array_add((void ***)&session->forwards, &session->forwardssize, forward);
     }
+    rbm_mutex_unlock(&session->lock);
 
+    // Channels are closed before accept sockets of their forwards
     rbm_session_cleanup(session);
 
+    ssh_log_debug(session, "Closing local accept sockets");
+    while (session->forwardssize > 0) {
+        rbm_forward_close(session, session->forwards[0]);
+    }
+
+    ssh_log_throughput(session, "SSH tunnel closed", session->bytestotunnel, session->bytesfromtunnel,
+                       session->opentime);
     ssh_log_debug(session, "SSH tunnel successfully closed.");
+    rbm_mutex_destroy(&session->lock);
     free(session);
     free(sshsession);
 }
@@ -168,29 +207,127 @@ int rbm_ssh_session_setup(struct rbm_ssh_session *sshsession) {
     if (rbm_ssh_setup(session) == -1)
         return RBM_ERROR;
 
-    session->localsocket = socket_listen(session, config->localip, (int *) &config->localport);
-    if (session->localsocket == -1) {
-        session->localsocket = rbm_socket_invalid;
-        return RBM_ERROR; // errors are already logged by socket_listen
+    struct rbm_forward *forward = rbm_forward_create(session, config->remotehost, config->remoteport);
+    if (!forward)
+        return RBM_ERROR; // errors are already logged by rbm_forward_create
+
+    if (rbm_array_add((void ***)&session->forwards, &session->forwardssize, forward)) {
+        rbm_forward_close(session, forward);
+        return RBM_ERROR;
     }
 
+    config->localport = forward->localport;
     ssh_log_debug(session, "Waiting for TCP connection on %s:%d...", config->localip, config->localport);
 
     return RBM_SUCCESS;
 }
 
+int rbm_ssh_session_add_forward(struct rbm_ssh_session *sshsession, char *remotehost, unsigned int remoteport,
+                                unsigned int *localport) {
+    struct rbm_session *session = (struct rbm_session*)sshsession->handle;
+
+    // Accept socket is listening right away, connections wait in its backlog
+    // until tunnel loop picks this forward up
+    struct rbm_forward *forward = rbm_forward_create(session, remotehost, remoteport);
+    if (!forward)
+        return RBM_ERROR;
+
+    int result = RBM_ERROR;
+    rbm_mutex_lock(&session->lock);
+    if (!session->closing)
+        result = rbm_array_add((void ***)&session->pending, &session->pendingsize, forward);
+    rbm_mutex_unlock(&session->lock);
+
+    if (result != RBM_SUCCESS) {
+        rbm_forward_close(session, forward);
+        return RBM_ERROR;
+    }
+
+    *localport = forward->localport;
+    ssh_log_debug(session, "Forwarding %s:%d to %s:%u through existing SSH session",
+                  session->config->localip, *localport, remotehost, remoteport);
+    return RBM_SUCCESS;
+}
+
+const char *rbm_ssh_session_methods(struct rbm_ssh_session *sshsession) {
+    struct rbm_session *session = (struct rbm_session*)sshsession->handle;
+    return session->methods;
+}
+
 
 //===----------------------------------------------------------------------===//
 // Private API
 //===----------------------------------------------------------------------===//
 
 
+/*
+ * Opens accept socket for new forward. Forward is not added to the session.
+ * Returns NULL on error, or valid rbm_forward otherwise.
+ */
+struct rbm_forward *rbm_forward_create(struct rbm_session *session, char *remotehost, unsigned int remoteport) {
+    struct rbm_forward *forward = malloc(sizeof(struct rbm_forward));
+    if (!forward)
+        return NULL;
+
+    forward->remotehost = malloc(strlen(remotehost) + 1);
+    if (!forward->remotehost) {
+        free(forward);
+        return NULL;
+    }
+    strcpy(forward->remotehost, remotehost);
+
+    forward->remoteport = remoteport;
+    forward->channels = 0;
+    forward->used = 0;
+
+    int port = 0;
+    forward->localsocket = socket_listen(session, session->config->localip, &port);
+    if (forward->localsocket == rbm_socket_invalid) {
+        free(forward->remotehost);
+        free(forward);
+        return NULL; // errors are already logged by socket_listen
+    }
+
+    forward->localport = (unsigned int) port;
+    return forward;
+}
+
+/*
+ * Closes accept socket and removes forward from the session (if it was added)
+ */
+void rbm_forward_close(struct rbm_session *session, struct rbm_forward *forward) {
+    rbm_array_remove((void ***)&session->forwards, &session->forwardssize, forward);
+
+    if (session->poller)
+        rbm_poller_remove(session->poller, forward->localsocket);
+    rbm_socket_close(forward->localsocket);
+
+    ssh_log_debug(session, "Forward of port %u to %s:%u closed", forward->localport,
+                  forward->remotehost, forward->remoteport);
+
+    free(forward->remotehost);
+    free(forward);
+}
+
+/*
+ * Returns forward with specified accept socket, or NULL otherwise
+ */
+struct rbm_forward *rbm_forward_find_by_socket(struct rbm_session *session, rbm_socket_t socket) {
+    for (int i = 0; i < session->forwardssize; i++)
+        if (session->forwards[i]->localsocket == socket)
+            return session->forwards[i];
+
+    return NULL;
+}
+
 // Returns NULL on error, or valid rbm_ssh_channel otherwise.
-struct rbm_channel *rbm_channel_create(struct rbm_session* session, rbm_socket_t socket, LIBSSH2_CHANNEL *lchannel) {
+struct rbm_channel *rbm_channel_create(struct rbm_session* session, struct rbm_forward *forward, rbm_socket_t socket,
+                                       LIBSSH2_CHANNEL *lchannel) {
     struct rbm_channel *channel = malloc(sizeof(struct rbm_channel));
     if (!channel)
         return NULL;
 
+    // Buffers start small and grow (see rbm_buffer_grow) only for channels that move a lot of data
     char *inbuf = malloc(sizeof(char) * RBM_BUFSIZE);
     if (!inbuf)
         return NULL;
@@ -200,15 +337,22 @@ struct rbm_channel *rbm_channel_create(struct rbm_session* session, rbm_socket_t
         return NULL;
 
     channel->session = session;
+    channel->forward = forward;
     channel->channel = lchannel;
     channel->socket = socket;
     channel->inbuf = inbuf;
     channel->outbuf = outbuf;
-    channel->bufmaxsize = RBM_BUFSIZE;
+    channel->insize = RBM_BUFSIZE;
+    channel->outsize = RBM_BUFSIZE;
+    channel->bytestotunnel = 0;
+    channel->bytesfromtunnel = 0;
+    channel->opentime = rbm_time_ms();
 
     if (rbm_array_add((void ***)&session->channels, &session->channelssize, channel))
         return NULL;
 
+    forward->channels++;
+    forward->used = 1;
     return channel;
 }
 
@@ -217,8 +361,12 @@ void rbm_channel_close(struct rbm_channel *channel) {
     if (rbm_array_remove((void ***)&session->channels, &session->channelssize, channel))
         return;
 
+    channel->forward->channels--;
+
     // 3. Close socket
     if (channel->socket != rbm_socket_invalid) {
+        if (session->poller)
+            rbm_poller_remove(session->poller, channel->socket);
         rbm_socket_close(channel->socket);
         channel->socket = rbm_socket_invalid;
     }
@@ -235,10 +383,11 @@ void rbm_channel_close(struct rbm_channel *channel) {
     channel->inbuf = NULL;
     channel->outbuf = NULL;
 
+    ssh_log_throughput(session, "Channel closed", channel->bytestotunnel, channel->bytesfromtunnel,
+                       channel->opentime);
+
     // 4. Free channel struct
     free(channel);
-
-    ssh_log_debug(session, "Channel closed");
 }
 
 /*
@@ -252,6 +401,39 @@ struct rbm_channel *rbm_channel_find_by_socket(struct rbm_session *session, rbm_
     return NULL;
 }
 
+/*
+ * Enlarges receive window of the channel up to RBM_CHANNEL_WINDOW, so that server can
+ * send big result sets without waiting for window adjustments after every few packets.
+ * Returns -1 on error, 0 when otherwise
+ */
+int rbm_channel_tune_window(struct rbm_session *session, LIBSSH2_CHANNEL *lchannel) {
+    unsigned long initial = 0;
+    unsigned long window = libssh2_channel_window_read_ex(lchannel, NULL, &initial);
+    if (window >= RBM_CHANNEL_WINDOW)
+        return RBM_SUCCESS;
+
+    const int maxattempts = 25;
+    for (int attempts = 0; attempts < maxattempts; ++attempts) {
+        unsigned int newwindow = 0;
+        int rc = libssh2_channel_receive_window_adjust2(lchannel, RBM_CHANNEL_WINDOW - window, 1, &newwindow);
+        if (rc == LIBSSH2_ERROR_EAGAIN) {
+            rbm_sleep_ms(10);
+            continue;
+        }
+
+        if (rc) {
+            ssh_log_warn(session, "Failed to adjust window of SSH channel (%d)", rc);
+            return RBM_ERROR;
+        }
+
+        ssh_log_debug(session, "Receive window of SSH channel adjusted to %u bytes", newwindow);
+        return RBM_SUCCESS;
+    }
+
+    ssh_log_warn(session, "Failed to adjust window of SSH channel (timeout)");
+    return RBM_ERROR;
+}
+
 // Returns -1 on error, 0 when otherwise
 int rbm_ssh_setup(struct rbm_session *session) {
     struct rbm_ssh_tunnel_config *config = session->config;
@@ -270,6 +452,19 @@ int rbm_ssh_setup(struct rbm_session *session) {
         return RBM_ERROR; // errors are already logged by ssh_connect
     }
 
+    // Written once per (re)connect, before tunnel loop and other threads read it
+    const char *cipher = libssh2_session_methods(session->sshsession, LIBSSH2_METHOD_CRYPT_CS);
+    const char *mac = libssh2_session_methods(session->sshsession, LIBSSH2_METHOD_MAC_CS);
+    const char *compression = libssh2_session_methods(session->sshsession, LIBSSH2_METHOD_COMP_CS);
+    snprintf(session->methods, sizeof(session->methods), "%s, %s, %s",
+             cipher ? cipher : "?", mac ? mac : "?", compression ? compression : "?");
+    ssh_log_msg(session, "SSH session uses %s", session->methods);
+
+    if (config->keepaliveinterval > 0) {
+        libssh2_keepalive_config(session->sshsession, 1, config->keepaliveinterval);
+        session->nextkeepalive = rbm_time_ms() + config->keepaliveinterval * 1000LL;
+    }
+
     // Must use non-blocking IO hereafter due to the current libssh3 API
     libssh2_session_set_blocking(session->sshsession, 0);
 
@@ -308,60 +503,102 @@ void rbm_session_cleanup(struct rbm_session *session) {
 }
 
 
+/*
+ * Moves forwards added by rbm_ssh_session_add_forward() to the tunnel loop.
+ * When there are no forwards left, marks session as closing and returns 0,
+ * otherwise returns 1.
+ */
+static int rbm_adopt_pending_forwards(struct rbm_session *connection) {
+    int active = 1;
+
+    rbm_mutex_lock(&connection->lock);
+    while (connection->pendingsize > 0) {
+        struct rbm_forward *forward = connection->pending[0];
+        rbm_array_remove((void ***)&connection->pending, &connection->pendingsize, forward);
+
+        if (rbm_array_add((void ***)&connection->forwards, &connection->forwardssize, forward) ||
+            rbm_poller_add(connection->poller, forward->localsocket)) {
+            ssh_log_error(connection, "Failed to add forward of port %u", forward->localport);
+            rbm_forward_close(connection, forward);
+        }
+    }
+
+    if (connection->forwardssize == 0) {
+        connection->closing = 1;
+        active = 0;
+    }
+    rbm_mutex_unlock(&connection->lock);
+
+    return active;
+}
+
 int rbm_open_tunnel(struct rbm_session *connection) {
-    rbm_socket_t local_socket = connection->localsocket;
     rbm_socket_t ssh_socket = connection->sshsocket;
 
     const int maxerrors = 25;   // number of serial errors, when we probably should stop the loop
     int errors = 0;             // counter for serial errors
     int rc = 0;
+    int result = RBM_SUCCESS;
 
-    int fdmax;       // maximum socket (file descriptor) number
-    int isocket;     // index for traversing sockets
-    fd_set masterset, readset;
-    FD_ZERO(&masterset);
+    rbm_socket_t ready[RBM_POLL_EVENTS];
+    struct rbm_poller *poller = rbm_poller_create();
+    if (!poller) {
+        ssh_log_error(connection, "Failed to create poller");
+        return RBM_ERROR;
+    }
 
-    // Add the listener to the master set
-    FD_SET(local_socket, &masterset);
-    FD_SET(ssh_socket, &masterset);
+    // Client sockets are added when accepted and removed by rbm_channel_close(),
+    // accept sockets are removed by rbm_forward_close()
+    connection->poller = poller;
+    if (rbm_poller_add(poller, ssh_socket)) {
+        ssh_log_error(connection, "Failed to add socket to poller");
+        result = RBM_ERROR;
+        goto done;
+    }
 
-    // Keep track of the biggest file descriptor
-    fdmax = local_socket > ssh_socket ? local_socket : ssh_socket;
+    for (int i = 0; i < connection->forwardssize; i++) {
+        if (rbm_poller_add(poller, connection->forwards[i]->localsocket)) {
+            ssh_log_error(connection, "Failed to add socket to poller");
+            result = RBM_ERROR;
+            goto done;
+        }
+    }
 
     while (errors < maxerrors) {
 
-        readset = masterset; // copy set
-
-        // If local (accept) socket is closed, it means that
+        // If all forwards are closed, it means that
         // session is closed and we should stop our work
-        if (!FD_ISSET(local_socket, &readset))
+        if (!rbm_adopt_pending_forwards(connection))
             break;
 
-        ssh_log_debug(connection, "* Okay, we are ready to select.");
-        if (select(fdmax + 1, &readset, NULL, NULL, NULL) == -1) {
-            ssh_log_error(connection, "Error on select()");
+        int nready = rbm_poller_wait(poller, ready, RBM_POLL_EVENTS, RBM_POLL_TIMEOUT);
+        if (nready == -1) {
+            ssh_log_error(connection, "Error on waiting for sockets");
             break;
         }
-        ssh_log_debug(connection, "* Selected!");
 
-        // Run through the existing connections looking for data to read
-        for(isocket = 0; isocket <= fdmax; isocket++) {
+        rbm_send_keepalive(connection);
+
+        // Run through the ready sockets only
+        for (int i = 0; i < nready; i++) {
+            rbm_socket_t isocket = ready[i];
 
-            // Skip connections that are not available for reading
-            if (!FD_ISSET(isocket, &readset))
+            // Socket could be closed by one of the previous handlers
+            if (!rbm_poller_contains(poller, isocket))
                 continue;
 
-            if (isocket == local_socket) {
-                rc = handle_new_client_connections(connection, &fdmax, &masterset);
+            if (isocket == ssh_socket) {
+                rc = handle_ssh_connections(connection);
                 goto next;
             }
 
-            if (isocket == ssh_socket) {
-                rc = handle_ssh_connections(connection, &masterset);
+            struct rbm_forward *forward = rbm_forward_find_by_socket(connection, isocket);
+            if (forward) {
+                rc = handle_new_client_connections(connection, forward);
                 goto next;
             }
 
-            rc = handle_client_connections(connection, isocket, &masterset);
+            rc = handle_client_connections(connection, isocket);
 
             next:
             // Increment "errors" counter, if we found an error,
@@ -373,28 +610,31 @@ int rbm_open_tunnel(struct rbm_session *connection) {
 
             if (rc == -1) {
                 ssh_log_warn(connection, "SSH tunnel shutdown because of error");
-                return RBM_ERROR;
+                result = RBM_ERROR;
+                goto done;
             }
 
             if (rc == RBM_CHANNEL_CREATION_ERROR) {
-                return RBM_CHANNEL_CREATION_ERROR;
+                result = RBM_CHANNEL_CREATION_ERROR;
+                goto done;
             }
         }
     }
 
     if (errors >= maxerrors) {
         ssh_log_warn(connection, "SSH tunnel shutdown because of series of successive EAGAIN errors");
-        return RBM_ERROR;
+        result = RBM_ERROR;
     }
 
-    rbm_ssh_session_close(connection->publicsession);
-    return RBM_SUCCESS;
+done:
+    connection->poller = NULL;
+    rbm_poller_free(poller);
+    return result;
 }
 
 // Return -1 on error. 0 otherwise.
-static int handle_new_client_connections(struct rbm_session *connection, int *fdmax, fd_set *masterset) {
-    rbm_socket_t local_socket = connection->localsocket;
-    rbm_socket_t ssh_socket = connection->sshsocket;
+static int handle_new_client_connections(struct rbm_session *connection, struct rbm_forward *forward) {
+    rbm_socket_t local_socket = forward->localsocket;
     LIBSSH2_SESSION* session = connection->sshsession;
     struct rbm_ssh_tunnel_config* config = connection->config;
     rbm_socket_t newfd = rbm_socket_invalid;
@@ -409,10 +649,10 @@ static int handle_new_client_connections(struct rbm_session *connection, int *fd
         ssh_log_error(connection, "Error on accept()");
         return RBM_ERROR;
     } else {
-        FD_SET(newfd, masterset); // add to master set
-
-        if (newfd > *fdmax) {       // keep track of the maximum
-            *fdmax = newfd;
+        if (rbm_poller_add(connection->poller, newfd)) {
+            ssh_log_error(connection, "Failed to add socket to poller");
+            rbm_socket_close(newfd);
+            return RBM_ERROR;
         }
 
         ssh_log_debug(connection, "New connection from %s on socket %d", inet_ntoa(remoteaddr.sin_addr), newfd);
@@ -423,8 +663,8 @@ static int handle_new_client_connections(struct rbm_session *connection, int *fd
     int attempts = 0;
     while (attempts < maxattempts) {
         ++attempts;
-        channel = libssh2_channel_direct_tcpip_ex(session, config->remotehost, config->remoteport,
-                                                  config->localip, config->localport);
+        channel = libssh2_channel_direct_tcpip_ex(session, forward->remotehost, forward->remoteport,
+                                                  config->localip, forward->localport);
 
         int errsave = errno;
         if (!channel) {
@@ -451,7 +691,15 @@ static int handle_new_client_connections(struct rbm_session *connection, int *fd
         return RBM_CHANNEL_CREATION_ERROR;
     }
 
-    if (rbm_channel_create(connection, newfd, channel) == NULL) {
+    // Channel is still usable with default window, only slower
+    rbm_channel_tune_window(connection, channel);
+
+    if (rbm_channel_create(connection, forward, newfd, channel) == NULL) {
+        return RBM_ERROR;
+    }
+
+    if (rbm_poller_add(connection->poller, connection->sshsocket)) {
+        ssh_log_error(connection, "Failed to add socket to poller");
         return RBM_ERROR;
     }
 
@@ -460,41 +708,47 @@ static int handle_new_client_connections(struct rbm_session *connection, int *fd
 
 //  0: success
 // -1:
-static int handle_ssh_connections(struct rbm_session *connection, fd_set *masterset) {
+static int handle_ssh_connections(struct rbm_session *connection) {
     const int AGAIN = -2;
     struct rbm_ssh_tunnel_config* config = connection->config;
 
-    ssh_log_debug(connection, "Data on SSH socket is available");
-    ssh_log_debug(connection, "[%d]  <-  Number of channels", connection->channelssize);
-
+    // Tunnel is done with all forwards that already had connections. SSH socket
+    // is watched again when the next channel is opened.
     if (connection->channelssize == 0) {
-        FD_CLR(connection->localsocket, masterset); // remove from master set
-        FD_CLR(connection->sshsocket, masterset);   // remove from master set
+        for (int i = connection->forwardssize - 1; i >= 0; i--)
+            if (connection->forwards[i]->used)
+                rbm_forward_close(connection, connection->forwards[i]);
+
+        rbm_poller_remove(connection->poller, connection->sshsocket);
         return RBM_SUCCESS;
     }
 
     int s = 0;
     int result = RBM_SUCCESS;
     int eagain = 0;
+    int serviced = 0;
     while (s < connection->channelssize) {
         struct rbm_channel *context = connection->channels[s];
         ++s;
 
+        // Read of the first channel pulls all available packets from SSH socket into
+        // channel queues, so other channels are read only if they got some data
+        if (s > 1 && !rbm_channel_has_data(context->channel))
+            continue;
+        ++serviced;
+
+        // Data of successive reads is collected in outbuf and forwarded to the client
+        // with one send() when channel has no more data or buffer is full
         int firstflag = 1;
+        int filled = 0;
         while (1) {
             int len;
-            len = libssh2_channel_read(context->channel, context->outbuf, context->bufmaxsize);
+            len = libssh2_channel_read(context->channel, context->outbuf + filled, context->outsize - filled);
             if (len == LIBSSH2_ERROR_EAGAIN) {
 
-                if (firstflag) {
+                if (firstflag)
                     ++eagain;
 
-                    if (eagain == connection->channelssize) {
-                        result = AGAIN;
-                        ssh_log_warn(connection, "All channels are in a non ready state (EAGAIN)");
-                    }
-                }
-
                 // Proceed with the next channel
                 break;
             } else if (len < 0) {
@@ -507,25 +761,27 @@ static int handle_ssh_connections(struct rbm_session *connection, fd_set *master
                 // Endless cycle:
                 // Network is down. libssh2_channel_read: -43. (Error #50)
 
-                result = RBM_ERROR;
                 ssh_log_error(connection, "libssh2_channel_read: %d", len);
+                if (filled > 0)
+                    rbm_send_all(connection, context, context->outbuf, filled);
                 return RBM_ERROR;
             }
 
             firstflag = 0;
-            ssh_log_debug(connection, "Received %d bytes from tunnel", len);
+            filled += len;
 
-            int wr = 0;
-            int rc = 0; // result
-            while (wr < len) {
-                rc = send(context->socket, context->outbuf + wr, len - wr, 0);
-                if (rc <= 0) {
+            // Buffer is full: enlarge it to read more at once next time, or flush when it is
+            // already at maximum size
+            if (filled == context->outsize &&
+                rbm_buffer_grow(&context->outbuf, &context->outsize) != RBM_SUCCESS) {
+                if (rbm_send_all(connection, context, context->outbuf, filled) != RBM_SUCCESS) {
                     result = RBM_ERROR;
-                    ssh_log_error(connection, "Failure to write data to client");
+                    filled = 0;
                     break;
                 }
-                wr += rc;
+                filled = 0;
             }
+
             if (libssh2_channel_eof(context->channel)) {
                 result = RBM_SUCCESS;
                 ssh_log_debug(connection, "The server at %s:%d disconnected!\n",
@@ -533,24 +789,32 @@ static int handle_ssh_connections(struct rbm_session *connection, fd_set *master
                 break;
             }
         }
+
+        if (filled > 0 && rbm_send_all(connection, context, context->outbuf, filled) != RBM_SUCCESS)
+            result = RBM_ERROR;
+    }
+
+    if (result == RBM_SUCCESS && eagain == serviced) {
+        result = AGAIN;
+        ssh_log_warn(connection, "All channels are in a non ready state (EAGAIN)");
     }
 
     return result;
 }
 
-static int handle_client_connections(struct rbm_session *connection, rbm_socket_t i, fd_set *masterset) {
+static int handle_client_connections(struct rbm_session *connection, rbm_socket_t i) {
     int result = RBM_SUCCESS;
     ssh_log_debug(connection, "Data on client socket is available");
 
     struct rbm_channel *context = rbm_channel_find_by_socket(connection, i);
     if (!context) {
+        rbm_poller_remove(connection->poller, i);
         rbm_socket_close(i); // bye!
-        FD_CLR(i, masterset); // remove from master set
         return RBM_ERROR;
     }
 
     // Read data from a client
-    int nbytes = recv(context->socket, context->inbuf, context->bufmaxsize, 0);
+    int nbytes = recv(context->socket, context->inbuf, context->insize, 0);
     if (nbytes <= 0) {
         if (nbytes == 0) {
             // Normal situation
@@ -563,18 +827,18 @@ static int handle_client_connections(struct rbm_session *connection, rbm_socket_
         }
 
         // In both these cases, close and cleanup connection
-//        rbm_socket_close(context->socket); // bye!
-        FD_CLR(context->socket, masterset); // remove from master set
+        struct rbm_forward *forward = context->forward;
         rbm_channel_close(context);
 
-        if (connection->channelssize == 0) {
-            FD_CLR(connection->localsocket, masterset); // remove from master set
-            FD_CLR(connection->sshsocket, masterset);   // remove from master set
-        }
+        // Last connection of the forward is closed (reference-counted teardown)
+        if (forward->used && forward->channels == 0)
+            rbm_forward_close(connection, forward);
+
+        if (connection->channelssize == 0)
+            rbm_poller_remove(connection->poller, connection->sshsocket);
 
         return result;
     }
-    ssh_log_debug(connection, "Received %d bytes from client", nbytes);
 
     // Write data to ssh tunnel
     const int againmax = 100;
@@ -591,6 +855,12 @@ static int handle_client_connections(struct rbm_session *connection, rbm_socket_
                 return RBM_ERROR;
             }
 
+            // Instead of spinning, wait until SSH socket is ready in the direction libssh2 needs
+            if (rbm_ssh_wait(connection, 100) == RBM_ERROR) {
+                ssh_log_error(connection, "Error on waiting for SSH socket");
+                return RBM_ERROR;
+            }
+
             continue;
         }
         if (rc < 0) {
@@ -599,11 +869,79 @@ static int handle_client_connections(struct rbm_session *connection, rbm_socket_
         }
         wr += rc;
     }
-    ssh_log_debug(connection, "Written %d bytes to tunnel", wr);
+
+    context->bytestotunnel += wr;
+    connection->bytestotunnel += wr;
+
+    // Client sends more than fits in buffer: read it with fewer recv() next time
+    if (nbytes == context->insize)
+        rbm_buffer_grow(&context->inbuf, &context->insize);
 
     return RBM_SUCCESS;
 }
 
+/*
+ * Returns non-zero if channel has data that can be read without waiting for SSH socket
+ */
+static int rbm_channel_has_data(LIBSSH2_CHANNEL *lchannel) {
+    unsigned long readavail = 0;
+    libssh2_channel_window_read_ex(lchannel, &readavail, NULL);
+    return readavail > 0 || libssh2_channel_eof(lchannel);
+}
+
+/*
+ * Waits until SSH socket is ready for the operation that libssh2 is blocked on
+ * (see libssh2_session_block_directions), or until timeout expires.
+ * Returns -1 on error, 0 when otherwise
+ */
+static int rbm_ssh_wait(struct rbm_session *connection, int timeoutms) {
+    int libssh2dirs = libssh2_session_block_directions(connection->sshsession);
+    int directions = 0;
+    if (libssh2dirs & LIBSSH2_SESSION_BLOCK_INBOUND)
+        directions |= RBM_WAIT_READ;
+    if (libssh2dirs & LIBSSH2_SESSION_BLOCK_OUTBOUND)
+        directions |= RBM_WAIT_WRITE;
+
+    if (!directions)
+        return RBM_SUCCESS;
+
+    return rbm_socket_wait(connection->sshsocket, directions, timeoutms) == RBM_ERROR ? RBM_ERROR : RBM_SUCCESS;
+}
+
+/*
+ * Sends all data to the client socket of channel, counting it as the traffic received from tunnel.
+ * Returns -1 on error, 0 when otherwise
+ */
+static int rbm_send_all(struct rbm_session *connection, struct rbm_channel *context, const char *data, int len) {
+    int wr = 0;
+    while (wr < len) {
+        int rc = send(context->socket, data + wr, len - wr, 0);
+        if (rc <= 0) {
+            ssh_log_error(connection, "Failure to write data to client");
+            return RBM_ERROR;
+        }
+        wr += rc;
+    }
+
+    context->bytesfromtunnel += wr;
+    connection->bytesfromtunnel += wr;
+    return RBM_SUCCESS;
+}
+
+/*
+ * Logs (with INFO level) amount of traffic and average throughput since "opentime".
+ */
+static void ssh_log_throughput(struct rbm_session *session, const char *what, unsigned long long totunnel,
+                               unsigned long long fromtunnel, long long opentime) {
+    long long elapsed = rbm_time_ms() - opentime;
+    if (elapsed <= 0)
+        elapsed = 1;
+
+    double kbps = (double)(totunnel + fromtunnel) / 1024.0 * 1000.0 / (double)elapsed;
+    ssh_log_msg(session, "%s: %llu bytes sent, %llu bytes received in %.1f sec. (%.1f KB/s)",
+                what, totunnel, fromtunnel, (double)elapsed / 1000.0, kbps);
+}
+
 /*
  * Returns socket if succeed, otherwise -1 on error
  */
@@ -713,6 +1051,19 @@ LIBSSH2_SESSION *ssh_connect(struct rbm_session *rsession, rbm_socket_t sock, en
         return 0;
     }
 
+    // Preferences must be set before handshake, which negotiates them
+    struct rbm_ssh_tunnel_config *config = rsession->config;
+    if (!ssh_set_method_pref(rsession, session, LIBSSH2_METHOD_CRYPT_CS, config->ciphers) ||
+        !ssh_set_method_pref(rsession, session, LIBSSH2_METHOD_CRYPT_SC, config->ciphers) ||
+        !ssh_set_method_pref(rsession, session, LIBSSH2_METHOD_MAC_CS, config->macs) ||
+        !ssh_set_method_pref(rsession, session, LIBSSH2_METHOD_MAC_SC, config->macs)) {
+        libssh2_session_free(session);
+        return 0;
+    }
+
+    if (config->compression)
+        libssh2_session_flag(session, LIBSSH2_FLAG_COMPRESS, 1);
+
     /* ... start it up. This will trade welcome banners, exchange keys,
      * and setup crypto, compression, and MAC layers
      */
@@ -769,6 +1120,36 @@ LIBSSH2_SESSION *ssh_connect(struct rbm_session *rsession, rbm_socket_t sock, en
     return session;
 }
 
+/*
+ * Returns 0 if none of the methods in "prefs" is supported by libssh2.
+ * Empty or NULL "prefs" keep defaults.
+ */
+static int ssh_set_method_pref(struct rbm_session *rsession, LIBSSH2_SESSION *session, int method, char *prefs) {
+    if (!prefs || !*prefs)
+        return 1;
+
+    if (libssh2_session_method_pref(session, method, prefs)) {
+        ssh_log_error(rsession, "None of SSH algorithms \"%s\" is supported", prefs);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Sends keep-alive message, when interval configured by rbm_ssh_setup() has passed.
+ * Failure to send is left to tunnel loop, which sees the broken socket.
+ */
+static void rbm_send_keepalive(struct rbm_session *session) {
+    if (session->nextkeepalive == 0 || rbm_time_ms() < session->nextkeepalive)
+        return;
+
+    int seconds = 0;
+    if (libssh2_keepalive_send(session->sshsession, &seconds) != 0 || seconds <= 0)
+        seconds = 1; // i.e. EAGAIN, tried again soon
+    ssh_log_debug(session, "SSH keep-alive, next in %d s", seconds);
+    session->nextkeepalive = rbm_time_ms() + seconds * 1000LL;
+}
+
 static void rbm_sleep_ms(int ms) {
 #ifdef WIN32
     Sleep(ms);
@@ -777,6 +1158,51 @@ static void rbm_sleep_ms(int ms) {
 #endif
 }
 
+/*
+ * Milliseconds since some unspecified point, for measuring intervals
+ */
+static long long rbm_time_ms() {
+#ifdef WIN32
+    return (long long)GetTickCount64();
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (long long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+#endif
+}
+
+static void rbm_mutex_init(rbm_mutex_t *mutex) {
+#ifdef WIN32
+    InitializeCriticalSection(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+static void rbm_mutex_destroy(rbm_mutex_t *mutex) {
+#ifdef WIN32
+    DeleteCriticalSection(mutex);
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+static void rbm_mutex_lock(rbm_mutex_t *mutex) {
+#ifdef WIN32
+    EnterCriticalSection(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+static void rbm_mutex_unlock(rbm_mutex_t *mutex) {
+#ifdef WIN32
+    LeaveCriticalSection(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
 static void rbm_socket_close(rbm_socket_t socket) {
 #ifdef WIN32
     closesocket(socket);
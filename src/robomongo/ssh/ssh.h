@@ -45,6 +45,13 @@ struct rbm_ssh_tunnel_config {
     char *sshserverhost;
     unsigned int sshserverport;
 
+    // Algorithms offered to SSH server, comma separated in order of preference.
+    // NULL or "" keeps defaults of libssh2, names it does not support are skipped.
+    char *ciphers;
+    char *macs;
+    int compression;                    // offer zlib compression, if non-zero
+    unsigned int keepaliveinterval;     // seconds between keep-alive messages, 0 to disable
+
     // Logging facilities
     enum rbm_ssh_log_type loglevel;
     void *logcontext;   // Pointer to user-defined data (can be NULL)
@@ -60,10 +67,30 @@ int rbm_ssh_init();
 void rbm_ssh_cleanup();
 
 struct rbm_ssh_session* rbm_ssh_session_create(struct rbm_ssh_tunnel_config *config);
+/*
+ * Blocks until all forwards of the session are closed. Session stays open,
+ * caller should close it with rbm_ssh_session_close() in any case.
+ */
 int rbm_ssh_open_tunnel(struct rbm_ssh_session *connection);
 int rbm_ssh_session_setup(struct rbm_ssh_session *session);
 void rbm_ssh_session_close(struct rbm_ssh_session *session);
 
+/*
+ * Forwards one more local port to "remotehost:remoteport" through already
+ * authenticated session, without new SSH handshake. Can be called from any
+ * thread, also while rbm_ssh_open_tunnel() is running. Local port is stored
+ * to "localport". Forward is closed when its last TCP connection closes.
+ * Returns 0 on success, -1 on error or if tunnel is already closing.
+ */
+int rbm_ssh_session_add_forward(struct rbm_ssh_session *session, char *remotehost, unsigned int remoteport,
+                                unsigned int *localport);
+
+/*
+ * Cipher, MAC and compression negotiated with SSH server (client to server direction),
+ * i.e. "aes128-ctr, hmac-sha2-256, none". Empty until session is set up.
+ */
+const char *rbm_ssh_session_methods(struct rbm_ssh_session *session);
+
 
 #ifdef __cplusplus
 }
@@ -1,2 +1,5 @@
+#include <pthread.h>
+
 #define rbm_socket_t int
 #define rbm_socket_invalid (-1)
+#define rbm_mutex_t pthread_mutex_t
@@ -1,2 +1,6 @@
+#include <winsock2.h>
+#include <windows.h>
+
 #define rbm_socket_t SOCKET
 #define rbm_socket_invalid INVALID_SOCKET
+#define rbm_mutex_t CRITICAL_SECTION
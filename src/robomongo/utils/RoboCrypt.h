@@ -14,12 +14,19 @@ namespace Robomongo {
             return simpleCrypt;
         }
 
-        static std::string encrypt(std::string passwd) {
-            return simpleCrypter().encryptToString(QString::fromStdString(passwd)).toStdString();
+        // Both work on UTF-8 bytes directly, the same result as through QString
+        static std::string encrypt(const std::string &passwd) {
+            QByteArray const plain = QByteArray::fromRawData(passwd.data(), static_cast<int>(passwd.size()));
+            return simpleCrypter().encryptToByteArray(plain).toBase64().toStdString();
         }
 
-        static std::string decrypt(std::string cryptedPasswd) {
-            return simpleCrypter().decryptToString(QString::fromStdString(cryptedPasswd)).toStdString();
+        static std::string decrypt(const std::string &cryptedPasswd) {
+            QByteArray const cypher = QByteArray::fromBase64(
+                QByteArray::fromRawData(cryptedPasswd.data(), static_cast<int>(cryptedPasswd.size())));
+            QByteArray plain = simpleCrypter().decryptToByteArray(cypher);
+            std::string const result(plain.constData(), plain.size());
+            plain.fill('\0');
+            return result;
         }
 
         // Read key from key file otherwise create a new key and save it into file